@@ -31,7 +31,9 @@
 #include <zlib.h>
 
 #include <fstream>
+#include <map>
 #include <memory>
+#include <set>
 
 #include <binder/IBinder.h>
 #include <binder/IServiceManager.h>
@@ -634,28 +636,50 @@ static bool setAppCmdlineProperty(char* cmdline)
     return true;
 }
 
-// Disable all /sys/ enable files.
-static bool disableKernelTraceEvents() {
+// Write each /sys/ enable file of the known categories once: "1" if it is in a
+// category enabled for this trace capture and enableCategories is true, "0"
+// otherwise. The same enable can exist in multiple categories; it is enabled if
+// any of the enabled categories has it.
+static bool setKernelTraceEventsEnable(bool enableCategories) {
     bool ok = true;
+    std::map<std::string, bool> enables;
+    std::set<std::string> requiredEnables;
     for (size_t i = 0; i < arraysize(k_categories); i++) {
         const TracingCategory &c = k_categories[i];
+        const bool enable = enableCategories && g_categoryEnables[i];
         for (int j = 0; j < MAX_SYS_FILES; j++) {
             const char* path = c.sysfiles[j].path;
-            if (path != nullptr && fileIsWritable(path)) {
-                ok &= setKernelOptionEnable(path, false);
+            if (path == nullptr) {
+                continue;
+            }
+            enables[path] |= enable;
+            if (enable && c.sysfiles[j].required == REQ) {
+                requiredEnables.insert(path);
             }
         }
     }
     for (const TracingVendorFileCategory& c : g_vendorFileCategories) {
         for (const std::string& path : c.ftrace_enable_paths) {
-            if (fileIsWritable(path.c_str())) {
-                ok &= setKernelOptionEnable(path.c_str(), false);
-            }
+            enables[path] |= enableCategories && c.enabled;
+        }
+    }
+
+    for (const auto& [path, enable] : enables) {
+        if (fileIsWritable(path.c_str())) {
+            ok &= setKernelOptionEnable(path.c_str(), enable);
+        } else if (requiredEnables.count(path) != 0) {
+            fprintf(stderr, "error writing file %s\n", path.c_str());
+            ok = false;
         }
     }
     return ok;
 }
 
+// Disable all /sys/ enable files.
+static bool disableKernelTraceEvents() {
+    return setKernelTraceEventsEnable(false);
+}
+
 // Verify that the comma separated list of functions are being traced by the
 // kernel.
 static bool verifyKernelTraceFuncs(const char* funcs)
@@ -847,38 +871,9 @@ static bool setUpKernelTracing()
     ok &= setPrintTgidEnableIfPresent(true);
     ok &= setKernelTraceFuncs(g_kernelTraceFuncs);
 
-    // Disable all the sysfs enables.  This is done as a separate loop from
-    // the enables to allow the same enable to exist in multiple categories.
-    ok &= disableKernelTraceEvents();
-
-    // Enable all the sysfs enables that are in an enabled category.
-    for (size_t i = 0; i < arraysize(k_categories); i++) {
-        if (g_categoryEnables[i]) {
-            const TracingCategory &c = k_categories[i];
-            for (int j = 0; j < MAX_SYS_FILES; j++) {
-                const char* path = c.sysfiles[j].path;
-                bool required = c.sysfiles[j].required == REQ;
-                if (path != nullptr) {
-                    if (fileIsWritable(path)) {
-                        ok &= setKernelOptionEnable(path, true);
-                    } else if (required) {
-                        fprintf(stderr, "error writing file %s\n", path);
-                        ok = false;
-                    }
-                }
-            }
-        }
-    }
-
-    for (const TracingVendorFileCategory& c : g_vendorFileCategories) {
-        if (c.enabled) {
-            for (const std::string& path : c.ftrace_enable_paths) {
-                if (fileIsWritable(path.c_str())) {
-                    ok &= setKernelOptionEnable(path.c_str(), true);
-                }
-            }
-        }
-    }
+    // Enable the sysfs enables that are in an enabled category, and disable all
+    // the others.
+    ok &= setKernelTraceEventsEnable(true);
 
     return ok;
 }
@@ -1392,6 +1387,7 @@ int main(int argc, char **argv)
 
     bool ok = true;
 
+    const nsecs_t setUpStartTime = systemTime(SYSTEM_TIME_MONOTONIC);
     if (traceStart) {
         ok &= setUpUserspaceTracing();
     }
@@ -1401,6 +1397,10 @@ int main(int argc, char **argv)
         ok &= setUpVendorTracingWithHal();
         ok &= startTrace();
     }
+    if (traceStart) {
+        ALOGI("Setting up tracing took %" PRId64 "ms",
+              ns2ms(systemTime(SYSTEM_TIME_MONOTONIC) - setUpStartTime));
+    }
 
     if (ok && traceStart) {
 
@@ -18,9 +18,13 @@
 
 #include "DumpPool.h"
 
+#include <sys/mman.h>
+
 #include <array>
 #include <thread>
 
+#include <android-base/parseint.h>
+#include <android-base/strings.h>
 #include <log/log.h>
 
 #include "dumpstate.h"
@@ -33,6 +37,8 @@ namespace dumpstate {
 
 const std::string DumpPool::PREFIX_TMPFILE_NAME = "dump-tmp.";
 
+// The path of the task results kept in memory, followed by the number of the fd that holds them.
+static const std::string IN_MEMORY_PATH_PREFIX = "/proc/self/fd/";
 
 void WaitForTask(std::future<std::string> future, const std::string& title, int out_fd) {
     DurationReporter duration_reporter("Wait for " + title, true);
@@ -41,6 +47,15 @@ void WaitForTask(std::future<std::string> future, const std::string& title, int
     if (result.empty()) {
         return;
     }
+    int fd;
+    if (android::base::StartsWith(result, IN_MEMORY_PATH_PREFIX) &&
+        android::base::ParseInt(result.substr(IN_MEMORY_PATH_PREFIX.size()), &fd)) {
+        android::base::unique_fd in_memory_fd(fd);
+        lseek(in_memory_fd.get(), 0, SEEK_SET);
+        DumpFileFromFdToFd(title, result, in_memory_fd.get(), out_fd,
+                           PropertiesHelper::IsDryRun());
+        return;
+    }
     DumpFileToFd(out_fd, title, result);
     if (unlink(result.c_str())) {
         MYLOGE("Failed to unlink (%s): %s\n", result.c_str(), strerror(errno));
@@ -96,6 +111,31 @@ void DumpPool::setLogDuration(bool log_duration) {
     log_duration_ = log_duration;
 }
 
+void DumpPool::dumpTaskStats(int out_fd) {
+    std::vector<TaskStats> task_stats;
+    {
+        std::unique_lock lock(lock_);
+        task_stats = task_stats_;
+    }
+    dprintf(out_fd, "------ DUMP POOL TASKS ------\n");
+    for (const TaskStats& stats : task_stats) {
+        dprintf(out_fd, "%s: queued %.3fs, ran %.3fs\n", stats.title.c_str(),
+                (float)(stats.started_ns - stats.queued_ns) / NANOS_PER_SEC,
+                (float)(stats.finished_ns - stats.started_ns) / NANOS_PER_SEC);
+    }
+    dprintf(out_fd, "\n");
+}
+
+uint64_t DumpPool::now() {
+    return Nanotime();
+}
+
+void DumpPool::recordTaskStats(const std::string& title, uint64_t queued_ns, uint64_t started_ns,
+                               uint64_t finished_ns) {
+    std::unique_lock lock(lock_);
+    task_stats_.push_back({title, queued_ns, started_ns, finished_ns});
+}
+
 template <>
 void DumpPool::invokeTask<std::function<void()>>(std::function<void()> dump_func,
         const std::string& duration_title, int out_fd) {
@@ -114,6 +154,20 @@ void DumpPool::invokeTask<std::function<void(int)>>(std::function<void(int)> dum
 
 std::unique_ptr<DumpPool::TmpFile> DumpPool::createTempFile() {
     auto tmp_file_ptr = std::make_unique<TmpFile>();
+
+    // Keep the results in memory, where they are only written once more, into the bugreport.
+    // Unlike a file in tmp_root_, they never reach the flash, and the kernel can still swap them
+    // out if they get large.
+    tmp_file_ptr->fd.reset(memfd_create(PREFIX_TMPFILE_NAME.c_str(), MFD_CLOEXEC));
+    if (tmp_file_ptr->fd.get() != -1) {
+        snprintf(tmp_file_ptr->path, sizeof(tmp_file_ptr->path), "%s%d",
+                 IN_MEMORY_PATH_PREFIX.c_str(), tmp_file_ptr->fd.get());
+        tmp_file_ptr->in_memory = true;
+        return tmp_file_ptr;
+    }
+    MYLOGE("memfd_create(%s): %s\n", PREFIX_TMPFILE_NAME.c_str(), strerror(errno));
+
+    tmp_file_ptr->in_memory = false;
     std::string file_name_format = "%s/" + PREFIX_TMPFILE_NAME + "XXXXXX";
     snprintf(tmp_file_ptr->path, sizeof(tmp_file_ptr->path), file_name_format.c_str(),
              tmp_root_.c_str());
@@ -144,6 +144,16 @@ class DumpPool {
      */
     void deleteTempFiles();
 
+    /*
+     * Dumps how long each finished task waited in the queue and ran, to tell
+     * which tasks would gain from more threads and which ones bound the
+     * bugreport. The "Wait for" duration reports show how long dumpstate
+     * itself was blocked on each of them.
+     *
+     * |out_fd| The target file to dump the stats to.
+     */
+    void dumpTaskStats(int out_fd);
+
     static const std::string PREFIX_TMPFILE_NAME;
 
   private:
@@ -153,13 +163,21 @@ class DumpPool {
 
     template<class T>
     std::future<std::string> post(const std::string& duration_title, T dump_func) {
+        const uint64_t queued_ns = now();
         Task packaged_task([=]() {
+            const uint64_t started_ns = now();
             std::unique_ptr<TmpFile> tmp_file_ptr = createTempFile();
             if (!tmp_file_ptr) {
                 return std::string("");
             }
             invokeTask(dump_func, duration_title, tmp_file_ptr->fd.get());
-            fsync(tmp_file_ptr->fd.get());
+            recordTaskStats(duration_title, queued_ns, started_ns, now());
+            if (tmp_file_ptr->in_memory) {
+                // The path only stays valid while the file is open; WaitForTask closes it.
+                (void)tmp_file_ptr->fd.release();
+            } else {
+                fsync(tmp_file_ptr->fd.get());
+            }
             return std::string(tmp_file_ptr->path);
         });
         std::unique_lock lock(lock_);
@@ -172,8 +190,20 @@ class DumpPool {
     typedef struct {
       android::base::unique_fd fd;
       char path[1024];
+      bool in_memory;
     } TmpFile;
 
+    typedef struct {
+      std::string title;
+      uint64_t queued_ns;
+      uint64_t started_ns;
+      uint64_t finished_ns;
+    } TaskStats;
+
+    static uint64_t now();
+    void recordTaskStats(const std::string& title, uint64_t queued_ns, uint64_t started_ns,
+                         uint64_t finished_ns);
+
     std::unique_ptr<TmpFile> createTempFile();
     void deleteTempFiles(const std::string& folder);
     void setThreadName(const pthread_t thread, int id);
@@ -194,11 +224,12 @@ class DumpPool {
     std::string tmp_root_;
     bool shutdown_;
     bool log_duration_; // For test purpose only, the default value is true.
-    std::mutex lock_;  // A lock for the tasks_.
+    std::mutex lock_;  // A lock for the tasks_ and the task_stats_.
     std::condition_variable condition_variable_;
 
     std::vector<std::thread> threads_;
     std::queue<Task> tasks_;
+    std::vector<TaskStats> task_stats_;
 
     DISALLOW_COPY_AND_ASSIGN(DumpPool);
 };
@@ -250,6 +250,7 @@ static const std::string DUMP_NETSTATS_PROTO_TASK = "DUMP NETSTATS PROTO";
 static const std::string DUMP_HALS_TASK = "DUMP HALS";
 static const std::string DUMP_BOARD_TASK = "dumpstate_board()";
 static const std::string DUMP_CHECKINS_TASK = "DUMP CHECKINS";
+static const std::string DUMP_OPEN_FILES_TASK = "DUMP OPEN FILES";
 static const std::string SERIALIZE_PERFETTO_TRACE_TASK = "SERIALIZE PERFETTO TRACE";
 
 namespace android {
@@ -1594,6 +1595,10 @@ static void DumpstateLimitedOnly() {
  * Dumpstate can pick up later and output to the bugreport. Using STDOUT_FILENO
  * if it's not running in the parallel task.
  */
+static void DumpOpenFiles(int out_fd = STDOUT_FILENO) {
+    RunCommand("LIST OF OPEN FILES", {"lsof"}, CommandOptions::AS_ROOT, false, out_fd);
+}
+
 static void DumpCheckins(int out_fd = STDOUT_FILENO) {
     dprintf(out_fd, "========================================================\n");
     dprintf(out_fd, "== Checkins\n");
@@ -1664,13 +1669,16 @@ Dumpstate::RunStatus Dumpstate::dumpstate() {
 
     // Enqueue slow functions into the thread pool, if the parallel run is enabled.
     std::future<std::string> dump_hals, dump_incident_report, dump_board, dump_checkins,
-        dump_netstats_report;
+        dump_netstats_report, dump_open_files;
     if (ds.dump_pool_) {
         // Pool was shutdown in DumpstateDefaultAfterCritical method in order to
         // drop root user. Restarts it.
         ds.dump_pool_->start(/* thread_counts = */3);
 
         dump_hals = ds.dump_pool_->enqueueTaskWithFd(DUMP_HALS_TASK, &DumpHals, _1);
+        // Waited for early on, so queue it early as well.
+        dump_open_files = ds.dump_pool_->enqueueTaskWithFd(
+            DUMP_OPEN_FILES_TASK, &DumpOpenFiles, _1);
         dump_incident_report = ds.dump_pool_->enqueueTask(
             DUMP_INCIDENT_REPORT_TASK, &DumpIncidentReport);
         dump_netstats_report = ds.dump_pool_->enqueueTask(
@@ -1735,7 +1743,11 @@ Dumpstate::RunStatus Dumpstate::dumpstate() {
 
     DumpVintf();
 
-    RunCommand("LIST OF OPEN FILES", {"lsof"}, CommandOptions::AS_ROOT);
+    if (ds.dump_pool_) {
+        WAIT_TASK_WITH_CONSENT_CHECK(std::move(dump_open_files));
+    } else {
+        RUN_SLOW_FUNCTION_WITH_CONSENT_CHECK_AND_LOG(DUMP_OPEN_FILES_TASK, DumpOpenFiles);
+    }
 
     for_each_tid(show_wchan, "BLOCKED PROCESS WAIT-CHANNELS");
     for_each_pid(show_showtime, "PROCESS TIMES (pid cmd user system iowait+percentage)");
@@ -1891,6 +1903,10 @@ Dumpstate::RunStatus Dumpstate::dumpstate() {
                 DumpIncidentReport);
     }
 
+    if (ds.dump_pool_) {
+        ds.dump_pool_->dumpTaskStats(STDOUT_FILENO);
+    }
+
     MaybeAddUiTracesToZip();
 
     return Dumpstate::RunStatus::OK;
@@ -1782,6 +1782,23 @@ TEST_F(DumpPoolTest, EnqueueTask_withDurationLog) {
     EXPECT_THAT(getTempFileCounts(kTestDataPath), Eq(0));
 }
 
+TEST_F(DumpPoolTest, DumpTaskStats) {
+    setLogDuration(/* log_duration = */false);
+    auto t1 = dump_pool_->enqueueTask(/* duration_title = */"1", []() {});
+    auto t2 = dump_pool_->enqueueTaskWithFd(/* duration_title = */"2", [](int) {},
+            std::placeholders::_1);
+    WaitForTask(std::move(t1), "", out_fd_.get());
+    WaitForTask(std::move(t2), "", out_fd_.get());
+
+    dump_pool_->dumpTaskStats(out_fd_.get());
+
+    std::string result;
+    ReadFileToString(out_path_, &result);
+    EXPECT_THAT(result, HasSubstr("------ DUMP POOL TASKS ------\n"));
+    EXPECT_THAT(result, HasSubstr("\n1: queued "));
+    EXPECT_THAT(result, HasSubstr("\n2: queued "));
+}
+
 class TaskQueueTest : public DumpstateBaseTest {
 public:
     void SetUp() {
@@ -15,8 +15,11 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <iomanip>
+#include <mutex>
 #include <thread>
 
 #include <android-base/file.h>
@@ -39,6 +42,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/poll.h>
 #include <sys/socket.h>
 #include <sys/time.h>
@@ -66,7 +70,7 @@ static void usage() {
         "         To dump all services.\n"
         "or:\n"
         "       dumpsys [-t TIMEOUT] [--priority LEVEL] [--clients] [--dump] [--pid] [--thread] "
-        "[--help | "
+        "[--jobs N] [--help | "
         "-l | --skip SERVICES "
         "| SERVICE [ARGS]]\n"
         "         --help: shows this help\n"
@@ -75,6 +79,8 @@ static void usage() {
         "         -T TIMEOUT_MS: TIMEOUT to use in milliseconds instead of default 10 seconds\n"
         "         --clients: dump client PIDs instead of usual dump\n"
         "         --dump: ask the service to dump itself (this is the default)\n"
+        "         --jobs N: dump up to N services at a time; the output is still in\n"
+        "               service order\n"
         "         --pid: dump PID instead of usual dump\n"
         "         --proto: filter services that support dumping data in proto format. Dumps\n"
         "               will be in proto format.\n"
@@ -136,12 +142,14 @@ int Dumpsys::main(int argc, char* const argv[]) {
     int dumpTypeFlags = 0;
     int timeoutArgMs = 10000;
     int priorityFlags = IServiceManager::DUMP_FLAG_PRIORITY_ALL;
+    size_t jobs = 1;
     static struct option longOptions[] = {
         {"help", no_argument, 0, 0},           {"clients", no_argument, 0, 0},
         {"dump", no_argument, 0, 0},           {"pid", no_argument, 0, 0},
         {"priority", required_argument, 0, 0}, {"proto", no_argument, 0, 0},
         {"skip", no_argument, 0, 0},           {"stability", no_argument, 0, 0},
-        {"thread", no_argument, 0, 0},         {0, 0, 0, 0}};
+        {"thread", no_argument, 0, 0},         {"jobs", required_argument, 0, 0},
+        {0, 0, 0, 0}};
 
     // Must reset optind, otherwise subsequent calls will fail (wouldn't happen on main.cpp, but
     // happens on test cases).
@@ -182,6 +190,14 @@ int Dumpsys::main(int argc, char* const argv[]) {
                 dumpTypeFlags |= TYPE_THREAD;
             } else if (!strcmp(longOptions[optionIndex].name, "clients")) {
                 dumpTypeFlags |= TYPE_CLIENTS;
+            } else if (!strcmp(longOptions[optionIndex].name, "jobs")) {
+                char* endptr;
+                long jobsArg = strtol(optarg, &endptr, 10);
+                if (*endptr != '\0' || jobsArg <= 0) {
+                    fprintf(stderr, "Error: invalid number of jobs: '%s'\n", optarg);
+                    return -1;
+                }
+                jobs = jobsArg;
             }
             break;
 
@@ -271,6 +287,19 @@ int Dumpsys::main(int argc, char* const argv[]) {
         return 0;
     }
 
+    if (jobs > 1 && N > 1) {
+        Vector<String16> servicesToDump;
+        for (const String16& serviceName : services) {
+            if (!IsSkipped(skippedServices, serviceName)) {
+                servicesToDump.add(serviceName);
+            }
+        }
+        dumpServicesConcurrently(STDOUT_FILENO, servicesToDump, dumpTypeFlags, args,
+                                 priorityFlags, std::chrono::milliseconds(timeoutArgMs), asProto,
+                                 jobs);
+        return 0;
+    }
+
     for (size_t i = 0; i < N; i++) {
         const String16& serviceName = services[i];
         if (IsSkipped(skippedServices, serviceName)) continue;
@@ -304,6 +333,85 @@ int Dumpsys::main(int argc, char* const argv[]) {
     return 0;
 }
 
+void Dumpsys::dumpServicesConcurrently(int fd, const Vector<String16>& services,
+                                       int dumpTypeFlags, const Vector<String16>& args,
+                                       int priorityFlags, std::chrono::milliseconds timeout,
+                                       bool asProto, size_t jobs) const {
+    struct ServiceDump {
+        bool done = false;
+        bool started = false;
+        status_t status = OK;
+        std::chrono::duration<double> elapsedDuration{0};
+        unique_fd buffer;
+    };
+    std::vector<ServiceDump> dumps(services.size());
+    std::mutex lock;
+    std::condition_variable doneCondition;
+    std::atomic<size_t> nextService = 0;
+
+    // Each worker dumps the next service into a memfd, with a Dumpsys of its own, so that a slow
+    // service only holds up its own worker.
+    auto worker = [&]() {
+        for (size_t i = nextService++; i < services.size(); i = nextService++) {
+            ServiceDump dump;
+            Dumpsys dumpsys(sm_);
+            unique_fd buffer(memfd_create("dumpsys", MFD_CLOEXEC));
+            if (buffer.get() == -1) {
+                std::cerr << "Failed to create buffer to dump service " << services[i] << ": "
+                          << strerror(errno) << std::endl;
+            } else if (dumpsys.startDumpThread(dumpTypeFlags, services[i], args) == OK) {
+                size_t bytesWritten = 0;
+                dump.started = true;
+                dump.status = dumpsys.writeDump(buffer.get(), services[i], timeout, asProto,
+                                                dump.elapsedDuration, bytesWritten);
+                dumpsys.stopDumpThread(dump.status == OK);
+                dump.buffer = std::move(buffer);
+            }
+            dump.done = true;
+            std::lock_guard<std::mutex> guard(lock);
+            dumps[i] = std::move(dump);
+            doneCondition.notify_all();
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < std::min(jobs, services.size()); i++) {
+        workers.emplace_back(worker);
+    }
+
+    // Write the dumps out in order, as each one finishes.
+    for (size_t i = 0; i < services.size(); i++) {
+        ServiceDump dump;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            doneCondition.wait(guard, [&]() { return dumps[i].done; });
+            dump = std::move(dumps[i]);
+        }
+        if (!dump.started) {
+            continue;
+        }
+        writeDumpHeader(fd, services[i], priorityFlags);
+        lseek(dump.buffer.get(), 0, SEEK_SET);
+        char buf[4096];
+        ssize_t rc;
+        while ((rc = TEMP_FAILURE_RETRY(read(dump.buffer.get(), buf, sizeof(buf)))) > 0) {
+            if (!WriteFully(fd, buf, rc)) {
+                break;
+            }
+        }
+        if (dump.status == TIMED_OUT) {
+            std::string msg =
+                    StringPrintf("\n*** SERVICE '%s' DUMP TIMEOUT (%llums) EXPIRED ***\n\n",
+                                 String8(services[i]).c_str(), timeout.count());
+            WriteStringToFd(msg, fd);
+        }
+        writeDumpFooter(fd, services[i], dump.elapsedDuration);
+    }
+
+    for (std::thread& thread : workers) {
+        thread.join();
+    }
+}
+
 Vector<String16> Dumpsys::listServices(int priorityFilterFlags, bool filterByProto) const {
     Vector<String16> services = sm_->listServices(priorityFilterFlags);
     services.sort(sort_func);
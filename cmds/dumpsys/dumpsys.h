@@ -33,6 +33,25 @@ class Dumpsys {
      */
     int main(int argc, char* const argv[]);
 
+    /**
+     * Dumps services like {@code main} does without --jobs, but with up to {@code jobs} services
+     * dumping at a time. Each service dumps into a buffer of its own, and the buffers are written
+     * to {@code fd} in the order of {@code services}, each with its header and footer.
+     * @param fd file descriptor to write data
+     * @param services services to dump
+     * @param dumpTypeFlags operations to perform
+     * @param args list of arguments to pass to service dump method
+     * @param priorityFlags dump priority specified
+     * @param timeout timeout to terminate each dump if not completed
+     * @param asProto used to supresses additional output to the fd such as timeout
+     * error messages
+     * @param jobs maximum number of services dumping at a time
+     */
+    void dumpServicesConcurrently(int fd, const Vector<String16>& services, int dumpTypeFlags,
+                                  const Vector<String16>& args, int priorityFlags,
+                                  std::chrono::milliseconds timeout, bool asProto,
+                                  size_t jobs) const;
+
     /**
      * Returns a list of services.
      * @param priorityFlags filter services by specified priorities
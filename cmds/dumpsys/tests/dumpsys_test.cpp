@@ -454,6 +454,24 @@ TEST_F(DumpsysTest, DumpMultipleServices) {
     AssertDumped("running3", "dump3");
 }
 
+// Tests 'dumpsys --jobs 2', where a slow service must not reorder the output
+TEST_F(DumpsysTest, DumpMultipleServicesConcurrently) {
+    ExpectListServices({"running1", "stopped2", "running3", "running4"});
+    ExpectDumpAndHang("running1", 1, "dump1");
+    ExpectCheckService("stopped2", false);
+    ExpectDump("running3", "dump3");
+    ExpectDump("running4", "dump4");
+
+    CallMain({"--jobs", "2"});
+
+    AssertRunningServices({"running1", "running3", "running4"});
+    AssertDumped("running1", "dump1");
+    AssertStopped("stopped2");
+    AssertDumped("running3", "dump3");
+    AssertDumped("running4", "dump4");
+    AssertOutputFormat("(.|\n)*dump1(.|\n)*dump3(.|\n)*dump4(.|\n)*");
+}
+
 // Tests 'dumpsys --skip skipped3 skipped5', which should skip these services
 TEST_F(DumpsysTest, DumpWithSkip) {
     ExpectListServices({"running1", "stopped2", "skipped3", "running4", "skipped5"});
@@ -73,6 +73,33 @@ void CacheTracker::loadStats() {
     ATRACE_END();
 }
 
+void CacheTracker::loadStats(const std::vector<std::shared_ptr<CacheTracker>>& trackers) {
+    ATRACE_BEGIN("loadStats quota");
+    std::vector<std::string> paths;
+    std::vector<CacheTracker*> pathTrackers;
+    for (const auto& tracker : trackers) {
+        tracker->cacheUsed = 0;
+        if (tracker->loadQuotaStats()) {
+            continue;
+        }
+        tracker->cacheUsed = 0;
+        for (const auto& path : tracker->mDataPaths) {
+            paths.push_back(read_path_inode(path, "cache", kXattrInodeCache));
+            pathTrackers.push_back(tracker.get());
+            paths.push_back(read_path_inode(path, "code_cache", kXattrInodeCodeCache));
+            pathTrackers.push_back(tracker.get());
+        }
+    }
+    ATRACE_END();
+
+    ATRACE_BEGIN("loadStats tree");
+    std::vector<int64_t> sizes = calculate_tree_sizes(paths, kMaxTreeSizeThreads);
+    for (size_t i = 0; i < sizes.size(); i++) {
+        pathTrackers[i]->cacheUsed += sizes[i];
+    }
+    ATRACE_END();
+}
+
 bool CacheTracker::loadQuotaStats() {
     int cacheGid = multiuser_get_cache_gid(mUserId, mAppId);
     if (IsQuotaSupported(mUuid) && cacheGid != -1) {
@@ -172,7 +199,10 @@ void CacheTracker::loadItems() {
     ATRACE_END();
 
     ATRACE_BEGIN("sortItems");
-    auto cmp = [](std::shared_ptr<CacheItem> left, std::shared_ptr<CacheItem> right) {
+    // Compare by reference, copying the shared_ptrs would cost two atomic
+    // reference count updates per comparison.
+    auto cmp = [](const std::shared_ptr<CacheItem>& left,
+                  const std::shared_ptr<CacheItem>& right) {
         // TODO: sort dotfiles last
         // TODO: sort code_cache last
         if (left->modified != right->modified) {
@@ -20,6 +20,7 @@
 #include <memory>
 #include <string>
 #include <queue>
+#include <vector>
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -49,6 +50,10 @@ public:
     void loadStats();
     void loadItems();
 
+    // Same as calling loadStats() on each tracker, but measures the cache
+    // directories of all trackers without quota support in parallel.
+    static void loadStats(const std::vector<std::shared_ptr<CacheTracker>>& trackers);
+
     void ensureItems();
 
     int getCacheRatio();
@@ -66,6 +71,9 @@ private:
 
     std::vector<std::string> mDataPaths;
 
+    // The number of cache directory trees to measure at once in loadStats().
+    static constexpr size_t kMaxTreeSizeThreads = 4;
+
     bool loadQuotaStats();
     void loadItemsFrom(const std::string& path);
 
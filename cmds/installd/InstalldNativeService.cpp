@@ -2210,9 +2210,14 @@ binder::Status InstalldNativeService::freeCache(const std::optional<std::string>
         };
         std::priority_queue<std::shared_ptr<CacheTracker>,
                 std::vector<std::shared_ptr<CacheTracker>>, decltype(cmp)> queue(cmp);
+        std::vector<std::shared_ptr<CacheTracker>> loadedTrackers;
+        loadedTrackers.reserve(trackers.size());
         for (const auto& it : trackers) {
-            it.second->loadStats();
-            queue.push(it.second);
+            loadedTrackers.push_back(it.second);
+        }
+        CacheTracker::loadStats(loadedTrackers);
+        for (const auto& tracker : loadedTrackers) {
+            queue.push(tracker);
         }
         atrace_pm_end();
 
@@ -2419,7 +2424,44 @@ static void collectQuotaStats(const std::string& uuid, int32_t userId,
     }
 }
 
-static void collectManualStats(const std::string& path, struct stats* stats) {
+// Directory trees whose sizes collectManualStats() needs. They're measured together by run(), so
+// that the trees of all the packages of a call are walked in parallel.
+class TreeSizeJobs {
+public:
+    // Adds the size of the tree at |path| to |*dataSize|, and to |*cacheSize| unless it's null,
+    // when run.
+    void add(std::string path, int64_t* dataSize, int64_t* cacheSize) {
+        mPaths.push_back(std::move(path));
+        mTargets.push_back({dataSize, cacheSize});
+    }
+
+    void run() {
+        atrace_pm_begin("tree");
+        std::vector<int64_t> sizes = calculate_tree_sizes(mPaths, kMaxThreads);
+        for (size_t i = 0; i < sizes.size(); i++) {
+            *mTargets[i].dataSize += sizes[i];
+            if (mTargets[i].cacheSize != nullptr) {
+                *mTargets[i].cacheSize += sizes[i];
+            }
+        }
+        mPaths.clear();
+        mTargets.clear();
+        atrace_pm_end();
+    }
+
+private:
+    static constexpr size_t kMaxThreads = 4;
+
+    struct Target {
+        int64_t* dataSize;
+        int64_t* cacheSize;
+    };
+    std::vector<std::string> mPaths;
+    std::vector<Target> mTargets;
+};
+
+static void collectManualStats(const std::string& path, struct stats* stats,
+                               TreeSizeJobs* jobs) {
     DIR *d;
     int dfd;
     struct dirent *de;
@@ -2448,9 +2490,11 @@ static void collectManualStats(const std::string& path, struct stats* stats) {
                 // Don't recurse or count node size
                 continue;
             } else {
-                // Measure all children nodes
-                size = 0;
-                calculate_tree_size(StringPrintf("%s/%s", path.c_str(), name), &size);
+                // Measure all children nodes, everything found inside is considered data
+                const bool isCache = !strcmp(name, "cache") || !strcmp(name, "code_cache");
+                jobs->add(StringPrintf("%s/%s", path.c_str(), name), &stats->dataSize,
+                          isCache ? &stats->cacheSize : nullptr);
+                continue;
             }
 
             if (!strcmp(name, "cache") || !strcmp(name, "code_cache")) {
@@ -2469,16 +2513,17 @@ static void collectManualStats(const std::string& path, struct stats* stats) {
     closedir(d);
 }
 
-void collectManualStatsForSubDirectories(const std::string& path, struct stats* stats) {
-    const auto subDirHandler = [&path, &stats](const std::string& subDir) {
+void collectManualStatsForSubDirectories(const std::string& path, struct stats* stats,
+                                         TreeSizeJobs* jobs) {
+    const auto subDirHandler = [&path, &stats, jobs](const std::string& subDir) {
         auto fullpath = path + "/" + subDir;
-        collectManualStats(fullpath, stats);
+        collectManualStats(fullpath, stats, jobs);
     };
     foreach_subdir(path, subDirHandler);
 }
 
 static void collectManualStatsForUser(const std::string& path, struct stats* stats,
-                                      bool exclude_apps = false,
+                                      TreeSizeJobs* jobs, bool exclude_apps = false,
                                       bool is_sdk_sandbox_storage = false) {
     DIR *d;
     int dfd;
@@ -2508,9 +2553,9 @@ static void collectManualStatsForUser(const std::string& path, struct stats* sta
                 // In case of sdk sandbox storage (e.g. /data/misc_ce/0/sdksandbox/<package-name>),
                 // collect individual stats of each subdirectory (shared, storage of each sdk etc.)
                 collectManualStatsForSubDirectories(StringPrintf("%s/%s", path.c_str(), name),
-                                                    stats);
+                                                    stats, jobs);
             } else {
-                collectManualStats(StringPrintf("%s/%s", path.c_str(), name), stats);
+                collectManualStats(StringPrintf("%s/%s", path.c_str(), name), stats, jobs);
             }
         }
     }
@@ -2655,14 +2700,15 @@ binder::Status InstalldNativeService::getAppSize(const std::optional<std::string
         }
         atrace_pm_end();
 
+        TreeSizeJobs jobs;
         for (size_t i = 0; i < packageNames.size(); i++) {
             const char* pkgname = packageNames[i].c_str();
 
             atrace_pm_begin("data");
             auto cePath = create_data_user_ce_package_path(uuid_, userId, pkgname, ceDataInodes[i]);
-            collectManualStats(cePath, &stats);
+            collectManualStats(cePath, &stats, &jobs);
             auto dePath = create_data_user_de_package_path(uuid_, userId, pkgname);
-            collectManualStats(dePath, &stats);
+            collectManualStats(dePath, &stats, &jobs);
             atrace_pm_end();
 
             // In case of sdk sandbox storage (e.g. /data/misc_ce/0/sdksandbox/<package-name>),
@@ -2671,10 +2717,10 @@ binder::Status InstalldNativeService::getAppSize(const std::optional<std::string
                 atrace_pm_begin("sdksandbox");
                 auto sdkSandboxCePath =
                         create_data_misc_sdk_sandbox_package_path(uuid_, true, userId, pkgname);
-                collectManualStatsForSubDirectories(sdkSandboxCePath, &stats);
+                collectManualStatsForSubDirectories(sdkSandboxCePath, &stats, &jobs);
                 auto sdkSandboxDePath =
                         create_data_misc_sdk_sandbox_package_path(uuid_, false, userId, pkgname);
-                collectManualStatsForSubDirectories(sdkSandboxDePath, &stats);
+                collectManualStatsForSubDirectories(sdkSandboxDePath, &stats, &jobs);
                 atrace_pm_end();
             }
 
@@ -2691,11 +2737,12 @@ binder::Status InstalldNativeService::getAppSize(const std::optional<std::string
 
             atrace_pm_begin("external");
             auto extPath = create_data_media_package_path(uuid_, userId, "data", pkgname);
-            collectManualStats(extPath, &extStats);
+            collectManualStats(extPath, &extStats, &jobs);
             auto mediaPath = create_data_media_package_path(uuid_, userId, "media", pkgname);
             calculate_tree_size(mediaPath, &extStats.dataSize);
             atrace_pm_end();
         }
+        jobs.run();
 
         if (!uuid) {
             atrace_pm_begin("dalvik");
@@ -2856,10 +2903,12 @@ binder::Status InstalldNativeService::getUserSize(const std::optional<std::strin
         atrace_pm_end();
 
         atrace_pm_begin("data");
+        TreeSizeJobs jobs;
         auto cePath = create_data_user_ce_path(uuid_, userId);
-        collectManualStatsForUser(cePath, &stats, true);
+        collectManualStatsForUser(cePath, &stats, &jobs, true);
         auto dePath = create_data_user_de_path(uuid_, userId);
-        collectManualStatsForUser(dePath, &stats, true);
+        collectManualStatsForUser(dePath, &stats, &jobs, true);
+        jobs.run();
         atrace_pm_end();
 
         if (!uuid) {
@@ -2904,19 +2953,22 @@ binder::Status InstalldNativeService::getUserSize(const std::optional<std::strin
         atrace_pm_end();
 
         atrace_pm_begin("data");
+        TreeSizeJobs jobs;
         auto cePath = create_data_user_ce_path(uuid_, userId);
-        collectManualStatsForUser(cePath, &stats);
+        collectManualStatsForUser(cePath, &stats, &jobs);
         auto dePath = create_data_user_de_path(uuid_, userId);
-        collectManualStatsForUser(dePath, &stats);
+        collectManualStatsForUser(dePath, &stats, &jobs);
         atrace_pm_end();
 
         atrace_pm_begin("sdksandbox");
         auto sdkSandboxCePath = create_data_misc_sdk_sandbox_path(uuid_, true, userId);
-        collectManualStatsForUser(sdkSandboxCePath, &stats, false, true);
+        collectManualStatsForUser(sdkSandboxCePath, &stats, &jobs, false, true);
         auto sdkSandboxDePath = create_data_misc_sdk_sandbox_path(uuid_, false, userId);
-        collectManualStatsForUser(sdkSandboxDePath, &stats, false, true);
+        collectManualStatsForUser(sdkSandboxDePath, &stats, &jobs, false, true);
         atrace_pm_end();
 
+        jobs.run();
+
         if (!uuid) {
             atrace_pm_begin("profile");
             auto userProfilePath = create_primary_cur_profile_dir_path(userId);
@@ -3638,6 +3690,33 @@ binder::Status InstalldNativeService::hashSecondaryDexFile(
         dexPath, packageName, uid, volumeUuid, storageFlag, _aidl_return);
     return result ? ok() : error();
 }
+
+binder::Status InstalldNativeService::hashSecondaryDexFiles(
+        const std::vector<std::string>& dexPaths, const std::string& packageName, int32_t uid,
+        const std::optional<std::string>& volumeUuid, int32_t storageFlag,
+        std::vector<uint8_t>* _aidl_return) {
+    ENFORCE_UID(AID_SYSTEM);
+    CHECK_ARGUMENT_UUID(volumeUuid);
+    CHECK_ARGUMENT_PACKAGE_NAME(packageName);
+    for (const auto& dexPath : dexPaths) {
+        CHECK_ARGUMENT_PATH(dexPath);
+    }
+
+    // mLock is not taken here for the same reason as in hashSecondaryDexFile.
+    std::vector<std::vector<uint8_t>> hashes;
+    bool result = android::installd::hash_secondary_dex_files(
+        dexPaths, packageName, uid, volumeUuid, storageFlag, &hashes);
+
+    // Flatten the hashes, leaving zeros for the files that have none.
+    constexpr size_t kHashSize = 32;  // SHA-256
+    _aidl_return->assign(hashes.size() * kHashSize, 0);
+    for (size_t i = 0; i < hashes.size(); i++) {
+        if (hashes[i].size() == kHashSize) {
+            std::copy(hashes[i].begin(), hashes[i].end(), _aidl_return->begin() + i * kHashSize);
+        }
+    }
+    return result ? ok() : error();
+}
 /**
  * Returns true if ioctl feature (F2FS_IOC_FS{GET,SET}XATTR) is supported as
  * these were introduced in Linux 4.14, so kernel versions before that will fail
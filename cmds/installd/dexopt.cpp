@@ -29,6 +29,8 @@
 #include <unistd.h>
 
 #include <array>
+#include <chrono>
+#include <condition_variable>
 #include <iomanip>
 #include <mutex>
 #include <unordered_set>
@@ -153,6 +155,87 @@ class DexOptStatus {
 
 android::base::NoDestructor<DexOptStatus> dexopt_status_;
 
+// Limits how many dex2oat processes run at the same time while the device is under memory
+// pressure. Callers decide how many packages to compile concurrently, which is fine until memory
+// gets tight; then more concurrent dex2oat processes, each with its own large heap, only add to
+// the thrashing. Without pressure, or if the pressure can't be read, nothing is limited.
+class Dex2oatThrottle {
+ public:
+    // Waits until a dex2oat process may start. Gives up waiting after kMaxWaitMs, so that a call
+    // is never held long enough to trip the package manager's watchdog, and when dexopt gets
+    // blocked, so that the caller sees the cancellation right away.
+    void acquire() {
+        std::unique_lock<std::mutex> lock(lock_);
+        const auto deadline =
+                std::chrono::steady_clock::now() + std::chrono::milliseconds(kMaxWaitMs);
+        while (running_ >= kMaxRunningUnderPressure && is_under_memory_pressure_locked() &&
+               !dexopt_status_->is_dexopt_blocked()) {
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) {
+                LOG(WARNING) << "Starting dex2oat under memory pressure after waiting "
+                             << kMaxWaitMs << "ms, " << running_ << " already running";
+                break;
+            }
+            cv_.wait_until(lock, std::min(deadline, now + std::chrono::milliseconds(kPollMs)));
+        }
+        running_++;
+    }
+
+    void release() {
+        std::lock_guard<std::mutex> lock(lock_);
+        running_--;
+        cv_.notify_one();
+    }
+
+ private:
+    // Reads the "full" memory pressure stall information at most every kPollMs. "full" is the
+    // share of time in which all non-idle tasks were stalled on memory.
+    bool is_under_memory_pressure_locked() {
+        const auto now = std::chrono::steady_clock::now();
+        if (now - pressure_read_time_ < std::chrono::milliseconds(kPollMs)) {
+            return under_pressure_;
+        }
+        pressure_read_time_ = now;
+        under_pressure_ = false;
+        std::string pressure;
+        if (!android::base::ReadFileToString("/proc/pressure/memory", &pressure)) {
+            return false;
+        }
+        const size_t full = pressure.find("full avg10=");
+        if (full != std::string::npos) {
+            under_pressure_ = strtod(pressure.c_str() + full + strlen("full avg10="), nullptr) >=
+                    kFullPressureThreshold;
+        }
+        return under_pressure_;
+    }
+
+    // Percentage of time stalled on memory over the last 10s above which the device is considered
+    // under memory pressure.
+    static constexpr double kFullPressureThreshold = 10.0;
+    static constexpr size_t kMaxRunningUnderPressure = 1;
+    static constexpr int kMaxWaitMs = 60000;
+    static constexpr int kPollMs = 1000;
+
+    // Guards the members below.
+    std::mutex lock_;
+    std::condition_variable cv_;
+    size_t running_ = 0;
+    bool under_pressure_ = false;
+    std::chrono::steady_clock::time_point pressure_read_time_;
+};
+
+android::base::NoDestructor<Dex2oatThrottle> dex2oat_throttle_;
+
+// Holds one of the dex2oat_throttle_ slots for its lifetime.
+class ScopedDex2oatThrottle {
+ public:
+    ScopedDex2oatThrottle() { dex2oat_throttle_->acquire(); }
+    ~ScopedDex2oatThrottle() { dex2oat_throttle_->release(); }
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(ScopedDex2oatThrottle);
+};
+
 } // namespace
 
 namespace android {
@@ -1968,6 +2051,7 @@ int dexopt(const char* dex_path, uid_t uid, const char* pkgname, const char* ins
                       enable_hidden_api_checks, generate_compact_dex, compile_without_image,
                       background_job_compile, compilation_reason);
 
+    ScopedDex2oatThrottle throttle;
     bool cancelled = false;
     pid_t pid = dexopt_status_->check_cancellation_and_fork(&cancelled);
     if (cancelled) {
@@ -2219,24 +2303,15 @@ bool reconcile_secondary_dex_file(const std::string& dex_path,
 // Also returns true with an empty hash if the file does not currently exist or is not accessible to
 // the app.
 // For any other errors (e.g. if any of the parameters are invalid) returns false.
-bool hash_secondary_dex_file(const std::string& dex_path, const std::string& pkgname, int uid,
-        const std::optional<std::string>& volume_uuid, int storage_flag,
-        std::vector<uint8_t>* out_secondary_dex_hash) {
-    out_secondary_dex_hash->clear();
-
-    const char* volume_uuid_cstr = volume_uuid ? volume_uuid->c_str() : nullptr;
-
-    if (storage_flag != FLAG_STORAGE_CE && storage_flag != FLAG_STORAGE_DE) {
-        LOG(ERROR) << "hash_secondary_dex_file called with invalid storage_flag: "
-                << storage_flag;
-        return false;
-    }
-
+// Forks a child that hashes the secondary dex file at dex_path with the app's credentials, and
+// writes the hash to out_pipe_read. Returns the pid of the child, or -1 if it couldn't be started.
+static pid_t start_hash_secondary_dex_child(const std::string& dex_path,
+        const std::string& pkgname, int uid, const char* volume_uuid_cstr, int storage_flag, unique_fd* out_pipe_read) {
     // Pipe to get the hash result back from our child process.
     unique_fd pipe_read, pipe_write;
     if (!Pipe(&pipe_read, &pipe_write)) {
         PLOG(ERROR) << "Failed to create pipe";
-        return false;
+        return -1;
     }
 
     // Fork so that actual access to the files is done in the app's own UID, to ensure we only
@@ -2292,8 +2367,18 @@ bool hash_secondary_dex_file(const std::string& dex_path, const std::string& pkg
     }
 
     // parent
-    pipe_write.reset();
+    if (pid == -1) {
+        PLOG(ERROR) << "Failed to fork to hash secondary dex " << dex_path;
+        return -1;
+    }
+    *out_pipe_read = std::move(pipe_read);
+    return pid;
+}
 
+// Reads the hash written by a child started with start_hash_secondary_dex_child, and waits for it
+// to exit. Returns false if the child failed.
+static bool finish_hash_secondary_dex_child(pid_t pid, unique_fd pipe_read,
+        std::vector<uint8_t>* out_secondary_dex_hash) {
     out_secondary_dex_hash->resize(SHA256_DIGEST_LENGTH);
     if (!ReadFully(pipe_read, out_secondary_dex_hash->data(), out_secondary_dex_hash->size())) {
         out_secondary_dex_hash->clear();
@@ -2301,6 +2386,71 @@ bool hash_secondary_dex_file(const std::string& dex_path, const std::string& pkg
     return wait_child_with_timeout(pid, kShortTimeoutMs) == 0;
 }
 
+bool hash_secondary_dex_file(const std::string& dex_path, const std::string& pkgname, int uid,
+        const std::optional<std::string>& volume_uuid, int storage_flag,
+        std::vector<uint8_t>* out_secondary_dex_hash) {
+    out_secondary_dex_hash->clear();
+
+    const char* volume_uuid_cstr = volume_uuid ? volume_uuid->c_str() : nullptr;
+
+    if (storage_flag != FLAG_STORAGE_CE && storage_flag != FLAG_STORAGE_DE) {
+        LOG(ERROR) << "hash_secondary_dex_file called with invalid storage_flag: "
+                << storage_flag;
+        return false;
+    }
+
+    unique_fd pipe_read;
+    pid_t pid = start_hash_secondary_dex_child(dex_path, pkgname, uid, volume_uuid_cstr,
+            storage_flag, &pipe_read);
+    if (pid == -1) {
+        return false;
+    }
+    return finish_hash_secondary_dex_child(pid, std::move(pipe_read), out_secondary_dex_hash);
+}
+
+bool hash_secondary_dex_files(const std::vector<std::string>& dex_paths,
+        const std::string& pkgname, int uid, const std::optional<std::string>& volume_uuid,
+        int storage_flag, std::vector<std::vector<uint8_t>>* out_secondary_dex_hashes) {
+    out_secondary_dex_hashes->assign(dex_paths.size(), {});
+
+    const char* volume_uuid_cstr = volume_uuid ? volume_uuid->c_str() : nullptr;
+
+    if (storage_flag != FLAG_STORAGE_CE && storage_flag != FLAG_STORAGE_DE) {
+        LOG(ERROR) << "hash_secondary_dex_files called with invalid storage_flag: "
+                << storage_flag;
+        return false;
+    }
+
+    // Hash up to kMaxParallelHashChildren files at a time, each in its own child, so that reading
+    // one file doesn't wait for the previous one.
+    constexpr size_t kMaxParallelHashChildren = 4;
+    struct HashChild {
+        size_t index;
+        pid_t pid;
+        unique_fd pipe_read;
+    };
+    bool result = true;
+    for (size_t start = 0; start < dex_paths.size(); start += kMaxParallelHashChildren) {
+        const size_t end = std::min(dex_paths.size(), start + kMaxParallelHashChildren);
+        std::vector<HashChild> children;
+        for (size_t i = start; i < end; i++) {
+            unique_fd pipe_read;
+            pid_t pid = start_hash_secondary_dex_child(dex_paths[i], pkgname, uid,
+                    volume_uuid_cstr, storage_flag, &pipe_read);
+            if (pid == -1) {
+                result = false;
+                continue;
+            }
+            children.push_back({i, pid, std::move(pipe_read)});
+        }
+        for (HashChild& child : children) {
+            result = finish_hash_secondary_dex_child(child.pid, std::move(child.pipe_read),
+                    &(*out_secondary_dex_hashes)[child.index]) && result;
+        }
+    }
+    return result;
+}
+
 // Helper for move_ab, so that we can have common failure-case cleanup.
 static bool unlink_and_rename(const char* from, const char* to) {
     // Check whether "from" exists, and if so whether it's regular. If it is, unlink. Otherwise,
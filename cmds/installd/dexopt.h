@@ -119,6 +119,11 @@ bool hash_secondary_dex_file(const std::string& dex_path,
         const std::string& pkgname, int uid, const std::optional<std::string>& volume_uuid,
         int storage_flag, std::vector<uint8_t>* out_secondary_dex_hash);
 
+// Same as hash_secondary_dex_file for each of dex_paths, hashing several files in parallel.
+bool hash_secondary_dex_files(const std::vector<std::string>& dex_paths,
+        const std::string& pkgname, int uid, const std::optional<std::string>& volume_uuid,
+        int storage_flag, std::vector<std::vector<uint8_t>>* out_secondary_dex_hashes);
+
 // completed pass false if it is canceled. Otherwise it will be true even if there is other
 // error.
 int dexopt(const char *apk_path, uid_t uid, const char *pkgName, const char *instruction_set,
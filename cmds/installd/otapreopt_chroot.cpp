@@ -14,6 +14,7 @@
  ** limitations under the License.
  */
 
+#include <dirent.h>
 #include <fcntl.h>
 #include <linux/unistd.h>
 #include <sys/mount.h>
@@ -25,11 +26,13 @@
 #include <array>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <sstream>
 
 #include <android-base/file.h>
 #include <android-base/logging.h>
 #include <android-base/macros.h>
+#include <android-base/properties.h>
 #include <android-base/scopeguard.h>
 #include <android-base/stringprintf.h>
 #include <android-base/strings.h>
@@ -134,6 +137,79 @@ static void TryExtraMount(const char* name, const char* slot, const char* target
     (void)TryMountWithFstypes(block_device.c_str(), target);
 }
 
+// How many otapreopt processes run at a time. Each one spends part of its run reading the APK and
+// writing the artifacts, so a second one keeps the CPUs busy meanwhile.
+static constexpr size_t kDefaultMaxConcurrentOtapreopt = 2;
+
+static size_t GetMaxConcurrentOtapreopt() {
+    return std::max<size_t>(1, android::base::GetUintProperty<size_t>(
+                                       "ro.otapreopt.max_concurrent_jobs",
+                                       kDefaultMaxConcurrentOtapreopt));
+}
+
+// Asks the kernel to start reading a file into the page cache.
+static void ReadAhead(const std::string& path) {
+    android::base::unique_fd fd(open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    if (fd < 0) {
+        return;
+    }
+    if (posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED) != 0) {
+        PLOG(WARNING) << "Failed to read ahead " << path;
+    }
+}
+
+// Reads ahead the APK and the reference profiles of a dexopt command, so that its otapreopt
+// doesn't have to wait for them while the running ones compile. The parameters are
+//
+//   [version] "dexopt" apk-path uid package-name ...
+static void ReadAheadDexoptInputs(const std::vector<std::string>& cmd) {
+    auto dexopt = std::find(cmd.begin(), cmd.end(), "dexopt");
+    if (std::distance(dexopt, cmd.end()) < 4) {
+        return;
+    }
+    const std::string& apk_path = *(dexopt + 1);
+    const std::string& package_name = *(dexopt + 3);
+    ReadAhead(apk_path);
+
+    if (package_name.find('/') != std::string::npos) {
+        return;
+    }
+    const std::string profile_dir = "/data/misc/profiles/ref/" + package_name;
+    DIR* dir = opendir(profile_dir.c_str());
+    if (dir == nullptr) {
+        return;
+    }
+    for (dirent* entry = readdir(dir); entry != nullptr; entry = readdir(dir)) {
+        if (entry->d_type == DT_REG) {
+            ReadAhead(profile_dir + "/" + entry->d_name);
+        }
+    }
+    closedir(dir);
+}
+
+// Reads the next dexopt command from stdin and turns it into an otapreopt command line. Commands
+// that are too long are skipped, and reported as done through done_count. Returns false on EOF.
+static bool ReadDexoptCommand(const char* slot_suffix, int* done_count,
+                              std::vector<std::string>* cmd) {
+    for (std::array<char, 10000> linebuf;
+         std::cin.clear(), std::cin.getline(&linebuf[0], linebuf.size());) {
+        // Subtract one from gcount() since getline() counts the newline.
+        std::string line(&linebuf[0], std::cin.gcount() - 1);
+
+        if (std::cin.fail()) {
+            LOG(ERROR) << "Command exceeds max length " << linebuf.size() << " - skipped: " << line;
+            std::cout << ++*done_count << std::endl;
+            continue;
+        }
+
+        std::vector<std::string> tokenized_line = android::base::Tokenize(line, " ");
+        *cmd = {"/system/bin/otapreopt", slot_suffix};
+        std::move(tokenized_line.begin(), tokenized_line.end(), std::back_inserter(*cmd));
+        return true;
+    }
+    return false;
+}
+
 // Entry for otapreopt_chroot. Expected parameters are:
 //
 //   [cmd] [status-fd] [target-slot-suffix]
@@ -143,9 +219,9 @@ static void TryExtraMount(const char* name, const char* slot, const char* target
 //
 //   "dexopt" [dexopt-params]
 //
-// are then read from stdin until EOF and passed on to /system/bin/otapreopt one
-// by one. After each call a line with the current command count is written to
-// stdout and flushed.
+// are then read from stdin until EOF and passed on to /system/bin/otapreopt, a
+// few at a time. After each call a line with the count of finished commands is
+// written to stdout and flushed.
 static int otapreopt_chroot(const int argc, char **arg) {
     // Validate arguments
     if (argc == 2 && std::string_view(arg[1]) == "--version") {
@@ -350,34 +426,56 @@ static int otapreopt_chroot(const int argc, char **arg) {
         exit(218);
     }
 
-    // Now go on and read dexopt lines from stdin and pass them on to otapreopt.
-
-    int count = 1;
-    for (std::array<char, 10000> linebuf;
-         std::cin.clear(), std::cin.getline(&linebuf[0], linebuf.size()); ++count) {
-        // Subtract one from gcount() since getline() counts the newline.
-        std::string line(&linebuf[0], std::cin.gcount() - 1);
+    // Now go on and read dexopt lines from stdin and pass them on to otapreopt. While the running
+    // otapreopt processes compile, the inputs of the command that starts next are read ahead.
+    const size_t max_concurrent = GetMaxConcurrentOtapreopt();
+    std::map<pid_t, std::string> running;
+    int started_count = 0;
+    int done_count = 0;
+    std::vector<std::string> next_cmd;
+    bool has_next = ReadDexoptCommand(slot_suffix, &done_count, &next_cmd);
+    while (has_next || !running.empty()) {
+        while (has_next && running.size() < max_concurrent) {
+            std::string command_line = android::base::Join(next_cmd, " ");
+            LOG(INFO) << "Command " << ++started_count << ": " << command_line;
+
+            // Fork and execute otapreopt in its own process.
+            std::string error_msg;
+            pid_t pid = ForkExec(next_cmd, &error_msg);
+            if (pid == -1) {
+                LOG(ERROR) << "Running otapreopt failed: " << error_msg;
+                std::cout << ++done_count << std::endl;
+            } else {
+                running.emplace(pid, std::move(command_line));
+            }
 
-        if (std::cin.fail()) {
-            LOG(ERROR) << "Command exceeds max length " << linebuf.size() << " - skipped: " << line;
+            has_next = ReadDexoptCommand(slot_suffix, &done_count, &next_cmd);
+            if (has_next) {
+                ReadAheadDexoptInputs(next_cmd);
+            }
+        }
+        if (running.empty()) {
             continue;
         }
 
-        std::vector<std::string> tokenized_line = android::base::Tokenize(line, " ");
-        std::vector<std::string> cmd{"/system/bin/otapreopt", slot_suffix};
-        std::move(tokenized_line.begin(), tokenized_line.end(), std::back_inserter(cmd));
-
-        LOG(INFO) << "Command " << count << ": " << android::base::Join(cmd, " ");
-
-        // Fork and execute otapreopt in its own process.
-        std::string error_msg;
-        bool exec_result = Exec(cmd, &error_msg);
-        if (!exec_result) {
-            LOG(ERROR) << "Running otapreopt failed: " << error_msg;
+        int status;
+        pid_t pid = TEMP_FAILURE_RETRY(waitpid(-1, &status, 0));
+        if (pid == -1) {
+            PLOG(ERROR) << "Failed waiting for otapreopt";
+            break;
+        }
+        auto it = running.find(pid);
+        if (it == running.end()) {
+            continue;
+        }
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            LOG(ERROR) << "Running otapreopt failed: Failed execv(" << it->second
+                       << ") because non-0 exit status";
         }
+        running.erase(it);
 
         // Print the count to stdout and flush to indicate progress.
-        std::cout << count << std::endl;
+        std::cout << ++done_count << std::endl;
     }
 
     LOG(INFO) << "No more dexopt commands";
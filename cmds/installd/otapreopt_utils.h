@@ -17,6 +17,8 @@
 #ifndef OTAPREOPT_UTILS_H_
 #define OTAPREOPT_UTILS_H_
 
+#include <sys/types.h>
+
 #include <regex>
 #include <string>
 #include <vector>
@@ -30,6 +32,10 @@ static inline bool ValidateTargetSlotSuffix(const std::string& input) {
     return std::regex_match(input, slot_suffix_match, slot_suffix_regex);
 }
 
+// Wrapper on fork/execv to start a command in a subprocess. Returns the pid of the subprocess, or
+// -1 with error_msg set if it could not be forked.
+pid_t ForkExec(const std::vector<std::string>& arg_vector, std::string* error_msg);
+
 // Wrapper on fork/execv to run a command in a subprocess.
 bool Exec(const std::vector<std::string>& arg_vector, std::string* error_msg);
 
@@ -465,6 +465,39 @@ TEST_F(ServiceTest, HashSecondaryDex_WrongApp) {
         dexPath, "com.wrong", 10000, testUuid, FLAG_STORAGE_CE, &result));
 }
 
+TEST_F(ServiceTest, HashSecondaryDexFiles) {
+    LOG(INFO) << "HashSecondaryDexFiles";
+
+    mkdir("user/0/com.example", 10000, 10000, 0700);
+    mkdir("user/0/com.example/foo", 10000, 10000, 0700);
+    std::vector<std::string> dexPaths;
+    for (int i = 0; i < 6; i++) {
+        std::string file = StringPrintf("user/0/com.example/foo/file%d", i);
+        if (i != 3) {
+            touch(file, 10000, 20000, 0700);
+        }
+        dexPaths.push_back(get_full_path(file));
+    }
+
+    std::vector<uint8_t> result;
+    EXPECT_BINDER_SUCCESS(service->hashSecondaryDexFiles(
+        dexPaths, "com.example", 10000, testUuid, FLAG_STORAGE_CE, &result));
+
+    ASSERT_EQ(result.size(), 6U * 32U);
+    std::vector<uint8_t> hash;
+    for (int i = 0; i < 6; i++) {
+        EXPECT_BINDER_SUCCESS(service->hashSecondaryDexFile(
+            dexPaths[i], "com.example", 10000, testUuid, FLAG_STORAGE_CE, &hash));
+        if (hash.empty()) {
+            hash.assign(32, 0);
+        }
+        EXPECT_EQ(std::vector<uint8_t>(result.begin() + i * 32, result.begin() + (i + 1) * 32),
+                  hash) << i;
+    }
+    EXPECT_EQ(std::vector<uint8_t>(result.begin() + 3 * 32, result.begin() + 4 * 32),
+              std::vector<uint8_t>(32, 0));
+}
+
 TEST_F(ServiceTest, CalculateOat) {
     char buf[PKG_PATH_MAX];
 
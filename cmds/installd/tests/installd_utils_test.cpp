@@ -757,5 +757,31 @@ TEST_F(UtilsTest, RemoveFileAtFd) {
     close(fd);
 }
 
+TEST_F(UtilsTest, CalculateTreeSizes) {
+    system("rm -rf /data/local/tmp/tree_sizes");
+    system("mkdir -p /data/local/tmp/tree_sizes/a/sub /data/local/tmp/tree_sizes/b");
+    system("head -c 100000 /dev/zero > /data/local/tmp/tree_sizes/a/sub/file");
+    system("head -c 10000 /dev/zero > /data/local/tmp/tree_sizes/b/file");
+    auto cleanup = android::base::make_scope_guard(
+            [] { system("rm -rf /data/local/tmp/tree_sizes"); });
+
+    const std::vector<std::string> paths = {
+            "/data/local/tmp/tree_sizes/a",
+            "/data/local/tmp/tree_sizes/missing",
+            "/data/local/tmp/tree_sizes/b",
+    };
+    for (size_t maxThreads : {1, 2, 8}) {
+        std::vector<int64_t> sizes = calculate_tree_sizes(paths, maxThreads);
+        ASSERT_EQ(sizes.size(), paths.size());
+        for (size_t i = 0; i < paths.size(); i++) {
+            int64_t expected = 0;
+            calculate_tree_size(paths[i], &expected);
+            EXPECT_EQ(sizes[i], expected) << paths[i] << " with " << maxThreads << " threads";
+        }
+    }
+    EXPECT_GT(calculate_tree_sizes(paths, 2)[0], 100000);
+    EXPECT_EQ(calculate_tree_sizes(paths, 2)[1], 0);
+}
+
 }  // namespace installd
 }  // namespace android
@@ -42,6 +42,10 @@
 #include <private/android_filesystem_config.h>
 #include <private/android_projectid_config.h>
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 #include "dexopt_return_codes.h"
 #include "globals.h"  // extern variables.
 #include "QuotaUtils.h"
@@ -517,6 +521,29 @@ int calculate_tree_size(const std::string& path, int64_t* size,
     return 0;
 }
 
+std::vector<int64_t> calculate_tree_sizes(const std::vector<std::string>& paths,
+        size_t max_threads) {
+    std::vector<int64_t> sizes(paths.size(), 0);
+    // Each thread takes the next tree that nobody has started walking yet, so that a few large
+    // trees don't leave the other threads idle.
+    std::atomic<size_t> next_index(0);
+    auto walk = [&]() {
+        for (size_t i = next_index++; i < paths.size(); i = next_index++) {
+            calculate_tree_size(paths[i], &sizes[i]);
+        }
+    };
+    const size_t num_threads = std::min(max_threads, paths.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < num_threads; i++) {
+        threads.emplace_back(walk);
+    }
+    walk();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    return sizes;
+}
+
 /**
  * Checks whether the package name is valid. Returns -1 on error and
  * 0 on success.
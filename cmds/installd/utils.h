@@ -120,6 +120,12 @@ std::vector<userid_t> get_known_users(const char* volume_uuid);
 int calculate_tree_size(const std::string& path, int64_t* size,
         int32_t include_gid = -1, int32_t exclude_gid = -1, bool exclude_apps = false);
 
+// Calculates the size of each of |paths| like calculate_tree_size() with the default filters,
+// walking up to |max_threads| of the trees at the same time. Returns the sizes in the order of
+// |paths|, 0 for the ones that could not be walked.
+std::vector<int64_t> calculate_tree_sizes(const std::vector<std::string>& paths,
+        size_t max_threads);
+
 int create_user_config_path(char path[PKG_PATH_MAX], userid_t userid);
 
 bool is_valid_filename(const std::string& name);
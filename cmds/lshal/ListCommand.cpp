@@ -19,6 +19,7 @@
 #include <getopt.h>
 
 #include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <functional>
 #include <iomanip>
@@ -26,6 +27,7 @@
 #include <map>
 #include <regex>
 #include <sstream>
+#include <thread>
 
 #include <android-base/file.h>
 #include <android-base/hex.h>
@@ -54,6 +56,9 @@ using ::android::hidl::manager::V1_0::IServiceManager;
 namespace android {
 namespace lshal {
 
+// Maximum number of binderized HAL entries that are fetched at the same time.
+static constexpr size_t kMaxFetchBinderizedThreads = 8;
+
 vintf::SchemaType toSchemaType(Partition p) {
     return (p == Partition::SYSTEM) ? vintf::SchemaType::FRAMEWORK : vintf::SchemaType::DEVICE;
 }
@@ -211,6 +216,10 @@ bool ListCommand::getPidInfo(
 }
 
 const BinderPidInfo* ListCommand::getPidInfoCached(pid_t serverPid) {
+    // Entries of the same server share its binder state, so it is parsed only once even when
+    // entries are fetched concurrently. Entries are never erased, so the returned pointer stays
+    // valid after the lock is released.
+    std::lock_guard<std::mutex> lock(mCachedPidInfosLock);
     auto pair = mCachedPidInfos.insert({serverPid, BinderPidInfo{}});
     if (pair.second /* did insertion take place? */) {
         if (!getPidInfo(serverPid, &pair.first->second)) {
@@ -619,7 +628,6 @@ Status ListCommand::fetchBinderized(const sp<IServiceManager> &manager) {
         return DUMP_BINDERIZED_ERROR;
     }
 
-    Status status = OK;
     std::map<std::string, TableEntry> allTableEntries;
     for (const auto& fqInstanceName : *fqInstanceNames) {
         // create entry and default assign all fields.
@@ -627,8 +635,42 @@ Status ListCommand::fetchBinderized(const sp<IServiceManager> &manager) {
         entry.interfaceName = fqInstanceName;
         entry.transport = mode;
         entry.serviceStatus = ServiceStatus::NON_RESPONSIVE;
+    }
+
+    // Each entry needs several IPCs to its server, and a slow or hung server would otherwise
+    // delay every entry after it by up to the IPC timeout. Query the entries concurrently, and
+    // emit their warnings afterwards in the same order as a serial run would.
+    struct PendingEntry {
+        TableEntry* entry;
+        std::stringstream warnings;
+        Status status = OK;
+    };
+    std::vector<PendingEntry> pendingEntries(allTableEntries.size());
+    size_t index = 0;
+    for (auto& pair : allTableEntries) {
+        pendingEntries[index++].entry = &pair.second;
+    }
+    std::atomic_size_t nextEntry = 0;
+    const auto fetchPendingEntries = [&] {
+        for (size_t i = nextEntry++; i < pendingEntries.size(); i = nextEntry++) {
+            auto& pending = pendingEntries[i];
+            pending.status = fetchBinderizedEntry(manager, pending.entry, pending.warnings);
+        }
+    };
+    const size_t numThreads = std::min(kMaxFetchBinderizedThreads, pendingEntries.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < numThreads; ++i) {
+        threads.emplace_back(fetchPendingEntries);
+    }
+    fetchPendingEntries();
+    for (auto& thread : threads) {
+        thread.join();
+    }
 
-        status |= fetchBinderizedEntry(manager, &entry);
+    Status status = OK;
+    for (const auto& pending : pendingEntries) {
+        err() << pending.warnings.str();
+        status |= pending.status;
     }
 
     for (auto& pair : allTableEntries) {
@@ -638,10 +680,10 @@ Status ListCommand::fetchBinderized(const sp<IServiceManager> &manager) {
 }
 
 Status ListCommand::fetchBinderizedEntry(const sp<IServiceManager> &manager,
-                                         TableEntry *entry) {
+                                         TableEntry *entry, std::ostream &warnings) {
     Status status = OK;
     const auto handleError = [&](Status additionalError, const std::string& msg) {
-        err() << "Warning: Skipping \"" << entry->interfaceName << "\": " << msg << std::endl;
+        warnings << "Warning: Skipping \"" << entry->interfaceName << "\": " << msg << std::endl;
         status |= DUMP_BINDERIZED_ERROR | additionalError;
     };
 
@@ -33,6 +33,8 @@ constexpr bool kIsVendor = false;
 #endif
 
 #ifdef __ANDROID__
+constexpr size_t kMaxCachedServiceContexts = 4096;
+
 static std::string getPidcon(pid_t pid) {
     android_errorWriteLog(0x534e4554, "121035042");
 
@@ -46,9 +48,9 @@ static std::string getPidcon(pid_t pid) {
     return result;
 }
 
-static struct selabel_handle* getSehandle() {
+static struct selabel_handle* getSehandle(bool reload) {
     static struct selabel_handle* gSehandle = nullptr;
-    if (gSehandle != nullptr && selinux_status_updated()) {
+    if (gSehandle != nullptr && (reload || selinux_status_updated())) {
         selabel_close(gSehandle);
         gSehandle = nullptr;
     }
@@ -159,17 +161,58 @@ bool Access::actionAllowed(const CallingContext& sctx, const char* tctx, const c
 #endif
 }
 
+Access::ContextCacheStats Access::getContextCacheStats() const {
+    ContextCacheStats stats = mContextCacheStats;
+    stats.entries = mServiceContexts.size();
+    return stats;
+}
+
+const char* Access::lookupServiceContext(const std::string& name) {
+#ifdef __ANDROID__
+    // Unlike selinux_status_updated(), which the AVC also calls, the policy
+    // load sequence number doesn't reset when read, so no reload is missed.
+    int seqno = selinux_status_policyload();
+    bool reloaded = seqno != mPolicyLoadSeqno;
+    if (reloaded) {
+        if (mPolicyLoadSeqno != -1) mContextCacheStats.policyReloads++;
+        mPolicyLoadSeqno = seqno;
+        mServiceContexts.clear();
+    }
+
+    mContextCacheStats.lookups++;
+    if (auto it = mServiceContexts.find(name); it != mServiceContexts.end()) {
+        mContextCacheStats.hits++;
+        return it->second.c_str();
+    }
+
+    char* tctx = nullptr;
+    if (selabel_lookup(getSehandle(reloaded), &tctx, name.c_str(), SELABEL_CTX_ANDROID_SERVICE) !=
+        0) {
+        return nullptr;
+    }
+    // Any name matches the default entry of service_contexts, so bound the
+    // cache against callers looking up made up names.
+    if (mServiceContexts.size() >= kMaxCachedServiceContexts) {
+        mServiceContexts.clear();
+    }
+    auto [it, _] = mServiceContexts.emplace(name, tctx);
+    freecon(tctx);
+    return it->second.c_str();
+#else
+    (void)name;
+    return nullptr;
+#endif
+}
+
 bool Access::actionAllowedFromLookup(const CallingContext& sctx, const std::string& name, const char *perm) {
 #ifdef __ANDROID__
-    char *tctx = nullptr;
-    if (selabel_lookup(getSehandle(), &tctx, name.c_str(), SELABEL_CTX_ANDROID_SERVICE) != 0) {
+    const char* tctx = lookupServiceContext(name);
+    if (tctx == nullptr) {
         LOG(ERROR) << "SELinux: No match for " << name << " in service_contexts.\n";
         return false;
     }
 
-    bool allowed = actionAllowed(sctx, tctx, perm, name);
-    freecon(tctx);
-    return allowed;
+    return actionAllowed(sctx, tctx, perm, name);
 #else
     (void)sctx;
     (void)name;
@@ -16,8 +16,10 @@
 
 #pragma once
 
+#include <stdint.h>
 #include <string>
 #include <sys/types.h>
+#include <unordered_map>
 
 namespace android {
 
@@ -46,13 +48,32 @@ public:
     virtual bool canAdd(const CallingContext& ctx, const std::string& name);
     virtual bool canList(const CallingContext& ctx);
 
+    struct ContextCacheStats {
+        size_t entries = 0;
+        uint64_t lookups = 0;
+        uint64_t hits = 0;
+        uint64_t policyReloads = 0;
+    };
+    // Stats of the cache of service contexts looked up for canFind and canAdd.
+    ContextCacheStats getContextCacheStats() const;
+
 private:
     bool actionAllowed(const CallingContext& sctx, const char* tctx, const char* perm,
             const std::string& tname);
     bool actionAllowedFromLookup(const CallingContext& sctx, const std::string& name,
             const char *perm);
 
+    // Returns the context of the service |name| from service_contexts, or nullptr if none.
+    const char* lookupServiceContext(const std::string& name);
+
     char* mThisProcessContext = nullptr;
+
+    // Service name -> context, cleared when the policy is reloaded. Only the
+    // lookups are cached: access decisions still go through the AVC, so that
+    // they are audited as before.
+    std::unordered_map<std::string, std::string> mServiceContexts;
+    int mPolicyLoadSeqno = -1;
+    ContextCacheStats mContextCacheStats;
 };
 
 };
@@ -26,7 +26,10 @@
 #include <binder/Stability.h>
 #include <cutils/android_filesystem_config.h>
 #include <cutils/multiuser.h>
+#include <inttypes.h>
+#include <mutex>
 #include <thread>
+#include <unordered_map>
 
 #if !defined(VENDORSERVICEMANAGER) && !defined(__ANDROID_RECOVERY__)
 #include "perfetto/public/protos/trace/android/android_track_event.pzc.h"
@@ -96,20 +99,6 @@ static std::vector<ManifestWithDescription> GetManifestsWithDescription() {
 #endif
 }
 
-// func true -> stop search and forEachManifest will return true
-static bool forEachManifest(const std::function<bool(const ManifestWithDescription&)>& func) {
-    for (const ManifestWithDescription& mwd : GetManifestsWithDescription()) {
-        if (mwd.manifest == nullptr) {
-            ALOGE("NULL VINTF MANIFEST!: %s", mwd.description);
-            // note, we explicitly do not retry here, so that we can detect VINTF
-            // or other bugs (b/151696835)
-            continue;
-        }
-        if (func(mwd)) return true;
-    }
-    return false;
-}
-
 static std::string getNativeInstanceName(const vintf::ManifestInstance& instance) {
     return instance.package() + "/" + instance.instance();
 }
@@ -141,184 +130,226 @@ static std::string getAidlInstanceName(const vintf::ManifestInstance& instance)
     return instance.package() + "." + instance.interface() + "/" + instance.instance();
 }
 
-static bool isVintfDeclared(const Access::CallingContext& ctx, const std::string& name) {
-    NativeName nname;
-    if (NativeName::fill(name, &nname)) {
-        bool found = forEachManifest([&](const ManifestWithDescription& mwd) {
-            if (mwd.manifest->hasNativeInstance(nname.package, nname.instance)) {
-                ALOGI("%s Found %s in %s VINTF manifest.", ctx.toDebugString().c_str(),
-                      name.c_str(), mwd.description);
-                return true; // break
+// Hashed index of the NATIVE and AIDL instances declared in the VINTF
+// manifests, so that lookups don't walk every manifest entry. Names are
+// "package/instance" for native instances and "package.IFoo/instance" for
+// AIDL instances, which is what clients pass to servicemanager.
+struct VintfIndex {
+    struct Instance {
+        vintf::HalFormat format;
+        // first manifest declaring the instance
+        const char* description = nullptr;
+        std::optional<std::string> updatableViaApex;
+        // last manifest declaring the instance
+        std::optional<std::string> accessor;
+        std::optional<std::string> ip;
+        std::optional<uint64_t> port;
+    };
+
+    // The manifests this was built from. VintfObject returns the same objects
+    // until it reloads them, so the index only needs to be rebuilt when these
+    // change.
+    std::vector<std::shared_ptr<const vintf::HalManifest>> manifests;
+
+    std::unordered_map<std::string, Instance> instances;
+    // package -> instances of native HALs, in manifest order
+    std::unordered_map<std::string, std::vector<std::string>> nativeInstances;
+    // package.IFoo -> instances of AIDL HALs, in manifest order
+    std::unordered_map<std::string, std::vector<std::string>> aidlInstances;
+    // apex name -> instance names which are updatable via that apex
+    std::unordered_map<std::string, std::vector<std::string>> updatableNames;
+};
+
+static std::shared_ptr<const VintfIndex> buildVintfIndex(
+        const std::vector<ManifestWithDescription>& mwds) {
+    auto index = std::make_shared<VintfIndex>();
+
+    for (const ManifestWithDescription& mwd : mwds) {
+        index->manifests.push_back(mwd.manifest);
+        if (mwd.manifest == nullptr) {
+            ALOGE("NULL VINTF MANIFEST!: %s", mwd.description);
+            // note, we explicitly do not retry here, so that we can detect VINTF
+            // or other bugs (b/151696835)
+            continue;
+        }
+
+        // libvintf returns instances of one manifest sorted, keep that order
+        std::map<std::string, std::set<std::string>> nativeInstances;
+        std::map<std::string, std::set<std::string>> aidlInstances;
+
+        mwd.manifest->forEachInstance([&](const auto& manifestInstance) {
+            std::string name;
+            if (manifestInstance.format() == vintf::HalFormat::NATIVE) {
+                name = getNativeInstanceName(manifestInstance);
+                nativeInstances[manifestInstance.package()].insert(manifestInstance.instance());
+            } else if (manifestInstance.format() == vintf::HalFormat::AIDL) {
+                name = getAidlInstanceName(manifestInstance);
+                aidlInstances[manifestInstance.package() + "." + manifestInstance.interface()]
+                        .insert(manifestInstance.instance());
+            } else {
+                return true; // continue (libvintf uses opposite convention)
+            }
+
+            auto [it, inserted] = index->instances.try_emplace(name);
+            VintfIndex::Instance& instance = it->second;
+            if (inserted) {
+                instance.format = manifestInstance.format();
+                instance.description = mwd.description;
+                instance.updatableViaApex = manifestInstance.updatableViaApex();
+            }
+            instance.accessor = manifestInstance.accessor();
+            instance.ip = manifestInstance.ip();
+            instance.port = manifestInstance.port();
+
+            if (manifestInstance.updatableViaApex().has_value()) {
+                index->updatableNames[*manifestInstance.updatableViaApex()].push_back(name);
             }
-            return false; // continue
+            return true; // continue (libvintf uses opposite convention)
         });
-        if (!found) {
-            ALOGI("%s Could not find %s in the VINTF manifest.", ctx.toDebugString().c_str(),
-                  name.c_str());
+
+        for (auto& [package, instances] : nativeInstances) {
+            auto& all = index->nativeInstances[package];
+            all.insert(all.end(), instances.begin(), instances.end());
+        }
+        for (auto& [iface, instances] : aidlInstances) {
+            auto& all = index->aidlInstances[iface];
+            all.insert(all.end(), instances.begin(), instances.end());
         }
-        return found;
     }
 
-    AidlName aname;
-    if (!AidlName::fill(name, &aname, true)) return false;
+    return index;
+}
 
-    bool found = forEachManifest([&](const ManifestWithDescription& mwd) {
-        if (mwd.manifest->hasAidlInstance(aname.package, aname.iface, aname.instance)) {
-            ALOGI("%s Found %s in %s VINTF manifest.", ctx.toDebugString().c_str(), name.c_str(),
-                  mwd.description);
-            return true; // break
-        }
-        return false;  // continue
-    });
+static std::shared_ptr<const VintfIndex> getVintfIndex() {
+    static std::mutex sMutex;
+    static std::shared_ptr<const VintfIndex> sIndex;
 
-    if (!found) {
-        std::set<std::string> instances;
-        forEachManifest([&](const ManifestWithDescription& mwd) {
-            std::set<std::string> res = mwd.manifest->getAidlInstances(aname.package, aname.iface);
-            instances.insert(res.begin(), res.end());
-            return true;
-        });
+    std::vector<ManifestWithDescription> mwds = GetManifestsWithDescription();
 
-        std::string available;
-        if (instances.empty()) {
-            available = "No alternative instances declared in VINTF";
-        } else {
-            // for logging only. We can't return this information to the client
-            // because they may not have permissions to find or list those
-            // instances
-            available = "VINTF declared instances: " + base::Join(instances, ", ");
-        }
-        // Although it is tested, explicitly rebuilding qualified name, in case it
-        // becomes something unexpected.
-        ALOGI("%s Could not find %s.%s/%s in the VINTF manifest. %s.", ctx.toDebugString().c_str(),
-              aname.package.c_str(), aname.iface.c_str(), aname.instance.c_str(),
-              available.c_str());
+    std::lock_guard<std::mutex> lock(sMutex);
+    bool current = sIndex != nullptr && sIndex->manifests.size() == mwds.size();
+    for (size_t i = 0; current && i < mwds.size(); i++) {
+        current = sIndex->manifests[i] == mwds[i].manifest;
     }
+    if (!current) sIndex = buildVintfIndex(mwds);
+    return sIndex;
+}
 
-    return found;
+static const VintfIndex::Instance* findVintfInstance(const VintfIndex& index,
+                                                     const std::string& name,
+                                                     vintf::HalFormat format) {
+    auto it = index.instances.find(name);
+    if (it == index.instances.end() || it->second.format != format) return nullptr;
+    return &it->second;
 }
 
-static std::optional<std::string> getVintfUpdatableApex(const std::string& name) {
+static bool isVintfDeclared(const Access::CallingContext& ctx, const std::string& name) {
+    std::shared_ptr<const VintfIndex> index = getVintfIndex();
+
     NativeName nname;
     if (NativeName::fill(name, &nname)) {
-        std::optional<std::string> updatableViaApex;
-
-        forEachManifest([&](const ManifestWithDescription& mwd) {
-            bool cont = mwd.manifest->forEachInstance([&](const auto& manifestInstance) {
-                if (manifestInstance.format() != vintf::HalFormat::NATIVE) return true;
-                if (manifestInstance.package() != nname.package) return true;
-                if (manifestInstance.instance() != nname.instance) return true;
-                updatableViaApex = manifestInstance.updatableViaApex();
-                return false; // break (libvintf uses opposite convention)
-            });
-            return !cont;
-        });
-
-        return updatableViaApex;
+        const VintfIndex::Instance* instance =
+                findVintfInstance(*index, name, vintf::HalFormat::NATIVE);
+        if (instance != nullptr) {
+            ALOGI("%s Found %s in %s VINTF manifest.", ctx.toDebugString().c_str(),
+                  name.c_str(), instance->description);
+        } else {
+            ALOGI("%s Could not find %s in the VINTF manifest.", ctx.toDebugString().c_str(),
+                  name.c_str());
+        }
+        return instance != nullptr;
     }
 
     AidlName aname;
-    if (!AidlName::fill(name, &aname, true)) return std::nullopt;
+    if (!AidlName::fill(name, &aname, true)) return false;
 
-    std::optional<std::string> updatableViaApex;
+    const VintfIndex::Instance* instance = findVintfInstance(*index, name, vintf::HalFormat::AIDL);
+    if (instance != nullptr) {
+        ALOGI("%s Found %s in %s VINTF manifest.", ctx.toDebugString().c_str(), name.c_str(),
+              instance->description);
+        return true;
+    }
 
-    forEachManifest([&](const ManifestWithDescription& mwd) {
-        bool cont = mwd.manifest->forEachInstance([&](const auto& manifestInstance) {
-            if (manifestInstance.format() != vintf::HalFormat::AIDL) return true;
-            if (manifestInstance.package() != aname.package) return true;
-            if (manifestInstance.interface() != aname.iface) return true;
-            if (manifestInstance.instance() != aname.instance) return true;
-            updatableViaApex = manifestInstance.updatableViaApex();
-            return false; // break (libvintf uses opposite convention)
-        });
-        return !cont;
-    });
+    std::set<std::string> instances;
+    if (auto it = index->aidlInstances.find(aname.package + "." + aname.iface);
+        it != index->aidlInstances.end()) {
+        instances.insert(it->second.begin(), it->second.end());
+    }
 
-    return updatableViaApex;
+    std::string available;
+    if (instances.empty()) {
+        available = "No alternative instances declared in VINTF";
+    } else {
+        // for logging only. We can't return this information to the client
+        // because they may not have permissions to find or list those
+        // instances
+        available = "VINTF declared instances: " + base::Join(instances, ", ");
+    }
+    // Although it is tested, explicitly rebuilding qualified name, in case it
+    // becomes something unexpected.
+    ALOGI("%s Could not find %s.%s/%s in the VINTF manifest. %s.", ctx.toDebugString().c_str(),
+          aname.package.c_str(), aname.iface.c_str(), aname.instance.c_str(), available.c_str());
+
+    return false;
 }
 
-static std::vector<std::string> getVintfUpdatableNames(const std::string& apexName) {
-    std::vector<std::string> names;
+static std::optional<std::string> getVintfUpdatableApex(const std::string& name) {
+    vintf::HalFormat format = vintf::HalFormat::NATIVE;
+    NativeName nname;
+    if (!NativeName::fill(name, &nname)) {
+        AidlName aname;
+        if (!AidlName::fill(name, &aname, true)) return std::nullopt;
+        format = vintf::HalFormat::AIDL;
+    }
 
-    forEachManifest([&](const ManifestWithDescription& mwd) {
-        mwd.manifest->forEachInstance([&](const auto& manifestInstance) {
-            if (manifestInstance.updatableViaApex().has_value() &&
-                manifestInstance.updatableViaApex().value() == apexName) {
-                if (manifestInstance.format() == vintf::HalFormat::NATIVE) {
-                    names.push_back(getNativeInstanceName(manifestInstance));
-                } else if (manifestInstance.format() == vintf::HalFormat::AIDL) {
-                    names.push_back(getAidlInstanceName(manifestInstance));
-                }
-            }
-            return true; // continue (libvintf uses opposite convention)
-        });
-        return false; // continue
-    });
+    std::shared_ptr<const VintfIndex> index = getVintfIndex();
+    const VintfIndex::Instance* instance = findVintfInstance(*index, name, format);
+    if (instance == nullptr) return std::nullopt;
+    return instance->updatableViaApex;
+}
 
-    return names;
+static std::vector<std::string> getVintfUpdatableNames(const std::string& apexName) {
+    std::shared_ptr<const VintfIndex> index = getVintfIndex();
+    auto it = index->updatableNames.find(apexName);
+    if (it == index->updatableNames.end()) return {};
+    return it->second;
 }
 
 static std::optional<std::string> getVintfAccessorName(const std::string& name) {
     AidlName aname;
     if (!AidlName::fill(name, &aname, false)) return std::nullopt;
 
-    std::optional<std::string> accessor;
-    forEachManifest([&](const ManifestWithDescription& mwd) {
-        mwd.manifest->forEachInstance([&](const auto& manifestInstance) {
-            if (manifestInstance.format() != vintf::HalFormat::AIDL) return true;
-            if (manifestInstance.package() != aname.package) return true;
-            if (manifestInstance.interface() != aname.iface) return true;
-            if (manifestInstance.instance() != aname.instance) return true;
-            accessor = manifestInstance.accessor();
-            return false; // break (libvintf uses opposite convention)
-        });
-        return false; // continue
-    });
-    return accessor;
+    std::shared_ptr<const VintfIndex> index = getVintfIndex();
+    const VintfIndex::Instance* instance = findVintfInstance(*index, name, vintf::HalFormat::AIDL);
+    if (instance == nullptr) return std::nullopt;
+    return instance->accessor;
 }
 
 static std::optional<ConnectionInfo> getVintfConnectionInfo(const std::string& name) {
     AidlName aname;
     if (!AidlName::fill(name, &aname, true)) return std::nullopt;
 
-    std::optional<std::string> ip;
-    std::optional<uint64_t> port;
-    forEachManifest([&](const ManifestWithDescription& mwd) {
-        mwd.manifest->forEachInstance([&](const auto& manifestInstance) {
-            if (manifestInstance.format() != vintf::HalFormat::AIDL) return true;
-            if (manifestInstance.package() != aname.package) return true;
-            if (manifestInstance.interface() != aname.iface) return true;
-            if (manifestInstance.instance() != aname.instance) return true;
-            ip = manifestInstance.ip();
-            port = manifestInstance.port();
-            return false; // break (libvintf uses opposite convention)
-        });
-        return false; // continue
-    });
-
-    if (ip.has_value() && port.has_value()) {
-        ConnectionInfo info;
-        info.ipAddress = *ip;
-        info.port = *port;
-        return std::make_optional<ConnectionInfo>(info);
-    } else {
+    std::shared_ptr<const VintfIndex> index = getVintfIndex();
+    const VintfIndex::Instance* instance = findVintfInstance(*index, name, vintf::HalFormat::AIDL);
+    if (instance == nullptr || !instance->ip.has_value() || !instance->port.has_value()) {
         return std::nullopt;
     }
+
+    ConnectionInfo info;
+    info.ipAddress = *instance->ip;
+    info.port = *instance->port;
+    return std::make_optional<ConnectionInfo>(info);
 }
 
 static std::vector<std::string> getVintfInstances(const std::string& interface) {
+    std::shared_ptr<const VintfIndex> index = getVintfIndex();
+
     size_t lastDot = interface.rfind('.');
     if (lastDot == std::string::npos) {
         // This might be a package for native instance.
-        std::vector<std::string> ret;
-        (void)forEachManifest([&](const ManifestWithDescription& mwd) {
-            auto instances = mwd.manifest->getNativeInstances(interface);
-            ret.insert(ret.end(), instances.begin(), instances.end());
-            return false; // continue
-        });
         // If found, return it without error log.
-        if (!ret.empty()) {
-            return ret;
+        if (auto it = index->nativeInstances.find(interface); it != index->nativeInstances.end()) {
+            return it->second;
         }
 
         ALOGE("VINTF interfaces require names in Java package format (e.g. some.package.foo.IFoo) "
@@ -326,17 +357,11 @@ static std::vector<std::string> getVintfInstances(const std::string& interface)
               interface.c_str());
         return {};
     }
-    const std::string package = interface.substr(0, lastDot);
-    const std::string iface = interface.substr(lastDot+1);
-
-    std::vector<std::string> ret;
-    (void)forEachManifest([&](const ManifestWithDescription& mwd) {
-        auto instances = mwd.manifest->getAidlInstances(package, iface);
-        ret.insert(ret.end(), instances.begin(), instances.end());
-        return false;  // continue
-    });
 
-    return ret;
+    if (auto it = index->aidlInstances.find(interface); it != index->aidlInstances.end()) {
+        return it->second;
+    }
+    return {};
 }
 
 static bool meetsDeclarationRequirements(const Access::CallingContext& ctx,
@@ -1165,6 +1190,21 @@ Status ServiceManager::getServiceDebugInfo(std::vector<ServiceDebugInfo>* outRet
     return Status::ok();
 }
 
+status_t ServiceManager::dump(int fd, const Vector<String16>& /*args*/) {
+    if (!mAccess->canList(mAccess->getCallingContext())) {
+        return PERMISSION_DENIED;
+    }
+
+    Access::ContextCacheStats stats = mAccess->getContextCacheStats();
+    dprintf(fd, "Services: %zu\n", mNameToService.size());
+    dprintf(fd,
+            "Service context cache: %zu entries, %" PRIu64 " hits / %" PRIu64
+            " lookups (%.1f%%), %" PRIu64 " policy reloads\n",
+            stats.entries, stats.hits, stats.lookups,
+            stats.lookups == 0 ? 0.0 : 100.0 * stats.hits / stats.lookups, stats.policyReloads);
+    return OK;
+}
+
 void ServiceManager::clear() {
     mNameToService.clear();
     mNameToRegistrationCallback.clear();
@@ -67,6 +67,7 @@ public:
                                           const sp<IClientCallback>& cb) override;
     binder::Status tryUnregisterService(const std::string& name, const sp<IBinder>& binder) override;
     binder::Status getServiceDebugInfo(std::vector<ServiceDebugInfo>* outReturn) override;
+    status_t dump(int fd, const Vector<String16>& args) override;
     void binderDied(const wp<IBinder>& who) override;
     void handleClientCallbacks();
 
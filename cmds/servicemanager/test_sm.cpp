@@ -14,8 +14,10 @@
  * limitations under the License.
  */
 
+#include <android-base/file.h>
 #include <android-base/properties.h>
 #include <android-base/strings.h>
+#include <android-base/unique_fd.h>
 #include <android/os/BnServiceCallback.h>
 #include <binder/Binder.h>
 #include <binder/IServiceManager.h>
@@ -40,6 +42,7 @@ using android::os::BnServiceCallback;
 using android::os::IServiceManager;
 using android::os::Service;
 using testing::_;
+using testing::HasSubstr;
 using testing::ElementsAre;
 using testing::NiceMock;
 using testing::Return;
@@ -346,6 +349,30 @@ TEST(ListServices, CriticalServices) {
     EXPECT_THAT(out, ElementsAre("sa"));
 }
 
+TEST(Dump, NoPermissions) {
+    std::unique_ptr<MockAccess> access = std::make_unique<NiceMock<MockAccess>>();
+
+    EXPECT_CALL(*access, getCallingContext()).WillOnce(Return(Access::CallingContext{}));
+    EXPECT_CALL(*access, canList(_)).WillOnce(Return(false));
+
+    sp<ServiceManager> sm = sp<NiceMock<MockServiceManager>>::make(std::move(access));
+
+    EXPECT_EQ(android::PERMISSION_DENIED, sm->dump(STDOUT_FILENO, {}));
+}
+
+TEST(Dump, ServiceContextCacheStats) {
+    auto sm = getPermissiveServiceManager();
+
+    android::base::unique_fd readFd, writeFd;
+    ASSERT_TRUE(android::base::Pipe(&readFd, &writeFd));
+    EXPECT_EQ(android::OK, sm->dump(writeFd.get(), {}));
+    writeFd.reset();
+
+    std::string out;
+    ASSERT_TRUE(android::base::ReadFdToString(readFd, &out));
+    EXPECT_THAT(out, HasSubstr("Service context cache:"));
+}
+
 TEST(Vintf, UpdatableViaApex) {
     if (!isCuttlefishPhone()) GTEST_SKIP() << "Skipping non-Cuttlefish-phone devices";
 
@@ -0,0 +1,165 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace android::ftl {
+
+// Monotonic allocator for objects that die together, e.g. the per-frame state of the composite
+// path. Allocation bumps a pointer in the current block, deallocation is a no-op, and reset frees
+// everything at once. The blocks are kept across resets, so a steady workload stops allocating
+// from the heap after its first few frames.
+//
+// Arena is not thread-safe.
+//
+// Example usage:
+//
+//   ftl::Arena arena;
+//
+//   ftl::ArenaVector<int> vector(arena);
+//   vector.reserve(100);
+//   vector.push_back(42);
+//   assert(arena.bytes_used() >= 100 * sizeof(int));
+//
+//   vector = ftl::ArenaVector<int>(arena);
+//   arena.reset();
+//   assert(arena.bytes_used() == 0u);
+//
+class Arena final {
+ public:
+  static constexpr std::size_t kDefaultBlockSize = 16 * 1024;
+
+  explicit Arena(std::size_t block_size = kDefaultBlockSize) : block_size_(block_size) {}
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  // Returns storage for size bytes aligned to alignment, which must be a power of two. The storage
+  // remains valid until reset or destruction.
+  void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t)) {
+    for (; current_ < blocks_.size(); ++current_, offset_ = 0) {
+      if (void* const storage = allocate_in(blocks_[current_], size, alignment)) {
+        return storage;
+      }
+    }
+
+    const std::size_t block_size = std::max(block_size_, size + alignment);
+    blocks_.push_back({std::unique_ptr<std::byte[]>(new std::byte[block_size]), block_size});
+    reserved_ += block_size;
+    return allocate_in(blocks_.back(), size, alignment);
+  }
+
+  // Frees all allocations at once. Blocks are kept for reuse.
+  void reset() {
+    current_ = 0;
+    offset_ = 0;
+    used_ = 0;
+  }
+
+  // Frees all allocations, and releases the blocks to the heap.
+  void release() {
+    reset();
+    blocks_.clear();
+    reserved_ = 0;
+  }
+
+  // Returns the number of bytes allocated since the last reset, including alignment padding.
+  std::size_t bytes_used() const { return used_; }
+
+  // Returns the number of bytes held in blocks.
+  std::size_t bytes_reserved() const { return reserved_; }
+
+ private:
+  struct Block {
+    std::unique_ptr<std::byte[]> storage;
+    std::size_t size;
+  };
+
+  void* allocate_in(const Block& block, std::size_t size, std::size_t alignment) {
+    const auto base = reinterpret_cast<std::uintptr_t>(block.storage.get());
+    const std::size_t offset = ((base + offset_ + alignment - 1) & ~(alignment - 1)) - base;
+    if (offset > block.size || size > block.size - offset) return nullptr;
+
+    used_ += offset + size - offset_;
+    offset_ = offset + size;
+    return block.storage.get() + offset;
+  }
+
+  const std::size_t block_size_;
+
+  std::vector<Block> blocks_;
+  std::size_t current_ = 0;
+  std::size_t offset_ = 0;
+
+  std::size_t used_ = 0;
+  std::size_t reserved_ = 0;
+};
+
+// Standard allocator that draws from an Arena, for containers whose elements share a lifetime. The
+// arena must outlive the containers, or at least their use until the arena is reset.
+template <typename T>
+class ArenaAllocator {
+ public:
+  using value_type = T;
+
+  // Containers that are moved or swapped take their allocator along, so that their storage stays
+  // in the arena it was allocated from.
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  // Implicit, so that containers can be constructed from the arena itself.
+  ArenaAllocator(Arena& arena) : arena_(&arena) {}
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena_) {}
+
+  T* allocate(std::size_t n) { return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T))); }
+
+  void deallocate(T*, std::size_t) {}
+
+  Arena& arena() const { return *arena_; }
+
+ private:
+  template <typename>
+  friend class ArenaAllocator;
+
+  Arena* arena_;
+};
+
+template <typename T, typename U>
+inline bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) {
+  return &lhs.arena() == &rhs.arena();
+}
+
+// TODO: Remove in C++20.
+template <typename T, typename U>
+inline bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) {
+  return !(lhs == rhs);
+}
+
+// std::vector whose storage is allocated from an Arena. Unlike ftl::SmallVector, it has no static
+// storage, but growing it does not touch the heap.
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+}  // namespace android::ftl
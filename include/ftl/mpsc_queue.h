@@ -0,0 +1,110 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+
+namespace android::ftl {
+
+// Base class of the elements of an MpscQueue<T>, which links them without allocating.
+template <typename T>
+class MpscQueueNode {
+ private:
+  template <typename>
+  friend class MpscQueue;
+
+  T* next_ = nullptr;
+};
+
+// Unbounded lock-free queue for any number of producer threads and one consumer thread. The queue
+// is intrusive: elements derive from MpscQueueNode<T>, are owned by the caller, and may only be in
+// one queue at a time. Elements pushed by the same producer are popped in FIFO order.
+//
+// Producers push onto a lock-free stack. When its own list runs out, the consumer takes the whole
+// stack at once and reverses it, so popping is wait-free apart from that amortized reversal.
+//
+// Example usage:
+//
+//   struct Event : ftl::MpscQueueNode<Event> {
+//     explicit Event(int id) : id(id) {}
+//     int id;
+//   };
+//
+//   ftl::MpscQueue<Event> queue;
+//   Event a(1), b(2);
+//
+//   queue.push(&a);
+//   queue.push(&b);
+//
+//   assert(queue.pop() == &a);
+//   assert(queue.pop() == &b);
+//   assert(queue.pop() == nullptr);
+//
+template <typename T>
+class MpscQueue final {
+ public:
+  MpscQueue() = default;
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  // Pushes an element, which must outlive its stay in the queue. Returns whether the queue was
+  // empty before, as seen by producers, e.g. to decide whether to wake up the consumer.
+  bool push(T* element) {
+    Node* const node = element;
+    T* top = top_.load(std::memory_order_relaxed);
+    do {
+      node->next_ = top;
+    } while (!top_.compare_exchange_weak(top, element, std::memory_order_release,
+                                         std::memory_order_relaxed));
+    return top == nullptr;
+  }
+
+  // Removes and returns the oldest element, or nullptr if the queue is empty. Only the consumer
+  // may call this.
+  T* pop() {
+    if (!front_) {
+      T* top = top_.exchange(nullptr, std::memory_order_acquire);
+      while (top) {
+        T* const next = static_cast<Node*>(top)->next_;
+        static_cast<Node*>(top)->next_ = front_;
+        front_ = top;
+        top = next;
+      }
+      if (!front_) return nullptr;
+    }
+
+    T* const element = front_;
+    front_ = static_cast<Node*>(element)->next_;
+    static_cast<Node*>(element)->next_ = nullptr;
+    return element;
+  }
+
+  // Returns whether the queue is empty. Only the consumer may call this.
+  bool empty() const { return !front_ && !top_.load(std::memory_order_acquire); }
+
+ private:
+  using Node = MpscQueueNode<T>;
+
+  // Stack of pushed elements, latest first.
+  std::atomic<T*> top_ = nullptr;
+
+  // Elements taken from the stack by the consumer, oldest first.
+  T* front_ = nullptr;
+};
+
+}  // namespace android::ftl
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace android::ftl {
+
+// Publishes snapshots of a trivially copyable value from one writer thread to any number of reader
+// threads, without readers blocking the writer or each other. Readers retry if the writer stores
+// a new value while they copy it, so the value should be small and rarely written compared to how
+// often it is read, e.g. a vsync model or the active display mode.
+//
+// Concurrent calls to store must be serialized by the caller.
+//
+// Example usage:
+//
+//   struct Timeline {
+//     int64_t vsync_time;
+//     int64_t vsync_period;
+//   };
+//
+//   ftl::SeqLock<Timeline> timeline({0, 16'666'667});
+//
+//   // Writer thread.
+//   timeline.store({16'666'667, 16'666'667});
+//
+//   // Reader threads.
+//   const Timeline snapshot = timeline.load();
+//
+template <typename T>
+class SeqLock final {
+  static_assert(std::is_trivially_copyable_v<T>);
+  static_assert(std::is_default_constructible_v<T>);
+
+ public:
+  SeqLock() : SeqLock(T{}) {}
+  explicit SeqLock(const T& value) { write(value, std::memory_order_relaxed); }
+
+  SeqLock(const SeqLock&) = delete;
+  SeqLock& operator=(const SeqLock&) = delete;
+
+  void store(const T& value) {
+    const std::uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+
+    // An odd sequence number tells readers that a store is in progress. A reader that sees any
+    // word of the new value also sees that sequence number, since the words are released after it.
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    write(value, std::memory_order_release);
+
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  T load() const {
+    T value;
+    while (!try_load(&value));
+    return value;
+  }
+
+  // Reads the value unless a store is in progress or completes meanwhile. Returns whether the
+  // value was read.
+  bool try_load(T* value) const {
+    const std::uint32_t sequence = sequence_.load(std::memory_order_acquire);
+    if (sequence & 1) return false;
+
+    read(value);
+    return sequence_.load(std::memory_order_relaxed) == sequence;
+  }
+
+ private:
+  // The value is copied through atomic words, so that copying it while it is being stored is not a
+  // data race, even though the copy is discarded. Ordering each word rather than using fences also
+  // keeps the lock visible to ThreadSanitizer, which does not support fences.
+  using Word = std::uintptr_t;
+  static constexpr std::size_t kWordCount = (sizeof(T) + sizeof(Word) - 1) / sizeof(Word);
+
+  void write(const T& value, std::memory_order order) {
+    Word words[kWordCount] = {};
+    std::memcpy(words, &value, sizeof(T));
+    for (std::size_t i = 0; i < kWordCount; ++i) {
+      words_[i].store(words[i], order);
+    }
+  }
+
+  void read(T* value) const {
+    Word words[kWordCount];
+    for (std::size_t i = 0; i < kWordCount; ++i) {
+      words[i] = words_[i].load(std::memory_order_acquire);
+    }
+    std::memcpy(value, words, sizeof(T));
+  }
+
+  std::atomic<std::uint32_t> sequence_ = 0;
+  std::atomic<Word> words_[kWordCount];
+};
+
+}  // namespace android::ftl
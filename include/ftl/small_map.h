@@ -21,9 +21,11 @@
 #include <ftl/small_vector.h>
 
 #include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace android::ftl {
 
@@ -36,6 +38,10 @@ namespace android::ftl {
 //
 // SmallMap<K, V, 0> unconditionally allocates on the heap.
 //
+// Lookup is a linear search, except for integral or enum keys compared with std::equal_to, where
+// maps that outgrow kIndexThreshold mappings also build an open-addressed hash index of positions
+// into the contiguous storage. Iteration order and iterator invalidation are unaffected.
+//
 // Example usage:
 //
 //   ftl::SmallMap<int, std::string, 3> map;
@@ -101,11 +107,17 @@ class SmallMap final {
   SmallMap(InitializerList<U, std::index_sequence<Sizes...>, Types...>&& list)
       : map_(std::move(list)) {
     deduplicate();
+    if (size() > kIndexThreshold) rebuild_index();
   }
 
   // Copies or moves key-value pairs from a convertible map.
   template <typename Q, typename W, std::size_t M, typename E>
-  SmallMap(SmallMap<Q, W, M, E> other) : map_(std::move(other.map_)) {}
+  SmallMap(SmallMap<Q, W, M, E> other) : map_(std::move(other.map_)) {
+    if (size() > kIndexThreshold) rebuild_index();
+  }
+
+  // Number of mappings above which lookups of indexable keys go through the hash index.
+  static constexpr std::size_t kIndexThreshold = 32;
 
   static constexpr size_type static_capacity() { return N; }
 
@@ -146,26 +158,31 @@ class SmallMap final {
   //   assert(d == 'D');
   //
   auto get(const key_type& key) const -> Optional<std::reference_wrapper<const mapped_type>> {
-    for (const auto& [k, v] : *this) {
-      if (KeyEqual{}(k, key)) {
-        return std::cref(v);
-      }
+    if (const auto it = find(key); it != end()) {
+      return std::cref(it->second);
     }
     return {};
   }
 
   auto get(const key_type& key) -> Optional<std::reference_wrapper<mapped_type>> {
-    for (auto& [k, v] : *this) {
-      if (KeyEqual{}(k, key)) {
-        return std::ref(v);
-      }
+    if (const auto it = find(key); it != end()) {
+      return std::ref(it->second);
     }
     return {};
   }
 
   // Returns an iterator to an existing mapping for the given key, or the end() iterator otherwise.
   const_iterator find(const key_type& key) const { return const_cast<SmallMap&>(*this).find(key); }
-  iterator find(const key_type& key) { return find(key, begin()); }
+
+  iterator find(const key_type& key) {
+    if constexpr (kIndexable) {
+      if (!index_.empty()) {
+        const size_type position = index_[find_slot(key)];
+        return position == 0 ? end() : begin() + (position - 1);
+      }
+    }
+    return find(key, begin());
+  }
 
   // Inserts a mapping unless it exists. Returns an iterator to the inserted or existing mapping,
   // and whether the mapping was inserted.
@@ -183,6 +200,15 @@ class SmallMap final {
         map_.emplace_back(std::piecewise_construct, std::forward_as_tuple(key),
                           std::forward_as_tuple(std::forward<Args>(args)...));
 
+    if constexpr (kIndexable) {
+      // Keep the index at most half full, so that probe sequences stay short.
+      if (index_.empty() ? size() > kIndexThreshold : size() * 2 > index_.size()) {
+        rebuild_index();
+      } else if (!index_.empty()) {
+        index_[find_slot(key)] = size();
+      }
+    }
+
     if constexpr (static_capacity() > 0) {
       return {&ref_or_it, true};
     } else {
@@ -238,21 +264,94 @@ class SmallMap final {
   //
   // All iterators are invalidated.
   //
-  void clear() { map_.clear(); }
+  void clear() {
+    map_.clear();
+    if constexpr (kIndexable) index_.clear();
+  }
 
  private:
+  static constexpr bool kIndexable =
+      (std::is_integral_v<K> || std::is_enum_v<K>) && std::is_same_v<KeyEqual, std::equal_to<K>>;
+
+  // The hash index maps slots to 1-based positions in map_, and 0 to an empty slot. Its size is a
+  // power of two, and collisions are resolved by linear probing.
+  using Index = std::vector<size_type>;
+  struct NoIndex {};
+
   iterator find(const key_type& key, iterator first) {
     return std::find_if(first, end(),
                         [&key](const auto& pair) { return KeyEqual{}(pair.first, key); });
   }
 
   bool erase(const key_type& key, iterator first) {
+    if constexpr (kIndexable) {
+      if (!index_.empty() && first == begin()) {
+        const size_type slot = find_slot(key);
+        const size_type position = index_[slot];
+        if (position == 0) return false;
+
+        // unstable_erase moves the last mapping into the erased position.
+        erase_slot(slot);
+        if (position != size()) {
+          index_[find_slot(map_.back().first)] = position;
+        }
+        map_.unstable_erase(begin() + (position - 1));
+        return true;
+      }
+    }
+
     const auto it = find(key, first);
     if (it == end()) return false;
     map_.unstable_erase(it);
     return true;
   }
 
+  static size_type hash(const key_type& key) {
+    std::uint64_t value;
+    if constexpr (std::is_enum_v<K>) {
+      value = static_cast<std::uint64_t>(static_cast<std::underlying_type_t<K>>(key));
+    } else {
+      value = static_cast<std::uint64_t>(key);
+    }
+    // Fibonacci hashing, so that neither consecutive keys nor keys that only differ in their high
+    // bits collide.
+    return static_cast<size_type>((value * 0x9e3779b97f4a7c15u) >> 32);
+  }
+
+  // Returns the slot of the given key, or the empty slot where it would be inserted.
+  size_type find_slot(const key_type& key) const {
+    const size_type mask = index_.size() - 1;
+    for (size_type slot = hash(key) & mask;; slot = (slot + 1) & mask) {
+      const size_type position = index_[slot];
+      if (position == 0 || map_[position - 1].first == key) return slot;
+    }
+  }
+
+  // Empties the slot, and shifts back the mappings after it that would no longer be found.
+  void erase_slot(size_type slot) {
+    const size_type mask = index_.size() - 1;
+    for (size_type next = (slot + 1) & mask; index_[next] != 0; next = (next + 1) & mask) {
+      const size_type home = hash(map_[index_[next] - 1].first) & mask;
+      if (((next - home) & mask) >= ((next - slot) & mask)) {
+        index_[slot] = index_[next];
+        slot = next;
+      }
+    }
+    index_[slot] = 0;
+  }
+
+  void rebuild_index() {
+    if constexpr (kIndexable) {
+      size_type capacity = 2 * kIndexThreshold;
+      while (capacity < size() * 2) capacity *= 2;
+
+      index_.assign(capacity, 0);
+      for (size_type position = 0; position < size(); ++position) {
+        index_[find_slot(map_[position].first)] = position + 1;
+      }
+    }
+  }
+
   void deduplicate() {
     for (auto it = begin(); it != end();) {
       if (const auto key = it->first; ++it != end()) {
@@ -262,6 +361,7 @@ class SmallMap final {
   }
 
   Map map_;
+  std::conditional_t<kIndexable, Index, NoIndex> index_;
 };
 
 // Deduction guide for in-place constructor.
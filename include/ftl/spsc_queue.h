@@ -0,0 +1,141 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace android::ftl {
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread. Elements are
+// stored inline in a ring of N slots, so neither pushing nor popping allocates. N must be a power
+// of two.
+//
+// The producer may only call try_emplace and try_push, and the consumer may only call try_pop and
+// front. Other member functions may be called from either thread, but their results are stale as
+// soon as they return.
+//
+// Example usage:
+//
+//   ftl::SpscQueue<int, 4> queue;
+//   assert(queue.empty());
+//
+//   assert(queue.try_push(1));
+//   assert(queue.try_emplace(2));
+//   assert(queue.size() == 2u);
+//
+//   assert(queue.try_pop() == 1);
+//   assert(queue.try_pop() == 2);
+//   assert(!queue.try_pop());
+//
+template <typename T, std::size_t N>
+class SpscQueue final {
+  static_assert(N > 0 && (N & (N - 1)) == 0, "Capacity must be a power of two");
+
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+
+  SpscQueue() = default;
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  ~SpscQueue() {
+    while (try_pop());
+  }
+
+  static constexpr size_type capacity() { return N; }
+
+  size_type size() const {
+    // Load the head first, since it never passes the tail.
+    const size_type head = head_.load(std::memory_order_acquire);
+    return tail_.load(std::memory_order_acquire) - head;
+  }
+
+  bool empty() const { return size() == 0; }
+
+  // Constructs an element at the back of the queue, unless the queue is full. Returns whether the
+  // element was constructed.
+  template <typename... Args>
+  bool try_emplace(Args&&... args) {
+    const size_type tail = tail_.load(std::memory_order_relaxed);
+    if (tail - cached_head_ == N) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (tail - cached_head_ == N) return false;
+    }
+
+    new (&slots_[tail % N].value) T(std::forward<Args>(args)...);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // If the queue is full, the value is not moved from, so pushing can be retried.
+  bool try_push(const T& value) { return try_emplace(value); }
+  bool try_push(T&& value) { return try_emplace(std::move(value)); }
+
+  // Returns the element at the front of the queue, or nullptr if the queue is empty. The element
+  // remains valid until it is popped.
+  T* front() {
+    const size_type head = head_.load(std::memory_order_relaxed);
+    if (head == cached_tail_) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (head == cached_tail_) return nullptr;
+    }
+    return &slots_[head % N].value;
+  }
+
+  // Removes and returns the element at the front of the queue, or std::nullopt if it is empty.
+  std::optional<T> try_pop() {
+    T* const element = front();
+    if (!element) return std::nullopt;
+
+    std::optional<T> value(std::move(*element));
+    element->~T();
+    head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    return value;
+  }
+
+ private:
+  // Avoid false sharing between the producer and consumer.
+  static constexpr std::size_t kCacheLineSize = 64;
+
+  union Slot {
+    Slot() {}
+    ~Slot() {}
+
+    T value;
+  };
+
+  // Owned by the consumer, along with its copy of the tail, which it only reloads when the queue
+  // seems empty.
+  alignas(kCacheLineSize) std::atomic<size_type> head_ = 0;
+  size_type cached_tail_ = 0;
+
+  // Owned by the producer, along with its copy of the head, which it only reloads when the queue
+  // seems full.
+  alignas(kCacheLineSize) std::atomic<size_type> tail_ = 0;
+  size_type cached_head_ = 0;
+
+  alignas(kCacheLineSize) Slot slots_[N];
+};
+
+}  // namespace android::ftl
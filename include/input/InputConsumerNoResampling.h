@@ -19,6 +19,7 @@
 #include <map>
 #include <memory>
 #include <optional>
+#include <vector>
 
 #include <input/Input.h>
 #include <input/InputTransport.h>
@@ -193,13 +194,42 @@ private:
      * notify InputConsumerCallbacks.
      */
     void handleMessages(std::vector<InputMessage>&& messages);
+    /**
+     * A queue of batched messages. Its storage is kept when it is drained, so that batching a
+     * continuous stream of input does not allocate on every frame.
+     */
+    class MessageBatch {
+    public:
+        bool empty() const { return mFront == mMessages.size(); }
+        const InputMessage& front() const { return mMessages[mFront]; }
+        void push(const InputMessage& msg) { mMessages.push_back(msg); }
+        void pop() { mFront++; }
+        /**
+         * Releases the slots of the popped messages for reuse.
+         */
+        void compact();
+        std::vector<InputMessage>::const_iterator begin() const {
+            return mMessages.begin() + mFront;
+        }
+        std::vector<InputMessage>::const_iterator end() const { return mMessages.end(); }
+
+    private:
+        std::vector<InputMessage> mMessages;
+        // The index of the oldest message that has not been popped.
+        size_t mFront = 0;
+    };
     /**
      * Batched InputMessages, per deviceId.
      * For each device, we are storing a queue of batched messages. These will all be collapsed into
      * a single MotionEvent (up to a specific requestedFrameTime) when the consumer calls
-     * `consumeBatchedInputEvents`.
+     * `consumeBatchedInputEvents`. The batch of a device is kept once it is empty so that its
+     * storage is reused.
+     */
+    std::map<DeviceId, MessageBatch> mBatches;
+    /**
+     * Whether any device has batched messages.
      */
-    std::map<DeviceId, std::queue<InputMessage>> mBatches;
+    bool hasPendingBatches() const;
     /**
      * Creates a MotionEvent by consuming samples from the provided queue. If one message has
      * eventTime > adjustedFrameTime, all subsequent messages in the queue will be skipped. It is
@@ -209,7 +239,7 @@ private:
      * @param messages the queue of messages to consume from
      */
     std::pair<std::unique_ptr<MotionEvent>, std::optional<uint32_t>> createBatchedMotionEvent(
-            const nsecs_t requestedFrameTime, std::queue<InputMessage>& messages);
+            const nsecs_t requestedFrameTime, MessageBatch& messages);
 
     /**
      * Consumes the batched input events, optionally allowing the caller to specify a device id
@@ -419,6 +419,13 @@ extern std::string getInputDeviceConfigurationFilePathByDeviceIdentifier(
 extern std::string getInputDeviceConfigurationFilePathByName(
         const std::string& name, InputDeviceConfigurationFileType type);
 
+/*
+ * Results of searching the read-only system locations are cached for the lifetime of the process,
+ * since those locations only change across reboots. User installed configuration files are always
+ * searched again. Drops the cached results, e.g. after the configuration files were updated.
+ */
+extern void clearInputDeviceConfigurationFilePathCache();
+
 enum ReservedInputDeviceId : int32_t {
     // Device id representing an invalid device
     INVALID_INPUT_DEVICE_ID = android::os::IInputConstants::INVALID_INPUT_DEVICE_ID,
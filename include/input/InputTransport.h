@@ -30,6 +30,7 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <android-base/chrono_utils.h>
 #include <android-base/result.h>
@@ -40,6 +41,7 @@
 #include <input/Input.h>
 #include <input/InputVerifier.h>
 #include <sys/stat.h>
+#include <span>
 #include <ui/Transform.h>
 #include <utils/BitSet.h>
 #include <utils/Errors.h>
@@ -265,6 +267,16 @@ public:
      */
     virtual status_t sendMessage(const InputMessage* msg);
 
+    /* Send the messages in |msgs|, in order, using a single system call where the platform
+     * supports it.
+     *
+     * Return the number of messages sent from the front of |msgs|, which is at least 1, on
+     * success. Fewer messages than requested may be sent if the channel fills up, or if |msgs|
+     * holds more messages than can be sent at once; the remaining messages were not sent.
+     * Return the same errors as sendMessage if not even the first message could be sent.
+     */
+    virtual android::base::Result<size_t> sendMessages(std::span<const InputMessage> msgs);
+
     /* Receive a message sent by the other endpoint.
      *
      * If there is no message present, try again after poll() indicates that the fd
@@ -277,6 +289,15 @@ public:
      */
     virtual android::base::Result<InputMessage> receiveMessage();
 
+    /* Receive up to |outMessages.size()| messages sent by the other endpoint, using a single
+     * system call where the platform supports it.
+     *
+     * Return the number of messages stored at the front of |outMessages|, which is at least 1,
+     * on success.
+     * Return the same errors as receiveMessage otherwise.
+     */
+    virtual android::base::Result<size_t> receiveMessages(std::span<InputMessage> outMessages);
+
     /* Tells whether there is a message in the channel available to be received.
      *
      * This is only a performance hint and may return false negative results. Clients should not
@@ -329,6 +350,11 @@ protected:
 private:
     static std::unique_ptr<InputChannel> create(const std::string& name,
                                                 android::base::unique_fd fd, sp<IBinder> token);
+
+    status_t sendErrorToStatus(int error, const InputMessage& msg) const;
+    status_t receiveErrorToStatus(int error) const;
+    // Returns OK if |msg| is a valid message of |nRead| bytes.
+    status_t checkReceivedMessage(const InputMessage& msg, size_t nRead) const;
 };
 
 /*
@@ -379,6 +405,23 @@ public:
                                 const PointerProperties* pointerProperties,
                                 const PointerCoords* pointerCoords);
 
+    /* Starts a batch of motion events. Until endMotionBatch is called, publishMotionEvent
+     * validates each event and appends it to the batch instead of sending it. It then returns OK,
+     * or BAD_VALUE if the event is invalid.
+     */
+    void beginMotionBatch();
+
+    /* Sends the motion events batched since beginMotionBatch, in order, with as few system calls
+     * as possible, and ends the batch.
+     *
+     * Returns the number of events sent from the front of the batch on success. It can be lower
+     * than the size of the batch if the channel fills up; the other events were not sent and must
+     * be published again.
+     * Returns the errors of publishMotionEvent if not even the first event could be sent,
+     * including BAD_VALUE if the verifier is enabled and the event failed verification.
+     */
+    android::base::Result<size_t> endMotionBatch();
+
     /* Publishes a focus event to the input channel.
      *
      * Returns OK on success.
@@ -452,6 +495,13 @@ public:
 private:
     std::shared_ptr<InputChannel> mChannel;
     InputVerifier mInputVerifier;
+
+    // Verifies a batched motion event and sends it on its own.
+    android::base::Result<size_t> verifyAndSendMotion(const InputMessage& msg);
+
+    bool mBatchingMotions = false;
+    // Kept across batches so that its storage is reused.
+    std::vector<InputMessage> mMotionBatch;
 };
 
 } // namespace android
@@ -18,6 +18,8 @@
 
 #include <android-base/result.h>
 #include <input/Input.h>
+#include <array>
+#include <unordered_map>
 #include "rust/cxx.h"
 
 namespace android {
@@ -55,6 +57,18 @@ public:
 
 private:
     rust::Box<android::input::verifier::InputVerifier> mVerifier;
+    const bool mShouldLog;
+
+    // The last ACTION_MOVE of a device that the rust verifier accepted. ACTION_MOVE does not change
+    // the verifier state, so an identical ACTION_MOVE that follows is accepted without crossing into
+    // rust. Any other action on the device drops the entry.
+    struct AcceptedMove {
+        int32_t source;
+        int32_t flags;
+        uint32_t pointerCount;
+        std::array<int32_t, MAX_POINTERS> pointerIds;
+    };
+    std::unordered_map<int32_t /*deviceId*/, AcceptedMove> mAcceptedMoves;
 };
 
 } // namespace android
@@ -21,8 +21,10 @@
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <span>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <android-base/result.h>
 #include <android-base/thread_annotations.h>
@@ -103,10 +105,18 @@ public:
      *
      * reportAtomFunction: the function that will be called to report prediction metrics. If
      * omitted, the implementation will choose a default metrics reporting mechanism.
+     *
+     * asyncInference: whether to run the prediction model on a dedicated thread. The model then
+     * runs whenever an event is recorded, instead of when a prediction is requested, and predict
+     * returns a prediction made from the latest inference that completed. This keeps the latency
+     * of the model out of the thread that handles input events, at the cost of predicting from
+     * inputs that may be one event old.
      */
     MotionPredictor(nsecs_t predictionTimestampOffsetNanos,
                     std::function<bool()> checkEnableMotionPrediction = isMotionPredictionEnabled,
-                    ReportAtomFunction reportAtomFunction = {});
+                    ReportAtomFunction reportAtomFunction = {}, bool asyncInference = false);
+
+    ~MotionPredictor();
 
     /**
      * Record the actual motion received by the view. This event will be used for calculating the
@@ -122,10 +132,44 @@ public:
     bool isPredictionAvailable(int32_t deviceId, int32_t source);
 
 private:
+    // The model outputs to build a prediction from, with the model inputs they were computed for.
+    struct ModelOutput {
+        std::span<const float> r;
+        std::span<const float> phi;
+        std::span<const float> pressure;
+        TfLiteMotionPredictorSample::Point axisFrom;
+        TfLiteMotionPredictorSample::Point axisTo;
+        int64_t lastTimestamp;
+    };
+
+    // The result of running the model on the inference thread.
+    struct Inference {
+        std::vector<float> r;
+        std::vector<float> phi;
+        std::vector<float> pressure;
+        TfLiteMotionPredictorSample::Point axisFrom;
+        TfLiteMotionPredictorSample::Point axisTo;
+        int64_t lastTimestamp;
+        // The time it took to run the model.
+        nsecs_t latency;
+        // The gesture whose events the model was run on.
+        uint64_t gestureId;
+    };
+
+    class InferenceThread;
+
     const nsecs_t mPredictionTimestampOffsetNanos;
     const std::function<bool()> mCheckMotionPredictionEnabled;
+    const bool mAsyncInference;
 
     std::unique_ptr<TfLiteMotionPredictorModel> mModel;
+    // Only set with asyncInference. Declared after mModel, which it uses, so that it is destroyed
+    // first.
+    std::unique_ptr<InferenceThread> mInferenceThread;
+    // Identifies the current gesture, so that inferences made for a previous gesture are ignored.
+    uint64_t mGestureId = 0;
+    // The latest inference received from mInferenceThread for the current gesture.
+    std::optional<Inference> mLatestInference;
 
     std::unique_ptr<TfLiteMotionPredictorBuffers> mBuffers;
     std::optional<MotionEvent> mLastEvent;
@@ -140,6 +184,10 @@ private:
     // Called during lazy initialization.
     // TODO: b/210158587 Consider removing lazy initialization.
     void initializeObjects();
+
+    // Returns the predicted MotionEvent up to timestamp for the given model output, or nullptr if
+    // nothing could be predicted.
+    std::unique_ptr<MotionEvent> createPrediction(const ModelOutput& output, nsecs_t timestamp);
 };
 
 } // namespace android
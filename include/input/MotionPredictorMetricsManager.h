@@ -51,6 +51,13 @@ public:
 
     static void defaultReportAtomFunction(const AtomFields& atomFields);
 
+    struct InferenceLatencyPercentiles;
+
+    using ReportInferenceLatencyFunction = std::function<void(const InferenceLatencyPercentiles&)>;
+
+    // Logs the percentiles at debug level.
+    static void defaultReportInferenceLatencyFunction(const InferenceLatencyPercentiles& latencies);
+
     // Parameters:
     //  • predictionInterval: the time interval between successive prediction target timestamps.
     //    Note: the MetricsManager assumes that the input interval equals the prediction interval.
@@ -59,10 +66,15 @@ public:
     //  • [Optional] reportAtomFunction: the function that will be called to report metrics. If
     //    omitted (or if an empty function is given), the `stats_write(…)` function from the Android
     //    stats library will be used.
+    //  • [Optional] reportInferenceLatencyFunction: the function that will be called at the end of
+    //    each stroke with the latency percentiles of the model inferences made during the stroke.
+    //    If omitted (or if an empty function is given), the percentiles are logged.
     MotionPredictorMetricsManager(
             nsecs_t predictionInterval,
             size_t maxNumPredictions,
-            ReportAtomFunction reportAtomFunction = defaultReportAtomFunction);
+            ReportAtomFunction reportAtomFunction = defaultReportAtomFunction,
+            ReportInferenceLatencyFunction reportInferenceLatencyFunction =
+                    defaultReportInferenceLatencyFunction);
 
     // This method should be called once for each call to MotionPredictor::record, receiving the
     // forwarded MotionEvent argument.
@@ -72,6 +84,10 @@ public:
     // MotionEvent that will be returned by MotionPredictor::predict.
     void onPredict(const MotionEvent& predictionEvent);
 
+    // This method should be called once for each run of the prediction model whose outputs are
+    // used, with the time it took to run the model.
+    void onInference(nsecs_t inferenceLatency);
+
     // Simple structs to hold relevant touch input information. Public so they can be used in tests.
 
     struct TouchPoint {
@@ -157,6 +173,15 @@ public:
         int scaleInvariantOffTrajectoryRmse = NO_DATA_SENTINEL;   // millipixels
     };
 
+    // Latency percentiles of the model inferences made during one stroke. The percentiles are
+    // computed with the nearest-rank method.
+    struct InferenceLatencyPercentiles {
+        size_t inferenceCount = 0;
+        nsecs_t p50 = 0;
+        nsecs_t p90 = 0;
+        nsecs_t p99 = 0;
+    };
+
 private:
     // The interval between consecutive predictions' target timestamps. We assume that the input
     // interval also equals this value.
@@ -182,6 +207,11 @@ private:
 
     const ReportAtomFunction mReportAtomFunction;
 
+    // The latencies of the model inferences made during the current stroke.
+    std::vector<nsecs_t> mInferenceLatencies;
+
+    const ReportInferenceLatencyFunction mReportInferenceLatencyFunction;
+
     // Helper methods for the implementation of onRecord and onPredict.
 
     // Clears stored ground truth and prediction points, as well as all stored metrics for the
@@ -197,6 +227,9 @@ private:
     // timestamp, computes the corresponding metrics and updates mAggregatedMetrics.
     void updateAggregatedMetrics(const PredictionPoint& predictionPoint);
 
+    // Reports the percentiles of mInferenceLatencies, if there are any.
+    void reportInferenceLatencies();
+
     // Computes the atom fields to mAtomFields from the values in mAggregatedMetrics.
     void computeAtomFields();
 
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include <android-base/thread_annotations.h>
+
+namespace android {
+
+/**
+ * Identifies the contents of a file on disk without reading it. A file that is replaced, or
+ * edited in place, gets a new identity.
+ */
+struct FileIdentity {
+    dev_t device;
+    ino_t inode;
+    off_t size;
+    int64_t modificationTimeNanos;
+
+    bool operator==(const FileIdentity&) const = default;
+
+    // Returns std::nullopt if the file cannot be stat'ed.
+    static std::optional<FileIdentity> of(const std::string& path) {
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0) {
+            return std::nullopt;
+        }
+#if defined(__APPLE__)
+        const struct timespec& mtime = st.st_mtimespec;
+#else
+        const struct timespec& mtime = st.st_mtim;
+#endif
+        return FileIdentity{.device = st.st_dev,
+                            .inode = st.st_ino,
+                            .size = st.st_size,
+                            .modificationTimeNanos =
+                                    int64_t(mtime.tv_sec) * 1'000'000'000 + mtime.tv_nsec};
+    }
+};
+
+/**
+ * A thread-safe cache of objects parsed from files, keyed by path and FileIdentity, so that a file
+ * that is loaded again, for example when an input device is reconnected or when several devices
+ * share a layout, is only parsed again if it changed. Up to <i>capacity</i> objects are kept; the
+ * least recently used one is evicted first.
+ */
+template <class T>
+class ParsedFileCache {
+public:
+    explicit ParsedFileCache(size_t capacity) : mCapacity(capacity) {}
+
+    // Returns the object parsed from the file at path, or nullptr if the file was not parsed
+    // since it last changed.
+    std::shared_ptr<T> find(const std::string& path, const FileIdentity& identity) {
+        std::scoped_lock lock(mLock);
+        for (auto it = mEntries.begin(); it != mEntries.end(); it++) {
+            if (it->path == path) {
+                if (!(it->identity == identity)) {
+                    mEntries.erase(it);
+                    return nullptr;
+                }
+                // Move to the front, as the most recently used entry.
+                mEntries.splice(mEntries.begin(), mEntries, it);
+                return it->object;
+            }
+        }
+        return nullptr;
+    }
+
+    void insert(const std::string& path, const FileIdentity& identity, std::shared_ptr<T> object) {
+        std::scoped_lock lock(mLock);
+        mEntries.remove_if([&path](const Entry& entry) { return entry.path == path; });
+        mEntries.push_front({.path = path, .identity = identity, .object = std::move(object)});
+        if (mEntries.size() > mCapacity) {
+            mEntries.pop_back();
+        }
+    }
+
+    void clear() {
+        std::scoped_lock lock(mLock);
+        mEntries.clear();
+    }
+
+    size_t size() const {
+        std::scoped_lock lock(mLock);
+        return mEntries.size();
+    }
+
+private:
+    struct Entry {
+        std::string path;
+        FileIdentity identity;
+        std::shared_ptr<T> object;
+    };
+
+    const size_t mCapacity;
+    mutable std::mutex mLock;
+    // Ordered from the most to the least recently used.
+    std::list<Entry> mEntries GUARDED_BY(mLock);
+};
+
+} // namespace android
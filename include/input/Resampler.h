@@ -16,9 +16,9 @@
 
 #pragma once
 
+#include <array>
 #include <chrono>
 #include <optional>
-#include <vector>
 
 #include <input/Input.h>
 #include <input/InputTransport.h>
@@ -73,22 +73,15 @@ public:
     std::chrono::nanoseconds getResampleLatency() const override;
 
 private:
-    struct Pointer {
-        PointerProperties properties;
-        PointerCoords coords;
-    };
-
+    /**
+     * A sample of every pointer of a MotionEvent. The pointers are stored inline, so that keeping
+     * and resampling samples does not allocate.
+     */
     struct Sample {
         std::chrono::nanoseconds eventTime;
-        std::vector<Pointer> pointers;
-
-        std::vector<PointerCoords> asPointerCoords() const {
-            std::vector<PointerCoords> pointersCoords;
-            for (const Pointer& pointer : pointers) {
-                pointersCoords.push_back(pointer.coords);
-            }
-            return pointersCoords;
-        }
+        size_t pointerCount = 0;
+        std::array<PointerProperties, MAX_POINTERS> properties;
+        std::array<PointerCoords, MAX_POINTERS> coords;
     };
 
     /**
@@ -125,7 +118,7 @@ private:
      * take place if samples are too far apart in time. mLatestSamples must have at least one sample
      * when canInterpolate is invoked.
      */
-    bool canInterpolate(const InputMessage& futureSample) const;
+    bool canInterpolate(const Sample& futureSample) const;
 
     /**
      * Returns a sample interpolated between the latest sample of mLatestSamples and futureSample,
@@ -149,6 +142,13 @@ private:
      */
     std::optional<Sample> attemptExtrapolation(std::chrono::nanoseconds resampleTime) const;
 
+    /**
+     * Returns a sample at resampleTime with the pointers of target, whose coordinates are linearly
+     * interpolated between a and b, or extrapolated past b if alpha is greater than 1.
+     */
+    static Sample resampleCoords(const Sample& target, const Sample& a, const Sample& b,
+                                 float alpha, std::chrono::nanoseconds resampleTime);
+
     inline static void addSampleToMotionEvent(const Sample& sample, MotionEvent& motionEvent);
 };
 } // namespace android
@@ -21,7 +21,9 @@
 #include <input/RingBuffer.h>
 #include <utils/BitSet.h>
 #include <utils/Timers.h>
+#include <array>
 #include <map>
+#include <optional>
 #include <set>
 
 namespace android {
@@ -98,6 +100,8 @@ public:
     void addMovement(nsecs_t eventTime, int32_t pointerId, int32_t axis, float position);
 
     // Adds movement information for all pointers in a MotionEvent, including historical samples.
+    // This is equivalent to calling addMovement for every pointer, axis and sample of the event,
+    // but looks up the strategy of each axis once per event rather than once per value.
     void addMovement(const MotionEvent& event);
 
     // Returns the velocity of the specified pointer id and axis in position units per second.
@@ -128,6 +132,11 @@ private:
     std::map<int32_t /*axis*/, std::unique_ptr<VelocityTrackerStrategy>> mConfiguredStrategies;
 
     void configureStrategy(int32_t axis);
+    VelocityTrackerStrategy& getOrConfigureStrategy(int32_t axis);
+
+    // Updates the pointer state for a sample of the given pointer. Returns true if the
+    // configured strategies were cleared because the pointers had stopped moving.
+    bool startSample(nsecs_t eventTime, int32_t pointerId);
 
     // Generates a VelocityTrackerStrategy instance for the given Strategy type.
     // The `deltaValues` parameter indicates whether or not the created strategy should treat motion
@@ -175,6 +184,9 @@ protected:
     // protected const field.
     static constexpr uint32_t HISTORY_SIZE = 20;
 
+    // Returns the movements of the given pointer, or nullptr if there are none.
+    const RingBuffer<Movement>* getMovements(int32_t pointerId) const;
+
     /**
      * Duration, in nanoseconds, since the latest movement where a movement may be considered for
      * velocity calculation.
@@ -185,7 +197,11 @@ protected:
      * addition of a new movement.
      */
     const bool mMaintainHorizonDuringAdd;
-    std::map<int32_t /*pointerId*/, RingBuffer<Movement>> mMovements;
+
+private:
+    // Indexed by pointer id. The buffer of a cleared pointer is kept, so that a pointer going
+    // down again does not allocate.
+    std::array<std::optional<RingBuffer<Movement>>, MAX_POINTER_ID + 1> mMovements;
 };
 
 /*
@@ -220,7 +236,7 @@ private:
     // changes in direction.
     static const nsecs_t HORIZON = 100 * 1000000; // 100 ms
 
-    float chooseWeight(int32_t pointerId, uint32_t index) const;
+    float chooseWeight(const RingBuffer<Movement>& movements, uint32_t index) const;
     /**
      * An optimized least-squares solver for degree 2 and no weight (i.e. `Weighting.NONE`).
      * The provided container of movements shall NOT be empty, and shall have the movements in
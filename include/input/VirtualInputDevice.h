@@ -18,7 +18,10 @@
 
 #include <android-base/unique_fd.h>
 #include <input/Input.h>
+#include <linux/input.h>
 #include <map>
+#include <span>
+#include <vector>
 
 namespace android {
 
@@ -52,10 +55,18 @@ protected:
     const android::base::unique_fd mFd;
     bool writeInputEvent(uint16_t type, uint16_t code, int32_t value,
                          std::chrono::nanoseconds eventTime);
+    // Between these calls, writeInputEvent() only queues the events. endBatch() writes the queued
+    // events to the device with a single write if commit is true, and drops them otherwise.
+    void beginBatch();
+    bool endBatch(bool commit);
     bool writeEvKeyEvent(int32_t androidCode, int32_t androidAction,
                          const std::map<int, int>& evKeyCodeMapping,
                          const std::map<int, UinputAction>& actionMapping,
                          std::chrono::nanoseconds eventTime);
+
+private:
+    bool mBatching = false;
+    std::vector<input_event> mBatchedEvents;
 };
 
 class VirtualKeyboard : public VirtualInputDevice {
@@ -108,6 +119,20 @@ public:
                          float locationY, float pressure, float majorAxisSize,
                          std::chrono::nanoseconds eventTime);
 
+    struct TouchPointer {
+        int32_t pointerId;
+        int32_t toolType;
+        int32_t action;
+        float locationX;
+        float locationY;
+        float pressure;
+        float majorAxisSize;
+    };
+    // Writes the pointers as one frame, i.e. with a single SYN_REPORT, in a single write to the
+    // device. Nothing is written if any of the pointers is invalid.
+    bool writeTouchFrame(std::span<const TouchPointer> pointers,
+                         std::chrono::nanoseconds eventTime);
+
 private:
     static const std::map<int, int> TOOL_TYPE_MAPPING;
     /* The set of active touch pointers on this device.
@@ -117,6 +142,7 @@ private:
      */
     std::bitset<MAX_POINTERS> mActivePointers{};
     bool isValidPointerId(int32_t pointerId, UinputAction uinputAction);
+    bool writeTouchPointer(const TouchPointer& pointer, std::chrono::nanoseconds eventTime);
     bool handleTouchDown(int32_t pointerId, std::chrono::nanoseconds eventTime);
     bool handleTouchUp(int32_t pointerId, std::chrono::nanoseconds eventTime);
 };
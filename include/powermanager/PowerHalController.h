@@ -25,6 +25,12 @@
 #include <powermanager/PowerHalWrapper.h>
 #include <powermanager/PowerHintSessionWrapper.h>
 
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <optional>
+#include <thread>
+
 namespace android {
 
 namespace power {
@@ -53,10 +59,20 @@ public:
     PowerHalController() : PowerHalController(std::make_unique<HalConnector>()) {}
     explicit PowerHalController(std::unique_ptr<HalConnector> connector)
           : mHalConnector(std::move(connector)) {}
-    virtual ~PowerHalController() = default;
+    virtual ~PowerHalController();
 
     virtual void init();
 
+    // Queues a setBoost call to be made on a worker thread, so that the caller doesn't wait for
+    // the Power HAL. A boost identical to one still in the queue is dropped. Failures are
+    // handled as for setBoost, but are not reported to the caller.
+    virtual void setBoostAsync(aidl::android::hardware::power::Boost boost, int32_t durationMs);
+    // Queues a setMode call like setBoostAsync. Calls that would not change the state last
+    // requested for the mode through this method are dropped.
+    virtual void setModeAsync(aidl::android::hardware::power::Mode mode, bool enabled);
+    // Waits until all the calls queued by setBoostAsync and setModeAsync have been made.
+    virtual void flushAsyncCalls();
+
     virtual HalResult<void> setBoost(aidl::android::hardware::power::Boost boost,
                                      int32_t durationMs) override;
     virtual HalResult<void> setMode(aidl::android::hardware::power::Mode mode,
@@ -74,6 +90,18 @@ public:
     virtual HalResult<void> closeSessionChannel(int tgid, int uid) override;
 
 private:
+    static constexpr size_t kModeCount =
+            static_cast<size_t>(
+                    *(ndk::enum_range<aidl::android::hardware::power::Mode>().end() - 1)) +
+            1;
+
+    struct AsyncCall {
+        std::optional<aidl::android::hardware::power::Boost> boost;
+        std::optional<aidl::android::hardware::power::Mode> mode;
+        // Duration of the boost, or whether the mode is enabled.
+        int32_t value;
+    };
+
     std::mutex mConnectedHalMutex;
     std::unique_ptr<HalConnector> mHalConnector;
 
@@ -81,10 +109,27 @@ private:
     // different threads
     std::shared_ptr<HalWrapper> mConnectedHal GUARDED_BY(mConnectedHalMutex) = nullptr;
     const std::shared_ptr<HalWrapper> mDefaultHal = std::make_shared<EmptyHalWrapper>();
+    // The rate is fixed for a Power HAL, so it is only queried again after reconnecting.
+    std::optional<int64_t> mHintSessionPreferredRate GUARDED_BY(mConnectedHalMutex);
+
+    // Calls queued by setBoostAsync and setModeAsync, made in order by mAsyncThread.
+    std::mutex mAsyncMutex;
+    std::condition_variable mAsyncCondition;
+    std::deque<AsyncCall> mAsyncCalls GUARDED_BY(mAsyncMutex);
+    bool mAsyncCallRunning GUARDED_BY(mAsyncMutex) = false;
+    bool mAsyncThreadExit GUARDED_BY(mAsyncMutex) = false;
+    // Started by the first async call.
+    std::thread mAsyncThread GUARDED_BY(mAsyncMutex);
+    // State last requested for each mode through setModeAsync. Cleared when a call fails, or
+    // when setMode is called directly, since the Power HAL may no longer be in that state.
+    std::array<std::optional<bool>, kModeCount> mAsyncModeStates GUARDED_BY(mAsyncMutex);
 
     std::shared_ptr<HalWrapper> initHal();
     template <typename T>
     HalResult<T> processHalResult(HalResult<T>&& result, const char* functionName);
+    void queueAsyncCall(AsyncCall call) REQUIRES(mAsyncMutex);
+    void runAsyncCalls();
+    void clearAsyncModeState(std::optional<aidl::android::hardware::power::Mode> mode);
 };
 
 // -------------------------------------------------------------------------------------------------
@@ -25,13 +25,16 @@
 #include <android-base/thread_annotations.h>
 #include "HalResult.h"
 
+#include <mutex>
+#include <vector>
+
 namespace android::power {
 
 // Wrapper for power hint sessions, which allows for better mocking,
 // support checking, and failure handling than using hint sessions directly
 class PowerHintSessionWrapper {
 public:
-    virtual ~PowerHintSessionWrapper() = default;
+    virtual ~PowerHintSessionWrapper();
     PowerHintSessionWrapper(
             std::shared_ptr<aidl::android::hardware::power::IPowerHintSession>&& session);
     virtual HalResult<void> updateTargetWorkDuration(int64_t in_targetDurationNanos);
@@ -46,9 +49,26 @@ public:
                                     bool in_enabled);
     virtual HalResult<aidl::android::hardware::power::SessionConfig> getSessionConfig();
 
+    // Batches reportActualWorkDuration calls, for sessions whose durations don't need to reach
+    // the HAL every frame. Reported durations are held until maxDurations of them are held, or
+    // the newest is maxDelayNanos newer than the oldest, and then sent in a single call. Other
+    // calls to the session send the held durations first, so that the HAL sees them in order.
+    // A maxDurations of 1, the default, sends every report right away.
+    virtual void setReportBatching(size_t maxDurations, int64_t maxDelayNanos);
+    // Sends the durations held for batching, if any.
+    virtual HalResult<void> flushActualWorkDurations();
+
 private:
+    HalResult<void> flushActualWorkDurationsLocked() REQUIRES(mHeldDurationsMutex);
+
     std::shared_ptr<aidl::android::hardware::power::IPowerHintSession> mSession;
     int32_t mInterfaceVersion;
+
+    std::mutex mHeldDurationsMutex;
+    size_t mMaxBatchedDurations GUARDED_BY(mHeldDurationsMutex) = 1;
+    int64_t mMaxBatchDelayNanos GUARDED_BY(mHeldDurationsMutex) = 0;
+    std::vector<aidl::android::hardware::power::WorkDuration> mHeldDurations
+            GUARDED_BY(mHeldDurationsMutex);
 };
 
 } // namespace android::power
\ No newline at end of file
@@ -31,30 +31,52 @@ bool LongArrayMultiStateCounter::delta(const std::vector<uint64_t>& previousValu
         return false;
     }
 
+    // Branch-free, so that the compiler can vectorize the loop.
+    const uint64_t* prev = previousValue.data();
+    const uint64_t* next = newValue.data();
+    uint64_t* out = outValue->data();
     bool is_delta_valid = true;
-    for (int i = size - 1; i >= 0; i--) {
-        if (newValue[i] >= previousValue[i]) {
-            (*outValue)[i] = newValue[i] - previousValue[i];
-        } else {
-            (*outValue)[i] = 0;
-            is_delta_valid = false;
-        }
+    for (size_t i = 0; i < size; i++) {
+        bool valid = next[i] >= prev[i];
+        out[i] = valid ? next[i] - prev[i] : 0;
+        is_delta_valid &= valid;
     }
     return is_delta_valid;
 }
 
+// Products below this convert to double exactly, see add().
+static constexpr uint64_t kMaxExactProduct = 1ull << 52;
+
 template <>
 void LongArrayMultiStateCounter::add(std::vector<uint64_t>* value1,
                                      const std::vector<uint64_t>& value2, const uint64_t numerator,
                                      const uint64_t denominator) const {
+    uint64_t* out = value1->data();
+    const uint64_t* in = value2.data();
+    const size_t size = value2.size();
     if (numerator != denominator) {
-        for (int i = value2.size() - 1; i >= 0; i--) {
-            // The caller ensures that denominator != 0
-            (*value1)[i] += value2[i] * numerator / denominator;
+        // The caller ensures that denominator != 0
+        const double inverse = 1.0 / denominator;
+        for (size_t i = 0; i < size; i++) {
+            const uint64_t product = in[i] * numerator;
+            if (product >= kMaxExactProduct) {
+                out[i] += product / denominator;
+                continue;
+            }
+            // Integer division is several times slower than multiplying by the inverse.
+            // Below kMaxExactProduct the estimate is off by at most one, so correct it.
+            uint64_t quotient = static_cast<uint64_t>(product * inverse);
+            if (quotient * denominator > product) {
+                quotient--;
+            } else if (product - quotient * denominator >= denominator) {
+                quotient++;
+            }
+            out[i] += quotient;
         }
     } else {
-        for (int i = value2.size() - 1; i >= 0; i--) {
-            (*value1)[i] += value2[i];
+        // Simple enough for the compiler to vectorize.
+        for (size_t i = 0; i < size; i++) {
+            out[i] += in[i];
         }
     }
 }
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include "LongArrayMultiStateCounter.h"
+
+namespace android {
+namespace battery {
+namespace {
+
+// BatteryStats tracks per-uid CPU times in each process state, with one array element per
+// CPU frequency.
+constexpr uint16_t kStateCount = 5;
+
+void BM_LongArrayMultiStateCounter_updateValue(benchmark::State& state) {
+    const size_t size = state.range(0);
+    LongArrayMultiStateCounter counter(kStateCount, std::vector<uint64_t>(size));
+    std::vector<uint64_t> value(size);
+    time_t timestamp = 0;
+    counter.updateValue(value, timestamp);
+
+    for (auto _ : state) {
+        // Spend time in two states between updates, so that the delta is split.
+        counter.setState(0, timestamp += 100);
+        counter.setState(1, timestamp += 300);
+        for (size_t i = 0; i < size; i++) {
+            value[i] += i;
+        }
+        benchmark::DoNotOptimize(counter.updateValue(value, timestamp += 100));
+    }
+}
+BENCHMARK(BM_LongArrayMultiStateCounter_updateValue)->Arg(16)->Arg(64)->Arg(256);
+
+void BM_LongArrayMultiStateCounter_addValue(benchmark::State& state) {
+    const size_t size = state.range(0);
+    LongArrayMultiStateCounter counter(kStateCount, std::vector<uint64_t>(size));
+    const std::vector<uint64_t> increment(size, 1);
+    counter.setState(0, 0);
+
+    for (auto _ : state) {
+        counter.addValue(increment);
+        benchmark::DoNotOptimize(counter.getCount(0).data());
+    }
+}
+BENCHMARK(BM_LongArrayMultiStateCounter_addValue)->Arg(16)->Arg(64)->Arg(256);
+
+} // namespace
+} // namespace battery
+} // namespace android
+
+BENCHMARK_MAIN();
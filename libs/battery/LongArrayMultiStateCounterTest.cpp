@@ -54,6 +54,37 @@ TEST_F(LongArrayMultiStateCounterTest, accumulation) {
     EXPECT_EQ(std::vector<uint64_t>({70, 120, 170, 220}), testCounter.getCount(1));
 }
 
+TEST_F(LongArrayMultiStateCounterTest, unusedStates) {
+    LongArrayMultiStateCounter testCounter(3, std::vector<uint64_t>(4));
+    testCounter.updateValue(std::vector<uint64_t>({0, 0, 0, 0}), 1000);
+    testCounter.setState(1, 1000);
+    testCounter.updateValue(std::vector<uint64_t>({100, 200, 300, 400}), 2000);
+
+    EXPECT_EQ(std::vector<uint64_t>({0, 0, 0, 0}), testCounter.getCount(0));
+    EXPECT_EQ(std::vector<uint64_t>({100, 200, 300, 400}), testCounter.getCount(1));
+    EXPECT_EQ(std::vector<uint64_t>({0, 0, 0, 0}), testCounter.getCount(2));
+
+    testCounter.reset();
+    EXPECT_EQ(std::vector<uint64_t>({0, 0, 0, 0}), testCounter.getCount(1));
+
+    testCounter.updateValue(std::vector<uint64_t>({100, 200, 300, 400}), 3000);
+    testCounter.setState(1, 3000);
+    testCounter.updateValue(std::vector<uint64_t>({110, 220, 330, 440}), 4000);
+    EXPECT_EQ(std::vector<uint64_t>({10, 20, 30, 40}), testCounter.getCount(1));
+}
+
+TEST_F(LongArrayMultiStateCounterTest, decreasingValue) {
+    LongArrayMultiStateCounter testCounter(1, std::vector<uint64_t>(4));
+    testCounter.updateValue(std::vector<uint64_t>({100, 200, 300, 400}), 1000);
+    testCounter.setState(0, 1000);
+    const std::vector<uint64_t>& delta =
+            testCounter.updateValue(std::vector<uint64_t>({110, 190, 330, 440}), 2000);
+
+    // An array with any decreasing element is dropped entirely.
+    EXPECT_EQ(std::vector<uint64_t>({0, 0, 0, 0}), delta);
+    EXPECT_EQ(std::vector<uint64_t>({0, 0, 0, 0}), testCounter.getCount(0));
+}
+
 TEST_F(LongArrayMultiStateCounterTest, toString) {
     LongArrayMultiStateCounter testCounter(2, std::vector<uint64_t>(4));
     testCounter.updateValue(std::vector<uint64_t>({0, 0, 0, 0}), 1000);
@@ -48,6 +48,10 @@ class MultiStateCounter {
 
     struct State {
         time_t timeInStateSinceUpdate;
+        // Whether counter holds the count for this state. Until a value is added to a state,
+        // its count is emptyValue and counter is left unset, so that counters with many
+        // states, only some of which are ever entered, don't allocate a value for each.
+        bool hasCounter;
         T counter;
     };
 
@@ -114,6 +118,12 @@ private:
              const uint64_t denominator) const;
 
     std::string valueToString(const T& value) const;
+
+    /**
+     * Returns the counter of the given state, setting it to emptyValue first if it
+     * is unset.
+     */
+    T& getOrInitCounter(state_t state);
 };
 
 // ---------------------- MultiStateCounter Implementation -------------------------
@@ -132,7 +142,8 @@ MultiStateCounter<T>::MultiStateCounter(uint16_t stateCount, const T& emptyValue
     states = new State[stateCount];
     for (int i = 0; i < stateCount; i++) {
         states[i].timeInStateSinceUpdate = 0;
-        states[i].counter = emptyValue;
+        states[i].hasCounter = false;
+        states[i].counter = T();
     }
 }
 
@@ -208,7 +219,7 @@ void MultiStateCounter<T>::copyStatesFrom(const MultiStateCounter<T>& source) {
     currentState = source.currentState;
     for (int i = 0; i < stateCount; i++) {
         states[i].timeInStateSinceUpdate = source.states[i].timeInStateSinceUpdate;
-        states[i].counter = emptyValue;
+        states[i].hasCounter = false;
     }
     lastStateChangeTimestamp = source.lastStateChangeTimestamp;
     lastUpdateTimestamp = source.lastUpdateTimestamp;
@@ -217,6 +228,7 @@ void MultiStateCounter<T>::copyStatesFrom(const MultiStateCounter<T>& source) {
 template <class T>
 void MultiStateCounter<T>::setValue(state_t state, const T& value) {
     states[state].counter = value;
+    states[state].hasCounter = true;
 }
 
 template <class T>
@@ -244,7 +256,7 @@ const T& MultiStateCounter<T>::updateValue(const T& value, time_t timestamp) {
                     for (int i = 0; i < stateCount; i++) {
                         time_t timeInState = states[i].timeInStateSinceUpdate;
                         if (timeInState) {
-                            add(&states[i].counter, deltaValue, timeInState, timeSinceUpdate);
+                            add(&getOrInitCounter(i), deltaValue, timeInState, timeSinceUpdate);
                             states[i].timeInStateSinceUpdate = 0;
                         }
                     }
@@ -288,7 +300,7 @@ void MultiStateCounter<T>::addValue(const T& value) {
     if (!isEnabled) {
         return;
     }
-    add(&states[currentState].counter, value, 1 /* numerator */, 1 /* denominator */);
+    add(&getOrInitCounter(currentState), value, 1 /* numerator */, 1 /* denominator */);
 }
 
 template <class T>
@@ -297,7 +309,8 @@ void MultiStateCounter<T>::reset() {
     lastUpdateTimestamp = -1;
     for (int i = 0; i < stateCount; i++) {
         states[i].timeInStateSinceUpdate = 0;
-        states[i].counter = emptyValue;
+        // Keep the counter itself, so that it can be reused without reallocating.
+        states[i].hasCounter = false;
     }
 }
 
@@ -308,7 +321,17 @@ uint16_t MultiStateCounter<T>::getStateCount() {
 
 template <class T>
 const T& MultiStateCounter<T>::getCount(state_t state) {
-    return states[state].counter;
+    return states[state].hasCounter ? states[state].counter : emptyValue;
+}
+
+template <class T>
+T& MultiStateCounter<T>::getOrInitCounter(state_t state) {
+    State& s = states[state];
+    if (!s.hasCounter) {
+        s.counter = emptyValue;
+        s.hasCounter = true;
+    }
+    return s.counter;
 }
 
 template <class T>
@@ -319,7 +342,7 @@ std::string MultiStateCounter<T>::toString() {
         if (i != 0) {
             str << ", ";
         }
-        str << i << ": " << valueToString(states[i].counter);
+        str << i << ": " << valueToString(getCount(i));
         if (states[i].timeInStateSinceUpdate > 0) {
             str << " timeInStateSinceUpdate: " << states[i].timeInStateSinceUpdate;
         }
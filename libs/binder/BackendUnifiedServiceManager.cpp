@@ -118,7 +118,23 @@ binder::Status BackendUnifiedServiceManager::updateCache(const std::string& serv
         sp<IBinder> binder = service.get<os::Service::Tag::binder>();
         if (binder && mCacheForGetService->isClientSideCachingEnabled(serviceName) &&
             binder->isBinderAlive()) {
-            return mCacheForGetService->setItem(serviceName, binder);
+            binder::Status status = mCacheForGetService->setItem(serviceName, binder);
+            if (!status.isOk()) return status;
+
+            // Registered after the entry is added, so that the immediate
+            // callback for the current registration drops the entry if the
+            // service was replaced in between.
+            if (sp<os::IServiceCallback> callback =
+                        mCacheForGetService->takeRegistrationCallback(serviceName)) {
+                binder::Status registered =
+                        mTheRealServiceManager->registerForNotifications(serviceName, callback);
+                if (!registered.isOk()) {
+                    // Still invalidated on death.
+                    ALOGW("Failed to register for re-registration of %s: %s",
+                          serviceName.c_str(), registered.toString8().c_str());
+                }
+            }
+            return status;
         }
     }
     return binder::Status::ok();
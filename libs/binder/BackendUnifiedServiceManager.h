@@ -15,11 +15,13 @@
  */
 #pragma once
 
+#include <android/os/BnServiceCallback.h>
 #include <android/os/BnServiceManager.h>
 #include <android/os/IServiceManager.h>
 #include <binder/IPCThreadState.h>
 #include <map>
 #include <memory>
+#include <set>
 
 namespace android {
 
@@ -43,6 +45,24 @@ class BinderCacheWithInvalidation
         std::weak_ptr<BinderCacheWithInvalidation> mCache;
         std::string mKey;
     };
+    // servicemanager calls this whenever a service is added, including when
+    // an existing name is re-registered with a different binder while the
+    // old one is still alive, which the death recipient can't observe.
+    class RegistrationInvalidation : public os::BnServiceCallback {
+    public:
+        explicit RegistrationInvalidation(std::weak_ptr<BinderCacheWithInvalidation> cache)
+              : mCache(cache) {}
+
+        binder::Status onRegistration(const std::string& name, const sp<IBinder>& binder) override {
+            if (std::shared_ptr<BinderCacheWithInvalidation> cache = mCache.lock()) {
+                cache->removeItemIfReplaced(name, binder);
+            }
+            return binder::Status::ok();
+        }
+
+    private:
+        std::weak_ptr<BinderCacheWithInvalidation> mCache;
+    };
     struct Entry {
         sp<IBinder> service;
         sp<BinderInvalidation> deathRecipient;
@@ -73,6 +93,31 @@ public:
         return false;
     }
 
+    bool removeItemIfReplaced(const std::string& key, const sp<IBinder>& current) {
+        std::lock_guard<std::mutex> lock(mCacheMutex);
+        if (auto it = mCache.find(key); it != mCache.end()) {
+            if (it->second.service != current) {
+                if (it->second.service->localBinder() == nullptr) {
+                    it->second.service->unlinkToDeath(it->second.deathRecipient);
+                }
+                mCache.erase(it);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Returns the callback to register for key the first time it is called
+    // for that key, nullptr afterwards.
+    sp<os::IServiceCallback> takeRegistrationCallback(const std::string& key) {
+        std::lock_guard<std::mutex> lock(mCacheMutex);
+        if (!mRegisteredKeys.insert(key).second) return nullptr;
+        if (mRegistrationCallback == nullptr) {
+            mRegistrationCallback = sp<RegistrationInvalidation>::make(weak_from_this());
+        }
+        return mRegistrationCallback;
+    }
+
     binder::Status setItem(const std::string& key, const sp<IBinder>& item) {
         sp<BinderInvalidation> deathRecipient =
                 sp<BinderInvalidation>::make(shared_from_this(), key);
@@ -96,6 +141,8 @@ public:
 
 private:
     std::map<std::string, Entry> mCache;
+    std::set<std::string> mRegisteredKeys;
+    sp<RegistrationInvalidation> mRegistrationCallback;
     mutable std::mutex mCacheMutex;
 };
 
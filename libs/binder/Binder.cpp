@@ -17,7 +17,9 @@
 #include <binder/Binder.h>
 
 #include <atomic>
+#include <chrono>
 #include <set>
+#include <vector>
 
 #include <binder/BpBinder.h>
 #include <binder/IInterface.h>
@@ -27,6 +29,7 @@
 #include <binder/Parcel.h>
 #include <binder/RecordedTransaction.h>
 #include <binder/RpcServer.h>
+#include <binder/TransactionStats.h>
 #include <binder/unique_fd.h>
 #include <pthread.h>
 
@@ -40,6 +43,7 @@
 #include "BuildFlags.h"
 #include "OS.h"
 #include "RpcState.h"
+#include "file.h"
 
 namespace android {
 
@@ -47,6 +51,13 @@ using android::binder::unique_fd;
 
 constexpr uid_t kUidRoot = 0;
 
+// Commands carried by TRANSACTION_STATS_TRANSACTION
+enum : int32_t {
+    kTransactionStatsGet = 0,
+    kTransactionStatsSetEnabled = 1,
+    kTransactionStatsGetThreadPool = 2,
+};
+
 // Service implementations inherit from BBinder and IBinder, and this is frozen
 // in prebuilts.
 #ifdef __LP64__
@@ -72,6 +83,9 @@ constexpr bool kEnableRecording = false;
 
 // Log any reply transactions for which the data exceeds this size
 #define LOG_REPLIES_OVER_SIZE (300 * 1024)
+
+// Recorded transactions waiting to be written beyond this size are dropped
+constexpr size_t kMaxQueuedRecordingBytes = 64 * 1024 * 1024;
 // ---------------------------------------------------------------------------
 
 IBinder::IBinder()
@@ -185,6 +199,67 @@ status_t IBinder::getDebugPid(pid_t* out) {
     return OK;
 }
 
+status_t IBinder::getTransactionStats(
+        std::vector<binder::debug::TransactionStats::Entry>* outEntries) {
+    using binder::debug::TransactionStats;
+
+    BBinder* local = this->localBinder();
+    if (local != nullptr) {
+        *outEntries = TransactionStats::snapshot();
+        return OK;
+    }
+
+    Parcel data;
+    Parcel reply;
+    if (status_t status = data.writeInt32(kTransactionStatsGet); status != OK) return status;
+    status_t status = transact(TRANSACTION_STATS_TRANSACTION, data, &reply);
+    if (status != OK) return status;
+
+    return TransactionStats::readFromParcel(reply, outEntries);
+}
+
+status_t IBinder::setTransactionStatsEnabled(bool enabled) {
+    using binder::debug::TransactionStats;
+
+    BBinder* local = this->localBinder();
+    if (local != nullptr) {
+        if (enabled) TransactionStats::reset();
+        TransactionStats::setEnabled(enabled);
+        return OK;
+    }
+
+    Parcel data;
+    Parcel reply;
+    if (status_t status = data.writeInt32(kTransactionStatsSetEnabled); status != OK) {
+        return status;
+    }
+    if (status_t status = data.writeBool(enabled); status != OK) return status;
+    return transact(TRANSACTION_STATS_TRANSACTION, data, &reply);
+}
+
+status_t IBinder::getThreadPoolStats(binder::debug::ThreadPoolStats* outStats) {
+    if (!kEnableKernelIpc) {
+        ALOGW("Thread pool stats disallowed because kernel binder is not enabled");
+        return INVALID_OPERATION;
+    }
+
+    BBinder* local = this->localBinder();
+    if (local != nullptr) {
+        *outStats = ProcessState::self()->getThreadPoolStats();
+        return OK;
+    }
+
+    Parcel data;
+    Parcel reply;
+    if (status_t status = data.writeInt32(kTransactionStatsGetThreadPool); status != OK) {
+        return status;
+    }
+    status_t status = transact(TRANSACTION_STATS_TRANSACTION, data, &reply);
+    if (status != OK) return status;
+
+    return outStats->readFromParcel(reply);
+}
+
 status_t IBinder::setRpcClientDebug(unique_fd socketFd, const sp<IBinder>& keepAliveBinder) {
     if (!kEnableRpcDevServers) {
         ALOGW("setRpcClientDebug disallowed because RPC is not enabled");
@@ -273,6 +348,71 @@ private:
 };
 BBinder::RpcServerLink::~RpcServerLink() {}
 
+// Writes recorded transactions to the recording file on its own thread, so that the recorded
+// binder only pays for serializing them, not for the file I/O.
+class TransactionRecorder {
+public:
+    explicit TransactionRecorder(unique_fd fd)
+          : mFd(std::move(fd)), mThread(&TransactionRecorder::writeLoop, this) {}
+
+    // Writes out all queued transactions before returning.
+    ~TransactionRecorder() {
+        {
+            RpcMutexLockGuard lock(mLock);
+            mStopping = true;
+        }
+        mCv.notify_one();
+        mThread.join();
+        if (mDroppedCount > 0) {
+            ALOGW("Dropped %zu recorded transactions because the recording file fell behind",
+                  mDroppedCount);
+        }
+    }
+
+    void record(std::vector<uint8_t>&& transaction) {
+        {
+            RpcMutexLockGuard lock(mLock);
+            if (mQueuedBytes + transaction.size() > kMaxQueuedRecordingBytes) {
+                mDroppedCount++;
+                return;
+            }
+            mQueuedBytes += transaction.size();
+            mQueue.push_back(std::move(transaction));
+        }
+        mCv.notify_one();
+    }
+
+private:
+    void writeLoop() {
+        std::vector<std::vector<uint8_t>> batch;
+        while (true) {
+            {
+                RpcMutexUniqueLock lock(mLock);
+                mCv.wait(lock, [this] { return !mQueue.empty() || mStopping; });
+                if (mQueue.empty()) return;
+                batch.swap(mQueue);
+                mQueuedBytes = 0;
+            }
+            for (const std::vector<uint8_t>& transaction : batch) {
+                if (!binder::WriteFully(mFd, transaction.data(), transaction.size())) {
+                    ALOGI("Failed to write recorded transaction to fd %d", mFd.get());
+                }
+            }
+            batch.clear();
+        }
+    }
+
+    const unique_fd mFd;
+    RpcMutex mLock;
+    RpcConditionVariable mCv;
+    std::vector<std::vector<uint8_t>> mQueue;
+    size_t mQueuedBytes = 0;
+    size_t mDroppedCount = 0;
+    bool mStopping = false;
+    // Started last, once the members it uses are initialized.
+    RpcMaybeThread mThread;
+};
+
 class BBinder::Extras
 {
 public:
@@ -290,7 +430,7 @@ public:
     std::set<sp<RpcServerLink>> mRpcServerLinks;
     BpBinder::ObjectManager mObjects;
 
-    unique_fd mRecordingFd;
+    std::unique_ptr<TransactionRecorder> mRecorder;
 };
 
 // ---------------------------------------------------------------------------
@@ -327,10 +467,12 @@ status_t BBinder::startRecordingTransactions(const Parcel& data) {
         ALOGI("Could not start Binder recording. Another is already in progress.");
         return INVALID_OPERATION;
     } else {
-        status_t readStatus = data.readUniqueFileDescriptor(&(e->mRecordingFd));
+        unique_fd fd;
+        status_t readStatus = data.readUniqueFileDescriptor(&fd);
         if (readStatus != OK) {
             return readStatus;
         }
+        e->mRecorder = std::make_unique<TransactionRecorder>(std::move(fd));
         mRecordingOn = true;
         ALOGI("Started Binder recording.");
         return NO_ERROR;
@@ -354,8 +496,12 @@ status_t BBinder::stopRecordingTransactions() {
     Extras* e = getOrCreateExtras();
     RpcMutexUniqueLock lock(e->mLock);
     if (mRecordingOn) {
-        e->mRecordingFd.reset();
+        std::unique_ptr<TransactionRecorder> recorder = std::move(e->mRecorder);
         mRecordingOn = false;
+        lock.unlock();
+        // Waits for the queued transactions to be written, so that the file is complete once
+        // the client sees recording stopped.
+        recorder.reset();
         ALOGI("Stopped Binder recording.");
         return NO_ERROR;
     } else {
@@ -364,6 +510,44 @@ status_t BBinder::stopRecordingTransactions() {
     }
 }
 
+status_t BBinder::transactionStatsCommand(const Parcel& data, Parcel* reply) {
+    using binder::debug::TransactionStats;
+
+    int32_t command;
+    if (status_t status = data.readInt32(&command); status != OK) return status;
+
+    switch (command) {
+        case kTransactionStatsGet:
+            return TransactionStats::writeToParcel(TransactionStats::snapshot(), reply);
+        case kTransactionStatsSetEnabled: {
+            if (!kEnableKernelIpc) {
+                ALOGW("Transaction stats control disallowed because kernel binder is not enabled");
+                return INVALID_OPERATION;
+            }
+            uid_t uid = IPCThreadState::self()->getCallingUid();
+            if (uid != kUidRoot) {
+                ALOGE("Transaction stats control not allowed because client %" PRIu32
+                      " is not root",
+                      uid);
+                return PERMISSION_DENIED;
+            }
+            bool enabled;
+            if (status_t status = data.readBool(&enabled); status != OK) return status;
+            if (enabled) TransactionStats::reset();
+            TransactionStats::setEnabled(enabled);
+            return OK;
+        }
+        case kTransactionStatsGetThreadPool:
+            if (!kEnableKernelIpc) {
+                ALOGW("Thread pool stats disallowed because kernel binder is not enabled");
+                return INVALID_OPERATION;
+            }
+            return ProcessState::self()->getThreadPoolStats().writeToParcel(reply);
+        default:
+            return BAD_VALUE;
+    }
+}
+
 const String16& BBinder::getInterfaceDescriptor() const
 {
     static StaticString16 sBBinder(u"BBinder");
@@ -404,7 +588,23 @@ status_t BBinder::transact(
             err = setRpcClientDebug(data);
             break;
         }
+        case TRANSACTION_STATS_TRANSACTION:
+            LOG_ALWAYS_FATAL_IF(reply == nullptr, "reply == nullptr");
+            err = transactionStatsCommand(data, reply);
+            break;
         default:
+            if (code >= FIRST_CALL_TRANSACTION && code <= LAST_CALL_TRANSACTION &&
+                binder::debug::TransactionStats::isEnabled()) [[unlikely]] {
+                auto start = std::chrono::steady_clock::now();
+                err = onTransact(code, data, reply, flags);
+                auto latency = std::chrono::steady_clock::now() - start;
+                binder::debug::TransactionStats::
+                        record(getInterfaceDescriptor(), code, true /*incoming*/,
+                               std::chrono::duration_cast<std::chrono::nanoseconds>(latency)
+                                       .count(),
+                               data.dataSize() + (reply ? reply->dataSize() : 0));
+                break;
+            }
             err = onTransact(code, data, reply, flags);
             break;
     }
@@ -419,21 +619,23 @@ status_t BBinder::transact(
     }
 
     if (kEnableKernelIpc && mRecordingOn && code != START_RECORDING_TRANSACTION) [[unlikely]] {
-        Extras* e = mExtras.load(std::memory_order_acquire);
-        RpcMutexUniqueLock lock(e->mLock);
-        if (mRecordingOn) {
-            Parcel emptyReply;
-            timespec ts;
-            timespec_get(&ts, TIME_UTC);
-            auto transaction = android::binder::debug::RecordedTransaction::
-                    fromDetails(getInterfaceDescriptor(), code, flags, ts, data,
-                                reply ? *reply : emptyReply, err);
-            if (transaction) {
-                if (status_t err = transaction->dumpToFile(e->mRecordingFd); err != NO_ERROR) {
-                    ALOGI("Failed to dump RecordedTransaction to file with error %d", err);
-                }
-            } else {
-                ALOGI("Failed to create RecordedTransaction object.");
+        // Serialize without holding the lock; the recorder writes it out later.
+        Parcel emptyReply;
+        timespec ts;
+        timespec_get(&ts, TIME_UTC);
+        auto transaction = android::binder::debug::RecordedTransaction::
+                fromDetails(getInterfaceDescriptor(), code, flags, ts, data,
+                            reply ? *reply : emptyReply, err);
+        std::vector<uint8_t> buffer;
+        if (!transaction) {
+            ALOGI("Failed to create RecordedTransaction object.");
+        } else if (status_t err = transaction->dumpToBuffer(&buffer); err != NO_ERROR) {
+            ALOGI("Failed to dump RecordedTransaction with error %d", err);
+        } else {
+            Extras* e = mExtras.load(std::memory_order_acquire);
+            RpcMutexUniqueLock lock(e->mLock);
+            if (mRecordingOn) {
+                e->mRecorder->record(std::move(buffer));
             }
         }
     }
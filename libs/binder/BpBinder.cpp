@@ -24,9 +24,12 @@
 #include <binder/RpcSession.h>
 #include <binder/Stability.h>
 #include <binder/Trace.h>
+#include <binder/TransactionStats.h>
 
 #include <stdio.h>
 
+#include <chrono>
+
 #include "BuildFlags.h"
 #include "file.h"
 
@@ -394,6 +397,13 @@ status_t BpBinder::transact(
             }
         }
 
+        const bool recordStats = code >= FIRST_CALL_TRANSACTION &&
+                code <= LAST_CALL_TRANSACTION && binder::debug::TransactionStats::isEnabled();
+        std::chrono::steady_clock::time_point start;
+        if (recordStats) [[unlikely]] {
+            start = std::chrono::steady_clock::now();
+        }
+
         status_t status;
         if (isRpcBinder()) [[unlikely]] {
             status = rpcSession()->transact(sp<IBinder>::fromExisting(this), code, data, reply,
@@ -406,6 +416,18 @@ status_t BpBinder::transact(
 
             status = IPCThreadState::self()->transact(binderHandle(), code, data, reply, flags);
         }
+        if (recordStats) [[unlikely]] {
+            auto latency = std::chrono::steady_clock::now() - start;
+            // Don't look up the descriptor here, the lookup is itself a
+            // transaction. Proxies whose descriptor was never requested are
+            // recorded without one.
+            String16 descriptor;
+            if (isDescriptorCached()) descriptor = mDescriptorCache;
+            binder::debug::TransactionStats::
+                    record(descriptor, code, false /*incoming*/,
+                           std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count(),
+                           data.dataSize() + (reply ? reply->dataSize() : 0));
+        }
         if (data.dataSize() > LOG_TRANSACTIONS_OVER_SIZE) {
             RpcMutexUniqueLock _l(mLock);
             ALOGW("Large outgoing transaction of %zu bytes, interface descriptor %s, code %d",
@@ -57,6 +57,14 @@ public:
     [[nodiscard]] status_t triggerablePoll(const android::RpcTransportFd& transportFd,
                                            int16_t event);
 
+#ifndef BINDER_RPC_SINGLE_THREADED
+    /**
+     * FD which reports POLLHUP once trigger() is called. For transports which
+     * wait in their own event loop (e.g. io_uring) instead of triggerablePoll.
+     */
+    binder::borrowed_fd pollFd() const { return binder::borrowed_fd(mRead.get()); }
+#endif
+
 private:
 #ifdef BINDER_RPC_SINGLE_THREADED
     bool mTriggered = false;
@@ -688,6 +688,12 @@ status_t IPCThreadState::getAndExecuteCommand()
         }
 
         size_t newThreadsCount = mProcess->mExecutingThreadsCount.fetch_add(1) + 1;
+        size_t peak = mProcess->mPeakExecutingThreads.load(std::memory_order_relaxed);
+        while (newThreadsCount > peak &&
+               !mProcess->mPeakExecutingThreads
+                        .compare_exchange_weak(peak, newThreadsCount,
+                                               std::memory_order_relaxed)) {
+        }
         if (newThreadsCount >= mProcess->mMaxThreads) {
             auto expected = ProcessState::never();
             mProcess->mStarvationStartTime
@@ -707,6 +713,7 @@ status_t IPCThreadState::getAndExecuteCommand()
                     ALOGE("binder thread pool (%zu threads) starved for %" PRId64 " ms", maxThreads,
                           to_ms(starvationTime));
                 }
+                mProcess->onThreadPoolStarvationEnded(starvationTime);
             }
         }
 
@@ -848,6 +855,42 @@ void IPCThreadState::stopProcess(bool /*immediate*/)
     //kill(getpid(), SIGKILL);
 }
 
+void IPCThreadState::beginOnewayBatch()
+{
+    mOnewayBatching = true;
+}
+
+status_t IPCThreadState::flushOnewayBatch()
+{
+    mOnewayBatching = false;
+
+    // Completions consumed from here on belong to this flush, so stop
+    // waitForResponse() from skipping over them.
+    size_t pending = mPendingOnewayCompletions;
+    mPendingOnewayCompletions = 0;
+
+    status_t result = mOnewayBatchError;
+    mOnewayBatchError = NO_ERROR;
+    for (; pending > 0; pending--) {
+        // The first call submits everything queued in mOut; later ones
+        // normally find their completion already waiting in mIn.
+        status_t err = waitForResponse(nullptr, nullptr);
+        if (err != NO_ERROR && result == NO_ERROR) result = err;
+    }
+    mOnewayBatch.clear();
+    return result;
+}
+
+bool IPCThreadState::consumePendingOnewayCompletion(status_t err)
+{
+    // Batched transactions always precede anything written after them, so
+    // the driver answers them first.
+    if (mPendingOnewayCompletions == 0) return false;
+    mPendingOnewayCompletions--;
+    if (err != NO_ERROR && mOnewayBatchError == NO_ERROR) mOnewayBatchError = err;
+    return true;
+}
+
 status_t IPCThreadState::transact(int32_t handle,
                                   uint32_t code, const Parcel& data,
                                   Parcel* reply, uint32_t flags)
@@ -868,13 +911,36 @@ status_t IPCThreadState::transact(int32_t handle,
 
     LOG_ONEWAY(">>>> SEND from pid %d uid %d %s", getpid(), getuid(),
         (flags & TF_ONE_WAY) == 0 ? "READ REPLY" : "ONE WAY");
-    err = writeTransactionData(BC_TRANSACTION, flags, handle, code, data, nullptr);
+    // A batched transaction outlives the caller's parcel, which the driver
+    // only reads once the batch is submitted, so keep our own copy.
+    const bool batched = (flags & TF_ONE_WAY) != 0 && mOnewayBatching;
+    const Parcel* toSend = &data;
+    if (batched) {
+        err = data.errorCheck();
+        if (err == NO_ERROR) {
+            auto copy = std::make_unique<Parcel>();
+            if (data.mDeallocZero) copy->markSensitive();
+            err = copy->appendFrom(&data, 0, data.dataSize());
+            if (err == NO_ERROR) {
+                toSend = copy.get();
+                mOnewayBatch.push_back(std::move(copy));
+            }
+        }
+        if (err != NO_ERROR) return (mLastError = err);
+    }
+
+    err = writeTransactionData(BC_TRANSACTION, flags, handle, code, *toSend, nullptr);
 
     if (err != NO_ERROR) {
         if (reply) reply->setError(err);
         return (mLastError = err);
     }
 
+    if (batched) {
+        mPendingOnewayCompletions++;
+        return NO_ERROR;
+    }
+
     if ((flags & TF_ONE_WAY) == 0) {
         if (mCallRestriction != ProcessState::CallRestriction::NONE) [[unlikely]] {
             if (mCallRestriction == ProcessState::CallRestriction::ERROR_IF_NOT_ONEWAY) {
@@ -1032,7 +1098,10 @@ IPCThreadState::IPCThreadState()
         mIsFlushing(false),
         mStrictModePolicy(0),
         mLastTransactionBinderFlags(0),
-        mCallRestriction(mProcess->mCallRestriction) {
+        mCallRestriction(mProcess->mCallRestriction),
+        mOnewayBatching(false),
+        mPendingOnewayCompletions(0),
+        mOnewayBatchError(NO_ERROR) {
     pthread_setspecific(gTLS, this);
     clearCaller();
     mHasExplicitIdentity = false;
@@ -1081,24 +1150,29 @@ status_t IPCThreadState::waitForResponse(Parcel *reply, status_t *acquireResult)
                     ANDROID_LOG_ERROR);
             [[fallthrough]];
         case BR_TRANSACTION_COMPLETE:
+            if (consumePendingOnewayCompletion(NO_ERROR)) break;
             if (!reply && !acquireResult) goto finish;
             break;
 
         case BR_TRANSACTION_PENDING_FROZEN:
             ALOGW("Sending oneway calls to frozen process.");
+            if (consumePendingOnewayCompletion(NO_ERROR)) break;
             goto finish;
 
         case BR_DEAD_REPLY:
             err = DEAD_OBJECT;
+            if (consumePendingOnewayCompletion(err)) break;
             goto finish;
 
         case BR_FAILED_REPLY:
             err = FAILED_TRANSACTION;
+            if (consumePendingOnewayCompletion(err)) break;
             goto finish;
 
         case BR_FROZEN_REPLY:
             ALOGW("Transaction failed because process frozen.");
             err = FAILED_TRANSACTION;
+            if (consumePendingOnewayCompletion(err)) break;
             goto finish;
 
         case BR_ACQUIRE_RESULT:
@@ -1517,6 +1591,11 @@ status_t IPCThreadState::executeCommand(int32_t cmd)
                 LOG_ONEWAY("NOT sending reply to %d!", mCallingPid);
             }
 
+            if (mOnewayBatching || mPendingOnewayCompletions > 0) [[unlikely]] {
+                ALOGW("Oneway batch still open after transaction code %u, flushing it.", tr.code);
+                (void)flushOnewayBatch();
+            }
+
             mServingStackPointer = origServingStackPointer;
             mCallingPid = origPid;
             mCallingSid = origSid;
@@ -23,6 +23,7 @@
 
 #include <inttypes.h>
 #include <unistd.h>
+#include <algorithm>
 #include <chrono>
 #include <condition_variable>
 
@@ -34,6 +35,7 @@
 #include <android/os/BnServiceManager.h>
 #include <android/os/IAccessor.h>
 #include <android/os/IServiceManager.h>
+#include <binder/Functional.h>
 #include <binder/IPCThreadState.h>
 #include <binder/Parcel.h>
 #include <binder/RpcSession.h>
@@ -85,6 +87,17 @@ const String16& IServiceManager::getInterfaceDescriptor() const {
 IServiceManager::IServiceManager() {}
 IServiceManager::~IServiceManager() {}
 
+status_t IServiceManager::waitForServices(
+        const std::vector<String16>& names,
+        const std::function<void(const String16&, const sp<IBinder>&)>& onAvailable) {
+    for (const String16& name : names) {
+        sp<IBinder> binder = waitForService(name);
+        if (binder == nullptr) return UNKNOWN_ERROR;
+        onAvailable(name, binder);
+    }
+    return OK;
+}
+
 // From the old libbinder IServiceManager interface to IServiceManager.
 class CppBackendShim : public IServiceManager {
 public:
@@ -121,6 +134,9 @@ public:
                                         const sp<AidlRegistrationCallback>& cb) override;
 
     std::vector<IServiceManager::ServiceDebugInfo> getServiceDebugInfo() override;
+    status_t waitForServices(
+            const std::vector<String16>& names,
+            const std::function<void(const String16&, const sp<IBinder>&)>& onAvailable) override;
     // for legacy ABI
     const String16& getInterfaceDescriptor() const override {
         return mUnifiedServiceManager->getInterfaceDescriptor();
@@ -663,6 +679,104 @@ sp<IBinder> CppBackendShim::waitForService(const String16& name16) {
     }
 }
 
+status_t CppBackendShim::waitForServices(
+        const std::vector<String16>& names16,
+        const std::function<void(const String16&, const sp<IBinder>&)>& onAvailable) {
+    // One callback for every name, which records registrations by name.
+    class Waiter : public android::os::BnServiceCallback {
+        Status onRegistration(const std::string& name, const sp<IBinder>& binder) override {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mBinders[name] = binder;
+            lock.unlock();
+            // Flushing here helps ensure the service's ref count remains accurate
+            IPCThreadState::self()->flushCommands();
+            mCv.notify_one();
+            return Status::ok();
+        }
+    public:
+        std::map<std::string, sp<IBinder>> mBinders;
+        std::mutex mMutex;
+        std::condition_variable mCv;
+    };
+
+    std::vector<std::string> names;
+    names.reserve(names16.size());
+    for (const String16& name16 : names16) names.push_back(String8(name16).c_str());
+
+    // index into names, in order, of services not reported yet
+    std::vector<size_t> pending;
+    for (size_t i = 0; i < names.size(); i++) {
+        sp<IBinder> out;
+        if (Status status = realGetService(names[i], &out); !status.isOk()) {
+            ALOGW("Failed to getService in waitForServices for %s: %s", names[i].c_str(),
+                  status.toString8().c_str());
+            return UNKNOWN_ERROR;
+        }
+        if (out != nullptr) {
+            onAvailable(names16[i], out);
+        } else {
+            pending.push_back(i);
+        }
+    }
+    if (pending.empty()) return OK;
+
+    sp<Waiter> waiter = sp<Waiter>::make();
+    std::vector<size_t> registered;
+    auto unregister = binder::impl::make_scope_guard([&] {
+        for (size_t i : registered) {
+            mUnifiedServiceManager->unregisterForNotifications(names[i], waiter);
+        }
+    });
+    for (size_t i : pending) {
+        if (Status status = mUnifiedServiceManager->registerForNotifications(names[i], waiter);
+            !status.isOk()) {
+            ALOGW("Failed to registerForNotifications in waitForServices for %s: %s",
+                  names[i].c_str(), status.toString8().c_str());
+            return UNKNOWN_ERROR;
+        }
+        registered.push_back(i);
+    }
+
+    while (!pending.empty()) {
+        std::vector<std::pair<size_t, sp<IBinder>>> available;
+        {
+            std::unique_lock<std::mutex> lock(waiter->mMutex);
+            waiter->mCv.wait_for(lock, 1s, [&] { return !waiter->mBinders.empty(); });
+            for (size_t i : pending) {
+                auto it = waiter->mBinders.find(names[i]);
+                if (it != waiter->mBinders.end()) available.emplace_back(i, it->second);
+            }
+            waiter->mBinders.clear();
+        }
+
+        if (available.empty()) {
+            ALOGW("Waited one second for %zu services, including %s (are services started? "
+                  "Number of threads started in the threadpool: %zu. Are binder threads started "
+                  "and available?)",
+                  pending.size(), names[pending[0]].c_str(),
+                  ProcessState::self()->getThreadPoolMaxTotalThreadCount());
+
+            // Handle race condition for lazy services, see waitForService.
+            for (size_t i : pending) {
+                sp<IBinder> out;
+                if (Status status = realGetService(names[i], &out); !status.isOk()) {
+                    ALOGW("Failed to getService in waitForServices on later try for %s: %s",
+                          names[i].c_str(), status.toString8().c_str());
+                    return UNKNOWN_ERROR;
+                }
+                if (out != nullptr) available.emplace_back(i, out);
+            }
+        }
+
+        // pending is in order, so available is too
+        for (const auto& [i, binder] : available) {
+            onAvailable(names16[i], binder);
+            pending.erase(std::find(pending.begin(), pending.end(), i));
+        }
+    }
+    return OK;
+}
+
 bool CppBackendShim::isDeclared(const String16& name) {
     bool declared;
     if (Status status = mUnifiedServiceManager->isDeclared(String8(name).c_str(), &declared);
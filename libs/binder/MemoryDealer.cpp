@@ -37,6 +37,9 @@
 #include <sys/mman.h>
 #include <sys/file.h>
 
+#include <algorithm>
+#include <unordered_map>
+
 namespace android {
 // ----------------------------------------------------------------------------
 
@@ -125,7 +128,9 @@ class SimpleBestFitAllocator
         PAGE_ALIGNED = 0x00000001
     };
 public:
-    explicit SimpleBestFitAllocator(size_t size);
+    using AllocationPolicy = MemoryDealer::AllocationPolicy;
+
+    SimpleBestFitAllocator(size_t size, AllocationPolicy policy);
     ~SimpleBestFitAllocator();
 
     size_t      allocate(size_t size, uint32_t flags = 0);
@@ -133,6 +138,7 @@ public:
     size_t      size() const;
     void        dump(const char* what) const;
     void        dump(String8& res, const char* what) const;
+    MemoryDealer::Stats getStats() const;
 
     static size_t getAllocationAlignment() { return kMemoryAlign; }
 
@@ -140,24 +146,48 @@ private:
 
     struct chunk_t {
         chunk_t(size_t start, size_t size)
-        : start(start), size(size), free(1), prev(nullptr), next(nullptr) {
+        : start(start), size(size), free(1), prev(nullptr), next(nullptr),
+          freePrev(nullptr), freeNext(nullptr) {
         }
         size_t              start;
         size_t              size : 28;
         int                 free : 4;
         mutable chunk_t*    prev;
         mutable chunk_t*    next;
+        // Neighbours in the free list of this chunk's size class, only used
+        // with AllocationPolicy::SIZE_CLASSES.
+        chunk_t*            freePrev;
+        chunk_t*            freeNext;
     };
 
+    // One size class per bit of chunk_t::size.
+    static constexpr int kNumSizeClasses = 28;
+
     ssize_t  alloc(size_t size, uint32_t flags);
     chunk_t* dealloc(size_t start);
+    ssize_t  allocFromSizeClasses(size_t size);
+    chunk_t* deallocToSizeClasses(size_t start);
+    void     insertFree(chunk_t* chunk);
+    void     removeFree(chunk_t* chunk);
+    MemoryDealer::Stats getStats_l() const;
     void     dump_l(const char* what) const;
     void     dump_l(String8& res, const char* what) const;
 
+    static int sizeClass(size_t size) { return 31 - __builtin_clz(uint32_t(size)); }
+
     static const int    kMemoryAlign;
+    const AllocationPolicy mPolicy;
     mutable std::mutex mLock;
     LinkedList<chunk_t> mList;
     size_t              mHeapSize;
+
+    // With AllocationPolicy::SIZE_CLASSES, the free chunks with a size in
+    // [2^i, 2^(i+1)) units are linked from mFreeLists[i], and bit i of
+    // mFreeListMask is set if that list is not empty. Allocated chunks are
+    // indexed by start so they can be freed without walking mList.
+    chunk_t*            mFreeLists[kNumSizeClasses] = {};
+    uint32_t            mFreeListMask = 0;
+    std::unordered_map<size_t, chunk_t*> mAllocatedChunks;
 };
 
 // ----------------------------------------------------------------------------
@@ -227,8 +257,12 @@ Allocation::~Allocation()
 // ----------------------------------------------------------------------------
 
 MemoryDealer::MemoryDealer(size_t size, const char* name, uint32_t flags)
+      : MemoryDealer(size, name, flags, AllocationPolicy::BEST_FIT) {}
+
+MemoryDealer::MemoryDealer(size_t size, const char* name, uint32_t flags,
+                           AllocationPolicy policy)
       : mHeap(sp<MemoryHeapBase>::make(size, flags, name)),
-        mAllocator(new SimpleBestFitAllocator(size)) {}
+        mAllocator(new SimpleBestFitAllocator(size, policy)) {}
 
 MemoryDealer::~MemoryDealer()
 {
@@ -255,6 +289,11 @@ void MemoryDealer::dump(const char* what) const
     allocator()->dump(what);
 }
 
+MemoryDealer::Stats MemoryDealer::getStats() const
+{
+    return allocator()->getStats();
+}
+
 const sp<IMemoryHeap>& MemoryDealer::heap() const {
     return mHeap;
 }
@@ -274,13 +313,17 @@ size_t MemoryDealer::getAllocationAlignment()
 // align all the memory blocks on a cache-line boundary
 const int SimpleBestFitAllocator::kMemoryAlign = 32;
 
-SimpleBestFitAllocator::SimpleBestFitAllocator(size_t size)
+SimpleBestFitAllocator::SimpleBestFitAllocator(size_t size, AllocationPolicy policy)
+      : mPolicy(policy)
 {
     size_t pagesize = getpagesize();
     mHeapSize = ((size + pagesize-1) & ~(pagesize-1));
 
     chunk_t* node = new chunk_t(0, mHeapSize / kMemoryAlign);
     mList.insertHead(node);
+    if (mPolicy == AllocationPolicy::SIZE_CLASSES && node->size) {
+        insertFree(node);
+    }
 }
 
 SimpleBestFitAllocator::~SimpleBestFitAllocator()
@@ -306,6 +349,11 @@ size_t SimpleBestFitAllocator::size() const
 size_t SimpleBestFitAllocator::allocate(size_t size, uint32_t flags)
 {
     std::unique_lock<std::mutex> _l(mLock);
+    if (mPolicy == AllocationPolicy::SIZE_CLASSES) {
+        LOG_ALWAYS_FATAL_IF(flags & PAGE_ALIGNED,
+                            "PAGE_ALIGNED is not supported with size classes");
+        return allocFromSizeClasses(size);
+    }
     ssize_t offset = alloc(size, flags);
     return offset;
 }
@@ -313,7 +361,9 @@ size_t SimpleBestFitAllocator::allocate(size_t size, uint32_t flags)
 status_t SimpleBestFitAllocator::deallocate(size_t offset)
 {
     std::unique_lock<std::mutex> _l(mLock);
-    chunk_t const * const freed = dealloc(offset);
+    chunk_t const * const freed = mPolicy == AllocationPolicy::SIZE_CLASSES
+            ? deallocToSizeClasses(offset)
+            : dealloc(offset);
     if (freed) {
         return NO_ERROR;
     }
@@ -418,6 +468,124 @@ SimpleBestFitAllocator::chunk_t* SimpleBestFitAllocator::dealloc(size_t start)
     return nullptr;
 }
 
+void SimpleBestFitAllocator::insertFree(chunk_t* chunk)
+{
+    const int c = sizeClass(chunk->size);
+    chunk->freePrev = nullptr;
+    chunk->freeNext = mFreeLists[c];
+    if (mFreeLists[c]) mFreeLists[c]->freePrev = chunk;
+    mFreeLists[c] = chunk;
+    mFreeListMask |= 1u << c;
+}
+
+void SimpleBestFitAllocator::removeFree(chunk_t* chunk)
+{
+    const int c = sizeClass(chunk->size);
+    if (chunk->freePrev) chunk->freePrev->freeNext = chunk->freeNext;
+    else                 mFreeLists[c] = chunk->freeNext;
+    if (chunk->freeNext) chunk->freeNext->freePrev = chunk->freePrev;
+    if (!mFreeLists[c]) mFreeListMask &= ~(1u << c);
+    chunk->freePrev = chunk->freeNext = nullptr;
+}
+
+ssize_t SimpleBestFitAllocator::allocFromSizeClasses(size_t size)
+{
+    if (size == 0) {
+        return 0;
+    }
+    size = (size + kMemoryAlign-1) / kMemoryAlign;
+    if (size >= (size_t(1) << kNumSizeClasses)) {
+        return NO_MEMORY;
+    }
+
+    // Every chunk in a class above the one of size fits, as does every chunk
+    // in its own class when size is a power of two. Otherwise only some
+    // chunks of its own class may fit, and those are searched as a last resort.
+    const int c = sizeClass(size);
+    const int first = (size & (size - 1)) ? c + 1 : c;
+    const uint32_t fitting = first < kNumSizeClasses ? mFreeListMask & (~0u << first) : 0;
+    chunk_t* chunk = nullptr;
+    if (fitting) {
+        chunk = mFreeLists[__builtin_ctz(fitting)];
+    } else {
+        for (chunk_t* cur = mFreeLists[c]; cur; cur = cur->freeNext) {
+            if (cur->size >= size) {
+                chunk = cur;
+                break;
+            }
+        }
+        if (!chunk) {
+            return NO_MEMORY;
+        }
+    }
+
+    removeFree(chunk);
+    chunk->free = 0;
+    if (chunk->size > size) {
+        chunk_t* split = new chunk_t(chunk->start + size, chunk->size - size);
+        chunk->size = size;
+        mList.insertAfter(chunk, split);
+        insertFree(split);
+    }
+    mAllocatedChunks.emplace(chunk->start, chunk);
+    return (chunk->start)*kMemoryAlign;
+}
+
+SimpleBestFitAllocator::chunk_t* SimpleBestFitAllocator::deallocToSizeClasses(size_t start)
+{
+    auto it = mAllocatedChunks.find(start / kMemoryAlign);
+    if (it == mAllocatedChunks.end()) {
+        return nullptr;
+    }
+    chunk_t* freed = it->second;
+    mAllocatedChunks.erase(it);
+    freed->free = 1;
+
+    // merge with the neighbouring free chunks, which are still in their lists
+    chunk_t* const p = freed->prev;
+    if (p && p->free) {
+        removeFree(p);
+        p->size += freed->size;
+        mList.remove(freed);
+        delete freed;
+        freed = p;
+    }
+    chunk_t* const n = freed->next;
+    if (n && n->free) {
+        removeFree(n);
+        freed->size += n->size;
+        mList.remove(n);
+        delete n;
+    }
+    insertFree(freed);
+    return freed;
+}
+
+MemoryDealer::Stats SimpleBestFitAllocator::getStats() const
+{
+    std::unique_lock<std::mutex> _l(mLock);
+    return getStats_l();
+}
+
+MemoryDealer::Stats SimpleBestFitAllocator::getStats_l() const
+{
+    MemoryDealer::Stats stats;
+    stats.heapSize = mHeapSize;
+    for (chunk_t const* cur = mList.head(); cur; cur = cur->next) {
+        const size_t bytes = cur->size * kMemoryAlign;
+        if (cur->free) {
+            if (!bytes) continue;
+            stats.freeBlocks++;
+            stats.freeBytes += bytes;
+            stats.largestFreeBlock = std::max(stats.largestFreeBlock, bytes);
+        } else {
+            stats.allocations++;
+            stats.allocatedBytes += bytes;
+        }
+    }
+    return stats;
+}
+
 void SimpleBestFitAllocator::dump(const char* what) const
 {
     std::unique_lock<std::mutex> _l(mLock);
@@ -475,6 +643,12 @@ void SimpleBestFitAllocator::dump_l(String8& result,
     snprintf(buffer, SIZE,
             "  size allocated: %u (%u KB)\n", int(size), int(size/1024));
     result.append(buffer);
+
+    const MemoryDealer::Stats stats = getStats_l();
+    snprintf(buffer, SIZE,
+            "  free blocks: %zu, free: %zu, largest free block: %zu, fragmentation: %.2f\n",
+            stats.freeBlocks, stats.freeBytes, stats.largestFreeBlock, stats.fragmentation());
+    result.append(buffer);
 }
 
 
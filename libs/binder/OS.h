@@ -44,6 +44,17 @@ LIBBINDER_INTERNAL_EXPORTED ssize_t
 receiveMessageFromSocket(const RpcTransportFd& socket, iovec* iovs, int niovs,
                          std::vector<std::variant<unique_fd, borrowed_fd>>* ancillaryFds);
 
+// Copies `size` bytes from `data` into a new shared memory region which is
+// sealed against writes and resizing, so the receiver can map it without
+// copying and without racing the sender.
+status_t createSealedSharedMemory(const void* data, size_t size, unique_fd* outFd);
+
+// Maps a region created by createSealedSharedMemory() read-only. Fails if the
+// region is not sealed or is smaller than `size`. Release with
+// unmapSharedMemory().
+status_t mapSealedSharedMemory(borrowed_fd fd, size_t size, const void** outData);
+void unmapSharedMemory(const void* data, size_t size);
+
 uint64_t GetThreadId();
 
 bool report_sysprop_change();
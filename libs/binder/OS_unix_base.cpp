@@ -19,9 +19,13 @@
 #include "file.h"
 
 #include <binder/RpcTransportRaw.h>
+#include <fcntl.h>
+#include <inttypes.h>
 #include <log/log.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
 
 using android::binder::ReadFully;
 
@@ -65,6 +69,55 @@ status_t dupFileDescriptor(int oldFd, int* newFd) {
     return OK;
 }
 
+status_t createSealedSharedMemory(const void* data, size_t size, unique_fd* outFd) {
+    unique_fd fd(memfd_create("rpc-binder-payload", MFD_CLOEXEC | MFD_ALLOW_SEALING));
+    if (!fd.ok()) return -errno;
+    if (TEMP_FAILURE_RETRY(ftruncate(fd.get(), size)) != 0) return -errno;
+
+    void* mapped = mmap(nullptr, size, PROT_WRITE, MAP_SHARED, fd.get(), 0);
+    if (mapped == MAP_FAILED) return -errno;
+    memcpy(mapped, data, size);
+    // F_SEAL_WRITE is refused while a writable mapping exists
+    munmap(mapped, size);
+
+    constexpr int kSeals = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL;
+    if (fcntl(fd.get(), F_ADD_SEALS, kSeals) != 0) return -errno;
+
+    *outFd = std::move(fd);
+    return OK;
+}
+
+status_t mapSealedSharedMemory(borrowed_fd fd, size_t size, const void** outData) {
+    constexpr int kRequiredSeals = F_SEAL_SHRINK | F_SEAL_WRITE;
+    int seals = fcntl(fd.get(), F_GET_SEALS);
+    if (seals < 0) return -errno;
+    if ((seals & kRequiredSeals) != kRequiredSeals) {
+        ALOGE("Shared memory payload is not sealed (seals 0x%x)", seals);
+        return BAD_VALUE;
+    }
+
+    struct stat st;
+    if (fstat(fd.get(), &st) != 0) return -errno;
+    if (st.st_size < 0 || static_cast<size_t>(st.st_size) < size) {
+        ALOGE("Shared memory payload too small: %" PRId64 " < %zu",
+              static_cast<int64_t>(st.st_size), size);
+        return BAD_VALUE;
+    }
+
+    if (size == 0) {
+        *outData = nullptr;
+        return OK;
+    }
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd.get(), 0);
+    if (mapped == MAP_FAILED) return -errno;
+    *outData = mapped;
+    return OK;
+}
+
+void unmapSharedMemory(const void* data, size_t size) {
+    if (data != nullptr) munmap(const_cast<void*>(data), size);
+}
+
 std::unique_ptr<RpcTransportCtxFactory> makeDefaultRpcTransportCtxFactory() {
     return RpcTransportCtxFactoryRaw::make();
 }
@@ -114,6 +114,83 @@ static std::atomic<size_t> gParcelGlobalAllocSize;
 // Maximum number of file descriptors per Parcel.
 constexpr size_t kMaxFds = 1024;
 
+// Per-thread cache of recently freed Parcel buffers (data and object offset
+// arrays). Binder threads construct and destroy a request and a reply Parcel
+// for every transaction, so recycling a handful of small buffers lets steady
+// state calls run without touching the heap. Buffers are plain malloc()
+// allocations, so a buffer taken from the pool may later be realloc()ed or
+// free()d like any other.
+namespace {
+constexpr size_t kParcelBufferPoolSlots = 4;
+constexpr size_t kParcelBufferPoolMaxCapacity = 4096;
+
+// Trivially destructible, so it can still be read after the pool below has
+// been destroyed during thread exit (e.g. when IPCThreadState's parcels are
+// freed from its pthread key destructor).
+thread_local bool tParcelBufferPoolDestroyed = false;
+
+class ParcelBufferPool {
+public:
+    ~ParcelBufferPool() {
+        tParcelBufferPoolDestroyed = true;
+        for (size_t i = 0; i < mCount; i++) {
+            free(mSlots[i].data);
+        }
+        mCount = 0;
+    }
+
+    // Returns a buffer of at least `minCapacity` bytes and stores its real
+    // capacity in `outCapacity`, or nullptr if no pooled buffer fits.
+    void* take(size_t minCapacity, size_t* outCapacity) {
+        for (size_t i = mCount; i > 0; i--) {
+            Slot& slot = mSlots[i - 1];
+            if (slot.capacity >= minCapacity) {
+                void* data = slot.data;
+                *outCapacity = slot.capacity;
+                slot = mSlots[--mCount];
+                return data;
+            }
+        }
+        return nullptr;
+    }
+
+    // Takes ownership of `data` if it can be recycled. Returns false if the
+    // caller must free() it itself.
+    bool give(void* data, size_t capacity) {
+        if (capacity == 0 || capacity > kParcelBufferPoolMaxCapacity) return false;
+        if (mCount == kParcelBufferPoolSlots) return false;
+        mSlots[mCount++] = {data, capacity};
+        return true;
+    }
+
+private:
+    struct Slot {
+        void* data;
+        size_t capacity;
+    };
+    Slot mSlots[kParcelBufferPoolSlots] = {};
+    size_t mCount = 0;
+};
+
+ParcelBufferPool* threadParcelBufferPool() {
+    if (tParcelBufferPoolDestroyed) return nullptr;
+    thread_local ParcelBufferPool pool;
+    return &pool;
+}
+
+void* takePooledParcelBuffer(size_t minCapacity, size_t* outCapacity) {
+    if (minCapacity > kParcelBufferPoolMaxCapacity) return nullptr;
+    ParcelBufferPool* pool = threadParcelBufferPool();
+    return pool ? pool->take(minCapacity, outCapacity) : nullptr;
+}
+
+void freePooledParcelBuffer(void* data, size_t capacity) {
+    if (data == nullptr) return;
+    ParcelBufferPool* pool = threadParcelBufferPool();
+    if (pool == nullptr || !pool->give(data, capacity)) free(data);
+}
+} // namespace
+
 // Maximum size of a blob to transfer in-place.
 [[maybe_unused]] static const size_t BLOB_INPLACE_LIMIT = 16 * 1024;
 
@@ -1829,8 +1906,16 @@ restart_write:
         if ((kernelFields->mObjectsSize + 2) > SIZE_MAX / 3) return NO_MEMORY; // overflow
         size_t newSize = ((kernelFields->mObjectsSize + 2) * 3) / 2;
         if (newSize > SIZE_MAX / sizeof(binder_size_t)) return NO_MEMORY; // overflow
-        binder_size_t* objects =
-                (binder_size_t*)realloc(kernelFields->mObjects, newSize * sizeof(binder_size_t));
+        binder_size_t* objects = nullptr;
+        size_t pooledBytes = 0;
+        if (kernelFields->mObjects == nullptr &&
+            (objects = static_cast<binder_size_t*>(
+                     takePooledParcelBuffer(newSize * sizeof(binder_size_t), &pooledBytes)))) {
+            newSize = pooledBytes / sizeof(binder_size_t);
+        } else {
+            objects = (binder_size_t*)realloc(kernelFields->mObjects,
+                                              newSize * sizeof(binder_size_t));
+        }
         if (objects == nullptr) return NO_MEMORY;
         kernelFields->mObjects = objects;
         kernelFields->mObjectsCapacity = newSize;
@@ -2933,10 +3018,13 @@ void Parcel::freeDataNoInit()
             if (mDeallocZero) {
                 zeroMemory(mData, mDataSize);
             }
-            free(mData);
+            freePooledParcelBuffer(mData, mDataCapacity);
         }
         auto* kernelFields = maybeKernelFields();
-        if (kernelFields && kernelFields->mObjects) free(kernelFields->mObjects);
+        if (kernelFields && kernelFields->mObjects) {
+            freePooledParcelBuffer(kernelFields->mObjects,
+                                   kernelFields->mObjectsCapacity * sizeof(binder_size_t));
+        }
     }
 }
 
@@ -2956,8 +3044,12 @@ status_t Parcel::growData(size_t len)
             : continueWrite(std::max(newSize, (size_t) 128));
 }
 
-static uint8_t* reallocZeroFree(uint8_t* data, size_t oldCapacity, size_t newCapacity, bool zero) {
-    if (!zero) {
+// Resizes the buffer, preserving only the first `keepSize` bytes. Anything past
+// that is garbage from the caller's point of view, so it is never copied.
+static uint8_t* reallocZeroFree(uint8_t* data, size_t oldCapacity, size_t newCapacity,
+                                size_t keepSize, bool zero) {
+    keepSize = std::min(keepSize, std::min(oldCapacity, newCapacity));
+    if (!zero && keepSize > 0) {
         return (uint8_t*)realloc(data, newCapacity);
     }
     uint8_t* newData = (uint8_t*)malloc(newCapacity);
@@ -2965,8 +3057,12 @@ static uint8_t* reallocZeroFree(uint8_t* data, size_t oldCapacity, size_t newCap
         return nullptr;
     }
 
-    memcpy(newData, data, std::min(oldCapacity, newCapacity));
-    zeroMemory(data, oldCapacity);
+    if (keepSize > 0) {
+        memcpy(newData, data, keepSize);
+    }
+    if (zero && data) {
+        zeroMemory(data, oldCapacity);
+    }
     free(data);
     return newData;
 }
@@ -2986,7 +3082,16 @@ status_t Parcel::restartWrite(size_t desired)
 
     releaseObjects();
 
-    uint8_t* data = reallocZeroFree(mData, mDataCapacity, desired, mDeallocZero);
+    // Nothing written so far survives a restart, so don't pay for copying it.
+    uint8_t* data;
+    if (mData && desired == mDataCapacity) {
+        if (mDeallocZero) {
+            zeroMemory(mData, mDataSize);
+        }
+        data = mData;
+    } else {
+        data = reallocZeroFree(mData, mDataCapacity, desired, 0, mDeallocZero);
+    }
     if (!data && desired > mDataCapacity) {
         LOG_ALWAYS_FATAL("out of memory");
         mError = NO_MEMORY;
@@ -3013,7 +3118,8 @@ status_t Parcel::restartWrite(size_t desired)
     ALOGV("restartWrite Setting data pos of %p to %zu", this, mDataPos);
 
     if (auto* kernelFields = maybeKernelFields()) {
-        free(kernelFields->mObjects);
+        freePooledParcelBuffer(kernelFields->mObjects,
+                               kernelFields->mObjectsCapacity * sizeof(binder_size_t));
         kernelFields->mObjects = nullptr;
         kernelFields->mObjectsSize = kernelFields->mObjectsCapacity = 0;
         kernelFields->mNextObjectHint = 0;
@@ -3175,7 +3281,8 @@ status_t Parcel::continueWrite(size_t desired)
 
         // We own the data, so we can just do a realloc().
         if (desired > mDataCapacity) {
-            uint8_t* data = reallocZeroFree(mData, mDataCapacity, desired, mDeallocZero);
+            uint8_t* data =
+                    reallocZeroFree(mData, mDataCapacity, desired, mDataSize, mDeallocZero);
             if (data) {
                 LOG_ALLOC("Parcel %p: continue from %zu to %zu capacity", this, mDataCapacity,
                         desired);
@@ -3200,7 +3307,12 @@ status_t Parcel::continueWrite(size_t desired)
 
     } else {
         // This is the first data.  Easy!
-        uint8_t* data = (uint8_t*)malloc(desired);
+        size_t capacity = desired;
+        uint8_t* data = static_cast<uint8_t*>(takePooledParcelBuffer(desired, &capacity));
+        if (!data) {
+            capacity = desired;
+            data = (uint8_t*)malloc(desired);
+        }
         if (!data) {
             mError = NO_MEMORY;
             return NO_MEMORY;
@@ -3214,15 +3326,15 @@ status_t Parcel::continueWrite(size_t desired)
                   kernelFields ? kernelFields->mObjectsCapacity : 0, desired);
         }
 
-        LOG_ALLOC("Parcel %p: allocating with %zu capacity", this, desired);
-        gParcelGlobalAllocSize += desired;
+        LOG_ALLOC("Parcel %p: allocating with %zu capacity", this, capacity);
+        gParcelGlobalAllocSize += capacity;
         gParcelGlobalAllocCount++;
 
         mData = data;
         mDataSize = mDataPos = 0;
         ALOGV("continueWrite Setting data size of %p to %zu", this, mDataSize);
         ALOGV("continueWrite Setting data pos of %p to %zu", this, mDataPos);
-        mDataCapacity = desired;
+        mDataCapacity = capacity;
     }
 
     return NO_ERROR;
@@ -96,6 +96,13 @@ status_t PersistableBundle::writeToParcel(Parcel* parcel) const {
      * frameworks/base/core/java/android/os/BaseBundle.java.
      */
 
+    // Data read lazily is written back as-is.
+    if (mUnparsedData != nullptr) {
+        RETURN_IF_FAILED(parcel->writeInt32(static_cast<int32_t>(mUnparsedData->size())));
+        RETURN_IF_FAILED(parcel->write(mUnparsedData->data(), mUnparsedData->size()));
+        return NO_ERROR;
+    }
+
     // Special case for empty bundles.
     if (empty()) {
         RETURN_IF_FAILED(parcel->writeInt32(0));
@@ -133,14 +140,69 @@ status_t PersistableBundle::readFromParcel(const Parcel* parcel) {
         return UNEXPECTED_NULL;
     }
 
+    unparcel();
     return readFromParcelInner(parcel, static_cast<size_t>(length));
 }
 
+status_t PersistableBundle::readFromParcelLazily(const Parcel* parcel) {
+    // Entries read into a bundle that isn't empty are added to it, which needs them parsed.
+    if (!empty()) {
+        return readFromParcel(parcel);
+    }
+
+    int32_t length = parcel->readInt32();
+    if (length < 0) {
+        ALOGE("Bad length in parcel: %d", length);
+        return UNEXPECTED_NULL;
+    }
+    if (length == 0) {
+        return NO_ERROR;
+    }
+    const uint8_t* data = static_cast<const uint8_t*>(parcel->readInplace(length));
+    if (data == nullptr) {
+        ALOGE("Bad length in parcel: %d, %zu bytes left", length, parcel->dataAvail());
+        return BAD_VALUE;
+    }
+    mUnparsedData = std::make_shared<const std::vector<uint8_t>>(data, data + length);
+    return NO_ERROR;
+}
+
+void PersistableBundle::unparcel() const {
+    if (mUnparsedData == nullptr) {
+        return;
+    }
+    std::shared_ptr<const std::vector<uint8_t>> data = std::move(mUnparsedData);
+    mUnparsedData = nullptr;
+
+    Parcel parcel;
+    PersistableBundle parsed;
+    status_t status = parcel.setData(data->data(), data->size());
+    if (status == NO_ERROR) {
+        status = parsed.readFromParcelInner(&parcel, data->size());
+    }
+    if (status != NO_ERROR) {
+        ALOGE("Failed to parse lazily read PersistableBundle: %d", status);
+        return;
+    }
+    mBoolMap = std::move(parsed.mBoolMap);
+    mIntMap = std::move(parsed.mIntMap);
+    mLongMap = std::move(parsed.mLongMap);
+    mDoubleMap = std::move(parsed.mDoubleMap);
+    mStringMap = std::move(parsed.mStringMap);
+    mBoolVectorMap = std::move(parsed.mBoolVectorMap);
+    mIntVectorMap = std::move(parsed.mIntVectorMap);
+    mLongVectorMap = std::move(parsed.mLongVectorMap);
+    mDoubleVectorMap = std::move(parsed.mDoubleVectorMap);
+    mStringVectorMap = std::move(parsed.mStringVectorMap);
+    mPersistableBundleMap = std::move(parsed.mPersistableBundleMap);
+}
+
 bool PersistableBundle::empty() const {
     return size() == 0u;
 }
 
 size_t PersistableBundle::size() const {
+    unparcel();
     return (mBoolMap.size() +
             mIntMap.size() +
             mLongMap.size() +
@@ -155,6 +217,7 @@ size_t PersistableBundle::size() const {
 }
 
 size_t PersistableBundle::erase(const String16& key) {
+    unparcel();
     RETURN_IF_ENTRY_ERASED(mBoolMap, key);
     RETURN_IF_ENTRY_ERASED(mIntMap, key);
     RETURN_IF_ENTRY_ERASED(mLongMap, key);
@@ -224,90 +287,112 @@ void PersistableBundle::putPersistableBundle(const String16& key, const Persista
 }
 
 bool PersistableBundle::getBoolean(const String16& key, bool* out) const {
+    unparcel();
     return getValue(key, out, mBoolMap);
 }
 
 bool PersistableBundle::getInt(const String16& key, int32_t* out) const {
+    unparcel();
     return getValue(key, out, mIntMap);
 }
 
 bool PersistableBundle::getLong(const String16& key, int64_t* out) const {
+    unparcel();
     return getValue(key, out, mLongMap);
 }
 
 bool PersistableBundle::getDouble(const String16& key, double* out) const {
+    unparcel();
     return getValue(key, out, mDoubleMap);
 }
 
 bool PersistableBundle::getString(const String16& key, String16* out) const {
+    unparcel();
     return getValue(key, out, mStringMap);
 }
 
 bool PersistableBundle::getBooleanVector(const String16& key, vector<bool>* out) const {
+    unparcel();
     return getValue(key, out, mBoolVectorMap);
 }
 
 bool PersistableBundle::getIntVector(const String16& key, vector<int32_t>* out) const {
+    unparcel();
     return getValue(key, out, mIntVectorMap);
 }
 
 bool PersistableBundle::getLongVector(const String16& key, vector<int64_t>* out) const {
+    unparcel();
     return getValue(key, out, mLongVectorMap);
 }
 
 bool PersistableBundle::getDoubleVector(const String16& key, vector<double>* out) const {
+    unparcel();
     return getValue(key, out, mDoubleVectorMap);
 }
 
 bool PersistableBundle::getStringVector(const String16& key, vector<String16>* out) const {
+    unparcel();
     return getValue(key, out, mStringVectorMap);
 }
 
 bool PersistableBundle::getPersistableBundle(const String16& key, PersistableBundle* out) const {
+    unparcel();
     return getValue(key, out, mPersistableBundleMap);
 }
 
 set<String16> PersistableBundle::getBooleanKeys() const {
+    unparcel();
     return getKeys(mBoolMap);
 }
 
 set<String16> PersistableBundle::getIntKeys() const {
+    unparcel();
     return getKeys(mIntMap);
 }
 
 set<String16> PersistableBundle::getLongKeys() const {
+    unparcel();
     return getKeys(mLongMap);
 }
 
 set<String16> PersistableBundle::getDoubleKeys() const {
+    unparcel();
     return getKeys(mDoubleMap);
 }
 
 set<String16> PersistableBundle::getStringKeys() const {
+    unparcel();
     return getKeys(mStringMap);
 }
 
 set<String16> PersistableBundle::getBooleanVectorKeys() const {
+    unparcel();
     return getKeys(mBoolVectorMap);
 }
 
 set<String16> PersistableBundle::getIntVectorKeys() const {
+    unparcel();
     return getKeys(mIntVectorMap);
 }
 
 set<String16> PersistableBundle::getLongVectorKeys() const {
+    unparcel();
     return getKeys(mLongVectorMap);
 }
 
 set<String16> PersistableBundle::getDoubleVectorKeys() const {
+    unparcel();
     return getKeys(mDoubleVectorMap);
 }
 
 set<String16> PersistableBundle::getStringVectorKeys() const {
+    unparcel();
     return getKeys(mStringVectorMap);
 }
 
 set<String16> PersistableBundle::getPersistableBundleKeys() const {
+    unparcel();
     return getKeys(mPersistableBundleMap);
 }
 
@@ -318,7 +403,7 @@ status_t PersistableBundle::writeToParcelInner(Parcel* parcel) const {
      * value pairs must be written into the parcel before writing the key-value
      * pairs themselves.
      */
-    size_t num_entries = size();
+    size_t num_entries = size();  // Also parses any lazily read data.
     if (num_entries > static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
         ALOGE("The size of this PersistableBundle (%zu) too large to store in 32-bit signed int",
               num_entries);
@@ -34,6 +34,7 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <inttypes.h>
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -323,17 +324,39 @@ ProcessState::handle_entry* ProcessState::lookupHandleLocked(int32_t handle)
     return &mHandleToObject.editItemAt(handle);
 }
 
+sp<IBinder> ProcessState::getExistingProxyLocked(int32_t handle)
+{
+    if (handle < 0 || static_cast<size_t>(handle) >= mHandleToObject.size()) return nullptr;
+
+    const handle_entry& e = mHandleToObject[handle];
+    // Only called with mHandleLock held (at least shared), so expungeHandle()
+    // can't run and the weak refs of a non-null binder are still valid.
+    IBinder* b = e.binder;
+    if (b == nullptr || !e.refs->attemptIncWeak(this)) return nullptr;
+
+    sp<IBinder> result;
+    result.force_set(b);
+    e.refs->decWeak(this);
+    return result;
+}
+
 // see b/166779391: cannot change the VNDK interface, so access like this
 extern sp<BBinder> the_context_object;
 
 sp<IBinder> ProcessState::getStrongProxyForHandle(int32_t handle)
 {
+    if (handle == 0 && the_context_object != nullptr) return the_context_object;
+
+    // Fast path, the proxy usually already exists.
+    {
+        std::shared_lock<std::shared_mutex> _l(mHandleLock);
+        if (sp<IBinder> result = getExistingProxyLocked(handle)) return result;
+    }
+
     sp<IBinder> result;
     std::function<void()> postTask;
 
-    std::unique_lock<std::mutex> _l(mLock);
-
-    if (handle == 0 && the_context_object != nullptr) return the_context_object;
+    std::unique_lock<std::shared_mutex> _l(mHandleLock);
 
     handle_entry* e = lookupHandleLocked(handle);
 
@@ -399,7 +422,7 @@ sp<IBinder> ProcessState::getStrongProxyForHandle(int32_t handle)
 
 void ProcessState::expungeHandle(int32_t handle, IBinder* binder)
 {
-    std::unique_lock<std::mutex> _l(mLock);
+    std::unique_lock<std::shared_mutex> _l(mHandleLock);
 
     handle_entry* e = lookupHandleLocked(handle);
 
@@ -451,6 +474,55 @@ status_t ProcessState::setThreadPoolMaxThreadCount(size_t maxThreads) {
     return result;
 }
 
+status_t ProcessState::setThreadPoolAdaptiveMaxThreadCount(size_t maxThreads,
+                                                           std::chrono::milliseconds growAfter) {
+    if (maxThreads < mMaxThreads || growAfter.count() < 0) {
+        ALOGE("Invalid adaptive thread pool: %zu max threads (currently %zu), grow after %" PRId64
+              " ms",
+              maxThreads, mMaxThreads.load(), static_cast<int64_t>(growAfter.count()));
+        return BAD_VALUE;
+    }
+    mAdaptiveGrowAfterNs = std::chrono::nanoseconds(growAfter).count();
+    mAdaptiveMaxThreads = maxThreads;
+    return NO_ERROR;
+}
+
+void ProcessState::onThreadPoolStarvationEnded(std::chrono::nanoseconds starvationTime) {
+    const uint64_t starvationNs = starvationTime.count();
+    mStarvationCount.fetch_add(1, std::memory_order_relaxed);
+    mTotalStarvationNs.fetch_add(starvationNs, std::memory_order_relaxed);
+    uint64_t longest = mLongestStarvationNs.load(std::memory_order_relaxed);
+    while (starvationNs > longest &&
+           !mLongestStarvationNs.compare_exchange_weak(longest, starvationNs,
+                                                       std::memory_order_relaxed)) {
+    }
+
+    size_t adaptiveMax = mAdaptiveMaxThreads.load(std::memory_order_relaxed);
+    if (adaptiveMax == 0 || mMaxThreads >= adaptiveMax ||
+        starvationTime.count() < mAdaptiveGrowAfterNs.load(std::memory_order_relaxed)) {
+        return;
+    }
+    std::lock_guard<std::mutex> _l(mLock);
+    size_t maxThreads = mMaxThreads + 1;
+    if (maxThreads > adaptiveMax) return;
+    if (setThreadPoolMaxThreadCount(maxThreads) == NO_ERROR) {
+        ALOGI("binder thread pool starved for %" PRId64 " ms, growing to %zu threads",
+              static_cast<int64_t>(starvationNs / 1000000), maxThreads);
+    }
+}
+
+binder::debug::ThreadPoolStats ProcessState::getThreadPoolStats() const {
+    binder::debug::ThreadPoolStats stats;
+    stats.currentThreads = mCurrentThreads;
+    stats.maxThreads = mMaxThreads;
+    stats.executingThreads = mExecutingThreadsCount;
+    stats.peakExecutingThreads = mPeakExecutingThreads.load(std::memory_order_relaxed);
+    stats.starvationCount = mStarvationCount.load(std::memory_order_relaxed);
+    stats.totalStarvationNs = mTotalStarvationNs.load(std::memory_order_relaxed);
+    stats.longestStarvationNs = mLongestStarvationNs.load(std::memory_order_relaxed);
+    return stats;
+}
+
 size_t ProcessState::getThreadPoolMaxTotalThreadCount() const {
     // Need to read `mKernelStartedThreads` before `mThreadPoolStarted` (with
     // non-relaxed memory ordering) to avoid a race like the following:
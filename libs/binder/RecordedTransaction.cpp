@@ -21,6 +21,7 @@
 #include <binder/unique_fd.h>
 
 #include <inttypes.h>
+#include <string.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <algorithm>
@@ -310,8 +311,9 @@ std::optional<RecordedTransaction> RecordedTransaction::fromFile(const unique_fd
     return std::optional<RecordedTransaction>(std::move(t));
 }
 
-android::status_t RecordedTransaction::writeChunk(borrowed_fd fd, uint32_t chunkType,
-                                                  size_t byteCount, const uint8_t* data) const {
+android::status_t RecordedTransaction::writeChunk(std::vector<uint8_t>* buffer,
+                                                  uint32_t chunkType, size_t byteCount,
+                                                  const uint8_t* data) const {
     if (byteCount > kMaxChunkDataSize) {
         ALOGE("Chunk data exceeds maximum size");
         return BAD_VALUE;
@@ -319,71 +321,87 @@ android::status_t RecordedTransaction::writeChunk(borrowed_fd fd, uint32_t chunk
     ChunkDescriptor descriptor = {.chunkType = chunkType,
                                   .dataSize = static_cast<uint32_t>(byteCount)};
     // Prepare Chunk content as byte *
-    const std::byte* descriptorBytes = reinterpret_cast<const std::byte*>(&descriptor);
-    const std::byte* dataBytes = reinterpret_cast<const std::byte*>(data);
-
-    // Add Chunk to intermediate buffer, except checksum
-    std::vector<std::byte> buffer;
-    buffer.insert(buffer.end(), descriptorBytes, descriptorBytes + sizeof(ChunkDescriptor));
-    buffer.insert(buffer.end(), dataBytes, dataBytes + byteCount);
-    std::byte zero{0};
-    buffer.insert(buffer.end(), PADDING8(byteCount), zero);
-
-    // Calculate checksum from buffer
-    transaction_checksum_t* checksumData = reinterpret_cast<transaction_checksum_t*>(buffer.data());
+    const uint8_t* descriptorBytes = reinterpret_cast<const uint8_t*>(&descriptor);
+
+    // Add Chunk to buffer, except checksum
+    const size_t chunkStart = buffer->size();
+    buffer->insert(buffer->end(), descriptorBytes, descriptorBytes + sizeof(ChunkDescriptor));
+    if (byteCount > 0) {
+        buffer->insert(buffer->end(), data, data + byteCount);
+    }
+    buffer->insert(buffer->end(), PADDING8(byteCount), 0);
+
+    // Calculate checksum from the chunk, which need not be 8-byte aligned within buffer
     transaction_checksum_t checksumValue = 0;
-    for (size_t idx = 0; idx < (buffer.size() / sizeof(transaction_checksum_t)); idx++) {
-        checksumValue ^= checksumData[idx];
+    for (size_t offset = chunkStart; offset < buffer->size();
+         offset += sizeof(transaction_checksum_t)) {
+        transaction_checksum_t word;
+        memcpy(&word, buffer->data() + offset, sizeof(word));
+        checksumValue ^= word;
     }
 
     // Write checksum to buffer
-    std::byte* checksumBytes = reinterpret_cast<std::byte*>(&checksumValue);
-    buffer.insert(buffer.end(), checksumBytes, checksumBytes + sizeof(transaction_checksum_t));
+    const uint8_t* checksumBytes = reinterpret_cast<const uint8_t*>(&checksumValue);
+    buffer->insert(buffer->end(), checksumBytes, checksumBytes + sizeof(transaction_checksum_t));
+    return NO_ERROR;
+}
 
-    // Write buffer to file
+android::status_t RecordedTransaction::dumpToFile(const unique_fd& fd) const {
+    std::vector<uint8_t> buffer;
+    if (status_t err = dumpToBuffer(&buffer); err != NO_ERROR) {
+        return err;
+    }
     if (!WriteFully(fd, buffer.data(), buffer.size())) {
-        ALOGE("Failed to write chunk fd %d", fd.get());
+        ALOGE("Failed to write transaction to fd %d", fd.get());
         return UNKNOWN_ERROR;
     }
     return NO_ERROR;
 }
 
-android::status_t RecordedTransaction::dumpToFile(const unique_fd& fd) const {
+android::status_t RecordedTransaction::dumpToBuffer(std::vector<uint8_t>* buffer) const {
+    constexpr size_t kChunkOverhead = sizeof(ChunkDescriptor) + 7 + sizeof(transaction_checksum_t);
+    buffer->reserve(buffer->size() + 6 * kChunkOverhead + sizeof(TransactionHeader) +
+                    mData.mInterfaceName.size() + mSentDataOnly.dataBufferSize() +
+                    mReplyDataOnly.dataBufferSize() +
+                    mData.mSentObjectData.size() * sizeof(uint64_t));
+
     if (NO_ERROR !=
-        writeChunk(fd, HEADER_CHUNK, sizeof(TransactionHeader),
+        writeChunk(buffer, HEADER_CHUNK, sizeof(TransactionHeader),
                    reinterpret_cast<const uint8_t*>(&(mData.mHeader)))) {
-        ALOGE("Failed to write transactionHeader to fd %d", fd.get());
+        ALOGE("Failed to write transactionHeader");
         return UNKNOWN_ERROR;
     }
     if (NO_ERROR !=
-        writeChunk(fd, INTERFACE_NAME_CHUNK, mData.mInterfaceName.size() * sizeof(uint8_t),
+        writeChunk(buffer, INTERFACE_NAME_CHUNK, mData.mInterfaceName.size() * sizeof(uint8_t),
                    reinterpret_cast<const uint8_t*>(mData.mInterfaceName.c_str()))) {
-        ALOGI("Failed to write Interface Name Chunk to fd %d", fd.get());
+        ALOGI("Failed to write Interface Name Chunk");
         return UNKNOWN_ERROR;
     }
 
     if (NO_ERROR !=
-        writeChunk(fd, DATA_PARCEL_CHUNK, mSentDataOnly.dataBufferSize(), mSentDataOnly.data())) {
-        ALOGE("Failed to write sent Parcel to fd %d", fd.get());
+        writeChunk(buffer, DATA_PARCEL_CHUNK, mSentDataOnly.dataBufferSize(),
+                   mSentDataOnly.data())) {
+        ALOGE("Failed to write sent Parcel");
         return UNKNOWN_ERROR;
     }
 
     if (NO_ERROR !=
-        writeChunk(fd, REPLY_PARCEL_CHUNK, mReplyDataOnly.dataBufferSize(),
+        writeChunk(buffer, REPLY_PARCEL_CHUNK, mReplyDataOnly.dataBufferSize(),
                    mReplyDataOnly.data())) {
-        ALOGE("Failed to write reply Parcel to fd %d", fd.get());
+        ALOGE("Failed to write reply Parcel");
         return UNKNOWN_ERROR;
     }
 
     if (NO_ERROR !=
-        writeChunk(fd, DATA_PARCEL_OBJECT_CHUNK, mData.mSentObjectData.size() * sizeof(uint64_t),
+        writeChunk(buffer, DATA_PARCEL_OBJECT_CHUNK,
+                   mData.mSentObjectData.size() * sizeof(uint64_t),
                    reinterpret_cast<const uint8_t*>(mData.mSentObjectData.data()))) {
-        ALOGE("Failed to write sent parcel object metadata to fd %d", fd.get());
+        ALOGE("Failed to write sent parcel object metadata");
         return UNKNOWN_ERROR;
     }
 
-    if (NO_ERROR != writeChunk(fd, END_CHUNK, 0, nullptr)) {
-        ALOGE("Failed to write end chunk to fd %d", fd.get());
+    if (NO_ERROR != writeChunk(buffer, END_CHUNK, 0, nullptr)) {
+        ALOGE("Failed to write end chunk");
         return UNKNOWN_ERROR;
     }
     return NO_ERROR;
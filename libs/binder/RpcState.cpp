@@ -24,6 +24,7 @@
 #include <binder/RpcServer.h>
 
 #include "Debug.h"
+#include "OS.h"
 #include "RpcWireFormat.h"
 #include "Utils.h"
 
@@ -66,6 +67,68 @@ static bool enableAncillaryFds(RpcSession::FileDescriptorTransportMode mode) {
     LOG_ALWAYS_FATAL("Invalid FileDescriptorTransportMode: %d", static_cast<int>(mode));
 }
 
+// Parcels at least this large are passed through sealed shared memory,
+// when the session supports it, instead of being streamed over the socket.
+constexpr size_t kSharedMemoryPayloadMinSize = 256 * 1024;
+// Linux allows 253 (SCM_MAX_FD) FDs per unix socket message, and the shared
+// memory FD travels alongside the parcel's own FDs.
+constexpr size_t kMaxParcelFdsWithSharedMemoryPayload = 252;
+
+using AncillaryFds = std::vector<std::variant<unique_fd, borrowed_fd>>;
+
+static bool useSharedMemoryPayload(const sp<RpcSession>& session, size_t dataSize,
+                                   const AncillaryFds* parcelFds) {
+    return dataSize >= kSharedMemoryPayloadMinSize &&
+            session->getFileDescriptorTransportMode() ==
+            RpcSession::FileDescriptorTransportMode::UNIX &&
+            session->getProtocolVersion().value() >=
+            RPC_WIRE_PROTOCOL_VERSION_RPC_HEADER_FEATURE_SHARED_MEMORY_PAYLOAD &&
+            (parcelFds == nullptr || parcelFds->size() <= kMaxParcelFdsWithSharedMemoryPayload);
+}
+
+// Copies the parcel data into sealed shared memory and builds the ancillary
+// FDs to send with the command: the parcel's own FDs followed by the region.
+static status_t prepareSharedMemoryPayload(const uint8_t* data, size_t dataSize,
+                                           const AncillaryFds* parcelFds, AncillaryFds* outFds) {
+    unique_fd payloadFd;
+    if (status_t status = binder::os::createSealedSharedMemory(data, dataSize, &payloadFd);
+        status != OK) {
+        ALOGW("Could not create shared memory payload, sending inline: %s",
+              statusToString(status).c_str());
+        return status;
+    }
+    outFds->clear();
+    if (parcelFds != nullptr) {
+        outFds->reserve(parcelFds->size() + 1);
+        for (const auto& fd : *parcelFds) {
+            outFds->emplace_back(std::visit([](const auto& f) { return borrowed_fd(f.get()); }, fd));
+        }
+    }
+    outFds->emplace_back(std::move(payloadFd));
+    return OK;
+}
+
+// Takes the shared memory FD carrying a command's parcel data off the end of
+// `ancillaryFds` and maps it. The mapping outlives the FD.
+static status_t receiveSharedMemoryPayload(const sp<RpcSession>& session, size_t dataSize,
+                                           AncillaryFds* ancillaryFds, const void** outData) {
+    if (session->getProtocolVersion().value() <
+                RPC_WIRE_PROTOCOL_VERSION_RPC_HEADER_FEATURE_SHARED_MEMORY_PAYLOAD ||
+        ancillaryFds == nullptr || ancillaryFds->empty() || dataSize == 0) {
+        ALOGE("Unexpected shared memory payload (protocol %" PRIu32 ", %zu fds, %zu bytes)",
+              session->getProtocolVersion().value(), ancillaryFds ? ancillaryFds->size() : 0,
+              dataSize);
+        return BAD_VALUE;
+    }
+    auto payloadFd = std::move(ancillaryFds->back());
+    ancillaryFds->pop_back();
+    return binder::os::mapSealedSharedMemory(std::visit([](const auto& f) {
+                                                 return borrowed_fd(f.get());
+                                             },
+                                                        payloadFd),
+                                             dataSize, outData);
+}
+
 RpcState::RpcState() {}
 RpcState::~RpcState() {}
 
@@ -568,12 +631,26 @@ status_t RpcState::transactAddress(const sp<RpcSession::RpcConnection>& connecti
     Span<const uint32_t> objectTableSpan = Span<const uint32_t>{rpcFields->mObjectPositions.data(),
                                                                 rpcFields->mObjectPositions.size()};
 
+    const AncillaryFds* ancillaryFds = rpcFields->mFds.get();
+    AncillaryFds fdsWithPayload;
+    uint32_t payloadOptions = 0;
+    if (useSharedMemoryPayload(session, data.dataSize(), ancillaryFds) &&
+        prepareSharedMemoryPayload(data.data(), data.dataSize(), ancillaryFds, &fdsWithPayload) ==
+                OK) {
+        payloadOptions |= RPC_WIRE_PAYLOAD_OPTION_SHARED_MEMORY;
+        ancillaryFds = &fdsWithPayload;
+    }
+    const size_t inlineDataSize =
+            (payloadOptions & RPC_WIRE_PAYLOAD_OPTION_SHARED_MEMORY) ? 0 : data.dataSize();
+
     uint32_t bodySize;
     LOG_ALWAYS_FATAL_IF(__builtin_add_overflow(sizeof(RpcWireTransaction), data.dataSize(),
                                                &bodySize) ||
                                 __builtin_add_overflow(objectTableSpan.byteSize(), bodySize,
                                                        &bodySize),
                         "Too much data %zu", data.dataSize());
+    // the check above covered the larger, inline size
+    bodySize -= data.dataSize() - inlineDataSize;
     RpcWireHeader command{
             .command = RPC_COMMAND_TRANSACT,
             .bodySize = bodySize,
@@ -586,6 +663,7 @@ status_t RpcState::transactAddress(const sp<RpcSession::RpcConnection>& connecti
             .asyncNumber = asyncNumber,
             // bodySize didn't overflow => this cast is safe
             .parcelDataSize = static_cast<uint32_t>(data.dataSize()),
+            .payloadOptions = payloadOptions,
     };
 
     // Oneway calls have no sync point, so if many are sent before, whether this
@@ -598,7 +676,7 @@ status_t RpcState::transactAddress(const sp<RpcSession::RpcConnection>& connecti
     iovec iovs[]{
             {&command, sizeof(RpcWireHeader)},
             {&transaction, sizeof(RpcWireTransaction)},
-            {const_cast<uint8_t*>(data.data()), data.dataSize()},
+            {const_cast<uint8_t*>(data.data()), inlineDataSize},
             objectTableSpan.toIovec(),
     };
     auto altPoll = [&] {
@@ -618,7 +696,7 @@ status_t RpcState::transactAddress(const sp<RpcSession::RpcConnection>& connecti
         return drainCommands(connection, session, CommandType::CONTROL_ONLY);
     };
     if (status_t status = rpcSend(connection, session, "transaction", iovs, countof(iovs),
-                                  std::ref(altPoll), rpcFields->mFds.get());
+                                  std::ref(altPoll), ancillaryFds);
         status != OK) {
         // rpcSend calls shutdownAndWait, so all refcounts should be reset. If we ever tolerate
         // errors here, then we may need to undo the binder-sent counts for the transaction as
@@ -647,6 +725,13 @@ static void cleanup_reply_data(const uint8_t* data, size_t dataSize, const binde
     (void)objectsCount;
 }
 
+static void cleanup_shared_reply_data(const uint8_t* data, size_t dataSize,
+                                      const binder_size_t* objects, size_t objectsCount) {
+    binder::os::unmapSharedMemory(data, dataSize);
+    LOG_ALWAYS_FATAL_IF(objects != nullptr);
+    (void)objectsCount;
+}
+
 status_t RpcState::waitForReply(const sp<RpcSession::RpcConnection>& connection,
                                 const sp<RpcSession>& session, Parcel* reply) {
     std::vector<std::variant<unique_fd, borrowed_fd>> ancillaryFds;
@@ -696,6 +781,26 @@ status_t RpcState::waitForReply(const sp<RpcSession::RpcConnection>& connection,
 
     if (rpcReply.status != OK) return rpcReply.status;
 
+    if (rpcReply.payloadOptions & RPC_WIRE_PAYLOAD_OPTION_SHARED_MEMORY) {
+        // the body only holds the object table, which rpcSetDataReference copies
+        std::optional<Span<const uint32_t>> objectTableSpan =
+                Span<const uint8_t>{data.data(), data.size()}.reinterpret<const uint32_t>();
+        const void* payload = nullptr;
+        if (!objectTableSpan.has_value() ||
+            receiveSharedMemoryPayload(session, rpcReply.parcelDataSize, &ancillaryFds,
+                                       &payload) != OK) {
+            ALOGE("Bad shared memory payload in RpcWireReply (bodySize=%" PRId32
+                  " parcelSize=%" PRId32 "). Terminating!",
+                  command.bodySize, rpcReply.parcelDataSize);
+            (void)session->shutdownAndWait(false);
+            return BAD_VALUE;
+        }
+        return reply->rpcSetDataReference(session, static_cast<const uint8_t*>(payload),
+                                          rpcReply.parcelDataSize, objectTableSpan->data,
+                                          objectTableSpan->size, std::move(ancillaryFds),
+                                          cleanup_shared_reply_data);
+    }
+
     Span<const uint8_t> parcelSpan = {data.data(), data.size()};
     Span<const uint32_t> objectTableSpan;
     if (session->getProtocolVersion().value() >=
@@ -956,8 +1061,27 @@ processTransactInternalTailCall:
                                           transactionData.size() -
                                                   offsetof(RpcWireTransaction, data)};
         Span<const uint32_t> objectTableSpan;
-        if (session->getProtocolVersion().value() >=
-            RPC_WIRE_PROTOCOL_VERSION_RPC_HEADER_FEATURE_EXPLICIT_PARCEL_SIZE) {
+        // Must outlive `data` below.
+        const void* sharedPayload = nullptr;
+        const size_t sharedPayloadSize = transaction->parcelDataSize;
+        auto unmapSharedPayload = make_scope_guard(
+                [&] { binder::os::unmapSharedMemory(sharedPayload, sharedPayloadSize); });
+        if (transaction->payloadOptions & RPC_WIRE_PAYLOAD_OPTION_SHARED_MEMORY) {
+            // the inline bytes only hold the object table
+            std::optional<Span<const uint32_t>> maybeSpan = parcelSpan.reinterpret<const uint32_t>();
+            if (!maybeSpan.has_value() ||
+                receiveSharedMemoryPayload(session, sharedPayloadSize, &ancillaryFds,
+                                           &sharedPayload) != OK) {
+                ALOGE("Bad shared memory payload in RpcWireTransaction (bodySize=%zu "
+                      "parcelSize=%" PRId32 "). Terminating!",
+                      transactionData.size(), transaction->parcelDataSize);
+                (void)session->shutdownAndWait(false);
+                return BAD_VALUE;
+            }
+            objectTableSpan = *maybeSpan;
+            parcelSpan = {static_cast<const uint8_t*>(sharedPayload), sharedPayloadSize};
+        } else if (session->getProtocolVersion().value() >=
+                   RPC_WIRE_PROTOCOL_VERSION_RPC_HEADER_FEATURE_EXPLICIT_PARCEL_SIZE) {
             std::optional<Span<const uint8_t>> objectTableBytes =
                     parcelSpan.splitOff(transaction->parcelDataSize);
             if (!objectTableBytes.has_value()) {
@@ -1120,11 +1244,25 @@ processTransactInternalTailCall:
     Span<const uint32_t> objectTableSpan = Span<const uint32_t>{rpcFields->mObjectPositions.data(),
                                                                 rpcFields->mObjectPositions.size()};
 
+    const AncillaryFds* ancillaryFds = rpcFields->mFds.get();
+    AncillaryFds fdsWithPayload;
+    uint32_t payloadOptions = 0;
+    if (useSharedMemoryPayload(session, reply.dataSize(), ancillaryFds) &&
+        prepareSharedMemoryPayload(reply.data(), reply.dataSize(), ancillaryFds,
+                                   &fdsWithPayload) == OK) {
+        payloadOptions |= RPC_WIRE_PAYLOAD_OPTION_SHARED_MEMORY;
+        ancillaryFds = &fdsWithPayload;
+    }
+    const size_t inlineDataSize =
+            (payloadOptions & RPC_WIRE_PAYLOAD_OPTION_SHARED_MEMORY) ? 0 : reply.dataSize();
+
     uint32_t bodySize;
     LOG_ALWAYS_FATAL_IF(__builtin_add_overflow(rpcReplyWireSize, reply.dataSize(), &bodySize) ||
                                 __builtin_add_overflow(objectTableSpan.byteSize(), bodySize,
                                                        &bodySize),
                         "Too much data for reply %zu", reply.dataSize());
+    // the check above covered the larger, inline size
+    bodySize -= reply.dataSize() - inlineDataSize;
     RpcWireHeader cmdReply{
             .command = RPC_COMMAND_REPLY,
             .bodySize = bodySize,
@@ -1135,16 +1273,16 @@ processTransactInternalTailCall:
             // version.
             // NOTE: bodySize didn't overflow => this cast is safe
             .parcelDataSize = static_cast<uint32_t>(reply.dataSize()),
-            .reserved = {0, 0, 0},
+            .payloadOptions = payloadOptions,
+            .reserved = {0, 0},
     };
     iovec iovs[]{
             {&cmdReply, sizeof(RpcWireHeader)},
             {&rpcReply, rpcReplyWireSize},
-            {const_cast<uint8_t*>(reply.data()), reply.dataSize()},
+            {const_cast<uint8_t*>(reply.data()), inlineDataSize},
             objectTableSpan.toIovec(),
     };
-    return rpcSend(connection, session, "reply", iovs, countof(iovs), std::nullopt,
-                   rpcFields->mFds.get());
+    return rpcSend(connection, session, "reply", iovs, countof(iovs), std::nullopt, ancillaryFds);
 }
 
 status_t RpcState::processDecStrong(const sp<RpcSession::RpcConnection>& connection,
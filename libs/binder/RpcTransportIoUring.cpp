@@ -0,0 +1,296 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "RpcIoUringTransport"
+#include <log/log.h>
+
+#include <inttypes.h>
+#include <liburing.h>
+#include <poll.h>
+#include <stddef.h>
+#include <sys/socket.h>
+
+#include <binder/Functional.h>
+#include <binder/RpcTransportIoUring.h>
+
+#include "FdTrigger.h"
+#include "OS.h"
+#include "RpcState.h"
+#include "RpcTransportUtils.h"
+
+namespace android {
+
+using namespace android::binder::impl;
+using android::binder::borrowed_fd;
+using android::binder::unique_fd;
+
+namespace {
+
+// One socket operation, the trigger poll and a cancellation can be in flight.
+constexpr unsigned kQueueDepth = 4;
+
+enum : uint64_t {
+    kTagSocketOp = 1,
+    kTagTrigger,
+    kTagCancel,
+};
+
+} // namespace
+
+// RpcTransport with TLS disabled, waiting through io_uring.
+//
+// Each interruptable read or write is a single io_uring_enter() which both
+// submits the sendmsg/recvmsg and waits for it, rather than a non-blocking
+// attempt, a poll() and a retry. The session's FdTrigger is watched by a poll
+// request kept armed on the same ring for the lifetime of the transport.
+//
+// Transfers which carry file descriptors, or which need altPoll to make
+// progress while the socket is full, use the same sendmsg/recvmsg path as
+// RpcTransportRaw.
+class RpcTransportIoUring : public RpcTransport {
+public:
+    explicit RpcTransportIoUring(android::RpcTransportFd socket) : mSocket(std::move(socket)) {}
+    ~RpcTransportIoUring() {
+        if (mRingInitialized) io_uring_queue_exit(&mRing);
+    }
+
+    status_t init() {
+        if (int ret = io_uring_queue_init(kQueueDepth, &mRing, 0); ret < 0) {
+            ALOGE("io_uring_queue_init failed: %s", strerror(-ret));
+            return ret;
+        }
+        mRingInitialized = true;
+        return OK;
+    }
+
+    status_t pollRead(void) override {
+        uint8_t buf;
+        ssize_t ret = TEMP_FAILURE_RETRY(
+                ::recv(mSocket.fd.get(), &buf, sizeof(buf), MSG_PEEK | MSG_DONTWAIT));
+        if (ret < 0) {
+            int savedErrno = errno;
+            if (savedErrno == EAGAIN || savedErrno == EWOULDBLOCK) {
+                return WOULD_BLOCK;
+            }
+
+            LOG_RPC_DETAIL("RpcTransport poll(): %s", strerror(savedErrno));
+            return -savedErrno;
+        } else if (ret == 0) {
+            return DEAD_OBJECT;
+        }
+
+        return OK;
+    }
+
+    status_t interruptableWriteFully(
+            FdTrigger* fdTrigger, iovec* iovs, int niovs,
+            const std::optional<SmallFunction<status_t()>>& altPoll,
+            const std::vector<std::variant<unique_fd, borrowed_fd>>* ancillaryFds) override {
+        if (altPoll || (ancillaryFds != nullptr && !ancillaryFds->empty())) {
+            bool sentFds = false;
+            auto send = [&](iovec* iovs, int niovs) -> ssize_t {
+                ssize_t ret = binder::os::sendMessageOnSocket(mSocket, iovs, niovs,
+                                                              sentFds ? nullptr : ancillaryFds);
+                sentFds |= ret > 0;
+                return ret;
+            };
+            return interruptableReadOrWrite(mSocket, fdTrigger, iovs, niovs, send, "sendmsg",
+                                            POLLOUT, altPoll);
+        }
+        return transferFully(fdTrigger, iovs, niovs, IORING_OP_SENDMSG);
+    }
+
+    status_t interruptableReadFully(
+            FdTrigger* fdTrigger, iovec* iovs, int niovs,
+            const std::optional<SmallFunction<status_t()>>& altPoll,
+            std::vector<std::variant<unique_fd, borrowed_fd>>* ancillaryFds) override {
+        if (altPoll || ancillaryFds != nullptr) {
+            auto recv = [&](iovec* iovs, int niovs) -> ssize_t {
+                return binder::os::receiveMessageFromSocket(mSocket, iovs, niovs, ancillaryFds);
+            };
+            return interruptableReadOrWrite(mSocket, fdTrigger, iovs, niovs, recv, "recvmsg",
+                                            POLLIN, altPoll);
+        }
+
+        mSocket.setPollingState(true);
+        auto pollingStateGuard = make_scope_guard([&]() { mSocket.setPollingState(false); });
+        return transferFully(fdTrigger, iovs, niovs, IORING_OP_RECVMSG);
+    }
+
+    bool isWaiting() override { return mSocket.isInPollingState(); }
+
+private:
+    status_t transferFully(FdTrigger* fdTrigger, iovec* iovs, int niovs, uint8_t opcode) {
+        MAYBE_WAIT_IN_FLAKE_MODE;
+
+        if (niovs < 0) {
+            return BAD_VALUE;
+        }
+        if (fdTrigger->isTriggered()) {
+            return DEAD_OBJECT;
+        }
+        // See interruptableReadOrWrite: trailing empty iovecs would make a
+        // complete transfer look like EOF.
+        while (niovs > 0 && iovs[niovs - 1].iov_len == 0) {
+            niovs--;
+        }
+
+        while (niovs > 0) {
+            ssize_t processSize;
+            if (status_t status = submitAndWait(fdTrigger, iovs, niovs, opcode, &processSize);
+                status != OK) {
+                return status;
+            }
+            if (processSize < 0) {
+                LOG_RPC_DETAIL("RpcTransport io_uring %s: %s",
+                               opcode == IORING_OP_SENDMSG ? "sendmsg" : "recvmsg",
+                               strerror(-processSize));
+                return processSize;
+            }
+            if (processSize == 0) {
+                return DEAD_OBJECT;
+            }
+
+            while (processSize > 0 && niovs > 0) {
+                auto& iov = iovs[0];
+                if (static_cast<size_t>(processSize) < iov.iov_len) {
+                    // Advance the base of the current iovec
+                    iov.iov_base = reinterpret_cast<char*>(iov.iov_base) + processSize;
+                    iov.iov_len -= processSize;
+                    break;
+                }
+
+                // The current iovec was fully transferred
+                processSize -= iov.iov_len;
+                iovs++;
+                niovs--;
+            }
+            LOG_ALWAYS_FATAL_IF(niovs == 0 && processSize > 0,
+                                "Reached the end of iovecs with %zd bytes remaining", processSize);
+        }
+        return OK;
+    }
+
+    // Submits one sendmsg/recvmsg and waits for it with a single syscall.
+    // `outResult` is the CQE result (bytes transferred or -errno).
+    status_t submitAndWait(FdTrigger* fdTrigger, iovec* iovs, int niovs, uint8_t opcode,
+                           ssize_t* outResult) {
+        if (!mTriggerArmed) {
+            io_uring_sqe* sqe = io_uring_get_sqe(&mRing);
+            LOG_ALWAYS_FATAL_IF(sqe == nullptr, "io_uring submission queue full");
+            io_uring_prep_poll_add(sqe, fdTrigger->pollFd().get(), POLLIN);
+            io_uring_sqe_set_data64(sqe, kTagTrigger);
+            mTriggerArmed = true;
+        }
+
+        msghdr msg{
+                .msg_iov = iovs,
+                // posix uses int, glibc uses size_t.  niovs is a
+                // non-negative int and can be cast to either.
+                .msg_iovlen = static_cast<decltype(msg.msg_iovlen)>(niovs),
+        };
+        io_uring_sqe* sqe = io_uring_get_sqe(&mRing);
+        LOG_ALWAYS_FATAL_IF(sqe == nullptr, "io_uring submission queue full");
+        if (opcode == IORING_OP_SENDMSG) {
+            io_uring_prep_sendmsg(sqe, mSocket.fd.get(), &msg, MSG_NOSIGNAL);
+        } else {
+            io_uring_prep_recvmsg(sqe, mSocket.fd.get(), &msg, MSG_NOSIGNAL);
+        }
+        io_uring_sqe_set_data64(sqe, kTagSocketOp);
+
+        if (int ret = io_uring_submit_and_wait(&mRing, 1); ret < 0) {
+            // Nothing we submitted can be relied upon to complete, and `msg`
+            // lives on this stack frame, so the ring can't be reused.
+            LOG_ALWAYS_FATAL("io_uring_submit_and_wait: %s", strerror(-ret));
+        }
+
+        bool triggered = false;
+        while (true) {
+            io_uring_cqe* cqe;
+            if (int ret = io_uring_wait_cqe(&mRing, &cqe); ret < 0) {
+                if (ret == -EINTR) continue;
+                LOG_ALWAYS_FATAL("io_uring_wait_cqe: %s", strerror(-ret));
+            }
+            uint64_t tag = io_uring_cqe_get_data64(cqe);
+            int res = cqe->res;
+            io_uring_cqe_seen(&mRing, cqe);
+
+            switch (tag) {
+                case kTagSocketOp:
+                    if (triggered) return DEAD_OBJECT;
+                    *outResult = res;
+                    return OK;
+                case kTagTrigger: {
+                    // FdTrigger fired: shutting down. The socket operation
+                    // still references `msg`, so cancel it and wait for it to
+                    // retire before returning.
+                    triggered = true;
+                    io_uring_sqe* cancel = io_uring_get_sqe(&mRing);
+                    LOG_ALWAYS_FATAL_IF(cancel == nullptr, "io_uring submission queue full");
+                    io_uring_prep_cancel64(cancel, kTagSocketOp, 0);
+                    io_uring_sqe_set_data64(cancel, kTagCancel);
+                    (void)io_uring_submit(&mRing);
+                    break;
+                }
+                case kTagCancel:
+                    break;
+                default:
+                    LOG_ALWAYS_FATAL("Unexpected io_uring completion tag %" PRIu64, tag);
+            }
+        }
+    }
+
+    android::RpcTransportFd mSocket;
+    io_uring mRing;
+    bool mRingInitialized = false;
+    bool mTriggerArmed = false;
+};
+
+// RpcTransportCtx with TLS disabled, for io_uring transports.
+class RpcTransportCtxIoUring : public RpcTransportCtx {
+public:
+    std::unique_ptr<RpcTransport> newTransport(android::RpcTransportFd socket,
+                                               FdTrigger*) const override {
+        auto transport = std::make_unique<RpcTransportIoUring>(std::move(socket));
+        if (transport->init() != OK) return nullptr;
+        return transport;
+    }
+    std::vector<uint8_t> getCertificate(RpcCertificateFormat) const override { return {}; }
+};
+
+std::unique_ptr<RpcTransportCtx> RpcTransportCtxFactoryIoUring::newServerCtx() const {
+    return std::make_unique<RpcTransportCtxIoUring>();
+}
+
+std::unique_ptr<RpcTransportCtx> RpcTransportCtxFactoryIoUring::newClientCtx() const {
+    return std::make_unique<RpcTransportCtxIoUring>();
+}
+
+const char* RpcTransportCtxFactoryIoUring::toCString() const {
+    return "io_uring";
+}
+
+std::unique_ptr<RpcTransportCtxFactory> RpcTransportCtxFactoryIoUring::make() {
+    io_uring probe;
+    if (int ret = io_uring_queue_init(1, &probe, 0); ret < 0) {
+        ALOGW("io_uring unavailable: %s", strerror(-ret));
+        return nullptr;
+    }
+    io_uring_queue_exit(&probe);
+    return std::unique_ptr<RpcTransportCtxFactoryIoUring>(new RpcTransportCtxFactoryIoUring());
+}
+
+} // namespace android
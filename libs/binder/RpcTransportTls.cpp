@@ -30,6 +30,7 @@
 #include "RpcState.h"
 #include "Utils.h"
 
+#include <mutex>
 #include <sstream>
 
 #define SHOULD_LOG_TLS_DETAIL false
@@ -459,9 +460,19 @@ public:
 
 protected:
     static ssl_verify_result_t sslCustomVerify(SSL* ssl, uint8_t* outAlert);
+    static int sslNewSession(SSL* ssl, SSL_SESSION* session);
+    // Called by create() with the new context, for |Impl| specific settings.
+    static void configureCtx(SSL_CTX*) {}
     virtual void preHandshake(Ssl* ssl) const = 0;
+    bool verifyResumedSession(Ssl* ssl) const;
+    // Returns the latest session to resume, from a connection made with this context.
+    bssl::UniquePtr<SSL_SESSION> getSessionToResume() const;
+
     bssl::UniquePtr<SSL_CTX> mCtx;
     std::shared_ptr<RpcCertificateVerifier> mCertVerifier;
+    // Protects mSessionToResume, which sslNewSession() sets from any connection.
+    mutable std::mutex mSessionMutex;
+    bssl::UniquePtr<SSL_SESSION> mSessionToResume;
 };
 
 std::vector<uint8_t> RpcTransportCtxTls::getCertificate(RpcCertificateFormat format) const {
@@ -490,6 +501,47 @@ ssl_verify_result_t RpcTransportCtxTls::sslCustomVerify(SSL* ssl, uint8_t* outAl
     return ssl_verify_invalid;
 }
 
+// Called by libssl with the sessions it can resume, which in TLS 1.3 arrive after the handshake.
+int RpcTransportCtxTls::sslNewSession(SSL* ssl, SSL_SESSION* session) {
+    auto ctx = SSL_get_SSL_CTX(ssl); // Does not set error queue
+    LOG_ALWAYS_FATAL_IF(ctx == nullptr);
+    // void* -> RpcTransportCtxTls*
+    auto rpcTransportCtxTls = reinterpret_cast<RpcTransportCtxTls*>(SSL_CTX_get_app_data(ctx));
+    LOG_ALWAYS_FATAL_IF(rpcTransportCtxTls == nullptr);
+
+    std::lock_guard<std::mutex> lock(rpcTransportCtxTls->mSessionMutex);
+    rpcTransportCtxTls->mSessionToResume.reset(session);
+    return 1; // Takes ownership of |session|.
+}
+
+bssl::UniquePtr<SSL_SESSION> RpcTransportCtxTls::getSessionToResume() const {
+    std::lock_guard<std::mutex> lock(mSessionMutex);
+    if (mSessionToResume == nullptr) return nullptr;
+    SSL_SESSION_up_ref(mSessionToResume.get());
+    return bssl::UniquePtr<SSL_SESSION>(mSessionToResume.get());
+}
+
+// A resumed handshake doesn't exchange certificates, and the peer certificate is the one
+// verified for the resumed session. Verify it again, in case the verifier stopped trusting it;
+// that only costs a lookup, unlike the signatures the resumption saved.
+bool RpcTransportCtxTls::verifyResumedSession(Ssl* ssl) const {
+    auto [reused, reusedErrorQueue] = ssl->call(SSL_session_reused);
+    reusedErrorQueue.clear();
+    if (!reused) return true;
+
+    uint8_t alert = 0;
+    auto [verifyStatus, verifyErrorQueue] =
+            ssl->call([this, &alert](SSL* s) { return mCertVerifier->verify(s, &alert); });
+    verifyErrorQueue.clear();
+    if (verifyStatus != OK) {
+        ALOGE("%s: Failed to verify peer of resumed session: status = %s, alert = %s",
+              __PRETTY_FUNCTION__, statusToString(verifyStatus).c_str(),
+              SSL_alert_desc_string_long(alert));
+        return false;
+    }
+    return true;
+}
+
 // Common implementation for creating server and client contexts. The child class, |Impl|, is
 // provided as a template argument so that this function can initialize an |Impl| object.
 template <typename Impl, typename>
@@ -512,6 +564,13 @@ std::unique_ptr<RpcTransportCtxTls> RpcTransportCtxTls::create(
     // Require at least TLS 1.3
     TEST_AND_RETURN(nullptr, SSL_CTX_set_min_proto_version(ctx.get(), TLS1_3_VERSION));
 
+    // Servers refuse to resume sessions with verified peers without a session ID context.
+    static constexpr uint8_t kSessionIdContext[] = "libbinder_rpc";
+    TEST_AND_RETURN(nullptr,
+                    SSL_CTX_set_session_id_context(ctx.get(), kSessionIdContext,
+                                                   sizeof(kSessionIdContext)));
+    Impl::configureCtx(ctx.get());
+
     if constexpr (SHOULD_LOG_TLS_DETAIL) { // NOLINT
         SSL_CTX_set_info_callback(ctx.get(), sslDebugLog);
     }
@@ -532,6 +591,7 @@ std::unique_ptr<RpcTransport> RpcTransportCtxTls::newTransport(android::RpcTrans
 
     preHandshake(&wrapped);
     TEST_AND_RETURN(nullptr, setFdAndDoHandshake(&wrapped, socket, fdTrigger));
+    TEST_AND_RETURN(nullptr, verifyResumedSession(&wrapped));
     return std::make_unique<RpcTransportTls>(std::move(socket), std::move(wrapped));
 }
 
@@ -542,10 +602,22 @@ protected:
     }
 };
 
+// Connections after the first of a client context, e.g. the other connections of an RpcSession,
+// resume the TLS session of an earlier one, which skips the certificate exchange and
+// verification. Servers resume sessions from the tickets they send, which libssl does by default.
 class RpcTransportCtxTlsClient : public RpcTransportCtxTls {
+public:
+    static void configureCtx(SSL_CTX* ctx) {
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT);
+        SSL_CTX_sess_set_new_cb(ctx, sslNewSession);
+    }
+
 protected:
     void preHandshake(Ssl* ssl) const override {
         ssl->call(SSL_set_connect_state).errorQueue.clear();
+        if (bssl::UniquePtr<SSL_SESSION> session = getSessionToResume()) {
+            ssl->call(SSL_set_session, session.get()).errorQueue.clear();
+        }
     }
 };
 
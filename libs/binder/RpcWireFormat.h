@@ -129,6 +129,15 @@ struct RpcDecStrong {
 };
 static_assert(sizeof(RpcDecStrong) == 16);
 
+/**
+ * Set in RpcWireTransaction::payloadOptions / RpcWireReply::payloadOptions
+ * when the parcel data is not inline but in a sealed shared memory region
+ * passed as the last ancillary FD of the command. The command body then only
+ * contains the object table. Requires
+ * RPC_WIRE_PROTOCOL_VERSION_RPC_HEADER_FEATURE_SHARED_MEMORY_PAYLOAD.
+ */
+constexpr uint32_t RPC_WIRE_PAYLOAD_OPTION_SHARED_MEMORY = 1 << 0;
+
 struct RpcWireTransaction {
     RpcWireAddress address;
     uint32_t code;
@@ -139,7 +148,10 @@ struct RpcWireTransaction {
     // The size of the Parcel data directly following RpcWireTransaction.
     uint32_t parcelDataSize;
 
-    uint32_t reserved[3];
+    // RPC_WIRE_PAYLOAD_OPTION_*
+    uint32_t payloadOptions;
+
+    uint32_t reserved[2];
 
     uint8_t data[];
 };
@@ -153,7 +165,10 @@ struct RpcWireReply {
     // The size of the Parcel data directly following RpcWireReply.
     uint32_t parcelDataSize;
 
-    uint32_t reserved[3];
+    // RPC_WIRE_PAYLOAD_OPTION_*
+    uint32_t payloadOptions;
+
+    uint32_t reserved[2];
 
     // Byte size of RpcWireReply in the wire protocol.
     static size_t wireSize(uint32_t protocolVersion) {
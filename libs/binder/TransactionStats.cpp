@@ -0,0 +1,267 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "TransactionStats"
+
+#include <binder/Parcel.h>
+#include <binder/TransactionStats.h>
+#include <utils/String8.h>
+
+#include <atomic>
+#include <cinttypes>
+#include <string_view>
+
+#include "Utils.h"
+
+namespace android::binder::debug {
+
+namespace {
+
+// Open addressing table. Slots are claimed on first use and never released,
+// so a reader holding a published descriptor pointer can use it forever.
+constexpr size_t kNumSlots = 512;
+constexpr size_t kMaxProbes = 16;
+
+struct Slot {
+    // 0 while unclaimed, otherwise the key hash (with the low bit set).
+    std::atomic<uint64_t> hash;
+    // Published last, with release ordering, once code and incoming are set.
+    std::atomic<const String16*> descriptor;
+    std::atomic<uint32_t> code;
+    std::atomic<bool> incoming;
+
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> totalLatencyNs;
+    std::atomic<uint64_t> latencyHistogram[TransactionStats::kNumBuckets];
+    std::atomic<uint64_t> sizeHistogram[TransactionStats::kNumBuckets];
+};
+
+std::atomic<bool> gEnabled = false;
+Slot gSlots[kNumSlots];
+
+size_t bucketFor(uint64_t value) {
+    if (value == 0) return 0;
+    size_t bucket = 64 - __builtin_clzll(value);
+    return std::min(bucket, TransactionStats::kNumBuckets - 1);
+}
+
+uint64_t hashKey(const String16& descriptor, uint32_t code, bool incoming) {
+    uint64_t hash = std::hash<std::u16string_view>{}(
+            std::u16string_view(descriptor.c_str(), descriptor.size()));
+    hash ^= (static_cast<uint64_t>(code) << 1 | incoming) * 0x9E3779B97F4A7C15ULL;
+    return hash | 1;
+}
+
+Slot* findOrClaimSlot(const String16& descriptor, uint32_t code, bool incoming) {
+    const uint64_t hash = hashKey(descriptor, code, incoming);
+    for (size_t i = 0; i < kMaxProbes; i++) {
+        Slot& slot = gSlots[(hash + i) % kNumSlots];
+
+        uint64_t slotHash = slot.hash.load(std::memory_order_acquire);
+        if (slotHash == 0) {
+            if (slot.hash.compare_exchange_strong(slotHash, hash, std::memory_order_acq_rel)) {
+                slot.code.store(code, std::memory_order_relaxed);
+                slot.incoming.store(incoming, std::memory_order_relaxed);
+                slot.descriptor.store(new String16(descriptor), std::memory_order_release);
+                return &slot;
+            }
+            // lost the race, slotHash now holds the winner's hash
+        }
+        if (slotHash != hash) continue;
+
+        const String16* slotDescriptor = slot.descriptor.load(std::memory_order_acquire);
+        if (slotDescriptor == nullptr) return nullptr; // being claimed
+        if (slot.code.load(std::memory_order_relaxed) == code &&
+            slot.incoming.load(std::memory_order_relaxed) == incoming &&
+            *slotDescriptor == descriptor) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+uint64_t TransactionStats::Entry::latencyPercentileUs(double percentile) const {
+    if (count == 0) return 0;
+    uint64_t target = static_cast<uint64_t>(static_cast<double>(count) * percentile / 100.0);
+    if (target == 0) target = 1;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kNumBuckets; i++) {
+        seen += latencyHistogram[i];
+        if (seen >= target) return i == 0 ? 0 : (1ULL << i);
+    }
+    return 1ULL << (kNumBuckets - 1);
+}
+
+void TransactionStats::setEnabled(bool enabled) {
+    gEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool TransactionStats::isEnabled() {
+    return gEnabled.load(std::memory_order_relaxed);
+}
+
+void TransactionStats::record(const String16& descriptor, uint32_t code, bool incoming,
+                              uint64_t latencyNs, size_t parcelBytes) {
+    // Samples are dropped when the table is full, or while another thread
+    // is still claiming the slot for this key.
+    Slot* slot = findOrClaimSlot(descriptor, code, incoming);
+    if (slot == nullptr) return;
+
+    slot->count.fetch_add(1, std::memory_order_relaxed);
+    slot->totalLatencyNs.fetch_add(latencyNs, std::memory_order_relaxed);
+    slot->latencyHistogram[bucketFor(latencyNs / 1000)].fetch_add(1, std::memory_order_relaxed);
+    slot->sizeHistogram[bucketFor(parcelBytes)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void TransactionStats::reset() {
+    for (Slot& slot : gSlots) {
+        slot.count.store(0, std::memory_order_relaxed);
+        slot.totalLatencyNs.store(0, std::memory_order_relaxed);
+        for (auto& bucket : slot.latencyHistogram) bucket.store(0, std::memory_order_relaxed);
+        for (auto& bucket : slot.sizeHistogram) bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::vector<TransactionStats::Entry> TransactionStats::snapshot() {
+    std::vector<Entry> entries;
+    for (const Slot& slot : gSlots) {
+        const String16* descriptor = slot.descriptor.load(std::memory_order_acquire);
+        if (descriptor == nullptr) continue;
+
+        Entry entry;
+        entry.count = slot.count.load(std::memory_order_relaxed);
+        if (entry.count == 0) continue;
+
+        entry.interfaceName = String8(*descriptor).c_str();
+        entry.code = slot.code.load(std::memory_order_relaxed);
+        entry.incoming = slot.incoming.load(std::memory_order_relaxed);
+        entry.totalLatencyNs = slot.totalLatencyNs.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < kNumBuckets; i++) {
+            entry.latencyHistogram[i] = slot.latencyHistogram[i].load(std::memory_order_relaxed);
+            entry.sizeHistogram[i] = slot.sizeHistogram[i].load(std::memory_order_relaxed);
+        }
+        entries.push_back(std::move(entry));
+    }
+    return entries;
+}
+
+std::string TransactionStats::toString(const std::vector<Entry>& entries) {
+    std::string out;
+    for (const Entry& entry : entries) {
+        char line[256];
+        snprintf(line, sizeof(line),
+                 " code=%" PRIu32 " count=%" PRIu64 " mean=%" PRIu64 "us p50<%" PRIu64
+                 "us p90<%" PRIu64 "us p99<%" PRIu64 "us\n",
+                 entry.code, entry.count,
+                 entry.count == 0 ? 0 : entry.totalLatencyNs / entry.count / 1000,
+                 entry.latencyPercentileUs(50), entry.latencyPercentileUs(90),
+                 entry.latencyPercentileUs(99));
+        out += entry.incoming ? "in  " : "out ";
+        out += entry.interfaceName.empty() ? "(unknown)" : entry.interfaceName;
+        out += line;
+    }
+    return out;
+}
+
+status_t TransactionStats::writeToParcel(const std::vector<Entry>& entries, Parcel* parcel) {
+    if (status_t status = parcel->writeUint32(static_cast<uint32_t>(entries.size()));
+        status != OK) {
+        return status;
+    }
+    if (status_t status = parcel->writeUint32(kNumBuckets); status != OK) return status;
+
+    for (const Entry& entry : entries) {
+        if (status_t status = parcel->writeUtf8AsUtf16(entry.interfaceName); status != OK) {
+            return status;
+        }
+        if (status_t status = parcel->writeUint32(entry.code); status != OK) return status;
+        if (status_t status = parcel->writeBool(entry.incoming); status != OK) return status;
+        if (status_t status = parcel->writeUint64(entry.count); status != OK) return status;
+        if (status_t status = parcel->writeUint64(entry.totalLatencyNs); status != OK) {
+            return status;
+        }
+        for (size_t i = 0; i < kNumBuckets; i++) {
+            if (status_t status = parcel->writeUint64(entry.latencyHistogram[i]); status != OK) {
+                return status;
+            }
+            if (status_t status = parcel->writeUint64(entry.sizeHistogram[i]); status != OK) {
+                return status;
+            }
+        }
+    }
+    return OK;
+}
+
+status_t TransactionStats::readFromParcel(const Parcel& parcel, std::vector<Entry>* entries) {
+    uint32_t numEntries;
+    if (status_t status = parcel.readUint32(&numEntries); status != OK) return status;
+    if (numEntries > kNumSlots) return BAD_VALUE;
+
+    uint32_t numBuckets;
+    if (status_t status = parcel.readUint32(&numBuckets); status != OK) return status;
+    if (numBuckets != kNumBuckets) {
+        ALOGE("Transaction stats have %" PRIu32 " buckets, expected %zu", numBuckets,
+              kNumBuckets);
+        return BAD_VALUE;
+    }
+
+    entries->clear();
+    entries->reserve(numEntries);
+    for (uint32_t n = 0; n < numEntries; n++) {
+        Entry entry;
+        if (status_t status = parcel.readUtf8FromUtf16(&entry.interfaceName); status != OK) {
+            return status;
+        }
+        if (status_t status = parcel.readUint32(&entry.code); status != OK) return status;
+        if (status_t status = parcel.readBool(&entry.incoming); status != OK) return status;
+        if (status_t status = parcel.readUint64(&entry.count); status != OK) return status;
+        if (status_t status = parcel.readUint64(&entry.totalLatencyNs); status != OK) {
+            return status;
+        }
+        for (size_t i = 0; i < kNumBuckets; i++) {
+            if (status_t status = parcel.readUint64(&entry.latencyHistogram[i]); status != OK) {
+                return status;
+            }
+            if (status_t status = parcel.readUint64(&entry.sizeHistogram[i]); status != OK) {
+                return status;
+            }
+        }
+        entries->push_back(std::move(entry));
+    }
+    return OK;
+}
+
+status_t ThreadPoolStats::writeToParcel(Parcel* parcel) const {
+    for (uint64_t value : {currentThreads, maxThreads, executingThreads, peakExecutingThreads,
+                           starvationCount, totalStarvationNs, longestStarvationNs}) {
+        if (status_t status = parcel->writeUint64(value); status != OK) return status;
+    }
+    return OK;
+}
+
+status_t ThreadPoolStats::readFromParcel(const Parcel& parcel) {
+    for (uint64_t* value : {&currentThreads, &maxThreads, &executingThreads,
+                            &peakExecutingThreads, &starvationCount, &totalStarvationNs,
+                            &longestStarvationNs}) {
+        if (status_t status = parcel.readUint64(value); status != OK) return status;
+    }
+    return OK;
+}
+
+} // namespace android::binder::debug
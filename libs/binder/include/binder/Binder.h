@@ -123,6 +123,7 @@ private:
     void removeRpcServerLink(const sp<RpcServerLink>& link);
     [[nodiscard]] status_t startRecordingTransactions(const Parcel& data);
     [[nodiscard]] status_t stopRecordingTransactions();
+    [[nodiscard]] static status_t transactionStatsCommand(const Parcel& data, Parcel* reply);
 
     std::atomic<Extras*> mExtras;
 
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <binder/Common.h>
+#include <binder/TransactionStats.h>
 #include <binder/unique_fd.h>
 #include <utils/Errors.h>
 #include <utils/RefBase.h>
@@ -65,6 +66,7 @@ public:
         EXTENSION_TRANSACTION = B_PACK_CHARS('_', 'E', 'X', 'T'),
         DEBUG_PID_TRANSACTION = B_PACK_CHARS('_', 'P', 'I', 'D'),
         SET_RPC_CLIENT_TRANSACTION = B_PACK_CHARS('_', 'R', 'P', 'C'),
+        TRANSACTION_STATS_TRANSACTION = B_PACK_CHARS('_', 'S', 'T', 'S'),
 
         // See android.os.IBinder.TWEET_TRANSACTION
         // Most importantly, messages can be anything not exceeding 130 UTF-8
@@ -161,6 +163,26 @@ public:
      */
     status_t                getDebugPid(pid_t* outPid);
 
+    /**
+     * Read the per-interface transaction stats of the process hosting this
+     * binder, for debugging. See binder::debug::TransactionStats.
+     */
+    status_t                getTransactionStats(
+            std::vector<binder::debug::TransactionStats::Entry>* outEntries);
+
+    /**
+     * Turn transaction stats collection on or off in the process hosting
+     * this binder. Turning it on clears previously collected stats. Remote
+     * callers must be root.
+     */
+    status_t                setTransactionStatsEnabled(bool enabled);
+
+    /**
+     * Read the kernel binder thread pool usage of the process hosting this
+     * binder, for debugging. See ProcessState::getThreadPoolStats().
+     */
+    status_t                getThreadPoolStats(binder::debug::ThreadPoolStats* outStats);
+
     /**
      * Set the RPC client fd to this binder service, for debugging. This is only available on
      * debuggable builds.
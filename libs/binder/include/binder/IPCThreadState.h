@@ -22,6 +22,9 @@
 #include <utils/Errors.h>
 #include <utils/Vector.h>
 
+#include <memory>
+#include <vector>
+
 #if defined(_WIN32)
 typedef  int  uid_t;
 #endif
@@ -166,6 +169,23 @@ public:
     LIBBINDER_EXPORTED status_t transact(int32_t handle, uint32_t code, const Parcel& data,
                                          Parcel* reply, uint32_t flags);
 
+    // Oneway batching.
+    //
+    // After beginOnewayBatch(), oneway transactions sent from this thread over
+    // the kernel driver (for instance through BpBinder::transact or an AIDL
+    // oneway method) are copied and queued instead of being submitted one
+    // BINDER_WRITE_READ ioctl at a time. flushOnewayBatch() hands all queued
+    // transactions, which may target different binders, to the driver in a
+    // single ioctl and ends the batch. It returns the first error reported
+    // for any queued transaction.
+    //
+    // Any other call which talks to the driver from this thread (e.g. a
+    // two-way transaction) implicitly submits the queued transactions first.
+    // A batch opened while serving an incoming transaction is flushed before
+    // the thread returns to the threadpool.
+    LIBBINDER_EXPORTED void beginOnewayBatch();
+    LIBBINDER_EXPORTED status_t flushOnewayBatch();
+
     LIBBINDER_EXPORTED void incStrongHandle(int32_t handle, BpBinder* proxy);
     LIBBINDER_EXPORTED void decStrongHandle(int32_t handle);
     LIBBINDER_EXPORTED void incWeakHandle(int32_t handle, BpBinder* proxy);
@@ -219,6 +239,7 @@ private:
                                                 uint32_t code, const Parcel& data,
                                                 status_t* statusBuffer);
     [[nodiscard]] status_t getAndExecuteCommand();
+    bool consumePendingOnewayCompletion(status_t err);
     [[nodiscard]] status_t executeCommand(int32_t command);
     void processPendingDerefs();
     void processPostWriteDerefs();
@@ -254,6 +275,13 @@ private:
             int32_t             mStrictModePolicy;
             int32_t             mLastTransactionBinderFlags;
             CallRestriction     mCallRestriction;
+            // Oneway batching state, see beginOnewayBatch().
+            bool mOnewayBatching;
+            std::vector<std::unique_ptr<Parcel>> mOnewayBatch;
+            // Number of BR_TRANSACTION_COMPLETE (or error) returns still owed
+            // by the driver for batched transactions already written to it.
+            size_t mPendingOnewayCompletions;
+            status_t mOnewayBatchError;
 };
 
 } // namespace android
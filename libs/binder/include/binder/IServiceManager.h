@@ -23,7 +23,9 @@
 #endif // __TRUSTY__
 #include <utils/String16.h>
 #include <utils/Vector.h>
+#include <functional>
 #include <optional>
+#include <vector>
 
 namespace android {
 
@@ -149,6 +151,25 @@ public:
         int pid;
     };
     virtual std::vector<ServiceDebugInfo> getServiceDebugInfo() = 0;
+
+    /**
+     * Efficiently wait for several services, e.g. all the dependencies of a
+     * daemon during boot. Instead of one waitForService after another, every
+     * service which isn't available yet is waited on at the same time, with a
+     * single notification callback.
+     *
+     * onAvailable is called on the calling thread once for each name, as soon
+     * as that service is available. Services which become available together
+     * are reported in the order of names, so callers should list their most
+     * important dependencies first.
+     *
+     * Returns OK once every service has been reported. Returns an error only for
+     * permission problems or fatal errors, and then some names may be unreported.
+     */
+    virtual status_t waitForServices(
+            const std::vector<String16>& names,
+            const std::function<void(const String16& name, const sp<IBinder>& binder)>&
+                    onAvailable);
 };
 
 LIBBINDER_EXPORTED sp<IServiceManager> defaultServiceManager();
@@ -32,12 +32,41 @@ class SimpleBestFitAllocator;
 
 class MemoryDealer : public RefBase {
 public:
+    enum class AllocationPolicy {
+        // Allocate from the smallest free block that fits. Allocating and
+        // deallocating walk all blocks.
+        BEST_FIT,
+        // Keep free blocks in lists by power of two size class, so that
+        // allocating and deallocating take constant time. Allocations are
+        // taken from a class whose blocks all fit, if there is one, which
+        // can split larger blocks than best fit would.
+        SIZE_CLASSES,
+    };
+
+    struct Stats {
+        size_t heapSize = 0;
+        size_t allocations = 0;
+        size_t allocatedBytes = 0;
+        size_t freeBlocks = 0;
+        size_t freeBytes = 0;
+        size_t largestFreeBlock = 0;
+
+        // 0 if all free memory is in one block, approaching 1 as it is split
+        // into more, smaller blocks.
+        double fragmentation() const {
+            return freeBytes == 0 ? 0.0 : 1.0 - double(largestFreeBlock) / double(freeBytes);
+        }
+    };
+
     LIBBINDER_EXPORTED explicit MemoryDealer(
             size_t size, const char* name = nullptr,
             uint32_t flags = 0 /* or bits such as MemoryHeapBase::READ_ONLY */);
+    LIBBINDER_EXPORTED MemoryDealer(size_t size, const char* name, uint32_t flags,
+                                    AllocationPolicy policy);
 
     LIBBINDER_EXPORTED virtual sp<IMemory> allocate(size_t size);
     LIBBINDER_EXPORTED virtual void dump(const char* what) const;
+    LIBBINDER_EXPORTED Stats getStats() const;
 
     // allocations are aligned to some value. return that value so clients can account for it.
     LIBBINDER_EXPORTED static size_t getAllocationAlignment();
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <limits>
 #include <map> // for legacy reasons
@@ -59,7 +60,30 @@ class Status;
 namespace debug {
 class RecordedTransaction;
 }
-}
+
+// A fixed-layout parcelable is a trivially copyable type whose memory image is
+// its wire image: every field is an int32_t, uint32_t, int64_t, uint64_t, float,
+// double or an enum of 4 or 8 bytes, declared in wire order. It declares this with
+//
+//     static constexpr size_t kFixedLayoutSize = <sum of the field sizes>;
+//
+// which only takes effect if it equals sizeof(T), i.e. the compiler added no
+// padding. Parcel then reads and writes it, and vectors and arrays of it, with
+// bulk copies instead of field by field. On the wire it is identical to an AIDL
+// structured parcelable with the same fields.
+template <typename T, typename = void>
+struct is_fixed_layout_parcelable : std::false_type {};
+
+template <typename T>
+struct is_fixed_layout_parcelable<T, std::void_t<decltype(T::kFixedLayoutSize)>>
+      : std::bool_constant<std::is_trivially_copyable_v<T> &&
+                           std::is_default_constructible_v<T> &&
+                           T::kFixedLayoutSize == sizeof(T) && sizeof(T) % sizeof(int32_t) == 0> {
+};
+
+template <typename T>
+inline constexpr bool is_fixed_layout_parcelable_v = is_fixed_layout_parcelable<T>::value;
+} // namespace binder
 
 class Parcel {
     friend class IPCThreadState;
@@ -333,6 +357,11 @@ public:
     }
 
     LIBBINDER_EXPORTED status_t writeParcelable(const Parcelable& parcelable);
+    template <typename T,
+              std::enable_if_t<binder::is_fixed_layout_parcelable_v<T>, bool> = true>
+    status_t writeParcelable(const T& parcelable) {
+        return writeData(parcelable);
+    }
 
     template<typename T>
     status_t            write(const Flattenable<T>& val);
@@ -487,6 +516,11 @@ public:
             { return readData(val); }
 
     LIBBINDER_EXPORTED status_t readParcelable(Parcelable* parcelable) const;
+    template <typename T,
+              std::enable_if_t<binder::is_fixed_layout_parcelable_v<T>, bool> = true>
+    status_t readParcelable(T* parcelable) const {
+        return readData(parcelable);
+    }
 
     template<typename T>
     status_t            readParcelable(std::optional<T>* parcelable) const
@@ -1022,6 +1056,33 @@ private:
         return writeStrongBinder(t);
     }
 
+    template <typename T,
+              typename std::enable_if_t<binder::is_fixed_layout_parcelable_v<T>, bool> = true>
+    status_t writeData(const T& t) {
+        return writeFixedLayoutParcelables(&t, 1);
+    }
+
+    // Each element is written like a non-null structured parcelable: the
+    // non-null flag, the parcelable size (including the size itself), then
+    // the fields. All elements are written with one reservation.
+    template <typename T>
+    status_t writeFixedLayoutParcelables(const T* data, size_t count) {
+        static_assert(binder::is_fixed_layout_parcelable_v<T>);
+        constexpr int32_t kParcelableSize = static_cast<int32_t>(sizeof(int32_t) + sizeof(T));
+        constexpr size_t kElementSize = sizeof(int32_t) + kParcelableSize;
+        size_t len;
+        if (__builtin_mul_overflow(count, kElementSize, &len)) return BAD_VALUE;
+        auto out = reinterpret_cast<uint8_t*>(writeInplace(len));
+        if (out == nullptr) return BAD_VALUE;
+        const int32_t header[] = {kNonNullParcelableFlag, kParcelableSize};
+        for (size_t i = 0; i < count; i++) {
+            memcpy(out, header, sizeof(header));
+            memcpy(out + sizeof(header), &data[i], sizeof(T));
+            out += kElementSize;
+        }
+        return OK;
+    }
+
     // std::optional, std::unique_ptr, std::shared_ptr special case.
     template <typename CT,
             typename std::enable_if_t<is_parcel_nullable_type_v<CT>, bool> = true>
@@ -1031,7 +1092,8 @@ private:
                 || std::is_same_v<T, String16>
                 || std::is_same_v<T, std::string>) {
             if (!c) return writeData(static_cast<int32_t>(kNullVectorSize));
-        } else if constexpr (std::is_base_of_v<Parcelable, T>) {
+        } else if constexpr (std::is_base_of_v<Parcelable, T> ||
+                             binder::is_fixed_layout_parcelable_v<T>) {
             if (!c) return writeData(static_cast<int32_t>(kNullParcelableFlag));
         } else if constexpr (is_fixed_array_v<T>) {
             if (!c) return writeData(static_cast<int32_t>(kNullVectorSize));
@@ -1057,6 +1119,8 @@ private:
             // TODO: Padding of the write is suboptimal when the length of the
             // data is not a multiple of 4.  Consider improving the write() method.
             return write(c.data(), c.size() * sizeof(T));
+        } else if constexpr (binder::is_fixed_layout_parcelable_v<T>) {
+            return writeFixedLayoutParcelables(c.data(), c.size());
         } else if constexpr (std::is_same_v<T, bool>
                 || std::is_same_v<T, char16_t>) {
             // reserve data space to write to
@@ -1082,6 +1146,8 @@ private:
         if constexpr (is_pointer_equivalent_array_v<T>) {
             static_assert(N <= std::numeric_limits<size_t>::max() / sizeof(T));
             return write(val.data(), val.size() * sizeof(T));
+        } else if constexpr (binder::is_fixed_layout_parcelable_v<T>) {
+            return writeFixedLayoutParcelables(val.data(), N);
         } else /* constexpr */ {
             for (const auto& t : val) {
                 status = writeData(t);
@@ -1172,6 +1238,64 @@ private:
         return readStrongBinder(t);  // Note: on null, returns failure
     }
 
+    template <typename T,
+              typename std::enable_if_t<binder::is_fixed_layout_parcelable_v<T>, bool> = true>
+    status_t readData(T* t) const {
+        return readFixedLayoutParcelables(t, 1);
+    }
+
+    // Reads what writeFixedLayoutParcelables() writes with one bounds check.
+    // Elements whose size doesn't match, e.g. from a sender with another
+    // version of the parcelable, are read like AIDL does: missing fields keep
+    // their default value and unknown trailing fields are skipped.
+    template <typename T>
+    status_t readFixedLayoutParcelables(T* data, size_t count) const {
+        static_assert(binder::is_fixed_layout_parcelable_v<T>);
+        constexpr int32_t kParcelableSize = static_cast<int32_t>(sizeof(int32_t) + sizeof(T));
+        constexpr size_t kElementSize = sizeof(int32_t) + kParcelableSize;
+
+        size_t i = 0;
+        const size_t startPos = dataPosition();
+        size_t len;
+        if (!__builtin_mul_overflow(count, kElementSize, &len) && len <= dataAvail()) {
+            auto in = reinterpret_cast<const uint8_t*>(readInplace(len));
+            if (in == nullptr) return BAD_VALUE;
+            for (; i < count; i++, in += kElementSize) {
+                int32_t header[2];
+                memcpy(header, in, sizeof(header));
+                if (header[0] != kNonNullParcelableFlag || header[1] != kParcelableSize) break;
+                memcpy(&data[i], in + sizeof(header), sizeof(T));
+            }
+            if (i == count) return OK;
+            setDataPosition(startPos + i * kElementSize);
+        }
+
+        for (; i < count; i++) {
+            int32_t present;
+            if (status_t status = readInt32(&present); status != OK) return status;
+            if (present != kNonNullParcelableFlag) return UNEXPECTED_NULL;
+
+            const size_t parcelableStart = dataPosition();
+            int32_t parcelableSize;
+            if (status_t status = readInt32(&parcelableSize); status != OK) return status;
+            if (parcelableSize < static_cast<int32_t>(sizeof(int32_t))) return BAD_VALUE;
+            if (static_cast<size_t>(parcelableSize) >
+                std::numeric_limits<int32_t>::max() - parcelableStart) {
+                return BAD_VALUE;
+            }
+            const size_t fieldsSize =
+                    std::min(static_cast<size_t>(parcelableSize) - sizeof(int32_t), sizeof(T));
+            data[i] = T();
+            if (fieldsSize > 0) {
+                const void* fields = readInplace(fieldsSize);
+                if (fields == nullptr) return BAD_VALUE;
+                memcpy(&data[i], fields, fieldsSize);
+            }
+            setDataPosition(parcelableStart + parcelableSize);
+        }
+        return OK;
+    }
+
 
     template <typename CT,
             typename std::enable_if_t<is_parcel_nullable_type_v<CT>, bool> = true>
@@ -1187,7 +1311,8 @@ private:
                 c->reset();
                 return OK;
             }
-        } else if constexpr (std::is_base_of_v<Parcelable, T>) {
+        } else if constexpr (std::is_base_of_v<Parcelable, T> ||
+                             binder::is_fixed_layout_parcelable_v<T>) {
             if (peek == kNullParcelableFlag) {
                 c->reset();
                 return OK;
@@ -1250,6 +1375,9 @@ private:
             // this.
             c->resize(size);
             memcpy(c->data(), data, dataLen);
+        } else if constexpr (binder::is_fixed_layout_parcelable_v<T>) {
+            c->resize(size);
+            return readFixedLayoutParcelables(c->data(), c->size());
         } else if constexpr (std::is_same_v<T, bool>
                 || std::is_same_v<T, char16_t>) {
             c->reserve(size); // avoids default initialization
@@ -1294,6 +1422,8 @@ private:
             auto data = reinterpret_cast<const T*>(readInplace(N * sizeof(T)));
             if (data == nullptr) return BAD_VALUE;
             memcpy(val->data(), data, N * sizeof(T));
+        } else if constexpr (binder::is_fixed_layout_parcelable_v<T>) {
+            return readFixedLayoutParcelables(val->data(), N);
         } else if constexpr (is_specialization_v<T, sp>) {
             for (auto& t : *val) {
                 if (readFlags & READ_FLAG_SP_NULLABLE) {
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <set>
 #include <vector>
 
@@ -42,6 +43,16 @@ public:
     status_t writeToParcel(Parcel* parcel) const override;
     status_t readFromParcel(const Parcel* parcel) override;
 
+    /*
+     * Reads the bundle like readFromParcel, but only copies its serialized data, which is
+     * parsed on first access, as BaseBundle does in Java. This is cheaper for receivers that
+     * read only a few keys of a large bundle, or pass it on unread: writeToParcel writes the
+     * copied data back as-is. Errors in the data are only found when it is parsed; they are
+     * logged and leave the bundle empty. Until it is parsed, const methods modify the bundle,
+     * so it must not be accessed from several threads at once.
+     */
+    status_t readFromParcelLazily(const Parcel* parcel);
+
     bool empty() const;
     size_t size() const;
     size_t erase(const String16& key);
@@ -94,6 +105,8 @@ public:
     std::set<String16> getPersistableBundleKeys() const;
 
     friend bool operator==(const PersistableBundle& lhs, const PersistableBundle& rhs) {
+        lhs.unparcel();
+        rhs.unparcel();
         return (lhs.mBoolMap == rhs.mBoolMap && lhs.mIntMap == rhs.mIntMap &&
                 lhs.mLongMap == rhs.mLongMap && lhs.mDoubleMap == rhs.mDoubleMap &&
                 lhs.mStringMap == rhs.mStringMap && lhs.mBoolVectorMap == rhs.mBoolVectorMap &&
@@ -111,18 +124,25 @@ public:
 private:
     status_t writeToParcelInner(Parcel* parcel) const;
     status_t readFromParcelInner(const Parcel* parcel, size_t length);
-
-    std::map<String16, bool> mBoolMap;
-    std::map<String16, int32_t> mIntMap;
-    std::map<String16, int64_t> mLongMap;
-    std::map<String16, double> mDoubleMap;
-    std::map<String16, String16> mStringMap;
-    std::map<String16, std::vector<bool>> mBoolVectorMap;
-    std::map<String16, std::vector<int32_t>> mIntVectorMap;
-    std::map<String16, std::vector<int64_t>> mLongVectorMap;
-    std::map<String16, std::vector<double>> mDoubleVectorMap;
-    std::map<String16, std::vector<String16>> mStringVectorMap;
-    std::map<String16, PersistableBundle> mPersistableBundleMap;
+    // Parses the data kept by readFromParcelLazily, if any, into the maps.
+    void unparcel() const;
+
+    // The maps are mutable so that const methods can fill them from mUnparsedData.
+    mutable std::map<String16, bool> mBoolMap;
+    mutable std::map<String16, int32_t> mIntMap;
+    mutable std::map<String16, int64_t> mLongMap;
+    mutable std::map<String16, double> mDoubleMap;
+    mutable std::map<String16, String16> mStringMap;
+    mutable std::map<String16, std::vector<bool>> mBoolVectorMap;
+    mutable std::map<String16, std::vector<int32_t>> mIntVectorMap;
+    mutable std::map<String16, std::vector<int64_t>> mLongVectorMap;
+    mutable std::map<String16, std::vector<double>> mDoubleVectorMap;
+    mutable std::map<String16, std::vector<String16>> mStringVectorMap;
+    mutable std::map<String16, PersistableBundle> mPersistableBundleMap;
+
+    // Serialized data kept by readFromParcelLazily until first access, shared by copies of the
+    // bundle. Holds the magic number and entries, without the length header.
+    mutable std::shared_ptr<const std::vector<uint8_t>> mUnparsedData;
 };
 
 }  // namespace os
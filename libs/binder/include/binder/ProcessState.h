@@ -27,6 +27,7 @@
 #include <chrono>
 #include <condition_variable>
 #include <mutex>
+#include <shared_mutex>
 
 // ---------------------------------------------------------------------------
 namespace android {
@@ -125,6 +126,21 @@ public:
      */
     LIBBINDER_EXPORTED size_t getThreadPoolMaxTotalThreadCount() const;
 
+    /**
+     * Lets the thread pool grow past setThreadPoolMaxThreadCount, up to
+     * 'maxThreads' kernel started threads: each time all of them have been
+     * busy for at least 'growAfter', the kernel may start one more. Brief
+     * bursts then don't start threads which would stay idle afterwards; the
+     * kernel never lets threads leave the pool, so they can't be retired.
+     */
+    LIBBINDER_EXPORTED status_t setThreadPoolAdaptiveMaxThreadCount(
+            size_t maxThreads, std::chrono::milliseconds growAfter);
+
+    /**
+     * Get thread pool usage, for debugging.
+     */
+    LIBBINDER_EXPORTED binder::debug::ThreadPoolStats getThreadPoolStats() const;
+
     /**
      * Check to see if the thread pool has started.
      */
@@ -154,6 +170,8 @@ private:
     ProcessState(const ProcessState& o);
     ProcessState& operator=(const ProcessState& o);
     String8 makeBinderThreadName();
+    // Called by IPCThreadState when the thread pool stops being starved.
+    void onThreadPoolStarvationEnded(std::chrono::nanoseconds starvationTime);
 
     struct handle_entry {
         IBinder* binder;
@@ -161,6 +179,7 @@ private:
     };
 
     handle_entry* lookupHandleLocked(int32_t handle);
+    sp<IBinder> getExistingProxyLocked(int32_t handle);
 
     String8 mDriverName;
     int mDriverFD;
@@ -184,10 +203,23 @@ private:
 
     static constexpr auto never = &std::chrono::steady_clock::time_point::min;
 
-    mutable std::mutex mLock; // protects everything below.
-
+    // See getThreadPoolStats().
+    std::atomic_size_t mPeakExecutingThreads = 0;
+    std::atomic_uint64_t mStarvationCount = 0;
+    std::atomic_uint64_t mTotalStarvationNs = 0;
+    std::atomic_uint64_t mLongestStarvationNs = 0;
+    // See setThreadPoolAdaptiveMaxThreadCount(). 0 if the pool doesn't grow.
+    std::atomic_size_t mAdaptiveMaxThreads = 0;
+    std::atomic<int64_t> mAdaptiveGrowAfterNs = 0;
+
+    // Protects mHandleToObject. Lookups which find a live proxy only take it
+    // shared, so threads receiving binders don't serialize on each other.
+    // Creating and expunging proxies takes it exclusively.
+    mutable std::shared_mutex mHandleLock;
     Vector<handle_entry> mHandleToObject;
 
+    mutable std::mutex mLock; // protects everything below.
+
     bool mForked;
     std::atomic_bool mThreadPoolStarted;
     std::atomic_int32_t mThreadPoolSeq;
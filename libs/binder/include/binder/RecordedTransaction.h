@@ -42,6 +42,9 @@ public:
     LIBBINDER_EXPORTED RecordedTransaction(RecordedTransaction&& t) noexcept;
 
     [[nodiscard]] LIBBINDER_EXPORTED status_t dumpToFile(const binder::unique_fd& fd) const;
+    // Appends the transaction to buffer, in the format written by dumpToFile, so that it can be
+    // written to the file later, and with a single write.
+    [[nodiscard]] LIBBINDER_EXPORTED status_t dumpToBuffer(std::vector<uint8_t>* buffer) const;
 
     LIBBINDER_EXPORTED const std::string& getInterfaceName() const;
     LIBBINDER_EXPORTED uint32_t getCode() const;
@@ -56,8 +59,8 @@ public:
 private:
     RecordedTransaction() = default;
 
-    android::status_t writeChunk(const binder::borrowed_fd, uint32_t chunkType, size_t byteCount,
-                                 const uint8_t* data) const;
+    android::status_t writeChunk(std::vector<uint8_t>* buffer, uint32_t chunkType,
+                                 size_t byteCount, const uint8_t* data) const;
 
 #pragma clang diagnostic push
 #pragma clang diagnostic error "-Wpadded"
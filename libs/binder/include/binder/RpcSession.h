@@ -47,6 +47,14 @@ constexpr uint32_t RPC_WIRE_PROTOCOL_VERSION = 1;
 // * RpcWireTransaction and RpcWireReplyV1 include the parcel data size.
 constexpr uint32_t RPC_WIRE_PROTOCOL_VERSION_RPC_HEADER_FEATURE_EXPLICIT_PARCEL_SIZE = 1;
 
+// Starting with this version:
+//
+// * RpcWireTransaction and RpcWireReply may set RPC_WIRE_PAYLOAD_OPTION_SHARED_MEMORY,
+//   in which case the parcel data is carried in a sealed shared memory FD
+//   (the last ancillary FD) instead of inline. This is only used with
+//   FileDescriptorTransportMode::UNIX.
+constexpr uint32_t RPC_WIRE_PROTOCOL_VERSION_RPC_HEADER_FEATURE_SHARED_MEMORY_PAYLOAD = 2;
+
 /**
  * This represents a session (group of connections) between a client
  * and a server. Multiple connections are needed for multiple parallel "binder"
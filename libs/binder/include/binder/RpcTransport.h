@@ -42,10 +42,12 @@ struct RpcTransportFd;
 
 // for 'friend'
 class RpcTransportRaw;
+class RpcTransportIoUring;
 class RpcTransportTls;
 class RpcTransportTipcAndroid;
 class RpcTransportTipcTrusty;
 class RpcTransportCtxRaw;
+class RpcTransportCtxIoUring;
 class RpcTransportCtxTls;
 class RpcTransportCtxTipcAndroid;
 class RpcTransportCtxTipcTrusty;
@@ -115,6 +117,7 @@ private:
     // to add more transports.
 
     friend class ::android::RpcTransportRaw;
+    friend class ::android::RpcTransportIoUring;
     friend class ::android::RpcTransportTls;
     friend class ::android::RpcTransportTipcAndroid;
     friend class ::android::RpcTransportTipcTrusty;
@@ -146,6 +149,7 @@ public:
 private:
     // see comment on RpcTransport
     friend class ::android::RpcTransportCtxRaw;
+    friend class ::android::RpcTransportCtxIoUring;
     friend class ::android::RpcTransportCtxTls;
     friend class ::android::RpcTransportCtxTipcAndroid;
     friend class ::android::RpcTransportCtxTipcTrusty;
@@ -202,6 +206,7 @@ public:
 
     bool isInPollingState() const { return isPolling; }
     friend class FdTrigger;
+    friend class RpcTransportIoUring;
 };
 
 } // namespace android
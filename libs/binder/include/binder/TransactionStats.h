@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <binder/Common.h>
+#include <utils/Errors.h>
+#include <utils/String16.h>
+
+#include <array>
+#include <string>
+#include <vector>
+
+namespace android {
+
+class Parcel;
+
+namespace binder::debug {
+
+// Process-wide latency and parcel size histograms for user transactions,
+// keyed by (interface descriptor, transaction code, direction).
+//
+// Collection is off by default. When it is off, the only cost on the
+// transaction path is a relaxed atomic load. When it is on, recording is
+// lock-free: entries live in a fixed-size table which is never freed, and
+// counters are relaxed atomics.
+//
+// The stats of another process can be read with
+// IBinder::getTransactionStats() on any binder object it hosts.
+class TransactionStats {
+public:
+    // Bucket i counts samples in [2^(i-1), 2^i), with bucket 0 counting
+    // zero and the last bucket counting everything above.
+    static constexpr size_t kNumBuckets = 24;
+
+    struct Entry {
+        std::string interfaceName;
+        uint32_t code = 0;
+        // true for transactions handled by a local BBinder, false for
+        // transactions sent through a BpBinder.
+        bool incoming = false;
+        uint64_t count = 0;
+        uint64_t totalLatencyNs = 0;
+        // latency in microseconds
+        std::array<uint64_t, kNumBuckets> latencyHistogram{};
+        // data size plus reply size in bytes
+        std::array<uint64_t, kNumBuckets> sizeHistogram{};
+
+        // Upper bound of the bucket containing the given percentile
+        // (0 < percentile <= 100), in microseconds.
+        LIBBINDER_EXPORTED uint64_t latencyPercentileUs(double percentile) const;
+    };
+
+    LIBBINDER_EXPORTED static void setEnabled(bool enabled);
+    LIBBINDER_EXPORTED static bool isEnabled();
+
+    // Clears all counters. Keys which have already been seen keep their slot.
+    LIBBINDER_EXPORTED static void reset();
+
+    LIBBINDER_EXPORTED static std::vector<Entry> snapshot();
+
+    // Human readable dump of entries, one line per entry.
+    LIBBINDER_EXPORTED static std::string toString(const std::vector<Entry>& entries);
+
+    // Wire format for IBinder::TRANSACTION_STATS_TRANSACTION. Not stable.
+    LIBBINDER_EXPORTED static status_t writeToParcel(const std::vector<Entry>& entries,
+                                                     Parcel* parcel);
+    LIBBINDER_EXPORTED static status_t readFromParcel(const Parcel& parcel,
+                                                      std::vector<Entry>* entries);
+
+    // Called by BpBinder and BBinder. Only call after isEnabled() returned
+    // true.
+    static void record(const String16& descriptor, uint32_t code, bool incoming,
+                       uint64_t latencyNs, size_t parcelBytes);
+};
+
+// Kernel binder thread pool usage of a process. See ProcessState::getThreadPoolStats().
+//
+// The stats of another process can be read with IBinder::getThreadPoolStats()
+// on any binder object it hosts.
+struct ThreadPoolStats {
+    // Threads in the thread pool, including ones joined by the process itself.
+    uint64_t currentThreads = 0;
+    // Threads the kernel may start, see ProcessState::setThreadPoolMaxThreadCount().
+    uint64_t maxThreads = 0;
+    // Threads executing a command, now and at most so far.
+    uint64_t executingThreads = 0;
+    uint64_t peakExecutingThreads = 0;
+    // Periods in which all threads the kernel may start were busy, during which
+    // incoming transactions waited in the kernel for a thread, and their total
+    // and longest duration.
+    uint64_t starvationCount = 0;
+    uint64_t totalStarvationNs = 0;
+    uint64_t longestStarvationNs = 0;
+
+    // Wire format for IBinder::TRANSACTION_STATS_TRANSACTION. Not stable.
+    LIBBINDER_EXPORTED status_t writeToParcel(Parcel* parcel) const;
+    LIBBINDER_EXPORTED status_t readFromParcel(const Parcel& parcel);
+};
+
+} // namespace binder::debug
+
+} // namespace android
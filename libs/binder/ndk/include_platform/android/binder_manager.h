@@ -188,6 +188,28 @@ AServiceManager_registerForServiceNotifications(const char* instance,
                                                 AServiceManager_onRegister onRegister, void* cookie)
         __INTRODUCED_IN(34);
 
+/**
+ * Wait for several services at once, e.g. all the dependencies of a daemon during boot. This is
+ * like calling AServiceManager_waitForService for each instance, except that every service which
+ * isn't available yet is waited on at the same time.
+ *
+ * onAvailable is called on the calling thread once for each instance, as soon as that service is
+ * available. Services which become available together are reported in the order of instances, so
+ * list the most important dependencies first.
+ *
+ * \param instances names of the services to wait for
+ * \param numInstances number of entries in instances
+ * \param onAvailable callback for when a service is available, which is passed ownership of the
+ * binder
+ * \param cookie data passed to onAvailable
+ *
+ * \return STATUS_OK once every service was reported. Otherwise, an error for permission problems
+ * or fatal errors, and some services may not have been reported.
+ */
+binder_status_t AServiceManager_waitForServices(const char* const* instances, size_t numInstances,
+                                                AServiceManager_onRegister onAvailable,
+                                                void* cookie) __INTRODUCED_IN(36);
+
 /**
  * Unregister for notifications and delete the object.
  *
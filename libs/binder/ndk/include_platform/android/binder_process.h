@@ -97,4 +97,26 @@ __attribute__((weak)) binder_status_t ABinderProcess_setupPolling(int* fd) __INT
  */
 __attribute__((weak)) binder_status_t ABinderProcess_handlePolledCommands(void) __INTRODUCED_IN(31);
 
+/**
+ * Starts batching oneway transactions made from the calling thread.
+ *
+ * Until ABinderProcess_flushOnewayBatch is called, oneway transactions sent from this thread over
+ * the kernel binder driver are queued rather than submitted individually. Queued transactions may
+ * target different binders. Any other call from this thread which needs the driver (for instance a
+ * two-way transaction) submits the queue first.
+ *
+ * This is intended for services which send bursts of oneway callbacks, to reduce the number of
+ * system calls per callback.
+ */
+__attribute__((weak)) void ABinderProcess_beginOnewayBatch(void) __INTRODUCED_IN(36);
+
+/**
+ * Submits all oneway transactions queued on the calling thread since
+ * ABinderProcess_beginOnewayBatch with a single call into the kernel, and ends the batch.
+ *
+ * eturn STATUS_OK if every queued transaction was accepted, otherwise the first error reported
+ * for one of them.
+ */
+__attribute__((weak)) binder_status_t ABinderProcess_flushOnewayBatch(void) __INTRODUCED_IN(36);
+
 __END_DECLS
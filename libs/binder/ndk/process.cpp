@@ -19,6 +19,8 @@
 
 #include <mutex>
 
+#include "status_internal.h"
+
 using ::android::IPCThreadState;
 using ::android::ProcessState;
 
@@ -43,3 +45,11 @@ binder_status_t ABinderProcess_setupPolling(int* fd) {
 binder_status_t ABinderProcess_handlePolledCommands(void) {
     return IPCThreadState::self()->handlePolledCommands();
 }
+
+void ABinderProcess_beginOnewayBatch(void) {
+    IPCThreadState::self()->beginOnewayBatch();
+}
+
+binder_status_t ABinderProcess_flushOnewayBatch(void) {
+    return PruneStatusT(IPCThreadState::self()->flushOnewayBatch());
+}
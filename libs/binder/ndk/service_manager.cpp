@@ -84,6 +84,30 @@ AIBinder* AServiceManager_checkService(const char* instance) {
     AIBinder_incStrong(ret.get());
     return ret.get();
 }
+binder_status_t AServiceManager_waitForServices(const char* const* instances, size_t numInstances,
+                                                AServiceManager_onRegister onAvailable,
+                                                void* cookie) {
+    if (instances == nullptr && numInstances > 0) {
+        return STATUS_UNEXPECTED_NULL;
+    }
+    LOG_ALWAYS_FATAL_IF(onAvailable == nullptr, "onAvailable == nullptr");
+
+    std::vector<String16> names;
+    names.reserve(numInstances);
+    for (size_t i = 0; i < numInstances; i++) {
+        if (instances[i] == nullptr) return STATUS_UNEXPECTED_NULL;
+        names.push_back(String16(instances[i]));
+    }
+
+    sp<IServiceManager> sm = defaultServiceManager();
+    status_t status =
+            sm->waitForServices(names, [&](const String16& name, const sp<IBinder>& binder) {
+                sp<AIBinder> ret = ABpBinder::lookupOrCreateFromBinder(binder);
+                AIBinder_incStrong(ret.get());
+                onAvailable(String8(name).c_str(), ret.get(), cookie);
+            });
+    return PruneStatusT(status);
+}
 AIBinder* AServiceManager_getService(const char* instance) {
     if (instance == nullptr) {
         return nullptr;
@@ -342,6 +342,33 @@ TEST(NdkBinder, RegisterForServiceNotificationsExisting) {
     EXPECT_EQ(data.binder, ndk::SpAIBinder(AServiceManager_checkService(kExistingNonNdkService)));
 }
 
+TEST(NdkBinder, WaitForServices) {
+    struct Available {
+        std::vector<std::string> instances;
+        std::vector<ndk::SpAIBinder> binders;
+
+        static void onAvailable(const char* instance, AIBinder* binder, void* cookie) {
+            Available* a = reinterpret_cast<Available*>(cookie);
+            a->instances.push_back(instance);
+            a->binders.push_back(ndk::SpAIBinder(binder));
+        }
+    } available;
+
+    // kLazyBinderNdkUnitTestService is started on demand while waiting
+    const char* instances[] = {kExistingNonNdkService, kLazyBinderNdkUnitTestService};
+    ASSERT_EQ(STATUS_OK,
+              AServiceManager_waitForServices(instances, std::size(instances),
+                                              Available::onAvailable, &available));
+
+    ASSERT_EQ(2u, available.instances.size());
+    EXPECT_EQ(kExistingNonNdkService, available.instances[0]);
+    EXPECT_EQ(kLazyBinderNdkUnitTestService, available.instances[1]);
+    for (const ndk::SpAIBinder& binder : available.binders) {
+        ASSERT_NE(nullptr, binder.get());
+        EXPECT_EQ(STATUS_OK, AIBinder_ping(binder.get()));
+    }
+}
+
 TEST(NdkBinder, UnimplementedDump) {
     ndk::SpAIBinder binder;
     sp<IFoo> foo = IFoo::getService(IFoo::kSomeInstanceName, binder.getR());
@@ -221,7 +221,19 @@ TEST(BinderAllocation, SmallTransaction) {
     });
     manager->checkService(empty_descriptor);
 
-    EXPECT_EQ(mallocs, 1u);
+    // Parcel buffers are recycled through a per-thread pool, so earlier tests
+    // on this thread may already have provided one.
+    EXPECT_LE(mallocs, 1u);
+}
+
+TEST(BinderAllocation, SmallTransactionSteadyState) {
+    String16 empty_descriptor = String16("");
+    sp<IServiceManager> manager = defaultServiceManager();
+
+    manager->checkService(empty_descriptor); // first call may fill the parcel pool
+    const auto m = ScopeDisallowMalloc();
+    manager->checkService(empty_descriptor);
+    manager->checkService(empty_descriptor);
 }
 
 TEST(RpcBinderAllocation, SetupRpcServer) {
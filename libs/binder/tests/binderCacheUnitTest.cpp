@@ -24,7 +24,9 @@
 #include "fakeservicemanager/FakeServiceManager.h"
 
 #include <sys/prctl.h>
+#include <map>
 #include <thread>
+#include <vector>
 
 using namespace android;
 
@@ -77,6 +79,32 @@ public:
     FakeServiceManager innerSm;
 };
 
+// Also pushes service registrations to registered callbacks, like servicemanager.
+class MockAidlServiceManagerWithNotifications : public MockAidlServiceManager {
+public:
+    binder::Status addService(const std::string& name, const sp<IBinder>& service,
+                              bool allowIsolated, int32_t dumpPriority) override {
+        binder::Status status =
+                MockAidlServiceManager::addService(name, service, allowIsolated, dumpPriority);
+        if (!status.isOk()) return status;
+        for (const sp<os::IServiceCallback>& callback : mCallbacks[name]) {
+            callback->onRegistration(name, service);
+        }
+        return status;
+    }
+
+    binder::Status registerForNotifications(const std::string& name,
+                                            const sp<os::IServiceCallback>& callback) override {
+        mCallbacks[name].push_back(callback);
+        if (sp<IBinder> binder = innerSm.getService(String16(name.c_str()))) {
+            callback->onRegistration(name, binder);
+        }
+        return binder::Status::ok();
+    }
+
+    std::map<std::string, std::vector<sp<os::IServiceCallback>>> mCallbacks;
+};
+
 class LibbinderCacheTest : public ::testing::Test {
 protected:
     void SetUp() override {
@@ -189,6 +217,36 @@ TEST_F(LibbinderCacheTest, DoNotCacheServiceNotInList) {
     EXPECT_EQ(binder2, result);
 }
 
+TEST(LibbinderCacheInvalidationTest, ReplacedServiceInvalidatesCache) {
+    sp<MockAidlServiceManagerWithNotifications> sm =
+            sp<MockAidlServiceManagerWithNotifications>::make();
+    sp<android::IServiceManager> serviceManager =
+            getServiceManagerShimFromAidlServiceManagerForTests(sm);
+
+    sp<IBinder> binder1 = sp<BBinder>::make();
+    sp<IBinder> binder2 = sp<BBinder>::make();
+
+    EXPECT_EQ(OK, serviceManager->addService(kCachedServiceName, binder1));
+    // Get the service. This caches it and registers for notifications.
+    sp<IBinder> result = serviceManager->checkService(kCachedServiceName);
+    ASSERT_EQ(binder1, result);
+    if (kUseLibbinderCache) {
+        EXPECT_EQ(1u, sm->mCallbacks[String8(kCachedServiceName).c_str()].size());
+    }
+
+    // Replacing the service is pushed to the cache, which drops binder1.
+    EXPECT_EQ(OK, serviceManager->addService(kCachedServiceName, binder2));
+    result = serviceManager->checkService(kCachedServiceName);
+    EXPECT_EQ(binder2, result);
+
+    // Only one callback is registered per name.
+    result = serviceManager->checkService(kCachedServiceName);
+    EXPECT_EQ(binder2, result);
+    if (kUseLibbinderCache) {
+        EXPECT_EQ(1u, sm->mCallbacks[String8(kCachedServiceName).c_str()].size());
+    }
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
 
@@ -20,8 +20,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <algorithm>
 #include <chrono>
 #include <fstream>
+#include <numeric>
 #include <thread>
 
 #include <gmock/gmock.h>
@@ -1205,6 +1207,79 @@ TEST_F(BinderLibTest, RemoteGetExtension) {
     EXPECT_EQ(NO_ERROR, extension->pingBinder());
 }
 
+TEST_F(BinderLibTest, LocalTransactionStats) {
+    sp<BBinder> binder = new BBinder();
+    ASSERT_EQ(NO_ERROR, binder->setTransactionStatsEnabled(true));
+
+    Parcel data, reply;
+    for (int i = 0; i < 3; i++) {
+        // BBinder doesn't implement user transactions, but they are still counted.
+        EXPECT_EQ(UNKNOWN_TRANSACTION, binder->transact(IBinder::FIRST_CALL_TRANSACTION, data,
+                                                        &reply));
+    }
+
+    std::vector<binder::debug::TransactionStats::Entry> entries;
+    ASSERT_EQ(NO_ERROR, binder->getTransactionStats(&entries));
+    EXPECT_EQ(NO_ERROR, binder->setTransactionStatsEnabled(false));
+
+    auto it = std::find_if(entries.begin(), entries.end(), [](const auto& entry) {
+        return entry.incoming && entry.interfaceName == "BBinder" &&
+                entry.code == IBinder::FIRST_CALL_TRANSACTION;
+    });
+    ASSERT_NE(it, entries.end());
+    EXPECT_EQ(3u, it->count);
+    EXPECT_EQ(3u,
+              std::accumulate(it->latencyHistogram.begin(), it->latencyHistogram.end(), uint64_t{0}));
+    EXPECT_EQ(3u,
+              std::accumulate(it->sizeHistogram.begin(), it->sizeHistogram.end(), uint64_t{0}));
+}
+
+TEST_F(BinderLibTest, RemoteTransactionStats) {
+    sp<IBinder> server = addServer();
+    ASSERT_TRUE(server != nullptr);
+
+    ASSERT_EQ(NO_ERROR, server->setTransactionStatsEnabled(true));
+    Parcel data, reply;
+    EXPECT_THAT(server->transact(BINDER_LIB_TEST_NOP_TRANSACTION, data, &reply),
+                StatusEq(NO_ERROR));
+
+    std::vector<binder::debug::TransactionStats::Entry> entries;
+    ASSERT_EQ(NO_ERROR, server->getTransactionStats(&entries));
+    EXPECT_EQ(NO_ERROR, server->setTransactionStatsEnabled(false));
+
+    auto it = std::find_if(entries.begin(), entries.end(), [](const auto& entry) {
+        return entry.incoming && entry.code == BINDER_LIB_TEST_NOP_TRANSACTION;
+    });
+    ASSERT_NE(it, entries.end());
+    EXPECT_GE(it->count, 1u);
+}
+
+TEST_F(BinderLibTest, RemoteThreadPoolStats) {
+    sp<IBinder> server = addServer();
+    ASSERT_TRUE(server != nullptr);
+
+    Parcel data, reply;
+    EXPECT_THAT(server->transact(BINDER_LIB_TEST_NOP_TRANSACTION, data, &reply),
+                StatusEq(NO_ERROR));
+
+    binder::debug::ThreadPoolStats stats;
+    ASSERT_EQ(NO_ERROR, server->getThreadPoolStats(&stats));
+    EXPECT_GE(stats.currentThreads, 1u);
+    EXPECT_GE(stats.maxThreads, 1u);
+    // This call is executing while the server reports its stats.
+    EXPECT_GE(stats.executingThreads, 1u);
+    EXPECT_GE(stats.peakExecutingThreads, stats.executingThreads);
+    EXPECT_LE(stats.longestStarvationNs, stats.totalStarvationNs);
+}
+
+TEST_F(BinderLibTest, AdaptiveThreadPoolMaxThreadCount) {
+    sp<ProcessState> process = ProcessState::self();
+    const size_t maxThreads = process->getThreadPoolStats().maxThreads;
+    EXPECT_EQ(BAD_VALUE, process->setThreadPoolAdaptiveMaxThreadCount(maxThreads, -1ms));
+    EXPECT_EQ(NO_ERROR, process->setThreadPoolAdaptiveMaxThreadCount(maxThreads, 10ms));
+    EXPECT_EQ(maxThreads, process->getThreadPoolStats().maxThreads);
+}
+
 TEST_F(BinderLibTest, CheckHandleZeroBinderHighBitsZeroCookie) {
     Parcel data, reply;
 
@@ -169,4 +169,150 @@ BENCHMARK(BM_CharVector)->Apply(VectorArgs);
 BENCHMARK(BM_Int32Vector)->Apply(VectorArgs);
 BENCHMARK(BM_Int64Vector)->Apply(VectorArgs);
 
+// The same three fields, once as a fixed-layout parcelable, which Parcel
+// copies in bulk, and once as a Parcelable written field by field.
+struct FixedLayoutPoint {
+    int32_t x = 0;
+    int32_t y = 0;
+    int64_t timestamp = 0;
+    static constexpr size_t kFixedLayoutSize = 16;
+};
+static_assert(android::binder::is_fixed_layout_parcelable_v<FixedLayoutPoint>);
+
+struct ParcelablePoint : public android::Parcelable {
+    int32_t x = 0;
+    int32_t y = 0;
+    int64_t timestamp = 0;
+
+    android::status_t writeToParcel(android::Parcel* p) const override {
+        size_t start = p->dataPosition();
+        p->writeInt32(0);
+        p->writeInt32(x);
+        p->writeInt32(y);
+        p->writeInt64(timestamp);
+        size_t end = p->dataPosition();
+        p->setDataPosition(start);
+        p->writeInt32(end - start);
+        p->setDataPosition(end);
+        return android::OK;
+    }
+    android::status_t readFromParcel(const android::Parcel* p) override {
+        size_t start = p->dataPosition();
+        int32_t size;
+        p->readInt32(&size);
+        p->readInt32(&x);
+        p->readInt32(&y);
+        p->readInt64(&timestamp);
+        p->setDataPosition(start + size);
+        return android::OK;
+    }
+};
+
+template <typename T>
+static void BM_ParcelableVectorOf(benchmark::State& state) {
+    const size_t elements = state.range(0);
+
+    std::vector<T> v1(elements);
+    std::vector<T> v2(elements);
+    android::Parcel p;
+    while (state.KeepRunning()) {
+        p.setDataPosition(0);
+        p.writeParcelableVector(v1);
+
+        p.setDataPosition(0);
+        p.readParcelableVector(&v2);
+
+        benchmark::DoNotOptimize(v2[0]);
+        benchmark::ClobberMemory();
+    }
+    state.SetComplexityN(elements);
+}
+
+static void BM_FixedLayoutParcelableVector(benchmark::State& state) {
+    BM_ParcelableVectorOf<FixedLayoutPoint>(state);
+}
+
+static void BM_FieldByFieldParcelableVector(benchmark::State& state) {
+    BM_ParcelableVectorOf<ParcelablePoint>(state);
+}
+
+BENCHMARK(BM_FixedLayoutParcelableVector)->Apply(VectorArgs);
+BENCHMARK(BM_FieldByFieldParcelableVector)->Apply(VectorArgs);
+
+// Construct a series of payload sizes in bytes { 4KiB, 16KiB, ..., 1MiB }
+static void GrowthArgs(benchmark::internal::Benchmark* b) {
+    for (int i = 12; i <= 20; i += 2) {
+        b->Args({1 << i});
+    }
+}
+
+enum class GrowthMode { kGrow, kReserved, kSensitive };
+
+/*
+  Build a parcel of state.range(0) bytes from scratch using small writes, the
+  way SurfaceComposerClient::Transaction::writeToParcel does with hundreds of
+  layer_state_t. This exercises growData()/continueWrite() rather than the
+  steady-state write path measured above.
+*/
+template <GrowthMode kMode>
+static void BM_ParcelGrowth(benchmark::State& state) {
+    const size_t bytes = state.range(0);
+    const size_t words = bytes / sizeof(int32_t);
+
+    while (state.KeepRunning()) {
+        android::Parcel p;
+        if constexpr (kMode == GrowthMode::kReserved) {
+            p.setDataCapacity(bytes);
+        } else if constexpr (kMode == GrowthMode::kSensitive) {
+            p.markSensitive();
+        }
+        for (size_t i = 0; i < words; ++i) {
+            p.writeInt32(static_cast<int32_t>(i));
+        }
+        benchmark::DoNotOptimize(p.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * bytes);
+    state.SetComplexityN(bytes);
+}
+
+/*
+  Reuse one parcel for payloads of increasing size. Every round calls
+  setData()/restartWrite() on a parcel that already holds data which is about
+  to be discarded.
+*/
+static void BM_ParcelRestartWrite(benchmark::State& state) {
+    const size_t bytes = state.range(0);
+
+    std::vector<uint8_t> small(bytes / 4);
+    std::vector<uint8_t> large(bytes);
+    android::Parcel p;
+    while (state.KeepRunning()) {
+        p.setData(small.data(), small.size());
+        p.setData(large.data(), large.size());
+        p.freeData();
+        benchmark::DoNotOptimize(p.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * (small.size() + large.size()));
+    state.SetComplexityN(bytes);
+}
+
+static void BM_ParcelGrowthUnreserved(benchmark::State& state) {
+    BM_ParcelGrowth<GrowthMode::kGrow>(state);
+}
+
+static void BM_ParcelGrowthReserved(benchmark::State& state) {
+    BM_ParcelGrowth<GrowthMode::kReserved>(state);
+}
+
+static void BM_ParcelGrowthSensitive(benchmark::State& state) {
+    BM_ParcelGrowth<GrowthMode::kSensitive>(state);
+}
+
+BENCHMARK(BM_ParcelGrowthUnreserved)->Apply(GrowthArgs);
+BENCHMARK(BM_ParcelGrowthReserved)->Apply(GrowthArgs);
+BENCHMARK(BM_ParcelGrowthSensitive)->Apply(GrowthArgs);
+BENCHMARK(BM_ParcelRestartWrite)->Apply(GrowthArgs);
+
 BENCHMARK_MAIN();
@@ -415,3 +415,101 @@ TEST(Parcel, GetOpenAshmemSize) {
         ASSERT_EQ((kSize * (i + 1)), p.getOpenAshmemSize());
     }
 }
+
+struct FixedLayoutPoint {
+    int32_t x = 0;
+    int32_t y = 0;
+    int64_t timestamp = 0;
+    static constexpr size_t kFixedLayoutSize = 16;
+};
+static_assert(android::binder::is_fixed_layout_parcelable_v<FixedLayoutPoint>);
+
+TEST(Parcel, FixedLayoutParcelableMatchesStructuredParcelable) {
+    std::vector<FixedLayoutPoint> points = {{1, 2, 3}, {-1, -2, -3}};
+    Parcel p;
+    ASSERT_EQ(OK, p.writeParcelableVector(points));
+
+    // what AIDL writes for the same parcelable
+    p.setDataPosition(0);
+    int32_t value;
+    int64_t timestamp;
+    ASSERT_EQ(OK, p.readInt32(&value));
+    EXPECT_EQ(2, value);
+    for (const auto& point : points) {
+        ASSERT_EQ(OK, p.readInt32(&value));
+        EXPECT_EQ(1, value);
+        ASSERT_EQ(OK, p.readInt32(&value));
+        EXPECT_EQ(20, value);
+        ASSERT_EQ(OK, p.readInt32(&value));
+        EXPECT_EQ(point.x, value);
+        ASSERT_EQ(OK, p.readInt32(&value));
+        EXPECT_EQ(point.y, value);
+        ASSERT_EQ(OK, p.readInt64(&timestamp));
+        EXPECT_EQ(point.timestamp, timestamp);
+    }
+    EXPECT_EQ(0u, p.dataAvail());
+
+    p.setDataPosition(0);
+    std::vector<FixedLayoutPoint> out;
+    ASSERT_EQ(OK, p.readParcelableVector(&out));
+    ASSERT_EQ(points.size(), out.size());
+    for (size_t i = 0; i < points.size(); i++) {
+        EXPECT_EQ(points[i].x, out[i].x);
+        EXPECT_EQ(points[i].y, out[i].y);
+        EXPECT_EQ(points[i].timestamp, out[i].timestamp);
+    }
+}
+
+TEST(Parcel, FixedLayoutParcelableOtherVersions) {
+    Parcel p;
+    // older version, without timestamp
+    ASSERT_EQ(OK, p.writeInt32(1));
+    ASSERT_EQ(OK, p.writeInt32(12));
+    ASSERT_EQ(OK, p.writeInt32(4));
+    ASSERT_EQ(OK, p.writeInt32(5));
+    // newer version, with an extra field
+    ASSERT_EQ(OK, p.writeInt32(1));
+    ASSERT_EQ(OK, p.writeInt32(24));
+    ASSERT_EQ(OK, p.writeInt32(6));
+    ASSERT_EQ(OK, p.writeInt32(7));
+    ASSERT_EQ(OK, p.writeInt64(8));
+    ASSERT_EQ(OK, p.writeInt32(9));
+    ASSERT_EQ(OK, p.writeInt32(42));
+
+    p.setDataPosition(0);
+    FixedLayoutPoint older{1, 1, 1};
+    ASSERT_EQ(OK, p.readParcelable(&older));
+    EXPECT_EQ(4, older.x);
+    EXPECT_EQ(5, older.y);
+    EXPECT_EQ(0, older.timestamp);
+
+    FixedLayoutPoint newer;
+    ASSERT_EQ(OK, p.readParcelable(&newer));
+    EXPECT_EQ(6, newer.x);
+    EXPECT_EQ(7, newer.y);
+    EXPECT_EQ(8, newer.timestamp);
+
+    int32_t trailing;
+    ASSERT_EQ(OK, p.readInt32(&trailing));
+    EXPECT_EQ(42, trailing);
+}
+
+TEST(Parcel, FixedLayoutParcelableNullable) {
+    Parcel p;
+    std::optional<FixedLayoutPoint> point;
+    ASSERT_EQ(OK, p.writeNullableParcelable(point));
+    point = FixedLayoutPoint{1, 2, 3};
+    ASSERT_EQ(OK, p.writeNullableParcelable(point));
+
+    p.setDataPosition(0);
+    std::optional<FixedLayoutPoint> out;
+    ASSERT_EQ(OK, p.readParcelable(&out));
+    EXPECT_FALSE(out.has_value());
+    ASSERT_EQ(OK, p.readParcelable(&out));
+    ASSERT_TRUE(out.has_value());
+    EXPECT_EQ(3, out->timestamp);
+
+    p.setDataPosition(0);
+    FixedLayoutPoint nonNull;
+    EXPECT_EQ(android::UNEXPECTED_NULL, p.readParcelable(&nonNull));
+}
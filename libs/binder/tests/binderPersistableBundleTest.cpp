@@ -132,3 +132,29 @@ TEST(PersistableBundle, OverwriteKey) {
     EXPECT_TRUE(pb.getDouble(kKey, &out));
     EXPECT_EQ(out, 0.5);
 }
+
+TEST(PersistableBundle, ParcelAndUnparcelLazily) {
+    PersistableBundle expected = createSimplePersistableBundle();
+    expected.putString(String16{"string"}, String16{"foo"});
+    expected.putPersistableBundle(String16{"bundle"}, createSimplePersistableBundle());
+
+    Parcel p{};
+    EXPECT_EQ(expected.writeToParcel(&p), 0);
+
+    // A bundle passed on unread is written back as-is.
+    PersistableBundle unread{};
+    p.setDataPosition(0);
+    EXPECT_EQ(unread.readFromParcelLazily(&p), 0);
+    Parcel forwarded{};
+    EXPECT_EQ(unread.writeToParcel(&forwarded), 0);
+    ASSERT_EQ(forwarded.dataSize(), p.dataSize());
+    EXPECT_EQ(memcmp(forwarded.data(), p.data(), p.dataSize()), 0);
+
+    PersistableBundle out{};
+    p.setDataPosition(0);
+    EXPECT_EQ(out.readFromParcelLazily(&p), 0);
+    int32_t value;
+    EXPECT_TRUE(out.getInt(kKey, &value));
+    EXPECT_EQ(value, 64);
+    EXPECT_EQ(expected, out);
+}
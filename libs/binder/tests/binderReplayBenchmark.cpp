@@ -0,0 +1,227 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Replays transactions recorded with `record_binder` (see RecordedTransaction.h) against a
+// running service, and reports the throughput and latencies the service achieved. The same
+// recording can be replayed before and after a change to the service to compare them with
+// real traffic.
+
+#include <binder/Binder.h>
+#include <binder/IBinder.h>
+#include <binder/IServiceManager.h>
+#include <binder/Parcel.h>
+#include <binder/RecordedTransaction.h>
+#include <binder/unique_fd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+
+using namespace android;
+using android::binder::unique_fd;
+using android::binder::debug::RecordedTransaction;
+using std::chrono::nanoseconds;
+using std::chrono::steady_clock;
+
+namespace {
+
+struct Options {
+    const char* serviceName = nullptr;
+    const char* recordingPath = nullptr;
+    int threads = 1;
+    int iterations = 1;
+    // Transactions per second across all threads, or 0 to replay as fast as possible.
+    double rate = 0;
+};
+
+struct Result {
+    // Latencies in nanoseconds, by transaction code.
+    std::map<uint32_t, std::vector<uint64_t>> latencies;
+    size_t errors = 0;
+
+    void merge(Result&& other) {
+        for (auto& [code, latencies] : other.latencies) {
+            std::vector<uint64_t>& merged = this->latencies[code];
+            merged.insert(merged.end(), latencies.begin(), latencies.end());
+        }
+        errors += other.errors;
+    }
+};
+
+void printUsage(const char* name) {
+    std::cout << "Usage: " << name << " [OPTIONS] <service_name> <recording_path>" << std::endl
+              << "\t-t N : Replay from N threads at once (default 1)." << std::endl
+              << "\t-i N : Replay the recording N times from each thread (default 1)."
+              << std::endl
+              << "\t-r N : Send N transactions per second across all threads, instead of as"
+              << " fast as possible." << std::endl;
+}
+
+bool parseOptions(int argc, char** argv, Options* options) {
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-'; i++) {
+        std::string option = argv[i];
+        if (option == "--help" || i + 1 == argc) return false;
+        const char* value = argv[++i];
+        if (option == "-t") {
+            options->threads = atoi(value);
+        } else if (option == "-i") {
+            options->iterations = atoi(value);
+        } else if (option == "-r") {
+            options->rate = atof(value);
+        } else {
+            return false;
+        }
+    }
+    if (argc - i != 2 || options->threads < 1 || options->iterations < 1 || options->rate < 0) {
+        return false;
+    }
+    options->serviceName = argv[i];
+    options->recordingPath = argv[i + 1];
+    return true;
+}
+
+// Reads the transactions that can be replayed. Those that sent binders or file descriptors
+// can't be, since the recording doesn't keep the objects.
+std::vector<RecordedTransaction> loadRecording(const char* path) {
+    std::vector<RecordedTransaction> transactions;
+    unique_fd fd(open(path, O_RDONLY | O_CLOEXEC));
+    if (!fd.ok()) {
+        std::cerr << "Failed to open " << path << ": " << strerror(errno) << std::endl;
+        return transactions;
+    }
+    size_t skipped = 0;
+    while (std::optional<RecordedTransaction> transaction = RecordedTransaction::fromFile(fd)) {
+        if (!transaction->getObjectOffsets().empty()) {
+            skipped++;
+            continue;
+        }
+        transactions.push_back(std::move(*transaction));
+    }
+    if (skipped > 0) {
+        std::cout << "Skipped " << skipped << " transactions that sent binders or fds."
+                  << std::endl;
+    }
+    return transactions;
+}
+
+Result replay(const sp<IBinder>& binder, const std::vector<RecordedTransaction>& transactions,
+              const Options& options, size_t firstIndex) {
+    Result result;
+    const nanoseconds interval = options.rate > 0
+            ? nanoseconds(static_cast<int64_t>(1e9 * options.threads / options.rate))
+            : nanoseconds(0);
+    steady_clock::time_point next = steady_clock::now();
+
+    // Threads start at different points of the recording, so that they don't all send the
+    // same transaction at the same time.
+    for (int iteration = 0; iteration < options.iterations; iteration++) {
+        for (size_t n = 0; n < transactions.size(); n++) {
+            const RecordedTransaction& transaction =
+                    transactions[(firstIndex + n) % transactions.size()];
+            if (interval.count() > 0) {
+                std::this_thread::sleep_until(next);
+                next += interval;
+            }
+
+            Parcel data;
+            data.setData(transaction.getDataParcel().data(),
+                         transaction.getDataParcel().dataSize());
+            Parcel reply;
+            steady_clock::time_point start = steady_clock::now();
+            status_t status = binder->transact(transaction.getCode(), data, &reply,
+                                               transaction.getFlags());
+            nanoseconds latency = steady_clock::now() - start;
+
+            if (status != OK) {
+                result.errors++;
+            }
+            result.latencies[transaction.getCode()].push_back(latency.count());
+        }
+    }
+    return result;
+}
+
+void printLatencies(const char* label, std::vector<uint64_t>* latencies) {
+    std::sort(latencies->begin(), latencies->end());
+    auto percentile = [&](size_t p) {
+        return (*latencies)[std::min(latencies->size() - 1, p * latencies->size() / 100)] / 1e3;
+    };
+    std::cout << label << ": " << latencies->size() << " transactions, p50 " << percentile(50)
+              << "us, p90 " << percentile(90) << "us, p99 " << percentile(99) << "us, max "
+              << latencies->back() / 1e3 << "us" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, &options)) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<RecordedTransaction> transactions = loadRecording(options.recordingPath);
+    if (transactions.empty()) {
+        std::cerr << "No transactions to replay in " << options.recordingPath << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    sp<IBinder> binder = defaultServiceManager()->checkService(String16(options.serviceName));
+    if (binder == nullptr) {
+        std::cerr << "Service " << options.serviceName << " not found" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<Result> results(options.threads);
+    std::vector<std::thread> threads;
+    steady_clock::time_point start = steady_clock::now();
+    for (int i = 0; i < options.threads; i++) {
+        threads.emplace_back([&, i] {
+            results[i] = replay(binder, transactions, options, i * transactions.size() /
+                                        options.threads);
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(steady_clock::now() - start).count();
+
+    Result total;
+    for (Result& result : results) {
+        total.merge(std::move(result));
+    }
+    std::vector<uint64_t> all;
+    for (auto& [code, latencies] : total.latencies) {
+        all.insert(all.end(), latencies.begin(), latencies.end());
+    }
+
+    std::cout << "Replayed " << all.size() << " transactions in " << seconds << "s ("
+              << all.size() / seconds << "/s), " << total.errors << " failed" << std::endl;
+    printLatencies("all", &all);
+    for (auto& [code, latencies] : total.latencies) {
+        printLatencies(("code " + std::to_string(code)).c_str(), &latencies);
+    }
+    return total.errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
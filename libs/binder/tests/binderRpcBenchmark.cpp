@@ -118,6 +118,9 @@ enum Transport {
     KERNEL,
     RPC,
     RPC_TLS,
+    // Raw sockets with FD passing and the experimental protocol, so that
+    // large parcels go through shared memory.
+    RPC_SHMEM,
 };
 
 static const std::initializer_list<int64_t> kTransportList = {
@@ -145,6 +148,13 @@ static sp<IBinder> gRpcBinder;
 // Skip certificate validation to simplify the setup process.
 static sp<RpcSession> gSessionTls = RpcSession::make(makeFactoryTls());
 static sp<IBinder> gRpcTlsBinder;
+// Stays null if the experimental protocol is not allowed on this build.
+// Server threads, so also client connections, of the TLS server used by BM_tlsSessionSetup.
+static constexpr size_t kTlsSetupMaxThreads = 4;
+static std::string gTlsSetupAddr;
+
+static sp<RpcSession> gSessionShmem = RpcSession::make();
+static sp<IBinder> gRpcShmemBinder;
 #ifdef __BIONIC__
 static const String16 kKernelBinderInstance = String16(u"binderRpcBenchmark-control");
 static sp<IBinder> gKernelBinder;
@@ -161,6 +171,8 @@ static sp<IBinder> getBinderForOptions(benchmark::State& state) {
             return gRpcBinder;
         case RPC_TLS:
             return gRpcTlsBinder;
+        case RPC_SHMEM:
+            return gRpcShmemBinder;
         default:
             LOG(FATAL) << "Unknown transport value: " << transport;
             return nullptr;
@@ -181,6 +193,9 @@ static void SetLabel(benchmark::State& state) {
         case RPC_TLS:
             state.SetLabel("rpc_tls");
             break;
+        case RPC_SHMEM:
+            state.SetLabel("rpc_shmem");
+            break;
         default:
             LOG(FATAL) << "Unknown transport value: " << transport;
     }
@@ -250,6 +265,36 @@ BENCHMARK(BM_throughputForTransportAndBytes)
         ->ArgsProduct({kTransportList,
                        {64, 1024, 2048, 4096, 8182, 16364, 32728, 65535, 65536, 65537}});
 
+// Multi-megabyte payloads, e.g. between VMs. Kernel binder is left out since
+// its transaction buffer is limited to 1MB.
+void BM_largePayloadForTransportAndBytes(benchmark::State& state) {
+    sp<IBinder> binder = getBinderForOptions(state);
+    if (binder == nullptr) {
+        state.SkipWithError("transport unavailable");
+        return;
+    }
+    sp<IBinderRpcBenchmark> iface = interface_cast<IBinderRpcBenchmark>(binder);
+    CHECK(iface != nullptr);
+
+    std::vector<uint8_t> bytes = std::vector<uint8_t>(state.range(1));
+    for (size_t i = 0; i < bytes.size(); i++) {
+        bytes[i] = i % 256;
+    }
+
+    while (state.KeepRunning()) {
+        std::vector<uint8_t> out;
+        Status ret = iface->repeatBytes(bytes, &out);
+        CHECK(ret.isOk()) << ret;
+    }
+    state.SetBytesProcessed(state.iterations() * bytes.size() * 2);
+
+    SetLabel(state);
+}
+BENCHMARK(BM_largePayloadForTransportAndBytes)
+        ->ArgsProduct({{Transport::RPC, Transport::RPC_SHMEM},
+                       {1 << 20, 4 << 20, 16 << 20, 64 << 20}})
+        ->Unit(benchmark::kMillisecond);
+
 void BM_collectProxies(benchmark::State& state) {
     sp<IBinder> binder = getBinderForOptions(state);
     sp<IBinderRpcBenchmark> iface = interface_cast<IBinderRpcBenchmark>(binder);
@@ -301,6 +346,27 @@ void BM_repeatBinder(benchmark::State& state) {
 }
 BENCHMARK(BM_repeatBinder)->ArgsProduct({kTransportList});
 
+// Sets up a new TLS session per iteration, which opens one connection per thread of the server.
+// The connections after the first resume the TLS session of the first, without exchanging and
+// verifying certificates, so compare the time of 1 and kTlsSetupMaxThreads connections.
+void BM_tlsSessionSetup(benchmark::State& state) {
+    const size_t connections = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        sp<RpcSession> session = RpcSession::make(makeFactoryTls());
+        session->setMaxOutgoingConnections(connections);
+        state.ResumeTiming();
+
+        CHECK_EQ(OK, session->setupUnixDomainClient(gTlsSetupAddr.c_str()));
+
+        state.PauseTiming();
+        CHECK(session->shutdownAndWait(true));
+        state.ResumeTiming();
+    }
+    state.SetLabel("connections: " + std::to_string(connections));
+}
+BENCHMARK(BM_tlsSessionSetup)->Arg(1)->Arg(kTlsSetupMaxThreads);
+
 void forkRpcServer(const char* addr, const sp<RpcServer>& server) {
     if (0 == fork()) {
         prctl(PR_SET_PDEATHSIG, SIGHUP); // racey, okay
@@ -356,6 +422,32 @@ int main(int argc, char** argv) {
     setupClient(gSessionTls, tlsAddr.c_str());
     gRpcTlsBinder = gSessionTls->getRootObject();
 
+    gTlsSetupAddr = tmp + "/binderRpcTlsSetupBenchmark";
+    (void)unlink(gTlsSetupAddr.c_str());
+    auto tlsSetupServer = RpcServer::make(makeFactoryTls());
+    tlsSetupServer->setMaxThreads(kTlsSetupMaxThreads);
+    forkRpcServer(gTlsSetupAddr.c_str(), tlsSetupServer);
+    {
+        // Wait for the server to start.
+        sp<RpcSession> session = RpcSession::make(makeFactoryTls());
+        setupClient(session, gTlsSetupAddr.c_str());
+        CHECK(session->shutdownAndWait(true));
+    }
+
+    std::string shmemAddr = tmp + "/binderRpcShmemBenchmark";
+    (void)unlink(shmemAddr.c_str());
+    auto shmemServer = RpcServer::make(RpcTransportCtxFactoryRaw::make());
+    shmemServer->setSupportedFileDescriptorTransportModes(
+            {RpcSession::FileDescriptorTransportMode::UNIX});
+    if (shmemServer->setProtocolVersion(android::RPC_WIRE_PROTOCOL_VERSION_EXPERIMENTAL) &&
+        gSessionShmem->setProtocolVersion(android::RPC_WIRE_PROTOCOL_VERSION_EXPERIMENTAL)) {
+        gSessionShmem->setFileDescriptorTransportMode(
+                RpcSession::FileDescriptorTransportMode::UNIX);
+        forkRpcServer(shmemAddr.c_str(), shmemServer);
+        setupClient(gSessionShmem, shmemAddr.c_str());
+        gRpcShmemBinder = gSessionShmem->getRootObject();
+    }
+
     ::benchmark::RunSpecifiedBenchmarks();
     return 0;
 }
@@ -9,6 +9,7 @@
 
 #include <fstream>
 #include <iostream>
+#include <thread>
 #include <tuple>
 #include <vector>
 
@@ -20,6 +21,10 @@ using namespace android;
 
 enum BinderWorkerServiceCode {
     BINDER_NOP = IBinder::FIRST_CALL_TRANSACTION,
+    // Replies with a binder owned by the service. Clients which don't hold
+    // on to it make the kernel and ProcessState create and expunge a proxy
+    // for it on every call.
+    BINDER_GET_TOKEN,
 };
 
 #define ASSERT_TRUE(cond) \
@@ -33,7 +38,7 @@ do { \
 class BinderWorkerService : public BBinder
 {
 public:
-    BinderWorkerService() {}
+    BinderWorkerService() : m_token(new BBinder) {}
     ~BinderWorkerService() {}
     virtual status_t onTransact(uint32_t code,
                                 const Parcel& data, Parcel* reply,
@@ -44,10 +49,14 @@ public:
         switch (code) {
         case BINDER_NOP:
             return NO_ERROR;
+        case BINDER_GET_TOKEN:
+            return reply->writeStrongBinder(m_token);
         default:
             return UNKNOWN_TRANSACTION;
         };
     }
+private:
+    sp<IBinder> m_token;
 };
 
 static uint64_t warn_latency = std::numeric_limits<uint64_t>::max();
@@ -207,6 +216,8 @@ void worker_fx(int num,
                int iterations,
                int payload_size,
                bool cs_pair,
+               int oneway_batch,
+               int churn_threads,
                Pipe p)
 {
     // Create BinderWorkerService and for go.
@@ -240,7 +251,82 @@ void worker_fx(int num,
     chrono::time_point<chrono::high_resolution_clock> start, end;
 
     // Skip the benchmark if server of a cs_pair.
-    if (!(cs_pair && num < server_count)) {
+    if (!(cs_pair && num < server_count) && churn_threads > 0) {
+        // Proxy churn: churn_threads threads concurrently receive binders
+        // and drop them again, so each sample is dominated by proxy lookup,
+        // creation and expunging in ProcessState. Every thread makes
+        // iterations / churn_threads calls.
+        vector<ProcResults> thread_results(churn_threads, ProcResults(iterations / churn_threads));
+        vector<thread> threads;
+        for (int t = 0; t < churn_threads; t++) {
+            threads.emplace_back([&, t] {
+                unsigned int seed = num * churn_threads + t;
+                for (int i = 0; i < iterations / churn_threads; i++) {
+                    Parcel data, reply;
+                    int target = cs_pair ? num % server_count : rand_r(&seed) % workers.size();
+
+                    auto call_start = chrono::high_resolution_clock::now();
+                    status_t ret = workers[target]->transact(BINDER_GET_TOKEN, data, &reply);
+                    sp<IBinder> token;
+                    if (ret == NO_ERROR) ret = reply.readStrongBinder(&token);
+                    bool received = token != nullptr;
+                    token.clear();
+                    auto call_end = chrono::high_resolution_clock::now();
+
+                    if (ret != NO_ERROR || !received) {
+                        cout << "thread " << num << "." << t << " failed " << ret << " i : " << i
+                             << endl;
+                        exit(EXIT_FAILURE);
+                    }
+                    thread_results[t].add_time(uint64_t(
+                            chrono::duration_cast<chrono::nanoseconds>(call_end - call_start)
+                                    .count()));
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+        for (auto& r : thread_results) results.combine_with(r);
+    } else if (!(cs_pair && num < server_count) && oneway_batch > 0) {
+        // Oneway calls, submitted oneway_batch at a time. Each sample is the
+        // average cost of one call within a batch; a batch of N replaces N
+        // BINDER_WRITE_READ ioctls with one.
+        IPCThreadState* ipc = IPCThreadState::self();
+        for (int i = 0; i < iterations; i += oneway_batch) {
+            int calls = min(oneway_batch, iterations - i);
+            vector<Parcel> data(calls);
+            for (Parcel& d : data) {
+                int sz = payload_size;
+                while (sz >= sizeof(uint32_t)) {
+                    d.writeInt32(0);
+                    sz -= sizeof(uint32_t);
+                }
+            }
+
+            status_t ret = NO_ERROR;
+            start = chrono::high_resolution_clock::now();
+            if (oneway_batch > 1) ipc->beginOnewayBatch();
+            for (int j = 0; j < calls && ret == NO_ERROR; j++) {
+                int target = cs_pair ? num % server_count : rand() % workers.size();
+                ret = workers[target]->transact(BINDER_NOP, data[j], nullptr,
+                                                IBinder::FLAG_ONEWAY);
+            }
+            if (oneway_batch > 1) {
+                status_t flushRet = ipc->flushOnewayBatch();
+                if (ret == NO_ERROR) ret = flushRet;
+            }
+            end = chrono::high_resolution_clock::now();
+
+            uint64_t cur_time = uint64_t(chrono::duration_cast<chrono::nanoseconds>(end - start).count());
+            for (int j = 0; j < calls; j++) {
+                results.add_time(cur_time / calls);
+            }
+
+            if (ret != NO_ERROR) {
+               cout << "thread " << num << " failed " << ret << "i : " << i << endl;
+               exit(EXIT_FAILURE);
+            }
+        }
+    } else if (!(cs_pair && num < server_count)) {
         for (int i = 0; i < iterations; i++) {
             Parcel data, reply;
             int target = cs_pair ? num % server_count : rand() % workers.size();
@@ -275,7 +361,8 @@ void worker_fx(int num,
     exit(EXIT_SUCCESS);
 }
 
-Pipe make_worker(int num, int iterations, int worker_count, int payload_size, bool cs_pair)
+Pipe make_worker(int num, int iterations, int worker_count, int payload_size, bool cs_pair,
+                 int oneway_batch, int churn_threads)
 {
     auto pipe_pair = Pipe::createPipePair();
     pid_t pid = fork();
@@ -284,8 +371,8 @@ Pipe make_worker(int num, int iterations, int worker_count, int payload_size, bo
         return std::move(get<0>(pipe_pair));
     } else {
         /* child */
-        worker_fx(num, worker_count, iterations, payload_size, cs_pair,
-                  std::move(get<1>(pipe_pair)));
+        worker_fx(num, worker_count, iterations, payload_size, cs_pair, oneway_batch,
+                  churn_threads, std::move(get<1>(pipe_pair)));
         /* never get here */
         return std::move(get<0>(pipe_pair));
     }
@@ -306,12 +393,14 @@ void signal_all(vector<Pipe>& v)
     }
 }
 
-void run_main(int iterations, int workers, int payload_size, int cs_pair,
-              bool training_round = false, bool dump_to_file = false, string dump_filename = "") {
+void run_main(int iterations, int workers, int payload_size, int cs_pair, int oneway_batch,
+              int churn_threads, bool training_round = false, bool dump_to_file = false,
+              string dump_filename = "") {
     vector<Pipe> pipes;
     // Create all the workers and wait for them to spawn.
     for (int i = 0; i < workers; i++) {
-        pipes.push_back(make_worker(i, iterations, workers, payload_size, cs_pair));
+        pipes.push_back(make_worker(i, iterations, workers, payload_size, cs_pair, oneway_batch,
+                                    churn_threads));
     }
     wait_all(pipes);
     // All workers have now been spawned and added themselves to service
@@ -371,6 +460,8 @@ int main(int argc, char *argv[])
     int iterations = 10000;
     int payload_size = 0;
     bool cs_pair = false;
+    int oneway_batch = 0;
+    int churn_threads = 0;
     bool training_round = false;
     int max_time_us;
     bool dump_to_file = false;
@@ -387,6 +478,9 @@ int main(int argc, char *argv[])
             cout << "\t-t      : Run training round." << endl;
             cout << "\t-w N    : Specify total number of workers." << endl;
             cout << "\t-d FILE : Dump raw data to file." << endl;
+            cout << "\t-o      : Use oneway calls." << endl;
+            cout << "\t-b N    : Use oneway calls, submitted N at a time." << endl;
+            cout << "\t-c N    : Receive and drop binders from N threads per worker." << endl;
             return 0;
         }
         if (string(argv[i]) == "-w") {
@@ -416,6 +510,36 @@ int main(int argc, char *argv[])
             i++;
             continue;
         }
+        if (string(argv[i]) == "-o") {
+            oneway_batch = max(oneway_batch, 1);
+            continue;
+        }
+        if (string(argv[i]) == "-b") {
+            if (i + 1 == argc) {
+                cout << "-b requires an argument\n" << endl;
+                exit(EXIT_FAILURE);
+            }
+            oneway_batch = atoi(argv[i+1]);
+            if (oneway_batch <= 0) {
+                cout << "Batch size -b must be positive." << endl;
+                exit(EXIT_FAILURE);
+            }
+            i++;
+            continue;
+        }
+        if (string(argv[i]) == "-c") {
+            if (i + 1 == argc) {
+                cout << "-c requires an argument\n" << endl;
+                exit(EXIT_FAILURE);
+            }
+            churn_threads = atoi(argv[i+1]);
+            if (churn_threads <= 0) {
+                cout << "Thread count -c must be positive." << endl;
+                exit(EXIT_FAILURE);
+            }
+            i++;
+            continue;
+        }
         if (string(argv[i]) == "-p") {
             // client/server pairs instead of spreading
             // requests to all workers. If true, half
@@ -459,10 +583,11 @@ int main(int argc, char *argv[])
 
     if (training_round) {
         cout << "Start training round" << endl;
-        run_main(iterations, workers, payload_size, cs_pair, true);
+        run_main(iterations, workers, payload_size, cs_pair, oneway_batch, churn_threads, true);
         cout << "Completed training round" << endl << endl;
     }
 
-    run_main(iterations, workers, payload_size, cs_pair, false, dump_to_file, dump_filename);
+    run_main(iterations, workers, payload_size, cs_pair, oneway_batch, churn_threads, false,
+             dump_to_file, dump_filename);
     return 0;
 }
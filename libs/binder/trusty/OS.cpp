@@ -79,6 +79,18 @@ std::unique_ptr<RpcTransportCtxFactory> makeDefaultRpcTransportCtxFactory() {
     return RpcTransportCtxFactoryTipcTrusty::make();
 }
 
+status_t createSealedSharedMemory(const void* /* data */, size_t /* size */,
+                                  unique_fd* /* outFd */) {
+    return INVALID_OPERATION;
+}
+
+status_t mapSealedSharedMemory(borrowed_fd /* fd */, size_t /* size */,
+                               const void** /* outData */) {
+    return INVALID_OPERATION;
+}
+
+void unmapSharedMemory(const void* /* data */, size_t /* size */) {}
+
 ssize_t sendMessageOnSocket(
         const RpcTransportFd& /* socket */, iovec* /* iovs */, int /* niovs */,
         const std::vector<std::variant<unique_fd, borrowed_fd>>* /* ancillaryFds */) {
@@ -22,11 +22,93 @@
 
 #include <inttypes.h>
 
+#include <set>
+#include <string_view>
+
 namespace android {
 
-extern "C" int main() {
-    // ignore args - we only print csv
+static void usage(const char* program) {
+    fprintf(stderr,
+            "usage: %s [--transactions | --enable-transactions | --disable-transactions |\n"
+            "          --thread-pools]\n"
+            "  (no args)               print thread usage of each service\n"
+            "  --transactions          print transaction stats of each service process\n"
+            "  --enable-transactions   start collecting transaction stats\n"
+            "  --disable-transactions  stop collecting transaction stats\n"
+            "  --thread-pools          print thread pool stats of each service process\n",
+            program);
+}
+
+// Calls fn once for each process hosting a service.
+template <typename Fn>
+static void forEachServiceProcess(Fn fn) {
+    std::set<pid_t> seen;
+    for (const String16& name : defaultServiceManager()->listServices()) {
+        sp<IBinder> binder = defaultServiceManager()->checkService(name);
+        if (binder == nullptr) continue;
+
+        pid_t pid;
+        if (binder->getDebugPid(&pid) != OK) continue;
+        if (!seen.insert(pid).second) continue;
+
+        fn(name, pid, binder);
+    }
+}
+
+static int printTransactionStats() {
+    printf("pid,service,direction,interface,code,count,mean_us,p50_us,p90_us,p99_us\n");
+
+    forEachServiceProcess([](const String16& name, pid_t pid, const sp<IBinder>& binder) {
+        std::vector<binder::debug::TransactionStats::Entry> entries;
+        if (status_t status = binder->getTransactionStats(&entries); status != OK) {
+            fprintf(stderr, "%s: failed to get transaction stats: %s\n", String8(name).c_str(),
+                    statusToString(status).c_str());
+            return;
+        }
+        for (const auto& entry : entries) {
+            printf("%d,%s,%s,%s,%" PRIu32 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64
+                   ",%" PRIu64 "\n",
+                   pid, String8(name).c_str(), entry.incoming ? "in" : "out",
+                   entry.interfaceName.c_str(), entry.code, entry.count,
+                   entry.count == 0 ? 0 : entry.totalLatencyNs / entry.count / 1000,
+                   entry.latencyPercentileUs(50), entry.latencyPercentileUs(90),
+                   entry.latencyPercentileUs(99));
+        }
+    });
+    return 0;
+}
+
+static int setTransactionStatsEnabled(bool enabled) {
+    forEachServiceProcess([&](const String16& name, pid_t, const sp<IBinder>& binder) {
+        if (status_t status = binder->setTransactionStatsEnabled(enabled); status != OK) {
+            fprintf(stderr, "%s: failed to %s transaction stats: %s\n", String8(name).c_str(),
+                    enabled ? "enable" : "disable", statusToString(status).c_str());
+        }
+    });
+    return 0;
+}
+
+static int printThreadPoolStats() {
+    printf("pid,service,threads,max_threads,executing_threads,peak_executing_threads,"
+           "starvation_count,total_starvation_ms,longest_starvation_ms\n");
 
+    forEachServiceProcess([](const String16& name, pid_t pid, const sp<IBinder>& binder) {
+        binder::debug::ThreadPoolStats stats;
+        if (status_t status = binder->getThreadPoolStats(&stats); status != OK) {
+            fprintf(stderr, "%s: failed to get thread pool stats: %s\n", String8(name).c_str(),
+                    statusToString(status).c_str());
+            return;
+        }
+        printf("%d,%s,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64
+               ",%" PRIu64 "\n",
+               pid, String8(name).c_str(), stats.currentThreads, stats.maxThreads,
+               stats.executingThreads, stats.peakExecutingThreads, stats.starvationCount,
+               stats.totalStarvationNs / 1000000, stats.longestStarvationNs / 1000000);
+    });
+    return 0;
+}
+
+static int printThreadStats() {
     // we should use a csv library here for escaping, because
     // the name is coming from another process
     printf("name,binder_threads_in_use,binder_threads_started,client_count\n");
@@ -59,4 +141,18 @@ extern "C" int main() {
     return 0;
 }
 
+extern "C" int main(int argc, char** argv) {
+    // we only print csv
+    if (argc <= 1) return printThreadStats();
+    if (argc == 2) {
+        std::string_view arg = argv[1];
+        if (arg == "--transactions") return printTransactionStats();
+        if (arg == "--enable-transactions") return setTransactionStatsEnabled(true);
+        if (arg == "--disable-transactions") return setTransactionStatsEnabled(false);
+        if (arg == "--thread-pools") return printThreadPoolStats();
+    }
+    usage(argv[0]);
+    return 1;
+}
+
 } // namespace android
@@ -24,6 +24,8 @@
 
 #include <binder/IPCThreadState.h>
 #include <hwbinder/IPCThreadState.h>
+#include <sys/types.h>
+#include <unistd.h>
 
 namespace android {
 
@@ -33,12 +35,10 @@ enum class BinderCallType {
     HWBINDER,
 };
 
-// Based on where we are in recursion of nested binder/hwbinder calls, determine
-// which one we are closer to.
-inline static BinderCallType getCurrentServingCall() {
-    auto* hwState = android::hardware::IPCThreadState::selfOrNull();
-    auto* state = android::IPCThreadState::selfOrNull();
-
+// Determines which of the given thread states is serving the innermost call.
+// Either state may be nullptr if it hasn't been initialized on this thread.
+inline static BinderCallType getCurrentServingCall(
+        const android::IPCThreadState* state, const android::hardware::IPCThreadState* hwState) {
     // getServingStackPointer can also return nullptr
     const void* hwbinderSp = hwState ? hwState->getServingStackPointer() : nullptr;
     const void* binderSp = state ? state->getServingStackPointer() : nullptr;
@@ -51,4 +51,35 @@ inline static BinderCallType getCurrentServingCall() {
     return BinderCallType::BINDER;
 }
 
+// Based on where we are in recursion of nested binder/hwbinder calls, determine
+// which one we are closer to.
+inline static BinderCallType getCurrentServingCall() {
+    return getCurrentServingCall(android::IPCThreadState::selfOrNull(),
+                                 android::hardware::IPCThreadState::selfOrNull());
+}
+
+struct CallingIdentity {
+    BinderCallType callType;
+    pid_t pid;
+    uid_t uid;
+};
+
+// Same as getCurrentServingCall(), but also returns the calling pid and uid of
+// that call, looking up each thread state only once. When no call is being
+// served, the identity is that of this process, as IPCThreadState reports.
+// Like getCurrentServingCall(), this doesn't initialize either thread state.
+inline static CallingIdentity getCurrentServingCallIdentity() {
+    auto* hwState = android::hardware::IPCThreadState::selfOrNull();
+    auto* state = android::IPCThreadState::selfOrNull();
+
+    const BinderCallType callType = getCurrentServingCall(state, hwState);
+    if (callType == BinderCallType::HWBINDER) {
+        return {callType, hwState->getCallingPid(), hwState->getCallingUid()};
+    }
+    if (state != nullptr) {
+        return {callType, state->getCallingPid(), state->getCallingUid()};
+    }
+    return {callType, getpid(), getuid()};
+}
+
 } // namespace android
@@ -31,8 +31,10 @@
 #include <sys/prctl.h>
 
 using android::BinderCallType;
+using android::CallingIdentity;
 using android::defaultServiceManager;
 using android::getCurrentServingCall;
+using android::getCurrentServingCallIdentity;
 using android::getService;
 using android::OK;
 using android::sp;
@@ -111,6 +113,9 @@ public:
                   << " with tid: " << gettid() << " calling " << (doCallHidl ? "HIDL" : "AIDL");
         CHECK_EQ(BinderCallType::HWBINDER, getCurrentServingCall())
                 << " before call " << getStackPointerDebugInfo();
+        CHECK_EQ(BinderCallType::HWBINDER, getCurrentServingCallIdentity().callType);
+        CHECK_EQ(android::hardware::IPCThreadState::self()->getCallingPid(),
+                 getCurrentServingCallIdentity().pid);
         if (idx > 0) {
             if (doCallHidl) {
                 callHidl(otherId, idx - 1);
@@ -139,6 +144,9 @@ public:
                   << " with tid: " << gettid() << " calling " << (doCallHidl ? "HIDL" : "AIDL");
         CHECK_EQ(BinderCallType::BINDER, getCurrentServingCall())
                 << " before call " << getStackPointerDebugInfo();
+        CHECK_EQ(BinderCallType::BINDER, getCurrentServingCallIdentity().callType);
+        CHECK_EQ(android::IPCThreadState::self()->getCallingPid(),
+                 getCurrentServingCallIdentity().pid);
         if (idx > 0) {
             if (doCallHidl) {
                 callHidl(otherId, idx - 1);
@@ -170,6 +178,10 @@ TEST(BinderThreadState, DoesntInitializeBinderDriver) {
         EXPECT_EQ(nullptr, android::hardware::IPCThreadState::selfOrNull());
 
         (void)getCurrentServingCall();
+        CallingIdentity identity = getCurrentServingCallIdentity();
+        EXPECT_EQ(BinderCallType::NONE, identity.callType);
+        EXPECT_EQ(getpid(), identity.pid);
+        EXPECT_EQ(getuid(), identity.uid);
 
         EXPECT_EQ(nullptr, android::IPCThreadState::selfOrNull());
         EXPECT_EQ(nullptr, android::hardware::IPCThreadState::selfOrNull());
@@ -22,8 +22,12 @@
 #include <dirent.h>
 #include <errno.h>
 #include <inttypes.h>
+#include <string.h>
+#include <sys/syscall.h>
 #include <sys/sysinfo.h>
+#include <unistd.h>
 
+#include <atomic>
 #include <mutex>
 #include <numeric>
 #include <optional>
@@ -63,6 +67,27 @@ static unique_fd gConcurrentMapFd;
 static unique_fd gUidLastUpdateMapFd;
 static unique_fd gPidTisMapFd;
 
+// Entries read from a map by readMap(). The buffers are kept across calls, since BatteryStats
+// polls the uid maps frequently and they can hold thousands of entries.
+template <typename Key, typename Val>
+struct MapEntries {
+    std::mutex mutex;
+    std::vector<Key> keys;
+    // valsPerKey values for each key: one per CPU for per-CPU maps.
+    std::vector<Val> vals;
+    size_t size = 0;
+};
+
+static MapEntries<time_key_t, tis_val_t> gTisEntries;
+static MapEntries<time_key_t, concurrent_val_t> gConcurrentEntries;
+static MapEntries<uint32_t, uint64_t> gUidLastUpdateEntries;
+
+// Number of entries read by each BPF_MAP_LOOKUP_BATCH call.
+static constexpr uint32_t kBatchSize = 256;
+// Hash map batches hold whole buckets, so a batch may need to grow up to this size.
+static constexpr uint32_t kMaxBatchSize = 16384;
+static std::atomic<bool> gBatchLookupUnsupported = false;
+
 static std::optional<std::vector<uint32_t>> readNumbersFromFile(const std::string &path) {
     std::string data;
 
@@ -79,6 +104,77 @@ static std::optional<std::vector<uint32_t>> readNumbersFromFile(const std::strin
     return ret;
 }
 
+template <typename Key, typename Val>
+static void reserveMapEntries(MapEntries<Key, Val> *entries, size_t count, uint32_t valsPerKey) {
+    if (entries->keys.size() < count) {
+        entries->keys.resize(count);
+        entries->vals.resize(count * valsPerKey);
+    }
+}
+
+// Reads all the entries of a map with BPF_MAP_LOOKUP_BATCH, kBatchSize at a time. Returns
+// std::nullopt if the kernel doesn't support it, false on other errors.
+template <typename Key, typename Val>
+static std::optional<bool> readMapBatched(const unique_fd &fd, uint32_t valsPerKey,
+                                          MapEntries<Key, Val> *entries) {
+    // Opaque position in the map: a bucket index for hash maps, a key for arrays.
+    Key inBatch, outBatch;
+    static_assert(sizeof(Key) >= sizeof(uint32_t));
+    bool first = true;
+    uint32_t batchSize = kBatchSize;
+    while (true) {
+        reserveMapEntries(entries, entries->size + batchSize, valsPerKey);
+        union bpf_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.batch.in_batch = first ? 0 : reinterpret_cast<uintptr_t>(&inBatch);
+        attr.batch.out_batch = reinterpret_cast<uintptr_t>(&outBatch);
+        attr.batch.keys = reinterpret_cast<uintptr_t>(&entries->keys[entries->size]);
+        attr.batch.values =
+                reinterpret_cast<uintptr_t>(&entries->vals[entries->size * valsPerKey]);
+        attr.batch.count = batchSize;
+        attr.batch.map_fd = fd.get();
+        int ret = syscall(__NR_bpf, BPF_MAP_LOOKUP_BATCH, &attr, sizeof(attr));
+        if (ret && errno == ENOSPC && attr.batch.count == 0) {
+            // The next bucket doesn't fit in a batch of this size.
+            if (batchSize >= kMaxBatchSize) return false;
+            batchSize *= 2;
+            continue;
+        }
+        if (ret && errno != ENOENT) {
+            if (first && (errno == EINVAL || errno == ENOTSUP || errno == ENOSYS)) {
+                return std::nullopt;
+            }
+            return false;
+        }
+        entries->size += attr.batch.count;
+        if (ret) return true; // ENOENT: no more entries.
+        inBatch = outBatch;
+        first = false;
+    }
+}
+
+// Reads all the entries of the map behind fd into entries, with valsPerKey values per key.
+// Returns false on error.
+template <typename Key, typename Val>
+static bool readMap(const unique_fd &fd, uint32_t valsPerKey, MapEntries<Key, Val> *entries) {
+    entries->size = 0;
+    if (!gBatchLookupUnsupported) {
+        auto ret = readMapBatched(fd, valsPerKey, entries);
+        if (ret.has_value()) return *ret;
+        gBatchLookupUnsupported = true;
+        entries->size = 0;
+    }
+
+    Key key, prevKey;
+    if (getFirstMapKey(fd, &key)) return errno == ENOENT;
+    do {
+        reserveMapEntries(entries, entries->size + 1, valsPerKey);
+        if (findMapEntry(fd, &key, &entries->vals[entries->size * valsPerKey])) return false;
+        entries->keys[entries->size++] = key;
+    } while (prevKey = key, !getNextMapKey(fd, &prevKey, &key));
+    return errno == ENOENT;
+}
+
 static int isPolicyFile(const struct dirent *d) {
     return android::base::StartsWith(d->d_name, "policy");
 }
@@ -337,10 +433,30 @@ std::optional<std::vector<std::vector<uint64_t>>> getUidCpuFreqTimes(uint32_t ui
     return out;
 }
 
+// Reads the last update times of all uids, for uidUpdatedSince.
+static std::optional<std::unordered_map<uint32_t, uint64_t>> getUidLastUpdates() {
+    std::lock_guard<std::mutex> guard(gUidLastUpdateEntries.mutex);
+    if (!readMap(gUidLastUpdateMapFd, 1, &gUidLastUpdateEntries)) return {};
+    std::unordered_map<uint32_t, uint64_t> lastUpdates;
+    lastUpdates.reserve(gUidLastUpdateEntries.size);
+    for (size_t i = 0; i < gUidLastUpdateEntries.size; ++i) {
+        lastUpdates.emplace(gUidLastUpdateEntries.keys[i], gUidLastUpdateEntries.vals[i]);
+    }
+    return lastUpdates;
+}
+
 static std::optional<bool> uidUpdatedSince(uint32_t uid, uint64_t lastUpdate,
-                                           uint64_t *newLastUpdate) {
+                                           uint64_t *newLastUpdate,
+                                           const std::unordered_map<uint32_t, uint64_t>
+                                                   &uidLastUpdates) {
     uint64_t uidLastUpdate;
-    if (findMapEntry(gUidLastUpdateMapFd, &uid, &uidLastUpdate)) return {};
+    auto it = uidLastUpdates.find(uid);
+    if (it != uidLastUpdates.end()) {
+        uidLastUpdate = it->second;
+    } else if (findMapEntry(gUidLastUpdateMapFd, &uid, &uidLastUpdate)) {
+        // The uid may have run for the first time since uidLastUpdates was read.
+        return {};
+    }
     // Updates that occurred during the previous read may have been missed. To mitigate
     // this, don't ignore entries updated up to 1s before *lastUpdate
     constexpr uint64_t NSEC_PER_SEC = 1000000000;
@@ -366,42 +482,47 @@ getUidsCpuFreqTimes() {
 std::optional<std::unordered_map<uint32_t, std::vector<std::vector<uint64_t>>>>
 getUidsUpdatedCpuFreqTimes(uint64_t *lastUpdate) {
     if (!gInitialized && !initGlobals()) return {};
-    time_key_t key, prevKey;
     std::unordered_map<uint32_t, std::vector<std::vector<uint64_t>>> map;
-    if (getFirstMapKey(gTisMapFd, &key)) {
-        if (errno == ENOENT) return map;
-        return std::nullopt;
+
+    std::lock_guard<std::mutex> guard(gTisEntries.mutex);
+    if (!readMap(gTisMapFd, gNCpus, &gTisEntries)) return {};
+    if (gTisEntries.size == 0) return map;
+
+    std::unordered_map<uint32_t, uint64_t> uidLastUpdates;
+    if (lastUpdate) {
+        auto lastUpdates = getUidLastUpdates();
+        if (!lastUpdates.has_value()) return {};
+        uidLastUpdates = std::move(*lastUpdates);
     }
 
     std::vector<std::vector<uint64_t>> mapFormat;
     for (const auto &freqList : gPolicyFreqs) mapFormat.emplace_back(freqList.size(), 0);
 
     uint64_t newLastUpdate = lastUpdate ? *lastUpdate : 0;
-    std::vector<tis_val_t> vals(gNCpus);
-    do {
+    for (size_t k = 0; k < gTisEntries.size; ++k) {
+        const time_key_t &key = gTisEntries.keys[k];
+        const tis_val_t *vals = &gTisEntries.vals[k * gNCpus];
         if (lastUpdate) {
-            auto uidUpdated = uidUpdatedSince(key.uid, *lastUpdate, &newLastUpdate);
+            auto uidUpdated = uidUpdatedSince(key.uid, *lastUpdate, &newLastUpdate,
+                                              uidLastUpdates);
             if (!uidUpdated.has_value()) return {};
             if (!*uidUpdated) continue;
         }
-        if (findMapEntry(gTisMapFd, &key, vals.data())) return {};
-        if (map.find(key.uid) == map.end()) map.emplace(key.uid, mapFormat);
+        auto &times = map.try_emplace(key.uid, mapFormat).first->second;
 
         auto offset = key.bucket * FREQS_PER_ENTRY;
         auto nextOffset = (key.bucket + 1) * FREQS_PER_ENTRY;
         for (uint32_t i = 0; i < gNPolicies; ++i) {
             if (offset >= gPolicyFreqs[i].size()) continue;
-            auto begin = map[key.uid][i].begin() + offset;
+            auto begin = times[i].begin() + offset;
             auto end = nextOffset < gPolicyFreqs[i].size() ? begin + FREQS_PER_ENTRY :
-                map[key.uid][i].end();
+                times[i].end();
             for (const auto &cpu : gPolicyCpus[i]) {
                 std::transform(begin, end, std::begin(vals[gCpuIndexMap[cpu]].ar), begin,
                                std::plus<uint64_t>());
             }
         }
-        prevKey = key;
-    } while (prevKey = key, !getNextMapKey(gTisMapFd, &prevKey, &key));
-    if (errno != ENOENT) return {};
+    }
     if (lastUpdate && newLastUpdate > *lastUpdate) *lastUpdate = newLastUpdate;
     return map;
 }
@@ -478,35 +599,42 @@ std::optional<std::unordered_map<uint32_t, concurrent_time_t>> getUidsConcurrent
 std::optional<std::unordered_map<uint32_t, concurrent_time_t>> getUidsUpdatedConcurrentTimes(
         uint64_t *lastUpdate) {
     if (!gInitialized && !initGlobals()) return {};
-    time_key_t key, prevKey;
     std::unordered_map<uint32_t, concurrent_time_t> ret;
-    if (getFirstMapKey(gConcurrentMapFd, &key)) {
-        if (errno == ENOENT) return ret;
-        return {};
+
+    std::unique_lock<std::mutex> guard(gConcurrentEntries.mutex);
+    if (!readMap(gConcurrentMapFd, gNCpus, &gConcurrentEntries)) return {};
+    if (gConcurrentEntries.size == 0) return ret;
+
+    std::unordered_map<uint32_t, uint64_t> uidLastUpdates;
+    if (lastUpdate) {
+        auto lastUpdates = getUidLastUpdates();
+        if (!lastUpdates.has_value()) return {};
+        uidLastUpdates = std::move(*lastUpdates);
     }
 
     concurrent_time_t retFormat = {.active = std::vector<uint64_t>(gNCpus, 0)};
     for (const auto &cpuList : gPolicyCpus) retFormat.policy.emplace_back(cpuList.size(), 0);
 
-    std::vector<concurrent_val_t> vals(gNCpus);
     std::vector<uint64_t>::iterator activeBegin, activeEnd, policyBegin, policyEnd;
 
     uint64_t newLastUpdate = lastUpdate ? *lastUpdate : 0;
-    do {
+    for (size_t k = 0; k < gConcurrentEntries.size; ++k) {
+        const time_key_t &key = gConcurrentEntries.keys[k];
+        const concurrent_val_t *vals = &gConcurrentEntries.vals[k * gNCpus];
         if (key.bucket > (gNCpus - 1) / CPUS_PER_ENTRY) return {};
         if (lastUpdate) {
-            auto uidUpdated = uidUpdatedSince(key.uid, *lastUpdate, &newLastUpdate);
+            auto uidUpdated = uidUpdatedSince(key.uid, *lastUpdate, &newLastUpdate,
+                                              uidLastUpdates);
             if (!uidUpdated.has_value()) return {};
             if (!*uidUpdated) continue;
         }
-        if (findMapEntry(gConcurrentMapFd, &key, vals.data())) return {};
-        if (ret.find(key.uid) == ret.end()) ret.emplace(key.uid, retFormat);
+        auto &times = ret.try_emplace(key.uid, retFormat).first->second;
 
         auto offset = key.bucket * CPUS_PER_ENTRY;
         auto nextOffset = (key.bucket + 1) * CPUS_PER_ENTRY;
 
-        activeBegin = ret[key.uid].active.begin();
-        activeEnd = nextOffset < gNCpus ? activeBegin + CPUS_PER_ENTRY : ret[key.uid].active.end();
+        activeBegin = times.active.begin() + offset;
+        activeEnd = nextOffset < gNCpus ? activeBegin + CPUS_PER_ENTRY : times.active.end();
 
         for (uint32_t cpu = 0; cpu < gNCpus; ++cpu) {
             std::transform(activeBegin, activeEnd, std::begin(vals[cpu].active), activeBegin,
@@ -515,17 +643,17 @@ std::optional<std::unordered_map<uint32_t, concurrent_time_t>> getUidsUpdatedCon
 
         for (uint32_t policy = 0; policy < gNPolicies; ++policy) {
             if (offset >= gPolicyCpus[policy].size()) continue;
-            policyBegin = ret[key.uid].policy[policy].begin() + offset;
+            policyBegin = times.policy[policy].begin() + offset;
             policyEnd = nextOffset < gPolicyCpus[policy].size() ? policyBegin + CPUS_PER_ENTRY
-                                                                : ret[key.uid].policy[policy].end();
+                                                                : times.policy[policy].end();
 
             for (const auto &cpu : gPolicyCpus[policy]) {
                 std::transform(policyBegin, policyEnd, std::begin(vals[gCpuIndexMap[cpu]].policy),
                                policyBegin, std::plus<uint64_t>());
             }
         }
-    } while (prevKey = key, !getNextMapKey(gConcurrentMapFd, &prevKey, &key));
-    if (errno != ENOENT) return {};
+    }
+    guard.unlock();
     for (const auto &[key, value] : ret) {
         if (!verifyConcurrentTimes(value)) {
             auto val = getUidConcurrentTimes(key, false);
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ftl/arena.h>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace android::test {
+
+using ftl::Arena;
+using ftl::ArenaAllocator;
+using ftl::ArenaVector;
+
+// Keep in sync with example usage in header file.
+TEST(Arena, Example) {
+  ftl::Arena arena;
+
+  ftl::ArenaVector<int> vector(arena);
+  vector.reserve(100);
+  vector.push_back(42);
+  EXPECT_GE(arena.bytes_used(), 100 * sizeof(int));
+
+  vector = ftl::ArenaVector<int>(arena);
+  arena.reset();
+  EXPECT_EQ(arena.bytes_used(), 0u);
+}
+
+TEST(Arena, Alignment) {
+  Arena arena(64);
+
+  for (std::size_t alignment = 1; alignment <= 32; alignment *= 2) {
+    EXPECT_TRUE(arena.allocate(1, 1));
+
+    const auto address = reinterpret_cast<std::uintptr_t>(arena.allocate(3, alignment));
+    EXPECT_EQ(address % alignment, 0u);
+  }
+}
+
+TEST(Arena, Blocks) {
+  Arena arena(64);
+  EXPECT_EQ(arena.bytes_reserved(), 0u);
+
+  auto* const first = static_cast<std::byte*>(arena.allocate(32, 1));
+  auto* const second = static_cast<std::byte*>(arena.allocate(32, 1));
+  EXPECT_EQ(second, first + 32);
+  EXPECT_EQ(arena.bytes_used(), 64u);
+  EXPECT_EQ(arena.bytes_reserved(), 64u);
+
+  // Allocations that do not fit get a block of their own.
+  EXPECT_TRUE(arena.allocate(1000, 1));
+  EXPECT_GE(arena.bytes_reserved(), 1064u);
+
+  // Blocks are reused after reset.
+  const std::size_t reserved = arena.bytes_reserved();
+  arena.reset();
+  EXPECT_EQ(arena.allocate(32, 1), first);
+  EXPECT_TRUE(arena.allocate(1000, 1));
+  EXPECT_EQ(arena.bytes_reserved(), reserved);
+
+  arena.release();
+  EXPECT_EQ(arena.bytes_used(), 0u);
+  EXPECT_EQ(arena.bytes_reserved(), 0u);
+}
+
+TEST(Arena, Vector) {
+  Arena arena;
+  ArenaVector<std::string> vector(arena);
+
+  for (int i = 0; i < 1000; ++i) {
+    vector.push_back(std::to_string(i));
+  }
+  EXPECT_EQ(vector[999], "999");
+  EXPECT_EQ(&vector.get_allocator().arena(), &arena);
+
+  // Moving takes the allocator along.
+  Arena other;
+  ArenaVector<std::string> moved(other);
+  moved = std::move(vector);
+  EXPECT_EQ(&moved.get_allocator().arena(), &arena);
+  EXPECT_EQ(moved.size(), 1000u);
+}
+
+TEST(Arena, Rebind) {
+  Arena arena;
+  std::map<int, int, std::less<int>, ArenaAllocator<std::pair<const int, int>>> map(arena);
+
+  for (int i = 0; i < 100; ++i) {
+    map.emplace(i, i * i);
+  }
+  EXPECT_EQ(map.at(9), 81);
+  EXPECT_GE(arena.bytes_used(), 100 * sizeof(std::pair<const int, int>));
+
+  EXPECT_EQ(ArenaAllocator<int>(arena), ArenaAllocator<char>(arena));
+  Arena other;
+  EXPECT_NE(ArenaAllocator<int>(arena), ArenaAllocator<int>(other));
+}
+
+}  // namespace android::test
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <ftl/mpsc_queue.h>
+#include <ftl/seq_lock.h>
+#include <ftl/spsc_queue.h>
+
+#include <cstdint>
+#include <thread>
+
+namespace android {
+namespace {
+
+// Thread 0 pushes and thread 1 pops, so items per second is the throughput of the queue.
+void BM_SpscQueue(benchmark::State& state) {
+  static ftl::SpscQueue<std::int64_t, 1024> queue;
+
+  std::int64_t i = 0;
+  if (state.thread_index() == 0) {
+    for (auto _ : state) {
+      while (!queue.try_push(i)) std::this_thread::yield();
+      ++i;
+    }
+  } else {
+    for (auto _ : state) {
+      auto value = queue.try_pop();
+      while (!value) {
+        std::this_thread::yield();
+        value = queue.try_pop();
+      }
+      benchmark::DoNotOptimize(*value);
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SpscQueue)->Threads(2)->UseRealTime();
+
+struct Node : ftl::MpscQueueNode<Node> {};
+
+// Thread 0 pops what the other threads push. Nodes are allocated by producers and freed by the
+// consumer, as callers typically do.
+void BM_MpscQueue(benchmark::State& state) {
+  static ftl::MpscQueue<Node> queue;
+
+  if (state.thread_index() == 0) {
+    const int producers = state.threads() - 1;
+    for (auto _ : state) {
+      for (int i = 0; i < producers; ++i) {
+        Node* node;
+        while (!(node = queue.pop())) std::this_thread::yield();
+        delete node;
+      }
+    }
+  } else {
+    for (auto _ : state) {
+      queue.push(new Node);
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MpscQueue)->ThreadRange(2, 8)->UseRealTime();
+
+struct Snapshot {
+  std::int64_t vsync_time;
+  std::int64_t vsync_period;
+  std::int64_t phase;
+};
+
+// Every thread loads, and thread 0 also stores once every 64 loads.
+void BM_SeqLock(benchmark::State& state) {
+  static ftl::SeqLock<Snapshot> lock;
+
+  std::int64_t i = 0;
+  for (auto _ : state) {
+    if (state.thread_index() == 0 && ++i % 64 == 0) {
+      lock.store({i, 16'666'667, 0});
+    }
+    benchmark::DoNotOptimize(lock.load());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SeqLock)->ThreadRange(1, 8)->UseRealTime();
+
+}  // namespace
+}  // namespace android
+
+BENCHMARK_MAIN();
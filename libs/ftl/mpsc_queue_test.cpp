@@ -0,0 +1,116 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ftl/mpsc_queue.h>
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace android::test {
+
+using ftl::MpscQueue;
+using ftl::MpscQueueNode;
+
+namespace {
+
+struct Event : MpscQueueNode<Event> {
+  explicit Event(int id) : id(id) {}
+  int id;
+};
+
+}  // namespace
+
+// Keep in sync with example usage in header file.
+TEST(MpscQueue, Example) {
+  ftl::MpscQueue<Event> queue;
+  Event a(1), b(2);
+
+  queue.push(&a);
+  queue.push(&b);
+
+  EXPECT_EQ(queue.pop(), &a);
+  EXPECT_EQ(queue.pop(), &b);
+  EXPECT_EQ(queue.pop(), nullptr);
+}
+
+TEST(MpscQueue, Push) {
+  MpscQueue<Event> queue;
+  EXPECT_TRUE(queue.empty());
+
+  Event a(1), b(2), c(3);
+  EXPECT_TRUE(queue.push(&a));
+  EXPECT_FALSE(queue.push(&b));
+  EXPECT_FALSE(queue.empty());
+
+  EXPECT_EQ(queue.pop(), &a);
+
+  // The consumer holds b, so producers see an empty queue.
+  EXPECT_TRUE(queue.push(&c));
+
+  EXPECT_EQ(queue.pop(), &b);
+  EXPECT_EQ(queue.pop(), &c);
+  EXPECT_TRUE(queue.empty());
+
+  // Popped elements can be pushed again.
+  EXPECT_TRUE(queue.push(&a));
+  EXPECT_EQ(queue.pop(), &a);
+  EXPECT_EQ(queue.pop(), nullptr);
+}
+
+TEST(MpscQueue, Threads) {
+  constexpr int kProducers = 4;
+  constexpr int kCount = 10'000;
+
+  struct Element : MpscQueueNode<Element> {
+    int producer = 0;
+    int index = 0;
+  };
+
+  std::vector<std::vector<Element>> elements(kProducers, std::vector<Element>(kCount));
+  MpscQueue<Element> queue;
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&queue, &elements, p] {
+      for (int i = 0; i < kCount; ++i) {
+        Element& element = elements[p][i];
+        element.producer = p;
+        element.index = i;
+        queue.push(&element);
+      }
+    });
+  }
+
+  // Elements of each producer are popped in the order they were pushed.
+  std::vector<int> next(kProducers, 0);
+  for (int popped = 0; popped < kProducers * kCount;) {
+    const Element* element = queue.pop();
+    if (!element) {
+      std::this_thread::yield();
+      continue;
+    }
+    ASSERT_EQ(element->index, next[element->producer]++);
+    ++popped;
+  }
+
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  EXPECT_TRUE(queue.empty());
+}
+
+}  // namespace android::test
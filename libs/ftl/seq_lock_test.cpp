@@ -0,0 +1,106 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ftl/seq_lock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace android::test {
+
+using ftl::SeqLock;
+
+namespace {
+
+struct Timeline {
+  int64_t vsync_time;
+  int64_t vsync_period;
+};
+
+}  // namespace
+
+// Keep in sync with example usage in header file.
+TEST(SeqLock, Example) {
+  ftl::SeqLock<Timeline> timeline({0, 16'666'667});
+
+  timeline.store({16'666'667, 16'666'667});
+
+  const Timeline snapshot = timeline.load();
+  EXPECT_EQ(snapshot.vsync_time, 16'666'667);
+  EXPECT_EQ(snapshot.vsync_period, 16'666'667);
+}
+
+TEST(SeqLock, Default) {
+  const SeqLock<int> lock;
+  EXPECT_EQ(lock.load(), 0);
+
+  int value = -1;
+  EXPECT_TRUE(lock.try_load(&value));
+  EXPECT_EQ(value, 0);
+}
+
+TEST(SeqLock, OddSize) {
+  struct Bytes {
+    char bytes[13];
+  };
+
+  SeqLock<Bytes> lock;
+  lock.store({"hello, world"});
+  EXPECT_STREQ(lock.load().bytes, "hello, world");
+}
+
+TEST(SeqLock, Threads) {
+  // Each stored value repeats the same number, so a torn snapshot would mix two numbers.
+  struct Snapshot {
+    uint64_t values[8];
+  };
+
+  SeqLock<Snapshot> lock;
+  std::atomic_bool done = false;
+
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&] {
+      uint64_t last = 0;
+      while (!done.load(std::memory_order_relaxed)) {
+        const Snapshot snapshot = lock.load();
+        for (uint64_t value : snapshot.values) {
+          ASSERT_EQ(value, snapshot.values[0]);
+        }
+        // Snapshots never go back in time.
+        ASSERT_GE(snapshot.values[0], last);
+        last = snapshot.values[0];
+      }
+    });
+  }
+
+  for (uint64_t value = 1; value <= 100'000; ++value) {
+    Snapshot snapshot;
+    for (uint64_t& v : snapshot.values) v = value;
+    lock.store(snapshot);
+  }
+  done = true;
+
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(lock.load().values[0], 100'000u);
+}
+
+}  // namespace android::test
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <ftl/small_map.h>
+
+#include <cstdint>
+#include <string>
+
+namespace android {
+namespace {
+
+// Keys like display IDs, which mostly differ in their high bits.
+std::uint64_t makeKey(std::int64_t i) {
+  return static_cast<std::uint64_t>(i) << 32 | 0x1234;
+}
+
+template <typename Map>
+void BM_Get(benchmark::State& state) {
+  const std::int64_t size = state.range(0);
+
+  Map map;
+  for (std::int64_t i = 0; i < size; ++i) {
+    map.try_emplace(makeKey(i), i);
+  }
+
+  std::int64_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(map.get(makeKey(i)));
+    if (++i == size) i = 0;
+  }
+}
+BENCHMARK(BM_Get<ftl::SmallMap<std::uint64_t, std::int64_t, 4>>)->RangeMultiplier(4)->Range(1, 1024);
+
+// Lookups in a map with string keys, which always use linear search.
+void BM_GetString(benchmark::State& state) {
+  const std::int64_t size = state.range(0);
+
+  ftl::SmallMap<std::string, std::int64_t, 4> map;
+  for (std::int64_t i = 0; i < size; ++i) {
+    map.try_emplace(std::to_string(makeKey(i)), i);
+  }
+
+  const std::string key = std::to_string(makeKey(size - 1));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(map.get(key));
+  }
+}
+BENCHMARK(BM_GetString)->RangeMultiplier(4)->Range(1, 1024);
+
+template <typename Map>
+void BM_EmplaceAndErase(benchmark::State& state) {
+  const std::int64_t size = state.range(0);
+
+  for (auto _ : state) {
+    Map map;
+    for (std::int64_t i = 0; i < size; ++i) {
+      map.try_emplace(makeKey(i), i);
+    }
+    for (std::int64_t i = 0; i < size; ++i) {
+      map.erase(makeKey(i));
+    }
+    benchmark::DoNotOptimize(map);
+  }
+}
+BENCHMARK(BM_EmplaceAndErase<ftl::SmallMap<std::uint64_t, std::int64_t, 4>>)
+    ->RangeMultiplier(4)
+    ->Range(1, 1024);
+
+}  // namespace
+}  // namespace android
+
+BENCHMARK_MAIN();
@@ -442,4 +442,42 @@ TEST(SmallMap, KeyEqual) {
   EXPECT_EQ(map, SmallMap(ftl::init::map<int, char, KeyEqual>(1, '1')(2, '2')));
 }
 
+TEST(SmallMap, HashIndex) {
+  constexpr int kSize = 3 * SmallMap<int, int, 4>::kIndexThreshold;
+
+  SmallMap<int, int, 4> map;
+  for (int i = 0; i < kSize; ++i) {
+    // Spread the keys out, so that they do not only differ in their low bits.
+    EXPECT_TRUE(map.try_emplace(i << 20, i).second);
+    EXPECT_FALSE(map.try_emplace(i << 20, -i).second);
+  }
+  EXPECT_EQ(map.size(), static_cast<std::size_t>(kSize));
+
+  for (int i = 0; i < kSize; ++i) {
+    EXPECT_EQ(map.get(i << 20), i);
+    EXPECT_EQ(map.find(i << 20)->second, i);
+  }
+  EXPECT_FALSE(map.contains(1));
+  EXPECT_EQ(map.find(kSize << 20), map.end());
+
+  // Erasing moves the last mapping, which must still be found.
+  for (int i = 0; i < kSize; i += 2) {
+    EXPECT_TRUE(map.erase(i << 20));
+    EXPECT_FALSE(map.erase(i << 20));
+  }
+  EXPECT_EQ(map.size(), static_cast<std::size_t>(kSize / 2));
+
+  for (int i = 0; i < kSize; ++i) {
+    EXPECT_EQ(map.contains(i << 20), i % 2 == 1);
+  }
+
+  EXPECT_NE(map.try_replace(1 << 20, -1), map.end());
+  EXPECT_EQ(map.get(1 << 20), -1);
+
+  map.clear();
+  EXPECT_FALSE(map.contains(1 << 20));
+  EXPECT_TRUE(map.try_emplace(1 << 20, 1).second);
+  EXPECT_EQ(map.get(1 << 20), 1);
+}
+
 }  // namespace android::test
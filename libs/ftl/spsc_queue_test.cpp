@@ -0,0 +1,108 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ftl/spsc_queue.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace android::test {
+
+using ftl::SpscQueue;
+
+// Keep in sync with example usage in header file.
+TEST(SpscQueue, Example) {
+  ftl::SpscQueue<int, 4> queue;
+  EXPECT_TRUE(queue.empty());
+
+  EXPECT_TRUE(queue.try_push(1));
+  EXPECT_TRUE(queue.try_emplace(2));
+  EXPECT_EQ(queue.size(), 2u);
+
+  EXPECT_EQ(queue.try_pop(), 1);
+  EXPECT_EQ(queue.try_pop(), 2);
+  EXPECT_FALSE(queue.try_pop());
+}
+
+TEST(SpscQueue, Full) {
+  SpscQueue<int, 2> queue;
+  EXPECT_TRUE(queue.try_push(1));
+  EXPECT_TRUE(queue.try_push(2));
+  EXPECT_FALSE(queue.try_push(3));
+  EXPECT_EQ(queue.size(), 2u);
+
+  EXPECT_EQ(queue.try_pop(), 1);
+  EXPECT_TRUE(queue.try_push(3));
+
+  EXPECT_EQ(queue.try_pop(), 2);
+  EXPECT_EQ(queue.try_pop(), 3);
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(SpscQueue, Front) {
+  SpscQueue<std::string, 4> queue;
+  EXPECT_EQ(queue.front(), nullptr);
+
+  EXPECT_TRUE(queue.try_emplace(3u, 'a'));
+  ASSERT_NE(queue.front(), nullptr);
+  EXPECT_EQ(*queue.front(), "aaa");
+
+  queue.front()->append("b");
+  EXPECT_EQ(queue.try_pop(), "aaab");
+  EXPECT_EQ(queue.front(), nullptr);
+}
+
+TEST(SpscQueue, Destroy) {
+  const auto counter = std::make_shared<int>();
+  {
+    SpscQueue<std::shared_ptr<int>, 4> queue;
+    EXPECT_TRUE(queue.try_push(counter));
+    EXPECT_TRUE(queue.try_push(counter));
+    EXPECT_TRUE(queue.try_pop());
+    EXPECT_EQ(counter.use_count(), 2);
+  }
+  EXPECT_EQ(counter.use_count(), 1);
+}
+
+TEST(SpscQueue, Threads) {
+  constexpr int kCount = 100'000;
+  SpscQueue<std::unique_ptr<int>, 16> queue;
+
+  std::thread producer([&queue] {
+    for (int i = 0; i < kCount; ++i) {
+      auto value = std::make_unique<int>(i);
+      while (!queue.try_push(std::move(value))) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  for (int i = 0; i < kCount; ++i) {
+    auto value = queue.try_pop();
+    while (!value) {
+      std::this_thread::yield();
+      value = queue.try_pop();
+    }
+    ASSERT_EQ(**value, i);
+  }
+
+  producer.join();
+  EXPECT_TRUE(queue.empty());
+}
+
+}  // namespace android::test
@@ -392,6 +392,12 @@ void GraphicsEnv::setGpuStats(const std::string& driverPackageName,
     mGpuStats.driverBuildTime = driverBuildTime;
     mGpuStats.appPackageName = appPackageName;
     mGpuStats.vulkanVersion = vulkanVersion;
+
+    mSentTargetStatsMask = 0;
+    mSentVulkanApiVersion = 0;
+    mSentVulkanDeviceFeatures = 0;
+    mSentVulkanInstanceExtensions.clear();
+    mSentVulkanDeviceExtensions.clear();
 }
 
 void GraphicsEnv::setDriverToLoad(GpuStatsInfo::Driver driver) {
@@ -523,9 +529,68 @@ void GraphicsEnv::setTargetStatsArray(const GpuStatsInfo::Stats stats, const uin
     if (!readyToSendGpuStatsLocked()) return;
 
     const sp<IGpuService> gpuService = getGpuService();
-    if (gpuService) {
-        gpuService->setTargetStatsArray(mGpuStats.appPackageName, mGpuStats.driverVersionCode,
-                                        stats, values, valueCount);
+    if (!gpuService) return;
+
+    std::vector<uint64_t> unsentValues;
+    if (!takeUnsentTargetStatsLocked(stats, values, valueCount, &unsentValues)) return;
+
+    gpuService->setTargetStatsArray(mGpuStats.appPackageName, mGpuStats.driverVersionCode, stats,
+                                    unsentValues.data(),
+                                    static_cast<uint32_t>(unsentValues.size()));
+}
+
+bool GraphicsEnv::takeUnsentTargetStatsLocked(const GpuStatsInfo::Stats stats,
+                                              const uint64_t* values, const uint32_t valueCount,
+                                              std::vector<uint64_t>* outValues) {
+    // Keep in sync with GpuStats::insertTargetStatsArray in gpuservice.
+    switch (stats) {
+        case GpuStatsInfo::Stats::VULKAN_INSTANCE_EXTENSION:
+        case GpuStatsInfo::Stats::VULKAN_DEVICE_EXTENSION: {
+            // GpuService keeps the set of extensions seen, so only send the new ones.
+            std::unordered_set<uint64_t>& sent =
+                    stats == GpuStatsInfo::Stats::VULKAN_INSTANCE_EXTENSION
+                    ? mSentVulkanInstanceExtensions
+                    : mSentVulkanDeviceExtensions;
+            for (uint32_t i = 0; i < valueCount; i++) {
+                if (sent.insert(values[i]).second) {
+                    outValues->push_back(values[i]);
+                }
+            }
+            return !outValues->empty();
+        }
+        case GpuStatsInfo::Stats::CREATED_VULKAN_API_VERSION: {
+            // GpuService keeps the last version.
+            if (valueCount == 0) return false;
+            const uint32_t version = uint32_t(values[valueCount - 1] & 0xffffffff);
+            if ((mSentTargetStatsMask & (1u << stats)) && version == mSentVulkanApiVersion) {
+                return false;
+            }
+            mSentTargetStatsMask |= 1u << stats;
+            mSentVulkanApiVersion = version;
+            outValues->push_back(version);
+            return true;
+        }
+        case GpuStatsInfo::Stats::VULKAN_DEVICE_FEATURES_ENABLED: {
+            // GpuService merges the feature bits.
+            uint64_t features = 0;
+            for (uint32_t i = 0; i < valueCount; i++) {
+                features |= values[i];
+            }
+            if ((mSentTargetStatsMask & (1u << stats)) &&
+                (features & ~mSentVulkanDeviceFeatures) == 0) {
+                return false;
+            }
+            mSentTargetStatsMask |= 1u << stats;
+            mSentVulkanDeviceFeatures |= features;
+            outValues->push_back(features);
+            return true;
+        }
+        default:
+            // GpuService only records that the others happened.
+            if (valueCount == 0 || (mSentTargetStatsMask & (1u << stats))) return false;
+            mSentTargetStatsMask |= 1u << stats;
+            outValues->assign(values, values + valueCount);
+            return true;
     }
 }
 
@@ -744,4 +809,12 @@ void GraphicsEnv::setDebugLayersGLES(const std::string& layers) {
     mDebugLayersGLES = layers;
 }
 
+void GraphicsEnv::setVulkanPipelineCacheDir(const std::string& dir) {
+    mVulkanPipelineCacheDir = dir;
+}
+
+const std::string& GraphicsEnv::getVulkanPipelineCacheDir() {
+    return mVulkanPipelineCacheDir;
+}
+
 } // namespace android
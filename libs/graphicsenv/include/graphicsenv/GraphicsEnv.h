@@ -21,6 +21,7 @@
 
 #include <mutex>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 struct android_namespace_t;
@@ -143,6 +144,14 @@ public:
     // Get the debug layers to load.
     const std::string& getDebugLayersGLES();
 
+    /*
+     * Apis for Vulkan pipeline cache
+     */
+    // Set the directory in which the Vulkan loader persists the pipeline caches of the app.
+    void setVulkanPipelineCacheDir(const std::string& dir);
+    // Get the directory for Vulkan pipeline caches, empty if the loader shouldn't persist them.
+    const std::string& getVulkanPipelineCacheDir();
+
 private:
     // Link updatable driver namespace with llndk and vndk-sp libs.
     bool linkDriverNamespaceLocked(android_namespace_t* destNamespace,
@@ -152,6 +161,10 @@ private:
     bool readyToSendGpuStatsLocked();
     // Send the initial complete GpuStats to GpuService.
     void sendGpuStatsLocked(GpuStatsInfo::Api api, bool isDriverLoaded, int64_t driverLoadingTime);
+    // Copy the target stats values that would change what GpuService recorded for this app into
+    // outValues, and remember them as sent. Returns false if there is nothing to send.
+    bool takeUnsentTargetStatsLocked(GpuStatsInfo::Stats stats, const uint64_t* values,
+                                     uint32_t valueCount, std::vector<uint64_t>* outValues);
 
     GraphicsEnv() = default;
 
@@ -195,6 +208,14 @@ private:
     bool mActivityLaunched = false;
     // Information bookkept for GpuStats.
     GpuStatsInfo mGpuStats;
+    // Target stats already sent to GpuService for the current app and driver. GpuService only
+    // records that most of them happened, so sending them again, e.g. for every context or
+    // swapchain created, would only cost a binder call.
+    uint32_t mSentTargetStatsMask = 0;
+    uint32_t mSentVulkanApiVersion = 0;
+    uint64_t mSentVulkanDeviceFeatures = 0;
+    std::unordered_set<uint64_t> mSentVulkanInstanceExtensions;
+    std::unordered_set<uint64_t> mSentVulkanDeviceExtensions;
 
     /**
      * Debug layers.
@@ -207,6 +228,12 @@ private:
     std::string mLayerPaths;
     // This App's namespace to open native libraries.
     NativeLoaderNamespace* mAppNamespace = nullptr;
+
+    /**
+     * Vulkan pipeline cache.
+     */
+    // Directory for the pipeline caches persisted by the Vulkan loader.
+    std::string mVulkanPipelineCacheDir;
 };
 
 } // namespace android
@@ -24,6 +24,7 @@
 #include <cutils/atomic.h>
 #include <ftl/fake_guard.h>
 #include <gui/BLASTBufferQueue.h>
+#include <gui/BLASTFrameBatcher.h>
 #include <gui/BufferItemConsumer.h>
 #include <gui/BufferQueueConsumer.h>
 #include <gui/BufferQueueCore.h>
@@ -241,6 +242,9 @@ BLASTBufferQueue::BLASTBufferQueue(const std::string& name, const sp<SurfaceCont
 
 BLASTBufferQueue::~BLASTBufferQueue() {
     TransactionCompletedListener::getInstance()->removeQueueStallListener(this);
+    if (mFrameBatcher != nullptr) {
+        mFrameBatcher->removeQueue(this);
+    }
     if (mPendingTransactions.empty()) {
         return;
     }
@@ -248,8 +252,7 @@ BLASTBufferQueue::~BLASTBufferQueue() {
              static_cast<uint32_t>(mPendingTransactions.size()));
     SurfaceComposerClient::Transaction t;
     mergePendingTransactions(&t, std::numeric_limits<uint64_t>::max() /* frameNumber */);
-    // All transactions on our apply token are one-way. See comment on mAppliedLastTransaction
-    t.setApplyToken(mApplyToken).apply(false, true);
+    applyTransactionLocked(&t);
 
     if (mTransactionReadyCallback) {
         mTransactionReadyCallback(mSyncTransaction);
@@ -312,8 +315,7 @@ void BLASTBufferQueue::update(const sp<SurfaceControl>& surface, uint32_t width,
         }
     }
     if (applyTransaction) {
-        // All transactions on our apply token are one-way. See comment on mAppliedLastTransaction
-        t.setApplyToken(mApplyToken).apply(false, true);
+        applyTransactionLocked(&t);
     }
 }
 
@@ -684,9 +686,14 @@ status_t BLASTBufferQueue::acquireNextBufferLocked(
         ATRACE_FORMAT_INSTANT("dropping stale frameNumber: %" PRIu64 " vsyncId: %" PRId64,
                               mPendingFrameTimelines.front().first,
                               mPendingFrameTimelines.front().second.vsyncId);
+        if (mFrameBatcher != nullptr) {
+            mFrameBatcher->cancelFrame(this, mPendingFrameTimelines.front().second.vsyncId);
+        }
         mPendingFrameTimelines.pop();
     }
 
+    int64_t vsyncId = FrameTimelineInfo::INVALID_VSYNC_ID;
+
     if (!mPendingFrameTimelines.empty() &&
         mPendingFrameTimelines.front().first == bufferItem.mFrameNumber) {
         ATRACE_FORMAT_INSTANT("Transaction::setFrameTimelineInfo frameNumber: %" PRIu64
@@ -694,13 +701,13 @@ status_t BLASTBufferQueue::acquireNextBufferLocked(
                               bufferItem.mFrameNumber,
                               mPendingFrameTimelines.front().second.vsyncId);
         t->setFrameTimelineInfo(mPendingFrameTimelines.front().second);
+        vsyncId = mPendingFrameTimelines.front().second.vsyncId;
         mPendingFrameTimelines.pop();
     }
 
     mergePendingTransactions(t, bufferItem.mFrameNumber);
     if (applyTransaction) {
-        // All transactions on our apply token are one-way. See comment on mAppliedLastTransaction
-        t->setApplyToken(mApplyToken).apply(false, true);
+        applyTransactionLocked(t, vsyncId);
         mAppliedLastTransaction = true;
         mLastAppliedFrameNumber = bufferItem.mFrameNumber;
     } else {
@@ -990,6 +997,9 @@ status_t BLASTBufferQueue::setFrameTimelineInfo(uint64_t frameNumber,
                   frameNumber, frameTimelineInfo.vsyncId);
     std::lock_guard _lock{mMutex};
     mPendingFrameTimelines.push({frameNumber, frameTimelineInfo});
+    if (mFrameBatcher != nullptr) {
+        mFrameBatcher->expectFrame(this, frameTimelineInfo.vsyncId);
+    }
     return OK;
 }
 
@@ -1027,8 +1037,7 @@ void BLASTBufferQueue::applyPendingTransactions(uint64_t frameNumber) {
 
     SurfaceComposerClient::Transaction t;
     mergePendingTransactions(&t, frameNumber);
-    // All transactions on our apply token are one-way. See comment on mAppliedLastTransaction
-    t.setApplyToken(mApplyToken).apply(false, true);
+    applyTransactionLocked(&t);
 }
 
 void BLASTBufferQueue::mergePendingTransactions(SurfaceComposerClient::Transaction* t,
@@ -1271,6 +1280,37 @@ void BLASTBufferQueue::setApplyToken(sp<IBinder> applyToken) {
     mApplyToken = std::move(applyToken);
 }
 
+void BLASTBufferQueue::setFrameBatcher(const sp<BLASTFrameBatcher>& batcher) {
+    std::lock_guard _lock{mMutex};
+    if (mFrameBatcher == batcher) {
+        return;
+    }
+    if (mFrameBatcher != nullptr) {
+        mFrameBatcher->removeQueue(this);
+        // Transactions applied on our own token from here on must not overtake the ones still
+        // waiting in the old batch.
+        mFrameBatcher->flush();
+    }
+    mFrameBatcher = batcher;
+    if (mFrameBatcher != nullptr) {
+        std::queue<std::pair<uint64_t, FrameTimelineInfo>> pending = mPendingFrameTimelines;
+        while (!pending.empty()) {
+            mFrameBatcher->expectFrame(this, pending.front().second.vsyncId);
+            pending.pop();
+        }
+    }
+}
+
+void BLASTBufferQueue::applyTransactionLocked(SurfaceComposerClient::Transaction* t,
+                                              int64_t vsyncId) {
+    if (mFrameBatcher != nullptr) {
+        mFrameBatcher->submit(this, vsyncId, t);
+        return;
+    }
+    // All transactions on our apply token are one-way. See comment on mAppliedLastTransaction
+    t->setApplyToken(mApplyToken).apply(false, true);
+}
+
 #if COM_ANDROID_GRAPHICS_LIBGUI_FLAGS(BUFFER_RELEASE_CHANNEL)
 
 BLASTBufferQueue::BufferReleaseReader::BufferReleaseReader(
@@ -1323,6 +1363,15 @@ BLASTBufferQueue::BufferReleaseReader& BLASTBufferQueue::BufferReleaseReader::op
 status_t BLASTBufferQueue::BufferReleaseReader::readBlocking(ReleaseCallbackId& outId,
                                                              sp<Fence>& outFence,
                                                              uint32_t& outMaxAcquiredBufferCount) {
+    {
+        // Releases are sent in batches, so the last read may have left some behind which the
+        // socket will not signal for again.
+        std::lock_guard lock{mMutex};
+        if (mEndpoint->hasPendingReleaseFences()) {
+            return mEndpoint->readReleaseFence(outId, outFence, outMaxAcquiredBufferCount);
+        }
+    }
+
     epoll_event event{};
     while (true) {
         int eventCount = epoll_wait(mEpollFd.get(), &event, 1 /* maxevents */, -1 /* timeout */);
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#undef LOG_TAG
+#define LOG_TAG "BLASTFrameBatcher"
+
+#define ATRACE_TAG ATRACE_TAG_GRAPHICS
+
+#include <gui/BLASTFrameBatcher.h>
+
+#include <android/gui/FrameTimelineInfo.h>
+#include <gui/TraceUtils.h>
+#include <utils/Trace.h>
+
+#include <cinttypes>
+
+namespace android {
+
+using gui::FrameTimelineInfo;
+
+BLASTFrameBatcher::BLASTFrameBatcher(std::chrono::nanoseconds maxDelay)
+      : mMaxDelay(maxDelay), mThread(&BLASTFrameBatcher::threadMain, this) {}
+
+BLASTFrameBatcher::~BLASTFrameBatcher() {
+    {
+        std::lock_guard _lock{mMutex};
+        mStopped = true;
+        flushLocked();
+    }
+    mCondition.notify_all();
+    mThread.join();
+}
+
+void BLASTFrameBatcher::flush() {
+    std::lock_guard _lock{mMutex};
+    flushLocked();
+}
+
+void BLASTFrameBatcher::expectFrame(const BLASTBufferQueue* queue, int64_t vsyncId) {
+    if (vsyncId == FrameTimelineInfo::INVALID_VSYNC_ID) return;
+    std::lock_guard _lock{mMutex};
+    mExpected[vsyncId].insert(queue);
+}
+
+void BLASTFrameBatcher::cancelFrame(const BLASTBufferQueue* queue, int64_t vsyncId) {
+    std::lock_guard _lock{mMutex};
+    auto it = mExpected.find(vsyncId);
+    if (it == mExpected.end()) return;
+    auto queueIt = it->second.find(queue);
+    if (queueIt != it->second.end()) {
+        it->second.erase(queueIt);
+    }
+    if (it->second.empty()) {
+        mExpected.erase(it);
+    }
+    flushIfCompleteLocked();
+}
+
+void BLASTFrameBatcher::removeQueue(const BLASTBufferQueue* queue) {
+    std::lock_guard _lock{mMutex};
+    for (auto it = mExpected.begin(); it != mExpected.end();) {
+        it->second.erase(queue);
+        it = it->second.empty() ? mExpected.erase(it) : std::next(it);
+    }
+    flushIfCompleteLocked();
+}
+
+void BLASTFrameBatcher::submit(const BLASTBufferQueue* queue, int64_t vsyncId,
+                               SurfaceComposerClient::Transaction* t) {
+    std::lock_guard _lock{mMutex};
+    if (mHasPending && vsyncId != mPendingVsyncId) {
+        flushLocked();
+    }
+    if (vsyncId == FrameTimelineInfo::INVALID_VSYNC_ID) {
+        // All transactions on our apply token are one-way, as in BLASTBufferQueue.
+        t->setApplyToken(mApplyToken).apply(false, true);
+        return;
+    }
+
+    // Frames announced for earlier vsyncs will not join any batch anymore.
+    mExpected.erase(mExpected.begin(), mExpected.lower_bound(vsyncId));
+    auto it = mExpected.find(vsyncId);
+    if (it != mExpected.end()) {
+        auto queueIt = it->second.find(queue);
+        if (queueIt != it->second.end()) {
+            it->second.erase(queueIt);
+        }
+        if (it->second.empty()) {
+            mExpected.erase(it);
+        }
+    }
+
+    mPending.merge(std::move(*t));
+    if (!mHasPending) {
+        mHasPending = true;
+        mPendingVsyncId = vsyncId;
+        mPendingDeadline = std::chrono::steady_clock::now() + mMaxDelay;
+        mCondition.notify_all();
+    }
+    flushIfCompleteLocked();
+}
+
+void BLASTFrameBatcher::flushLocked() {
+    if (!mHasPending) return;
+    ATRACE_FORMAT("%s vsyncId: %" PRId64, __func__, mPendingVsyncId);
+    mPending.setApplyToken(mApplyToken).apply(false, true);
+    mPending.clear();
+    mHasPending = false;
+}
+
+void BLASTFrameBatcher::flushIfCompleteLocked() {
+    if (mHasPending && mExpected.find(mPendingVsyncId) == mExpected.end()) {
+        flushLocked();
+    }
+}
+
+void BLASTFrameBatcher::threadMain() {
+    std::unique_lock lock{mMutex};
+    while (!mStopped) {
+        if (!mHasPending) {
+            mCondition.wait(lock);
+            continue;
+        }
+        // The batch may have been flushed and replaced while we waited, so
+        // check the deadline of whatever is pending now.
+        if (std::chrono::steady_clock::now() >= mPendingDeadline) {
+            flushLocked();
+            continue;
+        }
+        mCondition.wait_until(lock, mPendingDeadline);
+    }
+}
+
+} // namespace android
@@ -562,19 +562,27 @@ status_t BufferQueueConsumer::disconnect() {
 
     BQ_LOGV("disconnect");
 
-    std::lock_guard<std::mutex> lock(mCore->mMutex);
+    sp<IProducerListener> producerListener;
+    { // Autolock scope
+        std::lock_guard<std::mutex> lock(mCore->mMutex);
 
-    if (mCore->mConsumerListener == nullptr) {
-        BQ_LOGE("disconnect: no consumer is connected");
-        return BAD_VALUE;
-    }
+        if (mCore->mConsumerListener == nullptr) {
+            BQ_LOGE("disconnect: no consumer is connected");
+            return BAD_VALUE;
+        }
 
-    mCore->mIsAbandoned = true;
-    mCore->mConsumerListener = nullptr;
-    mCore->mQueue.clear();
-    mCore->freeAllBuffersLocked();
-    mCore->mSharedBufferSlot = BufferQueueCore::INVALID_BUFFER_SLOT;
-    mCore->mDequeueCondition.notify_all();
+        mCore->mIsAbandoned = true;
+        mCore->mConsumerListener = nullptr;
+        mCore->mQueue.clear();
+        mCore->freeAllBuffersLocked();
+        mCore->mSharedBufferSlot = BufferQueueCore::INVALID_BUFFER_SLOT;
+        mCore->mDequeueCondition.notify_all();
+        producerListener = getConsumerConfigListenerLocked();
+    }
+    // Call back without lock held
+    if (producerListener != nullptr) {
+        producerListener->onConsumerConfigChanged();
+    }
     return NO_ERROR;
 }
 
@@ -628,9 +636,19 @@ status_t BufferQueueConsumer::setDefaultBufferSize(uint32_t width,
 
     BQ_LOGV("setDefaultBufferSize: width=%u height=%u", width, height);
 
-    std::lock_guard<std::mutex> lock(mCore->mMutex);
-    mCore->mDefaultWidth = width;
-    mCore->mDefaultHeight = height;
+    sp<IProducerListener> listener;
+    { // Autolock scope
+        std::lock_guard<std::mutex> lock(mCore->mMutex);
+        if (width != mCore->mDefaultWidth || height != mCore->mDefaultHeight) {
+            listener = getConsumerConfigListenerLocked();
+        }
+        mCore->mDefaultWidth = width;
+        mCore->mDefaultHeight = height;
+    }
+    // Call back without lock held
+    if (listener != nullptr) {
+        listener->onConsumerConfigChanged();
+    }
     return NO_ERROR;
 }
 
@@ -681,6 +699,7 @@ status_t BufferQueueConsumer::setMaxAcquiredBufferCount(
     }
 
     sp<IConsumerListener> listener;
+    sp<IProducerListener> producerListener;
     { // Autolock scope
         std::unique_lock<std::mutex> lock(mCore->mMutex);
         mCore->waitWhileAllocatingLocked(lock);
@@ -731,11 +750,16 @@ status_t BufferQueueConsumer::setMaxAcquiredBufferCount(
         if (delta < 0 && mCore->mBufferReleasedCbEnabled) {
             listener = mCore->mConsumerListener;
         }
+        // The min undequeued buffer count follows the max acquired buffer count.
+        producerListener = getConsumerConfigListenerLocked();
     }
     // Call back without lock held
     if (listener != nullptr) {
         listener->onBuffersReleased();
     }
+    if (producerListener != nullptr) {
+        producerListener->onConsumerConfigChanged();
+    }
 
     return NO_ERROR;
 }
@@ -752,8 +776,18 @@ status_t BufferQueueConsumer::setConsumerName(const String8& name) {
 status_t BufferQueueConsumer::setDefaultBufferFormat(PixelFormat defaultFormat) {
     ATRACE_CALL();
     BQ_LOGV("setDefaultBufferFormat: %u", defaultFormat);
-    std::lock_guard<std::mutex> lock(mCore->mMutex);
-    mCore->mDefaultBufferFormat = defaultFormat;
+    sp<IProducerListener> listener;
+    { // Autolock scope
+        std::lock_guard<std::mutex> lock(mCore->mMutex);
+        if (defaultFormat != mCore->mDefaultBufferFormat) {
+            listener = getConsumerConfigListenerLocked();
+        }
+        mCore->mDefaultBufferFormat = defaultFormat;
+    }
+    // Call back without lock held
+    if (listener != nullptr) {
+        listener->onConsumerConfigChanged();
+    }
     return NO_ERROR;
 }
 
@@ -761,24 +795,54 @@ status_t BufferQueueConsumer::setDefaultBufferDataSpace(
         android_dataspace defaultDataSpace) {
     ATRACE_CALL();
     BQ_LOGV("setDefaultBufferDataSpace: %u", defaultDataSpace);
-    std::lock_guard<std::mutex> lock(mCore->mMutex);
-    mCore->mDefaultBufferDataSpace = defaultDataSpace;
+    sp<IProducerListener> listener;
+    { // Autolock scope
+        std::lock_guard<std::mutex> lock(mCore->mMutex);
+        if (defaultDataSpace != mCore->mDefaultBufferDataSpace) {
+            listener = getConsumerConfigListenerLocked();
+        }
+        mCore->mDefaultBufferDataSpace = defaultDataSpace;
+    }
+    // Call back without lock held
+    if (listener != nullptr) {
+        listener->onConsumerConfigChanged();
+    }
     return NO_ERROR;
 }
 
 status_t BufferQueueConsumer::setConsumerUsageBits(uint64_t usage) {
     ATRACE_CALL();
     BQ_LOGV("setConsumerUsageBits: %#" PRIx64, usage);
-    std::lock_guard<std::mutex> lock(mCore->mMutex);
-    mCore->mConsumerUsageBits = usage;
+    sp<IProducerListener> listener;
+    { // Autolock scope
+        std::lock_guard<std::mutex> lock(mCore->mMutex);
+        if (usage != mCore->mConsumerUsageBits) {
+            listener = getConsumerConfigListenerLocked();
+        }
+        mCore->mConsumerUsageBits = usage;
+    }
+    // Call back without lock held
+    if (listener != nullptr) {
+        listener->onConsumerConfigChanged();
+    }
     return NO_ERROR;
 }
 
 status_t BufferQueueConsumer::setConsumerIsProtected(bool isProtected) {
     ATRACE_CALL();
     BQ_LOGV("setConsumerIsProtected: %s", isProtected ? "true" : "false");
-    std::lock_guard<std::mutex> lock(mCore->mMutex);
-    mCore->mConsumerIsProtected = isProtected;
+    sp<IProducerListener> listener;
+    { // Autolock scope
+        std::lock_guard<std::mutex> lock(mCore->mMutex);
+        if (isProtected != mCore->mConsumerIsProtected) {
+            listener = getConsumerConfigListenerLocked();
+        }
+        mCore->mConsumerIsProtected = isProtected;
+    }
+    // Call back without lock held
+    if (listener != nullptr) {
+        listener->onConsumerConfigChanged();
+    }
     return NO_ERROR;
 }
 
@@ -814,6 +878,10 @@ status_t BufferQueueConsumer::discardFreeBuffers() {
     return NO_ERROR;
 }
 
+sp<IProducerListener> BufferQueueConsumer::getConsumerConfigListenerLocked() const {
+    return mCore->mConsumerConfigCbEnabled ? mCore->mConnectedProducerListener : nullptr;
+}
+
 status_t BufferQueueConsumer::dumpState(const String8& prefix, String8* outResult) const {
     struct passwd* pwd = getpwnam("shell");
     uid_t shellUid = pwd ? pwd->pw_uid : 0;
@@ -97,6 +97,7 @@ BufferQueueCore::BufferQueueCore()
         mConnectedProducerListener(),
         mBufferReleasedCbEnabled(false),
         mBufferAttachedCbEnabled(false),
+        mConsumerConfigCbEnabled(false),
         mSlots(),
         mQueue(),
         mFreeSlots(),
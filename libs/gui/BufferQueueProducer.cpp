@@ -95,8 +95,26 @@ BufferQueueProducer::~BufferQueueProducer() {}
 
 status_t BufferQueueProducer::requestBuffer(int slot, sp<GraphicBuffer>* buf) {
     ATRACE_CALL();
-    BQ_LOGV("requestBuffer: slot %d", slot);
     std::lock_guard<std::mutex> lock(mCore->mMutex);
+    return requestBufferLocked(slot, buf);
+}
+
+status_t BufferQueueProducer::requestBuffers(const std::vector<int32_t>& slots,
+                                             std::vector<RequestBufferOutput>* outputs) {
+    ATRACE_CALL();
+    outputs->clear();
+    outputs->reserve(slots.size());
+
+    std::lock_guard<std::mutex> lock(mCore->mMutex);
+    for (int32_t slot : slots) {
+        RequestBufferOutput& output = outputs->emplace_back();
+        output.result = requestBufferLocked(static_cast<int>(slot), &output.buffer);
+    }
+    return NO_ERROR;
+}
+
+status_t BufferQueueProducer::requestBufferLocked(int slot, sp<GraphicBuffer>* buf) {
+    BQ_LOGV("requestBuffer: slot %d", slot);
 
     if (mCore->mIsAbandoned) {
         BQ_LOGE("requestBuffer: BufferQueue has been abandoned");
@@ -392,276 +410,268 @@ status_t BufferQueueProducer::waitForFreeSlotThenRelock(FreeSlotCaller caller,
     return NO_ERROR;
 }
 
-status_t BufferQueueProducer::dequeueBuffer(int* outSlot, sp<android::Fence>* outFence,
-                                            uint32_t width, uint32_t height, PixelFormat format,
-                                            uint64_t usage, uint64_t* outBufferAge,
-                                            FrameEventHistoryDelta* outTimestamps) {
-    ATRACE_CALL();
-    { // Autolock scope
-        std::lock_guard<std::mutex> lock(mCore->mMutex);
-        mConsumerName = mCore->mConsumerName;
+status_t BufferQueueProducer::dequeueBufferLocked(std::unique_lock<std::mutex>& lock,
+                                                  DequeueState* state) {
+    mConsumerName = mCore->mConsumerName;
 
-        if (mCore->mIsAbandoned) {
-            BQ_LOGE("dequeueBuffer: BufferQueue has been abandoned");
-            return NO_INIT;
-        }
+    if (mCore->mIsAbandoned) {
+        BQ_LOGE("dequeueBuffer: BufferQueue has been abandoned");
+        return NO_INIT;
+    }
 
-        if (mCore->mConnectedApi == BufferQueueCore::NO_CONNECTED_API) {
-            BQ_LOGE("dequeueBuffer: BufferQueue has no connected producer");
-            return NO_INIT;
-        }
-    } // Autolock scope
+    if (mCore->mConnectedApi == BufferQueueCore::NO_CONNECTED_API) {
+        BQ_LOGE("dequeueBuffer: BufferQueue has no connected producer");
+        return NO_INIT;
+    }
 
-    BQ_LOGV("dequeueBuffer: w=%u h=%u format=%#x, usage=%#" PRIx64, width, height, format, usage);
+    BQ_LOGV("dequeueBuffer: w=%u h=%u format=%#x, usage=%#" PRIx64, state->width, state->height,
+            state->format, state->usage);
 
-    if ((width && !height) || (!width && height)) {
-        BQ_LOGE("dequeueBuffer: invalid size: w=%u h=%u", width, height);
+    if ((state->width && !state->height) || (!state->width && state->height)) {
+        BQ_LOGE("dequeueBuffer: invalid size: w=%u h=%u", state->width, state->height);
         return BAD_VALUE;
     }
 
-    status_t returnFlags = NO_ERROR;
-    EGLDisplay eglDisplay = EGL_NO_DISPLAY;
-    EGLSyncKHR eglFence = EGL_NO_SYNC_KHR;
-    bool attachedByConsumer = false;
+    // If we don't have a free buffer, but we are currently allocating, we wait until allocation
+    // is finished such that we don't allocate in parallel.
+    if (mCore->mFreeBuffers.empty() && mCore->mIsAllocating) {
+        mDequeueWaitingForAllocation = true;
+        mCore->waitWhileAllocatingLocked(lock);
+        mDequeueWaitingForAllocation = false;
+        mDequeueWaitingForAllocationCondition.notify_all();
+    }
 
-    sp<IConsumerListener> listener;
-    bool callOnFrameDequeued = false;
-    uint64_t bufferId = 0; // Only used if callOnFrameDequeued == true
-#if COM_ANDROID_GRAPHICS_LIBGUI_FLAGS(BQ_EXTENDEDALLOCATE)
-    std::vector<gui::AdditionalOptions> allocOptions;
-    uint32_t allocOptionsGenId = 0;
-#endif
+    if (state->format == 0) {
+        state->format = mCore->mDefaultBufferFormat;
+    }
 
-    { // Autolock scope
-        std::unique_lock<std::mutex> lock(mCore->mMutex);
+    // Enable the usage bits the consumer requested
+    state->usage |= mCore->mConsumerUsageBits;
 
-        // If we don't have a free buffer, but we are currently allocating, we wait until allocation
-        // is finished such that we don't allocate in parallel.
-        if (mCore->mFreeBuffers.empty() && mCore->mIsAllocating) {
-            mDequeueWaitingForAllocation = true;
-            mCore->waitWhileAllocatingLocked(lock);
-            mDequeueWaitingForAllocation = false;
-            mDequeueWaitingForAllocationCondition.notify_all();
+    const bool useDefaultSize = !state->width && !state->height;
+    if (useDefaultSize) {
+        state->width = mCore->mDefaultWidth;
+        state->height = mCore->mDefaultHeight;
+        if (mCore->mAutoPrerotation &&
+            (mCore->mTransformHintInUse & NATIVE_WINDOW_TRANSFORM_ROT_90)) {
+            std::swap(state->width, state->height);
         }
+    }
 
-        if (format == 0) {
-            format = mCore->mDefaultBufferFormat;
+    int found = BufferItem::INVALID_BUFFER_SLOT;
+    while (found == BufferItem::INVALID_BUFFER_SLOT) {
+        status_t status = waitForFreeSlotThenRelock(FreeSlotCaller::Dequeue, lock, &found);
+        if (status != NO_ERROR) {
+            return status;
         }
 
-        // Enable the usage bits the consumer requested
-        usage |= mCore->mConsumerUsageBits;
-
-        const bool useDefaultSize = !width && !height;
-        if (useDefaultSize) {
-            width = mCore->mDefaultWidth;
-            height = mCore->mDefaultHeight;
-            if (mCore->mAutoPrerotation &&
-                (mCore->mTransformHintInUse & NATIVE_WINDOW_TRANSFORM_ROT_90)) {
-                std::swap(width, height);
-            }
+        // This should not happen
+        if (found == BufferQueueCore::INVALID_BUFFER_SLOT) {
+            BQ_LOGE("dequeueBuffer: no available buffer slots");
+            return -EBUSY;
         }
 
-        int found = BufferItem::INVALID_BUFFER_SLOT;
-        while (found == BufferItem::INVALID_BUFFER_SLOT) {
-            status_t status = waitForFreeSlotThenRelock(FreeSlotCaller::Dequeue, lock, &found);
-            if (status != NO_ERROR) {
-                return status;
-            }
-
-            // This should not happen
-            if (found == BufferQueueCore::INVALID_BUFFER_SLOT) {
-                BQ_LOGE("dequeueBuffer: no available buffer slots");
-                return -EBUSY;
-            }
-
-            const sp<GraphicBuffer>& buffer(mSlots[found].mGraphicBuffer);
+        const sp<GraphicBuffer>& buffer(mSlots[found].mGraphicBuffer);
 
-            // If we are not allowed to allocate new buffers,
-            // waitForFreeSlotThenRelock must have returned a slot containing a
-            // buffer. If this buffer would require reallocation to meet the
-            // requested attributes, we free it and attempt to get another one.
-            if (!mCore->mAllowAllocation) {
-                if (buffer->needsReallocation(width, height, format, BQ_LAYER_COUNT, usage)) {
-                    if (mCore->mSharedBufferSlot == found) {
-                        BQ_LOGE("dequeueBuffer: cannot re-allocate a sharedbuffer");
-                        return BAD_VALUE;
-                    }
-                    mCore->mFreeSlots.insert(found);
-                    mCore->clearBufferSlotLocked(found);
-                    found = BufferItem::INVALID_BUFFER_SLOT;
-                    continue;
+        // If we are not allowed to allocate new buffers,
+        // waitForFreeSlotThenRelock must have returned a slot containing a
+        // buffer. If this buffer would require reallocation to meet the
+        // requested attributes, we free it and attempt to get another one.
+        if (!mCore->mAllowAllocation) {
+            if (buffer->needsReallocation(state->width, state->height, state->format,
+                                          BQ_LAYER_COUNT, state->usage)) {
+                if (mCore->mSharedBufferSlot == found) {
+                    BQ_LOGE("dequeueBuffer: cannot re-allocate a sharedbuffer");
+                    return BAD_VALUE;
                 }
+                mCore->mFreeSlots.insert(found);
+                mCore->clearBufferSlotLocked(found);
+                found = BufferItem::INVALID_BUFFER_SLOT;
+                continue;
             }
         }
+    }
 
-        const sp<GraphicBuffer>& buffer(mSlots[found].mGraphicBuffer);
+    const sp<GraphicBuffer>& buffer(mSlots[found].mGraphicBuffer);
 
-        bool needsReallocation = buffer == nullptr ||
-                buffer->needsReallocation(width, height, format, BQ_LAYER_COUNT, usage);
+    bool needsReallocation = buffer == nullptr ||
+            buffer->needsReallocation(state->width, state->height, state->format,
+                                      BQ_LAYER_COUNT, state->usage);
 
 #if COM_ANDROID_GRAPHICS_LIBGUI_FLAGS(BQ_EXTENDEDALLOCATE)
-        needsReallocation |= mSlots[found].mAdditionalOptionsGenerationId !=
-                mCore->mAdditionalOptionsGenerationId;
+    needsReallocation |= mSlots[found].mAdditionalOptionsGenerationId !=
+            mCore->mAdditionalOptionsGenerationId;
 #endif
 
-        if (mCore->mSharedBufferSlot == found && needsReallocation) {
-            BQ_LOGE("dequeueBuffer: cannot re-allocate a shared buffer");
-            return BAD_VALUE;
-        }
+    if (mCore->mSharedBufferSlot == found && needsReallocation) {
+        BQ_LOGE("dequeueBuffer: cannot re-allocate a shared buffer");
+        return BAD_VALUE;
+    }
 
-        if (mCore->mSharedBufferSlot != found) {
-            mCore->mActiveBuffers.insert(found);
-        }
-        *outSlot = found;
-        ATRACE_BUFFER_INDEX(found);
+    if (mCore->mSharedBufferSlot != found) {
+        mCore->mActiveBuffers.insert(found);
+    }
+    state->slot = found;
+    ATRACE_BUFFER_INDEX(found);
 
-        attachedByConsumer = mSlots[found].mNeedsReallocation;
-        mSlots[found].mNeedsReallocation = false;
+    state->attachedByConsumer = mSlots[found].mNeedsReallocation;
+    mSlots[found].mNeedsReallocation = false;
 
-        mSlots[found].mBufferState.dequeue();
+    mSlots[found].mBufferState.dequeue();
 
-        if (needsReallocation) {
-            if (CC_UNLIKELY(ATRACE_ENABLED())) {
-                if (buffer == nullptr) {
-                    ATRACE_FORMAT_INSTANT("%s buffer reallocation: null", mConsumerName.c_str());
-                } else {
-                    ATRACE_FORMAT_INSTANT("%s buffer reallocation actual %dx%d format:%d "
-                                          "layerCount:%d "
-                                          "usage:%d requested: %dx%d format:%d layerCount:%d "
-                                          "usage:%d ",
-                                          mConsumerName.c_str(), width, height, format,
-                                          BQ_LAYER_COUNT, usage, buffer->getWidth(),
-                                          buffer->getHeight(), buffer->getPixelFormat(),
-                                          buffer->getLayerCount(), buffer->getUsage());
-                }
+    if (needsReallocation) {
+        if (CC_UNLIKELY(ATRACE_ENABLED())) {
+            if (buffer == nullptr) {
+                ATRACE_FORMAT_INSTANT("%s buffer reallocation: null", mConsumerName.c_str());
+            } else {
+                ATRACE_FORMAT_INSTANT("%s buffer reallocation actual %dx%d format:%d "
+                                      "layerCount:%d "
+                                      "usage:%d requested: %dx%d format:%d layerCount:%d "
+                                      "usage:%d ",
+                                      mConsumerName.c_str(), state->width, state->height,
+                                      state->format, BQ_LAYER_COUNT, state->usage,
+                                      buffer->getWidth(),
+                                      buffer->getHeight(), buffer->getPixelFormat(),
+                                      buffer->getLayerCount(), buffer->getUsage());
             }
-            mSlots[found].mAcquireCalled = false;
-            mSlots[found].mGraphicBuffer = nullptr;
-            mSlots[found].mRequestBufferCalled = false;
-            mSlots[found].mEglDisplay = EGL_NO_DISPLAY;
-            mSlots[found].mEglFence = EGL_NO_SYNC_KHR;
-            mSlots[found].mFence = Fence::NO_FENCE;
-            mCore->mBufferAge = 0;
-            mCore->mIsAllocating = true;
+        }
+        mSlots[found].mAcquireCalled = false;
+        mSlots[found].mGraphicBuffer = nullptr;
+        mSlots[found].mRequestBufferCalled = false;
+        mSlots[found].mEglDisplay = EGL_NO_DISPLAY;
+        mSlots[found].mEglFence = EGL_NO_SYNC_KHR;
+        mSlots[found].mFence = Fence::NO_FENCE;
+        mCore->mBufferAge = 0;
+        mCore->mIsAllocating = true;
 #if COM_ANDROID_GRAPHICS_LIBGUI_FLAGS(BQ_EXTENDEDALLOCATE)
-            allocOptions = mCore->mAdditionalOptions;
-            allocOptionsGenId = mCore->mAdditionalOptionsGenerationId;
+        state->allocOptions = mCore->mAdditionalOptions;
+        state->allocOptionsGenId = mCore->mAdditionalOptionsGenerationId;
 #endif
 
-            returnFlags |= BUFFER_NEEDS_REALLOCATION;
-        } else {
-            // We add 1 because that will be the frame number when this buffer
-            // is queued
-            mCore->mBufferAge = mCore->mFrameCounter + 1 - mSlots[found].mFrameNumber;
-        }
+        state->returnFlags |= BUFFER_NEEDS_REALLOCATION;
+    } else {
+        // We add 1 because that will be the frame number when this buffer
+        // is queued
+        mCore->mBufferAge = mCore->mFrameCounter + 1 - mSlots[found].mFrameNumber;
+    }
 
-        BQ_LOGV("dequeueBuffer: setting buffer age to %" PRIu64,
-                mCore->mBufferAge);
+    state->bufferAge = mCore->mBufferAge;
+    BQ_LOGV("dequeueBuffer: setting buffer age to %" PRIu64,
+            mCore->mBufferAge);
 
-        if (CC_UNLIKELY(mSlots[found].mFence == nullptr)) {
-            BQ_LOGE("dequeueBuffer: about to return a NULL fence - "
-                    "slot=%d w=%d h=%d format=%u",
-                    found, buffer->width, buffer->height, buffer->format);
-        }
+    if (CC_UNLIKELY(mSlots[found].mFence == nullptr)) {
+        BQ_LOGE("dequeueBuffer: about to return a NULL fence - "
+                "slot=%d w=%d h=%d format=%u",
+                found, buffer->width, buffer->height, buffer->format);
+    }
 
-        eglDisplay = mSlots[found].mEglDisplay;
-        eglFence = mSlots[found].mEglFence;
-        // Don't return a fence in shared buffer mode, except for the first
-        // frame.
-        *outFence = (mCore->mSharedBufferMode &&
-                mCore->mSharedBufferSlot == found) ?
-                Fence::NO_FENCE : mSlots[found].mFence;
-        mSlots[found].mEglFence = EGL_NO_SYNC_KHR;
-        mSlots[found].mFence = Fence::NO_FENCE;
+    state->eglDisplay = mSlots[found].mEglDisplay;
+    state->eglFence = mSlots[found].mEglFence;
+    // Don't return a fence in shared buffer mode, except for the first
+    // frame.
+    state->fence = (mCore->mSharedBufferMode &&
+            mCore->mSharedBufferSlot == found) ?
+            Fence::NO_FENCE : mSlots[found].mFence;
+    mSlots[found].mEglFence = EGL_NO_SYNC_KHR;
+    mSlots[found].mFence = Fence::NO_FENCE;
+
+    // If shared buffer mode has just been enabled, cache the slot of the
+    // first buffer that is dequeued and mark it as the shared buffer.
+    if (mCore->mSharedBufferMode && mCore->mSharedBufferSlot ==
+            BufferQueueCore::INVALID_BUFFER_SLOT) {
+        mCore->mSharedBufferSlot = found;
+        mSlots[found].mBufferState.mShared = true;
+    }
 
-        // If shared buffer mode has just been enabled, cache the slot of the
-        // first buffer that is dequeued and mark it as the shared buffer.
-        if (mCore->mSharedBufferMode && mCore->mSharedBufferSlot ==
-                BufferQueueCore::INVALID_BUFFER_SLOT) {
-            mCore->mSharedBufferSlot = found;
-            mSlots[found].mBufferState.mShared = true;
-        }
+    if (!(state->returnFlags & BUFFER_NEEDS_REALLOCATION)) {
+        state->callOnFrameDequeued = true;
+        state->bufferId = mSlots[found].mGraphicBuffer->getId();
+    }
 
-        if (!(returnFlags & BUFFER_NEEDS_REALLOCATION)) {
-            callOnFrameDequeued = true;
-            bufferId = mSlots[*outSlot].mGraphicBuffer->getId();
-        }
+    state->listener = mCore->mConsumerListener;
 
-        listener = mCore->mConsumerListener;
-    } // Autolock scope
+    return NO_ERROR;
+}
+
+status_t BufferQueueProducer::allocateDequeuedBuffer(DequeueState* state) {
+    if (!(state->returnFlags & BUFFER_NEEDS_REALLOCATION)) {
+        return NO_ERROR;
+    }
 
-    if (returnFlags & BUFFER_NEEDS_REALLOCATION) {
-        BQ_LOGV("dequeueBuffer: allocating a new buffer for slot %d", *outSlot);
+    BQ_LOGV("dequeueBuffer: allocating a new buffer for slot %d", state->slot);
 
 #if COM_ANDROID_GRAPHICS_LIBGUI_FLAGS(BQ_EXTENDEDALLOCATE)
-        std::vector<GraphicBufferAllocator::AdditionalOptions> tempOptions;
-        tempOptions.reserve(allocOptions.size());
-        for (const auto& it : allocOptions) {
-            tempOptions.emplace_back(it.name.c_str(), it.value);
-        }
-        const GraphicBufferAllocator::AllocationRequest allocRequest = {
-                .importBuffer = true,
-                .width = width,
-                .height = height,
-                .format = format,
-                .layerCount = BQ_LAYER_COUNT,
-                .usage = usage,
-                .requestorName = {mConsumerName.c_str(), mConsumerName.size()},
-                .extras = std::move(tempOptions),
-        };
-        sp<GraphicBuffer> graphicBuffer = new GraphicBuffer(allocRequest);
+    std::vector<GraphicBufferAllocator::AdditionalOptions> tempOptions;
+    tempOptions.reserve(state->allocOptions.size());
+    for (const auto& it : state->allocOptions) {
+        tempOptions.emplace_back(it.name.c_str(), it.value);
+    }
+    const GraphicBufferAllocator::AllocationRequest allocRequest = {
+            .importBuffer = true,
+            .width = state->width,
+            .height = state->height,
+            .format = state->format,
+            .layerCount = BQ_LAYER_COUNT,
+            .usage = state->usage,
+            .requestorName = {mConsumerName.c_str(), mConsumerName.size()},
+            .extras = std::move(tempOptions),
+    };
+    sp<GraphicBuffer> graphicBuffer = new GraphicBuffer(allocRequest);
 #else
-        sp<GraphicBuffer> graphicBuffer =
-                new GraphicBuffer(width, height, format, BQ_LAYER_COUNT, usage,
-                                  {mConsumerName.c_str(), mConsumerName.size()});
+    sp<GraphicBuffer> graphicBuffer =
+            new GraphicBuffer(state->width, state->height, state->format, BQ_LAYER_COUNT,
+                              state->usage, {mConsumerName.c_str(), mConsumerName.size()});
 #endif
 
-        status_t error = graphicBuffer->initCheck();
+    status_t error = graphicBuffer->initCheck();
 
-        { // Autolock scope
-            std::lock_guard<std::mutex> lock(mCore->mMutex);
+    { // Autolock scope
+        std::lock_guard<std::mutex> lock(mCore->mMutex);
 
-            if (error == NO_ERROR && !mCore->mIsAbandoned) {
-                graphicBuffer->setGenerationNumber(mCore->mGenerationNumber);
-                mSlots[*outSlot].mGraphicBuffer = graphicBuffer;
+        if (error == NO_ERROR && !mCore->mIsAbandoned) {
+            graphicBuffer->setGenerationNumber(mCore->mGenerationNumber);
+            mSlots[state->slot].mGraphicBuffer = graphicBuffer;
 #if COM_ANDROID_GRAPHICS_LIBGUI_FLAGS(BQ_EXTENDEDALLOCATE)
-                mSlots[*outSlot].mAdditionalOptionsGenerationId = allocOptionsGenId;
+            mSlots[state->slot].mAdditionalOptionsGenerationId = state->allocOptionsGenId;
 #endif
-                callOnFrameDequeued = true;
-                bufferId = mSlots[*outSlot].mGraphicBuffer->getId();
-            }
+            state->callOnFrameDequeued = true;
+            state->bufferId = mSlots[state->slot].mGraphicBuffer->getId();
+        }
 
-            mCore->mIsAllocating = false;
-            mCore->mIsAllocatingCondition.notify_all();
+        mCore->mIsAllocating = false;
+        mCore->mIsAllocatingCondition.notify_all();
 
-            if (error != NO_ERROR) {
-                mCore->mFreeSlots.insert(*outSlot);
-                mCore->clearBufferSlotLocked(*outSlot);
-                BQ_LOGE("dequeueBuffer: createGraphicBuffer failed");
-                return error;
-            }
+        if (error != NO_ERROR) {
+            mCore->mFreeSlots.insert(state->slot);
+            mCore->clearBufferSlotLocked(state->slot);
+            BQ_LOGE("dequeueBuffer: createGraphicBuffer failed");
+            return error;
+        }
 
-            if (mCore->mIsAbandoned) {
-                mCore->mFreeSlots.insert(*outSlot);
-                mCore->clearBufferSlotLocked(*outSlot);
-                BQ_LOGE("dequeueBuffer: BufferQueue has been abandoned");
-                return NO_INIT;
-            }
+        if (mCore->mIsAbandoned) {
+            mCore->mFreeSlots.insert(state->slot);
+            mCore->clearBufferSlotLocked(state->slot);
+            BQ_LOGE("dequeueBuffer: BufferQueue has been abandoned");
+            return NO_INIT;
+        }
 
-            VALIDATE_CONSISTENCY();
-        } // Autolock scope
-    }
+        VALIDATE_CONSISTENCY();
+    } // Autolock scope
+
+    return NO_ERROR;
+}
 
-    if (listener != nullptr && callOnFrameDequeued) {
-        listener->onFrameDequeued(bufferId);
+status_t BufferQueueProducer::finishDequeueBuffer(DequeueState* state) {
+    if (state->listener != nullptr && state->callOnFrameDequeued) {
+        state->listener->onFrameDequeued(state->bufferId);
     }
 
-    if (attachedByConsumer) {
-        returnFlags |= BUFFER_NEEDS_REALLOCATION;
+    if (state->attachedByConsumer) {
+        state->returnFlags |= BUFFER_NEEDS_REALLOCATION;
     }
 
-    if (eglFence != EGL_NO_SYNC_KHR) {
-        EGLint result = eglClientWaitSyncKHR(eglDisplay, eglFence, 0,
+    if (state->eglFence != EGL_NO_SYNC_KHR) {
+        EGLint result = eglClientWaitSyncKHR(state->eglDisplay, state->eglFence, 0,
                 1000000000);
         // If something goes wrong, log the error, but return the buffer without
         // synchronizing access to it. It's too late at this point to abort the
@@ -672,23 +682,97 @@ status_t BufferQueueProducer::dequeueBuffer(int* outSlot, sp<android::Fence>* ou
         } else if (result == EGL_TIMEOUT_EXPIRED_KHR) {
             BQ_LOGE("dequeueBuffer: timeout waiting for fence");
         }
-        eglDestroySyncKHR(eglDisplay, eglFence);
+        eglDestroySyncKHR(state->eglDisplay, state->eglFence);
     }
 
     BQ_LOGV("dequeueBuffer: returning slot=%d/%" PRIu64 " buf=%p flags=%#x",
-            *outSlot,
-            mSlots[*outSlot].mFrameNumber,
-            mSlots[*outSlot].mGraphicBuffer != nullptr ?
-            mSlots[*outSlot].mGraphicBuffer->handle : nullptr, returnFlags);
+            state->slot,
+            mSlots[state->slot].mFrameNumber,
+            mSlots[state->slot].mGraphicBuffer != nullptr ?
+            mSlots[state->slot].mGraphicBuffer->handle : nullptr, state->returnFlags);
+
+    return state->returnFlags;
+}
+
+status_t BufferQueueProducer::dequeueBuffer(int* outSlot, sp<android::Fence>* outFence,
+                                            uint32_t width, uint32_t height, PixelFormat format,
+                                            uint64_t usage, uint64_t* outBufferAge,
+                                            FrameEventHistoryDelta* outTimestamps) {
+    ATRACE_CALL();
+
+    DequeueState state;
+    state.width = width;
+    state.height = height;
+    state.format = format;
+    state.usage = usage;
+
+    { // Autolock scope
+        std::unique_lock<std::mutex> lock(mCore->mMutex);
+        status_t status = dequeueBufferLocked(lock, &state);
+        if (status != NO_ERROR) {
+            return status;
+        }
+    } // Autolock scope
+
+    status_t status = allocateDequeuedBuffer(&state);
+    if (status != NO_ERROR) {
+        return status;
+    }
 
+    *outSlot = state.slot;
+    *outFence = state.fence;
     if (outBufferAge) {
-        *outBufferAge = mCore->mBufferAge;
+        *outBufferAge = state.bufferAge;
     }
+    status_t returnFlags = finishDequeueBuffer(&state);
     addAndGetFrameTimestamps(nullptr, outTimestamps);
 
     return returnFlags;
 }
 
+status_t BufferQueueProducer::dequeueBuffers(const std::vector<DequeueBufferInput>& inputs,
+                                             std::vector<DequeueBufferOutput>* outputs) {
+    ATRACE_CALL();
+    outputs->clear();
+    outputs->resize(inputs.size());
+
+    std::vector<DequeueState> states(inputs.size());
+    { // Autolock scope
+        std::unique_lock<std::mutex> lock(mCore->mMutex);
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            DequeueState& state = states[i];
+            state.width = inputs[i].width;
+            state.height = inputs[i].height;
+            state.format = inputs[i].format;
+            state.usage = inputs[i].usage;
+
+            status_t status = dequeueBufferLocked(lock, &state);
+            if (status == NO_ERROR && (state.returnFlags & BUFFER_NEEDS_REALLOCATION)) {
+                // Allocate before dequeueing the next buffer, which would
+                // otherwise wait for this allocation to finish.
+                lock.unlock();
+                status = allocateDequeuedBuffer(&state);
+                lock.lock();
+            }
+            (*outputs)[i].result = status;
+        }
+    } // Autolock scope
+
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        DequeueBufferOutput& output = (*outputs)[i];
+        if (output.result != NO_ERROR) {
+            continue;
+        }
+        output.slot = states[i].slot;
+        output.fence = states[i].fence;
+        output.bufferAge = states[i].bufferAge;
+        output.result = finishDequeueBuffer(&states[i]);
+        addAndGetFrameTimestamps(nullptr,
+                                 inputs[i].getTimestamps ? &output.timestamps.emplace() : nullptr);
+    }
+    return NO_ERROR;
+}
+
 status_t BufferQueueProducer::detachBuffer(int slot) {
     ATRACE_CALL();
     ATRACE_BUFFER_INDEX(slot);
@@ -884,265 +968,251 @@ status_t BufferQueueProducer::attachBuffer(int* outSlot,
     return returnFlags;
 }
 
-status_t BufferQueueProducer::queueBuffer(int slot,
-        const QueueBufferInput &input, QueueBufferOutput *output) {
-    ATRACE_CALL();
-    ATRACE_BUFFER_INDEX(slot);
+status_t BufferQueueProducer::prepareQueueBuffer(const QueueBufferInput& input,
+                                                 QueueState* state) const {
+    state->input = &input;
+    input.deflate(&state->requestedPresentTimestamp, &state->isAutoTimestamp, &state->dataSpace,
+            &state->crop, &state->scalingMode, &state->transform, &state->acquireFence,
+            &state->stickyTransform, &state->getFrameTimestamps);
 
-    int64_t requestedPresentTimestamp;
-    bool isAutoTimestamp;
-    android_dataspace dataSpace;
-    Rect crop(Rect::EMPTY_RECT);
-    int scalingMode;
-    uint32_t transform;
-    uint32_t stickyTransform;
-    sp<Fence> acquireFence;
-    bool getFrameTimestamps = false;
-    input.deflate(&requestedPresentTimestamp, &isAutoTimestamp, &dataSpace,
-            &crop, &scalingMode, &transform, &acquireFence, &stickyTransform,
-            &getFrameTimestamps);
-    const Region& surfaceDamage = input.getSurfaceDamage();
-    const HdrMetadata& hdrMetadata = input.getHdrMetadata();
-
-    if (acquireFence == nullptr) {
+    if (state->acquireFence == nullptr) {
         BQ_LOGE("queueBuffer: fence is NULL");
         return BAD_VALUE;
     }
 
-    auto acquireFenceTime = std::make_shared<FenceTime>(acquireFence);
+    state->acquireFenceTime = std::make_shared<FenceTime>(state->acquireFence);
 
-    switch (scalingMode) {
+    switch (state->scalingMode) {
         case NATIVE_WINDOW_SCALING_MODE_FREEZE:
         case NATIVE_WINDOW_SCALING_MODE_SCALE_TO_WINDOW:
         case NATIVE_WINDOW_SCALING_MODE_SCALE_CROP:
         case NATIVE_WINDOW_SCALING_MODE_NO_SCALE_CROP:
             break;
         default:
-            BQ_LOGE("queueBuffer: unknown scaling mode %d", scalingMode);
+            BQ_LOGE("queueBuffer: unknown scaling mode %d", state->scalingMode);
             return BAD_VALUE;
     }
 
-    sp<IConsumerListener> frameAvailableListener;
-    sp<IConsumerListener> frameReplacedListener;
-    int callbackTicket = 0;
-    uint64_t currentFrameNumber = 0;
-    BufferItem item;
-    int connectedApi;
-    bool enableEglCpuThrottling = true;
-    sp<Fence> lastQueuedFence;
+    return NO_ERROR;
+}
 
-    { // Autolock scope
-        std::lock_guard<std::mutex> lock(mCore->mMutex);
+status_t BufferQueueProducer::queueBufferLocked(int slot, QueueState* state,
+                                                QueueBufferOutput* output) {
+    const Region& surfaceDamage = state->input->getSurfaceDamage();
+    const HdrMetadata& hdrMetadata = state->input->getHdrMetadata();
 
-        if (mCore->mIsAbandoned) {
-            BQ_LOGE("queueBuffer: BufferQueue has been abandoned");
-            return NO_INIT;
-        }
+    if (mCore->mIsAbandoned) {
+        BQ_LOGE("queueBuffer: BufferQueue has been abandoned");
+        return NO_INIT;
+    }
 
-        if (mCore->mConnectedApi == BufferQueueCore::NO_CONNECTED_API) {
-            BQ_LOGE("queueBuffer: BufferQueue has no connected producer");
-            return NO_INIT;
-        }
+    if (mCore->mConnectedApi == BufferQueueCore::NO_CONNECTED_API) {
+        BQ_LOGE("queueBuffer: BufferQueue has no connected producer");
+        return NO_INIT;
+    }
 
-        if (slot < 0 || slot >= BufferQueueDefs::NUM_BUFFER_SLOTS) {
-            BQ_LOGE("queueBuffer: slot index %d out of range [0, %d)",
-                    slot, BufferQueueDefs::NUM_BUFFER_SLOTS);
-            return BAD_VALUE;
-        } else if (!mSlots[slot].mBufferState.isDequeued()) {
-            BQ_LOGE("queueBuffer: slot %d is not owned by the producer "
-                    "(state = %s)", slot, mSlots[slot].mBufferState.string());
-            return BAD_VALUE;
-        } else if (!mSlots[slot].mRequestBufferCalled) {
-            BQ_LOGE("queueBuffer: slot %d was queued without requesting "
-                    "a buffer", slot);
-            return BAD_VALUE;
-        }
+    if (slot < 0 || slot >= BufferQueueDefs::NUM_BUFFER_SLOTS) {
+        BQ_LOGE("queueBuffer: slot index %d out of range [0, %d)",
+                slot, BufferQueueDefs::NUM_BUFFER_SLOTS);
+        return BAD_VALUE;
+    } else if (!mSlots[slot].mBufferState.isDequeued()) {
+        BQ_LOGE("queueBuffer: slot %d is not owned by the producer "
+                "(state = %s)", slot, mSlots[slot].mBufferState.string());
+        return BAD_VALUE;
+    } else if (!mSlots[slot].mRequestBufferCalled) {
+        BQ_LOGE("queueBuffer: slot %d was queued without requesting "
+                "a buffer", slot);
+        return BAD_VALUE;
+    }
 
-        // If shared buffer mode has just been enabled, cache the slot of the
-        // first buffer that is queued and mark it as the shared buffer.
-        if (mCore->mSharedBufferMode && mCore->mSharedBufferSlot ==
-                BufferQueueCore::INVALID_BUFFER_SLOT) {
-            mCore->mSharedBufferSlot = slot;
-            mSlots[slot].mBufferState.mShared = true;
-        }
+    // If shared buffer mode has just been enabled, cache the slot of the
+    // first buffer that is queued and mark it as the shared buffer.
+    if (mCore->mSharedBufferMode && mCore->mSharedBufferSlot ==
+            BufferQueueCore::INVALID_BUFFER_SLOT) {
+        mCore->mSharedBufferSlot = slot;
+        mSlots[slot].mBufferState.mShared = true;
+    }
 
-        BQ_LOGV("queueBuffer: slot=%d/%" PRIu64 " time=%" PRIu64 " dataSpace=%d"
-                " validHdrMetadataTypes=0x%x crop=[%d,%d,%d,%d] transform=%#x scale=%s",
-                slot, mCore->mFrameCounter + 1, requestedPresentTimestamp, dataSpace,
-                hdrMetadata.validTypes, crop.left, crop.top, crop.right, crop.bottom,
-                transform,
-                BufferItem::scalingModeName(static_cast<uint32_t>(scalingMode)));
-
-        const sp<GraphicBuffer>& graphicBuffer(mSlots[slot].mGraphicBuffer);
-        Rect bufferRect(graphicBuffer->getWidth(), graphicBuffer->getHeight());
-        Rect croppedRect(Rect::EMPTY_RECT);
-        crop.intersect(bufferRect, &croppedRect);
-        if (croppedRect != crop) {
-            BQ_LOGE("queueBuffer: crop rect is not contained within the "
-                    "buffer in slot %d", slot);
-            return BAD_VALUE;
-        }
+    BQ_LOGV("queueBuffer: slot=%d/%" PRIu64 " time=%" PRIu64 " dataSpace=%d"
+            " validHdrMetadataTypes=0x%x crop=[%d,%d,%d,%d] transform=%#x scale=%s",
+            slot, mCore->mFrameCounter + 1, state->requestedPresentTimestamp, state->dataSpace,
+            hdrMetadata.validTypes, state->crop.left, state->crop.top, state->crop.right,
+            state->crop.bottom, state->transform,
+            BufferItem::scalingModeName(static_cast<uint32_t>(state->scalingMode)));
+
+    const sp<GraphicBuffer>& graphicBuffer(mSlots[slot].mGraphicBuffer);
+    Rect bufferRect(graphicBuffer->getWidth(), graphicBuffer->getHeight());
+    Rect croppedRect(Rect::EMPTY_RECT);
+    state->crop.intersect(bufferRect, &croppedRect);
+    if (croppedRect != state->crop) {
+        BQ_LOGE("queueBuffer: crop rect is not contained within the "
+                "buffer in slot %d", slot);
+        return BAD_VALUE;
+    }
 
-        // Override UNKNOWN dataspace with consumer default
-        if (dataSpace == HAL_DATASPACE_UNKNOWN) {
-            dataSpace = mCore->mDefaultBufferDataSpace;
-        }
+    // Override UNKNOWN dataspace with consumer default
+    if (state->dataSpace == HAL_DATASPACE_UNKNOWN) {
+        state->dataSpace = mCore->mDefaultBufferDataSpace;
+    }
 
-        mSlots[slot].mFence = acquireFence;
-        mSlots[slot].mBufferState.queue();
-
-        // Increment the frame counter and store a local version of it
-        // for use outside the lock on mCore->mMutex.
-        ++mCore->mFrameCounter;
-        currentFrameNumber = mCore->mFrameCounter;
-        mSlots[slot].mFrameNumber = currentFrameNumber;
-
-        item.mAcquireCalled = mSlots[slot].mAcquireCalled;
-        item.mGraphicBuffer = mSlots[slot].mGraphicBuffer;
-        item.mCrop = crop;
-        item.mTransform = transform &
-                ~static_cast<uint32_t>(NATIVE_WINDOW_TRANSFORM_INVERSE_DISPLAY);
-        item.mTransformToDisplayInverse =
-                (transform & NATIVE_WINDOW_TRANSFORM_INVERSE_DISPLAY) != 0;
-        item.mScalingMode = static_cast<uint32_t>(scalingMode);
-        item.mTimestamp = requestedPresentTimestamp;
-        item.mIsAutoTimestamp = isAutoTimestamp;
-        item.mDataSpace = dataSpace;
-        item.mHdrMetadata = hdrMetadata;
-        item.mFrameNumber = currentFrameNumber;
-        item.mSlot = slot;
-        item.mFence = acquireFence;
-        item.mFenceTime = acquireFenceTime;
-        item.mIsDroppable = mCore->mAsyncMode ||
-                (mConsumerIsSurfaceFlinger && mCore->mQueueBufferCanDrop) ||
-                (mCore->mLegacyBufferDrop && mCore->mQueueBufferCanDrop) ||
-                (mCore->mSharedBufferMode && mCore->mSharedBufferSlot == slot);
-        item.mSurfaceDamage = surfaceDamage;
-        item.mQueuedBuffer = true;
-        item.mAutoRefresh = mCore->mSharedBufferMode && mCore->mAutoRefresh;
-        item.mApi = mCore->mConnectedApi;
-
-        mStickyTransform = stickyTransform;
-
-        // Cache the shared buffer data so that the BufferItem can be recreated.
-        if (mCore->mSharedBufferMode) {
-            mCore->mSharedBufferCache.crop = crop;
-            mCore->mSharedBufferCache.transform = transform;
-            mCore->mSharedBufferCache.scalingMode = static_cast<uint32_t>(
-                    scalingMode);
-            mCore->mSharedBufferCache.dataspace = dataSpace;
-        }
+    mSlots[slot].mFence = state->acquireFence;
+    mSlots[slot].mBufferState.queue();
+
+    // Increment the frame counter and store a local version of it
+    // for use outside the lock on mCore->mMutex.
+    ++mCore->mFrameCounter;
+    state->currentFrameNumber = mCore->mFrameCounter;
+    mSlots[slot].mFrameNumber = state->currentFrameNumber;
+
+    state->item.mAcquireCalled = mSlots[slot].mAcquireCalled;
+    state->item.mGraphicBuffer = mSlots[slot].mGraphicBuffer;
+    state->item.mCrop = state->crop;
+    state->item.mTransform = state->transform &
+            ~static_cast<uint32_t>(NATIVE_WINDOW_TRANSFORM_INVERSE_DISPLAY);
+    state->item.mTransformToDisplayInverse =
+            (state->transform & NATIVE_WINDOW_TRANSFORM_INVERSE_DISPLAY) != 0;
+    state->item.mScalingMode = static_cast<uint32_t>(state->scalingMode);
+    state->item.mTimestamp = state->requestedPresentTimestamp;
+    state->item.mIsAutoTimestamp = state->isAutoTimestamp;
+    state->item.mDataSpace = state->dataSpace;
+    state->item.mHdrMetadata = hdrMetadata;
+    state->item.mFrameNumber = state->currentFrameNumber;
+    state->item.mSlot = slot;
+    state->item.mFence = state->acquireFence;
+    state->item.mFenceTime = state->acquireFenceTime;
+    state->item.mIsDroppable = mCore->mAsyncMode ||
+            (mConsumerIsSurfaceFlinger && mCore->mQueueBufferCanDrop) ||
+            (mCore->mLegacyBufferDrop && mCore->mQueueBufferCanDrop) ||
+            (mCore->mSharedBufferMode && mCore->mSharedBufferSlot == slot);
+    state->item.mSurfaceDamage = surfaceDamage;
+    state->item.mQueuedBuffer = true;
+    state->item.mAutoRefresh = mCore->mSharedBufferMode && mCore->mAutoRefresh;
+    state->item.mApi = mCore->mConnectedApi;
+
+    mStickyTransform = state->stickyTransform;
+
+    // Cache the shared buffer data so that the BufferItem can be recreated.
+    if (mCore->mSharedBufferMode) {
+        mCore->mSharedBufferCache.crop = state->crop;
+        mCore->mSharedBufferCache.transform = state->transform;
+        mCore->mSharedBufferCache.scalingMode = static_cast<uint32_t>(
+                state->scalingMode);
+        mCore->mSharedBufferCache.dataspace = state->dataSpace;
+    }
 
-        output->bufferReplaced = false;
-        if (mCore->mQueue.empty()) {
-            // When the queue is empty, we can ignore mDequeueBufferCannotBlock
-            // and simply queue this buffer
-            mCore->mQueue.push_back(item);
-            frameAvailableListener = mCore->mConsumerListener;
-        } else {
-            // When the queue is not empty, we need to look at the last buffer
-            // in the queue to see if we need to replace it
-            const BufferItem& last = mCore->mQueue.itemAt(
-                    mCore->mQueue.size() - 1);
-            if (last.mIsDroppable) {
-
-                if (!last.mIsStale) {
-                    mSlots[last.mSlot].mBufferState.freeQueued();
-
-                    // After leaving shared buffer mode, the shared buffer will
-                    // still be around. Mark it as no longer shared if this
-                    // operation causes it to be free.
-                    if (!mCore->mSharedBufferMode &&
-                            mSlots[last.mSlot].mBufferState.isFree()) {
-                        mSlots[last.mSlot].mBufferState.mShared = false;
-                    }
-                    // Don't put the shared buffer on the free list.
-                    if (!mSlots[last.mSlot].mBufferState.isShared()) {
-                        mCore->mActiveBuffers.erase(last.mSlot);
-                        mCore->mFreeBuffers.push_back(last.mSlot);
-                        output->bufferReplaced = true;
-                    }
+    output->bufferReplaced = false;
+    if (mCore->mQueue.empty()) {
+        // When the queue is empty, we can ignore mDequeueBufferCannotBlock
+        // and simply queue this buffer
+        mCore->mQueue.push_back(state->item);
+        state->frameAvailableListener = mCore->mConsumerListener;
+    } else {
+        // When the queue is not empty, we need to look at the last buffer
+        // in the queue to see if we need to replace it
+        const BufferItem& last = mCore->mQueue.itemAt(
+                mCore->mQueue.size() - 1);
+        if (last.mIsDroppable) {
+
+            if (!last.mIsStale) {
+                mSlots[last.mSlot].mBufferState.freeQueued();
+
+                // After leaving shared buffer mode, the shared buffer will
+                // still be around. Mark it as no longer shared if this
+                // operation causes it to be free.
+                if (!mCore->mSharedBufferMode &&
+                        mSlots[last.mSlot].mBufferState.isFree()) {
+                    mSlots[last.mSlot].mBufferState.mShared = false;
                 }
-
-                // Make sure to merge the damage rect from the frame we're about
-                // to drop into the new frame's damage rect.
-                if (last.mSurfaceDamage.bounds() == Rect::INVALID_RECT ||
-                    item.mSurfaceDamage.bounds() == Rect::INVALID_RECT) {
-                    item.mSurfaceDamage = Region::INVALID_REGION;
-                } else {
-                    item.mSurfaceDamage |= last.mSurfaceDamage;
+                // Don't put the shared buffer on the free list.
+                if (!mSlots[last.mSlot].mBufferState.isShared()) {
+                    mCore->mActiveBuffers.erase(last.mSlot);
+                    mCore->mFreeBuffers.push_back(last.mSlot);
+                    output->bufferReplaced = true;
                 }
+            }
 
-                // Overwrite the droppable buffer with the incoming one
-                mCore->mQueue.editItemAt(mCore->mQueue.size() - 1) = item;
-                frameReplacedListener = mCore->mConsumerListener;
+            // Make sure to merge the damage rect from the frame we're about
+            // to drop into the new frame's damage rect.
+            if (last.mSurfaceDamage.bounds() == Rect::INVALID_RECT ||
+                state->item.mSurfaceDamage.bounds() == Rect::INVALID_RECT) {
+                state->item.mSurfaceDamage = Region::INVALID_REGION;
             } else {
-                mCore->mQueue.push_back(item);
-                frameAvailableListener = mCore->mConsumerListener;
+                state->item.mSurfaceDamage |= last.mSurfaceDamage;
             }
+
+            // Overwrite the droppable buffer with the incoming one
+            mCore->mQueue.editItemAt(mCore->mQueue.size() - 1) = state->item;
+            state->frameReplacedListener = mCore->mConsumerListener;
+        } else {
+            mCore->mQueue.push_back(state->item);
+            state->frameAvailableListener = mCore->mConsumerListener;
         }
+    }
 
-        mCore->mBufferHasBeenQueued = true;
-        mCore->mDequeueCondition.notify_all();
-        mCore->mLastQueuedSlot = slot;
+    mCore->mBufferHasBeenQueued = true;
+    mCore->mDequeueCondition.notify_all();
+    mCore->mLastQueuedSlot = slot;
 
-        output->width = mCore->mDefaultWidth;
-        output->height = mCore->mDefaultHeight;
-        output->transformHint = mCore->mTransformHintInUse = mCore->mTransformHint;
-        output->numPendingBuffers = static_cast<uint32_t>(mCore->mQueue.size());
-        output->nextFrameNumber = mCore->mFrameCounter + 1;
+    output->width = mCore->mDefaultWidth;
+    output->height = mCore->mDefaultHeight;
+    output->transformHint = mCore->mTransformHintInUse = mCore->mTransformHint;
+    output->numPendingBuffers = static_cast<uint32_t>(mCore->mQueue.size());
+    output->nextFrameNumber = mCore->mFrameCounter + 1;
 
-        ATRACE_INT(mCore->mConsumerName.c_str(), static_cast<int32_t>(mCore->mQueue.size()));
+    ATRACE_INT(mCore->mConsumerName.c_str(), static_cast<int32_t>(mCore->mQueue.size()));
 #ifndef NO_BINDER
-        mCore->mOccupancyTracker.registerOccupancyChange(mCore->mQueue.size());
+    mCore->mOccupancyTracker.registerOccupancyChange(mCore->mQueue.size());
 #endif
-        // Take a ticket for the callback functions
-        callbackTicket = mNextCallbackTicket++;
+    // Take a ticket for the callback functions
+    state->callbackTicket = mNextCallbackTicket++;
 
-        VALIDATE_CONSISTENCY();
+    VALIDATE_CONSISTENCY();
 
-        connectedApi = mCore->mConnectedApi;
-        if (flags::bq_producer_throttles_only_async_mode()) {
-            enableEglCpuThrottling = mCore->mAsyncMode || mCore->mDequeueBufferCannotBlock;
-        }
-        lastQueuedFence = std::move(mLastQueueBufferFence);
+    state->connectedApi = mCore->mConnectedApi;
+    if (flags::bq_producer_throttles_only_async_mode()) {
+        state->enableEglCpuThrottling = mCore->mAsyncMode || mCore->mDequeueBufferCannotBlock;
+    }
+    state->lastQueuedFence = std::move(mLastQueueBufferFence);
 
-        mLastQueueBufferFence = std::move(acquireFence);
-        mLastQueuedCrop = item.mCrop;
-        mLastQueuedTransform = item.mTransform;
-    } // Autolock scope
+    mLastQueueBufferFence = std::move(state->acquireFence);
+    mLastQueuedCrop = state->item.mCrop;
+    mLastQueuedTransform = state->item.mTransform;
+
+    return NO_ERROR;
+}
 
+void BufferQueueProducer::finishQueueBuffer(QueueState* state, QueueBufferOutput* output) {
     // It is okay not to clear the GraphicBuffer when the consumer is SurfaceFlinger because
     // it is guaranteed that the BufferQueue is inside SurfaceFlinger's process and
     // there will be no Binder call
     if (!mConsumerIsSurfaceFlinger) {
-        item.mGraphicBuffer.clear();
+        state->item.mGraphicBuffer.clear();
     }
 
     // Update and get FrameEventHistory.
     nsecs_t postedTime = systemTime(SYSTEM_TIME_MONOTONIC);
     NewFrameEventsEntry newFrameEventsEntry = {
-        currentFrameNumber,
+        state->currentFrameNumber,
         postedTime,
-        requestedPresentTimestamp,
-        std::move(acquireFenceTime)
+        state->requestedPresentTimestamp,
+        std::move(state->acquireFenceTime)
     };
     addAndGetFrameTimestamps(&newFrameEventsEntry,
-            getFrameTimestamps ? &output->frameTimestamps : nullptr);
+            state->getFrameTimestamps ? &output->frameTimestamps : nullptr);
 
     // Call back without the main BufferQueue lock held, but with the callback
     // lock held so we can ensure that callbacks occur in order
 
     { // scope for the lock
         std::unique_lock<std::mutex> lock(mCallbackMutex);
-        while (callbackTicket != mCurrentCallbackTicket) {
+        while (state->callbackTicket != mCurrentCallbackTicket) {
             mCallbackCondition.wait(lock);
         }
 
-        if (frameAvailableListener != nullptr) {
-            frameAvailableListener->onFrameAvailable(item);
-        } else if (frameReplacedListener != nullptr) {
-            frameReplacedListener->onFrameReplaced(item);
+        if (state->frameAvailableListener != nullptr) {
+            state->frameAvailableListener->onFrameAvailable(state->item);
+        } else if (state->frameReplacedListener != nullptr) {
+            state->frameReplacedListener->onFrameReplaced(state->item);
         }
 
         ++mCurrentCallbackTicket;
@@ -1150,84 +1220,175 @@ status_t BufferQueueProducer::queueBuffer(int slot,
     }
 
     // Wait without lock held
-    if (connectedApi == NATIVE_WINDOW_API_EGL && enableEglCpuThrottling) {
+    if (state->connectedApi == NATIVE_WINDOW_API_EGL && state->enableEglCpuThrottling) {
         // Waiting here allows for two full buffers to be queued but not a
         // third. In the event that frames take varying time, this makes a
         // small trade-off in favor of latency rather than throughput.
-        lastQueuedFence->waitForever("Throttling EGL Production");
+        state->lastQueuedFence->waitForever("Throttling EGL Production");
+    }
+}
+
+status_t BufferQueueProducer::queueBuffer(int slot,
+        const QueueBufferInput &input, QueueBufferOutput *output) {
+    ATRACE_CALL();
+    ATRACE_BUFFER_INDEX(slot);
+
+    QueueState state;
+    status_t status = prepareQueueBuffer(input, &state);
+    if (status != NO_ERROR) {
+        return status;
     }
 
+    { // Autolock scope
+        std::lock_guard<std::mutex> lock(mCore->mMutex);
+        status = queueBufferLocked(slot, &state, output);
+        if (status != NO_ERROR) {
+            return status;
+        }
+    } // Autolock scope
+
+    finishQueueBuffer(&state, output);
     return NO_ERROR;
 }
 
-status_t BufferQueueProducer::cancelBuffer(int slot, const sp<Fence>& fence) {
+status_t BufferQueueProducer::queueBuffers(const std::vector<QueueBufferInput>& inputs,
+                                           std::vector<QueueBufferOutput>* outputs) {
     ATRACE_CALL();
-    BQ_LOGV("cancelBuffer: slot %d", slot);
+    outputs->clear();
+    outputs->resize(inputs.size());
 
-    sp<IConsumerListener> listener;
-    bool callOnFrameCancelled = false;
-    uint64_t bufferId = 0; // Only used if callOnFrameCancelled == true
-    {
-        std::lock_guard<std::mutex> lock(mCore->mMutex);
+    std::vector<QueueState> states(inputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        (*outputs)[i].result = prepareQueueBuffer(inputs[i], &states[i]);
+    }
 
-        if (mCore->mIsAbandoned) {
-            BQ_LOGE("cancelBuffer: BufferQueue has been abandoned");
-            return NO_INIT;
+    { // Autolock scope
+        std::lock_guard<std::mutex> lock(mCore->mMutex);
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            if ((*outputs)[i].result == NO_ERROR) {
+                ATRACE_BUFFER_INDEX(inputs[i].slot);
+                (*outputs)[i].result = queueBufferLocked(inputs[i].slot, &states[i],
+                                                         &(*outputs)[i]);
+            }
         }
+    } // Autolock scope
 
-        if (mCore->mConnectedApi == BufferQueueCore::NO_CONNECTED_API) {
-            BQ_LOGE("cancelBuffer: BufferQueue has no connected producer");
-            return NO_INIT;
+    // Callbacks were ticketed in queue order, so they are delivered in that
+    // order here.
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if ((*outputs)[i].result == NO_ERROR) {
+            finishQueueBuffer(&states[i], &(*outputs)[i]);
         }
+    }
+    return NO_ERROR;
+}
 
-        if (mCore->mSharedBufferMode) {
-            BQ_LOGE("cancelBuffer: cannot cancel a buffer in shared buffer mode");
-            return BAD_VALUE;
-        }
+status_t BufferQueueProducer::cancelBuffer(int slot, const sp<Fence>& fence) {
+    ATRACE_CALL();
 
-        if (slot < 0 || slot >= BufferQueueDefs::NUM_BUFFER_SLOTS) {
-            BQ_LOGE("cancelBuffer: slot index %d out of range [0, %d)", slot,
-                    BufferQueueDefs::NUM_BUFFER_SLOTS);
-            return BAD_VALUE;
-        } else if (!mSlots[slot].mBufferState.isDequeued()) {
-            BQ_LOGE("cancelBuffer: slot %d is not owned by the producer "
-                    "(state = %s)",
-                    slot, mSlots[slot].mBufferState.string());
-            return BAD_VALUE;
-        } else if (fence == nullptr) {
-            BQ_LOGE("cancelBuffer: fence is NULL");
-            return BAD_VALUE;
+    sp<IConsumerListener> listener;
+    std::optional<uint64_t> cancelledBufferId;
+    {
+        std::lock_guard<std::mutex> lock(mCore->mMutex);
+        status_t status = cancelBufferLocked(slot, fence, &cancelledBufferId);
+        if (status != NO_ERROR) {
+            return status;
         }
+        mCore->mDequeueCondition.notify_all();
+        listener = mCore->mConsumerListener;
+    }
 
-        mSlots[slot].mBufferState.cancel();
+    if (listener != nullptr && cancelledBufferId) {
+        listener->onFrameCancelled(*cancelledBufferId);
+    }
 
-        // After leaving shared buffer mode, the shared buffer will still be around.
-        // Mark it as no longer shared if this operation causes it to be free.
-        if (!mCore->mSharedBufferMode && mSlots[slot].mBufferState.isFree()) {
-            mSlots[slot].mBufferState.mShared = false;
-        }
+    return NO_ERROR;
+}
 
-        // Don't put the shared buffer on the free list.
-        if (!mSlots[slot].mBufferState.isShared()) {
-            mCore->mActiveBuffers.erase(slot);
-            mCore->mFreeBuffers.push_back(slot);
-        }
+status_t BufferQueueProducer::cancelBuffers(const std::vector<CancelBufferInput>& inputs,
+                                            std::vector<status_t>* results) {
+    ATRACE_CALL();
+    results->clear();
+    results->reserve(inputs.size());
 
-        auto gb = mSlots[slot].mGraphicBuffer;
-        if (gb != nullptr) {
-            callOnFrameCancelled = true;
-            bufferId = gb->getId();
+    sp<IConsumerListener> listener;
+    std::vector<uint64_t> cancelledBufferIds;
+    {
+        std::lock_guard<std::mutex> lock(mCore->mMutex);
+        for (const CancelBufferInput& input : inputs) {
+            std::optional<uint64_t> cancelledBufferId;
+            results->push_back(cancelBufferLocked(input.slot, input.fence, &cancelledBufferId));
+            if (cancelledBufferId) {
+                cancelledBufferIds.push_back(*cancelledBufferId);
+            }
         }
-        mSlots[slot].mFence = fence;
         mCore->mDequeueCondition.notify_all();
         listener = mCore->mConsumerListener;
-        VALIDATE_CONSISTENCY();
     }
 
-    if (listener != nullptr && callOnFrameCancelled) {
-        listener->onFrameCancelled(bufferId);
+    if (listener != nullptr) {
+        for (uint64_t bufferId : cancelledBufferIds) {
+            listener->onFrameCancelled(bufferId);
+        }
+    }
+
+    return NO_ERROR;
+}
+
+status_t BufferQueueProducer::cancelBufferLocked(int slot, const sp<Fence>& fence,
+                                                 std::optional<uint64_t>* outCancelledBufferId) {
+    BQ_LOGV("cancelBuffer: slot %d", slot);
+
+    if (mCore->mIsAbandoned) {
+        BQ_LOGE("cancelBuffer: BufferQueue has been abandoned");
+        return NO_INIT;
+    }
+
+    if (mCore->mConnectedApi == BufferQueueCore::NO_CONNECTED_API) {
+        BQ_LOGE("cancelBuffer: BufferQueue has no connected producer");
+        return NO_INIT;
     }
 
+    if (mCore->mSharedBufferMode) {
+        BQ_LOGE("cancelBuffer: cannot cancel a buffer in shared buffer mode");
+        return BAD_VALUE;
+    }
+
+    if (slot < 0 || slot >= BufferQueueDefs::NUM_BUFFER_SLOTS) {
+        BQ_LOGE("cancelBuffer: slot index %d out of range [0, %d)", slot,
+                BufferQueueDefs::NUM_BUFFER_SLOTS);
+        return BAD_VALUE;
+    } else if (!mSlots[slot].mBufferState.isDequeued()) {
+        BQ_LOGE("cancelBuffer: slot %d is not owned by the producer "
+                "(state = %s)",
+                slot, mSlots[slot].mBufferState.string());
+        return BAD_VALUE;
+    } else if (fence == nullptr) {
+        BQ_LOGE("cancelBuffer: fence is NULL");
+        return BAD_VALUE;
+    }
+
+    mSlots[slot].mBufferState.cancel();
+
+    // After leaving shared buffer mode, the shared buffer will still be around.
+    // Mark it as no longer shared if this operation causes it to be free.
+    if (!mCore->mSharedBufferMode && mSlots[slot].mBufferState.isFree()) {
+        mSlots[slot].mBufferState.mShared = false;
+    }
+
+    // Don't put the shared buffer on the free list.
+    if (!mSlots[slot].mBufferState.isShared()) {
+        mCore->mActiveBuffers.erase(slot);
+        mCore->mFreeBuffers.push_back(slot);
+    }
+
+    auto gb = mSlots[slot].mGraphicBuffer;
+    if (gb != nullptr) {
+        *outCancelledBufferId = gb->getId();
+    }
+    mSlots[slot].mFence = fence;
+    VALIDATE_CONSISTENCY();
+
     return NO_ERROR;
 }
 
@@ -1371,6 +1532,7 @@ status_t BufferQueueProducer::connect(const sp<IProducerListener>& listener,
 #if COM_ANDROID_GRAPHICS_LIBGUI_FLAGS(BQ_CONSUMER_ATTACH_CALLBACK)
                 mCore->mBufferAttachedCbEnabled = listener->needsAttachNotify();
 #endif
+                mCore->mConsumerConfigCbEnabled = listener->needsConsumerConfigNotify();
             }
             break;
         default:
@@ -1455,6 +1617,7 @@ status_t BufferQueueProducer::disconnect(int api, DisconnectMode mode) {
                             BufferQueueCore::INVALID_BUFFER_SLOT;
                     mCore->mLinkedToDeath = nullptr;
                     mCore->mConnectedProducerListener = nullptr;
+                    mCore->mConsumerConfigCbEnabled = false;
                     mCore->mConnectedApi = BufferQueueCore::NO_CONNECTED_API;
                     mCore->mConnectedPid = -1;
                     mCore->mSidebandStream.clear();
@@ -26,10 +26,7 @@ namespace android {
 
 uid_t BufferQueueThreadState::getCallingUid() {
 #ifndef NO_BINDER
-    if (getCurrentServingCall() == BinderCallType::HWBINDER) {
-        return hardware::IPCThreadState::self()->getCallingUid();
-    }
-    return IPCThreadState::self()->getCallingUid();
+    return getCurrentServingCallIdentity().uid;
 #else // NO_BINDER
     return hardware::IPCThreadState::self()->getCallingUid();
 #endif // NO_BINDER
@@ -37,10 +34,7 @@ uid_t BufferQueueThreadState::getCallingUid() {
 
 pid_t BufferQueueThreadState::getCallingPid() {
 #ifndef NO_BINDER
-    if (getCurrentServingCall() == BinderCallType::HWBINDER) {
-        return hardware::IPCThreadState::self()->getCallingPid();
-    }
-    return IPCThreadState::self()->getCallingPid();
+    return getCurrentServingCallIdentity().pid;
 #else // NO_BINDER
     return hardware::IPCThreadState::self()->getCallingPid();
 #endif // NO_BINDER
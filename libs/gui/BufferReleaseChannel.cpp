@@ -16,6 +16,8 @@
 
 #define LOG_TAG "BufferReleaseChannel"
 
+#include <algorithm>
+
 #include <fcntl.h>
 #include <sys/socket.h>
 #include <sys/uio.h>
@@ -136,9 +138,26 @@ status_t BufferReleaseChannel::Message::unflatten(void const*& buffer, size_t& s
 status_t BufferReleaseChannel::ConsumerEndpoint::readReleaseFence(
         ReleaseCallbackId& outReleaseCallbackId, sp<Fence>& outReleaseFence,
         uint32_t& outMaxAcquiredBufferCount) {
-    Message message;
-    mFlattenedBuffer.resize(message.getFlattenedSize());
-    std::array<uint8_t, CMSG_SPACE(sizeof(int))> controlMessageBuffer;
+    if (mPendingMessages.empty()) {
+        if (status_t err = readMessages(); err != OK) {
+            return err;
+        }
+    }
+
+    Message& message = mPendingMessages.front();
+    outReleaseCallbackId = message.releaseCallbackId;
+    outReleaseFence = std::move(message.releaseFence);
+    outMaxAcquiredBufferCount = message.maxAcquiredBufferCount;
+    mPendingMessages.pop_front();
+
+    return OK;
+}
+
+status_t BufferReleaseChannel::ConsumerEndpoint::readMessages() {
+    // Every message has the same flattened size, with or without a fence fd.
+    const size_t messageSize = Message().getFlattenedSize();
+    mFlattenedBuffer.resize(messageSize * kMaxBatchSize);
+    std::array<uint8_t, CMSG_SPACE(sizeof(int) * kMaxBatchSize)> controlMessageBuffer;
 
     iovec iov{
             .iov_base = mFlattenedBuffer.data(),
@@ -174,9 +193,9 @@ status_t BufferReleaseChannel::ConsumerEndpoint::readReleaseFence(
         return UNKNOWN_ERROR;
     }
 
-    size_t dataLen = msg.msg_iov->iov_len;
+    size_t dataLen = static_cast<size_t>(result);
     const void* data = static_cast<const void*>(msg.msg_iov->iov_base);
-    if (!data) {
+    if (!data || dataLen < messageSize) {
         ALOGE("Error reading release fence from socket: no buffer data");
         return UNKNOWN_ERROR;
     }
@@ -188,36 +207,67 @@ status_t BufferReleaseChannel::ConsumerEndpoint::readReleaseFence(
         fdCount = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
     }
 
-    if (status_t err = message.unflatten(data, dataLen, fdData, fdCount); err != OK) {
-        return err;
+    // A socket message holds one or more messages back to back, and the fds of their fences in
+    // the same order.
+    while (dataLen >= messageSize) {
+        Message message;
+        if (status_t err = message.unflatten(data, dataLen, fdData, fdCount); err != OK) {
+            return err;
+        }
+        mPendingMessages.push_back(std::move(message));
     }
 
-    outReleaseCallbackId = message.releaseCallbackId;
-    outReleaseFence = std::move(message.releaseFence);
-    outMaxAcquiredBufferCount = message.maxAcquiredBufferCount;
-
     return OK;
 }
 
-int BufferReleaseChannel::ProducerEndpoint::writeReleaseFence(const ReleaseCallbackId& callbackId,
-                                                              const sp<Fence>& fence,
-                                                              uint32_t maxAcquiredBufferCount) {
+status_t BufferReleaseChannel::ProducerEndpoint::writeReleaseFence(
+        const ReleaseCallbackId& callbackId, const sp<Fence>& fence,
+        uint32_t maxAcquiredBufferCount) {
     Message message{callbackId, fence ? fence : Fence::NO_FENCE, maxAcquiredBufferCount};
-    mFlattenedBuffer.resize(message.getFlattenedSize());
-    int flattenedFd;
+    return writeMessages(&message, 1);
+}
+
+status_t BufferReleaseChannel::ProducerEndpoint::writeReleaseFences(
+        const std::vector<Message>& messages) {
+    for (size_t i = 0; i < messages.size(); i += kMaxBatchSize) {
+        if (status_t err = writeMessages(&messages[i], std::min(kMaxBatchSize, messages.size() - i));
+            err != OK) {
+            return err;
+        }
+    }
+    return OK;
+}
+
+status_t BufferReleaseChannel::ProducerEndpoint::writeMessages(const Message* messages,
+                                                               size_t count) {
+    size_t flattenedSize = 0;
+    for (size_t i = 0; i < count; i++) {
+        flattenedSize += messages[i].getFlattenedSize();
+    }
+    mFlattenedBuffer.resize(flattenedSize);
+    std::array<int, kMaxBatchSize> flattenedFds;
+    size_t fdCount = 0;
     {
         // Make copies of needed items since flatten modifies them, and we don't
         // want to send anything if there's an error during flatten.
         void* flattenedBufferPtr = mFlattenedBuffer.data();
         size_t flattenedBufferSize = mFlattenedBuffer.size();
-        int* flattenedFdPtr = &flattenedFd;
-        size_t flattenedFdCount = 1;
-        if (status_t err = message.flatten(flattenedBufferPtr, flattenedBufferSize, flattenedFdPtr,
-                                           flattenedFdCount);
-            err != OK) {
-            ALOGE("Failed to flatten BufferReleaseChannel message.");
-            return err;
+        int* flattenedFdPtr = flattenedFds.data();
+        size_t flattenedFdCount = flattenedFds.size();
+        for (size_t i = 0; i < count; i++) {
+            const Message& message = messages[i];
+            if (message.releaseFence == nullptr) {
+                ALOGE("BufferReleaseChannel message has no fence.");
+                return BAD_VALUE;
+            }
+            if (status_t err = message.flatten(flattenedBufferPtr, flattenedBufferSize,
+                                               flattenedFdPtr, flattenedFdCount);
+                err != OK) {
+                ALOGE("Failed to flatten BufferReleaseChannel message.");
+                return err;
+            }
         }
+        fdCount = flattenedFds.size() - flattenedFdCount;
     }
 
     iovec iov{
@@ -230,16 +280,16 @@ int BufferReleaseChannel::ProducerEndpoint::writeReleaseFence(const ReleaseCallb
             .msg_iovlen = 1,
     };
 
-    std::array<uint8_t, CMSG_SPACE(sizeof(int))> controlMessageBuffer;
-    if (fence && fence->isValid()) {
+    std::array<uint8_t, CMSG_SPACE(sizeof(int) * kMaxBatchSize)> controlMessageBuffer;
+    if (fdCount > 0) {
         msg.msg_control = controlMessageBuffer.data();
-        msg.msg_controllen = controlMessageBuffer.size();
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * fdCount);
 
         cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
         cmsg->cmsg_level = SOL_SOCKET;
         cmsg->cmsg_type = SCM_RIGHTS;
-        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
-        memcpy(CMSG_DATA(cmsg), &flattenedFd, sizeof(int));
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fdCount);
+        memcpy(CMSG_DATA(cmsg), flattenedFds.data(), sizeof(int) * fdCount);
     }
 
     int result;
@@ -21,6 +21,8 @@
 #include <gui/TraceUtils.h>
 #include <jni.h>
 
+#include <utility>
+
 #undef LOG_TAG
 #define LOG_TAG "AChoreographer"
 
@@ -153,8 +155,15 @@ void Choreographer::postFrameCallbackDelayed(AChoreographer_frameCallback cb,
     if (callback.dueTime <= now) {
         if (std::this_thread::get_id() != mThreadId) {
             if (mLooper != nullptr) {
-                Message m{MSG_SCHEDULE_VSYNC};
-                mLooper->sendMessage(this, m);
+                bool alreadyPending;
+                {
+                    std::lock_guard<std::mutex> _l{mLock};
+                    alreadyPending = std::exchange(mVsyncMessagePending, true);
+                }
+                if (!alreadyPending) {
+                    Message m{MSG_SCHEDULE_VSYNC};
+                    mLooper->sendMessage(this, m);
+                }
             } else {
                 scheduleVsync();
             }
@@ -264,7 +273,9 @@ void Choreographer::scheduleCallbacks() {
 }
 
 void Choreographer::handleRefreshRateUpdates() {
-    std::vector<RefreshRateCallback> callbacks{};
+    // Reuse the storage of the previous update.
+    std::vector<RefreshRateCallback> callbacks = std::move(mDispatchedRefreshRateCallbacks);
+    callbacks.clear();
     const nsecs_t pendingPeriod = gChoreographers.mLastKnownVsync.load();
     const nsecs_t lastPeriod = mLatestVsyncPeriod;
     if (pendingPeriod > 0) {
@@ -283,6 +294,7 @@ void Choreographer::handleRefreshRateUpdates() {
             cb.callback(pendingPeriod, cb.data);
         }
     }
+    mDispatchedRefreshRateCallbacks = std::move(callbacks);
 }
 
 void Choreographer::dispatchCallbacks(const std::vector<FrameCallback>& callbacks,
@@ -311,8 +323,13 @@ void Choreographer::dispatchCallbacks(const std::vector<FrameCallback>& callback
 
 void Choreographer::dispatchVsync(nsecs_t timestamp, PhysicalDisplayId, uint32_t,
                                   VsyncEventData vsyncEventData) {
-    std::vector<FrameCallback> animationCallbacks{};
-    std::vector<FrameCallback> inputCallbacks{};
+    // Reuse the storage of the previous frame, rather than allocating new
+    // vectors every vsync. A nested dispatch, from a callback which handles
+    // pending events itself, just starts from empty vectors.
+    std::vector<FrameCallback> animationCallbacks = std::move(mDispatchedAnimationCallbacks);
+    std::vector<FrameCallback> inputCallbacks = std::move(mDispatchedInputCallbacks);
+    animationCallbacks.clear();
+    inputCallbacks.clear();
     {
         std::lock_guard<std::mutex> _l{mLock};
         nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
@@ -335,6 +352,8 @@ void Choreographer::dispatchVsync(nsecs_t timestamp, PhysicalDisplayId, uint32_t
         ATRACE_FORMAT("CALLBACK_ANIMATION");
         dispatchCallbacks(animationCallbacks, vsyncEventData, timestamp);
     }
+    mDispatchedInputCallbacks = std::move(inputCallbacks);
+    mDispatchedAnimationCallbacks = std::move(animationCallbacks);
 }
 
 void Choreographer::dispatchHotplug(nsecs_t, PhysicalDisplayId displayId, bool connected) {
@@ -375,6 +394,12 @@ void Choreographer::handleMessage(const Message& message) {
             scheduleCallbacks();
             break;
         case MSG_SCHEDULE_VSYNC:
+            {
+                // Callbacks posted from now on need their own message, as
+                // the vsync requested below may be dispatched before them.
+                std::lock_guard<std::mutex> _l{mLock};
+                mVsyncMessagePending = false;
+            }
             scheduleVsync();
             break;
         case MSG_HANDLE_REFRESH_RATE_UPDATES:
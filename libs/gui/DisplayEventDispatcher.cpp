@@ -73,7 +73,30 @@ void DisplayEventDispatcher::dispose() {
 
     if (!mReceiver.initCheck() && mLooper != nullptr) {
         mLooper->removeFd(mReceiver.getFd());
+        if (mVsyncBroadcastEnabled) {
+            mLooper->removeFd(mReceiver.getVsyncBroadcastFd());
+        }
+    }
+}
+
+status_t DisplayEventDispatcher::enableVsyncBroadcast() {
+    if (mVsyncBroadcastEnabled) {
+        return OK;
+    }
+    if (mLooper == nullptr) {
+        return INVALID_OPERATION;
+    }
+    status_t result = mReceiver.subscribeToVsyncBroadcast();
+    if (result) {
+        ALOGW("Failed to subscribe to the vsync broadcast, status=%d", result);
+        return result;
+    }
+    int rc = mLooper->addFd(mReceiver.getVsyncBroadcastFd(), 0, Looper::EVENT_INPUT, this, NULL);
+    if (rc < 0) {
+        return UNKNOWN_ERROR;
     }
+    mVsyncBroadcastEnabled = true;
+    return OK;
 }
 
 status_t DisplayEventDispatcher::scheduleVsync() {
@@ -220,6 +243,17 @@ bool DisplayEventDispatcher::processPendingEvents(nsecs_t* outTimestamp,
     if (n < 0) {
         ALOGW("Failed to get events from display event dispatcher, status=%d", status_t(n));
     }
+
+    // Vsync events are delivered through shared memory once subscribed, but the ones which were
+    // already queued in the pipe are still read above. The one in shared memory is newer.
+    DisplayEventReceiver::Event ev;
+    if (mVsyncBroadcastEnabled && mReceiver.readVsyncBroadcast(&ev) == OK) {
+        gotVsync = true;
+        *outTimestamp = ev.header.timestamp;
+        *outDisplayId = ev.header.displayId;
+        *outCount = ev.vsync.count;
+        *outVsyncEventData = ev.vsync.vsyncData;
+    }
     return gotVsync;
 }
 
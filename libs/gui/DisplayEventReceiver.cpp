@@ -17,11 +17,14 @@
 #define LOG_TAG "DisplayEventReceiver"
 
 #include <string.h>
+#include <sys/epoll.h>
 
 #include <utils/Errors.h>
 
 #include <gui/DisplayEventReceiver.h>
+#include <gui/VsyncBroadcastPage.h>
 #include <gui/VsyncEventData.h>
+#include <gui/VsyncTimelinePage.h>
 
 #include <private/gui/ComposerServiceAIDL.h>
 
@@ -107,6 +110,76 @@ status_t DisplayEventReceiver::getLatestVsyncEventData(
     return NO_INIT;
 }
 
+status_t DisplayEventReceiver::readVsyncTimelinePage(VsyncEventData* outVsyncEventData) {
+    if (mVsyncTimelinePage == nullptr) {
+        // Only ask once, a server which couldn't provide the page won't later.
+        if (mEventConnection == nullptr || mVsyncTimelinePageRequested) {
+            return NO_INIT;
+        }
+        mVsyncTimelinePageRequested = true;
+        os::ParcelFileDescriptor fd;
+        auto status = mEventConnection->getVsyncTimelinePage(&fd);
+        if (!status.isOk()) {
+            ALOGE("Failed to get vsync timeline page: %s", status.toString8().c_str());
+            return NO_INIT;
+        }
+        mVsyncTimelinePage = gui::VsyncTimelinePage::map(fd.release());
+        if (mVsyncTimelinePage == nullptr) {
+            return NO_INIT;
+        }
+    }
+    return mVsyncTimelinePage->read(outVsyncEventData);
+}
+
+status_t DisplayEventReceiver::subscribeToVsyncBroadcast() {
+    if (mEventConnection == nullptr) {
+        return NO_INIT;
+    }
+    if (mVsyncBroadcastPage != nullptr) {
+        return NO_ERROR;
+    }
+
+    gui::VsyncBroadcastSubscription subscription;
+    auto status = mEventConnection->subscribeToVsyncBroadcast(&subscription);
+    if (!status.isOk()) {
+        ALOGE("Failed to subscribe to the vsync broadcast: %s", status.toString8().c_str());
+        return status.transactionError() != OK ? status.transactionError() : UNKNOWN_ERROR;
+    }
+    auto page = gui::VsyncBroadcastPage::map(subscription.page.release());
+    if (page == nullptr) {
+        return NO_MEMORY;
+    }
+    base::unique_fd epollFd(epoll_create1(EPOLL_CLOEXEC));
+    if (!epollFd.ok()) {
+        const int error = errno;
+        ALOGE("epoll_create1 failed: %s", strerror(error));
+        return -error;
+    }
+    struct epoll_event wakeEvent = {.events = EPOLLIN | EPOLLET};
+    if (epoll_ctl(epollFd.get(), EPOLL_CTL_ADD, subscription.wakeEvent.get(), &wakeEvent) == -1) {
+        const int error = errno;
+        ALOGE("Failed to poll the vsync broadcast eventfd: %s", strerror(error));
+        return -error;
+    }
+    mVsyncBroadcastPage = std::move(page);
+    mVsyncBroadcastWakeFd = subscription.wakeEvent.release();
+    mVsyncBroadcastEpollFd = std::move(epollFd);
+    return NO_ERROR;
+}
+
+int DisplayEventReceiver::getVsyncBroadcastFd() const {
+    return mVsyncBroadcastEpollFd.ok() ? mVsyncBroadcastEpollFd.get() : NO_INIT;
+}
+
+status_t DisplayEventReceiver::readVsyncBroadcast(Event* outEvent) {
+    if (mVsyncBroadcastPage == nullptr) {
+        return NO_INIT;
+    }
+    struct epoll_event wakeEvent;
+    epoll_wait(mVsyncBroadcastEpollFd.get(), &wakeEvent, 1, 0);
+    return mVsyncBroadcastPage->readNext(&mVsyncBroadcastSequence, outEvent);
+}
+
 ssize_t DisplayEventReceiver::getEvents(DisplayEventReceiver::Event* events,
         size_t count) {
     return DisplayEventReceiver::getEvents(mDataChannel.get(), events, count);
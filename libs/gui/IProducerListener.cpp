@@ -28,6 +28,8 @@ enum {
     ON_BUFFER_DETACHED,
     ON_BUFFER_ATTACHED,
     NEEDS_ATTACH_NOTIFY,
+    ON_CONSUMER_CONFIG_CHANGED,
+    NEEDS_CONSUMER_CONFIG_NOTIFY,
 };
 
 class BpProducerListener : public BpInterface<IProducerListener>
@@ -99,6 +101,29 @@ public:
         return result;
     }
 #endif
+
+    virtual void onConsumerConfigChanged() {
+        Parcel data, reply;
+        data.writeInterfaceToken(IProducerListener::getInterfaceDescriptor());
+        remote()->transact(ON_CONSUMER_CONFIG_CHANGED, data, &reply, IBinder::FLAG_ONEWAY);
+    }
+
+    virtual bool needsConsumerConfigNotify() {
+        bool result;
+        Parcel data, reply;
+        data.writeInterfaceToken(IProducerListener::getInterfaceDescriptor());
+        status_t err = remote()->transact(NEEDS_CONSUMER_CONFIG_NOTIFY, data, &reply);
+        if (err != NO_ERROR) {
+            ALOGE("IProducerListener: binder call \'needsConsumerConfigNotify\' failed");
+            return false;
+        }
+        err = reply.readBool(&result);
+        if (err != NO_ERROR) {
+            ALOGE("IProducerListener: malformed binder reply");
+            return false;
+        }
+        return result;
+    }
 };
 
 // Out-of-line virtual method definition to trigger vtable emission in this
@@ -171,6 +196,14 @@ status_t BnProducerListener::onTransact(uint32_t code, const Parcel& data,
             reply->writeBool(needsAttachNotify());
             return NO_ERROR;
 #endif
+        case ON_CONSUMER_CONFIG_CHANGED:
+            CHECK_INTERFACE(IProducerListener, data, reply);
+            onConsumerConfigChanged();
+            return NO_ERROR;
+        case NEEDS_CONSUMER_CONFIG_NOTIFY:
+            CHECK_INTERFACE(IProducerListener, data, reply);
+            reply->writeBool(needsConsumerConfigNotify());
+            return NO_ERROR;
     }
     return BBinder::onTransact(code, data, reply, flags);
 }
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "SharedSeqlock"
+
+#include <private/gui/SharedSeqlock.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <log/log.h>
+
+namespace android::gui {
+
+void* createSealedSharedMemory(const char* name, size_t size, base::unique_fd* outFd) {
+#ifdef __BIONIC__
+    base::unique_fd fd(memfd_create(name, MFD_CLOEXEC | MFD_ALLOW_SEALING));
+    if (!fd.ok()) {
+        ALOGE("%s: memfd_create failed: %s", __func__, strerror(errno));
+        return nullptr;
+    }
+    if (ftruncate(fd.get(), size) == -1) {
+        ALOGE("%s: ftruncate failed: %s", __func__, strerror(errno));
+        return nullptr;
+    }
+    void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd.get(), 0);
+    if (addr == MAP_FAILED) {
+        ALOGE("%s: mmap failed: %s", __func__, strerror(errno));
+        return nullptr;
+    }
+    // Our mapping stays writable, but nobody else can create one.
+    if (fcntl(fd.get(), F_ADD_SEALS,
+              F_SEAL_FUTURE_WRITE | F_SEAL_GROW | F_SEAL_SHRINK | F_SEAL_SEAL) == -1) {
+        ALOGE("%s: sealing failed: %s", __func__, strerror(errno));
+        munmap(addr, size);
+        return nullptr;
+    }
+    *outFd = std::move(fd);
+    return addr;
+#else
+    (void)name;
+    (void)size;
+    (void)outFd;
+    return nullptr;
+#endif
+}
+
+void* mapSharedMemory(const base::unique_fd& fd, size_t size) {
+    struct stat st;
+    if (fstat(fd.get(), &st) == -1 || st.st_size < static_cast<off_t>(size)) {
+        ALOGE("%s: invalid shared memory fd", __func__);
+        return nullptr;
+    }
+    void* addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd.get(), 0);
+    if (addr == MAP_FAILED) {
+        ALOGE("%s: mmap failed: %s", __func__, strerror(errno));
+        return nullptr;
+    }
+    return addr;
+}
+
+} // namespace android::gui
@@ -286,8 +286,7 @@ Surface::Surface(const sp<IGraphicBufferProducer>& bufferProducer, bool controll
         mSharedBufferHasBeenQueued(false),
         mQueriedSupportedTimestamps(false),
         mFrameTimestampsSupportsPresent(false),
-        mEnableFrameTimestamps(false),
-        mFrameEventHistory(std::make_unique<ProducerFrameEventHistory>()) {
+        mEnableFrameTimestamps(false) {
     // Initialize the ANativeWindow function pointers.
     ANativeWindow::setSwapInterval  = hook_setSwapInterval;
     ANativeWindow::dequeueBuffer    = hook_dequeueBuffer;
@@ -389,7 +388,11 @@ String8 Surface::getConsumerName() const {
 }
 
 status_t Surface::setDequeueTimeout(nsecs_t timeout) {
-    return mGraphicBufferProducer->setDequeueTimeout(timeout);
+    status_t err = mGraphicBufferProducer->setDequeueTimeout(timeout);
+    // Whether dequeueBuffer can block changes the min undequeued buffer count.
+    Mutex::Autolock lock(mMutex);
+    invalidateQueryCacheLocked();
+    return err;
 }
 
 status_t Surface::getLastQueuedBuffer(sp<GraphicBuffer>* outBuffer,
@@ -417,6 +420,11 @@ void Surface::enableFrameTimestamps(bool enable) {
     // If going from disabled to enabled, get the initial values for
     // compositor and display timing.
     if (!mEnableFrameTimestamps && enable) {
+        // Most producers never enable frame timestamps, so the history is
+        // only allocated the first time they do. It is kept from then on.
+        if (mFrameEventHistory == nullptr) {
+            mFrameEventHistory = std::make_unique<ProducerFrameEventHistory>();
+        }
         FrameEventHistoryDelta delta;
         mGraphicBufferProducer->getFrameTimestamps(&delta);
         mFrameEventHistory->applyDelta(delta);
@@ -774,6 +782,8 @@ int Surface::setSwapInterval(int interval) {
 
     if (mSwapIntervalZero != wasSwapIntervalZero) {
         mGraphicBufferProducer->setAsyncMode(mSwapIntervalZero);
+        Mutex::Autolock lock(mMutex);
+        invalidateQueryCacheLocked();
     }
 
     return NO_ERROR;
@@ -1624,6 +1634,7 @@ void Surface::querySupportedTimestampsLocked() const {
 int Surface::query(int what, int* value) const {
     ATRACE_CALL();
     ALOGV("Surface::query");
+    bool cacheable = false;
     { // scope for the lock
         Mutex::Autolock lock(mMutex);
         switch (what) {
@@ -1712,8 +1723,56 @@ int Surface::query(int what, int* value) const {
                 return NO_ERROR;
             }
         }
+
+        if (mQueryCacheEnabled && isCacheableQuery(what)) {
+            const uint32_t generation = mListenerProxy->getConsumerConfigGeneration();
+            if (generation != mQueryCacheGeneration) {
+                mQueryCache.clear();
+                mQueryCacheGeneration = generation;
+            }
+            auto it = mQueryCache.find(what);
+            if (it != mQueryCache.end()) {
+                *value = it->second;
+                return NO_ERROR;
+            }
+            cacheable = true;
+        }
+    }
+
+    status_t err = mGraphicBufferProducer->query(what, value);
+    if (cacheable && err == NO_ERROR) {
+        Mutex::Autolock lock(mMutex);
+        // Skip the answer if the consumer changed its settings while we asked for it.
+        if (mQueryCacheEnabled &&
+            mListenerProxy->getConsumerConfigGeneration() == mQueryCacheGeneration) {
+            mQueryCache[what] = *value;
+        }
+    }
+    return err;
+}
+
+bool Surface::isCacheableQuery(int what) {
+    switch (what) {
+        case NATIVE_WINDOW_WIDTH:
+        case NATIVE_WINDOW_HEIGHT:
+        case NATIVE_WINDOW_FORMAT:
+        case NATIVE_WINDOW_LAYER_COUNT:
+        case NATIVE_WINDOW_MIN_UNDEQUEUED_BUFFERS:
+        case NATIVE_WINDOW_CONSUMER_USAGE_BITS:
+        case NATIVE_WINDOW_DEFAULT_DATASPACE:
+        case NATIVE_WINDOW_CONSUMER_IS_PROTECTED:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void Surface::invalidateQueryCacheLocked() {
+    mQueryCache.clear();
+    if (mListenerProxy != nullptr) {
+        // Also drops the answers of queries in flight.
+        mListenerProxy->onConsumerConfigChanged();
     }
-    return mGraphicBufferProducer->query(what, value);
 }
 
 int Surface::perform(int operation, va_list args)
@@ -2275,6 +2334,9 @@ int Surface::connect(int api, const sp<SurfaceListener>& listener, bool reportBu
         mDefaultHeight = output.height;
         mNextFrameNumber = output.nextFrameNumber;
         mMaxBufferCount = output.maxBufferCount;
+        invalidateQueryCacheLocked();
+        mQueryCacheEnabled =
+                mListenerProxy != nullptr && mListenerProxy->isConsumerConfigNotifyEnabled();
 
         // Ignore transform hint if sticky transform is set or transform to display inverse flag is
         // set. Transform hint should be ignored if the client is expected to always submit buffers
@@ -2330,6 +2392,8 @@ int Surface::disconnect(int api, IGraphicBufferProducer::DisconnectMode mode) {
         mAutoPrerotation = false;
         mEnableFrameTimestamps = false;
         mMaxBufferCount = NUM_BUFFER_SLOTS;
+        mQueryCacheEnabled = false;
+        invalidateQueryCacheLocked();
 
         if (api == NATIVE_WINDOW_API_CPU) {
             mConnectedToCpu = false;
@@ -2509,6 +2573,7 @@ int Surface::setAsyncMode(bool async) {
     status_t err = mGraphicBufferProducer->setAsyncMode(async);
     ALOGE_IF(err, "IGraphicBufferProducer::setAsyncMode(%d) returned %s",
             async, strerror(-err));
+    invalidateQueryCacheLocked();
 
     return err;
 }
@@ -1077,14 +1077,22 @@ SurfaceComposerClient::Transaction& SurfaceComposerClient::Transaction::merge(Tr
     }
     mMergedTransactionIds.insert(mMergedTransactionIds.begin(), other.mId);
 
-    for (auto const& [handle, composerState] : other.mComposerStates) {
-        if (mComposerStates.count(handle) == 0) {
-            mComposerStates[handle] = composerState;
-        } else {
+    // other is cleared below, so its states can be moved rather than copied. If we have none,
+    // take its whole table.
+    if (mComposerStates.empty()) {
+        mComposerStates = std::move(other.mComposerStates);
+    } else {
+        mComposerStates.reserve(mComposerStates.size() + other.mComposerStates.size());
+        for (auto& [handle, composerState] : other.mComposerStates) {
+            auto [it, inserted] = mComposerStates.try_emplace(handle, std::move(composerState));
+            if (inserted) {
+                continue;
+            }
+            layer_state_t& state = it->second.state;
             if (composerState.state.what & layer_state_t::eBufferChanged) {
-                releaseBufferIfOverwriting(mComposerStates[handle].state);
+                releaseBufferIfOverwriting(state);
             }
-            mComposerStates[handle].state.merge(composerState.state);
+            state.merge(composerState.state);
         }
     }
 
@@ -1187,7 +1195,7 @@ void SurfaceComposerClient::Transaction::cacheBuffers() {
 
     size_t count = 0;
     for (auto& [handle, cs] : mComposerStates) {
-        layer_state_t* s = &(mComposerStates[handle].state);
+        layer_state_t* s = &cs.state;
         if (!(s->what & layer_state_t::eBufferChanged)) {
             continue;
         } else if (s->bufferData &&
@@ -1454,17 +1462,14 @@ void SurfaceComposerClient::Transaction::setEarlyWakeupEnd() {
 layer_state_t* SurfaceComposerClient::Transaction::getLayerState(const sp<SurfaceControl>& sc) {
     auto handle = sc->getLayerStateHandle();
 
-    if (mComposerStates.count(handle) == 0) {
-        // we don't have it, add an initialized layer_state to our list
-        ComposerState s;
-
-        s.state.surface = handle;
-        s.state.layerId = sc->getLayerId();
-
-        mComposerStates[handle] = s;
+    auto [it, inserted] = mComposerStates.try_emplace(handle);
+    if (inserted) {
+        // we didn't have it, initialize the new layer_state
+        it->second.state.surface = handle;
+        it->second.state.layerId = sc->getLayerId();
     }
 
-    return &(mComposerStates[handle].state);
+    return &(it->second.state);
 }
 
 void SurfaceComposerClient::Transaction::registerSurfaceControlForCallback(
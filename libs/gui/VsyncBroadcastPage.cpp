@@ -0,0 +1,81 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "VsyncBroadcastPage"
+
+#include <gui/VsyncBroadcastPage.h>
+
+#include <sys/mman.h>
+
+#include <log/log.h>
+#include <private/gui/SharedSeqlock.h>
+
+namespace android::gui {
+
+struct VsyncBroadcastPage::Layout : SharedSeqlock<DisplayEventReceiver::Event> {};
+
+std::unique_ptr<VsyncBroadcastPage> VsyncBroadcastPage::create() {
+    base::unique_fd fd;
+    void* addr = createSealedSharedMemory("VsyncBroadcastPage", sizeof(Layout), &fd);
+    if (!addr) {
+        return nullptr;
+    }
+    return std::unique_ptr<VsyncBroadcastPage>(
+            new VsyncBroadcastPage(std::move(fd), static_cast<Layout*>(addr), true));
+}
+
+std::unique_ptr<VsyncBroadcastPage> VsyncBroadcastPage::map(base::unique_fd fd) {
+    void* addr = mapSharedMemory(fd, sizeof(Layout));
+    if (!addr) {
+        return nullptr;
+    }
+    return std::unique_ptr<VsyncBroadcastPage>(
+            new VsyncBroadcastPage(std::move(fd), static_cast<Layout*>(addr), false));
+}
+
+VsyncBroadcastPage::VsyncBroadcastPage(base::unique_fd fd, Layout* layout, bool writable)
+      : mFd(std::move(fd)), mLayout(layout), mWritable(writable) {}
+
+VsyncBroadcastPage::~VsyncBroadcastPage() {
+    munmap(mLayout, sizeof(Layout));
+}
+
+void VsyncBroadcastPage::write(const DisplayEventReceiver::Event& event) {
+    LOG_ALWAYS_FATAL_IF(!mWritable, "Writing to a read-only VsyncBroadcastPage");
+    mLayout->write(event);
+}
+
+status_t VsyncBroadcastPage::readNext(uint64_t* inOutSequence,
+                                      DisplayEventReceiver::Event* outEvent) const {
+    DisplayEventReceiver::Event event;
+    uint64_t sequence;
+    switch (const status_t status = mLayout->read(&event, &sequence)) {
+        case OK:
+            break;
+        case NO_INIT:
+            return NOT_ENOUGH_DATA;
+        default:
+            return status;
+    }
+    if (sequence <= *inOutSequence) {
+        return NOT_ENOUGH_DATA;
+    }
+    *inOutSequence = sequence;
+    *outEvent = event;
+    return OK;
+}
+
+} // namespace android::gui
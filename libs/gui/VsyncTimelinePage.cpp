@@ -0,0 +1,65 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "VsyncTimelinePage"
+
+#include <gui/VsyncTimelinePage.h>
+
+#include <sys/mman.h>
+
+#include <log/log.h>
+#include <private/gui/SharedSeqlock.h>
+
+namespace android::gui {
+
+struct VsyncTimelinePage::Layout : SharedSeqlock<VsyncEventData> {};
+
+std::unique_ptr<VsyncTimelinePage> VsyncTimelinePage::create() {
+    base::unique_fd fd;
+    void* addr = createSealedSharedMemory("VsyncTimelinePage", sizeof(Layout), &fd);
+    if (!addr) {
+        return nullptr;
+    }
+    return std::unique_ptr<VsyncTimelinePage>(
+            new VsyncTimelinePage(std::move(fd), static_cast<Layout*>(addr), true));
+}
+
+std::unique_ptr<VsyncTimelinePage> VsyncTimelinePage::map(base::unique_fd fd) {
+    void* addr = mapSharedMemory(fd, sizeof(Layout));
+    if (!addr) {
+        return nullptr;
+    }
+    return std::unique_ptr<VsyncTimelinePage>(
+            new VsyncTimelinePage(std::move(fd), static_cast<Layout*>(addr), false));
+}
+
+VsyncTimelinePage::VsyncTimelinePage(base::unique_fd fd, Layout* layout, bool writable)
+      : mFd(std::move(fd)), mLayout(layout), mWritable(writable) {}
+
+VsyncTimelinePage::~VsyncTimelinePage() {
+    munmap(mLayout, sizeof(Layout));
+}
+
+void VsyncTimelinePage::write(const VsyncEventData& vsyncEventData) {
+    LOG_ALWAYS_FATAL_IF(!mWritable, "Writing to a read-only VsyncTimelinePage");
+    mLayout->write(vsyncEventData);
+}
+
+status_t VsyncTimelinePage::read(VsyncEventData* outVsyncEventData) const {
+    return mLayout->read(outVsyncEventData);
+}
+
+} // namespace android::gui
@@ -19,6 +19,10 @@
 #include <gui/WindowInfosListenerReporter.h>
 #include "gui/WindowInfosUpdate.h"
 
+#include <cinttypes>
+#include <optional>
+#include <unordered_map>
+
 namespace android {
 
 using gui::DisplayInfo;
@@ -78,6 +82,8 @@ status_t WindowInfosListenerReporter::removeWindowInfosListener(
             // stale values
             mLastWindowInfos.clear();
             mLastDisplayInfos.clear();
+            mLastWindowIds.clear();
+            mWaitingForFullUpdate = false;
         }
 
         if (status == OK) {
@@ -92,26 +98,102 @@ binder::Status WindowInfosListenerReporter::onWindowInfosChanged(
         const gui::WindowInfosUpdate& update) {
     std::unordered_set<sp<WindowInfosListener>, gui::SpHash<WindowInfosListener>>
             windowInfosListeners;
+    std::optional<gui::WindowInfosUpdate> expandedUpdate;
+    bool requestFullUpdate = false;
 
     {
         std::scoped_lock lock(mListenersMutex);
-        for (auto listener : mWindowInfosListeners) {
-            windowInfosListeners.insert(listener);
+        if (update.isIncremental) {
+            if (!mWaitingForFullUpdate && !applyIncrementalUpdateLocked(update)) {
+                ALOGE("Could not apply incremental window infos update for vsync %" PRId64,
+                      update.vsyncId);
+                mWaitingForFullUpdate = true;
+                requestFullUpdate = true;
+            }
+            if (!mWaitingForFullUpdate) {
+                expandedUpdate.emplace(mLastWindowInfos, update.displayInfos, update.vsyncId,
+                                       update.timestamp);
+            }
+        } else {
+            mLastWindowInfos = update.windowInfos;
+            if (update.windowIds.size() == update.windowInfos.size()) {
+                mLastWindowIds = update.windowIds;
+            } else {
+                mLastWindowIds.clear();
+                for (const auto& windowInfo : update.windowInfos) {
+                    mLastWindowIds.push_back(windowInfo.id);
+                }
+            }
+            mWaitingForFullUpdate = false;
         }
 
-        mLastWindowInfos = update.windowInfos;
-        mLastDisplayInfos = update.displayInfos;
+        if (!mWaitingForFullUpdate) {
+            for (auto listener : mWindowInfosListeners) {
+                windowInfosListeners.insert(listener);
+            }
+            mLastDisplayInfos = update.displayInfos;
+        }
     }
 
+    const gui::WindowInfosUpdate& fullUpdate = expandedUpdate ? *expandedUpdate : update;
     for (auto listener : windowInfosListeners) {
-        listener->onWindowInfosChanged(update);
+        listener->onWindowInfosChanged(fullUpdate);
     }
 
+    if (requestFullUpdate) {
+        mWindowInfosPublisher->requestFullWindowInfos(mListenerId);
+    }
     mWindowInfosPublisher->ackWindowInfosReceived(update.vsyncId, mListenerId);
 
     return binder::Status::ok();
 }
 
+bool WindowInfosListenerReporter::applyIncrementalUpdateLocked(
+        const gui::WindowInfosUpdate& update) {
+    if (update.changedWindows.size() != update.windowIds.size()) {
+        return false;
+    }
+    std::unordered_map<int32_t, size_t> lastWindowIndices;
+    lastWindowIndices.reserve(mLastWindowIds.size());
+    for (size_t i = 0; i < mLastWindowIds.size(); i++) {
+        lastWindowIndices.try_emplace(mLastWindowIds[i], i);
+    }
+
+    // Check the whole update before taking anything from mLastWindowInfos.
+    std::vector<size_t> sourceIndices;
+    sourceIndices.reserve(update.windowIds.size());
+    size_t changedCount = 0;
+    for (size_t i = 0; i < update.windowIds.size(); i++) {
+        if (update.changedWindows[i]) {
+            sourceIndices.push_back(changedCount++);
+            continue;
+        }
+        auto it = lastWindowIndices.find(update.windowIds[i]);
+        if (it == lastWindowIndices.end()) {
+            return false;
+        }
+        sourceIndices.push_back(it->second);
+    }
+    if (changedCount != update.windowInfos.size()) {
+        return false;
+    }
+
+    std::vector<WindowInfo> windowInfos;
+    windowInfos.reserve(update.windowIds.size());
+    for (size_t i = 0; i < update.windowIds.size(); i++) {
+        if (update.changedWindows[i]) {
+            windowInfos.push_back(update.windowInfos[sourceIndices[i]]);
+        } else {
+            // SurfaceFlinger does not send incremental updates with duplicate ids, so each
+            // previous window is taken at most once.
+            windowInfos.push_back(std::move(mLastWindowInfos[sourceIndices[i]]));
+        }
+    }
+    mLastWindowInfos = std::move(windowInfos);
+    mLastWindowIds = update.windowIds;
+    return true;
+}
+
 void WindowInfosListenerReporter::reconnect(const sp<gui::ISurfaceComposer>& composerService) {
     std::scoped_lock lock(mListenersMutex);
     if (!mWindowInfosListeners.empty()) {
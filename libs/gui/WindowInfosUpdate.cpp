@@ -44,6 +44,10 @@ status_t WindowInfosUpdate::readFromParcel(const android::Parcel* parcel) {
     SAFE_PARCEL(parcel->readInt64, &vsyncId);
     SAFE_PARCEL(parcel->readInt64, &timestamp);
 
+    SAFE_PARCEL(parcel->readInt32Vector, &windowIds);
+    SAFE_PARCEL(parcel->readBool, &isIncremental);
+    SAFE_PARCEL(parcel->readBoolVector, &changedWindows);
+
     return OK;
 }
 
@@ -66,6 +70,10 @@ status_t WindowInfosUpdate::writeToParcel(android::Parcel* parcel) const {
     SAFE_PARCEL(parcel->writeInt64, vsyncId);
     SAFE_PARCEL(parcel->writeInt64, timestamp);
 
+    SAFE_PARCEL(parcel->writeInt32Vector, windowIds);
+    SAFE_PARCEL(parcel->writeBool, isIncremental);
+    SAFE_PARCEL(parcel->writeBoolVector, changedWindows);
+
     return OK;
 }
 
@@ -18,6 +18,7 @@
 #define ANDROID_GUI_BLAST_BUFFER_QUEUE_H
 
 #include <com_android_graphics_libgui_flags.h>
+#include <gui/BLASTFrameBatcher.h>
 #include <gui/BufferItem.h>
 #include <gui/BufferItemConsumer.h>
 #include <gui/IGraphicBufferConsumer.h>
@@ -143,6 +144,14 @@ public:
      */
     void setTransactionHangCallback(std::function<void(const std::string&)> callback);
     void setApplyToken(sp<IBinder>);
+
+    /**
+     * Hand the transactions of this queue to a batcher shared with other queues of this process,
+     * so buffer updates for the same vsync are applied together. While a batcher is set its apply
+     * token is used instead of ours. Pass nullptr to apply transactions directly again. Best set
+     * before the first frame is queued.
+     */
+    void setFrameBatcher(const sp<BLASTFrameBatcher>& batcher);
     virtual ~BLASTBufferQueue();
 
     void onFirstRef() override;
@@ -168,6 +177,12 @@ private:
     void mergePendingTransactions(SurfaceComposerClient::Transaction* t, uint64_t frameNumber)
             REQUIRES(mMutex);
 
+    // Applies t on our apply token, or hands it to mFrameBatcher. vsyncId is the vsync the frame
+    // in t was drawn for, if any.
+    void applyTransactionLocked(SurfaceComposerClient::Transaction* t,
+                                int64_t vsyncId = FrameTimelineInfo::INVALID_VSYNC_ID)
+            REQUIRES(mMutex);
+
     void flushShadowQueue() REQUIRES(mMutex);
     void acquireAndReleaseBuffer() REQUIRES(mMutex);
     void releaseBuffer(const ReleaseCallbackId& callbackId, const sp<Fence>& releaseFence)
@@ -273,6 +288,8 @@ private:
     // transactions from other parts of the client from blocking this transaction.
     sp<IBinder> mApplyToken GUARDED_BY(mMutex) = sp<BBinder>::make();
 
+    sp<BLASTFrameBatcher> mFrameBatcher GUARDED_BY(mMutex);
+
     // Guards access to mDequeueTimestamps since we cannot hold to mMutex in onFrameDequeued or
     // we will deadlock.
     std::mutex mTimestampMutex;
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_GUI_BLAST_FRAME_BATCHER_H
+#define ANDROID_GUI_BLAST_FRAME_BATCHER_H
+
+#include <android-base/thread_annotations.h>
+#include <binder/Binder.h>
+#include <gui/SurfaceComposerClient.h>
+#include <utils/RefBase.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace android {
+
+class BLASTBufferQueue;
+
+// Merges the buffer updates of several BLASTBufferQueues into one applied
+// transaction per vsync.
+//
+// An app with several SurfaceViews otherwise sends one transaction per
+// surface per frame. BLASTBufferQueues which share a batcher through
+// BLASTBufferQueue::setFrameBatcher() hand it every transaction they would
+// have applied. Transactions tagged with the same vsync id are merged, and
+// the batch is applied when:
+//  - every queue which announced a frame for that vsync (through
+//    BLASTBufferQueue::setFrameTimelineInfo) has submitted it,
+//  - a transaction for another vsync id, or without one, is submitted, or
+//  - maxDelay has passed since the first transaction of the batch.
+//
+// All transactions are applied on the batcher's apply token, so they stay
+// ordered with each other.
+class BLASTFrameBatcher : public RefBase {
+public:
+    explicit BLASTFrameBatcher(
+            std::chrono::nanoseconds maxDelay = std::chrono::milliseconds(4));
+    ~BLASTFrameBatcher() override;
+
+    sp<IBinder> getApplyToken() const { return mApplyToken; }
+
+    // Applies the pending batch, if any.
+    void flush() EXCLUDES(mMutex);
+
+private:
+    friend class BLASTBufferQueue;
+
+    // queue expects to submit a transaction for vsyncId.
+    void expectFrame(const BLASTBufferQueue* queue, int64_t vsyncId) EXCLUDES(mMutex);
+    // queue will not submit the frame it announced for vsyncId.
+    void cancelFrame(const BLASTBufferQueue* queue, int64_t vsyncId) EXCLUDES(mMutex);
+    // Drops every expectation of queue, which no longer uses this batcher.
+    void removeQueue(const BLASTBufferQueue* queue) EXCLUDES(mMutex);
+
+    // Takes the contents of t, and batches or applies it. vsyncId is
+    // FrameTimelineInfo::INVALID_VSYNC_ID for transactions which must not
+    // wait, which are applied right after the pending batch.
+    void submit(const BLASTBufferQueue* queue, int64_t vsyncId,
+                SurfaceComposerClient::Transaction* t) EXCLUDES(mMutex);
+
+    void flushLocked() REQUIRES(mMutex);
+    void flushIfCompleteLocked() REQUIRES(mMutex);
+    void threadMain() EXCLUDES(mMutex);
+
+    const std::chrono::nanoseconds mMaxDelay;
+    const sp<IBinder> mApplyToken = sp<BBinder>::make();
+
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    bool mStopped GUARDED_BY(mMutex) = false;
+
+    bool mHasPending GUARDED_BY(mMutex) = false;
+    int64_t mPendingVsyncId GUARDED_BY(mMutex) = 0;
+    std::chrono::steady_clock::time_point mPendingDeadline GUARDED_BY(mMutex);
+    SurfaceComposerClient::Transaction mPending GUARDED_BY(mMutex);
+
+    // Queues which announced a frame, by vsync id.
+    std::map<int64_t, std::multiset<const BLASTBufferQueue*>> mExpected GUARDED_BY(mMutex);
+
+    // Applies batches whose deadline has passed.
+    std::thread mThread;
+};
+
+} // namespace android
+
+#endif // ANDROID_GUI_BLAST_FRAME_BATCHER_H
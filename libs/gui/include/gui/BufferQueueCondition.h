@@ -0,0 +1,66 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_GUI_BUFFERQUEUECONDITION_H
+#define ANDROID_GUI_BUFFERQUEUECONDITION_H
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace android {
+
+// A std::condition_variable which only signals when some thread is waiting
+// on it.
+//
+// BufferQueue broadcasts on every acquire, release, queue and cancel, but a
+// waiter is rare: in the common in-process case the producer and consumer
+// just alternate. A broadcast on a condition variable is a futex syscall
+// even when nobody waits, so this skips it when the waiter count is zero.
+//
+// The waiter count is protected by the mutex passed to wait(), so every
+// notify_all() must be made with that same mutex held.
+class BufferQueueCondition {
+public:
+    void wait(std::unique_lock<std::mutex>& lock) {
+        mWaiters++;
+        mCondition.wait(lock);
+        mWaiters--;
+    }
+
+    template <class Rep, class Period>
+    std::cv_status wait_for(std::unique_lock<std::mutex>& lock,
+                            const std::chrono::duration<Rep, Period>& timeout) {
+        mWaiters++;
+        std::cv_status result = mCondition.wait_for(lock, timeout);
+        mWaiters--;
+        return result;
+    }
+
+    void notify_all() {
+        if (mWaiters > 0) {
+            mCondition.notify_all();
+        }
+    }
+
+private:
+    std::condition_variable mCondition;
+    int mWaiters = 0;
+};
+
+} // namespace android
+
+#endif // ANDROID_GUI_BUFFERQUEUECONDITION_H
@@ -179,6 +179,10 @@ public:
     void setAllowExtraAcquire(bool /* allow */);
 
 private:
+    // Returns the producer listener to notify with onConsumerConfigChanged, if
+    // it asked for it. Lock mCore->mMutex while calling.
+    sp<IProducerListener> getConsumerConfigListenerLocked() const;
+
     sp<BufferQueueCore> mCore;
 
     // This references mCore->mSlots. Lock mCore->mMutex while accessing.
@@ -21,8 +21,10 @@
 
 #include <gui/AdditionalOptions.h>
 #include <gui/BufferItem.h>
+#include <gui/BufferQueueCondition.h>
 #include <gui/BufferQueueDefs.h>
 #include <gui/BufferSlot.h>
+#include <gui/BufferSlotSet.h>
 #include <gui/OccupancyTracker.h>
 
 #include <utils/NativeHandle.h>
@@ -196,6 +198,11 @@ private:
     // callback is registered by the listener. When set to false,
     // mConnectedProducerListener will not trigger onBufferAttached() callback.
     bool mBufferAttachedCbEnabled;
+    // mConsumerConfigCbEnabled is used to indicate whether
+    // onConsumerConfigChanged() callback is registered by the listener. When
+    // set to false, mConnectedProducerListener will not trigger
+    // onConsumerConfigChanged() callback.
+    bool mConsumerConfigCbEnabled;
 
     // mSlots is an array of buffer slots that must be mirrored on the producer
     // side. This allows buffer ownership to be transferred between the producer
@@ -209,22 +216,22 @@ private:
 
     // mFreeSlots contains all of the slots which are FREE and do not currently
     // have a buffer attached.
-    std::set<int> mFreeSlots;
+    BufferSlotSet mFreeSlots;
 
     // mFreeBuffers contains all of the slots which are FREE and currently have
     // a buffer attached.
-    std::list<int> mFreeBuffers;
+    BufferSlotList mFreeBuffers;
 
     // mUnusedSlots contains all slots that are currently unused. They should be
     // free and not have a buffer attached.
-    std::list<int> mUnusedSlots;
+    BufferSlotList mUnusedSlots;
 
     // mActiveBuffers contains all slots which have a non-FREE buffer attached.
-    std::set<int> mActiveBuffers;
+    BufferSlotSet mActiveBuffers;
 
     // mDequeueCondition is a condition variable used for dequeueBuffer in
     // synchronous mode.
-    mutable std::condition_variable mDequeueCondition;
+    mutable BufferQueueCondition mDequeueCondition;
 
     // mDequeueBufferCannotBlock indicates whether dequeueBuffer is allowed to
     // block. This flag is set during connect when both the producer and
@@ -298,7 +305,7 @@ private:
 
     // mIsAllocatingCondition is a condition variable used by producers to wait until mIsAllocating
     // becomes false.
-    mutable std::condition_variable mIsAllocatingCondition;
+    mutable BufferQueueCondition mIsAllocatingCondition;
 
     // mAllowAllocation determines whether dequeueBuffer is allowed to allocate
     // new buffers
@@ -18,10 +18,16 @@
 #define ANDROID_GUI_BUFFERQUEUEPRODUCER_H
 
 #include <gui/AdditionalOptions.h>
+#include <gui/BufferItem.h>
+#include <gui/BufferQueueCondition.h>
 #include <gui/BufferQueueDefs.h>
 
+#include <gui/IConsumerListener.h>
 #include <gui/IGraphicBufferProducer.h>
 
+#include <optional>
+#include <vector>
+
 namespace android {
 
 class IBinder;
@@ -47,6 +53,11 @@ public:
     // flags indicating that previously-returned buffers are no longer valid.
     virtual status_t requestBuffer(int slot, sp<GraphicBuffer>* buf);
 
+    // See IGraphicBufferProducer::requestBuffers. Takes the BufferQueue lock
+    // once for the whole batch.
+    status_t requestBuffers(const std::vector<int32_t>& slots,
+                            std::vector<RequestBufferOutput>* outputs) override;
+
     // see IGraphicsBufferProducer::setMaxDequeuedBufferCount
     virtual status_t setMaxDequeuedBufferCount(int maxDequeuedBuffers);
 
@@ -93,6 +104,12 @@ public:
                                    uint64_t* outBufferAge,
                                    FrameEventHistoryDelta* outTimestamps) override;
 
+    // See IGraphicBufferProducer::dequeueBuffers. Slots are claimed under a
+    // single acquisition of the BufferQueue lock, which is only dropped while
+    // waiting for a free slot or allocating a buffer, as dequeueBuffer does.
+    status_t dequeueBuffers(const std::vector<DequeueBufferInput>& inputs,
+                            std::vector<DequeueBufferOutput>* outputs) override;
+
     // See IGraphicBufferProducer::detachBuffer
     virtual status_t detachBuffer(int slot);
 
@@ -121,6 +138,12 @@ public:
     virtual status_t queueBuffer(int slot,
             const QueueBufferInput& input, QueueBufferOutput* output);
 
+    // See IGraphicBufferProducer::queueBuffers. All buffers are queued under
+    // one acquisition of the BufferQueue lock; consumer callbacks are then
+    // made in queue order.
+    status_t queueBuffers(const std::vector<QueueBufferInput>& inputs,
+                          std::vector<QueueBufferOutput>* outputs) override;
+
     // cancelBuffer returns a dequeued buffer to the BufferQueue, but doesn't
     // queue it for use by the consumer.
     //
@@ -128,6 +151,11 @@ public:
     // will usually be the one obtained from dequeueBuffer.
     virtual status_t cancelBuffer(int slot, const sp<Fence>& fence);
 
+    // See IGraphicBufferProducer::cancelBuffers. Takes the BufferQueue lock
+    // once for the whole batch.
+    status_t cancelBuffers(const std::vector<CancelBufferInput>& inputs,
+                           std::vector<status_t>* results) override;
+
     // Query native window attributes.  The "what" values are enumerated in
     // window.h (e.g. NATIVE_WINDOW_FORMAT).
     virtual int query(int what, int* outValue);
@@ -245,6 +273,75 @@ private:
     status_t waitForFreeSlotThenRelock(FreeSlotCaller caller, std::unique_lock<std::mutex>& lock,
             int* found) const;
 
+    // The single and batched versions of requestBuffer, dequeueBuffer,
+    // queueBuffer and cancelBuffer share these steps. The *Locked steps must
+    // be called with mCore->mMutex held, the others without.
+    status_t requestBufferLocked(int slot, sp<GraphicBuffer>* buf);
+
+    // State of one dequeue, carried from dequeueBufferLocked, which claims
+    // the slot, to allocateDequeuedBuffer, which allocates a new buffer for
+    // it if BUFFER_NEEDS_REALLOCATION is set, to finishDequeueBuffer, which
+    // notifies the consumer and returns the dequeue flags.
+    struct DequeueState {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        PixelFormat format = 0;
+        uint64_t usage = 0;
+
+        int slot = BufferItem::INVALID_BUFFER_SLOT;
+        sp<Fence> fence;
+        uint64_t bufferAge = 0;
+        status_t returnFlags = NO_ERROR;
+        EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+        EGLSyncKHR eglFence = EGL_NO_SYNC_KHR;
+        bool attachedByConsumer = false;
+
+        sp<IConsumerListener> listener;
+        bool callOnFrameDequeued = false;
+        uint64_t bufferId = 0; // Only used if callOnFrameDequeued == true
+#if COM_ANDROID_GRAPHICS_LIBGUI_FLAGS(BQ_EXTENDEDALLOCATE)
+        std::vector<gui::AdditionalOptions> allocOptions;
+        uint32_t allocOptionsGenId = 0;
+#endif
+    };
+    status_t dequeueBufferLocked(std::unique_lock<std::mutex>& lock, DequeueState* state);
+    status_t allocateDequeuedBuffer(DequeueState* state);
+    status_t finishDequeueBuffer(DequeueState* state);
+
+    // State of one queue, carried from prepareQueueBuffer, which validates
+    // the input, to queueBufferLocked, which queues the buffer, to
+    // finishQueueBuffer, which makes the consumer callbacks.
+    struct QueueState {
+        const QueueBufferInput* input = nullptr;
+        int64_t requestedPresentTimestamp = 0;
+        bool isAutoTimestamp = false;
+        android_dataspace dataSpace = HAL_DATASPACE_UNKNOWN;
+        Rect crop = Rect::EMPTY_RECT;
+        int scalingMode = 0;
+        uint32_t transform = 0;
+        uint32_t stickyTransform = 0;
+        sp<Fence> acquireFence;
+        bool getFrameTimestamps = false;
+        std::shared_ptr<FenceTime> acquireFenceTime;
+
+        sp<IConsumerListener> frameAvailableListener;
+        sp<IConsumerListener> frameReplacedListener;
+        int callbackTicket = 0;
+        uint64_t currentFrameNumber = 0;
+        BufferItem item;
+        int connectedApi = 0;
+        bool enableEglCpuThrottling = true;
+        sp<Fence> lastQueuedFence;
+    };
+    status_t prepareQueueBuffer(const QueueBufferInput& input, QueueState* state) const;
+    status_t queueBufferLocked(int slot, QueueState* state, QueueBufferOutput* output);
+    void finishQueueBuffer(QueueState* state, QueueBufferOutput* output);
+
+    // Sets outCancelledBufferId to the id of the cancelled buffer, if the
+    // slot has one.
+    status_t cancelBufferLocked(int slot, const sp<Fence>& fence,
+                                std::optional<uint64_t>* outCancelledBufferId);
+
     sp<BufferQueueCore> mCore;
 
     // This references mCore->mSlots. Lock mCore->mMutex while accessing.
@@ -278,7 +375,7 @@ private:
     std::mutex mCallbackMutex;
     int mNextCallbackTicket; // Protected by mCore->mMutex
     int mCurrentCallbackTicket; // Protected by mCallbackMutex
-    std::condition_variable mCallbackCondition;
+    BufferQueueCondition mCallbackCondition;
 
     // Sets how long dequeueBuffer or attachBuffer will block if a buffer or
     // slot is not yet available.
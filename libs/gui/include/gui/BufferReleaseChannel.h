@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <deque>
 #include <string>
 #include <vector>
 
@@ -53,6 +54,36 @@ private:
     };
 
 public:
+    struct Message : public Flattenable<Message> {
+        ReleaseCallbackId releaseCallbackId;
+        sp<Fence> releaseFence = Fence::NO_FENCE;
+        uint32_t maxAcquiredBufferCount;
+
+        Message() = default;
+        Message(ReleaseCallbackId releaseCallbackId, sp<Fence> releaseFence,
+                uint32_t maxAcquiredBufferCount)
+              : releaseCallbackId{releaseCallbackId},
+                releaseFence{std::move(releaseFence)},
+                maxAcquiredBufferCount{maxAcquiredBufferCount} {}
+
+        // Flattenable protocol
+        size_t getFlattenedSize() const;
+
+        size_t getFdCount() const { return releaseFence->getFdCount(); }
+
+        status_t flatten(void*& buffer, size_t& size, int*& fds, size_t& count) const;
+
+        status_t unflatten(void const*& buffer, size_t& size, int const*& fds, size_t& count);
+
+    private:
+        size_t getPodSize() const;
+    };
+
+    /**
+     * Maximum number of release fences sent in a single socket message.
+     */
+    static constexpr size_t kMaxBatchSize = 32;
+
     class ConsumerEndpoint : public Endpoint {
     public:
         ConsumerEndpoint(std::string name, android::base::unique_fd fd)
@@ -68,8 +99,17 @@ public:
         status_t readReleaseFence(ReleaseCallbackId& outReleaseCallbackId,
                                   sp<Fence>& outReleaseFence, uint32_t& maxAcquiredBufferCount);
 
+        /**
+         * Returns true if a batch read earlier still holds release fences, in which case
+         * readReleaseFence returns one without reading from the socket.
+         */
+        bool hasPendingReleaseFences() const { return !mPendingMessages.empty(); }
+
     private:
+        status_t readMessages();
+
         std::vector<uint8_t> mFlattenedBuffer;
+        std::deque<Message> mPendingMessages;
     };
 
     class ProducerEndpoint : public Endpoint, public Parcelable {
@@ -84,7 +124,15 @@ public:
         status_t writeReleaseFence(const ReleaseCallbackId&, const sp<Fence>& releaseFence,
                                    uint32_t maxAcquiredBufferCount);
 
+        /**
+         * Writes several release fences, kMaxBatchSize at a time, so the consumer can read them
+         * all with one recvmsg for each batch.
+         */
+        status_t writeReleaseFences(const std::vector<Message>& messages);
+
     private:
+        status_t writeMessages(const Message* messages, size_t count);
+
         std::vector<uint8_t> mFlattenedBuffer;
     };
 
@@ -95,31 +143,6 @@ public:
      */
     static status_t open(const std::string name, std::unique_ptr<ConsumerEndpoint>& outConsumer,
                          std::shared_ptr<ProducerEndpoint>& outProducer);
-
-    struct Message : public Flattenable<Message> {
-        ReleaseCallbackId releaseCallbackId;
-        sp<Fence> releaseFence = Fence::NO_FENCE;
-        uint32_t maxAcquiredBufferCount;
-
-        Message() = default;
-        Message(ReleaseCallbackId releaseCallbackId, sp<Fence> releaseFence,
-                uint32_t maxAcquiredBufferCount)
-              : releaseCallbackId{releaseCallbackId},
-                releaseFence{std::move(releaseFence)},
-                maxAcquiredBufferCount{maxAcquiredBufferCount} {}
-
-        // Flattenable protocol
-        size_t getFlattenedSize() const;
-
-        size_t getFdCount() const { return releaseFence->getFdCount(); }
-
-        status_t flatten(void*& buffer, size_t& size, int*& fds, size_t& count) const;
-
-        status_t unflatten(void const*& buffer, size_t& size, int const*& fds, size_t& count);
-
-    private:
-        size_t getPodSize() const;
-    };
 };
 
 } // namespace android::gui
@@ -0,0 +1,182 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_GUI_BUFFERSLOTSET_H
+#define ANDROID_GUI_BUFFERSLOTSET_H
+
+#include <ui/BufferQueueDefs.h>
+
+#include <log/log.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+namespace android {
+
+// Fixed-capacity replacements for the std::set<int> and std::list<int> which
+// BufferQueueCore uses to track slots. Slot numbers are in
+// [0, NUM_BUFFER_SLOTS) and a slot is in at most one of these at a time, so
+// nothing here ever allocates.
+
+// An ordered set of slots, iterated in increasing slot order.
+class BufferSlotSet {
+public:
+    static_assert(BufferQueueDefs::NUM_BUFFER_SLOTS <= 64);
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const int*;
+        using reference = int;
+
+        const_iterator() = default;
+        explicit const_iterator(uint64_t bits) : mBits(bits) {}
+
+        int operator*() const { return __builtin_ctzll(mBits); }
+        const_iterator& operator++() {
+            mBits &= mBits - 1;
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator it = *this;
+            ++*this;
+            return it;
+        }
+        bool operator==(const const_iterator& other) const { return mBits == other.mBits; }
+        bool operator!=(const const_iterator& other) const { return mBits != other.mBits; }
+
+    private:
+        // the slots not yet visited
+        uint64_t mBits = 0;
+    };
+    using iterator = const_iterator;
+
+    const_iterator begin() const { return const_iterator(mBits); }
+    const_iterator end() const { return const_iterator(); }
+
+    void insert(int slot) { mBits |= bit(slot); }
+    void erase(int slot) { mBits &= ~bit(slot); }
+    void erase(const_iterator it) { erase(*it); }
+    void clear() { mBits = 0; }
+
+    size_t count(int slot) const { return (mBits & bit(slot)) != 0 ? 1 : 0; }
+    size_t size() const { return __builtin_popcountll(mBits); }
+    bool empty() const { return mBits == 0; }
+
+private:
+    static uint64_t bit(int slot) {
+        LOG_ALWAYS_FATAL_IF(slot < 0 || slot >= BufferQueueDefs::NUM_BUFFER_SLOTS,
+                            "Slot %d out of range", slot);
+        return uint64_t(1) << slot;
+    }
+
+    uint64_t mBits = 0;
+};
+
+// A double-ended queue of slots, keeping the order in which they were added.
+class BufferSlotList {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const int*;
+        using reference = const int&;
+
+        const_iterator() = default;
+        const_iterator(const BufferSlotList* list, size_t index) : mList(list), mIndex(index) {}
+
+        const int& operator*() const { return mList->at(mIndex); }
+        const_iterator& operator++() {
+            mIndex++;
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator it = *this;
+            ++*this;
+            return it;
+        }
+        bool operator==(const const_iterator& other) const { return mIndex == other.mIndex; }
+        bool operator!=(const const_iterator& other) const { return mIndex != other.mIndex; }
+
+    private:
+        const BufferSlotList* mList = nullptr;
+        size_t mIndex = 0;
+    };
+    using iterator = const_iterator;
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, mSize); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    int front() const { return at(0); }
+    int back() const { return at(mSize - 1); }
+
+    void push_back(int slot) {
+        LOG_ALWAYS_FATAL_IF(mSize == kCapacity, "BufferSlotList full");
+        mSlots[(mHead + mSize) % kCapacity] = slot;
+        mSize++;
+    }
+    void push_front(int slot) {
+        LOG_ALWAYS_FATAL_IF(mSize == kCapacity, "BufferSlotList full");
+        mHead = (mHead + kCapacity - 1) % kCapacity;
+        mSlots[mHead] = slot;
+        mSize++;
+    }
+    void pop_front() {
+        LOG_ALWAYS_FATAL_IF(mSize == 0, "BufferSlotList empty");
+        mHead = (mHead + 1) % kCapacity;
+        mSize--;
+    }
+    void pop_back() {
+        LOG_ALWAYS_FATAL_IF(mSize == 0, "BufferSlotList empty");
+        mSize--;
+    }
+    // Removes every occurrence of slot, keeping the order of the others.
+    void remove(int slot) {
+        size_t kept = 0;
+        for (size_t i = 0; i < mSize; i++) {
+            int s = at(i);
+            if (s != slot) mSlots[(mHead + kept++) % kCapacity] = s;
+        }
+        mSize = kept;
+    }
+    void clear() {
+        mHead = 0;
+        mSize = 0;
+    }
+
+    size_t size() const { return mSize; }
+    bool empty() const { return mSize == 0; }
+
+private:
+    static constexpr size_t kCapacity = BufferQueueDefs::NUM_BUFFER_SLOTS;
+
+    const int& at(size_t index) const { return mSlots[(mHead + index) % kCapacity]; }
+
+    int mSlots[kCapacity] = {};
+    size_t mHead = 0;
+    size_t mSize = 0;
+};
+
+} // namespace android
+
+#endif // ANDROID_GUI_BUFFERSLOTSET_H
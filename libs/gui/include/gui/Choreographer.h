@@ -137,6 +137,16 @@ private:
     // Protected by mLock
     std::priority_queue<FrameCallback> mFrameCallbacks;
     std::vector<RefreshRateCallback> mRefreshRateCallbacks;
+    // Whether a MSG_SCHEDULE_VSYNC is already posted to the looper, so that
+    // callbacks posted from other threads before it is handled share it.
+    bool mVsyncMessagePending = false;
+
+    // Storage for the callbacks dispatched on a vsync or refresh rate change,
+    // kept between dispatches so that it is reused from one frame to the
+    // next. Only used on the looper thread.
+    std::vector<FrameCallback> mDispatchedInputCallbacks;
+    std::vector<FrameCallback> mDispatchedAnimationCallbacks;
+    std::vector<RefreshRateCallback> mDispatchedRefreshRateCallbacks;
 
     nsecs_t mLatestVsyncPeriod = -1;
     VsyncEventData mLastVsyncEventData;
@@ -31,6 +31,9 @@ public:
 
     status_t initialize();
     void dispose();
+    // Makes SurfaceFlinger deliver vsync events through shared memory rather than the pipe,
+    // which is cheaper for it when many apps draw at once. Must be called after initialize().
+    status_t enableVsyncBroadcast();
     status_t scheduleVsync();
     void injectEvent(const DisplayEventReceiver::Event& event);
     int getFd() const;
@@ -46,6 +49,7 @@ private:
     bool mWaitingForVsync;
     uint32_t mLastVsyncCount;
     nsecs_t mLastScheduleVsyncTime;
+    bool mVsyncBroadcastEnabled = false;
 
     std::vector<FrameRateOverride> mFrameRateOverrides;
 
@@ -20,6 +20,7 @@
 #include <stdint.h>
 #include <sys/types.h>
 
+#include <android-base/unique_fd.h>
 #include <ftl/flags.h>
 
 #include <utils/Errors.h>
@@ -46,6 +47,8 @@ using gui::VsyncEventData;
 
 namespace gui {
 class BitTube;
+class VsyncBroadcastPage;
+class VsyncTimelinePage;
 } // namespace gui
 
 static inline constexpr uint32_t fourcc(char c1, char c2, char c3, char c4) {
@@ -188,10 +191,55 @@ public:
      */
     status_t getLatestVsyncEventData(ParcelableVsyncEventData* outVsyncEventData) const;
 
+    /**
+     * readVsyncTimelinePage() reads the vsync event data which SurfaceFlinger
+     * last published for this connection, from shared memory. Only the first
+     * call makes a binder call, to map the page. The frame timelines are
+     * refreshed on every vsync SurfaceFlinger dispatches, so they may have
+     * expired if none was requested recently. Returns NO_INIT if the page is
+     * unavailable, in which case getLatestVsyncEventData() should be used.
+     */
+    status_t readVsyncTimelinePage(VsyncEventData* outVsyncEventData);
+
+    /**
+     * subscribeToVsyncBroadcast() makes SurfaceFlinger deliver vsync events
+     * through shared memory instead of the fd from getFd(), which saves it a
+     * write per vsync. The vsync events must then be read with
+     * readVsyncBroadcast() once getVsyncBroadcastFd() becomes readable. Other
+     * events are still read with getEvents().
+     */
+    status_t subscribeToVsyncBroadcast();
+
+    /*
+     * getVsyncBroadcastFd returns the file descriptor which becomes readable
+     * when SurfaceFlinger may have delivered a vsync event through the vsync
+     * broadcast. It is shared with other connections, so a wakeup does not
+     * mean that there is a new event.
+     * OWNERSHIP IS RETAINED by DisplayEventReceiver. DO NOT CLOSE this
+     * file-descriptor.
+     */
+    int getVsyncBroadcastFd() const;
+
+    /**
+     * readVsyncBroadcast() reads the latest vsync event delivered through the
+     * vsync broadcast, and clears the readiness of getVsyncBroadcastFd().
+     * Returns NOT_ENOUGH_DATA if no vsync event was delivered since the last
+     * call.
+     */
+    status_t readVsyncBroadcast(Event* outEvent);
+
 private:
     sp<IDisplayEventConnection> mEventConnection;
     std::unique_ptr<gui::BitTube> mDataChannel;
     std::optional<status_t> mInitError;
+    std::unique_ptr<gui::VsyncTimelinePage> mVsyncTimelinePage;
+    bool mVsyncTimelinePageRequested = false;
+    std::unique_ptr<gui::VsyncBroadcastPage> mVsyncBroadcastPage;
+    base::unique_fd mVsyncBroadcastWakeFd;
+    // An epoll fd holding the shared wake eventfd, edge triggered, so that
+    // each subscriber can clear its own readiness without reading the eventfd.
+    base::unique_fd mVsyncBroadcastEpollFd;
+    uint64_t mVsyncBroadcastSequence = 0;
 };
 
 inline bool operator==(DisplayEventReceiver::Event::FrameRateOverride lhs,
@@ -67,6 +67,17 @@ public:
     virtual void onBufferAttached() {} // Asynchronous
     virtual bool needsAttachNotify() { return false; }
 #endif
+    // onConsumerConfigChanged is called when a consumer setting that the
+    // producer can query changes: the default buffer size, format or
+    // dataspace, the consumer usage bits, whether the consumer is protected,
+    // the max acquired buffer count, or whether the consumer was abandoned.
+    //
+    // This is called without any lock held and can be called concurrently by
+    // multiple threads. This callback is enabled only when
+    // needsConsumerConfigNotify() returns {@code true}, which the consumer
+    // asks on connect.
+    virtual void onConsumerConfigChanged() {} // Asynchronous
+    virtual bool needsConsumerConfigNotify() { return false; }
 };
 
 #ifndef NO_BINDER
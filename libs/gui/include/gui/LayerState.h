@@ -224,9 +224,14 @@ struct layer_state_t {
         eBufferReleaseChannelChanged = 0x40000'00000000,
     };
 
+    // Written first by write(). Bump it whenever the parcel layout changes.
+    static constexpr uint32_t kParcelFormatVersion = 2;
+
     layer_state_t();
 
     void merge(const layer_state_t& other);
+    // Writes only the fields whose change flag is set in what, plus the surface, layer id, what
+    // and listeners.
     status_t write(Parcel& output) const;
     status_t read(const Parcel& input);
     // Compares two layer_state_t structs and returns a set of change flags describing all the
@@ -31,7 +31,9 @@
 #include <utils/Mutex.h>
 #include <utils/RefBase.h>
 
+#include <atomic>
 #include <shared_mutex>
+#include <unordered_map>
 #include <unordered_set>
 
 namespace android {
@@ -496,9 +498,24 @@ protected:
             return mSurfaceListener->needsAttachNotify();
         }
 #endif
+
+        // The consumer asks during connect, so by the time connect returns
+        // this tells whether it will report changes to its settings.
+        virtual bool needsConsumerConfigNotify() {
+            mConsumerConfigNotifyEnabled = true;
+            return true;
+        }
+
+        virtual void onConsumerConfigChanged() { mConsumerConfigGeneration++; }
+
+        bool isConsumerConfigNotifyEnabled() const { return mConsumerConfigNotifyEnabled; }
+        uint32_t getConsumerConfigGeneration() const { return mConsumerConfigGeneration; }
+
     private:
         wp<Surface> mParent;
         sp<SurfaceListener> mSurfaceListener;
+        std::atomic<bool> mConsumerConfigNotifyEnabled{false};
+        std::atomic<uint32_t> mConsumerConfigGeneration{0};
     };
 
 #if COM_ANDROID_GRAPHICS_LIBGUI_FLAGS(WB_PLATFORM_API_IMPROVEMENTS)
@@ -518,6 +535,12 @@ protected:
 
     void querySupportedTimestampsLocked() const;
 
+    // Whether query() may cache the answer of mGraphicBufferProducer to what,
+    // which only changes with the settings of the consumer.
+    static bool isCacheableQuery(int what);
+    // Drops the cached query answers, after a change that may affect them.
+    void invalidateQueryCacheLocked();
+
     void freeAllBuffers();
     int getSlotFromBufferLocked(android_native_buffer_t* buffer) const;
 
@@ -723,6 +746,8 @@ protected:
 
     // A cached copy of the FrameEventHistory maintained by the consumer.
     bool mEnableFrameTimestamps = false;
+    // Created the first time frame timestamps are enabled, and only used
+    // while they are.
     std::unique_ptr<ProducerFrameEventHistory> mFrameEventHistory;
 
     // Reference to the SurfaceFlinger layer that was used to create this
@@ -734,7 +759,16 @@ protected:
     std::vector<sp<GraphicBuffer>> mRemovedBuffers;
     int mMaxBufferCount;
 
-    sp<IProducerListener> mListenerProxy;
+    sp<ProducerListenerProxy> mListenerProxy;
+
+    // Answers of mGraphicBufferProducer to the queries that isCacheableQuery()
+    // accepts, so that apps calling ANativeWindow_getWidth and the like every
+    // frame don't make a binder call each time. Only used while connected to a
+    // consumer that reports its changes, and only valid for the consumer
+    // config generation of mListenerProxy they were queried in.
+    bool mQueryCacheEnabled = false;
+    mutable uint32_t mQueryCacheGeneration = 0;
+    mutable std::unordered_map<int, int> mQueryCache;
 
     // Get and flush the buffers of given slots, if the buffer in the slot
     // is currently dequeued then it won't be flushed and won't be returned
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <android-base/unique_fd.h>
+#include <gui/DisplayEventReceiver.h>
+#include <utils/Errors.h>
+
+#include <cstdint>
+#include <memory>
+
+namespace android::gui {
+
+// A page of shared memory through which SurfaceFlinger delivers the vsync events of a display
+// event connection subscribed to the vsync broadcast, instead of writing them to its BitTube.
+//
+// SurfaceFlinger rewrites the page with every vsync event the connection consumes, then wakes
+// all the subscribers of the EventThread at once, through one eventfd. The client maps the
+// page read-only, from the fd returned by IDisplayEventConnection::subscribeToVsyncBroadcast().
+// The page only holds the last event, which is all a DisplayEventDispatcher keeps anyway.
+class VsyncBroadcastPage {
+public:
+    // Creates a writable page. Returns nullptr on failure.
+    static std::unique_ptr<VsyncBroadcastPage> create();
+    // Maps a page created by another process, read-only. Returns nullptr on failure.
+    static std::unique_ptr<VsyncBroadcastPage> map(base::unique_fd fd);
+
+    ~VsyncBroadcastPage();
+
+    // The fd to send to the reader. The page is sealed, so it can only be mapped read-only
+    // from this fd.
+    const base::unique_fd& getFd() const { return mFd; }
+
+    // Publishes a vsync event. Must only be called on a page from create(), by one thread at a
+    // time.
+    void write(const DisplayEventReceiver::Event& event);
+
+    // Reads the last published event if it is newer than *inOutSequence, and updates
+    // *inOutSequence to it. Start from a sequence of 0. Returns NOT_ENOUGH_DATA if there is no
+    // newer event, and WOULD_BLOCK if the page kept changing while it was being read, in which
+    // case the writer will wake the reader again once it is done.
+    status_t readNext(uint64_t* inOutSequence, DisplayEventReceiver::Event* outEvent) const;
+
+private:
+    struct Layout;
+
+    VsyncBroadcastPage(base::unique_fd fd, Layout* layout, bool writable);
+    VsyncBroadcastPage(const VsyncBroadcastPage&) = delete;
+    VsyncBroadcastPage& operator=(const VsyncBroadcastPage&) = delete;
+
+    const base::unique_fd mFd;
+    Layout* const mLayout;
+    const bool mWritable;
+};
+
+} // namespace android::gui
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <android-base/unique_fd.h>
+#include <gui/VsyncEventData.h>
+#include <utils/Errors.h>
+
+#include <memory>
+
+namespace android::gui {
+
+// A page of shared memory through which SurfaceFlinger publishes the frame
+// timelines of a display event connection, so that its client can read the
+// latest ones at any time without a binder call.
+//
+// SurfaceFlinger creates the page and rewrites it on every vsync it
+// dispatches. The client maps the page read-only, from the fd returned by
+// IDisplayEventConnection::getVsyncTimelinePage(). Writes are published
+// under a sequence counter, so a reader never sees a torn update.
+class VsyncTimelinePage {
+public:
+    // Creates a writable page. Returns nullptr on failure.
+    static std::unique_ptr<VsyncTimelinePage> create();
+    // Maps a page created by another process, read-only. Returns nullptr on
+    // failure.
+    static std::unique_ptr<VsyncTimelinePage> map(base::unique_fd fd);
+
+    ~VsyncTimelinePage();
+
+    // The fd to send to the reader. The page is sealed, so it can only be
+    // mapped read-only from this fd.
+    const base::unique_fd& getFd() const { return mFd; }
+
+    // Publishes vsyncEventData. Must only be called on a page from create(),
+    // by one thread at a time.
+    void write(const VsyncEventData& vsyncEventData);
+
+    // Reads the last published vsync event data. Its frame timelines may have
+    // expired if the connection hasn't received a vsync in a while, so
+    // callers should check the deadlines against the current time.
+    // Returns NO_INIT if nothing was published yet, and WOULD_BLOCK if the
+    // page kept changing while it was being read.
+    status_t read(VsyncEventData* outVsyncEventData) const;
+
+private:
+    struct Layout;
+
+    VsyncTimelinePage(base::unique_fd fd, Layout* layout, bool writable);
+    VsyncTimelinePage(const VsyncTimelinePage&) = delete;
+    VsyncTimelinePage& operator=(const VsyncTimelinePage&) = delete;
+
+    const base::unique_fd mFd;
+    Layout* const mLayout;
+    const bool mWritable;
+};
+
+} // namespace android::gui
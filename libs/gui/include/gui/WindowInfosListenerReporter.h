@@ -46,6 +46,15 @@ private:
 
     std::vector<gui::WindowInfo> mLastWindowInfos GUARDED_BY(mListenersMutex);
     std::vector<gui::DisplayInfo> mLastDisplayInfos GUARDED_BY(mListenersMutex);
+    // The ids SurfaceFlinger gave to mLastWindowInfos, which incremental updates refer to.
+    std::vector<int32_t> mLastWindowIds GUARDED_BY(mListenersMutex);
+    // Set when an incremental update could not be applied. Incremental updates are dropped
+    // until SurfaceFlinger sends a full one.
+    bool mWaitingForFullUpdate GUARDED_BY(mListenersMutex) = false;
+
+    // Applies an incremental update to mLastWindowInfos. Returns false if it does not apply.
+    bool applyIncrementalUpdateLocked(const gui::WindowInfosUpdate& update)
+            REQUIRES(mListenersMutex);
 
     sp<gui::IWindowInfosPublisher> mWindowInfosPublisher;
     int64_t mListenerId;
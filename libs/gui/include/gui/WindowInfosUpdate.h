@@ -37,6 +37,18 @@ struct WindowInfosUpdate : public Parcelable {
     int64_t vsyncId;
     int64_t timestamp;
 
+    // The ids of all the windows, in z-order, as known to SurfaceFlinger. A window without a name
+    // is parceled empty and loses its id, so the id is sent separately as well.
+    std::vector<int32_t> windowIds;
+
+    // Set when the update only carries the windows which were added or changed since the
+    // previous update sent to the same listener. changedWindows then tells, for each entry of
+    // windowIds, whether that window is in windowInfos. The other windows are unchanged, and
+    // the windows which are not in windowIds were removed. WindowInfosListenerReporter expands
+    // these updates, so a WindowInfosListener always receives every window.
+    bool isIncremental = false;
+    std::vector<bool> changedWindows;
+
     status_t writeToParcel(android::Parcel*) const override;
     status_t readFromParcel(const android::Parcel*) override;
 };
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <android-base/unique_fd.h>
+#include <utils/Errors.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace android::gui {
+
+// Creates a memfd of the given size and maps it read-write. The memfd is then sealed, so that
+// other processes can only map it read-only from outFd. Returns nullptr on failure.
+void* createSealedSharedMemory(const char* name, size_t size, base::unique_fd* outFd);
+
+// Maps a memfd created by createSealedSharedMemory() in another process, read-only. Returns
+// nullptr on failure.
+void* mapSharedMemory(const base::unique_fd& fd, size_t size);
+
+// A value in shared memory, written by one process and read by others.
+//
+// The value is copied through atomic words, so that reading it while it is rewritten is not a
+// data race. The sequence counter tells the reader whether that happened.
+template <typename T>
+struct SharedSeqlock {
+    static_assert(std::is_trivially_copyable_v<T>);
+    static_assert(sizeof(T) % sizeof(uint64_t) == 0);
+    static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+    static constexpr size_t kWords = sizeof(T) / sizeof(uint64_t);
+
+    // A reader gives up after this many concurrent updates, rather than spinning on a writer
+    // which died in the middle of one.
+    static constexpr int kMaxReadAttempts = 8;
+
+    // Zero until the first write, then odd while an update is in progress.
+    std::atomic<uint64_t> sequence;
+    std::atomic<uint64_t> data[kWords];
+
+    // Must only be called by one thread at a time.
+    void write(const T& value) {
+        uint64_t words[kWords];
+        std::memcpy(words, &value, sizeof(words));
+
+        const uint64_t before = sequence.load(std::memory_order_relaxed);
+        sequence.store(before + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < kWords; i++) {
+            data[i].store(words[i], std::memory_order_relaxed);
+        }
+        sequence.store(before + 2, std::memory_order_release);
+    }
+
+    // Reads the last written value, and the sequence it was written under, which grows with
+    // every write. Returns NO_INIT if nothing was written yet, and WOULD_BLOCK if the value kept
+    // changing while it was being read.
+    status_t read(T* outValue, uint64_t* outSequence = nullptr) const {
+        uint64_t words[kWords];
+        for (int attempt = 0; attempt < kMaxReadAttempts; attempt++) {
+            const uint64_t before = sequence.load(std::memory_order_acquire);
+            if (before == 0) {
+                return NO_INIT;
+            }
+            if (before % 2 != 0) {
+                continue;
+            }
+            for (size_t i = 0; i < kWords; i++) {
+                words[i] = data[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == before) {
+                std::memcpy(outValue, words, sizeof(words));
+                if (outSequence) {
+                    *outSequence = before;
+                }
+                return OK;
+            }
+        }
+        return WOULD_BLOCK;
+    }
+};
+
+} // namespace android::gui
@@ -190,6 +190,14 @@ public:
         mBlastBufferQueueAdapter->setApplyToken(std::move(applyToken));
     }
 
+    void setFrameBatcher(const sp<BLASTFrameBatcher>& batcher) {
+        mBlastBufferQueueAdapter->setFrameBatcher(batcher);
+    }
+
+    void setFrameTimelineInfo(uint64_t frameNumber, const FrameTimelineInfo& info) {
+        mBlastBufferQueueAdapter->setFrameTimelineInfo(frameNumber, info);
+    }
+
 private:
     sp<TestBLASTBufferQueue> mBlastBufferQueueAdapter;
 };
@@ -525,6 +533,11 @@ public:
         cv.wait(lock, [this] { return mCallbackReceived; });
     }
 
+    bool waitFor(std::chrono::nanoseconds timeout) {
+        std::unique_lock lock(mMutex);
+        return cv.wait_for(lock, timeout, [this] { return mCallbackReceived; });
+    }
+
     void notify() {
         std::unique_lock lock(mMutex);
         mCallbackReceived = true;
@@ -578,6 +591,46 @@ TEST_F(BLASTBufferQueueTest, setApplyToken) {
               firstTransaction.mCallbackReceivedTimeStamp);
 }
 
+TEST_F(BLASTBufferQueueTest, FrameBatcherWaitsForAnnouncedFrames) {
+    sp<SurfaceControl> otherSurfaceControl =
+            mClient->createSurface(String8("OtherTestSurface"), mDisplayWidth, mDisplayHeight,
+                                   PIXEL_FORMAT_RGBA_8888,
+                                   ISurfaceComposerClient::eFXSurfaceBufferState,
+                                   /*parent*/ mRootSurfaceControl->getHandle());
+    sp<BLASTFrameBatcher> batcher = sp<BLASTFrameBatcher>::make(std::chrono::seconds(10));
+
+    BLASTBufferQueueHelper adapter(mSurfaceControl, mDisplayWidth, mDisplayHeight);
+    BLASTBufferQueueHelper otherAdapter(otherSurfaceControl, mDisplayWidth, mDisplayHeight);
+    adapter.setFrameBatcher(batcher);
+    otherAdapter.setFrameBatcher(batcher);
+    sp<IGraphicBufferProducer> igbProducer;
+    sp<IGraphicBufferProducer> otherIgbProducer;
+    setUpProducer(adapter, igbProducer);
+    setUpProducer(otherAdapter, otherIgbProducer);
+
+    FrameTimelineInfo info;
+    info.vsyncId = 1234;
+    adapter.setFrameTimelineInfo(1, info);
+    otherAdapter.setFrameTimelineInfo(1, info);
+
+    WaitForCommittedCallback firstFrame;
+    WaitForCommittedCallback secondFrame;
+    Transaction t;
+    t.addTransactionCommittedCallback(firstFrame.getCallback(), nullptr);
+    adapter.mergeWithNextTransaction(&t, 1);
+    queueBuffer(igbProducer, 127, 127, 127, /*presentTimeDelay*/ 0);
+
+    // The other queue announced a frame for the same vsync, so the first one is held back.
+    EXPECT_FALSE(firstFrame.waitFor(500ms));
+
+    t.addTransactionCommittedCallback(secondFrame.getCallback(), nullptr);
+    otherAdapter.mergeWithNextTransaction(&t, 1);
+    queueBuffer(otherIgbProducer, 127, 127, 127, /*presentTimeDelay*/ 0);
+
+    firstFrame.wait();
+    secondFrame.wait();
+}
+
 TEST_F(BLASTBufferQueueTest, SetCrop_Item) {
     uint8_t r = 255;
     uint8_t g = 0;
@@ -0,0 +1,212 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MockConsumer.h"
+
+#include <benchmark/benchmark.h>
+#include <gui/BufferItem.h>
+#include <gui/BufferQueue.h>
+#include <gui/IProducerListener.h>
+#include <system/window.h>
+#include <ui/GraphicBuffer.h>
+#include <utils/Timers.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Usage: atest libgui_benchmark
+
+using namespace android;
+
+namespace {
+
+// Connects both ends of a new in-process BufferQueue and attaches a buffer to
+// every slot the producer can use, so that timed loops never hit gralloc.
+bool setUpBufferQueue(benchmark::State& state, const sp<IConsumerListener>& listener,
+                      int bufferCount, sp<IGraphicBufferProducer>* outProducer,
+                      sp<IGraphicBufferConsumer>* outConsumer) {
+    sp<IGraphicBufferProducer> producer;
+    sp<IGraphicBufferConsumer> consumer;
+    BufferQueue::createBufferQueue(&producer, &consumer);
+
+    if (consumer->consumerConnect(listener, false) != OK ||
+        consumer->setMaxAcquiredBufferCount(1) != OK) {
+        state.SkipWithError("consumer setup failed");
+        return false;
+    }
+    IGraphicBufferProducer::QueueBufferOutput qbo;
+    if (producer->connect(sp<StubProducerListener>::make(), NATIVE_WINDOW_API_CPU, false, &qbo) !=
+                OK ||
+        producer->setMaxDequeuedBufferCount(bufferCount) != OK) {
+        state.SkipWithError("producer setup failed");
+        return false;
+    }
+
+    std::vector<int> slots;
+    for (int i = 0; i < bufferCount; i++) {
+        int slot;
+        sp<Fence> fence;
+        sp<GraphicBuffer> buffer;
+        status_t result = producer->dequeueBuffer(&slot, &fence, 1, 1, 0,
+                                                  GRALLOC_USAGE_SW_READ_OFTEN, nullptr, nullptr);
+        if (result < 0 || producer->requestBuffer(slot, &buffer) != OK) {
+            state.SkipWithError("buffer allocation failed");
+            return false;
+        }
+        slots.push_back(slot);
+    }
+    for (int slot : slots) {
+        producer->cancelBuffer(slot, Fence::NO_FENCE);
+    }
+
+    *outProducer = producer;
+    *outConsumer = consumer;
+    return true;
+}
+
+// Runs dequeue/queue/acquire/release cycles through an in-process
+// BufferQueue, using buffer counts from a single buffer up to the slot limit.
+// Buffers are allocated before timing, so this measures the BufferQueue
+// bookkeeping and not gralloc.
+void BM_BufferQueueCycle(benchmark::State& state) {
+    const int bufferCount = static_cast<int>(state.range(0));
+
+    sp<IGraphicBufferProducer> producer;
+    sp<IGraphicBufferConsumer> consumer;
+    if (!setUpBufferQueue(state, sp<MockConsumer>::make(), bufferCount, &producer, &consumer)) {
+        return;
+    }
+
+    IGraphicBufferProducer::QueueBufferOutput qbo;
+    const IGraphicBufferProducer::QueueBufferInput qbi(0, false, HAL_DATASPACE_UNKNOWN,
+                                                       Rect(0, 0, 1, 1),
+                                                       NATIVE_WINDOW_SCALING_MODE_FREEZE, 0,
+                                                       Fence::NO_FENCE);
+
+    for (auto _ : state) {
+        int slot;
+        sp<Fence> fence;
+        if (producer->dequeueBuffer(&slot, &fence, 1, 1, 0, GRALLOC_USAGE_SW_READ_OFTEN, nullptr,
+                                    nullptr) < 0 ||
+            producer->queueBuffer(slot, qbi, &qbo) != OK) {
+            state.SkipWithError("producer cycle failed");
+            return;
+        }
+
+        BufferItem item;
+        if (consumer->acquireBuffer(&item, 0) != OK ||
+            consumer->releaseBuffer(item.mSlot, item.mFrameNumber, EGL_NO_DISPLAY, EGL_NO_SYNC_KHR,
+                                    Fence::NO_FENCE) != OK) {
+            state.SkipWithError("consumer cycle failed");
+            return;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_BufferQueueCycle)->Arg(1)->Arg(3)->Arg(16)->Arg(62);
+
+// Wakes the consumer thread of BM_BufferQueueHandoff for every queued frame.
+struct FrameAvailableListener : public MockConsumer {
+    void onFrameAvailable(const BufferItem& /* item */) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        available++;
+        condition.notify_one();
+    }
+
+    // Returns false once stopped and no frames are left.
+    bool waitForFrame() {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this] { return available > 0 || stopped; });
+        if (available == 0) return false;
+        available--;
+        return true;
+    }
+
+    void stop() {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopped = true;
+        condition.notify_one();
+    }
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    int available = 0;
+    bool stopped = false;
+};
+
+// Hands buffers from a producer thread to a consumer thread in the same
+// process, the way BLASTBufferQueue and CpuConsumer use a BufferQueue. The
+// producer blocks in dequeueBuffer whenever the consumer falls behind.
+// handoff_us is the mean time from queueBuffer to the consumer acquiring
+// that buffer.
+void BM_BufferQueueHandoff(benchmark::State& state) {
+    const int bufferCount = static_cast<int>(state.range(0));
+
+    sp<FrameAvailableListener> listener = sp<FrameAvailableListener>::make();
+    sp<IGraphicBufferProducer> producer;
+    sp<IGraphicBufferConsumer> consumer;
+    if (!setUpBufferQueue(state, listener, bufferCount, &producer, &consumer)) {
+        return;
+    }
+
+    int64_t totalHandoffNs = 0;
+    int64_t handoffs = 0;
+    std::thread consumerThread([&] {
+        while (listener->waitForFrame()) {
+            BufferItem item;
+            if (consumer->acquireBuffer(&item, 0) != OK) continue;
+            totalHandoffNs += systemTime() - item.mTimestamp;
+            handoffs++;
+            consumer->releaseBuffer(item.mSlot, item.mFrameNumber, EGL_NO_DISPLAY,
+                                    EGL_NO_SYNC_KHR, Fence::NO_FENCE);
+        }
+    });
+
+    IGraphicBufferProducer::QueueBufferOutput qbo;
+    for (auto _ : state) {
+        int slot;
+        sp<Fence> fence;
+        if (producer->dequeueBuffer(&slot, &fence, 1, 1, 0, GRALLOC_USAGE_SW_READ_OFTEN, nullptr,
+                                    nullptr) < 0) {
+            state.SkipWithError("dequeueBuffer failed");
+            break;
+        }
+        const IGraphicBufferProducer::QueueBufferInput qbi(systemTime(), false,
+                                                           HAL_DATASPACE_UNKNOWN, Rect(0, 0, 1, 1),
+                                                           NATIVE_WINDOW_SCALING_MODE_FREEZE, 0,
+                                                           Fence::NO_FENCE);
+        if (producer->queueBuffer(slot, qbi, &qbo) != OK) {
+            state.SkipWithError("queueBuffer failed");
+            break;
+        }
+    }
+
+    listener->stop();
+    consumerThread.join();
+
+    state.SetItemsProcessed(state.iterations());
+    if (handoffs > 0) {
+        state.counters["handoff_us"] = static_cast<double>(totalHandoffNs) / handoffs / 1000.0;
+    }
+}
+
+BENCHMARK(BM_BufferQueueHandoff)->Arg(2)->Arg(3)->Arg(16)->UseRealTime();
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -135,4 +135,46 @@ TEST(BufferReleaseChannelTest, ProduceAndConsume) {
     }
 }
 
+// Verify that a batch of messages, larger than a single socket message can hold, is read back in
+// order, with fences only on the messages which had one.
+TEST(BufferReleaseChannelTest, ProduceAndConsumeBatch) {
+    std::unique_ptr<BufferReleaseChannel::ConsumerEndpoint> consumer;
+    std::shared_ptr<BufferReleaseChannel::ProducerEndpoint> producer;
+    ASSERT_EQ(OK, BufferReleaseChannel::open("test-channel"s, consumer, producer));
+
+    sp<Fence> fence = sp<Fence>::make(memfd_create("fake-fence-fd", 0));
+
+    const uint64_t count = BufferReleaseChannel::kMaxBatchSize + 8;
+    std::vector<BufferReleaseChannel::Message> messages;
+    for (uint64_t i = 0; i < count; i++) {
+        messages.emplace_back(ReleaseCallbackId{i, i + 1}, i % 2 ? fence : Fence::NO_FENCE,
+                              static_cast<uint32_t>(i + 2));
+    }
+    ASSERT_EQ(OK, producer->writeReleaseFences(messages));
+
+    for (uint64_t i = 0; i < count; i++) {
+        ReleaseCallbackId consumerId;
+        sp<Fence> consumerFence;
+        uint32_t maxAcquiredBufferCount;
+        ASSERT_EQ(OK,
+                  consumer->readReleaseFence(consumerId, consumerFence, maxAcquiredBufferCount));
+
+        ASSERT_EQ((ReleaseCallbackId{i, i + 1}), consumerId);
+        if (i % 2) {
+            ASSERT_TRUE(is_same_file(fence->get(), consumerFence->get()));
+        } else {
+            ASSERT_FALSE(consumerFence->isValid());
+        }
+        ASSERT_EQ(i + 2, maxAcquiredBufferCount);
+        ASSERT_EQ(i + 1 != BufferReleaseChannel::kMaxBatchSize && i + 1 != count,
+                  consumer->hasPendingReleaseFences());
+    }
+
+    ReleaseCallbackId consumerId;
+    sp<Fence> consumerFence;
+    uint32_t maxAcquiredBufferCount;
+    ASSERT_EQ(WOULD_BLOCK,
+              consumer->readReleaseFence(consumerId, consumerFence, maxAcquiredBufferCount));
+}
+
 } // namespace android
\ No newline at end of file
@@ -24,6 +24,7 @@
 #include <chrono>
 #include <future>
 #include <string>
+#include <thread>
 
 namespace android {
 class ChoreographerTest : public ::testing::Test {};
@@ -83,4 +84,36 @@ TEST_F(ChoreographerTest, InputCallbackBeforeAnimation) {
                                            animationCb.frameTime.count());
 }
 
+TEST_F(ChoreographerTest, CallbacksPostedFromOtherThreadsAreAllDispatched) {
+    sp<Looper> looper = Looper::prepare(0);
+    Choreographer* choreographer = Choreographer::getForThread();
+    // These share a single vsync request to the looper, and must all run.
+    static constexpr size_t kNumCallbacks = 4;
+    VsyncCallback callbacks[kNumCallbacks];
+    std::thread poster([&] {
+        for (auto& cb : callbacks) {
+            choreographer->postFrameCallbackDelayed(nullptr, nullptr, vsyncCallback, &cb, 0,
+                                                    CALLBACK_ANIMATION);
+        }
+    });
+    poster.join();
+
+    auto allReceived = [&] {
+        for (auto& cb : callbacks) {
+            if (!cb.callbackReceived()) return false;
+        }
+        return true;
+    };
+    auto startTime = std::chrono::system_clock::now();
+    do {
+        static constexpr int32_t timeoutMs = 1000;
+        int pollResult = looper->pollOnce(timeoutMs);
+        ASSERT_TRUE((pollResult != Looper::POLL_TIMEOUT) && (pollResult != Looper::POLL_ERROR))
+                << "Failed to poll looper. Poll result = " << pollResult;
+        auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now() - startTime);
+        ASSERT_LE(elapsedMs.count(), timeoutMs) << "Timed out waiting for callbacks";
+    } while (!allReceived());
+}
+
 } // namespace android
\ No newline at end of file
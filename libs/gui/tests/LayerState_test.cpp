@@ -0,0 +1,89 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <binder/Binder.h>
+#include <binder/Parcel.h>
+
+#include <gui/LayerState.h>
+
+namespace android {
+
+namespace test {
+
+TEST(LayerState, ParcellingOnlyWritesChangedFields) {
+    layer_state_t state;
+    state.surface = sp<BBinder>::make();
+    state.layerId = 7;
+    state.what = layer_state_t::ePositionChanged | layer_state_t::eAlphaChanged;
+    state.x = 12.5f;
+    state.y = -3.0f;
+    state.color.a = 0.5f;
+    // Not selected by what, so not sent.
+    state.cornerRadius = 8.0f;
+    state.shadowRadius = 4.0f;
+
+    Parcel p;
+    ASSERT_EQ(OK, state.write(p));
+    p.setDataPosition(0);
+
+    layer_state_t state2;
+    ASSERT_EQ(OK, state2.read(p));
+    ASSERT_EQ(state.surface, state2.surface);
+    ASSERT_EQ(state.layerId, state2.layerId);
+    ASSERT_EQ(state.what, state2.what);
+    ASSERT_EQ(state.x, state2.x);
+    ASSERT_EQ(state.y, state2.y);
+    ASSERT_EQ(state.color.a, state2.color.a);
+    ASSERT_EQ(layer_state_t().cornerRadius, state2.cornerRadius);
+    ASSERT_EQ(layer_state_t().shadowRadius, state2.shadowRadius);
+    ASSERT_EQ(p.dataSize(), p.dataPosition());
+}
+
+TEST(LayerState, ParcellingSizeScalesWithChangedFields) {
+    layer_state_t position;
+    position.what = layer_state_t::ePositionChanged;
+
+    layer_state_t many;
+    many.what = layer_state_t::ePositionChanged | layer_state_t::eMatrixChanged |
+            layer_state_t::eCropChanged | layer_state_t::eColorTransformChanged |
+            layer_state_t::eInputInfoChanged | layer_state_t::eMetadataChanged;
+
+    Parcel positionParcel;
+    Parcel manyParcel;
+    ASSERT_EQ(OK, position.write(positionParcel));
+    ASSERT_EQ(OK, many.write(manyParcel));
+    ASSERT_LT(positionParcel.dataSize(), manyParcel.dataSize());
+
+    manyParcel.setDataPosition(0);
+    layer_state_t many2;
+    ASSERT_EQ(OK, many2.read(manyParcel));
+    ASSERT_EQ(many.what, many2.what);
+    ASSERT_EQ(manyParcel.dataSize(), manyParcel.dataPosition());
+}
+
+TEST(LayerState, ParcellingRejectsOtherVersions) {
+    Parcel p;
+    p.writeUint32(layer_state_t::kParcelFormatVersion + 1);
+    p.setDataPosition(0);
+
+    layer_state_t state;
+    ASSERT_EQ(BAD_VALUE, state.read(p));
+}
+
+} // namespace test
+} // namespace android
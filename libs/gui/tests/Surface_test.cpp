@@ -320,6 +320,36 @@ TEST_F(SurfaceTest, QueryDefaultBuffersDataSpace) {
     ASSERT_EQ(TEST_DATASPACE, dataSpace);
 }
 
+TEST_F(SurfaceTest, FrameTimestampsCanBeEnabledAfterQueueing) {
+    sp<CpuConsumer> cpuConsumer = new CpuConsumer(1);
+    sp<Surface> surface = cpuConsumer->getSurface();
+    sp<ANativeWindow> window(surface);
+    ASSERT_EQ(NO_ERROR, native_window_api_connect(window.get(), NATIVE_WINDOW_API_CPU));
+
+    nsecs_t compositeInterval = 0;
+    EXPECT_EQ(INVALID_OPERATION,
+              native_window_get_compositor_timing(window.get(), nullptr, &compositeInterval,
+                                                  nullptr));
+
+    ANativeWindowBuffer* buffer;
+    int fenceFd;
+    ASSERT_EQ(NO_ERROR, native_window_dequeue_buffer_and_wait(window.get(), &buffer));
+    ASSERT_EQ(NO_ERROR, window->queueBuffer(window.get(), buffer, -1));
+    CpuConsumer::LockedBuffer lockedBuffer;
+    ASSERT_EQ(NO_ERROR, cpuConsumer->lockNextBuffer(&lockedBuffer));
+    ASSERT_EQ(NO_ERROR, cpuConsumer->unlockBuffer(lockedBuffer));
+
+    // The history is only created now, and works like one created up front.
+    ASSERT_EQ(NO_ERROR, native_window_enable_frame_timestamps(window.get(), true));
+    EXPECT_EQ(NO_ERROR,
+              native_window_get_compositor_timing(window.get(), nullptr, &compositeInterval,
+                                                  nullptr));
+    ASSERT_EQ(NO_ERROR, window->dequeueBuffer(window.get(), &buffer, &fenceFd));
+    ASSERT_EQ(NO_ERROR, window->queueBuffer(window.get(), buffer, fenceFd));
+
+    ASSERT_EQ(NO_ERROR, native_window_api_disconnect(window.get(), NATIVE_WINDOW_API_CPU));
+}
+
 TEST_F(SurfaceTest, SettingGenerationNumber) {
     sp<CpuConsumer> cpuConsumer = new CpuConsumer(1);
     sp<Surface> surface = cpuConsumer->getSurface();
@@ -2159,6 +2189,41 @@ TEST_F(SurfaceTest, DefaultMaxBufferCountSetAndUpdated) {
     EXPECT_EQ(BufferQueueDefs::NUM_BUFFER_SLOTS, count);
 }
 
+TEST_F(SurfaceTest, CachedQueriesFollowConsumerChanges) {
+    sp<IGraphicBufferProducer> producer;
+    sp<IGraphicBufferConsumer> consumer;
+    BufferQueue::createBufferQueue(&producer, &consumer);
+
+    sp<MockConsumer> mockConsumer(new MockConsumer);
+    consumer->consumerConnect(mockConsumer, false);
+    consumer->setDefaultBufferSize(64, 32);
+
+    sp<Surface> surface = new Surface(producer);
+    sp<ANativeWindow> window(surface);
+    ASSERT_EQ(NO_ERROR, native_window_api_connect(window.get(), NATIVE_WINDOW_API_CPU));
+
+    int width = -1;
+    int minUndequeued = -1;
+    ASSERT_EQ(NO_ERROR, window->query(window.get(), NATIVE_WINDOW_WIDTH, &width));
+    EXPECT_EQ(64, width);
+    ASSERT_EQ(NO_ERROR,
+              window->query(window.get(), NATIVE_WINDOW_MIN_UNDEQUEUED_BUFFERS, &minUndequeued));
+    EXPECT_EQ(1, minUndequeued);
+
+    // Changes on either side must not be hidden by the cached answers.
+    consumer->setDefaultBufferSize(128, 32);
+    ASSERT_EQ(NO_ERROR, window->query(window.get(), NATIVE_WINDOW_WIDTH, &width));
+    EXPECT_EQ(128, width);
+
+    ASSERT_EQ(NO_ERROR, window->setSwapInterval(window.get(), 0));
+    ASSERT_EQ(NO_ERROR,
+              window->query(window.get(), NATIVE_WINDOW_MIN_UNDEQUEUED_BUFFERS, &minUndequeued));
+    EXPECT_EQ(2, minUndequeued);
+
+    consumer->consumerDisconnect();
+    EXPECT_EQ(NO_INIT, window->query(window.get(), NATIVE_WINDOW_WIDTH, &width));
+}
+
 TEST_F(SurfaceTest, BatchOperations) {
     const int BUFFER_COUNT = 16;
     const int BATCH_SIZE = 8;
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <binder/Binder.h>
+#include <gui/SurfaceComposerClient.h>
+#include <gui/SurfaceControl.h>
+
+#include <vector>
+
+using namespace android;
+
+namespace {
+
+using Transaction = SurfaceComposerClient::Transaction;
+
+// Layers which are never sent to SurfaceFlinger, so no connection is needed.
+std::vector<sp<SurfaceControl>> makeSurfaceControls(int count) {
+    std::vector<sp<SurfaceControl>> surfaceControls;
+    for (int i = 0; i < count; i++) {
+        surfaceControls.push_back(sp<SurfaceControl>::make(nullptr, sp<BBinder>::make(), i,
+                                                           "BenchmarkLayer"));
+    }
+    return surfaceControls;
+}
+
+// Merges a transaction touching every layer into one that touches the same layers, as
+// WindowManager does when it folds per-window transactions into its global one.
+void BM_TransactionMergeOverlapping(benchmark::State& state) {
+    const auto surfaceControls = makeSurfaceControls(static_cast<int>(state.range(0)));
+    Transaction base;
+    for (const auto& sc : surfaceControls) {
+        base.setPosition(sc, 1, 1);
+    }
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        Transaction t = base;
+        Transaction other;
+        for (const auto& sc : surfaceControls) {
+            other.setPosition(sc, 2, 2).setAlpha(sc, 0.5f);
+        }
+        state.ResumeTiming();
+
+        t.merge(std::move(other));
+        benchmark::DoNotOptimize(t);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_TransactionMergeOverlapping)->Arg(16)->Arg(128)->Arg(512);
+
+// Merges a transaction into an empty one, the common case when transactions are collected
+// before being applied.
+void BM_TransactionMergeIntoEmpty(benchmark::State& state) {
+    const auto surfaceControls = makeSurfaceControls(static_cast<int>(state.range(0)));
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        Transaction t;
+        Transaction other;
+        for (const auto& sc : surfaceControls) {
+            other.setPosition(sc, 2, 2).setAlpha(sc, 0.5f);
+        }
+        state.ResumeTiming();
+
+        t.merge(std::move(other));
+        benchmark::DoNotOptimize(t);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_TransactionMergeIntoEmpty)->Arg(16)->Arg(128)->Arg(512);
+
+} // namespace
@@ -18,7 +18,11 @@
 
 #include <binder/Parcel.h>
 
+#include <gui/VsyncBroadcastPage.h>
 #include <gui/VsyncEventData.h>
+#include <gui/VsyncTimelinePage.h>
+
+#include <sys/mman.h>
 
 namespace android {
 
@@ -56,5 +60,84 @@ TEST(ParcelableVsyncEventData, Parcelling) {
     }
 }
 
+TEST(VsyncTimelinePage, ReadsWhatWasWritten) {
+    auto page = gui::VsyncTimelinePage::create();
+    ASSERT_NE(nullptr, page);
+    auto reader = gui::VsyncTimelinePage::map(base::unique_fd(dup(page->getFd().get())));
+    ASSERT_NE(nullptr, reader);
+
+    VsyncEventData data;
+    EXPECT_EQ(NO_INIT, reader->read(&data));
+
+    VsyncEventData written{};
+    written.frameInterval = 8333333;
+    written.preferredFrameTimelineIndex = 1;
+    written.frameTimelines[0] = FrameTimeline{1, 2, 3};
+    written.frameTimelines[1] = FrameTimeline{4, 5, 6};
+    written.frameTimelinesLength = 2;
+    page->write(written);
+
+    ASSERT_EQ(OK, reader->read(&data));
+    EXPECT_EQ(written.frameInterval, data.frameInterval);
+    EXPECT_EQ(written.preferredFrameTimelineIndex, data.preferredFrameTimelineIndex);
+    ASSERT_EQ(written.frameTimelinesLength, data.frameTimelinesLength);
+    for (uint32_t i = 0; i < data.frameTimelinesLength; i++) {
+        EXPECT_EQ(written.frameTimelines[i].vsyncId, data.frameTimelines[i].vsyncId);
+        EXPECT_EQ(written.frameTimelines[i].deadlineTimestamp,
+                  data.frameTimelines[i].deadlineTimestamp);
+        EXPECT_EQ(written.frameTimelines[i].expectedPresentationTime,
+                  data.frameTimelines[i].expectedPresentationTime);
+    }
+}
+
+TEST(VsyncTimelinePage, CannotBeMappedWritable) {
+    auto page = gui::VsyncTimelinePage::create();
+    ASSERT_NE(nullptr, page);
+    void* addr = mmap(nullptr, getpagesize(), PROT_READ | PROT_WRITE, MAP_SHARED,
+                      page->getFd().get(), 0);
+    EXPECT_EQ(MAP_FAILED, addr);
+}
+
+TEST(VsyncBroadcastPage, ReadsEachEventOnce) {
+    auto page = gui::VsyncBroadcastPage::create();
+    ASSERT_NE(nullptr, page);
+    auto reader = gui::VsyncBroadcastPage::map(base::unique_fd(dup(page->getFd().get())));
+    ASSERT_NE(nullptr, reader);
+
+    uint64_t sequence = 0;
+    DisplayEventReceiver::Event event;
+    EXPECT_EQ(NOT_ENOUGH_DATA, reader->readNext(&sequence, &event));
+
+    DisplayEventReceiver::Event written{};
+    written.header.type = DisplayEventReceiver::DISPLAY_EVENT_VSYNC;
+    written.header.timestamp = 123;
+    written.vsync.count = 1;
+    written.vsync.vsyncData.frameTimelines[0] = FrameTimeline{1, 2, 3};
+    written.vsync.vsyncData.frameTimelinesLength = 1;
+    page->write(written);
+
+    ASSERT_EQ(OK, reader->readNext(&sequence, &event));
+    EXPECT_EQ(written.header.timestamp, event.header.timestamp);
+    EXPECT_EQ(written.vsync.count, event.vsync.count);
+    EXPECT_EQ(1, event.vsync.vsyncData.frameTimelines[0].vsyncId);
+    EXPECT_EQ(NOT_ENOUGH_DATA, reader->readNext(&sequence, &event));
+
+    // Only the latest event is kept.
+    written.vsync.count = 2;
+    page->write(written);
+    written.vsync.count = 3;
+    page->write(written);
+    ASSERT_EQ(OK, reader->readNext(&sequence, &event));
+    EXPECT_EQ(3u, event.vsync.count);
+}
+
+TEST(VsyncBroadcastPage, CannotBeMappedWritable) {
+    auto page = gui::VsyncBroadcastPage::create();
+    ASSERT_NE(nullptr, page);
+    void* addr = mmap(nullptr, getpagesize(), PROT_READ | PROT_WRITE, MAP_SHARED,
+                      page->getFd().get(), 0);
+    EXPECT_EQ(MAP_FAILED, addr);
+}
+
 } // namespace test
 } // namespace android
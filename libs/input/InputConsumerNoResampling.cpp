@@ -17,6 +17,8 @@
 #define LOG_TAG "InputConsumerNoResampling"
 #define ATRACE_TAG ATRACE_TAG_INPUT
 
+#include <algorithm>
+#include <array>
 #include <chrono>
 
 #include <inttypes.h>
@@ -46,6 +48,12 @@ using std::chrono::nanoseconds;
 const bool DEBUG_TRANSPORT_CONSUMER =
         __android_log_is_loggable(ANDROID_LOG_DEBUG, LOG_TAG "Consumer", ANDROID_LOG_INFO);
 
+// Most messages read from the channel with a single system call.
+constexpr size_t MAX_MESSAGES_PER_READ = 8;
+
+// Most messages a drained batch keeps room for. A 240Hz device batched at 60Hz needs about 4.
+constexpr size_t MAX_RETAINED_BATCH_MESSAGES = 16;
+
 std::unique_ptr<KeyEvent> createKeyEvent(const InputMessage& msg) {
     std::unique_ptr<KeyEvent> event = std::make_unique<KeyEvent>();
     event->initialize(msg.body.key.eventId, msg.body.key.deviceId, msg.body.key.source,
@@ -78,13 +86,11 @@ std::unique_ptr<DragEvent> createDragEvent(const InputMessage& msg) {
 std::unique_ptr<MotionEvent> createMotionEvent(const InputMessage& msg) {
     std::unique_ptr<MotionEvent> event = std::make_unique<MotionEvent>();
     const uint32_t pointerCount = msg.body.motion.pointerCount;
-    std::vector<PointerProperties> pointerProperties;
-    pointerProperties.reserve(pointerCount);
-    std::vector<PointerCoords> pointerCoords;
-    pointerCoords.reserve(pointerCount);
+    std::array<PointerProperties, MAX_POINTERS> pointerProperties;
+    std::array<PointerCoords, MAX_POINTERS> pointerCoords;
     for (uint32_t i = 0; i < pointerCount; i++) {
-        pointerProperties.push_back(msg.body.motion.pointers[i].properties);
-        pointerCoords.push_back(msg.body.motion.pointers[i].coords);
+        pointerProperties[i] = msg.body.motion.pointers[i].properties;
+        pointerCoords[i] = msg.body.motion.pointers[i].coords;
     }
 
     ui::Transform transform;
@@ -108,10 +114,9 @@ std::unique_ptr<MotionEvent> createMotionEvent(const InputMessage& msg) {
 
 void addSample(MotionEvent& event, const InputMessage& msg) {
     uint32_t pointerCount = msg.body.motion.pointerCount;
-    std::vector<PointerCoords> pointerCoords;
-    pointerCoords.reserve(pointerCount);
+    std::array<PointerCoords, MAX_POINTERS> pointerCoords;
     for (uint32_t i = 0; i < pointerCount; i++) {
-        pointerCoords.push_back(msg.body.motion.pointers[i].coords);
+        pointerCoords[i] = msg.body.motion.pointers[i].coords;
     }
 
     // TODO(b/329770983): figure out if it's safe to combine events with mismatching metaState
@@ -286,7 +291,12 @@ bool InputConsumerNoResampling::probablyHasInput() const {
     // Ideally, this would only be allowed to run on the looper thread, and in production, it will.
     // However, for testing, it's convenient to call this while the looper thread is blocked, so
     // we do not call ensureCalledOnLooperThread here.
-    return (!mBatches.empty()) || mChannel->probablyHasInput();
+    return hasPendingBatches() || mChannel->probablyHasInput();
+}
+
+bool InputConsumerNoResampling::hasPendingBatches() const {
+    return std::any_of(mBatches.begin(), mBatches.end(),
+                       [](const auto& pair) { return !pair.second.empty(); });
 }
 
 void InputConsumerNoResampling::reportTimeline(int32_t inputEventId, nsecs_t gpuCompletedTime,
@@ -331,7 +341,7 @@ void InputConsumerNoResampling::handleMessages(std::vector<InputMessage>&& messa
                      isFromSource(source, AINPUT_SOURCE_CLASS_JOYSTICK));
             if (batchableEvent) {
                 // add it to batch
-                mBatches[deviceId].emplace(msg);
+                mBatches[deviceId].push(msg);
             } else {
                 // consume all pending batches for this device immediately
                 consumeBatchedInputEvents(deviceId, /*requestedFrameTime=*/std::nullopt);
@@ -352,12 +362,15 @@ void InputConsumerNoResampling::handleMessages(std::vector<InputMessage>&& messa
     std::set<int32_t> pendingBatchSources;
     for (const auto& [_, pendingMessages] : mBatches) {
         // Assume that all messages for a given device has the same source.
-        pendingBatchSources.insert(pendingMessages.front().body.motion.source);
+        if (!pendingMessages.empty()) {
+            pendingBatchSources.insert(pendingMessages.front().body.motion.source);
+        }
     }
     for (const int32_t source : pendingBatchSources) {
         const bool sourceStillRemaining =
                 std::any_of(mBatches.begin(), mBatches.end(), [=](const auto& pair) {
-                    return pair.second.front().body.motion.source == source;
+                    return !pair.second.empty() &&
+                            pair.second.front().body.motion.source == source;
                 });
         if (sourceStillRemaining) {
             mCallbacks.onBatchedInputEventPending(source);
@@ -367,20 +380,25 @@ void InputConsumerNoResampling::handleMessages(std::vector<InputMessage>&& messa
 
 std::vector<InputMessage> InputConsumerNoResampling::readAllMessages() {
     std::vector<InputMessage> messages;
+    // High rate touch or stylus input often leaves several messages in the channel by the time
+    // the consumer wakes up. Read them with as few system calls as possible.
+    std::array<InputMessage, MAX_MESSAGES_PER_READ> batch;
     while (true) {
-        android::base::Result<InputMessage> result = mChannel->receiveMessage();
+        android::base::Result<size_t> result = mChannel->receiveMessages(batch);
         if (result.ok()) {
-            const InputMessage& msg = *result;
-            const auto [_, inserted] =
-                    mConsumeTimes.emplace(msg.header.seq, systemTime(SYSTEM_TIME_MONOTONIC));
-            LOG_ALWAYS_FATAL_IF(!inserted, "Already have a consume time for seq=%" PRIu32,
-                                msg.header.seq);
-
-            // Trace the event processing timeline - event was just read from the socket
-            // TODO(b/329777420): distinguish between multiple instances of InputConsumer
-            // in the same process.
-            ATRACE_ASYNC_BEGIN("InputConsumer processing", /*cookie=*/msg.header.seq);
-            messages.push_back(msg);
+            const nsecs_t consumeTime = systemTime(SYSTEM_TIME_MONOTONIC);
+            for (size_t i = 0; i < *result; i++) {
+                const InputMessage& msg = batch[i];
+                const auto [_, inserted] = mConsumeTimes.emplace(msg.header.seq, consumeTime);
+                LOG_ALWAYS_FATAL_IF(!inserted, "Already have a consume time for seq=%" PRIu32,
+                                    msg.header.seq);
+
+                // Trace the event processing timeline - event was just read from the socket
+                // TODO(b/329777420): distinguish between multiple instances of InputConsumer
+                // in the same process.
+                ATRACE_ASYNC_BEGIN("InputConsumer processing", /*cookie=*/msg.header.seq);
+                messages.push_back(msg);
+            }
         } else { // !result.ok()
             switch (result.error().code()) {
                 case WOULD_BLOCK: {
@@ -453,7 +471,7 @@ void InputConsumerNoResampling::handleMessage(const InputMessage& msg) const {
 
 std::pair<std::unique_ptr<MotionEvent>, std::optional<uint32_t>>
 InputConsumerNoResampling::createBatchedMotionEvent(const nsecs_t requestedFrameTime,
-                                                    std::queue<InputMessage>& messages) {
+                                                    MessageBatch& messages) {
     std::unique_ptr<MotionEvent> motionEvent;
     std::optional<uint32_t> firstSeqForBatch;
     const nanoseconds resampleLatency =
@@ -476,13 +494,14 @@ InputConsumerNoResampling::createBatchedMotionEvent(const nsecs_t requestedFrame
     }
     // Check if resampling should be performed.
     if (motionEvent != nullptr && isPointerEvent(*motionEvent) && mResampler != nullptr) {
-        InputMessage* futureSample = nullptr;
+        const InputMessage* futureSample = nullptr;
         if (!messages.empty()) {
             futureSample = &messages.front();
         }
         mResampler->resampleMotionEvent(nanoseconds{requestedFrameTime}, *motionEvent,
                                         futureSample);
     }
+    messages.compact();
     return std::make_pair(std::move(motionEvent), firstSeqForBatch);
 }
 
@@ -497,7 +516,7 @@ bool InputConsumerNoResampling::consumeBatchedInputEvents(
     for (auto deviceIdIter = (deviceId.has_value()) ? (mBatches.find(*deviceId))
                                                     : (mBatches.begin());
          deviceIdIter != mBatches.cend(); ++deviceIdIter) {
-        std::queue<InputMessage>& messages = deviceIdIter->second;
+        MessageBatch& messages = deviceIdIter->second;
         auto [motion, firstSeqForBatch] = createBatchedMotionEvent(*requestedFrameTime, messages);
         if (motion != nullptr) {
             LOG_ALWAYS_FATAL_IF(!firstSeqForBatch.has_value());
@@ -517,7 +536,6 @@ bool InputConsumerNoResampling::consumeBatchedInputEvents(
             break;
         }
     }
-    std::erase_if(mBatches, [](const auto& pair) { return pair.second.empty(); });
     return producedEvents;
 }
 
@@ -526,6 +544,20 @@ bool InputConsumerNoResampling::consumeBatchedInputEvents(
     return consumeBatchedInputEvents(/*deviceId=*/std::nullopt, requestedFrameTime);
 }
 
+void InputConsumerNoResampling::MessageBatch::compact() {
+    if (empty()) {
+        if (mMessages.capacity() > MAX_RETAINED_BATCH_MESSAGES) {
+            // Don't hold on to the memory needed by an unusually long batch.
+            std::vector<InputMessage>().swap(mMessages);
+        } else {
+            mMessages.clear();
+        }
+    } else {
+        mMessages.erase(mMessages.begin(), mMessages.begin() + mFront);
+    }
+    mFront = 0;
+}
+
 void InputConsumerNoResampling::ensureCalledOnLooperThread(const char* func) const {
     sp<Looper> callingThreadLooper = Looper::getForThread();
     if (callingThreadLooper != mLooper) {
@@ -549,22 +581,21 @@ std::string InputConsumerNoResampling::dump() const {
         }
     }
 
-    if (mBatches.empty()) {
+    if (!hasPendingBatches()) {
         out += "mBatches: <empty>\n";
     } else {
         out += "mBatches:\n";
         for (const auto& [deviceId, messages] : mBatches) {
+            if (messages.empty()) {
+                continue;
+            }
             out += "  Device id ";
             out += std::to_string(deviceId);
             out += ":\n";
-            // Make a copy of mOutboundQueue for printing destructively. Unfortunately std::queue
-            // doesn't provide a good way to iterate over the entire container.
-            std::queue<InputMessage> tmpQueue = messages;
-            while (!tmpQueue.empty()) {
-                LOG_ALWAYS_FATAL_IF(tmpQueue.front().header.type != InputMessage::Type::MOTION);
-                std::unique_ptr<MotionEvent> motion = createMotionEvent(tmpQueue.front());
+            for (const InputMessage& msg : messages) {
+                LOG_ALWAYS_FATAL_IF(msg.header.type != InputMessage::Type::MOTION);
+                std::unique_ptr<MotionEvent> motion = createMotionEvent(msg);
                 out += std::string("    ") + streamableToString(*motion) + "\n";
-                tmpQueue.pop();
             }
         }
     }
@@ -23,9 +23,12 @@
 #include <android-base/logging.h>
 #include <android-base/properties.h>
 #include <android-base/stringprintf.h>
+#include <android-base/thread_annotations.h>
 #include <ftl/enum.h>
 #include <input/InputDevice.h>
 #include <input/InputEventLabels.h>
+#include <map>
+#include <mutex>
 
 using android::base::GetProperty;
 using android::base::StringPrintf;
@@ -94,6 +97,59 @@ std::string getInputDeviceConfigurationFilePathByDeviceIdentifier(
                                                      type);
 }
 
+// Searches the read-only system locations, which only change across reboots. Sets outCacheable to
+// false if a location could not be probed, so the search is retried next time.
+static std::string findSystemInputDeviceConfigurationFile(
+        const std::vector<std::string>& pathPrefixes, const std::string& name,
+        InputDeviceConfigurationFileType type, bool& outCacheable) {
+    outCacheable = true;
+    std::string path;
+    for (const auto& prefix : pathPrefixes) {
+        path = prefix;
+        appendInputDeviceConfigurationFileRelativePath(path, name, type);
+        if (!access(path.c_str(), R_OK)) {
+            LOG_IF(INFO, DEBUG_PROBE)
+                    << "Found system-provided input device configuration file at " << path;
+            return path;
+        } else if (errno != ENOENT) {
+            LOG(WARNING) << "Couldn't find a system-provided input device configuration file at "
+                         << path << " due to error " << errno << " (" << strerror(errno)
+                         << "); there may be an IDC file there that cannot be loaded.";
+            outCacheable = false;
+        } else {
+            LOG_IF(ERROR, DEBUG_PROBE)
+                    << "Didn't find system-provided input device configuration file at " << path
+                    << ": " << strerror(errno);
+        }
+    }
+    return "";
+}
+
+namespace {
+
+// Results of findSystemInputDeviceConfigurationFile, both found and not found, shared by every
+// device in the process. Many devices, e.g. virtual keyboards created by apps, probe the same
+// names. The cache is dropped when the set of system locations changes.
+struct SystemConfigurationFileCache {
+    std::mutex lock;
+    std::vector<std::string> pathPrefixes GUARDED_BY(lock);
+    std::map<std::pair<std::string, InputDeviceConfigurationFileType>, std::string> paths
+            GUARDED_BY(lock);
+};
+
+SystemConfigurationFileCache& getSystemConfigurationFileCache() {
+    static SystemConfigurationFileCache* cache = new SystemConfigurationFileCache();
+    return *cache;
+}
+
+} // namespace
+
+void clearInputDeviceConfigurationFilePathCache() {
+    SystemConfigurationFileCache& cache = getSystemConfigurationFileCache();
+    std::scoped_lock lock(cache.lock);
+    cache.paths.clear();
+}
+
 std::string getInputDeviceConfigurationFilePathByName(
         const std::string& name, InputDeviceConfigurationFileType type) {
     // Search system repository.
@@ -115,23 +171,27 @@ std::string getInputDeviceConfigurationFilePathByName(
     if (auto android_root = getenv("ANDROID_ROOT"); android_root != nullptr) {
         pathPrefixes.push_back(std::string(android_root) + "/usr/");
     }
-    for (const auto& prefix : pathPrefixes) {
-        path = prefix;
-        appendInputDeviceConfigurationFileRelativePath(path, name, type);
-        if (!access(path.c_str(), R_OK)) {
-            LOG_IF(INFO, DEBUG_PROBE)
-                    << "Found system-provided input device configuration file at " << path;
-            return path;
-        } else if (errno != ENOENT) {
-            LOG(WARNING) << "Couldn't find a system-provided input device configuration file at "
-                         << path << " due to error " << errno << " (" << strerror(errno)
-                         << "); there may be an IDC file there that cannot be loaded.";
+
+    SystemConfigurationFileCache& cache = getSystemConfigurationFileCache();
+    {
+        std::scoped_lock lock(cache.lock);
+        if (cache.pathPrefixes != pathPrefixes) {
+            cache.pathPrefixes = pathPrefixes;
+            cache.paths.clear();
+        }
+        if (const auto it = cache.paths.find({name, type}); it != cache.paths.end()) {
+            path = it->second;
         } else {
-            LOG_IF(ERROR, DEBUG_PROBE)
-                    << "Didn't find system-provided input device configuration file at " << path
-                    << ": " << strerror(errno);
+            bool cacheable;
+            path = findSystemInputDeviceConfigurationFile(pathPrefixes, name, type, cacheable);
+            if (cacheable) {
+                cache.paths.emplace(std::make_pair(name, type), path);
+            }
         }
     }
+    if (!path.empty()) {
+        return path;
+    }
 
     // Search user repository.
     // TODO Should only look here if not in safe mode.
@@ -14,6 +14,8 @@
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <algorithm>
+#include <array>
 
 #include <android-base/logging.h>
 #include <android-base/properties.h>
@@ -397,16 +399,7 @@ status_t InputChannel::sendMessage(const InputMessage* msg) {
     } while (nWrite == -1 && errno == EINTR);
 
     if (nWrite < 0) {
-        int error = errno;
-        ALOGD_IF(DEBUG_CHANNEL_MESSAGES, "channel '%s' ~ error sending message of type %s, %s",
-                 name.c_str(), ftl::enum_string(msg->header.type).c_str(), strerror(error));
-        if (error == EAGAIN || error == EWOULDBLOCK) {
-            return WOULD_BLOCK;
-        }
-        if (error == EPIPE || error == ENOTCONN || error == ECONNREFUSED || error == ECONNRESET) {
-            return DEAD_OBJECT;
-        }
-        return -error;
+        return sendErrorToStatus(errno, *msg);
     }
 
     if (size_t(nWrite) != msgLength) {
@@ -422,6 +415,74 @@ status_t InputChannel::sendMessage(const InputMessage* msg) {
     return OK;
 }
 
+android::base::Result<size_t> InputChannel::sendMessages(std::span<const InputMessage> msgs) {
+#if defined(__linux__)
+    // Each message is sanitized into a copy on the stack, which bounds the batch size.
+    constexpr size_t MAX_MESSAGES_PER_CALL = 8;
+    const size_t maxMessages = std::min(msgs.size(), MAX_MESSAGES_PER_CALL);
+    if (maxMessages <= 1) {
+        if (msgs.empty()) {
+            return android::base::Error(BAD_VALUE);
+        }
+        if (status_t status = sendMessage(&msgs[0]); status != OK) {
+            return android::base::Error(status);
+        }
+        return 1;
+    }
+    ATRACE_NAME_IF(ATRACE_ENABLED(),
+                   StringPrintf("sendMessages(inputChannel=%s, count=%zu)", name.c_str(),
+                                maxMessages));
+
+    std::array<InputMessage, MAX_MESSAGES_PER_CALL> cleanMsgs;
+    std::array<iovec, MAX_MESSAGES_PER_CALL> iovecs;
+    std::array<mmsghdr, MAX_MESSAGES_PER_CALL> headers{};
+    for (size_t i = 0; i < maxMessages; i++) {
+        msgs[i].getSanitizedCopy(&cleanMsgs[i]);
+        iovecs[i] = {.iov_base = &cleanMsgs[i], .iov_len = msgs[i].size()};
+        headers[i].msg_hdr.msg_iov = &iovecs[i];
+        headers[i].msg_hdr.msg_iovlen = 1;
+    }
+    int nMessages;
+    do {
+        nMessages = ::sendmmsg(getFd(), headers.data(), maxMessages, MSG_DONTWAIT | MSG_NOSIGNAL);
+    } while (nMessages == -1 && errno == EINTR);
+
+    if (nMessages < 0) {
+        return android::base::Error(sendErrorToStatus(errno, msgs[0]));
+    }
+    for (int i = 0; i < nMessages; i++) {
+        if (headers[i].msg_len != iovecs[i].iov_len) {
+            ALOGD_IF(DEBUG_CHANNEL_MESSAGES,
+                     "channel '%s' ~ error sending message type %s, send was incomplete",
+                     name.c_str(), ftl::enum_string(msgs[i].header.type).c_str());
+            return android::base::Error(DEAD_OBJECT);
+        }
+    }
+    ALOGD_IF(DEBUG_CHANNEL_MESSAGES, "channel '%s' ~ sent %d messages", name.c_str(), nMessages);
+    return nMessages;
+#else
+    if (msgs.empty()) {
+        return android::base::Error(BAD_VALUE);
+    }
+    if (status_t status = sendMessage(&msgs[0]); status != OK) {
+        return android::base::Error(status);
+    }
+    return 1;
+#endif
+}
+
+status_t InputChannel::sendErrorToStatus(int error, const InputMessage& msg) const {
+    ALOGD_IF(DEBUG_CHANNEL_MESSAGES, "channel '%s' ~ error sending message of type %s, %s",
+             name.c_str(), ftl::enum_string(msg.header.type).c_str(), strerror(error));
+    if (error == EAGAIN || error == EWOULDBLOCK) {
+        return WOULD_BLOCK;
+    }
+    if (error == EPIPE || error == ENOTCONN || error == ECONNREFUSED || error == ECONNRESET) {
+        return DEAD_OBJECT;
+    }
+    return -error;
+}
+
 android::base::Result<InputMessage> InputChannel::receiveMessage() {
     ssize_t nRead;
     InputMessage msg;
@@ -430,27 +491,90 @@ android::base::Result<InputMessage> InputChannel::receiveMessage() {
     } while (nRead == -1 && errno == EINTR);
 
     if (nRead < 0) {
-        int error = errno;
-        ALOGD_IF(DEBUG_CHANNEL_MESSAGES, "channel '%s' ~ receive message failed, errno=%d",
-                 name.c_str(), errno);
-        if (error == EAGAIN || error == EWOULDBLOCK) {
-            return android::base::Error(WOULD_BLOCK);
+        return android::base::Error(receiveErrorToStatus(errno));
+    }
+    if (status_t status = checkReceivedMessage(msg, nRead); status != OK) {
+        return android::base::Error(status);
+    }
+    return msg;
+}
+
+android::base::Result<size_t> InputChannel::receiveMessages(std::span<InputMessage> outMessages) {
+#if defined(__linux__)
+    constexpr size_t MAX_MESSAGES_PER_CALL = 16;
+    const size_t maxMessages = std::min(outMessages.size(), MAX_MESSAGES_PER_CALL);
+    if (maxMessages <= 1) {
+        android::base::Result<InputMessage> result = receiveMessage();
+        if (!result.ok()) {
+            return result.error();
         }
-        if (error == EPIPE || error == ENOTCONN || error == ECONNREFUSED) {
-            return android::base::Error(DEAD_OBJECT);
+        outMessages[0] = *result;
+        return 1;
+    }
+
+    std::array<iovec, MAX_MESSAGES_PER_CALL> iovecs;
+    std::array<mmsghdr, MAX_MESSAGES_PER_CALL> headers{};
+    for (size_t i = 0; i < maxMessages; i++) {
+        iovecs[i] = {.iov_base = &outMessages[i], .iov_len = sizeof(InputMessage)};
+        headers[i].msg_hdr.msg_iov = &iovecs[i];
+        headers[i].msg_hdr.msg_iovlen = 1;
+    }
+    int nMessages;
+    do {
+        nMessages = ::recvmmsg(getFd(), headers.data(), maxMessages, MSG_DONTWAIT,
+                               /*timeout=*/nullptr);
+    } while (nMessages == -1 && errno == EINTR);
+
+    if (nMessages < 0) {
+        return android::base::Error(receiveErrorToStatus(errno));
+    }
+    for (int i = 0; i < nMessages; i++) {
+        if (status_t status = checkReceivedMessage(outMessages[i], headers[i].msg_len);
+            status != OK) {
+            // Hand over the messages received before the peer closed the channel. The next call
+            // reports that the peer was closed.
+            if (status == DEAD_OBJECT && i > 0) {
+                return i;
+            }
+            return android::base::Error(status);
         }
-        return android::base::Error(-error);
     }
+    return nMessages;
+#else
+    if (outMessages.empty()) {
+        return android::base::Error(BAD_VALUE);
+    }
+    android::base::Result<InputMessage> result = receiveMessage();
+    if (!result.ok()) {
+        return result.error();
+    }
+    outMessages[0] = *result;
+    return 1;
+#endif
+}
+
+status_t InputChannel::receiveErrorToStatus(int error) const {
+    ALOGD_IF(DEBUG_CHANNEL_MESSAGES, "channel '%s' ~ receive message failed, errno=%d",
+             name.c_str(), error);
+    if (error == EAGAIN || error == EWOULDBLOCK) {
+        return WOULD_BLOCK;
+    }
+    if (error == EPIPE || error == ENOTCONN || error == ECONNREFUSED) {
+        return DEAD_OBJECT;
+    }
+    return -error;
+}
 
+status_t InputChannel::checkReceivedMessage(const InputMessage& msg, size_t nRead) const {
     if (nRead == 0) { // check for EOF
         ALOGD_IF(DEBUG_CHANNEL_MESSAGES,
                  "channel '%s' ~ receive message failed because peer was closed", name.c_str());
-        return android::base::Error(DEAD_OBJECT);
+        return DEAD_OBJECT;
     }
 
     if (!msg.isValid(nRead)) {
-        ALOGE("channel '%s' ~ received invalid message of size %zd", name.c_str(), nRead);
-        return android::base::Error(BAD_VALUE);
+        ALOGE("channel '%s' ~ received invalid message of size %zu", name.c_str(), nRead);
+        return BAD_VALUE;
     }
 
     ALOGD_IF(DEBUG_CHANNEL_MESSAGES, "channel '%s' ~ received message of type %s", name.c_str(),
@@ -463,7 +587,7 @@ android::base::Result<InputMessage> InputChannel::receiveMessage() {
                              ftl::enum_string(msg.header.type).c_str());
         ATRACE_NAME(message.c_str());
     }
-    return msg;
+    return OK;
 }
 
 bool InputChannel::probablyHasInput() const {
@@ -583,7 +707,9 @@ status_t InputPublisher::publishMotionEvent(
                    StringPrintf("publishMotionEvent(inputChannel=%s, action=%s)",
                                 mChannel->getName().c_str(),
                                 MotionEvent::actionToString(action).c_str()));
-    if (verifyEvents()) {
+    // Batched events are verified as they are sent, so that the verifier does not see the events
+    // that did not fit in the channel twice.
+    if (verifyEvents() && !mBatchingMotions) {
         Result<void> result =
                 mInputVerifier.processMovement(deviceId, source, action, pointerCount,
                                                pointerProperties, pointerCoords, flags);
@@ -658,9 +784,66 @@ status_t InputPublisher::publishMotionEvent(
         msg.body.motion.pointers[i].coords = pointerCoords[i];
     }
 
+    if (mBatchingMotions) {
+        mMotionBatch.push_back(msg);
+        return OK;
+    }
     return mChannel->sendMessage(&msg);
 }
 
+void InputPublisher::beginMotionBatch() {
+    LOG_ALWAYS_FATAL_IF(mBatchingMotions, "channel '%s' publisher ~ Motion batch already started",
+                        mChannel->getName().c_str());
+    mBatchingMotions = true;
+}
+
+android::base::Result<size_t> InputPublisher::endMotionBatch() {
+    LOG_ALWAYS_FATAL_IF(!mBatchingMotions, "channel '%s' publisher ~ No motion batch started",
+                        mChannel->getName().c_str());
+    mBatchingMotions = false;
+    std::span<const InputMessage> pending(mMotionBatch);
+    size_t sentCount = 0;
+    while (!pending.empty()) {
+        android::base::Result<size_t> sent = verifyEvents()
+                ? verifyAndSendMotion(pending.front())
+                : mChannel->sendMessages(pending);
+        if (!sent.ok()) {
+            if (sentCount == 0) {
+                mMotionBatch.clear();
+                return sent.error();
+            }
+            // The caller publishes the rest again once the consumer catches up.
+            break;
+        }
+        sentCount += *sent;
+        pending = pending.subspan(*sent);
+    }
+    mMotionBatch.clear();
+    return sentCount;
+}
+
+android::base::Result<size_t> InputPublisher::verifyAndSendMotion(const InputMessage& msg) {
+    const InputMessage::Body::Motion& motion = msg.body.motion;
+    std::array<PointerProperties, MAX_POINTERS> pointerProperties;
+    std::array<PointerCoords, MAX_POINTERS> pointerCoords;
+    for (uint32_t i = 0; i < motion.pointerCount; i++) {
+        pointerProperties[i] = motion.pointers[i].properties;
+        pointerCoords[i] = motion.pointers[i].coords;
+    }
+    Result<void> result =
+            mInputVerifier.processMovement(motion.deviceId, motion.source, motion.action,
+                                           motion.pointerCount, pointerProperties.data(),
+                                           pointerCoords.data(), motion.flags);
+    if (!result.ok()) {
+        LOG(ERROR) << "Bad stream: " << result.error();
+        return android::base::Error(BAD_VALUE);
+    }
+    if (status_t status = mChannel->sendMessage(&msg); status != OK) {
+        return android::base::Error(status);
+    }
+    return 1;
+}
+
 status_t InputPublisher::publishFocusEvent(uint32_t seq, int32_t eventId, bool hasFocus) {
     ATRACE_NAME_IF(ATRACE_ENABLED(),
                    StringPrintf("publishFocusEvent(inputChannel=%s, hasFocus=%s)",
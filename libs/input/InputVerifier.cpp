@@ -18,6 +18,7 @@
 
 #include <android-base/logging.h>
 #include <input/InputVerifier.h>
+#include <algorithm>
 #include "input_cxx_bridge.rs.h"
 
 using android::base::Error;
@@ -31,28 +32,61 @@ namespace android {
 // --- InputVerifier ---
 
 InputVerifier::InputVerifier(const std::string& name)
-      : mVerifier(android::input::verifier::create(rust::String::lossy(name))){};
+      : mVerifier(android::input::verifier::create(rust::String::lossy(name))),
+        mShouldLog(android::base::ShouldLog(android::base::LogSeverity::DEBUG,
+                                            "InputVerifierLogEvents")){};
 
 Result<void> InputVerifier::processMovement(DeviceId deviceId, int32_t source, int32_t action,
                                             uint32_t pointerCount,
                                             const PointerProperties* pointerProperties,
                                             const PointerCoords* pointerCoords, int32_t flags) {
-    std::vector<RustPointerProperties> rpp;
+    const bool isMove = MotionEvent::getActionMasked(action) == AMOTION_EVENT_ACTION_MOVE;
+    auto it = mAcceptedMoves.find(deviceId);
+    if (it != mAcceptedMoves.end()) {
+        const AcceptedMove& accepted = it->second;
+        // The rust verifier logs every event when asked to, so always go through it then.
+        if (isMove && !mShouldLog && accepted.source == source && accepted.flags == flags &&
+            accepted.pointerCount == pointerCount &&
+            std::equal(pointerProperties, pointerProperties + pointerCount,
+                       accepted.pointerIds.begin(),
+                       [](const PointerProperties& p, int32_t id) { return p.id == id; })) {
+            return {};
+        }
+        mAcceptedMoves.erase(it);
+    }
+
+    // Malformed events may have too many pointers, and those are left for rust to reject.
+    std::array<RustPointerProperties, MAX_POINTERS> inlineProperties;
+    std::vector<RustPointerProperties> heapProperties;
+    RustPointerProperties* rpp = inlineProperties.data();
+    if (pointerCount > MAX_POINTERS) {
+        heapProperties.resize(pointerCount);
+        rpp = heapProperties.data();
+    }
     for (size_t i = 0; i < pointerCount; i++) {
-        rpp.emplace_back(RustPointerProperties{.id = pointerProperties[i].id});
+        rpp[i] = RustPointerProperties{.id = pointerProperties[i].id};
     }
-    rust::Slice<const RustPointerProperties> properties{rpp.data(), rpp.size()};
+    rust::Slice<const RustPointerProperties> properties{rpp, pointerCount};
     rust::String errorMessage =
             android::input::verifier::process_movement(*mVerifier, deviceId, source, action,
                                                        properties, static_cast<uint32_t>(flags));
-    if (errorMessage.empty()) {
-        return {};
-    } else {
+    if (!errorMessage.empty()) {
         return Error() << errorMessage;
     }
+    if (isMove && pointerCount <= MAX_POINTERS) {
+        AcceptedMove& accepted = mAcceptedMoves[deviceId];
+        accepted.source = source;
+        accepted.flags = flags;
+        accepted.pointerCount = pointerCount;
+        for (size_t i = 0; i < pointerCount; i++) {
+            accepted.pointerIds[i] = pointerProperties[i].id;
+        }
+    }
+    return {};
 }
 
 void InputVerifier::resetDevice(DeviceId deviceId) {
+    mAcceptedMoves.erase(deviceId);
     android::input::verifier::reset_device(*mVerifier, deviceId);
 }
 
@@ -25,6 +25,7 @@
 #include <input/InputEventLabels.h>
 #include <input/KeyCharacterMap.h>
 #include <input/Keyboard.h>
+#include <input/ParsedFileCache.h>
 
 #include <utils/Errors.h>
 #include <utils/Log.h>
@@ -45,6 +46,10 @@ namespace android {
 static const char* WHITESPACE = " \t\r";
 static const char* WHITESPACE_OR_PROPERTY_DELIMITER = " \t\r,:";
 
+// The number of parsed base key character maps kept across loads. Devices of the same kind share
+// a map, so this covers many more devices.
+static constexpr size_t MAX_CACHED_BASE_MAPS = 16;
+
 struct Modifier {
     const char* label;
     int32_t metaState;
@@ -82,10 +87,27 @@ static String8 toString(const char16_t* chars, size_t numChars) {
 
 // --- KeyCharacterMap ---
 
+// Base maps parsed from files. The maps returned by load() are copies, since they can be modified
+// by overlays and key remappings.
+static ParsedFileCache<const KeyCharacterMap>& getBaseMapCache() {
+    static ParsedFileCache<const KeyCharacterMap> cache(MAX_CACHED_BASE_MAPS);
+    return cache;
+}
+
 KeyCharacterMap::KeyCharacterMap(const std::string& filename) : mLoadFileName(filename) {}
 
 base::Result<std::shared_ptr<KeyCharacterMap>> KeyCharacterMap::load(const std::string& filename,
                                                                      Format format) {
+    const std::optional<FileIdentity> identity =
+            format == Format::BASE ? FileIdentity::of(filename) : std::nullopt;
+    if (identity) {
+        std::shared_ptr<const KeyCharacterMap> cached =
+                getBaseMapCache().find(filename, *identity);
+        if (cached) {
+            return std::make_shared<KeyCharacterMap>(*cached);
+        }
+    }
+
     Tokenizer* tokenizer;
     status_t status = Tokenizer::open(String8(filename.c_str()), &tokenizer);
     if (status) {
@@ -100,6 +122,10 @@ base::Result<std::shared_ptr<KeyCharacterMap>> KeyCharacterMap::load(const std::
     std::unique_ptr<Tokenizer> t(tokenizer);
     status = map->load(t.get(), format);
     if (status == OK) {
+        if (identity) {
+            getBaseMapCache().insert(filename, *identity,
+                                     std::make_shared<const KeyCharacterMap>(*map));
+        }
         return map;
     }
     return Errorf("Load KeyCharacterMap failed {}.", status);
@@ -155,15 +181,19 @@ void KeyCharacterMap::clear() {
 
 status_t KeyCharacterMap::reloadBaseFromFile() {
     clear();
-    Tokenizer* tokenizer;
-    status_t status = Tokenizer::open(String8(mLoadFileName.c_str()), &tokenizer);
-    if (status) {
-        ALOGE("Error %s opening key character map file %s.", statusToString(status).c_str(),
-              mLoadFileName.c_str());
-        return status;
-    }
-    std::unique_ptr<Tokenizer> t(tokenizer);
-    return load(t.get(), KeyCharacterMap::Format::BASE);
+    base::Result<std::shared_ptr<KeyCharacterMap>> loaded = load(mLoadFileName, Format::BASE);
+    if (!loaded.ok()) {
+        ALOGE("Error reloading key character map file %s: %s", mLoadFileName.c_str(),
+              loaded.error().message().c_str());
+        return loaded.error().code();
+    }
+    // Keep the key remapping, which is not part of the file.
+    KeyCharacterMap& baseMap = **loaded;
+    mKeys = std::move(baseMap.mKeys);
+    mType = baseMap.mType;
+    mKeysByScanCode = std::move(baseMap.mKeysByScanCode);
+    mKeysByUsageCode = std::move(baseMap.mKeysByUsageCode);
+    return OK;
 }
 
 void KeyCharacterMap::combine(const KeyCharacterMap& overlay) {
@@ -22,6 +22,7 @@
 #include <input/InputEventLabels.h>
 #include <input/KeyLayoutMap.h>
 #include <input/Keyboard.h>
+#include <input/ParsedFileCache.h>
 #include <log/log.h>
 #include <utils/Errors.h>
 #include <utils/Timers.h>
@@ -125,6 +126,16 @@ bool kernelConfigsArePresent(const std::set<std::string>& configs) {
 #endif
 }
 
+// The number of parsed key layout maps kept across loads. Devices of the same kind share a map,
+// so this covers many more devices.
+constexpr size_t MAX_CACHED_MAPS = 16;
+
+// Key layout maps are immutable once loaded, so the devices that use the same file share one map.
+ParsedFileCache<KeyLayoutMap>& getCache() {
+    static ParsedFileCache<KeyLayoutMap> cache(MAX_CACHED_MAPS);
+    return cache;
+}
+
 } // namespace
 
 KeyLayoutMap::KeyLayoutMap() = default;
@@ -137,6 +148,15 @@ base::Result<std::shared_ptr<KeyLayoutMap>> KeyLayoutMap::loadContents(const std
 
 base::Result<std::shared_ptr<KeyLayoutMap>> KeyLayoutMap::load(const std::string& filename,
                                                                const char* contents) {
+    const std::optional<FileIdentity> identity =
+            contents == nullptr ? FileIdentity::of(filename) : std::nullopt;
+    if (identity) {
+        std::shared_ptr<KeyLayoutMap> cached = getCache().find(filename, *identity);
+        if (cached) {
+            return cached;
+        }
+    }
+
     Tokenizer* tokenizer;
     status_t status;
     if (contents == nullptr) {
@@ -160,6 +180,9 @@ base::Result<std::shared_ptr<KeyLayoutMap>> KeyLayoutMap::load(const std::string
         return Errorf("Missing kernel config");
     }
     map->mLoadFileName = filename;
+    if (identity) {
+        getCache().insert(filename, *identity, map);
+    }
     return ret;
 }
 
@@ -23,15 +23,19 @@
 #include <cinttypes>
 #include <cmath>
 #include <cstddef>
+#include <condition_variable>
 #include <cstdint>
 #include <limits>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
 #include <android-base/logging.h>
 #include <android-base/strings.h>
+#include <android-base/thread_annotations.h>
 #include <android/input.h>
 #include <com_android_input_flags.h>
 
@@ -144,19 +148,121 @@ std::optional<float> JerkTracker::jerkMagnitude() const {
     return std::nullopt;
 }
 
+// --- MotionPredictor::InferenceThread ---
+
+/**
+ * Runs the model on a dedicated thread. Only the latest request is kept: a request that the thread
+ * has not started by the time a newer one is made is dropped, since its outputs would be stale.
+ */
+class MotionPredictor::InferenceThread {
+public:
+    explicit InferenceThread(TfLiteMotionPredictorModel& model)
+          : mModel(model), mThread(&InferenceThread::threadLoop, this) {}
+
+    ~InferenceThread() {
+        {
+            std::scoped_lock lock(mLock);
+            mStopping = true;
+        }
+        mCondition.notify_one();
+        mThread.join();
+    }
+
+    // Runs the model on the given buffers, which must be ready.
+    void request(const TfLiteMotionPredictorBuffers& buffers, uint64_t gestureId) {
+        {
+            std::scoped_lock lock(mLock);
+            mPendingRequest.emplace(Request{.buffers = buffers, .gestureId = gestureId});
+        }
+        mCondition.notify_one();
+    }
+
+    // Returns the latest inference that completed since the previous call, if any.
+    std::optional<Inference> takeCompletedInference() {
+        std::scoped_lock lock(mLock);
+        std::optional<Inference> inference = std::move(mCompletedInference);
+        mCompletedInference.reset();
+        return inference;
+    }
+
+private:
+    struct Request {
+        TfLiteMotionPredictorBuffers buffers;
+        uint64_t gestureId;
+    };
+
+    void threadLoop() {
+        while (true) {
+            std::optional<Request> request;
+            { // acquire lock
+                std::unique_lock lock(mLock);
+                base::ScopedLockAssertion assumeLocked(mLock);
+                mCondition.wait(lock, [this]() REQUIRES(mLock) {
+                    return mStopping || mPendingRequest.has_value();
+                });
+                if (mStopping) {
+                    return;
+                }
+                request.swap(mPendingRequest);
+            } // release lock
+
+            const nsecs_t startTime = systemTime(SYSTEM_TIME_MONOTONIC);
+            request->buffers.copyTo(mModel);
+            LOG_ALWAYS_FATAL_IF(!mModel.invoke());
+            const nsecs_t latency = systemTime(SYSTEM_TIME_MONOTONIC) - startTime;
+
+            const std::span<const float> r = mModel.outputR();
+            const std::span<const float> phi = mModel.outputPhi();
+            const std::span<const float> pressure = mModel.outputPressure();
+            Inference inference{
+                    .r = std::vector<float>(r.begin(), r.end()),
+                    .phi = std::vector<float>(phi.begin(), phi.end()),
+                    .pressure = std::vector<float>(pressure.begin(), pressure.end()),
+                    .axisFrom = request->buffers.axisFrom().position,
+                    .axisTo = request->buffers.axisTo().position,
+                    .lastTimestamp = request->buffers.lastTimestamp(),
+                    .latency = latency,
+                    .gestureId = request->gestureId,
+            };
+
+            std::scoped_lock lock(mLock);
+            mCompletedInference = std::move(inference);
+        }
+    }
+
+    // Only used on the inference thread once it has started.
+    TfLiteMotionPredictorModel& mModel;
+
+    std::mutex mLock;
+    std::condition_variable mCondition;
+    bool mStopping GUARDED_BY(mLock) = false;
+    std::optional<Request> mPendingRequest GUARDED_BY(mLock);
+    std::optional<Inference> mCompletedInference GUARDED_BY(mLock);
+
+    // Declared last so that the members above are initialized when the thread starts.
+    std::thread mThread;
+};
+
 // --- MotionPredictor ---
 
 MotionPredictor::MotionPredictor(nsecs_t predictionTimestampOffsetNanos,
                                  std::function<bool()> checkMotionPredictionEnabled,
-                                 ReportAtomFunction reportAtomFunction)
+                                 ReportAtomFunction reportAtomFunction, bool asyncInference)
       : mPredictionTimestampOffsetNanos(predictionTimestampOffsetNanos),
         mCheckMotionPredictionEnabled(std::move(checkMotionPredictionEnabled)),
+        mAsyncInference(asyncInference),
         mReportAtomFunction(reportAtomFunction) {}
 
+MotionPredictor::~MotionPredictor() = default;
+
 void MotionPredictor::initializeObjects() {
     mModel = TfLiteMotionPredictorModel::create();
     LOG_ALWAYS_FATAL_IF(!mModel);
 
+    if (mAsyncInference) {
+        mInferenceThread = std::make_unique<InferenceThread>(*mModel);
+    }
+
     // mJerkTracker assumes normalized dt = 1 between recorded samples because
     // the underlying mModel input also assumes fixed-interval samples.
     // Normalized dt as 1 is also used to correspond with the similar Jank
@@ -200,6 +306,9 @@ android::base::Result<void> MotionPredictor::record(const MotionEvent& event) {
         mBuffers->reset();
         mJerkTracker->reset();
         mLastEvent.reset();
+        // Inferences still running for this gesture must not be used for the next one.
+        mGestureId++;
+        mLatestInference.reset();
         return {};
     } else if (action != AMOTION_EVENT_ACTION_DOWN && action != AMOTION_EVENT_ACTION_MOVE) {
         ALOGD_IF(isDebug(), "Skipping unsupported %s action",
@@ -243,6 +352,10 @@ android::base::Result<void> MotionPredictor::record(const MotionEvent& event) {
     }
     mLastEvent->copyFrom(&event, /*keepHistory=*/false);
 
+    if (mInferenceThread && mBuffers->isReady()) {
+        mInferenceThread->request(*mBuffers, mGestureId);
+    }
+
     return {};
 }
 
@@ -252,25 +365,68 @@ std::unique_ptr<MotionEvent> MotionPredictor::predict(nsecs_t timestamp) {
     }
 
     LOG_ALWAYS_FATAL_IF(!mModel);
-    mBuffers->copyTo(*mModel);
-    LOG_ALWAYS_FATAL_IF(!mModel->invoke());
+    LOG_ALWAYS_FATAL_IF(!mMetricsManager);
 
-    // Read out the predictions.
-    const std::span<const float> predictedR = mModel->outputR();
-    const std::span<const float> predictedPhi = mModel->outputPhi();
-    const std::span<const float> predictedPressure = mModel->outputPressure();
+    if (mInferenceThread) {
+        std::optional<Inference> inference = mInferenceThread->takeCompletedInference();
+        if (inference && inference->gestureId == mGestureId) {
+            mMetricsManager->onInference(inference->latency);
+            mLatestInference = std::move(inference);
+        }
+        if (!mLatestInference) {
+            // The first inference of the gesture has not completed yet.
+            return nullptr;
+        }
+        return createPrediction(
+                {
+                        .r = mLatestInference->r,
+                        .phi = mLatestInference->phi,
+                        .pressure = mLatestInference->pressure,
+                        .axisFrom = mLatestInference->axisFrom,
+                        .axisTo = mLatestInference->axisTo,
+                        .lastTimestamp = mLatestInference->lastTimestamp,
+                },
+                timestamp);
+    }
 
-    TfLiteMotionPredictorSample::Point axisFrom = mBuffers->axisFrom().position;
-    TfLiteMotionPredictorSample::Point axisTo = mBuffers->axisTo().position;
+    const nsecs_t startTime = systemTime(SYSTEM_TIME_MONOTONIC);
+    mBuffers->copyTo(*mModel);
+    LOG_ALWAYS_FATAL_IF(!mModel->invoke());
+    mMetricsManager->onInference(systemTime(SYSTEM_TIME_MONOTONIC) - startTime);
 
     if (isDebug()) {
-        ALOGD("axisFrom: %f, %f", axisFrom.x, axisFrom.y);
-        ALOGD("axisTo: %f, %f", axisTo.x, axisTo.y);
         ALOGD("mInputR: %s", base::Join(mModel->inputR(), ", ").c_str());
         ALOGD("mInputPhi: %s", base::Join(mModel->inputPhi(), ", ").c_str());
         ALOGD("mInputPressure: %s", base::Join(mModel->inputPressure(), ", ").c_str());
         ALOGD("mInputTilt: %s", base::Join(mModel->inputTilt(), ", ").c_str());
         ALOGD("mInputOrientation: %s", base::Join(mModel->inputOrientation(), ", ").c_str());
+    }
+
+    return createPrediction(
+            {
+                    .r = mModel->outputR(),
+                    .phi = mModel->outputPhi(),
+                    .pressure = mModel->outputPressure(),
+                    .axisFrom = mBuffers->axisFrom().position,
+                    .axisTo = mBuffers->axisTo().position,
+                    .lastTimestamp = mBuffers->lastTimestamp(),
+            },
+            timestamp);
+}
+
+std::unique_ptr<MotionEvent> MotionPredictor::createPrediction(const ModelOutput& output,
+                                                               nsecs_t timestamp) {
+    // Read out the predictions.
+    const std::span<const float> predictedR = output.r;
+    const std::span<const float> predictedPhi = output.phi;
+    const std::span<const float> predictedPressure = output.pressure;
+
+    TfLiteMotionPredictorSample::Point axisFrom = output.axisFrom;
+    TfLiteMotionPredictorSample::Point axisTo = output.axisTo;
+
+    if (isDebug()) {
+        ALOGD("axisFrom: %f, %f", axisFrom.x, axisFrom.y);
+        ALOGD("axisTo: %f, %f", axisTo.x, axisTo.y);
         ALOGD("predictedR: %s", base::Join(predictedR, ", ").c_str());
         ALOGD("predictedPhi: %s", base::Join(predictedPhi, ", ").c_str());
         ALOGD("predictedPressure: %s", base::Join(predictedPressure, ", ").c_str());
@@ -280,7 +436,7 @@ std::unique_ptr<MotionEvent> MotionPredictor::predict(nsecs_t timestamp) {
     const MotionEvent& event = *mLastEvent;
     bool hasPredictions = false;
     std::unique_ptr<MotionEvent> prediction = std::make_unique<MotionEvent>();
-    int64_t predictionTime = mBuffers->lastTimestamp();
+    int64_t predictionTime = output.lastTimestamp;
     const int64_t futureTime = timestamp + mPredictionTimestampOffsetNanos;
 
     const float jerkMagnitude = mJerkTracker->jerkMagnitude().value_or(0);
@@ -357,7 +513,6 @@ std::unique_ptr<MotionEvent> MotionPredictor::predict(nsecs_t timestamp) {
     }
 
     // Pass predictions to the MetricsManager.
-    LOG_ALWAYS_FATAL_IF(!mMetricsManager);
     mMetricsManager->onPredict(*prediction);
 
     return prediction;
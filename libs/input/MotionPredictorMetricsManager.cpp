@@ -43,6 +43,16 @@ inline constexpr float HIGH_VELOCITY_THRESHOLD = 1100.0;
 // zero.
 inline constexpr float PATH_LENGTH_EPSILON = 0.001;
 
+// Returns the given percentile of the values, using the nearest-rank method. Reorders the values.
+nsecs_t nearestRankPercentile(std::vector<nsecs_t>& values, int percentile) {
+    LOG_ALWAYS_FATAL_IF(values.empty());
+    // The rank is ceil(percentile / 100 * size), and is 1-based.
+    const size_t rank = std::max<size_t>(1, (percentile * values.size() + 99) / 100);
+    const auto nth = values.begin() + (rank - 1);
+    std::nth_element(values.begin(), nth, values.end());
+    return *nth;
+}
+
 } // namespace
 
 void MotionPredictorMetricsManager::defaultReportAtomFunction(
@@ -63,16 +73,27 @@ void MotionPredictorMetricsManager::defaultReportAtomFunction(
 #endif // __ANDROID__
 }
 
+void MotionPredictorMetricsManager::defaultReportInferenceLatencyFunction(
+        const MotionPredictorMetricsManager::InferenceLatencyPercentiles& latencies) {
+    LOG(DEBUG) << "Inference latency over " << latencies.inferenceCount
+               << " inferences: p50=" << latencies.p50 << "ns, p90=" << latencies.p90
+               << "ns, p99=" << latencies.p99 << "ns";
+}
+
 MotionPredictorMetricsManager::MotionPredictorMetricsManager(
         nsecs_t predictionInterval,
         size_t maxNumPredictions,
-        ReportAtomFunction reportAtomFunction)
+        ReportAtomFunction reportAtomFunction,
+        ReportInferenceLatencyFunction reportInferenceLatencyFunction)
       : mPredictionInterval(predictionInterval),
         mMaxNumPredictions(maxNumPredictions),
         mRecentGroundTruthPoints(maxNumPredictions + 1),
         mAggregatedMetrics(maxNumPredictions),
         mAtomFields(maxNumPredictions),
-        mReportAtomFunction(reportAtomFunction ? reportAtomFunction : defaultReportAtomFunction) {}
+        mReportAtomFunction(reportAtomFunction ? reportAtomFunction : defaultReportAtomFunction),
+        mReportInferenceLatencyFunction(reportInferenceLatencyFunction
+                                                ? reportInferenceLatencyFunction
+                                                : defaultReportInferenceLatencyFunction) {}
 
 void MotionPredictorMetricsManager::onRecord(const MotionEvent& inputEvent) {
     // Convert MotionEvent to GroundTruthPoint.
@@ -102,6 +123,7 @@ void MotionPredictorMetricsManager::onRecord(const MotionEvent& inputEvent) {
                 computeAtomFields();
                 reportMetrics();
             }
+            reportInferenceLatencies();
             break;
         }
     }
@@ -133,9 +155,14 @@ void MotionPredictorMetricsManager::onPredict(const MotionEvent& predictionEvent
     std::sort(mRecentPredictions.begin(), mRecentPredictions.end());
 }
 
+void MotionPredictorMetricsManager::onInference(nsecs_t inferenceLatency) {
+    mInferenceLatencies.push_back(inferenceLatency);
+}
+
 void MotionPredictorMetricsManager::clearStrokeData() {
     mRecentGroundTruthPoints.clear();
     mRecentPredictions.clear();
+    mInferenceLatencies.clear();
     std::fill(mAggregatedMetrics.begin(), mAggregatedMetrics.end(), AggregatedStrokeMetrics{});
     std::fill(mAtomFields.begin(), mAtomFields.end(), AtomFields{});
 }
@@ -379,4 +406,18 @@ void MotionPredictorMetricsManager::reportMetrics() {
     }
 }
 
+void MotionPredictorMetricsManager::reportInferenceLatencies() {
+    if (mInferenceLatencies.empty()) {
+        return;
+    }
+    const InferenceLatencyPercentiles latencies{
+            .inferenceCount = mInferenceLatencies.size(),
+            .p50 = nearestRankPercentile(mInferenceLatencies, 50),
+            .p90 = nearestRankPercentile(mInferenceLatencies, 90),
+            .p99 = nearestRankPercentile(mInferenceLatencies, 99),
+    };
+    mInferenceLatencies.clear();
+    mReportInferenceLatencyFunction(latencies);
+}
+
 } // namespace android
@@ -65,78 +65,68 @@ bool canResampleTool(ToolType toolType) {
 inline float lerp(float a, float b, float alpha) {
     return a + alpha * (b - a);
 }
-
-PointerCoords calculateResampledCoords(const PointerCoords& a, const PointerCoords& b,
-                                       float alpha) {
-    // We use the value of alpha to initialize resampledCoords with the latest sample information.
-    PointerCoords resampledCoords = (alpha < 1.0f) ? a : b;
-    resampledCoords.isResampled = true;
-    resampledCoords.setAxisValue(AMOTION_EVENT_AXIS_X, lerp(a.getX(), b.getX(), alpha));
-    resampledCoords.setAxisValue(AMOTION_EVENT_AXIS_Y, lerp(a.getY(), b.getY(), alpha));
-    return resampledCoords;
-}
 } // namespace
 
 void LegacyResampler::updateLatestSamples(const MotionEvent& motionEvent) {
     const size_t numSamples = motionEvent.getHistorySize() + 1;
     const size_t latestIndex = numSamples - 1;
     const size_t secondToLatestIndex = (latestIndex > 0) ? (latestIndex - 1) : 0;
+    const size_t numPointers = motionEvent.getPointerCount();
+    Sample sample;
+    sample.pointerCount = numPointers;
+    for (size_t pointerIndex = 0; pointerIndex < numPointers; ++pointerIndex) {
+        sample.properties[pointerIndex] = *motionEvent.getPointerProperties(pointerIndex);
+    }
     for (size_t sampleIndex = secondToLatestIndex; sampleIndex < numSamples; ++sampleIndex) {
-        std::vector<Pointer> pointers;
-        const size_t numPointers = motionEvent.getPointerCount();
-        for (size_t pointerIndex = 0; pointerIndex < numPointers; ++pointerIndex) {
-            // getSamplePointerCoords is the vector representation of a getHistorySize by
-            // getPointerCount matrix.
-            const PointerCoords& pointerCoords =
-                    motionEvent.getSamplePointerCoords()[sampleIndex * numPointers + pointerIndex];
-            pointers.push_back(
-                    Pointer{*motionEvent.getPointerProperties(pointerIndex), pointerCoords});
-        }
-        mLatestSamples.pushBack(
-                Sample{nanoseconds{motionEvent.getHistoricalEventTime(sampleIndex)}, pointers});
+        sample.eventTime = nanoseconds{motionEvent.getHistoricalEventTime(sampleIndex)};
+        // getSamplePointerCoords is the vector representation of a getHistorySize by
+        // getPointerCount matrix.
+        std::copy_n(motionEvent.getSamplePointerCoords() + sampleIndex * numPointers, numPointers,
+                    sample.coords.begin());
+        mLatestSamples.pushBack(sample);
     }
 }
 
 LegacyResampler::Sample LegacyResampler::messageToSample(const InputMessage& message) {
-    std::vector<Pointer> pointers;
+    Sample sample{.eventTime = nanoseconds{message.body.motion.eventTime},
+                  .pointerCount = message.body.motion.pointerCount};
     for (uint32_t i = 0; i < message.body.motion.pointerCount; ++i) {
-        pointers.push_back(Pointer{message.body.motion.pointers[i].properties,
-                                   message.body.motion.pointers[i].coords});
+        sample.properties[i] = message.body.motion.pointers[i].properties;
+        sample.coords[i] = message.body.motion.pointers[i].coords;
     }
-    return Sample{nanoseconds{message.body.motion.eventTime}, pointers};
+    return sample;
 }
 
 bool LegacyResampler::pointerPropertiesResampleable(const Sample& target, const Sample& auxiliary) {
-    if (target.pointers.size() > auxiliary.pointers.size()) {
+    if (target.pointerCount > auxiliary.pointerCount) {
         LOG_IF(INFO, debugResampling())
                 << "Not resampled. Auxiliary sample has fewer pointers than target sample.";
         return false;
     }
-    for (size_t i = 0; i < target.pointers.size(); ++i) {
-        if (target.pointers[i].properties.id != auxiliary.pointers[i].properties.id) {
+    for (size_t i = 0; i < target.pointerCount; ++i) {
+        if (target.properties[i].id != auxiliary.properties[i].id) {
             LOG_IF(INFO, debugResampling()) << "Not resampled. Pointer ID mismatch.";
             return false;
         }
-        if (target.pointers[i].properties.toolType != auxiliary.pointers[i].properties.toolType) {
+        if (target.properties[i].toolType != auxiliary.properties[i].toolType) {
             LOG_IF(INFO, debugResampling()) << "Not resampled. Pointer ToolType mismatch.";
             return false;
         }
-        if (!canResampleTool(target.pointers[i].properties.toolType)) {
+        if (!canResampleTool(target.properties[i].toolType)) {
             LOG_IF(INFO, debugResampling())
                     << "Not resampled. Cannot resample "
-                    << ftl::enum_string(target.pointers[i].properties.toolType) << " ToolType.";
+                    << ftl::enum_string(target.properties[i].toolType) << " ToolType.";
             return false;
         }
     }
     return true;
 }
 
-bool LegacyResampler::canInterpolate(const InputMessage& message) const {
+bool LegacyResampler::canInterpolate(const Sample& futureSample) const {
     LOG_IF(FATAL, mLatestSamples.empty())
             << "Not resampled. mLatestSamples must not be empty to interpolate.";
 
     const Sample& pastSample = *(mLatestSamples.end() - 1);
-    const Sample& futureSample = messageToSample(message);
 
     if (!pointerPropertiesResampleable(pastSample, futureSample)) {
         return false;
@@ -151,7 +141,8 @@ bool LegacyResampler::canInterpolate(const InputMessage& message) const {
 }
 
 std::optional<LegacyResampler::Sample> LegacyResampler::attemptInterpolation(
-        nanoseconds resampleTime, const InputMessage& futureSample) const {
+        nanoseconds resampleTime, const InputMessage& futureMessage) const {
+    const Sample futureSample = messageToSample(futureMessage);
     if (!canInterpolate(futureSample)) {
         return std::nullopt;
     }
@@ -160,19 +151,11 @@ std::optional<LegacyResampler::Sample> LegacyResampler::attemptInterpolation(
 
     const Sample& pastSample = *(mLatestSamples.end() - 1);
 
-    const nanoseconds delta =
-            nanoseconds{futureSample.body.motion.eventTime} - pastSample.eventTime;
+    const nanoseconds delta = futureSample.eventTime - pastSample.eventTime;
     const float alpha =
             std::chrono::duration<float, std::milli>(resampleTime - pastSample.eventTime) / delta;
 
-    std::vector<Pointer> resampledPointers;
-    for (size_t i = 0; i < pastSample.pointers.size(); ++i) {
-        const PointerCoords& resampledCoords =
-                calculateResampledCoords(pastSample.pointers[i].coords,
-                                         futureSample.body.motion.pointers[i].coords, alpha);
-        resampledPointers.push_back(Pointer{pastSample.pointers[i].properties, resampledCoords});
-    }
-    return Sample{resampleTime, resampledPointers};
+    return resampleCoords(pastSample, pastSample, futureSample, alpha, resampleTime);
 }
 
 bool LegacyResampler::canExtrapolate() const {
@@ -225,20 +208,45 @@ std::optional<LegacyResampler::Sample> LegacyResampler::attemptExtrapolation(
             std::chrono::duration<float, std::milli>(newResampleTime - pastSample.eventTime) /
             delta;
 
-    std::vector<Pointer> resampledPointers;
-    for (size_t i = 0; i < presentSample.pointers.size(); ++i) {
-        const PointerCoords& resampledCoords =
-                calculateResampledCoords(pastSample.pointers[i].coords,
-                                         presentSample.pointers[i].coords, alpha);
-        resampledPointers.push_back(Pointer{presentSample.pointers[i].properties, resampledCoords});
+    return resampleCoords(presentSample, pastSample, presentSample, alpha, newResampleTime);
+}
+
+LegacyResampler::Sample LegacyResampler::resampleCoords(const Sample& target, const Sample& a,
+                                                        const Sample& b, float alpha,
+                                                        nanoseconds resampleTime) {
+    const size_t pointerCount = target.pointerCount;
+    Sample resampled{.eventTime = resampleTime, .pointerCount = pointerCount};
+    std::copy_n(target.properties.begin(), pointerCount, resampled.properties.begin());
+
+    // Gather the positions of all the pointers into contiguous arrays, so that the interpolation
+    // below is a plain loop over floats that the compiler vectorizes.
+    std::array<float, MAX_POINTERS> ax, ay, bx, by;
+    for (size_t i = 0; i < pointerCount; ++i) {
+        ax[i] = a.coords[i].getX();
+        ay[i] = a.coords[i].getY();
+        bx[i] = b.coords[i].getX();
+        by[i] = b.coords[i].getY();
+    }
+    std::array<float, MAX_POINTERS> x, y;
+    for (size_t i = 0; i < pointerCount; ++i) {
+        x[i] = lerp(ax[i], bx[i], alpha);
+        y[i] = lerp(ay[i], by[i], alpha);
+    }
+
+    for (size_t i = 0; i < pointerCount; ++i) {
+        // We use the value of alpha to initialize the coords with the latest sample information.
+        PointerCoords& coords = resampled.coords[i];
+        coords = (alpha < 1.0f) ? a.coords[i] : b.coords[i];
+        coords.isResampled = true;
+        coords.setAxisValue(AMOTION_EVENT_AXIS_X, x[i]);
+        coords.setAxisValue(AMOTION_EVENT_AXIS_Y, y[i]);
     }
-    return Sample{newResampleTime, resampledPointers};
+    return resampled;
 }
 
 inline void LegacyResampler::addSampleToMotionEvent(const Sample& sample,
                                                     MotionEvent& motionEvent) {
-    motionEvent.addSample(sample.eventTime.count(), sample.asPointerCoords().data(),
-                          motionEvent.getId());
+    motionEvent.addSample(sample.eventTime.count(), sample.coords.data(), motionEvent.getId());
 }
 
 nanoseconds LegacyResampler::getResampleLatency() const {
@@ -23,6 +23,7 @@
 #include <math.h>
 #include <array>
 #include <optional>
+#include <span>
 
 #include <input/PrintTools.h>
 #include <input/VelocityTracker.h>
@@ -71,7 +72,12 @@ static const std::map<int32_t, VelocityTracker::Strategy> DEFAULT_STRATEGY_BY_AX
          {AMOTION_EVENT_AXIS_SCROLL, VelocityTracker::Strategy::IMPULSE}};
 
 // Axes specifying location on a 2D plane (i.e. X and Y).
-static const std::set<int32_t> PLANAR_AXES = {AMOTION_EVENT_AXIS_X, AMOTION_EVENT_AXIS_Y};
+static constexpr std::array<int32_t, 2> PLANAR_AXES = {AMOTION_EVENT_AXIS_X,
+                                                       AMOTION_EVENT_AXIS_Y};
+static constexpr std::array<int32_t, 1> SCROLL_AXES = {AMOTION_EVENT_AXIS_SCROLL};
+
+// Most axes processed from a single MotionEvent.
+static constexpr size_t MAX_AXES_PER_EVENT = PLANAR_AXES.size();
 
 // Axes whose motion values are differential values (i.e. deltas).
 static const std::set<int32_t> DIFFERENTIAL_AXES = {AMOTION_EVENT_AXIS_SCROLL};
@@ -119,7 +125,7 @@ static std::string vectorToString(const float* a, uint32_t m) {
     return str;
 }
 
-static std::string vectorToString(const std::vector<float>& v) {
+static std::string vectorToString(std::span<const float> v) {
     return vectorToString(v.data(), v.size());
 }
 
@@ -238,13 +244,21 @@ void VelocityTracker::clearPointer(int32_t pointerId) {
     }
 }
 
-void VelocityTracker::addMovement(nsecs_t eventTime, int32_t pointerId, int32_t axis,
-                                  float position) {
+VelocityTrackerStrategy& VelocityTracker::getOrConfigureStrategy(int32_t axis) {
+    auto it = mConfiguredStrategies.find(axis);
+    if (it == mConfiguredStrategies.end()) {
+        configureStrategy(axis);
+        it = mConfiguredStrategies.find(axis);
+    }
+    return *it->second;
+}
+
+bool VelocityTracker::startSample(nsecs_t eventTime, int32_t pointerId) {
     if (pointerId < 0 || pointerId > MAX_POINTER_ID) {
-        LOG(FATAL) << "Invalid pointer ID " << pointerId << " for axis "
-                   << MotionEvent::getLabel(axis);
+        LOG(FATAL) << "Invalid pointer ID " << pointerId;
     }
 
+    bool cleared = false;
     if (mCurrentPointerIdBits.hasBit(pointerId) &&
         std::chrono::nanoseconds(eventTime - mLastEventTime) > ASSUME_POINTER_STOPPED_TIME) {
         ALOGD_IF(DEBUG_VELOCITY, "VelocityTracker: stopped for %s, clearing state.",
@@ -253,6 +267,7 @@ void VelocityTracker::addMovement(nsecs_t eventTime, int32_t pointerId, int32_t
         // We have not received any movements for too long.  Assume that all pointers
         // have stopped.
         mConfiguredStrategies.clear();
+        cleared = true;
     }
     mLastEventTime = eventTime;
 
@@ -261,11 +276,13 @@ void VelocityTracker::addMovement(nsecs_t eventTime, int32_t pointerId, int32_t
         // Let this be the new active pointer if no active pointer is currently set
         mActivePointerId = pointerId;
     }
+    return cleared;
+}
 
-    if (mConfiguredStrategies.find(axis) == mConfiguredStrategies.end()) {
-        configureStrategy(axis);
-    }
-    mConfiguredStrategies[axis]->addMovement(eventTime, pointerId, position);
+void VelocityTracker::addMovement(nsecs_t eventTime, int32_t pointerId, int32_t axis,
+                                  float position) {
+    startSample(eventTime, pointerId);
+    getOrConfigureStrategy(axis).addMovement(eventTime, pointerId, position);
 
     if (DEBUG_VELOCITY) {
         LOG(INFO) << "VelocityTracker: addMovement axis=" << MotionEvent::getLabel(axis)
@@ -277,7 +294,7 @@ void VelocityTracker::addMovement(nsecs_t eventTime, int32_t pointerId, int32_t
 
 void VelocityTracker::addMovement(const MotionEvent& event) {
     // Stores data about which axes to process based on the incoming motion event.
-    std::set<int32_t> axesToProcess;
+    std::span<const int32_t> axesToProcess;
     int32_t actionMasked = event.getActionMasked();
 
     switch (actionMasked) {
@@ -285,19 +302,19 @@ void VelocityTracker::addMovement(const MotionEvent& event) {
         case AMOTION_EVENT_ACTION_HOVER_ENTER:
             // Clear all pointers on down before adding the new movement.
             clear();
-            axesToProcess.insert(PLANAR_AXES.begin(), PLANAR_AXES.end());
+            axesToProcess = PLANAR_AXES;
             break;
         case AMOTION_EVENT_ACTION_POINTER_DOWN: {
             // Start a new movement trace for a pointer that just went down.
             // We do this on down instead of on up because the client may want to query the
             // final velocity for a pointer that just went up.
             clearPointer(event.getPointerId(event.getActionIndex()));
-            axesToProcess.insert(PLANAR_AXES.begin(), PLANAR_AXES.end());
+            axesToProcess = PLANAR_AXES;
             break;
         }
         case AMOTION_EVENT_ACTION_MOVE:
         case AMOTION_EVENT_ACTION_HOVER_MOVE:
-            axesToProcess.insert(PLANAR_AXES.begin(), PLANAR_AXES.end());
+            axesToProcess = PLANAR_AXES;
             break;
         case AMOTION_EVENT_ACTION_POINTER_UP:
             if (event.getFlags() & AMOTION_EVENT_FLAG_CANCELED) {
@@ -329,7 +346,7 @@ void VelocityTracker::addMovement(const MotionEvent& event) {
             return;
         }
         case AMOTION_EVENT_ACTION_SCROLL:
-            axesToProcess.insert(AMOTION_EVENT_AXIS_SCROLL);
+            axesToProcess = SCROLL_AXES;
             break;
         case AMOTION_EVENT_ACTION_CANCEL: {
             clear();
@@ -341,6 +358,9 @@ void VelocityTracker::addMovement(const MotionEvent& event) {
             return;
     }
 
+    // The strategies stay the same for the whole event, unless the pointers are found to have
+    // stopped, so they are only looked up again then.
+    std::array<VelocityTrackerStrategy*, MAX_AXES_PER_EVENT> strategies{};
     const size_t historySize = event.getHistorySize();
     for (size_t h = 0; h <= historySize; h++) {
         const nsecs_t eventTime = event.getHistoricalEventTime(h);
@@ -349,9 +369,25 @@ void VelocityTracker::addMovement(const MotionEvent& event) {
                 continue; // skip resampled samples
             }
             const int32_t pointerId = event.getPointerId(i);
-            for (int32_t axis : axesToProcess) {
+            if (startSample(eventTime, pointerId)) {
+                strategies.fill(nullptr);
+            }
+            for (size_t a = 0; a < axesToProcess.size(); a++) {
+                const int32_t axis = axesToProcess[a];
+                if (!strategies[a]) {
+                    strategies[a] = &getOrConfigureStrategy(axis);
+                }
                 const float position = event.getHistoricalAxisValue(axis, i, h);
-                addMovement(eventTime, pointerId, axis, position);
+                strategies[a]->addMovement(eventTime, pointerId, position);
+
+                if (DEBUG_VELOCITY) {
+                    LOG(INFO) << "VelocityTracker: addMovement axis="
+                              << MotionEvent::getLabel(axis) << ", eventTime=" << eventTime
+                              << ", pointerId=" << pointerId
+                              << ", activePointerId=" << toString(mActivePointerId)
+                              << ", position=" << position
+                              << ", velocity=" << toString(getVelocity(axis, pointerId));
+                }
             }
         }
     }
@@ -388,13 +424,26 @@ AccumulatingVelocityTrackerStrategy::AccumulatingVelocityTrackerStrategy(
       : mHorizonNanos(horizonNanos), mMaintainHorizonDuringAdd(maintainHorizonDuringAdd) {}
 
 void AccumulatingVelocityTrackerStrategy::clearPointer(int32_t pointerId) {
-    mMovements.erase(pointerId);
+    if (pointerId >= 0 && pointerId <= MAX_POINTER_ID && mMovements[pointerId]) {
+        mMovements[pointerId]->clear();
+    }
+}
+
+const RingBuffer<AccumulatingVelocityTrackerStrategy::Movement>*
+AccumulatingVelocityTrackerStrategy::getMovements(int32_t pointerId) const {
+    if (pointerId < 0 || pointerId > MAX_POINTER_ID || !mMovements[pointerId] ||
+        mMovements[pointerId]->size() == 0) {
+        return nullptr;
+    }
+    return &*mMovements[pointerId];
 }
 
 void AccumulatingVelocityTrackerStrategy::addMovement(nsecs_t eventTime, int32_t pointerId,
                                                       float position) {
-    auto [ringBufferIt, _] = mMovements.try_emplace(pointerId, HISTORY_SIZE);
-    RingBuffer<Movement>& movements = ringBufferIt->second;
+    if (!mMovements[pointerId]) {
+        mMovements[pointerId].emplace(HISTORY_SIZE);
+    }
+    RingBuffer<Movement>& movements = *mMovements[pointerId];
     const size_t size = movements.size();
 
     if (size != 0 && movements[size - 1].eventTime == eventTime) {
@@ -479,9 +528,8 @@ LeastSquaresVelocityTrackerStrategy::~LeastSquaresVelocityTrackerStrategy() {}
  * http://en.wikipedia.org/wiki/Numerical_methods_for_linear_least_squares
  * http://en.wikipedia.org/wiki/Gram-Schmidt
  */
-static std::optional<float> solveLeastSquares(const std::vector<float>& x,
-                                              const std::vector<float>& y,
-                                              const std::vector<float>& w, uint32_t n) {
+static std::optional<float> solveLeastSquares(std::span<const float> x, std::span<const float> y,
+                                              std::span<const float> w, uint32_t n) {
     const size_t m = x.size();
 
     ALOGD_IF(DEBUG_STRATEGY, "solveLeastSquares: m=%d, n=%d, x=%s, y=%s, w=%s", int(m), int(n),
@@ -646,16 +694,13 @@ std::optional<float> LeastSquaresVelocityTrackerStrategy::solveUnweightedLeastSq
 }
 
 std::optional<float> LeastSquaresVelocityTrackerStrategy::getVelocity(int32_t pointerId) const {
-    const auto movementIt = mMovements.find(pointerId);
-    if (movementIt == mMovements.end()) {
+    const RingBuffer<Movement>* movementsPtr = getMovements(pointerId);
+    if (movementsPtr == nullptr) {
         return std::nullopt; // no data
     }
 
-    const RingBuffer<Movement>& movements = movementIt->second;
+    const RingBuffer<Movement>& movements = *movementsPtr;
     const size_t size = movements.size();
-    if (size == 0) {
-        return std::nullopt; // no data
-    }
 
     uint32_t degree = mDegree;
     if (degree > size - 1) {
@@ -672,25 +717,27 @@ std::optional<float> LeastSquaresVelocityTrackerStrategy::getVelocity(int32_t po
     }
 
     // Iterate over movement samples in reverse time order and collect samples.
-    std::vector<float> positions;
-    std::vector<float> w;
-    std::vector<float> time;
+    std::array<float, HISTORY_SIZE> positions;
+    std::array<float, HISTORY_SIZE> w;
+    std::array<float, HISTORY_SIZE> time;
 
     const Movement& newestMovement = movements[size - 1];
-    for (ssize_t i = size - 1; i >= 0; i--) {
-        const Movement& movement = movements[i];
+    for (size_t i = 0; i < size; i++) {
+        const size_t index = size - 1 - i;
+        const Movement& movement = movements[index];
         nsecs_t age = newestMovement.eventTime - movement.eventTime;
-        positions.push_back(movement.position);
-        w.push_back(chooseWeight(pointerId, i));
-        time.push_back(-age * 0.000000001f);
+        positions[i] = movement.position;
+        w[i] = chooseWeight(movements, index);
+        time[i] = -age * 0.000000001f;
     }
 
     // General case for an Nth degree polynomial fit
-    return solveLeastSquares(time, positions, w, degree + 1);
+    return solveLeastSquares(std::span(time).first(size), std::span(positions).first(size),
+                             std::span(w).first(size), degree + 1);
 }
 
-float LeastSquaresVelocityTrackerStrategy::chooseWeight(int32_t pointerId, uint32_t index) const {
-    const RingBuffer<Movement>& movements = mMovements.at(pointerId);
+float LeastSquaresVelocityTrackerStrategy::chooseWeight(const RingBuffer<Movement>& movements,
+                                                        uint32_t index) const {
     const size_t size = movements.size();
     switch (mWeighting) {
         case Weighting::DELTA: {
@@ -843,16 +890,13 @@ LegacyVelocityTrackerStrategy::~LegacyVelocityTrackerStrategy() {
 }
 
 std::optional<float> LegacyVelocityTrackerStrategy::getVelocity(int32_t pointerId) const {
-    const auto movementIt = mMovements.find(pointerId);
-    if (movementIt == mMovements.end()) {
+    const RingBuffer<Movement>* movementsPtr = getMovements(pointerId);
+    if (movementsPtr == nullptr) {
         return std::nullopt; // no data
     }
 
-    const RingBuffer<Movement>& movements = movementIt->second;
+    const RingBuffer<Movement>& movements = *movementsPtr;
     const size_t size = movements.size();
-    if (size == 0) {
-        return std::nullopt; // no data
-    }
 
     const Movement& newestMovement = movements[size - 1];
 
@@ -992,16 +1036,13 @@ static float kineticEnergyToVelocity(float work) {
 }
 
 std::optional<float> ImpulseVelocityTrackerStrategy::getVelocity(int32_t pointerId) const {
-    const auto movementIt = mMovements.find(pointerId);
-    if (movementIt == mMovements.end()) {
+    const RingBuffer<Movement>* movementsPtr = getMovements(pointerId);
+    if (movementsPtr == nullptr) {
         return std::nullopt; // no data
     }
 
-    const RingBuffer<Movement>& movements = movementIt->second;
+    const RingBuffer<Movement>& movements = *movementsPtr;
     const size_t size = movements.size();
-    if (size == 0) {
-        return std::nullopt; // no data
-    }
 
     float work = 0;
     for (size_t i = 0; i < size - 1; i++) {
@@ -25,6 +25,7 @@
 #include <input/VirtualInputDevice.h>
 #include <linux/uinput.h>
 
+#include <chrono>
 #include <string>
 
 using android::base::unique_fd;
@@ -292,9 +293,38 @@ bool VirtualInputDevice::writeInputEvent(uint16_t type, uint16_t code, int32_t v
     ev.input_event_sec = static_cast<decltype(ev.input_event_sec)>(seconds.count());
     ev.input_event_usec = static_cast<decltype(ev.input_event_usec)>(microseconds.count());
 
+    if (mBatching) {
+        mBatchedEvents.push_back(ev);
+        return true;
+    }
     return TEMP_FAILURE_RETRY(write(mFd, &ev, sizeof(struct input_event))) == sizeof(ev);
 }
 
+void VirtualInputDevice::beginBatch() {
+    mBatching = true;
+    mBatchedEvents.clear();
+}
+
+bool VirtualInputDevice::endBatch(bool commit) {
+    mBatching = false;
+    if (!commit || mBatchedEvents.empty()) {
+        mBatchedEvents.clear();
+        return true;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    const ssize_t size = static_cast<ssize_t>(mBatchedEvents.size() * sizeof(input_event));
+    const bool written =
+            TEMP_FAILURE_RETRY(write(mFd, mBatchedEvents.data(), static_cast<size_t>(size))) ==
+            size;
+    ALOGD_IF(isDebug(), "Wrote %zu events to device %d in %lldus", mBatchedEvents.size(),
+             mFd.get(),
+             static_cast<long long>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                            std::chrono::steady_clock::now() - start)
+                                            .count()));
+    mBatchedEvents.clear();
+    return written;
+}
+
 /** Utility method to write keyboard key events or mouse/stylus button events. */
 bool VirtualInputDevice::writeEvKeyEvent(int32_t androidCode, int32_t androidAction,
                                          const std::map<int, int>& evKeyCodeMapping,
@@ -596,6 +626,35 @@ bool VirtualTouchscreen::isValidPointerId(int32_t pointerId, UinputAction uinput
 bool VirtualTouchscreen::writeTouchEvent(int32_t pointerId, int32_t toolType, int32_t action,
                                          float locationX, float locationY, float pressure,
                                          float majorAxisSize, std::chrono::nanoseconds eventTime) {
+    const TouchPointer pointer{pointerId, toolType,  action,       locationX,
+                               locationY, pressure, majorAxisSize};
+    return writeTouchFrame({&pointer, 1}, eventTime);
+}
+
+bool VirtualTouchscreen::writeTouchFrame(std::span<const TouchPointer> pointers,
+                                         std::chrono::nanoseconds eventTime) {
+    const std::bitset<MAX_POINTERS> activePointers = mActivePointers;
+    beginBatch();
+    for (const TouchPointer& pointer : pointers) {
+        if (!writeTouchPointer(pointer, eventTime)) {
+            endBatch(/*commit=*/false);
+            mActivePointers = activePointers;
+            return false;
+        }
+    }
+    writeInputEvent(EV_SYN, SYN_REPORT, 0, eventTime);
+    if (!endBatch(/*commit=*/true)) {
+        ALOGE("Failed to write %zu pointer(s) to touchscreen %d.", pointers.size(), mFd.get());
+        mActivePointers = activePointers;
+        return false;
+    }
+    return true;
+}
+
+bool VirtualTouchscreen::writeTouchPointer(const TouchPointer& pointer,
+                                           std::chrono::nanoseconds eventTime) {
+    const auto& [pointerId, toolType, action, locationX, locationY, pressure, majorAxisSize] =
+            pointer;
     auto actionIterator = TOUCH_ACTION_MAPPING.find(action);
     if (actionIterator == TOUCH_ACTION_MAPPING.end()) {
         return false;
@@ -637,7 +696,7 @@ bool VirtualTouchscreen::writeTouchEvent(int32_t pointerId, int32_t toolType, in
             return false;
         }
     }
-    return writeInputEvent(EV_SYN, SYN_REPORT, 0, eventTime);
+    return true;
 }
 
 bool VirtualTouchscreen::handleTouchUp(int32_t pointerId, std::chrono::nanoseconds eventTime) {
@@ -15,6 +15,7 @@
  */
 
 #include <array>
+#include <vector>
 
 #include <unistd.h>
 #include <time.h>
@@ -176,6 +177,59 @@ TEST_F(InputChannelTest, ReceiveSignal_WhenPeerClosed_ReturnsAnError) {
             << "receiveMessage should have returned DEAD_OBJECT";
 }
 
+TEST_F(InputChannelTest, ReceiveMessages_ReceivesPendingMessagesInOrder) {
+    std::unique_ptr<InputChannel> serverChannel, clientChannel;
+    ASSERT_EQ(OK, InputChannel::openInputChannelPair("channel name", serverChannel, clientChannel));
+
+    constexpr uint32_t kMessageCount = 5;
+    for (uint32_t seq = 1; seq <= kMessageCount; seq++) {
+        InputMessage msg = {};
+        msg.header.type = InputMessage::Type::KEY;
+        msg.header.seq = seq;
+        ASSERT_EQ(OK, serverChannel->sendMessage(&msg));
+    }
+
+    // Receive the messages in a buffer smaller than the number of pending messages.
+    std::array<InputMessage, 3> messages;
+    std::vector<uint32_t> receivedSeqs;
+    while (receivedSeqs.size() < kMessageCount) {
+        android::base::Result<size_t> result = clientChannel->receiveMessages(messages);
+        ASSERT_TRUE(result.ok()) << "should receive the messages sent so far";
+        ASSERT_GE(*result, 1u);
+        ASSERT_LE(*result, messages.size());
+        for (size_t i = 0; i < *result; i++) {
+            EXPECT_EQ(InputMessage::Type::KEY, messages[i].header.type);
+            receivedSeqs.push_back(messages[i].header.seq);
+        }
+    }
+    EXPECT_EQ(std::vector<uint32_t>({1, 2, 3, 4, 5}), receivedSeqs);
+
+    android::base::Result<size_t> result = clientChannel->receiveMessages(messages);
+    ASSERT_FALSE(result.ok());
+    EXPECT_EQ(WOULD_BLOCK, result.error().code());
+}
+
+TEST_F(InputChannelTest, ReceiveMessages_WhenPeerClosed_ReturnsPendingMessagesFirst) {
+    std::unique_ptr<InputChannel> serverChannel, clientChannel;
+    ASSERT_EQ(OK, InputChannel::openInputChannelPair("channel name", serverChannel, clientChannel));
+
+    InputMessage msg = {};
+    msg.header.type = InputMessage::Type::KEY;
+    msg.header.seq = 1;
+    ASSERT_EQ(OK, serverChannel->sendMessage(&msg));
+    serverChannel.reset(); // close server channel
+
+    std::array<InputMessage, 4> messages;
+    android::base::Result<size_t> result = clientChannel->receiveMessages(messages);
+    ASSERT_TRUE(result.ok());
+    ASSERT_EQ(1u, *result);
+    EXPECT_EQ(1u, messages[0].header.seq);
+
+    result = clientChannel->receiveMessages(messages);
+    ASSERT_FALSE(result.ok());
+    EXPECT_EQ(DEAD_OBJECT, result.error().code());
+}
+
 TEST_F(InputChannelTest, SendSignal_WhenPeerClosed_ReturnsAnError) {
     std::unique_ptr<InputChannel> serverChannel, clientChannel;
 
@@ -193,6 +247,51 @@ TEST_F(InputChannelTest, SendSignal_WhenPeerClosed_ReturnsAnError) {
             << "sendMessage should have returned DEAD_OBJECT";
 }
 
+TEST_F(InputChannelTest, SendMessages_SendsMessagesInOrder) {
+    std::unique_ptr<InputChannel> serverChannel, clientChannel;
+    ASSERT_EQ(OK, InputChannel::openInputChannelPair("channel name", serverChannel, clientChannel));
+
+    constexpr uint32_t kMessageCount = 20;
+    std::vector<InputMessage> messages(kMessageCount);
+    for (uint32_t i = 0; i < kMessageCount; i++) {
+        messages[i].header.type = InputMessage::Type::FOCUS;
+        messages[i].header.seq = i + 1;
+        messages[i].body.focus.eventId = i;
+        messages[i].body.focus.hasFocus = true;
+    }
+
+    std::span<const InputMessage> pending(messages);
+    while (!pending.empty()) {
+        android::base::Result<size_t> result = serverChannel->sendMessages(pending);
+        ASSERT_TRUE(result.ok()) << "the channel should have room for all the messages";
+        ASSERT_GE(*result, 1u);
+        pending = pending.subspan(*result);
+    }
+
+    for (uint32_t seq = 1; seq <= kMessageCount; seq++) {
+        android::base::Result<InputMessage> msg = clientChannel->receiveMessage();
+        ASSERT_TRUE(msg.ok());
+        EXPECT_EQ(InputMessage::Type::FOCUS, msg->header.type);
+        EXPECT_EQ(seq, msg->header.seq);
+        EXPECT_TRUE(msg->body.focus.hasFocus);
+    }
+    EXPECT_FALSE(clientChannel->receiveMessage().ok());
+}
+
+TEST_F(InputChannelTest, SendMessages_WhenPeerClosed_ReturnsAnError) {
+    std::unique_ptr<InputChannel> serverChannel, clientChannel;
+    ASSERT_EQ(OK, InputChannel::openInputChannelPair("channel name", serverChannel, clientChannel));
+    serverChannel.reset(); // close server channel
+
+    std::array<InputMessage, 2> messages = {};
+    for (InputMessage& msg : messages) {
+        msg.header.type = InputMessage::Type::KEY;
+    }
+    android::base::Result<size_t> result = clientChannel->sendMessages(messages);
+    ASSERT_FALSE(result.ok());
+    EXPECT_EQ(DEAD_OBJECT, result.error().code());
+}
+
 TEST_F(InputChannelTest, SendAndReceive_MotionClassification) {
     std::unique_ptr<InputChannel> serverChannel, clientChannel;
     status_t result = InputChannel::openInputChannelPair("channel name",
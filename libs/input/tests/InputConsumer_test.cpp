@@ -199,6 +199,53 @@ TEST_F(InputConsumerTest, LastBatchedSampleIsLessThanResampleTime) {
     mClientTestChannel->assertFinishMessage(/*seq=*/3, true);
 }
 
+TEST_F(InputConsumerTest, BatchPartiallyConsumedAcrossFrames) {
+    mClientTestChannel->enqueueMessage(InputMessageBuilder{InputMessage::Type::MOTION, /*seq=*/0}
+                                               .eventTime(nanoseconds{0ms}.count())
+                                               .action(AMOTION_EVENT_ACTION_DOWN)
+                                               .build());
+    for (uint32_t seq = 1; seq <= 4; seq++) {
+        mClientTestChannel->enqueueMessage(InputMessageBuilder{InputMessage::Type::MOTION, seq}
+                                                   .eventTime(nanoseconds{seq * 5ms}.count())
+                                                   .action(AMOTION_EVENT_ACTION_MOVE)
+                                                   .build());
+    }
+    invokeLooperCallback();
+    assertOnBatchedInputEventPendingWasCalled();
+
+    // The moves at 5ms and 10ms are before the adjusted frame time.
+    mConsumer->consumeBatchedInputEvents(16'000'000 /*ns*/);
+    assertReceivedMotionEvent(WithMotionAction(AMOTION_EVENT_ACTION_DOWN));
+    std::unique_ptr<MotionEvent> moveMotionEvent = mMotionEvents.pop();
+    ASSERT_NE(moveMotionEvent, nullptr);
+    EXPECT_EQ(nanoseconds{5ms}.count(), moveMotionEvent->getHistoricalEventTime(0));
+    EXPECT_EQ(nanoseconds{10ms}.count(), moveMotionEvent->getHistoricalEventTime(1));
+    EXPECT_TRUE(mConsumer->probablyHasInput());
+
+    // New moves are appended after those left in the batch.
+    for (uint32_t seq = 5; seq <= 6; seq++) {
+        mClientTestChannel->enqueueMessage(InputMessageBuilder{InputMessage::Type::MOTION, seq}
+                                                   .eventTime(nanoseconds{seq * 5ms}.count())
+                                                   .action(AMOTION_EVENT_ACTION_MOVE)
+                                                   .build());
+    }
+    invokeLooperCallback();
+    assertOnBatchedInputEventPendingWasCalled();
+
+    mConsumer->consumeBatchedInputEvents(std::nullopt);
+    moveMotionEvent = mMotionEvents.pop();
+    ASSERT_NE(moveMotionEvent, nullptr);
+    ASSERT_GE(moveMotionEvent->getHistorySize() + 1, 4UL);
+    for (size_t i = 0; i < 4; i++) {
+        EXPECT_EQ(nanoseconds{(i + 3) * 5ms}.count(), moveMotionEvent->getHistoricalEventTime(i));
+    }
+    EXPECT_FALSE(mConsumer->probablyHasInput());
+
+    for (uint32_t seq = 0; seq <= 6; seq++) {
+        mClientTestChannel->assertFinishMessage(seq, /*handled=*/true);
+    }
+}
+
 TEST_F(InputConsumerTest, BatchedEventsMultiDeviceConsumption) {
     mClientTestChannel->enqueueMessage(InputMessageBuilder{InputMessage::Type::MOTION, /*seq=*/0}
                                                .deviceId(0)
@@ -21,6 +21,8 @@
 #include <input/KeyLayoutMap.h>
 #include <input/Keyboard.h>
 #include <linux/uinput.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "android-base/file.h"
 
 namespace android {
@@ -36,6 +38,44 @@ TEST(InputDeviceIdentifierTest, getCanonicalName) {
     ASSERT_EQ(std::string("deviceName-123_version_C_"), identifier.getCanonicalName());
 }
 
+TEST(InputDeviceConfigurationFileTest, SystemSearchResultsAreCachedUntilCleared) {
+    const char* previousRoot = getenv("ANDROID_ROOT");
+    const std::string savedRoot = previousRoot != nullptr ? previousRoot : "";
+    TemporaryDir root;
+    ASSERT_EQ(0, setenv("ANDROID_ROOT", root.path, /*overwrite=*/1));
+
+    const std::string dir = std::string(root.path) + "/usr/idc";
+    ASSERT_EQ(0, mkdir((std::string(root.path) + "/usr").c_str(), 0755));
+    ASSERT_EQ(0, mkdir(dir.c_str(), 0755));
+    const std::string file = dir + "/CacheTestDevice.idc";
+    ASSERT_TRUE(base::WriteStringToFile("", file));
+
+    EXPECT_EQ(file,
+              getInputDeviceConfigurationFilePathByName("CacheTestDevice",
+                                                        InputDeviceConfigurationFileType::
+                                                                CONFIGURATION));
+
+    // The system locations are not probed again until the cache is cleared.
+    ASSERT_EQ(0, unlink(file.c_str()));
+    EXPECT_EQ(file,
+              getInputDeviceConfigurationFilePathByName("CacheTestDevice",
+                                                        InputDeviceConfigurationFileType::
+                                                                CONFIGURATION));
+    clearInputDeviceConfigurationFilePathCache();
+    EXPECT_EQ("",
+              getInputDeviceConfigurationFilePathByName("CacheTestDevice",
+                                                        InputDeviceConfigurationFileType::
+                                                                CONFIGURATION));
+
+    rmdir(dir.c_str());
+    rmdir((std::string(root.path) + "/usr").c_str());
+    if (previousRoot != nullptr) {
+        setenv("ANDROID_ROOT", savedRoot.c_str(), /*overwrite=*/1);
+    } else {
+        unsetenv("ANDROID_ROOT");
+    }
+}
+
 class InputDeviceKeyMapTest : public testing::Test {
 protected:
     void loadKeyLayout(const char* name) {
@@ -134,6 +174,26 @@ TEST_F(InputDeviceKeyMapTest, keyCharacterMapApplyMultipleOverlaysTest) {
     ASSERT_EQ(*mKeyMap.keyCharacterMap, *frenchOverlaidKeyCharacterMap);
 }
 
+TEST_F(InputDeviceKeyMapTest, keyCharacterMapLoadedTwiceIsNotShared) {
+    base::Result<std::shared_ptr<KeyCharacterMap>> ret =
+            KeyCharacterMap::load(mKeyMap.keyCharacterMapFile, KeyCharacterMap::Format::BASE);
+    ASSERT_TRUE(ret.ok()) << "Cannot load KeyCharacterMap at " << mKeyMap.keyCharacterMapFile;
+    const std::shared_ptr<KeyCharacterMap>& map = *ret;
+    ASSERT_NE(map, mKeyMap.keyCharacterMap);
+    ASSERT_EQ(*map, *mKeyMap.keyCharacterMap);
+
+    // Applying an overlay to one of the maps does not change the other.
+    std::string germanOverlayPath = base::GetExecutableDirectory() + "/data/german.kcm";
+    base::Result<std::shared_ptr<KeyCharacterMap>> germanOverlay =
+            KeyCharacterMap::load(germanOverlayPath, KeyCharacterMap::Format::OVERLAY);
+    ASSERT_TRUE(germanOverlay.ok()) << "Cannot load KeyCharacterMap at " << germanOverlayPath;
+    map->combine(*germanOverlay->get());
+    ASSERT_NE(*map, *mKeyMap.keyCharacterMap);
+
+    map->clearLayoutOverlay();
+    ASSERT_EQ(*map, *mKeyMap.keyCharacterMap);
+}
+
 TEST_F(InputDeviceKeyMapTest, keyCharacterMapApplyOverlayTest) {
     std::string frenchOverlayPath = base::GetExecutableDirectory() + "/data/french.kcm";
     base::Result<std::shared_ptr<KeyCharacterMap>> frenchOverlay =
@@ -202,6 +262,27 @@ TEST(InputDeviceKeyLayoutTest, HidUsageCodesFallbackMapping) {
     }
 }
 
+TEST(InputDeviceKeyLayoutTest, UnchangedFileIsOnlyParsedOnce) {
+    TemporaryFile klFile;
+    ASSERT_TRUE(base::WriteStringToFile("key 1 ESCAPE\n", klFile.path));
+    base::Result<std::shared_ptr<KeyLayoutMap>> first = KeyLayoutMap::load(klFile.path);
+    ASSERT_TRUE(first.ok()) << "Unable to load KeyLayout at " << klFile.path;
+    base::Result<std::shared_ptr<KeyLayoutMap>> second = KeyLayoutMap::load(klFile.path);
+    ASSERT_TRUE(second.ok()) << "Unable to load KeyLayout at " << klFile.path;
+    ASSERT_EQ(*first, *second);
+
+    // A changed file is parsed again.
+    ASSERT_TRUE(base::WriteStringToFile("key 1 ESCAPE\nkey 2 1\n", klFile.path));
+    base::Result<std::shared_ptr<KeyLayoutMap>> changed = KeyLayoutMap::load(klFile.path);
+    ASSERT_TRUE(changed.ok()) << "Unable to load KeyLayout at " << klFile.path;
+    ASSERT_NE(*first, *changed);
+    int32_t keyCode;
+    uint32_t flags;
+    ASSERT_EQ(OK, (*changed)->mapKey(/*scanCode=*/2, /*usageCode=*/0, &keyCode, &flags));
+    ASSERT_EQ(AKEYCODE_1, keyCode);
+    ASSERT_EQ(NAME_NOT_FOUND, (*first)->mapKey(/*scanCode=*/2, /*usageCode=*/0, &keyCode, &flags));
+}
+
 TEST(InputDeviceKeyLayoutTest, DoesNotLoadWhenRequiredKernelConfigIsMissing) {
 #if !defined(__ANDROID__)
     GTEST_SKIP() << "Can't check kernel configs on host";
@@ -672,6 +672,39 @@ TEST_F(InputPublisherAndConsumerTest,
     ASSERT_EQ(BAD_VALUE, status) << "publisher publishMotionEvent should return BAD_VALUE";
 }
 
+TEST_F(InputPublisherAndConsumerTest, PublishMotionBatch_EndToEnd) {
+    const nsecs_t downTime = systemTime(SYSTEM_TIME_MONOTONIC);
+    const std::vector<Pointer> pointers = {Pointer{.id = 0, .x = 20, .y = 30},
+                                           Pointer{.id = 1, .x = 200, .y = 300}};
+    std::vector<PublishMotionArgs> batch;
+    batch.emplace_back(AMOTION_EVENT_ACTION_DOWN, downTime,
+                       std::vector<Pointer>{Pointer{.id = 0, .x = 20, .y = 30}}, /*seq=*/1);
+    batch.emplace_back(POINTER_1_DOWN, downTime, pointers, /*seq=*/2);
+    batch.emplace_back(AMOTION_EVENT_ACTION_CANCEL, downTime, pointers, /*seq=*/3);
+
+    mPublisher->beginMotionBatch();
+    for (const PublishMotionArgs& args : batch) {
+        ASSERT_NO_FATAL_FAILURE(publishMotionEvent(*mPublisher, args));
+    }
+    // Nothing is sent until the batch ends.
+    EXPECT_FALSE(mConsumer->probablyHasInput());
+    Result<size_t> sent = mPublisher->endMotionBatch();
+    ASSERT_TRUE(sent.ok());
+    ASSERT_EQ(batch.size(), *sent);
+
+    for (const PublishMotionArgs& args : batch) {
+        uint32_t consumeSeq;
+        InputEvent* event;
+        status_t status = mConsumer->consume(&mEventFactory, /*consumeBatches=*/true, -1,
+                                             &consumeSeq, &event);
+        ASSERT_EQ(OK, status) << "consumer consume should return OK";
+        ASSERT_EQ(InputEventType::MOTION, event->getType());
+        EXPECT_EQ(args.seq, consumeSeq);
+        verifyArgsEqualToEvent(args, static_cast<const MotionEvent&>(*event));
+    }
+    EXPECT_FALSE(mConsumer->probablyHasInput());
+}
+
 TEST_F(InputPublisherAndConsumerTest, PublishMultipleEvents_EndToEnd) {
     const nsecs_t downTime = systemTime(SYSTEM_TIME_MONOTONIC);
 
@@ -51,4 +51,43 @@ TEST(InputVerifierTest, ProcessSourceClassPointer) {
     ASSERT_TRUE(result.ok());
 }
 
+TEST(InputVerifierTest, RepeatedMoveIsStillVerifiedAfterStateChanges) {
+    InputVerifier verifier("Verify repeated moves");
+
+    PointerProperties properties;
+    properties.clear();
+    properties.id = 0;
+    properties.toolType = ToolType::FINGER;
+
+    PointerCoords coords;
+    coords.clear();
+    coords.setAxisValue(AMOTION_EVENT_AXIS_X, 75);
+    coords.setAxisValue(AMOTION_EVENT_AXIS_Y, 300);
+
+    const auto process = [&](int32_t action) {
+        return verifier.processMovement(/*deviceId=*/0, AINPUT_SOURCE_TOUCHSCREEN, action,
+                                        /*pointerCount=*/1, &properties, &coords, /*flags=*/0);
+    };
+
+    ASSERT_TRUE(process(AMOTION_EVENT_ACTION_DOWN).ok());
+    ASSERT_TRUE(process(AMOTION_EVENT_ACTION_MOVE).ok());
+    ASSERT_TRUE(process(AMOTION_EVENT_ACTION_MOVE).ok());
+
+    // A move with a different pointer must not be accepted because of the previous move.
+    properties.id = 1;
+    ASSERT_FALSE(process(AMOTION_EVENT_ACTION_MOVE).ok());
+    properties.id = 0;
+    ASSERT_TRUE(process(AMOTION_EVENT_ACTION_MOVE).ok());
+
+    // Once the pointer is lifted, the same move is no longer valid.
+    ASSERT_TRUE(process(AMOTION_EVENT_ACTION_UP).ok());
+    ASSERT_FALSE(process(AMOTION_EVENT_ACTION_MOVE).ok());
+
+    // Neither is it after the device is reset.
+    ASSERT_TRUE(process(AMOTION_EVENT_ACTION_DOWN).ok());
+    ASSERT_TRUE(process(AMOTION_EVENT_ACTION_MOVE).ok());
+    verifier.resetDevice(/*deviceId=*/0);
+    ASSERT_FALSE(process(AMOTION_EVENT_ACTION_MOVE).ok());
+}
+
 } // namespace android
@@ -40,6 +40,7 @@ using GroundTruthPoint = MotionPredictorMetricsManager::GroundTruthPoint;
 using PredictionPoint = MotionPredictorMetricsManager::PredictionPoint;
 using AtomFields = MotionPredictorMetricsManager::AtomFields;
 using ReportAtomFunction = MotionPredictorMetricsManager::ReportAtomFunction;
+using InferenceLatencyPercentiles = MotionPredictorMetricsManager::InferenceLatencyPercentiles;
 
 inline constexpr int NANOS_PER_MILLIS = 1'000'000;
 
@@ -1005,5 +1006,43 @@ TEST(MotionPredictorMetricsManagerTest, MismatchedInputAndPredictionInterval) {
     runMetricsManager(groundTruthPoints, predictionPoints, reportedAtomFields);
 }
 
+
+// Inference latency test:
+//  • Input: one stroke with 100 inferences taking 1 to 100 ms, in reverse order, then a stroke with
+//    no inferences.
+//  • Expectation: the nearest-rank percentiles are reported once, at the end of the first stroke.
+TEST(MotionPredictorMetricsManagerTest, ReportsInferenceLatencyPercentiles) {
+    std::vector<AtomFields> reportedAtomFields;
+    std::vector<InferenceLatencyPercentiles> reportedLatencies;
+    auto reportLatencies = [&reportedLatencies](const InferenceLatencyPercentiles& latencies) {
+        reportedLatencies.push_back(latencies);
+    };
+    MotionPredictorMetricsManager metricsManager(TEST_PREDICTION_INTERVAL_NANOS,
+                                                 TEST_MAX_NUM_PREDICTIONS,
+                                                 createMockReportAtomFunction(reportedAtomFields),
+                                                 reportLatencies);
+
+    const MotionEvent downEvent = MotionEventBuilder(AMOTION_EVENT_ACTION_DOWN,
+                                                     AINPUT_SOURCE_CLASS_POINTER)
+                                          .eventTime(TEST_INITIAL_TIMESTAMP)
+                                          .pointer(PointerBuilder(/*id=*/0, ToolType::STYLUS))
+                                          .build();
+    metricsManager.onRecord(downEvent);
+    for (nsecs_t millis = 100; millis > 0; --millis) {
+        metricsManager.onInference(millis * NANOS_PER_MILLIS);
+    }
+    metricsManager.onRecord(makeLiftMotionEvent());
+
+    ASSERT_EQ(1u, reportedLatencies.size());
+    EXPECT_EQ(100u, reportedLatencies[0].inferenceCount);
+    EXPECT_EQ(50 * NANOS_PER_MILLIS, reportedLatencies[0].p50);
+    EXPECT_EQ(90 * NANOS_PER_MILLIS, reportedLatencies[0].p90);
+    EXPECT_EQ(99 * NANOS_PER_MILLIS, reportedLatencies[0].p99);
+
+    metricsManager.onRecord(downEvent);
+    metricsManager.onRecord(makeLiftMotionEvent());
+    EXPECT_EQ(1u, reportedLatencies.size());
+}
+
 } // namespace
 } // namespace android
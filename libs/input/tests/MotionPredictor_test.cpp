@@ -17,6 +17,7 @@
 // TODO(b/331815574): Decouple this test from assumed config values.
 #include <chrono>
 #include <cmath>
+#include <thread>
 
 #include <com_android_input_flags.h>
 #include <flag_macros.h>
@@ -214,6 +215,31 @@ TEST(MotionPredictorTest, FollowsGesture) {
     EXPECT_EQ(nullptr, predictor.predict(100 * NSEC_PER_MSEC));
 }
 
+TEST(MotionPredictorTest, AsyncInferenceFollowsGesture) {
+    MotionPredictor predictor(/*predictionTimestampOffsetNanos=*/0,
+                              []() { return true /*enable prediction*/; },
+                              /*reportAtomFunction=*/{}, /*asyncInference=*/true);
+    predictor.record(getMotionEvent(DOWN, 3.75, 3, 20ms));
+    predictor.record(getMotionEvent(MOVE, 4.8, 3, 30ms));
+    predictor.record(getMotionEvent(MOVE, 6.2, 3, 40ms));
+    predictor.record(getMotionEvent(MOVE, 8, 3, 50ms));
+
+    // The model runs on another thread, so the prediction is only available once it completes.
+    std::unique_ptr<MotionEvent> predicted;
+    const auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (predicted == nullptr && std::chrono::steady_clock::now() < deadline) {
+        predicted = predictor.predict(90 * NSEC_PER_MSEC);
+        std::this_thread::sleep_for(1ms);
+    }
+    ASSERT_NE(nullptr, predicted);
+
+    // The latest completed inference keeps being used until the end of the gesture.
+    EXPECT_NE(nullptr, predictor.predict(90 * NSEC_PER_MSEC));
+
+    predictor.record(getMotionEvent(UP, 10.25, 3, 60ms));
+    EXPECT_EQ(nullptr, predictor.predict(100 * NSEC_PER_MSEC));
+}
+
 TEST(MotionPredictorTest, MultipleDevicesNotSupported) {
     MotionPredictor predictor(/*predictionTimestampOffsetNanos=*/0,
                               []() { return true /*enable prediction*/; });
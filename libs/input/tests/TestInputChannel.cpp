@@ -64,6 +64,13 @@ status_t TestInputChannel::sendMessage(const InputMessage* message) {
     return OK;
 }
 
+base::Result<size_t> TestInputChannel::sendMessages(std::span<const InputMessage> messages) {
+    for (const InputMessage& message : messages) {
+        mSentMessages.push(message);
+    }
+    return messages.size();
+}
+
 base::Result<InputMessage> TestInputChannel::receiveMessage() {
     if (mReceivedMessages.empty()) {
         return base::Error(WOULD_BLOCK);
@@ -73,6 +80,18 @@ base::Result<InputMessage> TestInputChannel::receiveMessage() {
     return message;
 }
 
+base::Result<size_t> TestInputChannel::receiveMessages(std::span<InputMessage> outMessages) {
+    if (mReceivedMessages.empty()) {
+        return base::Error(WOULD_BLOCK);
+    }
+    size_t count = 0;
+    while (count < outMessages.size() && !mReceivedMessages.empty()) {
+        outMessages[count++] = mReceivedMessages.front();
+        mReceivedMessages.pop();
+    }
+    return count;
+}
+
 bool TestInputChannel::probablyHasInput() const {
     return !mReceivedMessages.empty();
 }
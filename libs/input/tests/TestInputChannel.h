@@ -42,12 +42,22 @@ public:
      */
     status_t sendMessage(const InputMessage* message) override;
 
+    /**
+     * Pushes all the messages to mSentMessages.
+     */
+    base::Result<size_t> sendMessages(std::span<const InputMessage> messages) override;
+
     /**
      * Returns an InputMessage from mReceivedMessages. This is done instead of retrieving data
      * directly from fd.
      */
     base::Result<InputMessage> receiveMessage() override;
 
+    /**
+     * Returns the InputMessages in mReceivedMessages, up to the size of outMessages.
+     */
+    base::Result<size_t> receiveMessages(std::span<InputMessage> outMessages) override;
+
     /**
      * Returns if mReceivedMessages is not empty.
      */
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <attestation/HmacKeyManager.h>
+#include <input/Input.h>
+#include <input/VelocityTracker.h>
+
+#include <chrono>
+#include <vector>
+
+namespace android {
+namespace {
+
+// A touchscreen reporting at 240Hz, with its samples batched into 60Hz frames.
+constexpr std::chrono::nanoseconds SAMPLE_INTERVAL =
+        std::chrono::nanoseconds(std::chrono::seconds(1)) / 240;
+constexpr size_t SAMPLES_PER_FRAME = 4;
+constexpr size_t FRAMES = 30;
+
+PointerCoords fingerCoords(size_t finger, size_t sample) {
+    PointerCoords coords;
+    coords.clear();
+    coords.setAxisValue(AMOTION_EVENT_AXIS_X, 100 + finger * 80 + 2.f * sample);
+    coords.setAxisValue(AMOTION_EVENT_AXIS_Y, 2000 - 15.f * sample - 0.02f * sample * sample);
+    return coords;
+}
+
+// The ACTION_MOVE events of a gesture with the given number of fingers down, each event carrying
+// SAMPLES_PER_FRAME samples.
+std::vector<MotionEvent> createGesture(size_t fingers) {
+    std::vector<PointerProperties> properties(fingers);
+    for (size_t finger = 0; finger < fingers; finger++) {
+        properties[finger].clear();
+        properties[finger].id = finger;
+        properties[finger].toolType = ToolType::FINGER;
+    }
+
+    std::vector<MotionEvent> events;
+    std::vector<PointerCoords> coords(fingers);
+    for (size_t frame = 0; frame < FRAMES; frame++) {
+        MotionEvent& event = events.emplace_back();
+        for (size_t s = 0; s < SAMPLES_PER_FRAME; s++) {
+            const size_t sample = frame * SAMPLES_PER_FRAME + s;
+            const nsecs_t eventTime = (SAMPLE_INTERVAL * sample).count();
+            for (size_t finger = 0; finger < fingers; finger++) {
+                coords[finger] = fingerCoords(finger, sample);
+            }
+            if (s == 0) {
+                ui::Transform identityTransform;
+                event.initialize(InputEvent::nextId(), /*deviceId=*/0, AINPUT_SOURCE_TOUCHSCREEN,
+                                 ui::LogicalDisplayId::DEFAULT, INVALID_HMAC,
+                                 AMOTION_EVENT_ACTION_MOVE, /*actionButton=*/0, /*flags=*/0,
+                                 AMOTION_EVENT_EDGE_FLAG_NONE, AMETA_NONE, /*buttonState=*/0,
+                                 MotionClassification::NONE, identityTransform,
+                                 /*xPrecision=*/0, /*yPrecision=*/0,
+                                 AMOTION_EVENT_INVALID_CURSOR_POSITION,
+                                 AMOTION_EVENT_INVALID_CURSOR_POSITION, identityTransform,
+                                 /*downTime=*/0, eventTime, fingers, properties.data(),
+                                 coords.data());
+            } else {
+                event.addSample(eventTime, coords.data(), InputEvent::nextId());
+            }
+        }
+    }
+    return events;
+}
+
+// Feeds a gesture to a VelocityTracker, and queries the velocity of every finger after every frame
+// like a scrolling view would.
+void BM_VelocityTracker(benchmark::State& state, VelocityTracker::Strategy strategy) {
+    const size_t fingers = state.range(0);
+    const std::vector<MotionEvent> events = createGesture(fingers);
+    for (auto _ : state) {
+        VelocityTracker tracker(strategy);
+        for (const MotionEvent& event : events) {
+            tracker.addMovement(event);
+            for (size_t finger = 0; finger < fingers; finger++) {
+                benchmark::DoNotOptimize(tracker.getVelocity(AMOTION_EVENT_AXIS_X, finger));
+                benchmark::DoNotOptimize(tracker.getVelocity(AMOTION_EVENT_AXIS_Y, finger));
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * FRAMES);
+}
+
+BENCHMARK_CAPTURE(BM_VelocityTracker, lsq2, VelocityTracker::Strategy::LSQ2)->Arg(1)->Arg(10);
+BENCHMARK_CAPTURE(BM_VelocityTracker, lsq3, VelocityTracker::Strategy::LSQ3)->Arg(1)->Arg(10);
+BENCHMARK_CAPTURE(BM_VelocityTracker, wlsq2Recent, VelocityTracker::Strategy::WLSQ2_RECENT)
+        ->Arg(1)
+        ->Arg(10);
+BENCHMARK_CAPTURE(BM_VelocityTracker, impulse, VelocityTracker::Strategy::IMPULSE)
+        ->Arg(1)
+        ->Arg(10);
+
+} // namespace
+} // namespace android
+
+BENCHMARK_MAIN();
@@ -22,6 +22,7 @@
 #include <limits>
 
 #include <android-base/stringprintf.h>
+#include <ftl/enum.h>
 #include <attestation/HmacKeyManager.h>
 #include <gtest/gtest.h>
 #include <input/VelocityTracker.h>
@@ -399,6 +400,51 @@ TEST_F(VelocityTrackerTest, MultiPointerResampledData) {
                             /*pointerId=*/1);
 }
 
+TEST_F(VelocityTrackerTest, MotionEventMatchesIndividualMovements) {
+    std::vector<PlanarMotionEventEntry> motions = {
+            {0ms, {{0, 0}}},
+            {8ms, {{1, 2}, {10, 20}}},
+            {16ms, {{3, 3}, {12, 19}}},
+            {24ms, {{6, 5}, {15, 17}}},
+            {32ms, {{10, 6}, {19, 14}}},
+            {40ms, {{15, 8}, {24, 10}}},
+            {48ms, {{21, 9}}}, // ACTION_UP
+    };
+    const std::vector<MotionEvent> events = createTouchMotionEventStream(motions);
+
+    for (VelocityTracker::Strategy strategy :
+         {VelocityTracker::Strategy::IMPULSE, VelocityTracker::Strategy::LSQ1,
+          VelocityTracker::Strategy::LSQ2, VelocityTracker::Strategy::LSQ3,
+          VelocityTracker::Strategy::WLSQ2_DELTA, VelocityTracker::Strategy::INT2,
+          VelocityTracker::Strategy::LEGACY}) {
+        VelocityTracker fromEvents(strategy);
+        VelocityTracker fromMovements(strategy);
+        for (const MotionEvent& event : events) {
+            fromEvents.addMovement(event);
+            // Lifting pointers does not add movements.
+            if (event.getActionMasked() == AMOTION_EVENT_ACTION_UP ||
+                event.getActionMasked() == AMOTION_EVENT_ACTION_POINTER_UP) {
+                continue;
+            }
+            for (size_t i = 0; i < event.getPointerCount(); i++) {
+                for (int32_t axis : {AMOTION_EVENT_AXIS_X, AMOTION_EVENT_AXIS_Y}) {
+                    fromMovements.addMovement(event.getEventTime(), event.getPointerId(i), axis,
+                                              event.getAxisValue(axis, i));
+                }
+            }
+        }
+
+        for (int32_t pointerId : {0, 1}) {
+            for (int32_t axis : {AMOTION_EVENT_AXIS_X, AMOTION_EVENT_AXIS_Y}) {
+                EXPECT_EQ(fromMovements.getVelocity(axis, pointerId),
+                          fromEvents.getVelocity(axis, pointerId))
+                        << ftl::enum_string(strategy) << " pointer " << pointerId << " axis "
+                        << MotionEvent::getLabel(axis);
+            }
+        }
+    }
+}
+
 TEST_F(VelocityTrackerTest, TestGetComputedVelocity) {
     std::vector<PlanarMotionEventEntry> motions = {
             {235089067457000ns, {{528.00, 0}}}, {235089084684000ns, {{527.00, 0}}},
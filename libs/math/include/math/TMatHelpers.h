@@ -224,6 +224,61 @@ CONSTEXPR MATRIX PURE fastInverse3(const MATRIX& x) {
     return inverted;
 }
 
+//------------------------------------------------------------------------------
+// 4x4 matrix inverse by Laplace expansion along pairs of rows: the determinants
+// of the 2x2 submatrices of the top two rows (s0-s5) and of the bottom two rows
+// (c0-c5) are shared by all the cofactors. This is straight-line code that
+// compilers vectorize, unlike the pivoting loops of gaussJordanInverse.
+template <typename MATRIX>
+CONSTEXPR MATRIX PURE fastInverse4(const MATRIX& x) {
+    typedef typename MATRIX::value_type T;
+
+    // Importantly, our matrices are column-major! aRC is the element of row R
+    // and column C.
+    const T a00 = x[0][0], a01 = x[1][0], a02 = x[2][0], a03 = x[3][0];
+    const T a10 = x[0][1], a11 = x[1][1], a12 = x[2][1], a13 = x[3][1];
+    const T a20 = x[0][2], a21 = x[1][2], a22 = x[2][2], a23 = x[3][2];
+    const T a30 = x[0][3], a31 = x[1][3], a32 = x[2][3], a33 = x[3][3];
+
+    const T s0 = a00 * a11 - a10 * a01;
+    const T s1 = a00 * a12 - a10 * a02;
+    const T s2 = a00 * a13 - a10 * a03;
+    const T s3 = a01 * a12 - a11 * a02;
+    const T s4 = a01 * a13 - a11 * a03;
+    const T s5 = a02 * a13 - a12 * a03;
+
+    const T c0 = a20 * a31 - a30 * a21;
+    const T c1 = a20 * a32 - a30 * a22;
+    const T c2 = a20 * a33 - a30 * a23;
+    const T c3 = a21 * a32 - a31 * a22;
+    const T c4 = a21 * a33 - a31 * a23;
+    const T c5 = a22 * a33 - a32 * a23;
+
+    const T det(s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+
+    MATRIX inverted(MATRIX::NO_INIT);
+    inverted[0][0] = ( a11 * c5 - a12 * c4 + a13 * c3) / det;
+    inverted[1][0] = (-a01 * c5 + a02 * c4 - a03 * c3) / det;
+    inverted[2][0] = ( a31 * s5 - a32 * s4 + a33 * s3) / det;
+    inverted[3][0] = (-a21 * s5 + a22 * s4 - a23 * s3) / det;
+
+    inverted[0][1] = (-a10 * c5 + a12 * c2 - a13 * c1) / det;
+    inverted[1][1] = ( a00 * c5 - a02 * c2 + a03 * c1) / det;
+    inverted[2][1] = (-a30 * s5 + a32 * s2 - a33 * s1) / det;
+    inverted[3][1] = ( a20 * s5 - a22 * s2 + a23 * s1) / det;
+
+    inverted[0][2] = ( a10 * c4 - a11 * c2 + a13 * c0) / det;
+    inverted[1][2] = (-a00 * c4 + a01 * c2 - a03 * c0) / det;
+    inverted[2][2] = ( a30 * s4 - a31 * s2 + a33 * s0) / det;
+    inverted[3][2] = (-a20 * s4 + a21 * s2 - a23 * s0) / det;
+
+    inverted[0][3] = (-a10 * c3 + a11 * c1 - a12 * c0) / det;
+    inverted[1][3] = ( a00 * c3 - a01 * c1 + a02 * c0) / det;
+    inverted[2][3] = (-a30 * s3 + a31 * s1 - a32 * s0) / det;
+    inverted[3][3] = ( a20 * s3 - a21 * s1 + a22 * s0) / det;
+    return inverted;
+}
+
 /**
  * Inversion function which switches on the matrix size.
  * @warning This function assumes the matrix is invertible. The result is
@@ -235,7 +290,8 @@ inline constexpr MATRIX PURE inverse(const MATRIX& matrix) {
     static_assert(MATRIX::NUM_ROWS == MATRIX::NUM_COLS, "only square matrices can be inverted");
     return (MATRIX::NUM_ROWS == 2) ? fastInverse2<MATRIX>(matrix) :
           ((MATRIX::NUM_ROWS == 3) ? fastInverse3<MATRIX>(matrix) :
-                    gaussJordanInverse<MATRIX>(matrix));
+          ((MATRIX::NUM_ROWS == 4) ? fastInverse4<MATRIX>(matrix) :
+                    gaussJordanInverse<MATRIX>(matrix)));
 }
 
 template<typename MATRIX_R, typename MATRIX_A, typename MATRIX_B>
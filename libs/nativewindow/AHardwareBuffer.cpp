@@ -22,10 +22,16 @@
 #include <vndk/hardware_buffer.h>
 
 #include <errno.h>
+#include <poll.h>
 #include <sys/socket.h>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
+#include <android-base/unique_fd.h>
 #include <cutils/native_handle.h>
+#include <gralloctypes/Gralloc4.h>
 #include <log/log.h>
 #include <utils/StrongPointer.h>
 #include <ui/GraphicBuffer.h>
@@ -340,6 +346,256 @@ int AHardwareBuffer_unlock(AHardwareBuffer* buffer, int32_t* fence) {
         return gBuffer->unlockAsync(fence);
 }
 
+namespace {
+
+// Plane layout of a YUV buffer, as offsets from the address returned by a plain lock. Mappers
+// 4.0 and up derive the planes of lockYCbCr from the PLANE_LAYOUTS metadata of the buffer, which
+// is decoded on every call, so batch locks remember it per buffer id instead.
+struct YuvPlaneLayout {
+    size_t offsets[3]; // Y, Cb, Cr
+    uint32_t pixelStrides[3];
+    uint32_t rowStrides[3];
+};
+
+constexpr size_t kMaxCachedYuvPlaneLayouts = 64;
+
+// P010 is word-aligned 10-bit semiplaner, and YCbCr_422_I is a single interleaved plane
+uint32_t yuvPixelStride(int format) {
+    return format == AHARDWAREBUFFER_FORMAT_YCbCr_P010 ||
+                    format == AHARDWAREBUFFER_FORMAT_YCbCr_422_I
+            ? 2
+            : 1;
+}
+
+std::mutex gYuvPlaneLayoutsMutex;
+std::unordered_map<uint64_t, YuvPlaneLayout> gYuvPlaneLayouts;
+
+bool getYuvPlaneLayout(GraphicBuffer* gBuffer, int format, YuvPlaneLayout* outLayout) {
+    {
+        std::lock_guard lock(gYuvPlaneLayoutsMutex);
+        auto it = gYuvPlaneLayouts.find(gBuffer->getId());
+        if (it != gYuvPlaneLayouts.end()) {
+            *outLayout = it->second;
+            return true;
+        }
+    }
+
+    auto planeLayouts = GraphicBufferMapper::get().getPlaneLayouts(gBuffer->handle);
+    if (!planeLayouts.has_value()) {
+        return false;
+    }
+
+    // Same rules as the mappers' lockYCbCr.
+    using aidl::android::hardware::graphics::common::PlaneLayoutComponentType;
+    bool found[3] = {false, false, false};
+    YuvPlaneLayout layout = {};
+    for (const auto& planeLayout : planeLayouts.value()) {
+        for (const auto& component : planeLayout.components) {
+            if (component.type.name != GRALLOC4_STANDARD_PLANE_LAYOUT_COMPONENT_TYPE) {
+                continue;
+            }
+            size_t plane;
+            switch (static_cast<PlaneLayoutComponentType>(component.type.value)) {
+                case PlaneLayoutComponentType::Y:
+                    plane = 0;
+                    break;
+                case PlaneLayoutComponentType::CB:
+                    plane = 1;
+                    break;
+                case PlaneLayoutComponentType::CR:
+                    plane = 2;
+                    break;
+                default:
+                    continue;
+            }
+            const int64_t sampleIncrement = planeLayout.sampleIncrementInBits / 8;
+            if (found[plane] || planeLayout.sampleIncrementInBits % 8 != 0 ||
+                (plane != 0 && sampleIncrement != 1 && sampleIncrement != 2 &&
+                 sampleIncrement != 4)) {
+                return false;
+            }
+            found[plane] = true;
+            layout.offsets[plane] = planeLayout.offsetInBytes + component.offsetInBits / 8;
+            layout.pixelStrides[plane] = static_cast<uint32_t>(sampleIncrement);
+            layout.rowStrides[plane] = static_cast<uint32_t>(planeLayout.strideInBytes);
+        }
+    }
+    if (!found[0] || !found[1] || !found[2] || layout.rowStrides[1] != layout.rowStrides[2] ||
+        layout.pixelStrides[1] != layout.pixelStrides[2]) {
+        return false;
+    }
+    // Match AHardwareBuffer_lockPlanes, which doesn't take the Y increment from the mapper.
+    layout.pixelStrides[0] = yuvPixelStride(format);
+
+    std::lock_guard lock(gYuvPlaneLayoutsMutex);
+    if (gYuvPlaneLayouts.size() >= kMaxCachedYuvPlaneLayouts) {
+        gYuvPlaneLayouts.clear();
+    }
+    gYuvPlaneLayouts.emplace(gBuffer->getId(), layout);
+    *outLayout = layout;
+    return true;
+}
+
+// Waits for all the fences at once, rather than for each in turn in the mapper.
+status_t waitForFences(const std::vector<base::unique_fd>& fences) {
+    std::vector<pollfd> fds;
+    for (const auto& fence : fences) {
+        if (fence.ok()) {
+            fds.push_back({fence.get(), POLLIN, 0});
+        }
+    }
+    while (!fds.empty()) {
+        int ret = poll(fds.data(), fds.size(), -1);
+        if (ret < 0) {
+            if (errno == EINTR || errno == EAGAIN) continue;
+            return -errno;
+        }
+        for (size_t i = 0; i < fds.size();) {
+            if (fds[i].revents & (POLLERR | POLLNVAL)) {
+                return UNKNOWN_ERROR;
+            }
+            if (fds[i].revents & POLLIN) {
+                fds[i] = fds.back();
+                fds.pop_back();
+            } else {
+                i++;
+            }
+        }
+    }
+    return OK;
+}
+
+int lockPlanesSignaled(GraphicBuffer* gBuffer, uint64_t usage, const Rect& bounds,
+                       AHardwareBuffer_Planes* outPlanes) {
+    int format = AHardwareBuffer_convertFromPixelFormat(uint32_t(gBuffer->getPixelFormat()));
+    memset(outPlanes->planes, 0, sizeof(outPlanes->planes));
+    outPlanes->planeCount = 0;
+
+    YuvPlaneLayout layout;
+    const bool isYuv = AHardwareBuffer_formatIsYuv(format);
+    if (isYuv &&
+        (gBuffer->getBufferMapperVersion() < GraphicBufferMapper::Version::GRALLOC_4 ||
+         !getYuvPlaneLayout(gBuffer, format, &layout))) {
+        android_ycbcr yuvData;
+        int result = gBuffer->lockAsyncYCbCr(usage, bounds, &yuvData, -1);
+        if (result != 0) return result;
+        outPlanes->planeCount = 3;
+        outPlanes->planes[0] = {yuvData.y, yuvPixelStride(format),
+                                static_cast<uint32_t>(yuvData.ystride)};
+        outPlanes->planes[1] = {yuvData.cb, static_cast<uint32_t>(yuvData.chroma_step),
+                                static_cast<uint32_t>(yuvData.cstride)};
+        outPlanes->planes[2] = {yuvData.cr, static_cast<uint32_t>(yuvData.chroma_step),
+                                static_cast<uint32_t>(yuvData.cstride)};
+        return 0;
+    }
+
+    void* data = nullptr;
+    int32_t bytesPerPixel;
+    int32_t bytesPerStride;
+    int result = gBuffer->lockAsync(usage, usage, bounds, &data, -1, &bytesPerPixel,
+                                    &bytesPerStride);
+    if (result != 0) return result;
+    if (isYuv) {
+        outPlanes->planeCount = 3;
+        for (size_t i = 0; i < 3; i++) {
+            outPlanes->planes[i] = {static_cast<uint8_t*>(data) + layout.offsets[i],
+                                    layout.pixelStrides[i], layout.rowStrides[i]};
+        }
+    } else {
+        outPlanes->planeCount = 1;
+        outPlanes->planes[0] = {data, static_cast<uint32_t>(bytesPerPixel),
+                                static_cast<uint32_t>(bytesPerStride)};
+    }
+    return 0;
+}
+
+} // namespace
+
+int AHardwareBuffer_lockPlanesBatch(const AHardwareBuffer_LockRequest* requests, uint32_t count,
+                                    AHardwareBuffer_Planes* outPlanes) {
+    if (count != 0 && (!requests || !outPlanes)) return BAD_VALUE;
+
+    // The fences are owned by this call whatever happens.
+    std::vector<base::unique_fd> fences;
+    fences.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        fences.emplace_back(requests[i].fence);
+        outPlanes[i].planeCount = 0;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        const AHardwareBuffer_LockRequest& request = requests[i];
+        if (!request.buffer) return BAD_VALUE;
+        if (request.usage &
+                    ~(AHARDWAREBUFFER_USAGE_CPU_READ_MASK | AHARDWAREBUFFER_USAGE_CPU_WRITE_MASK) ||
+            request.usage == 0) {
+            ALOGE("Invalid usage flags passed to AHardwareBuffer_lockPlanesBatch; only "
+                  "AHARDWAREBUFFER_USAGE_CPU_* flags are allowed");
+            return BAD_VALUE;
+        }
+        if (AHardwareBuffer_to_GraphicBuffer(request.buffer)->getLayerCount() > 1) {
+            ALOGE("Buffer with multiple layers passed to AHardwareBuffer_lockPlanesBatch; "
+                  "only buffers with one layer are allowed");
+            return BAD_VALUE;
+        }
+    }
+
+    status_t result = waitForFences(fences);
+    if (result != OK) {
+        ALOGE("Failed to wait for the fences passed to AHardwareBuffer_lockPlanesBatch: %d",
+              result);
+        return result;
+    }
+    fences.clear();
+
+    for (uint32_t i = 0; i < count; i++) {
+        const AHardwareBuffer_LockRequest& request = requests[i];
+        GraphicBuffer* gBuffer = AHardwareBuffer_to_GraphicBuffer(request.buffer);
+        Rect bounds;
+        if (!request.rect) {
+            bounds.set(Rect(gBuffer->getWidth(), gBuffer->getHeight()));
+        } else {
+            bounds.set(Rect(request.rect->left, request.rect->top, request.rect->right,
+                            request.rect->bottom));
+        }
+        result = lockPlanesSignaled(gBuffer,
+                                    AHardwareBuffer_convertToGrallocUsageBits(request.usage),
+                                    bounds, &outPlanes[i]);
+        if (result != 0) {
+            // Either all the buffers are locked, or none are.
+            while (i-- > 0) {
+                AHardwareBuffer_to_GraphicBuffer(requests[i].buffer)->unlock();
+                outPlanes[i].planeCount = 0;
+            }
+            return result;
+        }
+    }
+    return 0;
+}
+
+int AHardwareBuffer_unlockBatch(AHardwareBuffer* const* buffers, uint32_t count,
+                                int32_t* outFences) {
+    if (count != 0 && !buffers) return BAD_VALUE;
+    for (uint32_t i = 0; i < count; i++) {
+        if (!buffers[i]) return BAD_VALUE;
+    }
+
+    int result = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        GraphicBuffer* gBuffer = AHardwareBuffer_to_GraphicBuffer(buffers[i]);
+        int err;
+        if (outFences) {
+            outFences[i] = -1;
+            err = gBuffer->unlockAsync(&outFences[i]);
+        } else {
+            err = gBuffer->unlock();
+        }
+        // Unlock the remaining buffers even if one fails.
+        if (err != 0 && result == 0) result = err;
+    }
+    return result;
+}
+
 int AHardwareBuffer_sendHandleToUnixSocket(const AHardwareBuffer* buffer, int socketFd) {
     if (!buffer) return BAD_VALUE;
     const GraphicBuffer* gBuffer = AHardwareBuffer_to_GraphicBuffer(buffer);
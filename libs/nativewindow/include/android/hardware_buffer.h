@@ -621,6 +621,59 @@ int AHardwareBuffer_lockAndGetInfo(AHardwareBuffer* _Nonnull buffer, uint64_t us
 int AHardwareBuffer_getId(const AHardwareBuffer* _Nonnull buffer, uint64_t* _Nonnull outId)
         __INTRODUCED_IN(31);
 
+/**
+ * Describes one buffer to lock with AHardwareBuffer_lockPlanesBatch.
+ */
+typedef struct AHardwareBuffer_LockRequest {
+    AHardwareBuffer* _Nonnull buffer; ///< Buffer to lock
+    uint64_t usage;                   ///< Combination of AHARDWAREBUFFER_USAGE_CPU_* flags
+    int32_t fence;                    ///< Fence to wait on before locking the buffer, or -1
+    const ARect* _Nullable rect;      ///< Area the caller will access, or NULL for the whole buffer
+} AHardwareBuffer_LockRequest;
+
+/**
+ * Lock several AHardwareBuffers for direct CPU access.
+ *
+ * This function is equivalent to calling AHardwareBuffer_lockPlanes for each
+ * request, and returns the planes of \a requests[i] in \a outPlanes[i]. It is
+ * meant for CPU pipelines that process many buffers per frame: the fences of
+ * all the requests are waited on together before any buffer is locked, and the
+ * plane layouts of YUV buffers are remembered across calls instead of being
+ * queried from the allocator on every lock.
+ *
+ * The function takes ownership of the fences of all the requests, even if it
+ * fails. Either all the buffers are locked, or none are.
+ *
+ * Unlock the buffers with AHardwareBuffer_unlock or AHardwareBuffer_unlockBatch.
+ *
+ * Available since API level 36.
+ *
+ * \return 0 on success. -EINVAL if \a requests or \a outPlanes is NULL, or
+ * any request is invalid for AHardwareBuffer_lockPlanes. Error number if
+ * waiting on a fence or locking a buffer fails for any other reason.
+ */
+int AHardwareBuffer_lockPlanesBatch(const AHardwareBuffer_LockRequest* _Nullable requests,
+                                    uint32_t count, AHardwareBuffer_Planes* _Nullable outPlanes)
+        __INTRODUCED_IN(36);
+
+/**
+ * Unlock several AHardwareBuffers from direct CPU access.
+ *
+ * This function is equivalent to calling AHardwareBuffer_unlock for each
+ * buffer. If \a outFences is NULL, the function blocks until all work is
+ * completed. Otherwise \a outFences[i] is set to the fence of \a buffers[i],
+ * as described in AHardwareBuffer_unlock.
+ *
+ * All the buffers are unlocked, even if unlocking one of them fails.
+ *
+ * Available since API level 36.
+ *
+ * \return 0 on success. -EINVAL if \a buffers or any of the buffers is NULL.
+ * The error number of the first unlock that failed otherwise.
+ */
+int AHardwareBuffer_unlockBatch(AHardwareBuffer* _Nonnull const* _Nullable buffers, uint32_t count,
+                                int32_t* _Nullable outFences) __INTRODUCED_IN(36);
+
 __END_DECLS
 
 #endif // ANDROID_HARDWARE_BUFFER_H
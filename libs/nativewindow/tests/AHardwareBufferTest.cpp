@@ -255,4 +255,58 @@ TEST(AHardwareBufferTest, GetSetDataspace) {
     }
 
     AHardwareBuffer_release(buffer);
-}
\ No newline at end of file
+}
+TEST(AHardwareBufferTest, LockPlanesBatchMatchesLockPlanes) {
+    constexpr uint32_t kBufferCount = 3;
+    const std::array<uint32_t, kBufferCount> formats = {AHARDWAREBUFFER_FORMAT_R8G8B8A8_UNORM,
+                                                        AHARDWAREBUFFER_FORMAT_Y8Cb8Cr8_420,
+                                                        AHARDWAREBUFFER_FORMAT_Y8Cb8Cr8_420};
+    const uint64_t usage =
+            AHARDWAREBUFFER_USAGE_CPU_READ_OFTEN | AHARDWAREBUFFER_USAGE_CPU_WRITE_OFTEN;
+
+    std::array<AHardwareBuffer*, kBufferCount> buffers{};
+    std::array<AHardwareBuffer_LockRequest, kBufferCount> requests{};
+    for (uint32_t i = 0; i < kBufferCount; i++) {
+        AHardwareBuffer_Desc desc{
+                .width = 64,
+                .height = 48,
+                .layers = 1,
+                .format = formats[i],
+                .usage = usage,
+                .stride = 0,
+        };
+        ASSERT_EQ(0, AHardwareBuffer_allocate(&desc, &buffers[i]));
+        requests[i] = {.buffer = buffers[i], .usage = usage, .fence = -1, .rect = nullptr};
+    }
+
+    // Lock twice so that the second batch uses the cached YUV plane layouts.
+    for (int pass = 0; pass < 2; pass++) {
+        std::array<AHardwareBuffer_Planes, kBufferCount> batchPlanes{};
+        ASSERT_EQ(0,
+                  AHardwareBuffer_lockPlanesBatch(requests.data(), kBufferCount,
+                                                  batchPlanes.data()));
+        ASSERT_EQ(0, AHardwareBuffer_unlockBatch(buffers.data(), kBufferCount, nullptr));
+
+        for (uint32_t i = 0; i < kBufferCount; i++) {
+            AHardwareBuffer_Planes planes{};
+            ASSERT_EQ(0, AHardwareBuffer_lockPlanes(buffers[i], usage, -1, nullptr, &planes));
+            ASSERT_EQ(planes.planeCount, batchPlanes[i].planeCount);
+            // The mapping may move between locks, but not the planes within it.
+            const auto offset = [](const AHardwareBuffer_Planes& planes, uint32_t p) {
+                return static_cast<uint8_t*>(planes.planes[p].data) -
+                        static_cast<uint8_t*>(planes.planes[0].data);
+            };
+            for (uint32_t p = 0; p < planes.planeCount; p++) {
+                EXPECT_NE(nullptr, batchPlanes[i].planes[p].data);
+                EXPECT_EQ(offset(planes, p), offset(batchPlanes[i], p));
+                EXPECT_EQ(planes.planes[p].pixelStride, batchPlanes[i].planes[p].pixelStride);
+                EXPECT_EQ(planes.planes[p].rowStride, batchPlanes[i].planes[p].rowStride);
+            }
+            ASSERT_EQ(0, AHardwareBuffer_unlock(buffers[i], nullptr));
+        }
+    }
+
+    for (AHardwareBuffer* buffer : buffers) {
+        AHardwareBuffer_release(buffer);
+    }
+}
@@ -71,4 +71,69 @@ static void BM_AHardwareBuffer_Desc(benchmark::State& state) {
 }
 BENCHMARK(BM_AHardwareBuffer_Desc);
 
+constexpr size_t kBatchSize = 8;
+
+constexpr AHardwareBuffer_Desc k720pYuvDesc = {.width = 1280,
+                                               .height = 720,
+                                               .layers = 1,
+                                               .format = AHARDWAREBUFFER_FORMAT_Y8Cb8Cr8_420,
+                                               .usage = AHARDWAREBUFFER_USAGE_CPU_READ_OFTEN,
+                                               .stride = 0};
+
+static bool AllocateBatch(benchmark::State& state, AHardwareBuffer* (&buffers)[kBatchSize]) {
+    for (AHardwareBuffer*& buffer : buffers) {
+        if (UNLIKELY(AHardwareBuffer_allocate(&k720pYuvDesc, &buffer) != 0)) {
+            state.SkipWithError("Unable to allocate buffer.");
+            return false;
+        }
+    }
+    return true;
+}
+
+static void ReleaseBatch(AHardwareBuffer* (&buffers)[kBatchSize]) {
+    for (AHardwareBuffer* buffer : buffers) {
+        if (buffer) AHardwareBuffer_release(buffer);
+    }
+}
+
+static void BM_AHardwareBuffer_LockPlanesEach(benchmark::State& state) {
+    AHardwareBuffer* buffers[kBatchSize] = {};
+    if (AllocateBatch(state, buffers)) {
+        for (auto _ : state) {
+            for (AHardwareBuffer* buffer : buffers) {
+                AHardwareBuffer_Planes planes;
+                if (UNLIKELY(AHardwareBuffer_lockPlanes(buffer, k720pYuvDesc.usage, -1, nullptr,
+                                                        &planes) != 0)) {
+                    state.SkipWithError("Unable to lock buffer.");
+                }
+                AHardwareBuffer_unlock(buffer, nullptr);
+            }
+        }
+    }
+    ReleaseBatch(buffers);
+}
+BENCHMARK(BM_AHardwareBuffer_LockPlanesEach);
+
+static void BM_AHardwareBuffer_LockPlanesBatch(benchmark::State& state) {
+    AHardwareBuffer* buffers[kBatchSize] = {};
+    if (AllocateBatch(state, buffers)) {
+        AHardwareBuffer_LockRequest requests[kBatchSize];
+        for (size_t i = 0; i < kBatchSize; i++) {
+            requests[i] = {.buffer = buffers[i],
+                           .usage = k720pYuvDesc.usage,
+                           .fence = -1,
+                           .rect = nullptr};
+        }
+        for (auto _ : state) {
+            AHardwareBuffer_Planes planes[kBatchSize];
+            if (UNLIKELY(AHardwareBuffer_lockPlanesBatch(requests, kBatchSize, planes) != 0)) {
+                state.SkipWithError("Unable to lock buffers.");
+            }
+            AHardwareBuffer_unlockBatch(buffers, kBatchSize, nullptr);
+        }
+    }
+    ReleaseBatch(buffers);
+}
+BENCHMARK(BM_AHardwareBuffer_LockPlanesBatch);
+
 BENCHMARK_MAIN();
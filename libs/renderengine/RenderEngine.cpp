@@ -107,6 +107,82 @@ ftl::Future<FenceResult> RenderEngine::drawLayers(const DisplaySettings& display
     return resultFuture;
 }
 
+std::vector<ftl::Future<FenceResult>> RenderEngine::drawLayersToMirrors(
+        const DisplaySettings& display, const std::vector<LayerSettings>& layers,
+        const std::shared_ptr<ExternalTexture>& buffer, base::unique_fd&& bufferFence,
+        std::vector<MirrorOutput> mirrors) {
+    std::vector<std::shared_ptr<std::promise<FenceResult>>> resultPromises;
+    std::vector<ftl::Future<FenceResult>> resultFutures;
+    resultPromises.reserve(mirrors.size() + 1);
+    resultFutures.reserve(mirrors.size() + 1);
+    for (size_t i = 0; i < mirrors.size() + 1; i++) {
+        resultFutures.emplace_back(resultPromises.emplace_back(
+                std::make_shared<std::promise<FenceResult>>())->get_future());
+    }
+    drawLayersToMirrorsInternal(std::move(resultPromises), display, layers, buffer,
+                                std::move(bufferFence), std::move(mirrors));
+    return resultFutures;
+}
+
+void RenderEngine::drawLayersToMirrorsInternal(
+        std::vector<std::shared_ptr<std::promise<FenceResult>>>&& resultPromises,
+        const DisplaySettings& display, const std::vector<LayerSettings>& layers,
+        const std::shared_ptr<ExternalTexture>& buffer, base::unique_fd&& bufferFence,
+        std::vector<MirrorOutput>&& mirrors) {
+    // drawLayersInternal fulfills its promise before returning, so the fence of the output is
+    // known before the mirrors are drawn.
+    auto outputPromise = std::make_shared<std::promise<FenceResult>>();
+    std::future<FenceResult> outputFuture = outputPromise->get_future();
+    updateProtectedContext(layers, {buffer.get()});
+    drawLayersInternal(std::move(outputPromise), display, layers, buffer, std::move(bufferFence));
+    const FenceResult outputResult = outputFuture.get();
+    resultPromises[0]->set_value(outputResult);
+
+    const bool canSampleOutput = outputResult.ok() && buffer &&
+            (buffer->getUsage() & GRALLOC_USAGE_HW_TEXTURE) && display.physicalDisplay.isValid();
+
+    for (size_t i = 0; i < mirrors.size(); i++) {
+        MirrorOutput& mirror = mirrors[i];
+        auto& resultPromise = resultPromises[i + 1];
+        if (!canSampleOutput) {
+            updateProtectedContext(layers, {mirror.buffer.get()});
+            drawLayersInternal(std::move(resultPromise), mirror.display, layers, mirror.buffer,
+                               std::move(mirror.bufferFence));
+            continue;
+        }
+
+        // Draw in the physical space of the mirror, so that the output only has to be scaled.
+        DisplaySettings mirrorDisplay = mirror.display;
+        mirrorDisplay.clip = mirrorDisplay.physicalDisplay;
+        mirrorDisplay.orientation = ui::Transform::ROT_0;
+
+        // The texture transform crops the output buffer to its physicalDisplay.
+        const Rect& source = display.physicalDisplay;
+        const float bufferWidth = static_cast<float>(buffer->getWidth());
+        const float bufferHeight = static_cast<float>(buffer->getHeight());
+        const mat4 textureTransform =
+                mat4::translate(vec4(source.left / bufferWidth, source.top / bufferHeight, 0, 0)) *
+                mat4::scale(vec4(source.getWidth() / bufferWidth,
+                                 source.getHeight() / bufferHeight, 1, 1));
+        const bool isScaled = source.getWidth() != mirrorDisplay.physicalDisplay.getWidth() ||
+                source.getHeight() != mirrorDisplay.physicalDisplay.getHeight();
+
+        const std::vector<LayerSettings> mirrorLayers{LayerSettings{
+                .geometry = Geometry{.boundaries = mirrorDisplay.physicalDisplay.toFloatRect()},
+                .source = PixelSource{.buffer = Buffer{.buffer = buffer,
+                                                       .fence = *outputResult,
+                                                       .useTextureFiltering = isScaled,
+                                                       .textureTransform = textureTransform,
+                                                       .isOpaque = true}},
+                .alpha = 1.f,
+                .sourceDataspace = display.outputDataspace,
+        }};
+        updateProtectedContext(mirrorLayers, {mirror.buffer.get()});
+        drawLayersInternal(std::move(resultPromise), mirrorDisplay, mirrorLayers, mirror.buffer,
+                           std::move(mirror.bufferFence));
+    }
+}
+
 ftl::Future<FenceResult> RenderEngine::drawGainmap(
         const std::shared_ptr<ExternalTexture>& sdr, base::borrowed_fd&& sdrFence,
         const std::shared_ptr<ExternalTexture>& hdr, base::borrowed_fd&& hdrFence,
@@ -24,6 +24,7 @@
 #include <renderengine/RenderEngine.h>
 #include <renderengine/impl/ExternalTexture.h>
 
+#include <chrono>
 #include <mutex>
 
 using namespace android;
@@ -76,7 +77,8 @@ std::pair<uint32_t, uint32_t> getDisplaySize() {
 
 static std::unique_ptr<RenderEngine> createRenderEngine(
         RenderEngine::Threaded threaded, RenderEngine::GraphicsApi graphicsApi,
-        RenderEngine::BlurAlgorithm blurAlgorithm = RenderEngine::BlurAlgorithm::KAWASE) {
+        RenderEngine::BlurAlgorithm blurAlgorithm = RenderEngine::BlurAlgorithm::KAWASE,
+        RenderEngine::SkiaBackend skiaBackend = RenderEngine::SkiaBackend::GANESH) {
     auto args = RenderEngineCreationArgs::Builder()
                         .setPixelFormat(static_cast<int>(ui::PixelFormat::RGBA_8888))
                         .setImageCacheSize(1)
@@ -86,6 +88,7 @@ static std::unique_ptr<RenderEngine> createRenderEngine(
                         .setContextPriority(RenderEngine::ContextPriority::REALTIME)
                         .setThreaded(threaded)
                         .setGraphicsApi(graphicsApi)
+                        .setSkiaBackend(skiaBackend)
                         .build();
     return RenderEngine::create(args);
 }
@@ -142,6 +145,16 @@ static std::shared_ptr<ExternalTexture> copyBuffer(RenderEngine& re,
     return texture;
 }
 
+static DisplaySettings createDisplaySettings() {
+    auto [width, height] = getDisplaySize();
+    const Rect displayRect(0, 0, static_cast<int32_t>(width), static_cast<int32_t>(height));
+    return DisplaySettings{
+            .physicalDisplay = displayRect,
+            .clip = displayRect,
+            .maxLuminance = 500,
+    };
+}
+
 /**
  * Helper for timing calls to drawLayers.
  *
@@ -150,27 +163,38 @@ static std::shared_ptr<ExternalTexture> copyBuffer(RenderEngine& re,
  * drawLayers, and saving (if --save is used).
  *
  * This times both the CPU and GPU work initiated by drawLayers. All work done
- * outside of the for loop is excluded from the timing measurements.
+ * outside of the for loop is excluded from the timing measurements. The time
+ * spent recording and submitting the draw is also reported as "record_ms", and
+ * the time then spent waiting for the GPU to finish as "gpu_wait_ms".
  */
-static void benchDrawLayers(RenderEngine& re, const std::vector<LayerSettings>& layers,
+static void benchDrawLayers(RenderEngine& re, const DisplaySettings& display,
+                            const std::vector<LayerSettings>& layers,
                             benchmark::State& benchState, const char* saveFileName) {
     auto [width, height] = getDisplaySize();
     auto outputBuffer = allocateBuffer(re, width, height);
 
-    const Rect displayRect(0, 0, static_cast<int32_t>(width), static_cast<int32_t>(height));
-    DisplaySettings display{
-            .physicalDisplay = displayRect,
-            .clip = displayRect,
-            .maxLuminance = 500,
-    };
+    std::chrono::nanoseconds recordTime{0};
+    std::chrono::nanoseconds gpuWaitTime{0};
 
     // This loop starts and stops the timer.
     for (auto _ : benchState) {
+        const auto start = std::chrono::steady_clock::now();
         sp<Fence> waitFence =
                 re.drawLayers(display, layers, outputBuffer, base::unique_fd()).get().value();
+        const auto recorded = std::chrono::steady_clock::now();
         waitFence->waitForever(LOG_TAG);
+        recordTime += recorded - start;
+        gpuWaitTime += std::chrono::steady_clock::now() - recorded;
     }
 
+    using std::chrono::duration;
+    benchState.counters["record_ms"] =
+            benchmark::Counter(duration<double, std::milli>(recordTime).count(),
+                               benchmark::Counter::kAvgIterations);
+    benchState.counters["gpu_wait_ms"] =
+            benchmark::Counter(duration<double, std::milli>(gpuWaitTime).count(),
+                               benchmark::Counter::kAvgIterations);
+
     if (renderenginebench::save() && saveFileName) {
         // Copy to a CPU-accessible buffer so we can encode it.
         outputBuffer = copyBuffer(re, outputBuffer, GRALLOC_USAGE_SW_READ_OFTEN, "to_encode");
@@ -183,6 +207,11 @@ static void benchDrawLayers(RenderEngine& re, const std::vector<LayerSettings>&
     }
 }
 
+static void benchDrawLayers(RenderEngine& re, const std::vector<LayerSettings>& layers,
+                            benchmark::State& benchState, const char* saveFileName) {
+    benchDrawLayers(re, createDisplaySettings(), layers, benchState, saveFileName);
+}
+
 /**
  * Return a buffer with the image in the provided path, relative to the executable directory
  */
@@ -240,7 +269,8 @@ template <class... Args>
 void BM_homescreen_blur(benchmark::State& benchState, Args&&... args) {
     auto args_tuple = std::make_tuple(std::move(args)...);
     auto re = createRenderEngine(static_cast<RenderEngine::Threaded>(std::get<0>(args_tuple)),
-                                 static_cast<RenderEngine::GraphicsApi>(std::get<1>(args_tuple)));
+                                 static_cast<RenderEngine::GraphicsApi>(std::get<1>(args_tuple)),
+                                 static_cast<RenderEngine::BlurAlgorithm>(std::get<2>(args_tuple)));
 
     auto [width, height] = getDisplaySize();
     auto srcBuffer = createTexture(*re, kHomescreenPath);
@@ -323,3 +353,192 @@ BENCHMARK_CAPTURE(BM_homescreen, SkiaGLThreaded, RenderEngine::Threaded::YES,
 
 BENCHMARK_CAPTURE(BM_homescreen_edgeExtension, SkiaGLThreaded, RenderEngine::Threaded::YES,
                   RenderEngine::GraphicsApi::GL);
+
+///////////////////////////////////////////////////////////////////////////////
+//  Composition scenarios
+//
+//  These approximate frames SurfaceFlinger composes on device, and run on every
+//  backend RenderEngine supports.
+///////////////////////////////////////////////////////////////////////////////
+
+static LayerSettings createWindowLayer(std::shared_ptr<ExternalTexture> buffer,
+                                       const FloatRect& bounds, float cornerRadius) {
+    return LayerSettings{
+            .geometry =
+                    Geometry{
+                            .boundaries = bounds,
+                            .roundedCornersRadius = vec2(cornerRadius, cornerRadius),
+                            .roundedCornersCrop = bounds,
+                    },
+            .source =
+                    PixelSource{
+                            .buffer =
+                                    Buffer{
+                                            .buffer = std::move(buffer),
+                                            .usePremultipliedAlpha = true,
+                                    },
+                    },
+            .alpha = half(1.0f),
+            .sourceDataspace = ui::Dataspace::V0_SRGB,
+    };
+}
+
+/**
+ * The notification shade pulled down over the homescreen: a blurred scrim, and a stack of
+ * notifications with rounded corners and blurred backgrounds.
+ */
+static void BM_shade(benchmark::State& benchState, RenderEngine::Threaded threaded,
+                     RenderEngine::GraphicsApi graphicsApi,
+                     RenderEngine::SkiaBackend skiaBackend) {
+    auto re = createRenderEngine(threaded, graphicsApi, RenderEngine::BlurAlgorithm::KAWASE,
+                                 skiaBackend);
+
+    auto [width, height] = getDisplaySize();
+    auto srcBuffer = createTexture(*re, kHomescreenPath);
+
+    const FloatRect displayRect(0, 0, width, height);
+    std::vector<LayerSettings> layers{createWindowLayer(srcBuffer, displayRect, 0.f)};
+    layers.push_back(LayerSettings{
+            .geometry = Geometry{.boundaries = displayRect},
+            .source = PixelSource{.solidColor = half3(0.f, 0.f, 0.f)},
+            .alpha = half(0.4f),
+            .backgroundBlurRadius = 80,
+    });
+
+    const float margin = width * 0.05f;
+    const float notificationHeight = height * 0.12f;
+    for (int i = 0; i < 4; i++) {
+        const float top = height * 0.2f + i * (notificationHeight + margin / 2);
+        const FloatRect bounds(margin, top, width - margin, top + notificationHeight);
+        layers.push_back(LayerSettings{
+                .geometry =
+                        Geometry{
+                                .boundaries = bounds,
+                                .roundedCornersRadius = vec2(margin, margin),
+                                .roundedCornersCrop = bounds,
+                        },
+                .source = PixelSource{.solidColor = half3(1.f, 1.f, 1.f)},
+                .alpha = half(0.8f),
+                .backgroundBlurRadius = 40,
+        });
+    }
+    benchDrawLayers(*re, layers, benchState, "shade");
+}
+
+/**
+ * A full screen PQ video composited with SDR system bars on an SDR display, so that the video
+ * is tone mapped with either libtonemap (LinearEffect) or the local tone mapper (MouriMap).
+ */
+static void benchHdrVideo(benchmark::State& benchState, RenderEngine::Threaded threaded,
+                          RenderEngine::GraphicsApi graphicsApi,
+                          RenderEngine::SkiaBackend skiaBackend,
+                          DisplaySettings::TonemapStrategy tonemapStrategy,
+                          const char* saveFileName) {
+    auto re = createRenderEngine(threaded, graphicsApi, RenderEngine::BlurAlgorithm::KAWASE,
+                                 skiaBackend);
+
+    auto [width, height] = getDisplaySize();
+    auto srcBuffer = createTexture(*re, kHomescreenPath);
+
+    const FloatRect displayRect(0, 0, width, height);
+    LayerSettings video = createWindowLayer(srcBuffer, displayRect, 0.f);
+    video.sourceDataspace = ui::Dataspace::BT2020_ITU_PQ;
+    video.source.buffer.isOpaque = true;
+    video.source.buffer.maxLuminanceNits = 1000.f;
+    video.whitePointNits = 200.f;
+
+    LayerSettings statusBar = createWindowLayer(srcBuffer, FloatRect(0, 0, width, height * 0.04f),
+                                                0.f);
+    statusBar.alpha = half(0.5f);
+    statusBar.whitePointNits = 200.f;
+
+    DisplaySettings display = createDisplaySettings();
+    display.outputDataspace = ui::Dataspace::DISPLAY_P3;
+    display.targetLuminanceNits = 500.f;
+    display.tonemapStrategy = tonemapStrategy;
+    display.targetHdrSdrRatio = 2.5f;
+
+    benchDrawLayers(*re, display, {video, statusBar}, benchState, saveFileName);
+}
+
+static void BM_hdrVideo(benchmark::State& benchState, RenderEngine::Threaded threaded,
+                        RenderEngine::GraphicsApi graphicsApi,
+                        RenderEngine::SkiaBackend skiaBackend) {
+    benchHdrVideo(benchState, threaded, graphicsApi, skiaBackend,
+                  DisplaySettings::TonemapStrategy::Libtonemap, "hdr_video");
+}
+
+static void BM_hdrVideoLocalTonemap(benchmark::State& benchState, RenderEngine::Threaded threaded,
+                                    RenderEngine::GraphicsApi graphicsApi,
+                                    RenderEngine::SkiaBackend skiaBackend) {
+    benchHdrVideo(benchState, threaded, graphicsApi, skiaBackend,
+                  DisplaySettings::TonemapStrategy::Local, "hdr_video_local_tonemap");
+}
+
+/**
+ * Overlapping app windows with rounded corners and shadows, as in recents or a desktop session.
+ */
+static void BM_roundedCornerStack(benchmark::State& benchState, RenderEngine::Threaded threaded,
+                                  RenderEngine::GraphicsApi graphicsApi,
+                                  RenderEngine::SkiaBackend skiaBackend) {
+    auto re = createRenderEngine(threaded, graphicsApi, RenderEngine::BlurAlgorithm::KAWASE,
+                                 skiaBackend);
+
+    auto [width, height] = getDisplaySize();
+    auto srcBuffer = createTexture(*re, kHomescreenPath);
+
+    const FloatRect displayRect(0, 0, width, height);
+    std::vector<LayerSettings> layers{createWindowLayer(srcBuffer, displayRect, 0.f)};
+    const float cornerRadius = width * 0.04f;
+    for (int i = 0; i < 6; i++) {
+        const float offset = i * width * 0.05f;
+        const FloatRect bounds(offset, offset, width * 0.6f + offset, height * 0.6f + offset);
+        LayerSettings window = createWindowLayer(srcBuffer, bounds, cornerRadius);
+        window.shadow = ShadowSettings{
+                .boundaries = bounds,
+                .ambientColor = vec4(0.f, 0.f, 0.f, 0.04f),
+                .spotColor = vec4(0.f, 0.f, 0.f, 0.12f),
+                .lightPos = vec3(width / 2.f, 0.f, height),
+                .lightRadius = width * 0.5f,
+                .length = cornerRadius,
+        };
+        layers.push_back(std::move(window));
+    }
+    benchDrawLayers(*re, layers, benchState, "rounded_corner_stack");
+}
+
+BENCHMARK_CAPTURE(BM_shade, SkiaGLThreaded, RenderEngine::Threaded::YES,
+                  RenderEngine::GraphicsApi::GL, RenderEngine::SkiaBackend::GANESH);
+
+BENCHMARK_CAPTURE(BM_shade, SkiaGaneshVkThreaded, RenderEngine::Threaded::YES,
+                  RenderEngine::GraphicsApi::VK, RenderEngine::SkiaBackend::GANESH);
+
+BENCHMARK_CAPTURE(BM_shade, SkiaGraphiteVkThreaded, RenderEngine::Threaded::YES,
+                  RenderEngine::GraphicsApi::VK, RenderEngine::SkiaBackend::GRAPHITE);
+
+BENCHMARK_CAPTURE(BM_hdrVideo, SkiaGLThreaded, RenderEngine::Threaded::YES,
+                  RenderEngine::GraphicsApi::GL, RenderEngine::SkiaBackend::GANESH);
+
+BENCHMARK_CAPTURE(BM_hdrVideo, SkiaGaneshVkThreaded, RenderEngine::Threaded::YES,
+                  RenderEngine::GraphicsApi::VK, RenderEngine::SkiaBackend::GANESH);
+
+BENCHMARK_CAPTURE(BM_hdrVideo, SkiaGraphiteVkThreaded, RenderEngine::Threaded::YES,
+                  RenderEngine::GraphicsApi::VK, RenderEngine::SkiaBackend::GRAPHITE);
+
+BENCHMARK_CAPTURE(BM_hdrVideoLocalTonemap, SkiaGLThreaded, RenderEngine::Threaded::YES,
+                  RenderEngine::GraphicsApi::GL, RenderEngine::SkiaBackend::GANESH);
+
+BENCHMARK_CAPTURE(BM_hdrVideoLocalTonemap, SkiaGaneshVkThreaded, RenderEngine::Threaded::YES,
+                  RenderEngine::GraphicsApi::VK, RenderEngine::SkiaBackend::GANESH);
+
+BENCHMARK_CAPTURE(BM_hdrVideoLocalTonemap, SkiaGraphiteVkThreaded, RenderEngine::Threaded::YES,
+                  RenderEngine::GraphicsApi::VK, RenderEngine::SkiaBackend::GRAPHITE);
+
+BENCHMARK_CAPTURE(BM_roundedCornerStack, SkiaGLThreaded, RenderEngine::Threaded::YES,
+                  RenderEngine::GraphicsApi::GL, RenderEngine::SkiaBackend::GANESH);
+
+BENCHMARK_CAPTURE(BM_roundedCornerStack, SkiaGaneshVkThreaded, RenderEngine::Threaded::YES,
+                  RenderEngine::GraphicsApi::VK, RenderEngine::SkiaBackend::GANESH);
+
+BENCHMARK_CAPTURE(BM_roundedCornerStack, SkiaGraphiteVkThreaded, RenderEngine::Threaded::YES,
+                  RenderEngine::GraphicsApi::VK, RenderEngine::SkiaBackend::GRAPHITE);
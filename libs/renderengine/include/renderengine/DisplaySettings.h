@@ -50,6 +50,10 @@ struct DisplaySettings {
     // z=1.
     Rect clip = Rect::INVALID_RECT;
 
+    // If valid, only this rectangle of the output buffer, in the same space as physicalDisplay, is
+    // redrawn. The rest of the buffer must already contain the same content as this frame.
+    Rect damage = Rect::INVALID_RECT;
+
     // Maximum luminance pulled from the display's HDR capabilities.
     float maxLuminance = 1.0f;
 
@@ -109,7 +113,7 @@ struct DisplaySettings {
 
 static inline bool operator==(const DisplaySettings& lhs, const DisplaySettings& rhs) {
     return lhs.namePlusId == rhs.namePlusId && lhs.physicalDisplay == rhs.physicalDisplay &&
-            lhs.clip == rhs.clip && lhs.maxLuminance == rhs.maxLuminance &&
+            lhs.clip == rhs.clip && lhs.damage == rhs.damage && lhs.maxLuminance == rhs.maxLuminance &&
             lhs.currentLuminanceNits == rhs.currentLuminanceNits &&
             lhs.outputDataspace == rhs.outputDataspace &&
             lhs.colorTransform == rhs.colorTransform &&
@@ -148,6 +152,8 @@ static inline void PrintTo(const DisplaySettings& settings, ::std::ostream* os)
     PrintTo(settings.physicalDisplay, os);
     *os << "\n    .clip = ";
     PrintTo(settings.clip, os);
+    *os << "\n    .damage = ";
+    PrintTo(settings.damage, os);
     *os << "\n    .maxLuminance = " << settings.maxLuminance;
     *os << "\n    .currentLuminanceNits = " << settings.currentLuminanceNits;
     *os << "\n    .outputDataspace = ";
@@ -29,8 +29,10 @@
 #include <ui/GraphicTypes.h>
 #include <ui/Transform.h>
 
+#include <functional>
 #include <future>
 #include <memory>
+#include <string>
 
 /**
  * Allows to override the RenderEngine backend.
@@ -102,6 +104,12 @@ struct PrimeCacheConfig {
     bool cacheTransparentImageDimmedLayers = true;
     bool cacheClippedDimmedImageLayers = true;
     bool cacheUltraHDR = true;
+    // If set, the shaders compiled at runtime are recorded to this file, and the ones recorded on
+    // previous boots are compiled first when priming.
+    std::string runtimeShaderCachePath;
+    // If set, called on the RenderEngine thread between priming steps, so that work queued while
+    // priming doesn't have to wait for all of it.
+    std::function<void()> yield;
 };
 
 class RenderEngine {
@@ -209,6 +217,26 @@ public:
                                                 const std::shared_ptr<ExternalTexture>& buffer,
                                                 base::unique_fd&& bufferFence);
 
+    // An additional output which shows the same content as the output of drawLayersToMirrors.
+    struct MirrorOutput {
+        // The physicalDisplay of the mirrored output is scaled to fill this physicalDisplay. The
+        // clip and orientation are only used if the layers have to be drawn again for the mirror.
+        DisplaySettings display;
+        std::shared_ptr<ExternalTexture> buffer;
+        base::unique_fd bufferFence;
+    };
+
+    // Same as drawLayers, but also fills each of the mirrors with the output. The layers are
+    // drawn once, and the result is then scaled into each mirror, rather than drawing all of the
+    // layers again for mirrored displays and screen recordings. If the output can't be sampled,
+    // for instance because it lacks GRALLOC_USAGE_HW_TEXTURE, the layers are drawn to each mirror
+    // instead.
+    // @return A future for buffer, followed by one for each of the mirrors.
+    virtual std::vector<ftl::Future<FenceResult>> drawLayersToMirrors(
+            const DisplaySettings& display, const std::vector<LayerSettings>& layers,
+            const std::shared_ptr<ExternalTexture>& buffer, base::unique_fd&& bufferFence,
+            std::vector<MirrorOutput> mirrors);
+
     virtual ftl::Future<FenceResult> drawGainmap(const std::shared_ptr<ExternalTexture>& sdr,
                                                  base::borrowed_fd&& sdrFence,
                                                  const std::shared_ptr<ExternalTexture>& hdr,
@@ -286,6 +314,14 @@ protected:
     // avoid any thread synchronization that may be required by directly calling postRenderCleanup.
     virtual bool canSkipPostRenderCleanup() const = 0;
 
+    // Does the work of drawLayersToMirrors. resultPromises has one promise per output, in the
+    // order of the futures returned by drawLayersToMirrors.
+    void drawLayersToMirrorsInternal(
+            std::vector<std::shared_ptr<std::promise<FenceResult>>>&& resultPromises,
+            const DisplaySettings& display, const std::vector<LayerSettings>& layers,
+            const std::shared_ptr<ExternalTexture>& buffer, base::unique_fd&& bufferFence,
+            std::vector<MirrorOutput>&& mirrors);
+
     friend class impl::ExternalTexture;
     friend class threaded::RenderEngineThreaded;
     friend class RenderEngineTest_cleanupPostRender_cleansUpOnce_Test;
@@ -664,6 +664,26 @@ void Cache::primeShaderCache(SkiaRenderEngine* renderengine, PrimeCacheConfig co
         ALOGD("%d Shaders already compiled before Cache::primeShaderCache ran\n", previousCount);
     }
 
+    // The shaders recorded at runtime on previous boots are the ones this device actually needs,
+    // so compile them ahead of the representative layers below.
+    if (const int runtimeShaders = renderengine->precompileRuntimeShaders()) {
+        ALOGD("Precompiled %d shaders recorded at runtime on previous boots\n", runtimeShaders);
+    }
+
+    // Building a LinearEffect does not need the GPU, but generating and parsing its SkSL is slow
+    // enough to cause a hitch when HDR content first shows up.
+    if (const size_t linearEffects = renderengine->prewarmLinearEffects()) {
+        ALOGD("Built %zu LinearEffects for common dataspaces\n", linearEffects);
+    }
+
+    // Let work which is waiting on RenderEngine run between the steps below, rather than after
+    // all of them.
+    const auto yield = [&config] {
+        if (config.yield) {
+            config.yield();
+        }
+    };
+
     // The loop is beneficial for debugging and should otherwise be optimized out by the compiler.
     // Adding additional bounds to the loop is useful for verifying that the size of the dst buffer
     // does not impact the shader compilation counts by triggering different behaviors in RE/Skia.
@@ -725,24 +745,29 @@ void Cache::primeShaderCache(SkiaRenderEngine* renderengine, PrimeCacheConfig co
 
         if (config.cacheHolePunchLayer) {
             drawHolePunchLayer(renderengine, display, dstTexture);
+            yield();
         }
 
         if (config.cacheSolidLayers) {
             drawSolidLayers(renderengine, display, dstTexture);
             drawSolidLayers(renderengine, p3Display, dstTexture);
+            yield();
         }
 
         if (config.cacheSolidDimmedLayers) {
             drawSolidDimmedLayers(renderengine, display, dstTexture);
+            yield();
         }
 
         if (config.cacheShadowLayers) {
             drawShadowLayers(renderengine, display, srcTexture);
             drawShadowLayers(renderengine, p3Display, srcTexture);
+            yield();
         }
 
         if (renderengine->supportsBackgroundBlur()) {
             drawBlurLayers(renderengine, display, dstTexture);
+            yield();
         }
 
         // The majority of skia shaders needed by RenderEngine are related to sampling images.
@@ -795,10 +820,12 @@ void Cache::primeShaderCache(SkiaRenderEngine* renderengine, PrimeCacheConfig co
                 drawEdgeExtensionLayers(renderengine, display, dstTexture, texture);
                 drawEdgeExtensionLayers(renderengine, p3Display, dstTexture, texture);
             }
+            yield();
         }
 
         if (config.cachePIPImageLayers) {
             drawPIPImageLayer(renderengine, display, dstTexture, externalTexture);
+            yield();
         }
 
         if (config.cacheTransparentImageDimmedLayers) {
@@ -808,10 +835,12 @@ void Cache::primeShaderCache(SkiaRenderEngine* renderengine, PrimeCacheConfig co
             drawTransparentImageDimmedLayers(renderengine, p3Display, dstTexture, externalTexture);
             drawTransparentImageDimmedLayers(renderengine, p3DisplayEnhance, dstTexture,
                                              externalTexture);
+            yield();
         }
 
         if (config.cacheClippedDimmedImageLayers) {
             drawClippedDimmedImageLayers(renderengine, bt2020Display, dstTexture, externalTexture);
+            yield();
         }
 
         if (config.cacheUltraHDR) {
@@ -825,6 +854,7 @@ void Cache::primeShaderCache(SkiaRenderEngine* renderengine, PrimeCacheConfig co
             drawExtendedHDRImageLayers(renderengine, p3DisplayEnhance, dstTexture, externalTexture);
 
             drawP3ImageLayers(renderengine, p3DisplayEnhance, dstTexture, externalTexture);
+            yield();
         }
 
         // draw one final layer synchronously to force GL submit
@@ -0,0 +1,188 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#undef LOG_TAG
+#define LOG_TAG "RenderEngine"
+#define ATRACE_TAG ATRACE_TAG_GRAPHICS
+
+#include "RuntimeShaderCache.h"
+
+#include <android-base/file.h>
+#include <common/trace.h>
+#include <log/log.h>
+
+#include <cstdio>
+#include <cstring>
+
+#include "debug/CommonPool.h"
+
+namespace android::renderengine::skia {
+
+namespace {
+
+// "RSC" followed by the format version.
+constexpr uint32_t kMagic = 0x52534301;
+
+std::string toString(const SkData& data) {
+    return std::string(static_cast<const char*>(data.data()), data.size());
+}
+
+void appendUint32(std::string& bytes, uint32_t value) {
+    bytes.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+bool readUint32(const std::string& bytes, size_t& offset, uint32_t& outValue) {
+    if (bytes.size() - offset < sizeof(outValue)) {
+        return false;
+    }
+    memcpy(&outValue, bytes.data() + offset, sizeof(outValue));
+    offset += sizeof(outValue);
+    return true;
+}
+
+bool readData(const std::string& bytes, size_t& offset, sk_sp<SkData>& outData) {
+    uint32_t size;
+    if (!readUint32(bytes, offset, size) || bytes.size() - offset < size) {
+        return false;
+    }
+    outData = SkData::MakeWithCopy(bytes.data() + offset, size);
+    offset += size;
+    return true;
+}
+
+} // namespace
+
+RuntimeShaderCache::RuntimeShaderCache(std::string path) : mPath(std::move(path)) {}
+
+size_t RuntimeShaderCache::load() {
+    SFTRACE_CALL();
+    std::string bytes;
+    if (!base::ReadFileToString(mPath, &bytes)) {
+        return 0;
+    }
+
+    std::vector<std::pair<sk_sp<SkData>, sk_sp<SkData>>> shaders;
+    if (!deserialize(bytes, shaders)) {
+        ALOGW("Ignoring malformed runtime shader cache %s", mPath.c_str());
+        return 0;
+    }
+    for (auto& [key, data] : shaders) {
+        if (mShaders.size() >= kMaxShaders) {
+            break;
+        }
+        mShaders.try_emplace(toString(*key), Shader{std::move(key), std::move(data)});
+    }
+    return mShaders.size();
+}
+
+sk_sp<SkData> RuntimeShaderCache::find(const SkData& key) const {
+    auto it = mShaders.find(toString(key));
+    return it == mShaders.end() ? nullptr : it->second.data;
+}
+
+bool RuntimeShaderCache::record(const SkData& key, const SkData& data) {
+    if (mShaders.size() >= kMaxShaders) {
+        return false;
+    }
+    auto [_, inserted] =
+            mShaders.try_emplace(toString(key),
+                                 Shader{SkData::MakeWithCopy(key.data(), key.size()),
+                                        SkData::MakeWithCopy(data.data(), data.size())});
+    mDirty |= inserted;
+    return inserted;
+}
+
+void RuntimeShaderCache::forEach(
+        const std::function<void(const SkData& key, const SkData& data)>& f) const {
+    for (const auto& [_, shader] : mShaders) {
+        f(*shader.key, *shader.data);
+    }
+}
+
+void RuntimeShaderCache::persistAsync() {
+    if (!mDirty) {
+        return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    if (now - mLastPersistTime < kMinPersistInterval) {
+        return;
+    }
+    mDirty = false;
+    mLastPersistTime = now;
+
+    // SkData is immutable, so the background thread can share it.
+    std::vector<std::pair<sk_sp<SkData>, sk_sp<SkData>>> shaders;
+    shaders.reserve(mShaders.size());
+    for (const auto& [_, shader] : mShaders) {
+        shaders.emplace_back(shader.key, shader.data);
+    }
+
+    CommonPool::post([path = mPath, shaders = std::move(shaders), writeMutex = mWriteMutex] {
+        SFTRACE_NAME("RuntimeShaderCache::persist");
+        const std::lock_guard<std::mutex> lock(*writeMutex);
+        // Write to a temporary file first, so that a crash doesn't leave a truncated cache.
+        const std::string tmpPath = path + ".tmp";
+        if (!base::WriteStringToFile(serialize(shaders), tmpPath) ||
+            rename(tmpPath.c_str(), path.c_str()) != 0) {
+            ALOGW("Failed to write the runtime shader cache to %s", path.c_str());
+            return;
+        }
+        ALOGD("Recorded %zu runtime shaders to %s", shaders.size(), path.c_str());
+    });
+}
+
+std::string RuntimeShaderCache::serialize(
+        const std::vector<std::pair<sk_sp<SkData>, sk_sp<SkData>>>& shaders) {
+    size_t size = 2 * sizeof(uint32_t);
+    for (const auto& [key, data] : shaders) {
+        size += 2 * sizeof(uint32_t) + key->size() + data->size();
+    }
+
+    std::string bytes;
+    bytes.reserve(size);
+    appendUint32(bytes, kMagic);
+    appendUint32(bytes, static_cast<uint32_t>(shaders.size()));
+    for (const auto& [key, data] : shaders) {
+        appendUint32(bytes, static_cast<uint32_t>(key->size()));
+        bytes.append(static_cast<const char*>(key->data()), key->size());
+        appendUint32(bytes, static_cast<uint32_t>(data->size()));
+        bytes.append(static_cast<const char*>(data->data()), data->size());
+    }
+    return bytes;
+}
+
+bool RuntimeShaderCache::deserialize(
+        const std::string& bytes, std::vector<std::pair<sk_sp<SkData>, sk_sp<SkData>>>& outShaders) {
+    size_t offset = 0;
+    uint32_t magic;
+    uint32_t count;
+    if (!readUint32(bytes, offset, magic) || magic != kMagic || !readUint32(bytes, offset, count)) {
+        return false;
+    }
+    outShaders.reserve(std::min<size_t>(count, kMaxShaders));
+    for (uint32_t i = 0; i < count; i++) {
+        sk_sp<SkData> key;
+        sk_sp<SkData> data;
+        if (!readData(bytes, offset, key) || !readData(bytes, offset, data)) {
+            outShaders.clear();
+            return false;
+        }
+        outShaders.emplace_back(std::move(key), std::move(data));
+    }
+    return offset == bytes.size();
+}
+
+} // namespace android::renderengine::skia
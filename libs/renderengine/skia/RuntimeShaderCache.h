@@ -0,0 +1,80 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <include/core/SkData.h>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace android::renderengine::skia {
+
+/**
+ * The shaders Skia compiled outside of Cache::primeShaderCache, keyed by their Skia program key.
+ * They are recorded to a file, so that on the next boot they can be compiled while priming the
+ * shader cache rather than on first use.
+ */
+class RuntimeShaderCache {
+public:
+    static constexpr size_t kMaxShaders = 512;
+    static constexpr std::chrono::seconds kMinPersistInterval{10};
+
+    explicit RuntimeShaderCache(std::string path);
+
+    // Reads the shaders recorded on previous boots. Returns the number of shaders read.
+    size_t load();
+
+    // Returns nullptr if the shader isn't recorded.
+    sk_sp<SkData> find(const SkData& key) const;
+
+    // Returns false if the shader was already recorded, or if the cache is full.
+    bool record(const SkData& key, const SkData& data);
+
+    void forEach(const std::function<void(const SkData& key, const SkData& data)>& f) const;
+    size_t size() const { return mShaders.size(); }
+
+    // Writes the shaders to the file on a background thread, if any were recorded since the last
+    // write. Shaders tend to be compiled in bursts, so writes are at least kMinPersistInterval
+    // apart.
+    void persistAsync();
+
+    // Exposed for testing.
+    static std::string serialize(
+            const std::vector<std::pair<sk_sp<SkData>, sk_sp<SkData>>>& shaders);
+    static bool deserialize(const std::string& bytes,
+                            std::vector<std::pair<sk_sp<SkData>, sk_sp<SkData>>>& outShaders);
+
+private:
+    struct Shader {
+        sk_sp<SkData> key;
+        sk_sp<SkData> data;
+    };
+
+    const std::string mPath;
+    std::unordered_map<std::string, Shader> mShaders;
+    bool mDirty = false;
+    std::chrono::steady_clock::time_point mLastPersistTime;
+    // Serializes writes from the background thread, which may outlive this cache.
+    std::shared_ptr<std::mutex> mWriteMutex = std::make_shared<std::mutex>();
+};
+
+} // namespace android::renderengine::skia
@@ -49,6 +49,7 @@
 #include <SkString.h>
 #include <SkSurface.h>
 #include <SkTileMode.h>
+#include <android-base/properties.h>
 #include <android-base/stringprintf.h>
 #include <common/FlagManager.h>
 #include <common/trace.h>
@@ -68,12 +69,14 @@
 #include <cmath>
 #include <cstdint>
 #include <deque>
+#include <functional>
 #include <memory>
 #include <numeric>
 
 #include "Cache.h"
 #include "ColorSpaces.h"
 #include "compat/SkiaGpuContext.h"
+#include "filters/BlurCache.h"
 #include "filters/BlurFilter.h"
 #include "filters/GainmapFactory.h"
 #include "filters/GaussianBlurFilter.h"
@@ -253,19 +256,35 @@ void trace(sp<Fence> fence) {
         sMonitor.queueFence(std::move(fence));
     }
 }
+
+size_t textureBytes(const GraphicBuffer& buffer) {
+    return static_cast<size_t>(buffer.getStride()) * buffer.getHeight() *
+            std::max(bytesPerPixel(buffer.getPixelFormat()), 1u);
+}
 } // namespace
 
 using base::StringAppendF;
 
 std::future<void> SkiaRenderEngine::primeCache(PrimeCacheConfig config) {
+    if (!config.runtimeShaderCachePath.empty()) {
+        mSkSLCacheMonitor.loadRuntimeShaders(std::move(config.runtimeShaderCachePath));
+    }
     Cache::primeShaderCache(this, config);
+    mSkSLCacheMonitor.startRecordingRuntimeShaders();
     return {};
 }
 
 sk_sp<SkData> SkiaRenderEngine::SkSLCacheMonitor::load(const SkData& key) {
-    // This "cache" does not actually cache anything. It just allows us to
-    // monitor Skia's internal cache. So this method always returns null.
-    return nullptr;
+    // Apart from the shaders recorded at runtime, this "cache" does not actually cache anything.
+    // It just allows us to monitor Skia's internal cache.
+    if (!mRuntimeShaders) {
+        return nullptr;
+    }
+    sk_sp<SkData> data = mRuntimeShaders->find(key);
+    if (data) {
+        mRuntimeShaderCacheHits++;
+    }
+    return data;
 }
 
 void SkiaRenderEngine::SkSLCacheMonitor::store(const SkData& key, const SkData& data,
@@ -273,12 +292,43 @@ void SkiaRenderEngine::SkSLCacheMonitor::store(const SkData& key, const SkData&
     mShadersCachedSinceLastCall++;
     mTotalShadersCompiled++;
     SFTRACE_FORMAT("SF cache: %i shaders", mTotalShadersCompiled);
+
+    if (mRecordingRuntimeShaders) {
+        mShadersCompiledAfterPriming++;
+        SFTRACE_FORMAT("SF cache misses after priming: %i", mShadersCompiledAfterPriming);
+        if (mRuntimeShaders) {
+            mRuntimeShaders->record(key, data);
+        }
+    }
+}
+
+void SkiaRenderEngine::SkSLCacheMonitor::loadRuntimeShaders(std::string path) {
+    mRuntimeShaders = std::make_unique<RuntimeShaderCache>(std::move(path));
+    mRuntimeShaders->load();
 }
 
 int SkiaRenderEngine::reportShadersCompiled() {
     return mSkSLCacheMonitor.totalShadersCompiled();
 }
 
+int SkiaRenderEngine::precompileRuntimeShaders() {
+    RuntimeShaderCache* runtimeShaders = mSkSLCacheMonitor.runtimeShaders();
+    if (!runtimeShaders || !mContext) {
+        return 0;
+    }
+    SFTRACE_CALL();
+    int count = 0;
+    runtimeShaders->forEach([&](const SkData& key, const SkData& data) {
+        count += mContext->precompileShader(key, data) ? 1 : 0;
+    });
+    return count;
+}
+
+size_t SkiaRenderEngine::prewarmLinearEffects() {
+    std::lock_guard<std::mutex> lock(mRenderingMutex);
+    return mRuntimeEffects.prewarm();
+}
+
 void SkiaRenderEngine::setEnableTracing(bool tracingEnabled) {
     SkAndroidFrameworkTraceUtil::setEnableTracing(tracingEnabled);
 }
@@ -453,6 +503,8 @@ void SkiaRenderEngine::mapExternalTextureBuffer(const sp<GraphicBuffer>& buffer,
                 std::make_shared<AutoBackendTexture::LocalRef>(std::move(backendTexture),
                                                                mTextureCleanupMgr);
         cache.insert({buffer->getId(), imageTextureRef});
+        mTextureCacheInfo[buffer->getId()] = {.bytes = textureBytes(*buffer),
+                                              .lastUsed = mDrawCount};
     }
 }
 
@@ -483,6 +535,7 @@ void SkiaRenderEngine::unmapExternalTextureBuffer(sp<GraphicBuffer>&& buffer) {
 
         if (iter->second == 0) {
             mTextureCache.erase(buffer->getId());
+            mTextureCacheInfo.erase(buffer->getId());
             mGraphicBufferExternalRefs.erase(buffer->getId());
         }
 
@@ -499,13 +552,81 @@ std::shared_ptr<AutoBackendTexture::LocalRef> SkiaRenderEngine::getOrCreateBacke
     // Do not lookup the buffer in the cache for protected contexts
     if (!isProtected()) {
         if (const auto& it = mTextureCache.find(buffer->getId()); it != mTextureCache.end()) {
+            mTextureCacheInfo[buffer->getId()].lastUsed = mDrawCount;
             return it->second;
         }
     }
     std::unique_ptr<SkiaBackendTexture> backendTexture =
             getActiveContext()->makeBackendTexture(buffer->toAHardwareBuffer(), isOutputBuffer);
-    return std::make_shared<AutoBackendTexture::LocalRef>(std::move(backendTexture),
-                                                          mTextureCleanupMgr);
+    auto imageTextureRef =
+            std::make_shared<AutoBackendTexture::LocalRef>(std::move(backendTexture),
+                                                           mTextureCleanupMgr);
+
+    // A mapped buffer is only missing from the cache if enforceGpuMemoryBudget evicted it while it
+    // was idle. It is being drawn again, so cache it again.
+    if (!isProtected()) {
+        if (const auto it = mGraphicBufferExternalRefs.find(buffer->getId());
+            it != mGraphicBufferExternalRefs.end() && it->second > 0) {
+            mTextureCache.insert({buffer->getId(), imageTextureRef});
+            mTextureCacheInfo[buffer->getId()] = {.bytes = textureBytes(*buffer),
+                                                  .lastUsed = mDrawCount};
+        }
+    }
+    return imageTextureRef;
+}
+
+SkiaRenderEngine::GpuMemoryUsage SkiaRenderEngine::getGpuMemoryUsage() {
+    GpuMemoryUsage usage{
+            .skiaResources = getActiveContext()->getResourceCacheUsage(),
+            .blurs = mBlurCache.memoryUsage(),
+    };
+    for (const auto& [id, info] : mTextureCacheInfo) {
+        usage.textures += info.bytes;
+    }
+    return usage;
+}
+
+void SkiaRenderEngine::enforceGpuMemoryBudget() {
+    if (mGpuMemoryBudget == 0 || getGpuMemoryUsage().total() <= mGpuMemoryBudget) {
+        return;
+    }
+    SFTRACE_CALL();
+    mGpuMemoryBudgetTrims++;
+
+    // Ordered from the cheapest to the most expensive to rebuild.
+    const std::function<void()> tiers[] = {
+            [&] { getActiveContext()->purgeUnlockedScratchResources(); },
+            [&] { mBlurCache.clear(); },
+            // Also drops compiled programs, which are reloaded from the persistent cache.
+            [&] { getActiveContext()->purgeUnlockedResources(); },
+            [&] { evictIdleTextures(); },
+    };
+    for (const auto& trim : tiers) {
+        trim();
+        if (getGpuMemoryUsage().total() <= mGpuMemoryBudget) {
+            return;
+        }
+    }
+    ALOGW("RenderEngine GPU memory is over budget after trimming: %zu > %zu bytes",
+          getGpuMemoryUsage().total(), mGpuMemoryBudget);
+}
+
+void SkiaRenderEngine::evictIdleTextures() {
+    // Cached textures are unprotected, so they must be freed from the unprotected context.
+    if (mInProtectedContext) {
+        return;
+    }
+    // Buffers cycle through a BufferQueue or a BLAST adapter, so a buffer that is still displayed
+    // is drawn at least every few frames.
+    constexpr uint64_t kIdleDraws = 60;
+    for (auto it = mTextureCacheInfo.begin(); it != mTextureCacheInfo.end();) {
+        if (it->second.lastUsed + kIdleDraws < mDrawCount) {
+            mTextureCache.erase(it->first);
+            it = mTextureCacheInfo.erase(it);
+        } else {
+            it++;
+        }
+    }
 }
 
 bool SkiaRenderEngine::canSkipPostRenderCleanup() const {
@@ -517,6 +638,9 @@ void SkiaRenderEngine::cleanupPostRender() {
     SFTRACE_CALL();
     std::lock_guard<std::mutex> lock(mRenderingMutex);
     mTextureCleanupMgr.cleanup();
+    if (RuntimeShaderCache* runtimeShaders = mSkSLCacheMonitor.runtimeShaders()) {
+        runtimeShaders->persistAsync();
+    }
 }
 
 sk_sp<SkShader> SkiaRenderEngine::createRuntimeEffectShader(
@@ -575,14 +699,7 @@ sk_sp<SkShader> SkiaRenderEngine::createRuntimeEffectShader(
                                       .undoPremultipliedAlpha = parameters.undoPremultipliedAlpha,
                                       .fakeOutputDataspace = parameters.fakeOutputDataspace};
 
-        auto effectIter = mRuntimeEffects.find(effect);
-        sk_sp<SkRuntimeEffect> runtimeEffect = nullptr;
-        if (effectIter == mRuntimeEffects.end()) {
-            runtimeEffect = buildRuntimeEffect(effect);
-            mRuntimeEffects.insert({effect, runtimeEffect});
-        } else {
-            runtimeEffect = effectIter->second;
-        }
+        sk_sp<SkRuntimeEffect> runtimeEffect = mRuntimeEffects.getOrBuild(effect);
 
         mat4 colorTransform = parameters.layer.colorTransform;
 
@@ -718,6 +835,14 @@ void SkiaRenderEngine::drawLayersInternal(
 
     std::lock_guard<std::mutex> lock(mRenderingMutex);
 
+    mDrawCount++;
+
+    // Cached blurs belong to the context they were generated in.
+    if (mBlurCacheIsProtected != mInProtectedContext) {
+        mBlurCache.clear();
+        mBlurCacheIsProtected = mInProtectedContext;
+    }
+
     if (buffer == nullptr) {
         ALOGE("No output buffer provided. Aborting GPU composition.");
         resultPromise->set_value(base::unexpected(BAD_VALUE));
@@ -798,7 +923,12 @@ void SkiaRenderEngine::drawLayersInternal(
     }
 
     AutoSaveRestore surfaceAutoSaveRestore(canvas);
-    // Clear the entire canvas with a transparent black to prevent ghost images.
+    // Limit drawing to the damaged part of the buffer, unless drawing into an offscreen surface
+    // which does not have the rest of the frame yet.
+    if (display.damage.isValid() && canvas == dstCanvas) {
+        canvas->clipRect(getSkRect(display.damage));
+    }
+    // Clear the canvas with a transparent black to prevent ghost images.
     canvas->clear(SK_ColorTRANSPARENT);
     initCanvas(canvas, display);
 
@@ -869,6 +999,20 @@ void SkiaRenderEngine::drawLayersInternal(
                                  layer.geometry.roundedCornersRadius);
         if (mBlurFilter && layerHasBlur(layer, ctModifiesAlpha)) {
             std::unordered_map<uint32_t, sk_sp<SkImage>> cachedBlurs;
+            const std::optional<size_t> blurContentKey =
+                    BlurCache::computeContentKey(display, layers, &layer - layers.data());
+            const auto generateBlur = [&](uint32_t radius, const SkRect& blurRect) {
+                if (blurContentKey) {
+                    if (auto blurredImage = mBlurCache.get(*blurContentKey, radius, blurRect)) {
+                        return blurredImage;
+                    }
+                }
+                auto blurredImage = mBlurFilter->generate(context, radius, blurInput, blurRect);
+                if (blurContentKey) {
+                    mBlurCache.put(*blurContentKey, radius, blurRect, blurredImage);
+                }
+                return blurredImage;
+            };
 
             // if multiple layers have blur, then we need to take a snapshot now because
             // only the lowest layer will have blurImage populated earlier
@@ -901,8 +1045,7 @@ void SkiaRenderEngine::drawLayersInternal(
             if (blurRect.width() > 0 && blurRect.height() > 0) {
                 if (layer.backgroundBlurRadius > 0) {
                     SFTRACE_NAME("BackgroundBlur");
-                    auto blurredImage = mBlurFilter->generate(context, layer.backgroundBlurRadius,
-                                                              blurInput, blurRect);
+                    auto blurredImage = generateBlur(layer.backgroundBlurRadius, blurRect);
 
                     cachedBlurs[layer.backgroundBlurRadius] = blurredImage;
 
@@ -914,9 +1057,7 @@ void SkiaRenderEngine::drawLayersInternal(
                 for (auto region : layer.blurRegions) {
                     if (cachedBlurs[region.blurRadius] == nullptr) {
                         SFTRACE_NAME("BlurRegion");
-                        cachedBlurs[region.blurRadius] =
-                                mBlurFilter->generate(context, region.blurRadius, blurInput,
-                                                      blurRect);
+                        cachedBlurs[region.blurRadius] = generateBlur(region.blurRadius, blurRect);
                     }
 
                     mBlurFilter->drawBlurRegion(canvas, getBlurRRect(region), region.blurRadius,
@@ -1202,6 +1343,8 @@ void SkiaRenderEngine::drawLayersInternal(
     auto drawFence = sp<Fence>::make(flushAndSubmit(context, dstSurface));
     trace(drawFence);
     resultPromise->set_value(std::move(drawFence));
+
+    enforceGpuMemoryBudget();
 }
 
 void SkiaRenderEngine::drawGainmapInternal(
@@ -1275,6 +1418,16 @@ void SkiaRenderEngine::onActiveDisplaySizeChanged(ui::Size size) {
     const float SURFACE_SIZE_MULTIPLIER = 3.5f * bytesPerPixel(mDefaultPixelFormat);
     const int maxResourceBytes = size.width * size.height * SURFACE_SIZE_MULTIPLIER;
 
+    // RenderEngine's own budget also covers the blurs and the client buffers it caches. Low RAM
+    // devices get half, at the cost of importing buffers again after they were idle.
+    {
+        static const bool kIsLowRam = base::GetBoolProperty("ro.config.low_ram", false);
+        const size_t screenBytes =
+                static_cast<size_t>(size.width * size.height) * bytesPerPixel(mDefaultPixelFormat);
+        std::lock_guard<std::mutex> lock(mRenderingMutex);
+        mGpuMemoryBudget = screenBytes * (kIsLowRam ? 16 : 32);
+    }
+
     // start by resizing the current context
     getActiveContext()->setResourceCacheLimit(maxResourceBytes);
 
@@ -1298,6 +1451,16 @@ void SkiaRenderEngine::dump(std::string& result) {
     StringAppendF(&result, "RenderEngine is in protected context: %d\n", mInProtectedContext);
     StringAppendF(&result, "RenderEngine shaders cached since last dump/primeCache: %d\n",
                   mSkSLCacheMonitor.shadersCachedSinceLastCall());
+    StringAppendF(&result, "RenderEngine shaders compiled after primeCache: %d\n",
+                  mSkSLCacheMonitor.shadersCompiledAfterPriming());
+    if (RuntimeShaderCache* runtimeShaders = mSkSLCacheMonitor.runtimeShaders()) {
+        StringAppendF(&result, "RenderEngine runtime shaders recorded: %zu (loaded by Skia: %d)\n",
+                      runtimeShaders->size(), mSkSLCacheMonitor.runtimeShaderCacheHits());
+    }
+    if (mBlurFilter) {
+        std::lock_guard<std::mutex> lock(mRenderingMutex);
+        mBlurCache.dump(result);
+    }
 
     std::vector<ResourcePair> cpuResourceMap = {
             {"skia/sk_resource_cache/bitmap_", "Bitmaps"},
@@ -1335,6 +1498,12 @@ void SkiaRenderEngine::dump(std::string& result) {
         for (const auto& [id, refCounts] : mGraphicBufferExternalRefs) {
             StringAppendF(&result, "- 0x%" PRIx64 " - %d refs \n", id, refCounts);
         }
+        const GpuMemoryUsage usage = getGpuMemoryUsage();
+        StringAppendF(&result,
+                      "RenderEngine GPU memory: %zu KiB of %zu KiB budget (Skia resources: %zu KiB, "
+                      "blurs: %zu KiB, textures: %zu KiB), trimmed %d times\n",
+                      usage.total() / 1024, mGpuMemoryBudget / 1024, usage.skiaResources / 1024,
+                      usage.blurs / 1024, usage.textures / 1024, mGpuMemoryBudgetTrims);
         StringAppendF(&result, "RenderEngine AHB/BackendTexture cache size: %zu\n",
                       mTextureCache.size());
         StringAppendF(&result, "Dumping buffer ids...\n");
@@ -1357,7 +1526,7 @@ void SkiaRenderEngine::dump(std::string& result) {
 
         StringAppendF(&result, "\n");
         StringAppendF(&result, "RenderEngine runtime effects: %zu\n", mRuntimeEffects.size());
-        for (const auto& [linearEffect, unused] : mRuntimeEffects) {
+        mRuntimeEffects.forEach([&](const shaders::LinearEffect& linearEffect) {
             StringAppendF(&result, "- inputDataspace: %s\n",
                           dataspaceDetails(
                                   static_cast<android_dataspace>(linearEffect.inputDataspace))
@@ -1368,7 +1537,7 @@ void SkiaRenderEngine::dump(std::string& result) {
                                   .c_str());
             StringAppendF(&result, "undoPremultipliedAlpha: %s\n",
                           linearEffect.undoPremultipliedAlpha ? "true" : "false");
-        }
+        });
     }
     StringAppendF(&result, "\n");
 }
@@ -33,9 +33,11 @@
 #include <unordered_map>
 
 #include "AutoBackendTexture.h"
+#include "RuntimeShaderCache.h"
 #include "android-base/macros.h"
 #include "compat/SkiaGpuContext.h"
 #include "debug/SkiaCapture.h"
+#include "filters/BlurCache.h"
 #include "filters/BlurFilter.h"
 #include "filters/EdgeExtensionShaderFactory.h"
 #include "filters/LinearEffect.h"
@@ -69,6 +71,10 @@ public:
     }
     void onActiveDisplaySizeChanged(ui::Size size) override final;
     int reportShadersCompiled();
+    // Compiles the shaders recorded at runtime on previous boots. Returns how many were compiled.
+    int precompileRuntimeShaders();
+    // Builds the LinearEffects for common dataspace combinations. Returns how many were built.
+    size_t prewarmLinearEffects();
 
     virtual void setEnableTracing(bool tracingEnabled) override final;
 
@@ -101,7 +107,8 @@ protected:
     bool isProtected() const { return mInProtectedContext; }
 
     // Implements PersistentCache as a way to monitor what SkSL shaders Skia has
-    // cached.
+    // cached. Once priming is done, it also records the shaders compiled at runtime in a
+    // RuntimeShaderCache, if one was loaded, and serves them back to Skia.
     class SkSLCacheMonitor : public GrContextOptions::PersistentCache {
     public:
         SkSLCacheMonitor() = default;
@@ -119,9 +126,23 @@ protected:
 
         int totalShadersCompiled() const { return mTotalShadersCompiled; }
 
+        // Loads the shaders recorded at runtime on previous boots from the given file.
+        void loadRuntimeShaders(std::string path);
+        // Any shader compiled after this call was missed by Cache::primeShaderCache.
+        void startRecordingRuntimeShaders() { mRecordingRuntimeShaders = true; }
+        RuntimeShaderCache* runtimeShaders() { return mRuntimeShaders.get(); }
+
+        int shadersCompiledAfterPriming() const { return mShadersCompiledAfterPriming; }
+        int runtimeShaderCacheHits() const { return mRuntimeShaderCacheHits; }
+
     private:
         int mShadersCachedSinceLastCall = 0;
         int mTotalShadersCompiled = 0;
+
+        std::unique_ptr<RuntimeShaderCache> mRuntimeShaders;
+        bool mRecordingRuntimeShaders = false;
+        int mShadersCompiledAfterPriming = 0;
+        int mRuntimeShaderCacheHits = 0;
     };
 
     SkSLCacheMonitor mSkSLCacheMonitor;
@@ -178,8 +199,30 @@ private:
             GUARDED_BY(mRenderingMutex);
     std::unordered_map<GraphicBufferId, std::shared_ptr<AutoBackendTexture::LocalRef>> mTextureCache
             GUARDED_BY(mRenderingMutex);
-    std::unordered_map<shaders::LinearEffect, sk_sp<SkRuntimeEffect>, shaders::LinearEffectHasher>
-            mRuntimeEffects;
+    struct CachedTextureInfo {
+        size_t bytes;
+        // Value of mDrawCount when the texture was last drawn or mapped.
+        uint64_t lastUsed;
+    };
+    std::unordered_map<GraphicBufferId, CachedTextureInfo> mTextureCacheInfo
+            GUARDED_BY(mRenderingMutex);
+    uint64_t mDrawCount GUARDED_BY(mRenderingMutex) = 0;
+
+    // Estimate of the GPU memory RenderEngine holds on to between frames, per category.
+    struct GpuMemoryUsage {
+        size_t skiaResources = 0;
+        size_t blurs = 0;
+        size_t textures = 0;
+        size_t total() const { return skiaResources + blurs + textures; }
+    };
+    GpuMemoryUsage getGpuMemoryUsage() REQUIRES(mRenderingMutex);
+    // Trims caches, cheapest to rebuild first, until the usage fits in mGpuMemoryBudget.
+    void enforceGpuMemoryBudget() REQUIRES(mRenderingMutex);
+    void evictIdleTextures() REQUIRES(mRenderingMutex);
+    // Zero until the display size is known.
+    size_t mGpuMemoryBudget GUARDED_BY(mRenderingMutex) = 0;
+    int mGpuMemoryBudgetTrims GUARDED_BY(mRenderingMutex) = 0;
+    LinearEffectCache mRuntimeEffects;
     AutoBackendTexture::CleanupManager mTextureCleanupMgr GUARDED_BY(mRenderingMutex);
 
     StretchShaderFactory mStretchShaderFactory;
@@ -187,6 +230,9 @@ private:
 
     sp<Fence> mLastDrawFence;
     BlurFilter* mBlurFilter = nullptr;
+    // Blurs generated by mBlurFilter on previous frames. They belong to the active context.
+    BlurCache mBlurCache GUARDED_BY(mRenderingMutex);
+    bool mBlurCacheIsProtected GUARDED_BY(mRenderingMutex) = false;
 
     // Object to capture commands send to Skia.
     std::unique_ptr<SkiaCapture> mCapture;
@@ -109,6 +109,16 @@ void GaneshGpuContext::purgeUnlockedScratchResources() {
     mGrContext->purgeUnlockedResources(GrPurgeResourceOptions::kScratchResourcesOnly);
 }
 
+void GaneshGpuContext::purgeUnlockedResources() {
+    mGrContext->purgeUnlockedResources(GrPurgeResourceOptions::kAllResources);
+}
+
+size_t GaneshGpuContext::getResourceCacheUsage() const {
+    size_t resourceBytes = 0;
+    mGrContext->getResourceCacheUsage(nullptr, &resourceBytes);
+    return resourceBytes;
+}
+
 void GaneshGpuContext::resetContextIfApplicable() {
     mGrContext->resetContext(); // Only applicable to GL
 };
@@ -117,4 +127,8 @@ void GaneshGpuContext::dumpMemoryStatistics(SkTraceMemoryDump* traceMemoryDump)
     mGrContext->dumpMemoryStatistics(traceMemoryDump);
 }
 
+bool GaneshGpuContext::precompileShader(const SkData& key, const SkData& data) {
+    return mGrContext->precompileShader(key, data);
+}
+
 } // namespace android::renderengine::skia
@@ -40,10 +40,14 @@ public:
     void setResourceCacheLimit(size_t maxResourceBytes) override;
 
     void purgeUnlockedScratchResources() override;
+    void purgeUnlockedResources() override;
+    size_t getResourceCacheUsage() const override;
     void resetContextIfApplicable() override;
 
     void dumpMemoryStatistics(SkTraceMemoryDump* traceMemoryDump) const override;
 
+    bool precompileShader(const SkData& key, const SkData& data) override;
+
 private:
     DISALLOW_COPY_AND_ASSIGN(GaneshGpuContext);
 
@@ -110,6 +110,14 @@ bool GraphiteGpuContext::isAbandonedOrDeviceLost() {
     return mContext->isDeviceLost();
 }
 
+void GraphiteGpuContext::purgeUnlockedResources() {
+    mContext->freeGpuResources();
+}
+
+size_t GraphiteGpuContext::getResourceCacheUsage() const {
+    return mContext->currentBudgetedBytes();
+}
+
 void GraphiteGpuContext::dumpMemoryStatistics(SkTraceMemoryDump* traceMemoryDump) const {
     mContext->dumpMemoryStatistics(traceMemoryDump);
 }
@@ -49,6 +49,8 @@ public:
     // contexts.
     // No-op (unnecessary during context switch for Graphite's client-budgeted memory model).
     void purgeUnlockedScratchResources() override{};
+    void purgeUnlockedResources() override;
+    size_t getResourceCacheUsage() const override;
     // No-op (only applicable to GL).
     void resetContextIfApplicable() override{};
 
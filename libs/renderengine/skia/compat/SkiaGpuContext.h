@@ -105,9 +105,20 @@ public:
     virtual void setResourceCacheLimit(size_t maxResourceBytes) = 0;
 
     virtual void purgeUnlockedScratchResources() = 0;
+    // Frees every resource Skia caches that isn't in use, including compiled programs and
+    // uploaded paths and glyphs, not only scratch textures.
+    virtual void purgeUnlockedResources() = 0;
+    // Bytes of GPU memory counted against Skia's resource cache budget.
+    virtual size_t getResourceCacheUsage() const = 0;
     virtual void resetContextIfApplicable() = 0; // No-op outside of GL (&& Ganesh at this point.)
 
     virtual void dumpMemoryStatistics(SkTraceMemoryDump* traceMemoryDump) const = 0;
+
+    /**
+     * Compiles a shader which Skia previously stored in the persistent cache. Returns false if it
+     * couldn't be compiled, or if the backend doesn't support it.
+     */
+    virtual bool precompileShader(const SkData& /*key*/, const SkData& /*data*/) { return false; }
 };
 
 } // namespace android::renderengine::skia
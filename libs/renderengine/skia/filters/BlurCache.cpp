@@ -0,0 +1,190 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "BlurCache.h"
+
+#include <android-base/stringprintf.h>
+#include <math/HashCombine.h>
+
+#include <algorithm>
+#include <cinttypes>
+
+namespace android {
+namespace renderengine {
+namespace skia {
+
+namespace {
+
+void hashFloats(size_t& hash, const float* values, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        hashCombineSingle(hash, values[i]);
+    }
+}
+
+template <typename Vec>
+void hashVec(size_t& hash, const Vec& v) {
+    for (size_t i = 0; i < v.size(); i++) {
+        hashCombineSingle(hash, static_cast<float>(v[i]));
+    }
+}
+
+void hashMat(size_t& hash, const mat4& m) {
+    hashFloats(hash, m.asArray(), sizeof(mat4) / sizeof(float));
+}
+
+// Returns false if the layer draws something that is not described by its settings.
+bool hashLayer(size_t& hash, const LayerSettings& layer) {
+    const Buffer& buffer = layer.source.buffer;
+    if (buffer.buffer) {
+        if (!buffer.fence || !buffer.fence->isValid()) {
+            return false;
+        }
+        hashCombineSingle(hash, buffer.buffer->getId());
+        // A new frame in the same buffer comes with a new fence.
+        hashCombineSingle(hash, buffer.fence.get());
+        hashCombineSingle(hash, buffer.useTextureFiltering);
+        hashMat(hash, buffer.textureTransform);
+        hashCombineSingle(hash, buffer.usePremultipliedAlpha);
+        hashCombineSingle(hash, buffer.isOpaque);
+        hashCombineSingle(hash, buffer.maxLuminanceNits);
+    } else {
+        hashVec(hash, layer.source.solidColor);
+    }
+    if (layer.stretchEffect.hasEffect() || layer.edgeExtensionEffect.hasEffect()) {
+        return false;
+    }
+
+    const Geometry& geometry = layer.geometry;
+    hashCombineSingle(hash, geometry.boundaries);
+    hashMat(hash, geometry.positionTransform);
+    hashVec(hash, geometry.roundedCornersRadius);
+    hashCombineSingle(hash, geometry.roundedCornersCrop);
+
+    hashCombineSingle(hash, static_cast<float>(layer.alpha));
+    hashCombineSingle(hash, static_cast<int32_t>(layer.sourceDataspace));
+    hashMat(hash, layer.colorTransform);
+    hashCombineSingle(hash, layer.disableBlending);
+    hashCombineSingle(hash, layer.skipContentDraw);
+    hashCombineSingle(hash, layer.whitePointNits);
+
+    const ShadowSettings& shadow = layer.shadow;
+    hashCombineSingle(hash, shadow.length);
+    if (shadow.length > 0) {
+        hashCombineSingle(hash, shadow.boundaries);
+        hashVec(hash, shadow.ambientColor);
+        hashVec(hash, shadow.spotColor);
+        hashVec(hash, shadow.lightPos);
+        hashCombineSingle(hash, shadow.lightRadius);
+        hashCombineSingle(hash, shadow.casterIsTranslucent);
+    }
+
+    hashCombineSingle(hash, layer.backgroundBlurRadius);
+    for (const auto& region : layer.blurRegions) {
+        hashCombineSingle(hash, region);
+    }
+    if (!layer.blurRegions.empty()) {
+        hashMat(hash, layer.blurRegionTransform);
+    }
+    return true;
+}
+
+} // namespace
+
+std::optional<size_t> BlurCache::computeContentKey(const DisplaySettings& display,
+                                                   const std::vector<LayerSettings>& layers,
+                                                   size_t layerIndex) {
+    size_t hash = 0;
+    hashCombineSingle(hash, display.physicalDisplay);
+    hashCombineSingle(hash, display.clip);
+    hashCombineSingle(hash, display.orientation);
+    hashCombineSingle(hash, static_cast<int32_t>(display.outputDataspace));
+    hashMat(hash, display.colorTransform);
+    hashCombineSingle(hash, display.deviceHandlesColorTransform);
+    hashCombineSingle(hash, display.maxLuminance);
+    hashCombineSingle(hash, display.currentLuminanceNits);
+    hashCombineSingle(hash, display.targetLuminanceNits);
+    hashCombineSingle(hash, display.targetHdrSdrRatio);
+
+    // The dimming ratio depends on every layer, not only those under the blur.
+    for (const auto& layer : layers) {
+        hashCombineSingle(hash, layer.whitePointNits);
+    }
+
+    for (size_t i = 0; i < layerIndex && i < layers.size(); i++) {
+        if (!hashLayer(hash, layers[i])) {
+            return std::nullopt;
+        }
+    }
+    return hash;
+}
+
+sk_sp<SkImage> BlurCache::get(size_t contentKey, uint32_t radius, const SkRect& blurRect) {
+    const auto it = std::find_if(mEntries.begin(), mEntries.end(), [&](const Entry& entry) {
+        return entry.contentKey == contentKey && entry.radius == radius &&
+                entry.blurRect == blurRect;
+    });
+    if (it == mEntries.end()) {
+        mMisses++;
+        return nullptr;
+    }
+    mHits++;
+    mPixelsReused += static_cast<uint64_t>(blurRect.width() * blurRect.height());
+    it->lastUsed = ++mUseCounter;
+    return it->image;
+}
+
+void BlurCache::put(size_t contentKey, uint32_t radius, const SkRect& blurRect,
+                    sk_sp<SkImage> image) {
+    if (!image) {
+        return;
+    }
+    if (mEntries.size() >= kMaxEntries) {
+        const auto lru =
+                std::min_element(mEntries.begin(), mEntries.end(),
+                                 [](const Entry& lhs, const Entry& rhs) {
+                                     return lhs.lastUsed < rhs.lastUsed;
+                                 });
+        mEntries.erase(lru);
+    }
+    mEntries.push_back({.contentKey = contentKey,
+                        .radius = radius,
+                        .blurRect = blurRect,
+                        .image = std::move(image),
+                        .lastUsed = ++mUseCounter});
+}
+
+void BlurCache::clear() {
+    mEntries.clear();
+}
+
+size_t BlurCache::memoryUsage() const {
+    size_t bytes = 0;
+    for (const auto& entry : mEntries) {
+        bytes += entry.image->imageInfo().computeMinByteSize();
+    }
+    return bytes;
+}
+
+void BlurCache::dump(std::string& result) const {
+    base::StringAppendF(&result,
+                        "RenderEngine blur cache: %zu entries, %d hits, %d misses, %" PRIu64
+                        " blurred pixels reused\n",
+                        mEntries.size(), mHits, mMisses, mPixelsReused);
+}
+
+} // namespace skia
+} // namespace renderengine
+} // namespace android
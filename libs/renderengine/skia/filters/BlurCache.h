@@ -0,0 +1,82 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <SkImage.h>
+#include <SkRect.h>
+#include <renderengine/DisplaySettings.h>
+#include <renderengine/LayerSettings.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace android {
+namespace renderengine {
+namespace skia {
+
+/**
+ * Keeps the output of BlurFilter::generate across frames, so that a blur behind a layer is only
+ * recomputed when the content drawn under it changes. This is common for a dialog or shade
+ * whose background stays still.
+ */
+class BlurCache {
+public:
+    static constexpr size_t kMaxEntries = 4;
+
+    // Returns a key identifying everything drawn under layers[layerIndex], or std::nullopt if
+    // that content cannot be identified. A buffer without an acquire fence is not identified,
+    // since its contents may have been updated in place.
+    static std::optional<size_t> computeContentKey(const DisplaySettings& display,
+                                                   const std::vector<LayerSettings>& layers,
+                                                   size_t layerIndex);
+
+    // Returns nullptr on a miss.
+    sk_sp<SkImage> get(size_t contentKey, uint32_t radius, const SkRect& blurRect);
+
+    // Evicts the least recently used blur if the cache is full.
+    void put(size_t contentKey, uint32_t radius, const SkRect& blurRect, sk_sp<SkImage> image);
+
+    void clear();
+
+    size_t size() const { return mEntries.size(); }
+    // Bytes of GPU memory held by the cached blurs.
+    size_t memoryUsage() const;
+    void dump(std::string& result) const;
+
+private:
+    struct Entry {
+        size_t contentKey;
+        uint32_t radius;
+        SkRect blurRect;
+        sk_sp<SkImage> image;
+        uint64_t lastUsed;
+    };
+
+    std::vector<Entry> mEntries;
+    uint64_t mUseCounter = 0;
+
+    int mHits = 0;
+    int mMisses = 0;
+    // Number of pixels the blur filter did not have to process thanks to hits.
+    uint64_t mPixelsReused = 0;
+};
+
+} // namespace skia
+} // namespace renderengine
+} // namespace android
@@ -40,6 +40,71 @@ sk_sp<SkRuntimeEffect> buildRuntimeEffect(const shaders::LinearEffect& linearEff
     return shader;
 }
 
+sk_sp<SkRuntimeEffect> LinearEffectCache::getOrBuild(const shaders::LinearEffect& linearEffect) {
+    if (const auto it = mIndex.find(linearEffect); it != mIndex.end()) {
+        mEffects.splice(mEffects.begin(), mEffects, it->second);
+        return it->second->second;
+    }
+
+    if (mEffects.size() >= kMaxEffects) {
+        mIndex.erase(mEffects.back().first);
+        mEffects.pop_back();
+    }
+    mEffects.emplace_front(linearEffect, buildRuntimeEffect(linearEffect));
+    mIndex.emplace(linearEffect, mEffects.begin());
+    return mEffects.front().second;
+}
+
+size_t LinearEffectCache::prewarm() {
+    SFTRACE_CALL();
+    size_t built = 0;
+    for (const auto& linearEffect : commonLinearEffects()) {
+        if (mIndex.find(linearEffect) == mIndex.end()) {
+            getOrBuild(linearEffect);
+            built++;
+        }
+    }
+    return built;
+}
+
+std::vector<shaders::LinearEffect> LinearEffectCache::commonLinearEffects() {
+    using ui::Dataspace;
+    // Content SurfaceFlinger commonly composes: SDR and wide color UI, HDR10 and HLG video, and
+    // extended range (HDR UI and Ultra HDR images).
+    static constexpr Dataspace kInputDataspaces[] = {
+            Dataspace::V0_SRGB,
+            Dataspace::DISPLAY_P3,
+            Dataspace::BT2020_ITU_PQ,
+            Dataspace::BT2020_ITU_HLG,
+            Dataspace::BT2020_PQ,
+            Dataspace::BT2020_HLG,
+            static_cast<Dataspace>(Dataspace::RANGE_EXTENDED | Dataspace::TRANSFER_SRGB |
+                                   Dataspace::STANDARD_DCI_P3),
+            Dataspace::V0_SCRGB,
+    };
+    // Dataspaces that displays commonly composite into.
+    static constexpr Dataspace kOutputDataspaces[] = {
+            Dataspace::V0_SRGB,
+            Dataspace::DISPLAY_P3,
+            Dataspace::DISPLAY_BT2020,
+    };
+
+    std::vector<shaders::LinearEffect> linearEffects;
+    for (const auto outputDataspace : kOutputDataspaces) {
+        for (const auto inputDataspace : kInputDataspaces) {
+            if (inputDataspace == outputDataspace) {
+                continue;
+            }
+            for (const bool undoPremultipliedAlpha : {false, true}) {
+                linearEffects.push_back({.inputDataspace = inputDataspace,
+                                         .outputDataspace = outputDataspace,
+                                         .undoPremultipliedAlpha = undoPremultipliedAlpha});
+            }
+        }
+    }
+    return linearEffects;
+}
+
 sk_sp<SkShader> createLinearEffectShader(
         sk_sp<SkShader> shader, const shaders::LinearEffect& linearEffect,
         sk_sp<SkRuntimeEffect> runtimeEffect, const mat4& colorTransform, float maxDisplayLuminance,
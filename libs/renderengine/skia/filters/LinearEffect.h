@@ -18,7 +18,10 @@
 
 #include <math/mat4.h>
 
+#include <list>
 #include <optional>
+#include <unordered_map>
+#include <vector>
 
 #include <shaders/shaders.h>
 #include "SkRuntimeEffect.h"
@@ -49,6 +52,43 @@ sk_sp<SkShader> createLinearEffectShader(
         sk_sp<SkRuntimeEffect> runtimeEffect, const mat4& colorTransform, float maxDisplayLuminance,
         float currentDisplayLuminanceNits, float maxLuminance, AHardwareBuffer* buffer,
         aidl::android::hardware::graphics::composer3::RenderIntent renderIntent);
+
+// The runtime effects built by buildRuntimeEffect, keyed by their LinearEffect. Building an effect
+// generates and parses its SkSL, which is slow enough to cause a hitch when content switches to a
+// new dataspace, so the most recently used effects are kept.
+class LinearEffectCache {
+public:
+    static constexpr size_t kMaxEffects = 64;
+
+    // Returns the cached effect, building it on a miss. Evicts the least recently used effect if
+    // the cache is full.
+    sk_sp<SkRuntimeEffect> getOrBuild(const shaders::LinearEffect& linearEffect);
+
+    // Builds the effects for the dataspace combinations that devices commonly compose, so that
+    // they do not have to be built at draw time. Returns the number of effects built.
+    size_t prewarm();
+
+    // The combinations built by prewarm.
+    static std::vector<shaders::LinearEffect> commonLinearEffects();
+
+    size_t size() const { return mEffects.size(); }
+
+    // Iterates from the most to the least recently used effect.
+    template <typename F>
+    void forEach(F f) const {
+        for (const auto& [linearEffect, runtimeEffect] : mEffects) {
+            f(linearEffect);
+        }
+    }
+
+private:
+    using Entry = std::pair<shaders::LinearEffect, sk_sp<SkRuntimeEffect>>;
+    std::list<Entry> mEffects;
+    std::unordered_map<shaders::LinearEffect, std::list<Entry>::iterator,
+                       shaders::LinearEffectHasher>
+            mIndex;
+};
+
 } // namespace skia
 } // namespace renderengine
 } // namespace android
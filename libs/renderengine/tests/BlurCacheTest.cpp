@@ -0,0 +1,118 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <SkSurface.h>
+#include <renderengine/impl/ExternalTexture.h>
+#include <renderengine/mock/RenderEngine.h>
+
+#include "../skia/filters/BlurCache.h"
+
+namespace android::renderengine::skia {
+
+namespace {
+
+sk_sp<SkImage> makeImage() {
+    return SkSurfaces::Raster(SkImageInfo::MakeN32Premul(1, 1))->makeImageSnapshot();
+}
+
+LayerSettings makeSolidLayer(half3 color) {
+    LayerSettings layer;
+    layer.geometry.boundaries = FloatRect(0, 0, 100, 100);
+    layer.source.solidColor = color;
+    layer.alpha = 1.f;
+    return layer;
+}
+
+LayerSettings makeBlurLayer() {
+    LayerSettings layer = makeSolidLayer(half3(0.f, 0.f, 0.f));
+    layer.alpha = 0.5f;
+    layer.backgroundBlurRadius = 30;
+    return layer;
+}
+
+} // namespace
+
+class BlurCacheTest : public testing::Test {
+protected:
+    std::shared_ptr<ExternalTexture> makeBuffer() {
+        return std::make_shared<impl::ExternalTexture>(sp<GraphicBuffer>::make(), mRenderEngine,
+                                                       impl::ExternalTexture::Usage::READABLE);
+    }
+
+    DisplaySettings mDisplay{.physicalDisplay = Rect(0, 0, 100, 100),
+                             .clip = Rect(0, 0, 100, 100)};
+    mock::RenderEngine mRenderEngine;
+};
+
+TEST_F(BlurCacheTest, contentKeyOnlyDependsOnLayersBelow) {
+    std::vector<LayerSettings> layers = {makeSolidLayer(half3(1.f, 0.f, 0.f)), makeBlurLayer(),
+                                         makeSolidLayer(half3(0.f, 1.f, 0.f))};
+    const auto key = BlurCache::computeContentKey(mDisplay, layers, 1);
+    ASSERT_TRUE(key);
+
+    layers[2].source.solidColor = half3(0.f, 0.f, 1.f);
+    EXPECT_EQ(key, BlurCache::computeContentKey(mDisplay, layers, 1));
+
+    layers[0].source.solidColor = half3(0.f, 0.f, 1.f);
+    EXPECT_NE(key, BlurCache::computeContentKey(mDisplay, layers, 1));
+}
+
+TEST_F(BlurCacheTest, contentKeyChangesWithBufferFrames) {
+    std::vector<LayerSettings> layers = {makeSolidLayer(half3(1.f, 0.f, 0.f)), makeBlurLayer()};
+    layers[0].source.buffer.buffer = makeBuffer();
+
+    // Without a fence, a new frame in the same buffer cannot be told apart.
+    layers[0].source.buffer.fence = Fence::NO_FENCE;
+    EXPECT_FALSE(BlurCache::computeContentKey(mDisplay, layers, 1));
+
+    layers[0].source.buffer.fence = sp<Fence>::make(dup(1));
+    const auto key = BlurCache::computeContentKey(mDisplay, layers, 1);
+    ASSERT_TRUE(key);
+    EXPECT_EQ(key, BlurCache::computeContentKey(mDisplay, layers, 1));
+
+    layers[0].source.buffer.fence = sp<Fence>::make(dup(1));
+    EXPECT_NE(key, BlurCache::computeContentKey(mDisplay, layers, 1));
+}
+
+TEST_F(BlurCacheTest, getMatchesRadiusAndRect) {
+    BlurCache cache;
+    const SkRect blurRect = SkRect::MakeWH(100, 100);
+    const sk_sp<SkImage> image = makeImage();
+    cache.put(1, 30, blurRect, image);
+
+    EXPECT_EQ(image, cache.get(1, 30, blurRect));
+    EXPECT_EQ(nullptr, cache.get(2, 30, blurRect));
+    EXPECT_EQ(nullptr, cache.get(1, 20, blurRect));
+    EXPECT_EQ(nullptr, cache.get(1, 30, SkRect::MakeWH(50, 50)));
+}
+
+TEST_F(BlurCacheTest, evictsLeastRecentlyUsed) {
+    BlurCache cache;
+    const SkRect blurRect = SkRect::MakeWH(100, 100);
+    for (size_t key = 0; key < BlurCache::kMaxEntries; key++) {
+        cache.put(key, 30, blurRect, makeImage());
+    }
+    ASSERT_NE(nullptr, cache.get(0, 30, blurRect));
+
+    cache.put(BlurCache::kMaxEntries, 30, blurRect, makeImage());
+    EXPECT_EQ(BlurCache::kMaxEntries, cache.size());
+    EXPECT_NE(nullptr, cache.get(0, 30, blurRect));
+    EXPECT_EQ(nullptr, cache.get(1, 30, blurRect));
+}
+
+} // namespace android::renderengine::skia
@@ -0,0 +1,51 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <unordered_set>
+
+#include "../skia/filters/LinearEffect.h"
+
+namespace android::renderengine::skia {
+
+TEST(LinearEffectCacheTest, commonLinearEffectsFitInCache) {
+    const auto linearEffects = LinearEffectCache::commonLinearEffects();
+    std::unordered_set<shaders::LinearEffect, shaders::LinearEffectHasher>
+            uniqueEffects(linearEffects.begin(), linearEffects.end());
+    EXPECT_EQ(linearEffects.size(), uniqueEffects.size());
+    EXPECT_LE(linearEffects.size(), LinearEffectCache::kMaxEffects);
+}
+
+TEST(LinearEffectCacheTest, prewarmBuildsEffectsOnce) {
+    LinearEffectCache cache;
+    const size_t built = cache.prewarm();
+    EXPECT_EQ(LinearEffectCache::commonLinearEffects().size(), built);
+    EXPECT_EQ(built, cache.size());
+    EXPECT_EQ(0u, cache.prewarm());
+}
+
+TEST(LinearEffectCacheTest, getOrBuildReusesEffects) {
+    LinearEffectCache cache;
+    const shaders::LinearEffect linearEffect{.inputDataspace = ui::Dataspace::BT2020_ITU_PQ,
+                                             .outputDataspace = ui::Dataspace::DISPLAY_P3};
+    const sk_sp<SkRuntimeEffect> runtimeEffect = cache.getOrBuild(linearEffect);
+    ASSERT_NE(nullptr, runtimeEffect);
+    EXPECT_EQ(runtimeEffect, cache.getOrBuild(linearEffect));
+    EXPECT_EQ(1u, cache.size());
+}
+
+} // namespace android::renderengine::skia
@@ -147,6 +147,33 @@ TEST_F(RenderEngineThreadedTest, PostRenderCleanup_notSkipped) {
     mThreadedRE->getContextPriority();
 }
 
+TEST_F(RenderEngineThreadedTest, queuedWorkRunsInOrder) {
+    // Hold up the RenderEngine thread, so that the work below queues up past the initial
+    // capacity of the queue.
+    std::promise<void> unblock;
+    std::shared_future<void> unblocked = unblock.get_future().share();
+    EXPECT_CALL(*mRenderEngine, primeCache(_)).WillOnce([unblocked](PrimeCacheConfig) {
+        unblocked.wait();
+        return std::future<void>();
+    });
+    mThreadedRE->primeCache(PrimeCacheConfig());
+
+    constexpr int kCalls = 100;
+    {
+        testing::InSequence seq;
+        for (int i = 1; i <= kCalls; i++) {
+            EXPECT_CALL(*mRenderEngine, onActiveDisplaySizeChanged(ui::Size(i, i)));
+        }
+    }
+    for (int i = 1; i <= kCalls; i++) {
+        mThreadedRE->onActiveDisplaySizeChanged(ui::Size(i, i));
+    }
+    unblock.set_value();
+
+    // call ANY synchronous function to ensure that the queued work has completed.
+    mThreadedRE->getContextPriority();
+}
+
 TEST_F(RenderEngineThreadedTest, supportsBackgroundBlur_returnsFalse) {
     EXPECT_CALL(*mRenderEngine, supportsBackgroundBlur()).WillOnce(Return(false));
     status_t result = mThreadedRE->supportsBackgroundBlur();
@@ -185,6 +212,61 @@ TEST_F(RenderEngineThreadedTest, drawLayers) {
     ASSERT_TRUE(result.ok());
 }
 
+TEST_F(RenderEngineThreadedTest, drawLayersToMirrors_drawsLayersOnce) {
+    renderengine::DisplaySettings settings;
+    settings.physicalDisplay = Rect(0, 0, 100, 100);
+    std::vector<renderengine::LayerSettings> layers(3);
+    auto graphicBuffer = sp<GraphicBuffer>::make();
+    graphicBuffer->usage |= GRALLOC_USAGE_HW_TEXTURE;
+    std::shared_ptr<renderengine::ExternalTexture> buffer = std::make_shared<
+            renderengine::impl::
+                    ExternalTexture>(std::move(graphicBuffer), *mRenderEngine,
+                                     renderengine::impl::ExternalTexture::Usage::READABLE |
+                                             renderengine::impl::ExternalTexture::Usage::WRITEABLE);
+    std::shared_ptr<renderengine::ExternalTexture> mirrorBuffer = std::make_shared<
+            renderengine::impl::
+                    ExternalTexture>(sp<GraphicBuffer>::make(), *mRenderEngine,
+                                     renderengine::impl::ExternalTexture::Usage::READABLE |
+                                             renderengine::impl::ExternalTexture::Usage::WRITEABLE);
+
+    std::vector<renderengine::RenderEngine::MirrorOutput> mirrors;
+    mirrors.push_back({.display = {.physicalDisplay = Rect(0, 0, 50, 50)},
+                       .buffer = mirrorBuffer});
+
+    EXPECT_CALL(*mRenderEngine, useProtectedContext(false)).Times(2);
+    EXPECT_CALL(*mRenderEngine, drawLayersInternal)
+            .WillOnce([&](const std::shared_ptr<std::promise<FenceResult>>&& resultPromise,
+                          const renderengine::DisplaySettings&,
+                          const std::vector<renderengine::LayerSettings>& drawnLayers,
+                          const std::shared_ptr<renderengine::ExternalTexture>& output,
+                          base::unique_fd&&) {
+                EXPECT_EQ(drawnLayers.size(), 3u);
+                EXPECT_EQ(output, buffer);
+                resultPromise->set_value(Fence::NO_FENCE);
+            })
+            .WillOnce([&](const std::shared_ptr<std::promise<FenceResult>>&& resultPromise,
+                          const renderengine::DisplaySettings& display,
+                          const std::vector<renderengine::LayerSettings>& drawnLayers,
+                          const std::shared_ptr<renderengine::ExternalTexture>& output,
+                          base::unique_fd&&) {
+                // The mirror samples the output instead of drawing the layers again.
+                EXPECT_EQ(display.clip, Rect(0, 0, 50, 50));
+                ASSERT_EQ(drawnLayers.size(), 1u);
+                EXPECT_EQ(drawnLayers[0].source.buffer.buffer, buffer);
+                EXPECT_EQ(output, mirrorBuffer);
+                resultPromise->set_value(Fence::NO_FENCE);
+            });
+
+    std::vector<ftl::Future<FenceResult>> futures =
+            mThreadedRE->drawLayersToMirrors(settings, layers, buffer, base::unique_fd(),
+                                             std::move(mirrors));
+    ASSERT_EQ(futures.size(), 2u);
+    for (auto& future : futures) {
+        ASSERT_TRUE(future.valid());
+        ASSERT_TRUE(future.get().ok());
+    }
+}
+
 TEST_F(RenderEngineThreadedTest, drawLayers_protectedLayer) {
     renderengine::DisplaySettings settings;
     auto layerBuffer = sp<GraphicBuffer>::make();
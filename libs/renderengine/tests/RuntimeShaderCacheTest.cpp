@@ -0,0 +1,72 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "../skia/RuntimeShaderCache.h"
+
+namespace android::renderengine::skia {
+
+namespace {
+
+sk_sp<SkData> makeData(const std::string& string) {
+    return SkData::MakeWithCopy(string.data(), string.size());
+}
+
+std::string toString(const sk_sp<SkData>& data) {
+    return std::string(static_cast<const char*>(data->data()), data->size());
+}
+
+} // namespace
+
+TEST(RuntimeShaderCacheTest, serializeRoundTrips) {
+    std::vector<std::pair<sk_sp<SkData>, sk_sp<SkData>>> shaders = {
+            {makeData("key1"), makeData("shader one")},
+            {makeData("key2"), makeData("")},
+    };
+
+    std::vector<std::pair<sk_sp<SkData>, sk_sp<SkData>>> result;
+    ASSERT_TRUE(RuntimeShaderCache::deserialize(RuntimeShaderCache::serialize(shaders), result));
+    ASSERT_EQ(result.size(), 2u);
+    EXPECT_EQ(toString(result[0].first), "key1");
+    EXPECT_EQ(toString(result[0].second), "shader one");
+    EXPECT_EQ(toString(result[1].first), "key2");
+    EXPECT_EQ(toString(result[1].second), "");
+}
+
+TEST(RuntimeShaderCacheTest, deserializeRejectsTruncatedData) {
+    const std::string bytes =
+            RuntimeShaderCache::serialize({{makeData("key"), makeData("shader")}});
+
+    std::vector<std::pair<sk_sp<SkData>, sk_sp<SkData>>> result;
+    EXPECT_FALSE(RuntimeShaderCache::deserialize(bytes.substr(0, bytes.size() - 1), result));
+    EXPECT_TRUE(result.empty());
+    EXPECT_FALSE(RuntimeShaderCache::deserialize("", result));
+}
+
+TEST(RuntimeShaderCacheTest, recordsEachShaderOnce) {
+    RuntimeShaderCache cache("");
+    EXPECT_TRUE(cache.record(*makeData("key"), *makeData("shader")));
+    EXPECT_FALSE(cache.record(*makeData("key"), *makeData("other shader")));
+    EXPECT_EQ(cache.size(), 1u);
+
+    sk_sp<SkData> data = cache.find(*makeData("key"));
+    ASSERT_NE(data, nullptr);
+    EXPECT_EQ(toString(data), "shader");
+    EXPECT_EQ(cache.find(*makeData("missing")), nullptr);
+}
+
+} // namespace android::renderengine::skia
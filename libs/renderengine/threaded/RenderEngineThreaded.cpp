@@ -19,6 +19,7 @@
 #include "RenderEngineThreaded.h"
 
 #include <sched.h>
+#include <algorithm>
 #include <chrono>
 #include <future>
 
@@ -100,9 +101,18 @@ void RenderEngineThreaded::threadMain(CreateInstanceFactory factory) NO_THREAD_S
         const auto getNextTask = [this]() -> std::optional<Work> {
             std::scoped_lock lock(mThreadMutex);
             if (!mFunctionCalls.empty()) {
-                Work task = mFunctionCalls.front();
-                mFunctionCalls.pop();
-                return std::make_optional<Work>(task);
+                return mFunctionCalls.pop();
+            }
+            // Texture imports only run once there is nothing else to do.
+            if (!mPendingTextureImports.empty()) {
+                PendingTextureImport import = std::move(mPendingTextureImports.front());
+                mPendingTextureImports.pop_front();
+                SFTRACE_INT("REPendingTextureImports",
+                            static_cast<int32_t>(mPendingTextureImports.size()));
+                return std::make_optional<Work>([import](renderengine::RenderEngine& instance) {
+                    SFTRACE_NAME("REThreaded::mapExternalTextureBuffer");
+                    instance.mapExternalTextureBuffer(import.buffer, import.isRenderable);
+                });
             }
             return std::nullopt;
         };
@@ -115,7 +125,7 @@ void RenderEngineThreaded::threadMain(CreateInstanceFactory factory) NO_THREAD_S
 
         std::unique_lock<std::mutex> lock(mThreadMutex);
         mCondition.wait(lock, [this]() REQUIRES(mThreadMutex) {
-            return !mRunning || !mFunctionCalls.empty();
+            return !mRunning || !mFunctionCalls.empty() || !mPendingTextureImports.empty();
         });
     }
 
@@ -134,42 +144,97 @@ std::future<void> RenderEngineThreaded::primeCache(PrimeCacheConfig config) {
     const auto resultPromise = std::make_shared<std::promise<void>>();
     std::future<void> resultFuture = resultPromise->get_future();
     SFTRACE_CALL();
+    // Priming takes a while, so let the frames which come in meanwhile be drawn between its steps.
+    config.yield = [this] { runQueuedWork(); };
     // This function is designed so it can run asynchronously, so we do not need to wait
     // for the futures.
+    queueWork([resultPromise, config](renderengine::RenderEngine& instance) {
+        SFTRACE_NAME("REThreaded::primeCache");
+        if (setSchedFifo(false) != NO_ERROR) {
+            ALOGW("Couldn't set SCHED_OTHER for primeCache");
+        }
+
+        instance.primeCache(config);
+        resultPromise->set_value();
+
+        if (setSchedFifo(true) != NO_ERROR) {
+            ALOGW("Couldn't set SCHED_FIFO for primeCache");
+        }
+    });
+
+    return resultFuture;
+}
+
+void RenderEngineThreaded::queueWork(Work&& work) {
     {
         std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([resultPromise, config](renderengine::RenderEngine& instance) {
-            SFTRACE_NAME("REThreaded::primeCache");
-            if (setSchedFifo(false) != NO_ERROR) {
-                ALOGW("Couldn't set SCHED_OTHER for primeCache");
-            }
+        mFunctionCalls.push(std::move(work));
+    }
+    mCondition.notify_one();
+}
 
-            instance.primeCache(config);
-            resultPromise->set_value();
+void RenderEngineThreaded::WorkRing::push(Work&& work) {
+    if (mSize == mSlots.size()) {
+        // Unroll the ring into a larger one, keeping the oldest work first.
+        std::vector<Work> slots(mSlots.size() * 2);
+        for (size_t i = 0; i < mSize; i++) {
+            slots[i] = std::move(mSlots[(mHead + i) % mSlots.size()]);
+        }
+        mSlots = std::move(slots);
+        mHead = 0;
+    }
+    mSlots[(mHead + mSize) % mSlots.size()] = std::move(work);
+    mSize++;
+}
 
-            if (setSchedFifo(true) != NO_ERROR) {
-                ALOGW("Couldn't set SCHED_FIFO for primeCache");
-            }
-        });
+RenderEngineThreaded::Work RenderEngineThreaded::WorkRing::pop() {
+    Work work = std::move(mSlots[mHead]);
+    // Release what the work captured now rather than when the slot is reused.
+    mSlots[mHead] = nullptr;
+    mHead = (mHead + 1) % mSlots.size();
+    mSize--;
+    return work;
+}
+
+// NO_THREAD_SAFETY_ANALYSIS is because the queued work must run without holding mThreadMutex.
+void RenderEngineThreaded::runQueuedWork() NO_THREAD_SAFETY_ANALYSIS {
+    // Only run the work queued so far, as more may be queued while it runs.
+    size_t count;
+    {
+        std::scoped_lock lock(mThreadMutex);
+        count = mFunctionCalls.size();
+    }
+    if (count == 0) {
+        return;
     }
-    mCondition.notify_one();
 
-    return resultFuture;
+    SFTRACE_CALL();
+    // The caller lowered the priority of the thread, restore it for the queued work.
+    if (setSchedFifo(true) != NO_ERROR) {
+        ALOGW("Couldn't set SCHED_FIFO for queued work");
+    }
+    for (size_t i = 0; i < count; i++) {
+        Work work;
+        {
+            std::scoped_lock lock(mThreadMutex);
+            work = mFunctionCalls.pop();
+        }
+        work(*mRenderEngine);
+    }
+    if (setSchedFifo(false) != NO_ERROR) {
+        ALOGW("Couldn't set SCHED_OTHER after queued work");
+    }
 }
 
 void RenderEngineThreaded::dump(std::string& result) {
     std::promise<std::string> resultPromise;
     std::future<std::string> resultFuture = resultPromise.get_future();
-    {
-        std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([&resultPromise, &result](renderengine::RenderEngine& instance) {
-            SFTRACE_NAME("REThreaded::dump");
-            std::string localResult = result;
-            instance.dump(localResult);
-            resultPromise.set_value(std::move(localResult));
-        });
-    }
-    mCondition.notify_one();
+    queueWork([&resultPromise, &result](renderengine::RenderEngine& instance) {
+        SFTRACE_NAME("REThreaded::dump");
+        std::string localResult = result;
+        instance.dump(localResult);
+        resultPromise.set_value(std::move(localResult));
+    });
     // Note: This is an rvalue.
     result.assign(resultFuture.get());
 }
@@ -181,10 +246,8 @@ void RenderEngineThreaded::mapExternalTextureBuffer(const sp<GraphicBuffer>& buf
     // for the futures.
     {
         std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([=](renderengine::RenderEngine& instance) {
-            SFTRACE_NAME("REThreaded::mapExternalTextureBuffer");
-            instance.mapExternalTextureBuffer(buffer, isRenderable);
-        });
+        mPendingTextureImports.push_back({buffer, isRenderable});
+        SFTRACE_INT("REPendingTextureImports", static_cast<int32_t>(mPendingTextureImports.size()));
     }
     mCondition.notify_one();
 }
@@ -195,6 +258,17 @@ void RenderEngineThreaded::unmapExternalTextureBuffer(sp<GraphicBuffer>&& buffer
     // for the futures.
     {
         std::lock_guard lock(mThreadMutex);
+        // A buffer that was never imported does not need to be unmapped.
+        const auto it = std::find_if(mPendingTextureImports.rbegin(), mPendingTextureImports.rend(),
+                                     [&](const PendingTextureImport& import) {
+                                         return import.buffer->getId() == buffer->getId();
+                                     });
+        if (it != mPendingTextureImports.rend()) {
+            mPendingTextureImports.erase(std::next(it).base());
+            SFTRACE_INT("REPendingTextureImports",
+                        static_cast<int32_t>(mPendingTextureImports.size()));
+            return;
+        }
         mFunctionCalls.push(
                 [=, buffer = std::move(buffer)](renderengine::RenderEngine& instance) mutable {
                     SFTRACE_NAME("REThreaded::unmapExternalTextureBuffer");
@@ -204,6 +278,38 @@ void RenderEngineThreaded::unmapExternalTextureBuffer(sp<GraphicBuffer>&& buffer
     mCondition.notify_one();
 }
 
+void RenderEngineThreaded::importPendingTextures(renderengine::RenderEngine& instance,
+                                                 const std::vector<LayerSettings>& layers,
+                                                 const ExternalTexture* output) {
+    std::vector<PendingTextureImport> imports;
+    {
+        std::scoped_lock lock(mThreadMutex);
+        if (mPendingTextureImports.empty()) {
+            return;
+        }
+        const auto isDrawn = [&](const PendingTextureImport& import) {
+            const uint64_t id = import.buffer->getId();
+            return (output && output->getId() == id) ||
+                    std::any_of(layers.begin(), layers.end(), [id](const LayerSettings& layer) {
+                        return layer.source.buffer.buffer &&
+                                layer.source.buffer.buffer->getId() == id;
+                    });
+        };
+        for (auto it = mPendingTextureImports.begin(); it != mPendingTextureImports.end();) {
+            if (isDrawn(*it)) {
+                imports.push_back(std::move(*it));
+                it = mPendingTextureImports.erase(it);
+            } else {
+                it++;
+            }
+        }
+    }
+    for (const auto& import : imports) {
+        SFTRACE_NAME("REThreaded::mapExternalTextureBuffer");
+        instance.mapExternalTextureBuffer(import.buffer, import.isRenderable);
+    }
+}
+
 size_t RenderEngineThreaded::getMaxTextureSize() const {
     waitUntilInitialized();
     return mRenderEngine->getMaxTextureSize();
@@ -226,15 +332,11 @@ void RenderEngineThreaded::cleanupPostRender() {
 
     // This function is designed so it can run asynchronously, so we do not need to wait
     // for the futures.
-    {
-        std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([=](renderengine::RenderEngine& instance) {
-            SFTRACE_NAME("REThreaded::cleanupPostRender");
-            instance.cleanupPostRender();
-        });
-        mNeedsPostRenderCleanup = false;
-    }
-    mCondition.notify_one();
+    mNeedsPostRenderCleanup = false;
+    queueWork([](renderengine::RenderEngine& instance) {
+        SFTRACE_NAME("REThreaded::cleanupPostRender");
+        instance.cleanupPostRender();
+    });
 }
 
 bool RenderEngineThreaded::canSkipPostRenderCleanup() const {
@@ -266,21 +368,48 @@ ftl::Future<FenceResult> RenderEngineThreaded::drawLayers(
     const auto resultPromise = std::make_shared<std::promise<FenceResult>>();
     std::future<FenceResult> resultFuture = resultPromise->get_future();
     int fd = bufferFence.release();
-    {
-        std::lock_guard lock(mThreadMutex);
-        mNeedsPostRenderCleanup = true;
-        mFunctionCalls.push(
-                [resultPromise, display, layers, buffer, fd](renderengine::RenderEngine& instance) {
-                    SFTRACE_NAME("REThreaded::drawLayers");
-                    instance.updateProtectedContext(layers, {buffer.get()});
-                    instance.drawLayersInternal(std::move(resultPromise), display, layers, buffer,
-                                                base::unique_fd(fd));
-                });
-    }
-    mCondition.notify_one();
+    mNeedsPostRenderCleanup = true;
+    queueWork([this, resultPromise, display, layers, buffer,
+               fd](renderengine::RenderEngine& instance) {
+        SFTRACE_NAME("REThreaded::drawLayers");
+        importPendingTextures(instance, layers, buffer.get());
+        instance.updateProtectedContext(layers, {buffer.get()});
+        instance.drawLayersInternal(std::move(resultPromise), display, layers, buffer,
+                                    base::unique_fd(fd));
+    });
     return resultFuture;
 }
 
+std::vector<ftl::Future<FenceResult>> RenderEngineThreaded::drawLayersToMirrors(
+        const DisplaySettings& display, const std::vector<LayerSettings>& layers,
+        const std::shared_ptr<ExternalTexture>& buffer, base::unique_fd&& bufferFence,
+        std::vector<MirrorOutput> mirrors) {
+    SFTRACE_CALL();
+    std::vector<std::shared_ptr<std::promise<FenceResult>>> resultPromises;
+    std::vector<ftl::Future<FenceResult>> resultFutures;
+    resultPromises.reserve(mirrors.size() + 1);
+    resultFutures.reserve(mirrors.size() + 1);
+    for (size_t i = 0; i < mirrors.size() + 1; i++) {
+        resultFutures.emplace_back(resultPromises.emplace_back(
+                std::make_shared<std::promise<FenceResult>>())->get_future());
+    }
+    // Work must be copyable, so the fences and mirrors are shared with it rather than moved in.
+    int fd = bufferFence.release();
+    auto sharedMirrors = std::make_shared<std::vector<MirrorOutput>>(std::move(mirrors));
+    mNeedsPostRenderCleanup = true;
+    queueWork([this, resultPromises, display, layers, buffer, fd,
+               sharedMirrors](renderengine::RenderEngine& instance) mutable {
+        SFTRACE_NAME("REThreaded::drawLayersToMirrors");
+        importPendingTextures(instance, layers, buffer.get());
+        for (const auto& mirror : *sharedMirrors) {
+            importPendingTextures(instance, {}, mirror.buffer.get());
+        }
+        instance.drawLayersToMirrorsInternal(std::move(resultPromises), display, layers, buffer,
+                                             base::unique_fd(fd), std::move(*sharedMirrors));
+    });
+    return resultFutures;
+}
+
 ftl::Future<FenceResult> RenderEngineThreaded::drawGainmap(
         const std::shared_ptr<ExternalTexture>& sdr, base::borrowed_fd&& sdrFence,
         const std::shared_ptr<ExternalTexture>& hdr, base::borrowed_fd&& hdrFence,
@@ -289,34 +418,26 @@ ftl::Future<FenceResult> RenderEngineThreaded::drawGainmap(
     SFTRACE_CALL();
     const auto resultPromise = std::make_shared<std::promise<FenceResult>>();
     std::future<FenceResult> resultFuture = resultPromise->get_future();
-    {
-        std::lock_guard lock(mThreadMutex);
-        mNeedsPostRenderCleanup = true;
-        mFunctionCalls.push([resultPromise, sdr, sdrFence = std::move(sdrFence), hdr,
-                             hdrFence = std::move(hdrFence), hdrSdrRatio, dataspace,
-                             gainmap](renderengine::RenderEngine& instance) mutable {
-            SFTRACE_NAME("REThreaded::drawGainmap");
-            instance.updateProtectedContext({}, {sdr.get(), hdr.get(), gainmap.get()});
-            instance.drawGainmapInternal(std::move(resultPromise), sdr, std::move(sdrFence), hdr,
-                                         std::move(hdrFence), hdrSdrRatio, dataspace, gainmap);
-        });
-    }
-    mCondition.notify_one();
+    mNeedsPostRenderCleanup = true;
+    queueWork([resultPromise, sdr, sdrFence = std::move(sdrFence), hdr,
+               hdrFence = std::move(hdrFence), hdrSdrRatio, dataspace,
+               gainmap](renderengine::RenderEngine& instance) mutable {
+        SFTRACE_NAME("REThreaded::drawGainmap");
+        instance.updateProtectedContext({}, {sdr.get(), hdr.get(), gainmap.get()});
+        instance.drawGainmapInternal(std::move(resultPromise), sdr, std::move(sdrFence), hdr,
+                                     std::move(hdrFence), hdrSdrRatio, dataspace, gainmap);
+    });
     return resultFuture;
 }
 
 int RenderEngineThreaded::getContextPriority() {
     std::promise<int> resultPromise;
     std::future<int> resultFuture = resultPromise.get_future();
-    {
-        std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([&resultPromise](renderengine::RenderEngine& instance) {
-            SFTRACE_NAME("REThreaded::getContextPriority");
-            int priority = instance.getContextPriority();
-            resultPromise.set_value(priority);
-        });
-    }
-    mCondition.notify_one();
+    queueWork([&resultPromise](renderengine::RenderEngine& instance) {
+        SFTRACE_NAME("REThreaded::getContextPriority");
+        int priority = instance.getContextPriority();
+        resultPromise.set_value(priority);
+    });
     return resultFuture.get();
 }
 
@@ -328,41 +449,28 @@ bool RenderEngineThreaded::supportsBackgroundBlur() {
 void RenderEngineThreaded::onActiveDisplaySizeChanged(ui::Size size) {
     // This function is designed so it can run asynchronously, so we do not need to wait
     // for the futures.
-    {
-        std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([size](renderengine::RenderEngine& instance) {
-            SFTRACE_NAME("REThreaded::onActiveDisplaySizeChanged");
-            instance.onActiveDisplaySizeChanged(size);
-        });
-    }
-    mCondition.notify_one();
+    queueWork([size](renderengine::RenderEngine& instance) {
+        SFTRACE_NAME("REThreaded::onActiveDisplaySizeChanged");
+        instance.onActiveDisplaySizeChanged(size);
+    });
 }
 
 std::optional<pid_t> RenderEngineThreaded::getRenderEngineTid() const {
     std::promise<pid_t> tidPromise;
     std::future<pid_t> tidFuture = tidPromise.get_future();
-    {
-        std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([&tidPromise](renderengine::RenderEngine& instance) {
-            tidPromise.set_value(gettid());
-        });
-    }
-
-    mCondition.notify_one();
+    queueWork([&tidPromise](renderengine::RenderEngine& instance) {
+        tidPromise.set_value(gettid());
+    });
     return std::make_optional(tidFuture.get());
 }
 
 void RenderEngineThreaded::setEnableTracing(bool tracingEnabled) {
     // This function is designed so it can run asynchronously, so we do not need to wait
     // for the futures.
-    {
-        std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([tracingEnabled](renderengine::RenderEngine& instance) {
-            SFTRACE_NAME("REThreaded::setEnableTracing");
-            instance.setEnableTracing(tracingEnabled);
-        });
-    }
-    mCondition.notify_one();
+    queueWork([tracingEnabled](renderengine::RenderEngine& instance) {
+        SFTRACE_NAME("REThreaded::setEnableTracing");
+        instance.setEnableTracing(tracingEnabled);
+    });
 }
 } // namespace threaded
 } // namespace renderengine
@@ -18,9 +18,10 @@
 
 #include <android-base/thread_annotations.h>
 #include <condition_variable>
+#include <deque>
 #include <mutex>
-#include <queue>
 #include <thread>
+#include <vector>
 
 #include "renderengine/RenderEngine.h"
 
@@ -55,6 +56,10 @@ public:
                                         const std::vector<LayerSettings>& layers,
                                         const std::shared_ptr<ExternalTexture>& buffer,
                                         base::unique_fd&& bufferFence) override;
+    std::vector<ftl::Future<FenceResult>> drawLayersToMirrors(
+            const DisplaySettings& display, const std::vector<LayerSettings>& layers,
+            const std::shared_ptr<ExternalTexture>& buffer, base::unique_fd&& bufferFence,
+            std::vector<MirrorOutput> mirrors) override;
     ftl::Future<FenceResult> drawGainmap(const std::shared_ptr<ExternalTexture>& sdr,
                                          base::borrowed_fd&& sdrFence,
                                          const std::shared_ptr<ExternalTexture>& hdr,
@@ -89,6 +94,17 @@ private:
     void threadMain(CreateInstanceFactory factory);
     void waitUntilInitialized() const;
     static status_t setSchedFifo(bool enabled);
+    using Work = std::function<void(renderengine::RenderEngine&)>;
+    // Queues work for the RenderEngine thread. The work should be built before calling this, so
+    // that copying its captures does not hold up the RenderEngine thread waiting on mThreadMutex.
+    void queueWork(Work&& work) EXCLUDES(mThreadMutex);
+    // Runs the work queued so far, from within a long running task such as primeCache.
+    void runQueuedWork();
+    // Imports the pending textures of the buffers drawn by a task, so that they are cached rather
+    // than wrapped for a single draw.
+    void importPendingTextures(renderengine::RenderEngine& instance,
+                               const std::vector<LayerSettings>& layers,
+                               const ExternalTexture* output);
 
     // No-op. This method is only called on leaf implementations of RenderEngine.
     void useProtectedContext(bool) override {}
@@ -103,8 +119,33 @@ private:
     std::atomic<bool> mRunning = true;
     std::atomic<bool> mNeedsPostRenderCleanup = false;
 
-    using Work = std::function<void(renderengine::RenderEngine&)>;
-    mutable std::queue<Work> mFunctionCalls GUARDED_BY(mThreadMutex);
+    // FIFO of work backed by a ring of reused slots, so that queuing does not allocate once the
+    // ring has grown to the deepest queue seen.
+    class WorkRing {
+    public:
+        explicit WorkRing(size_t capacity) : mSlots(capacity) {}
+        bool empty() const { return mSize == 0; }
+        size_t size() const { return mSize; }
+        void push(Work&& work);
+        Work pop();
+
+    private:
+        std::vector<Work> mSlots;
+        size_t mHead = 0;
+        size_t mSize = 0;
+    };
+    // A frame queues a handful of calls per display, so this is rarely outgrown.
+    static constexpr size_t kInitialWorkRingCapacity = 32;
+    WorkRing mFunctionCalls GUARDED_BY(mThreadMutex){kInitialWorkRingCapacity};
+
+    // Buffers waiting for mapExternalTextureBuffer. They are imported when no work is queued, or
+    // by the first task that draws them, so that importing many new buffers at once (e.g. on app
+    // launch) does not hold up drawing.
+    struct PendingTextureImport {
+        sp<GraphicBuffer> buffer;
+        bool isRenderable;
+    };
+    std::deque<PendingTextureImport> mPendingTextureImports GUARDED_BY(mThreadMutex);
     mutable std::condition_variable mCondition;
 
     // Used to allow select thread safe methods to be accessed without requiring the
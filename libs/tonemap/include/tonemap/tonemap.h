@@ -19,6 +19,7 @@
 #include <aidl/android/hardware/graphics/common/Dataspace.h>
 #include <aidl/android/hardware/graphics/composer3/RenderIntent.h>
 #include <android/hardware_buffer.h>
+#include <math/mat3.h>
 #include <math/vec3.h>
 
 #include <string>
@@ -148,6 +149,18 @@ public:
             aidl::android::hardware::graphics::common::Dataspace sourceDataspace,
             aidl::android::hardware::graphics::common::Dataspace destinationDataspace,
             const std::vector<Color>& colors, const Metadata& metadata) = 0;
+
+    // CPU implementation of the tonemapping for whole rows of pixels, such as when converting a
+    // screenshot or generating a gainmap. Each of the count colors in linearRGB is scaled in place
+    // by its gain, as computed by lookupTonemapGain(). The colors are the absolute nits of the
+    // pixels in linear space, and rgbToXyz converts them to XYZ.
+    //
+    // The default implementation calls lookupTonemapGain() on chunks of the row. Implementations
+    // should override it to select the tonemapping curve once per row rather than per color.
+    virtual void tonemapLinearRGB(
+            aidl::android::hardware::graphics::common::Dataspace sourceDataspace,
+            aidl::android::hardware::graphics::common::Dataspace destinationDataspace,
+            vec3* linearRGB, size_t count, const mat3& rgbToXyz, const Metadata& metadata);
 };
 
 // Retrieves a tonemapper instance.
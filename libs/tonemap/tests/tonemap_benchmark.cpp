@@ -0,0 +1,87 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <tonemap/tonemap.h>
+
+#include <vector>
+
+using namespace android;
+using aidl::android::hardware::graphics::common::Dataspace;
+
+namespace {
+
+// One row of a 4K frame, ranging over the luminance of HDR content.
+std::vector<vec3> createRow() {
+    constexpr size_t kWidth = 3840;
+    std::vector<vec3> row;
+    row.reserve(kWidth);
+    for (size_t i = 0; i < kWidth; i++) {
+        const float nits = 10000.f * static_cast<float>(i) / kWidth;
+        row.push_back(vec3(nits, nits * 0.7f, nits * 0.4f));
+    }
+    return row;
+}
+
+const tonemap::Metadata kMetadata{.displayMaxLuminance = 500.f,
+                                  .contentMaxLuminance = 4000.f,
+                                  .currentDisplayLuminance = 200.f};
+
+void BM_lookupTonemapGain(benchmark::State& state, Dataspace source, Dataspace destination) {
+    const std::vector<vec3> row = createRow();
+    const mat3 rgbToXyz;
+    for (auto _ : state) {
+        std::vector<tonemap::Color> colors;
+        colors.reserve(row.size());
+        for (const auto& linearRGB : row) {
+            colors.push_back({.linearRGB = linearRGB, .xyz = rgbToXyz * linearRGB});
+        }
+        const auto gains =
+                tonemap::getToneMapper()->lookupTonemapGain(source, destination, colors, kMetadata);
+        std::vector<vec3> tonemapped;
+        tonemapped.reserve(row.size());
+        for (size_t i = 0; i < row.size(); i++) {
+            tonemapped.push_back(row[i] * static_cast<float>(gains[i]));
+        }
+        benchmark::DoNotOptimize(tonemapped.data());
+    }
+    state.SetItemsProcessed(state.iterations() * row.size());
+}
+
+void BM_tonemapLinearRGB(benchmark::State& state, Dataspace source, Dataspace destination) {
+    const std::vector<vec3> row = createRow();
+    const mat3 rgbToXyz;
+    std::vector<vec3> tonemapped(row.size());
+    for (auto _ : state) {
+        tonemapped = row;
+        tonemap::getToneMapper()->tonemapLinearRGB(source, destination, tonemapped.data(),
+                                                   tonemapped.size(), rgbToXyz, kMetadata);
+        benchmark::DoNotOptimize(tonemapped.data());
+    }
+    state.SetItemsProcessed(state.iterations() * row.size());
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE(BM_lookupTonemapGain, PqToP3, Dataspace::BT2020_ITU_PQ, Dataspace::DISPLAY_P3);
+BENCHMARK_CAPTURE(BM_tonemapLinearRGB, PqToP3, Dataspace::BT2020_ITU_PQ, Dataspace::DISPLAY_P3);
+BENCHMARK_CAPTURE(BM_lookupTonemapGain, HlgToP3, Dataspace::BT2020_ITU_HLG, Dataspace::DISPLAY_P3);
+BENCHMARK_CAPTURE(BM_tonemapLinearRGB, HlgToP3, Dataspace::BT2020_ITU_HLG, Dataspace::DISPLAY_P3);
+BENCHMARK_CAPTURE(BM_lookupTonemapGain, PqToPq, Dataspace::BT2020_ITU_PQ,
+                  Dataspace::BT2020_ITU_PQ);
+BENCHMARK_CAPTURE(BM_tonemapLinearRGB, PqToPq, Dataspace::BT2020_ITU_PQ, Dataspace::BT2020_ITU_PQ);
+
+BENCHMARK_MAIN();
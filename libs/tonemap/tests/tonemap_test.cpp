@@ -17,6 +17,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <tonemap/tonemap.h>
+#include <algorithm>
 #include <cmath>
 
 namespace android {
@@ -85,4 +86,43 @@ TEST_F(TonemapTest, generateTonemapGainShaderSkSL_containsEntryPointForHLG) {
     EXPECT_THAT(shader, HasSubstr("float libtonemap_LookupTonemapGain(vec3 linearRGB, vec3 xyz)"));
 }
 
+TEST_F(TonemapTest, tonemapLinearRGB_matchesLookupTonemapGain) {
+    using aidl::android::hardware::graphics::common::Dataspace;
+    const tonemap::Metadata metadata{.displayMaxLuminance = 500.f,
+                                     .contentMaxLuminance = 4000.f,
+                                     .currentDisplayLuminance = 200.f};
+    // Both paths must agree whatever the transform, so keep XYZ equal to RGB.
+    const mat3 rgbToXyz;
+
+    std::vector<vec3> row;
+    for (float nits = 0.f; nits <= 10000.f; nits += 97.f) {
+        row.push_back(vec3(nits, nits * 0.5f, nits * 0.25f));
+    }
+
+    for (const auto [source, destination] :
+         {std::pair(Dataspace::BT2020_ITU_PQ, Dataspace::DISPLAY_P3),
+          std::pair(Dataspace::BT2020_ITU_PQ, Dataspace::BT2020_ITU_HLG),
+          std::pair(Dataspace::BT2020_ITU_HLG, Dataspace::DISPLAY_P3),
+          std::pair(Dataspace::BT2020_ITU_HLG, Dataspace::BT2020_ITU_PQ),
+          std::pair(Dataspace::DISPLAY_P3, Dataspace::SRGB)}) {
+        std::vector<tonemap::Color> colors;
+        for (const auto& linearRGB : row) {
+            colors.push_back({.linearRGB = linearRGB, .xyz = rgbToXyz * linearRGB});
+        }
+        const auto gains =
+                tonemap::getToneMapper()->lookupTonemapGain(source, destination, colors, metadata);
+
+        std::vector<vec3> tonemapped = row;
+        tonemap::getToneMapper()->tonemapLinearRGB(source, destination, tonemapped.data(),
+                                                   tonemapped.size(), rgbToXyz, metadata);
+
+        for (size_t i = 0; i < row.size(); i++) {
+            const vec3 expected = row[i] * static_cast<float>(gains[i]);
+            EXPECT_NEAR(expected.r, tonemapped[i].r, 1e-3f * std::max(1.f, expected.r));
+            EXPECT_NEAR(expected.g, tonemapped[i].g, 1e-3f * std::max(1.f, expected.g));
+            EXPECT_NEAR(expected.b, tonemapped[i].b, 1e-3f * std::max(1.f, expected.b));
+        }
+    }
+}
+
 } // namespace android
@@ -436,7 +436,7 @@ public:
 
 class ToneMapper13 : public ToneMapper {
 private:
-    double OETF_ST2084(double nits) {
+    static double OETF_ST2084(double nits) {
         nits = nits / 10000.0;
         double m1 = (2610.0 / 4096.0) / 4.0;
         double m2 = (2523.0 / 4096.0) * 128.0;
@@ -630,106 +630,179 @@ public:
             aidl::android::hardware::graphics::common::Dataspace sourceDataspace,
             aidl::android::hardware::graphics::common::Dataspace destinationDataspace,
             const std::vector<Color>& colors, const Metadata& metadata) override {
+        const Curve curve(sourceDataspace, destinationDataspace, metadata);
+
         std::vector<Gain> gains;
         gains.reserve(colors.size());
-
-        // Precompute constants for HDR->SDR tonemapping parameters
-        constexpr double maxInLumi = 4000;
-        const double maxOutLumi = metadata.displayMaxLuminance;
-
-        const double x1 = maxOutLumi * 0.65;
-        const double y1 = x1;
-
-        const double x3 = maxInLumi;
-        const double y3 = maxOutLumi;
-
-        const double x2 = x1 + (x3 - x1) * 4.0 / 17.0;
-        const double y2 = maxOutLumi * 0.9;
-
-        const double greyNorm1 = OETF_ST2084(x1);
-        const double greyNorm2 = OETF_ST2084(x2);
-        const double greyNorm3 = OETF_ST2084(x3);
-
-        const double slope2 = (y2 - y1) / (greyNorm2 - greyNorm1);
-        const double slope3 = (y3 - y2) / (greyNorm3 - greyNorm2);
-
-        const double hlgGamma = computeHlgGamma(metadata.currentDisplayLuminance);
-
         for (const auto [linearRGB, _] : colors) {
-            double maxRGB = std::max({linearRGB.r, linearRGB.g, linearRGB.b});
-
-            if (maxRGB <= 0.0) {
-                gains.push_back(1.0);
-                continue;
-            }
+            const double maxRGB = std::max({linearRGB.r, linearRGB.g, linearRGB.b});
+            gains.push_back(maxRGB <= 0.0 ? 1.0 : curve.targetNits(maxRGB) / maxRGB);
+        }
+        return gains;
+    }
 
-            const int32_t sourceDataspaceInt = static_cast<int32_t>(sourceDataspace);
-            const int32_t destinationDataspaceInt = static_cast<int32_t>(destinationDataspace);
+    void tonemapLinearRGB(aidl::android::hardware::graphics::common::Dataspace sourceDataspace,
+                          aidl::android::hardware::graphics::common::Dataspace destinationDataspace,
+                          vec3* linearRGB, size_t count, const mat3& /* rgbToXyz */,
+                          const Metadata& metadata) override {
+        const Curve curve(sourceDataspace, destinationDataspace, metadata);
+        switch (curve.mode) {
+            case Curve::Mode::Identity:
+                return;
+            case Curve::Mode::PqToHlg:
+                return applyGain(linearRGB, count, [&](double maxRGB) {
+                    return curve.pqToHlg(maxRGB);
+                });
+            case Curve::Mode::PqToSdr:
+                return applyGain(linearRGB, count, [&](double maxRGB) {
+                    return curve.pqToSdr(maxRGB);
+                });
+            case Curve::Mode::HlgToPq:
+                return applyGain(linearRGB, count, [&](double maxRGB) {
+                    return curve.hlgToPq(maxRGB);
+                });
+            case Curve::Mode::HlgToSdr:
+                return applyGain(linearRGB, count, [&](double maxRGB) {
+                    return curve.hlgToSdr(maxRGB);
+                });
+        }
+    }
 
-            double targetNits = 0.0;
-            switch (sourceDataspaceInt & kTransferMask) {
+private:
+    // The tonemapping curve from one dataspace to another. The curve is selected and its
+    // constants are computed once, rather than for every color.
+    struct Curve {
+        enum class Mode { Identity, PqToHlg, PqToSdr, HlgToPq, HlgToSdr };
+
+        Curve(aidl::android::hardware::graphics::common::Dataspace sourceDataspace,
+              aidl::android::hardware::graphics::common::Dataspace destinationDataspace,
+              const Metadata& metadata)
+              : maxOutLumi(metadata.displayMaxLuminance),
+                x1(maxOutLumi * 0.65),
+                y1(x1),
+                x2(x1 + (kMaxInLumi - x1) * 4.0 / 17.0),
+                y2(maxOutLumi * 0.9),
+                greyNorm1(OETF_ST2084(x1)),
+                greyNorm2(OETF_ST2084(x2)),
+                greyNorm3(OETF_ST2084(kMaxInLumi)),
+                slope2((y2 - y1) / (greyNorm2 - greyNorm1)),
+                slope3((maxOutLumi - y2) / (greyNorm3 - greyNorm2)),
+                hlgGamma(computeHlgGamma(metadata.currentDisplayLuminance)) {
+            const int32_t sourceTransfer = static_cast<int32_t>(sourceDataspace) & kTransferMask;
+            const int32_t destinationTransfer =
+                    static_cast<int32_t>(destinationDataspace) & kTransferMask;
+            switch (sourceTransfer) {
                 case kTransferST2084:
-                    switch (destinationDataspaceInt & kTransferMask) {
-                        case kTransferST2084:
-                            targetNits = maxRGB;
-                            break;
-                        case kTransferHLG:
-                            // PQ has a wider luminance range (10,000 nits vs. 1,000 nits) than HLG,
-                            // so we'll clamp the luminance range in case we're mapping from PQ
-                            // input to HLG output.
-                            targetNits = std::clamp(maxRGB, 0.0, 1000.0);
-                            targetNits *= pow(targetNits / 1000.0, (1 - hlgGamma) / (hlgGamma));
-                            break;
-                        default:
-                            targetNits = maxRGB;
-                            if (targetNits < x1) {
-                                break;
-                            }
-
-                            if (targetNits > maxInLumi) {
-                                targetNits = maxOutLumi;
-                                break;
-                            }
-
-                            const double greyNits = OETF_ST2084(targetNits);
-
-                            if (greyNits <= greyNorm2) {
-                                targetNits = (greyNits - greyNorm2) * slope2 + y2;
-                            } else if (greyNits <= greyNorm3) {
-                                targetNits = (greyNits - greyNorm3) * slope3 + y3;
-                            } else {
-                                targetNits = maxOutLumi;
-                            }
-                            break;
-                    }
+                    mode = destinationTransfer == kTransferST2084 ? Mode::Identity
+                            : destinationTransfer == kTransferHLG ? Mode::PqToHlg
+                                                                  : Mode::PqToSdr;
                     break;
                 case kTransferHLG:
-                    switch (destinationDataspaceInt & kTransferMask) {
-                        case kTransferST2084:
-                            targetNits = maxRGB * pow(maxRGB / 1000.0, hlgGamma - 1);
-                            break;
-                        case kTransferHLG:
-                            targetNits = maxRGB;
-                            break;
-                        default:
-                            targetNits = maxRGB * pow(maxRGB / 1000.0, hlgGamma - 1) *
-                                    metadata.displayMaxLuminance / 1000.0;
-                            break;
-                    }
+                    mode = destinationTransfer == kTransferST2084 ? Mode::HlgToPq
+                            : destinationTransfer == kTransferHLG ? Mode::Identity
+                                                                  : Mode::HlgToSdr;
                     break;
                 default:
-                    targetNits = maxRGB;
+                    mode = Mode::Identity;
                     break;
             }
+        }
+
+        double targetNits(double maxRGB) const {
+            switch (mode) {
+                case Mode::Identity:
+                    return maxRGB;
+                case Mode::PqToHlg:
+                    return pqToHlg(maxRGB);
+                case Mode::PqToSdr:
+                    return pqToSdr(maxRGB);
+                case Mode::HlgToPq:
+                    return hlgToPq(maxRGB);
+                case Mode::HlgToSdr:
+                    return hlgToSdr(maxRGB);
+            }
+        }
 
-            gains.push_back(targetNits / maxRGB);
+        double pqToHlg(double maxRGB) const {
+            // PQ has a wider luminance range (10,000 nits vs. 1,000 nits) than HLG, so we'll
+            // clamp the luminance range in case we're mapping from PQ input to HLG output.
+            const double targetNits = std::clamp(maxRGB, 0.0, 1000.0);
+            return targetNits * pow(targetNits / 1000.0, (1 - hlgGamma) / (hlgGamma));
+        }
+
+        double pqToSdr(double maxRGB) const {
+            if (maxRGB < x1) {
+                return maxRGB;
+            }
+            if (maxRGB > kMaxInLumi) {
+                return maxOutLumi;
+            }
+
+            const double greyNits = OETF_ST2084(maxRGB);
+            if (greyNits <= greyNorm2) {
+                return (greyNits - greyNorm2) * slope2 + y2;
+            } else if (greyNits <= greyNorm3) {
+                return (greyNits - greyNorm3) * slope3 + maxOutLumi;
+            }
+            return maxOutLumi;
+        }
+
+        double hlgToPq(double maxRGB) const { return maxRGB * pow(maxRGB / 1000.0, hlgGamma - 1); }
+
+        double hlgToSdr(double maxRGB) const { return hlgToPq(maxRGB) * maxOutLumi / 1000.0; }
+
+        // Precomputed constants for HDR->SDR tonemapping parameters
+        static constexpr double kMaxInLumi = 4000;
+        const double maxOutLumi;
+        const double x1;
+        const double y1;
+        const double x2;
+        const double y2;
+        const double greyNorm1;
+        const double greyNorm2;
+        const double greyNorm3;
+        const double slope2;
+        const double slope3;
+        const double hlgGamma;
+        Mode mode;
+    };
+
+    template <typename TargetNits>
+    static void applyGain(vec3* linearRGB, size_t count, TargetNits targetNits) {
+        for (size_t i = 0; i < count; i++) {
+            vec3& color = linearRGB[i];
+            const float maxRGB = std::max({color.r, color.g, color.b});
+            if (maxRGB > 0.f) {
+                color *= static_cast<float>(targetNits(maxRGB) / maxRGB);
+            }
         }
-        return gains;
     }
 };
 
 } // namespace
 
+void ToneMapper::tonemapLinearRGB(
+        aidl::android::hardware::graphics::common::Dataspace sourceDataspace,
+        aidl::android::hardware::graphics::common::Dataspace destinationDataspace, vec3* linearRGB,
+        size_t count, const mat3& rgbToXyz, const Metadata& metadata) {
+    // Bounds the memory used for the colors and gains, however long the row is.
+    constexpr size_t kChunkSize = 256;
+    std::vector<Color> colors;
+    colors.reserve(std::min(count, kChunkSize));
+    for (size_t start = 0; start < count; start += kChunkSize) {
+        const size_t end = std::min(count, start + kChunkSize);
+        colors.clear();
+        for (size_t i = start; i < end; i++) {
+            colors.push_back({.linearRGB = linearRGB[i], .xyz = rgbToXyz * linearRGB[i]});
+        }
+        const std::vector<Gain> gains =
+                lookupTonemapGain(sourceDataspace, destinationDataspace, colors, metadata);
+        for (size_t i = start; i < end; i++) {
+            linearRGB[i] *= static_cast<float>(gains[i - start]);
+        }
+    }
+}
+
 ToneMapper* getToneMapper() {
     static std::once_flag sOnce;
     static std::unique_ptr<ToneMapper> sToneMapper;
@@ -95,67 +95,24 @@ static uint32_t system_property_serial(const prop_info* pi [[maybe_unused]]) {
   return last_prefer_seq_num;
 }
 
+// The categories, indexed by the bit position of their TRACE_CATEGORY_* tag. FRAMEWORK_CATEGORIES
+// lists them in tag order, so the table is built at compile time and a lookup is a single load.
+#define TO_CATEGORY_POINTER(name, str, desc) &name,
+struct PerfettoTeCategory* const kCategories[] = {FRAMEWORK_CATEGORIES(TO_CATEGORY_POINTER)};
+#undef TO_CATEGORY_POINTER
+
+constexpr size_t kCategoryCount = sizeof(kCategories) / sizeof(kCategories[0]);
+static_assert(TRACE_CATEGORY_ALWAYS == 1 << 0);
+static_assert(TRACE_CATEGORY_THERMAL == 1 << (kCategoryCount - 1),
+              "FRAMEWORK_CATEGORIES is out of sync with trace_categories.h");
+
 struct PerfettoTeCategory* toCategory(uint64_t inCategory) {
-  switch (inCategory) {
-    case TRACE_CATEGORY_ALWAYS:
-      return &always;
-    case TRACE_CATEGORY_GRAPHICS:
-      return &graphics;
-    case TRACE_CATEGORY_INPUT:
-      return &input;
-    case TRACE_CATEGORY_VIEW:
-      return &view;
-    case TRACE_CATEGORY_WEBVIEW:
-      return &webview;
-    case TRACE_CATEGORY_WINDOW_MANAGER:
-      return &windowmanager;
-    case TRACE_CATEGORY_ACTIVITY_MANAGER:
-      return &activitymanager;
-    case TRACE_CATEGORY_SYNC_MANAGER:
-      return &syncmanager;
-    case TRACE_CATEGORY_AUDIO:
-      return &audio;
-    case TRACE_CATEGORY_VIDEO:
-      return &video;
-    case TRACE_CATEGORY_CAMERA:
-      return &camera;
-    case TRACE_CATEGORY_HAL:
-      return &hal;
-    case TRACE_CATEGORY_APP:
-      return &app;
-    case TRACE_CATEGORY_RESOURCES:
-      return &resources;
-    case TRACE_CATEGORY_DALVIK:
-      return &dalvik;
-    case TRACE_CATEGORY_RS:
-      return &rs;
-    case TRACE_CATEGORY_BIONIC:
-      return &bionic;
-    case TRACE_CATEGORY_POWER:
-      return &power;
-    case TRACE_CATEGORY_PACKAGE_MANAGER:
-      return &packagemanager;
-    case TRACE_CATEGORY_SYSTEM_SERVER:
-      return &systemserver;
-    case TRACE_CATEGORY_DATABASE:
-      return &database;
-    case TRACE_CATEGORY_NETWORK:
-      return &network;
-    case TRACE_CATEGORY_ADB:
-      return &adb;
-    case TRACE_CATEGORY_VIBRATOR:
-      return &vibrator;
-    case TRACE_CATEGORY_AIDL:
-      return &aidl;
-    case TRACE_CATEGORY_NNAPI:
-      return &nnapi;
-    case TRACE_CATEGORY_RRO:
-      return &rro;
-    case TRACE_CATEGORY_THERMAL:
-      return &thermal;
-    default:
-      return nullptr;
+  // Tags are single bits. Anything else, e.g. a mask of several tags, has no category.
+  if (PERFETTO_UNLIKELY(inCategory == 0 || (inCategory & (inCategory - 1)) != 0)) {
+    return nullptr;
   }
+  const size_t index = static_cast<size_t>(__builtin_ctzll(inCategory));
+  return index < kCategoryCount ? kCategories[index] : nullptr;
 }
 
 }  // namespace
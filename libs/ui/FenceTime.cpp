@@ -21,6 +21,7 @@
 #include <cutils/compiler.h>  // For CC_[UN]LIKELY
 #include <utils/Log.h>
 #include <inttypes.h>
+#include <poll.h>
 #include <stdlib.h>
 
 #include <memory>
@@ -301,23 +302,61 @@ void FenceTimeline::push(const std::shared_ptr<FenceTime>& fence) {
             // we are removing it from the timeline.
             front->getSignalTime();
         }
-        mQueue.pop();
+        mQueue.pop_front();
     }
-    mQueue.push(fence);
+    mQueue.push_back(fence);
 }
 
 void FenceTimeline::updateSignalTimes() {
     std::lock_guard<std::mutex> lock(mMutex);
+
+    // Poll the fences that are still pending all at once, so that only the
+    // ones that are ready need the more expensive sync_file_info query.
+    mPendingFences.clear();
+    mPolledFences.clear();
+    mPollFds.clear();
+    for (const std::weak_ptr<FenceTime>& weakFence : mQueue) {
+        std::shared_ptr<FenceTime> fence = weakFence.lock();
+        if (!fence || fence->getCachedSignalTime() != Fence::SIGNAL_TIME_PENDING) {
+            continue;
+        }
+        const FenceTime::Snapshot snapshot = fence->getSnapshot();
+        // poll ignores negative fds, like those of test fences, which are
+        // queried unconditionally below.
+        const int fd = snapshot.state == FenceTime::Snapshot::State::FENCE
+                ? snapshot.fence->get() : -1;
+        mPendingFences.push_back(std::move(fence));
+        mPolledFences.push_back(snapshot.fence);
+        mPollFds.push_back({.fd = fd, .events = POLLIN, .revents = 0});
+    }
+    if (!mPollFds.empty() &&
+            poll(mPollFds.data(), mPollFds.size(), /*timeout=*/0) < 0) {
+        // Fall back to querying every fence.
+        for (pollfd& pollFd : mPollFds) {
+            pollFd.fd = -1;
+        }
+    }
+
+    size_t pendingIndex = 0;
     while (!mQueue.empty()) {
         std::shared_ptr<FenceTime> fence = mQueue.front().lock();
         if (!fence) {
             // The shared_ptr no longer exists and no one cares about the
             // timestamp anymore.
-            mQueue.pop();
+            mQueue.pop_front();
             continue;
-        } else if (fence->getSignalTime() != Fence::SIGNAL_TIME_PENDING) {
+        }
+        // The fences that are polled appear in the same order as in mQueue.
+        bool mayHaveSignaled = true;
+        if (pendingIndex < mPendingFences.size() &&
+                mPendingFences[pendingIndex] == fence) {
+            const pollfd& pollFd = mPollFds[pendingIndex++];
+            mayHaveSignaled = pollFd.fd < 0 || pollFd.revents != 0;
+        }
+        if (mayHaveSignaled &&
+                fence->getSignalTime() != Fence::SIGNAL_TIME_PENDING) {
             // The fence has signaled and we've removed the sp<Fence> ref.
-            mQueue.pop();
+            mQueue.pop_front();
             continue;
         } else {
             // The fence didn't signal yet. Break since the later ones
@@ -325,6 +364,8 @@ void FenceTimeline::updateSignalTimes() {
             break;
         }
     }
+    mPendingFences.clear();
+    mPolledFences.clear();
 }
 
 // ============================================================================
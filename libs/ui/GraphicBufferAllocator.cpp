@@ -35,6 +35,7 @@
 #include <ui/Gralloc3.h>
 #include <ui/Gralloc4.h>
 #include <ui/Gralloc5.h>
+#include <ui/GraphicBuffer.h>
 #include <ui/GraphicBufferMapper.h>
 
 namespace android {
@@ -104,6 +105,23 @@ void GraphicBufferAllocator::dump(std::string& result, bool less) const {
     StringAppendF(&result, "Total allocated by GraphicBufferAllocator (estimate): %.2f KB\n",
                   static_cast<double>(total) / 1024.0);
 
+    if (mPoolBudget > 0 || !mPool.empty()) {
+        StringAppendF(&result,
+                      "Recycle pool: %zu buffers, %.2f KiB of %.2f KiB, %" PRIu64 " hits, %" PRIu64
+                      " misses\n",
+                      mPool.size(), static_cast<double>(mPoolSize) / 1024.0,
+                      static_cast<double>(mPoolBudget) / 1024.0, mPoolHits, mPoolMisses);
+    }
+    result.append("Allocation latency:");
+    for (size_t i = 0; i < kLatencyBuckets; i++) {
+        if (i + 1 < kLatencyBuckets) {
+            StringAppendF(&result, " <%dms: %" PRIu64, 1 << i, mAllocationLatencies[i]);
+        } else {
+            StringAppendF(&result, " >=%dms: %" PRIu64, 1 << (i - 1), mAllocationLatencies[i]);
+        }
+    }
+    result.append("\n");
+
     result.append(mAllocator->dumpDebugInfo(less));
 }
 
@@ -134,6 +152,15 @@ auto GraphicBufferAllocator::allocate(const AllocationRequest& request) -> Alloc
         return AllocationResult(BAD_VALUE);
     }
 
+    if (request.importBuffer && request.extras.empty()) {
+        AllocationResult pooled(OK);
+        if (takePooledBuffer(width, height, request.format, request.layerCount, request.usage,
+                             request.requestorName, &pooled.handle, &pooled.stride)) {
+            return pooled;
+        }
+    }
+
+    const nsecs_t startTime = systemTime();
     auto result = mAllocator->allocate(request);
     if (result.status == UNKNOWN_TRANSACTION) {
         if (!request.extras.empty()) {
@@ -147,6 +174,7 @@ auto GraphicBufferAllocator::allocate(const AllocationRequest& request) -> Alloc
                                              request.format, request.layerCount, request.usage,
                                              &result.stride, &result.handle, request.importBuffer);
     }
+    recordAllocationLatency(systemTime() - startTime);
 
     if (result.status != NO_ERROR) {
         ALOGE("Failed to allocate (%u x %u) layerCount %u format %d "
@@ -213,8 +241,15 @@ status_t GraphicBufferAllocator::allocateHelper(uint32_t width, uint32_t height,
     // TODO(b/72323293, b/72703005): Remove these invalid bits from callers
     usage &= ~static_cast<uint64_t>((1 << 10) | (1 << 13));
 
+    if (importBuffer &&
+        takePooledBuffer(width, height, format, layerCount, usage, requestorName, handle, stride)) {
+        return NO_ERROR;
+    }
+
+    const nsecs_t startTime = systemTime();
     status_t error = mAllocator->allocate(requestorName, width, height, format, layerCount, usage,
                                           stride, handle, importBuffer);
+    recordAllocationLatency(systemTime() - startTime);
     if (error != NO_ERROR) {
         ALOGE("Failed to allocate (%u x %u) layerCount %u format %d "
               "usage %" PRIx64 ": %d",
@@ -280,15 +315,118 @@ status_t GraphicBufferAllocator::free(buffer_handle_t handle)
 {
     ATRACE_CALL();
 
+    bool pooled = false;
+    std::vector<buffer_handle_t> trimmed;
+    {
+        Mutex::Autolock _l(sLock);
+        KeyedVector<buffer_handle_t, alloc_rec_t>& list(sAllocList);
+        const nsecs_t now = systemTime();
+        const ssize_t index = list.indexOfKey(handle);
+        if (index >= 0) {
+            const alloc_rec_t& rec = list.valueAt(index);
+            if (mPoolBudget > 0 && rec.size > 0 && rec.size <= mPoolBudget &&
+                !(rec.usage & GraphicBuffer::USAGE_PROTECTED)) {
+                mPool.push_back({handle, rec, now});
+                mPoolSize += rec.size;
+                pooled = true;
+            }
+            list.removeItemsAt(index);
+        }
+        trimRecyclePoolLocked(now, &trimmed);
+    }
+
     // We allocated a buffer from the allocator and imported it into the
     // mapper to get the handle.  We just need to free the handle now.
-    mMapper.freeBuffer(handle);
+    if (!pooled) {
+        mMapper.freeBuffer(handle);
+    }
+    for (buffer_handle_t trimmedHandle : trimmed) {
+        mMapper.freeBuffer(trimmedHandle);
+    }
+
+    return NO_ERROR;
+}
+
+void GraphicBufferAllocator::setRecyclePoolBudget(uint64_t budgetBytes,
+                                                  std::chrono::nanoseconds idleTimeout) {
+    std::vector<buffer_handle_t> trimmed;
+    {
+        Mutex::Autolock _l(sLock);
+        mPoolBudget = budgetBytes;
+        mPoolIdleTimeout = idleTimeout.count();
+        trimRecyclePoolLocked(systemTime(), &trimmed);
+    }
+    for (buffer_handle_t handle : trimmed) {
+        mMapper.freeBuffer(handle);
+    }
+}
 
+void GraphicBufferAllocator::trimRecyclePool() {
+    std::vector<buffer_handle_t> trimmed;
+    {
+        Mutex::Autolock _l(sLock);
+        for (const pooled_buffer_t& buffer : mPool) {
+            trimmed.push_back(buffer.handle);
+        }
+        mPool.clear();
+        mPoolSize = 0;
+    }
+    for (buffer_handle_t handle : trimmed) {
+        mMapper.freeBuffer(handle);
+    }
+}
+
+bool GraphicBufferAllocator::takePooledBuffer(uint32_t width, uint32_t height, PixelFormat format,
+                                              uint32_t layerCount, uint64_t usage,
+                                              const std::string& requestorName,
+                                              buffer_handle_t* handle, uint32_t* stride) {
     Mutex::Autolock _l(sLock);
-    KeyedVector<buffer_handle_t, alloc_rec_t>& list(sAllocList);
-    list.removeItem(handle);
+    if (mPoolBudget == 0 && mPool.empty()) {
+        return false;
+    }
 
-    return NO_ERROR;
+    // Prefer the most recently freed buffer, which is the most likely to still be cached.
+    for (auto it = mPool.rbegin(); it != mPool.rend(); ++it) {
+        const alloc_rec_t& rec = it->rec;
+        if (rec.width != width || rec.height != height || rec.format != format ||
+            rec.layerCount != layerCount || rec.usage != usage) {
+            continue;
+        }
+
+        *handle = it->handle;
+        *stride = rec.stride;
+        alloc_rec_t allocated = rec;
+        allocated.requestorName = requestorName;
+        sAllocList.add(*handle, allocated);
+
+        mPoolSize -= rec.size;
+        mPool.erase(std::next(it).base());
+        mPoolHits++;
+        return true;
+    }
+
+    mPoolMisses++;
+    return false;
+}
+
+void GraphicBufferAllocator::trimRecyclePoolLocked(nsecs_t now,
+                                                   std::vector<buffer_handle_t>* trimmed) {
+    while (!mPool.empty() &&
+           (mPoolSize > mPoolBudget || now - mPool.front().freeTime >= mPoolIdleTimeout)) {
+        trimmed->push_back(mPool.front().handle);
+        mPoolSize -= mPool.front().rec.size;
+        mPool.pop_front();
+    }
+}
+
+void GraphicBufferAllocator::recordAllocationLatency(nsecs_t latency) {
+    size_t bucket = 0;
+    while (bucket + 1 < kLatencyBuckets && latency >= ms2ns(1 << bucket)) {
+        bucket++;
+    }
+
+    Mutex::Autolock _l(sLock);
+    mAllocationLatencies[bucket]++;
 }
 
 bool GraphicBufferAllocator::supportsAdditionalOptions() const {
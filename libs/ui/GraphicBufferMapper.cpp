@@ -21,6 +21,8 @@
 #include <ui/GraphicBufferMapper.h>
 
 #include <grallocusage/GrallocUsageConversion.h>
+#include <inttypes.h>
+#include <sys/stat.h>
 
 // We would eliminate the non-conforming zero-length array, but we can't since
 // this is effectively included from the Linux kernel
@@ -46,6 +48,30 @@ using unique_fd = ::android::base::unique_fd;
 namespace android {
 // ---------------------------------------------------------------------------
 
+namespace {
+
+// Identifies the files behind the fds of a handle, which, unlike the fds themselves, are the same
+// in every handle of a buffer.
+bool getHandleFiles(const native_handle_t* handle, std::vector<std::pair<dev_t, ino_t>>* outFiles) {
+    outFiles->clear();
+    outFiles->reserve(handle->numFds);
+    for (int i = 0; i < handle->numFds; i++) {
+        struct stat st;
+        if (fstat(handle->data[i], &st) != 0) {
+            return false;
+        }
+        outFiles->emplace_back(st.st_dev, st.st_ino);
+    }
+    return true;
+}
+
+std::vector<int> getHandleInts(const native_handle_t* handle) {
+    return std::vector<int>(handle->data + handle->numFds,
+                            handle->data + handle->numFds + handle->numInts);
+}
+
+} // namespace
+
 using LockResult = GraphicBufferMapper::LockResult;
 
 ANDROID_SINGLETON_STATIC_INSTANCE( GraphicBufferMapper )
@@ -119,6 +145,72 @@ status_t GraphicBufferMapper::importBuffer(const native_handle_t* rawHandle, uin
     return NO_ERROR;
 }
 
+status_t GraphicBufferMapper::importBufferCached(uint64_t bufferId, uint32_t generationNumber,
+                                                 const native_handle_t* rawHandle, uint32_t width,
+                                                 uint32_t height, uint32_t layerCount,
+                                                 PixelFormat format, uint64_t usage,
+                                                 uint32_t stride, buffer_handle_t* outHandle) {
+    if (!mImportCacheEnabled.load(std::memory_order_relaxed)) {
+        return importBuffer(rawHandle, width, height, layerCount, format, usage, stride,
+                            outHandle);
+    }
+    ATRACE_CALL();
+
+    // The id and generation number come from the sender, so they are only trusted to find the
+    // cached handle: rawHandle must also refer to the same files, with the same ints.
+    std::vector<std::pair<dev_t, ino_t>> files;
+    if (!getHandleFiles(rawHandle, &files)) {
+        return importBuffer(rawHandle, width, height, layerCount, format, usage, stride,
+                            outHandle);
+    }
+    std::vector<int> ints = getHandleInts(rawHandle);
+    const ImportCacheKey key{bufferId, generationNumber};
+
+    bool cacheable = true;
+    {
+        std::lock_guard lock(mImportCacheMutex);
+        if (auto it = mCachedImports.find(key); it != mCachedImports.end()) {
+            CachedImport& cached = it->second;
+            if (cached.files == files && cached.ints == ints) {
+                status_t error = mMapper->validateBufferSize(cached.handle, width, height, format,
+                                                             layerCount, usage, stride);
+                if (error != NO_ERROR) {
+                    ALOGE("validateBufferSize(%p) failed: %d", rawHandle, error);
+                    return error;
+                }
+                cached.refCount++;
+                *outHandle = cached.handle;
+                return NO_ERROR;
+            }
+            ALOGW("importBufferCached(%p): handle does not match buffer %" PRIu64 ", not cached",
+                  rawHandle, bufferId);
+            cacheable = false;
+        }
+    }
+
+    // Imported without the lock, since importBuffer frees the handle if it fails validation.
+    buffer_handle_t bufferHandle;
+    status_t error = importBuffer(rawHandle, width, height, layerCount, format, usage, stride,
+                                  &bufferHandle);
+    if (error != NO_ERROR) {
+        return error;
+    }
+    std::lock_guard lock(mImportCacheMutex);
+    // If another import of the buffer raced with this one, this handle just isn't cached.
+    if (cacheable && mCachedImports.count(key) == 0) {
+        mCachedImports.emplace(key,
+                               CachedImport{bufferHandle, std::move(files), std::move(ints), 1});
+        mCachedImportKeys.emplace(bufferHandle, key);
+        mCachedImportCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    *outHandle = bufferHandle;
+    return NO_ERROR;
+}
+
+void GraphicBufferMapper::setImportCacheEnabled(bool enabled) {
+    mImportCacheEnabled.store(enabled, std::memory_order_relaxed);
+}
+
 status_t GraphicBufferMapper::importBufferNoValidate(const native_handle_t* rawHandle,
                                                      buffer_handle_t* outHandle) {
     return mMapper->importBuffer(rawHandle, outHandle);
@@ -134,6 +226,19 @@ status_t GraphicBufferMapper::freeBuffer(buffer_handle_t handle)
 {
     ATRACE_CALL();
 
+    if (mCachedImportCount.load(std::memory_order_relaxed) != 0) {
+        std::lock_guard lock(mImportCacheMutex);
+        if (auto keyIt = mCachedImportKeys.find(handle); keyIt != mCachedImportKeys.end()) {
+            auto it = mCachedImports.find(keyIt->second);
+            if (--it->second.refCount != 0) {
+                return NO_ERROR;
+            }
+            mCachedImports.erase(it);
+            mCachedImportKeys.erase(keyIt);
+            mCachedImportCount.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
     mMapper->freeBuffer(handle);
 
     return NO_ERROR;
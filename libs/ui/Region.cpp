@@ -19,6 +19,8 @@
 #include <inttypes.h>
 #include <limits.h>
 
+#include <algorithm>
+
 #include <android-base/stringprintf.h>
 
 #include <utils/Log.h>
@@ -57,6 +59,103 @@ enum {
     op_xor  = region_operator<Rect>::op_xor
 };
 
+// Computes an operation between two rectangles when the result is a single rectangle or
+// empty, which is the common case for layers and their coverage. Returns false when the
+// result needs more than one rectangle, in which case the spans have to be walked.
+static bool rectOperation(uint32_t op, const Rect& lhs, const Rect& rhs, Rect* result) {
+    if (!lhs.isValid() || !rhs.isValid()) {
+        return false;
+    }
+    // The rasterizer's representation of an empty region.
+    const Rect empty(0, 0);
+    const bool lhsEmpty = lhs.isEmpty();
+    const bool rhsEmpty = rhs.isEmpty();
+    Rect intersection;
+    const bool intersects = !lhsEmpty && !rhsEmpty && lhs.intersect(rhs, &intersection);
+    switch (op) {
+        case op_and:
+            *result = intersects ? intersection : empty;
+            return true;
+        case op_or:
+            if (lhsEmpty && rhsEmpty) {
+                *result = empty;
+                return true;
+            }
+            if (rhsEmpty || (intersects && intersection == rhs)) {
+                *result = lhs;
+                return true;
+            }
+            if (lhsEmpty || (intersects && intersection == lhs)) {
+                *result = rhs;
+                return true;
+            }
+            // Rectangles which overlap or touch along a full side form a larger rectangle.
+            if (lhs.left == rhs.left && lhs.right == rhs.right && lhs.top <= rhs.bottom &&
+                rhs.top <= lhs.bottom) {
+                *result = Rect(lhs.left, std::min(lhs.top, rhs.top), lhs.right,
+                               std::max(lhs.bottom, rhs.bottom));
+                return true;
+            }
+            if (lhs.top == rhs.top && lhs.bottom == rhs.bottom && lhs.left <= rhs.right &&
+                rhs.left <= lhs.right) {
+                *result = Rect(std::min(lhs.left, rhs.left), lhs.top,
+                               std::max(lhs.right, rhs.right), lhs.bottom);
+                return true;
+            }
+            return false;
+        case op_nand:
+            if (lhsEmpty || (intersects && intersection == lhs)) {
+                *result = empty;
+                return true;
+            }
+            if (!intersects) {
+                *result = lhs;
+                return true;
+            }
+            // What remains is a single rectangle when rhs covers a full side of lhs.
+            if (intersection.left == lhs.left && intersection.right == lhs.right) {
+                if (intersection.top == lhs.top) {
+                    *result = Rect(lhs.left, intersection.bottom, lhs.right, lhs.bottom);
+                    return true;
+                }
+                if (intersection.bottom == lhs.bottom) {
+                    *result = Rect(lhs.left, lhs.top, lhs.right, intersection.top);
+                    return true;
+                }
+            }
+            if (intersection.top == lhs.top && intersection.bottom == lhs.bottom) {
+                if (intersection.left == lhs.left) {
+                    *result = Rect(intersection.right, lhs.top, lhs.right, lhs.bottom);
+                    return true;
+                }
+                if (intersection.right == lhs.right) {
+                    *result = Rect(lhs.left, lhs.top, intersection.left, lhs.bottom);
+                    return true;
+                }
+            }
+            return false;
+        default:
+            return false;
+    }
+}
+
+// Intersecting and subtracting regions whose bounds do not overlap does not need the spans.
+static bool disjointOperation(uint32_t op, Region& dst, const Region& lhs, const Rect& rhsBounds) {
+    if (op != op_and && op != op_nand) {
+        return false;
+    }
+    Rect intersection;
+    if (lhs.getBounds().intersect(rhsBounds, &intersection)) {
+        return false;
+    }
+    if (op == op_and || lhs.isEmpty()) {
+        dst.clear();
+    } else {
+        dst = lhs;
+    }
+    return true;
+}
+
 enum {
     direction_LTR,
     direction_RTL
@@ -251,8 +350,9 @@ bool Region::contains(const Point& point) const {
 bool Region::contains(int x, int y) const {
     const_iterator cur = begin();
     const_iterator const tail = end();
-    while (cur != tail) {
-        if (y >= cur->top && y < cur->bottom && x >= cur->left && x < cur->right) {
+    // The rects are sorted by band from top to bottom, so stop at the first band below y.
+    while (cur != tail && y >= cur->top) {
+        if (y < cur->bottom && x >= cur->left && x < cur->right) {
             return true;
         }
         cur++;
@@ -653,6 +753,24 @@ void Region::boolean_operation(uint32_t op, Region& dst,
     validate(dst, "boolean_operation (before): dst");
 #endif
 
+#if !VALIDATE_WITH_CORECG && !defined(VALIDATE_REGIONS)
+    if (lhs.isRect() && rhs.isRect()) {
+        Rect rhsRect = rhs.getBounds();
+        rhsRect.offsetBy(dx, dy);
+        Rect result;
+        if (rectOperation(op, lhs.getBounds(), rhsRect, &result)) {
+            dst.mStorage.clear();
+            dst.mStorage.push_back(result);
+            return;
+        }
+    }
+    Rect rhsBounds = rhs.getBounds();
+    rhsBounds.offsetBy(dx, dy);
+    if (disjointOperation(op, dst, lhs, rhsBounds)) {
+        return;
+    }
+#endif
+
     size_t lhs_count;
     Rect const * const lhs_rects = lhs.getArray(&lhs_count);
 
@@ -767,6 +885,22 @@ void Region::boolean_operation(uint32_t op, Region& dst,
 #if VALIDATE_WITH_CORECG || defined(VALIDATE_REGIONS)
     boolean_operation(op, dst, lhs, Region(rhs), dx, dy);
 #else
+    if (lhs.isRect()) {
+        Rect rhsRect = rhs;
+        rhsRect.offsetBy(dx, dy);
+        Rect result;
+        if (rectOperation(op, lhs.getBounds(), rhsRect, &result)) {
+            dst.mStorage.clear();
+            dst.mStorage.push_back(result);
+            return;
+        }
+    }
+    Rect rhsBounds = rhs;
+    rhsBounds.offsetBy(dx, dy);
+    if (disjointOperation(op, dst, lhs, rhsBounds)) {
+        return;
+    }
+
     size_t lhs_count;
     Rect const * const lhs_rects = lhs.getArray(&lhs_count);
 
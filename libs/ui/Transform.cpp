@@ -258,42 +258,55 @@ Rect Transform::makeBounds(int w, int h) const {
 }
 
 Rect Transform::transform(const Rect& bounds, bool roundOutwards) const {
-    Rect r;
-    vec2 lt( bounds.left,  bounds.top    );
-    vec2 rt( bounds.right, bounds.top    );
-    vec2 lb( bounds.left,  bounds.bottom );
-    vec2 rb( bounds.right, bounds.bottom );
+    // Translating by whole pixels only offsets the rect. The coordinates are bounded so that the
+    // float path below would be exact, and hence give the same result.
+    if (type() <= TRANSLATE && bounds.isValid()) {
+        constexpr int32_t kMaxExact = 1 << 23;
+        const float tx = mMatrix[2][0];
+        const float ty = mMatrix[2][1];
+        if (fabsf(tx) <= kMaxExact && fabsf(ty) <= kMaxExact &&
+            tx == static_cast<float>(static_cast<int32_t>(tx)) &&
+            ty == static_cast<float>(static_cast<int32_t>(ty)) && bounds.left >= -kMaxExact &&
+            bounds.top >= -kMaxExact && bounds.right <= kMaxExact && bounds.bottom <= kMaxExact) {
+            Rect r(bounds);
+            r.offsetBy(static_cast<int32_t>(tx), static_cast<int32_t>(ty));
+            return r;
+        }
+    }
 
-    lt = transform(lt);
-    rt = transform(rt);
-    lb = transform(lb);
-    rb = transform(rb);
+    const FloatRect f = transform(bounds.toFloatRect());
 
+    Rect r;
     if (roundOutwards) {
-        r.left   = static_cast<int32_t>(floorf(std::min({lt[0], rt[0], lb[0], rb[0]})));
-        r.top    = static_cast<int32_t>(floorf(std::min({lt[1], rt[1], lb[1], rb[1]})));
-        r.right  = static_cast<int32_t>(ceilf(std::max({lt[0], rt[0], lb[0], rb[0]})));
-        r.bottom = static_cast<int32_t>(ceilf(std::max({lt[1], rt[1], lb[1], rb[1]})));
+        r.left   = static_cast<int32_t>(floorf(f.left));
+        r.top    = static_cast<int32_t>(floorf(f.top));
+        r.right  = static_cast<int32_t>(ceilf(f.right));
+        r.bottom = static_cast<int32_t>(ceilf(f.bottom));
     } else {
-        r.left   = static_cast<int32_t>(floorf(std::min({lt[0], rt[0], lb[0], rb[0]}) + 0.5f));
-        r.top    = static_cast<int32_t>(floorf(std::min({lt[1], rt[1], lb[1], rb[1]}) + 0.5f));
-        r.right  = static_cast<int32_t>(floorf(std::max({lt[0], rt[0], lb[0], rb[0]}) + 0.5f));
-        r.bottom = static_cast<int32_t>(floorf(std::max({lt[1], rt[1], lb[1], rb[1]}) + 0.5f));
+        r.left   = static_cast<int32_t>(floorf(f.left + 0.5f));
+        r.top    = static_cast<int32_t>(floorf(f.top + 0.5f));
+        r.right  = static_cast<int32_t>(floorf(f.right + 0.5f));
+        r.bottom = static_cast<int32_t>(floorf(f.bottom + 0.5f));
     }
 
     return r;
 }
 
 FloatRect Transform::transform(const FloatRect& bounds) const {
-    vec2 lt(bounds.left, bounds.top);
-    vec2 rt(bounds.right, bounds.top);
-    vec2 lb(bounds.left, bounds.bottom);
-    vec2 rb(bounds.right, bounds.bottom);
+    const vec2 lt = transform(vec2(bounds.left, bounds.top));
+    const vec2 rb = transform(vec2(bounds.right, bounds.bottom));
 
-    lt = transform(lt);
-    rt = transform(rt);
-    lb = transform(lb);
-    rb = transform(rb);
+    // Without skew or a rotation other than 90 degrees, each coordinate of the other two corners
+    // equals a coordinate of these two, so there is no need to transform them. Unlike
+    // preserveRects(), this checks for exact zeros, so that the result is the same either way.
+    const mat33& M(mMatrix);
+    if ((M[1][0] == 0.f && M[0][1] == 0.f) || (M[0][0] == 0.f && M[1][1] == 0.f)) {
+        return FloatRect(std::min(lt[0], rb[0]), std::min(lt[1], rb[1]), std::max(lt[0], rb[0]),
+                         std::max(lt[1], rb[1]));
+    }
+
+    const vec2 rt = transform(vec2(bounds.right, bounds.top));
+    const vec2 lb = transform(vec2(bounds.left, bounds.bottom));
 
     FloatRect r;
     r.left = std::min({lt[0], rt[0], lb[0], rb[0]});
@@ -319,6 +332,10 @@ Region Transform::transform(const Region& reg) const {
     } else {
         int xpos = static_cast<int>(floorf(tx() + 0.5f));
         int ypos = static_cast<int>(floorf(ty() + 0.5f));
+        if (xpos == 0 && ypos == 0) {
+            // Share the rects of reg rather than copying them.
+            return reg;
+        }
         out = reg.translate(xpos, ypos);
     }
     return out;
@@ -22,10 +22,14 @@
 #include <utils/Mutex.h>
 #include <utils/Timers.h>
 
+#include <poll.h>
+
 #include <atomic>
+#include <deque>
 #include <mutex>
 #include <queue>
 #include <unordered_map>
+#include <vector>
 
 namespace android {
 
@@ -158,6 +162,9 @@ using FenceTimePtr = std::shared_ptr<FenceTime>;
 // if FenceTimeline did nothing. i.e. they should eventually call
 // Fence::getSignalTime(), not only Fence::getCachedSignalTime().
 //
+// updateSignalTimes() polls all of the pending fences with a single syscall,
+// and only queries the signal time of the ones that are ready.
+//
 // push() and updateSignalTimes() are safe to call simultaneously from
 // different threads.
 class FenceTimeline {
@@ -169,7 +176,13 @@ public:
 
 private:
     mutable std::mutex mMutex;
-    std::queue<std::weak_ptr<FenceTime>> mQueue GUARDED_BY(mMutex);
+    std::deque<std::weak_ptr<FenceTime>> mQueue GUARDED_BY(mMutex);
+
+    // Scratch space for updateSignalTimes(), kept to reuse the allocations.
+    // The Fences are held so that their fds stay open while they are polled.
+    std::vector<std::shared_ptr<FenceTime>> mPendingFences GUARDED_BY(mMutex);
+    std::vector<sp<Fence>> mPolledFences GUARDED_BY(mMutex);
+    std::vector<pollfd> mPollFds GUARDED_BY(mMutex);
 };
 
 // Used by test code to create or get FenceTimes for a given Fence.
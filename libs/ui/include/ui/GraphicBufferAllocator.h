@@ -20,6 +20,9 @@
 
 #include <stdint.h>
 
+#include <array>
+#include <chrono>
+#include <deque>
 #include <memory>
 #include <string>
 #include <vector>
@@ -32,6 +35,7 @@
 #include <utils/KeyedVector.h>
 #include <utils/Mutex.h>
 #include <utils/Singleton.h>
+#include <utils/Timers.h>
 
 namespace android {
 
@@ -109,6 +113,23 @@ public:
 
     bool supportsAdditionalOptions() const;
 
+    /**
+     * Keeps up to budgetBytes of freed buffers for reuse by later allocations of the same width,
+     * height, format, layer count and usage, e.g. by BufferQueues of cameras, codecs and virtual
+     * displays that keep reallocating buffers of the same shape. Buffers that stay in the pool for
+     * longer than idleTimeout are freed on the next allocation or free.
+     *
+     * A budget of 0, the default, disables the pool and frees the buffers it holds.
+     *
+     * Recycled buffers keep the contents they were freed with. Protected buffers, and buffers
+     * allocated with additional options or without being imported, are never recycled.
+     */
+    void setRecyclePoolBudget(uint64_t budgetBytes,
+                              std::chrono::nanoseconds idleTimeout = std::chrono::seconds(5));
+
+    // Frees the buffers held in the recycle pool.
+    void trimRecyclePool();
+
 protected:
     struct alloc_rec_t {
         uint32_t width;
@@ -121,13 +142,41 @@ protected:
         std::string requestorName;
     };
 
+    struct pooled_buffer_t {
+        buffer_handle_t handle;
+        alloc_rec_t rec;
+        nsecs_t freeTime;
+    };
+
     status_t allocateHelper(uint32_t w, uint32_t h, PixelFormat format, uint32_t layerCount,
                             uint64_t usage, buffer_handle_t* handle, uint32_t* stride,
                             std::string requestorName, bool importBuffer);
 
+    // Takes a buffer of the given shape from the recycle pool, and records it as allocated.
+    bool takePooledBuffer(uint32_t width, uint32_t height, PixelFormat format, uint32_t layerCount,
+                          uint64_t usage, const std::string& requestorName,
+                          buffer_handle_t* handle, uint32_t* stride);
+    // Removes the buffers over budget or idle for too long from the recycle pool, and appends
+    // them to trimmed, to be freed once sLock is released.
+    void trimRecyclePoolLocked(nsecs_t now, std::vector<buffer_handle_t>* trimmed);
+    void recordAllocationLatency(nsecs_t latency);
+
     static Mutex sLock;
     static KeyedVector<buffer_handle_t, alloc_rec_t> sAllocList;
 
+    // Recycle pool, guarded by sLock. Buffers are ordered from least to most recently freed.
+    uint64_t mPoolBudget = 0;
+    nsecs_t mPoolIdleTimeout = 0;
+    uint64_t mPoolSize = 0;
+    std::deque<pooled_buffer_t> mPool;
+    uint64_t mPoolHits = 0;
+    uint64_t mPoolMisses = 0;
+
+    // Histogram of the latencies of allocations from the allocator, guarded by sLock. Bucket i
+    // counts the allocations that took less than 2^i ms, and the last bucket the others.
+    static constexpr size_t kLatencyBuckets = 7;
+    std::array<uint64_t, kLatencyBuckets> mAllocationLatencies{};
+
     friend class Singleton<GraphicBufferAllocator>;
     GraphicBufferAllocator();
     ~GraphicBufferAllocator();
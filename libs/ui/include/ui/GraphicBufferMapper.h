@@ -20,8 +20,15 @@
 #include <stdint.h>
 #include <sys/types.h>
 
+#include <atomic>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include <android-base/thread_annotations.h>
 #include <android-base/unique_fd.h>
 #include <ui/GraphicTypes.h>
 #include <ui/PixelFormat.h>
@@ -69,6 +76,22 @@ public:
 
     status_t importBufferNoValidate(const native_handle_t* rawHandle, buffer_handle_t* outHandle);
 
+    // Like importBuffer, but while the import cache is enabled, imports of the same buffer
+    // (identified by its GraphicBuffer id and generation number) share one imported handle, so
+    // only the first one goes through the mapper. A cached handle is only reused if rawHandle
+    // refers to the same files and ints it was imported from. outHandle must be freed with
+    // freeBuffer, which frees the shared handle once every import of it has been freed.
+    status_t importBufferCached(uint64_t bufferId, uint32_t generationNumber,
+                                const native_handle_t* rawHandle, uint32_t width, uint32_t height,
+                                uint32_t layerCount, PixelFormat format, uint64_t usage,
+                                uint32_t stride, buffer_handle_t* outHandle);
+
+    // Enables or disables the import cache used by importBufferCached. It is disabled by
+    // default, since the buffers that share a handle also share its lock state: only enable it
+    // in processes that don't lock the same buffer through several GraphicBuffers at once.
+    // Handles that are already cached stay shared until they are freed.
+    void setImportCacheEnabled(bool enabled);
+
     status_t freeBuffer(buffer_handle_t handle);
 
     void getTransportSize(buffer_handle_t handle,
@@ -184,6 +207,24 @@ private:
     std::unique_ptr<const GrallocMapper> mMapper;
 
     Version mMapperVersion;
+
+    // An imported handle shared by importBufferCached, and what it was imported from.
+    struct CachedImport {
+        buffer_handle_t handle;
+        std::vector<std::pair<dev_t, ino_t>> files;
+        std::vector<int> ints;
+        size_t refCount;
+    };
+    using ImportCacheKey = std::pair<uint64_t /*bufferId*/, uint32_t /*generationNumber*/>;
+
+    std::atomic<bool> mImportCacheEnabled{false};
+    // The number of handles in mCachedImports, so that freeBuffer can skip the lock when the
+    // cache is empty.
+    std::atomic<size_t> mCachedImportCount{0};
+    std::mutex mImportCacheMutex;
+    std::map<ImportCacheKey, CachedImport> mCachedImports GUARDED_BY(mImportCacheMutex);
+    std::unordered_map<buffer_handle_t, ImportCacheKey> mCachedImportKeys
+            GUARDED_BY(mImportCacheMutex);
 };
 
 // ---------------------------------------------------------------------------
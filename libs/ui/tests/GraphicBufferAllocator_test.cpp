@@ -53,6 +53,11 @@ public:
                     allocate)
                 .WillOnce(DoAll(SetArgPointee<6>(stride), Return(err)));
     }
+    void setUpAllocateExpectations(status_t err, uint32_t stride, buffer_handle_t handle) {
+        EXPECT_CALL(*(reinterpret_cast<const mock::MockGrallocAllocator*>(mAllocator.get())),
+                    allocate)
+                .WillOnce(DoAll(SetArgPointee<6>(stride), SetArgPointee<7>(handle), Return(err)));
+    }
     std::unique_ptr<const GrallocAllocator>& getAllocator() { return mAllocator; }
 };
 
@@ -113,4 +118,30 @@ TEST_F(GraphicBufferAllocatorTest, AllocateLargeStride) {
     ASSERT_EQ(NO_ERROR, err);
     ASSERT_EQ(expectedStride, stride);
 }
+
+TEST_F(GraphicBufferAllocatorTest, RecyclePoolReusesFreedBuffer) {
+    // The handle is never imported, so it must stay in the pool rather than reach the mapper.
+    native_handle_t* const fakeHandle = native_handle_create(0, 0);
+    mAllocator.setUpAllocateExpectations(NO_ERROR, kTestWidth, fakeHandle);
+    mAllocator.setRecyclePoolBudget(std::numeric_limits<uint64_t>::max(), std::chrono::hours(1));
+
+    android::PixelFormat format = PIXEL_FORMAT_RGBA_8888;
+    uint32_t stride = 0;
+    buffer_handle_t handle = nullptr;
+    ASSERT_EQ(NO_ERROR,
+              mAllocator.allocate(kTestWidth, kTestHeight, format, kTestLayerCount, kTestUsage,
+                                  &handle, &stride, 0, "GraphicBufferAllocatorTest"));
+    ASSERT_EQ(fakeHandle, handle);
+    ASSERT_EQ(NO_ERROR, mAllocator.free(handle));
+
+    // Only the first allocation reaches the allocator.
+    stride = 0;
+    handle = nullptr;
+    ASSERT_EQ(NO_ERROR,
+              mAllocator.allocate(kTestWidth, kTestHeight, format, kTestLayerCount, kTestUsage,
+                                  &handle, &stride, 0, "GraphicBufferAllocatorTest"));
+    EXPECT_EQ(fakeHandle, handle);
+    EXPECT_EQ(kTestWidth, stride);
+    ASSERT_EQ(NO_ERROR, mAllocator.free(handle));
+}
 } // namespace android
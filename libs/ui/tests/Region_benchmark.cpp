@@ -0,0 +1,81 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <ui/Rect.h>
+#include <ui/Region.h>
+
+namespace android {
+namespace {
+
+// A region with two rects on each of its rows, like the touchable region of a window
+// with cutouts.
+Region makeBandedRegion(int32_t rows) {
+    Region region;
+    for (int32_t row = 0; row < rows; row++) {
+        region.orSelf(Rect(0, row * 20, 100, row * 20 + 10));
+        region.orSelf(Rect(200, row * 20, 300, row * 20 + 10));
+    }
+    return region;
+}
+
+void BM_RectIntersect(benchmark::State& state) {
+    const Region region(Rect(0, 0, 1080, 2400));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(region.intersect(Rect(100, 100, 500, 500)));
+    }
+}
+BENCHMARK(BM_RectIntersect);
+
+void BM_RectSubtract(benchmark::State& state) {
+    const Region region(Rect(0, 0, 1080, 2400));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(region.subtract(Rect(0, 0, 1080, 100)));
+    }
+}
+BENCHMARK(BM_RectSubtract);
+
+void BM_RegionMerge(benchmark::State& state) {
+    const Region region = makeBandedRegion(static_cast<int32_t>(state.range(0)));
+    const Region other = region.translate(50, 5);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(region.merge(other));
+    }
+}
+BENCHMARK(BM_RegionMerge)->Arg(4)->Arg(64);
+
+void BM_DisjointRegionSubtract(benchmark::State& state) {
+    const Region region = makeBandedRegion(static_cast<int32_t>(state.range(0)));
+    const Region other = region.translate(0, 10000);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(region.subtract(other));
+    }
+}
+BENCHMARK(BM_DisjointRegionSubtract)->Arg(4)->Arg(64);
+
+void BM_RegionContains(benchmark::State& state) {
+    const Region region = makeBandedRegion(static_cast<int32_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(region.contains(250, 5));
+    }
+}
+BENCHMARK(BM_RegionContains)->Arg(4)->Arg(64);
+
+} // namespace
+} // namespace android
+
+BENCHMARK_MAIN();
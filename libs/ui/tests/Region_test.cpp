@@ -179,5 +179,34 @@ TEST_F(RegionTest, RegionHash) {
     EXPECT_NE(std::hash<Region>{}(region1), std::hash<Region>{}(region2));
 }
 
+TEST_F(RegionTest, RectOperations) {
+    const Rect rect(0, 0, 100, 100);
+    const Region region(rect);
+
+    EXPECT_TRUE(region.intersect(Rect(50, 50, 150, 150))
+                        .hasSameRects(Region(Rect(50, 50, 100, 100))));
+    EXPECT_TRUE(region.intersect(Rect(100, 0, 200, 100)).isEmpty());
+
+    EXPECT_TRUE(region.merge(Rect(10, 10, 20, 20)).hasSameRects(region));
+    EXPECT_TRUE(region.merge(Rect(0, 100, 100, 200)).hasSameRects(Region(Rect(0, 0, 100, 200))));
+    EXPECT_TRUE(region.merge(Rect(50, 0, 150, 100)).hasSameRects(Region(Rect(0, 0, 150, 100))));
+    EXPECT_TRUE(region.merge(Region(Rect(0, 0, 0, 0))).hasSameRects(region));
+
+    EXPECT_TRUE(region.subtract(Rect(0, 0, 100, 40)).hasSameRects(Region(Rect(0, 40, 100, 100))));
+    EXPECT_TRUE(region.subtract(Rect(60, -10, 120, 110)).hasSameRects(Region(Rect(0, 0, 60, 100))));
+    EXPECT_TRUE(region.subtract(Rect(200, 200, 300, 300)).hasSameRects(region));
+    EXPECT_TRUE(region.subtract(Rect(-10, -10, 110, 110)).isEmpty());
+
+    // Results which need more than one rect.
+    const Region corner = region.merge(Rect(50, 50, 150, 150));
+    EXPECT_FALSE(corner.isRect());
+    EXPECT_TRUE(corner.contains(120, 120));
+    EXPECT_FALSE(corner.contains(120, 20));
+    const Region hole = region.subtract(Rect(40, 40, 60, 60));
+    EXPECT_FALSE(hole.isRect());
+    EXPECT_FALSE(hole.contains(50, 50));
+    EXPECT_TRUE(hole.contains(20, 50));
+}
+
 }; // namespace android
 
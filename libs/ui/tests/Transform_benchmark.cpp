@@ -0,0 +1,78 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <math/mat4.h>
+#include <ui/FloatRect.h>
+#include <ui/Rect.h>
+#include <ui/Transform.h>
+
+namespace android {
+namespace {
+
+// The transforms of typical layers: a translation, a scale, a 90 degree rotation for a rotated
+// display, and an arbitrary rotation.
+ui::Transform makeTransform(int64_t kind) {
+    ui::Transform transform;
+    switch (kind) {
+        case 0:
+            transform.set(100.f, 200.f);
+            break;
+        case 1:
+            transform.set(2.f, 0.f, 0.f, 2.f);
+            break;
+        case 2:
+            transform.set(ui::Transform::ROT_90, 1080.f, 2400.f);
+            break;
+        default:
+            transform.set(0.8f, 0.6f, -0.6f, 0.8f);
+            break;
+    }
+    return transform;
+}
+
+void BM_TransformFloatRect(benchmark::State& state) {
+    const ui::Transform transform = makeTransform(state.range(0));
+    const FloatRect bounds(0.f, 0.f, 1080.f, 2400.f);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(transform.transform(bounds));
+    }
+}
+BENCHMARK(BM_TransformFloatRect)->DenseRange(0, 3);
+
+void BM_TransformRect(benchmark::State& state) {
+    const ui::Transform transform = makeTransform(state.range(0));
+    const Rect bounds(0, 0, 1080, 2400);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(transform.transform(bounds));
+    }
+}
+BENCHMARK(BM_TransformRect)->DenseRange(0, 3);
+
+void BM_Mat4Inverse(benchmark::State& state) {
+    const mat4 matrix = mat4::translate(vec4(100.f, 200.f, 0.f, 1.f)) * mat4::scale(vec4(2.f)) *
+            mat4::rotate(0.5f, vec3(0.f, 0.f, 1.f));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(inverse(matrix));
+    }
+}
+BENCHMARK(BM_Mat4Inverse);
+
+} // namespace
+} // namespace android
+
+BENCHMARK_MAIN();
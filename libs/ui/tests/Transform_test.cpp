@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <ui/Region.h>
 #include <ui/Transform.h>
 
 #include <gtest/gtest.h>
@@ -46,4 +47,27 @@ TEST(TransformTest, inverseRotation_hasCorrectType) {
     testRotationFlagsForInverse(Transform::FLIP_V, Transform::FLIP_V, false);
 }
 
+TEST(TransformTest, transformRect_translate) {
+    Transform t;
+    t.set(10.f, -20.f);
+    EXPECT_EQ(Rect(10, -20, 110, 80), t.transform(Rect(0, 0, 100, 100)));
+    EXPECT_EQ(Rect(10, -20, 110, 80), t.makeBounds(100, 100));
+
+    // Invalid rects are normalized, as with any other transform.
+    EXPECT_EQ(Rect(9, -21, 10, -20), t.transform(Rect(0, 0, -1, -1)));
+
+    // Fractional translations are rounded.
+    t.set(10.5f, 0.25f);
+    EXPECT_EQ(Rect(11, 0, 111, 100), t.transform(Rect(0, 0, 100, 100)));
+    EXPECT_EQ(Rect(10, 0, 111, 101), t.transform(Rect(0, 0, 100, 100), true /* roundOutwards */));
+}
+
+TEST(TransformTest, transformRegion_identity) {
+    const Region region(Rect(0, 0, 100, 100));
+    const Transform t;
+    const Region transformed = t.transform(region);
+    EXPECT_TRUE(transformed.hasSameRects(region));
+    EXPECT_EQ(region.begin(), transformed.begin());
+}
+
 } // namespace android::ui
@@ -25,6 +25,7 @@
 #include <log/log.h>
 #include <utils/Trace.h>
 
+#include <algorithm>
 #include <chrono>
 
 namespace android {
@@ -81,13 +82,10 @@ BlobCache::InsertResult BlobCache::set(const void* key, size_t keySize, const vo
         return InsertResult::kInvalidValueSize;
     }
 
-    std::shared_ptr<Blob> cacheKey(new Blob(key, keySize, false));
-    CacheEntry cacheEntry(cacheKey, nullptr);
-
     bool didClean = false;
     while (true) {
-        auto index = std::lower_bound(mCacheEntries.begin(), mCacheEntries.end(), cacheEntry);
-        if (index == mCacheEntries.end() || cacheEntry < *index) {
+        auto index = findEntry(key, keySize);
+        if (index == mCacheEntries.end() || index->getKey()->compare(key, keySize) != 0) {
             // Create a new cache entry.
             std::shared_ptr<Blob> keyBlob(new Blob(key, keySize, true));
             std::shared_ptr<Blob> valueBlob(new Blob(value, valueSize, true));
@@ -144,17 +142,15 @@ size_t BlobCache::get(const void* key, size_t keySize, void* value, size_t value
               mMaxKeySize);
         return 0;
     }
-    std::shared_ptr<Blob> cacheKey(new Blob(key, keySize, false));
-    CacheEntry cacheEntry(cacheKey, nullptr);
-    auto index = std::lower_bound(mCacheEntries.begin(), mCacheEntries.end(), cacheEntry);
-    if (index == mCacheEntries.end() || cacheEntry < *index) {
+    auto index = findEntry(key, keySize);
+    if (index == mCacheEntries.end() || index->getKey()->compare(key, keySize) != 0) {
         ALOGV("get: no cache entry found for key of size %zu", keySize);
         return 0;
     }
 
     // The key was found. Return the value if the caller's buffer is large
     // enough.
-    std::shared_ptr<Blob> valueBlob(index->getValue());
+    const std::shared_ptr<Blob>& valueBlob(index->getValue());
     size_t valueBlobSize = valueBlob->getSize();
     if (valueBlobSize <= valueSize) {
         ALOGV("get: copying %zu bytes to caller's buffer", valueBlobSize);
@@ -260,6 +256,9 @@ int BlobCache::unflatten(void const* buffer, size_t size) {
     const uint8_t* byteBuffer = reinterpret_cast<const uint8_t*>(buffer);
     off_t byteOffset = align4(sizeof(Header) + header->mBuildIdLength);
     size_t numEntries = header->mNumEntries;
+    // Every entry takes at least an EntryHeader, so don't trust a corrupt
+    // mNumEntries beyond that.
+    mCacheEntries.reserve(std::min(numEntries, size / sizeof(EntryHeader)));
     for (size_t i = 0; i < numEntries; i++) {
         if (byteOffset + sizeof(EntryHeader) > size) {
             clear();
@@ -280,7 +279,11 @@ int BlobCache::unflatten(void const* buffer, size_t size) {
         }
 
         const uint8_t* data = eheader->mData;
-        set(data, keySize, data + keySize, valueSize);
+        // flatten writes the entries in key order, so they can usually be
+        // appended.
+        if (!appendSorted(data, keySize, data + keySize, valueSize)) {
+            set(data, keySize, data + keySize, valueSize);
+        }
 
         byteOffset += totalSize;
     }
@@ -313,6 +316,30 @@ bool BlobCache::isCleanable() const {
     return mTotalSize > mMaxTotalSize / 2;
 }
 
+bool BlobCache::appendSorted(const void* key, size_t keySize, const void* value,
+                             size_t valueSize) {
+    if (keySize == 0 || valueSize == 0 || mMaxKeySize < keySize || mMaxValueSize < valueSize ||
+        mMaxTotalSize < mTotalSize + keySize + valueSize) {
+        return false;
+    }
+    if (!mCacheEntries.empty() && mCacheEntries.back().getKey()->compare(key, keySize) >= 0) {
+        return false;
+    }
+    std::shared_ptr<Blob> keyBlob(new Blob(key, keySize, true));
+    std::shared_ptr<Blob> valueBlob(new Blob(value, valueSize, true));
+    mCacheEntries.push_back(CacheEntry(keyBlob, valueBlob));
+    mTotalSize += keySize + valueSize;
+    return true;
+}
+
+std::vector<BlobCache::CacheEntry>::iterator BlobCache::findEntry(const void* key,
+                                                                  size_t keySize) {
+    return std::lower_bound(mCacheEntries.begin(), mCacheEntries.end(), key,
+                            [keySize](const CacheEntry& entry, const void* key) {
+                                return entry.getKey()->compare(key, keySize) < 0;
+                            });
+}
+
 BlobCache::Blob::Blob(const void* data, size_t size, bool copyData)
       : mData(copyData ? malloc(size) : data), mSize(size), mOwnsData(copyData) {
     if (data != nullptr && copyData) {
@@ -327,10 +354,14 @@ BlobCache::Blob::~Blob() {
 }
 
 bool BlobCache::Blob::operator<(const Blob& rhs) const {
-    if (mSize == rhs.mSize) {
-        return memcmp(mData, rhs.mData, mSize) < 0;
+    return compare(rhs.mData, rhs.mSize) < 0;
+}
+
+int BlobCache::Blob::compare(const void* data, size_t size) const {
+    if (mSize == size) {
+        return memcmp(mData, data, mSize);
     } else {
-        return mSize < rhs.mSize;
+        return mSize < size ? -1 : 1;
     }
 }
 
@@ -360,11 +391,11 @@ const BlobCache::CacheEntry& BlobCache::CacheEntry::operator=(const CacheEntry&
     return *this;
 }
 
-std::shared_ptr<BlobCache::Blob> BlobCache::CacheEntry::getKey() const {
+const std::shared_ptr<BlobCache::Blob>& BlobCache::CacheEntry::getKey() const {
     return mKey;
 }
 
-std::shared_ptr<BlobCache::Blob> BlobCache::CacheEntry::getValue() const {
+const std::shared_ptr<BlobCache::Blob>& BlobCache::CacheEntry::getValue() const {
     return mValue;
 }
 
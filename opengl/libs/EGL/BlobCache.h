@@ -146,6 +146,13 @@ private:
     // to have some effect, and false otherwise.
     bool isCleanable() const;
 
+    // appendSorted adds a new entry at the end of mCacheEntries, if its key
+    // sorts after every key in the cache and it fits without cleaning. It
+    // returns false, without changing the cache, otherwise. This lets
+    // unflatten, whose entries are in key order, skip the search and the
+    // insertion into the middle of mCacheEntries that set would do.
+    bool appendSorted(const void* key, size_t keySize, const void* value, size_t valueSize);
+
     // A Blob is an immutable sized unstructured data blob.
     class Blob {
     public:
@@ -154,6 +161,10 @@ private:
 
         bool operator<(const Blob& rhs) const;
 
+        // compare orders the blob against the given data like operator< does,
+        // returning a negative, zero or positive value.
+        int compare(const void* data, size_t size) const;
+
         const void* getData() const;
         size_t getSize() const;
 
@@ -183,8 +194,8 @@ private:
         bool operator<(const CacheEntry& rhs) const;
         const CacheEntry& operator=(const CacheEntry&);
 
-        std::shared_ptr<Blob> getKey() const;
-        std::shared_ptr<Blob> getValue() const;
+        const std::shared_ptr<Blob>& getKey() const;
+        const std::shared_ptr<Blob>& getValue() const;
 
         void setValue(const std::shared_ptr<Blob>& value);
 
@@ -196,6 +207,10 @@ private:
         std::shared_ptr<Blob> mValue;
     };
 
+    // findEntry returns the first entry whose key is not less than the given
+    // key, without having to allocate a Blob for the key.
+    std::vector<CacheEntry>::iterator findEntry(const void* key, size_t keySize);
+
     // A Header is the header for the entire BlobCache serialization format. No
     // need to make this portable, so we simply write the struct out.
     struct Header {
@@ -355,6 +355,35 @@ TEST_F(BlobCacheFlattenTest, FlattenFullCache) {
     }
 }
 
+// Unflatten appends the entries it reads instead of inserting them, so check that the cache stays
+// sorted for the keys that are set afterwards.
+TEST_F(BlobCacheFlattenTest, SetAfterUnflattenKeepsAllEntries) {
+    mBC.reset(new BlobCache(MAX_KEY_SIZE, MAX_VALUE_SIZE, 100));
+    mBC2.reset(new BlobCache(MAX_KEY_SIZE, MAX_VALUE_SIZE, 100));
+    mBC->set("c", 1, "1", 1);
+    mBC->set("aa", 2, "2", 1);
+    mBC->set("e", 1, "3", 1);
+    mBC->set("a", 1, "4", 1);
+
+    roundTrip();
+    mBC2->set("b", 1, "5", 1);
+    mBC2->set("ab", 2, "6", 1);
+
+    char v = 0;
+    ASSERT_EQ(size_t(1), mBC2->get("c", 1, &v, 1));
+    ASSERT_EQ('1', v);
+    ASSERT_EQ(size_t(1), mBC2->get("aa", 2, &v, 1));
+    ASSERT_EQ('2', v);
+    ASSERT_EQ(size_t(1), mBC2->get("e", 1, &v, 1));
+    ASSERT_EQ('3', v);
+    ASSERT_EQ(size_t(1), mBC2->get("a", 1, &v, 1));
+    ASSERT_EQ('4', v);
+    ASSERT_EQ(size_t(1), mBC2->get("b", 1, &v, 1));
+    ASSERT_EQ('5', v);
+    ASSERT_EQ(size_t(1), mBC2->get("ab", 2, &v, 1));
+    ASSERT_EQ('6', v);
+}
+
 TEST_F(BlobCacheFlattenTest, FlattenDoesntChangeCache) {
     // Fill up the entire cache with 1 char key/value pairs.
     const int maxEntries = MAX_TOTAL_SIZE / 2;
@@ -29,6 +29,8 @@
 #include <utils/Timers.h>
 #include <vndksupport/linker.h>
 
+#include <map>
+#include <mutex>
 #include <string>
 
 #include "EGL/eglext_angle.h"
@@ -213,6 +215,24 @@ static void uninit_api(char const* const* api, __eglMustCastToProperFunctionPoin
     }
 }
 
+// Fills a GLES 1 table with the entry points already resolved into a GLES 2 table from the same
+// library, rather than looking each of them up again. 'api' must be a subsequence of 'ref_api'.
+static void copy_api(char const* const* api, char const* const* ref_api,
+                     const __eglMustCastToProperFunctionPointerType* src,
+                     __eglMustCastToProperFunctionPointerType* curr) {
+    while (*ref_api) {
+        if (*api && std::strcmp(*api, *ref_api) == 0) {
+            *curr = *src;
+            api++;
+        } else {
+            *curr = nullptr;
+        }
+        curr++;
+        src++;
+        ref_api++;
+    }
+}
+
 void Loader::unload_system_driver(egl_connection_t* cnx) {
     ATRACE_CALL();
 
@@ -450,8 +470,8 @@ void Loader::init_api(void* dso,
     }
 }
 
-static std::string findLibrary(const std::string libraryName, const std::string searchPath,
-                               const bool exact) {
+static std::string findLibraryUncached(const std::string& libraryName,
+                                       const std::string& searchPath, const bool exact) {
     if (exact) {
         std::string absolutePath = searchPath + "/" + libraryName + ".so";
         if (!access(absolutePath.c_str(), R_OK)) {
@@ -485,6 +505,25 @@ static std::string findLibrary(const std::string libraryName, const std::string
     return std::string();
 }
 
+// The driver directories are on read-only partitions, so what findLibraryUncached finds doesn't
+// change while the process runs. Remember it, so that a driver that is loaded again, or found
+// in the zygote before apps fork from it, doesn't search the directory again; the wildcard search
+// reads the whole directory for each of the four libraries.
+static std::string findLibrary(const std::string& libraryName, const std::string& searchPath,
+                               const bool exact) {
+    static std::mutex sLock;
+    static std::map<std::string, std::string> sFoundLibraries;
+
+    const std::string key = searchPath + "/" + libraryName + (exact ? "" : "*");
+    std::lock_guard<std::mutex> lock(sLock);
+    auto it = sFoundLibraries.find(key);
+    if (it == sFoundLibraries.end()) {
+        it = sFoundLibraries.emplace(key, findLibraryUncached(libraryName, searchPath, exact))
+                     .first;
+    }
+    return it->second;
+}
+
 static void* load_system_driver(const char* kind, const char* suffix, const bool exact) {
     ATRACE_CALL();
 
@@ -728,18 +767,25 @@ void Loader::initialize_api(void* dso, egl_connection_t* cnx, uint32_t mask) {
         }
     }
 
-    if (mask & GLESv1_CM) {
-        init_api(dso, gl_names_1, gl_names,
-            (__eglMustCastToProperFunctionPointerType*)
-                &cnx->hooks[egl_connection_t::GLESv1_INDEX]->gl,
-            getProcAddress);
-    }
+    __eglMustCastToProperFunctionPointerType* gles1 =
+            (__eglMustCastToProperFunctionPointerType*)&cnx->hooks[egl_connection_t::GLESv1_INDEX]
+                    ->gl;
+    __eglMustCastToProperFunctionPointerType* gles2 =
+            (__eglMustCastToProperFunctionPointerType*)&cnx->hooks[egl_connection_t::GLESv2_INDEX]
+                    ->gl;
 
     if (mask & GLESv2) {
-        init_api(dso, gl_names, nullptr,
-            (__eglMustCastToProperFunctionPointerType*)
-                &cnx->hooks[egl_connection_t::GLESv2_INDEX]->gl,
-            getProcAddress);
+        init_api(dso, gl_names, nullptr, gles2, getProcAddress);
+    }
+
+    if (mask & GLESv1_CM) {
+        if (mask & GLESv2) {
+            // Both APIs come from the same library, and every GLES 1 entry point is also a GLES 2
+            // one, so reuse what was just resolved.
+            copy_api(gl_names_1, gl_names, gles2, gles1);
+        } else {
+            init_api(dso, gl_names_1, gl_names, gles1, getProcAddress);
+        }
     }
 }
 
@@ -138,17 +138,40 @@ MultifileBlobCache::MultifileBlobCache(size_t maxKeySize, size_t maxValueSize, s
         DIR* dir;
         struct dirent* entry;
         if ((dir = opendir(mMultifileDirName.c_str())) != nullptr) {
+            std::vector<std::string> entryNames;
             while ((entry = readdir(dir)) != nullptr) {
                 if (entry->d_name == "."s || entry->d_name == ".."s ||
-                    strcmp(entry->d_name, kMultifileBlobCacheStatusFile) == 0) {
+                    strcmp(entry->d_name, kMultifileBlobCacheStatusFile) == 0 ||
+                    strcmp(entry->d_name, kMultifileBlobCachePrefetchFile) == 0) {
                     continue;
                 }
+                entryNames.push_back(entry->d_name);
+            }
+            closedir(dir);
 
-                std::string entryName = entry->d_name;
+            // Visit the entries that were requested first last time first, so that they are the
+            // ones preloaded into the hot cache
+            std::vector<uint32_t> prefetchOrder = readPrefetchOrder();
+            std::unordered_map<uint32_t, size_t> prefetchRanks;
+            for (size_t i = 0; i < prefetchOrder.size(); i++) {
+                prefetchRanks.emplace(prefetchOrder[i], i);
+            }
+            auto getPrefetchRank = [&prefetchRanks](const std::string& entryName) {
+                auto it = prefetchRanks.find(
+                        static_cast<uint32_t>(strtoul(entryName.c_str(), nullptr, 10)));
+                return it != prefetchRanks.end() ? it->second : prefetchRanks.size();
+            };
+            std::stable_sort(entryNames.begin(), entryNames.end(),
+                             [&getPrefetchRank](const std::string& lhs, const std::string& rhs) {
+                                 return getPrefetchRank(lhs) < getPrefetchRank(rhs);
+                             });
+
+            for (const std::string& entryName : entryNames) {
                 std::string fullPath = mMultifileDirName + "/" + entryName;
 
                 // The filename is the same as the entryHash
-                uint32_t entryHash = static_cast<uint32_t>(strtoul(entry->d_name, nullptr, 10));
+                uint32_t entryHash =
+                        static_cast<uint32_t>(strtoul(entryName.c_str(), nullptr, 10));
 
                 ALOGV("INIT: Checking entry %u", entryHash);
 
@@ -261,7 +284,6 @@ MultifileBlobCache::MultifileBlobCache(size_t maxKeySize, size_t maxValueSize, s
                     munmap(mappedEntry, fileSize);
                 }
             }
-            closedir(dir);
         } else {
             ALOGE("Unable to open filename: %s", mMultifileDirName.c_str());
         }
@@ -390,6 +412,8 @@ EGLsizeiANDROID MultifileBlobCache::get(const void* key, EGLsizeiANDROID keySize
     // Generate a hash of the key and use it to track this entry
     uint32_t entryHash = android::JenkinsHashMixBytes(0, static_cast<const uint8_t*>(key), keySize);
 
+    mStats.getCount++;
+
     // See if we have this file
     if (!contains(entryHash)) {
         ALOGV("GET: Cache MISS - cache does not contain entry: %u", entryHash);
@@ -410,6 +434,8 @@ EGLsizeiANDROID MultifileBlobCache::get(const void* key, EGLsizeiANDROID keySize
     // We have the file and have enough room to write it out, return the entry
     ALOGV("GET: Cache HIT - cache contains entry: %u", entryHash);
 
+    recordRequest(entryHash);
+
     // Look up the size of the file
     size_t fileSize = entryStats.fileSize;
     if (keySize > fileSize) {
@@ -428,8 +454,10 @@ EGLsizeiANDROID MultifileBlobCache::get(const void* key, EGLsizeiANDROID keySize
     if (mHotCache.find(entryHash) != mHotCache.end()) {
         ALOGV("GET: HotCache HIT for entry %u", entryHash);
         cacheEntry = mHotCache[entryHash].entryBuffer;
+        mStats.hotCacheHitCount++;
     } else {
         ALOGV("GET: HotCache MISS for entry: %u", entryHash);
+        const auto readStart = std::chrono::steady_clock::now();
 
         // Wait for writes to complete if there is an outstanding write for this entry
         bool wait = false;
@@ -471,6 +499,8 @@ EGLsizeiANDROID MultifileBlobCache::get(const void* key, EGLsizeiANDROID keySize
         }
 
         cacheEntry = mHotCache[entryHash].entryBuffer;
+        mStats.diskReadCount++;
+        mStats.diskReadTime += std::chrono::steady_clock::now() - readStart;
     }
 
     // Ensure the header matches
@@ -508,6 +538,11 @@ void MultifileBlobCache::finish() {
     ALOGV("FINISH: Waiting for work to complete.");
     waitForWorkComplete();
 
+    ALOGV("FINISH: %zu gets, %zu hot cache hits, %zu disk reads taking %" PRId64 "ns",
+          mStats.getCount, mStats.hotCacheHitCount, mStats.diskReadCount,
+          static_cast<int64_t>(mStats.diskReadTime.count()));
+    writePrefetchOrder();
+
     // Close all entries in the hot cache
     for (auto hotCacheIter = mHotCache.begin(); hotCacheIter != mHotCache.end();) {
         uint32_t entryHash = hotCacheIter->first;
@@ -626,6 +661,57 @@ bool MultifileBlobCache::checkStatus(const std::string& baseDir) {
     return true;
 }
 
+std::vector<uint32_t> MultifileBlobCache::readPrefetchOrder() {
+    std::vector<uint32_t> prefetchOrder;
+    std::string prefetchPath = mMultifileDirName + "/" + kMultifileBlobCachePrefetchFile;
+    int fd = open(prefetchPath.c_str(), O_RDONLY);
+    if (fd == -1) {
+        ALOGV("PREFETCH(READ): No prefetch file (%s)", prefetchPath.c_str());
+        return prefetchOrder;
+    }
+
+    prefetchOrder.resize(kMultifileMaxPrefetchEntries);
+    ssize_t result = read(fd, prefetchOrder.data(), prefetchOrder.size() * sizeof(uint32_t));
+    close(fd);
+    if (result < 0) {
+        ALOGE("PREFETCH(READ): Error reading prefetch file (%s): %s", prefetchPath.c_str(),
+              std::strerror(errno));
+        result = 0;
+    }
+    prefetchOrder.resize(static_cast<size_t>(result) / sizeof(uint32_t));
+    return prefetchOrder;
+}
+
+void MultifileBlobCache::writePrefetchOrder() {
+    if (mRequestOrder.empty()) {
+        return;
+    }
+
+    std::string prefetchPath = mMultifileDirName + "/" + kMultifileBlobCachePrefetchFile;
+    int fd = open(prefetchPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (fd == -1) {
+        ALOGE("PREFETCH(WRITE): Unable to create prefetch file: %s, error: %s",
+              prefetchPath.c_str(), std::strerror(errno));
+        return;
+    }
+
+    size_t size = mRequestOrder.size() * sizeof(uint32_t);
+    ssize_t result = write(fd, mRequestOrder.data(), size);
+    close(fd);
+    if (result != static_cast<ssize_t>(size)) {
+        ALOGE("PREFETCH(WRITE): Error writing prefetch file: %s, error %s", prefetchPath.c_str(),
+              std::strerror(errno));
+        remove(prefetchPath.c_str());
+    }
+}
+
+void MultifileBlobCache::recordRequest(uint32_t entryHash) {
+    if (mRequestOrder.size() < kMultifileMaxPrefetchEntries &&
+        mRequestedEntries.insert(entryHash).second) {
+        mRequestOrder.push_back(entryHash);
+    }
+}
+
 void MultifileBlobCache::trackEntry(uint32_t entryHash, EGLsizeiANDROID valueSize, size_t fileSize,
                                     time_t accessTime) {
     mEntries.insert(entryHash);
@@ -22,6 +22,7 @@
 
 #include <android-base/thread_annotations.h>
 #include <cutils/properties.h>
+#include <chrono>
 #include <future>
 #include <map>
 #include <queue>
@@ -29,6 +30,7 @@
 #include <thread>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "FileBlobCache.h"
 
@@ -36,6 +38,10 @@ namespace android {
 
 constexpr uint32_t kMultifileBlobCacheVersion = 1;
 constexpr char kMultifileBlobCacheStatusFile[] = "cache.status";
+constexpr char kMultifileBlobCachePrefetchFile[] = "cache.prefetch";
+
+// The number of distinct entries whose request order is recorded for the next initialization.
+constexpr size_t kMultifileMaxPrefetchEntries = 256;
 
 struct MultifileHeader {
     uint32_t magic;
@@ -57,6 +63,14 @@ struct MultifileStatus {
     char buildId[PROP_VALUE_MAX];
 };
 
+struct MultifileStats {
+    size_t getCount = 0;
+    size_t hotCacheHitCount = 0;
+    // Entries that get had to read from disk, and the time the caller spent waiting for them.
+    size_t diskReadCount = 0;
+    std::chrono::nanoseconds diskReadTime{0};
+};
+
 struct MultifileHotCache {
     int entryFd;
     uint8_t* entryBuffer;
@@ -122,6 +136,8 @@ public:
     uint32_t getCurrentCacheVersion() const { return mCacheVersion; }
     void setCurrentCacheVersion(uint32_t cacheVersion) { mCacheVersion = cacheVersion; }
 
+    const MultifileStats& getStats() const { return mStats; }
+
 private:
     void trackEntry(uint32_t entryHash, EGLsizeiANDROID valueSize, size_t fileSize,
                     time_t accessTime);
@@ -132,6 +148,12 @@ private:
     bool createStatus(const std::string& baseDir);
     bool checkStatus(const std::string& baseDir);
 
+    // The prefetch file holds the hashes of the entries in the order they were first requested,
+    // so that initialization can load the hot cache with them first.
+    std::vector<uint32_t> readPrefetchOrder();
+    void writePrefetchOrder();
+    void recordRequest(uint32_t entryHash);
+
     size_t getFileSize(uint32_t entryHash);
     size_t getValueSize(uint32_t entryHash);
 
@@ -165,6 +187,12 @@ private:
     size_t mHotCacheEntryLimit;
     size_t mHotCacheSize;
 
+    // The entries requested since initialization, in order, up to kMultifileMaxPrefetchEntries.
+    std::vector<uint32_t> mRequestOrder;
+    std::unordered_set<uint32_t> mRequestedEntries;
+
+    MultifileStats mStats;
+
     // Below are the components used for deferred writes
 
     // Track whether we have pending writes for an entry
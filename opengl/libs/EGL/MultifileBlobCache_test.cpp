@@ -307,6 +307,29 @@ TEST_F(MultifileBlobCacheTest, EnsureFileDescriptorsClosed) {
     ASSERT_LT(getFileDescriptorCount(), kMaxTotalEntries / 2);
 }
 
+TEST_F(MultifileBlobCacheTest, RequestedEntriesArePreloadedFirst) {
+    // Use values large enough that only one entry fits in the hot cache
+    std::vector<uint8_t> value(kMaxValueSize - 1024);
+    for (int i = 0; i < 3; i++) {
+        std::fill(value.begin(), value.end(), i);
+        mMBC->set(&i, sizeof(i), value.data(), value.size());
+    }
+
+    for (int i = 0; i < 3; i++) {
+        // Request one entry, so that it is the one preloaded next time
+        ASSERT_EQ(value.size(), mMBC->get(&i, sizeof(i), value.data(), value.size()));
+        mMBC->finish();
+        mMBC.reset(new MultifileBlobCache(kMaxKeySize, kMaxValueSize, kMaxTotalSize,
+                                          kMaxTotalEntries, &mTempFile->path[0]));
+
+        ASSERT_EQ(value.size(), mMBC->get(&i, sizeof(i), value.data(), value.size()));
+        ASSERT_EQ(i, value[0]);
+        ASSERT_EQ(size_t(1), mMBC->getStats().getCount);
+        ASSERT_EQ(size_t(1), mMBC->getStats().hotCacheHitCount);
+        ASSERT_EQ(size_t(0), mMBC->getStats().diskReadCount);
+    }
+}
+
 std::vector<std::string> MultifileBlobCacheTest::getCacheEntries() {
     std::string cachePath = &mTempFile->path[0];
     std::string multifileDirName = cachePath + ".multifile";
@@ -322,7 +345,8 @@ std::vector<std::string> MultifileBlobCacheTest::getCacheEntries() {
                 if (entry->d_name == "."s || entry->d_name == ".."s) {
                     continue;
                 }
-                if (strcmp(entry->d_name, kMultifileBlobCacheStatusFile) == 0) {
+                if (strcmp(entry->d_name, kMultifileBlobCacheStatusFile) == 0 ||
+                    strcmp(entry->d_name, kMultifileBlobCachePrefetchFile) == 0) {
                     continue;
                 }
                 cacheEntries.push_back(multifileDirName + "/" + entry->d_name);
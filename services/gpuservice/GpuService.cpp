@@ -179,6 +179,7 @@ status_t GpuService::doDump(int fd, const Vector<String16>& args, bool /*asProto
         bool dumpAll = true;
         bool dumpDriverInfo = false;
         bool dumpMem = false;
+        bool dumpMemHistory = false;
         bool dumpStats = false;
         bool dumpWork = false;
         size_t numArgs = args.size();
@@ -191,11 +192,13 @@ status_t GpuService::doDump(int fd, const Vector<String16>& args, bool /*asProto
                     dumpDriverInfo = true;
                 } else if (args[index] == String16("--gpumem")) {
                     dumpMem = true;
+                } else if (args[index] == String16("--gpumemhistory")) {
+                    dumpMemHistory = true;
                 } else if (args[index] == String16("--gpuwork")) {
                     dumpWork = true;
                 }
             }
-            dumpAll = !(dumpDriverInfo || dumpMem || dumpStats || dumpWork);
+            dumpAll = !(dumpDriverInfo || dumpMem || dumpMemHistory || dumpStats || dumpWork);
         }
 
         if (dumpAll || dumpDriverInfo) {
@@ -206,6 +209,10 @@ status_t GpuService::doDump(int fd, const Vector<String16>& args, bool /*asProto
             mGpuMem->dump(args, &result);
             result.append("\n");
         }
+        if (dumpMemHistory) {
+            mGpuMem->dumpHistory(&result);
+            result.append("\n");
+        }
         if (dumpAll || dumpStats) {
             mGpuStats->dump(args, &result);
             result.append("\n");
@@ -28,6 +28,8 @@
 #include <utils/Timers.h>
 #include <utils/Trace.h>
 
+#include <algorithm>
+#include <tuple>
 #include <unordered_map>
 #include <vector>
 
@@ -36,9 +38,21 @@ namespace android {
 using base::StringAppendF;
 
 GpuMem::~GpuMem() {
+    stop();
+    if (mSamplerThread.joinable()) {
+        mSamplerThread.join();
+    }
     bpf_detach_tracepoint(kGpuMemTraceGroup, kGpuMemTotalTracepoint);
 }
 
+void GpuMem::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mSamplerMutex);
+        mStop.store(true);
+    }
+    mSamplerCondition.notify_all();
+}
+
 void GpuMem::initialize() {
     // Make sure bpf programs are loaded
     bpf::waitForProgsLoaded();
@@ -76,6 +90,51 @@ void GpuMem::initialize() {
     setGpuMemTotalMap(map);
 
     mInitialized.store(true);
+
+    mSamplerThread = std::thread(&GpuMem::samplerThreadLoop, this);
+    pthread_setname_np(mSamplerThread.native_handle(), "GpuMemSampler");
+}
+
+void GpuMem::samplerThreadLoop() {
+    std::unique_lock<std::mutex> lock(mSamplerMutex);
+    while (!mStop.load()) {
+        lock.unlock();
+        sampleGpuMemTotals();
+        lock.lock();
+        mSamplerCondition.wait_for(lock, kSamplePeriod, [this] { return mStop.load(); });
+    }
+}
+
+void GpuMem::sampleGpuMemTotals() {
+    ATRACE_CALL();
+
+    if (!mInitialized.load() || !mGpuMemTotalMap.isValid()) return;
+
+    std::lock_guard<std::mutex> lock(mHistoryMutex);
+    std::vector<Total>& totals = mSampleTotals;
+    totals.clear();
+    traverseGpuMemTotals([&totals](int64_t, uint32_t gpuId, uint32_t pid, uint64_t size) {
+        totals.push_back({gpuId, pid, size});
+    });
+    std::sort(totals.begin(), totals.end(), [](const Total& l, const Total& r) {
+        return std::tie(l.gpuId, l.pid) < std::tie(r.gpuId, r.pid);
+    });
+
+    // Only keep the samples where something changed, so that the history covers a longer time.
+    if (!mHistory.empty()) {
+        const size_t last = (mHistoryNext + mHistory.size() - 1) % mHistory.size();
+        if (mHistory[last].totals == mSampleTotals) return;
+    }
+
+    if (mHistory.size() < kMaxHistorySamples) {
+        mHistoryNext = mHistory.size();
+        mHistory.emplace_back();
+    }
+    // Swap rather than copy, so that the evicted sample's storage is reused for the next one.
+    Sample& sample = mHistory[mHistoryNext];
+    sample.timestamp = systemTime();
+    std::swap(sample.totals, mSampleTotals);
+    mHistoryNext = (mHistoryNext + 1) % kMaxHistorySamples;
 }
 
 void GpuMem::setGpuMemTotalMap(bpf::BpfMapRO<uint64_t, uint64_t>& map) {
@@ -135,6 +194,30 @@ void GpuMem::dump(const Vector<String16>& /* args */, std::string* result) {
     }
 }
 
+// Dump the changes of the per process memory usage on all gpus, oldest first
+void GpuMem::dumpHistory(std::string* result) {
+    ATRACE_CALL();
+
+    std::lock_guard<std::mutex> lock(mHistoryMutex);
+    StringAppendF(result, "GPU memory history: %zu samples\n", mHistory.size());
+    if (mHistory.empty()) return;
+
+    result->append("age_ms gpu_id pid size (pid 0 is the global total)\n");
+    const nsecs_t now = systemTime();
+    const size_t oldest = mHistory.size() < kMaxHistorySamples ? 0 : mHistoryNext;
+    for (size_t i = 0; i < mHistory.size(); i++) {
+        const Sample& sample = mHistory[(oldest + i) % mHistory.size()];
+        const int64_t ageMs = ns2ms(now - sample.timestamp);
+        if (sample.totals.empty()) {
+            StringAppendF(result, "%" PRId64 " - - 0\n", ageMs);
+        }
+        for (const Total& total : sample.totals) {
+            StringAppendF(result, "%" PRId64 " %u %u %" PRIu64 "\n", ageMs, total.gpuId,
+                          total.pid, total.size);
+        }
+    }
+}
+
 void GpuMem::traverseGpuMemTotals(const std::function<void(int64_t ts, uint32_t gpuId, uint32_t pid,
                                                            uint64_t size)>& callback) {
     auto res = mGpuMemTotalMap.getFirstKey();
@@ -16,11 +16,18 @@
 
 #pragma once
 
+#include <android-base/thread_annotations.h>
 #include <bpf/BpfMap.h>
 #include <utils/String16.h>
+#include <utils/Timers.h>
 #include <utils/Vector.h>
 
+#include <chrono>
+#include <condition_variable>
 #include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace android {
 
@@ -33,13 +40,18 @@ public:
     void initialize();
     // dumpsys interface
     void dump(const Vector<String16>& args, std::string* result);
+    // dumpsys interface for the history of the per process totals
+    void dumpHistory(std::string* result);
     bool isInitialized() { return mInitialized.load(); }
-    void stop() { mStop.store(true); }
+    void stop();
 
     // Traverse the gpu memory total map to feed the callback function.
     void traverseGpuMemTotals(const std::function<void(int64_t ts, uint32_t gpuId, uint32_t pid,
                                                        uint64_t size)>& callback);
 
+    // Samples the gpu memory totals into the history, if they changed since the last sample.
+    void sampleGpuMemTotals();
+
 private:
     // Friend class for testing.
     friend class TestableGpuMem;
@@ -47,6 +59,25 @@ private:
     // set gpu memory total map
     void setGpuMemTotalMap(bpf::BpfMapRO<uint64_t, uint64_t>& map);
 
+    // Calls sampleGpuMemTotals every kSamplePeriod until stopped.
+    void samplerThreadLoop();
+
+    struct Total {
+        uint32_t gpuId;
+        uint32_t pid;
+        uint64_t size;
+
+        bool operator==(const Total& other) const {
+            return gpuId == other.gpuId && pid == other.pid && size == other.size;
+        }
+    };
+
+    struct Sample {
+        nsecs_t timestamp = 0;
+        // Sorted by gpu id, then pid.
+        std::vector<Total> totals;
+    };
+
     // indicate whether ebpf has been initialized
     std::atomic<bool> mInitialized = false;
 
@@ -56,6 +87,19 @@ private:
     // bpf map for GPU memory total data
     android::bpf::BpfMapRO<uint64_t, uint64_t> mGpuMemTotalMap;
 
+    // Samples of the gpu memory totals, in a ring of kMaxHistorySamples that is filled lazily.
+    // mHistory[mHistoryNext] is the oldest sample once the ring is full.
+    std::mutex mHistoryMutex;
+    std::vector<Sample> mHistory GUARDED_BY(mHistoryMutex);
+    size_t mHistoryNext GUARDED_BY(mHistoryMutex) = 0;
+    // Scratch space for sampleGpuMemTotals.
+    std::vector<Total> mSampleTotals GUARDED_BY(mHistoryMutex);
+
+    // thread sampling the gpu memory totals, and the condition variable that wakes it up to stop
+    std::thread mSamplerThread;
+    std::mutex mSamplerMutex;
+    std::condition_variable mSamplerCondition;
+
     // gpu memory tracepoint event category
     static constexpr char kGpuMemTraceGroup[] = "gpu_mem";
     // gpu memory total tracepoint
@@ -67,6 +111,10 @@ private:
     static constexpr char kGpuMemTotalMapPath[] = "/sys/fs/bpf/map_gpuMem_gpu_mem_total_map";
     // 30 seconds timeout for trying to attach bpf program to tracepoint
     static constexpr int kGpuWaitTimeout = 30;
+    // period of the gpu memory total samples
+    static constexpr std::chrono::seconds kSamplePeriod{1};
+    // number of samples in the history, i.e. at least 5 minutes of changes
+    static constexpr size_t kMaxHistorySamples = 300;
 };
 
 } // namespace android
@@ -24,10 +24,12 @@
 #include <binder/PermissionCache.h>
 #include <bpf/WaitForProgsLoaded.h>
 #include <libbpf.h>
+#include <linux/bpf.h>
 #include <log/log.h>
 #include <random>
 #include <stats_event.h>
 #include <statslog.h>
+#include <sys/syscall.h>
 #include <unistd.h>
 #include <utils/Timers.h>
 #include <utils/Trace.h>
@@ -63,6 +65,67 @@ bool equalGpuIdUid(const android::gpuwork::GpuIdUid& l, const android::gpuwork::
     return std::tie(l.gpu_id, l.uid) == std::tie(r.gpu_id, r.uid);
 }
 
+uint64_t ptrToU64(const void* ptr) {
+    return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ptr));
+}
+
+// Reads all entries of the BPF hash map |mapFd|, which holds at most
+// |maxEntries| entries, into |keys| and |values| using BPF_MAP_LOOKUP_BATCH.
+// Each syscall copies whole hash buckets, rather than needing a |getNextKey|
+// and a |readValue| syscall per entry. Returns false if the kernel does not
+// support batched map operations (they were added in Linux 5.6).
+template <class Key, class Value>
+bool lookupBatch(int mapFd, uint32_t maxEntries, std::vector<Key>* keys,
+                 std::vector<Value>* values) {
+    keys->resize(maxEntries);
+    values->resize(maxEntries);
+    uint32_t inBatch = 0;
+    uint32_t outBatch = 0;
+    uint32_t numRead = 0;
+    bool firstBatch = true;
+    while (numRead < maxEntries) {
+        union bpf_attr attr = {};
+        attr.batch.in_batch = firstBatch ? 0 : ptrToU64(&inBatch);
+        attr.batch.out_batch = ptrToU64(&outBatch);
+        attr.batch.keys = ptrToU64(keys->data() + numRead);
+        attr.batch.values = ptrToU64(values->data() + numRead);
+        attr.batch.count = maxEntries - numRead;
+        attr.batch.map_fd = static_cast<uint32_t>(mapFd);
+        errno = 0;
+        int ret = static_cast<int>(syscall(__NR_bpf, BPF_MAP_LOOKUP_BATCH, &attr, sizeof(attr)));
+        // |count| is updated to the number of entries read, including by the
+        // last batch, which fails with ENOENT.
+        numRead += attr.batch.count;
+        if (ret < 0) {
+            if (errno == ENOENT) {
+                break;
+            }
+            keys->clear();
+            values->clear();
+            return false;
+        }
+        inBatch = outBatch;
+        firstBatch = false;
+    }
+    keys->resize(numRead);
+    values->resize(numRead);
+    return true;
+}
+
+// Deletes |keys| from the BPF map |mapFd| using BPF_MAP_DELETE_BATCH. Returns
+// false if not all of them could be deleted.
+template <class Key>
+bool deleteBatch(int mapFd, const std::vector<Key>& keys) {
+    if (keys.empty()) {
+        return true;
+    }
+    union bpf_attr attr = {};
+    attr.batch.keys = ptrToU64(keys.data());
+    attr.batch.count = static_cast<uint32_t>(keys.size());
+    attr.batch.map_fd = static_cast<uint32_t>(mapFd);
+    return syscall(__NR_bpf, BPF_MAP_DELETE_BATCH, &attr, sizeof(attr)) == 0;
+}
+
 // Gets a BPF map from |mapPath|.
 template <class Key, class Value>
 bool getBpfMap(const char* mapPath, bpf::BpfMap<Key, Value>* out) {
@@ -173,6 +236,8 @@ void GpuWork::dump(const Vector<String16>& /* args */, std::string* result) {
 
     // Ordered map ensures output data is sorted.
     std::map<GpuIdUid, UidTrackingInfo, decltype(lessThanGpuIdUid)*> dumpMap(&lessThanGpuIdUid);
+    MapReadStats readStats;
+    bool batchedMapOps;
 
     {
         std::lock_guard<std::mutex> lock(mMutex);
@@ -182,27 +247,24 @@ void GpuWork::dump(const Vector<String16>& /* args */, std::string* result) {
             return;
         }
 
-        // Iteration of BPF hash maps can be unreliable (no data races, but elements
-        // may be repeated), as the map is typically being modified by other
-        // threads. The buckets are all preallocated. Our eBPF program only updates
-        // entries (in-place) or adds entries. |GpuWork| only iterates or clears the
-        // map while holding |mMutex|. Given this, we should be able to iterate over
-        // all elements reliably. Nevertheless, we copy into a map to avoid
-        // duplicates.
-
-        // Note that userspace reads of BPF maps make a copy of the value, and
-        // thus the returned value is not being concurrently accessed by the BPF
-        // program (no atomic reads needed below).
-
-        mGpuWorkMap.iterateWithValue(
-                [&dumpMap](const GpuIdUid& key, const UidTrackingInfo& value,
-                           const android::bpf::BpfMap<GpuIdUid, UidTrackingInfo>&)
-                        -> base::Result<void> {
-                    dumpMap[key] = value;
-                    return {};
-                });
+        // Copy into a map to avoid duplicates; see |readGpuWorkMap|.
+        std::vector<GpuIdUid> keys;
+        std::vector<UidTrackingInfo> values;
+        readGpuWorkMap(&keys, &values);
+        for (size_t i = 0; i < keys.size(); ++i) {
+            dumpMap[keys[i]] = values[i];
+        }
+        readStats = mMapReadStats;
+        batchedMapOps = mBatchedMapOpsSupported;
     }
 
+    StringAppendF(result,
+                  "GPU work map reads: %" PRIu64 " (%s), last read %zu entries in %" PRId64
+                  " us, max %" PRId64 " us\n",
+                  readStats.count, batchedMapOps ? "batched" : "per entry",
+                  readStats.lastEntryCount, ns2us(readStats.lastDuration),
+                  ns2us(readStats.maxDuration));
+
     // Dump work information.
     // E.g.
     // GPU work information.
@@ -226,6 +288,48 @@ void GpuWork::dump(const Vector<String16>& /* args */, std::string* result) {
     }
 }
 
+void GpuWork::readGpuWorkMap(std::vector<GpuIdUid>* keys, std::vector<UidTrackingInfo>* values) {
+    ATRACE_CALL();
+    const nsecs_t start = systemTime(SYSTEM_TIME_MONOTONIC);
+
+    // Iteration of BPF hash maps can be unreliable (no data races, but elements
+    // may be repeated), as the map is typically being modified by other
+    // threads. The buckets are all preallocated. Our eBPF program only updates
+    // entries (in-place) or adds entries. |GpuWork| only iterates or clears the
+    // map while holding |mMutex|. Given this, we should be able to iterate over
+    // all elements reliably. Nevertheless, callers should copy the entries into
+    // a map to avoid duplicates.
+
+    // Note that userspace reads of BPF maps make a copy of the value, and thus
+    // the returned value is not being concurrently accessed by the BPF program
+    // (no atomic reads needed by callers).
+
+    if (mBatchedMapOpsSupported &&
+        !lookupBatch(mGpuWorkMap.getMap().get(), kMaxTrackedGpuIdUids, keys, values)) {
+        ALOGI("Batched BPF map operations are not supported [%d(%s)]", errno, strerror(errno));
+        mBatchedMapOpsSupported = false;
+    }
+    if (!mBatchedMapOpsSupported) {
+        keys->clear();
+        values->clear();
+        mGpuWorkMap.iterateWithValue([keys, values](const GpuIdUid& key,
+                                                    const UidTrackingInfo& value,
+                                                    const android::bpf::BpfMap<GpuIdUid,
+                                                                               UidTrackingInfo>&)
+                                             -> base::Result<void> {
+            keys->push_back(key);
+            values->push_back(value);
+            return {};
+        });
+    }
+
+    const nsecs_t duration = systemTime(SYSTEM_TIME_MONOTONIC) - start;
+    mMapReadStats.count++;
+    mMapReadStats.lastEntryCount = keys->size();
+    mMapReadStats.lastDuration = duration;
+    mMapReadStats.maxDuration = std::max(mMapReadStats.maxDuration, duration);
+}
+
 bool GpuWork::attachTracepoint(const char* programPath, const char* tracepointGroup,
                                const char* tracepointName) {
     errno = 0;
@@ -283,24 +387,15 @@ AStatsManager_PullAtomCallbackReturn GpuWork::pullWorkAtoms(AStatsEventList* dat
     std::unordered_map<GpuIdUid, UidTrackingInfo, decltype(hashGpuIdUid)*, decltype(equalGpuIdUid)*>
             workMap(32, &hashGpuIdUid, &equalGpuIdUid);
 
-    // Iteration of BPF hash maps can be unreliable (no data races, but elements
-    // may be repeated), as the map is typically being modified by other
-    // threads. The buckets are all preallocated. Our eBPF program only updates
-    // entries (in-place) or adds entries. |GpuWork| only iterates or clears the
-    // map while holding |mMutex|. Given this, we should be able to iterate over
-    // all elements reliably. Nevertheless, we copy into a map to avoid
-    // duplicates.
-
-    // Note that userspace reads of BPF maps make a copy of the value, and thus
-    // the returned value is not being concurrently accessed by the BPF program
-    // (no atomic reads needed below).
-
-    mGpuWorkMap.iterateWithValue([&workMap](const GpuIdUid& key, const UidTrackingInfo& value,
-                                            const android::bpf::BpfMap<GpuIdUid, UidTrackingInfo>&)
-                                         -> base::Result<void> {
-        workMap[key] = value;
-        return {};
-    });
+    // Copy into a map to avoid duplicates; see |readGpuWorkMap|.
+    {
+        std::vector<GpuIdUid> keys;
+        std::vector<UidTrackingInfo> values;
+        readGpuWorkMap(&keys, &values);
+        for (size_t i = 0; i < keys.size(); ++i) {
+            workMap[keys[i]] = values[i];
+        }
+    }
 
     // Get a list of just the UIDs; the order does not matter.
     std::vector<Uid> uids;
@@ -498,6 +593,20 @@ void GpuWork::clearMap() {
         return;
     }
 
+    // With batched operations, read the keys and then delete them all in one
+    // syscall. Entries the BPF program adds in between are kept until the next
+    // clear.
+    if (mBatchedMapOpsSupported) {
+        std::vector<GpuIdUid> keys;
+        std::vector<UidTrackingInfo> values;
+        if (lookupBatch(mGpuWorkMap.getMap().get(), kMaxTrackedGpuIdUids, &keys, &values) &&
+            deleteBatch(mGpuWorkMap.getMap().get(), keys)) {
+            resetMapEntryCount(globalData.value());
+            return;
+        }
+        ALOGW("Batched clearing of the GPU work map failed [%d(%s)]", errno, strerror(errno));
+    }
+
     // Iterating BPF maps to delete keys is tricky. If we just repeatedly call
     // |getFirstKey()| and delete that, we may loop forever (or for a long time)
     // because our BPF program might be repeatedly re-adding keys. Also, even if
@@ -520,10 +629,14 @@ void GpuWork::clearMap() {
         mGpuWorkMap.deleteValue(previousKey.value());
     }
 
+    resetMapEntryCount(globalData.value());
+}
+
+void GpuWork::resetMapEntryCount(GlobalData globalData) {
     // Reset our counter; |globalData| is a copy of the data, so we have to use
     // |writeValue|.
-    globalData.value().num_map_entries = 0;
-    mGpuWorkGlobalDataMap.writeValue(0, globalData.value(), BPF_ANY);
+    globalData.num_map_entries = 0;
+    mGpuWorkGlobalDataMap.writeValue(0, globalData, BPF_ANY);
 
     // Update |mPreviousMapClearTimePoint| so we know when we started collecting
     // the stats.
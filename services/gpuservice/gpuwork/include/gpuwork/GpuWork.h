@@ -20,12 +20,14 @@
 #include <stats_pull_atom_callback.h>
 #include <utils/Mutex.h>
 #include <utils/String16.h>
+#include <utils/Timers.h>
 #include <utils/Vector.h>
 
 #include <condition_variable>
 #include <cstdint>
 #include <functional>
 #include <thread>
+#include <vector>
 
 #include "gpuwork/gpuWork.h"
 
@@ -73,6 +75,15 @@ private:
     // Clears the |mGpuWorkMap| map.
     void clearMap() REQUIRES(mMutex);
 
+    // Resets the entry counter of |mGpuWorkGlobalDataMap| after clearing
+    // |mGpuWorkMap|, and records when that happened.
+    void resetMapEntryCount(GlobalData globalData) REQUIRES(mMutex);
+
+    // Reads all entries of the |mGpuWorkMap| map, with batched lookups when the
+    // kernel supports them, and updates |mMapReadStats|.
+    void readGpuWorkMap(std::vector<GpuIdUid>* keys, std::vector<UidTrackingInfo>* values)
+            REQUIRES(mMutex);
+
     // Waits for required permissions to become set. This seems to be needed
     // because platform service permissions might not be set when a service
     // first starts. See b/214085769.
@@ -97,6 +108,19 @@ private:
     // BPF map containing a single element for global data.
     bpf::BpfMap<uint32_t, GlobalData> mGpuWorkGlobalDataMap GUARDED_BY(mMutex);
 
+    // Whether the kernel supports batched BPF map operations. Cleared the first
+    // time one fails, after which maps are read entry by entry.
+    bool mBatchedMapOpsSupported GUARDED_BY(mMutex) = true;
+
+    // How long reading |mGpuWorkMap| takes, for |dump|.
+    struct MapReadStats {
+        uint64_t count = 0;
+        size_t lastEntryCount = 0;
+        nsecs_t lastDuration = 0;
+        nsecs_t maxDuration = 0;
+    };
+    MapReadStats mMapReadStats GUARDED_BY(mMutex);
+
     // When true, we are being destructed, so |mMapClearerThread| should stop.
     bool mIsTerminating GUARDED_BY(mMutex);
 
@@ -166,5 +166,29 @@ TEST_F(GpuMemTest, traverseGpuMemTotals) {
     EXPECT_EQ(sCount, TEST_KEY_COUNT);
 }
 
+TEST_F(GpuMemTest, emptyHistory) {
+    std::string result;
+    mGpuMem->dumpHistory(&result);
+
+    EXPECT_EQ(result, "GPU memory history: 0 samples\n");
+}
+
+TEST_F(GpuMemTest, historyOnlyRecordsChanges) {
+    ASSERT_RESULT_OK(mTestMap.writeValue(TEST_GLOBAL_KEY, TEST_GLOBAL_VAL, BPF_ANY));
+    ASSERT_RESULT_OK(mTestMap.writeValue(TEST_PROC_KEY_2, TEST_PROC_VAL_2, BPF_ANY));
+    mTestableGpuMem.setGpuMemTotalMap(mTestMap);
+
+    mGpuMem->sampleGpuMemTotals();
+    mGpuMem->sampleGpuMemTotals();
+
+    std::string result;
+    mGpuMem->dumpHistory(&result);
+    EXPECT_THAT(result, HasSubstr("GPU memory history: 1 samples\n"));
+    EXPECT_THAT(result, HasSubstr(StringPrintf(" 0 0 %" PRIu64 "\n", TEST_GLOBAL_VAL)));
+    EXPECT_THAT(result,
+                HasSubstr(StringPrintf(" %u %u %" PRIu64 "\n", (uint32_t)(TEST_PROC_KEY_2 >> 32),
+                                       (uint32_t)TEST_PROC_KEY_2, TEST_PROC_VAL_2)));
+}
+
 } // namespace
 } // namespace android
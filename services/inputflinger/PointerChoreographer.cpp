@@ -99,6 +99,15 @@ std::unordered_set<ui::LogicalDisplayId> getPrivacySensitiveDisplaysFromWindowIn
     return privacySensitiveDisplays;
 }
 
+// Every position change makes the PointerController update its sprite, so skip the events that
+// don't move the pointer, such as button presses and scrolls.
+void movePointer(PointerControllerInterface& pc, float deltaX, float deltaY) {
+    if (deltaX == 0 && deltaY == 0) {
+        return;
+    }
+    pc.move(deltaX, deltaY);
+}
+
 } // namespace
 
 // --- PointerChoreographer ---
@@ -239,12 +248,14 @@ NotifyMotionArgs PointerChoreographer::processMouseEventLocked(const NotifyMotio
         const float deltaY = args.yCursorPosition - y;
         newArgs.pointerCoords[0].setAxisValue(AMOTION_EVENT_AXIS_RELATIVE_X, deltaX);
         newArgs.pointerCoords[0].setAxisValue(AMOTION_EVENT_AXIS_RELATIVE_Y, deltaY);
-        pc.setPosition(args.xCursorPosition, args.yCursorPosition);
+        if (deltaX != 0 || deltaY != 0) {
+            pc.setPosition(args.xCursorPosition, args.yCursorPosition);
+        }
     } else {
         // This is a relative mouse, so move the cursor by the specified amount.
         const float deltaX = args.pointerCoords[0].getAxisValue(AMOTION_EVENT_AXIS_RELATIVE_X);
         const float deltaY = args.pointerCoords[0].getAxisValue(AMOTION_EVENT_AXIS_RELATIVE_Y);
-        pc.move(deltaX, deltaY);
+        movePointer(pc, deltaX, deltaY);
         const auto [x, y] = pc.getPosition();
         newArgs.pointerCoords[0].setAxisValue(AMOTION_EVENT_AXIS_X, x);
         newArgs.pointerCoords[0].setAxisValue(AMOTION_EVENT_AXIS_Y, y);
@@ -267,7 +278,7 @@ NotifyMotionArgs PointerChoreographer::processTouchpadEventLocked(const NotifyMo
         // This is a movement of the mouse pointer.
         const float deltaX = args.pointerCoords[0].getAxisValue(AMOTION_EVENT_AXIS_RELATIVE_X);
         const float deltaY = args.pointerCoords[0].getAxisValue(AMOTION_EVENT_AXIS_RELATIVE_Y);
-        pc.move(deltaX, deltaY);
+        movePointer(pc, deltaX, deltaY);
         if (canUnfadeOnDisplay(displayId)) {
             pc.unfade(PointerControllerInterface::Transition::IMMEDIATE);
         }
@@ -709,7 +709,12 @@ std::vector<NotifyMotionArgs> PalmRejector::processMotion(const NotifyMotionArgs
 
     std::optional<NotifyMotionArgs> touchOnlyArgs = removeStylusPointerIds(args);
     if (touchOnlyArgs) {
+        const nsecs_t filterStartTime = systemTime(SYSTEM_TIME_MONOTONIC);
         mSuppressedPointerIds = detectPalmPointers(*touchOnlyArgs);
+        const nsecs_t filterTime = systemTime(SYSTEM_TIME_MONOTONIC) - filterStartTime;
+        mMetrics.filteredEventCount++;
+        mMetrics.totalFilterTime += filterTime;
+        mMetrics.maxFilterTime = std::max(mMetrics.maxFilterTime, filterTime);
     } else {
         // This is a stylus-only event.
         // We can skip this event and just keep the suppressed pointer ids the same as before.
@@ -726,6 +731,13 @@ std::vector<NotifyMotionArgs> PalmRejector::processMotion(const NotifyMotionArgs
     // subset of oldSuppressedIds.
     if (!std::includes(oldSuppressedIds.begin(), oldSuppressedIds.end(),
                        mSuppressedPointerIds.begin(), mSuppressedPointerIds.end())) {
+        for (int32_t pointerId : mSuppressedPointerIds) {
+            if (oldSuppressedIds.find(pointerId) == oldSuppressedIds.end()) {
+                mMetrics.rejectedPointerCount++;
+            }
+        }
+        mMetrics.maxRejectionDelay =
+                std::max(mMetrics.maxRejectionDelay, args.eventTime - args.downTime);
         ALOGI("Palm detected, removing pointer ids %s after %" PRId64 "ms from %s",
               dumpSet(mSuppressedPointerIds).c_str(), ns2ms(args.eventTime - args.downTime),
               args.dump().c_str());
@@ -738,6 +750,10 @@ const AndroidPalmFilterDeviceInfo& PalmRejector::getPalmFilterDeviceInfo() const
     return mDeviceInfo;
 }
 
+const PalmRejector::Metrics& PalmRejector::getMetrics() const {
+    return mMetrics;
+}
+
 std::string PalmRejector::dump() const {
     std::string out;
     out += "mDeviceInfo:\n";
@@ -749,6 +765,15 @@ std::string PalmRejector::dump() const {
     out += addLinePrefix(mSlotState.dump(), "  ");
     out += "mSuppressedPointerIds: ";
     out += dumpSet(mSuppressedPointerIds) + "\n";
+    const nsecs_t averageFilterTime = mMetrics.filteredEventCount == 0
+            ? 0
+            : mMetrics.totalFilterTime / static_cast<nsecs_t>(mMetrics.filteredEventCount);
+    out += StringPrintf("mMetrics: filteredEvents=%zu, averageFilterTime=%" PRId64
+                        "us, maxFilterTime=%" PRId64 "us, rejectedPointers=%zu, "
+                        "maxRejectionDelay=%" PRId64 "ms\n",
+                        mMetrics.filteredEventCount, ns2us(averageFilterTime),
+                        ns2us(mMetrics.maxFilterTime), mMetrics.rejectedPointerCount,
+                        ns2ms(mMetrics.maxRejectionDelay));
     std::stringstream state;
     state << *mSharedPalmState;
     out += "mSharedPalmState: " + state.str() + "\n";
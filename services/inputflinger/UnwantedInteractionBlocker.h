@@ -20,6 +20,7 @@
 #include <set>
 
 #include <android-base/thread_annotations.h>
+#include <utils/Timers.h>
 #include "include/UnwantedInteractionBlockerInterface.h"
 #include "ui/events/ozone/evdev/touch_filter/neural_stylus_palm_detection_filter_util.h"
 #include "ui/events/ozone/evdev/touch_filter/palm_detection_filter.h"
@@ -170,6 +171,18 @@ public:
     const AndroidPalmFilterDeviceInfo& getPalmFilterDeviceInfo() const;
     std::string dump() const;
 
+    // The cost of running the palm detection model, and how it affected the event stream.
+    struct Metrics {
+        size_t filteredEventCount = 0;
+        nsecs_t totalFilterTime = 0;
+        nsecs_t maxFilterTime = 0;
+        // Pointers are only rejected after they have been forwarded for a while, so they get
+        // canceled. The delay is measured from the down time of the gesture.
+        size_t rejectedPointerCount = 0;
+        nsecs_t maxRejectionDelay = 0;
+    };
+    const Metrics& getMetrics() const;
+
 private:
     PalmRejector(const PalmRejector&) = delete;
     PalmRejector& operator=(const PalmRejector&) = delete;
@@ -186,6 +199,7 @@ private:
     AndroidPalmFilterDeviceInfo mDeviceInfo;
     std::unique_ptr<::ui::PalmDetectionFilter> mPalmDetectionFilter;
     std::set<int32_t> mSuppressedPointerIds;
+    Metrics mMetrics;
 
     // Used to help convert an Android touch stream to Linux input stream.
     SlotState mSlotState;
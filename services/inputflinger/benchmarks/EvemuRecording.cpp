@@ -0,0 +1,160 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "EvemuRecording.h"
+
+#include <android/keycodes.h>
+#include <linux/input.h>
+
+#include <sstream>
+
+namespace android {
+
+using namespace ftl::flag_operators;
+
+namespace {
+
+// Reads the bytes of a bitmap line, and sets the bits they contain, given the number of bytes of
+// the bitmap that were read from previous lines.
+template <typename Callback>
+bool readBitmapBytes(std::istringstream& line, size_t& bytesRead, Callback onBitSet) {
+    unsigned int byte;
+    while (line >> std::hex >> byte) {
+        if (byte > 0xff) {
+            return false;
+        }
+        for (int bit = 0; bit < 8; bit++) {
+            if (byte & (1 << bit)) {
+                onBitSet(bytesRead * 8 + bit);
+            }
+        }
+        bytesRead++;
+    }
+    return line.eof();
+}
+
+} // namespace
+
+base::Result<EvemuRecording> EvemuRecording::parse(std::istream& in) {
+    EvemuRecording recording;
+    size_t propertyBytesRead = 0;
+    std::map<int32_t /*type*/, size_t> bitmapBytesRead;
+    std::string text;
+    for (size_t lineNumber = 1; std::getline(in, text); lineNumber++) {
+        if (text.empty() || text[0] == '#') {
+            continue;
+        }
+        if (text.size() < 2 || text[1] != ':') {
+            return base::Error() << "Line " << lineNumber << ": expected a prefix: " << text;
+        }
+        std::istringstream line(text.substr(2));
+        bool valid = true;
+        switch (text[0]) {
+            case 'N': {
+                std::getline(line >> std::ws, recording.name);
+                break;
+            }
+            case 'I': {
+                line >> std::hex >> recording.bus;
+                valid = !line.fail();
+                break;
+            }
+            case 'P': {
+                valid = readBitmapBytes(line, propertyBytesRead, [&](int property) {
+                    recording.inputProperties.insert(property);
+                });
+                break;
+            }
+            case 'B': {
+                int32_t type;
+                if (!(line >> std::hex >> type)) {
+                    valid = false;
+                    break;
+                }
+                valid = readBitmapBytes(line, bitmapBytesRead[type], [&](int32_t code) {
+                    recording.codes[type].insert(code);
+                });
+                break;
+            }
+            case 'A': {
+                int32_t code;
+                AbsoluteAxis axis;
+                line >> std::hex >> code >> std::dec >> axis.minValue >> axis.maxValue >>
+                        axis.fuzz >> axis.flat >> axis.resolution;
+                valid = !line.fail();
+                if (valid) {
+                    recording.absoluteAxes[code] = axis;
+                }
+                break;
+            }
+            case 'E': {
+                int64_t seconds;
+                char dot;
+                int64_t micros;
+                Event event;
+                line >> std::dec >> seconds >> dot >> micros >> std::hex >> event.type >>
+                        event.code >> std::dec >> event.value;
+                valid = !line.fail() && dot == '.';
+                if (valid) {
+                    event.time = s2ns(seconds) + us2ns(micros);
+                    recording.events.push_back(event);
+                }
+                break;
+            }
+            default:
+                // Lines added by later versions of the format, such as LED and switch states.
+                break;
+        }
+        if (!valid) {
+            return base::Error() << "Line " << lineNumber << ": could not parse: " << text;
+        }
+    }
+    return recording;
+}
+
+base::Result<void> EvemuRecording::addDevice(FakeEventHub& eventHub, int32_t eventHubId) const {
+    if (absoluteAxes.count(ABS_MT_POSITION_X) == 0 || absoluteAxes.count(ABS_MT_POSITION_Y) == 0) {
+        return base::Error() << "'" << name << "' is not a multi-touch device";
+    }
+    const std::set<int32_t> noCodes;
+    const auto keysIt = codes.find(EV_KEY);
+    const std::set<int32_t>& keys = keysIt != codes.end() ? keysIt->second : noCodes;
+
+    // See EventHub::openDeviceLocked.
+    ftl::Flags<InputDeviceClass> classes = InputDeviceClass::TOUCH | InputDeviceClass::TOUCH_MT;
+    const bool hasStylusTool = keys.lower_bound(BTN_TOOL_PEN) != keys.lower_bound(BTN_TOOL_FINGER);
+    if (inputProperties.count(INPUT_PROP_POINTER) != 0 && !hasStylusTool) {
+        classes |= InputDeviceClass::TOUCHPAD;
+    }
+
+    eventHub.addDevice(eventHubId, name, classes, bus);
+    for (int property : inputProperties) {
+        eventHub.addInputProperty(eventHubId, property);
+    }
+    for (int32_t scanCode : keys) {
+        eventHub.addKey(eventHubId, scanCode, /*usageCode=*/0, AKEYCODE_UNKNOWN, /*flags=*/0);
+    }
+    for (const auto& [code, axis] : absoluteAxes) {
+        eventHub.addAbsoluteAxis(eventHubId, code, axis.minValue, axis.maxValue, axis.flat,
+                                 axis.fuzz, axis.resolution);
+    }
+    if (absoluteAxes.count(ABS_MT_SLOT) != 0) {
+        eventHub.setAbsoluteAxisValue(eventHubId, ABS_MT_SLOT, 0);
+    }
+    return {};
+}
+
+} // namespace android
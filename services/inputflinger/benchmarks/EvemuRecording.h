@@ -0,0 +1,68 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <android-base/result.h>
+#include <utils/Timers.h>
+
+#include <istream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../tests/FakeEventHub.h"
+
+namespace android {
+
+/**
+ * A device and its events, as recorded by evemu-record (see cmds/evemu-record).
+ */
+struct EvemuRecording {
+    struct AbsoluteAxis {
+        int32_t minValue;
+        int32_t maxValue;
+        int32_t fuzz;
+        int32_t flat;
+        int32_t resolution;
+    };
+
+    struct Event {
+        // Relative to the start of the recording.
+        nsecs_t time;
+        int32_t type;
+        int32_t code;
+        int32_t value;
+    };
+
+    std::string name;
+    int bus = 0;
+    std::set<int> inputProperties;
+    // The codes that the device supports, by event type.
+    std::map<int32_t /*type*/, std::set<int32_t>> codes;
+    std::map<int32_t /*code*/, AbsoluteAxis> absoluteAxes;
+    std::vector<Event> events;
+
+    // Parses the text format written by evemu-record.
+    static base::Result<EvemuRecording> parse(std::istream& in);
+
+    // Adds the recorded device to the event hub, with the classes EventHub would give it. Only
+    // multi-touch devices, touchscreens and touchpads, are supported.
+    base::Result<void> addDevice(FakeEventHub& eventHub, int32_t eventHubId) const;
+};
+
+} // namespace android
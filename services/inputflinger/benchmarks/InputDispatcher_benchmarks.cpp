@@ -16,8 +16,11 @@
 
 #include <benchmark/benchmark.h>
 
+#include <android-base/thread_annotations.h>
 #include <android/os/IInputConstants.h>
 #include <binder/Binder.h>
+#include <mutex>
+#include <variant>
 #include "../dispatcher/InputDispatcher.h"
 #include "../tests/FakeApplicationHandle.h"
 #include "../tests/FakeInputDispatcherPolicy.h"
@@ -73,6 +76,42 @@ static MotionEvent generateMotionEvent() {
     return event;
 }
 
+// A tracing backend that hands the traced events off the way ThreadedBackend does, but never
+// writes them anywhere.
+class QueueingTracingBackend : public trace::InputTracingBackendInterface {
+public:
+    void traceKeyEvent(const trace::TracedKeyEvent& event,
+                       const trace::TracedEventMetadata& metadata) override {
+        enqueue(event, metadata);
+    }
+    void traceMotionEvent(const trace::TracedMotionEvent& event,
+                          const trace::TracedEventMetadata& metadata) override {
+        enqueue(event, metadata);
+    }
+    void traceWindowDispatch(const trace::WindowDispatchArgs& args,
+                             const trace::TracedEventMetadata& metadata) override {
+        enqueue(args, metadata);
+    }
+
+private:
+    static constexpr size_t MAX_QUEUE_SIZE = 1000;
+
+    std::mutex mLock;
+    std::vector<std::pair<std::variant<trace::TracedKeyEvent, trace::TracedMotionEvent,
+                                       trace::WindowDispatchArgs>,
+                          trace::TracedEventMetadata>>
+            mQueue GUARDED_BY(mLock);
+
+    template <typename T>
+    void enqueue(const T& entry, const trace::TracedEventMetadata& metadata) {
+        std::scoped_lock lock(mLock);
+        if (mQueue.size() >= MAX_QUEUE_SIZE) {
+            mQueue.clear();
+        }
+        mQueue.emplace_back(entry, metadata);
+    }
+};
+
 static NotifyMotionArgs generateMotionArgs() {
     PointerProperties pointerProperties[1];
     PointerCoords pointerCoords[1];
@@ -135,6 +174,198 @@ static void benchmarkNotifyMotion(benchmark::State& state) {
     dispatcher->stop();
 }
 
+// Like benchmarkNotifyMotion, but each event goes to a spy window as well as to the window under
+// it, so the dispatcher creates and releases entries for several targets.
+static void benchmarkNotifyMotionWithSpy(benchmark::State& state) {
+    // Create dispatcher
+    FakeInputDispatcherPolicy fakePolicy;
+    auto dispatcher = std::make_unique<InputDispatcher>(fakePolicy);
+    dispatcher->setInputDispatchMode(/*enabled*/ true, /*frozen*/ false);
+    dispatcher->start();
+
+    // Create a spy window, and a window under it that will receive motion events
+    std::shared_ptr<FakeApplicationHandle> application = std::make_shared<FakeApplicationHandle>();
+    sp<FakeWindowHandle> spyWindow =
+            sp<FakeWindowHandle>::make(application, dispatcher, "Fake Spy Window", DISPLAY_ID);
+    spyWindow->setTrustedOverlay(true);
+    spyWindow->setSpy(true);
+    sp<FakeWindowHandle> window =
+            sp<FakeWindowHandle>::make(application, dispatcher, "Fake Window", DISPLAY_ID);
+
+    dispatcher->onWindowInfosChanged({{*spyWindow->getInfo(), *window->getInfo()}, {}, 0, 0});
+
+    NotifyMotionArgs motionArgs = generateMotionArgs();
+
+    for (auto _ : state) {
+        // Send ACTION_DOWN
+        motionArgs.action = AMOTION_EVENT_ACTION_DOWN;
+        motionArgs.downTime = now();
+        motionArgs.eventTime = motionArgs.downTime;
+        dispatcher->notifyMotion(motionArgs);
+
+        // Send ACTION_UP
+        motionArgs.action = AMOTION_EVENT_ACTION_UP;
+        motionArgs.eventTime = now();
+        dispatcher->notifyMotion(motionArgs);
+
+        spyWindow->consumeMotionEvent();
+        spyWindow->consumeMotionEvent();
+        window->consumeMotionEvent();
+        window->consumeMotionEvent();
+    }
+
+    dispatcher->stop();
+}
+
+// Like benchmarkNotifyMotionWithSpy, but with input tracing enabled, to measure the cost of tracing
+// on the dispatcher thread.
+static void benchmarkNotifyMotionWithTracing(benchmark::State& state) {
+    // Create dispatcher
+    FakeInputDispatcherPolicy fakePolicy;
+    auto dispatcher =
+            std::make_unique<InputDispatcher>(fakePolicy,
+                                              std::make_unique<QueueingTracingBackend>());
+    dispatcher->setInputDispatchMode(/*enabled*/ true, /*frozen*/ false);
+    dispatcher->start();
+
+    // Create a spy window, and a window under it that will receive motion events
+    std::shared_ptr<FakeApplicationHandle> application = std::make_shared<FakeApplicationHandle>();
+    sp<FakeWindowHandle> spyWindow =
+            sp<FakeWindowHandle>::make(application, dispatcher, "Fake Spy Window", DISPLAY_ID);
+    spyWindow->setTrustedOverlay(true);
+    spyWindow->setSpy(true);
+    sp<FakeWindowHandle> window =
+            sp<FakeWindowHandle>::make(application, dispatcher, "Fake Window", DISPLAY_ID);
+
+    dispatcher->onWindowInfosChanged({{*spyWindow->getInfo(), *window->getInfo()}, {}, 0, 0});
+
+    NotifyMotionArgs motionArgs = generateMotionArgs();
+
+    for (auto _ : state) {
+        // Send ACTION_DOWN
+        motionArgs.action = AMOTION_EVENT_ACTION_DOWN;
+        motionArgs.downTime = now();
+        motionArgs.eventTime = motionArgs.downTime;
+        dispatcher->notifyMotion(motionArgs);
+
+        // Send ACTION_UP
+        motionArgs.action = AMOTION_EVENT_ACTION_UP;
+        motionArgs.eventTime = now();
+        dispatcher->notifyMotion(motionArgs);
+
+        spyWindow->consumeMotionEvent();
+        spyWindow->consumeMotionEvent();
+        window->consumeMotionEvent();
+        window->consumeMotionEvent();
+    }
+
+    dispatcher->stop();
+}
+
+// Sends taps to a window at the bottom of state.range(0) other windows, like in a desktop session
+// with many freeform windows. Each ACTION_DOWN hit tests the windows on the display.
+static void benchmarkNotifyMotionWithManyWindows(benchmark::State& state) {
+    const int64_t windowCount = state.range(0);
+    // Create dispatcher
+    FakeInputDispatcherPolicy fakePolicy;
+    auto dispatcher = std::make_unique<InputDispatcher>(fakePolicy);
+    dispatcher->setInputDispatchMode(/*enabled*/ true, /*frozen*/ false);
+    dispatcher->start();
+
+    // Tile small windows over the display, and put the window that will receive motion events
+    // under them, where none of them overlaps the location of the taps.
+    std::shared_ptr<FakeApplicationHandle> application = std::make_shared<FakeApplicationHandle>();
+    std::vector<sp<FakeWindowHandle>> windows;
+    std::vector<gui::WindowInfo> windowInfos;
+    for (int64_t i = 0; i < windowCount; i++) {
+        sp<FakeWindowHandle> tile =
+                sp<FakeWindowHandle>::make(application, dispatcher,
+                                           "Fake Window " + std::to_string(i), DISPLAY_ID);
+        const int32_t left = 200 + (i % 10) * 80;
+        const int32_t top = 200 + (i / 10) * 80;
+        tile->setFrame(Rect(left, top, left + 80, top + 80));
+        windowInfos.push_back(*tile->getInfo());
+        windows.push_back(std::move(tile));
+    }
+    sp<FakeWindowHandle> window =
+            sp<FakeWindowHandle>::make(application, dispatcher, "Fake Window", DISPLAY_ID);
+    window->setFrame(Rect(0, 0, 1000, 2000));
+    windowInfos.push_back(*window->getInfo());
+
+    dispatcher->onWindowInfosChanged({windowInfos, {}, 0, 0});
+
+    NotifyMotionArgs motionArgs = generateMotionArgs();
+
+    for (auto _ : state) {
+        // Send ACTION_DOWN
+        motionArgs.action = AMOTION_EVENT_ACTION_DOWN;
+        motionArgs.downTime = now();
+        motionArgs.eventTime = motionArgs.downTime;
+        dispatcher->notifyMotion(motionArgs);
+
+        // Send ACTION_UP
+        motionArgs.action = AMOTION_EVENT_ACTION_UP;
+        motionArgs.eventTime = now();
+        dispatcher->notifyMotion(motionArgs);
+
+        window->consumeMotionEvent();
+        window->consumeMotionEvent();
+    }
+
+    dispatcher->stop();
+}
+
+// Sends a gesture with state.range(0) moves before the window consumes any of it, like a busy
+// application would. The events that do not fit in the channel pile up in the dispatcher, and are
+// published together as the window catches up.
+static void benchmarkNotifyMotionBurst(benchmark::State& state) {
+    const int64_t moveCount = state.range(0);
+    // Create dispatcher
+    FakeInputDispatcherPolicy fakePolicy;
+    auto dispatcher = std::make_unique<InputDispatcher>(fakePolicy);
+    dispatcher->setInputDispatchMode(/*enabled*/ true, /*frozen*/ false);
+    dispatcher->start();
+
+    // Create a window that will receive motion events
+    std::shared_ptr<FakeApplicationHandle> application = std::make_shared<FakeApplicationHandle>();
+    sp<FakeWindowHandle> window =
+            sp<FakeWindowHandle>::make(application, dispatcher, "Fake Window", DISPLAY_ID);
+
+    dispatcher->onWindowInfosChanged({{*window->getInfo()}, {}, 0, 0});
+
+    NotifyMotionArgs motionArgs = generateMotionArgs();
+
+    for (auto _ : state) {
+        motionArgs.action = AMOTION_EVENT_ACTION_DOWN;
+        motionArgs.downTime = now();
+        motionArgs.eventTime = motionArgs.downTime;
+        dispatcher->notifyMotion(motionArgs);
+
+        motionArgs.action = AMOTION_EVENT_ACTION_MOVE;
+        for (int64_t i = 0; i < moveCount; i++) {
+            motionArgs.eventTime = now();
+            dispatcher->notifyMotion(motionArgs);
+        }
+
+        motionArgs.action = AMOTION_EVENT_ACTION_UP;
+        motionArgs.eventTime = now();
+        dispatcher->notifyMotion(motionArgs);
+
+        // The window may receive the moves batched together, so consume until the gesture ends.
+        std::unique_ptr<MotionEvent> event;
+        do {
+            event = window->consumeMotionEvent();
+        } while (event != nullptr && event->getAction() != AMOTION_EVENT_ACTION_UP);
+        if (event == nullptr) {
+            state.SkipWithError("Did not receive the end of the gesture");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * (moveCount + 2));
+
+    dispatcher->stop();
+}
+
 static void benchmarkInjectMotion(benchmark::State& state) {
     // Create dispatcher
     FakeInputDispatcherPolicy fakePolicy;
@@ -198,6 +429,10 @@ static void benchmarkOnWindowInfosChanged(benchmark::State& state) {
 } // namespace
 
 BENCHMARK(benchmarkNotifyMotion);
+BENCHMARK(benchmarkNotifyMotionWithSpy);
+BENCHMARK(benchmarkNotifyMotionWithTracing);
+BENCHMARK(benchmarkNotifyMotionWithManyWindows)->Arg(10)->Arg(100);
+BENCHMARK(benchmarkNotifyMotionBurst)->Arg(10)->Arg(200);
 BENCHMARK(benchmarkInjectMotion);
 BENCHMARK(benchmarkOnWindowInfosChanged);
 
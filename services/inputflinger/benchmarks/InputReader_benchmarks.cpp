@@ -0,0 +1,222 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <android-base/file.h>
+#include <linux/input.h>
+#include <log/log.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+
+#include "../tests/FakeEventHub.h"
+#include "../tests/FakeInputReaderPolicy.h"
+#include "../tests/InstrumentedInputReader.h"
+#include "EvemuRecording.h"
+
+namespace {
+
+// The number of allocations made through operator new, so that the benchmarks can report how many
+// allocations the reader makes per event.
+std::atomic<size_t> sAllocationCount{0};
+
+} // namespace
+
+void* operator new(size_t size) {
+    sAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) {
+        std::abort();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+namespace android {
+
+using namespace ftl::flag_operators;
+
+namespace {
+
+constexpr int32_t EVENTHUB_ID = 1;
+constexpr int32_t DISPLAY_WIDTH = 2560;
+constexpr int32_t DISPLAY_HEIGHT = 1600;
+constexpr int32_t MAX_SLOT = 9;
+
+static nsecs_t now() {
+    return systemTime(SYSTEM_TIME_MONOTONIC);
+}
+
+// An InputListener that drops everything the reader notifies it of.
+class NullInputListener : public InputListenerInterface {
+public:
+    void notifyInputDevicesChanged(const NotifyInputDevicesChangedArgs&) override {}
+    void notifyKey(const NotifyKeyArgs&) override {}
+    void notifyMotion(const NotifyMotionArgs&) override {}
+    void notifySwitch(const NotifySwitchArgs&) override {}
+    void notifySensor(const NotifySensorArgs&) override {}
+    void notifyVibratorState(const NotifyVibratorStateArgs&) override {}
+    void notifyDeviceReset(const NotifyDeviceResetArgs&) override {}
+    void notifyPointerCaptureChanged(const NotifyPointerCaptureChangedArgs&) override {}
+};
+
+void addMultiTouchScreen(FakeEventHub& eventHub) {
+    eventHub.addDevice(EVENTHUB_ID, "Fake Touchscreen",
+                       InputDeviceClass::TOUCH | InputDeviceClass::TOUCH_MT);
+    eventHub.addConfigurationProperty(EVENTHUB_ID, "touch.deviceType", "touchScreen");
+    eventHub.addAbsoluteAxis(EVENTHUB_ID, ABS_MT_POSITION_X, 0, DISPLAY_WIDTH - 1, 0, 0);
+    eventHub.addAbsoluteAxis(EVENTHUB_ID, ABS_MT_POSITION_Y, 0, DISPLAY_HEIGHT - 1, 0, 0);
+    eventHub.addAbsoluteAxis(EVENTHUB_ID, ABS_MT_TOUCH_MAJOR, 0, 255, 0, 0);
+    eventHub.addAbsoluteAxis(EVENTHUB_ID, ABS_MT_PRESSURE, 0, 255, 0, 0);
+    eventHub.addAbsoluteAxis(EVENTHUB_ID, ABS_MT_TRACKING_ID, 0, 65535, 0, 0);
+    eventHub.addAbsoluteAxis(EVENTHUB_ID, ABS_MT_SLOT, 0, MAX_SLOT, 0, 0);
+    eventHub.setAbsoluteAxisValue(EVENTHUB_ID, ABS_MT_SLOT, 0);
+}
+
+// Reports a frame of 'pointerCount' pointers, each 'offset' pixels away from its initial position.
+void enqueueFrame(FakeEventHub& eventHub, int32_t pointerCount, int32_t offset, bool isDown) {
+    const nsecs_t when = now();
+    for (int32_t slot = 0; slot < pointerCount; slot++) {
+        eventHub.enqueueEvent(when, when, EVENTHUB_ID, EV_ABS, ABS_MT_SLOT, slot);
+        if (isDown) {
+            eventHub.enqueueEvent(when, when, EVENTHUB_ID, EV_ABS, ABS_MT_TRACKING_ID, slot);
+        }
+        eventHub.enqueueEvent(when, when, EVENTHUB_ID, EV_ABS, ABS_MT_POSITION_X,
+                              100 + slot * 200 + offset);
+        eventHub.enqueueEvent(when, when, EVENTHUB_ID, EV_ABS, ABS_MT_POSITION_Y, 800 + offset);
+        eventHub.enqueueEvent(when, when, EVENTHUB_ID, EV_ABS, ABS_MT_TOUCH_MAJOR, 20 + slot);
+        eventHub.enqueueEvent(when, when, EVENTHUB_ID, EV_ABS, ABS_MT_PRESSURE, 100 + slot);
+    }
+    eventHub.enqueueEvent(when, when, EVENTHUB_ID, EV_SYN, SYN_REPORT, 0);
+}
+
+void addViewport(FakeInputReaderPolicy& policy) {
+    policy.addDisplayViewport(ui::LogicalDisplayId::DEFAULT, DISPLAY_WIDTH, DISPLAY_HEIGHT,
+                              ui::ROTATION_0, /*isActive=*/true, "local:0",
+                              /*physicalPort=*/std::nullopt, ViewportType::INTERNAL);
+}
+
+EvemuRecording loadRecording(const char* fileName) {
+    const std::string path = base::GetExecutableDirectory() + "/data/" + fileName;
+    std::ifstream file(path);
+    LOG_ALWAYS_FATAL_IF(!file, "Could not open %s", path.c_str());
+    base::Result<EvemuRecording> recording = EvemuRecording::parse(file);
+    LOG_ALWAYS_FATAL_IF(!recording.ok(), "Could not parse %s: %s", path.c_str(),
+                        recording.error().message().c_str());
+    return *std::move(recording);
+}
+
+// Splits the events of a recording into the frames that end with each SYN_REPORT.
+std::vector<std::vector<EvemuRecording::Event>> splitIntoFrames(const EvemuRecording& recording) {
+    std::vector<std::vector<EvemuRecording::Event>> frames(1);
+    for (const EvemuRecording::Event& event : recording.events) {
+        frames.back().push_back(event);
+        if (event.type == EV_SYN && event.code == SYN_REPORT) {
+            frames.emplace_back();
+        }
+    }
+    if (frames.back().empty()) {
+        frames.pop_back();
+    }
+    return frames;
+}
+
+} // namespace
+
+// Moves state.range(0) pointers on a multi-touch screen, and measures the time the reader takes
+// to turn each frame of raw events into a motion event.
+static void benchmarkMultiTouchMove(benchmark::State& state) {
+    const int32_t pointerCount = state.range(0);
+    auto eventHub = std::make_shared<FakeEventHub>();
+    sp<FakeInputReaderPolicy> policy = sp<FakeInputReaderPolicy>::make();
+    addViewport(*policy);
+    NullInputListener listener;
+    InstrumentedInputReader reader(eventHub, policy, listener);
+
+    addMultiTouchScreen(*eventHub);
+    reader.loopOnce();
+
+    // Put all of the pointers down.
+    enqueueFrame(*eventHub, pointerCount, /*offset=*/0, /*isDown=*/true);
+    reader.loopOnce();
+
+    int32_t offset = 0;
+    for (auto _ : state) {
+        offset = (offset + 1) % 100;
+        enqueueFrame(*eventHub, pointerCount, offset, /*isDown=*/false);
+        reader.loopOnce();
+    }
+}
+
+BENCHMARK(benchmarkMultiTouchMove)->Arg(1)->Arg(10);
+
+// Replays a recording made with evemu-record through the reader, one frame per loop, and reports
+// the time and the number of allocations the reader needs per raw event. Which mappers are
+// exercised depends on the recorded device: MultiTouchInputMapper for touchscreens, and
+// TouchpadInputMapper with its GestureConverter for touchpads.
+static void benchmarkReplayRecording(benchmark::State& state, const char* fileName) {
+    const EvemuRecording recording = loadRecording(fileName);
+    const std::vector<std::vector<EvemuRecording::Event>> frames = splitIntoFrames(recording);
+    auto eventHub = std::make_shared<FakeEventHub>();
+    sp<FakeInputReaderPolicy> policy = sp<FakeInputReaderPolicy>::make();
+    addViewport(*policy);
+    NullInputListener listener;
+    InstrumentedInputReader reader(eventHub, policy, listener);
+
+    if (base::Result<void> result = recording.addDevice(*eventHub, EVENTHUB_ID); !result.ok()) {
+        state.SkipWithError(result.error().message().c_str());
+        return;
+    }
+    reader.loopOnce();
+
+    // Each replay is shifted past the end of the previous one, so that time never goes backwards.
+    const nsecs_t duration = recording.events.empty() ? 0 : recording.events.back().time;
+    nsecs_t replayStartTime = now();
+    size_t readerAllocations = 0;
+    for (auto _ : state) {
+        for (const std::vector<EvemuRecording::Event>& frame : frames) {
+            for (const EvemuRecording::Event& event : frame) {
+                const nsecs_t when = replayStartTime + event.time;
+                eventHub->enqueueEvent(when, when, EVENTHUB_ID, event.type, event.code,
+                                       event.value);
+            }
+            // Only count what the reader allocates, not the fake event hub's queue.
+            const size_t allocationsBefore = sAllocationCount.load(std::memory_order_relaxed);
+            reader.loopOnce();
+            readerAllocations +=
+                    sAllocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+        }
+        replayStartTime += duration + ms2ns(100);
+    }
+
+    const int64_t eventCount = state.iterations() * static_cast<int64_t>(recording.events.size());
+    state.SetItemsProcessed(eventCount);
+    state.counters["allocs/event"] =
+            benchmark::Counter(eventCount == 0 ? 0 : double(readerAllocations) / eventCount);
+}
+
+BENCHMARK_CAPTURE(benchmarkReplayRecording, touchscreen_drag, "multitouch_screen_drag.evemu");
+BENCHMARK_CAPTURE(benchmarkReplayRecording, touchpad_scroll, "touchpad_two_finger_scroll.evemu");
+
+} // namespace android
+
+BENCHMARK_MAIN();
@@ -174,8 +174,8 @@ struct MotionEntry : EventEntry {
                 int32_t metaState, int32_t buttonState, MotionClassification classification,
                 int32_t edgeFlags, float xPrecision, float yPrecision, float xCursorPosition,
                 float yCursorPosition, nsecs_t downTime,
-                const std::vector<PointerProperties>& pointerProperties,
-                const std::vector<PointerCoords>& pointerCoords);
+                std::vector<PointerProperties> pointerProperties,
+                std::vector<PointerCoords> pointerCoords);
     std::string getDescription() const override;
 };
 
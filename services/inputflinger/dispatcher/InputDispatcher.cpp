@@ -39,11 +39,13 @@
 #include <unistd.h>
 #include <utils/Trace.h>
 
+#include <algorithm>
 #include <cerrno>
 #include <cinttypes>
 #include <climits>
 #include <cstddef>
 #include <ctime>
+#include <iterator>
 #include <queue>
 #include <sstream>
 
@@ -155,6 +157,13 @@ constexpr std::chrono::milliseconds SLOW_INTERCEPTION_THRESHOLD = 50ms;
 // Number of recent events to keep for debugging purposes.
 constexpr size_t RECENT_QUEUE_MAX_SIZE = 10;
 
+// Maximum number of motion events sent to a connection together.
+constexpr size_t MAX_MOTION_BATCH_SIZE = 16;
+
+// The number of released motion entries kept for reuse. Covers the events in flight for a touch
+// stream dispatched to a few windows.
+constexpr size_t MOTION_ENTRY_POOL_CAPACITY = 32;
+
 // Event log tags. See EventLogTags.logtags for reference.
 constexpr int LOGTAG_INPUT_INTERACTION = 62000;
 constexpr int LOGTAG_INPUT_FOCUS = 62001;
@@ -397,6 +406,7 @@ size_t firstMarkedBit(T set) {
 }
 
 std::unique_ptr<DispatchEntry> createDispatchEntry(const IdGenerator& idGenerator,
+                                                   MotionEntryPool& motionEntryPool,
                                                    const InputTarget& inputTarget,
                                                    std::shared_ptr<const EventEntry> eventEntry,
                                                    ftl::Flags<InputTarget::Flags> inputTargetFlags,
@@ -454,18 +464,17 @@ std::unique_ptr<DispatchEntry> createDispatchEntry(const IdGenerator& idGenerato
         }
     }
 
-    std::unique_ptr<MotionEntry> combinedMotionEntry =
-            std::make_unique<MotionEntry>(idGenerator.nextId(), motionEntry.injectionState,
-                                          motionEntry.eventTime, motionEntry.deviceId,
-                                          motionEntry.source, motionEntry.displayId,
-                                          motionEntry.policyFlags, motionEntry.action,
-                                          motionEntry.actionButton, motionEntry.flags,
-                                          motionEntry.metaState, motionEntry.buttonState,
-                                          motionEntry.classification, motionEntry.edgeFlags,
-                                          motionEntry.xPrecision, motionEntry.yPrecision,
-                                          motionEntry.xCursorPosition, motionEntry.yCursorPosition,
-                                          motionEntry.downTime, motionEntry.pointerProperties,
-                                          pointerCoords);
+    std::shared_ptr<MotionEntry> combinedMotionEntry =
+            motionEntryPool.obtain(idGenerator.nextId(), motionEntry.injectionState,
+                                   motionEntry.eventTime, motionEntry.deviceId, motionEntry.source,
+                                   motionEntry.displayId, motionEntry.policyFlags,
+                                   motionEntry.action, motionEntry.actionButton, motionEntry.flags,
+                                   motionEntry.metaState, motionEntry.buttonState,
+                                   motionEntry.classification, motionEntry.edgeFlags,
+                                   motionEntry.xPrecision, motionEntry.yPrecision,
+                                   motionEntry.xCursorPosition, motionEntry.yCursorPosition,
+                                   motionEntry.downTime, motionEntry.pointerProperties,
+                                   pointerCoords);
     if (tracer) {
         combinedMotionEntry->traceTracker =
                 tracer->traceDerivedEvent(*combinedMotionEntry, *motionEntry.traceTracker);
@@ -572,6 +581,33 @@ bool isUserActivityEvent(const EventEntry& eventEntry) {
     }
 }
 
+// Returns whether transform.transform(region) contains the point, without building the transformed
+// region. The rects are transformed one at a time, after a quick check against the bounds.
+bool transformedRegionContains(const Region& region, const ui::Transform& transform, int x, int y) {
+    const auto rectContains = [x, y](const Rect& rect) {
+        return x >= rect.left && x < rect.right && y >= rect.top && y < rect.bottom;
+    };
+    if (transform.getType() <= ui::Transform::TRANSLATE) {
+        // Transform::transform translates regions by the rounded offset.
+        const int dx = static_cast<int>(std::floor(transform.tx() + 0.5f));
+        const int dy = static_cast<int>(std::floor(transform.ty() + 0.5f));
+        return region.contains(x - dx, y - dy);
+    }
+    if (!rectContains(transform.transform(region.getBounds()))) {
+        return false;
+    }
+    if (!transform.preserveRects()) {
+        // Such regions are transformed to the transformed bounds.
+        return true;
+    }
+    for (const Rect& rect : region) {
+        if (rectContains(transform.transform(rect))) {
+            return true;
+        }
+    }
+    return false;
+}
+
 // Returns true if the given window can accept pointer events at the given display location.
 bool windowAcceptsTouchAt(const WindowInfo& windowInfo, ui::LogicalDisplayId displayId, float x,
                           float y, bool isStylus, const ui::Transform& displayTransform) {
@@ -592,12 +628,10 @@ bool windowAcceptsTouchAt(const WindowInfo& windowInfo, ui::LogicalDisplayId dis
     // "bottom" of the window will be different in the display (un-rotated) space compared to in the
     // logical display in which WM determined the bounds. Perform the hit test in the logical
     // display space to ensure these edges are considered correctly in all orientations.
-    const auto touchableRegion = displayTransform.transform(windowInfo.touchableRegion);
     const auto p = displayTransform.transform(x, y);
-    if (!touchableRegion.contains(std::floor(p.x), std::floor(p.y))) {
-        return false;
-    }
-    return true;
+    return transformedRegionContains(windowInfo.touchableRegion, displayTransform,
+                                     static_cast<int>(std::floor(p.x)),
+                                     static_cast<int>(std::floor(p.y)));
 }
 
 // Returns true if the given window's frame can occlude pointer events at the given display
@@ -924,6 +958,18 @@ Error<EnumErrorWrapper<InputEventInjectionResult>> injectionError(InputEventInje
             std::forward<InputEventInjectionResult>(e));
 }
 
+// The number of motion events, up to MAX_MOTION_BATCH_SIZE, at the front of the outbound queue.
+size_t countLeadingMotionEntries(const Connection& connection) {
+    size_t count = 0;
+    for (const std::unique_ptr<DispatchEntry>& entry : connection.outboundQueue) {
+        if (count == MAX_MOTION_BATCH_SIZE || entry->eventEntry->type != EventEntry::Type::MOTION) {
+            break;
+        }
+        count++;
+    }
+    return count;
+}
+
 } // namespace
 
 // --- InputDispatcher ---
@@ -934,6 +980,7 @@ InputDispatcher::InputDispatcher(InputDispatcherPolicyInterface& policy)
 InputDispatcher::InputDispatcher(InputDispatcherPolicyInterface& policy,
                                  std::unique_ptr<trace::InputTracingBackendInterface> traceBackend)
       : mPolicy(policy),
+        mMotionEntryPool(MOTION_ENTRY_POOL_CAPACITY),
         mPendingEvent(nullptr),
         mLastDropReason(DropReason::NOT_DROPPED),
         mIdGenerator(IdGenerator::Source::INPUT_DISPATCHER),
@@ -948,7 +995,12 @@ InputDispatcher::InputDispatcher(InputDispatcherPolicyInterface& policy,
         mWindowTokenWithPointerCapture(nullptr),
         mAwaitedApplicationDisplayId(ui::LogicalDisplayId::INVALID),
         mLatencyAggregator(),
-        mLatencyTracker(&mLatencyAggregator) {
+        // The timelines are processed by mLatencyTracker, with mLock held.
+        mLatencyHistograms(LatencyHistograms::getConfiguredSamplingInterval(),
+                           [this](const sp<IBinder>& connectionToken) NO_THREAD_SAFETY_ANALYSIS {
+                               return getConnectionNameLocked(connectionToken);
+                           }),
+        mLatencyTracker({&mLatencyAggregator, &mLatencyHistograms}) {
     mLooper = sp<Looper>::make(false);
     mReporter = createInputReporter();
 
@@ -1341,7 +1393,7 @@ bool InputDispatcher::shouldPruneInboundQueueLocked(const MotionEntry& motionEnt
     return false;
 }
 
-bool InputDispatcher::enqueueInboundEventLocked(std::unique_ptr<EventEntry> newEntry) {
+bool InputDispatcher::enqueueInboundEventLocked(std::shared_ptr<EventEntry> newEntry) {
     bool needWake = mInboundQueue.empty();
     mInboundQueue.push_back(std::move(newEntry));
     const EventEntry& entry = *(mInboundQueue.back());
@@ -1432,9 +1484,11 @@ void InputDispatcher::addRecentEventLocked(std::shared_ptr<const EventEntry> ent
 sp<WindowInfoHandle> InputDispatcher::findTouchedWindowAtLocked(ui::LogicalDisplayId displayId,
                                                                 float x, float y, bool isStylus,
                                                                 bool ignoreDragWindow) const {
-    // Traverse windows from front to back to find touched window.
+    // Traverse windows from front to back to find touched window. Only the windows whose
+    // touchable region may contain the location need to be hit tested.
     const auto& windowHandles = getWindowHandlesLocked(displayId);
-    for (const sp<WindowInfoHandle>& windowHandle : windowHandles) {
+    for (size_t position : getWindowHitIndexLocked(displayId).findCandidates(x, y)) {
+        const sp<WindowInfoHandle>& windowHandle = windowHandles[position];
         if (ignoreDragWindow && haveSameToken(windowHandle, mDragState->dragWindow)) {
             continue;
         }
@@ -1478,10 +1532,20 @@ std::vector<InputTarget> InputDispatcher::findOutsideTargetsLocked(
 
 std::vector<sp<WindowInfoHandle>> InputDispatcher::findTouchedSpyWindowsAtLocked(
         ui::LogicalDisplayId displayId, float x, float y, bool isStylus, DeviceId deviceId) const {
-    // Traverse windows from front to back and gather the touched spy windows.
+    // Traverse windows from front to back and gather the touched spy windows. Windows that don't
+    // support split touch may get the pointer even if they are not touched, so they are traversed
+    // along with the windows whose touchable region may contain the location.
     std::vector<sp<WindowInfoHandle>> spyWindows;
     const auto& windowHandles = getWindowHandlesLocked(displayId);
-    for (const sp<WindowInfoHandle>& windowHandle : windowHandles) {
+    const WindowHitIndex& hitIndex = getWindowHitIndexLocked(displayId);
+    const std::vector<size_t>& candidates = hitIndex.findCandidates(x, y);
+    const std::vector<size_t>& unsplittable = hitIndex.getUnsplittable();
+    std::vector<size_t> positions;
+    positions.reserve(candidates.size() + unsplittable.size());
+    std::set_union(candidates.begin(), candidates.end(), unsplittable.begin(), unsplittable.end(),
+                   std::back_inserter(positions));
+    for (size_t position : positions) {
+        const sp<WindowInfoHandle>& windowHandle = windowHandles[position];
         const WindowInfo& info = *windowHandle->getInfo();
         if (!windowAcceptsTouchAt(info, displayId, x, y, isStylus, getTransformLocked(displayId))) {
             // Generally, we would skip any pointer that's outside of the window. However, if the
@@ -2178,9 +2242,20 @@ void InputDispatcher::dispatchEventLocked(nsecs_t currentTime,
 
     pokeUserActivityLocked(*eventEntry);
 
+    // Enqueue the event for every target before publishing anything, then start the dispatch
+    // cycle of each connection that had nothing to send. A connection that is the target of the
+    // event several times gets all of its entries in one batch.
+    std::vector<std::shared_ptr<Connection>> connectionsToStart;
     for (const InputTarget& inputTarget : inputTargets) {
-        std::shared_ptr<Connection> connection = inputTarget.connection;
+        const std::shared_ptr<Connection>& connection = inputTarget.connection;
+        const bool wasEmpty = connection->outboundQueue.empty();
         prepareDispatchCycleLocked(currentTime, connection, eventEntry, inputTarget);
+        if (wasEmpty && !connection->outboundQueue.empty()) {
+            connectionsToStart.push_back(connection);
+        }
+    }
+    for (const std::shared_ptr<Connection>& connection : connectionsToStart) {
+        startDispatchCycleLocked(currentTime, connection);
     }
 }
 
@@ -2842,17 +2917,20 @@ InputDispatcher::findTouchedWindowTargetsLocked(nsecs_t currentTime, const Motio
 
     // Save changes unless the action was scroll in which case the temporary touch
     // state was only valid for this one action.
-    if (maskedAction != AMOTION_EVENT_ACTION_SCROLL) {
-        if (displayId >= ui::LogicalDisplayId::DEFAULT) {
-            tempTouchState.clearWindowsWithoutPointers();
-            mTouchStatesByDisplay[displayId] = tempTouchState;
-        } else {
-            mTouchStatesByDisplay.erase(displayId);
-        }
+    const bool saveTouchState = maskedAction != AMOTION_EVENT_ACTION_SCROLL &&
+            displayId >= ui::LogicalDisplayId::DEFAULT;
+    if (saveTouchState) {
+        tempTouchState.clearWindowsWithoutPointers();
     }
 
     if (tempTouchState.windows.empty()) {
         mTouchStatesByDisplay.erase(displayId);
+    } else if (saveTouchState) {
+        // The temporary state isn't used past this point, so move it rather than copying every
+        // touched window and its pointers again.
+        mTouchStatesByDisplay[displayId] = std::move(tempTouchState);
+    } else if (maskedAction != AMOTION_EVENT_ACTION_SCROLL) {
+        mTouchStatesByDisplay.erase(displayId);
     }
 
     return targets;
@@ -3154,10 +3232,14 @@ InputDispatcher::TouchOcclusionInfo InputDispatcher::computeTouchOcclusionInfoLo
     info.obscuringOpacity = 0;
     info.obscuringUid = gui::Uid::INVALID;
     std::map<gui::Uid, float> opacityByUid;
-    for (const sp<WindowInfoHandle>& otherHandle : windowHandles) {
-        if (windowHandle == otherHandle) {
+    // Only the windows whose frame may contain the location can occlude the touch.
+    const WindowHitIndex& hitIndex = getWindowHitIndexLocked(displayId);
+    const size_t windowPosition = hitIndex.getPosition(windowHandle);
+    for (size_t position : hitIndex.findOccluders(x, y)) {
+        if (position >= windowPosition) {
             break; // All future windows are below us. Exit early.
         }
+        const sp<WindowInfoHandle>& otherHandle = windowHandles[position];
         const WindowInfo* otherInfo = otherHandle->getInfo();
         if (canBeObscuredBy(windowHandle, otherHandle) &&
             windowOccludesTouchAt(*otherInfo, displayId, x, y, getTransformLocked(displayId)) &&
@@ -3233,10 +3315,13 @@ bool InputDispatcher::isWindowObscuredAtPointLocked(const sp<WindowInfoHandle>&
                                                     float x, float y) const {
     ui::LogicalDisplayId displayId = windowHandle->getInfo()->displayId;
     const std::vector<sp<WindowInfoHandle>>& windowHandles = getWindowHandlesLocked(displayId);
-    for (const sp<WindowInfoHandle>& otherHandle : windowHandles) {
-        if (windowHandle == otherHandle) {
+    const WindowHitIndex& hitIndex = getWindowHitIndexLocked(displayId);
+    const size_t windowPosition = hitIndex.getPosition(windowHandle);
+    for (size_t position : hitIndex.findOccluders(x, y)) {
+        if (position >= windowPosition) {
             break; // All future windows are below us. Exit early.
         }
+        const sp<WindowInfoHandle>& otherHandle = windowHandles[position];
         const WindowInfo* otherInfo = otherHandle->getInfo();
         if (canBeObscuredBy(windowHandle, otherHandle) &&
             windowOccludesTouchAt(*otherInfo, displayId, x, y, getTransformLocked(displayId))) {
@@ -3399,7 +3484,7 @@ void InputDispatcher::prepareDispatchCycleLocked(nsecs_t currentTime,
                            << connection->getInputChannelName() << " for "
                            << originalMotionEntry.getDescription();
             }
-            std::unique_ptr<MotionEntry> splitMotionEntry =
+            std::shared_ptr<MotionEntry> splitMotionEntry =
                     splitMotionEvent(originalMotionEntry, inputTarget.getPointerIds(),
                                      inputTarget.firstDownTimeInTarget.value());
             if (!splitMotionEntry) {
@@ -3415,34 +3500,13 @@ void InputDispatcher::prepareDispatchCycleLocked(nsecs_t currentTime,
                       connection->getInputChannelName().c_str());
                 logOutboundMotionDetails("  ", *splitMotionEntry);
             }
-            enqueueDispatchEntryAndStartDispatchCycleLocked(currentTime, connection,
-                                                            std::move(splitMotionEntry),
-                                                            inputTarget);
+            enqueueDispatchEntryLocked(connection, std::move(splitMotionEntry), inputTarget);
             return;
         }
     }
 
     // Not splitting.  Enqueue dispatch entries for the event as is.
-    enqueueDispatchEntryAndStartDispatchCycleLocked(currentTime, connection, eventEntry,
-                                                    inputTarget);
-}
-
-void InputDispatcher::enqueueDispatchEntryAndStartDispatchCycleLocked(
-        nsecs_t currentTime, const std::shared_ptr<Connection>& connection,
-        std::shared_ptr<const EventEntry> eventEntry, const InputTarget& inputTarget) {
-    ATRACE_NAME_IF(ATRACE_ENABLED(),
-                   StringPrintf("enqueueDispatchEntryAndStartDispatchCycleLocked(inputChannel=%s, "
-                                "id=0x%" PRIx32 ")",
-                                connection->getInputChannelName().c_str(), eventEntry->id));
-
-    const bool wasEmpty = connection->outboundQueue.empty();
-
     enqueueDispatchEntryLocked(connection, eventEntry, inputTarget);
-
-    // If the outbound queue was previously empty, start the dispatch cycle going.
-    if (wasEmpty && !connection->outboundQueue.empty()) {
-        startDispatchCycleLocked(currentTime, connection);
-    }
 }
 
 void InputDispatcher::enqueueDispatchEntryLocked(const std::shared_ptr<Connection>& connection,
@@ -3458,8 +3522,8 @@ void InputDispatcher::enqueueDispatchEntryLocked(const std::shared_ptr<Connectio
     // This is a new event.
     // Enqueue a new dispatch entry onto the outbound queue for this connection.
     std::unique_ptr<DispatchEntry> dispatchEntry =
-            createDispatchEntry(mIdGenerator, inputTarget, eventEntry, inputTarget.flags,
-                                mWindowInfosVsyncId, mTracer.get());
+            createDispatchEntry(mIdGenerator, mMotionEntryPool, inputTarget, eventEntry,
+                                inputTarget.flags, mWindowInfosVsyncId, mTracer.get());
 
     // Use the eventEntry from dispatchEntry since the entry may have changed and can now be a
     // different EventEntry than what was passed in.
@@ -3594,7 +3658,8 @@ void InputDispatcher::enqueueDispatchEntryLocked(const std::shared_ptr<Connectio
                             mTracer->traceDerivedEvent(*cancelEvent, *resolvedMotion->traceTracker);
                 }
                 std::unique_ptr<DispatchEntry> cancelDispatchEntry =
-                        createDispatchEntry(mIdGenerator, inputTarget, std::move(cancelEvent),
+                        createDispatchEntry(mIdGenerator, mMotionEntryPool, inputTarget,
+                                            std::move(cancelEvent),
                                             ftl::Flags<InputTarget::Flags>(), mWindowInfosVsyncId,
                                             mTracer.get());
 
@@ -3802,6 +3867,15 @@ void InputDispatcher::startDispatchCycleLocked(nsecs_t currentTime,
     }
 
     while (connection->status == Connection::Status::NORMAL && !connection->outboundQueue.empty()) {
+        // Consecutive motion events, such as those that piled up while the application was busy,
+        // are sent to the channel together.
+        if (const size_t batchSize = countLeadingMotionEntries(*connection); batchSize > 1) {
+            if (!publishMotionBatchLocked(currentTime, connection, batchSize)) {
+                return;
+            }
+            continue;
+        }
+
         std::unique_ptr<DispatchEntry>& dispatchEntry = connection->outboundQueue.front();
         dispatchEntry->deliveryTime = currentTime;
         const std::chrono::nanoseconds timeout = getDispatchingTimeoutLocked(connection);
@@ -3900,44 +3974,105 @@ void InputDispatcher::startDispatchCycleLocked(nsecs_t currentTime,
 
         // Check the result.
         if (status) {
-            if (status == WOULD_BLOCK) {
-                if (connection->waitQueue.empty()) {
-                    ALOGE("channel '%s' ~ Could not publish event because the pipe is full. "
-                          "This is unexpected because the wait queue is empty, so the pipe "
-                          "should be empty and we shouldn't have any problems writing an "
-                          "event to it, status=%s(%d)",
-                          connection->getInputChannelName().c_str(), statusToString(status).c_str(),
-                          status);
-                    abortBrokenDispatchCycleLocked(currentTime, connection, /*notify=*/true);
-                } else {
-                    // Pipe is full and we are waiting for the app to finish process some events
-                    // before sending more events to it.
-                    if (DEBUG_DISPATCH_CYCLE) {
-                        ALOGD("channel '%s' ~ Could not publish event because the pipe is full, "
-                              "waiting for the application to catch up",
-                              connection->getInputChannelName().c_str());
-                    }
-                }
-            } else {
-                ALOGE("channel '%s' ~ Could not publish event due to an unexpected error, "
-                      "status=%s(%d)",
-                      connection->getInputChannelName().c_str(), statusToString(status).c_str(),
-                      status);
-                abortBrokenDispatchCycleLocked(currentTime, connection, /*notify=*/true);
-            }
+            handlePublishErrorLocked(currentTime, connection, status);
             return;
         }
 
         // Re-enqueue the event on the wait queue.
-        const nsecs_t timeoutTime = dispatchEntry->timeoutTime;
-        connection->waitQueue.emplace_back(std::move(dispatchEntry));
-        connection->outboundQueue.erase(connection->outboundQueue.begin());
-        traceOutboundQueueLength(*connection);
-        if (connection->responsive) {
-            mAnrTracker.insert(timeoutTime, connection->getToken());
+        moveOutboundEntryToWaitQueueLocked(*connection);
+    }
+}
+
+bool InputDispatcher::publishMotionBatchLocked(nsecs_t currentTime,
+                                               const std::shared_ptr<Connection>& connection,
+                                               size_t batchSize) {
+    ATRACE_NAME_IF(ATRACE_ENABLED(), StringPrintf("publishMotionBatchLocked(size=%zu)", batchSize));
+    const nsecs_t timeoutTime = currentTime + getDispatchingTimeoutLocked(connection).count();
+
+    connection->inputPublisher.beginMotionBatch();
+    for (size_t i = 0; i < batchSize; i++) {
+        DispatchEntry& dispatchEntry = *connection->outboundQueue[i];
+        dispatchEntry.deliveryTime = currentTime;
+        dispatchEntry.timeoutTime = timeoutTime;
+        if (DEBUG_OUTBOUND_EVENT_DETAILS) {
+            LOG(INFO) << "Publishing " << dispatchEntry << " to "
+                      << connection->getInputChannelName();
         }
-        traceWaitQueueLength(*connection);
+        const MotionEntry& motionEntry =
+                static_cast<const MotionEntry&>(*dispatchEntry.eventEntry);
+        if (publishMotionEvent(*connection, dispatchEntry) == BAD_VALUE) {
+            logDispatchStateLocked();
+            LOG(FATAL) << "Publisher failed for " << motionEntry;
+        }
+        if (mTracer) {
+            ensureEventTraced(motionEntry);
+            mTracer->traceEventDispatch(dispatchEntry, *motionEntry.traceTracker);
+        }
+    }
+    Result<size_t> sent = connection->inputPublisher.endMotionBatch();
+    if (!sent.ok()) {
+        if (sent.error().code() == BAD_VALUE) {
+            logDispatchStateLocked();
+            LOG(FATAL) << "Publisher failed for " << *connection->outboundQueue.front();
+        }
+        handlePublishErrorLocked(currentTime, connection, sent.error().code());
+        return false;
+    }
+
+    for (size_t i = 0; i < *sent; i++) {
+        moveOutboundEntryToWaitQueueLocked(*connection);
+    }
+    if (*sent < batchSize) {
+        // The pipe is full. Publish the rest once the application catches up.
+        if (DEBUG_DISPATCH_CYCLE) {
+            ALOGD("channel '%s' ~ Published %zu of %zu events before the pipe filled up, "
+                  "waiting for the application to catch up",
+                  connection->getInputChannelName().c_str(), *sent, batchSize);
+        }
+        return false;
+    }
+    return true;
+}
+
+void InputDispatcher::handlePublishErrorLocked(nsecs_t currentTime,
+                                               const std::shared_ptr<Connection>& connection,
+                                               status_t status) {
+    if (status == WOULD_BLOCK) {
+        if (connection->waitQueue.empty()) {
+            ALOGE("channel '%s' ~ Could not publish event because the pipe is full. "
+                  "This is unexpected because the wait queue is empty, so the pipe "
+                  "should be empty and we shouldn't have any problems writing an "
+                  "event to it, status=%s(%d)",
+                  connection->getInputChannelName().c_str(), statusToString(status).c_str(),
+                  status);
+            abortBrokenDispatchCycleLocked(currentTime, connection, /*notify=*/true);
+        } else {
+            // Pipe is full and we are waiting for the app to finish process some events
+            // before sending more events to it.
+            if (DEBUG_DISPATCH_CYCLE) {
+                ALOGD("channel '%s' ~ Could not publish event because the pipe is full, "
+                      "waiting for the application to catch up",
+                      connection->getInputChannelName().c_str());
+            }
+        }
+    } else {
+        ALOGE("channel '%s' ~ Could not publish event due to an unexpected error, "
+              "status=%s(%d)",
+              connection->getInputChannelName().c_str(), statusToString(status).c_str(), status);
+        abortBrokenDispatchCycleLocked(currentTime, connection, /*notify=*/true);
+    }
+}
+
+void InputDispatcher::moveOutboundEntryToWaitQueueLocked(Connection& connection) {
+    std::unique_ptr<DispatchEntry>& dispatchEntry = connection.outboundQueue.front();
+    const nsecs_t timeoutTime = dispatchEntry->timeoutTime;
+    connection.waitQueue.emplace_back(std::move(dispatchEntry));
+    connection.outboundQueue.erase(connection.outboundQueue.begin());
+    traceOutboundQueueLength(connection);
+    if (connection.responsive) {
+        mAnrTracker.insert(timeoutTime, connection.getToken());
     }
+    traceWaitQueueLength(connection);
 }
 
 std::array<uint8_t, 32> InputDispatcher::sign(const VerifiedInputEvent& event) const {
@@ -4390,7 +4525,7 @@ void InputDispatcher::synthesizePointerDownEventsForConnectionLocked(
     }
 }
 
-std::unique_ptr<MotionEntry> InputDispatcher::splitMotionEvent(
+std::shared_ptr<MotionEntry> InputDispatcher::splitMotionEvent(
         const MotionEntry& originalMotionEntry, std::bitset<MAX_POINTER_ID + 1> pointerIds,
         nsecs_t splitDownTime) {
     const auto& [action, pointerProperties, pointerCoords] =
@@ -4426,22 +4561,19 @@ std::unique_ptr<MotionEntry> InputDispatcher::splitMotionEvent(
                    StringPrintf("Split MotionEvent(id=0x%" PRIx32 ") to MotionEvent(id=0x%" PRIx32
                                 ").",
                                 originalMotionEntry.id, newId));
-    std::unique_ptr<MotionEntry> splitMotionEntry =
-            std::make_unique<MotionEntry>(newId, originalMotionEntry.injectionState,
-                                          originalMotionEntry.eventTime,
-                                          originalMotionEntry.deviceId, originalMotionEntry.source,
-                                          originalMotionEntry.displayId,
-                                          originalMotionEntry.policyFlags, action,
-                                          originalMotionEntry.actionButton,
-                                          originalMotionEntry.flags, originalMotionEntry.metaState,
-                                          originalMotionEntry.buttonState,
-                                          originalMotionEntry.classification,
-                                          originalMotionEntry.edgeFlags,
-                                          originalMotionEntry.xPrecision,
-                                          originalMotionEntry.yPrecision,
-                                          originalMotionEntry.xCursorPosition,
-                                          originalMotionEntry.yCursorPosition, splitDownTime,
-                                          pointerProperties, pointerCoords);
+    std::shared_ptr<MotionEntry> splitMotionEntry =
+            mMotionEntryPool.obtain(newId, originalMotionEntry.injectionState,
+                                    originalMotionEntry.eventTime, originalMotionEntry.deviceId,
+                                    originalMotionEntry.source, originalMotionEntry.displayId,
+                                    originalMotionEntry.policyFlags, action,
+                                    originalMotionEntry.actionButton, originalMotionEntry.flags,
+                                    originalMotionEntry.metaState, originalMotionEntry.buttonState,
+                                    originalMotionEntry.classification,
+                                    originalMotionEntry.edgeFlags, originalMotionEntry.xPrecision,
+                                    originalMotionEntry.yPrecision,
+                                    originalMotionEntry.xCursorPosition,
+                                    originalMotionEntry.yCursorPosition, splitDownTime,
+                                    pointerProperties, pointerCoords);
     if (mTracer) {
         splitMotionEntry->traceTracker =
                 mTracer->traceDerivedEvent(*splitMotionEntry, *originalMotionEntry.traceTracker);
@@ -4502,6 +4634,14 @@ void InputDispatcher::notifyKey(const NotifyKeyArgs& args) {
               std::to_string(t.duration().count()).c_str());
     }
 
+    // Allocate the entry before taking the lock, so that the dispatcher thread isn't held up by
+    // the allocation. Its policy flags are finalized under the lock.
+    std::unique_ptr<KeyEntry> newEntry =
+            std::make_unique<KeyEntry>(args.id, /*injectionState=*/nullptr, args.eventTime,
+                                       args.deviceId, args.source, args.displayId, policyFlags,
+                                       args.action, flags, keyCode, args.scanCode, metaState,
+                                       repeatCount, args.downTime);
+
     bool needWake = false;
     { // acquire lock
         mLock.lock();
@@ -4521,11 +4661,7 @@ void InputDispatcher::notifyKey(const NotifyKeyArgs& args) {
             mLock.lock();
         }
 
-        std::unique_ptr<KeyEntry> newEntry =
-                std::make_unique<KeyEntry>(args.id, /*injectionState=*/nullptr, args.eventTime,
-                                           args.deviceId, args.source, args.displayId, policyFlags,
-                                           args.action, flags, keyCode, args.scanCode, metaState,
-                                           repeatCount, args.downTime);
+        newEntry->policyFlags = policyFlags;
         if (mTracer) {
             newEntry->traceTracker = mTracer->traceInboundEvent(*newEntry);
         }
@@ -4604,6 +4740,23 @@ void InputDispatcher::notifyMotion(const NotifyMotionArgs& args) {
               std::to_string(t.duration().count()).c_str());
     }
 
+    // Allocate the entry before taking the lock, so that the dispatcher thread isn't held up by
+    // copying the pointers. Its policy flags are finalized under the lock.
+    std::shared_ptr<MotionEntry> newEntry =
+            mMotionEntryPool.obtain(args.id, /*injectionState=*/nullptr, args.eventTime,
+                                    args.deviceId, args.source, args.displayId, policyFlags,
+                                    args.action, args.actionButton, args.flags, args.metaState,
+                                    args.buttonState, args.classification, args.edgeFlags,
+                                    args.xPrecision, args.yPrecision, args.xCursorPosition,
+                                    args.yCursorPosition, args.downTime, args.pointerProperties,
+                                    args.pointerCoords);
+    const bool isFromInputReader =
+            args.id != android::os::IInputConstants::INVALID_INPUT_EVENT_ID &&
+            IdGenerator::getSource(args.id) == IdGenerator::Source::INPUT_READER;
+    const std::set<InputDeviceUsageSource> usageSources =
+            isFromInputReader ? getUsageSourcesForMotionArgs(args)
+                              : std::set<InputDeviceUsageSource>{};
+
     bool needWake = false;
     { // acquire lock
         mLock.lock();
@@ -4646,25 +4799,14 @@ void InputDispatcher::notifyMotion(const NotifyMotionArgs& args) {
         }
 
         // Just enqueue a new motion event.
-        std::unique_ptr<MotionEntry> newEntry =
-                std::make_unique<MotionEntry>(args.id, /*injectionState=*/nullptr, args.eventTime,
-                                              args.deviceId, args.source, args.displayId,
-                                              policyFlags, args.action, args.actionButton,
-                                              args.flags, args.metaState, args.buttonState,
-                                              args.classification, args.edgeFlags, args.xPrecision,
-                                              args.yPrecision, args.xCursorPosition,
-                                              args.yCursorPosition, args.downTime,
-                                              args.pointerProperties, args.pointerCoords);
+        newEntry->policyFlags = policyFlags;
         if (mTracer) {
             newEntry->traceTracker = mTracer->traceInboundEvent(*newEntry);
         }
 
-        if (args.id != android::os::IInputConstants::INVALID_INPUT_EVENT_ID &&
-            IdGenerator::getSource(args.id) == IdGenerator::Source::INPUT_READER &&
-            !mInputFilterEnabled) {
-            std::set<InputDeviceUsageSource> sources = getUsageSourcesForMotionArgs(args);
+        if (isFromInputReader && !mInputFilterEnabled) {
             mLatencyTracker.trackListener(args.id, args.eventTime, args.readTime, args.deviceId,
-                                          sources, args.action, InputEventType::MOTION);
+                                          usageSources, args.action, InputEventType::MOTION);
         }
 
         needWake = enqueueInboundEventLocked(std::move(newEntry));
@@ -5161,6 +5303,13 @@ const std::vector<sp<WindowInfoHandle>>& InputDispatcher::getWindowHandlesLocked
     return it != mWindowHandlesByDisplay.end() ? it->second : EMPTY_WINDOW_HANDLES;
 }
 
+const WindowHitIndex& InputDispatcher::getWindowHitIndexLocked(
+        ui::LogicalDisplayId displayId) const {
+    static const WindowHitIndex EMPTY_WINDOW_HIT_INDEX;
+    auto it = mWindowHitIndexByDisplay.find(displayId);
+    return it != mWindowHitIndexByDisplay.end() ? it->second : EMPTY_WINDOW_HIT_INDEX;
+}
+
 sp<WindowInfoHandle> InputDispatcher::getWindowHandleLocked(
         const sp<IBinder>& windowHandleToken, std::optional<ui::LogicalDisplayId> displayId) const {
     if (windowHandleToken == nullptr) {
@@ -5287,6 +5436,7 @@ void InputDispatcher::updateWindowHandlesForDisplayLocked(
     if (windowInfoHandles.empty()) {
         // Remove all handles on a display if there are no windows left.
         mWindowHandlesByDisplay.erase(displayId);
+        mWindowHitIndexByDisplay.erase(displayId);
         return;
     }
 
@@ -5332,6 +5482,9 @@ void InputDispatcher::updateWindowHandlesForDisplayLocked(
     }
 
     // Insert or replace
+    mWindowHitIndexByDisplay.insert_or_assign(displayId,
+                                              WindowHitIndex(newHandles,
+                                                             getTransformLocked(displayId)));
     mWindowHandlesByDisplay[displayId] = newHandles;
 }
 
@@ -6101,6 +6254,7 @@ void InputDispatcher::dumpDispatchStateLocked(std::string& dump) const {
                          ns2ms(mConfig.keyRepeatTimeout));
     dump += mLatencyTracker.dump(INDENT2);
     dump += mLatencyAggregator.dump(INDENT2);
+    dump += mLatencyHistograms.dump(INDENT2);
     dump += INDENT "InputTracer: ";
     dump += mTracer == nullptr ? "Disabled" : "Enabled";
 }
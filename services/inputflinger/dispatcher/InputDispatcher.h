@@ -28,10 +28,13 @@
 #include "InputTarget.h"
 #include "InputThread.h"
 #include "LatencyAggregator.h"
+#include "LatencyHistograms.h"
 #include "LatencyTracker.h"
 #include "Monitor.h"
+#include "MotionEntryPool.h"
 #include "TouchState.h"
 #include "TouchedWindow.h"
+#include "WindowHitIndex.h"
 #include "trace/InputTracerInterface.h"
 #include "trace/InputTracingBackendInterface.h"
 
@@ -186,6 +189,10 @@ private:
 
     sp<Looper> mLooper;
 
+    // Recycles the motion entries, which are created for every motion event and every split or
+    // transformed target. Thread-safe, since entries are created before mLock is taken.
+    MotionEntryPool mMotionEntryPool;
+
     std::shared_ptr<const EventEntry> mPendingEvent GUARDED_BY(mLock);
     std::deque<std::shared_ptr<const EventEntry>> mInboundQueue GUARDED_BY(mLock);
     std::deque<std::shared_ptr<const EventEntry>> mRecentQueue GUARDED_BY(mLock);
@@ -229,7 +236,7 @@ private:
     void dispatchOnceInnerLocked(nsecs_t& nextWakeupTime) REQUIRES(mLock);
 
     // Enqueues an inbound event.  Returns true if mLooper->wake() should be called.
-    bool enqueueInboundEventLocked(std::unique_ptr<EventEntry> entry) REQUIRES(mLock);
+    bool enqueueInboundEventLocked(std::shared_ptr<EventEntry> entry) REQUIRES(mLock);
 
     // Cleans up input state when dropping an inbound event.
     void dropInboundEventLocked(const EventEntry& entry, DropReason dropReason) REQUIRES(mLock);
@@ -365,12 +372,18 @@ private:
             mWindowHandlesByDisplay GUARDED_BY(mLock);
     std::unordered_map<ui::LogicalDisplayId /*displayId*/, android::gui::DisplayInfo> mDisplayInfos
             GUARDED_BY(mLock);
+    // Rebuilt along with mWindowHandlesByDisplay, and refers to the windows by their position in
+    // it.
+    std::unordered_map<ui::LogicalDisplayId /*displayId*/, WindowHitIndex> mWindowHitIndexByDisplay
+            GUARDED_BY(mLock);
     void setInputWindowsLocked(
             const std::vector<sp<android::gui::WindowInfoHandle>>& inputWindowHandles,
             ui::LogicalDisplayId displayId) REQUIRES(mLock);
     // Get a reference to window handles by display, return an empty vector if not found.
     const std::vector<sp<android::gui::WindowInfoHandle>>& getWindowHandlesLocked(
             ui::LogicalDisplayId displayId) const REQUIRES(mLock);
+    const WindowHitIndex& getWindowHitIndexLocked(ui::LogicalDisplayId displayId) const
+            REQUIRES(mLock);
     ui::Transform getTransformLocked(ui::LogicalDisplayId displayId) const REQUIRES(mLock);
 
     sp<android::gui::WindowInfoHandle> getWindowHandleLocked(
@@ -598,15 +611,21 @@ private:
                                     const std::shared_ptr<Connection>& connection,
                                     std::shared_ptr<const EventEntry>,
                                     const InputTarget& inputTarget) REQUIRES(mLock);
-    void enqueueDispatchEntryAndStartDispatchCycleLocked(
-            nsecs_t currentTime, const std::shared_ptr<Connection>& connection,
-            std::shared_ptr<const EventEntry>, const InputTarget& inputTarget) REQUIRES(mLock);
     void enqueueDispatchEntryLocked(const std::shared_ptr<Connection>& connection,
                                     std::shared_ptr<const EventEntry>,
                                     const InputTarget& inputTarget) REQUIRES(mLock);
     status_t publishMotionEvent(Connection& connection, DispatchEntry& dispatchEntry) const;
     void startDispatchCycleLocked(nsecs_t currentTime,
                                   const std::shared_ptr<Connection>& connection) REQUIRES(mLock);
+    // Publishes the first batchSize entries of the outbound queue, which are all motion events.
+    // Returns false if the dispatch cycle cannot continue.
+    bool publishMotionBatchLocked(nsecs_t currentTime,
+                                  const std::shared_ptr<Connection>& connection, size_t batchSize)
+            REQUIRES(mLock);
+    void handlePublishErrorLocked(nsecs_t currentTime,
+                                  const std::shared_ptr<Connection>& connection, status_t status)
+            REQUIRES(mLock);
+    void moveOutboundEntryToWaitQueueLocked(Connection& connection) REQUIRES(mLock);
     void finishDispatchCycleLocked(nsecs_t currentTime,
                                    const std::shared_ptr<Connection>& connection, uint32_t seq,
                                    bool handled, nsecs_t consumeTime) REQUIRES(mLock);
@@ -642,7 +661,7 @@ private:
 
     // Splitting motion events across windows. When splitting motion event for a target,
     // splitDownTime refers to the time of first 'down' event on that particular target
-    std::unique_ptr<MotionEntry> splitMotionEvent(const MotionEntry& originalMotionEntry,
+    std::shared_ptr<MotionEntry> splitMotionEvent(const MotionEntry& originalMotionEntry,
                                                   std::bitset<MAX_POINTER_ID + 1> pointerIds,
                                                   nsecs_t splitDownTime) REQUIRES(mLock);
 
@@ -698,6 +717,7 @@ private:
 
     // Statistics gathering.
     LatencyAggregator mLatencyAggregator GUARDED_BY(mLock);
+    LatencyHistograms mLatencyHistograms GUARDED_BY(mLock);
     LatencyTracker mLatencyTracker GUARDED_BY(mLock);
     void traceInboundQueueLengthLocked() REQUIRES(mLock);
     void traceOutboundQueueLength(const Connection& connection);
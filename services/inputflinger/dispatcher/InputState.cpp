@@ -19,6 +19,7 @@
 
 #include "InputState.h"
 
+#include <algorithm>
 #include <cinttypes>
 #include "InputDispatcher.h"
 
@@ -187,9 +188,14 @@ bool InputState::trackMotion(const MotionEntry& entry, int32_t flags) {
         case AMOTION_EVENT_ACTION_HOVER_MOVE: {
             ssize_t index = findMotionMemento(entry, /*hovering=*/true);
             if (index >= 0) {
-                mMotionMementos.erase(mMotionMementos.begin() + index);
+                // Reuse the memento and its pointer storage, but move it to the back so that it
+                // is ordered as if it had just been added.
+                std::rotate(mMotionMementos.begin() + index, mMotionMementos.begin() + index + 1,
+                            mMotionMementos.end());
+                initializeMotionMemento(mMotionMementos.back(), entry, flags, /*hovering=*/true);
+            } else {
+                addMotionMemento(entry, flags, /*hovering=*/true);
             }
-            addMotionMemento(entry, flags, /*hovering=*/true);
             return true;
         }
 
@@ -246,7 +252,11 @@ void InputState::addKeyMemento(const KeyEntry& entry, int32_t flags) {
 }
 
 void InputState::addMotionMemento(const MotionEntry& entry, int32_t flags, bool hovering) {
-    MotionMemento memento;
+    initializeMotionMemento(mMotionMementos.emplace_back(), entry, flags, hovering);
+}
+
+void InputState::initializeMotionMemento(MotionMemento& memento, const MotionEntry& entry,
+                                         int32_t flags, bool hovering) {
     memento.deviceId = entry.deviceId;
     memento.source = entry.source;
     memento.displayId = entry.displayId;
@@ -257,9 +267,9 @@ void InputState::addMotionMemento(const MotionEntry& entry, int32_t flags, bool
     memento.yCursorPosition = entry.yCursorPosition;
     memento.downTime = entry.downTime;
     memento.setPointers(entry);
+    memento.firstNewPointerIdx = INVALID_POINTER_INDEX;
     memento.hovering = hovering;
     memento.policyFlags = entry.policyFlags;
-    mMotionMementos.push_back(memento);
 }
 
 void InputState::MotionMemento::setPointers(const MotionEntry& entry) {
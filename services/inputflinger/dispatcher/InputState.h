@@ -132,6 +132,9 @@ private:
 
     void addKeyMemento(const KeyEntry& entry, int32_t flags);
     void addMotionMemento(const MotionEntry& entry, int32_t flags, bool hovering);
+    // Overwrites every field of the memento, reusing the storage of its pointers.
+    static void initializeMotionMemento(MotionMemento& memento, const MotionEntry& entry,
+                                        int32_t flags, bool hovering);
 
     static bool shouldCancelKey(const KeyMemento& memento, const CancelationOptions& options);
     static bool shouldCancelMotion(const MotionMemento& memento, const CancelationOptions& options);
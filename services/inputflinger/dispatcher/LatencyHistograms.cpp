@@ -0,0 +1,145 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "LatencyHistograms.h"
+
+#include <inttypes.h>
+
+#include <android-base/parseint.h>
+#include <android-base/stringprintf.h>
+#include <server_configurable_flags/get_flags.h>
+
+using android::base::StringPrintf;
+
+namespace android::inputdispatcher {
+
+namespace {
+
+// Category (=namespace) name for the input settings that are applied at boot time
+const char* INPUT_NATIVE_BOOT = "input_native_boot";
+// Feature flag name for the number of complete timelines per sample recorded in the histograms
+const char* LATENCY_HISTOGRAM_SAMPLING_INTERVAL = "latency_histogram_sampling_interval";
+// Record one timeline out of 10 by default.
+constexpr size_t DEFAULT_SAMPLING_INTERVAL = 10;
+
+// Indexed by SketchIndex.
+constexpr std::array<const char*, SketchIndex::SIZE> STAGE_NAMES = {
+        "EventToRead",
+        "ReadToDeliver",
+        "DeliverToConsume",
+        "ConsumeToFinish",
+        "ConsumeToGpuComplete",
+        "GpuCompleteToPresent",
+        "EndToEnd",
+};
+
+} // namespace
+
+LatencyHistograms::LatencyHistograms(size_t samplingInterval, NameResolver nameResolver)
+      : mSamplingInterval(samplingInterval), mNameResolver(std::move(nameResolver)) {}
+
+size_t LatencyHistograms::getConfiguredSamplingInterval() {
+    const std::string interval = server_configurable_flags::
+            GetServerConfigurableFlag(INPUT_NATIVE_BOOT, LATENCY_HISTOGRAM_SAMPLING_INTERVAL,
+                                      std::to_string(DEFAULT_SAMPLING_INTERVAL));
+    size_t parsed;
+    return android::base::ParseUint(interval, &parsed) ? parsed : DEFAULT_SAMPLING_INTERVAL;
+}
+
+void LatencyHistograms::processTimeline(const InputEventTimeline& timeline) {
+    if (mSamplingInterval == 0) {
+        return;
+    }
+    for (const auto& [connectionToken, connectionTimeline] : timeline.connectionTimelines) {
+        if (!connectionTimeline.isComplete()) {
+            continue;
+        }
+        if (mNumTimelines++ % mSamplingInterval != 0) {
+            continue;
+        }
+        const nsecs_t gpuCompletedTime =
+                connectionTimeline.graphicsTimeline[GraphicsTimeline::GPU_COMPLETED_TIME];
+        const nsecs_t presentTime =
+                connectionTimeline.graphicsTimeline[GraphicsTimeline::PRESENT_TIME];
+
+        Histograms& histograms = getOrCreateHistograms(mNameResolver(connectionToken));
+        record(histograms[SketchIndex::EVENT_TO_READ], timeline.readTime - timeline.eventTime);
+        record(histograms[SketchIndex::READ_TO_DELIVER],
+               connectionTimeline.deliveryTime - timeline.readTime);
+        record(histograms[SketchIndex::DELIVER_TO_CONSUME],
+               connectionTimeline.consumeTime - connectionTimeline.deliveryTime);
+        record(histograms[SketchIndex::CONSUME_TO_FINISH],
+               connectionTimeline.finishTime - connectionTimeline.consumeTime);
+        record(histograms[SketchIndex::CONSUME_TO_GPU_COMPLETE],
+               gpuCompletedTime - connectionTimeline.consumeTime);
+        record(histograms[SketchIndex::GPU_COMPLETE_TO_PRESENT], presentTime - gpuCompletedTime);
+        record(histograms[SketchIndex::END_TO_END], presentTime - timeline.eventTime);
+    }
+}
+
+void LatencyHistograms::record(Histogram& histogram, nsecs_t latency) {
+    size_t bucket = 0;
+    while (bucket < BUCKET_LIMITS_MS.size() && latency >= ms2ns(BUCKET_LIMITS_MS[bucket])) {
+        bucket++;
+    }
+    histogram[bucket]++;
+}
+
+LatencyHistograms::Histograms& LatencyHistograms::getOrCreateHistograms(
+        const std::string& receiverName) {
+    auto it = mHistogramsByReceiver.find(receiverName);
+    if (it != mHistogramsByReceiver.end()) {
+        return it->second;
+    }
+    if (mHistogramsByReceiver.size() >= MAX_RECEIVERS) {
+        return mHistogramsByReceiver[OTHER_RECEIVERS];
+    }
+    return mHistogramsByReceiver[receiverName];
+}
+
+const LatencyHistograms::Histograms* LatencyHistograms::getHistograms(
+        const std::string& receiverName) const {
+    const auto it = mHistogramsByReceiver.find(receiverName);
+    return it != mHistogramsByReceiver.end() ? &it->second : nullptr;
+}
+
+std::string LatencyHistograms::dump(const char* prefix) const {
+    std::string dump = StringPrintf("%sLatencyHistograms:\n", prefix);
+    if (mSamplingInterval == 0) {
+        return dump + StringPrintf("%s  Disabled\n", prefix);
+    }
+    dump += StringPrintf("%s  SamplingInterval: %zu, NumTimelines: %zu\n", prefix,
+                         mSamplingInterval, mNumTimelines);
+    std::string buckets;
+    for (nsecs_t limit : BUCKET_LIMITS_MS) {
+        buckets += StringPrintf("<%" PRId64 " ", limit);
+    }
+    dump += StringPrintf("%s  Buckets (ms): %s>=%" PRId64 "\n", prefix, buckets.c_str(),
+                         BUCKET_LIMITS_MS.back());
+    for (const auto& [receiverName, histograms] : mHistogramsByReceiver) {
+        dump += StringPrintf("%s  %s:\n", prefix, receiverName.c_str());
+        for (size_t stage = 0; stage < SketchIndex::SIZE; stage++) {
+            std::string counts;
+            for (uint64_t count : histograms[stage]) {
+                counts += StringPrintf(" %" PRIu64, count);
+            }
+            dump += StringPrintf("%s    %s:%s\n", prefix, STAGE_NAMES[stage], counts.c_str());
+        }
+    }
+    return dump;
+}
+
+} // namespace android::inputdispatcher
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <binder/IBinder.h>
+#include <utils/Timers.h>
+
+#include <array>
+#include <functional>
+#include <map>
+#include <string>
+
+#include "InputEventTimeline.h"
+#include "LatencyAggregator.h"
+
+namespace android::inputdispatcher {
+
+/**
+ * Keeps histograms of the latency of each stage of the input pipeline, for each receiver of the
+ * events. Unlike the sketches of LatencyAggregator, which are pulled and reset by statsd, the
+ * histograms accumulate for the lifetime of the process so that they can be inspected locally,
+ * through dumpsys.
+ *
+ * Only one in every 'samplingInterval' complete timelines is recorded, which keeps the cost low
+ * enough to leave the histograms on. A sampling interval of 0 disables them.
+ *
+ * Not thread-safe.
+ */
+class LatencyHistograms final : public InputEventTimelineProcessor {
+public:
+    // Returns the name to report the latency of a receiver under, given its connection token.
+    using NameResolver = std::function<std::string(const sp<IBinder>& connectionToken)>;
+
+    // The upper bound of each bucket, in milliseconds. The last bucket holds everything else.
+    static constexpr std::array<nsecs_t, 8> BUCKET_LIMITS_MS = {1, 2, 4, 8, 16, 32, 64, 128};
+    static constexpr size_t BUCKET_COUNT = BUCKET_LIMITS_MS.size() + 1;
+    // Receivers are reported under OTHER_RECEIVERS once this many receivers have histograms.
+    static constexpr size_t MAX_RECEIVERS = 64;
+    static constexpr const char* OTHER_RECEIVERS = "<other>";
+
+    using Histogram = std::array<uint64_t, BUCKET_COUNT>;
+    using Histograms = std::array<Histogram, SketchIndex::SIZE>;
+
+    LatencyHistograms(size_t samplingInterval, NameResolver nameResolver);
+
+    // Reads the sampling interval from the input_native_boot flags.
+    static size_t getConfiguredSamplingInterval();
+
+    void processTimeline(const InputEventTimeline& timeline) override;
+
+    // Returns the histograms of the receiver, or nullptr if nothing was recorded for it.
+    const Histograms* getHistograms(const std::string& receiverName) const;
+
+    std::string dump(const char* prefix) const;
+
+private:
+    const size_t mSamplingInterval;
+    const NameResolver mNameResolver;
+    // How many complete timelines have been seen, sampled or not.
+    size_t mNumTimelines = 0;
+    std::map<std::string /*receiverName*/, Histograms> mHistogramsByReceiver;
+
+    static void record(Histogram& histogram, nsecs_t latency);
+    Histograms& getOrCreateHistograms(const std::string& receiverName);
+};
+
+} // namespace android::inputdispatcher
@@ -63,8 +63,13 @@ static void eraseByValue(std::multimap<K, V>& map, const V& value) {
 }
 
 LatencyTracker::LatencyTracker(InputEventTimelineProcessor* processor)
-      : mTimelineProcessor(processor) {
-    LOG_ALWAYS_FATAL_IF(processor == nullptr);
+      : LatencyTracker(std::vector<InputEventTimelineProcessor*>{processor}) {}
+
+LatencyTracker::LatencyTracker(std::vector<InputEventTimelineProcessor*> processors)
+      : mTimelineProcessors(std::move(processors)) {
+    for (const InputEventTimelineProcessor* processor : mTimelineProcessors) {
+        LOG_ALWAYS_FATAL_IF(processor == nullptr);
+    }
 }
 
 void LatencyTracker::trackListener(int32_t inputEventId, nsecs_t eventTime, nsecs_t readTime,
@@ -213,7 +218,9 @@ void LatencyTracker::reportAndPruneMatureRecords(nsecs_t newEventTime) {
                                 "Event %" PRId32 " is in mEventTimes, but not in mTimelines",
                                 oldestInputEventId);
             const InputEventTimeline& timeline = it->second;
-            mTimelineProcessor->processTimeline(timeline);
+            for (InputEventTimelineProcessor* processor : mTimelineProcessors) {
+                processor->processTimeline(timeline);
+            }
             mTimelines.erase(it);
             mEventTimes.erase(mEventTimes.begin());
         } else {
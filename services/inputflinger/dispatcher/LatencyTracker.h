@@ -20,6 +20,7 @@
 
 #include <map>
 #include <unordered_map>
+#include <vector>
 
 #include <binder/IBinder.h>
 #include <input/Input.h>
@@ -43,6 +44,10 @@ public:
      * param reportingFunction: the function that will be called in order to report full latency.
      */
     LatencyTracker(InputEventTimelineProcessor* processor);
+    /**
+     * Create a LatencyTracker that reports full latency to each of the processors, in order.
+     */
+    LatencyTracker(std::vector<InputEventTimelineProcessor*> processors);
     /**
      * Start keeping track of an event identified by inputEventId. This must be called first.
      * If duplicate events are encountered (events that have the same eventId), none of them will be
@@ -81,7 +86,7 @@ private:
      */
     std::multimap<nsecs_t /*eventTime*/, int32_t /*inputEventId*/> mEventTimes;
 
-    InputEventTimelineProcessor* mTimelineProcessor;
+    std::vector<InputEventTimelineProcessor*> mTimelineProcessors;
     std::vector<InputDeviceInfo> mInputDevices;
     void reportAndPruneMatureRecords(nsecs_t newEventTime);
 };
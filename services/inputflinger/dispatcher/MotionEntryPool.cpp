@@ -0,0 +1,94 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MotionEntryPool.h"
+
+#include <new>
+
+namespace android::inputdispatcher {
+
+MotionEntryPool::State::State(size_t capacity) : capacity(capacity) {
+    std::scoped_lock lock(mutex);
+    freeEntries.reserve(capacity);
+}
+
+MotionEntryPool::State::~State() {
+    std::scoped_lock lock(mutex);
+    for (FreeEntry& freeEntry : freeEntries) {
+        ::operator delete(freeEntry.memory);
+    }
+}
+
+void MotionEntryPool::State::recycle(MotionEntry* entry) {
+    FreeEntry freeEntry{.memory = entry,
+                        .pointerProperties = std::move(entry->pointerProperties),
+                        .pointerCoords = std::move(entry->pointerCoords)};
+    // Release the injection state and the trace tracker outside of the lock.
+    entry->~MotionEntry();
+
+    std::scoped_lock lock(mutex);
+    if (freeEntries.size() < capacity) {
+        freeEntries.push_back(std::move(freeEntry));
+    } else {
+        ::operator delete(freeEntry.memory);
+    }
+}
+
+MotionEntryPool::MotionEntryPool(size_t capacity) : mState(std::make_shared<State>(capacity)) {}
+
+std::shared_ptr<MotionEntry> MotionEntryPool::obtain(
+        int32_t id, std::shared_ptr<InjectionState> injectionState, nsecs_t eventTime,
+        int32_t deviceId, uint32_t source, ui::LogicalDisplayId displayId, uint32_t policyFlags,
+        int32_t action, int32_t actionButton, int32_t flags, int32_t metaState,
+        int32_t buttonState, MotionClassification classification, int32_t edgeFlags,
+        float xPrecision, float yPrecision, float xCursorPosition, float yCursorPosition,
+        nsecs_t downTime, const std::vector<PointerProperties>& pointerProperties,
+        const std::vector<PointerCoords>& pointerCoords) {
+    FreeEntry freeEntry{.memory = nullptr};
+    { // acquire lock
+        std::scoped_lock lock(mState->mutex);
+        if (!mState->freeEntries.empty()) {
+            freeEntry = std::move(mState->freeEntries.back());
+            mState->freeEntries.pop_back();
+        }
+    } // release lock
+    if (freeEntry.memory == nullptr) {
+        freeEntry.memory = ::operator new(sizeof(MotionEntry));
+    }
+    // Copy the pointers into the recycled vectors, which only allocate if there are more pointers
+    // than they had before.
+    freeEntry.pointerProperties.assign(pointerProperties.begin(), pointerProperties.end());
+    freeEntry.pointerCoords.assign(pointerCoords.begin(), pointerCoords.end());
+
+    MotionEntry* entry =
+            new (freeEntry.memory) MotionEntry(id, std::move(injectionState), eventTime, deviceId,
+                                               source, displayId, policyFlags, action,
+                                               actionButton, flags, metaState, buttonState,
+                                               classification, edgeFlags, xPrecision, yPrecision,
+                                               xCursorPosition, yCursorPosition, downTime,
+                                               std::move(freeEntry.pointerProperties),
+                                               std::move(freeEntry.pointerCoords));
+    return std::shared_ptr<MotionEntry>(entry, [state = mState](MotionEntry* released) {
+        state->recycle(released);
+    });
+}
+
+size_t MotionEntryPool::getFreeCount() const {
+    std::scoped_lock lock(mState->mutex);
+    return mState->freeEntries.size();
+}
+
+} // namespace android::inputdispatcher
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <android-base/thread_annotations.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Entry.h"
+
+namespace android::inputdispatcher {
+
+/**
+ * Recycles the MotionEntry objects that the dispatcher creates for every motion event it
+ * receives, and for every window that a motion event is split or transformed for. An entry
+ * obtained from the pool goes back to it when its last reference is released, keeping its memory
+ * and the capacity of its pointer vectors, so that a steady stream of touches does not allocate
+ * them again for each event.
+ *
+ * The pool is thread-safe: entries are obtained on the thread that notifies the dispatcher, and
+ * released on the dispatcher thread. Entries may outlive the pool.
+ */
+class MotionEntryPool {
+public:
+    explicit MotionEntryPool(size_t capacity);
+
+    std::shared_ptr<MotionEntry> obtain(
+            int32_t id, std::shared_ptr<InjectionState> injectionState, nsecs_t eventTime,
+            int32_t deviceId, uint32_t source, ui::LogicalDisplayId displayId,
+            uint32_t policyFlags, int32_t action, int32_t actionButton, int32_t flags,
+            int32_t metaState, int32_t buttonState, MotionClassification classification,
+            int32_t edgeFlags, float xPrecision, float yPrecision, float xCursorPosition,
+            float yCursorPosition, nsecs_t downTime,
+            const std::vector<PointerProperties>& pointerProperties,
+            const std::vector<PointerCoords>& pointerCoords);
+
+    // The number of released entries ready to be reused.
+    size_t getFreeCount() const;
+
+private:
+    struct FreeEntry {
+        void* memory;
+        std::vector<PointerProperties> pointerProperties;
+        std::vector<PointerCoords> pointerCoords;
+    };
+
+    // Shared with the entries that were handed out, so that they can be released after the pool
+    // is destroyed.
+    struct State {
+        const size_t capacity;
+        mutable std::mutex mutex;
+        std::vector<FreeEntry> freeEntries GUARDED_BY(mutex);
+
+        explicit State(size_t capacity);
+        ~State();
+        void recycle(MotionEntry* entry);
+    };
+
+    std::shared_ptr<State> mState;
+};
+
+} // namespace android::inputdispatcher
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "WindowHitIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace android::inputdispatcher {
+
+namespace {
+
+const std::vector<size_t> NO_CANDIDATES;
+
+int64_t divideRoundingUp(int64_t numerator, int64_t denominator) {
+    return (numerator + denominator - 1) / denominator;
+}
+
+} // namespace
+
+WindowHitIndex::Grid::Grid(const std::vector<Rect>& bounds) {
+    for (const Rect& rect : bounds) {
+        if (rect.isEmpty()) {
+            continue;
+        }
+        if (mBounds.isEmpty()) {
+            mBounds = rect;
+        } else {
+            mBounds.left = std::min(mBounds.left, rect.left);
+            mBounds.top = std::min(mBounds.top, rect.top);
+            mBounds.right = std::max(mBounds.right, rect.right);
+            mBounds.bottom = std::max(mBounds.bottom, rect.bottom);
+        }
+    }
+    if (mBounds.isEmpty()) {
+        return;
+    }
+
+    // Aim for about one rect per cell. Touchable regions may be very large, so the sizes are
+    // computed with 64 bits.
+    const int64_t cellsPerSide =
+            std::clamp<int64_t>(std::ceil(std::sqrt(bounds.size())), 1, MAX_CELLS_PER_SIDE);
+    const int64_t width = int64_t(mBounds.right) - mBounds.left;
+    const int64_t height = int64_t(mBounds.bottom) - mBounds.top;
+    mCellWidth = divideRoundingUp(width, cellsPerSide);
+    mCellHeight = divideRoundingUp(height, cellsPerSide);
+    mColumns = divideRoundingUp(width, mCellWidth);
+    mRows = divideRoundingUp(height, mCellHeight);
+    mCells.resize(mColumns * mRows);
+
+    for (size_t position = 0; position < bounds.size(); position++) {
+        const Rect& rect = bounds[position];
+        if (rect.isEmpty()) {
+            continue;
+        }
+        const int64_t firstColumn = (int64_t(rect.left) - mBounds.left) / mCellWidth;
+        const int64_t lastColumn = (int64_t(rect.right) - 1 - mBounds.left) / mCellWidth;
+        const int64_t firstRow = (int64_t(rect.top) - mBounds.top) / mCellHeight;
+        const int64_t lastRow = (int64_t(rect.bottom) - 1 - mBounds.top) / mCellHeight;
+        for (int64_t row = firstRow; row <= lastRow; row++) {
+            for (int64_t column = firstColumn; column <= lastColumn; column++) {
+                mCells[row * mColumns + column].push_back(position);
+            }
+        }
+    }
+}
+
+const std::vector<size_t>& WindowHitIndex::Grid::find(float x, float y) const {
+    if (mCells.empty() ||
+        !(x >= mBounds.left && x < mBounds.right && y >= mBounds.top && y < mBounds.bottom)) {
+        return NO_CANDIDATES;
+    }
+    const int64_t column = (static_cast<int64_t>(x) - mBounds.left) / mCellWidth;
+    const int64_t row = (static_cast<int64_t>(y) - mBounds.top) / mCellHeight;
+    return mCells[row * mColumns + column];
+}
+
+WindowHitIndex::WindowHitIndex(const std::vector<sp<gui::WindowInfoHandle>>& windowHandles,
+                               const ui::Transform& displayTransform)
+      : mDisplayTransform(displayTransform), mWindowCount(windowHandles.size()) {
+    // Hit tests are done in the logical display space, see windowAcceptsTouchAt and
+    // windowOccludesTouchAt.
+    std::vector<Rect> touchableBounds;
+    std::vector<Rect> frames;
+    touchableBounds.reserve(windowHandles.size());
+    frames.reserve(windowHandles.size());
+    for (size_t position = 0; position < windowHandles.size(); position++) {
+        const gui::WindowInfo& info = *windowHandles[position]->getInfo();
+        touchableBounds.push_back(displayTransform.transform(info.touchableRegion).getBounds());
+        frames.push_back(displayTransform.transform(info.frame));
+        if (!info.supportsSplitTouch()) {
+            mUnsplittable.push_back(position);
+        }
+        mPositions.try_emplace(windowHandles[position].get(), position);
+    }
+    mTouchableGrid = Grid(touchableBounds);
+    mFrameGrid = Grid(frames);
+}
+
+const std::vector<size_t>& WindowHitIndex::findCandidates(float x, float y) const {
+    const vec2 p = mDisplayTransform.transform(x, y);
+    return mTouchableGrid.find(std::floor(p.x), std::floor(p.y));
+}
+
+const std::vector<size_t>& WindowHitIndex::findOccluders(float x, float y) const {
+    const vec2 p = mDisplayTransform.transform(x, y);
+    return mFrameGrid.find(std::floor(p.x), std::floor(p.y));
+}
+
+size_t WindowHitIndex::getPosition(const sp<gui::WindowInfoHandle>& windowHandle) const {
+    const auto it = mPositions.find(windowHandle.get());
+    return it != mPositions.end() ? it->second : mWindowCount;
+}
+
+} // namespace android::inputdispatcher
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <gui/WindowInfo.h>
+#include <ui/Rect.h>
+#include <ui/Transform.h>
+
+#include <unordered_map>
+#include <vector>
+
+namespace android::inputdispatcher {
+
+/**
+ * Grids over the windows of a display, used to find the windows that may be touched, or that may
+ * occlude a touch, at a location without testing every window.
+ *
+ * The index is built from the windows of a display in z-order, and refers to them by their
+ * position in that list. Candidates for a location are the windows whose touchable region, or
+ * frame, has bounds in the logical display space that contain the location. They are returned
+ * front to back, and still need to be hit tested exactly. The index must be rebuilt whenever the
+ * windows or the display transform change.
+ */
+class WindowHitIndex {
+public:
+    WindowHitIndex() = default;
+    WindowHitIndex(const std::vector<sp<gui::WindowInfoHandle>>& windowHandles,
+                   const ui::Transform& displayTransform);
+
+    // Returns the positions of the windows whose touchable region may contain the location, given
+    // in display coordinates, in increasing order.
+    const std::vector<size_t>& findCandidates(float x, float y) const;
+
+    // Returns the positions of the windows whose frame may contain the location, given in display
+    // coordinates, in increasing order.
+    const std::vector<size_t>& findOccluders(float x, float y) const;
+
+    // Returns the positions of the windows that don't support split touch, in increasing order.
+    const std::vector<size_t>& getUnsplittable() const { return mUnsplittable; }
+
+    // Returns the position of the window, or the number of windows if it is not indexed.
+    size_t getPosition(const sp<gui::WindowInfoHandle>& windowHandle) const;
+
+private:
+    // Maps each cell of a grid over the union of some bounds to the bounds that overlap it.
+    class Grid {
+    public:
+        Grid() = default;
+        explicit Grid(const std::vector<Rect>& bounds);
+
+        // Takes a location in the logical display space, rounded down.
+        const std::vector<size_t>& find(float x, float y) const;
+
+    private:
+        static constexpr int64_t MAX_CELLS_PER_SIDE = 16;
+
+        Rect mBounds;
+        int64_t mColumns = 0;
+        int64_t mRows = 0;
+        int64_t mCellWidth = 1;
+        int64_t mCellHeight = 1;
+        // The bounds overlapping each cell, row by row.
+        std::vector<std::vector<size_t>> mCells;
+    };
+
+    ui::Transform mDisplayTransform;
+    Grid mTouchableGrid;
+    Grid mFrameGrid;
+    std::vector<size_t> mUnsplittable;
+    size_t mWindowCount = 0;
+    std::unordered_map<const gui::WindowInfoHandle*, size_t> mPositions;
+};
+
+} // namespace android::inputdispatcher
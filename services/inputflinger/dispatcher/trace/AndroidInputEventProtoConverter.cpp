@@ -103,7 +103,7 @@ void AndroidInputEventProtoConverter::toProtoKeyEvent(const TracedKeyEvent& even
 void AndroidInputEventProtoConverter::toProtoWindowDispatchEvent(
         const WindowDispatchArgs& args, proto::AndroidWindowInputDispatchEvent& outProto,
         bool isRedacted) {
-    std::visit([&](auto entry) { outProto.set_event_id(entry.id); }, args.eventEntry);
+    std::visit([&](const auto& entry) { outProto.set_event_id(entry.id); }, *args.eventEntry);
     outProto.set_vsync_id(args.vsyncId);
     outProto.set_window_id(args.windowId);
     outProto.set_resolved_flags(args.resolvedFlags);
@@ -111,7 +111,7 @@ void AndroidInputEventProtoConverter::toProtoWindowDispatchEvent(
     if (isRedacted) {
         return;
     }
-    if (auto* motion = std::get_if<TracedMotionEvent>(&args.eventEntry); motion != nullptr) {
+    if (auto* motion = std::get_if<TracedMotionEvent>(args.eventEntry.get()); motion != nullptr) {
         for (size_t i = 0; i < motion->pointerProperties.size(); i++) {
             auto* pointerProto = outProto.add_dispatched_pointer();
             pointerProto->set_pointer_id(motion->pointerProperties[i].id);
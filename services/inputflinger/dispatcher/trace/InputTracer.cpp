@@ -31,34 +31,35 @@ struct Visitor : V... {
     using V::operator()...;
 };
 
-TracedEvent createTracedEvent(const MotionEntry& e, EventType type) {
-    return TracedMotionEvent{e.id,
-                             e.eventTime,
-                             e.policyFlags,
-                             e.deviceId,
-                             e.source,
-                             e.displayId,
-                             e.action,
-                             e.actionButton,
-                             e.flags,
-                             e.metaState,
-                             e.buttonState,
-                             e.classification,
-                             e.edgeFlags,
-                             e.xPrecision,
-                             e.yPrecision,
-                             e.xCursorPosition,
-                             e.yCursorPosition,
-                             e.downTime,
-                             e.pointerProperties,
-                             e.pointerCoords,
-                             type};
+std::shared_ptr<const TracedEvent> createTracedEvent(const MotionEntry& e, EventType type) {
+    return std::make_shared<const TracedEvent>(TracedMotionEvent{e.id,
+                                                                 e.eventTime,
+                                                                 e.policyFlags,
+                                                                 e.deviceId,
+                                                                 e.source,
+                                                                 e.displayId,
+                                                                 e.action,
+                                                                 e.actionButton,
+                                                                 e.flags,
+                                                                 e.metaState,
+                                                                 e.buttonState,
+                                                                 e.classification,
+                                                                 e.edgeFlags,
+                                                                 e.xPrecision,
+                                                                 e.yPrecision,
+                                                                 e.xCursorPosition,
+                                                                 e.yCursorPosition,
+                                                                 e.downTime,
+                                                                 e.pointerProperties,
+                                                                 e.pointerCoords,
+                                                                 type});
 }
 
-TracedEvent createTracedEvent(const KeyEntry& e, EventType type) {
-    return TracedKeyEvent{e.id,        e.eventTime, e.policyFlags, e.deviceId, e.source,
-                          e.displayId, e.action,    e.keyCode,     e.scanCode, e.metaState,
-                          e.downTime,  e.flags,     e.repeatCount, type};
+std::shared_ptr<const TracedEvent> createTracedEvent(const KeyEntry& e, EventType type) {
+    return std::make_shared<const TracedEvent>(
+            TracedKeyEvent{e.id,        e.eventTime, e.policyFlags, e.deviceId, e.source,
+                           e.displayId, e.action,    e.keyCode,     e.scanCode, e.metaState,
+                           e.downTime,  e.flags,     e.repeatCount, type});
 }
 
 void writeEventToBackend(const TracedEvent& event, const TracedEventMetadata metadata,
@@ -179,7 +180,7 @@ std::unique_ptr<EventTrackerInterface> InputTracer::traceDerivedEvent(
         // is dispatched, such as in the case of key fallback events. To account for these cases,
         // derived events can be traced after the processing is complete for the original event.
         const auto& event = eventState->events.back();
-        writeEventToBackend(event, eventState->metadata, *mBackend);
+        writeEventToBackend(*event, eventState->metadata, *mBackend);
     }
     return std::make_unique<EventTrackerImpl>(std::move(eventState), /*isDerived=*/true);
 }
@@ -199,7 +200,7 @@ void InputTracer::traceEventDispatch(const DispatchEntry& dispatchEntry,
 
     auto tracedEventIt =
             std::find_if(eventState->events.begin(), eventState->events.end(),
-                         [eventId](const auto& event) { return eventId == getId(event); });
+                         [eventId](const auto& event) { return eventId == getId(*event); });
     if (tracedEventIt == eventState->events.end()) {
         LOG(FATAL)
                 << __func__
@@ -215,16 +216,16 @@ void InputTracer::traceEventDispatch(const DispatchEntry& dispatchEntry,
     const int32_t vsyncId = dispatchEntry.windowId.has_value() ? dispatchEntry.vsyncId : 0;
 
     // TODO(b/210460522): Pass HMAC into traceEventDispatch.
-    const WindowDispatchArgs windowDispatchArgs{*tracedEventIt,
-                                                dispatchEntry.deliveryTime,
-                                                dispatchEntry.resolvedFlags,
-                                                dispatchEntry.targetUid,
-                                                vsyncId,
-                                                windowId,
-                                                dispatchEntry.transform,
-                                                dispatchEntry.rawTransform,
-                                                /*hmac=*/{},
-                                                resolvedKeyRepeatCount};
+    WindowDispatchArgs windowDispatchArgs{*tracedEventIt,
+                                          dispatchEntry.deliveryTime,
+                                          dispatchEntry.resolvedFlags,
+                                          dispatchEntry.targetUid,
+                                          vsyncId,
+                                          windowId,
+                                          dispatchEntry.transform,
+                                          dispatchEntry.rawTransform,
+                                          /*hmac=*/{},
+                                          resolvedKeyRepeatCount};
     if (eventState->isEventProcessingComplete) {
         mBackend->traceWindowDispatch(std::move(windowDispatchArgs), eventState->metadata);
     } else {
@@ -249,14 +250,14 @@ void InputTracer::EventState::onEventProcessingComplete(nsecs_t processingTimest
 
     // Write all of the events known so far to the trace.
     for (const auto& event : events) {
-        writeEventToBackend(event, metadata, *tracer.mBackend);
+        writeEventToBackend(*event, metadata, *tracer.mBackend);
     }
     // Write all pending dispatch args to the trace.
     for (const auto& windowDispatchArgs : pendingDispatchArgs) {
         auto tracedEventIt =
                 std::find_if(events.begin(), events.end(),
-                             [id = getId(windowDispatchArgs.eventEntry)](const auto& event) {
-                                 return id == getId(event);
+                             [id = getId(*windowDispatchArgs.eventEntry)](const auto& event) {
+                                 return id == getId(*event);
                              });
         if (tracedEventIt == events.end()) {
             LOG(FATAL) << __func__
@@ -65,7 +65,8 @@ private:
         void onEventProcessingComplete(nsecs_t processingTimestamp);
 
         InputTracer& tracer;
-        std::vector<TracedEvent> events;
+        // Shared with the dispatch args of the events, so that they are not copied for each window.
+        std::vector<std::shared_ptr<const TracedEvent>> events;
         bool isEventProcessingComplete{false};
         // A queue to hold dispatch args from being traced until event processing is complete.
         std::vector<WindowDispatchArgs> pendingDispatchArgs;
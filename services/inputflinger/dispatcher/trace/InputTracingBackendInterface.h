@@ -21,6 +21,7 @@
 #include <ui/Transform.h>
 
 #include <array>
+#include <memory>
 #include <set>
 #include <variant>
 #include <vector>
@@ -103,9 +104,14 @@ struct TracedEventMetadata {
     nsecs_t processingTimestamp;
 };
 
-/** Additional information about an input event being dispatched to a window. */
+/**
+ * Additional information about an input event being dispatched to a window.
+ *
+ * The traced event is shared with every other dispatch of the same event, rather than copied for
+ * each window, because it holds the pointer data of motion events.
+ */
 struct WindowDispatchArgs {
-    TracedEvent eventEntry;
+    std::shared_ptr<const TracedEvent> eventEntry;
     nsecs_t deliveryTime;
     int32_t resolvedFlags;
     gui::Uid targetUid;
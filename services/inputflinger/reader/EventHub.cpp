@@ -53,9 +53,12 @@
 #include <utils/Log.h>
 #include <utils/Timers.h>
 
+#include <atomic>
 #include <filesystem>
+#include <functional>
 #include <optional>
 #include <regex>
+#include <thread>
 #include <utility>
 
 #include "EventHub.h"
@@ -85,6 +88,10 @@ static constexpr int32_t FF_WEAK_MAGNITUDE_CHANNEL_IDX = 1;
 
 static constexpr size_t EVENT_BUFFER_SIZE = 256;
 
+// The maximum number of threads that probe the devices opened together, such as the devices found
+// at boot or the devices behind a USB hub that was just plugged in.
+static constexpr size_t MAX_PROBING_THREADS = 4;
+
 // Mapping for input battery class node IDs lookup.
 // https://www.kernel.org/doc/Documentation/power/power_supply_class.txt
 static const std::unordered_map<std::string, InputBatteryClass> BATTERY_CLASSES =
@@ -244,6 +251,28 @@ static nsecs_t processEventTimestamp(const struct input_event& event) {
 /**
  * Returns the sysfs root path of the input device.
  */
+/**
+ * Runs task(i) for each i in [0, count), on up to maxThreads threads including the calling thread,
+ * and returns once all the tasks are done.
+ */
+static void runInParallel(size_t count, size_t maxThreads,
+                          const std::function<void(size_t)>& task) {
+    std::atomic<size_t> nextIndex = 0;
+    auto worker = [&]() {
+        for (size_t i = nextIndex++; i < count; i = nextIndex++) {
+            task(i);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < std::min(count, maxThreads); i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
 static std::optional<std::filesystem::path> getSysfsRootPath(const char* devicePath) {
     std::error_code errorCode;
 
@@ -596,6 +625,182 @@ status_t EventHub::Device::readDeviceBitMask(unsigned long ioctlCode, BitArray<N
     return ret;
 }
 
+status_t EventHub::Device::probe() {
+    // Load the configuration file for the device.
+    loadConfigurationLocked();
+
+    // Figure out the kinds of events the device reports.
+    readDeviceBitMask(EVIOCGBIT(EV_KEY, 0), keyBitmask);
+    readDeviceBitMask(EVIOCGBIT(EV_ABS, 0), absBitmask);
+    readDeviceBitMask(EVIOCGBIT(EV_REL, 0), relBitmask);
+    readDeviceBitMask(EVIOCGBIT(EV_SW, 0), swBitmask);
+    readDeviceBitMask(EVIOCGBIT(EV_LED, 0), ledBitmask);
+    readDeviceBitMask(EVIOCGBIT(EV_FF, 0), ffBitmask);
+    readDeviceBitMask(EVIOCGBIT(EV_MSC, 0), mscBitmask);
+    readDeviceBitMask(EVIOCGPROP(0), propBitmask);
+
+    // See if this is a device with keys. This could be full keyboard, or other devices like
+    // gamepads, joysticks, and styluses with buttons that should generate key presses.
+    bool haveKeyboardKeys = keyBitmask.any(0, BTN_MISC) || keyBitmask.any(BTN_WHEEL, KEY_MAX + 1);
+    bool haveGamepadButtons =
+            keyBitmask.any(BTN_MISC, BTN_MOUSE) || keyBitmask.any(BTN_JOYSTICK, BTN_DIGI);
+    bool haveStylusButtons = keyBitmask.test(BTN_STYLUS) || keyBitmask.test(BTN_STYLUS2) ||
+            keyBitmask.test(BTN_STYLUS3);
+    if (haveKeyboardKeys || haveGamepadButtons || haveStylusButtons) {
+        classes |= InputDeviceClass::KEYBOARD;
+    }
+
+    // See if this is a cursor device such as a trackball or mouse.
+    if (keyBitmask.test(BTN_MOUSE) && relBitmask.test(REL_X) && relBitmask.test(REL_Y)) {
+        classes |= InputDeviceClass::CURSOR;
+    }
+
+    // See if the device is specially configured to be of a certain type.
+    if (configuration) {
+        std::string deviceType = configuration->getString("device.type").value_or("");
+        if (deviceType == "rotaryEncoder") {
+            classes |= InputDeviceClass::ROTARY_ENCODER;
+        } else if (deviceType == "externalStylus") {
+            classes |= InputDeviceClass::EXTERNAL_STYLUS;
+        }
+    }
+
+    // See if this is a touch pad.
+    // Is this a new modern multi-touch driver?
+    if (absBitmask.test(ABS_MT_POSITION_X) && absBitmask.test(ABS_MT_POSITION_Y)) {
+        // Some joysticks such as the PS3 controller report axes that conflict
+        // with the ABS_MT range.  Try to confirm that the device really is
+        // a touch screen.
+        if (keyBitmask.test(BTN_TOUCH) || !haveGamepadButtons) {
+            classes |= (InputDeviceClass::TOUCH | InputDeviceClass::TOUCH_MT);
+            if (propBitmask.test(INPUT_PROP_POINTER) &&
+                !keyBitmask.any(BTN_TOOL_PEN, BTN_TOOL_FINGER) && !haveStylusButtons) {
+                classes |= InputDeviceClass::TOUCHPAD;
+            }
+        }
+        // Is this an old style single-touch driver?
+    } else if (keyBitmask.test(BTN_TOUCH) && absBitmask.test(ABS_X) && absBitmask.test(ABS_Y)) {
+        classes |= InputDeviceClass::TOUCH;
+        // Is this a stylus that reports contact/pressure independently of touch coordinates?
+    } else if ((absBitmask.test(ABS_PRESSURE) || keyBitmask.test(BTN_TOUCH)) &&
+               !absBitmask.test(ABS_X) && !absBitmask.test(ABS_Y)) {
+        classes |= InputDeviceClass::EXTERNAL_STYLUS;
+    }
+
+    // See if this device is a joystick.
+    // Assumes that joysticks always have gamepad buttons in order to distinguish them
+    // from other devices such as accelerometers that also have absolute axes.
+    if (haveGamepadButtons) {
+        auto assumedClasses = classes | InputDeviceClass::JOYSTICK;
+        for (int i = 0; i <= ABS_MAX; i++) {
+            if (absBitmask.test(i) &&
+                (getAbsAxisUsage(i, assumedClasses).test(InputDeviceClass::JOYSTICK))) {
+                classes = assumedClasses;
+                break;
+            }
+        }
+    }
+
+    // Check whether this device is an accelerometer.
+    if (propBitmask.test(INPUT_PROP_ACCELEROMETER)) {
+        classes |= InputDeviceClass::SENSOR;
+    }
+
+    // Check whether this device has switches.
+    for (int i = 0; i <= SW_MAX; i++) {
+        if (swBitmask.test(i)) {
+            classes |= InputDeviceClass::SWITCH;
+            break;
+        }
+    }
+
+    // Check whether this device supports the vibrator.
+    if (ffBitmask.test(FF_RUMBLE)) {
+        classes |= InputDeviceClass::VIBRATOR;
+    }
+
+    // Configure virtual keys.
+    if ((classes.test(InputDeviceClass::TOUCH))) {
+        // Load the virtual keys for the touch screen, if any.
+        // We do this now so that we can make sure to load the keymap if necessary.
+        bool success = loadVirtualKeyMapLocked();
+        if (success) {
+            classes |= InputDeviceClass::KEYBOARD;
+        }
+    }
+
+    // Load the key map.
+    // We need to do this for joysticks too because the key layout may specify axes, and for
+    // sensor as well because the key layout may specify the axes to sensor data mapping.
+    status_t keyMapStatus = NAME_NOT_FOUND;
+    if (classes.any(InputDeviceClass::KEYBOARD | InputDeviceClass::JOYSTICK |
+                    InputDeviceClass::SENSOR)) {
+        // Load the keymap for the device.
+        keyMapStatus = loadKeyMapLocked();
+    }
+
+    // Configure the keyboard, gamepad or virtual keyboard.
+    if (classes.test(InputDeviceClass::KEYBOARD)) {
+        // 'Q' key support = cheap test of whether this is an alpha-capable kbd
+        if (hasKeycodeLocked(AKEYCODE_Q)) {
+            classes |= InputDeviceClass::ALPHAKEY;
+        }
+
+        // See if this device has a D-pad.
+        if (std::all_of(DPAD_REQUIRED_KEYCODES.begin(), DPAD_REQUIRED_KEYCODES.end(),
+                        [&](int32_t keycode) { return hasKeycodeLocked(keycode); })) {
+            classes |= InputDeviceClass::DPAD;
+        }
+
+        // See if this device has a gamepad.
+        if (std::any_of(GAMEPAD_KEYCODES.begin(), GAMEPAD_KEYCODES.end(),
+                        [&](int32_t keycode) { return hasKeycodeLocked(keycode); })) {
+            classes |= InputDeviceClass::GAMEPAD;
+        }
+
+        // See if this device has any stylus buttons that we would want to fuse with touch data.
+        if (!classes.any(InputDeviceClass::TOUCH | InputDeviceClass::TOUCH_MT) &&
+            !classes.any(InputDeviceClass::ALPHAKEY) &&
+            std::any_of(STYLUS_BUTTON_KEYCODES.begin(), STYLUS_BUTTON_KEYCODES.end(),
+                        [&](int32_t keycode) { return hasKeycodeLocked(keycode); })) {
+            classes |= InputDeviceClass::EXTERNAL_STYLUS;
+        }
+    }
+
+    // See if the device is a rotary encoder with a single scroll axis and nothing else.
+    if (vd_flags::virtual_rotary() && classes == ftl::Flags<InputDeviceClass>(0) &&
+        relBitmask.test(REL_WHEEL) && !relBitmask.test(REL_HWHEEL)) {
+        classes |= InputDeviceClass::ROTARY_ENCODER;
+    }
+
+    if (classes == ftl::Flags<InputDeviceClass>(0)) {
+        return keyMapStatus;
+    }
+
+    // Classify InputDeviceClass::BATTERY.
+    if (associatedDevice && !associatedDevice->batteryInfos.empty()) {
+        classes |= InputDeviceClass::BATTERY;
+    }
+
+    // Classify InputDeviceClass::LIGHT.
+    if (associatedDevice && !associatedDevice->lightInfos.empty()) {
+        classes |= InputDeviceClass::LIGHT;
+    }
+
+    // Determine whether the device has a mic.
+    if (deviceHasMicLocked()) {
+        classes |= InputDeviceClass::MIC;
+    }
+
+    // Determine whether the device is external or internal.
+    if (isExternalDeviceLocked()) {
+        classes |= InputDeviceClass::EXTERNAL;
+    }
+
+    configureFd();
+    return keyMapStatus;
+}
+
 void EventHub::Device::configureFd() {
     // Set fd parameters with ioctl, such as key repeat, suspend block, and clock type
     if (classes.test(InputDeviceClass::KEYBOARD)) {
@@ -773,6 +978,37 @@ status_t EventHub::Device::mapLed(int32_t led, int32_t* outScanCode) const {
     return NAME_NOT_FOUND;
 }
 
+void EventHub::Device::trackReadDelay(nsecs_t readDelay) {
+    if (classes.test(InputDeviceClass::SENSOR)) {
+        // Sensors timestamp their events with CLOCK_BOOTTIME, so the delay can't be measured.
+        return;
+    }
+    size_t bucket = 0;
+    for (nsecs_t limit = ms2ns(1); bucket < READ_DELAY_BUCKET_COUNT - 1 && readDelay >= limit;
+         limit *= 2) {
+        bucket++;
+    }
+    readDelayHistogram[bucket]++;
+}
+
+std::string EventHub::Device::dumpReadDelayHistogram() const {
+    std::string dump;
+    nsecs_t limit = ms2ns(1);
+    for (size_t bucket = 0; bucket < READ_DELAY_BUCKET_COUNT; bucket++, limit *= 2) {
+        if (!dump.empty()) {
+            dump += ", ";
+        }
+        if (bucket < READ_DELAY_BUCKET_COUNT - 1) {
+            dump += StringPrintf("<%" PRId64 "ms=%" PRIu64, ns2ms(limit),
+                                 readDelayHistogram[bucket]);
+        } else {
+            dump += StringPrintf(">=%" PRId64 "ms=%" PRIu64, ns2ms(limit / 2),
+                                 readDelayHistogram[bucket]);
+        }
+    }
+    return dump;
+}
+
 void EventHub::Device::trackInputEvent(const struct input_event& event) {
     switch (event.type) {
         case EV_KEY: {
@@ -1709,7 +1945,7 @@ std::vector<int32_t> EventHub::getVibratorIds(int32_t deviceId) const {
 }
 
 /**
- * Checks both mDevices and mOpeningDevices for a device with the descriptor passed.
+ * Checks mDevices, mOpeningDevices and mProbingDevices for a device with the descriptor passed.
  */
 bool EventHub::hasDeviceWithDescriptorLocked(const std::string& descriptor) const {
     for (const auto& device : mOpeningDevices) {
@@ -1718,6 +1954,12 @@ bool EventHub::hasDeviceWithDescriptorLocked(const std::string& descriptor) cons
         }
     }
 
+    for (const auto& device : mProbingDevices) {
+        if (descriptor == device->identifier.descriptor) {
+            return true;
+        }
+    }
+
     for (const auto& [id, device] : mDevices) {
         if (descriptor == device->identifier.descriptor) {
             return true;
@@ -1849,6 +2091,7 @@ std::vector<RawEvent> EventHub::getEvents(int timeoutMillis) {
     std::array<input_event, EVENT_BUFFER_SIZE> readBuffer;
 
     std::vector<RawEvent> events;
+    events.reserve(EVENT_BUFFER_SIZE);
     bool awoken = false;
     for (;;) {
         nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
@@ -1994,14 +2237,20 @@ std::vector<RawEvent> EventHub::getEvents(int timeoutMillis) {
                     ALOGE("could not get event (wrong size: %d)", readSize);
                 } else {
                     const int32_t deviceId = device->id == mBuiltInKeyboardId ? 0 : device->id;
+                    // All the events in the buffer were read by the same system call.
+                    const nsecs_t readTime = systemTime(SYSTEM_TIME_MONOTONIC);
 
                     const size_t count = size_t(readSize) / sizeof(struct input_event);
                     for (size_t i = 0; i < count; i++) {
                         struct input_event& iev = readBuffer[i];
                         device->trackInputEvent(iev);
+                        const nsecs_t when = processEventTimestamp(iev);
+                        if (iev.type == EV_SYN && iev.code == SYN_REPORT) {
+                            device->trackReadDelay(readTime - when);
+                        }
                         events.push_back({
-                                .when = processEventTimestamp(iev),
-                                .readTime = systemTime(SYSTEM_TIME_MONOTONIC),
+                                .when = when,
+                                .readTime = readTime,
                                 .deviceId = deviceId,
                                 .type = iev.type,
                                 .code = iev.code,
@@ -2227,13 +2476,46 @@ void EventHub::reportDeviceAddedForStatisticsLocked(const InputDeviceIdentifier&
 }
 
 void EventHub::openDeviceLocked(const std::string& devicePath) {
+    openDevicesLocked({devicePath});
+}
+
+void EventHub::openDevicesLocked(const std::vector<std::string>& devicePaths) {
+    // Identify the devices first, in order, since their ids and descriptors depend on the devices
+    // that are already known.
+    for (const std::string& devicePath : devicePaths) {
+        std::unique_ptr<Device> device = createDeviceLocked(devicePath);
+        if (device != nullptr) {
+            mProbingDevices.push_back(std::move(device));
+        }
+    }
+
+    // Probing a device issues dozens of ioctls and loads its configuration files. It only uses the
+    // state of the device being probed, so the devices are probed in parallel.
+    std::vector<std::unique_ptr<Device>> devices = std::move(mProbingDevices);
+    mProbingDevices.clear();
+    std::vector<status_t> keyMapStatuses(devices.size());
+    runInParallel(devices.size(), MAX_PROBING_THREADS, [&devices, &keyMapStatuses](size_t i) {
+        keyMapStatuses[i] = devices[i]->probe();
+    });
+
+    for (size_t i = 0; i < devices.size(); i++) {
+        addProbedDeviceLocked(std::move(devices[i]), keyMapStatuses[i]);
+    }
+}
+
+std::unique_ptr<EventHub::Device> EventHub::createDeviceLocked(const std::string& devicePath) {
     // If an input device happens to register around the time when EventHub's constructor runs, it
     // is possible that the same input event node (for example, /dev/input/event3) will be noticed
     // in both 'inotify' callback and also in the 'scanDirLocked' pass. To prevent duplicate devices
     // from getting registered, ensure that this path is not already covered by an existing device.
     for (const auto& [deviceId, device] : mDevices) {
         if (device->path == devicePath) {
-            return; // device was already registered
+            return nullptr; // device was already registered
+        }
+    }
+    for (const auto& device : mProbingDevices) {
+        if (device->path == devicePath) {
+            return nullptr; // device is already being opened
         }
     }
 
@@ -2244,7 +2526,7 @@ void EventHub::openDeviceLocked(const std::string& devicePath) {
     int fd = open(devicePath.c_str(), O_RDWR | O_CLOEXEC | O_NONBLOCK);
     if (fd < 0) {
         ALOGE("could not open %s, %s\n", devicePath.c_str(), strerror(errno));
-        return;
+        return nullptr;
     }
 
     InputDeviceIdentifier identifier;
@@ -2263,7 +2545,7 @@ void EventHub::openDeviceLocked(const std::string& devicePath) {
         if (identifier.name == item) {
             ALOGI("ignoring event id %s driver %s\n", devicePath.c_str(), item.c_str());
             close(fd);
-            return;
+            return nullptr;
         }
     }
 
@@ -2272,7 +2554,7 @@ void EventHub::openDeviceLocked(const std::string& devicePath) {
     if (ioctl(fd, EVIOCGVERSION, &driverVersion)) {
         ALOGE("could not get driver version for %s, %s\n", devicePath.c_str(), strerror(errno));
         close(fd);
-        return;
+        return nullptr;
     }
 
     // Get device identifier.
@@ -2280,7 +2562,7 @@ void EventHub::openDeviceLocked(const std::string& devicePath) {
     if (ioctl(fd, EVIOCGID, &inputId)) {
         ALOGE("could not get device input id for %s, %s\n", devicePath.c_str(), strerror(errno));
         close(fd);
-        return;
+        return nullptr;
     }
     identifier.bus = inputId.bustype;
     identifier.product = inputId.product;
@@ -2336,162 +2618,12 @@ void EventHub::openDeviceLocked(const std::string& devicePath) {
     ALOGV("  driver:     v%d.%d.%d\n", driverVersion >> 16, (driverVersion >> 8) & 0xff,
           driverVersion & 0xff);
 
-    // Load the configuration file for the device.
-    device->loadConfigurationLocked();
-
-    // Figure out the kinds of events the device reports.
-    device->readDeviceBitMask(EVIOCGBIT(EV_KEY, 0), device->keyBitmask);
-    device->readDeviceBitMask(EVIOCGBIT(EV_ABS, 0), device->absBitmask);
-    device->readDeviceBitMask(EVIOCGBIT(EV_REL, 0), device->relBitmask);
-    device->readDeviceBitMask(EVIOCGBIT(EV_SW, 0), device->swBitmask);
-    device->readDeviceBitMask(EVIOCGBIT(EV_LED, 0), device->ledBitmask);
-    device->readDeviceBitMask(EVIOCGBIT(EV_FF, 0), device->ffBitmask);
-    device->readDeviceBitMask(EVIOCGBIT(EV_MSC, 0), device->mscBitmask);
-    device->readDeviceBitMask(EVIOCGPROP(0), device->propBitmask);
-
-    // See if this is a device with keys. This could be full keyboard, or other devices like
-    // gamepads, joysticks, and styluses with buttons that should generate key presses.
-    bool haveKeyboardKeys =
-            device->keyBitmask.any(0, BTN_MISC) || device->keyBitmask.any(BTN_WHEEL, KEY_MAX + 1);
-    bool haveGamepadButtons = device->keyBitmask.any(BTN_MISC, BTN_MOUSE) ||
-            device->keyBitmask.any(BTN_JOYSTICK, BTN_DIGI);
-    bool haveStylusButtons = device->keyBitmask.test(BTN_STYLUS) ||
-            device->keyBitmask.test(BTN_STYLUS2) || device->keyBitmask.test(BTN_STYLUS3);
-    if (haveKeyboardKeys || haveGamepadButtons || haveStylusButtons) {
-        device->classes |= InputDeviceClass::KEYBOARD;
-    }
-
-    // See if this is a cursor device such as a trackball or mouse.
-    if (device->keyBitmask.test(BTN_MOUSE) && device->relBitmask.test(REL_X) &&
-        device->relBitmask.test(REL_Y)) {
-        device->classes |= InputDeviceClass::CURSOR;
-    }
-
-    // See if the device is specially configured to be of a certain type.
-    if (device->configuration) {
-        std::string deviceType = device->configuration->getString("device.type").value_or("");
-        if (deviceType == "rotaryEncoder") {
-            device->classes |= InputDeviceClass::ROTARY_ENCODER;
-        } else if (deviceType == "externalStylus") {
-            device->classes |= InputDeviceClass::EXTERNAL_STYLUS;
-        }
-    }
-
-    // See if this is a touch pad.
-    // Is this a new modern multi-touch driver?
-    if (device->absBitmask.test(ABS_MT_POSITION_X) && device->absBitmask.test(ABS_MT_POSITION_Y)) {
-        // Some joysticks such as the PS3 controller report axes that conflict
-        // with the ABS_MT range.  Try to confirm that the device really is
-        // a touch screen.
-        if (device->keyBitmask.test(BTN_TOUCH) || !haveGamepadButtons) {
-            device->classes |= (InputDeviceClass::TOUCH | InputDeviceClass::TOUCH_MT);
-            if (device->propBitmask.test(INPUT_PROP_POINTER) &&
-                !device->keyBitmask.any(BTN_TOOL_PEN, BTN_TOOL_FINGER) && !haveStylusButtons) {
-                device->classes |= InputDeviceClass::TOUCHPAD;
-            }
-        }
-        // Is this an old style single-touch driver?
-    } else if (device->keyBitmask.test(BTN_TOUCH) && device->absBitmask.test(ABS_X) &&
-               device->absBitmask.test(ABS_Y)) {
-        device->classes |= InputDeviceClass::TOUCH;
-        // Is this a stylus that reports contact/pressure independently of touch coordinates?
-    } else if ((device->absBitmask.test(ABS_PRESSURE) || device->keyBitmask.test(BTN_TOUCH)) &&
-               !device->absBitmask.test(ABS_X) && !device->absBitmask.test(ABS_Y)) {
-        device->classes |= InputDeviceClass::EXTERNAL_STYLUS;
-    }
-
-    // See if this device is a joystick.
-    // Assumes that joysticks always have gamepad buttons in order to distinguish them
-    // from other devices such as accelerometers that also have absolute axes.
-    if (haveGamepadButtons) {
-        auto assumedClasses = device->classes | InputDeviceClass::JOYSTICK;
-        for (int i = 0; i <= ABS_MAX; i++) {
-            if (device->absBitmask.test(i) &&
-                (getAbsAxisUsage(i, assumedClasses).test(InputDeviceClass::JOYSTICK))) {
-                device->classes = assumedClasses;
-                break;
-            }
-        }
-    }
-
-    // Check whether this device is an accelerometer.
-    if (device->propBitmask.test(INPUT_PROP_ACCELEROMETER)) {
-        device->classes |= InputDeviceClass::SENSOR;
-    }
-
-    // Check whether this device has switches.
-    for (int i = 0; i <= SW_MAX; i++) {
-        if (device->swBitmask.test(i)) {
-            device->classes |= InputDeviceClass::SWITCH;
-            break;
-        }
-    }
-
-    // Check whether this device supports the vibrator.
-    if (device->ffBitmask.test(FF_RUMBLE)) {
-        device->classes |= InputDeviceClass::VIBRATOR;
-    }
-
-    // Configure virtual keys.
-    if ((device->classes.test(InputDeviceClass::TOUCH))) {
-        // Load the virtual keys for the touch screen, if any.
-        // We do this now so that we can make sure to load the keymap if necessary.
-        bool success = device->loadVirtualKeyMapLocked();
-        if (success) {
-            device->classes |= InputDeviceClass::KEYBOARD;
-        }
-    }
-
-    // Load the key map.
-    // We need to do this for joysticks too because the key layout may specify axes, and for
-    // sensor as well because the key layout may specify the axes to sensor data mapping.
-    status_t keyMapStatus = NAME_NOT_FOUND;
-    if (device->classes.any(InputDeviceClass::KEYBOARD | InputDeviceClass::JOYSTICK |
-                            InputDeviceClass::SENSOR)) {
-        // Load the keymap for the device.
-        keyMapStatus = device->loadKeyMapLocked();
-    }
-
-    // Configure the keyboard, gamepad or virtual keyboard.
-    if (device->classes.test(InputDeviceClass::KEYBOARD)) {
-        // Register the keyboard as a built-in keyboard if it is eligible.
-        if (!keyMapStatus && mBuiltInKeyboardId == NO_BUILT_IN_KEYBOARD &&
-            isEligibleBuiltInKeyboard(device->identifier, device->configuration.get(),
-                                      &device->keyMap)) {
-            mBuiltInKeyboardId = device->id;
-        }
-
-        // 'Q' key support = cheap test of whether this is an alpha-capable kbd
-        if (device->hasKeycodeLocked(AKEYCODE_Q)) {
-            device->classes |= InputDeviceClass::ALPHAKEY;
-        }
-
-        // See if this device has a D-pad.
-        if (std::all_of(DPAD_REQUIRED_KEYCODES.begin(), DPAD_REQUIRED_KEYCODES.end(),
-                        [&](int32_t keycode) { return device->hasKeycodeLocked(keycode); })) {
-            device->classes |= InputDeviceClass::DPAD;
-        }
-
-        // See if this device has a gamepad.
-        if (std::any_of(GAMEPAD_KEYCODES.begin(), GAMEPAD_KEYCODES.end(),
-                        [&](int32_t keycode) { return device->hasKeycodeLocked(keycode); })) {
-            device->classes |= InputDeviceClass::GAMEPAD;
-        }
+    return device;
+}
 
-        // See if this device has any stylus buttons that we would want to fuse with touch data.
-        if (!device->classes.any(InputDeviceClass::TOUCH | InputDeviceClass::TOUCH_MT) &&
-            !device->classes.any(InputDeviceClass::ALPHAKEY) &&
-            std::any_of(STYLUS_BUTTON_KEYCODES.begin(), STYLUS_BUTTON_KEYCODES.end(),
-                        [&](int32_t keycode) { return device->hasKeycodeLocked(keycode); })) {
-            device->classes |= InputDeviceClass::EXTERNAL_STYLUS;
-        }
-    }
-
-    // See if the device is a rotary encoder with a single scroll axis and nothing else.
-    if (vd_flags::virtual_rotary() && device->classes == ftl::Flags<InputDeviceClass>(0) &&
-        device->relBitmask.test(REL_WHEEL) && !device->relBitmask.test(REL_HWHEEL)) {
-        device->classes |= InputDeviceClass::ROTARY_ENCODER;
-    }
+void EventHub::addProbedDeviceLocked(std::unique_ptr<Device> device, status_t keyMapStatus) {
+    const int32_t deviceId = device->id;
+    const std::string& devicePath = device->path;
 
     // If the device isn't recognized as something we handle, don't monitor it.
     if (device->classes == ftl::Flags<InputDeviceClass>(0)) {
@@ -2500,24 +2632,12 @@ void EventHub::openDeviceLocked(const std::string& devicePath) {
         return;
     }
 
-    // Classify InputDeviceClass::BATTERY.
-    if (device->associatedDevice && !device->associatedDevice->batteryInfos.empty()) {
-        device->classes |= InputDeviceClass::BATTERY;
-    }
-
-    // Classify InputDeviceClass::LIGHT.
-    if (device->associatedDevice && !device->associatedDevice->lightInfos.empty()) {
-        device->classes |= InputDeviceClass::LIGHT;
-    }
-
-    // Determine whether the device has a mic.
-    if (device->deviceHasMicLocked()) {
-        device->classes |= InputDeviceClass::MIC;
-    }
-
-    // Determine whether the device is external or internal.
-    if (device->isExternalDeviceLocked()) {
-        device->classes |= InputDeviceClass::EXTERNAL;
+    // Register the keyboard as a built-in keyboard if it is eligible.
+    if (device->classes.test(InputDeviceClass::KEYBOARD) && !keyMapStatus &&
+        mBuiltInKeyboardId == NO_BUILT_IN_KEYBOARD &&
+        isEligibleBuiltInKeyboard(device->identifier, device->configuration.get(),
+                                  &device->keyMap)) {
+        mBuiltInKeyboardId = device->id;
     }
 
     if (device->classes.any(InputDeviceClass::JOYSTICK | InputDeviceClass::DPAD) &&
@@ -2530,11 +2650,9 @@ void EventHub::openDeviceLocked(const std::string& devicePath) {
         return;
     }
 
-    device->configureFd();
-
     ALOGI("New device: id=%d, fd=%d, path='%s', name='%s', classes=%s, "
           "configuration='%s', keyLayout='%s', keyCharacterMap='%s', builtinKeyboard=%s, ",
-          deviceId, fd, devicePath.c_str(), device->identifier.name.c_str(),
+          deviceId, device->fd, devicePath.c_str(), device->identifier.name.c_str(),
           device->classes.string().c_str(), device->configurationFile.c_str(),
           device->keyMap.keyLayoutFile.c_str(), device->keyMap.keyCharacterMapFile.c_str(),
           toString(mBuiltInKeyboardId == deviceId));
@@ -2767,17 +2885,28 @@ base::Result<void> EventHub::readNotifyLocked() {
 
     if (sizeRead < EVENT_SIZE) return Errorf("could not get event, %s", strerror(errno));
 
+    // Input devices that are created together, such as the devices behind a USB hub that was just
+    // plugged in, are opened together so that they are probed in parallel.
+    std::vector<std::string> devicesToOpen;
     for (ssize_t eventPos = 0; sizeRead >= EVENT_SIZE;) {
         const inotify_event* event;
         event = (const inotify_event*)(eventBuffer + eventPos);
         if (event->len == 0) continue;
 
-        handleNotifyEventLocked(*event);
+        if (event->wd == mDeviceInputWd && (event->mask & IN_CREATE)) {
+            devicesToOpen.push_back(std::string(DEVICE_INPUT_PATH) + "/" + event->name);
+        } else {
+            // Keep the events in order.
+            openDevicesLocked(devicesToOpen);
+            devicesToOpen.clear();
+            handleNotifyEventLocked(*event);
+        }
 
         const ssize_t eventSize = EVENT_SIZE + event->len;
         sizeRead -= eventSize;
         eventPos += eventSize;
     }
+    openDevicesLocked(devicesToOpen);
     return {};
 }
 
@@ -2808,9 +2937,11 @@ void EventHub::handleNotifyEventLocked(const inotify_event& event) {
 }
 
 status_t EventHub::scanDirLocked(const std::string& dirname) {
+    std::vector<std::string> devicePaths;
     for (const auto& entry : std::filesystem::directory_iterator(dirname)) {
-        openDeviceLocked(entry.path());
+        devicePaths.push_back(entry.path());
     }
+    openDevicesLocked(devicePaths);
     return 0;
 }
 
@@ -2830,6 +2961,8 @@ status_t EventHub::scanVideoDirLocked(const std::string& dirname) {
 void EventHub::requestReopenDevices() {
     ALOGV("requestReopenDevices() called");
 
+    // The configuration files may have been updated, so search for them again.
+    clearInputDeviceConfigurationFilePathCache();
     std::scoped_lock _l(mLock);
     mNeedToReopenDevices = true;
 }
@@ -2908,6 +3041,7 @@ void EventHub::dump(std::string& dump) const {
                 }
                 dump += INDENT3 "AbsState: " + axisValues + "\n";
             }
+            dump += INDENT3 "ReadDelay (frames): " + device->dumpReadDelayHistogram() + "\n";
         }
 
         dump += INDENT "Unattached video devices:\n";
@@ -145,6 +145,7 @@ void InputReader::loopOnce() {
     { // acquire lock
         std::scoped_lock _l(mLock);
 
+        mLoopThreadId = std::this_thread::get_id();
         oldGeneration = mGeneration;
         timeoutMillis = -1;
 
@@ -512,7 +513,12 @@ bool InputReader::shouldDropVirtualKeyLocked(nsecs_t now, int32_t keyCode, int32
 void InputReader::requestTimeoutAtTimeLocked(nsecs_t when) {
     if (when < mNextTimeout) {
         mNextTimeout = when;
-        mEventHub->wake();
+        // The reader thread picks up the new timeout before it next waits for events, so it only
+        // needs a wake-up when the request comes from another thread. Mappers such as the touchpad
+        // reschedule their timers on almost every evdev frame.
+        if (std::this_thread::get_id() != mLoopThreadId) {
+            mEventHub->wake();
+        }
     }
 }
 
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <array>
 #include <bitset>
 #include <climits>
 #include <filesystem>
@@ -677,6 +678,10 @@ private:
         template <std::size_t N>
         status_t readDeviceBitMask(unsigned long ioctlCode, BitArray<N>& bitArray);
 
+        // Reads the capabilities of the device, loads its configuration and key maps, and
+        // classifies it. Only uses the state of this device, so that devices can be probed in
+        // parallel. Returns the status of loading the key map.
+        status_t probe();
         void configureFd();
         void populateAbsoluteAxisStates();
         bool hasKeycodeLocked(int keycode) const;
@@ -692,12 +697,35 @@ private:
         bool currentFrameDropped;
         void trackInputEvent(const struct input_event& event);
         void readDeviceState();
+
+        // The number of frames read from the device, bucketed by the time between the kernel
+        // timestamping the frame and EventHub reading it: < 1ms, < 2ms, < 4ms, ... < 64ms, and
+        // >= 64ms.
+        static constexpr size_t READ_DELAY_BUCKET_COUNT = 8;
+        std::array<uint64_t, READ_DELAY_BUCKET_COUNT> readDelayHistogram{};
+        void trackReadDelay(nsecs_t readDelay);
+        std::string dumpReadDelayHistogram() const;
     };
 
     /**
      * Create a new device for the provided path.
      */
     void openDeviceLocked(const std::string& devicePath) REQUIRES(mLock);
+    /**
+     * Create new devices for the provided paths. The devices are probed in parallel, and are only
+     * added once they are all probed.
+     */
+    void openDevicesLocked(const std::vector<std::string>& devicePaths) REQUIRES(mLock);
+    /**
+     * Open and identify the device at the provided path, before it is probed. Returns nullptr if
+     * the device is already open, cannot be opened, or is excluded.
+     */
+    std::unique_ptr<Device> createDeviceLocked(const std::string& devicePath) REQUIRES(mLock);
+    /**
+     * Add a device that was probed, unless it is not a kind of device that we handle.
+     */
+    void addProbedDeviceLocked(std::unique_ptr<Device> device, status_t keyMapStatus)
+            REQUIRES(mLock);
     void openVideoDeviceLocked(const std::string& devicePath) REQUIRES(mLock);
     /**
      * Try to associate a video device with an input device. If the association succeeds,
@@ -785,6 +813,8 @@ private:
 
     std::vector<std::unique_ptr<Device>> mOpeningDevices;
     std::vector<std::unique_ptr<Device>> mClosingDevices;
+    // Devices that are being probed by openDevicesLocked, and have not been added yet.
+    std::vector<std::unique_ptr<Device>> mProbingDevices;
 
     bool mNeedToReopenDevices;
     bool mNeedToScanDevices;
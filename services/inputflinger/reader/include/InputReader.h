@@ -21,6 +21,7 @@
 #include <utils/Mutex.h>
 
 #include <memory>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -247,6 +248,8 @@ private:
     bool shouldDropVirtualKeyLocked(nsecs_t now, int32_t keyCode, int32_t scanCode) REQUIRES(mLock);
 
     nsecs_t mNextTimeout GUARDED_BY(mLock);
+    // The thread that runs loopOnce, which does not need to be woken up for a new timeout.
+    std::thread::id mLoopThreadId GUARDED_BY(mLock);
     void requestTimeoutAtTimeLocked(nsecs_t when) REQUIRES(mLock);
 
     ConfigurationChanges mConfigurationChangesToRefresh GUARDED_BY(mLock);
@@ -2246,6 +2246,11 @@ void TouchInputMapper::cookPointerData() {
         mCurrentCookedState.buttonState = mCurrentRawState.buttonState;
     }
 
+    // When the size is summed over all of the touching pointers, each pointer gets its share.
+    const uint32_t touchingCount = mCurrentRawState.rawPointerData.touchingIdBits.count();
+    const bool divideSizeByTouchingCount =
+            mCalibration.sizeIsSummed && *mCalibration.sizeIsSummed && touchingCount > 1;
+
     // Walk through the the active pointers and map device coordinates onto
     // display coordinates and adjust for display orientation.
     for (uint32_t i = 0; i < currentPointerCount; i++) {
@@ -2288,15 +2293,12 @@ void TouchInputMapper::cookPointerData() {
                     size = 0;
                 }
 
-                if (mCalibration.sizeIsSummed && *mCalibration.sizeIsSummed) {
-                    uint32_t touchingCount = mCurrentRawState.rawPointerData.touchingIdBits.count();
-                    if (touchingCount > 1) {
-                        touchMajor /= touchingCount;
-                        touchMinor /= touchingCount;
-                        toolMajor /= touchingCount;
-                        toolMinor /= touchingCount;
-                        size /= touchingCount;
-                    }
+                if (divideSizeByTouchingCount) {
+                    touchMajor /= touchingCount;
+                    touchMinor /= touchingCount;
+                    toolMajor /= touchingCount;
+                    toolMinor /= touchingCount;
+                    size /= touchingCount;
                 }
 
                 if (mCalibration.sizeCalibration == Calibration::SizeCalibration::GEOMETRIC) {
@@ -2398,7 +2400,8 @@ void TouchInputMapper::cookPointerData() {
         mAffineTransform.applyTo(transformed.x /*byRef*/, transformed.y /*byRef*/);
         transformed = mRawToDisplay.transform(transformed);
 
-        // Write output coords.
+        // Write output coords. PointerCoords keeps its values sorted by axis, so the axes are
+        // written in increasing order for each value to be appended rather than inserted.
         PointerCoords& out = mCurrentCookedState.cookedPointerData.pointerCoords[i];
         out.clear();
         out.setAxisValue(AMOTION_EVENT_AXIS_X, transformed.x);
@@ -2407,11 +2410,11 @@ void TouchInputMapper::cookPointerData() {
         out.setAxisValue(AMOTION_EVENT_AXIS_SIZE, size);
         out.setAxisValue(AMOTION_EVENT_AXIS_TOUCH_MAJOR, touchMajor);
         out.setAxisValue(AMOTION_EVENT_AXIS_TOUCH_MINOR, touchMinor);
-        out.setAxisValue(AMOTION_EVENT_AXIS_ORIENTATION, orientation);
-        out.setAxisValue(AMOTION_EVENT_AXIS_TILT, tilt);
-        out.setAxisValue(AMOTION_EVENT_AXIS_DISTANCE, distance);
         out.setAxisValue(AMOTION_EVENT_AXIS_TOOL_MAJOR, toolMajor);
         out.setAxisValue(AMOTION_EVENT_AXIS_TOOL_MINOR, toolMinor);
+        out.setAxisValue(AMOTION_EVENT_AXIS_ORIENTATION, orientation);
+        out.setAxisValue(AMOTION_EVENT_AXIS_DISTANCE, distance);
+        out.setAxisValue(AMOTION_EVENT_AXIS_TILT, tilt);
 
         // Write output relative fields if applicable.
         uint32_t id = in.id;
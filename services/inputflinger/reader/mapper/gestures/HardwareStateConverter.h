@@ -39,11 +39,16 @@ public:
     HardwareStateConverter(const InputDeviceContext& deviceContext,
                            MultiTouchMotionAccumulator& motionAccumulator);
 
-    std::optional<SelfContainedHardwareState> processRawEvent(const RawEvent& event);
+    // Returns the HardwareState completed by a SYN_REPORT, or nullptr. The state is owned by the
+    // converter and is only valid until the next call.
+    SelfContainedHardwareState* processRawEvent(const RawEvent& event);
     void reset();
 
 private:
-    SelfContainedHardwareState produceHardwareState(nsecs_t when);
+    void produceHardwareState(nsecs_t when);
+
+    // Reused for every frame, so that its FingerState storage is only allocated once.
+    SelfContainedHardwareState mState;
 
     const InputDeviceContext& mDeviceContext;
     CursorButtonAccumulator mCursorButtonAccumulator;
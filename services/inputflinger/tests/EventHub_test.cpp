@@ -186,6 +186,33 @@ TEST_F(EventHubTest, DevicesWithMatchingUniqueIdsAreUnique) {
     waitForDeviceClose(deviceId2);
 }
 
+/**
+ * Ensure that identical devices get assigned unique descriptors when they are probed together, as
+ * they are when EventHub scans the devices that already exist.
+ */
+TEST_F(EventHubTest, DevicesProbedTogetherAreUnique) {
+    std::unique_ptr<UinputHomeKey> keyboard2 = createUinputDevice<UinputHomeKey>();
+    ASSERT_NO_FATAL_FAILURE(waitForDeviceCreation());
+
+    mEventHub = std::make_unique<EventHub>();
+    std::vector<int32_t> keyboardIds;
+    for (const RawEvent& event : getEvents()) {
+        if (event.type == EventHubInterface::DEVICE_ADDED &&
+            mEventHub->getDeviceIdentifier(event.deviceId).name == mKeyboard->getName()) {
+            keyboardIds.push_back(event.deviceId);
+        }
+    }
+    ASSERT_EQ(2U, keyboardIds.size());
+    ASSERT_NE(mEventHub->getDeviceIdentifier(keyboardIds[0]).descriptor,
+              mEventHub->getDeviceIdentifier(keyboardIds[1]).descriptor);
+
+    keyboard2.reset();
+    std::vector<RawEvent> events = getEvents(2);
+    ASSERT_EQ(1U, events.size());
+    EXPECT_EQ(static_cast<int32_t>(EventHubInterface::DEVICE_REMOVED), events[0].type);
+    mDeviceId = events[0].deviceId == keyboardIds[0] ? keyboardIds[1] : keyboardIds[0];
+}
+
 /**
  * Ensure that input_events are generated with monotonic clock.
  * That means input_event should receive a timestamp that is in the future of the time
@@ -207,6 +234,24 @@ TEST_F(EventHubTest, InputEvent_TimestampIsMonotonic) {
     }
 }
 
+/**
+ * Ensure that the delay between the kernel and EventHub is measured for every frame read from a
+ * device, and reported in the dump.
+ */
+TEST_F(EventHubTest, ReadDelayIsTracked) {
+    ASSERT_NO_FATAL_FAILURE(mKeyboard->pressAndReleaseHomeKey());
+
+    std::vector<RawEvent> events = getEvents(4);
+    ASSERT_EQ(4U, events.size()) << "Expected to receive 2 keys and 2 syncs, total of 4 events";
+    for (const RawEvent& event : events) {
+        ASSERT_LE(event.when, event.readTime) << "Event must have been read after it occurred";
+    }
+
+    std::string dump;
+    mEventHub->dump(dump);
+    ASSERT_NE(std::string::npos, dump.find("ReadDelay (frames): "));
+}
+
 // --- BitArrayTest ---
 class BitArrayTest : public testing::Test {
 protected:
@@ -175,6 +175,10 @@ void FakeEventHub::setMscEvent(int32_t deviceId, int32_t mscEvent) {
     getDevice(deviceId)->mscBitmask.loadFromBuffer(buffer);
 }
 
+void FakeEventHub::addInputProperty(int32_t deviceId, int property) {
+    getDevice(deviceId)->inputProperties.insert(property);
+}
+
 void FakeEventHub::addRawLightInfo(int32_t rawId, RawLightInfo&& info) {
     mRawLightInfos.emplace(rawId, std::move(info));
 }
@@ -281,7 +285,11 @@ bool FakeEventHub::hasRelativeAxis(int32_t deviceId, int axis) const {
     return false;
 }
 
-bool FakeEventHub::hasInputProperty(int32_t, int) const {
+bool FakeEventHub::hasInputProperty(int32_t deviceId, int property) const {
+    Device* device = getDevice(deviceId);
+    if (device) {
+        return device->inputProperties.count(property) != 0;
+    }
     return false;
 }
 
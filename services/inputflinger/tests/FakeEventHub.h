@@ -19,6 +19,7 @@
 #include <condition_variable>
 #include <mutex>
 #include <optional>
+#include <set>
 #include <unordered_map>
 #include <vector>
 
@@ -66,6 +67,7 @@ class FakeEventHub : public EventHubInterface {
         std::optional<RawLayoutInfo> layoutInfo;
         std::string sysfsRootPath;
         std::unordered_map<int32_t, std::vector<int32_t>> mtSlotValues;
+        std::set<int> inputProperties;
 
         status_t enable() {
             enabled = true;
@@ -137,6 +139,8 @@ public:
 
     void setMscEvent(int32_t deviceId, int32_t mscEvent);
 
+    void addInputProperty(int32_t deviceId, int property);
+
     void addLed(int32_t deviceId, int32_t led, bool initialState);
     void addRawLightInfo(int32_t rawId, RawLightInfo&& info);
     void fakeLightBrightness(int32_t rawId, int32_t brightness);
@@ -169,7 +173,7 @@ private:
     std::optional<RawAbsoluteAxisInfo> getAbsoluteAxisInfo(int32_t deviceId,
                                                            int axis) const override;
     bool hasRelativeAxis(int32_t deviceId, int axis) const override;
-    bool hasInputProperty(int32_t, int) const override;
+    bool hasInputProperty(int32_t deviceId, int property) const override;
     bool hasMscEvent(int32_t deviceId, int mscEvent) const override final;
     status_t mapKey(int32_t deviceId, int32_t scanCode, int32_t usageCode, int32_t metaState,
                     int32_t* outKeycode, int32_t* outMetaState, uint32_t* outFlags) const override;
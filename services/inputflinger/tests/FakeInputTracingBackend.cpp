@@ -120,7 +120,7 @@ base::Result<void> VerifyingTrace::verifyEventTraced(const Event& expectedEvent,
             std::find_if(mTracedWindowDispatches.begin(), mTracedWindowDispatches.end(),
                          [&](const trace::WindowDispatchArgs& args) {
                              return args.windowId == expectedWindowId &&
-                                     getId(args.eventEntry) == expectedEvent.getId();
+                                     getId(*args.eventEntry) == expectedEvent.getId();
                          });
     if (tracedDispatchesIt == mTracedWindowDispatches.end()) {
         msg << "Expected dispatch of event with ID 0x" << std::hex << expectedEvent.getId()
@@ -41,6 +41,7 @@ void FakePointerController::setPosition(float x, float y) {
 
     mX = x;
     mY = y;
+    mPositionUpdateCount++;
 }
 
 FloatPoint FakePointerController::getPosition() const {
@@ -101,6 +102,10 @@ void FakePointerController::assertPosition(float x, float y) {
     ASSERT_NEAR(y, actualY, 1);
 }
 
+void FakePointerController::assertPositionUpdateCount(int32_t count) {
+    ASSERT_EQ(count, mPositionUpdateCount);
+}
+
 void FakePointerController::assertSpotCount(ui::LogicalDisplayId displayId, int32_t count) {
     auto it = mSpotsByDisplay.find(displayId);
     ASSERT_TRUE(it != mSpotsByDisplay.end()) << "Spots not found for display " << displayId;
@@ -151,6 +156,7 @@ bool FakePointerController::isPointerShown() {
 void FakePointerController::move(float deltaX, float deltaY) {
     if (!mEnabled) return;
 
+    mPositionUpdateCount++;
     mX += deltaX;
     if (mX < mMinX) mX = mMinX;
     if (mX > mMaxX) mX = mMaxX;
@@ -81,8 +81,7 @@ protected:
         event.type = type;
         event.code = code;
         event.value = value;
-        std::optional<SelfContainedHardwareState> schs = mConverter->processRawEvent(event);
-        EXPECT_FALSE(schs.has_value());
+        EXPECT_EQ(nullptr, mConverter->processRawEvent(event));
     }
 
     std::optional<SelfContainedHardwareState> processSync(nsecs_t when) {
@@ -93,7 +92,14 @@ protected:
         event.type = EV_SYN;
         event.code = SYN_REPORT;
         event.value = 0;
-        return mConverter->processRawEvent(event);
+        SelfContainedHardwareState* schs = mConverter->processRawEvent(event);
+        if (schs == nullptr) {
+            return std::nullopt;
+        }
+        // The converter reuses its state, so take a copy that owns its FingerStates.
+        std::optional<SelfContainedHardwareState> copy = *schs;
+        copy->state.fingers = copy->fingers.data();
+        return copy;
     }
 
     std::shared_ptr<FakeEventHub> mFakeEventHub;
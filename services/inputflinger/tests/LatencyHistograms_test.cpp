@@ -0,0 +1,139 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../dispatcher/LatencyHistograms.h"
+
+#include <binder/Binder.h>
+#include <gtest/gtest.h>
+
+#include <map>
+
+namespace android::inputdispatcher {
+
+namespace {
+
+/**
+ * Create a timeline of an event that takes 'stageMillis' at every stage, delivered to 'token'.
+ */
+InputEventTimeline createTimeline(const sp<IBinder>& token, nsecs_t stageMillis) {
+    const nsecs_t stage = ms2ns(stageMillis);
+    const nsecs_t eventTime = 100;
+    InputEventTimeline timeline(eventTime, /*readTime=*/eventTime + stage, /*vendorId=*/0,
+                                /*productId=*/0, {InputDeviceUsageSource::TOUCHSCREEN},
+                                InputEventActionType::MOTION_ACTION_MOVE);
+    ConnectionTimeline connectionTimeline(/*deliveryTime=*/eventTime + 2 * stage,
+                                          /*consumeTime=*/eventTime + 3 * stage,
+                                          /*finishTime=*/eventTime + 4 * stage);
+    std::array<nsecs_t, GraphicsTimeline::SIZE> graphicsTimeline;
+    graphicsTimeline[GraphicsTimeline::GPU_COMPLETED_TIME] = eventTime + 4 * stage;
+    graphicsTimeline[GraphicsTimeline::PRESENT_TIME] = eventTime + 5 * stage;
+    connectionTimeline.setGraphicsTimeline(std::move(graphicsTimeline));
+    timeline.connectionTimelines.emplace(token, std::move(connectionTimeline));
+    return timeline;
+}
+
+} // namespace
+
+class LatencyHistogramsTest : public testing::Test {
+protected:
+    std::map<sp<IBinder>, std::string> mNames;
+
+    LatencyHistograms::NameResolver getNameResolver() {
+        return [this](const sp<IBinder>& token) { return mNames[token]; };
+    }
+
+    sp<IBinder> createConnection(const std::string& name) {
+        sp<IBinder> token = sp<BBinder>::make();
+        mNames[token] = name;
+        return token;
+    }
+};
+
+TEST_F(LatencyHistogramsTest, RecordsEachStageByReceiver) {
+    LatencyHistograms histograms(/*samplingInterval=*/1, getNameResolver());
+    const sp<IBinder> app = createConnection("app");
+    const sp<IBinder> otherApp = createConnection("otherApp");
+
+    histograms.processTimeline(createTimeline(app, /*stageMillis=*/3));
+    histograms.processTimeline(createTimeline(otherApp, /*stageMillis=*/200));
+
+    const LatencyHistograms::Histograms* appHistograms = histograms.getHistograms("app");
+    ASSERT_NE(nullptr, appHistograms);
+    // 3ms falls in the [2, 4) bucket.
+    EXPECT_EQ(1u, (*appHistograms)[SketchIndex::EVENT_TO_READ][2]);
+    EXPECT_EQ(1u, (*appHistograms)[SketchIndex::CONSUME_TO_FINISH][2]);
+    // The GPU completes at the same time as the finish.
+    EXPECT_EQ(1u, (*appHistograms)[SketchIndex::CONSUME_TO_GPU_COMPLETE][2]);
+    // 15ms falls in the [8, 16) bucket.
+    EXPECT_EQ(1u, (*appHistograms)[SketchIndex::END_TO_END][4]);
+
+    const LatencyHistograms::Histograms* otherHistograms = histograms.getHistograms("otherApp");
+    ASSERT_NE(nullptr, otherHistograms);
+    EXPECT_EQ(1u, (*otherHistograms)[SketchIndex::READ_TO_DELIVER].back());
+    EXPECT_EQ(0u, (*otherHistograms)[SketchIndex::READ_TO_DELIVER][0]);
+}
+
+TEST_F(LatencyHistogramsTest, IncompleteTimelinesAreIgnored) {
+    LatencyHistograms histograms(/*samplingInterval=*/1, getNameResolver());
+    const sp<IBinder> app = createConnection("app");
+    InputEventTimeline timeline(/*eventTime=*/1, /*readTime=*/2, /*vendorId=*/0, /*productId=*/0,
+                                {InputDeviceUsageSource::TOUCHSCREEN},
+                                InputEventActionType::MOTION_ACTION_DOWN);
+    timeline.connectionTimelines.emplace(app, ConnectionTimeline(/*deliveryTime=*/3,
+                                                                 /*consumeTime=*/4,
+                                                                 /*finishTime=*/5));
+
+    histograms.processTimeline(timeline);
+
+    EXPECT_EQ(nullptr, histograms.getHistograms("app"));
+}
+
+TEST_F(LatencyHistogramsTest, OnlySampledTimelinesAreRecorded) {
+    LatencyHistograms histograms(/*samplingInterval=*/3, getNameResolver());
+    const sp<IBinder> app = createConnection("app");
+
+    for (int i = 0; i < 7; i++) {
+        histograms.processTimeline(createTimeline(app, /*stageMillis=*/0));
+    }
+
+    const LatencyHistograms::Histograms* appHistograms = histograms.getHistograms("app");
+    ASSERT_NE(nullptr, appHistograms);
+    // The 1st, 4th and 7th timelines are recorded.
+    EXPECT_EQ(3u, (*appHistograms)[SketchIndex::END_TO_END][0]);
+}
+
+TEST_F(LatencyHistogramsTest, ZeroSamplingIntervalDisablesHistograms) {
+    LatencyHistograms histograms(/*samplingInterval=*/0, getNameResolver());
+    const sp<IBinder> app = createConnection("app");
+
+    histograms.processTimeline(createTimeline(app, /*stageMillis=*/1));
+
+    EXPECT_EQ(nullptr, histograms.getHistograms("app"));
+}
+
+TEST_F(LatencyHistogramsTest, ReceiversOverTheLimitAreGrouped) {
+    LatencyHistograms histograms(/*samplingInterval=*/1, getNameResolver());
+    for (size_t i = 0; i < LatencyHistograms::MAX_RECEIVERS; i++) {
+        const sp<IBinder> app = createConnection(std::to_string(i));
+        histograms.processTimeline(createTimeline(app, /*stageMillis=*/1));
+    }
+    histograms.processTimeline(createTimeline(createConnection("late"), /*stageMillis=*/1));
+
+    EXPECT_EQ(nullptr, histograms.getHistograms("late"));
+    EXPECT_NE(nullptr, histograms.getHistograms(LatencyHistograms::OTHER_RECEIVERS));
+}
+
+} // namespace android::inputdispatcher
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../dispatcher/MotionEntryPool.h"
+
+#include <gtest/gtest.h>
+
+namespace android::inputdispatcher {
+
+namespace {
+
+std::shared_ptr<MotionEntry> obtain(MotionEntryPool& pool, int32_t id, size_t pointerCount) {
+    std::vector<PointerProperties> properties(pointerCount);
+    std::vector<PointerCoords> coords(pointerCount);
+    for (size_t i = 0; i < pointerCount; i++) {
+        properties[i].clear();
+        properties[i].id = i;
+        properties[i].toolType = ToolType::FINGER;
+        coords[i].clear();
+        coords[i].setAxisValue(AMOTION_EVENT_AXIS_X, 10 * i);
+        coords[i].setAxisValue(AMOTION_EVENT_AXIS_Y, 20 * i);
+    }
+    return pool.obtain(id, /*injectionState=*/nullptr, /*eventTime=*/id, /*deviceId=*/1,
+                       AINPUT_SOURCE_TOUCHSCREEN, ui::LogicalDisplayId::DEFAULT,
+                       /*policyFlags=*/0, AMOTION_EVENT_ACTION_MOVE, /*actionButton=*/0,
+                       /*flags=*/0, AMETA_NONE, /*buttonState=*/0, MotionClassification::NONE,
+                       AMOTION_EVENT_EDGE_FLAG_NONE, /*xPrecision=*/0, /*yPrecision=*/0,
+                       AMOTION_EVENT_INVALID_CURSOR_POSITION,
+                       AMOTION_EVENT_INVALID_CURSOR_POSITION, /*downTime=*/0, properties, coords);
+}
+
+} // namespace
+
+TEST(MotionEntryPoolTest, ReleasedEntryIsReused) {
+    MotionEntryPool pool(/*capacity=*/2);
+    std::shared_ptr<MotionEntry> entry = obtain(pool, /*id=*/1, /*pointerCount=*/3);
+    const MotionEntry* address = entry.get();
+    ASSERT_EQ(0u, pool.getFreeCount());
+
+    entry = nullptr;
+    ASSERT_EQ(1u, pool.getFreeCount());
+
+    entry = obtain(pool, /*id=*/2, /*pointerCount=*/2);
+    EXPECT_EQ(address, entry.get());
+    EXPECT_EQ(0u, pool.getFreeCount());
+    EXPECT_EQ(2, entry->id);
+    EXPECT_FALSE(entry->dispatchInProgress);
+    ASSERT_EQ(2u, entry->getPointerCount());
+    EXPECT_EQ(1, entry->pointerProperties[1].id);
+    EXPECT_EQ(10, entry->pointerCoords[1].getX());
+    EXPECT_EQ(20, entry->pointerCoords[1].getY());
+}
+
+TEST(MotionEntryPoolTest, KeepsUpToCapacity) {
+    MotionEntryPool pool(/*capacity=*/2);
+    std::vector<std::shared_ptr<MotionEntry>> entries;
+    for (int32_t id = 0; id < 3; id++) {
+        entries.push_back(obtain(pool, id, /*pointerCount=*/1));
+    }
+    entries.clear();
+    EXPECT_EQ(2u, pool.getFreeCount());
+}
+
+TEST(MotionEntryPoolTest, EntryCanOutlivePool) {
+    std::shared_ptr<MotionEntry> entry;
+    {
+        MotionEntryPool pool(/*capacity=*/2);
+        entry = obtain(pool, /*id=*/1, /*pointerCount=*/1);
+    }
+    EXPECT_EQ(1, entry->id);
+    entry = nullptr;
+}
+
+} // namespace android::inputdispatcher
@@ -774,6 +774,10 @@ TEST_F(PalmRejectorTest, TwoPointersAreCanceled) {
                                {{1433.0, 751.0, 45.0}, {1072.0, 767.0, 13.0}}));
     ASSERT_EQ(1u, argsList.size());
     ASSERT_EQ(AMOTION_EVENT_ACTION_CANCEL, argsList[0].action);
+    const PalmRejector::Metrics& metrics = mPalmRejector->getMetrics();
+    ASSERT_EQ(16u, metrics.filteredEventCount);
+    ASSERT_EQ(2u, metrics.rejectedPointerCount);
+    ASSERT_EQ(toNs(120ms), metrics.maxRejectionDelay);
     mPalmRejector->processMotion(
             generateMotionArgs(downTime, toNs(128ms), MOVE,
                                {{1433.0, 751.0, 43.0}, {1072.0, 766.0, 13.0}}));
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../dispatcher/WindowHitIndex.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace android::inputdispatcher {
+
+using gui::WindowInfo;
+using gui::WindowInfoHandle;
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+namespace {
+
+sp<WindowInfoHandle> createWindow(const Rect& touchableRect, bool preventSplitting = false) {
+    WindowInfo info;
+    info.frame = touchableRect;
+    info.touchableRegion = Region(touchableRect);
+    info.setInputConfig(WindowInfo::InputConfig::PREVENT_SPLITTING, preventSplitting);
+    return sp<WindowInfoHandle>::make(info);
+}
+
+} // namespace
+
+TEST(WindowHitIndexTest, CandidatesAreInZOrder) {
+    const WindowHitIndex index({createWindow(Rect(0, 0, 100, 100)),
+                                createWindow(Rect(500, 500, 600, 600)),
+                                createWindow(Rect(0, 0, 1000, 1000))},
+                               ui::Transform());
+
+    EXPECT_THAT(index.findCandidates(50, 50), ElementsAre(0, 2));
+    EXPECT_THAT(index.findCandidates(550, 550), ElementsAre(1, 2));
+    EXPECT_THAT(index.findCandidates(900, 100), ElementsAre(2));
+}
+
+TEST(WindowHitIndexTest, NoCandidatesOutsideOfAllWindows) {
+    const WindowHitIndex index({createWindow(Rect(100, 100, 200, 200)),
+                                createWindow(Rect(300, 300, 400, 400))},
+                               ui::Transform());
+
+    EXPECT_THAT(index.findCandidates(50, 50), IsEmpty());
+    EXPECT_THAT(index.findCandidates(200, 150), IsEmpty());
+    EXPECT_THAT(index.findCandidates(-1, -1), IsEmpty());
+    EXPECT_THAT(index.findCandidates(NAN, 150), IsEmpty());
+    EXPECT_THAT(WindowHitIndex().findCandidates(150, 150), IsEmpty());
+}
+
+TEST(WindowHitIndexTest, UsesDisplayTransform) {
+    // A display of 1000x2000 rotated by 90 degrees.
+    ui::Transform displayTransform(ui::Transform::ROT_90, 1000, 2000);
+    const WindowHitIndex index({createWindow(Rect(0, 0, 100, 100))}, displayTransform);
+
+    EXPECT_THAT(index.findCandidates(50, 50), ElementsAre(0));
+    EXPECT_THAT(index.findCandidates(150, 50), IsEmpty());
+}
+
+TEST(WindowHitIndexTest, TracksUnsplittableWindows) {
+    const WindowHitIndex index({createWindow(Rect(0, 0, 100, 100)),
+                                createWindow(Rect(0, 0, 100, 100), /*preventSplitting=*/true),
+                                createWindow(Rect(0, 0, 100, 100))},
+                               ui::Transform());
+
+    EXPECT_THAT(index.getUnsplittable(), ElementsAre(1));
+}
+
+TEST(WindowHitIndexTest, OccludersAreFoundByFrame) {
+    sp<WindowInfoHandle> occluder = createWindow(Rect(0, 0, 100, 100));
+    // A window can occlude touches outside of its touchable region.
+    occluder->editInfo()->touchableRegion.clear();
+    const WindowHitIndex index({occluder, createWindow(Rect(0, 0, 1000, 1000))}, ui::Transform());
+
+    EXPECT_THAT(index.findCandidates(50, 50), ElementsAre(1));
+    EXPECT_THAT(index.findOccluders(50, 50), ElementsAre(0, 1));
+    EXPECT_THAT(index.findOccluders(500, 500), ElementsAre(1));
+}
+
+TEST(WindowHitIndexTest, GetPosition) {
+    sp<WindowInfoHandle> top = createWindow(Rect(0, 0, 100, 100));
+    sp<WindowInfoHandle> bottom = createWindow(Rect(0, 0, 100, 100));
+    const WindowHitIndex index({top, bottom}, ui::Transform());
+
+    EXPECT_EQ(0u, index.getPosition(top));
+    EXPECT_EQ(1u, index.getPosition(bottom));
+    // Windows that are not indexed are below all the others.
+    EXPECT_EQ(2u, index.getPosition(createWindow(Rect(0, 0, 100, 100))));
+}
+
+} // namespace android::inputdispatcher
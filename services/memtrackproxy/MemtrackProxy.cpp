@@ -125,6 +125,33 @@ ndk::ScopedAStatus MemtrackProxy::getMemory(int pid, MemtrackType type,
         return ndk::ScopedAStatus::fromExceptionCode(EX_UNSUPPORTED_OPERATION);
     }
 
+    const auto key = std::make_pair(pid, type);
+    const auto now = std::chrono::steady_clock::now();
+    {
+        std::scoped_lock lock(cache_mutex_);
+        if (const auto it = cache_.find(key);
+            it != cache_.end() && now - it->second.time < kCacheTtl) {
+            *_aidl_return = it->second.records;
+            return ndk::ScopedAStatus::ok();
+        }
+    }
+
+    ndk::ScopedAStatus status = QueryMemory(pid, type, _aidl_return);
+    if (status.isOk()) {
+        std::scoped_lock lock(cache_mutex_);
+        if (now - last_cache_prune_ >= kCacheTtl) {
+            std::erase_if(cache_, [now](const auto& entry) {
+                return now - entry.second.time >= kCacheTtl;
+            });
+            last_cache_prune_ = now;
+        }
+        cache_[key] = CacheEntry{now, *_aidl_return};
+    }
+    return status;
+}
+
+ndk::ScopedAStatus MemtrackProxy::QueryMemory(int pid, MemtrackType type,
+                                              std::vector<MemtrackRecord>* _aidl_return) {
     _aidl_return->clear();
 
     if (memtrack_aidl_instance_) {
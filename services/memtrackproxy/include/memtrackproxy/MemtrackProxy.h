@@ -23,6 +23,12 @@
 #include <aidl/android/hardware/memtrack/MemtrackType.h>
 #include <android/hardware/memtrack/1.0/IMemtrack.h>
 
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
 using ::android::sp;
 
 namespace V1_0_hidl = ::android::hardware::memtrack::V1_0;
@@ -49,8 +55,22 @@ private:
     static bool CheckUid(uid_t calling_uid);
     static bool CheckPid(pid_t calling_pid, pid_t request_pid);
 
+    ndk::ScopedAStatus QueryMemory(int pid, MemtrackType type,
+                                   std::vector<MemtrackRecord>* _aidl_return);
+
     sp<V1_0_hidl::IMemtrack> memtrack_hidl_instance_;
     std::shared_ptr<V1_aidl::IMemtrack> memtrack_aidl_instance_;
+
+    // Successful HAL results are reused for a short while. Callers such as dumpsys meminfo query
+    // every type of every process in bursts, and each query is a HAL transaction.
+    static constexpr std::chrono::milliseconds kCacheTtl{500};
+    struct CacheEntry {
+        std::chrono::steady_clock::time_point time;
+        std::vector<MemtrackRecord> records;
+    };
+    std::mutex cache_mutex_;
+    std::map<std::pair<int, MemtrackType>, CacheEntry> cache_;
+    std::chrono::steady_clock::time_point last_cache_prune_;
 };
 
 } // namespace memtrack
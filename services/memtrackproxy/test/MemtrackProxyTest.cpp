@@ -78,6 +78,21 @@ TEST_F(MemtrackProxyTest, GetMemoryForOtherPid) {
     }
 }
 
+TEST_F(MemtrackProxyTest, RepeatedGetMemoryReturnsSameRecords) {
+    int pid = getpid();
+
+    for (MemtrackType type : ndk::enum_range<MemtrackType>()) {
+        std::vector<MemtrackRecord> first;
+        std::vector<MemtrackRecord> second;
+
+        ASSERT_TRUE(memtrack_proxy_->getMemory(pid, type, &first).isOk());
+        ASSERT_TRUE(memtrack_proxy_->getMemory(pid, type, &second).isOk());
+
+        // The second call is served from the proxy's short-lived cache.
+        EXPECT_EQ(first, second);
+    }
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
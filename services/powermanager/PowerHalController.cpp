@@ -22,6 +22,7 @@
 #include <android/hardware/power/1.1/IPower.h>
 #include <powermanager/PowerHalController.h>
 #include <powermanager/PowerHalLoader.h>
+#include <pthread.h>
 #include <utils/Log.h>
 
 using namespace android::hardware::power;
@@ -63,6 +64,19 @@ int32_t HalConnector::getAidlVersion() {
 
 // -------------------------------------------------------------------------------------------------
 
+PowerHalController::~PowerHalController() {
+    std::thread asyncThread;
+    {
+        std::lock_guard<std::mutex> lock(mAsyncMutex);
+        mAsyncThreadExit = true;
+        asyncThread = std::move(mAsyncThread);
+    }
+    mAsyncCondition.notify_all();
+    if (asyncThread.joinable()) {
+        asyncThread.join();
+    }
+}
+
 void PowerHalController::init() {
     initHal();
 }
@@ -103,10 +117,15 @@ template <typename T>
 HalResult<T> PowerHalController::processHalResult(HalResult<T>&& result, const char* fnName) {
     if (result.isFailed()) {
         ALOGE("%s failed: %s", fnName, result.errorMessage());
-        std::lock_guard<std::mutex> lock(mConnectedHalMutex);
-        // Drop Power HAL handle. This will force future api calls to reconnect.
-        mConnectedHal = nullptr;
-        mHalConnector->reset();
+        {
+            std::lock_guard<std::mutex> lock(mConnectedHalMutex);
+            // Drop Power HAL handle. This will force future api calls to reconnect.
+            mConnectedHal = nullptr;
+            mHintSessionPreferredRate.reset();
+            mHalConnector->reset();
+        }
+        // A restarted Power HAL doesn't keep the modes that were set.
+        clearAsyncModeState(std::nullopt);
     }
     return std::move(result);
 }
@@ -119,10 +138,93 @@ HalResult<void> PowerHalController::setBoost(aidl::android::hardware::power::Boo
 
 HalResult<void> PowerHalController::setMode(aidl::android::hardware::power::Mode mode,
                                             bool enabled) {
+    clearAsyncModeState(mode);
     std::shared_ptr<HalWrapper> handle = initHal();
     return processHalResult(handle->setMode(mode, enabled), "setMode");
 }
 
+void PowerHalController::setBoostAsync(aidl::android::hardware::power::Boost boost,
+                                       int32_t durationMs) {
+    std::lock_guard<std::mutex> lock(mAsyncMutex);
+    for (const AsyncCall& call : mAsyncCalls) {
+        if (call.boost == boost && call.value == durationMs) {
+            return;
+        }
+    }
+    queueAsyncCall({.boost = boost, .value = durationMs});
+}
+
+void PowerHalController::setModeAsync(aidl::android::hardware::power::Mode mode, bool enabled) {
+    std::lock_guard<std::mutex> lock(mAsyncMutex);
+    std::optional<bool>& state = mAsyncModeStates[static_cast<size_t>(mode)];
+    if (state == enabled) {
+        return;
+    }
+    state = enabled;
+    queueAsyncCall({.mode = mode, .value = enabled});
+}
+
+void PowerHalController::flushAsyncCalls() {
+    std::unique_lock<std::mutex> lock(mAsyncMutex);
+    mAsyncCondition.wait(lock, [this]() REQUIRES(mAsyncMutex) {
+        return (mAsyncCalls.empty() && !mAsyncCallRunning) || mAsyncThreadExit;
+    });
+}
+
+void PowerHalController::queueAsyncCall(AsyncCall call) {
+    if (mAsyncThreadExit) {
+        return;
+    }
+    mAsyncCalls.push_back(call);
+    if (!mAsyncThread.joinable()) {
+        mAsyncThread = std::thread(&PowerHalController::runAsyncCalls, this);
+        pthread_setname_np(mAsyncThread.native_handle(), "PowerHalAsync");
+    }
+    mAsyncCondition.notify_all();
+}
+
+void PowerHalController::runAsyncCalls() {
+    std::unique_lock<std::mutex> lock(mAsyncMutex);
+    while (true) {
+        mAsyncCondition.wait(lock, [this]() REQUIRES(mAsyncMutex) {
+            return !mAsyncCalls.empty() || mAsyncThreadExit;
+        });
+        if (mAsyncThreadExit) {
+            return;
+        }
+        AsyncCall call = mAsyncCalls.front();
+        mAsyncCalls.pop_front();
+        mAsyncCallRunning = true;
+        lock.unlock();
+
+        std::shared_ptr<HalWrapper> handle = initHal();
+        if (call.boost) {
+            processHalResult(handle->setBoost(*call.boost, call.value), "setBoost");
+        } else {
+            auto result = processHalResult(handle->setMode(*call.mode, call.value), "setMode");
+            if (!result.isOk()) {
+                clearAsyncModeState(call.mode);
+            }
+        }
+
+        lock.lock();
+        mAsyncCallRunning = false;
+        if (mAsyncCalls.empty()) {
+            mAsyncCondition.notify_all();
+        }
+    }
+}
+
+void PowerHalController::clearAsyncModeState(
+        std::optional<aidl::android::hardware::power::Mode> mode) {
+    std::lock_guard<std::mutex> lock(mAsyncMutex);
+    if (mode) {
+        mAsyncModeStates[static_cast<size_t>(*mode)].reset();
+    } else {
+        mAsyncModeStates.fill(std::nullopt);
+    }
+}
+
 // Aidl-only methods
 
 HalResult<std::shared_ptr<PowerHintSessionWrapper>> PowerHalController::createHintSession(
@@ -147,10 +249,24 @@ HalResult<std::shared_ptr<PowerHintSessionWrapper>> PowerHalController::createHi
 }
 
 HalResult<int64_t> PowerHalController::getHintSessionPreferredRate() {
+    {
+        std::lock_guard<std::mutex> lock(mConnectedHalMutex);
+        if (mHintSessionPreferredRate) {
+            return HalResult<int64_t>::ok(*mHintSessionPreferredRate);
+        }
+    }
     std::shared_ptr<HalWrapper> handle = initHal();
-    return CACHE_SUPPORT(2,
-                         processHalResult(handle->getHintSessionPreferredRate(),
-                                          "getHintSessionPreferredRate"));
+    auto result = CACHE_SUPPORT(2,
+                                processHalResult(handle->getHintSessionPreferredRate(),
+                                                 "getHintSessionPreferredRate"));
+    if (result.isOk()) {
+        std::lock_guard<std::mutex> lock(mConnectedHalMutex);
+        // Don't cache the rate of the default HAL, in case the Power HAL connects later.
+        if (mConnectedHal == handle) {
+            mHintSessionPreferredRate = result.value();
+        }
+    }
+    return result;
 }
 
 HalResult<aidl::android::hardware::power::ChannelConfig> PowerHalController::getSessionChannel(
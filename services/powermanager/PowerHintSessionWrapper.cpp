@@ -39,12 +39,13 @@ namespace android::power {
         return HalResult<resultType>::failed("Session not running"); \
     }
 
-// FWD_CALL just forwards calls from the wrapper to the session object.
-// It only works if the call has no return object, as is the case with all calls
-// except getSessionConfig.
+// FWD_CALL just forwards calls from the wrapper to the session object, after any
+// durations held for batching. It only works if the call has no return object, as
+// is the case with all calls except getSessionConfig.
 #define FWD_CALL(version, name, args, untypedArgs)                                              \
     HalResult<void> PowerHintSessionWrapper::name args {                                        \
         CHECK_SESSION(void)                                                                     \
+        flushActualWorkDurations();                                                             \
         return CACHE_SUPPORT(version, HalResult<void>::fromStatus(mSession->name untypedArgs)); \
     }
 
@@ -55,13 +56,37 @@ PowerHintSessionWrapper::PowerHintSessionWrapper(std::shared_ptr<IPowerHintSessi
     }
 }
 
+PowerHintSessionWrapper::~PowerHintSessionWrapper() {
+    if (mSession != nullptr) {
+        flushActualWorkDurations();
+    }
+}
+
 // Support for individual hints/modes is not really handled here since there
 // is no way to check for it, so in the future if a way to check that is added,
 // this will need to be updated.
 
 FWD_CALL(2, updateTargetWorkDuration, (int64_t in_targetDurationNanos), (in_targetDurationNanos));
-FWD_CALL(2, reportActualWorkDuration, (const std::vector<WorkDuration>& in_durations),
-         (in_durations));
+
+HalResult<void> PowerHintSessionWrapper::reportActualWorkDuration(
+        const std::vector<WorkDuration>& in_durations) {
+    CHECK_SESSION(void)
+    std::lock_guard<std::mutex> lock(mHeldDurationsMutex);
+    if (mMaxBatchedDurations <= 1 && mHeldDurations.empty()) {
+        return CACHE_SUPPORT(2,
+                             HalResult<void>::fromStatus(
+                                     mSession->reportActualWorkDuration(in_durations)));
+    }
+    mHeldDurations.insert(mHeldDurations.end(), in_durations.begin(), in_durations.end());
+    if (mHeldDurations.empty() ||
+        (mHeldDurations.size() < mMaxBatchedDurations &&
+         mHeldDurations.back().timeStampNanos - mHeldDurations.front().timeStampNanos <
+                 mMaxBatchDelayNanos)) {
+        return HalResult<void>::ok();
+    }
+    return flushActualWorkDurationsLocked();
+}
+
 FWD_CALL(2, pause, (), ());
 FWD_CALL(2, resume, (), ());
 FWD_CALL(2, close, (), ());
@@ -69,6 +94,30 @@ FWD_CALL(4, sendHint, (SessionHint in_hint), (in_hint));
 FWD_CALL(4, setThreads, (const std::vector<int32_t>& in_threadIds), (in_threadIds));
 FWD_CALL(5, setMode, (SessionMode in_type, bool in_enabled), (in_type, in_enabled));
 
+void PowerHintSessionWrapper::setReportBatching(size_t maxDurations, int64_t maxDelayNanos) {
+    std::lock_guard<std::mutex> lock(mHeldDurationsMutex);
+    mMaxBatchedDurations = maxDurations;
+    mMaxBatchDelayNanos = maxDelayNanos;
+}
+
+HalResult<void> PowerHintSessionWrapper::flushActualWorkDurations() {
+    CHECK_SESSION(void)
+    std::lock_guard<std::mutex> lock(mHeldDurationsMutex);
+    return flushActualWorkDurationsLocked();
+}
+
+HalResult<void> PowerHintSessionWrapper::flushActualWorkDurationsLocked() {
+    if (mHeldDurations.empty()) {
+        return HalResult<void>::ok();
+    }
+    auto result = CACHE_SUPPORT(2,
+                                HalResult<void>::fromStatus(
+                                        mSession->reportActualWorkDuration(mHeldDurations)));
+    // The durations are dropped on failure too, as the HAL only uses recent ones.
+    mHeldDurations.clear();
+    return result;
+}
+
 HalResult<SessionConfig> PowerHintSessionWrapper::getSessionConfig() {
     CHECK_SESSION(SessionConfig);
     SessionConfig config;
@@ -71,6 +71,25 @@ static void runCachedBenchmark(benchmark::State& state,
     }
 }
 
+// Measures the time the caller of an async method waits, not the Power HAL call itself.
+template <class... Args0, class... Args1>
+static void runAsyncBenchmark(benchmark::State& state, void (PowerHalController::*fn)(Args0...),
+                              Args1&&... args1) {
+    PowerHalController controller;
+    // First call out of test, to cache HAL service and start the worker thread.
+    (controller.*fn)(std::forward<Args1>(args1)...);
+    controller.flushAsyncCalls();
+
+    while (state.KeepRunning()) {
+        (controller.*fn)(std::forward<Args1>(args1)...);
+        state.PauseTiming();
+        controller.flushAsyncCalls();
+        testDelaySpin(
+                std::chrono::duration_cast<std::chrono::duration<float>>(ONEWAY_API_DELAY).count());
+        state.ResumeTiming();
+    }
+}
+
 static void BM_PowerHalControllerBenchmarks_init(benchmark::State& state) {
     while (state.KeepRunning()) {
         PowerHalController controller;
@@ -108,9 +127,54 @@ static void BM_PowerHalControllerBenchmarks_setModeCached(benchmark::State& stat
     runCachedBenchmark(state, &PowerHalController::setMode, mode, false);
 }
 
+static void BM_PowerHalControllerBenchmarks_setBoostAsync(benchmark::State& state) {
+    Boost boost = static_cast<Boost>(state.range(0));
+    runAsyncBenchmark(state, &PowerHalController::setBoostAsync, boost, 0);
+}
+
+static void BM_PowerHalControllerBenchmarks_setModeAsync(benchmark::State& state) {
+    Mode mode = static_cast<Mode>(state.range(0));
+    PowerHalController controller;
+    bool enabled = false;
+    controller.setModeAsync(mode, enabled);
+    controller.flushAsyncCalls();
+
+    // Toggle the mode, so that no call is dropped as redundant.
+    while (state.KeepRunning()) {
+        enabled = !enabled;
+        controller.setModeAsync(mode, enabled);
+        state.PauseTiming();
+        controller.flushAsyncCalls();
+        testDelaySpin(
+                std::chrono::duration_cast<std::chrono::duration<float>>(ONEWAY_API_DELAY).count());
+        state.ResumeTiming();
+    }
+}
+
+static void BM_PowerHalControllerBenchmarks_setModeAsyncRedundant(benchmark::State& state) {
+    Mode mode = static_cast<Mode>(state.range(0));
+    PowerHalController controller;
+    controller.setModeAsync(mode, false);
+    controller.flushAsyncCalls();
+
+    while (state.KeepRunning()) {
+        controller.setModeAsync(mode, false);
+    }
+}
+
+static void BM_PowerHalControllerBenchmarks_getHintSessionPreferredRateCached(
+        benchmark::State& state) {
+    runCachedBenchmark(state, &PowerHalController::getHintSessionPreferredRate);
+}
+
 BENCHMARK(BM_PowerHalControllerBenchmarks_init);
 BENCHMARK(BM_PowerHalControllerBenchmarks_initCached);
 BENCHMARK(BM_PowerHalControllerBenchmarks_setBoost)->DenseRange(FIRST_BOOST, LAST_BOOST, 1);
 BENCHMARK(BM_PowerHalControllerBenchmarks_setBoostCached)->DenseRange(FIRST_BOOST, LAST_BOOST, 1);
 BENCHMARK(BM_PowerHalControllerBenchmarks_setMode)->DenseRange(FIRST_MODE, LAST_MODE, 1);
 BENCHMARK(BM_PowerHalControllerBenchmarks_setModeCached)->DenseRange(FIRST_MODE, LAST_MODE, 1);
+BENCHMARK(BM_PowerHalControllerBenchmarks_setBoostAsync)->DenseRange(FIRST_BOOST, LAST_BOOST, 1);
+BENCHMARK(BM_PowerHalControllerBenchmarks_setModeAsync)->DenseRange(FIRST_MODE, LAST_MODE, 1);
+BENCHMARK(BM_PowerHalControllerBenchmarks_setModeAsyncRedundant)
+        ->DenseRange(FIRST_MODE, LAST_MODE, 1);
+BENCHMARK(BM_PowerHalControllerBenchmarks_getHintSessionPreferredRateCached);
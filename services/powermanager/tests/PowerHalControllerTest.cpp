@@ -215,6 +215,45 @@ TEST_F(PowerHalControllerTest, TestPowerHalDoesNotTryToRecoverFromFailureOnUnsup
     EXPECT_EQ(powerHalResetCount, 0);
 }
 
+TEST_F(PowerHalControllerTest, TestAsyncCallsDelegatedToConnectedPowerHal) {
+    {
+        InSequence seg;
+        EXPECT_CALL(*mMockHal.get(), powerHint(Eq(PowerHint::INTERACTION), Eq(100)))
+                .Times(Exactly(1));
+        EXPECT_CALL(*mMockHal.get(), powerHint(Eq(PowerHint::LAUNCH), Eq(1))).Times(Exactly(1));
+        EXPECT_CALL(*mMockHal.get(), powerHint(Eq(PowerHint::LAUNCH), Eq(0))).Times(Exactly(1));
+    }
+
+    mHalController->setBoostAsync(Boost::INTERACTION, 100);
+    mHalController->setModeAsync(Mode::LAUNCH, true);
+    // Already requested, so dropped.
+    mHalController->setModeAsync(Mode::LAUNCH, true);
+    mHalController->flushAsyncCalls();
+    mHalController->setModeAsync(Mode::LAUNCH, true);
+    mHalController->setModeAsync(Mode::LAUNCH, false);
+    mHalController->flushAsyncCalls();
+
+    EXPECT_EQ(mHalConnector->getConnectCount(), 1);
+    EXPECT_EQ(mHalConnector->getResetCount(), 0);
+}
+
+TEST_F(PowerHalControllerTest, TestAsyncModeRetriedAfterFailure) {
+    ON_CALL(*mMockHal.get(), powerHint(Eq(PowerHint::LAUNCH), _))
+            .WillByDefault([](PowerHint, int32_t) {
+                return hardware::Return<void>(hardware::Status::fromExceptionCode(-1));
+            });
+
+    EXPECT_CALL(*mMockHal.get(), powerHint(Eq(PowerHint::LAUNCH), Eq(1))).Times(Exactly(2));
+
+    mHalController->setModeAsync(Mode::LAUNCH, true);
+    mHalController->flushAsyncCalls();
+    // The failed call doesn't count as the mode being set.
+    mHalController->setModeAsync(Mode::LAUNCH, true);
+    mHalController->flushAsyncCalls();
+
+    EXPECT_EQ(mHalConnector->getResetCount(), 2);
+}
+
 TEST_F(PowerHalControllerTest, TestMultiThreadConnectsOnlyOnce) {
     int powerHalConnectCount = mHalConnector->getConnectCount();
     EXPECT_EQ(powerHalConnectCount, 0);
@@ -89,6 +89,37 @@ TEST_F(PowerHintSessionWrapperTest, reportActualWorkDuration) {
     ASSERT_TRUE(status.isOk());
 }
 
+TEST_F(PowerHintSessionWrapperTest, reportActualWorkDurationBatched) {
+    using ::aidl::android::hardware::power::WorkDuration;
+    auto duration = [](int64_t timeStampNanos) {
+        return WorkDuration{.timeStampNanos = timeStampNanos, .durationNanos = 1000};
+    };
+    mSession->setReportBatching(3, 100);
+
+    {
+        InSequence seq;
+        // Sent once the batch is full.
+        EXPECT_CALL(*mMockSession.get(),
+                    reportActualWorkDuration(ElementsAre(duration(1), duration(2), duration(3))))
+                .WillOnce(Return(ndk::ScopedAStatus::ok()));
+        // Sent once the durations span the maximum delay.
+        EXPECT_CALL(*mMockSession.get(),
+                    reportActualWorkDuration(ElementsAre(duration(10), duration(110))))
+                .WillOnce(Return(ndk::ScopedAStatus::ok()));
+        // Sent before other calls to the session.
+        EXPECT_CALL(*mMockSession.get(), reportActualWorkDuration(ElementsAre(duration(200))))
+                .WillOnce(Return(ndk::ScopedAStatus::ok()));
+        EXPECT_CALL(*mMockSession.get(), pause()).WillOnce(Return(ndk::ScopedAStatus::ok()));
+    }
+
+    for (int64_t timeStampNanos : {1, 2, 3, 10, 110, 200}) {
+        auto status = mSession->reportActualWorkDuration({duration(timeStampNanos)});
+        ASSERT_TRUE(status.isOk());
+    }
+    auto status = mSession->pause();
+    ASSERT_TRUE(status.isOk());
+}
+
 TEST_F(PowerHintSessionWrapperTest, pause) {
     EXPECT_CALL(*mMockSession.get(), pause()).WillOnce(Return(ndk::ScopedAStatus::ok()));
     auto status = mSession->pause();
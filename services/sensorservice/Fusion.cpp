@@ -487,7 +487,21 @@ void Fusion::predict(const vec3_t& w, float dT) {
     if (x0.w < 0)
         x0 = -x0;
 
-    P = Phi*P*transpose(Phi) + GQGt;
+    // Phi is | Phi00 Phi10 |, so only the blocks below need to be computed. The generic block
+    //        |   0     I   |
+    // product would spend most of its time multiplying by the zero and identity blocks. Note
+    // that the matrices are indexed by [column][row].
+    const mat33_t& Phi00 = Phi[0][0];
+    const mat33_t& Phi10 = Phi[1][0];
+    const mat33_t Phi00t(transpose(Phi00));
+    const mat33_t Phi10t(transpose(Phi10));
+    const mat33_t top0(Phi00*P[0][0] + Phi10*P[0][1]);
+    const mat33_t top1(Phi00*P[1][0] + Phi10*P[1][1]);
+    const mat33_t bottom0(P[0][1]*Phi00t + P[1][1]*Phi10t);
+    P[0][0] = top0*Phi00t + top1*Phi10t + GQGt[0][0];
+    P[1][0] = top1 + GQGt[1][0];
+    P[0][1] = bottom0 + GQGt[0][1];
+    P[1][1] += GQGt[1][1];
 
     checkState();
 }
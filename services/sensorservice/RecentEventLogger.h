@@ -24,6 +24,7 @@
 #include <utils/String8.h>
 
 #include <mutex>
+#include <vector>
 
 namespace android {
 namespace SensorServiceUtil {
@@ -69,6 +70,10 @@ protected:
 
 private:
     static size_t logSizeBySensorType(int sensorType);
+
+    // Copies the recorded events, oldest first, so that they can be formatted without holding
+    // mLock and blocking the sensor thread.
+    std::vector<SensorEventLog> getRecentEvents() const;
 };
 
 } // namespace SensorServiceUtil
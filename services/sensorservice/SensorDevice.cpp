@@ -32,6 +32,7 @@
 #include <condition_variable>
 #include <cstddef>
 #include <mutex>
+#include <optional>
 #include <thread>
 
 #include "AidlSensorHalWrapper.h"
@@ -381,8 +382,15 @@ ssize_t SensorDevice::poll(sensors_event_t* buffer, size_t count) {
     }
 
     if (eventsRead > 0) {
+        // Looking up the resolution walks the whole sensor list, and a batch is usually made of
+        // runs of events from the same sensor, so only look it up when the sensor changes.
+        std::optional<int32_t> resolutionSensor;
+        float resolution = 0;
         for (ssize_t i = 0; i < eventsRead; i++) {
-            float resolution = getResolutionForSensor(buffer[i].sensor);
+            if (resolutionSensor != buffer[i].sensor) {
+                resolutionSensor = buffer[i].sensor;
+                resolution = getResolutionForSensor(buffer[i].sensor);
+            }
             android::SensorDeviceUtils::quantizeSensorEventValues(&buffer[i], resolution);
 
             if (buffer[i].type == SENSOR_TYPE_DYNAMIC_SENSOR_META) {
@@ -1135,6 +1135,9 @@ bool SensorService::threadLoop() {
     SensorDevice& device(SensorDevice::getInstance());
 
     const int halVersion = device.getHalDeviceVersion();
+    // The interfaces of the active virtual sensors, looked up once per poll. Kept outside of the
+    // loop to reuse its storage.
+    std::vector<std::shared_ptr<SensorInterface>> activeVirtualSensors;
     do {
         ssize_t count = device.poll(mSensorEventBuffer, numEventMax);
         if (count < 0) {
@@ -1184,8 +1187,19 @@ bool SensorService::threadLoop() {
                         fusion.process(event[i]);
                     }
                 }
+                // Each lookup takes the sensor list lock, so resolve the handles once rather than
+                // for every event.
+                activeVirtualSensors.clear();
+                for (int handle : mActiveVirtualSensors) {
+                    std::shared_ptr<SensorInterface> si = getSensorInterfaceFromHandle(handle);
+                    if (si == nullptr) {
+                        ALOGE("handle %d is not an valid virtual sensor", handle);
+                        continue;
+                    }
+                    activeVirtualSensors.push_back(std::move(si));
+                }
                 for (size_t i=0 ; i<size_t(count) && k<minBufferSize ; i++) {
-                    for (int handle : mActiveVirtualSensors) {
+                    for (const std::shared_ptr<SensorInterface>& si : activeVirtualSensors) {
                         if (count + k >= minBufferSize) {
                             ALOGE("buffer too small to hold all events: "
                                     "count=%zd, k=%zu, size=%zu",
@@ -1193,12 +1207,6 @@ bool SensorService::threadLoop() {
                             break;
                         }
                         sensors_event_t out;
-                        std::shared_ptr<SensorInterface> si = getSensorInterfaceFromHandle(handle);
-                        if (si == nullptr) {
-                            ALOGE("handle %d is not an valid virtual sensor", handle);
-                            continue;
-                        }
-
                         if (si->process(&out, event[i])) {
                             mSensorEventBuffer[count + k] = out;
                             k++;
@@ -1226,8 +1234,10 @@ bool SensorService::threadLoop() {
         }
 
         // Cache the list of active connections, since we use it in multiple places below but won't
-        // modify it here
-        const std::vector<sp<SensorEventConnection>> activeConnections = connLock.getActiveConnections();
+        // modify it here. connLock keeps the promoted references alive until it is released, so
+        // there is no need to copy them.
+        const std::vector<sp<SensorEventConnection>>& activeConnections =
+                connLock.getActiveConnections();
 
         for (int i = 0; i < count; ++i) {
             // Map flush_complete_events in the buffer to SensorEventConnections which called flush
@@ -23,7 +23,9 @@
 #include "StatsAidl.h"
 
 #include <Counter.h>
+#include <android/binder_ibinder.h>
 #include <log/log.h>
+#include <pthread.h>
 #include <stats_annotations.h>
 #include <stats_event.h>
 #include <statslog.h>
@@ -47,7 +49,73 @@ constexpr typename std::underlying_type<E>::type to_underlying(E e) noexcept {
     return static_cast<typename std::underlying_type<E>::type>(e);
 }
 
-StatsHal::StatsHal() {
+StatsHal::StatsHal() : mWriterThread(&StatsHal::writerLoop, this) {}
+
+StatsHal::~StatsHal() {
+    {
+        std::scoped_lock lock(mLock);
+        mStopping = true;
+    }
+    mCondition.notify_one();
+    mWriterThread.join();
+}
+
+bool StatsHal::enqueueAtom(pid_t clientPid, int32_t atomId, AStatsEvent* event) {
+    bool flushNow;
+    {
+        std::scoped_lock lock(mLock);
+        size_t& clientCount = mPendingAtomsPerClient[clientPid];
+        if (clientCount >= kMaxPendingAtomsPerClient) {
+            return false;
+        }
+        clientCount++;
+        mPendingAtoms.push_back({clientPid, atomId, event});
+        flushNow = mPendingAtoms.size() == 1 || mPendingAtoms.size() >= kFlushThreshold;
+    }
+    // The writer sleeps indefinitely while the queue is empty, and otherwise only needs to be
+    // woken early once the flush threshold is reached.
+    if (flushNow) {
+        mCondition.notify_one();
+    }
+    return true;
+}
+
+void StatsHal::writerLoop() {
+    pthread_setname_np(pthread_self(), "StatsAidlWriter");
+    std::unique_lock lock(mLock);
+    while (true) {
+        mCondition.wait(lock, [this] { return mStopping || !mPendingAtoms.empty(); });
+        if (!mStopping) {
+            mCondition.wait_for(lock, kFlushInterval, [this] {
+                return mStopping || mPendingAtoms.size() >= kFlushThreshold;
+            });
+        }
+
+        std::deque<PendingAtom> atoms;
+        atoms.swap(mPendingAtoms);
+        mPendingAtomsPerClient.clear();
+        const bool stopping = mStopping;
+
+        lock.unlock();
+        writeAtoms(atoms);
+        if (stopping) {
+            return;
+        }
+        lock.lock();
+    }
+}
+
+void StatsHal::writeAtoms(const std::deque<PendingAtom>& atoms) {
+    VLOG("Writing %zu vendor atoms", atoms.size());
+    for (const PendingAtom& atom : atoms) {
+        const int ret = AStatsEvent_write(atom.event);
+        if (ret <= 0) {
+            ALOGE("Error writing Atom ID %ld from pid %d. Result: %d",
+                  (long)atom.atomId, atom.clientPid, ret);
+            Counter::logIncrement(g_AtomErrorMetricName);
+        }
+        AStatsEvent_release(atom.event);
+    }
 }
 
 bool write_annotation(AStatsEvent* event, const Annotation& annotation) {
@@ -258,15 +326,16 @@ ndk::ScopedAStatus StatsHal::reportVendorAtom(const VendorAtom& vendorAtom) {
         atomValueIdx++;
     }
     AStatsEvent_build(event);
-    const int ret = AStatsEvent_write(event);
-    AStatsEvent_release(event);
-    if (ret <= 0) {
-        ALOGE("Error writing Atom ID %ld. Result: %d", (long)vendorAtom.atomId, ret);
+    const pid_t clientPid = AIBinder_getCallingPid();
+    if (!enqueueAtom(clientPid, vendorAtom.atomId, event)) {
+        AStatsEvent_release(event);
+        ALOGE("Dropping Atom ID %ld: pid %d has too many pending atoms", (long)vendorAtom.atomId,
+              clientPid);
         Counter::logIncrement(g_AtomErrorMetricName);
+        return ndk::ScopedAStatus::fromServiceSpecificErrorWithMessage(
+                -1, "too many pending atoms");
     }
-    return ret <= 0 ? ndk::ScopedAStatus::fromServiceSpecificErrorWithMessage(ret,
-                                                                              "report atom failed")
-                    : ndk::ScopedAStatus::ok();
+    return ndk::ScopedAStatus::ok();
 }
 
 }  // namespace stats
@@ -15,6 +15,15 @@
  */
 
 #include <aidl/android/frameworks/stats/BnStats.h>
+#include <stats_event.h>
+#include <sys/types.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 namespace aidl {
 namespace android {
@@ -24,11 +33,40 @@ namespace stats {
 class StatsHal : public BnStats {
 public:
     StatsHal();
+    ~StatsHal();
 
     /**
      * Binder call to get vendor atom.
+     *
+     * The atom is validated and built on the calling thread, so its timestamp is the time of
+     * the call, but it is written to statsd later in a batch by the writer thread.
      */
     virtual ndk::ScopedAStatus reportVendorAtom(const VendorAtom& in_vendorAtom) override;
+
+    // Longest time a built atom waits in the queue before it is written to statsd.
+    static constexpr std::chrono::milliseconds kFlushInterval{50};
+    // Number of queued atoms that triggers a flush before kFlushInterval has passed.
+    static constexpr size_t kFlushThreshold = 64;
+    // Atoms from a single client that may be queued at once. Further reports are rejected.
+    static constexpr size_t kMaxPendingAtomsPerClient = 512;
+
+private:
+    struct PendingAtom {
+        pid_t clientPid;
+        int32_t atomId;
+        AStatsEvent* event;
+    };
+
+    bool enqueueAtom(pid_t clientPid, int32_t atomId, AStatsEvent* event);
+    void writerLoop();
+    void writeAtoms(const std::deque<PendingAtom>& atoms);
+
+    std::mutex mLock;
+    std::condition_variable mCondition;
+    std::deque<PendingAtom> mPendingAtoms;
+    std::unordered_map<pid_t, size_t> mPendingAtomsPerClient;
+    bool mStopping = false;
+    std::thread mWriterThread;
 };
 
 }  // namespace stats
@@ -38,6 +38,14 @@ void set_thread_priority(bool highPriority) {
     sched_setscheduler(gettid(), highPriority ? SCHED_FIFO : SCHED_NORMAL, &param);
 }
 
+template <typename T>
+void updateMax(std::atomic<T>& max, T value) {
+    T current = max.load(std::memory_order_relaxed);
+    while (value > current &&
+           !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
 } // anonymous namespace
 
 BackgroundExecutor::BackgroundExecutor(bool highPriority) {
@@ -45,17 +53,14 @@ BackgroundExecutor::BackgroundExecutor(bool highPriority) {
     // BackgroundExecutor::sendCallbacks. For this reason, we initialize it
     // within the constructor instead of within mThread.
     LOG_ALWAYS_FATAL_IF(sem_init(&mSemaphore, 0, 0), "sem_init failed");
+    for (size_t i = 0; i < kRingCapacity; i++) {
+        mRing[i].sequence.store(i, std::memory_order_relaxed);
+    }
     mThread = std::thread([&, highPriority]() {
         set_thread_priority(highPriority);
         while (!mDone) {
             LOG_ALWAYS_FATAL_IF(sem_wait(&mSemaphore), "sem_wait failed (%d)", errno);
-            auto callbacks = mCallbacksQueue.pop();
-            if (!callbacks) {
-                continue;
-            }
-            for (auto& callback : *callbacks) {
-                callback();
-            }
+            runReadyCallbacks();
         }
     });
     if (highPriority) {
@@ -75,10 +80,77 @@ BackgroundExecutor::~BackgroundExecutor() {
 }
 
 void BackgroundExecutor::sendCallbacks(Callbacks&& tasks) {
-    mCallbacksQueue.push(std::move(tasks));
+    const nsecs_t now = systemTime();
+    const uint64_t ticket = mTail.fetch_add(1, std::memory_order_relaxed);
+    updateMax(mMaxQueueDepth,
+              static_cast<size_t>(ticket + 1 - mHead.load(std::memory_order_relaxed)));
+
+    Slot& slot = mRing[ticket % kRingCapacity];
+    if (slot.sequence.load(std::memory_order_acquire) == ticket) {
+        slot.callbacks = std::move(tasks);
+        slot.enqueueTime = now;
+        slot.sequence.store(ticket + 1, std::memory_order_release);
+    } else {
+        // The slot still holds the submission from the previous lap around the ring.
+        mOverflowCount.fetch_add(1, std::memory_order_relaxed);
+        mOverflowQueue.push({ticket, std::move(tasks), now});
+    }
     LOG_ALWAYS_FATAL_IF(sem_post(&mSemaphore), "sem_post failed");
 }
 
+void BackgroundExecutor::runReadyCallbacks() {
+    while (true) {
+        const uint64_t ticket = mHead.load(std::memory_order_relaxed);
+        Slot& slot = mRing[ticket % kRingCapacity];
+
+        Callbacks callbacks;
+        nsecs_t enqueueTime;
+        if (slot.sequence.load(std::memory_order_acquire) == ticket + 1) {
+            callbacks = std::move(slot.callbacks);
+            slot.callbacks.clear();
+            enqueueTime = slot.enqueueTime;
+        } else {
+            while (auto overflow = mOverflowQueue.pop()) {
+                const uint64_t overflowTicket = overflow->ticket;
+                mPendingOverflows.emplace(overflowTicket, std::move(*overflow));
+            }
+            const auto it = mPendingOverflows.find(ticket);
+            if (it == mPendingOverflows.end()) {
+                // The submission for this ticket is still being written. Its producer will post
+                // mSemaphore once it is done.
+                return;
+            }
+            callbacks = std::move(it->second.callbacks);
+            enqueueTime = it->second.enqueueTime;
+            mPendingOverflows.erase(it);
+        }
+
+        // Hand the slot over to the ticket of the next lap.
+        slot.sequence.store(ticket + kRingCapacity, std::memory_order_release);
+        mHead.store(ticket + 1, std::memory_order_relaxed);
+
+        const nsecs_t latency = systemTime() - enqueueTime;
+        mTotalLatency.fetch_add(latency, std::memory_order_relaxed);
+        updateMax(mMaxLatency, latency);
+        mExecutionCount.fetch_add(1, std::memory_order_relaxed);
+
+        for (auto& callback : callbacks) {
+            callback();
+        }
+    }
+}
+
+BackgroundExecutor::Stats BackgroundExecutor::getStats() const {
+    Stats stats;
+    stats.submissions = mTail.load(std::memory_order_relaxed);
+    stats.overflows = mOverflowCount.load(std::memory_order_relaxed);
+    stats.executions = mExecutionCount.load(std::memory_order_relaxed);
+    stats.maxQueueDepth = mMaxQueueDepth.load(std::memory_order_relaxed);
+    stats.totalLatency = std::chrono::nanoseconds(mTotalLatency.load(std::memory_order_relaxed));
+    stats.maxLatency = std::chrono::nanoseconds(mMaxLatency.load(std::memory_order_relaxed));
+    return stats;
+}
+
 void BackgroundExecutor::flushQueue() {
     std::mutex mutex;
     std::condition_variable cv;
@@ -18,6 +18,11 @@
 
 #include <ftl/small_vector.h>
 #include <semaphore.h>
+#include <utils/Timers.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <map>
 #include <thread>
 
 #include "LocklessQueue.h"
@@ -45,13 +50,61 @@ public:
     void sendCallbacks(Callbacks&& tasks);
     void flushQueue();
 
+    struct Stats {
+        uint64_t submissions = 0;
+        // Submissions that found their ring slot still occupied and were queued on the heap.
+        uint64_t overflows = 0;
+        uint64_t executions = 0;
+        size_t maxQueueDepth = 0;
+        // Time between a submission and the start of its execution.
+        std::chrono::nanoseconds totalLatency{0};
+        std::chrono::nanoseconds maxLatency{0};
+    };
+
+    Stats getStats() const;
+
+    static constexpr size_t kRingCapacity = 64;
+
 private:
     BackgroundExecutor(bool highPriority);
 
+    // Runs the submissions that are ready, in submission order. Only called on mThread.
+    void runReadyCallbacks();
+
     sem_t mSemaphore;
     std::atomic_bool mDone = false;
 
-    LocklessQueue<Callbacks> mCallbacksQueue;
+    // Every submission takes a ticket from mTail, and mThread executes them in ticket order. A
+    // ticket is stored in its ring slot if the slot is free, so the common case does not allocate.
+    // Otherwise, the submission falls back to mOverflowQueue, and mThread picks it up from there
+    // when the ticket comes up.
+    struct Slot {
+        // Equal to the ticket that may fill the slot, or to that ticket + 1 once it is filled.
+        std::atomic<uint64_t> sequence;
+        Callbacks callbacks;
+        nsecs_t enqueueTime = 0;
+    };
+
+    struct Overflow {
+        uint64_t ticket;
+        Callbacks callbacks;
+        nsecs_t enqueueTime;
+    };
+
+    std::array<Slot, kRingCapacity> mRing;
+    std::atomic<uint64_t> mTail = 0;
+    std::atomic<uint64_t> mHead = 0;
+
+    LocklessQueue<Overflow> mOverflowQueue;
+    // Only accessed on mThread.
+    std::map<uint64_t, Overflow> mPendingOverflows;
+
+    std::atomic<uint64_t> mOverflowCount = 0;
+    std::atomic<uint64_t> mExecutionCount = 0;
+    std::atomic<size_t> mMaxQueueDepth = 0;
+    std::atomic<nsecs_t> mTotalLatency = 0;
+    std::atomic<nsecs_t> mMaxLatency = 0;
+
     std::thread mThread;
 };
 
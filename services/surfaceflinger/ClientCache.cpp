@@ -24,6 +24,7 @@
 #include <android-base/stringprintf.h>
 #include <common/trace.h>
 #include <renderengine/impl/ExternalTexture.h>
+#include <ui/PixelFormat.h>
 
 #include "ClientCache.h"
 
@@ -33,27 +34,35 @@ ANDROID_SINGLETON_STATIC_INSTANCE(ClientCache);
 
 ClientCache::ClientCache() : mDeathRecipient(sp<CacheDeathRecipient>::make()) {}
 
-bool ClientCache::getBuffer(const client_cache_t& cacheId,
+ClientCache::Shard& ClientCache::getShard(const wp<IBinder>& processToken) {
+    // Binders are heap allocated, so the low bits of their address carry little entropy.
+    const auto address = reinterpret_cast<uintptr_t>(processToken.unsafe_get());
+    return mShards[((address >> 4) ^ (address >> 12)) % kShardCount];
+}
+
+bool ClientCache::getBuffer(Shard& shard, const client_cache_t& cacheId,
                             ClientCacheBuffer** outClientCacheBuffer) {
     auto& [processToken, id] = cacheId;
     if (processToken == nullptr) {
         ALOGE_AND_TRACE("ClientCache::getBuffer - invalid (nullptr) process token");
         return false;
     }
-    auto it = mBuffers.find(processToken);
-    if (it == mBuffers.end()) {
+    auto it = shard.processes.find(processToken);
+    if (it == shard.processes.end()) {
         ALOGE_AND_TRACE("ClientCache::getBuffer - invalid process token");
         return false;
     }
 
-    auto& processBuffers = it->second.second;
+    auto& processBuffers = it->second;
 
-    auto bufItr = processBuffers.find(id);
-    if (bufItr == processBuffers.end()) {
+    auto bufItr = processBuffers.buffers.find(id);
+    if (bufItr == processBuffers.buffers.end()) {
+        processBuffers.missCount.fetch_add(1, std::memory_order_relaxed);
         ALOGE_AND_TRACE("ClientCache::getBuffer - invalid buffer id");
         return false;
     }
 
+    processBuffers.hitCount.fetch_add(1, std::memory_order_relaxed);
     ClientCacheBuffer& buf = bufItr->second;
     *outClientCacheBuffer = &buf;
     return true;
@@ -72,14 +81,14 @@ ClientCache::add(const client_cache_t& cacheId, const sp<GraphicBuffer>& buffer)
         return base::unexpected(AddError::Unspecified);
     }
 
-    std::lock_guard lock(mMutex);
-    sp<IBinder> token;
+    Shard& shard = getShard(processToken);
+    std::lock_guard lock(shard.mutex);
 
     // If this is a new process token, set a death recipient. If the client process dies, we will
     // get a callback through binderDied.
-    auto it = mBuffers.find(processToken);
-    if (it == mBuffers.end()) {
-        token = processToken.promote();
+    auto it = shard.processes.find(processToken);
+    if (it == shard.processes.end()) {
+        sp<IBinder> token = processToken.promote();
         if (!token) {
             ALOGE_AND_TRACE("ClientCache::add - invalid token");
             return base::unexpected(AddError::Unspecified);
@@ -93,15 +102,13 @@ ClientCache::add(const client_cache_t& cacheId, const sp<GraphicBuffer>& buffer)
                 return base::unexpected(AddError::Unspecified);
             }
         }
-        auto [itr, success] =
-                mBuffers.emplace(processToken,
-                                 std::make_pair(token,
-                                                std::unordered_map<uint64_t, ClientCacheBuffer>()));
+        auto [itr, success] = shard.processes.try_emplace(processToken);
         LOG_ALWAYS_FATAL_IF(!success, "failed to insert new process into client cache");
+        itr->second.token = std::move(token);
         it = itr;
     }
 
-    auto& processBuffers = it->second.second;
+    auto& processBuffers = it->second.buffers;
 
     if (processBuffers.size() > BUFFER_CACHE_MAX_SIZE) {
         ALOGE_AND_TRACE("ClientCache::add - cache is full");
@@ -123,9 +130,10 @@ sp<GraphicBuffer> ClientCache::erase(const client_cache_t& cacheId) {
     auto& [processToken, id] = cacheId;
     std::vector<sp<ErasedRecipient>> pendingErase;
     {
-        std::lock_guard lock(mMutex);
+        Shard& shard = getShard(processToken);
+        std::lock_guard lock(shard.mutex);
         ClientCacheBuffer* buf = nullptr;
-        if (!getBuffer(cacheId, &buf)) {
+        if (!getBuffer(shard, cacheId, &buf)) {
             ALOGE("failed to erase buffer, could not retrieve buffer");
             return nullptr;
         }
@@ -139,7 +147,7 @@ sp<GraphicBuffer> ClientCache::erase(const client_cache_t& cacheId) {
             }
         }
 
-        mBuffers[processToken].second.erase(id);
+        shard.processes.at(processToken).buffers.erase(id);
     }
 
     for (auto& recipient : pendingErase) {
@@ -149,23 +157,30 @@ sp<GraphicBuffer> ClientCache::erase(const client_cache_t& cacheId) {
 }
 
 std::shared_ptr<renderengine::ExternalTexture> ClientCache::get(const client_cache_t& cacheId) {
-    std::lock_guard lock(mMutex);
+    Shard& shard = getShard(cacheId.token);
 
+    // TODO(b/257958323): Use std::shared_lock once it supports thread safety analysis.
+    shard.mutex.lock_shared();
     ClientCacheBuffer* buf = nullptr;
-    if (!getBuffer(cacheId, &buf)) {
-        ALOGE("failed to get buffer, could not retrieve buffer");
-        return nullptr;
+    std::shared_ptr<renderengine::ExternalTexture> buffer;
+    if (getBuffer(shard, cacheId, &buf)) {
+        buffer = buf->buffer;
     }
+    shard.mutex.unlock_shared();
 
-    return buf->buffer;
+    if (!buffer) {
+        ALOGE("failed to get buffer, could not retrieve buffer");
+    }
+    return buffer;
 }
 
 bool ClientCache::registerErasedRecipient(const client_cache_t& cacheId,
                                           const wp<ErasedRecipient>& recipient) {
-    std::lock_guard lock(mMutex);
+    Shard& shard = getShard(cacheId.token);
+    std::lock_guard lock(shard.mutex);
 
     ClientCacheBuffer* buf = nullptr;
-    if (!getBuffer(cacheId, &buf)) {
+    if (!getBuffer(shard, cacheId, &buf)) {
         ALOGV("failed to register erased recipient, could not retrieve buffer");
         return false;
     }
@@ -175,10 +190,11 @@ bool ClientCache::registerErasedRecipient(const client_cache_t& cacheId,
 
 void ClientCache::unregisterErasedRecipient(const client_cache_t& cacheId,
                                             const wp<ErasedRecipient>& recipient) {
-    std::lock_guard lock(mMutex);
+    Shard& shard = getShard(cacheId.token);
+    std::lock_guard lock(shard.mutex);
 
     ClientCacheBuffer* buf = nullptr;
-    if (!getBuffer(cacheId, &buf)) {
+    if (!getBuffer(shard, cacheId, &buf)) {
         ALOGE("failed to unregister erased recipient");
         return;
     }
@@ -193,14 +209,15 @@ void ClientCache::removeProcess(const wp<IBinder>& processToken) {
             ALOGE("failed to remove process, invalid (nullptr) process token");
             return;
         }
-        std::lock_guard lock(mMutex);
-        auto itr = mBuffers.find(processToken);
-        if (itr == mBuffers.end()) {
+        Shard& shard = getShard(processToken);
+        std::lock_guard lock(shard.mutex);
+        auto itr = shard.processes.find(processToken);
+        if (itr == shard.processes.end()) {
             ALOGE("failed to remove process, could not find process");
             return;
         }
 
-        for (auto& [id, clientCacheBuffer] : itr->second.second) {
+        for (auto& [id, clientCacheBuffer] : itr->second.buffers) {
             client_cache_t cacheId = {processToken, id};
             for (auto& recipient : clientCacheBuffer.recipients) {
                 sp<ErasedRecipient> erasedRecipient = recipient.promote();
@@ -209,7 +226,7 @@ void ClientCache::removeProcess(const wp<IBinder>& processToken) {
                 }
             }
         }
-        mBuffers.erase(itr);
+        shard.processes.erase(itr);
     }
 
     for (auto& [recipient, cacheId] : pendingErase) {
@@ -222,14 +239,29 @@ void ClientCache::CacheDeathRecipient::binderDied(const wp<IBinder>& who) {
 }
 
 void ClientCache::dump(std::string& result) {
-    std::lock_guard lock(mMutex);
-    for (const auto& [_, cache] : mBuffers) {
-        base::StringAppendF(&result, " Cache owner: %p\n", cache.first.get());
-
-        for (const auto& [id, entry] : cache.second) {
-            const auto& buffer = entry.buffer->getBuffer();
-            base::StringAppendF(&result, "\tID: %" PRIu64 ", size: %ux%u\n", id, buffer->getWidth(),
-                                buffer->getHeight());
+    for (Shard& shard : mShards) {
+        std::lock_guard lock(shard.mutex);
+        for (const auto& [_, process] : shard.processes) {
+            size_t pinnedBytes = 0;
+            for (const auto& [id, entry] : process.buffers) {
+                const auto& buffer = entry.buffer->getBuffer();
+                pinnedBytes += static_cast<size_t>(buffer->getStride()) * buffer->getHeight() *
+                        bytesPerPixel(buffer->getPixelFormat());
+            }
+
+            const uint64_t hits = process.hitCount.load(std::memory_order_relaxed);
+            const uint64_t misses = process.missCount.load(std::memory_order_relaxed);
+            base::StringAppendF(&result,
+                                " Cache owner: %p, %zu buffers, %.2f MiB pinned, %" PRIu64
+                                " hits, %" PRIu64 " misses\n",
+                                process.token.get(), process.buffers.size(),
+                                static_cast<float>(pinnedBytes) / (1024.f * 1024.f), hits, misses);
+
+            for (const auto& [id, entry] : process.buffers) {
+                const auto& buffer = entry.buffer->getBuffer();
+                base::StringAppendF(&result, "\tID: %" PRIu64 ", size: %ux%u\n", id,
+                                    buffer->getWidth(), buffer->getHeight());
+            }
         }
     }
 }
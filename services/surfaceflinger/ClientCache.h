@@ -18,12 +18,15 @@
 
 #include <android-base/thread_annotations.h>
 #include <binder/IBinder.h>
+#include <ftl/shared_mutex.h>
 #include <gui/LayerState.h>
 #include <renderengine/RenderEngine.h>
 #include <ui/GraphicBuffer.h>
 #include <utils/RefBase.h>
 #include <utils/Singleton.h>
 
+#include <array>
+#include <atomic>
 #include <map>
 #include <mutex>
 #include <set>
@@ -78,16 +81,33 @@ public:
     void dump(std::string& result);
 
 private:
-    std::mutex mMutex;
-
     struct ClientCacheBuffer {
         std::shared_ptr<renderengine::ExternalTexture> buffer;
         std::set<wp<ErasedRecipient>> recipients;
     };
-    std::map<wp<IBinder> /*caching process*/,
-             std::pair<sp<IBinder> /*strong ref to caching process*/,
-                       std::unordered_map<uint64_t /*cache id*/, ClientCacheBuffer>>>
-            mBuffers GUARDED_BY(mMutex);
+
+    struct ProcessBuffers {
+        // Strong ref to the caching process.
+        sp<IBinder> token;
+        std::unordered_map<uint64_t /*cache id*/, ClientCacheBuffer> buffers;
+
+        // Lookups of cached buffers, which are counted under a shared lock.
+        std::atomic<uint64_t> hitCount = 0;
+        std::atomic<uint64_t> missCount = 0;
+    };
+
+    // Buffers are resolved from transactions on many binder threads at once, so the processes
+    // are spread over shards, each of which can be read concurrently. Writes, i.e. caching and
+    // uncaching buffers, only block the lookups of the processes in the same shard.
+    struct Shard {
+        ftl::SharedMutex mutex;
+        std::map<wp<IBinder> /*caching process*/, ProcessBuffers> processes GUARDED_BY(mutex);
+    };
+
+    static constexpr size_t kShardCount = 16;
+    std::array<Shard, kShardCount> mShards;
+
+    Shard& getShard(const wp<IBinder>& processToken);
 
     class CacheDeathRecipient : public IBinder::DeathRecipient {
     public:
@@ -97,8 +117,8 @@ private:
     sp<CacheDeathRecipient> mDeathRecipient;
     renderengine::RenderEngine* mRenderEngine = nullptr;
 
-    bool getBuffer(const client_cache_t& cacheId, ClientCacheBuffer** outClientCacheBuffer)
-            REQUIRES(mMutex);
+    bool getBuffer(Shard& shard, const client_cache_t& cacheId,
+                   ClientCacheBuffer** outClientCacheBuffer) REQUIRES_SHARED(shard.mutex);
 };
 
 }; // namespace android
@@ -75,6 +75,11 @@ struct CompositionRefreshArgs {
     // If true, there was a geometry update this frame
     bool updatingGeometryThisFrame{false};
 
+    // If true, the only update this frame is new buffers on layers which are already on the
+    // outputs, with the same opacity and without newly forcing client composition. The outputs
+    // can then reuse the state they derived from their layer stacks for the last frame.
+    bool bufferOnlyUpdateThisFrame{false};
+
     // The color matrix to use for this
     // frame. Only set if the color transform is changing this frame.
     std::optional<mat4> colorTransformMatrix;
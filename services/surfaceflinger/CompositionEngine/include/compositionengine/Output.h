@@ -280,6 +280,10 @@ public:
     // Enables overriding the 170M trasnfer function as sRGB
     virtual void setTreat170mAsSrgb(bool) = 0;
 
+    // Enables redrawing only the damaged tiles of the client target when the rest of the buffer
+    // is still up to date
+    virtual void setPartialClientComposition(bool) = 0;
+
 protected:
     virtual void setDisplayColorProfile(std::unique_ptr<DisplayColorProfile>) = 0;
     virtual void setRenderSurface(std::unique_ptr<RenderSurface>) = 0;
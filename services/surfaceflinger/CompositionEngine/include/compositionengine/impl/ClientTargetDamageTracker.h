@@ -0,0 +1,78 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <vector>
+
+#include <compositionengine/LayerFE.h>
+#include <renderengine/DisplaySettings.h>
+#include <ui/Rect.h>
+#include <ui/Region.h>
+#include <ui/Transform.h>
+
+namespace android::compositionengine::impl {
+
+// Tracks which parts of the client target buffers are out of date, so that client composition only
+// redraws the tiles which changed since the buffer it renders into was last rendered, instead of
+// the whole output. For example, a blinking cursor over GPU composed content then only redraws the
+// tiles under the cursor.
+//
+// Damage is kept per buffer id, in framebuffer space and rounded out to kTileSize tiles. A buffer
+// is redrawn in full if it was not rendered before, or if the display settings or the list of
+// client composed layers changed since the last frame, as the damage of the frames in between is
+// then unknown.
+class ClientTargetDamageTracker {
+public:
+    static constexpr int32_t kTileSize = 64;
+
+    explicit ClientTargetDamageTracker(uint32_t maxBuffers) : mMaxBuffers(maxBuffers) {}
+
+    // Records a frame which is about to be rendered into bufferId, and returns the part of the
+    // buffer that must be redrawn: the bounds of the damaged tiles, or Rect::INVALID_RECT if the
+    // whole buffer must be redrawn.
+    //
+    // Changed layer settings are compared with the last frame. dirtyRegion, in layer stack space,
+    // adds the changes the settings do not show, such as new content in the same buffer.
+    Rect track(uint64_t bufferId, const Rect& framebufferBounds,
+               const ui::Transform& layerStackToFramebuffer, const Region& dirtyRegion,
+               const renderengine::DisplaySettings& display,
+               const std::vector<LayerFE::LayerSettings>& layers);
+
+    // Forgets the content of the buffer, e.g. because rendering into it failed.
+    void invalidate(uint64_t bufferId);
+
+    // Forgets the content of all buffers, e.g. because a frame was composed without rendering.
+    void clear();
+
+private:
+    // Adds the area the layer draws to, or returns false if it may draw outside of its bounds.
+    static bool addLayerBounds(const LayerFE::LayerSettings&, const ui::Transform&, Region*);
+
+    const uint32_t mMaxBuffers;
+
+    // Damage since each buffer was last rendered, least recently rendered first.
+    std::deque<std::pair<uint64_t /* bufferId */, Region>> mDamage;
+
+    // The last frame, without buffer references so that they are not kept alive.
+    std::optional<renderengine::DisplaySettings> mLastDisplay;
+    std::vector<LayerFE::LayerSettings> mLastLayers;
+};
+
+} // namespace android::compositionengine::impl
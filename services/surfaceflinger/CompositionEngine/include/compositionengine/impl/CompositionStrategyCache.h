@@ -0,0 +1,53 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+#include "DisplayHardware/HWComposer.h"
+
+namespace android::compositionengine::impl {
+
+// The cache is used to predict the composition strategy of a layer stack which was composed
+// before, though not necessarily last frame. For example, this happens when the notification shade
+// is opened and closed again over the same app.
+//
+// The cache maps the output layer hash of OutputCompositionState, which covers the layers, their
+// z order and whether they require client composition, to the changes the HWC requested for that
+// layer stack the last time it was validated. The prediction is always checked against the actual
+// changes, so a stale entry costs a prediction miss but never a wrong composition.
+class CompositionStrategyCache {
+public:
+    using DeviceRequestedChanges = android::HWComposer::DeviceRequestedChanges;
+
+    explicit CompositionStrategyCache(uint32_t cacheSize) : mMaxCacheSize(cacheSize) {}
+
+    // Returns the changes which were last requested for the layer stack, or nullptr if the layer
+    // stack is not cached.
+    const DeviceRequestedChanges* get(uint64_t outputLayerHash) const;
+
+    // Adds or replaces the changes for the layer stack, evicting the least recently added layer
+    // stack if the cache is full.
+    void add(uint64_t outputLayerHash, const DeviceRequestedChanges& changes);
+
+private:
+    const uint32_t mMaxCacheSize;
+    std::deque<std::pair<uint64_t /* outputLayerHash */, DeviceRequestedChanges>> mCache;
+};
+
+} // namespace android::compositionengine::impl
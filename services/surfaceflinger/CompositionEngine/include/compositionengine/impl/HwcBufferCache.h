@@ -66,6 +66,21 @@ public:
     // buffers from the cache. We add an extra slot at the end for the override buffers.
     static const constexpr size_t kOverrideBufferSlot = kMaxLayerBufferCount;
 
+    // public for testing
+    // Buffers that have been sent to the layer more than once are protected from eviction while
+    // buffers sent only once remain, up to this many protected buffers. This keeps a layer's
+    // working set of buffers cached when it also shows buffers that are only used once.
+    static const constexpr size_t kMaxProtectedBufferCount = kMaxLayerBufferCount * 3 / 4;
+
+    struct Stats {
+        // Number of buffers found in the cache, so that only the slot is sent to HWC.
+        uint32_t hits = 0;
+        // Number of buffers which had to be sent to HWC.
+        uint32_t misses = 0;
+        // Number of buffers evicted from the cache to make room for another buffer.
+        uint32_t evictions = 0;
+    };
+
     HwcBufferCache();
 
     //
@@ -92,6 +107,8 @@ public:
     //
     uint32_t uncache(uint64_t graphicBufferId);
 
+    const Stats& getStats() const { return mStats; }
+
 private:
     uint32_t cache(const sp<GraphicBuffer>& buffer);
     uint32_t getLeastRecentlyUsedSlot();
@@ -102,12 +119,16 @@ private:
         // Cache entries are evicted according to least-recently-used when more than
         // kMaxLayerBufferCount unique buffers have been sent to a layer.
         uint64_t lruCounter;
+        // True if this buffer has been sent to the layer again since it was cached.
+        bool reused;
     };
 
     std::unordered_map<uint64_t, Cache> mCacheByBufferId;
     sp<GraphicBuffer> mLastOverrideBuffer;
     std::stack<uint32_t> mFreeSlots;
     uint64_t mLeastRecentlyUsedCounter;
+    size_t mProtectedBufferCount = 0;
+    Stats mStats;
 };
 
 } // namespace compositionengine::impl
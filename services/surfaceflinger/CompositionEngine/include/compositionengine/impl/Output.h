@@ -20,6 +20,8 @@
 #include <compositionengine/LayerFECompositionState.h>
 #include <compositionengine/Output.h>
 #include <compositionengine/impl/ClientCompositionRequestCache.h>
+#include <compositionengine/impl/ClientTargetDamageTracker.h>
+#include <compositionengine/impl/CompositionStrategyCache.h>
 #include <compositionengine/impl/GpuCompositionResult.h>
 #include <compositionengine/impl/HwcAsyncWorker.h>
 #include <compositionengine/impl/OutputCompositionState.h>
@@ -110,6 +112,7 @@ public:
     bool canPredictCompositionStrategy(const CompositionRefreshArgs&) override;
     void setPredictCompositionStrategy(bool) override;
     void setTreat170mAsSrgb(bool) override;
+    void setPartialClientComposition(bool) override;
 
     // Testing
     const ReleasedLayers& getReleasedLayersForTest() const;
@@ -184,9 +187,18 @@ private:
     ReleasedLayers mReleasedLayers;
     OutputLayer* mLayerRequestingBackgroundBlur = nullptr;
     std::unique_ptr<ClientCompositionRequestCache> mClientCompositionRequestCache;
+    // Set if client composition only redraws the damaged tiles of the client target. Tracks more
+    // buffers than a triple buffered client target has, so that none are evicted in steady state.
+    static constexpr uint32_t kClientTargetDamageTrackerSize = 4;
+    std::unique_ptr<ClientTargetDamageTracker> mClientTargetDamageTracker;
     std::unique_ptr<planner::Planner> mPlanner;
     std::unique_ptr<HwcAsyncWorker> mHwComposerAsyncWorker;
 
+    // The composition strategies of the last few layer stacks, to predict the strategy of a layer
+    // stack which comes back.
+    static constexpr uint32_t kCompositionStrategyCacheSize = 4;
+    CompositionStrategyCache mCompositionStrategyCache{kCompositionStrategyCacheSize};
+
     bool mPredictCompositionStrategy = false;
     bool mOffloadPresent = false;
 
@@ -20,9 +20,11 @@
 #include <compositionengine/ProjectionSpace.h>
 #include <compositionengine/impl/planner/LayerState.h>
 #include <compositionengine/impl/planner/TexturePool.h>
+#include <ftl/future.h>
 #include <renderengine/RenderEngine.h>
 
 #include <chrono>
+#include <optional>
 
 namespace android {
 
@@ -85,7 +87,7 @@ public:
     size_t getDisplayCost() const;
 
     bool hasBufferUpdate() const;
-    bool hasRenderedBuffer() const { return mTexture != nullptr; }
+    bool hasRenderedBuffer() const { return mTexture != nullptr || mPendingRender.has_value(); }
     bool hasReadyBuffer() const;
 
     // Decomposes this CachedSet into a vector of its layers as individual CachedSets
@@ -96,6 +98,7 @@ public:
     void setLastUpdate(std::chrono::steady_clock::time_point now) { mLastUpdate = now; }
     void append(const CachedSet& other) {
         mTexture.reset();
+        mPendingRender.reset();
         mOutputDataspace = ui::Dataspace::UNKNOWN;
         mDrawFence = nullptr;
         mBlurLayer = nullptr;
@@ -113,10 +116,14 @@ public:
     void incrementSkipCount() { mSkipCount++; }
     size_t getSkipCount() { return mSkipCount; }
 
-    // Renders the cached set with the supplied output composition state.
+    // Renders the cached set with the supplied output composition state. RenderEngine may still be
+    // drawing when this returns, in which case the buffer is only set by finishRender().
     void render(renderengine::RenderEngine& re, TexturePool& texturePool,
                 const OutputCompositionState& outputState, bool deviceHandlesColorTransform);
 
+    // Sets the buffer drawn by render() once RenderEngine is done with it, without waiting.
+    void finishRender();
+
     void dump(std::string& result) const;
 
     // Whether this represents a single layer with a buffer and rounded corners.
@@ -171,6 +178,16 @@ private:
     ui::Dataspace mOutputDataspace;
     ui::Transform::RotationFlags mOrientation = ui::Transform::ROT_0;
 
+    // A draw which RenderEngine has not finished yet, and the state to set when it does.
+    struct PendingRender {
+        ftl::SharedFuture<FenceResult> drawFence;
+        std::shared_ptr<TexturePool::AutoTexture> texture;
+        ProjectionSpace outputSpace;
+        ui::Dataspace outputDataspace;
+        ui::Transform::RotationFlags orientation;
+    };
+    std::optional<PendingRender> mPendingRender;
+
     static const bool sDebugHighlighLayers;
 };
 
@@ -70,10 +70,28 @@ public:
             const size_t maxDeferRenderAttempts;
         };
 
+        // Tunables for the model which decides whether flattening a run is worth its cost. Costs
+        // are in pixels, like calculateDisplayCost.
+        struct CostModel {
+            static const constexpr size_t kDefaultOverlayPlaneBudget = 0;
+            static const constexpr size_t kDefaultGpuCostPercent = 200;
+
+            // Number of layers HWC is expected to put on overlay planes, or 0 if unknown. While
+            // the layer stack has more cached sets than this, HWC falls back to client
+            // composition for the rest every frame, so any run which frees planes is worth
+            // flattening.
+            const size_t overlayPlaneBudget;
+            // Cost of a pixel the GPU reads or writes while rendering a cached set, relative to a
+            // pixel the DPU reads while scanning out, in percent.
+            const size_t gpuCostPercent;
+        };
+
         static const constexpr std::chrono::milliseconds kDefaultActiveLayerTimeout = 150ms;
 
         static const constexpr bool kDefaultEnableHolePunch = true;
 
+        static const constexpr bool kDefaultKeepUnchangedCachedSets = false;
+
         // Threshold for determing whether a layer is active. A layer whose properties, including
         // the buffer, have not changed in at least this time is considered inactive and is
         // therefore a candidate for flattening.
@@ -85,6 +103,16 @@ public:
 
         // True if the hole punching feature should be enabled.
         const bool mEnableHolePunch;
+
+        // If set, only runs whose flattening saves more than it costs are flattened, and the run
+        // saving the most is chosen. Otherwise the first candidate run is flattened.
+        // See: CostModel
+        const std::optional<CostModel> mCostModel;
+
+        // If true, a geometry change keeps the cached sets at the bottom of the stack whose layers
+        // are all unchanged, rather than invalidating every cached set. This lets a stable
+        // background, e.g. wallpaper and launcher, stay flattened under an animating window.
+        const bool mKeepUnchangedCachedSets;
     };
 
     // Constants not yet backed by a sysprop
@@ -121,6 +149,15 @@ private:
 
     void resetActivities(NonBufferHash, std::chrono::steady_clock::time_point now);
 
+    // Returns the number of leading cached sets in mLayers whose layers are the same, in the same
+    // order and with the same non-buffer state, as the leading incoming layers.
+    size_t countUnchangedCachedSets(const std::vector<const LayerState*>& layers) const;
+
+    // Replaces mLayers with its first retainedCount cached sets followed by a new cached set for
+    // each remaining incoming layer, invalidating the rest.
+    void retainCachedSets(const std::vector<const LayerState*>& layers, size_t retainedCount,
+                          NonBufferHash, std::chrono::steady_clock::time_point now);
+
     NonBufferHash computeLayersHash() const;
 
     bool mergeWithCachedSets(const std::vector<const LayerState*>& layers,
@@ -225,6 +262,26 @@ private:
 
     std::vector<Run> findCandidateRuns(std::chrono::steady_clock::time_point now) const;
 
+    // The estimated cost and benefit of flattening a Run, in pixels.
+    struct RunCost {
+        // Pixels the GPU reads and writes to render the cached set, once.
+        size_t renderCost = 0;
+        // Pixels no longer read for each frame the cached set is reused.
+        int64_t savingsPerFrame = 0;
+        // Frames the cached set is expected to be reused for. Layers which have been stable for a
+        // number of frames are assumed to stay stable for as many.
+        size_t expectedReuseFrames = 0;
+
+        // Pixels saved over the expected reuse of the cached set, net of the render cost weighted
+        // by the given percentage.
+        int64_t getNetSavings(size_t gpuCostPercent) const;
+    };
+
+    RunCost estimateRunCost(const Run&) const;
+
+    // Whether the cost model allows flattening the given run.
+    bool isWorthFlattening(const Run&) const;
+
     std::optional<Run> findBestRun(std::vector<Run>& runs) const;
 
     void buildCachedSets(std::chrono::steady_clock::time_point now);
@@ -254,6 +311,8 @@ private:
     size_t mCachedSetCreationCount = 0;
     size_t mCachedSetCreationCost = 0;
     std::unordered_map<size_t, size_t> mInvalidatedCachedSetAges;
+    size_t mRunsRejectedByCostModel = 0;
+    size_t mRetainedCachedSetCount = 0;
 };
 
 } // namespace compositionengine::impl::planner
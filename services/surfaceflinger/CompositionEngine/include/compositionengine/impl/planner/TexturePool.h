@@ -73,7 +73,7 @@ public:
     // setDisplaySize must be called for the texture pool to be used.
     void setDisplaySize(ui::Size size);
 
-    // Borrows a new texture from the pool.
+    // Borrows a new texture from the pool, preferring one whose last use by the GPU is done.
     // If the pool is currently starved of textures, then a new texture is generated.
     // When the AutoTexture object is destroyed, the scratch texture is automatically returned
     // to the pool.
@@ -97,6 +97,11 @@ protected:
 
     std::deque<Entry> mPool;
 
+    // Statistics
+    size_t mHitCount = 0;
+    size_t mMissCount = 0;
+    size_t mBorrowedCount = 0;
+
 private:
     std::shared_ptr<renderengine::ExternalTexture> genTexture();
     // Returns a previously borrowed texture to the pool.
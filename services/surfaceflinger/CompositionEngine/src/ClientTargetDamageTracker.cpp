@@ -0,0 +1,157 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <compositionengine/impl/ClientTargetDamageTracker.h>
+
+namespace android::compositionengine::impl {
+
+namespace {
+
+LayerFE::LayerSettings getLayerSettingsSnapshot(const LayerFE::LayerSettings& settings) {
+    LayerFE::LayerSettings snapshot = settings;
+    snapshot.source.buffer.buffer = nullptr;
+    snapshot.source.buffer.fence = nullptr;
+    return snapshot;
+}
+
+bool snapshotsAreEqual(const LayerFE::LayerSettings& lhs, const LayerFE::LayerSettings& rhs) {
+    return lhs.bufferId == rhs.bufferId && lhs.frameNumber == rhs.frameNumber &&
+            static_cast<const renderengine::LayerSettings&>(lhs) ==
+            static_cast<const renderengine::LayerSettings&>(rhs);
+}
+
+int32_t roundDownToTile(int32_t value) {
+    return value / ClientTargetDamageTracker::kTileSize * ClientTargetDamageTracker::kTileSize;
+}
+
+int32_t roundUpToTile(int32_t value) {
+    return roundDownToTile(value + ClientTargetDamageTracker::kTileSize - 1);
+}
+
+Region toTiles(const Region& region, const Rect& bounds) {
+    Region tiles;
+    for (const Rect& rect : region.intersect(bounds)) {
+        tiles.orSelf(Rect(roundDownToTile(rect.left), roundDownToTile(rect.top),
+                          roundUpToTile(rect.right), roundUpToTile(rect.bottom)));
+    }
+    return tiles.intersect(bounds);
+}
+
+} // namespace
+
+Rect ClientTargetDamageTracker::track(uint64_t bufferId, const Rect& framebufferBounds,
+                                      const ui::Transform& layerStackToFramebuffer,
+                                      const Region& dirtyRegion,
+                                      const renderengine::DisplaySettings& display,
+                                      const std::vector<LayerFE::LayerSettings>& layers) {
+    std::vector<LayerFE::LayerSettings> snapshots;
+    snapshots.reserve(layers.size());
+    std::transform(layers.begin(), layers.end(), std::back_inserter(snapshots),
+                   getLayerSettingsSnapshot);
+
+    Region damage = layerStackToFramebuffer.transform(dirtyRegion);
+    bool damageKnown = mLastDisplay && *mLastDisplay == display &&
+            mLastLayers.size() == snapshots.size();
+    for (size_t i = 0; damageKnown && i < snapshots.size(); i++) {
+        if (!snapshotsAreEqual(mLastLayers[i], snapshots[i])) {
+            damageKnown = addLayerBounds(mLastLayers[i], layerStackToFramebuffer, &damage) &&
+                    addLayerBounds(snapshots[i], layerStackToFramebuffer, &damage);
+        }
+    }
+    mLastDisplay = display;
+    mLastLayers = std::move(snapshots);
+
+    if (!damageKnown) {
+        mDamage.clear();
+    }
+
+    const Region tiles = toTiles(damage, framebufferBounds);
+    Rect redraw = Rect::INVALID_RECT;
+    auto current = std::find_if(mDamage.begin(), mDamage.end(),
+                                [bufferId](const auto& entry) { return entry.first == bufferId; });
+    if (current != mDamage.end()) {
+        const Rect bounds = current->second.orSelf(tiles).getBounds();
+        if (bounds != framebufferBounds) {
+            redraw = bounds;
+        }
+        mDamage.erase(current);
+    }
+
+    for (auto& [otherBufferId, otherDamage] : mDamage) {
+        otherDamage.orSelf(tiles);
+    }
+    if (mDamage.size() >= mMaxBuffers) {
+        mDamage.pop_front();
+    }
+    mDamage.emplace_back(bufferId, Region());
+    return redraw;
+}
+
+void ClientTargetDamageTracker::invalidate(uint64_t bufferId) {
+    for (auto it = mDamage.begin(); it != mDamage.end(); it++) {
+        if (it->first == bufferId) {
+            mDamage.erase(it);
+            return;
+        }
+    }
+}
+
+void ClientTargetDamageTracker::clear() {
+    mDamage.clear();
+    mLastDisplay.reset();
+    mLastLayers.clear();
+}
+
+bool ClientTargetDamageTracker::addLayerBounds(const LayerFE::LayerSettings& layer,
+                                               const ui::Transform& layerStackToFramebuffer,
+                                               Region* damage) {
+    // Shadows and blurs reach beyond the layer bounds.
+    if (layer.shadow.length > 0.f || layer.backgroundBlurRadius > 0 || !layer.blurRegions.empty()) {
+        return false;
+    }
+
+    const FloatRect& bounds = layer.geometry.boundaries;
+    const mat4& transform = layer.geometry.positionTransform;
+    float left = INFINITY, top = INFINITY, right = -INFINITY, bottom = -INFINITY;
+    for (const vec2& corner : {vec2(bounds.left, bounds.top), vec2(bounds.right, bounds.top),
+                               vec2(bounds.left, bounds.bottom),
+                               vec2(bounds.right, bounds.bottom)}) {
+        const vec4 position = transform * vec4(corner.x, corner.y, 0.f, 1.f);
+        left = std::min(left, position.x);
+        top = std::min(top, position.y);
+        right = std::max(right, position.x);
+        bottom = std::max(bottom, position.y);
+    }
+    if (!std::isfinite(left) || !std::isfinite(top) || !std::isfinite(right) ||
+        !std::isfinite(bottom)) {
+        return false;
+    }
+
+    // Keep far off screen layers within the range of Rect.
+    constexpr float kMaxCoordinate = 1 << 24;
+    const auto toCoordinate = [&](float value) {
+        return static_cast<int32_t>(std::clamp(value, -kMaxCoordinate, kMaxCoordinate));
+    };
+    const Rect layerStackBounds(toCoordinate(std::floor(left)), toCoordinate(std::floor(top)),
+                                toCoordinate(std::ceil(right)), toCoordinate(std::ceil(bottom)));
+    damage->orSelf(layerStackToFramebuffer.transform(layerStackBounds, true /* roundOutwards */));
+    return true;
+}
+
+} // namespace android::compositionengine::impl
@@ -25,6 +25,8 @@
 
 #include <renderengine/RenderEngine.h>
 
+#include <algorithm>
+
 // TODO(b/129481165): remove the #pragma below and fix conversion issues
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wconversion"
@@ -90,9 +92,12 @@ nsecs_t CompositionEngine::getLastFrameRefreshTimestamp() const {
 }
 
 namespace {
-void offloadOutputs(Outputs& outputs) {
+using OffloadedOutputs = ui::PhysicalDisplayVector<compositionengine::Output*>;
+
+// Returns the outputs whose present will run on their HwcAsyncWorker this frame.
+OffloadedOutputs offloadOutputs(Outputs& outputs) {
     if (!FlagManager::getInstance().multithreaded_present() || outputs.size() < 2) {
-        return;
+        return {};
     }
 
     ui::PhysicalDisplayVector<compositionengine::Output*> outputsToOffload;
@@ -108,13 +113,13 @@ void offloadOutputs(Outputs& outputs) {
         // Only run present in multiple threads if all HWC-enabled displays
         // being refreshed support it.
         if (!output->supportsOffloadPresent()) {
-            return;
+            return {};
         }
         outputsToOffload.push_back(output.get());
     }
 
     if (outputsToOffload.size() < 2) {
-        return;
+        return {};
     }
 
     // Leave the last eligible display on the main thread, which will
@@ -124,6 +129,7 @@ void offloadOutputs(Outputs& outputs) {
     for (compositionengine::Output* output : outputsToOffload) {
         output->offloadPresentNextFrame();
     }
+    return outputsToOffload;
 }
 } // namespace
 
@@ -147,12 +153,21 @@ void CompositionEngine::present(CompositionRefreshArgs& args) {
     // Offloading the HWC call for `present` allows us to simultaneously call it
     // on multiple displays. This is desirable because these calls block and can
     // be slow.
-    offloadOutputs(args.outputs);
+    const OffloadedOutputs offloadedOutputs = offloadOutputs(args.outputs);
 
+    // Present the offloaded outputs first, so that their HWC calls overlap with composing the
+    // outputs that present on this thread, such as GPU virtual displays, rather than only with the
+    // outputs that happen to follow them in args.outputs.
     ui::DisplayVector<ftl::Future<std::monostate>> presentFutures;
-    for (const auto& output : args.outputs) {
+    for (compositionengine::Output* output : offloadedOutputs) {
         presentFutures.push_back(output->present(args));
     }
+    for (const auto& output : args.outputs) {
+        if (std::find(offloadedOutputs.begin(), offloadedOutputs.end(), output.get()) ==
+            offloadedOutputs.end()) {
+            presentFutures.push_back(output->present(args));
+        }
+    }
 
     {
         SFTRACE_NAME("Waiting on HWC");
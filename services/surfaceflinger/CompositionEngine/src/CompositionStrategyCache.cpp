@@ -0,0 +1,47 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <compositionengine/impl/CompositionStrategyCache.h>
+
+namespace android::compositionengine::impl {
+
+const CompositionStrategyCache::DeviceRequestedChanges* CompositionStrategyCache::get(
+        uint64_t outputLayerHash) const {
+    for (const auto& [cachedHash, cachedChanges] : mCache) {
+        if (cachedHash == outputLayerHash) {
+            return &cachedChanges;
+        }
+    }
+    return nullptr;
+}
+
+void CompositionStrategyCache::add(uint64_t outputLayerHash,
+                                   const DeviceRequestedChanges& changes) {
+    for (auto it = mCache.begin(); it != mCache.end(); it++) {
+        if (it->first == outputLayerHash) {
+            mCache.erase(it);
+            break;
+        }
+    }
+
+    if (mCache.size() >= mMaxCacheSize) {
+        mCache.pop_front();
+    }
+
+    mCache.emplace_back(outputLayerHash, changes);
+}
+
+} // namespace android::compositionengine::impl
@@ -32,8 +32,14 @@ HwcSlotAndBuffer HwcBufferCache::getHwcSlotAndBuffer(const sp<GraphicBuffer>& bu
         Cache& cache = i->second;
         // mark this cache slot as more recently used so it won't get evicted anytime soon
         cache.lruCounter = mLeastRecentlyUsedCounter++;
+        if (!cache.reused) {
+            cache.reused = true;
+            ++mProtectedBufferCount;
+        }
+        ++mStats.hits;
         return {cache.slot, nullptr};
     }
+    ++mStats.misses;
     return {cache(buffer), buffer};
 }
 
@@ -48,6 +54,9 @@ HwcSlotAndBuffer HwcBufferCache::getOverrideHwcSlotAndBuffer(const sp<GraphicBuf
 uint32_t HwcBufferCache::uncache(uint64_t bufferId) {
     if (auto i = mCacheByBufferId.find(bufferId); i != mCacheByBufferId.end()) {
         uint32_t slot = i->second.slot;
+        if (i->second.reused) {
+            --mProtectedBufferCount;
+        }
         mCacheByBufferId.erase(i);
         mFreeSlots.push(slot);
         return slot;
@@ -63,6 +72,7 @@ uint32_t HwcBufferCache::cache(const sp<GraphicBuffer>& buffer) {
     Cache cache;
     cache.slot = getLeastRecentlyUsedSlot();
     cache.lruCounter = mLeastRecentlyUsedCounter++;
+    cache.reused = false;
     cache.buffer = buffer;
     mCacheByBufferId.emplace(buffer->getId(), cache);
     return cache.slot;
@@ -71,16 +81,34 @@ uint32_t HwcBufferCache::cache(const sp<GraphicBuffer>& buffer) {
 uint32_t HwcBufferCache::getLeastRecentlyUsedSlot() {
     if (mFreeSlots.empty()) {
         assert(!mCacheByBufferId.empty());
-        // evict the least recently used cache entry
-        auto cacheToErase = mCacheByBufferId.begin();
-        for (auto i = cacheToErase; i != mCacheByBufferId.end(); ++i) {
-            if (i->second.lruCounter < cacheToErase->second.lruCounter) {
+        // evict the least recently used cache entry, preferring buffers that have only been used
+        // once while not too many buffers are protected
+        const bool evictProtected = mProtectedBufferCount > kMaxProtectedBufferCount;
+        const auto isCandidate = [evictProtected](const Cache& cache) {
+            return evictProtected || !cache.reused;
+        };
+        auto cacheToErase = mCacheByBufferId.end();
+        auto oldestCache = mCacheByBufferId.begin();
+        for (auto i = mCacheByBufferId.begin(); i != mCacheByBufferId.end(); ++i) {
+            if (i->second.lruCounter < oldestCache->second.lruCounter) {
+                oldestCache = i;
+            }
+            if (isCandidate(i->second) &&
+                (cacheToErase == mCacheByBufferId.end() ||
+                 i->second.lruCounter < cacheToErase->second.lruCounter)) {
                 cacheToErase = i;
             }
         }
+        if (cacheToErase == mCacheByBufferId.end()) {
+            cacheToErase = oldestCache;
+        }
         uint32_t slot = cacheToErase->second.slot;
+        if (cacheToErase->second.reused) {
+            --mProtectedBufferCount;
+        }
         mCacheByBufferId.erase(cacheToErase);
         mFreeSlots.push(slot);
+        ++mStats.evictions;
     }
     uint32_t slot = mFreeSlots.top();
     mFreeSlots.pop();
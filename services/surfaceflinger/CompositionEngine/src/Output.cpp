@@ -811,7 +811,11 @@ void Output::updateCompositionState(const compositionengine::CompositionRefreshA
         return;
     }
 
-    mLayerRequestingBackgroundBlur = findLayerRequestingBackgroundComposition();
+    // New buffers do not change which layer requests a background blur, the layer stack and
+    // the opacity of its layers stay the same.
+    if (!refreshArgs.bufferOnlyUpdateThisFrame) {
+        mLayerRequestingBackgroundBlur = findLayerRequestingBackgroundComposition();
+    }
     bool forceClientComposition = mLayerRequestingBackgroundBlur != nullptr;
 
     for (auto* layer : getOutputLayersOrderedByZ()) {
@@ -1104,6 +1108,9 @@ void Output::prepareFrame() {
 
     std::optional<android::HWComposer::DeviceRequestedChanges> changes;
     bool success = chooseCompositionStrategy(&changes);
+    if (success && changes) {
+        mCompositionStrategyCache.add(outputState.outputLayerHash, *changes);
+    }
     resetCompositionStrategy();
     outputState.strategyPrediction = CompositionStrategyPredictionState::DISABLED;
     outputState.previousDeviceRequestedChanges = changes;
@@ -1155,6 +1162,9 @@ GpuCompositionResult Output::prepareFrameAsync() {
     }
 
     auto chooseCompositionSuccess = hwcResult.get();
+    if (chooseCompositionSuccess && changes) {
+        mCompositionStrategyCache.add(state.outputLayerHash, *changes);
+    }
     const bool predictionSucceeded = dequeueSucceeded && changes == previousChanges;
     state.strategyPrediction = predictionSucceeded ? CompositionStrategyPredictionState::SUCCESS
                                                    : CompositionStrategyPredictionState::FAIL;
@@ -1298,6 +1308,10 @@ std::optional<base::unique_fd> Output::composeSurfaces(
         outputState.usesClientComposition};
     if (!hasClientComposition) {
         setExpensiveRenderingExpected(false);
+        if (mClientTargetDamageTracker) {
+            // The client target buffers miss whatever changed while HWC composed everything.
+            mClientTargetDamageTracker->clear();
+        }
         return base::unique_fd();
     }
 
@@ -1323,6 +1337,29 @@ std::optional<base::unique_fd> Output::composeSurfaces(
                                               clientCompositionLayersFE);
     appendRegionFlashRequests(debugRegion, clientCompositionLayers);
 
+    // Track the damage before checking the cache, so that frames which reuse a buffer still count
+    // towards the damage of the other buffers.
+    Rect damage = Rect::INVALID_RECT;
+    if (mClientTargetDamageTracker) {
+        damage = mClientTargetDamageTracker->track(tex->getBuffer()->getId(),
+                                                   outputState.framebufferSpace.getBoundsAsRect(),
+                                                   outputState.layerStackSpace.getTransform(
+                                                           outputState.framebufferSpace),
+                                                   getDirtyRegion(), clientCompositionDisplay,
+                                                   clientCompositionLayers);
+        // Blurs sample outside of the damage, and flashed regions must be fully redrawn next time.
+        const bool needsFullRedraw = !debugRegion.isEmpty() ||
+                mLayerRequestingBackgroundBlur != nullptr ||
+                std::any_of(clientCompositionLayers.begin(), clientCompositionLayers.end(),
+                            [](const auto& layer) {
+                                return layer.backgroundBlurRadius > 0 ||
+                                        !layer.blurRegions.empty();
+                            });
+        if (needsFullRedraw) {
+            damage = Rect::INVALID_RECT;
+        }
+    }
+
     OutputCompositionState& outputCompositionState = editState();
     // Check if the client composition requests were rendered into the provided graphic buffer. If
     // so, we can reuse the buffer and avoid client composition.
@@ -1364,6 +1401,9 @@ std::optional<base::unique_fd> Output::composeSurfaces(
                        return settings;
                    });
 
+    // Set after the cache check, as the cache compares whole frames.
+    clientCompositionDisplay.damage = damage;
+
     const nsecs_t renderEngineStart = systemTime();
     auto fenceResult = renderEngine
                                .drawLayers(clientCompositionDisplay, clientRenderEngineLayers, tex,
@@ -1374,6 +1414,9 @@ std::optional<base::unique_fd> Output::composeSurfaces(
         // If rendering was not successful, remove the request from the cache.
         mClientCompositionRequestCache->remove(tex->getBuffer()->getId());
     }
+    if (mClientTargetDamageTracker && fenceStatus(fenceResult) != NO_ERROR) {
+        mClientTargetDamageTracker->invalidate(tex->getBuffer()->getId());
+    }
     const auto fence = std::move(fenceResult).value_or(Fence::NO_FENCE);
     if (isPowerHintSessionEnabled()) {
         if (fence != Fence::NO_FENCE && fence->isValid() &&
@@ -1704,6 +1747,15 @@ void Output::setTreat170mAsSrgb(bool enable) {
     editState().treat170mAsSrgb = enable;
 }
 
+void Output::setPartialClientComposition(bool enable) {
+    if (!enable) {
+        mClientTargetDamageTracker.reset();
+    } else if (!mClientTargetDamageTracker) {
+        mClientTargetDamageTracker =
+                std::make_unique<ClientTargetDamageTracker>(kClientTargetDamageTrackerSize);
+    }
+}
+
 bool Output::canPredictCompositionStrategy(const CompositionRefreshArgs& refreshArgs) {
     uint64_t lastOutputLayerHash = getState().lastOutputLayerHash;
     uint64_t outputLayerHash = getState().outputLayerHash;
@@ -1714,6 +1766,17 @@ bool Output::canPredictCompositionStrategy(const CompositionRefreshArgs& refresh
         return false;
     }
 
+    if (lastOutputLayerHash != outputLayerHash) {
+        // The layer stack changed since last frame, but it may have been composed before.
+        const auto* cachedChanges = mCompositionStrategyCache.get(outputLayerHash);
+        if (!cachedChanges) {
+            ALOGV("canPredictCompositionStrategy output layers changed");
+            return false;
+        }
+        editState().previousDeviceRequestedChanges = *cachedChanges;
+        editState().previousDeviceRequestedSuccess = true;
+    }
+
     if (!getState().previousDeviceRequestedChanges) {
         ALOGV("canPredictCompositionStrategy previous changes not available");
         return false;
@@ -1729,11 +1792,6 @@ bool Output::canPredictCompositionStrategy(const CompositionRefreshArgs& refresh
         return false;
     }
 
-    if (lastOutputLayerHash != outputLayerHash) {
-        ALOGV("canPredictCompositionStrategy output layers changed");
-        return false;
-    }
-
     // If no layer uses clientComposition, then don't predict composition strategy
     // because we have less work to do in parallel.
     if (!anyLayersRequireClientComposition()) {
@@ -40,6 +40,11 @@ void dumpHwc(const OutputLayerCompositionState::Hwc& hwc, std::string& out) {
     }
 
     dumpVal(out, "composition", toString(hwc.hwcCompositionType), hwc.hwcCompositionType);
+
+    const auto& cacheStats = hwc.hwcBufferCache.getStats();
+    dumpVal(out, "bufferCacheHits", cacheStats.hits);
+    dumpVal(out, "bufferCacheMisses", cacheStats.misses);
+    dumpVal(out, "bufferCacheEvictions", cacheStats.evictions);
 }
 
 } // namespace
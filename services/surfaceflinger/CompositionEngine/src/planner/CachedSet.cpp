@@ -274,23 +274,43 @@ void CachedSet::render(renderengine::RenderEngine& renderEngine, TexturePool& te
         bufferFence.reset(texture->getReadyFence()->dup());
     }
 
-    auto fenceResult = renderEngine
-                               .drawLayers(displaySettings, layerSettings, texture->get(),
-                                           std::move(bufferFence))
-                               .get();
+    // Don't block on RenderEngine, so that rendering the cached set doesn't delay the next frame.
+    // The buffer is only set once the draw is done, see finishRender.
+    ProjectionSpace outputSpace = outputState.framebufferSpace;
+    outputSpace.setOrientation(outputState.framebufferSpace.getOrientation());
+    mPendingRender = PendingRender{
+            .drawFence = renderEngine
+                                 .drawLayers(displaySettings, layerSettings, texture->get(),
+                                             std::move(bufferFence))
+                                 .share(),
+            .texture = texture,
+            .outputSpace = outputSpace,
+            .outputDataspace = outputDataspace,
+            .orientation = orientation,
+    };
+
+    finishRender();
+}
+
+void CachedSet::finishRender() {
+    if (!mPendingRender ||
+        mPendingRender->drawFence.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return;
+    }
 
+    const FenceResult& fenceResult = mPendingRender->drawFence.get();
     if (fenceStatus(fenceResult) == NO_ERROR) {
-        mDrawFence = std::move(fenceResult).value_or(Fence::NO_FENCE);
-        mOutputSpace = outputState.framebufferSpace;
-        mTexture = texture;
+        mDrawFence = fenceResult.value_or(Fence::NO_FENCE);
+        mOutputSpace = mPendingRender->outputSpace;
+        mTexture = std::move(mPendingRender->texture);
         mTexture->setReadyFence(mDrawFence);
-        mOutputSpace.setOrientation(outputState.framebufferSpace.getOrientation());
-        mOutputDataspace = outputDataspace;
-        mOrientation = orientation;
+        mOutputDataspace = mPendingRender->outputDataspace;
+        mOrientation = mPendingRender->orientation;
         mSkipCount = 0;
     } else {
         mTexture.reset();
     }
+    mPendingRender.reset();
 }
 
 bool CachedSet::requiresHolePunch() const {
@@ -25,6 +25,9 @@
 #include <compositionengine/impl/planner/Flattener.h>
 #include <compositionengine/impl/planner/LayerState.h>
 
+#include <algorithm>
+#include <limits>
+
 using time_point = std::chrono::steady_clock::time_point;
 using namespace std::chrono_literals;
 
@@ -86,9 +89,14 @@ NonBufferHash Flattener::flattenLayers(const std::vector<const LayerState*>& lay
     // 3. A stricter equality check demonstrates that the layer stack really did change, since the
     // hashed geometry does not guarantee uniqueness.
     if (mCurrentGeometry != hash || (!mLayers.empty() && !isSameStack(layers, mLayers))) {
-        resetActivities(hash, now);
-        mFlattenedDisplayCost += unflattenedDisplayCost;
-        return hash;
+        const size_t retainedCount =
+                mTunables.mKeepUnchangedCachedSets ? countUnchangedCachedSets(layers) : 0;
+        if (retainedCount == 0) {
+            resetActivities(hash, now);
+            mFlattenedDisplayCost += unflattenedDisplayCost;
+            return hash;
+        }
+        retainCachedSets(layers, retainedCount, hash, now);
     }
 
     ++mInitialLayerCounts[layers.size()];
@@ -199,6 +207,22 @@ void Flattener::dump(std::string& result) const {
     base::StringAppendF(&result, "\n    Cached sets created: %zd\n", mCachedSetCreationCount);
     base::StringAppendF(&result, "    Cost: %.2f\n",
                         static_cast<float>(mCachedSetCreationCost) / displayArea);
+    base::StringAppendF(&result, "    Runs rejected by cost model: %zd\n",
+                        mRunsRejectedByCostModel);
+    base::StringAppendF(&result, "    Cached sets kept across geometry changes: %zd\n",
+                        mRetainedCachedSetCount);
+
+    // Cached sets are rendered to RGBA_8888 buffers, so assume 4 bytes per pixel.
+    constexpr float kBytesPerPixel = 4.f;
+    constexpr float kBytesPerMiB = 1024.f * 1024.f;
+    const float bytesSaved = (static_cast<float>(mUnflattenedDisplayCost) -
+                              static_cast<float>(mFlattenedDisplayCost)) *
+            kBytesPerPixel;
+    result.append("\n    Bandwidth (in MiB):\n");
+    base::StringAppendF(&result, "      Scanout saved:  %.2f\n", bytesSaved / kBytesPerMiB);
+    base::StringAppendF(&result, "      GPU work spent: %.2f\n",
+                        static_cast<float>(mCachedSetCreationCost) * kBytesPerPixel /
+                                kBytesPerMiB);
 
     const auto lastUpdate =
             std::chrono::duration_cast<std::chrono::milliseconds>(now - mLastGeometryUpdate);
@@ -258,6 +282,77 @@ void Flattener::resetActivities(NonBufferHash hash, time_point now) {
     }
 }
 
+size_t Flattener::countUnchangedCachedSets(const std::vector<const LayerState*>& layers) const {
+    size_t count = 0;
+    size_t flattenedCount = 0;
+    size_t index = 0;
+    for (const CachedSet& cachedSet : mLayers) {
+        // Hole punch and blur bake the layer above the cached set into its buffer, so a change
+        // above the set may invalidate it.
+        if (cachedSet.getHolePunchLayer() || cachedSet.getBlurLayer()) {
+            break;
+        }
+
+        const auto& constituents = cachedSet.getConstituentLayers();
+        if (index + constituents.size() > layers.size()) {
+            break;
+        }
+
+        // Compare pointers before dereferencing anything, since the LayerState of a removed layer
+        // may be destroyed after this frame.
+        const bool unchanged =
+                std::equal(constituents.begin(), constituents.end(), layers.begin() + index,
+                           [](const CachedSet::Layer& layer, const LayerState* incoming) {
+                               return layer.getState() == incoming &&
+                                       layer.getHash() == incoming->getHash();
+                           });
+        if (!unchanged) {
+            break;
+        }
+
+        index += constituents.size();
+        ++count;
+        if (constituents.size() > 1) {
+            flattenedCount = count;
+        }
+    }
+
+    // Keeping only single-layer sets saves nothing over starting again.
+    return flattenedCount;
+}
+
+void Flattener::retainCachedSets(const std::vector<const LayerState*>& layers,
+                                 size_t retainedCount, NonBufferHash hash, time_point now) {
+    ALOGV("[%s] Keeping %zu cached sets", __func__, retainedCount);
+
+    mCurrentGeometry = hash;
+    mLastGeometryUpdate = now;
+
+    size_t retainedLayerCount = 0;
+    for (size_t i = 0; i < retainedCount; ++i) {
+        retainedLayerCount += mLayers[i].getLayerCount();
+    }
+
+    for (size_t i = retainedCount; i < mLayers.size(); ++i) {
+        if (mLayers[i].getLayerCount() > 1) {
+            ++mInvalidatedCachedSetAges[mLayers[i].getAge()];
+        }
+    }
+    mLayers.erase(mLayers.begin() + retainedCount, mLayers.end());
+
+    if (mNewCachedSet) {
+        ++mInvalidatedCachedSetAges[mNewCachedSet->getAge()];
+        mNewCachedSet = std::nullopt;
+    }
+
+    mLayers.reserve(retainedCount + layers.size() - retainedLayerCount);
+    for (size_t i = retainedLayerCount; i < layers.size(); ++i) {
+        mLayers.emplace_back(layers[i], now);
+    }
+
+    mRetainedCachedSetCount += retainedCount;
+}
+
 NonBufferHash Flattener::computeLayersHash() const{
     size_t hash = 0;
     for (const auto& layer : mLayers) {
@@ -273,6 +368,10 @@ bool Flattener::mergeWithCachedSets(const std::vector<const LayerState*>& layers
     SFTRACE_CALL();
     std::vector<CachedSet> merged;
 
+    if (mNewCachedSet) {
+        mNewCachedSet->finishRender();
+    }
+
     if (mLayers.empty()) {
         merged.reserve(layers.size());
         for (const LayerState* layer : layers) {
@@ -483,13 +582,84 @@ std::vector<Flattener::Run> Flattener::findCandidateRuns(time_point now) const {
     return runs;
 }
 
+int64_t Flattener::RunCost::getNetSavings(size_t gpuCostPercent) const {
+    return savingsPerFrame * static_cast<int64_t>(expectedReuseFrames) -
+            static_cast<int64_t>(renderCost * gpuCostPercent / 100);
+}
+
+Flattener::RunCost Flattener::estimateRunCost(const Run& run) const {
+    RunCost cost;
+    Region boundingRegion;
+    size_t unflattenedDisplayCost = 0;
+    size_t layerCount = 0;
+    bool hasClientComposition = false;
+    cost.expectedReuseFrames = std::numeric_limits<size_t>::max();
+
+    for (auto currentSet = run.getStart(); layerCount < run.getLayerLength(); ++currentSet) {
+        layerCount += currentSet->getLayerCount();
+        boundingRegion.orSelf(currentSet->getBounds());
+        unflattenedDisplayCost += currentSet->getDisplayCost();
+        cost.renderCost += currentSet->getComponentDisplayCost();
+        cost.expectedReuseFrames = std::min(cost.expectedReuseFrames, currentSet->getAge());
+
+        for (const CachedSet::Layer& layer : currentSet->getConstituentLayers()) {
+            hasClientComposition |= layer.getState()->getCompositionType() ==
+                    aidl::android::hardware::graphics::composer3::Composition::CLIENT;
+        }
+    }
+
+    const Rect bounds = boundingRegion.getBounds();
+    const size_t flattenedDisplayCost = static_cast<size_t>(bounds.width() * bounds.height());
+    cost.renderCost += flattenedDisplayCost;
+    cost.savingsPerFrame = static_cast<int64_t>(unflattenedDisplayCost) -
+            static_cast<int64_t>(flattenedDisplayCost);
+    if (hasClientComposition) {
+        // Client composed layers are otherwise read by the GPU again every frame
+        cost.savingsPerFrame += static_cast<int64_t>(unflattenedDisplayCost);
+    }
+    return cost;
+}
+
+bool Flattener::isWorthFlattening(const Run& run) const {
+    const auto& costModel = mTunables.mCostModel;
+    if (!costModel) {
+        return true;
+    }
+
+    // A hole punch moves a layer to its own plane, rather than saving bandwidth.
+    if (run.getHolePunchCandidate() && run.getHolePunchCandidate()->requiresHolePunch()) {
+        return true;
+    }
+
+    if (costModel->overlayPlaneBudget > 0 && mLayers.size() > costModel->overlayPlaneBudget) {
+        return true;
+    }
+
+    return estimateRunCost(run).getNetSavings(costModel->gpuCostPercent) > 0;
+}
+
 std::optional<Flattener::Run> Flattener::findBestRun(std::vector<Flattener::Run>& runs) const {
     if (runs.empty()) {
         return std::nullopt;
     }
 
-    // TODO (b/181192467): Choose the best run, instead of just the first.
-    return runs[0];
+    const auto& costModel = mTunables.mCostModel;
+    if (!costModel) {
+        // TODO (b/181192467): Choose the best run, instead of just the first.
+        return runs[0];
+    }
+
+    if (costModel->overlayPlaneBudget > 0 && mLayers.size() > costModel->overlayPlaneBudget) {
+        // Free as many planes as possible.
+        return *std::max_element(runs.cbegin(), runs.cend(), [](const Run& left, const Run& right) {
+            return left.getLayerLength() < right.getLayerLength();
+        });
+    }
+
+    return *std::max_element(runs.cbegin(), runs.cend(), [&](const Run& left, const Run& right) {
+        return estimateRunCost(left).getNetSavings(costModel->gpuCostPercent) <
+                estimateRunCost(right).getNetSavings(costModel->gpuCostPercent);
+    });
 }
 
 void Flattener::buildCachedSets(time_point now) {
@@ -512,7 +682,14 @@ void Flattener::buildCachedSets(time_point now) {
         }
     }
 
-    std::vector<Run> runs = findCandidateRuns(now);
+    std::vector<Run> runs;
+    for (const Run& run : findCandidateRuns(now)) {
+        if (isWorthFlattening(run)) {
+            runs.push_back(run);
+        } else {
+            ++mRunsRejectedByCostModel;
+        }
+    }
 
     std::optional<Run> bestRun = findBestRun(runs);
 
@@ -53,6 +53,21 @@ std::optional<Flattener::Tunables::RenderScheduling> buildRenderSchedulingTunabl
             });
 }
 
+std::optional<Flattener::Tunables::CostModel> buildCostModelTunables() {
+    if (!base::GetBoolProperty(std::string("debug.sf.enable_flattener_cost_model"), false)) {
+        return std::nullopt;
+    }
+
+    return std::make_optional<Flattener::Tunables::CostModel>(Flattener::Tunables::CostModel{
+            .overlayPlaneBudget = base::GetUintProperty<
+                    size_t>(std::string("debug.sf.flattener_overlay_plane_budget"),
+                            Flattener::Tunables::CostModel::kDefaultOverlayPlaneBudget),
+            .gpuCostPercent = base::GetUintProperty<
+                    size_t>(std::string("debug.sf.flattener_gpu_cost_percent"),
+                            Flattener::Tunables::CostModel::kDefaultGpuCostPercent),
+    });
+}
+
 Flattener::Tunables buildFlattenerTuneables() {
     const auto activeLayerTimeout = std::chrono::milliseconds(
             base::GetIntProperty<int32_t>(std::string(
@@ -61,10 +76,15 @@ Flattener::Tunables buildFlattenerTuneables() {
     const auto enableHolePunch =
             base::GetBoolProperty(std::string("debug.sf.enable_hole_punch_pip"),
                                   Flattener::Tunables::kDefaultEnableHolePunch);
+    const auto keepUnchangedCachedSets =
+            base::GetBoolProperty(std::string("debug.sf.layer_caching_keep_unchanged_sets"),
+                                  Flattener::Tunables::kDefaultKeepUnchangedCachedSets);
     return Flattener::Tunables{
             .mActiveLayerTimeout = activeLayerTimeout,
             .mRenderScheduling = buildRenderSchedulingTunables(),
             .mEnableHolePunch = enableHolePunch,
+            .mCostModel = buildCostModelTunables(),
+            .mKeepUnchangedCachedSets = keepUnchangedCachedSets,
     };
 }
 
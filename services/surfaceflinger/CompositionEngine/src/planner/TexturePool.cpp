@@ -23,6 +23,8 @@
 #include <renderengine/impl/ExternalTexture.h>
 #include <utils/Log.h>
 
+#include <algorithm>
+
 namespace android::compositionengine::impl::planner {
 
 void TexturePool::allocatePool() {
@@ -44,17 +46,32 @@ void TexturePool::setDisplaySize(ui::Size size) {
 }
 
 std::shared_ptr<TexturePool::AutoTexture> TexturePool::borrowTexture() {
+    ++mBorrowedCount;
     if (mPool.empty()) {
+        ++mMissCount;
         return std::make_shared<AutoTexture>(*this, genTexture(), nullptr);
     }
 
-    const auto entry = mPool.front();
-    mPool.pop_front();
+    ++mHitCount;
+
+    // Textures are returned to the back of the pool, so the front one is the least recently used.
+    // Still, skip the ones which the GPU is drawing to, as the texture couldn't be rendered to now.
+    auto it = std::find_if(mPool.begin(), mPool.end(), [](const Entry& entry) {
+        return !entry.fence || entry.fence->getStatus() == Fence::Status::Signaled;
+    });
+    if (it == mPool.end()) {
+        it = mPool.begin();
+    }
+
+    const auto entry = *it;
+    mPool.erase(it);
     return std::make_shared<AutoTexture>(*this, entry.texture, entry.fence);
 }
 
 void TexturePool::returnTexture(std::shared_ptr<renderengine::ExternalTexture>&& texture,
                                 const sp<Fence>& fence) {
+    --mBorrowedCount;
+
     // Drop the texture on the floor if the pool is not enabled
     if (!mEnabled) {
         return;
@@ -107,6 +124,18 @@ void TexturePool::dump(std::string& out) const {
     base::StringAppendF(&out,
                         "TexturePool (%s) has %zu buffers of size [%" PRId32 ", %" PRId32 "]\n",
                         mEnabled ? "enabled" : "disabled", mPool.size(), mSize.width, mSize.height);
+
+    // Textures are RGBA_8888.
+    const size_t textureBytes = mSize.isValid()
+            ? static_cast<size_t>(mSize.getWidth()) * static_cast<size_t>(mSize.getHeight()) * 4
+            : 0;
+    base::StringAppendF(&out,
+                        "    %zu borrowed, %.2f MiB held in total. Borrows: %zu from the pool, "
+                        "%zu allocated\n",
+                        mBorrowedCount,
+                        static_cast<float>((mPool.size() + mBorrowedCount) * textureBytes) /
+                                (1024.f * 1024.f),
+                        mHitCount, mMissCount);
 }
 
 } // namespace android::compositionengine::impl::planner
\ No newline at end of file
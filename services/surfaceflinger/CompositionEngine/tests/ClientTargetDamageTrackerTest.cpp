@@ -0,0 +1,124 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <compositionengine/impl/ClientTargetDamageTracker.h>
+#include <gtest/gtest.h>
+
+namespace android::compositionengine {
+namespace {
+
+using impl::ClientTargetDamageTracker;
+
+constexpr uint64_t kBufferA = 1;
+constexpr uint64_t kBufferB = 2;
+constexpr uint64_t kBufferC = 3;
+const Rect kFramebufferBounds(1024, 1024);
+
+LayerFE::LayerSettings makeLayer(const FloatRect& bounds, uint64_t frameNumber = 1) {
+    LayerFE::LayerSettings layer;
+    layer.geometry.boundaries = bounds;
+    layer.source.solidColor = half3(1.f, 0.f, 0.f);
+    layer.frameNumber = frameNumber;
+    return layer;
+}
+
+class ClientTargetDamageTrackerTest : public testing::Test {
+protected:
+    Rect track(uint64_t bufferId, const std::vector<LayerFE::LayerSettings>& layers,
+               const Region& dirtyRegion = Region()) {
+        return mTracker.track(bufferId, kFramebufferBounds, ui::Transform(), dirtyRegion,
+                              mDisplay, layers);
+    }
+
+    ClientTargetDamageTracker mTracker{2};
+    renderengine::DisplaySettings mDisplay{.physicalDisplay = kFramebufferBounds,
+                                           .clip = kFramebufferBounds};
+    const LayerFE::LayerSettings mBackground = makeLayer(FloatRect(0, 0, 1024, 1024));
+};
+
+TEST_F(ClientTargetDamageTrackerTest, redrawsNewBuffersInFull) {
+    EXPECT_FALSE(track(kBufferA, {mBackground}).isValid());
+    EXPECT_FALSE(track(kBufferB, {mBackground}).isValid());
+}
+
+TEST_F(ClientTargetDamageTrackerTest, redrawsTilesOfChangedLayer) {
+    track(kBufferA, {mBackground, makeLayer(FloatRect(100, 100, 110, 120), 1)});
+    track(kBufferB, {mBackground, makeLayer(FloatRect(100, 100, 110, 120), 1)});
+
+    // The cursor blinks: only the tile under it is damaged since buffer A was rendered.
+    EXPECT_EQ(Rect(64, 64, 128, 128),
+              track(kBufferA, {mBackground, makeLayer(FloatRect(100, 100, 110, 120), 2)}));
+}
+
+TEST_F(ClientTargetDamageTrackerTest, accumulatesDamageSinceBufferWasRendered) {
+    track(kBufferA, {mBackground, makeLayer(FloatRect(0, 0, 10, 10), 1)});
+    track(kBufferB, {mBackground, makeLayer(FloatRect(0, 0, 10, 10), 2)});
+
+    const auto layer = makeLayer(FloatRect(0, 0, 10, 10), 3);
+    // Buffer A misses the change rendered into B as well as the new one.
+    EXPECT_EQ(Rect(0, 0, 64, 64), track(kBufferA, {mBackground, layer}));
+    // Buffer B only misses the last change.
+    EXPECT_EQ(Rect(0, 0, 64, 64), track(kBufferB, {mBackground, layer}));
+    // Buffer A is up to date.
+    EXPECT_EQ(Rect(0, 0, 0, 0), track(kBufferA, {mBackground, layer}));
+}
+
+TEST_F(ClientTargetDamageTrackerTest, includesDirtyRegion) {
+    track(kBufferA, {mBackground});
+    EXPECT_EQ(Rect(128, 192, 320, 256),
+              track(kBufferA, {mBackground}, Region(Rect(130, 200, 300, 210))));
+}
+
+TEST_F(ClientTargetDamageTrackerTest, redrawsInFullWhenLayersChange) {
+    track(kBufferA, {mBackground});
+    track(kBufferB, {mBackground, makeLayer(FloatRect(0, 0, 10, 10))});
+    EXPECT_FALSE(track(kBufferA, {mBackground, makeLayer(FloatRect(0, 0, 10, 10))}).isValid());
+}
+
+TEST_F(ClientTargetDamageTrackerTest, redrawsInFullWhenDisplayChanges) {
+    track(kBufferA, {mBackground});
+    mDisplay.maxLuminance = 500.f;
+    EXPECT_FALSE(track(kBufferA, {mBackground}).isValid());
+}
+
+TEST_F(ClientTargetDamageTrackerTest, redrawsInFullWhenChangedLayerCastsShadow) {
+    auto shadowed = makeLayer(FloatRect(0, 0, 10, 10), 1);
+    shadowed.shadow.length = 5.f;
+    track(kBufferA, {mBackground, shadowed});
+    shadowed.frameNumber = 2;
+    EXPECT_FALSE(track(kBufferA, {mBackground, shadowed}).isValid());
+}
+
+TEST_F(ClientTargetDamageTrackerTest, redrawsInFullAfterInvalidateAndClear) {
+    track(kBufferA, {mBackground});
+    mTracker.invalidate(kBufferA);
+    EXPECT_FALSE(track(kBufferA, {mBackground}).isValid());
+
+    mTracker.clear();
+    EXPECT_FALSE(track(kBufferA, {mBackground}).isValid());
+}
+
+TEST_F(ClientTargetDamageTrackerTest, evictsLeastRecentlyRenderedBuffer) {
+    track(kBufferA, {mBackground});
+    track(kBufferB, {mBackground});
+    track(kBufferC, {mBackground});
+    EXPECT_TRUE(track(kBufferC, {mBackground}).isValid());
+    EXPECT_TRUE(track(kBufferB, {mBackground}).isValid());
+    EXPECT_FALSE(track(kBufferA, {mBackground}).isValid());
+}
+
+} // namespace
+} // namespace android::compositionengine
@@ -44,6 +44,7 @@ using ::testing::Ref;
 using ::testing::Return;
 using ::testing::ReturnRef;
 using ::testing::SaveArg;
+using ::testing::Sequence;
 using ::testing::StrictMock;
 
 struct CompositionEngineTest : public testing::Test {
@@ -487,6 +488,33 @@ TEST_F(CompositionEngineOffloadTest, disabledDisplaysDoNotPreventOthersFromOfflo
     mEngine.present(mRefreshArgs);
 }
 
+TEST_F(CompositionEngineOffloadTest, presentsOffloadedOutputsFirst) {
+    EXPECT_CALL(*mVirtualDisplay, supportsOffloadPresent).Times(0);
+    EXPECT_CALL(*mDisplay1, supportsOffloadPresent).WillOnce(Return(true));
+    EXPECT_CALL(*mDisplay2, supportsOffloadPresent).WillOnce(Return(true));
+
+    EXPECT_CALL(*mVirtualDisplay, offloadPresentNextFrame).Times(0);
+    EXPECT_CALL(*mDisplay1, offloadPresentNextFrame).Times(1);
+    EXPECT_CALL(*mDisplay2, offloadPresentNextFrame).Times(0);
+
+    SET_FLAG_FOR_TEST(flags::multithreaded_present, true);
+
+    // setOutputs does not check the order in which the outputs are presented.
+    for (auto& output : {mVirtualDisplay, mDisplay1, mDisplay2}) {
+        EXPECT_CALL(*output, prepare(Ref(mRefreshArgs), _)).Times(1);
+        mRefreshArgs.outputs.push_back(output);
+    }
+
+    Sequence presentSequence;
+    for (auto& output : {mDisplay1, mVirtualDisplay, mDisplay2}) {
+        EXPECT_CALL(*output, present(Ref(mRefreshArgs)))
+                .InSequence(presentSequence)
+                .WillOnce(Return(ftl::yield<std::monostate>({})));
+    }
+
+    mEngine.present(mRefreshArgs);
+}
+
 struct CompositionEnginePostCompositionTest : public CompositionEngineTest {
     sp<StrictMock<mock::LayerFE>> mLayer1FE = sp<StrictMock<mock::LayerFE>>::make();
     sp<StrictMock<mock::LayerFE>> mLayer2FE = sp<StrictMock<mock::LayerFE>>::make();
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <compositionengine/impl/CompositionStrategyCache.h>
+#include <gtest/gtest.h>
+
+namespace android::compositionengine {
+namespace {
+
+using impl::CompositionStrategyCache;
+using DeviceRequestedChanges = CompositionStrategyCache::DeviceRequestedChanges;
+
+DeviceRequestedChanges makeChanges(hal::DisplayRequest displayRequests) {
+    DeviceRequestedChanges changes{};
+    changes.displayRequests = displayRequests;
+    return changes;
+}
+
+TEST(CompositionStrategyCacheTest, returnsChangesForCachedLayerStacks) {
+    CompositionStrategyCache cache(2);
+    EXPECT_EQ(cache.get(1u), nullptr);
+
+    const auto flipChanges = makeChanges(hal::DisplayRequest::FLIP_CLIENT_TARGET);
+    const auto noChanges = makeChanges(static_cast<hal::DisplayRequest>(0));
+    cache.add(1u, flipChanges);
+    cache.add(2u, noChanges);
+
+    ASSERT_NE(cache.get(1u), nullptr);
+    EXPECT_EQ(*cache.get(1u), flipChanges);
+    ASSERT_NE(cache.get(2u), nullptr);
+    EXPECT_EQ(*cache.get(2u), noChanges);
+    EXPECT_EQ(cache.get(3u), nullptr);
+}
+
+TEST(CompositionStrategyCacheTest, replacesChangesOfCachedLayerStack) {
+    CompositionStrategyCache cache(2);
+    cache.add(1u, makeChanges(static_cast<hal::DisplayRequest>(0)));
+
+    const auto flipChanges = makeChanges(hal::DisplayRequest::FLIP_CLIENT_TARGET);
+    cache.add(1u, flipChanges);
+
+    ASSERT_NE(cache.get(1u), nullptr);
+    EXPECT_EQ(*cache.get(1u), flipChanges);
+}
+
+TEST(CompositionStrategyCacheTest, evictsLeastRecentlyAddedLayerStack) {
+    CompositionStrategyCache cache(2);
+    const auto noChanges = makeChanges(static_cast<hal::DisplayRequest>(0));
+    cache.add(1u, noChanges);
+    cache.add(2u, noChanges);
+    // Adding 1 again makes 2 the least recently added.
+    cache.add(1u, noChanges);
+    cache.add(3u, noChanges);
+
+    EXPECT_NE(cache.get(1u), nullptr);
+    EXPECT_EQ(cache.get(2u), nullptr);
+    EXPECT_NE(cache.get(3u), nullptr);
+}
+
+} // namespace
+} // namespace android::compositionengine
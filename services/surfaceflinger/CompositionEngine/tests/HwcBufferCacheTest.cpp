@@ -85,6 +85,38 @@ TEST_F(HwcBufferCacheTest, getHwcSlotAndBuffer_whenSlotsFull_evictsOldestCachedB
     EXPECT_EQ(cache.uncache(graphicBuffers[0]->getId()), UINT32_MAX);
 }
 
+TEST_F(HwcBufferCacheTest, getHwcSlotAndBuffer_whenSlotsFull_keepsReusedBuffer) {
+    HwcBufferCache cache;
+
+    // the 1st buffer is the oldest, but has been used more than once
+    HwcSlotAndBuffer slotAndBufferFor1 = cache.getHwcSlotAndBuffer(mBuffer1);
+    cache.getHwcSlotAndBuffer(mBuffer1);
+
+    sp<GraphicBuffer> graphicBuffers[100];
+    for (int i = 0; i < 100; ++i) {
+        graphicBuffers[i] = sp<GraphicBuffer>::make(1u, 1u, HAL_PIXEL_FORMAT_RGBA_8888, 1u, 0u);
+        cache.getHwcSlotAndBuffer(graphicBuffers[i]);
+    }
+
+    // buffers used only once were evicted instead of the 1st buffer
+    EXPECT_GT(cache.getStats().evictions, 0u);
+    EXPECT_EQ(cache.getHwcSlotAndBuffer(mBuffer1).buffer, nullptr);
+    EXPECT_EQ(cache.uncache(mBuffer1->getId()), slotAndBufferFor1.slot);
+    EXPECT_EQ(cache.uncache(graphicBuffers[0]->getId()), UINT32_MAX);
+}
+
+TEST_F(HwcBufferCacheTest, getStats_countsHitsAndMisses) {
+    HwcBufferCache cache;
+
+    cache.getHwcSlotAndBuffer(mBuffer1);
+    cache.getHwcSlotAndBuffer(mBuffer1);
+    cache.getHwcSlotAndBuffer(mBuffer2);
+
+    EXPECT_EQ(cache.getStats().hits, 1u);
+    EXPECT_EQ(cache.getStats().misses, 2u);
+    EXPECT_EQ(cache.getStats().evictions, 0u);
+}
+
 TEST_F(HwcBufferCacheTest, uncache_whenCached_returnsSlotNumber) {
     HwcBufferCache cache;
     sp<GraphicBuffer> outBuffer;
@@ -5133,6 +5133,34 @@ TEST_F(OutputUpdateAndWriteCompositionStateTest, handlesBackgroundBlurRequests)
     mOutput->writeCompositionState(args);
 }
 
+TEST_F(OutputUpdateAndWriteCompositionStateTest, reusesBackgroundBlurRequestOnBufferOnlyUpdates) {
+    InjectedLayer layer1;
+    InjectedLayer layer2;
+
+    // The layer requesting blur is only looked up when there is more than a buffer update.
+    EXPECT_CALL(*layer1.outputLayer, updateCompositionState(false, true, ui::Transform::ROT_0))
+            .Times(2);
+    EXPECT_CALL(*layer2.outputLayer, updateCompositionState(false, true, ui::Transform::ROT_0))
+            .Times(2);
+
+    layer2.layerFEState.backgroundBlurRadius = 10;
+    layer2.layerFEState.isOpaque = false;
+
+    injectOutputLayer(layer1);
+    injectOutputLayer(layer2);
+
+    mOutput->editState().isEnabled = true;
+
+    CompositionRefreshArgs args;
+    args.updatingGeometryThisFrame = false;
+    args.devOptForceClientComposition = false;
+    mOutput->updateCompositionState(args);
+
+    layer2.layerFEState.backgroundBlurRadius = 0;
+    args.bufferOnlyUpdateThisFrame = true;
+    mOutput->updateCompositionState(args);
+}
+
 TEST_F(OutputUpdateAndWriteCompositionStateTest, handlesBlurRegionRequests) {
     InjectedLayer layer1;
     InjectedLayer layer2;
@@ -26,12 +26,14 @@
 #include <renderengine/mock/RenderEngine.h>
 #include <ui/GraphicTypes.h>
 #include <utils/Errors.h>
+#include <future>
 #include <memory>
 
 namespace android::compositionengine {
 using namespace std::chrono_literals;
 
 using testing::_;
+using testing::ByMove;
 using testing::DoAll;
 using testing::Invoke;
 using testing::Return;
@@ -382,6 +384,39 @@ TEST_F(CachedSetTest, renderUnsecureOutput) {
     cachedSet.append(CachedSet(layer3));
 }
 
+TEST_F(CachedSetTest, renderDoesNotWaitForRenderEngine) {
+    CachedSet::Layer& layer1 = *mTestLayers[1]->cachedSetLayer.get();
+    sp<mock::LayerFE> layerFE1 = mTestLayers[1]->layerFE;
+    CachedSet::Layer& layer2 = *mTestLayers[2]->cachedSetLayer.get();
+    sp<mock::LayerFE> layerFE2 = mTestLayers[2]->layerFE;
+
+    CachedSet cachedSet(layer1);
+    cachedSet.append(CachedSet(layer2));
+
+    std::optional<compositionengine::LayerFE::LayerSettings> clientComp;
+    clientComp.emplace();
+    EXPECT_CALL(*layerFE1, prepareClientComposition(_)).WillOnce(Return(clientComp));
+    EXPECT_CALL(*layerFE2, prepareClientComposition(_)).WillOnce(Return(clientComp));
+
+    std::promise<FenceResult> drawFence;
+    EXPECT_CALL(mRenderEngine, drawLayers(_, _, _, _))
+            .WillOnce(Return(ByMove(ftl::Future<FenceResult>(drawFence.get_future()))));
+    cachedSet.render(mRenderEngine, mTexturePool, mOutputState, true);
+
+    // The draw is in flight, so the cached set must not be rendered again, nor be used yet.
+    EXPECT_TRUE(cachedSet.hasRenderedBuffer());
+    EXPECT_FALSE(cachedSet.hasReadyBuffer());
+    EXPECT_EQ(nullptr, cachedSet.getBuffer());
+
+    cachedSet.finishRender();
+    EXPECT_EQ(nullptr, cachedSet.getBuffer());
+
+    drawFence.set_value(Fence::NO_FENCE);
+    cachedSet.finishRender();
+    expectReadyBuffer(cachedSet);
+    EXPECT_EQ(mOutputState.framebufferSpace, cachedSet.getOutputSpace());
+}
+
 TEST_F(CachedSetTest, renderSecureOutput) {
     // Skip the 0th layer to ensure that the bounding box of the layers is offset from (0, 0)
     CachedSet::Layer& layer1 = *mTestLayers[1]->cachedSetLayer.get();
@@ -1140,6 +1140,179 @@ TEST_F(FlattenerRenderSchedulingTest, flattenLayers_renderCachedSets_defersUpToM
                                  true);
 }
 
+class FlattenerCostModelTest : public FlattenerTest {
+public:
+    FlattenerCostModelTest() : FlattenerCostModelTest(0) {}
+
+protected:
+    FlattenerCostModelTest(size_t overlayPlaneBudget)
+          : FlattenerTest(Flattener::Tunables{.mActiveLayerTimeout = 100ms,
+                                              .mRenderScheduling = std::nullopt,
+                                              .mEnableHolePunch = true,
+                                              .mCostModel = Flattener::Tunables::CostModel{
+                                                      .overlayPlaneBudget = overlayPlaneBudget,
+                                                      .gpuCostPercent = 100}}) {}
+};
+
+class FlattenerOverlayPlaneBudgetTest : public FlattenerCostModelTest {
+public:
+    FlattenerOverlayPlaneBudgetTest() : FlattenerCostModelTest(1) {}
+};
+
+TEST_F(FlattenerCostModelTest, flattenLayers_doesNotFlattenWhenScanoutGrows) {
+    auto& layerState1 = mTestLayers[0]->layerState;
+    auto& layerState2 = mTestLayers[1]->layerState;
+
+    const std::vector<const LayerState*> layers = {
+            layerState1.get(),
+            layerState2.get(),
+    };
+
+    initializeFlattener(layers);
+
+    // The layers don't overlap, so a cached set would be larger than both of them together.
+    mTime += 200ms;
+    EXPECT_CALL(mRenderEngine, drawLayers(_, _, _, _)).Times(0);
+    for (size_t i = 0; i < 10; i++) {
+        initializeOverrideBuffer(layers);
+        EXPECT_EQ(getNonBufferHash(layers),
+                  mFlattener->flattenLayers(layers, getNonBufferHash(layers), mTime));
+        EXPECT_FALSE(mFlattener->getNewCachedSetForTesting());
+        mFlattener->renderCachedSets(mOutputState, std::nullopt, true);
+    }
+
+    std::string dump;
+    mFlattener->dump(dump);
+    EXPECT_NE(std::string::npos, dump.find("Runs rejected by cost model: 10"));
+}
+
+TEST_F(FlattenerCostModelTest, flattenLayers_flattensOnceReuseCoversRenderCost) {
+    auto& layerState1 = mTestLayers[0]->layerState;
+    auto& layerState2 = mTestLayers[1]->layerState;
+    mTestLayers[0]->outputLayerCompositionState.displayFrame = Rect(0, 0, 10, 10);
+    mTestLayers[1]->outputLayerCompositionState.displayFrame = Rect(0, 0, 10, 10);
+    layerState1->update(&mTestLayers[0]->outputLayer);
+    layerState2->update(&mTestLayers[1]->outputLayer);
+
+    const std::vector<const LayerState*> layers = {
+            layerState1.get(),
+            layerState2.get(),
+    };
+
+    initializeFlattener(layers);
+
+    // Rendering reads and writes 300 pixels to save 100 per frame, so the layers need to have
+    // been stable for more than 3 frames.
+    mTime += 200ms;
+    EXPECT_CALL(mRenderEngine, drawLayers(_, _, _, _)).Times(0);
+    for (size_t i = 0; i < 3; i++) {
+        initializeOverrideBuffer(layers);
+        EXPECT_EQ(getNonBufferHash(layers),
+                  mFlattener->flattenLayers(layers, getNonBufferHash(layers), mTime));
+        EXPECT_FALSE(mFlattener->getNewCachedSetForTesting());
+        mFlattener->renderCachedSets(mOutputState, std::nullopt, true);
+    }
+
+    expectAllLayersFlattened(layers);
+}
+
+TEST_F(FlattenerOverlayPlaneBudgetTest, flattenLayers_flattensWhenOverPlaneBudget) {
+    auto& layerState1 = mTestLayers[0]->layerState;
+    auto& layerState2 = mTestLayers[1]->layerState;
+
+    const std::vector<const LayerState*> layers = {
+            layerState1.get(),
+            layerState2.get(),
+    };
+
+    initializeFlattener(layers);
+
+    // Scanout grows, but the layers don't fit in the overlay planes.
+    mTime += 200ms;
+    expectAllLayersFlattened(layers);
+}
+
+class FlattenerKeepUnchangedCachedSetsTest : public FlattenerTest {
+public:
+    FlattenerKeepUnchangedCachedSetsTest()
+          : FlattenerTest(Flattener::Tunables{.mActiveLayerTimeout = 100ms,
+                                              .mRenderScheduling = std::nullopt,
+                                              .mEnableHolePunch = true,
+                                              .mCostModel = std::nullopt,
+                                              .mKeepUnchangedCachedSets = true}) {}
+};
+
+TEST_F(FlattenerKeepUnchangedCachedSetsTest, flattenLayers_addLayerAboveFlattenedKeepsCachedSet) {
+    auto& layerState1 = mTestLayers[0]->layerState;
+    const auto& overrideBuffer1 = layerState1->getOutputLayer()->getState().overrideInfo.buffer;
+
+    auto& layerState2 = mTestLayers[1]->layerState;
+    const auto& overrideBuffer2 = layerState2->getOutputLayer()->getState().overrideInfo.buffer;
+
+    auto& layerState3 = mTestLayers[2]->layerState;
+    const auto& overrideBuffer3 = layerState3->getOutputLayer()->getState().overrideInfo.buffer;
+
+    std::vector<const LayerState*> layers = {
+            layerState1.get(),
+            layerState2.get(),
+    };
+
+    initializeFlattener(layers);
+
+    // make all layers inactive
+    mTime += 200ms;
+    expectAllLayersFlattened(layers);
+    const auto buffer = overrideBuffer1;
+
+    // add a new layer above the flattened layers, which keeps their cached set
+    layers.push_back(layerState3.get());
+
+    initializeOverrideBuffer(layers);
+    EXPECT_NE(getNonBufferHash(layers),
+              mFlattener->flattenLayers(layers, getNonBufferHash(layers), mTime));
+    mFlattener->renderCachedSets(mOutputState, std::nullopt, true);
+
+    EXPECT_NE(nullptr, overrideBuffer1);
+    EXPECT_EQ(buffer, overrideBuffer1);
+    EXPECT_EQ(buffer, overrideBuffer2);
+    EXPECT_EQ(nullptr, overrideBuffer3);
+
+    std::string dump;
+    mFlattener->dump(dump);
+    EXPECT_NE(std::string::npos, dump.find("Cached sets kept across geometry changes: 1"));
+}
+
+TEST_F(FlattenerKeepUnchangedCachedSetsTest, flattenLayers_changedFlattenedLayerCausesReset) {
+    auto& layerState1 = mTestLayers[0]->layerState;
+    const auto& overrideBuffer1 = layerState1->getOutputLayer()->getState().overrideInfo.buffer;
+
+    auto& layerState2 = mTestLayers[1]->layerState;
+    const auto& overrideBuffer2 = layerState2->getOutputLayer()->getState().overrideInfo.buffer;
+
+    const std::vector<const LayerState*> layers = {
+            layerState1.get(),
+            layerState2.get(),
+    };
+
+    initializeFlattener(layers);
+
+    // make all layers inactive
+    mTime += 200ms;
+    expectAllLayersFlattened(layers);
+
+    // move a flattened layer, which invalidates its cached set
+    mTestLayers[0]->outputLayerCompositionState.displayFrame = Rect(5, 5, 6, 6);
+    layerState1->update(&mTestLayers[0]->outputLayer);
+
+    initializeOverrideBuffer(layers);
+    EXPECT_EQ(getNonBufferHash(layers),
+              mFlattener->flattenLayers(layers, getNonBufferHash(layers), mTime));
+    mFlattener->renderCachedSets(mOutputState, std::nullopt, true);
+
+    EXPECT_EQ(nullptr, overrideBuffer1);
+    EXPECT_EQ(nullptr, overrideBuffer2);
+}
+
 TEST_F(FlattenerTest, flattenLayers_skipsLayersDisabledFromCaching) {
     auto& layerState1 = mTestLayers[0]->layerState;
     const auto& overrideBuffer1 = layerState1->getOutputLayer()->getState().overrideInfo.buffer;
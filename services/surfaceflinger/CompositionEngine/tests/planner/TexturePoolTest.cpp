@@ -21,10 +21,13 @@
 #include <gtest/gtest.h>
 #include <log/log.h>
 #include <renderengine/mock/RenderEngine.h>
+#include <ui/MockFence.h>
 
 namespace android::compositionengine::impl::planner {
 namespace {
 
+using testing::Return;
+
 const ui::Size kDisplaySize(1, 1);
 const ui::Size kDisplaySizeTwo(2, 2);
 
@@ -35,6 +38,9 @@ public:
     size_t getMinPoolSize() const { return kMinPoolSize; }
     size_t getMaxPoolSize() const { return kMaxPoolSize; }
     size_t getPoolSize() const { return mPool.size(); }
+    void setFenceOfNextTexture(const sp<Fence>& fence) { mPool.front().fence = fence; }
+    size_t getHitCount() const { return mHitCount; }
+    size_t getMissCount() const { return mMissCount; }
 };
 
 struct TexturePoolTest : public testing::Test {
@@ -110,6 +116,32 @@ TEST_F(TexturePoolTest, goesPastMaxSizeAndRebounds) {
     EXPECT_EQ(mTexturePool.getMaxPoolSize(), newBufferIds.size());
 }
 
+TEST_F(TexturePoolTest, prefersTexturesWhichAreNotBeingDrawnTo) {
+    const auto pendingFence = sp<android::mock::MockFence>::make();
+    EXPECT_CALL(*pendingFence, getStatus()).WillRepeatedly(Return(Fence::Status::Unsignaled));
+    mTexturePool.setFenceOfNextTexture(pendingFence);
+
+    auto texture = mTexturePool.borrowTexture();
+    EXPECT_NE(pendingFence, texture->getReadyFence());
+
+    // Every other texture is borrowed, so the pending one is the only choice.
+    std::vector<std::shared_ptr<TexturePool::AutoTexture>> textures;
+    for (size_t i = 0; i < mTexturePool.getMinPoolSize() - 1; i++) {
+        textures.emplace_back(mTexturePool.borrowTexture());
+    }
+    EXPECT_EQ(pendingFence, textures.back()->getReadyFence());
+}
+
+TEST_F(TexturePoolTest, countsHitsAndMisses) {
+    std::vector<std::shared_ptr<TexturePool::AutoTexture>> textures;
+    for (size_t i = 0; i < mTexturePool.getMinPoolSize() + 1; i++) {
+        textures.emplace_back(mTexturePool.borrowTexture());
+    }
+
+    EXPECT_EQ(mTexturePool.getMinPoolSize(), mTexturePool.getHitCount());
+    EXPECT_EQ(1u, mTexturePool.getMissCount());
+}
+
 TEST_F(TexturePoolTest, reallocatesWhenDisplaySizeChanges) {
     auto texture = mTexturePool.borrowTexture();
 
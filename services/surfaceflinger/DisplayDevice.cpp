@@ -90,6 +90,9 @@ DisplayDevice::DisplayDevice(DisplayDeviceCreationArgs& args)
 
     mCompositionDisplay->setPredictCompositionStrategy(mFlinger->mPredictCompositionStrategy);
     mCompositionDisplay->setTreat170mAsSrgb(mFlinger->mTreat170mAsSrgb);
+    // The buffers of virtual displays belong to their consumer, which may write to them.
+    mCompositionDisplay->setPartialClientComposition(mFlinger->mPartialClientComposition &&
+                                                     !isVirtual());
     mCompositionDisplay->createDisplayColorProfile(
             compositionengine::DisplayColorProfileCreationArgsBuilder()
                     .setHasWideColorGamut(args.hasWideColorGamut)
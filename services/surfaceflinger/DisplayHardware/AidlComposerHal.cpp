@@ -736,7 +736,7 @@ Error AidlComposer::setClientTarget(Display display, uint32_t slot, const sp<Gra
                 .setClientTarget(translate<int64_t>(display), slot, handle, acquireFence,
                                  translate<aidl::android::hardware::graphics::common::Dataspace>(
                                          dataspace),
-                                 translate<AidlRect>(damage), hdrSdrRatio);
+                                 translateRects(display, damage), hdrSdrRatio);
     } else {
         error = Error::BAD_DISPLAY;
     }
@@ -972,7 +972,7 @@ Error AidlComposer::setLayerSurfaceDamage(Display display, Layer layer,
     mMutex.lock_shared();
     if (auto writer = getWriter(display)) {
         writer->get().setLayerSurfaceDamage(translate<int64_t>(display), translate<int64_t>(layer),
-                                            translate<AidlRect>(damage));
+                                            translateRects(display, damage));
     } else {
         error = Error::BAD_DISPLAY;
     }
@@ -1108,7 +1108,7 @@ Error AidlComposer::setLayerVisibleRegion(Display display, Layer layer,
     mMutex.lock_shared();
     if (auto writer = getWriter(display)) {
         writer->get().setLayerVisibleRegion(translate<int64_t>(display), translate<int64_t>(layer),
-                                            translate<AidlRect>(visible));
+                                            translateRects(display, visible));
     } else {
         error = Error::BAD_DISPLAY;
     }
@@ -1590,7 +1590,7 @@ Error AidlComposer::setLayerBlockingRegion(Display display, Layer layer,
     mMutex.lock_shared();
     if (auto writer = getWriter(display)) {
         writer->get().setLayerBlockingRegion(translate<int64_t>(display), translate<int64_t>(layer),
-                                             translate<AidlRect>(blocking));
+                                             translateRects(display, blocking));
     } else {
         error = Error::BAD_DISPLAY;
     }
@@ -1646,12 +1646,22 @@ ftl::Optional<std::reference_wrapper<ComposerClientReader>> AidlComposer::getRea
     return mReaders.get(display);
 }
 
+const std::vector<AidlRect>& AidlComposer::translateRects(
+        Display display, const std::vector<IComposerClient::Rect>& rects) REQUIRES_SHARED(mMutex) {
+    std::vector<AidlRect>& out = mRects.get(display).value().get();
+    out.clear();
+    std::transform(rects.begin(), rects.end(), std::back_inserter(out),
+                   [](IComposerClient::Rect rect) { return translate<AidlRect>(rect); });
+    return out;
+}
+
 void AidlComposer::removeDisplay(Display display) {
     mMutex.lock();
     bool wasErased = mWriters.erase(display);
     ALOGW_IF(!wasErased,
              "Attempting to remove writer for display %" PRId64 " which is not connected",
              translate<int64_t>(display));
+    mRects.erase(display);
     if (!mSingleReader) {
         removeReader(display);
     }
@@ -1699,6 +1709,7 @@ void AidlComposer::addDisplay(Display display) {
     auto [it, added] = mWriters.try_emplace(display, displayId);
     ALOGW_IF(!added, "Attempting to add writer for display %" PRId64 " which is already connected",
              displayId);
+    mRects.try_emplace(display);
     if (mSingleReader) {
         if (hasMultiThreadedPresentSupport(display)) {
             mSingleReader = false;
@@ -265,6 +265,10 @@ private:
             REQUIRES_SHARED(mMutex);
     ftl::Optional<std::reference_wrapper<ComposerClientReader>> getReader(Display)
             REQUIRES_SHARED(mMutex);
+    // Translates rects for the writer of the display, which copies them, into storage that is
+    // reused across frames.
+    const std::vector<aidl::android::hardware::graphics::common::Rect>& translateRects(
+            Display, const std::vector<IComposerClient::Rect>&) REQUIRES_SHARED(mMutex);
     void addDisplay(Display) EXCLUDES(mMutex);
     void removeDisplay(Display) EXCLUDES(mMutex);
     void addReader(Display) REQUIRES(mMutex);
@@ -289,6 +293,9 @@ private:
 
     ui::PhysicalDisplayMap<Display, ComposerClientWriter> mWriters GUARDED_BY(mMutex);
     ui::PhysicalDisplayMap<Display, ComposerClientReader> mReaders GUARDED_BY(mMutex);
+    // Added and removed with the writers, and only used by the thread using the writer.
+    ui::PhysicalDisplayMap<Display, std::vector<aidl::android::hardware::graphics::common::Rect>>
+            mRects GUARDED_BY(mMutex);
 
     // Protect access to mWriters and mReaders with a shared_mutex. Adding and
     // removing a display require exclusive access, since the iterator or the
@@ -685,17 +685,18 @@ void Display::setPhysicalSizeInMm(std::optional<ui::Size> size) {
 // Layer methods
 
 namespace {
-std::vector<Hwc2::IComposerClient::Rect> convertRegionToHwcRects(const Region& region) {
+// Reuses the storage of outHwcRects, so that converting regions does not allocate once it is
+// large enough.
+void convertRegionToHwcRects(const Region& region,
+                             std::vector<Hwc2::IComposerClient::Rect>& outHwcRects) {
     size_t rectCount = 0;
     Rect const* rectArray = region.getArray(&rectCount);
 
-    std::vector<Hwc2::IComposerClient::Rect> hwcRects;
-    hwcRects.reserve(rectCount);
+    outHwcRects.clear();
     for (size_t rect = 0; rect < rectCount; ++rect) {
-        hwcRects.push_back({rectArray[rect].left, rectArray[rect].top, rectArray[rect].right,
-                            rectArray[rect].bottom});
+        outHwcRects.push_back({rectArray[rect].left, rectArray[rect].top, rectArray[rect].right,
+                               rectArray[rect].bottom});
     }
-    return hwcRects;
 }
 } // namespace
 
@@ -800,8 +801,8 @@ Error Layer::setSurfaceDamage(const Region& damage)
         intError = mComposer.setLayerSurfaceDamage(mDisplay->getId(), mId,
                                                    std::vector<Hwc2::IComposerClient::Rect>());
     } else {
-        const auto hwcRects = convertRegionToHwcRects(damage);
-        intError = mComposer.setLayerSurfaceDamage(mDisplay->getId(), mId, hwcRects);
+        convertRegionToHwcRects(damage, mHwcRects);
+        intError = mComposer.setLayerSurfaceDamage(mDisplay->getId(), mId, mHwcRects);
     }
 
     return static_cast<Error>(intError);
@@ -987,8 +988,8 @@ Error Layer::setVisibleRegion(const Region& region)
         return Error::NONE;
     }
     mVisibleRegion = region;
-    const auto hwcRects = convertRegionToHwcRects(region);
-    auto intError = mComposer.setLayerVisibleRegion(mDisplay->getId(), mId, hwcRects);
+    convertRegionToHwcRects(region, mHwcRects);
+    auto intError = mComposer.setLayerVisibleRegion(mDisplay->getId(), mId, mHwcRects);
     return static_cast<Error>(intError);
 }
 
@@ -1052,8 +1053,8 @@ Error Layer::setBlockingRegion(const Region& region) {
         return Error::NONE;
     }
     mBlockingRegion = region;
-    const auto hwcRects = convertRegionToHwcRects(region);
-    const auto intError = mComposer.setLayerBlockingRegion(mDisplay->getId(), mId, hwcRects);
+    convertRegionToHwcRects(region, mHwcRects);
+    const auto intError = mComposer.setLayerBlockingRegion(mDisplay->getId(), mId, mHwcRects);
     return static_cast<Error>(intError);
 }
 
@@ -443,6 +443,9 @@ private:
     android::HdrMetadata mHdrMetadata;
     android::mat4 mColorMatrix;
     uint32_t mBufferSlot;
+
+    // Storage for the rects of the regions sent to the HWC, kept across frames.
+    std::vector<android::Hwc2::IComposerClient::Rect> mHwcRects;
 };
 
 } // namespace impl
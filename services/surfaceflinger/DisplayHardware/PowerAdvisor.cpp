@@ -330,9 +330,10 @@ void PowerAdvisor::reportActualWorkDuration() {
         ALOGV("Failed to send actual work duration, skipping");
         return;
     }
-    actualDuration->durationNanos += sTargetSafetyMargin.ns();
+    actualDuration->durationNanos += sTargetSafetyMargin.ns() + mMissedFrameHeadroom.ns();
     if (sTraceHintSessionData) {
         SFTRACE_INT64("Measured duration", actualDuration->durationNanos);
+        SFTRACE_INT64("Missed frame headroom", mMissedFrameHeadroom.ns());
         SFTRACE_INT64("Target error term", actualDuration->durationNanos - mTargetDuration.ns());
         SFTRACE_INT64("Reported duration", actualDuration->durationNanos);
         if (supportsGpuReporting()) {
@@ -545,6 +546,17 @@ void PowerAdvisor::setCommitStart(TimePoint commitStartTime) {
     mCommitStartTimes.append(commitStartTime);
 }
 
+void PowerAdvisor::setPreviousFrameMissed(bool missed) {
+    nsecs_t headroom = mMissedFrameHeadroom.ns();
+    if (missed) {
+        headroom = std::min(mTargetDuration.ns() / kMaxMissedFrameHeadroomDivisor,
+                            headroom + mTargetDuration.ns() / kMissedFrameHeadroomStepDivisor);
+    } else {
+        headroom -= headroom / kMissedFrameHeadroomDecayDivisor;
+    }
+    mMissedFrameHeadroom = Duration::fromNs(headroom);
+}
+
 void PowerAdvisor::setCompositeEnd(TimePoint compositeEndTime) {
     mLastPostcompDuration = compositeEndTime - mLastSfPresentEndTime;
 }
@@ -95,6 +95,9 @@ public:
     virtual void setFrameDelay(Duration frameDelayDuration) = 0;
     // Reports the SurfaceFlinger commit start time this frame
     virtual void setCommitStart(TimePoint commitStartTime) = 0;
+    // Reports whether the previous frame missed its expected present time, as seen by the
+    // FrameTargeter of the pacesetter display
+    virtual void setPreviousFrameMissed(bool missed) = 0;
     // Reports the SurfaceFlinger composite end time this frame
     virtual void setCompositeEnd(TimePoint compositeEndTime) = 0;
     // Reports the list of the currently active displays
@@ -142,6 +145,7 @@ public:
     void setHwcPresentDelayedTime(DisplayId displayId, TimePoint earliestFrameStartTime) override;
     void setFrameDelay(Duration frameDelayDuration) override;
     void setCommitStart(TimePoint commitStartTime) override;
+    void setPreviousFrameMissed(bool missed) override;
     void setCompositeEnd(TimePoint compositeEndTime) override;
     void setDisplays(std::vector<DisplayId>& displayIds) override;
     void setTotalFrameTargetWorkDuration(Duration targetDuration) override;
@@ -254,6 +258,10 @@ private:
     TimePoint mLastSfPresentEndTime;
     // Target duration for the entire pipeline including gpu
     std::optional<Duration> mTotalFrameTargetDuration;
+    // Padding added to the reported actual duration on top of sTargetSafetyMargin. It grows with
+    // every missed frame and decays while frames present on time, so that PowerHAL boosts harder
+    // only while SurfaceFlinger is actually missing its deadlines
+    Duration mMissedFrameHeadroom{0ns};
     // Updated list of display IDs
     std::vector<DisplayId> mDisplayIds;
 
@@ -311,6 +319,13 @@ private:
     static const Duration sTargetSafetyMargin;
     static constexpr const Duration kDefaultTargetSafetyMargin{1ms};
 
+    // The missed frame headroom grows by 1/kMissedFrameHeadroomStepDivisor of the target for each
+    // missed frame, up to 1/kMaxMissedFrameHeadroomDivisor of it, and loses
+    // 1/kMissedFrameHeadroomDecayDivisor of itself for each frame that presents on time
+    static constexpr int64_t kMissedFrameHeadroomStepDivisor = 4;
+    static constexpr int64_t kMaxMissedFrameHeadroomDivisor = 2;
+    static constexpr int64_t kMissedFrameHeadroomDecayDivisor = 8;
+
     // Whether we should send reportActualWorkDuration calls
     static const bool sUseReportActualDuration;
 
@@ -20,6 +20,7 @@
 
 // #define LOG_NDEBUG 0
 
+#include <algorithm>
 #include <cinttypes>
 
 #include <com_android_graphics_libgui_flags.h>
@@ -47,6 +48,25 @@
 
 namespace android {
 
+namespace {
+
+bool isRgbFormat(int format) {
+    switch (format) {
+        case HAL_PIXEL_FORMAT_RGBA_8888:
+        case HAL_PIXEL_FORMAT_RGBX_8888:
+        case HAL_PIXEL_FORMAT_RGB_888:
+        case HAL_PIXEL_FORMAT_RGB_565:
+        case HAL_PIXEL_FORMAT_BGRA_8888:
+        case HAL_PIXEL_FORMAT_RGBA_FP16:
+        case HAL_PIXEL_FORMAT_RGBA_1010102:
+            return true;
+        default:
+            return false;
+    }
+}
+
+} // namespace
+
 VirtualDisplaySurface::VirtualDisplaySurface(HWComposer& hwc, VirtualDisplayId displayId,
                                              const sp<IGraphicBufferProducer>& sink,
                                              const sp<IGraphicBufferProducer>& bqProducer,
@@ -96,15 +116,24 @@ VirtualDisplaySurface::VirtualDisplaySurface(HWComposer& hwc, VirtualDisplayId d
     sink->query(NATIVE_WINDOW_CONSUMER_USAGE_BITS, &sinkUsage);
     mSinkUsage |= (GRALLOC_USAGE_HW_COMPOSER | sinkUsage);
     setOutputUsage(mSinkUsage);
+    int sinkFormat;
+    sink->query(NATIVE_WINDOW_FORMAT, &sinkFormat);
     if (sinkUsage & (GRALLOC_USAGE_SW_READ_MASK | GRALLOC_USAGE_SW_WRITE_MASK)) {
-        int sinkFormat;
-        sink->query(NATIVE_WINDOW_FORMAT, &sinkFormat);
         mDefaultOutputFormat = sinkFormat;
     } else {
         mDefaultOutputFormat = HAL_PIXEL_FORMAT_IMPLEMENTATION_DEFINED;
     }
     mOutputFormat = mDefaultOutputFormat;
 
+    // The forced HWC copy of GPU-composed frames only pays off if HWC
+    // converts them to YUV on the way. Sinks that aren't video encoders and
+    // consume RGB get the GPU output directly instead.
+    if (mForceHwcCopy && !(sinkUsage & GRALLOC_USAGE_HW_VIDEO_ENCODER) &&
+        isRgbFormat(sinkFormat)) {
+        VDS_LOGV("Not forcing HWC copy for RGB sink format %d", sinkFormat);
+        mForceHwcCopy = false;
+    }
+
     ConsumerBase::mName = String8::format("VDS: %s", mDisplayName.c_str());
     mConsumer->setConsumerName(ConsumerBase::mName);
     mConsumer->setConsumerUsageBits(GRALLOC_USAGE_HW_COMPOSER);
@@ -136,6 +165,7 @@ status_t VirtualDisplaySurface::beginFrame(bool mustRecompose) {
     VDS_LOGW_IF(mDebugState != DebugState::Idle, "Unexpected %s in %s state", __func__,
                 ftl::enum_string(mDebugState).c_str());
     mDebugState = DebugState::Begun;
+    mFrameBeginTime = systemTime();
 
     return refreshOutputBuffer();
 }
@@ -158,8 +188,10 @@ status_t VirtualDisplaySurface::prepareFrame(CompositionType compositionType) {
         // directly to the consumer.
         //
         // On the other hand, when the consumer prefers RGB or can consume RGB
-        // inexpensively, this forces an unnecessary copy.
+        // inexpensively, this forces an unnecessary copy, so mForceHwcCopy is
+        // cleared for RGB sinks at construction.
         mCompositionType = CompositionType::Mixed;
+        mFrameStats.forcedHwcCopies++;
     }
 
     if (mCompositionType != mDebugLastCompositionType) {
@@ -278,6 +310,7 @@ void VirtualDisplaySurface::onFrameCommitted() {
                     &qbo);
             if (result == NO_ERROR) {
                 updateQueueBufferOutput(std::move(qbo));
+                recordFrameQueued();
             }
         } else {
             // If the surface hadn't actually been updated, then we only went
@@ -285,13 +318,33 @@ void VirtualDisplaySurface::onFrameCommitted() {
             // machine happy. We cancel the buffer to avoid triggering another
             // re-composition and causing an infinite loop.
             mSource[SOURCE_SINK]->cancelBuffer(sslot, retireFence);
+            mFrameStats.cancelled++;
         }
     }
 
     resetPerFrameState();
 }
 
-void VirtualDisplaySurface::dumpAsString(String8& /* result */) const {
+void VirtualDisplaySurface::dumpAsString(String8& result) const {
+    result.appendFormat("   VirtualDisplaySurface %s\n", mDisplayName.c_str());
+    if (GpuVirtualDisplayId::tryCast(mDisplayId)) {
+        result.append("      GPU composition directly into the sink\n");
+        return;
+    }
+
+    const FrameStats& stats = mFrameStats;
+    result.appendFormat("      sink %ux%u format=%u usage=%#" PRIx64 " forceHwcCopy=%d\n",
+                        mSinkBufferWidth, mSinkBufferHeight, mOutputFormat, mOutputUsage,
+                        mForceHwcCopy);
+    result.appendFormat("      frames queued=%zu cancelled=%zu (GPU=%zu HWC=%zu MIXED=%zu, "
+                        "forced HWC copies=%zu)\n",
+                        stats.queued, stats.cancelled, stats.gpu, stats.hwc, stats.mixed,
+                        stats.forcedHwcCopies);
+    if (stats.queued > 0) {
+        result.appendFormat("      latency to sink: last=%.3fms avg=%.3fms max=%.3fms\n",
+                            stats.lastLatency / 1e6, stats.totalLatency / stats.queued / 1e6,
+                            stats.maxLatency / 1e6);
+    }
 }
 
 void VirtualDisplaySurface::resizeBuffers(const ui::Size& newSize) {
@@ -628,6 +681,29 @@ void VirtualDisplaySurface::updateQueueBufferOutput(
     mQueueBufferOutput.transformHint = 0;
 }
 
+void VirtualDisplaySurface::recordFrameQueued() {
+    FrameStats& stats = mFrameStats;
+    stats.queued++;
+    switch (mCompositionType) {
+        case CompositionType::Gpu:
+            stats.gpu++;
+            break;
+        case CompositionType::Hwc:
+            stats.hwc++;
+            break;
+        case CompositionType::Mixed:
+            stats.mixed++;
+            break;
+        default:
+            break;
+    }
+
+    const nsecs_t latency = systemTime() - mFrameBeginTime;
+    stats.lastLatency = latency;
+    stats.totalLatency += latency;
+    stats.maxLatency = std::max(stats.maxLatency, latency);
+}
+
 void VirtualDisplaySurface::resetPerFrameState() {
     mCompositionType = CompositionType::Unknown;
     mFbFence = Fence::NO_FENCE;
@@ -147,6 +147,7 @@ private:
     void updateQueueBufferOutput(QueueBufferOutput&&);
     void resetPerFrameState();
     status_t refreshOutputBuffer();
+    void recordFrameQueued();
 
     // Both the sink and scratch buffer pools have their own set of slots
     // ("source slots", or "sslot"). We have to merge these into the single
@@ -266,6 +267,24 @@ private:
 
     bool mMustRecompose = false;
 
+    // Time beginFrame() was called for the current frame.
+    nsecs_t mFrameBeginTime = 0;
+
+    // Counters reported by dumpAsString(). Latencies are measured from
+    // beginFrame() to queueing the composed buffer to the sink.
+    struct FrameStats {
+        size_t queued = 0;
+        size_t cancelled = 0;
+        size_t gpu = 0;
+        size_t hwc = 0;
+        size_t mixed = 0;
+        size_t forcedHwcCopies = 0;
+        nsecs_t totalLatency = 0;
+        nsecs_t maxLatency = 0;
+        nsecs_t lastLatency = 0;
+    };
+    FrameStats mFrameStats;
+
     bool mForceHwcCopy;
     bool mSecure;
     int mSinkUsage;
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <android-base/stringprintf.h>
+#include <ftl/enum.h>
+
+#include <algorithm>
+#include <cinttypes>
+
+#include "FramePhaseTracker.h"
+
+namespace android {
+
+namespace {
+
+// The number of recent frames listed individually by dump.
+constexpr size_t kDumpedFrameCount = 16;
+
+float toMillis(nsecs_t duration) {
+    return static_cast<float>(duration) / 1e6f;
+}
+
+} // namespace
+
+void FramePhaseTracker::addDuration(int64_t vsyncId, FramePhase phase, nsecs_t duration) {
+    if (mFrameCount == 0 || mFrames[mOffset].vsyncId != vsyncId) {
+        if (mFrameCount != 0) {
+            mOffset = (mOffset + 1) % kFrameCount;
+        }
+        mFrameCount = std::min(mFrameCount + 1, kFrameCount);
+        mFrames[mOffset] = {.vsyncId = vsyncId};
+    }
+    mFrames[mOffset].durations[static_cast<size_t>(phase)] += duration;
+}
+
+const FramePhaseTracker::FrameRecord* FramePhaseTracker::getFrame(size_t offset) const {
+    if (offset >= mFrameCount) {
+        return nullptr;
+    }
+    return &mFrames[(mOffset + kFrameCount - offset) % kFrameCount];
+}
+
+void FramePhaseTracker::dump(std::string& result) const {
+    using base::StringAppendF;
+
+    StringAppendF(&result, "Frame phases over the last %zu frames (ms)\n", mFrameCount);
+    if (mFrameCount == 0) {
+        return;
+    }
+
+    for (size_t phase = 0; phase < kPhaseCount; phase++) {
+        nsecs_t total = 0;
+        nsecs_t worst = 0;
+        for (size_t i = 0; i < mFrameCount; i++) {
+            const nsecs_t duration = getFrame(i)->durations[phase];
+            total += duration;
+            worst = std::max(worst, duration);
+        }
+        StringAppendF(&result, "  %-20s avg %7.3f  max %7.3f\n",
+                      ftl::enum_string(static_cast<FramePhase>(phase)).c_str(),
+                      toMillis(total / static_cast<nsecs_t>(mFrameCount)), toMillis(worst));
+    }
+
+    StringAppendF(&result, "\n  %-12s", "vsyncId");
+    for (size_t phase = 0; phase < kPhaseCount; phase++) {
+        StringAppendF(&result, " %20s", ftl::enum_string(static_cast<FramePhase>(phase)).c_str());
+    }
+    result.append("\n");
+    for (size_t i = 0; i < std::min(mFrameCount, kDumpedFrameCount); i++) {
+        const FrameRecord& frame = *getFrame(i);
+        StringAppendF(&result, "  %-12" PRId64, frame.vsyncId);
+        for (const nsecs_t duration : frame.durations) {
+            StringAppendF(&result, " %20.3f", toMillis(duration));
+        }
+        result.append("\n");
+    }
+}
+
+} // namespace android
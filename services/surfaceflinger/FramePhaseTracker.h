@@ -0,0 +1,91 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <utils/Timers.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace android {
+
+// The parts of a frame whose main thread time is tracked.
+enum class FramePhase : size_t {
+    TransactionFlush,
+    LayerLifecycle,
+    SnapshotBuild,
+    WindowInfos,
+    CompositionPresent,
+    PostComposition,
+    ftl_last = PostComposition
+};
+
+// FramePhaseTracker keeps how long each phase of the most recent frames took, so that a
+// regression in one of them shows up in a bugreport without a trace. The phases are timed on
+// the main thread, and the tracker is *NOT* thread-safe, so it must only be dumped from there.
+class FramePhaseTracker {
+public:
+    // The number of frames kept in the circular buffer.
+    static constexpr size_t kFrameCount = 128;
+
+    static constexpr size_t kPhaseCount = static_cast<size_t>(FramePhase::ftl_last) + 1;
+
+    // Times a phase of the frame with the given vsync id until the end of the scope.
+    class ScopedPhase {
+    public:
+        ScopedPhase(FramePhaseTracker& tracker, int64_t vsyncId, FramePhase phase)
+              : mTracker(tracker), mVsyncId(vsyncId), mPhase(phase), mStart(systemTime()) {}
+        ~ScopedPhase() { mTracker.addDuration(mVsyncId, mPhase, systemTime() - mStart); }
+
+        ScopedPhase(const ScopedPhase&) = delete;
+        ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+    private:
+        FramePhaseTracker& mTracker;
+        const int64_t mVsyncId;
+        const FramePhase mPhase;
+        const nsecs_t mStart;
+    };
+
+    // Adds duration to a phase of the frame with the given vsync id. A vsync id other than
+    // the current frame's starts a new frame, overwriting the oldest one.
+    void addDuration(int64_t vsyncId, FramePhase phase, nsecs_t duration);
+
+    // Appends the average and worst duration of each phase, followed by the recent frames.
+    void dump(std::string& result) const;
+
+    struct FrameRecord {
+        int64_t vsyncId = 0;
+        std::array<nsecs_t, kPhaseCount> durations{};
+    };
+
+    // Returns the frame recorded offset frames ago, or nullptr if there is none.
+    const FrameRecord* getFrame(size_t offset = 0) const;
+
+private:
+    std::array<FrameRecord, kFrameCount> mFrames;
+
+    // The index of the current frame in mFrames.
+    size_t mOffset = 0;
+
+    // The number of frames recorded so far, up to kFrameCount.
+    size_t mFrameCount = 0;
+};
+
+} // namespace android
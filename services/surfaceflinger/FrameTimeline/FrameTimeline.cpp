@@ -888,19 +888,17 @@ namespace impl {
 int64_t TokenManager::generateTokenForPredictions(TimelineItem&& predictions) {
     SFTRACE_CALL();
     std::scoped_lock lock(mMutex);
-    while (mPredictions.size() >= kMaxTokens) {
-        mPredictions.erase(mPredictions.begin());
-    }
     const int64_t assignedToken = mCurrentToken++;
-    mPredictions[assignedToken] = predictions;
+    mPredictions[static_cast<uint64_t>(assignedToken) % kMaxTokens] = {assignedToken,
+                                                                       std::move(predictions)};
     return assignedToken;
 }
 
 std::optional<TimelineItem> TokenManager::getPredictionsForToken(int64_t token) const {
     std::scoped_lock lock(mMutex);
-    auto predictionsIterator = mPredictions.find(token);
-    if (predictionsIterator != mPredictions.end()) {
-        return predictionsIterator->second;
+    const auto& slot = mPredictions[static_cast<uint64_t>(token) % kMaxTokens];
+    if (token != FrameTimelineInfo::INVALID_VSYNC_ID && slot.token == token) {
+        return slot.predictions;
     }
     return {};
 }
@@ -1480,38 +1478,30 @@ void FrameTimeline::flushPendingPresentFences() {
             : 0;
 
     // Present fences are expected to be signaled in order. Mark all the previous
-    // pending fences as errors.
-    for (size_t i = 0; i < firstSignaledFence.value(); i++) {
-        const auto& pendingPresentFence = *mPendingPresentFences.begin();
-        const nsecs_t signalTime = Fence::SIGNAL_TIME_INVALID;
-        auto& displayFrame = pendingPresentFence.second;
-        displayFrame->onPresent(signalTime, mPreviousActualPresentTime);
-        mPreviousPredictionPresentTime =
-                displayFrame->trace(mSurfaceFlingerPid, monoBootOffset,
-                                    mPreviousPredictionPresentTime, mFilterFramesBeforeTraceStarts);
-        mPendingPresentFences.erase(mPendingPresentFences.begin());
-    }
-
-    for (size_t i = 0; i < mPendingPresentFences.size(); i++) {
-        const auto& pendingPresentFence = mPendingPresentFences[i];
+    // pending fences as errors. Then present the frames up to the first fence which is still
+    // pending, and remove them all from the queue at once.
+    size_t flushedCount = 0;
+    for (; flushedCount < mPendingPresentFences.size(); flushedCount++) {
+        const auto& [fence, displayFrame] = mPendingPresentFences[flushedCount];
+        const bool isMissed = flushedCount < firstSignaledFence.value();
         nsecs_t signalTime = Fence::SIGNAL_TIME_INVALID;
-        if (pendingPresentFence.first && pendingPresentFence.first->isValid()) {
-            signalTime = pendingPresentFence.first->getSignalTime();
+        if (!isMissed && fence && fence->isValid()) {
+            signalTime = fence->getSignalTime();
             if (signalTime == Fence::SIGNAL_TIME_PENDING) {
                 break;
             }
         }
 
-        auto& displayFrame = pendingPresentFence.second;
         displayFrame->onPresent(signalTime, mPreviousActualPresentTime);
         mPreviousPredictionPresentTime =
                 displayFrame->trace(mSurfaceFlingerPid, monoBootOffset,
                                     mPreviousPredictionPresentTime, mFilterFramesBeforeTraceStarts);
-        mPreviousActualPresentTime = signalTime;
-
-        mPendingPresentFences.erase(mPendingPresentFences.begin() + static_cast<int>(i));
-        --i;
+        if (!isMissed) {
+            mPreviousActualPresentTime = signalTime;
+        }
     }
+    mPendingPresentFences.erase(mPendingPresentFences.begin(),
+                                mPendingPresentFences.begin() + static_cast<int>(flushedCount));
 }
 
 void FrameTimeline::finalizeCurrentDisplayFrame() {
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <deque>
@@ -361,10 +362,19 @@ private:
 
     void flushTokens(nsecs_t flushTime) REQUIRES(mMutex);
 
-    std::map<int64_t, TimelineItem> mPredictions GUARDED_BY(mMutex);
+    static constexpr size_t kMaxTokens = 500;
+
+    struct TokenPredictions {
+        int64_t token = FrameTimelineInfo::INVALID_VSYNC_ID;
+        TimelineItem predictions;
+    };
+
+    // Tokens are generated in sequence, so the predictions of a token are kept in slot
+    // token % kMaxTokens until it is reused kMaxTokens tokens later. Unlike a map, this doesn't
+    // allocate, and binder threads looking up a token only hold mMutex for a copy.
+    std::array<TokenPredictions, kMaxTokens> mPredictions GUARDED_BY(mMutex);
     int64_t mCurrentToken GUARDED_BY(mMutex);
     mutable std::mutex mMutex;
-    static constexpr size_t kMaxTokens = 500;
 };
 
 class FrameTimeline : public android::frametimeline::FrameTimeline {
@@ -19,6 +19,7 @@
 #undef LOG_TAG
 #define LOG_TAG "SurfaceFlinger"
 
+#include <algorithm>
 #include <numeric>
 #include <optional>
 
@@ -35,6 +36,7 @@
 #include "LayerSnapshotBuilder.h"
 #include "TimeStats/TimeStats.h"
 #include "Tracing/TransactionTracing.h"
+#include "WorkerPool.h"
 
 namespace android::surfaceflinger::frontend {
 
@@ -331,6 +333,19 @@ uint32_t getPrimaryDisplayRotationFlags(
     return 0;
 }
 
+// Whether the only changes to the layer since the last update are a new buffer and the state which
+// comes with every buffer.
+bool isBufferOnlyChange(const RequestedLayerState& requested) {
+    constexpr uint64_t kBufferOnlyChanges = layer_state_t::eBufferChanged |
+            layer_state_t::eSurfaceDamageRegionChanged |
+            layer_state_t::eHasListenerCallbacksChanged |
+            layer_state_t::eBufferReleaseChannelChanged;
+    return (requested.what & ~kBufferOnlyChanges) == 0 &&
+            (requested.changes.get() &
+             ~(RequestedLayerState::Changes::Content | RequestedLayerState::Changes::Buffer)
+                      .get()) == 0;
+}
+
 } // namespace
 
 LayerSnapshot LayerSnapshotBuilder::getRootSnapshot() {
@@ -367,9 +382,20 @@ LayerSnapshot LayerSnapshotBuilder::getRootSnapshot() {
 
 LayerSnapshotBuilder::LayerSnapshotBuilder() {}
 
+LayerSnapshotBuilder::~LayerSnapshotBuilder() = default;
+
 LayerSnapshotBuilder::LayerSnapshotBuilder(Args args) : LayerSnapshotBuilder() {
     args.forceUpdate = ForceUpdateFlags::ALL;
     updateSnapshots(args);
+    updateInterestingSnapshotFlags();
+}
+
+void LayerSnapshotBuilder::setTraversalThreadCount(size_t threadCount) {
+    const size_t workerCount = threadCount > 1 ? threadCount - 1 : 0;
+    if (workerCount == (mWorkerPool ? mWorkerPool->getThreadCount() : 0)) {
+        return;
+    }
+    mWorkerPool = workerCount > 0 ? std::make_unique<WorkerPool>(workerCount) : nullptr;
 }
 
 bool LayerSnapshotBuilder::tryFastUpdate(const Args& args) {
@@ -397,11 +423,18 @@ bool LayerSnapshotBuilder::tryFastUpdate(const Args& args) {
     }
 
     // Walk through all the updated requested layer states and update the corresponding snapshots.
+    bool bufferOnly = true;
     for (const RequestedLayerState* requested : args.layerLifecycleManager.getChangedLayers()) {
+        bufferOnly &= isBufferOnlyChange(*requested);
         auto range = mIdToSnapshots.equal_range(requested->id);
         for (auto it = range.first; it != range.second; it++) {
-            it->second->merge(*requested, forceUpdate, args.displayChanges, args.forceFullDamage,
-                              primaryDisplayRotationFlags);
+            LayerSnapshot& snapshot = *it->second;
+            const bool wasOpaque = snapshot.isOpaque;
+            const bool wasForcingClientComposition = snapshot.forceClientComposition;
+            snapshot.merge(*requested, forceUpdate, args.displayChanges, args.forceFullDamage,
+                           primaryDisplayRotationFlags);
+            bufferOnly &= snapshot.isOpaque == wasOpaque &&
+                    snapshot.forceClientComposition == wasForcingClientComposition;
         }
     }
 
@@ -412,6 +445,7 @@ bool LayerSnapshotBuilder::tryFastUpdate(const Args& args) {
         // No fast path for you.
         return false;
     }
+    mLastUpdateBufferOnly = bufferOnly;
     return true;
 }
 
@@ -433,9 +467,17 @@ void LayerSnapshotBuilder::updateSnapshots(const Args& args) {
         rootSnapshot.clientChanges |= layer_state_t::eReparent;
     }
 
-    for (auto& snapshot : mSnapshots) {
-        if (snapshot->reachablilty == LayerSnapshot::Reachablilty::Reachable) {
-            snapshot->reachablilty = LayerSnapshot::Reachablilty::Unreachable;
+    mVisitedSnapshots = 0;
+    mSkippedSubtrees = 0;
+    mSkipUnchangedSubtrees = canSkipUnchangedSubtrees(args);
+    if (mSkipUnchangedSubtrees) {
+        // Without hierarchy changes, every snapshot stays as reachable as it was.
+        updateDirtyLayerIds(args);
+    } else {
+        for (auto& snapshot : mSnapshots) {
+            if (snapshot->reachablilty == LayerSnapshot::Reachablilty::Reachable) {
+                snapshot->reachablilty = LayerSnapshot::Reachablilty::Unreachable;
+            }
         }
     }
 
@@ -446,7 +488,7 @@ void LayerSnapshotBuilder::updateSnapshots(const Args& args) {
         LayerHierarchy::ScopedAddToTraversalPath addChildToPath(root, args.root.getLayer()->id,
                                                                 LayerHierarchy::Variant::Attached);
         updateSnapshotsInHierarchy(args, args.root, root, rootSnapshot, /*depth=*/0);
-    } else {
+    } else if (!updateRootSubtreesInParallel(args, rootSnapshot)) {
         for (auto& [childHierarchy, variant] : args.root.mChildren) {
             LayerHierarchy::ScopedAddToTraversalPath addChildToPath(root,
                                                                     childHierarchy->getLayer()->id,
@@ -497,21 +539,86 @@ void LayerSnapshotBuilder::updateSnapshots(const Args& args) {
                 });
         mIdToSnapshots.erase(matchingSnapshot);
         mNeedsTouchableRegionCrop.erase(traversalPath);
+        if (isClone) {
+            mCloneSnapshotCount--;
+        }
         mSnapshots.back()->globalZ = it->get()->globalZ;
         std::iter_swap(it, mSnapshots.end() - 1);
         mSnapshots.erase(mSnapshots.end() - 1);
     }
 }
 
+bool LayerSnapshotBuilder::canSkipUnchangedSubtrees(const Args& args) const {
+    return args.forceUpdate == ForceUpdateFlags::NONE && !args.displayChanges &&
+            !args.layerLifecycleManager.getGlobalChanges().any(
+                    RequestedLayerState::Changes::Hierarchy) &&
+            mCloneSnapshotCount == 0;
+}
+
+void LayerSnapshotBuilder::updateDirtyLayerIds(const Args& args) {
+    mDirtyLayerIds.clear();
+    std::vector<uint32_t> pendingLayerIds;
+    for (const RequestedLayerState* requested : args.layerLifecycleManager.getChangedLayers()) {
+        pendingLayerIds.push_back(requested->id);
+    }
+    while (!pendingLayerIds.empty()) {
+        const uint32_t layerId = pendingLayerIds.back();
+        pendingLayerIds.pop_back();
+        if (!mDirtyLayerIds.insert(layerId).second) {
+            continue;
+        }
+        const RequestedLayerState* requested =
+                args.layerLifecycleManager.getLayerFromId(layerId);
+        if (!requested) continue;
+        if (requested->parentId != UNASSIGNED_LAYER_ID) {
+            pendingLayerIds.push_back(requested->parentId);
+        }
+        if (requested->relativeParentId != UNASSIGNED_LAYER_ID) {
+            pendingLayerIds.push_back(requested->relativeParentId);
+        }
+    }
+}
+
+LayerSnapshot* LayerSnapshotBuilder::getUnchangedSubtreeSnapshot(
+        const LayerHierarchy::TraversalPath& path, const LayerSnapshot& parentSnapshot) const {
+    if (!mSkipUnchangedSubtrees || mDirtyLayerIds.find(path.id) != mDirtyLayerIds.end()) {
+        return nullptr;
+    }
+    // Same as the changes updateSnapshot passes down to the children.
+    const ftl::Flags<RequestedLayerState::Changes> parentChanges = parentSnapshot.changes &
+            (RequestedLayerState::Changes::Hierarchy | RequestedLayerState::Changes::Geometry |
+             RequestedLayerState::Changes::Visibility | RequestedLayerState::Changes::Metadata |
+             RequestedLayerState::Changes::AffectsChildren | RequestedLayerState::Changes::Input |
+             RequestedLayerState::Changes::FrameRate | RequestedLayerState::Changes::GameMode);
+    if (parentChanges.any() ||
+        (parentSnapshot.clientChanges &
+         (layer_state_t::AFFECTS_CHILDREN | layer_state_t::eEdgeExtensionChanged))) {
+        return nullptr;
+    }
+    LayerSnapshot* snapshot = getSnapshot(path);
+    // Edge extensions are reapplied on every update.
+    if (!snapshot || snapshot->changes.any() || snapshot->clientChanges ||
+        snapshot->edgeExtensionEffect.hasEffect()) {
+        return nullptr;
+    }
+    return snapshot;
+}
+
+LayerSnapshotBuilder::TraversalStats LayerSnapshotBuilder::getLastTraversalStats() const {
+    return {.visitedSnapshots = mVisitedSnapshots, .skippedSubtrees = mSkippedSubtrees};
+}
+
 void LayerSnapshotBuilder::update(const Args& args) {
     for (auto& snapshot : mSnapshots) {
         clearChanges(*snapshot);
     }
 
-    if (tryFastUpdate(args)) {
-        return;
+    mLastUpdateBufferOnly = false;
+
+    if (!tryFastUpdate(args)) {
+        updateSnapshots(args);
     }
-    updateSnapshots(args);
+    updateInterestingSnapshotFlags();
 }
 
 const LayerSnapshot& LayerSnapshotBuilder::updateSnapshotsInHierarchy(
@@ -522,16 +629,15 @@ const LayerSnapshot& LayerSnapshotBuilder::updateSnapshotsInHierarchy(
                                     "Cycle detected in LayerSnapshotBuilder. See "
                                     "builder_stack_overflow_transactions.winscope");
 
-    const RequestedLayerState* layer = hierarchy.getLayer();
-    LayerSnapshot* snapshot = getSnapshot(traversalPath);
-    const bool newSnapshot = snapshot == nullptr;
-    uint32_t primaryDisplayRotationFlags = getPrimaryDisplayRotationFlags(args.displays);
-    if (newSnapshot) {
-        snapshot = createSnapshot(traversalPath, *layer, parentSnapshot);
-        snapshot->merge(*layer, /*forceUpdate=*/true, /*displayChanges=*/true, args.forceFullDamage,
-                        primaryDisplayRotationFlags);
-        snapshot->changes |= RequestedLayerState::Changes::Created;
+    if (LayerSnapshot* unchangedSnapshot =
+                getUnchangedSubtreeSnapshot(traversalPath, parentSnapshot)) {
+        mSkippedSubtrees++;
+        return *unchangedSnapshot;
     }
+    mVisitedSnapshots++;
+
+    const RequestedLayerState* layer = hierarchy.getLayer();
+    LayerSnapshot* snapshot = getOrCreateSnapshot(args, traversalPath, *layer, parentSnapshot);
 
     if (traversalPath.isRelative()) {
         bool parentIsRelative = traversalPath.variant == LayerHierarchy::Variant::Relative;
@@ -558,6 +664,100 @@ const LayerSnapshot& LayerSnapshotBuilder::updateSnapshotsInHierarchy(
     return *snapshot;
 }
 
+bool LayerSnapshotBuilder::updateRootSubtreesInParallel(const Args& args,
+                                                        const LayerSnapshot& rootSnapshot) {
+    const size_t rootCount = args.root.mChildren.size();
+    if (!mWorkerPool || rootCount < 2) {
+        return false;
+    }
+    SFTRACE_NAME("UpdateRootSubtreesInParallel");
+
+    // Create the missing snapshots up front, in the order in which the serial traversal would
+    // have, so that the snapshot list and the ids given to clones do not depend on the thread
+    // timing. The same pass finds the root subtrees which visit a common snapshot, and groups
+    // them so that such a snapshot is only ever updated by one thread.
+    std::unordered_map<const LayerSnapshot*, size_t> owners;
+    owners.reserve(mSnapshots.size());
+    std::vector<size_t> groups(rootCount);
+    std::iota(groups.begin(), groups.end(), 0);
+    LayerHierarchy::TraversalPath root = LayerHierarchy::TraversalPath::ROOT;
+    for (size_t i = 0; i < rootCount; i++) {
+        auto& [childHierarchy, variant] = args.root.mChildren[i];
+        LayerHierarchy::ScopedAddToTraversalPath addChildToPath(root,
+                                                                childHierarchy->getLayer()->id,
+                                                                variant);
+        if (!prepareSnapshotsInHierarchy(args, *childHierarchy, root, rootSnapshot,
+                                         /*depth=*/0, i, owners, groups)) {
+            return false;
+        }
+    }
+
+    // Each task updates the root subtrees of one group, in their original order.
+    std::vector<std::vector<size_t>> rootsByGroup(rootCount);
+    for (size_t i = 0; i < rootCount; i++) {
+        size_t group = i;
+        while (groups[group] != group) {
+            group = groups[group];
+        }
+        rootsByGroup[group].push_back(i);
+    }
+    std::vector<std::function<void()>> tasks;
+    for (const auto& roots : rootsByGroup) {
+        if (roots.empty()) continue;
+        tasks.emplace_back([this, &args, &rootSnapshot, &roots]() {
+            LayerHierarchy::TraversalPath path = LayerHierarchy::TraversalPath::ROOT;
+            for (size_t i : roots) {
+                auto& [childHierarchy, variant] = args.root.mChildren[i];
+                LayerHierarchy::ScopedAddToTraversalPath addChildToPath(path,
+                                                                        childHierarchy->getLayer()
+                                                                                ->id,
+                                                                        variant);
+                updateSnapshotsInHierarchy(args, *childHierarchy, path, rootSnapshot,
+                                           /*depth=*/0);
+            }
+        });
+    }
+    mWorkerPool->run(tasks);
+    return true;
+}
+
+bool LayerSnapshotBuilder::prepareSnapshotsInHierarchy(
+        const Args& args, const LayerHierarchy& hierarchy,
+        LayerHierarchy::TraversalPath& traversalPath, const LayerSnapshot& parentSnapshot,
+        int depth, size_t rootIndex, std::unordered_map<const LayerSnapshot*, size_t>& owners,
+        std::vector<size_t>& groups) {
+    if (depth > 50) {
+        // Let the serial traversal report the cycle.
+        return false;
+    }
+
+    const LayerSnapshot* snapshot =
+            getOrCreateSnapshot(args, traversalPath, *hierarchy.getLayer(), parentSnapshot);
+    auto [it, inserted] = owners.emplace(snapshot, rootIndex);
+    if (!inserted && it->second != rootIndex) {
+        size_t a = it->second;
+        while (groups[a] != a) {
+            a = groups[a];
+        }
+        size_t b = rootIndex;
+        while (groups[b] != b) {
+            b = groups[b];
+        }
+        groups[std::max(a, b)] = std::min(a, b);
+    }
+
+    for (auto& [childHierarchy, variant] : hierarchy.mChildren) {
+        LayerHierarchy::ScopedAddToTraversalPath addChildToPath(traversalPath,
+                                                                childHierarchy->getLayer()->id,
+                                                                variant);
+        if (!prepareSnapshotsInHierarchy(args, *childHierarchy, traversalPath, *snapshot,
+                                         depth + 1, rootIndex, owners, groups)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 LayerSnapshot* LayerSnapshotBuilder::getSnapshot(uint32_t layerId) const {
     if (layerId == UNASSIGNED_LAYER_ID) {
         return nullptr;
@@ -583,11 +783,29 @@ LayerSnapshot* LayerSnapshotBuilder::createSnapshot(const LayerHierarchy::Traver
     snapshot->ignoreLocalTransform =
             path.isClone() && path.variant == LayerHierarchy::Variant::Detached_Mirror;
     mPathToSnapshot[path] = snapshot;
+    if (path.isClone()) {
+        mCloneSnapshotCount++;
+    }
 
     mIdToSnapshots.emplace(path.id, snapshot);
     return snapshot;
 }
 
+LayerSnapshot* LayerSnapshotBuilder::getOrCreateSnapshot(const Args& args,
+                                                         const LayerHierarchy::TraversalPath& path,
+                                                         const RequestedLayerState& layer,
+                                                         const LayerSnapshot& parentSnapshot) {
+    LayerSnapshot* snapshot = getSnapshot(path);
+    if (snapshot) {
+        return snapshot;
+    }
+    snapshot = createSnapshot(path, layer, parentSnapshot);
+    snapshot->merge(layer, /*forceUpdate=*/true, /*displayChanges=*/true, args.forceFullDamage,
+                    getPrimaryDisplayRotationFlags(args.displays));
+    snapshot->changes |= RequestedLayerState::Changes::Created;
+    return snapshot;
+}
+
 bool LayerSnapshotBuilder::sortSnapshotsByZ(const Args& args) {
     if (!mResortSnapshots && args.forceUpdate == ForceUpdateFlags::NONE &&
         !args.layerLifecycleManager.getGlobalChanges().any(
@@ -1176,6 +1394,7 @@ void LayerSnapshotBuilder::updateInput(LayerSnapshot& snapshot,
     }
 
     if (requested.touchCropId != UNASSIGNED_LAYER_ID || path.isClone()) {
+        std::scoped_lock lock{mNeedsTouchableRegionCropMutex};
         mNeedsTouchableRegionCrop.insert(path);
     }
     auto cropLayerSnapshot = getSnapshot(requested.touchCropId);
@@ -1208,11 +1427,19 @@ std::vector<std::unique_ptr<LayerSnapshot>>& LayerSnapshotBuilder::getSnapshots(
     return mSnapshots;
 }
 
+void LayerSnapshotBuilder::updateInterestingSnapshotFlags() {
+    mInterestingSnapshotFlags.resize((size_t)mNumInterestingSnapshots);
+    for (size_t i = 0; i < mInterestingSnapshotFlags.size(); i++) {
+        const LayerSnapshot& snapshot = *mSnapshots[i];
+        mInterestingSnapshotFlags[i] = {.isVisible = snapshot.isVisible,
+                                        .hasInputInfo = snapshot.hasInputInfo()};
+    }
+}
+
 void LayerSnapshotBuilder::forEachVisibleSnapshot(const ConstVisitor& visitor) const {
-    for (int i = 0; i < mNumInterestingSnapshots; i++) {
-        LayerSnapshot& snapshot = *mSnapshots[(size_t)i];
-        if (!snapshot.isVisible) continue;
-        visitor(snapshot);
+    for (size_t i = 0; i < mInterestingSnapshotFlags.size(); i++) {
+        if (!mInterestingSnapshotFlags[i].isVisible) continue;
+        visitor(*mSnapshots[i]);
     }
 }
 
@@ -1231,10 +1458,9 @@ void LayerSnapshotBuilder::forEachVisibleSnapshot(const ConstVisitor& visitor,
 }
 
 void LayerSnapshotBuilder::forEachVisibleSnapshot(const Visitor& visitor) {
-    for (int i = 0; i < mNumInterestingSnapshots; i++) {
-        std::unique_ptr<LayerSnapshot>& snapshot = mSnapshots.at((size_t)i);
-        if (!snapshot->isVisible) continue;
-        visitor(snapshot);
+    for (size_t i = 0; i < mInterestingSnapshotFlags.size(); i++) {
+        if (!mInterestingSnapshotFlags[i].isVisible) continue;
+        visitor(mSnapshots.at(i));
     }
 }
 
@@ -1254,10 +1480,9 @@ void LayerSnapshotBuilder::forEachSnapshot(const ConstVisitor& visitor) const {
 }
 
 void LayerSnapshotBuilder::forEachInputSnapshot(const ConstVisitor& visitor) const {
-    for (int i = mNumInterestingSnapshots - 1; i >= 0; i--) {
-        LayerSnapshot& snapshot = *mSnapshots[(size_t)i];
-        if (!snapshot.hasInputInfo()) continue;
-        visitor(snapshot);
+    for (size_t i = mInterestingSnapshotFlags.size(); i-- > 0;) {
+        if (!mInterestingSnapshotFlags[i].hasInputInfo) continue;
+        visitor(*mSnapshots[i]);
     }
 }
 
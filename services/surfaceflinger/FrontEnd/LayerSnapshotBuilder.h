@@ -22,8 +22,14 @@
 #include "LayerSnapshot.h"
 #include "RequestedLayerState.h"
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+
 namespace android::surfaceflinger::frontend {
 
+class WorkerPool;
+
 // Walks through the layer hierarchy to build an ordered list
 // of LayerSnapshots that can be passed on to CompositionEngine.
 // This builder does a minimum amount of work to update
@@ -61,10 +67,17 @@ public:
         LayerSnapshot rootSnapshot = getRootSnapshot();
     };
     LayerSnapshotBuilder();
+    ~LayerSnapshotBuilder();
 
     // Rebuild the snapshots from scratch.
     LayerSnapshotBuilder(Args);
 
+    // Updates the subtrees of the root layers on up to threadCount threads, including the
+    // calling thread. Root subtrees which share snapshots, for example through relative z, are
+    // updated together on one thread. The resulting snapshots are the same as with a single
+    // thread, which is the default.
+    void setTraversalThreadCount(size_t threadCount);
+
     // Update an existing set of snapshot using change flags in RequestedLayerState
     // and LayerLifecycleManager. This needs to be called before
     // LayerLifecycleManager.commitChanges is called as that function will clear all
@@ -97,6 +110,20 @@ public:
     // Visit each snapshot interesting to input reverse z-order
     void forEachInputSnapshot(const ConstVisitor& visitor) const;
 
+    struct TraversalStats {
+        // Snapshots updated by the last traversal of the hierarchy.
+        size_t visitedSnapshots = 0;
+        // Subtrees the last traversal skipped because nothing in them changed.
+        size_t skippedSubtrees = 0;
+    };
+    // Returns the stats of the last update which had to traverse the hierarchy.
+    TraversalStats getLastTraversalStats() const;
+
+    // Returns true if the last update only latched new buffers on existing layers, without
+    // changing their opacity or whether they are forced to client composition. CompositionEngine
+    // can then reuse the composition state it derived from the layer stack for the last frame.
+    bool isLastUpdateBufferOnly() const { return mLastUpdateBufferOnly; }
+
 private:
     friend class LayerSnapshotTest;
 
@@ -105,6 +132,26 @@ private:
     bool tryFastUpdate(const Args& args);
 
     void updateSnapshots(const Args& args);
+    // Returns true if the traversal only needs to visit the subtrees with changed layers.
+    bool canSkipUnchangedSubtrees(const Args& args) const;
+    // Collects the changed layers along with their parents and relative parents, which are the
+    // layers the traversal has to visit to reach them.
+    void updateDirtyLayerIds(const Args& args);
+    // Returns the snapshot of the subtree if it can be skipped, because none of its layers
+    // changed and its parent has no changes which are passed down to children.
+    LayerSnapshot* getUnchangedSubtreeSnapshot(const LayerHierarchy::TraversalPath& path,
+                                               const LayerSnapshot& parentSnapshot) const;
+    // Returns false, without updating anything, if the root subtrees cannot be updated in
+    // parallel.
+    bool updateRootSubtreesInParallel(const Args& args, const LayerSnapshot& rootSnapshot);
+    // Creates the missing snapshots in the hierarchy, in traversal order, and records the root
+    // subtree which visits each of them. Returns false if the hierarchy is too deep.
+    bool prepareSnapshotsInHierarchy(const Args& args, const LayerHierarchy& hierarchy,
+                                     LayerHierarchy::TraversalPath& traversalPath,
+                                     const LayerSnapshot& parentSnapshot, int depth,
+                                     size_t rootIndex,
+                                     std::unordered_map<const LayerSnapshot*, size_t>& owners,
+                                     std::vector<size_t>& groups);
 
     const LayerSnapshot& updateSnapshotsInHierarchy(const Args&, const LayerHierarchy& hierarchy,
                                                     LayerHierarchy::TraversalPath& traversalPath,
@@ -132,11 +179,15 @@ private:
     LayerSnapshot* createSnapshot(const LayerHierarchy::TraversalPath& id,
                                   const RequestedLayerState& layer,
                                   const LayerSnapshot& parentSnapshot);
+    LayerSnapshot* getOrCreateSnapshot(const Args& args, const LayerHierarchy::TraversalPath& path,
+                                       const RequestedLayerState& layer,
+                                       const LayerSnapshot& parentSnapshot);
     void updateFrameRateFromChildSnapshot(LayerSnapshot& snapshot,
                                           const LayerSnapshot& childSnapshot,
                                           const RequestedLayerState& requestedCHildState,
                                           const Args& args, bool* outChildHasValidFrameRate);
     void updateTouchableRegionCrop(const Args& args);
+    void updateInterestingSnapshotFlags();
 
     std::unordered_map<LayerHierarchy::TraversalPath, LayerSnapshot*,
                        LayerHierarchy::TraversalPathHash>
@@ -146,9 +197,30 @@ private:
     // Track snapshots that needs touchable region crop from other snapshots
     std::unordered_set<LayerHierarchy::TraversalPath, LayerHierarchy::TraversalPathHash>
             mNeedsTouchableRegionCrop;
+    // Guards inserts into mNeedsTouchableRegionCrop while root subtrees are updated in parallel.
+    std::mutex mNeedsTouchableRegionCropMutex;
     std::vector<std::unique_ptr<LayerSnapshot>> mSnapshots;
-    bool mResortSnapshots = false;
+    std::atomic<bool> mResortSnapshots = false;
+    std::unique_ptr<WorkerPool> mWorkerPool;
     int mNumInterestingSnapshots = 0;
+
+    // Set when the current traversal skips the subtrees without any layer in mDirtyLayerIds.
+    bool mSkipUnchangedSubtrees = false;
+    std::unordered_set<uint32_t> mDirtyLayerIds;
+    // Clones are not tracked by dirty layer ids, since they depend on the layers they mirror.
+    size_t mCloneSnapshotCount = 0;
+    std::atomic<size_t> mVisitedSnapshots = 0;
+    std::atomic<size_t> mSkippedSubtrees = 0;
+    bool mLastUpdateBufferOnly = false;
+
+    // The state the visitors filter on, for each of the first mNumInterestingSnapshots
+    // snapshots. Kept apart from the snapshots, which are large and scattered on the heap, so
+    // that finding the visible or input snapshots only touches the ones they visit.
+    struct InterestingSnapshotFlags {
+        bool isVisible;
+        bool hasInputInfo;
+    };
+    std::vector<InterestingSnapshotFlags> mInterestingSnapshotFlags;
 };
 
 } // namespace android::surfaceflinger::frontend
@@ -40,7 +40,7 @@ void TransactionHandler::collectTransactions() {
         if (!maybeTransaction.has_value()) {
             break;
         }
-        auto transaction = maybeTransaction.value();
+        TransactionState& transaction = *maybeTransaction;
         mPendingTransactionQueues[transaction.applyToken].emplace(std::move(transaction));
     }
 }
@@ -57,16 +57,20 @@ std::vector<TransactionState> TransactionHandler::flushTransactions() {
     // and then satisfy in a later inner iteration of flushPendingTransactionQueues.
     // The barrier dependent transaction was eligible to be presented in this frame
     // but we would have prevented it without case. To fix this we continually
-    // loop through flushPendingTransactionQueues until we perform an iteration
-    // where the number of transactionsPendingBarrier doesn't change. This way
-    // we can continue to resolve dependency chains of barriers as far as possible.
-    int lastTransactionsPendingBarrier = 0;
-    int transactionsPendingBarrier = 0;
-    do {
-        lastTransactionsPendingBarrier = transactionsPendingBarrier;
-        // Collect transactions that are ready to be applied.
-        transactionsPendingBarrier = flushPendingTransactionQueues(transactions, flushState);
-    } while (lastTransactionsPendingBarrier != transactionsPendingBarrier);
+    // loop through the queues pending on a barrier until we perform an iteration
+    // where the number of them doesn't change. This way we can continue to resolve
+    // dependency chains of barriers as far as possible. The transactions flushed in the
+    // meantime can only satisfy barriers, so the other queues are only checked once.
+    std::vector<sp<IBinder>> queuesPendingBarrier =
+            flushPendingTransactionQueues(transactions, flushState, /*applyTokens=*/nullptr);
+    while (!queuesPendingBarrier.empty()) {
+        std::vector<sp<IBinder>> queuesStillPendingBarrier =
+                flushPendingTransactionQueues(transactions, flushState, &queuesPendingBarrier);
+        if (queuesStillPendingBarrier.size() == queuesPendingBarrier.size()) {
+            break;
+        }
+        queuesPendingBarrier = std::move(queuesStillPendingBarrier);
+    }
 
     applyUnsignaledBufferTransaction(transactions, flushState);
 
@@ -146,38 +150,65 @@ TransactionHandler::TransactionReadiness TransactionHandler::applyFilters(
     return ready;
 }
 
-int TransactionHandler::flushPendingTransactionQueues(std::vector<TransactionState>& transactions,
-                                                      TransactionFlushState& flushState) {
-    int transactionsPendingBarrier = 0;
-    auto it = mPendingTransactionQueues.begin();
-    while (it != mPendingTransactionQueues.end()) {
-        auto& [applyToken, queue] = *it;
-        while (!queue.empty()) {
-            auto& transaction = queue.front();
-            flushState.transaction = &transaction;
-            auto ready = applyFilters(flushState);
-            if (ready == TransactionReadiness::NotReadyBarrier) {
-                transactionsPendingBarrier++;
-                break;
-            } else if (ready == TransactionReadiness::NotReady) {
-                break;
-            } else if (ready == TransactionReadiness::NotReadyUnsignaled) {
-                // We maybe able to latch this transaction if it's the only transaction
-                // ready to be applied.
-                flushState.queueWithUnsignaledBuffer = applyToken;
-                break;
+std::vector<sp<IBinder>> TransactionHandler::flushPendingTransactionQueues(
+        std::vector<TransactionState>& transactions, TransactionFlushState& flushState,
+        const std::vector<sp<IBinder>>* applyTokens) {
+    std::vector<sp<IBinder>> queuesPendingBarrier;
+    if (!applyTokens) {
+        auto it = mPendingTransactionQueues.begin();
+        while (it != mPendingTransactionQueues.end()) {
+            auto& [applyToken, queue] = *it;
+            if (flushPendingTransactionQueue(transactions, flushState, applyToken, queue) ==
+                TransactionReadiness::NotReadyBarrier) {
+                queuesPendingBarrier.push_back(applyToken);
+            }
+
+            if (queue.empty()) {
+                it = mPendingTransactionQueues.erase(it);
+            } else {
+                it = std::next(it, 1);
             }
-            // ready == TransactionReadiness::Ready
-            popTransactionFromPending(transactions, flushState, queue);
         }
+        return queuesPendingBarrier;
+    }
 
+    for (const auto& applyToken : *applyTokens) {
+        auto it = mPendingTransactionQueues.find(applyToken);
+        if (it == mPendingTransactionQueues.end()) {
+            continue;
+        }
+        auto& queue = it->second;
+        if (flushPendingTransactionQueue(transactions, flushState, applyToken, queue) ==
+            TransactionReadiness::NotReadyBarrier) {
+            queuesPendingBarrier.push_back(applyToken);
+        }
         if (queue.empty()) {
-            it = mPendingTransactionQueues.erase(it);
-        } else {
-            it = std::next(it, 1);
+            mPendingTransactionQueues.erase(it);
+        }
+    }
+    return queuesPendingBarrier;
+}
+
+TransactionHandler::TransactionReadiness TransactionHandler::flushPendingTransactionQueue(
+        std::vector<TransactionState>& transactions, TransactionFlushState& flushState,
+        const sp<IBinder>& applyToken, std::queue<TransactionState>& queue) {
+    while (!queue.empty()) {
+        auto& transaction = queue.front();
+        flushState.transaction = &transaction;
+        auto ready = applyFilters(flushState);
+        if (ready == TransactionReadiness::NotReadyBarrier ||
+            ready == TransactionReadiness::NotReady) {
+            return ready;
+        } else if (ready == TransactionReadiness::NotReadyUnsignaled) {
+            // We maybe able to latch this transaction if it's the only transaction
+            // ready to be applied.
+            flushState.queueWithUnsignaledBuffer = applyToken;
+            return ready;
         }
+        // ready == TransactionReadiness::Ready
+        popTransactionFromPending(transactions, flushState, queue);
     }
-    return transactionsPendingBarrier;
+    return TransactionReadiness::Ready;
 }
 
 void TransactionHandler::addTransactionReadyFilter(TransactionFilter&& filter) {
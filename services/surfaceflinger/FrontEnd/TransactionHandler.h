@@ -81,7 +81,17 @@ private:
     // For unit tests
     friend class ::android::TestableSurfaceFlinger;
 
-    int flushPendingTransactionQueues(std::vector<TransactionState>&, TransactionFlushState&);
+    // Flushes the ready transactions from the front of the queues of applyTokens, or of every
+    // queue if applyTokens is null. Returns the queues left waiting on a barrier.
+    std::vector<sp<IBinder>> flushPendingTransactionQueues(
+            std::vector<TransactionState>&, TransactionFlushState&,
+            const std::vector<sp<IBinder>>* applyTokens);
+    // Flushes the ready transactions from the front of the queue, and returns the readiness of
+    // the transaction it stopped at.
+    TransactionReadiness flushPendingTransactionQueue(std::vector<TransactionState>&,
+                                                      TransactionFlushState&,
+                                                      const sp<IBinder>& applyToken,
+                                                      std::queue<TransactionState>&);
     void applyUnsignaledBufferTransaction(std::vector<TransactionState>&, TransactionFlushState&);
     void popTransactionFromPending(std::vector<TransactionState>&, TransactionFlushState&,
                                    std::queue<TransactionState>&);
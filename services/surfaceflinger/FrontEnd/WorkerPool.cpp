@@ -0,0 +1,93 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#undef LOG_TAG
+#define LOG_TAG "SurfaceFlinger"
+
+#include <processgroup/sched_policy.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <string>
+
+#include "WorkerPool.h"
+
+namespace android::surfaceflinger::frontend {
+
+WorkerPool::WorkerPool(size_t threadCount) {
+    mThreads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; i++) {
+        mThreads.emplace_back(&WorkerPool::threadMain, this);
+        const std::string name = "SnapshotWorker" + std::to_string(i);
+        pthread_setname_np(mThreads.back().native_handle(), name.c_str());
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::scoped_lock lock{mMutex};
+        mStopped = true;
+    }
+    mWorkCondition.notify_all();
+    for (auto& thread : mThreads) {
+        thread.join();
+    }
+}
+
+void WorkerPool::run(const std::vector<std::function<void()>>& tasks) {
+    std::unique_lock lock{mMutex};
+    mTasks = &tasks;
+    mNextTask = 0;
+    mRemainingTasks = tasks.size();
+    mWorkCondition.notify_all();
+
+    runTasksLocked(lock);
+    mDoneCondition.wait(lock, [this]() REQUIRES(mMutex) { return mRemainingTasks == 0; });
+    mTasks = nullptr;
+}
+
+void WorkerPool::runTasksLocked(std::unique_lock<std::mutex>& lock) {
+    while (mTasks && mNextTask < mTasks->size()) {
+        const std::function<void()>& task = (*mTasks)[mNextTask++];
+        lock.unlock();
+        task();
+        lock.lock();
+        if (--mRemainingTasks == 0) {
+            mDoneCondition.notify_all();
+        }
+    }
+}
+
+void WorkerPool::threadMain() {
+    // The tasks hold up the main thread, so run them at the same priority.
+    set_sched_policy(0, SP_FOREGROUND);
+    struct sched_param param = {0};
+    param.sched_priority = 2;
+    sched_setscheduler(0, SCHED_FIFO, &param);
+
+    std::unique_lock lock{mMutex};
+    while (true) {
+        mWorkCondition.wait(lock, [this]() REQUIRES(mMutex) {
+            return mStopped || (mTasks && mNextTask < mTasks->size());
+        });
+        if (mStopped) {
+            return;
+        }
+        runTasksLocked(lock);
+    }
+}
+
+} // namespace android::surfaceflinger::frontend
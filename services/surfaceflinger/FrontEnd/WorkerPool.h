@@ -0,0 +1,60 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <android-base/thread_annotations.h>
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace android::surfaceflinger::frontend {
+
+// A fixed set of high priority threads which run a batch of tasks alongside the calling
+// thread. Used by the LayerSnapshotBuilder to update independent parts of the hierarchy in
+// parallel, so the threads are kept around rather than spawned for every frame.
+class WorkerPool {
+public:
+    // Creates threadCount threads in addition to the calling thread.
+    explicit WorkerPool(size_t threadCount);
+    ~WorkerPool();
+
+    size_t getThreadCount() const { return mThreads.size(); }
+
+    // Runs every task, on the pool threads and the calling thread, and returns once all of
+    // them have finished. Tasks are picked up in order, but may finish in any order.
+    void run(const std::vector<std::function<void()>>& tasks) EXCLUDES(mMutex);
+
+private:
+    void threadMain() EXCLUDES(mMutex);
+    void runTasksLocked(std::unique_lock<std::mutex>& lock) REQUIRES(mMutex);
+
+    std::mutex mMutex;
+    std::condition_variable mWorkCondition;
+    std::condition_variable mDoneCondition;
+    bool mStopped GUARDED_BY(mMutex) = false;
+
+    const std::vector<std::function<void()>>* mTasks GUARDED_BY(mMutex) = nullptr;
+    size_t mNextTask GUARDED_BY(mMutex) = 0;
+    size_t mRemainingTasks GUARDED_BY(mMutex) = 0;
+
+    std::vector<std::thread> mThreads;
+};
+
+} // namespace android::surfaceflinger::frontend
@@ -155,19 +155,29 @@ auto HdrSdrRatioOverlay::getOrCreateBuffers(float currentHdrSdrRatio) -> const s
     const auto transformHint =
             static_cast<ui::Transform::RotationFlags>(mSurfaceControl->get()->getTransformHint());
 
-    // Tell SurfaceFlinger about the pre-rotation on the buffer.
-    const auto transform = [&] {
-        switch (transformHint) {
-            case ui::Transform::ROT_90:
-                return ui::Transform::ROT_270;
-            case ui::Transform::ROT_270:
-                return ui::Transform::ROT_90;
-            default:
-                return ui::Transform::ROT_0;
-        }
-    }();
-
-    createTransaction().setTransform(mSurfaceControl->get(), transform).apply();
+    // animate() runs every frame while the overlay is enabled, but only two decimal places are
+    // shown, so only draw and send a buffer when those or the rotation change.
+    const int displayedValue = static_cast<int>(currentHdrSdrRatio * 100);
+    if (displayedValue == mDisplayedValue && transformHint == mTransformHint) return kNoBuffer;
+    mDisplayedValue = displayedValue;
+
+    if (transformHint != mTransformHint) {
+        mTransformHint = transformHint;
+
+        // Tell SurfaceFlinger about the pre-rotation on the buffer.
+        const auto transform = [&] {
+            switch (transformHint) {
+                case ui::Transform::ROT_90:
+                    return ui::Transform::ROT_270;
+                case ui::Transform::ROT_270:
+                    return ui::Transform::ROT_90;
+                default:
+                    return ui::Transform::ROT_0;
+            }
+        }();
+
+        createTransaction().setTransform(mSurfaceControl->get(), transform).apply();
+    }
 
     constexpr SkColor kMinRatioColor = SK_ColorBLUE;
     constexpr SkColor kMaxRatioColor = SK_ColorGREEN;
@@ -194,9 +204,9 @@ auto HdrSdrRatioOverlay::getOrCreateBuffers(float currentHdrSdrRatio) -> const s
 
 void HdrSdrRatioOverlay::animate() {
     if (!std::isfinite(mCurrentHdrSdrRatio) || mCurrentHdrSdrRatio < 1.0f) return;
-    createTransaction()
-            .setBuffer(mSurfaceControl->get(), getOrCreateBuffers(mCurrentHdrSdrRatio))
-            .apply();
+    const auto buffer = getOrCreateBuffers(mCurrentHdrSdrRatio);
+    if (!buffer) return;
+    createTransaction().setBuffer(mSurfaceControl->get(), buffer).apply();
 }
 
 SurfaceComposerClient::Transaction HdrSdrRatioOverlay::createTransaction() const {
@@ -18,7 +18,10 @@
 
 #include "Utils/OverlayUtils.h"
 
+#include <optional>
+
 #include <ui/Size.h>
+#include <ui/Transform.h>
 #include <utils/StrongPointer.h>
 
 class SkCanvas;
@@ -49,6 +52,9 @@ private:
     const sp<GraphicBuffer> getOrCreateBuffers(float currentHdrSdrRatio);
 
     float mCurrentHdrSdrRatio = 1.f;
+    // The value and rotation of the buffer last sent, so that unchanged frames send nothing.
+    int mDisplayedValue = -1;
+    std::optional<ui::Transform::RotationFlags> mTransformHint;
     const std::unique_ptr<SurfaceControlHolder> mSurfaceControl;
 
     size_t mIndex = 0;
@@ -77,8 +77,9 @@ void JankTracker::onJankData(int32_t layerId, gui::JankData data) {
                 }
 
                 tracker.mJankDataLock.lock();
-                tracker.mJankData.emplace(layerId, data);
-                size_t count = tracker.mJankData.count(layerId);
+                JankDataRing& ring = tracker.mJankData[layerId];
+                ring.push(std::move(data));
+                size_t count = ring.size();
                 tracker.mJankDataLock.unlock();
 
                 if (count >= kJankDataBatchSize && !sCollectAllJankDataForTesting) {
@@ -144,13 +145,12 @@ void JankTracker::markJankListenerForRemovalLocked(int32_t layerId, sp<IBinder>
 int64_t JankTracker::transferAvailableJankData(int32_t layerId,
                                                std::vector<gui::JankData>& outJankData) {
     const std::lock_guard<std::mutex> _l(mJankDataLock);
-    int64_t maxVsync = 0;
-    auto range = mJankData.equal_range(layerId);
-    for (auto it = range.first; it != range.second;) {
-        maxVsync = std::max(it->second.frameVsyncId, maxVsync);
-        outJankData.emplace_back(std::move(it->second));
-        it = mJankData.erase(it);
+    auto it = mJankData.find(layerId);
+    if (it == mJankData.end()) {
+        return 0;
     }
+    int64_t maxVsync = it->second.drainTo(outJankData);
+    mJankData.erase(it);
     return maxVsync;
 }
 
@@ -165,6 +165,37 @@ void JankTracker::dropJankListener(int32_t layerId, sp<IBinder> listener) {
     }
 }
 
+void JankTracker::JankDataRing::push(gui::JankData data) {
+    if (mData.size() < kMaxPendingJankDataPerLayer) {
+        mData.emplace_back(std::move(data));
+        return;
+    }
+    mData[mHead] = std::move(data);
+    mHead = (mHead + 1) % mData.size();
+}
+
+int64_t JankTracker::JankDataRing::drainTo(std::vector<gui::JankData>& outJankData) {
+    int64_t maxVsync = 0;
+    outJankData.reserve(outJankData.size() + mData.size());
+    for (size_t i = 0; i < mData.size(); i++) {
+        gui::JankData& data = mData[(mHead + i) % mData.size()];
+        maxVsync = std::max(data.frameVsyncId, maxVsync);
+        outJankData.emplace_back(std::move(data));
+    }
+    mData.clear();
+    mHead = 0;
+    return maxVsync;
+}
+
+std::vector<gui::JankData> JankTracker::JankDataRing::copy() const {
+    std::vector<gui::JankData> result;
+    result.reserve(mData.size());
+    for (size_t i = 0; i < mData.size(); i++) {
+        result.push_back(mData[(mHead + i) % mData.size()]);
+    }
+    return result;
+}
+
 void JankTracker::clearAndStartCollectingAllJankDataForTesting() {
     BackgroundExecutor::getLowPriorityInstance().flushQueue();
 
@@ -182,14 +213,11 @@ std::vector<gui::JankData> JankTracker::getCollectedJankDataForTesting(int32_t l
     JankTracker& tracker = getInstance();
     const std::lock_guard<std::mutex> _l(tracker.mJankDataLock);
 
-    auto range = tracker.mJankData.equal_range(layerId);
-    std::vector<gui::JankData> result;
-    std::transform(range.first, range.second, std::back_inserter(result),
-                   [](std::pair<int32_t, gui::JankData> layerIdToJankData) {
-                       return layerIdToJankData.second;
-                   });
-
-    return result;
+    auto it = tracker.mJankData.find(layerId);
+    if (it == tracker.mJankData.end()) {
+        return {};
+    }
+    return it->second.copy();
 }
 
 void JankTracker::clearAndStopCollectingAllJankDataForTesting() {
@@ -75,6 +75,27 @@ private:
     int64_t transferAvailableJankData(int32_t layerId, std::vector<gui::JankData>& jankData);
     void dropJankListener(int32_t layerId, sp<IBinder> listener);
 
+    // Upper bound on the jank data kept for a single layer. Data normally gets flushed long
+    // before this, but if a listener is slow to receive it, the oldest frames are overwritten
+    // instead of letting the backlog grow.
+    static constexpr size_t kMaxPendingJankDataPerLayer = 256;
+
+    // Fixed capacity FIFO of the pending jank data of one layer. Once full, pushing overwrites
+    // the oldest entry.
+    class JankDataRing {
+    public:
+        void push(gui::JankData data);
+        size_t size() const { return mData.size(); }
+        // Appends the data oldest first and returns the largest vsync id seen.
+        int64_t drainTo(std::vector<gui::JankData>& outJankData);
+        std::vector<gui::JankData> copy() const;
+
+    private:
+        std::vector<gui::JankData> mData;
+        // Index of the oldest entry, only non-zero once the ring has wrapped.
+        size_t mHead = 0;
+    };
+
     struct Listener {
         sp<IBinder> mListener;
         int64_t mRemoveAfter;
@@ -91,7 +112,7 @@ private:
     std::mutex mLock;
     std::unordered_multimap<int32_t, Listener> mJankListeners GUARDED_BY(mLock);
     std::mutex mJankDataLock;
-    std::unordered_multimap<int32_t, gui::JankData> mJankData GUARDED_BY(mJankDataLock);
+    std::unordered_map<int32_t, JankDataRing> mJankData GUARDED_BY(mJankDataLock);
 
     friend class JankTrackerTest;
 };
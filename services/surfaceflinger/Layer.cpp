@@ -62,6 +62,7 @@
 #include <algorithm>
 #include <optional>
 
+#include "BackgroundExecutor.h"
 #include "DisplayDevice.h"
 #include "DisplayHardware/HWComposer.h"
 #include "FrameTimeline.h"
@@ -678,17 +679,22 @@ void Layer::callReleaseBufferCallback(const sp<ITransactionCompletedListener>& l
     SFTRACE_FORMAT_INSTANT("callReleaseBufferCallback %s - %" PRIu64, getDebugName(), framenumber);
 
     ReleaseCallbackId callbackId{buffer->getId(), framenumber};
-    const sp<Fence>& fence = releaseFence ? releaseFence : Fence::NO_FENCE;
+    sp<Fence> fence = releaseFence ? releaseFence : Fence::NO_FENCE;
     uint32_t currentMaxAcquiredBufferCount =
             mFlinger->getMaxAcquiredBufferCountForCurrentRefreshRate(mOwnerUid);
 
-    if (listener) {
-        listener->onReleaseBuffer(callbackId, fence, currentMaxAcquiredBufferCount);
-    }
-
-    if (mBufferReleaseChannel) {
-        mBufferReleaseChannel->writeReleaseFence(callbackId, fence, currentMaxAcquiredBufferCount);
-    }
+    // The binder call and the channel write happen on the same thread as the transaction
+    // callbacks, which keeps them ordered with respect to each other and off the main thread.
+    BackgroundExecutor::getInstance().sendCallbacks(
+            {[listener, channel = mBufferReleaseChannel, callbackId, fence = std::move(fence),
+              currentMaxAcquiredBufferCount]() {
+                if (listener) {
+                    listener->onReleaseBuffer(callbackId, fence, currentMaxAcquiredBufferCount);
+                }
+                if (channel) {
+                    channel->writeReleaseFence(callbackId, fence, currentMaxAcquiredBufferCount);
+                }
+            }});
 }
 
 sp<CallbackHandle> Layer::findCallbackHandle() {
@@ -18,6 +18,7 @@
 
 #include <atomic>
 #include <optional>
+#include <utility>
 
 // Single consumer multi producer queue. We can understand the two operations independently to see
 // why they are without race condition.
@@ -79,7 +80,7 @@ private:
     public:
         T mValue;
         std::atomic<Entry*> mNext;
-        Entry(T value) : mValue(value) {}
+        Entry(T value) : mValue(std::move(value)) {}
     };
     std::atomic<Entry*> mPush = nullptr;
     std::atomic<Entry*> mPop = nullptr;
@@ -201,19 +201,23 @@ auto RefreshRateOverlay::getOrCreateBuffers(Fps refreshRate, Fps renderFps, bool
     const auto transformHint =
             static_cast<ui::Transform::RotationFlags>(mSurfaceControl->get()->getTransformHint());
 
-    // Tell SurfaceFlinger about the pre-rotation on the buffer.
-    const auto transform = [&] {
-        switch (transformHint) {
-            case ui::Transform::ROT_90:
-                return ui::Transform::ROT_270;
-            case ui::Transform::ROT_270:
-                return ui::Transform::ROT_90;
-            default:
-                return ui::Transform::ROT_0;
-        }
-    }();
+    if (transformHint != mTransformHint) {
+        mTransformHint = transformHint;
+
+        // Tell SurfaceFlinger about the pre-rotation on the buffer.
+        const auto transform = [&] {
+            switch (transformHint) {
+                case ui::Transform::ROT_90:
+                    return ui::Transform::ROT_270;
+                case ui::Transform::ROT_270:
+                    return ui::Transform::ROT_90;
+                default:
+                    return ui::Transform::ROT_0;
+            }
+        }();
 
-    createTransaction().setTransform(mSurfaceControl->get(), transform).apply();
+        createTransaction().setTransform(mSurfaceControl->get(), transform).apply();
+    }
 
     BufferCache::const_iterator it = mBufferCache.find(
             {refreshRate.getIntValue(), renderFps.getIntValue(), transformHint, idle});
@@ -275,24 +279,21 @@ void RefreshRateOverlay::setLayerStack(ui::LayerStack stack) {
 void RefreshRateOverlay::changeRefreshRate(Fps refreshRate, Fps renderFps) {
     mRefreshRate = refreshRate;
     mRenderFps = renderFps;
-    const auto buffer = getOrCreateBuffers(refreshRate, renderFps, mIsVrrIdle)[mFrame];
-    createTransaction().setBuffer(mSurfaceControl->get(), buffer).apply();
+    setBuffer(getOrCreateBuffers(refreshRate, renderFps, mIsVrrIdle)[mFrame]);
 }
 
 void RefreshRateOverlay::onVrrIdle(bool idle) {
     mIsVrrIdle = idle;
     if (!mRefreshRate || !mRenderFps) return;
 
-    const auto buffer = getOrCreateBuffers(*mRefreshRate, *mRenderFps, mIsVrrIdle)[mFrame];
-    createTransaction().setBuffer(mSurfaceControl->get(), buffer).apply();
+    setBuffer(getOrCreateBuffers(*mRefreshRate, *mRenderFps, mIsVrrIdle)[mFrame]);
 }
 
 void RefreshRateOverlay::changeRenderRate(Fps renderFps) {
     if (mFeatures.test(Features::RenderRate) && mRefreshRate &&
         FlagManager::getInstance().misc1()) {
         mRenderFps = renderFps;
-        const auto buffer = getOrCreateBuffers(*mRefreshRate, renderFps, mIsVrrIdle)[mFrame];
-        createTransaction().setBuffer(mSurfaceControl->get(), buffer).apply();
+        setBuffer(getOrCreateBuffers(*mRefreshRate, renderFps, mIsVrrIdle)[mFrame]);
     }
 }
 
@@ -301,7 +302,14 @@ void RefreshRateOverlay::animate() {
 
     const auto& buffers = getOrCreateBuffers(*mRefreshRate, *mRenderFps, mIsVrrIdle);
     mFrame = (mFrame + 1) % buffers.size();
-    const auto buffer = buffers[mFrame];
+    setBuffer(buffers[mFrame]);
+}
+
+void RefreshRateOverlay::setBuffer(const sp<GraphicBuffer>& buffer) {
+    // Skip the transaction when the layer already shows this buffer, e.g. when the rate is
+    // reported again unchanged.
+    if (buffer == mCurrentBuffer) return;
+    mCurrentBuffer = buffer;
     createTransaction().setBuffer(mSurfaceControl->get(), buffer).apply();
 }
 
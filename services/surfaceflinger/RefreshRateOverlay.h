@@ -72,6 +72,7 @@ private:
     static void drawDash(int left, SkCanvas&);
 
     const Buffers& getOrCreateBuffers(Fps, Fps, bool);
+    void setBuffer(const sp<GraphicBuffer>&);
 
     SurfaceComposerClient::Transaction createTransaction() const;
 
@@ -95,6 +96,10 @@ private:
     bool mIsVrrIdle = false;
     size_t mFrame = 0;
 
+    // The rotation and buffer last sent, so that unchanged frames send nothing.
+    std::optional<ui::Transform::RotationFlags> mTransformHint;
+    sp<GraphicBuffer> mCurrentBuffer;
+
     const FpsRange mFpsRange; // For color interpolation.
     const ftl::Flags<Features> mFeatures;
 
@@ -64,6 +64,7 @@ constexpr auto defaultRegionSamplingWorkDuration = 3ms;
 constexpr auto defaultRegionSamplingPeriod = 100ms;
 constexpr auto defaultRegionSamplingTimerTimeout = 100ms;
 constexpr auto maxRegionSamplingDelay = 100ms;
+constexpr int32_t defaultRegionSamplingDownscaleFactor = 1;
 // TODO: (b/127403193) duration to string conversion could probably be constexpr
 template <typename Rep, typename Per>
 inline std::string toNsString(std::chrono::duration<Rep, Per> t) {
@@ -100,6 +101,9 @@ RegionSamplingThread::EnvironmentTimingTunables::EnvironmentTimingTunables() {
 RegionSamplingThread::RegionSamplingThread(SurfaceFlinger& flinger, const TimingTunables& tunables)
       : mFlinger(flinger),
         mTunables(tunables),
+        mDownscaleFactor(std::max(property_get_int32("debug.sf.region_sampling_downscale_factor",
+                                                     defaultRegionSamplingDownscaleFactor),
+                                  1)),
         mIdleTimer(
                 "RegSampIdle",
                 std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -225,9 +229,18 @@ float sampleArea(const uint32_t* data, int32_t width, int32_t height, int32_t st
     return accumulatedLuma / (255.0f * pixelCount);
 }
 
+Rect downscaleSampleArea(const Rect& area, int32_t downscaleFactor) {
+    const auto roundUp = [downscaleFactor](int32_t value) {
+        return (value + downscaleFactor - 1) / downscaleFactor;
+    };
+    return Rect(area.left / downscaleFactor, area.top / downscaleFactor, roundUp(area.right),
+                roundUp(area.bottom));
+}
+
 std::vector<float> RegionSamplingThread::sampleBuffer(
         const sp<GraphicBuffer>& buffer, const Point& leftTop,
-        const std::vector<RegionSamplingThread::Descriptor>& descriptors, uint32_t orientation) {
+        const std::vector<RegionSamplingThread::Descriptor>& descriptors, uint32_t orientation,
+        int32_t downscaleFactor) {
     void* data_raw = nullptr;
     buffer->lock(GRALLOC_USAGE_SW_READ_OFTEN, &data_raw);
     std::shared_ptr<uint32_t> data(reinterpret_cast<uint32_t*>(data_raw),
@@ -241,7 +254,8 @@ std::vector<float> RegionSamplingThread::sampleBuffer(
     std::transform(descriptors.begin(), descriptors.end(), lumas.begin(),
                    [&](auto const& descriptor) {
                        return sampleArea(data.get(), width, height, stride, orientation,
-                                         descriptor.area - leftTop);
+                                         downscaleSampleArea(descriptor.area - leftTop,
+                                                             downscaleFactor));
                    });
     return lumas;
 }
@@ -277,6 +291,8 @@ void RegionSamplingThread::captureSample() {
     }
 
     const Rect sampledBounds = sampleRegion.bounds();
+    const ui::Size sampledSize =
+            downscaleSampleArea(Rect(sampledBounds.getSize()), mDownscaleFactor).getSize();
 
     std::unordered_set<sp<IRegionSamplingListener>, SpHash<IRegionSamplingListener>> listeners;
 
@@ -325,14 +341,14 @@ void RegionSamplingThread::captureSample() {
             mFlinger.getLayerSnapshotsForScreenshots(layerStack, CaptureArgs::UNSET_UID, filterFn);
 
     std::shared_ptr<renderengine::ExternalTexture> buffer = nullptr;
-    if (mCachedBuffer && mCachedBuffer->getBuffer()->getWidth() == sampledBounds.getWidth() &&
-        mCachedBuffer->getBuffer()->getHeight() == sampledBounds.getHeight()) {
+    if (mCachedBuffer && mCachedBuffer->getBuffer()->getWidth() == sampledSize.getWidth() &&
+        mCachedBuffer->getBuffer()->getHeight() == sampledSize.getHeight()) {
         buffer = mCachedBuffer;
     } else {
         const uint32_t usage =
                 GRALLOC_USAGE_SW_READ_OFTEN | GRALLOC_USAGE_HW_RENDER | GRALLOC_USAGE_HW_TEXTURE;
         sp<GraphicBuffer> graphicBuffer =
-                sp<GraphicBuffer>::make(sampledBounds.getWidth(), sampledBounds.getHeight(),
+                sp<GraphicBuffer>::make(sampledSize.getWidth(), sampledSize.getHeight(),
                                         PIXEL_FORMAT_RGBA_8888, 1, usage, "RegionSamplingThread");
         const status_t bufferStatus = graphicBuffer->initCheck();
         LOG_ALWAYS_FATAL_IF(bufferStatus != OK, "captureSample: Buffer failed to allocate: %d",
@@ -350,7 +366,7 @@ void RegionSamplingThread::captureSample() {
 
     SurfaceFlinger::RenderAreaBuilderVariant
             renderAreaBuilder(std::in_place_type<DisplayRenderAreaBuilder>, sampledBounds,
-                              sampledBounds.getSize(), ui::Dataspace::V0_SRGB, displayWeak,
+                              sampledSize, ui::Dataspace::V0_SRGB, displayWeak,
                               RenderArea::Options::CAPTURE_SECURE_LAYERS);
 
     FenceResult fenceResult;
@@ -382,7 +398,7 @@ void RegionSamplingThread::captureSample() {
 
     ALOGV("Sampling %zu descriptors", activeDescriptors.size());
     std::vector<float> lumas = sampleBuffer(buffer->getBuffer(), sampledBounds.leftTop(),
-                                            activeDescriptors, orientation);
+                                            activeDescriptors, orientation, mDownscaleFactor);
     if (lumas.size() != activeDescriptors.size()) {
         ALOGW("collected %zu median luma values for %zu descriptors", lumas.size(),
               activeDescriptors.size());
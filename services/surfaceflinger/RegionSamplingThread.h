@@ -45,6 +45,9 @@ using gui::IRegionSamplingListener;
 float sampleArea(const uint32_t* data, int32_t width, int32_t height, int32_t stride,
                  uint32_t orientation, const Rect& area);
 
+// Maps an area to a buffer downscaled by the given factor, rounding outwards.
+Rect downscaleSampleArea(const Rect& area, int32_t downscaleFactor);
+
 class RegionSamplingThread : public IBinder::DeathRecipient {
 public:
     struct TimingTunables {
@@ -93,7 +96,8 @@ private:
 
     std::vector<float> sampleBuffer(
             const sp<GraphicBuffer>& buffer, const Point& leftTop,
-            const std::vector<RegionSamplingThread::Descriptor>& descriptors, uint32_t orientation);
+            const std::vector<RegionSamplingThread::Descriptor>& descriptors, uint32_t orientation,
+            int32_t downscaleFactor);
 
     void doSample(std::optional<std::chrono::steady_clock::time_point> samplingDeadline);
     void binderDied(const wp<IBinder>& who) override;
@@ -104,6 +108,11 @@ private:
 
     SurfaceFlinger& mFlinger;
     const TimingTunables mTunables;
+    // debug.sf.region_sampling_downscale_factor
+    // The sampled region is rendered at this fraction of its size in each dimension. Luma is the
+    // mean over each sampling area, which the filtered downscale preserves closely, while the
+    // render and the CPU pass over the buffer shrink by the square of the factor.
+    const int32_t mDownscaleFactor;
     scheduler::OneShotTimer mIdleTimer;
 
     std::thread mThread;
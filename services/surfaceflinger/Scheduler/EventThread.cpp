@@ -22,7 +22,9 @@
 
 #include <pthread.h>
 #include <sched.h>
+#include <sys/eventfd.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 #include <chrono>
 #include <cstdint>
@@ -239,6 +241,25 @@ binder::Status EventThreadConnection::getLatestVsyncEventData(
     return binder::Status::ok();
 }
 
+binder::Status EventThreadConnection::getVsyncTimelinePage(os::ParcelFileDescriptor* outFd) {
+    SFTRACE_CALL();
+    base::unique_fd fd =
+            mEventThread->getVsyncTimelinePage(sp<EventThreadConnection>::fromExisting(this));
+    if (!fd.ok()) {
+        return binder::Status::fromStatusT(NO_MEMORY);
+    }
+    outFd->reset(std::move(fd));
+    return binder::Status::ok();
+}
+
+binder::Status EventThreadConnection::subscribeToVsyncBroadcast(
+        gui::VsyncBroadcastSubscription* outSubscription) {
+    SFTRACE_CALL();
+    return binder::Status::fromStatusT(
+            mEventThread->subscribeToVsyncBroadcast(sp<EventThreadConnection>::fromExisting(this),
+                                                    outSubscription));
+}
+
 binder::Status EventThreadConnection::getSchedulingPolicy(gui::SchedulingPolicy* outPolicy) {
     return gui::getSchedulingPolicy(outPolicy);
 }
@@ -410,6 +431,49 @@ VsyncEventData EventThread::getLatestVsyncEventData(const sp<EventThreadConnecti
     return vsyncEventData;
 }
 
+base::unique_fd EventThread::getVsyncTimelinePage(const sp<EventThreadConnection>& connection) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (connection->timelinePage) {
+            return base::unique_fd(dup(connection->timelinePage->getFd().get()));
+        }
+    }
+
+    auto page = gui::VsyncTimelinePage::create();
+    if (!page) {
+        return {};
+    }
+    // Seed the page, so that it's readable before the next vsync.
+    page->write(getLatestVsyncEventData(connection, systemTime()));
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!connection->timelinePage) {
+        connection->timelinePage = std::move(page);
+    }
+    return base::unique_fd(dup(connection->timelinePage->getFd().get()));
+}
+
+status_t EventThread::subscribeToVsyncBroadcast(const sp<EventThreadConnection>& connection,
+                                               gui::VsyncBroadcastSubscription* outSubscription) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mVsyncBroadcastWakeFd.ok()) {
+        mVsyncBroadcastWakeFd.reset(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK));
+        if (!mVsyncBroadcastWakeFd.ok()) {
+            ALOGE("%s: eventfd failed: %s", __func__, strerror(errno));
+            return NO_MEMORY;
+        }
+    }
+    if (!connection->broadcastPage) {
+        connection->broadcastPage = gui::VsyncBroadcastPage::create();
+        if (!connection->broadcastPage) {
+            return NO_MEMORY;
+        }
+    }
+    outSubscription->page.reset(base::unique_fd(dup(connection->broadcastPage->getFd().get())));
+    outSubscription->wakeEvent.reset(base::unique_fd(dup(mVsyncBroadcastWakeFd.get())));
+    return NO_ERROR;
+}
+
 void EventThread::enableSyntheticVsync(bool enable) {
     std::lock_guard<std::mutex> lock(mMutex);
     if (!mVSyncState || mVSyncState->synthetic == enable) {
@@ -474,6 +538,7 @@ void EventThread::onHdcpLevelsChanged(PhysicalDisplayId displayId, int32_t conne
 
 void EventThread::threadMain(std::unique_lock<std::mutex>& lock) {
     DisplayEventConsumers consumers;
+    DisplayEventConsumers timelineReaders;
 
     while (mState != State::Quit) {
         std::optional<DisplayEventReceiver::Event> event;
@@ -505,6 +570,10 @@ void EventThread::threadMain(std::unique_lock<std::mutex>& lock) {
             if (const auto connection = it->promote()) {
                 if (event && shouldConsumeEvent(*event, connection)) {
                     consumers.push_back(connection);
+                } else if (event &&
+                           event->header.type == DisplayEventReceiver::DISPLAY_EVENT_VSYNC &&
+                           connection->timelinePage) {
+                    timelineReaders.push_back(connection);
                 }
 
                 vsyncRequested |= connection->vsyncRequest != VSyncRequest::None;
@@ -519,6 +588,10 @@ void EventThread::threadMain(std::unique_lock<std::mutex>& lock) {
             dispatchEvent(*event, consumers);
             consumers.clear();
         }
+        if (!timelineReaders.empty()) {
+            publishVsyncTimelines(*event, timelineReaders);
+            timelineReaders.clear();
+        }
 
         if (mVSyncState && vsyncRequested) {
             mState = mVSyncState->synthetic ? State::SyntheticVSync : State::VSync;
@@ -701,6 +774,7 @@ void EventThread::generateFrameTimeline(VsyncEventData& outVsyncEventData, nsecs
 
 void EventThread::dispatchEvent(const DisplayEventReceiver::Event& event,
                                 const DisplayEventConsumers& consumers) {
+    bool wakeVsyncBroadcast = false;
     for (const auto& consumer : consumers) {
         DisplayEventReceiver::Event copy = event;
         if (event.header.type == DisplayEventReceiver::DISPLAY_EVENT_VSYNC) {
@@ -709,6 +783,14 @@ void EventThread::dispatchEvent(const DisplayEventReceiver::Event& event,
             generateFrameTimeline(copy.vsync.vsyncData, frameInterval.ns(), copy.header.timestamp,
                                   event.vsync.vsyncData.preferredExpectedPresentationTime(),
                                   event.vsync.vsyncData.preferredDeadlineTimestamp());
+            if (consumer->timelinePage) {
+                consumer->timelinePage->write(copy.vsync.vsyncData);
+            }
+            if (consumer->broadcastPage) {
+                consumer->broadcastPage->write(copy);
+                wakeVsyncBroadcast = true;
+                continue;
+            }
         }
         switch (consumer->postEvent(copy)) {
             case NO_ERROR:
@@ -725,6 +807,9 @@ void EventThread::dispatchEvent(const DisplayEventReceiver::Event& event,
                 removeDisplayEventConnectionLocked(consumer);
         }
     }
+    if (wakeVsyncBroadcast) {
+        wakeVsyncBroadcastSubscribers();
+    }
     if (event.header.type == DisplayEventReceiver::DISPLAY_EVENT_VSYNC &&
         FlagManager::getInstance().vrr_config()) {
         mLastCommittedVsyncTime =
@@ -733,6 +818,38 @@ void EventThread::dispatchEvent(const DisplayEventReceiver::Event& event,
     }
 }
 
+void EventThread::publishVsyncTimelines(const DisplayEventReceiver::Event& event,
+                                        const DisplayEventConsumers& connections) {
+    for (const auto& connection : connections) {
+        VsyncEventData vsyncEventData = event.vsync.vsyncData;
+        const Period frameInterval = mCallback.getVsyncPeriod(connection->mOwnerUid);
+        vsyncEventData.frameInterval = frameInterval.ns();
+        generateFrameTimeline(vsyncEventData, frameInterval.ns(), event.header.timestamp,
+                              event.vsync.vsyncData.preferredExpectedPresentationTime(),
+                              event.vsync.vsyncData.preferredDeadlineTimestamp());
+        connection->timelinePage->write(vsyncEventData);
+    }
+}
+
+void EventThread::wakeVsyncBroadcastSubscribers() {
+    SFTRACE_CALL();
+    constexpr uint64_t kIncrement = 1;
+    if (write(mVsyncBroadcastWakeFd.get(), &kIncrement, sizeof(kIncrement)) ==
+        sizeof(kIncrement)) {
+        return;
+    }
+    // Subscribers only poll the eventfd, so its counter never goes down unless we read it. It
+    // cannot realistically overflow from our writes, but a subscriber could fill it to keep the
+    // others from being woken.
+    uint64_t count;
+    if (errno == EAGAIN && read(mVsyncBroadcastWakeFd.get(), &count, sizeof(count)) != -1 &&
+        write(mVsyncBroadcastWakeFd.get(), &kIncrement, sizeof(kIncrement)) ==
+                sizeof(kIncrement)) {
+        return;
+    }
+    ALOGW("Failed to wake vsync broadcast subscribers: %s", strerror(errno));
+}
+
 void EventThread::dump(std::string& result) const {
     std::lock_guard<std::mutex> lock(mMutex);
 
@@ -19,6 +19,8 @@
 #include <android-base/thread_annotations.h>
 #include <android/gui/BnDisplayEventConnection.h>
 #include <gui/DisplayEventReceiver.h>
+#include <gui/VsyncBroadcastPage.h>
+#include <gui/VsyncTimelinePage.h>
 #include <private/gui/BitTube.h>
 #include <sys/types.h>
 #include <utils/Errors.h>
@@ -27,6 +29,7 @@
 #include <condition_variable>
 #include <cstdint>
 #include <deque>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <thread>
@@ -78,9 +81,16 @@ public:
     binder::Status setVsyncRate(int rate) override;
     binder::Status requestNextVsync() override; // asynchronous
     binder::Status getLatestVsyncEventData(ParcelableVsyncEventData* outVsyncEventData) override;
+    binder::Status getVsyncTimelinePage(os::ParcelFileDescriptor* outFd) override;
+    binder::Status subscribeToVsyncBroadcast(
+            gui::VsyncBroadcastSubscription* outSubscription) override;
     binder::Status getSchedulingPolicy(gui::SchedulingPolicy* outPolicy) override;
 
     VSyncRequest vsyncRequest = VSyncRequest::None;
+    /** The page the frame timelines are published to, once the client asked for it. */
+    std::unique_ptr<gui::VsyncTimelinePage> timelinePage;
+    /** The page vsync events are written to instead of the BitTube, once subscribed. */
+    std::unique_ptr<gui::VsyncBroadcastPage> broadcastPage;
     const uid_t mOwnerUid;
     const EventRegistrationFlags mEventRegistration;
 
@@ -129,6 +139,14 @@ public:
     virtual void requestNextVsync(const sp<EventThreadConnection>& connection) = 0;
     virtual VsyncEventData getLatestVsyncEventData(const sp<EventThreadConnection>& connection,
                                                    nsecs_t now) const = 0;
+    // Returns a read-only fd of the connection's vsync timeline page, creating the page on the
+    // first call.
+    virtual base::unique_fd getVsyncTimelinePage(const sp<EventThreadConnection>& connection) = 0;
+    // Delivers the connection's vsync events through a broadcast page from now on, and returns
+    // read-only fds of the page and of the eventfd shared by all subscribers.
+    virtual status_t subscribeToVsyncBroadcast(
+            const sp<EventThreadConnection>& connection,
+            gui::VsyncBroadcastSubscription* outSubscription) = 0;
 
     virtual void onNewVsyncSchedule(std::shared_ptr<scheduler::VsyncSchedule>) = 0;
 
@@ -162,6 +180,11 @@ public:
     void requestNextVsync(const sp<EventThreadConnection>& connection) override;
     VsyncEventData getLatestVsyncEventData(const sp<EventThreadConnection>& connection,
                                            nsecs_t now) const override;
+    base::unique_fd getVsyncTimelinePage(const sp<EventThreadConnection>& connection) override
+            EXCLUDES(mMutex);
+    status_t subscribeToVsyncBroadcast(const sp<EventThreadConnection>& connection,
+                                       gui::VsyncBroadcastSubscription* outSubscription) override
+            EXCLUDES(mMutex);
 
     void enableSyntheticVsync(bool) override;
 
@@ -195,6 +218,11 @@ private:
                             const sp<EventThreadConnection>& connection) const REQUIRES(mMutex);
     void dispatchEvent(const DisplayEventReceiver::Event& event,
                        const DisplayEventConsumers& consumers) REQUIRES(mMutex);
+    // Publishes the frame timelines of a vsync event to connections which have a timeline page
+    // but did not consume the event.
+    void publishVsyncTimelines(const DisplayEventReceiver::Event& event,
+                               const DisplayEventConsumers& connections) REQUIRES(mMutex);
+    void wakeVsyncBroadcastSubscribers() REQUIRES(mMutex);
 
     void removeDisplayEventConnectionLocked(const wp<EventThreadConnection>& connection)
             REQUIRES(mMutex);
@@ -233,6 +261,10 @@ private:
     std::vector<wp<EventThreadConnection>> mDisplayEventConnections GUARDED_BY(mMutex);
     std::deque<DisplayEventReceiver::Event> mPendingEvents GUARDED_BY(mMutex);
 
+    // Signaled once per dispatched vsync event if any consumer is subscribed to the vsync
+    // broadcast, rather than writing to each of their BitTubes. Created on first subscription.
+    base::unique_fd mVsyncBroadcastWakeFd GUARDED_BY(mMutex);
+
     // VSYNC state of connected display.
     struct VSyncState {
         explicit VSyncState(PhysicalDisplayId displayId) : displayId(displayId) {}
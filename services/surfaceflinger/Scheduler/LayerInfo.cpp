@@ -72,10 +72,7 @@ void LayerInfo::setLastPresentTime(nsecs_t lastPresentTime, nsecs_t now, LayerUp
                                        .queueTime = mLastUpdatedTime,
                                        .pendingModeChange = pendingModeChange,
                                        .isSmallDirty = props.isSmallDirty};
-            mFrameTimes.push_back(frameTime);
-            if (mFrameTimes.size() > HISTORY_SIZE) {
-                mFrameTimes.pop_front();
-            }
+            mFrameTimes.next() = frameTime;
             break;
     }
 }
@@ -157,21 +154,21 @@ LayerInfo::Frequent LayerInfo::isFrequent(nsecs_t now) const {
 
 Fps LayerInfo::getFps(nsecs_t now) const {
     // Find the first active frame
-    auto it = mFrameTimes.begin();
-    for (; it != mFrameTimes.end(); ++it) {
-        if (it->queueTime >= getActiveLayerThreshold(now)) {
+    size_t first = 0;
+    for (; first < mFrameTimes.size(); first++) {
+        if (mFrameTimes[first].queueTime >= getActiveLayerThreshold(now)) {
             break;
         }
     }
 
-    const auto numFrames = std::distance(it, mFrameTimes.end());
+    const auto numFrames = mFrameTimes.size() - first;
     if (numFrames < kFrequentLayerWindowSize) {
         return Fps();
     }
 
     // Layer is considered frequent if the average frame rate is higher than the threshold
-    const auto totalTime = mFrameTimes.back().queueTime - it->queueTime;
-    return Fps::fromPeriodNsecs(totalTime / (numFrames - 1));
+    const auto totalTime = mFrameTimes.back().queueTime - mFrameTimes[first].queueTime;
+    return Fps::fromPeriodNsecs(totalTime / static_cast<nsecs_t>(numFrames - 1));
 }
 
 bool LayerInfo::isAnimating(nsecs_t now) const {
@@ -202,17 +199,14 @@ bool LayerInfo::hasEnoughDataForHeuristic() const {
 
 std::optional<nsecs_t> LayerInfo::calculateAverageFrameTime() const {
     // Ignore frames captured during a mode change
-    const bool isDuringModeChange =
-            std::any_of(mFrameTimes.begin(), mFrameTimes.end(),
-                        [](const auto& frame) { return frame.pendingModeChange; });
-    if (isDuringModeChange) {
-        return std::nullopt;
+    bool isMissingPresentTime = false;
+    for (size_t i = 0; i < mFrameTimes.size(); i++) {
+        if (mFrameTimes[i].pendingModeChange) {
+            return std::nullopt;
+        }
+        isMissingPresentTime |= mFrameTimes[i].presentTime == 0;
     }
 
-    const bool isMissingPresentTime =
-            std::any_of(mFrameTimes.begin(), mFrameTimes.end(),
-                        [](auto frame) { return frame.presentTime == 0; });
-
     // Calculate the average frame time based on presentation timestamps. If those
     // doesn't exist, we look at the time the buffer was queued only. We can do that only if
     // we calculated a refresh rate based on presentation timestamps in the past. The reason
@@ -227,9 +221,9 @@ std::optional<nsecs_t> LayerInfo::calculateAverageFrameTime() const {
     nsecs_t totalDeltas = 0;
     int numDeltas = 0;
     int32_t smallDirtyCount = 0;
-    auto prevFrame = mFrameTimes.begin();
-    for (auto it = mFrameTimes.begin() + 1; it != mFrameTimes.end(); ++it) {
-        const auto currDelta = getFrameTime(*it) - getFrameTime(*prevFrame);
+    size_t prevFrame = 0;
+    for (size_t i = 1; i < mFrameTimes.size(); i++) {
+        const auto currDelta = getFrameTime(mFrameTimes[i]) - getFrameTime(mFrameTimes[prevFrame]);
         if (currDelta < kMinPeriodBetweenFrames) {
             // Skip this frame, but count the delta into the next frame
             continue;
@@ -237,12 +231,12 @@ std::optional<nsecs_t> LayerInfo::calculateAverageFrameTime() const {
 
         // If this is a small area update, we don't want to consider it for calculating the average
         // frame time. Instead, we let the bigger frame updates to drive the calculation.
-        if (it->isSmallDirty && currDelta < kMinPeriodBetweenSmallDirtyFrames) {
+        if (mFrameTimes[i].isSmallDirty && currDelta < kMinPeriodBetweenSmallDirtyFrames) {
             smallDirtyCount++;
             continue;
         }
 
-        prevFrame = it;
+        prevFrame = i;
 
         if (currDelta > kMaxPeriodBetweenFrames) {
             // Skip this frame and the current delta.
@@ -31,6 +31,7 @@
 #include "FrameRateCompatibility.h"
 #include "LayerHistory.h"
 #include "RefreshRateSelector.h"
+#include "Utils/RingBuffer.h"
 
 namespace android {
 
@@ -346,10 +347,12 @@ private:
 
     RefreshRateHeuristicData mLastRefreshRate;
 
-    std::deque<FrameTimeData> mFrameTimes;
+    static constexpr size_t HISTORY_SIZE = RefreshRateHistory::HISTORY_SIZE;
+    // The most recent frames, oldest first. A fixed ring rather than a deque, so recording a
+    // frame never allocates.
+    utils::RingBuffer<FrameTimeData, HISTORY_SIZE> mFrameTimes;
     std::chrono::time_point<std::chrono::steady_clock> mFrameTimeValidSince =
             std::chrono::steady_clock::now();
-    static constexpr size_t HISTORY_SIZE = RefreshRateHistory::HISTORY_SIZE;
     static constexpr std::chrono::nanoseconds HISTORY_DURATION = LayerHistory::kMaxPeriodForHistory;
 
     std::unique_ptr<LayerProps> mLayerProps;
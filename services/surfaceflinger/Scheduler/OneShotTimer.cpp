@@ -15,29 +15,120 @@
  */
 
 #include "OneShotTimer.h"
+#include <pthread.h>
 #include <utils/Log.h>
-#include <utils/Timers.h>
+#include <algorithm>
 #include <chrono>
-#include <sstream>
+#include <condition_variable>
 #include <thread>
+#include <vector>
 
-namespace {
-using namespace std::chrono_literals;
+namespace android {
+namespace scheduler {
 
-constexpr int64_t kNsToSeconds = std::chrono::duration_cast<std::chrono::nanoseconds>(1s).count();
+class OneShotTimer::Service {
+public:
+    static Service& getInstance() {
+        // Never destroyed, since timers may outlive static destruction.
+        static Service& instance = *new Service();
+        return instance;
+    }
 
-// The syscall interface uses a pair of integers for the timestamp. The first
-// (tv_sec) is the whole count of seconds. The second (tv_nsec) is the
-// nanosecond part of the count. This function takes care of translation.
-void calculateTimeoutTime(std::chrono::nanoseconds timestamp, timespec* spec) {
-    const nsecs_t timeout = systemTime(CLOCK_MONOTONIC) + timestamp.count();
-    spec->tv_sec = static_cast<__kernel_time_t>(timeout / kNsToSeconds);
-    spec->tv_nsec = timeout % kNsToSeconds;
-}
-} // namespace
+    void add(OneShotTimer* timer) {
+        std::lock_guard lock(mMutex);
+        if (timer->mRegistered) return;
 
-namespace android {
-namespace scheduler {
+        timer->mRegistered = true;
+        timer->mState = TimerState::RESET;
+        timer->mResetTriggered = false;
+        timer->mWaiting = false;
+        timer->mWakeupTime.reset();
+        timer->mSignaled = true;
+        mTimers.push_back(timer);
+
+        if (!mThread.joinable()) {
+            mThread = std::thread(&Service::loop, this);
+        }
+        mCondition.notify_all();
+    }
+
+    void remove(OneShotTimer* timer) {
+        std::unique_lock lock(mMutex);
+        if (!timer->mRegistered) return;
+
+        timer->mRegistered = false;
+        timer->mState = TimerState::STOPPED;
+        timer->mSignaled = false;
+        timer->mWakeupTime.reset();
+        mTimers.erase(std::find(mTimers.begin(), mTimers.end(), timer));
+
+        // Wait for callbacks in flight, unless this is one of them.
+        if (std::this_thread::get_id() != mThread.get_id()) {
+            mCondition.wait(lock, [&]() REQUIRES(mMutex) { return mRunningTimer != timer; });
+        }
+    }
+
+    void signal(OneShotTimer* timer) {
+        std::lock_guard lock(mMutex);
+        if (!timer->mRegistered) return;
+
+        timer->mSignaled = true;
+        mCondition.notify_all();
+    }
+
+private:
+    Service() = default;
+
+    void loop() {
+        if (pthread_setname_np(pthread_self(), "OneShotTimer")) {
+            ALOGW("Failed to set thread name on dispatch thread");
+        }
+
+        std::unique_lock lock(mMutex);
+        while (true) {
+            const auto now = std::chrono::steady_clock::now();
+            auto nextWakeupTime = std::chrono::steady_clock::time_point::max();
+
+            // Callbacks release the lock, so the list may change while a timer runs. Run one due
+            // timer at a time, and scan again afterwards.
+            OneShotTimer* dueTimer = nullptr;
+            for (OneShotTimer* timer : mTimers) {
+                if (timer->mSignaled || (timer->mWakeupTime && *timer->mWakeupTime <= now)) {
+                    dueTimer = timer;
+                    break;
+                }
+                if (timer->mWakeupTime) {
+                    nextWakeupTime = std::min(nextWakeupTime, *timer->mWakeupTime);
+                }
+            }
+
+            if (dueTimer) {
+                dueTimer->mSignaled = false;
+                dueTimer->mWakeupTime.reset();
+                mRunningTimer = dueTimer;
+                const auto timeout = dueTimer->advance(lock);
+                if (dueTimer->mRegistered && timeout) {
+                    dueTimer->mWakeupTime = std::chrono::steady_clock::now() + *timeout;
+                }
+                mRunningTimer = nullptr;
+                mCondition.notify_all();
+                continue;
+            }
+
+            if (nextWakeupTime == std::chrono::steady_clock::time_point::max()) {
+                mCondition.wait(lock);
+            } else {
+                mCondition.wait_until(lock, nextWakeupTime);
+            }
+        }
+    }
+
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::thread mThread GUARDED_BY(mMutex);
+    std::vector<OneShotTimer*> mTimers GUARDED_BY(mMutex);
+    OneShotTimer* mRunningTimer GUARDED_BY(mMutex) = nullptr;
+};
 
 OneShotTimer::OneShotTimer(std::string name, const Interval& interval,
                            const ResetCallback& resetCallback,
@@ -56,141 +147,73 @@ OneShotTimer::~OneShotTimer() {
 }
 
 void OneShotTimer::start() {
-    int result = sem_init(&mSemaphore, 0, 0);
-    LOG_ALWAYS_FATAL_IF(result, "sem_init failed");
-
-    if (!mThread.joinable()) {
-        // Only create thread if it has not been created.
-        mThread = std::thread(&OneShotTimer::loop, this);
-    }
+    Service::getInstance().add(this);
 }
 
 void OneShotTimer::stop() {
-    mStopTriggered = true;
-    int result = sem_post(&mSemaphore);
-    LOG_ALWAYS_FATAL_IF(result, "sem_post failed");
-
-    if (mThread.joinable()) {
-        mThread.join();
-        result = sem_destroy(&mSemaphore);
-        LOG_ALWAYS_FATAL_IF(result, "sem_destroy failed");
-    }
+    Service::getInstance().remove(this);
 }
 
-void OneShotTimer::loop() {
-    if (pthread_setname_np(pthread_self(), mName.c_str())) {
-        ALOGW("Failed to set thread name on dispatch thread");
-    }
-
-    TimerState state = TimerState::RESET;
-    while (true) {
-        bool triggerReset = false;
-        bool triggerTimeout = false;
-
-        state = checkForResetAndStop(state);
-        if (state == TimerState::STOPPED) {
-            break;
+std::optional<std::chrono::nanoseconds> OneShotTimer::advance(
+        std::unique_lock<std::mutex>& serviceLock) {
+    // Fires a callback without the service lock, and returns whether the timer is still running.
+    const auto fire = [&](const std::function<void()>& callback) {
+        if (callback) {
+            serviceLock.unlock();
+            callback();
+            serviceLock.lock();
         }
+        return mRegistered;
+    };
 
-        if (state == TimerState::IDLE) {
-            int result = sem_wait(&mSemaphore);
-            if (result && errno != EINTR) {
-                std::stringstream ss;
-                ss << "sem_wait failed (" << errno << ")";
-                LOG_ALWAYS_FATAL("%s", ss.str().c_str());
+    while (true) {
+        if (mState == TimerState::IDLE) {
+            if (!mResetTriggered.exchange(false)) {
+                mWaiting = false;
+                return std::nullopt;
             }
-            continue;
+            mState = TimerState::RESET;
         }
 
-        if (state == TimerState::RESET) {
-            triggerReset = true;
+        if (mState == TimerState::RESET) {
+            if (!fire(mResetCallback)) return std::nullopt;
+            mTriggerTime = mClock->now() + mInterval.load();
+            mState = TimerState::WAITING;
         }
 
-        if (triggerReset && mResetCallback) {
-            mResetCallback();
+        // Resets while waiting only push the trigger time out.
+        if (mResetTriggered.exchange(false)) {
+            mTriggerTime = mLastResetTime.load() + mInterval.load();
         }
 
-        state = checkForResetAndStop(state);
-        if (state == TimerState::STOPPED) {
-            break;
+        // Wait until triggerTime time to check if we need to reset or drop into the idle state.
+        // While paused, wait until resumed.
+        mWaiting = true;
+        if (mPaused) {
+            return std::nullopt;
         }
-
-        auto triggerTime = mClock->now() + mInterval.load();
-        state = TimerState::WAITING;
-        while (true) {
-            if (mPaused) {
-                mWaiting = true;
-                int result = sem_wait(&mSemaphore);
-                if (result && errno != EINTR) {
-                    std::stringstream ss;
-                    ss << "sem_wait failed (" << errno << ")";
-                    LOG_ALWAYS_FATAL("%s", ss.str().c_str());
-                }
-
-                mWaiting = false;
-                state = checkForResetAndStop(state);
-                if (state == TimerState::STOPPED) {
-                    break;
-                }
-            }
-            // Wait until triggerTime time to check if we need to reset or drop into the idle state.
-            if (const auto triggerInterval = triggerTime - mClock->now(); triggerInterval > 0ns) {
-                mWaiting = true;
-                struct timespec ts;
-                calculateTimeoutTime(triggerInterval, &ts);
-                int result = sem_clockwait(&mSemaphore, CLOCK_MONOTONIC, &ts);
-                if (result && errno != ETIMEDOUT && errno != EINTR) {
-                    std::stringstream ss;
-                    ss << "sem_clockwait failed (" << errno << ")";
-                    LOG_ALWAYS_FATAL("%s", ss.str().c_str());
-                }
-            }
-
-            mWaiting = false;
-            state = checkForResetAndStop(state);
-            if (state == TimerState::STOPPED) {
-                break;
-            }
-
-            if (!mPaused && state == TimerState::WAITING && (triggerTime - mClock->now()) <= 0ns) {
-                triggerTimeout = true;
-                state = TimerState::IDLE;
-                break;
-            }
-
-            if (state == TimerState::RESET) {
-                triggerTime = mLastResetTime.load() + mInterval.load();
-                state = TimerState::WAITING;
-            }
+        if (const auto triggerInterval = mTriggerTime - mClock->now(); triggerInterval > 0ns) {
+            return triggerInterval;
         }
+        mWaiting = false;
 
-        if (triggerTimeout && mTimeoutCallback) {
-            mTimeoutCallback();
+        if (mResetTriggered) {
+            continue;
         }
-    }
-}
 
-OneShotTimer::TimerState OneShotTimer::checkForResetAndStop(TimerState state) {
-    // Stop takes precedence of the reset.
-    if (mStopTriggered.exchange(false)) {
-        return TimerState::STOPPED;
-    }
-    // If the state was stopped, the thread was joined, and we cannot reset
-    // the timer anymore.
-    if (state != TimerState::STOPPED && mResetTriggered.exchange(false)) {
-        return TimerState::RESET;
+        mState = TimerState::IDLE;
+        if (!fire(mTimeoutCallback)) return std::nullopt;
     }
-    return state;
 }
 
 void OneShotTimer::reset() {
     mLastResetTime = mClock->now();
     mResetTriggered = true;
-    // If mWaiting is true, then we are guaranteed to be in a block where we are waiting on
-    // mSemaphore for a timeout, rather than idling. So we can avoid a sem_post call since we can
-    // just check that we triggered a reset on timeout.
+    // If mWaiting is true, then the timer is guaranteed to run again, either at its wakeup time or
+    // when resumed, rather than idling. So we can avoid signaling it since it will check that we
+    // triggered a reset then.
     if (!mWaiting) {
-        LOG_ALWAYS_FATAL_IF(sem_post(&mSemaphore), "sem_post failed");
+        Service::getInstance().signal(this);
     }
 }
 
@@ -200,7 +223,7 @@ void OneShotTimer::pause() {
 
 void OneShotTimer::resume() {
     if (mPaused.exchange(false)) {
-        LOG_ALWAYS_FATAL_IF(sem_post(&mSemaphore), "sem_post failed");
+        Service::getInstance().signal(this);
     }
 }
 
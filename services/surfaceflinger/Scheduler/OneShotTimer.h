@@ -16,10 +16,12 @@
 
 #pragma once
 
-#include <semaphore.h>
+#include <atomic>
 #include <chrono>
-#include <condition_variable>
-#include <thread>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
 #include "../Clock.h"
 
 #include <android-base/thread_annotations.h>
@@ -31,6 +33,8 @@ namespace scheduler {
 /*
  * Class that sets off a timer for a given interval, and fires a callback when the
  * interval expires.
+ *
+ * All timers share one thread, on which their callbacks run, so callbacks should not block.
  */
 class OneShotTimer {
 public:
@@ -58,9 +62,13 @@ public:
     void resume();
 
 private:
+    // The thread shared by all timers, which runs each timer when it is signaled or its wakeup
+    // time passes.
+    class Service;
+
     // Enum to track in what state is the timer.
     enum class TimerState {
-        // The internal timer thread has been destroyed, and no state is
+        // The timer is not registered with the service, and no state is
         // tracked.
         // Possible state transitions: RESET
         STOPPED = 0,
@@ -76,22 +84,14 @@ private:
         IDLE = 3
     };
 
-    // Function that loops until the condition for stopping is met.
-    void loop();
-
-    // Checks whether mResetTriggered and mStopTriggered were set and updates
-    // mState if so.
-    TimerState checkForResetAndStop(TimerState state);
-
-    // Thread waiting for timer to expire.
-    std::thread mThread;
+    // Runs the state machine on the service thread until the timer has to wait, firing callbacks
+    // on the way with the service lock released. Returns the time until the timer needs to run
+    // again, or nullopt if it only needs to run once signaled.
+    std::optional<std::chrono::nanoseconds> advance(std::unique_lock<std::mutex>& serviceLock);
 
     // Clock object for the timer. Mocked in unit tests.
     std::unique_ptr<android::Clock> mClock;
 
-    // Semaphore to keep mThread synchronized.
-    sem_t mSemaphore;
-
     // Timer's name.
     std::string mName;
 
@@ -104,11 +104,19 @@ private:
     // Callback that happens when timer expires.
     const TimeoutCallback mTimeoutCallback;
 
-    // After removing lock guarding mState, the state can be now accessed at
-    // any time. Keep a bool if the reset or stop were requested, and occasionally
-    // check in the main loop if they were.
+    // State owned by the service thread.
+    TimerState mState = TimerState::STOPPED;
+    std::chrono::steady_clock::time_point mTriggerTime;
+
+    // State guarded by the service lock.
+    bool mRegistered = false;
+    bool mSignaled = false;
+    std::optional<std::chrono::steady_clock::time_point> mWakeupTime;
+
+    // reset() is called often, so it only sets mResetTriggered, and the service checks it when
+    // the timer next runs. The timer is only signaled when it is not already waiting for a
+    // wakeup, in which case mWaiting is false.
     std::atomic<bool> mResetTriggered = false;
-    std::atomic<bool> mStopTriggered = false;
     std::atomic<bool> mWaiting = false;
     std::atomic<bool> mPaused = false;
     std::atomic<std::chrono::steady_clock::time_point> mLastResetTime;
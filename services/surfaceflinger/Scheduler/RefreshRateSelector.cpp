@@ -21,6 +21,7 @@
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wextra"
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <deque>
@@ -33,6 +34,7 @@
 #include <ftl/fake_guard.h>
 #include <ftl/match.h>
 #include <ftl/unit.h>
+#include <math/HashCombine.h>
 #include <scheduler/Fps.h>
 #include <scheduler/FrameRateMode.h>
 
@@ -477,17 +479,43 @@ float RefreshRateSelector::calculateLayerScoreLocked(const LayerRequirement& lay
 auto RefreshRateSelector::getRankedFrameRates(const std::vector<LayerRequirement>& layers,
                                               GlobalSignals signals, Fps pacesetterFps) const
         -> RankedFrameRates {
-    GetRankedFrameRatesCache cache{layers, signals, pacesetterFps};
+    const size_t key = GetRankedFrameRatesCache::makeKey(layers, signals);
 
     std::lock_guard lock(mLock);
 
-    if (mGetRankedFrameRatesCache && mGetRankedFrameRatesCache->matches(cache)) {
-        return mGetRankedFrameRatesCache->result;
+    const auto it = std::find_if(mGetRankedFrameRatesCache.begin(),
+                                 mGetRankedFrameRatesCache.end(), [&](const auto& cache) {
+                                     return cache.matches(layers, signals, pacesetterFps, key);
+                                 });
+    if (it != mGetRankedFrameRatesCache.end()) {
+        std::rotate(mGetRankedFrameRatesCache.begin(), it, it + 1);
+        return mGetRankedFrameRatesCache.front().result;
+    }
+
+    if (mGetRankedFrameRatesCache.size() == kRankedFrameRatesCacheSize) {
+        mGetRankedFrameRatesCache.pop_back();
     }
+    GetRankedFrameRatesCache cache{layers, signals, pacesetterFps,
+                                   getRankedFrameRatesLocked(layers, signals, pacesetterFps), key};
+    mGetRankedFrameRatesCache.insert(mGetRankedFrameRatesCache.begin(), std::move(cache));
+    return mGetRankedFrameRatesCache.front().result;
+}
 
-    cache.result = getRankedFrameRatesLocked(layers, signals, pacesetterFps);
-    mGetRankedFrameRatesCache = std::move(cache);
-    return mGetRankedFrameRatesCache->result;
+size_t RefreshRateSelector::GetRankedFrameRatesCache::makeKey(
+        const std::vector<LayerRequirement>& layers, GlobalSignals signals) {
+    // Only hash what LayerRequirement::operator== compares exactly, since approximately equal
+    // frame rates can hash differently.
+    size_t key = hashCombine(signals.touch, signals.idle, signals.powerOnImminent,
+                             signals.heuristicIdle, layers.size());
+    for (const auto& layer : layers) {
+        hashCombineSingle(key, layer.name);
+        hashCombineSingle(key, ftl::to_underlying(layer.vote));
+        hashCombineSingle(key, ftl::to_underlying(layer.seamlessness));
+        hashCombineSingle(key, ftl::to_underlying(layer.frameRateCategory));
+        hashCombineSingle(key, layer.weight);
+        hashCombineSingle(key, layer.focused);
+    }
+    return key;
 }
 
 auto RefreshRateSelector::getRankedFrameRatesLocked(const std::vector<LayerRequirement>& layers,
@@ -1303,7 +1331,7 @@ void RefreshRateSelector::setActiveMode(DisplayModeId modeId, Fps renderFrameRat
 
     // Invalidate the cached invocation to getRankedFrameRates. This forces
     // the refresh rate to be recomputed on the next call to getRankedFrameRates.
-    mGetRankedFrameRatesCache.reset();
+    mGetRankedFrameRatesCache.clear();
 
     const auto activeModeOpt = mDisplayModes.get(modeId);
     LOG_ALWAYS_FATAL_IF(!activeModeOpt);
@@ -1344,7 +1372,7 @@ void RefreshRateSelector::updateDisplayModes(DisplayModes modes, DisplayModeId a
 
     // Invalidate the cached invocation to getRankedFrameRates. This forces
     // the refresh rate to be recomputed on the next call to getRankedFrameRates.
-    mGetRankedFrameRatesCache.reset();
+    mGetRankedFrameRatesCache.clear();
 
     mDisplayModes = std::move(modes);
     const auto activeModeOpt = mDisplayModes.get(activeModeId);
@@ -1444,7 +1472,7 @@ auto RefreshRateSelector::setPolicy(const PolicyVariant& policy) -> SetPolicyRes
             return SetPolicyResult::Invalid;
         }
 
-        mGetRankedFrameRatesCache.reset();
+        mGetRankedFrameRatesCache.clear();
 
         const auto& idleScreenConfigOpt = getCurrentPolicyLocked()->idleScreenConfigOpt;
         if (idleScreenConfigOpt != oldPolicy.idleScreenConfigOpt) {
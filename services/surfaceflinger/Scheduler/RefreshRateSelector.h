@@ -577,12 +577,26 @@ private:
 
         RankedFrameRates result;
 
-        bool matches(const GetRankedFrameRatesCache& other) const {
-            return layers == other.layers && signals == other.signals &&
-                    isApproxEqual(pacesetterFps, other.pacesetterFps);
+        // Hash of the arguments, so that entries for other arguments are skipped without
+        // comparing every layer.
+        size_t key = 0;
+
+        static size_t makeKey(const std::vector<LayerRequirement>&, GlobalSignals);
+
+        bool matches(const std::vector<LayerRequirement>& otherLayers, GlobalSignals otherSignals,
+                     Fps otherPacesetterFps, size_t otherKey) const {
+            return key == otherKey && signals == otherSignals &&
+                    isApproxEqual(pacesetterFps, otherPacesetterFps) && layers == otherLayers;
         }
     };
-    mutable std::optional<GetRankedFrameRatesCache> mGetRankedFrameRatesCache GUARDED_BY(mLock);
+
+    // The number of getRankedFrameRates invocations that are cached, so that a summary which
+    // alternates between a few states, e.g. with touch boost, is not ranked again every time.
+    static constexpr size_t kRankedFrameRatesCacheSize = 4;
+
+    // The cached invocations, from the most to the least recently used. Cleared whenever the
+    // display modes or the policy change.
+    mutable std::vector<GetRankedFrameRatesCache> mGetRankedFrameRatesCache GUARDED_BY(mLock);
 
     // Declare mIdleTimer last to ensure its thread joins before the mutex/callbacks are destroyed.
     std::mutex mIdleTimerCallbacksMutex;
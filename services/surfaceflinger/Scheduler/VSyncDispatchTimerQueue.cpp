@@ -16,11 +16,10 @@
 
 #define ATRACE_TAG ATRACE_TAG_GRAPHICS
 
-#include <vector>
-
 #include <android-base/stringprintf.h>
 #include <common/trace.h>
 #include <ftl/concat.h>
+#include <ftl/small_vector.h>
 #include <log/log_main.h>
 
 #include <scheduler/TimeKeeper.h>
@@ -358,7 +357,8 @@ void VSyncDispatchTimerQueue::timerCallback() {
         nsecs_t wakeupTimestamp;
         nsecs_t deadlineTimestamp;
     };
-    std::vector<Invocation> invocations;
+    // Usually only one or two callbacks are due, so keep them on the stack.
+    ftl::SmallVector<Invocation, 4> invocations;
     {
         std::lock_guard lock(mMutex);
         if (!mRunning) {
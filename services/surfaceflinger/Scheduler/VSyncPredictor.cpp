@@ -181,7 +181,11 @@ bool VSyncPredictor::addVsyncTimestamp(nsecs_t timestamp) {
 
     const size_t numSamples = mTimestamps.size();
     if (numSamples < kMinimumSamplesForPrediction) {
-        mRateMap[idealPeriod()] = {idealPeriod(), 0};
+        // Until there are enough samples for a fit, predict from the oldest sample with the period
+        // learned the last time the display ran at this rate, so that a mode switch back to a
+        // known rate is predicted accurately from its first vsync.
+        Model& model = mRateMap[idealPeriod()];
+        model = {model.slope != 0 ? model.slope : idealPeriod(), 0};
         return true;
     }
 
@@ -200,8 +204,11 @@ bool VSyncPredictor::addVsyncTimestamp(nsecs_t timestamp) {
     //
     // intercept = mean(Y) - slope * mean(X)
     //
-    std::vector<nsecs_t> vsyncTS(numSamples);
-    std::vector<nsecs_t> ordinals(numSamples);
+    // Reuse the scratch buffers across samples, so that the fit does not allocate.
+    std::vector<nsecs_t>& vsyncTS = mFitTimestamps;
+    std::vector<nsecs_t>& ordinals = mFitOrdinals;
+    vsyncTS.resize(numSamples);
+    ordinals.resize(numSamples);
 
     // Normalizing to the oldest timestamp cuts down on error in calculating the intercept.
     const auto oldestTS = *std::min_element(mTimestamps.begin(), mTimestamps.end());
@@ -230,16 +237,15 @@ bool VSyncPredictor::addVsyncTimestamp(nsecs_t timestamp) {
     meanTS /= numSamples;
     meanOrdinal /= numSamples;
 
-    for (size_t i = 0; i < numSamples; i++) {
-        vsyncTS[i] -= meanTS;
-        ordinals[i] -= meanOrdinal;
-    }
-
+    // Center the samples while accumulating, in a loop without branches that the compiler
+    // can vectorize.
     nsecs_t top = 0;
     nsecs_t bottom = 0;
     for (size_t i = 0; i < numSamples; i++) {
-        top += vsyncTS[i] * ordinals[i];
-        bottom += ordinals[i] * ordinals[i];
+        const nsecs_t centeredTS = vsyncTS[i] - meanTS;
+        const nsecs_t centeredOrdinal = ordinals[i] - meanOrdinal;
+        top += centeredTS * centeredOrdinal;
+        bottom += centeredOrdinal * centeredOrdinal;
     }
 
     if (CC_UNLIKELY(bottom == 0)) {
@@ -274,8 +280,8 @@ nsecs_t VSyncPredictor::snapToVsync(nsecs_t timePoint) const {
     if (mTimestamps.empty()) {
         traceInt64("VSP-mode", 1);
         auto const knownTimestamp = mKnownTimestamp ? *mKnownTimestamp : timePoint;
-        auto const numPeriodsOut = ((timePoint - knownTimestamp) / idealPeriod()) + 1;
-        return knownTimestamp + numPeriodsOut * idealPeriod();
+        auto const numPeriodsOut = ((timePoint - knownTimestamp) / slope) + 1;
+        return knownTimestamp + numPeriodsOut * slope;
     }
 
     auto const oldest = *std::min_element(mTimestamps.begin(), mTimestamps.end());
@@ -159,6 +159,10 @@ private:
     size_t mLastTimestampIndex GUARDED_BY(mMutex) = 0;
     std::vector<nsecs_t> mTimestamps GUARDED_BY(mMutex);
 
+    // Scratch space for the linear regression in addVsyncTimestamp.
+    std::vector<nsecs_t> mFitTimestamps GUARDED_BY(mMutex);
+    std::vector<nsecs_t> mFitOrdinals GUARDED_BY(mMutex);
+
     ftl::NonNull<DisplayModePtr> mDisplayModePtr GUARDED_BY(mMutex);
     int mNumVsyncsForFrame GUARDED_BY(mMutex);
 
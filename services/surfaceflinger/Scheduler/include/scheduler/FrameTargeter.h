@@ -152,8 +152,9 @@ public:
 
 private:
     friend class FrameTargeterTestBase;
+    friend class ScheduleSimulator;
 
-    // For tests.
+    // For tests, and for simulation with fake fences.
     using IsFencePendingFuncPtr = bool (*)(const FenceTimePtr&, int graceTimeMs);
     void beginFrame(const BeginFrameArgs&, const IVsyncSource&, IsFencePendingFuncPtr);
     FenceTimePtr setPresentFence(sp<Fence>, FenceTimePtr);
@@ -0,0 +1,330 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#undef LOG_TAG
+#define LOG_TAG "ScheduleSimulator"
+
+#include "ScheduleSimulator.h"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <utility>
+
+#include <android-base/stringprintf.h>
+#include <ui/FenceTime.h>
+
+#include <DisplayHardware/DisplayMode.h>
+#include <Scheduler/VSyncPredictor.h>
+#include <Scheduler/VSyncReactor.h>
+#include <scheduler/FrameTargeter.h>
+#include <scheduler/IVsyncSource.h>
+#include <scheduler/PresentLatencyTracker.h>
+
+namespace android::scheduler {
+
+namespace {
+
+using base::StringAppendF;
+
+// The same as VsyncSchedule::createTracker and VsyncSchedule::createController.
+constexpr size_t kHistorySize = 20;
+constexpr size_t kMinSamplesForPrediction = 6;
+constexpr uint32_t kDiscardOutlierPercent = 20;
+constexpr size_t kMaxPendingFences = 20;
+
+// A frame that is backpressured for this many vsyncs in a row is composed anyway, so that a
+// trace whose vsyncs stop before its frames do does not stall the simulation.
+constexpr int kMaxBackpressuredVsyncs = 8;
+
+class SimulatedClock final : public Clock {
+public:
+    explicit SimulatedClock(const nsecs_t& now) : mNow(now) {}
+    nsecs_t now() const override { return mNow; }
+
+private:
+    const nsecs_t& mNow;
+};
+
+class PredictedVsyncSource final : public IVsyncSource {
+public:
+    explicit PredictedVsyncSource(VSyncTracker& tracker) : mTracker(tracker) {}
+
+    Period period() const override { return Period::fromNs(mTracker.currentPeriod()); }
+    TimePoint vsyncDeadlineAfter(TimePoint timePoint,
+                                 ftl::Optional<TimePoint> lastVsyncOpt = {}) const override {
+        return TimePoint::fromNs(
+                mTracker.nextAnticipatedVSyncTimeFrom(timePoint.ns(),
+                                                      lastVsyncOpt.transform(
+                                                              [](TimePoint t) { return t.ns(); })));
+    }
+    Period minFramePeriod() const override { return mTracker.minFramePeriod(); }
+
+private:
+    VSyncTracker& mTracker;
+};
+
+// The simulated fences are signaled explicitly, so there is nothing to wait for.
+bool isFencePending(const FenceTimePtr& fence, int /* graceTimeMs */) {
+    return fence->getSignalTime() == Fence::SIGNAL_TIME_PENDING;
+}
+
+Duration percentile(std::vector<Duration> durations, int percent) {
+    if (durations.empty()) return Duration::fromNs(0);
+    const size_t index = (durations.size() - 1) * static_cast<size_t>(percent) / 100;
+    std::nth_element(durations.begin(), durations.begin() + static_cast<ptrdiff_t>(index),
+                     durations.end());
+    return durations[index];
+}
+
+void dumpDurations(std::string& result, const char* name, const std::vector<Duration>& durations) {
+    StringAppendF(&result, "%-18s p50=%.3fms p90=%.3fms p99=%.3fms max=%.3fms\n", name,
+                  ticks<std::milli, float>(percentile(durations, 50)),
+                  ticks<std::milli, float>(percentile(durations, 90)),
+                  ticks<std::milli, float>(percentile(durations, 99)),
+                  ticks<std::milli, float>(percentile(durations, 100)));
+}
+
+} // namespace
+
+std::optional<ScheduleTrace> ScheduleTrace::parse(std::istream& input, std::string* outError) {
+    ScheduleTrace trace;
+    std::string line;
+    for (size_t lineNumber = 1; std::getline(input, line); lineNumber++) {
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream fields(line);
+        std::string event;
+        fields >> event;
+        bool valid = false;
+        if (event == "refresh_rate") {
+            float hz = 0.f;
+            valid = static_cast<bool>(fields >> hz) && hz > 0.f;
+            trace.refreshRate = Fps::fromValue(hz);
+        } else if (event == "hw_vsync") {
+            nsecs_t timestamp = 0;
+            valid = static_cast<bool>(fields >> timestamp);
+            trace.hwVsyncs.push_back(timestamp);
+        } else if (event == "present_fence") {
+            nsecs_t signalTime = 0;
+            valid = static_cast<bool>(fields >> signalTime);
+            trace.presentFences.push_back(signalTime);
+        } else if (event == "frame") {
+            Frame frame;
+            valid = static_cast<bool>(fields >> frame.requestTime >> frame.cpuDuration >>
+                                      frame.gpuDuration);
+            int jank = 0;
+            if (fields >> jank) {
+                frame.recordedJank = jank != 0;
+            }
+            trace.frames.push_back(frame);
+        }
+        if (!valid) {
+            *outError = "Invalid line " + std::to_string(lineNumber) + ": " + line;
+            return std::nullopt;
+        }
+    }
+
+    if (!trace.refreshRate.isValid()) {
+        *outError = "Missing refresh_rate";
+        return std::nullopt;
+    }
+    std::sort(trace.hwVsyncs.begin(), trace.hwVsyncs.end());
+    std::sort(trace.presentFences.begin(), trace.presentFences.end());
+    std::stable_sort(trace.frames.begin(), trace.frames.end(),
+                     [](const Frame& lhs, const Frame& rhs) {
+                         return lhs.requestTime < rhs.requestTime;
+                     });
+    return trace;
+}
+
+ScheduleSimulator::ScheduleSimulator(const ScheduleTrace& trace, const ScheduleConfig& config)
+      : mTrace(trace), mConfig(config) {
+    std::merge(trace.hwVsyncs.begin(), trace.hwVsyncs.end(), trace.presentFences.begin(),
+               trace.presentFences.end(), std::back_inserter(mActualVsyncs));
+
+    // A present fence signals on a vsync which may also have been recorded as a HW vsync.
+    const nsecs_t halfPeriod = trace.refreshRate.getPeriodNsecs() / 2;
+    mActualVsyncs.erase(std::unique(mActualVsyncs.begin(), mActualVsyncs.end(),
+                                    [halfPeriod](nsecs_t lhs, nsecs_t rhs) {
+                                        return rhs - lhs < halfPeriod;
+                                    }),
+                        mActualVsyncs.end());
+}
+
+nsecs_t ScheduleSimulator::actualVsyncAtOrAfter(nsecs_t time) const {
+    const nsecs_t period = mTrace.refreshRate.getPeriodNsecs();
+    const auto it = std::lower_bound(mActualVsyncs.begin(), mActualVsyncs.end(), time);
+    if (it == mActualVsyncs.begin()) {
+        return it == mActualVsyncs.end() ? time : *it;
+    }
+
+    const nsecs_t previous = *std::prev(it);
+    const nsecs_t extrapolated = previous + (time - previous + period - 1) / period * period;
+    if (it == mActualVsyncs.end() || extrapolated < *it - period / 2) {
+        return extrapolated;
+    }
+    return *it;
+}
+
+ScheduleReport ScheduleSimulator::run() {
+    ScheduleReport report;
+
+    nsecs_t now = std::numeric_limits<nsecs_t>::max();
+    if (!mTrace.hwVsyncs.empty()) now = mTrace.hwVsyncs.front();
+    if (!mTrace.frames.empty()) now = std::min(now, mTrace.frames.front().requestTime);
+
+    const auto displayId = PhysicalDisplayId::fromPort(0);
+    const ftl::NonNull<DisplayModePtr> modePtr = ftl::as_non_null(
+            DisplayMode::Builder(hal::HWConfigId(0))
+                    .setId(DisplayModeId(0))
+                    .setPhysicalDisplayId(displayId)
+                    .setVsyncPeriod(mTrace.refreshRate.getPeriodNsecs())
+                    .build());
+    VSyncPredictor tracker(std::make_unique<SimulatedClock>(now), modePtr, kHistorySize,
+                           kMinSamplesForPrediction, kDiscardOutlierPercent);
+    VSyncReactor reactor(displayId, std::make_unique<SimulatedClock>(now), tracker,
+                         kMaxPendingFences, mConfig.features.test(Feature::kKernelIdleTimer));
+    reactor.setIgnorePresentFences(!mConfig.features.test(Feature::kPresentFences));
+    const PredictedVsyncSource vsyncSource(tracker);
+
+    FrameTargeter targeter(displayId, mConfig.features);
+    PresentLatencyTracker presentLatencyTracker;
+    FenceToFenceTimeMap fenceMap;
+
+    // Frames which were composed, but whose present fence has not signaled by `now`.
+    struct PendingPresent {
+        sp<Fence> fence;
+        nsecs_t presentTime;
+    };
+    std::vector<PendingPresent> pendingPresents;
+
+    bool hwVsyncEnabled = true;
+    size_t nextHwVsync = 0;
+    const auto advanceTo = [&](nsecs_t time) {
+        now = std::max(now, time);
+        for (; nextHwVsync < mTrace.hwVsyncs.size() && mTrace.hwVsyncs[nextHwVsync] <= now;
+             nextHwVsync++) {
+            if (hwVsyncEnabled) {
+                bool periodFlushed = false;
+                hwVsyncEnabled = reactor.addHwVsyncTimestamp(mTrace.hwVsyncs[nextHwVsync],
+                                                             std::nullopt, &periodFlushed);
+            }
+        }
+        const auto signaled = std::remove_if(pendingPresents.begin(), pendingPresents.end(),
+                                             [&](const PendingPresent& present) {
+                                                 if (present.presentTime > now) return false;
+                                                 fenceMap.signalAllForTest(present.fence,
+                                                                           present.presentTime);
+                                                 return true;
+                                             });
+        pendingPresents.erase(signaled, pendingPresents.end());
+    };
+    const auto enableHwVsync = [&] {
+        if (!hwVsyncEnabled) {
+            tracker.resetModel();
+            hwVsyncEnabled = true;
+            report.resyncCount++;
+        }
+    };
+
+    const nsecs_t workDuration = mConfig.sfWorkDuration.ns();
+    const nsecs_t halfPeriod = mTrace.refreshRate.getPeriodNsecs() / 2;
+    nsecs_t mainThreadIdleTime = now;
+    nsecs_t lastPresentTime = 0;
+    int64_t vsyncId = 1;
+    for (const ScheduleTrace::Frame& frame : mTrace.frames) {
+        nsecs_t earliestWakeupTime = std::max(frame.requestTime, mainThreadIdleTime);
+        nsecs_t wakeupTime;
+        nsecs_t vsyncTime;
+        for (int backpressuredVsyncs = 0;; backpressuredVsyncs++) {
+            advanceTo(earliestWakeupTime);
+            vsyncTime = tracker.nextAnticipatedVSyncTimeFrom(earliestWakeupTime + workDuration);
+            wakeupTime = vsyncTime - workDuration;
+            advanceTo(wakeupTime);
+
+            targeter.beginFrame({.frameBeginTime = TimePoint::fromNs(wakeupTime),
+                                 .vsyncId = VsyncId{vsyncId++},
+                                 .expectedVsyncTime = TimePoint::fromNs(vsyncTime),
+                                 .sfWorkDuration = mConfig.sfWorkDuration,
+                                 .hwcMinWorkDuration = mConfig.hwcMinWorkDuration},
+                                vsyncSource, &isFencePending);
+            if (targeter.target().didMissFrame()) {
+                report.missedFrameCount++;
+            }
+            // SurfaceFlinger skips the frame, and tries again on the next vsync.
+            if (!targeter.target().wouldBackpressureHwc() ||
+                backpressuredVsyncs == kMaxBackpressuredVsyncs) {
+                break;
+            }
+            report.backpressuredFrameCount++;
+            earliestWakeupTime = wakeupTime + 1;
+        }
+
+        const nsecs_t compositeTime = wakeupTime + frame.cpuDuration;
+        advanceTo(compositeTime);
+
+        // HWC presents on the first vsync once the GPU is done, one frame per vsync.
+        nsecs_t earliestPresentTime =
+                std::max(compositeTime + frame.gpuDuration, lastPresentTime + halfPeriod);
+        if (mConfig.features.test(Feature::kExpectedPresentTime)) {
+            earliestPresentTime = std::max(earliestPresentTime,
+                                           targeter.target().expectedPresentTime().ns() -
+                                                   halfPeriod);
+        } else if (const auto earliest = targeter.target().earliestPresentTime()) {
+            earliestPresentTime = std::max(earliestPresentTime, earliest->ns());
+        }
+        const nsecs_t presentTime = actualVsyncAtOrAfter(earliestPresentTime);
+        lastPresentTime = presentTime;
+
+        auto [fence, fenceTime] = fenceMap.makePendingFenceForTest();
+        targeter.setPresentFence(fence, fenceTime);
+        targeter.endFrame({.compositionCoverage = frame.gpuDuration > 0 ? CompositionCoverage::Gpu
+                                                                        : CompositionCoverage::Hwc});
+        const Duration presentLatency =
+                presentLatencyTracker.trackPendingFrame(TimePoint::fromNs(compositeTime),
+                                                        fenceTime);
+        if (presentLatency.ns() > 0) {
+            report.presentLatencies.push_back(presentLatency);
+        }
+        if (reactor.addPresentFence(fenceTime)) {
+            enableHwVsync();
+        }
+        pendingPresents.push_back({std::move(fence), presentTime});
+
+        report.frameCount++;
+        if (frame.recordedJank) report.recordedJankCount++;
+        report.frameLatencies.push_back(Duration::fromNs(presentTime - frame.requestTime));
+        report.predictionErrors.push_back(Duration::fromNs(
+                std::abs(actualVsyncAtOrAfter(vsyncTime - halfPeriod) - vsyncTime)));
+        mainThreadIdleTime = compositeTime;
+    }
+
+    return report;
+}
+
+void ScheduleReport::dump(std::string& result) const {
+    StringAppendF(&result, "Frames: %zu\n", frameCount);
+    StringAppendF(&result, "Missed frames: %zu (recorded jank: %zu)\n", missedFrameCount,
+                  recordedJankCount);
+    StringAppendF(&result, "Backpressured frames: %zu\n", backpressuredFrameCount);
+    StringAppendF(&result, "Resyncs: %zu\n", resyncCount);
+    dumpDurations(result, "Present latency:", presentLatencies);
+    dumpDurations(result, "Frame latency:", frameLatencies);
+    dumpDurations(result, "Prediction error:", predictionErrors);
+}
+
+} // namespace android::scheduler
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <istream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <scheduler/Features.h>
+#include <scheduler/Fps.h>
+#include <scheduler/Time.h>
+
+namespace android::scheduler {
+
+// The schedule of a display recorded on a device, in the format described in readme.md.
+struct ScheduleTrace {
+    // A frame SurfaceFlinger was asked to compose, and how long composing it took.
+    struct Frame {
+        // When a transaction or buffer made the frame necessary.
+        nsecs_t requestTime = 0;
+        // Main thread time of the commit and composite.
+        nsecs_t cpuDuration = 0;
+        // Zero if the frame was composed by HWC alone.
+        nsecs_t gpuDuration = 0;
+        // Whether the frame was reported as janky on the device.
+        bool recordedJank = false;
+    };
+
+    Fps refreshRate;
+    // Sorted timestamps of the HW vsync callbacks, which only arrive while SurfaceFlinger
+    // resyncs its vsync model.
+    std::vector<nsecs_t> hwVsyncs;
+    // Sorted signal times of the present fences.
+    std::vector<nsecs_t> presentFences;
+    std::vector<Frame> frames;
+
+    // Returns nullopt and sets outError if the trace is malformed.
+    static std::optional<ScheduleTrace> parse(std::istream&, std::string* outError);
+};
+
+// The scheduling parameters to evaluate.
+struct ScheduleConfig {
+    // How long before a vsync SurfaceFlinger wakes up for it, as in VsyncConfig.
+    Duration sfWorkDuration = Duration::fromNs(0);
+    Duration hwcMinWorkDuration = Duration::fromNs(0);
+    FeatureFlags features;
+};
+
+struct ScheduleReport {
+    size_t frameCount = 0;
+    // Frames FrameTargeter saw miss their expected present time.
+    size_t missedFrameCount = 0;
+    // Frames which were deferred by a vsync because the previous one had not presented yet.
+    size_t backpressuredFrameCount = 0;
+    size_t recordedJankCount = 0;
+    // Times the vsync model had to be resynced from HW vsync.
+    size_t resyncCount = 0;
+
+    // Composite to present, as measured by PresentLatencyTracker.
+    std::vector<Duration> presentLatencies;
+    // Request to present.
+    std::vector<Duration> frameLatencies;
+    // Distance from the vsync a frame targeted to the closest actual vsync.
+    std::vector<Duration> predictionErrors;
+
+    void dump(std::string& result) const;
+};
+
+// Replays a recorded schedule through VSyncPredictor, VSyncReactor, FrameTargeter and
+// PresentLatencyTracker in simulated time. The recorded vsyncs and per-frame work stay the same,
+// so the report shows how the same load would have been scheduled with another configuration.
+//
+// The simulated main thread wakes up sfWorkDuration before the vsync the predictor expects
+// after the frame is requested, as VSyncDispatch would schedule it. The frame then presents on
+// the first actual vsync after its CPU and GPU work are done, and not before the expected
+// present time if HWC supports it.
+class ScheduleSimulator {
+public:
+    ScheduleSimulator(const ScheduleTrace&, const ScheduleConfig&);
+
+    ScheduleReport run();
+
+private:
+    // The first actual vsync at or after time, extrapolated at the refresh rate across the gaps
+    // of the trace.
+    nsecs_t actualVsyncAtOrAfter(nsecs_t time) const;
+
+    const ScheduleTrace& mTrace;
+    const ScheduleConfig mConfig;
+    // The recorded HW vsyncs and present fences, merged.
+    std::vector<nsecs_t> mActualVsyncs;
+};
+
+} // namespace android::scheduler
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#undef LOG_TAG
+#define LOG_TAG "ScheduleSimulator"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "ScheduleSimulator.h"
+
+using namespace android;
+using namespace android::scheduler;
+
+namespace {
+
+bool parseMillis(std::string_view arg, std::string_view name, Duration* outDuration) {
+    if (arg.substr(0, name.size()) != name) return false;
+    const std::string value(arg.substr(name.size()));
+    *outDuration = std::chrono::duration_cast<Duration>(
+            std::chrono::duration<double, std::milli>(std::stod(value)));
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cout << "Usage: " << argv[0]
+                  << " <schedule-trace-path> [--sf-work-duration=<ms>]"
+                     " [--hwc-min-work-duration=<ms>] [--expected-present-time]"
+                     " [--no-backpressure] [--kernel-idle-timer]\n";
+        return -1;
+    }
+
+    ScheduleConfig config;
+    config.sfWorkDuration = std::chrono::milliseconds(16);
+    config.features = FeatureFlags(Feature::kPresentFences) | Feature::kBackpressureGpuComposition |
+            Feature::kPropagateBackpressure;
+    for (int i = 2; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (parseMillis(arg, "--sf-work-duration=", &config.sfWorkDuration) ||
+            parseMillis(arg, "--hwc-min-work-duration=", &config.hwcMinWorkDuration)) {
+            continue;
+        }
+        if (arg == "--expected-present-time") {
+            config.features |= Feature::kExpectedPresentTime;
+        } else if (arg == "--no-backpressure") {
+            config.features.clear(Feature::kPropagateBackpressure);
+        } else if (arg == "--kernel-idle-timer") {
+            config.features |= Feature::kKernelIdleTimer;
+        } else {
+            std::cout << "Error: Unknown option " << arg << "\n";
+            return -1;
+        }
+    }
+
+    const char* tracePath = argv[1];
+    std::ifstream input(tracePath);
+    if (!input) {
+        std::cout << "Error: Could not open " << tracePath << "\n";
+        return -1;
+    }
+    std::string error;
+    const auto trace = ScheduleTrace::parse(input, &error);
+    if (!trace) {
+        std::cout << "Error: " << error << "\n";
+        return -1;
+    }
+
+    std::string result;
+    ScheduleSimulator(*trace, config).run().dump(result);
+    std::cout << result;
+    return 0;
+}
@@ -508,6 +508,9 @@ SurfaceFlinger::SurfaceFlinger(Factory& factory) : SurfaceFlinger(factory, SkipI
     property_get("debug.sf.treat_170m_as_sRGB", value, "0");
     mTreat170mAsSrgb = atoi(value);
 
+    property_get("debug.sf.partial_client_composition", value, "0");
+    mPartialClientComposition = atoi(value);
+
     property_get("debug.sf.dim_in_gamma_in_enhanced_screenshots", value, 0);
     mDimInGammaSpaceForEnhancedScreenshots = atoi(value);
 
@@ -539,6 +542,9 @@ SurfaceFlinger::SurfaceFlinger(Factory& factory) : SurfaceFlinger(factory, SkipI
     mRefreshRateOverlayShowInMiddle =
             property_get_bool("debug.sf.show_refresh_rate_overlay_in_middle", 0);
 
+    mLayerSnapshotBuilder.setTraversalThreadCount(
+            base::GetUintProperty("debug.sf.layer_snapshot_builder_threads"s, 1u));
+
     if (!mIsUserBuild && base::GetBoolProperty("debug.sf.enable_transaction_tracing"s, true)) {
         mTransactionTracing.emplace();
         mLayerTracing.setTransactionTracing(*mTransactionTracing);
@@ -1024,6 +1030,8 @@ void SurfaceFlinger::init() FTL_FAKE_GUARD(kMainThreadContext) {
                     base::GetBoolProperty("ro.surface_flinger.prime_shader_cache.ultrahdr"s, false);
             config.cacheEdgeExtension =
                     base::GetBoolProperty("debug.sf.edge_extension_shader"s, true);
+            config.runtimeShaderCachePath =
+                    base::GetProperty("debug.sf.prime_shader_cache.runtime_shaders_path"s, "");
             return getRenderEngine().primeCache(config);
         });
 
@@ -2387,6 +2395,7 @@ bool SurfaceFlinger::updateLayerSnapshots(VsyncId vsyncId, nsecs_t frameTimeNs,
     frontend::Update update;
     if (flushTransactions) {
         SFTRACE_NAME("TransactionHandler:flushTransactions");
+        const nsecs_t flushStart = systemTime();
         // Locking:
         // 1. to prevent onHandleDestroyed from being called while the state lock is held,
         // we must keep a copy of the transactions (specifically the composer
@@ -2417,6 +2426,11 @@ bool SurfaceFlinger::updateLayerSnapshots(VsyncId vsyncId, nsecs_t frameTimeNs,
                                                           update, mFrontEndDisplayInfos,
                                                           mFrontEndDisplayInfosChanged);
         }
+        mFramePhaseTracker.addDuration(ftl::to_underlying(vsyncId), FramePhase::TransactionFlush,
+                                       systemTime() - flushStart);
+
+        FramePhaseTracker::ScopedPhase phase(mFramePhaseTracker, ftl::to_underlying(vsyncId),
+                                             FramePhase::LayerLifecycle);
         mLayerLifecycleManager.applyTransactions(update.transactions);
         mLayerLifecycleManager.onHandlesDestroyed(update.destroyedHandles);
         for (auto& legacyLayer : update.legacyLayers) {
@@ -2436,6 +2450,8 @@ bool SurfaceFlinger::updateLayerSnapshots(VsyncId vsyncId, nsecs_t frameTimeNs,
 
     {
         SFTRACE_NAME("LayerSnapshotBuilder:update");
+        FramePhaseTracker::ScopedPhase phase(mFramePhaseTracker, ftl::to_underlying(vsyncId),
+                                             FramePhase::SnapshotBuild);
         frontend::LayerSnapshotBuilder::Args
                 args{.root = mLayerHierarchyBuilder.getHierarchy(),
                      .layerLifecycleManager = mLayerLifecycleManager,
@@ -2623,6 +2639,7 @@ bool SurfaceFlinger::commit(PhysicalDisplayId pacesetterId,
             activeDisplay->getPowerMode() == hal::PowerMode::ON;
     if (mPowerHintSessionEnabled) {
         mPowerAdvisor->setCommitStart(pacesetterFrameTarget.frameBeginTime());
+        mPowerAdvisor->setPreviousFrameMissed(pacesetterFrameTarget.didMissFrame());
         mPowerAdvisor->setExpectedPresentTime(pacesetterFrameTarget.expectedPresentTime());
 
         // Frame delay is how long we should have minus how long we actually have.
@@ -2830,6 +2847,8 @@ CompositeResultsPerDisplay SurfaceFlinger::composite(
             }
         }
     }
+    refreshArgs.bufferOnlyUpdateThisFrame =
+            !refreshArgs.updatingGeometryThisFrame && mLayerSnapshotBuilder.isLastUpdateBufferOnly();
 
     refreshArgs.refreshStartTime = systemTime(SYSTEM_TIME_MONOTONIC);
     for (auto& [layer, layerFE] : layers) {
@@ -2859,7 +2878,11 @@ CompositeResultsPerDisplay SurfaceFlinger::composite(
             }
         }
 
-        mCompositionEngine->present(refreshArgs);
+        {
+            FramePhaseTracker::ScopedPhase phase(mFramePhaseTracker, ftl::to_underlying(vsyncId),
+                                                 FramePhase::CompositionPresent);
+            mCompositionEngine->present(refreshArgs);
+        }
         moveSnapshotsFromCompositionArgs(refreshArgs, layers);
 
         for (auto& [layer, layerFE] : layers) {
@@ -2870,7 +2893,11 @@ CompositeResultsPerDisplay SurfaceFlinger::composite(
         }
 
     } else {
-        mCompositionEngine->present(refreshArgs);
+        {
+            FramePhaseTracker::ScopedPhase phase(mFramePhaseTracker, ftl::to_underlying(vsyncId),
+                                                 FramePhase::CompositionPresent);
+            mCompositionEngine->present(refreshArgs);
+        }
         moveSnapshotsFromCompositionArgs(refreshArgs, layers);
 
         for (auto [layer, layerFE] : layers) {
@@ -2885,6 +2912,9 @@ CompositeResultsPerDisplay SurfaceFlinger::composite(
     }
 
     SFTRACE_NAME("postComposition");
+    FramePhaseTracker::ScopedPhase postCompositionPhase(mFramePhaseTracker,
+                                                        ftl::to_underlying(vsyncId),
+                                                        FramePhase::PostComposition);
     mTimeStats->recordFrameDuration(pacesetterTarget.frameBeginTime().ns(), systemTime());
 
     // Send a power hint after presentation is finished.
@@ -4003,6 +4033,8 @@ void SurfaceFlinger::updateInputFlinger(VsyncId vsyncId, TimePoint frameTime) {
     if (mUpdateInputInfo) {
         mUpdateInputInfo = false;
         updateWindowInfo = true;
+        FramePhaseTracker::ScopedPhase phase(mFramePhaseTracker, ftl::to_underlying(vsyncId),
+                                             FramePhase::WindowInfos);
         buildWindowInfos(windowInfos, displayInfos);
     }
 
@@ -4804,6 +4836,19 @@ status_t SurfaceFlinger::setTransactionState(
             resolvedState.touchCropId =
                     LayerHandle::getLayerId(touchableRegionCropHandle.promote());
         }
+        for (const auto& listener : resolvedState.state.listeners) {
+            // Separates the callback ids according to callback type. This allows the callback
+            // invoker to send on latch callbacks earlier.
+            ListenerCallbacks onCommitCallbacks = listener.filter(CallbackId::Type::ON_COMMIT);
+            if (!onCommitCallbacks.callbackIds.empty()) {
+                resolvedState.filteredListeners.push_back(std::move(onCommitCallbacks));
+            }
+
+            ListenerCallbacks onCompleteCallbacks = listener.filter(CallbackId::Type::ON_COMPLETE);
+            if (!onCompleteCallbacks.callbackIds.empty()) {
+                resolvedState.filteredListeners.push_back(std::move(onCompleteCallbacks));
+            }
+        }
     }
 
     TransactionState state{frameTimelineInfo,
@@ -5013,23 +5058,7 @@ uint32_t SurfaceFlinger::updateLayerCallbacksAndStats(const FrameTimelineInfo& f
                                                       uint64_t transactionId) {
     layer_state_t& s = composerState.state;
 
-    std::vector<ListenerCallbacks> filteredListeners;
-    for (auto& listener : s.listeners) {
-        // Starts a registration but separates the callback ids according to callback type. This
-        // allows the callback invoker to send on latch callbacks earlier.
-        // note that startRegistration will not re-register if the listener has
-        // already be registered for a prior surface control
-
-        ListenerCallbacks onCommitCallbacks = listener.filter(CallbackId::Type::ON_COMMIT);
-        if (!onCommitCallbacks.callbackIds.empty()) {
-            filteredListeners.push_back(onCommitCallbacks);
-        }
-
-        ListenerCallbacks onCompleteCallbacks = listener.filter(CallbackId::Type::ON_COMPLETE);
-        if (!onCompleteCallbacks.callbackIds.empty()) {
-            filteredListeners.push_back(onCompleteCallbacks);
-        }
-    }
+    const std::vector<ListenerCallbacks>& filteredListeners = composerState.filteredListeners;
 
     const uint64_t what = s.what;
     uint32_t flags = 0;
@@ -5550,6 +5579,7 @@ status_t SurfaceFlinger::doDump(int fd, const DumpArgs& args, bool asProto) {
             {"--displays"s, dumper(&SurfaceFlinger::dumpDisplays)},
             {"--edid"s, argsDumper(&SurfaceFlinger::dumpRawDisplayIdentificationData)},
             {"--events"s, dumper(&SurfaceFlinger::dumpEvents)},
+            {"--frame-phases"s, mainThreadDumper(&SurfaceFlinger::dumpFramePhases)},
             {"--frametimeline"s, argsDumper(&SurfaceFlinger::dumpFrameTimeline)},
             {"--frontend"s, mainThreadDumper(&SurfaceFlinger::dumpFrontEnd)},
             {"--hdrinfo"s, dumper(&SurfaceFlinger::dumpHdrInfo)},
@@ -5797,6 +5827,10 @@ void SurfaceFlinger::dumpHdrInfo(std::string& result) const {
     }
 }
 
+void SurfaceFlinger::dumpFramePhases(std::string& result) const {
+    mFramePhaseTracker.dump(result);
+}
+
 void SurfaceFlinger::dumpFrontEnd(std::string& result) {
     std::ostringstream out;
     out << "\nComposition list\n";
@@ -5819,6 +5853,10 @@ void SurfaceFlinger::dumpFrontEnd(std::string& result) {
         out << "  " << snapshot << "\n";
     });
 
+    const auto traversalStats = mLayerSnapshotBuilder.getLastTraversalStats();
+    out << "\nLast traversal: visited " << traversalStats.visitedSnapshots
+        << " snapshots, skipped " << traversalStats.skippedSubtrees << " unchanged subtrees\n";
+
     out << "\nLayer Hierarchy\n"
         << mLayerHierarchyBuilder.getHierarchy().dump() << "\nOffscreen Hierarchy\n"
         << mLayerHierarchyBuilder.getOffscreenHierarchy().dump() << "\n\n";
@@ -6948,6 +6986,10 @@ ui::Dataspace pickBestDataspace(ui::Dataspace requestedDataspace,
     return dataspaceForColorMode;
 }
 
+client_cache_t getCaptureOutputBufferId(const CaptureArgs& args) {
+    return {args.outputBufferCacheToken, static_cast<uint64_t>(args.outputBufferCacheId)};
+}
+
 } // namespace
 
 static void invokeScreenCaptureError(const status_t status,
@@ -7029,7 +7071,8 @@ void SurfaceFlinger::captureDisplay(const DisplayCaptureArgs& args,
                         getLayerSnapshotsFn, reqSize,
                         static_cast<ui::PixelFormat>(captureArgs.pixelFormat),
                         captureArgs.allowProtected, captureArgs.grayscale,
-                        captureArgs.attachGainmap, captureListener);
+                        captureArgs.attachGainmap, getCaptureOutputBufferId(captureArgs),
+                        captureListener);
 }
 
 void SurfaceFlinger::captureDisplay(DisplayId displayId, const CaptureArgs& args,
@@ -7086,7 +7129,8 @@ void SurfaceFlinger::captureDisplay(DisplayId displayId, const CaptureArgs& args
                                                  static_cast<ui::Dataspace>(args.dataspace),
                                                  displayWeak, options),
                         getLayerSnapshotsFn, size, static_cast<ui::PixelFormat>(args.pixelFormat),
-                        kAllowProtected, kGrayscale, args.attachGainmap, captureListener);
+                        kAllowProtected, kGrayscale, args.attachGainmap,
+                        getCaptureOutputBufferId(args), captureListener);
 }
 
 ScreenCaptureResults SurfaceFlinger::captureLayersSync(const LayerCaptureArgs& args) {
@@ -7198,7 +7242,8 @@ void SurfaceFlinger::captureLayers(const LayerCaptureArgs& args,
                         getLayerSnapshotsFn, reqSize,
                         static_cast<ui::PixelFormat>(captureArgs.pixelFormat),
                         captureArgs.allowProtected, captureArgs.grayscale,
-                        captureArgs.attachGainmap, captureListener);
+                        captureArgs.attachGainmap, getCaptureOutputBufferId(captureArgs),
+                        captureListener);
 }
 
 // Creates a Future release fence for a layer and keeps track of it in a list to
@@ -7250,6 +7295,7 @@ void SurfaceFlinger::captureScreenCommon(RenderAreaBuilderVariant renderAreaBuil
                                          GetLayerSnapshotsFunction getLayerSnapshotsFn,
                                          ui::Size bufferSize, ui::PixelFormat reqPixelFormat,
                                          bool allowProtected, bool grayscale, bool attachGainmap,
+                                         const client_cache_t& outputBufferId,
                                          const sp<IScreenCaptureListener>& captureListener) {
     SFTRACE_CALL();
 
@@ -7261,6 +7307,35 @@ void SurfaceFlinger::captureScreenCommon(RenderAreaBuilderVariant renderAreaBuil
         return;
     }
 
+    sp<GraphicBuffer> outputBuffer;
+    if (outputBufferId.isValid()) {
+        // Unless RenderEngine maps buffers by their usage, a buffer cached for sampling isn't
+        // renderable.
+        if (!FlagManager::getInstance().renderable_buffer_usage()) {
+            ALOGE("%s: Capturing into a cached buffer is not supported", __func__);
+            invokeScreenCaptureError(INVALID_OPERATION, captureListener);
+            return;
+        }
+
+        if (const auto texture = ClientCache::getInstance().get(outputBufferId)) {
+            outputBuffer = texture->getBuffer();
+        }
+        if (!outputBuffer ||
+            static_cast<int32_t>(outputBuffer->getWidth()) != bufferSize.getWidth() ||
+            static_cast<int32_t>(outputBuffer->getHeight()) != bufferSize.getHeight() ||
+            outputBuffer->getPixelFormat() != static_cast<PixelFormat>(reqPixelFormat) ||
+            !(outputBuffer->getUsage() & GRALLOC_USAGE_HW_RENDER) ||
+            (outputBuffer->getUsage() & GRALLOC_USAGE_PROTECTED)) {
+            ALOGE("%s: Cached output buffer %" PRIu64 " does not fit the capture", __func__,
+                  outputBufferId.id);
+            invokeScreenCaptureError(BAD_VALUE, captureListener);
+            return;
+        }
+
+        // The buffer can't hold protected content.
+        allowProtected = false;
+    }
+
     if (FlagManager::getInstance().single_hop_screenshot() &&
         FlagManager::getInstance().ce_fence_promise() && mRenderEngine->isThreaded()) {
         std::vector<sp<LayerFE>> layerFEs;
@@ -7277,10 +7352,12 @@ void SurfaceFlinger::captureScreenCommon(RenderAreaBuilderVariant renderAreaBuil
                 GRALLOC_USAGE_HW_TEXTURE |
                 (isProtected ? GRALLOC_USAGE_PROTECTED
                              : GRALLOC_USAGE_SW_READ_OFTEN | GRALLOC_USAGE_SW_WRITE_OFTEN);
-        sp<GraphicBuffer> buffer =
-                getFactory().createGraphicBuffer(bufferSize.getWidth(), bufferSize.getHeight(),
-                                                 static_cast<android_pixel_format>(reqPixelFormat),
-                                                 1 /* layerCount */, usage, "screenshot");
+        sp<GraphicBuffer> buffer = outputBuffer
+                ? outputBuffer
+                : getFactory().createGraphicBuffer(bufferSize.getWidth(), bufferSize.getHeight(),
+                                                   static_cast<android_pixel_format>(
+                                                           reqPixelFormat),
+                                                   1 /* layerCount */, usage, "screenshot");
 
         const status_t bufferStatus = buffer->initCheck();
         if (bufferStatus != OK) {
@@ -7312,10 +7389,12 @@ void SurfaceFlinger::captureScreenCommon(RenderAreaBuilderVariant renderAreaBuil
                 GRALLOC_USAGE_HW_TEXTURE |
                 (isProtected ? GRALLOC_USAGE_PROTECTED
                              : GRALLOC_USAGE_SW_READ_OFTEN | GRALLOC_USAGE_SW_WRITE_OFTEN);
-        sp<GraphicBuffer> buffer =
-                getFactory().createGraphicBuffer(bufferSize.getWidth(), bufferSize.getHeight(),
-                                                 static_cast<android_pixel_format>(reqPixelFormat),
-                                                 1 /* layerCount */, usage, "screenshot");
+        sp<GraphicBuffer> buffer = outputBuffer
+                ? outputBuffer
+                : getFactory().createGraphicBuffer(bufferSize.getWidth(), bufferSize.getHeight(),
+                                                   static_cast<android_pixel_format>(
+                                                           reqPixelFormat),
+                                                   1 /* layerCount */, usage, "screenshot");
 
         const status_t bufferStatus = buffer->initCheck();
         if (bufferStatus != OK) {
@@ -73,6 +73,7 @@
 #include "DisplayHardware/PowerAdvisor.h"
 #include "DisplayIdGenerator.h"
 #include "Effects/Daltonizer.h"
+#include "FramePhaseTracker.h"
 #include "FrontEnd/DisplayInfo.h"
 #include "FrontEnd/LayerCreationArgs.h"
 #include "FrontEnd/LayerLifecycleManager.h"
@@ -321,6 +322,11 @@ public:
     // on this behavior to increase contrast for some media sources.
     bool mTreat170mAsSrgb = false;
 
+    // If set, GPU composition for physical displays only redraws the tiles of the client target
+    // which changed since the buffer was last rendered. This can be set by
+    // debug.sf.partial_client_composition
+    bool mPartialClientComposition = false;
+
     // If true, then screenshots with an enhanced render intent will dim in gamma space.
     // The purpose is to ensure that screenshots appear correct during system animations for devices
     // that require that dimming must occur in gamma space.
@@ -859,9 +865,12 @@ private:
             RenderAreaBuilderVariant& renderAreaBuilder,
             GetLayerSnapshotsFunction getLayerSnapshotsFn, std::vector<sp<LayerFE>>& layerFEs);
 
+    // outputBufferId is the cached buffer to render into, or invalid to allocate one.
     void captureScreenCommon(RenderAreaBuilderVariant, GetLayerSnapshotsFunction,
                              ui::Size bufferSize, ui::PixelFormat, bool allowProtected,
-                             bool grayscale, bool attachGainmap, const sp<IScreenCaptureListener>&);
+                             bool grayscale, bool attachGainmap,
+                             const client_cache_t& outputBufferId,
+                             const sp<IScreenCaptureListener>&);
 
     std::optional<OutputCompositionState> getDisplayStateFromRenderAreaBuilder(
             RenderAreaBuilderVariant& renderAreaBuilder) REQUIRES(kMainThreadContext);
@@ -1120,6 +1129,7 @@ private:
     void dumpWideColorInfo(std::string& result) const REQUIRES(mStateLock);
     void dumpHdrInfo(std::string& result) const REQUIRES(mStateLock);
     void dumpFrontEnd(std::string& result) REQUIRES(kMainThreadContext);
+    void dumpFramePhases(std::string& result) const REQUIRES(kMainThreadContext);
     void dumpVisibleFrontEnd(std::string& result) REQUIRES(mStateLock, kMainThreadContext);
 
     perfetto::protos::LayersProto dumpDrawingStateProto(uint32_t traceFlags) const
@@ -1355,6 +1365,7 @@ private:
     std::unique_ptr<scheduler::Scheduler> mScheduler;
 
     scheduler::PresentLatencyTracker mPresentLatencyTracker GUARDED_BY(kMainThreadContext);
+    FramePhaseTracker mFramePhaseTracker GUARDED_BY(kMainThreadContext);
 
     bool mLumaSampling = true;
     
@@ -28,6 +28,7 @@
 #include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <tuple>
 #include <unordered_map>
 
 #include "TimeStats.h"
@@ -441,14 +442,14 @@ static int32_t clampToNearestBucket(Fps fps, size_t bucketWidth) {
     return std::round(fps.getValue() / bucketWidth) * bucketWidth;
 }
 
-void TimeStats::flushAvailableRecordsToStatsLocked(int32_t layerId, Fps displayRefreshRate,
+void TimeStats::flushAvailableRecordsToStatsLocked(int32_t layerId, LayerRecord& layerRecord,
+                                                   Fps displayRefreshRate,
                                                    std::optional<Fps> renderRate,
                                                    SetFrameRateVote frameRateVote,
                                                    GameMode gameMode) {
     SFTRACE_CALL();
     ALOGV("[%d]-flushAvailableRecordsToStatsLocked", layerId);
 
-    LayerRecord& layerRecord = mTimeStatsTracker[layerId];
     TimeRecord& prevTimeRecord = layerRecord.prevTimeRecord;
     std::optional<int32_t>& prevPresentToPresentMs = layerRecord.prevPresentToPresentMs;
     std::deque<TimeRecord>& timeRecords = layerRecord.timeRecords;
@@ -466,24 +467,26 @@ void TimeStats::flushAvailableRecordsToStatsLocked(int32_t layerId, Fps displayR
             uid_t uid = layerRecord.uid;
             const std::string& layerName = layerRecord.layerName;
             TimeStatsHelper::TimelineStatsKey timelineKey = {refreshRateBucket, renderRateBucket};
-            if (!mTimeStats.stats.count(timelineKey)) {
-                mTimeStats.stats[timelineKey].key = timelineKey;
+            const auto [timelineIt, isNewTimeline] = mTimeStats.stats.try_emplace(timelineKey);
+            TimeStatsHelper::TimelineStats& displayStats = timelineIt->second;
+            if (isNewTimeline) {
+                displayStats.key = timelineKey;
             }
 
-            TimeStatsHelper::TimelineStats& displayStats = mTimeStats.stats[timelineKey];
-
             TimeStatsHelper::LayerStatsKey layerKey = {uid, layerName, gameMode};
-            if (!displayStats.stats.count(layerKey)) {
-                displayStats.stats[layerKey].displayRefreshRateBucket = refreshRateBucket;
-                displayStats.stats[layerKey].renderRateBucket = renderRateBucket;
-                displayStats.stats[layerKey].uid = uid;
-                displayStats.stats[layerKey].layerName = layerName;
-                displayStats.stats[layerKey].gameMode = gameMode;
+            const auto [layerIt, isNewLayer] = displayStats.stats.try_emplace(layerKey);
+            TimeStatsHelper::TimeStatsLayer& timeStatsLayer = layerIt->second;
+            if (isNewLayer) {
+                timeStatsLayer.displayRefreshRateBucket = refreshRateBucket;
+                timeStatsLayer.renderRateBucket = renderRateBucket;
+                timeStatsLayer.uid = uid;
+                timeStatsLayer.layerName = layerName;
+                timeStatsLayer.gameMode = gameMode;
+                mLayerStatsCount++;
             }
             if (frameRateVote.frameRate > 0.0f) {
-                displayStats.stats[layerKey].setFrameRateVote = frameRateVote;
+                timeStatsLayer.setFrameRateVote = frameRateVote;
             }
-            TimeStatsHelper::TimeStatsLayer& timeStatsLayer = displayStats.stats[layerKey];
             timeStatsLayer.totalFrames++;
             timeStatsLayer.droppedFrames += layerRecord.droppedFrames;
             timeStatsLayer.lateAcquireFrames += layerRecord.lateAcquireFrames;
@@ -552,16 +555,37 @@ static bool layerNameIsValid(const std::string& layerName) {
 
 bool TimeStats::canAddNewAggregatedStats(uid_t uid, const std::string& layerName,
                                          GameMode gameMode) {
-    uint32_t layerRecords = 0;
+    // Only look for the layer once the limit is reached, as this is called for every buffer.
+    if (mLayerStatsCount < MAX_NUM_LAYER_STATS) {
+        return true;
+    }
     for (const auto& record : mTimeStats.stats) {
         if (record.second.stats.count({uid, layerName, gameMode}) > 0) {
             return true;
         }
+    }
+    return false;
+}
 
-        layerRecords += record.second.stats.size();
+TimeStats::LayerRecord* TimeStats::findLayerRecordLocked(int32_t layerId) {
+    const auto it = mTimeStatsTracker.find(layerId);
+    return it == mTimeStatsTracker.end() ? nullptr : &it->second;
+}
+
+TimeStats::TimeRecord* TimeStats::findWaitingTimeRecordLocked(LayerRecord& layerRecord,
+                                                              uint64_t frameNumber) {
+    if (layerRecord.waitData < 0 ||
+        layerRecord.waitData >= static_cast<int32_t>(layerRecord.timeRecords.size())) {
+        return nullptr;
     }
+    TimeRecord& timeRecord = layerRecord.timeRecords[static_cast<size_t>(layerRecord.waitData)];
+    return timeRecord.frameTime.frameNumber == frameNumber ? &timeRecord : nullptr;
+}
 
-    return layerRecords < MAX_NUM_LAYER_STATS;
+TimeStats::TimeRecord* TimeStats::findWaitingTimeRecordLocked(int32_t layerId,
+                                                              uint64_t frameNumber) {
+    LayerRecord* layerRecord = findLayerRecordLocked(layerId);
+    return layerRecord ? findWaitingTimeRecordLocked(*layerRecord, frameNumber) : nullptr;
 }
 
 void TimeStats::setPostTime(int32_t layerId, uint64_t frameNumber, const std::string& layerName,
@@ -576,18 +600,21 @@ void TimeStats::setPostTime(int32_t layerId, uint64_t frameNumber, const std::st
     if (!canAddNewAggregatedStats(uid, layerName, gameMode)) {
         return;
     }
-    if (!mTimeStatsTracker.count(layerId) && mTimeStatsTracker.size() < MAX_NUM_LAYER_RECORDS &&
-        layerNameIsValid(layerName)) {
-        mTimeStatsTracker[layerId].uid = uid;
-        mTimeStatsTracker[layerId].layerName = layerName;
-        mTimeStatsTracker[layerId].gameMode = gameMode;
+    auto it = mTimeStatsTracker.find(layerId);
+    if (it == mTimeStatsTracker.end()) {
+        if (mTimeStatsTracker.size() >= MAX_NUM_LAYER_RECORDS || !layerNameIsValid(layerName)) {
+            return;
+        }
+        it = mTimeStatsTracker.try_emplace(layerId).first;
+        it->second.uid = uid;
+        it->second.layerName = layerName;
+        it->second.gameMode = gameMode;
     }
-    if (!mTimeStatsTracker.count(layerId)) return;
-    LayerRecord& layerRecord = mTimeStatsTracker[layerId];
+    LayerRecord& layerRecord = it->second;
     if (layerRecord.timeRecords.size() == MAX_NUM_TIME_RECORDS) {
         ALOGE("[%d]-[%s]-timeRecords is at its maximum size[%zu]. Ignore this when unittesting.",
               layerId, layerRecord.layerName.c_str(), MAX_NUM_TIME_RECORDS);
-        mTimeStatsTracker.erase(layerId);
+        mTimeStatsTracker.erase(it);
         return;
     }
     // For most media content, the acquireFence is invalid because the buffer is
@@ -616,14 +643,8 @@ void TimeStats::setLatchTime(int32_t layerId, uint64_t frameNumber, nsecs_t latc
     ALOGV("[%d]-[%" PRIu64 "]-LatchTime[%" PRId64 "]", layerId, frameNumber, latchTime);
 
     std::lock_guard<std::mutex> lock(mMutex);
-    if (!mTimeStatsTracker.count(layerId)) return;
-    LayerRecord& layerRecord = mTimeStatsTracker[layerId];
-    if (layerRecord.waitData < 0 ||
-        layerRecord.waitData >= static_cast<int32_t>(layerRecord.timeRecords.size()))
-        return;
-    TimeRecord& timeRecord = layerRecord.timeRecords[layerRecord.waitData];
-    if (timeRecord.frameTime.frameNumber == frameNumber) {
-        timeRecord.frameTime.latchTime = latchTime;
+    if (TimeRecord* timeRecord = findWaitingTimeRecordLocked(layerId, frameNumber)) {
+        timeRecord->frameTime.latchTime = latchTime;
     }
 }
 
@@ -635,12 +656,12 @@ void TimeStats::incrementLatchSkipped(int32_t layerId, LatchSkipReason reason) {
           static_cast<std::underlying_type<LatchSkipReason>::type>(reason));
 
     std::lock_guard<std::mutex> lock(mMutex);
-    if (!mTimeStatsTracker.count(layerId)) return;
-    LayerRecord& layerRecord = mTimeStatsTracker[layerId];
+    LayerRecord* layerRecord = findLayerRecordLocked(layerId);
+    if (!layerRecord) return;
 
     switch (reason) {
         case LatchSkipReason::LateAcquire:
-            layerRecord.lateAcquireFrames++;
+            layerRecord->lateAcquireFrames++;
             break;
     }
 }
@@ -652,9 +673,9 @@ void TimeStats::incrementBadDesiredPresent(int32_t layerId) {
     ALOGV("[%d]-BadDesiredPresent", layerId);
 
     std::lock_guard<std::mutex> lock(mMutex);
-    if (!mTimeStatsTracker.count(layerId)) return;
-    LayerRecord& layerRecord = mTimeStatsTracker[layerId];
-    layerRecord.badDesiredPresentFrames++;
+    LayerRecord* layerRecord = findLayerRecordLocked(layerId);
+    if (!layerRecord) return;
+    layerRecord->badDesiredPresentFrames++;
 }
 
 void TimeStats::setDesiredTime(int32_t layerId, uint64_t frameNumber, nsecs_t desiredTime) {
@@ -664,14 +685,8 @@ void TimeStats::setDesiredTime(int32_t layerId, uint64_t frameNumber, nsecs_t de
     ALOGV("[%d]-[%" PRIu64 "]-DesiredTime[%" PRId64 "]", layerId, frameNumber, desiredTime);
 
     std::lock_guard<std::mutex> lock(mMutex);
-    if (!mTimeStatsTracker.count(layerId)) return;
-    LayerRecord& layerRecord = mTimeStatsTracker[layerId];
-    if (layerRecord.waitData < 0 ||
-        layerRecord.waitData >= static_cast<int32_t>(layerRecord.timeRecords.size()))
-        return;
-    TimeRecord& timeRecord = layerRecord.timeRecords[layerRecord.waitData];
-    if (timeRecord.frameTime.frameNumber == frameNumber) {
-        timeRecord.frameTime.desiredTime = desiredTime;
+    if (TimeRecord* timeRecord = findWaitingTimeRecordLocked(layerId, frameNumber)) {
+        timeRecord->frameTime.desiredTime = desiredTime;
     }
 }
 
@@ -682,14 +697,8 @@ void TimeStats::setAcquireTime(int32_t layerId, uint64_t frameNumber, nsecs_t ac
     ALOGV("[%d]-[%" PRIu64 "]-AcquireTime[%" PRId64 "]", layerId, frameNumber, acquireTime);
 
     std::lock_guard<std::mutex> lock(mMutex);
-    if (!mTimeStatsTracker.count(layerId)) return;
-    LayerRecord& layerRecord = mTimeStatsTracker[layerId];
-    if (layerRecord.waitData < 0 ||
-        layerRecord.waitData >= static_cast<int32_t>(layerRecord.timeRecords.size()))
-        return;
-    TimeRecord& timeRecord = layerRecord.timeRecords[layerRecord.waitData];
-    if (timeRecord.frameTime.frameNumber == frameNumber) {
-        timeRecord.frameTime.acquireTime = acquireTime;
+    if (TimeRecord* timeRecord = findWaitingTimeRecordLocked(layerId, frameNumber)) {
+        timeRecord->frameTime.acquireTime = acquireTime;
     }
 }
 
@@ -702,14 +711,8 @@ void TimeStats::setAcquireFence(int32_t layerId, uint64_t frameNumber,
           acquireFence->getSignalTime());
 
     std::lock_guard<std::mutex> lock(mMutex);
-    if (!mTimeStatsTracker.count(layerId)) return;
-    LayerRecord& layerRecord = mTimeStatsTracker[layerId];
-    if (layerRecord.waitData < 0 ||
-        layerRecord.waitData >= static_cast<int32_t>(layerRecord.timeRecords.size()))
-        return;
-    TimeRecord& timeRecord = layerRecord.timeRecords[layerRecord.waitData];
-    if (timeRecord.frameTime.frameNumber == frameNumber) {
-        timeRecord.acquireFence = acquireFence;
+    if (TimeRecord* timeRecord = findWaitingTimeRecordLocked(layerId, frameNumber)) {
+        timeRecord->acquireFence = acquireFence;
     }
 }
 
@@ -722,20 +725,17 @@ void TimeStats::setPresentTime(int32_t layerId, uint64_t frameNumber, nsecs_t pr
     ALOGV("[%d]-[%" PRIu64 "]-PresentTime[%" PRId64 "]", layerId, frameNumber, presentTime);
 
     std::lock_guard<std::mutex> lock(mMutex);
-    if (!mTimeStatsTracker.count(layerId)) return;
-    LayerRecord& layerRecord = mTimeStatsTracker[layerId];
-    if (layerRecord.waitData < 0 ||
-        layerRecord.waitData >= static_cast<int32_t>(layerRecord.timeRecords.size()))
-        return;
-    TimeRecord& timeRecord = layerRecord.timeRecords[layerRecord.waitData];
-    if (timeRecord.frameTime.frameNumber == frameNumber) {
-        timeRecord.frameTime.presentTime = presentTime;
-        timeRecord.ready = true;
+    const auto it = mTimeStatsTracker.find(layerId);
+    if (it == mTimeStatsTracker.end()) return;
+    LayerRecord& layerRecord = it->second;
+    if (TimeRecord* timeRecord = findWaitingTimeRecordLocked(layerRecord, frameNumber)) {
+        timeRecord->frameTime.presentTime = presentTime;
+        timeRecord->ready = true;
         layerRecord.waitData++;
     }
 
-    flushAvailableRecordsToStatsLocked(layerId, displayRefreshRate, renderRate, frameRateVote,
-                                       gameMode);
+    flushAvailableRecordsToStatsLocked(layerId, layerRecord, displayRefreshRate, renderRate,
+                                       frameRateVote, gameMode);
 }
 
 void TimeStats::setPresentFence(int32_t layerId, uint64_t frameNumber,
@@ -749,20 +749,17 @@ void TimeStats::setPresentFence(int32_t layerId, uint64_t frameNumber,
           presentFence->getSignalTime());
 
     std::lock_guard<std::mutex> lock(mMutex);
-    if (!mTimeStatsTracker.count(layerId)) return;
-    LayerRecord& layerRecord = mTimeStatsTracker[layerId];
-    if (layerRecord.waitData < 0 ||
-        layerRecord.waitData >= static_cast<int32_t>(layerRecord.timeRecords.size()))
-        return;
-    TimeRecord& timeRecord = layerRecord.timeRecords[layerRecord.waitData];
-    if (timeRecord.frameTime.frameNumber == frameNumber) {
-        timeRecord.presentFence = presentFence;
-        timeRecord.ready = true;
+    const auto it = mTimeStatsTracker.find(layerId);
+    if (it == mTimeStatsTracker.end()) return;
+    LayerRecord& layerRecord = it->second;
+    if (TimeRecord* timeRecord = findWaitingTimeRecordLocked(layerRecord, frameNumber)) {
+        timeRecord->presentFence = presentFence;
+        timeRecord->ready = true;
         layerRecord.waitData++;
     }
 
-    flushAvailableRecordsToStatsLocked(layerId, displayRefreshRate, renderRate, frameRateVote,
-                                       gameMode);
+    flushAvailableRecordsToStatsLocked(layerId, layerRecord, displayRefreshRate, renderRate,
+                                       frameRateVote, gameMode);
 }
 
 static const constexpr int32_t kValidJankyReason = JankType::DisplayHAL |
@@ -829,25 +826,31 @@ void TimeStats::incrementJankyFrames(const JankyFramesInfo& info) {
                                  RENDER_RATE_BUCKET_WIDTH);
     const TimeStatsHelper::TimelineStatsKey timelineKey = {refreshRateBucket, renderRateBucket};
 
-    if (!mTimeStats.stats.count(timelineKey)) {
-        mTimeStats.stats[timelineKey].key = timelineKey;
+    const auto [timelineIt, isNewTimeline] = mTimeStats.stats.try_emplace(timelineKey);
+    TimeStatsHelper::TimelineStats& timelineStats = timelineIt->second;
+    if (isNewTimeline) {
+        timelineStats.key = timelineKey;
     }
 
-    TimeStatsHelper::TimelineStats& timelineStats = mTimeStats.stats[timelineKey];
-
     updateJankPayload<TimeStatsHelper::TimelineStats>(timelineStats, info.reasons);
 
     TimeStatsHelper::LayerStatsKey layerKey = {info.uid, info.layerName, info.gameMode};
-    if (!timelineStats.stats.count(layerKey)) {
+    auto layerIt = timelineStats.stats.find(layerKey);
+    if (layerIt == timelineStats.stats.end()) {
         layerKey = {info.uid, kDefaultLayerName, kDefaultGameMode};
-        timelineStats.stats[layerKey].displayRefreshRateBucket = refreshRateBucket;
-        timelineStats.stats[layerKey].renderRateBucket = renderRateBucket;
-        timelineStats.stats[layerKey].uid = info.uid;
-        timelineStats.stats[layerKey].layerName = kDefaultLayerName;
-        timelineStats.stats[layerKey].gameMode = kDefaultGameMode;
+        bool isNewLayer;
+        std::tie(layerIt, isNewLayer) = timelineStats.stats.try_emplace(layerKey);
+        if (isNewLayer) {
+            layerIt->second.displayRefreshRateBucket = refreshRateBucket;
+            layerIt->second.renderRateBucket = renderRateBucket;
+            layerIt->second.uid = info.uid;
+            layerIt->second.layerName = kDefaultLayerName;
+            layerIt->second.gameMode = kDefaultGameMode;
+            mLayerStatsCount++;
+        }
     }
 
-    TimeStatsHelper::TimeStatsLayer& timeStatsLayer = timelineStats.stats[layerKey];
+    TimeStatsHelper::TimeStatsLayer& timeStatsLayer = layerIt->second;
     updateJankPayload<TimeStatsHelper::TimeStatsLayer>(timeStatsLayer, info.reasons);
 
     if (info.reasons & kValidJankyReason) {
@@ -874,19 +877,19 @@ void TimeStats::removeTimeRecord(int32_t layerId, uint64_t frameNumber) {
     ALOGV("[%d]-[%" PRIu64 "]-removeTimeRecord", layerId, frameNumber);
 
     std::lock_guard<std::mutex> lock(mMutex);
-    if (!mTimeStatsTracker.count(layerId)) return;
-    LayerRecord& layerRecord = mTimeStatsTracker[layerId];
+    LayerRecord* layerRecord = findLayerRecordLocked(layerId);
+    if (!layerRecord) return;
     size_t removeAt = 0;
-    for (const TimeRecord& record : layerRecord.timeRecords) {
+    for (const TimeRecord& record : layerRecord->timeRecords) {
         if (record.frameTime.frameNumber == frameNumber) break;
         removeAt++;
     }
-    if (removeAt == layerRecord.timeRecords.size()) return;
-    layerRecord.timeRecords.erase(layerRecord.timeRecords.begin() + removeAt);
-    if (layerRecord.waitData > static_cast<int32_t>(removeAt)) {
-        layerRecord.waitData--;
+    if (removeAt == layerRecord->timeRecords.size()) return;
+    layerRecord->timeRecords.erase(layerRecord->timeRecords.begin() + removeAt);
+    if (layerRecord->waitData > static_cast<int32_t>(removeAt)) {
+        layerRecord->waitData--;
     }
-    layerRecord.droppedFrames++;
+    layerRecord->droppedFrames++;
 }
 
 void TimeStats::flushPowerTimeLocked() {
@@ -1046,6 +1049,7 @@ void TimeStats::disable() {
 void TimeStats::clearAll() {
     std::lock_guard<std::mutex> lock(mMutex);
     mTimeStats.stats.clear();
+    mLayerStatsCount = 0;
     clearGlobalLocked();
     clearLayersLocked();
 }
@@ -1085,6 +1089,7 @@ void TimeStats::clearLayersLocked() {
     for (auto& globalRecord : mTimeStats.stats) {
         globalRecord.second.stats.clear();
     }
+    mLayerStatsCount = 0;
     ALOGD("Cleared layer stats");
 }
 
@@ -292,12 +292,17 @@ private:
     bool populateGlobalAtom(std::vector<uint8_t>* pulledData);
     bool populateLayerAtom(std::vector<uint8_t>* pulledData);
     bool recordReadyLocked(int32_t layerId, TimeRecord* timeRecord);
-    void flushAvailableRecordsToStatsLocked(int32_t layerId, Fps displayRefreshRate,
+    void flushAvailableRecordsToStatsLocked(int32_t layerId, LayerRecord&, Fps displayRefreshRate,
                                             std::optional<Fps> renderRate, SetFrameRateVote,
                                             GameMode);
     void flushPowerTimeLocked();
     void flushAvailableGlobalRecordsToStatsLocked();
     bool canAddNewAggregatedStats(uid_t uid, const std::string& layerName, GameMode);
+    LayerRecord* findLayerRecordLocked(int32_t layerId);
+    // Returns the record of the frame whose timestamps are still being received, if it is
+    // frameNumber.
+    TimeRecord* findWaitingTimeRecordLocked(LayerRecord&, uint64_t frameNumber);
+    TimeRecord* findWaitingTimeRecordLocked(int32_t layerId, uint64_t frameNumber);
 
     void enable();
     void disable();
@@ -311,6 +316,8 @@ private:
     TimeStatsHelper::TimeStatsGlobal mTimeStats;
     // Hashmap for LayerRecord with layerId as the hash key
     std::unordered_map<int32_t, LayerRecord> mTimeStatsTracker;
+    // The number of layers in mTimeStats, across all timelines.
+    size_t mLayerStatsCount = 0;
     PowerTime mPowerTime;
     GlobalRecord mGlobalRecord;
 
@@ -24,6 +24,7 @@
 #include "Tracing/tools/LayerTraceGenerator.h"
 #include "TransactionTracing.h"
 
+#include <android-base/properties.h>
 #include <common/trace.h>
 #include <log/log.h>
 #include <perfetto/tracing.h>
@@ -56,6 +57,15 @@ void LayerTracing::setTransactionTracing(TransactionTracing& transactionTracing)
 void LayerTracing::onStart(Mode mode, uint32_t flags) {
     switch (mode) {
         case Mode::MODE_ACTIVE: {
+            {
+                const int keyframeInterval =
+                        base::GetIntProperty(kLayerTraceKeyframeIntervalProperty, 0);
+                std::scoped_lock lock(mDeltaEncoderMutex);
+                mDeltaEncoder.reset();
+                if (keyframeInterval > 1) {
+                    mDeltaEncoder.emplace(static_cast<uint32_t>(keyframeInterval));
+                }
+            }
             mActiveTracingFlags.store(flags);
             mIsActiveTracingStarted.store(true);
             ALOGV("Starting active tracing (waiting for initial snapshot)");
@@ -138,6 +148,12 @@ void LayerTracing::addProtoSnapshotToOstream(perfetto::protos::LayersSnapshotPro
     if (mOutStream) {
         writeSnapshotToStream(std::move(snapshot));
     } else {
+        if (mode == Mode::MODE_ACTIVE) {
+            std::scoped_lock lock(mDeltaEncoderMutex);
+            if (mDeltaEncoder) {
+                mDeltaEncoder->encode(snapshot);
+            }
+        }
         writeSnapshotToPerfetto(snapshot, mode);
     }
 }
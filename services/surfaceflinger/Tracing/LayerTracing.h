@@ -16,13 +16,17 @@
 
 #pragma once
 
+#include <android-base/thread_annotations.h>
 #include <layerproto/LayerProtoHeader.h>
 
 #include <atomic>
 #include <functional>
+#include <mutex>
 #include <optional>
 #include <ostream>
 
+#include "LayersSnapshotDelta.h"
+
 namespace android {
 
 class TransactionTracing;
@@ -42,7 +46,9 @@ class TransactionTracing;
  * Tracing can operate in the following modes.
  *
  * ACTIVE mode:
- * A layers snapshot is taken and written to perfetto for each vsyncid commit.
+ * A layers snapshot is taken and written to perfetto for each vsyncid commit. If
+ * debug.sf.layer_trace_keyframe_interval is set, only every n-th snapshot is written in full,
+ * and the others only contain the layers which changed (see LayersSnapshotDelta.h).
  *
  * GENERATED mode:
  * Listens to the perfetto 'flush' event (e.g. when a bugreport is taken).
@@ -130,6 +136,10 @@ private:
     std::atomic<uint32_t> mActiveTracingFlags{0};
     std::atomic<std::int64_t> mLastVsyncIdWrittenToPerfetto{-1};
     std::optional<std::reference_wrapper<std::ostream>> mOutStream;
+
+    // Snapshots are taken on the main thread, except for the initial one.
+    std::mutex mDeltaEncoderMutex;
+    std::optional<LayersSnapshotDeltaEncoder> mDeltaEncoder GUARDED_BY(mDeltaEncoderMutex);
 };
 
 } // namespace android
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "LayersSnapshotDelta.h"
+
+#include <string_view>
+#include <unordered_set>
+
+namespace android {
+
+namespace {
+
+bool isDelta(const perfetto::protos::LayersSnapshotProto& snapshot) {
+    return snapshot.where().starts_with(kDeltaWherePrefix);
+}
+
+// Every traced layer has a name, so a layer proto without one marks a removal.
+bool isRemoval(const perfetto::protos::LayerProto& layer) {
+    return !layer.has_name();
+}
+
+} // namespace
+
+LayersSnapshotDeltaEncoder::LayersSnapshotDeltaEncoder(uint32_t keyframeInterval)
+      : mKeyframeInterval(keyframeInterval) {}
+
+void LayersSnapshotDeltaEncoder::encode(perfetto::protos::LayersSnapshotProto& snapshot) {
+    const bool isKeyframe = mSnapshotsSinceKeyframe == 0;
+    mSnapshotsSinceKeyframe = (mSnapshotsSinceKeyframe + 1) % mKeyframeInterval;
+
+    std::unordered_map<int32_t, std::string> layers;
+    layers.reserve(static_cast<size_t>(snapshot.layers().layers_size()));
+    perfetto::protos::LayersProto changedLayers;
+    for (auto& layer : *snapshot.mutable_layers()->mutable_layers()) {
+        const int32_t id = layer.id();
+        std::string bytes = layer.SerializeAsString();
+        if (!isKeyframe) {
+            const auto it = mPreviousLayers.find(id);
+            if (it == mPreviousLayers.end() || it->second != bytes) {
+                changedLayers.add_layers()->Swap(&layer);
+            }
+        }
+        layers.emplace(id, std::move(bytes));
+    }
+
+    if (!isKeyframe) {
+        for (const auto& [id, _] : mPreviousLayers) {
+            if (!layers.contains(id)) {
+                changedLayers.add_layers()->set_id(id);
+            }
+        }
+        snapshot.set_where(kDeltaWherePrefix + snapshot.where());
+        *snapshot.mutable_layers() = std::move(changedLayers);
+    }
+    mPreviousLayers = std::move(layers);
+}
+
+bool LayersSnapshotDeltaDecoder::decode(perfetto::protos::LayersSnapshotProto& snapshot) {
+    if (!isDelta(snapshot)) {
+        mPreviousLayers = snapshot.layers();
+        return true;
+    }
+    if (!mPreviousLayers) {
+        return false;
+    }
+
+    std::unordered_map<int32_t, const perfetto::protos::LayerProto*> changedLayers;
+    std::unordered_set<int32_t> removedLayers;
+    for (const auto& layer : snapshot.layers().layers()) {
+        if (isRemoval(layer)) {
+            removedLayers.insert(layer.id());
+        } else {
+            changedLayers.emplace(layer.id(), &layer);
+        }
+    }
+
+    // Keep the order of the previous snapshot, and add the new layers after it.
+    perfetto::protos::LayersProto layers;
+    for (const auto& layer : mPreviousLayers->layers()) {
+        if (removedLayers.contains(layer.id())) {
+            continue;
+        }
+        if (const auto it = changedLayers.find(layer.id()); it != changedLayers.end()) {
+            *layers.add_layers() = *it->second;
+            changedLayers.erase(it);
+        } else {
+            *layers.add_layers() = layer;
+        }
+    }
+    for (const auto& layer : snapshot.layers().layers()) {
+        if (changedLayers.contains(layer.id())) {
+            *layers.add_layers() = layer;
+        }
+    }
+
+    snapshot.set_where(snapshot.where().substr(std::string_view(kDeltaWherePrefix).size()));
+    *snapshot.mutable_layers() = layers;
+    mPreviousLayers = std::move(layers);
+    return true;
+}
+
+} // namespace android
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <layerproto/LayerProtoHeader.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace android {
+
+/*
+ * Delta encoding of the layers snapshots written by active layer tracing.
+ *
+ * A keyframe is a full snapshot. The following snapshots, until the next keyframe, only
+ * contain the layers which changed since the previous snapshot, and a layer proto with nothing
+ * but the id of each layer which was removed. Their 'where' is prefixed with kDeltaWherePrefix.
+ * Displays and the HWC dump are written in full with every snapshot.
+ *
+ * The traces can be expanded back to full snapshots with
+ *   layertracegenerator --expand-deltas [layers-trace-path] [output-path]
+ */
+class LayersSnapshotDeltaEncoder {
+public:
+    // Every keyframeInterval-th snapshot is a keyframe.
+    explicit LayersSnapshotDeltaEncoder(uint32_t keyframeInterval);
+
+    void encode(perfetto::protos::LayersSnapshotProto& snapshot);
+
+private:
+    const uint32_t mKeyframeInterval;
+    uint32_t mSnapshotsSinceKeyframe = 0;
+    // The serialized layers of the previous snapshot, by id.
+    std::unordered_map<int32_t, std::string> mPreviousLayers;
+};
+
+class LayersSnapshotDeltaDecoder {
+public:
+    // Replaces a delta by the full snapshot. Returns false if there was no keyframe before it.
+    bool decode(perfetto::protos::LayersSnapshotProto& snapshot);
+
+private:
+    std::optional<perfetto::protos::LayersProto> mPreviousLayers;
+};
+
+static constexpr const char* kDeltaWherePrefix = "delta:";
+// The interval between keyframes of active layer tracing. Zero writes full snapshots only.
+static constexpr const char* kLayerTraceKeyframeIntervalProperty =
+        "debug.sf.layer_trace_keyframe_interval";
+
+} // namespace android
@@ -76,11 +76,11 @@ public:
                 return {};
             }
             mUsedInBytes -= static_cast<size_t>(mStorage.front().size());
-            replacedEntries.emplace_back(mStorage.front());
+            replacedEntries.emplace_back(std::move(mStorage.front()));
             mStorage.pop_front();
         }
         mUsedInBytes += protoSize;
-        mStorage.emplace_back(serializedProto);
+        mStorage.emplace_back(std::move(serializedProto));
         return replacedEntries;
     }
 
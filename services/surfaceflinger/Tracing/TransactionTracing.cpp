@@ -233,8 +233,8 @@ void TransactionTracing::addEntry(const std::vector<CommittedUpdates>& committed
     perfetto::protos::TransactionTraceEntry entryProto;
 
     while (auto incomingTransaction = mTransactionQueue.pop()) {
-        auto transaction = *incomingTransaction;
-        mQueuedTransactions[incomingTransaction->transaction_id()] = transaction;
+        const uint64_t id = incomingTransaction->transaction_id();
+        mQueuedTransactions[id] = std::move(*incomingTransaction);
         delete incomingTransaction;
     }
     for (const CommittedUpdates& update : committedUpdates) {
@@ -22,14 +22,60 @@
 #include <string>
 
 #include <Tracing/LayerTracing.h>
+#include <Tracing/LayersSnapshotDelta.h>
+#include <perfetto/trace/trace.pb.h>
 #include "LayerTraceGenerator.h"
 
 using namespace android;
 
+// Rewrites a perfetto trace of delta encoded layers snapshots with full snapshots.
+static int expandDeltas(const char* layersTracePath, const char* outputPath) {
+    std::fstream input(layersTracePath, std::ios::in | std::ios::binary);
+    if (!input) {
+        std::cout << "Error: Could not open " << layersTracePath;
+        return -1;
+    }
+
+    perfetto::protos::Trace trace;
+    if (!trace.ParseFromIstream(&input)) {
+        std::cout << "Error: Failed to parse " << layersTracePath;
+        return -1;
+    }
+
+    LayersSnapshotDeltaDecoder decoder;
+    size_t droppedCount = 0;
+    auto* packets = trace.mutable_packet();
+    for (auto it = packets->begin(); it != packets->end();) {
+        if (it->has_surfaceflinger_layers_snapshot() &&
+            !decoder.decode(*it->mutable_surfaceflinger_layers_snapshot())) {
+            // The keyframe before the delta was overwritten in the ring buffer.
+            it = packets->erase(it);
+            droppedCount++;
+        } else {
+            ++it;
+        }
+    }
+    if (droppedCount > 0) {
+        std::cout << "Dropped " << droppedCount << " snapshots before the first keyframe\n";
+    }
+
+    auto outStream = std::ofstream{outputPath, std::ios::binary | std::ios::out};
+    if (!trace.SerializeToOstream(&outStream)) {
+        std::cout << "Error: Failed to write " << outputPath << "\n";
+        return -1;
+    }
+    return 0;
+}
+
 int main(int argc, char** argv) {
+    if (argc == 4 && std::string_view(argv[1]) == "--expand-deltas") {
+        return expandDeltas(argv[2], argv[3]);
+    }
+
     if (argc > 4) {
         std::cout << "Usage: " << argv[0]
-                  << " [transaction-trace-path] [output-layers-trace-path] [--last-entry-only]\n";
+                  << " [transaction-trace-path] [output-layers-trace-path] [--last-entry-only]\n"
+                  << "       " << argv[0] << " --expand-deltas [layers-trace-path] [output-path]\n";
         return -1;
     }
 
@@ -32,6 +32,8 @@
 #include <common/trace.h>
 #include <utils/RefBase.h>
 
+#include <unordered_map>
+
 namespace android {
 
 // Returns 0 if they are equal
@@ -165,9 +167,16 @@ void TransactionCallbackInvoker::addPresentFence(sp<Fence> presentFence) {
 }
 
 void TransactionCallbackInvoker::sendCallbacks(bool onCommitOnly) {
+    // Send the releases of each channel together, so its consumer can drain them in one read.
+    // The releases for a channel keep their order.
+    std::unordered_map<std::shared_ptr<gui::BufferReleaseChannel::ProducerEndpoint>,
+                       std::vector<gui::BufferReleaseChannel::Message>>
+            releasesByChannel;
     for (const auto& bufferRelease : mBufferReleases) {
-        bufferRelease.channel->writeReleaseFence(bufferRelease.callbackId, bufferRelease.fence,
-                                                 bufferRelease.currentMaxAcquiredBufferCount);
+        releasesByChannel[bufferRelease.channel].emplace_back(
+                bufferRelease.callbackId,
+                bufferRelease.fence ? bufferRelease.fence : Fence::NO_FENCE,
+                bufferRelease.currentMaxAcquiredBufferCount);
     }
     mBufferReleases.clear();
 
@@ -178,6 +187,7 @@ void TransactionCallbackInvoker::sendCallbacks(bool onCommitOnly) {
         auto& [listener, transactionStatsDeque] = *completedTransactionsItr;
         ListenerStats listenerStats;
         listenerStats.listener = listener;
+        listenerStats.transactionStats.reserve(transactionStatsDeque.size());
 
         // For each transaction
         auto transactionStatsItr = transactionStatsDeque.begin();
@@ -196,7 +206,15 @@ void TransactionCallbackInvoker::sendCallbacks(bool onCommitOnly) {
 
             // Remove the transaction from completed to the callback
             listenerStats.transactionStats.push_back(std::move(transactionStats));
-            transactionStatsItr = transactionStatsDeque.erase(transactionStatsItr);
+            if (onCommitOnly) {
+                transactionStatsItr = transactionStatsDeque.erase(transactionStatsItr);
+            } else {
+                transactionStatsItr++;
+            }
+        }
+        if (!onCommitOnly) {
+            // Every transaction was moved out, so drop them together.
+            transactionStatsDeque.clear();
         }
         // If the listener has completed transactions
         if (!listenerStats.transactionStats.empty()) {
@@ -219,11 +237,20 @@ void TransactionCallbackInvoker::sendCallbacks(bool onCommitOnly) {
     }
 
     BackgroundExecutor::getInstance().sendCallbacks(
-            {[listenerStatsToSend = std::move(listenerStatsToSend)]() {
+            {[releasesByChannel = std::move(releasesByChannel),
+              listenerStatsToSend = std::move(listenerStatsToSend)]() mutable {
                 SFTRACE_NAME("TransactionCallbackInvoker::sendCallbacks");
+                // Channel endpoints are only written from this thread, see
+                // Layer::callReleaseBufferCallback.
+                for (const auto& [channel, releases] : releasesByChannel) {
+                    channel->writeReleaseFences(releases);
+                }
                 for (auto& stats : listenerStatsToSend) {
-                    interface_cast<ITransactionCompletedListener>(stats.listener)
-                            ->onTransactionCompleted(stats);
+                    // onTransactionCompleted takes the stats by value, so hand them over rather
+                    // than copying every SurfaceStats.
+                    sp<ITransactionCompletedListener> listener =
+                            interface_cast<ITransactionCompletedListener>(stats.listener);
+                    listener->onTransactionCompleted(std::move(stats));
                 }
             }});
 }
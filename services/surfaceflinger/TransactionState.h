@@ -45,6 +45,8 @@ public:
     uint32_t parentId = UNASSIGNED_LAYER_ID;
     uint32_t relativeParentId = UNASSIGNED_LAYER_ID;
     uint32_t touchCropId = UNASSIGNED_LAYER_ID;
+    // The listeners of the state, split by callback type. Resolved on the binder thread.
+    std::vector<ListenerCallbacks> filteredListeners;
 };
 
 struct TransactionState {
@@ -70,7 +72,7 @@ struct TransactionState {
             uncacheBufferIds(std::move(uncacheBufferIds)),
             postTime(postTime),
             hasListenerCallbacks(hasListenerCallbacks),
-            listenerCallbacks(listenerCallbacks),
+            listenerCallbacks(std::move(listenerCallbacks)),
             originPid(originPid),
             originUid(originUid),
             id(transactionId),
@@ -34,6 +34,17 @@ using gui::DisplayInfo;
 using gui::IWindowInfosListener;
 using gui::WindowInfo;
 
+namespace {
+
+// WindowInfo::operator== leaves out a few of the fields which are sent to the listeners.
+bool isSameWindowInfo(const WindowInfo& a, const WindowInfo& b) {
+    return a == b && a.alpha == b.alpha && a.windowToken == b.windowToken &&
+            a.focusTransferTarget == b.focusTransferTarget &&
+            a.touchableRegionCropHandle == b.touchableRegionCropHandle;
+}
+
+} // namespace
+
 void WindowInfosListenerInvoker::addWindowInfosListener(sp<IWindowInfosListener> listener,
                                                         gui::WindowInfosListenerInfo* outInfo) {
     int64_t listenerId = mNextListenerId++;
@@ -46,7 +57,10 @@ void WindowInfosListenerInvoker::addWindowInfosListener(sp<IWindowInfosListener>
                 sp<IBinder> asBinder = IInterface::asBinder(listener);
                 asBinder->linkToDeath(sp<DeathRecipient>::fromExisting(this));
                 mWindowInfosListeners.try_emplace(asBinder,
-                                                  std::make_pair(listenerId, std::move(listener)));
+                                                  ListenerState{.listenerId = listenerId,
+                                                                .listener = std::move(listener),
+                                                                .ackedUpdateNumber =
+                                                                        mLastUpdateNumber});
             }});
 }
 
@@ -67,140 +81,227 @@ void WindowInfosListenerInvoker::binderDied(const wp<IBinder>& who) {
     }});
 }
 
-void WindowInfosListenerInvoker::eraseListenerAndAckMessages(const wp<IBinder>& binder) {
-    auto it = mWindowInfosListeners.find(binder);
-    int64_t listenerId = it->second.first;
-    mWindowInfosListeners.erase(binder);
-
-    std::vector<int64_t> vsyncIds;
-    for (auto& [vsyncId, state] : mUnackedState) {
-        if (std::find(state.unackedListenerIds.begin(), state.unackedListenerIds.end(),
-                      listenerId) != state.unackedListenerIds.end()) {
-            vsyncIds.push_back(vsyncId);
-        }
-    }
+WindowInfosListenerInvoker::ListenerState* WindowInfosListenerInvoker::findListener(
+        int64_t listenerId) {
+    auto it = std::find_if(mWindowInfosListeners.begin(), mWindowInfosListeners.end(),
+                           [listenerId](const auto& pair) {
+                               return pair.second.listenerId == listenerId;
+                           });
+    return it == mWindowInfosListeners.end() ? nullptr : &it->second;
+}
 
-    for (int64_t vsyncId : vsyncIds) {
-        ackWindowInfosReceived(vsyncId, listenerId);
+void WindowInfosListenerInvoker::eraseListenerAndAckMessages(const wp<IBinder>& binder) {
+    if (!mWindowInfosListeners.erase(binder)) {
+        return;
     }
+    // The reported listeners may only have been waiting on this listener.
+    callReportedListeners();
 }
 
 void WindowInfosListenerInvoker::windowInfosChanged(
         gui::WindowInfosUpdate update, WindowInfosReportedListenerSet reportedListeners,
         bool forceImmediateCall) {
-    if (!mDelayInfo) {
-        mDelayInfo = DelayInfo{
-                .vsyncId = update.vsyncId,
-                .frameTime = update.timestamp,
-        };
-    }
-
-    // If there are unacked messages and this isn't a forced call, then return immediately.
-    // If a forced window infos change doesn't happen first, the update will be sent after
-    // the WindowInfosReportedListeners are called. If a forced window infos change happens or
-    // if there are subsequent delayed messages before this update is sent, then this message
-    // will be dropped and the listeners will only be called with the latest info. This is done
-    // to reduce the amount of binder memory used.
-    if (!mUnackedState.empty() && !forceImmediateCall) {
-        mDelayedUpdate = std::move(update);
+    if (CC_UNLIKELY(mWindowInfosListeners.empty())) {
         mReportedListeners.merge(reportedListeners);
         return;
     }
 
-    if (mDelayedUpdate) {
-        mDelayedUpdate.reset();
+    const uint64_t updateNumber = ++mLastUpdateNumber;
+    reportedListeners.merge(mReportedListeners);
+    mReportedListeners.clear();
+    if (!reportedListeners.empty()) {
+        mPendingReports.try_emplace(updateNumber, std::move(reportedListeners));
     }
 
-    if (CC_UNLIKELY(mWindowInfosListeners.empty())) {
-        mReportedListeners.merge(reportedListeners);
-        mDelayInfo.reset();
-        return;
+    update.windowIds.clear();
+    update.windowIds.reserve(update.windowInfos.size());
+    std::unordered_map<int32_t, size_t> windowIndices;
+    windowIndices.reserve(update.windowInfos.size());
+    bool hasDuplicateIds = false;
+    for (size_t i = 0; i < update.windowInfos.size(); i++) {
+        const int32_t id = update.windowInfos[i].id;
+        update.windowIds.push_back(id);
+        hasDuplicateIds |= !windowIndices.try_emplace(id, i).second;
+    }
+    std::optional<gui::WindowInfosUpdate> incrementalUpdate;
+    if (!hasDuplicateIds) {
+        incrementalUpdate = makeIncrementalUpdate(update, windowIndices);
     }
 
-    reportedListeners.merge(mReportedListeners);
-    mReportedListeners.clear();
+    // Call the listeners which have acked their previous messages. A forced update is sent to
+    // all of them.
+    for (auto& [_, state] : mWindowInfosListeners) {
+        if (!state.unackedMessages.empty() && !forceImmediateCall) {
+            if (!state.delayedSince) {
+                state.delayedSince = DelayInfo{
+                        .vsyncId = update.vsyncId,
+                        .frameTime = update.timestamp,
+                };
+            }
+            // This update is skipped, so the next one can't be incremental.
+            state.needsFullSync = true;
+            continue;
+        }
+        const bool sendFullUpdate = state.needsFullSync || !incrementalUpdate;
+        sendUpdate(state, sendFullUpdate ? update : *incrementalUpdate, updateNumber);
+    }
+
+    mLastUpdate = std::move(update);
+    mLastWindowIndices = std::move(windowIndices);
+    mLastUpdateHasDuplicateIds = hasDuplicateIds;
+}
 
-    // Update mUnackedState to include the message we're about to send
-    auto [it, _] = mUnackedState.try_emplace(update.vsyncId,
-                                             UnackedState{.reportedListeners =
-                                                                  std::move(reportedListeners)});
-    auto& unackedState = it->second;
-    for (auto& pair : mWindowInfosListeners) {
-        int64_t listenerId = pair.second.first;
-        unackedState.unackedListenerIds.push_back(listenerId);
-    }
-
-    mDelayInfo.reset();
-    updateMaxSendDelay();
-
-    // Call the listeners
-    for (auto& pair : mWindowInfosListeners) {
-        auto& [listenerId, listener] = pair.second;
-        auto status = listener->onWindowInfosChanged(update);
-        if (!status.isOk()) {
-            ackWindowInfosReceived(update.vsyncId, listenerId);
+void WindowInfosListenerInvoker::sendUpdate(ListenerState& state,
+                                            const gui::WindowInfosUpdate& update,
+                                            uint64_t updateNumber) {
+    if (state.delayedSince) {
+        updateMaxSendDelay(*state.delayedSince);
+        state.delayedSince.reset();
+    }
+    state.needsFullSync = false;
+    state.unackedMessages.push_back({.vsyncId = update.vsyncId, .updateNumber = updateNumber});
+    auto status = state.listener->onWindowInfosChanged(update);
+    if (!status.isOk()) {
+        ackWindowInfosReceived(update.vsyncId, state.listenerId);
+        state.needsFullSync = true;
+    }
+}
+
+std::optional<gui::WindowInfosUpdate> WindowInfosListenerInvoker::makeIncrementalUpdate(
+        const gui::WindowInfosUpdate& update,
+        const std::unordered_map<int32_t, size_t>& windowIndices) const {
+    if (!mLastUpdate || mLastUpdateHasDuplicateIds) {
+        return std::nullopt;
+    }
+    SFTRACE_CALL();
+
+    gui::WindowInfosUpdate incrementalUpdate{{},
+                                             update.displayInfos,
+                                             update.vsyncId,
+                                             update.timestamp};
+    incrementalUpdate.windowIds = update.windowIds;
+    incrementalUpdate.isIncremental = true;
+    incrementalUpdate.changedWindows.resize(update.windowInfos.size());
+    for (size_t i = 0; i < update.windowInfos.size(); i++) {
+        const WindowInfo& windowInfo = update.windowInfos[i];
+        auto it = mLastWindowIndices.find(windowInfo.id);
+        if (it != mLastWindowIndices.end() &&
+            isSameWindowInfo(mLastUpdate->windowInfos[it->second], windowInfo)) {
+            continue;
         }
+        incrementalUpdate.changedWindows[i] = true;
+        incrementalUpdate.windowInfos.push_back(windowInfo);
+    }
+
+    // When most windows changed, the full update is about as large and simpler to apply.
+    if (incrementalUpdate.windowInfos.size() * 2 > update.windowInfos.size()) {
+        return std::nullopt;
     }
+    return incrementalUpdate;
 }
 
 WindowInfosListenerInvoker::DebugInfo WindowInfosListenerInvoker::getDebugInfo() {
     DebugInfo result;
     BackgroundExecutor::getInstance().sendCallbacks({[&, this]() {
         SFTRACE_NAME("WindowInfosListenerInvoker::getDebugInfo");
-        updateMaxSendDelay();
+        size_t pendingMessageCount = 0;
+        for (const auto& [_, state] : mWindowInfosListeners) {
+            if (state.delayedSince) {
+                updateMaxSendDelay(*state.delayedSince);
+            }
+            pendingMessageCount += state.unackedMessages.size();
+        }
         result = mDebugInfo;
-        result.pendingMessageCount = mUnackedState.size();
+        result.pendingMessageCount = pendingMessageCount;
     }});
     BackgroundExecutor::getInstance().flushQueue();
     return result;
 }
 
-void WindowInfosListenerInvoker::updateMaxSendDelay() {
-    if (!mDelayInfo) {
-        return;
-    }
-    nsecs_t delay = TimePoint::now().ns() - mDelayInfo->frameTime;
+void WindowInfosListenerInvoker::updateMaxSendDelay(const DelayInfo& delayInfo) {
+    nsecs_t delay = TimePoint::now().ns() - delayInfo.frameTime;
     if (delay > mDebugInfo.maxSendDelayDuration) {
         mDebugInfo.maxSendDelayDuration = delay;
-        mDebugInfo.maxSendDelayVsyncId = VsyncId{mDelayInfo->vsyncId};
+        mDebugInfo.maxSendDelayVsyncId = VsyncId{delayInfo.vsyncId};
     }
 }
 
+binder::Status WindowInfosListenerInvoker::requestFullWindowInfos(int64_t listenerId) {
+    BackgroundExecutor::getInstance().sendCallbacks({[this, listenerId]() {
+        SFTRACE_NAME("WindowInfosListenerInvoker::requestFullWindowInfos");
+        ListenerState* state = findListener(listenerId);
+        if (!state) {
+            return;
+        }
+        if (!mLastUpdate) {
+            state->needsFullSync = true;
+            return;
+        }
+
+        // Send the last update again rather than wait for the next one, which could be a while.
+        // It must be acked like any other message.
+        sendUpdate(*state, *mLastUpdate, mLastUpdateNumber);
+    }});
+    return binder::Status::ok();
+}
+
 binder::Status WindowInfosListenerInvoker::ackWindowInfosReceived(int64_t vsyncId,
                                                                   int64_t listenerId) {
     BackgroundExecutor::getInstance().sendCallbacks({[this, vsyncId, listenerId]() {
         SFTRACE_NAME("WindowInfosListenerInvoker::ackWindowInfosReceived");
-        auto it = mUnackedState.find(vsyncId);
-        if (it == mUnackedState.end()) {
+        ListenerState* state = findListener(listenerId);
+        if (!state) {
             return;
         }
 
-        auto& state = it->second;
-        state.unackedListenerIds.unstable_erase(std::find(state.unackedListenerIds.begin(),
-                                                          state.unackedListenerIds.end(),
-                                                          listenerId));
-        if (!state.unackedListenerIds.empty()) {
+        auto it = std::find_if(state->unackedMessages.begin(), state->unackedMessages.end(),
+                               [vsyncId](const auto& message) {
+                                   return message.vsyncId == vsyncId;
+                               });
+        if (it == state->unackedMessages.end()) {
             return;
         }
+        state->ackedUpdateNumber = std::max(state->ackedUpdateNumber, it->updateNumber);
+        state->unackedMessages.unstable_erase(it);
 
-        WindowInfosReportedListenerSet reportedListeners{std::move(state.reportedListeners)};
-        mUnackedState.erase(vsyncId);
-
-        for (const auto& reportedListener : reportedListeners) {
-            sp<IBinder> asBinder = IInterface::asBinder(reportedListener);
-            if (asBinder->isBinderAlive()) {
-                reportedListener->onWindowInfosReported();
-            }
+        // Catch the listener up with the latest update, if any were held back from it.
+        if (state->unackedMessages.empty() && state->delayedSince && mLastUpdate) {
+            sendUpdate(*state, *mLastUpdate, mLastUpdateNumber);
         }
 
-        if (!mDelayedUpdate || !mUnackedState.empty()) {
-            return;
-        }
-        gui::WindowInfosUpdate update{std::move(*mDelayedUpdate)};
-        mDelayedUpdate.reset();
-        windowInfosChanged(std::move(update), {}, false);
+        callReportedListeners();
     }});
     return binder::Status::ok();
 }
 
+void WindowInfosListenerInvoker::callReportedListeners() {
+    if (mPendingReports.empty()) {
+        return;
+    }
+
+    uint64_t ackedUpdateNumber = mLastUpdateNumber;
+    for (const auto& [_, state] : mWindowInfosListeners) {
+        ackedUpdateNumber = std::min(ackedUpdateNumber, state.ackedUpdateNumber);
+    }
+
+    WindowInfosReportedListenerSet reportedListeners;
+    std::vector<uint64_t> updateNumbers;
+    for (auto& [updateNumber, listeners] : mPendingReports) {
+        if (updateNumber <= ackedUpdateNumber) {
+            reportedListeners.merge(listeners);
+            updateNumbers.push_back(updateNumber);
+        }
+    }
+    for (uint64_t updateNumber : updateNumbers) {
+        mPendingReports.erase(updateNumber);
+    }
+
+    for (const auto& reportedListener : reportedListeners) {
+        sp<IBinder> asBinder = IInterface::asBinder(reportedListener);
+        if (asBinder->isBinderAlive()) {
+            reportedListener->onWindowInfosReported();
+        }
+    }
+}
+
 } // namespace android
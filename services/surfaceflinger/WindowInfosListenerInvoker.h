@@ -17,6 +17,7 @@
 #pragma once
 
 #include <optional>
+#include <unordered_map>
 #include <unordered_set>
 
 #include <android/gui/BnWindowInfosPublisher.h>
@@ -26,6 +27,7 @@
 #include <ftl/small_map.h>
 #include <ftl/small_vector.h>
 #include <gui/SpHash.h>
+#include <gui/WindowInfosUpdate.h>
 #include <utils/Mutex.h>
 
 #include "scheduler/VsyncId.h"
@@ -47,6 +49,7 @@ public:
                             bool forceImmediateCall);
 
     binder::Status ackWindowInfosReceived(int64_t, int64_t) override;
+    binder::Status requestFullWindowInfos(int64_t listenerId) override;
 
     struct DebugInfo {
         VsyncId maxSendDelayVsyncId;
@@ -61,27 +64,59 @@ protected:
 private:
     static constexpr size_t kStaticCapacity = 3;
     std::atomic<int64_t> mNextListenerId{0};
-    ftl::SmallMap<wp<IBinder>, const std::pair<int64_t, sp<gui::IWindowInfosListener>>,
-                  kStaticCapacity>
-            mWindowInfosListeners;
 
-    std::optional<gui::WindowInfosUpdate> mDelayedUpdate;
-    WindowInfosReportedListenerSet mReportedListeners;
-    void eraseListenerAndAckMessages(const wp<IBinder>&);
-
-    struct UnackedState {
-        ftl::SmallVector<int64_t, kStaticCapacity> unackedListenerIds;
-        WindowInfosReportedListenerSet reportedListeners;
-    };
-    ftl::SmallMap<int64_t /* vsyncId */, UnackedState, 5> mUnackedState;
-
-    DebugInfo mDebugInfo;
     struct DelayInfo {
         int64_t vsyncId;
         nsecs_t frameTime;
     };
-    std::optional<DelayInfo> mDelayInfo;
-    void updateMaxSendDelay();
+
+    // Each listener has its own pipeline, so that a slow listener doesn't hold back the updates
+    // of the others. While a listener has unacked messages, new updates aren't sent to it. Once
+    // it acks, it is sent the latest update only; the ones in between are dropped for it. This
+    // is done to reduce the amount of binder memory used.
+    struct ListenerState {
+        int64_t listenerId;
+        sp<gui::IWindowInfosListener> listener;
+
+        struct UnackedMessage {
+            int64_t vsyncId;
+            uint64_t updateNumber;
+        };
+        ftl::SmallVector<UnackedMessage, 2> unackedMessages;
+
+        // Number of the latest update this listener acked, or of the latest update at the time
+        // it was added.
+        uint64_t ackedUpdateNumber;
+
+        // Set while an update is being held back from this listener.
+        std::optional<DelayInfo> delayedSince;
+
+        // Listeners are sent the windows which changed since the last update, mLastUpdate,
+        // except when this is set: new listeners, listeners which skipped an update, and
+        // listeners which failed to receive or apply an update.
+        bool needsFullSync = true;
+    };
+    ftl::SmallMap<wp<IBinder>, ListenerState, kStaticCapacity> mWindowInfosListeners;
+    ListenerState* findListener(int64_t listenerId);
+    void eraseListenerAndAckMessages(const wp<IBinder>&);
+    void sendUpdate(ListenerState&, const gui::WindowInfosUpdate&, uint64_t updateNumber);
+
+    std::optional<gui::WindowInfosUpdate> mLastUpdate;
+    uint64_t mLastUpdateNumber = 0;
+    std::unordered_map<int32_t /* windowId */, size_t> mLastWindowIndices;
+    bool mLastUpdateHasDuplicateIds = false;
+    std::optional<gui::WindowInfosUpdate> makeIncrementalUpdate(
+            const gui::WindowInfosUpdate& update,
+            const std::unordered_map<int32_t, size_t>& windowIndices) const;
+
+    // Reported listeners are called once every listener has acked the update they came with, or
+    // a later one. The ones which came while there were no listeners wait for the next update.
+    WindowInfosReportedListenerSet mReportedListeners;
+    ftl::SmallMap<uint64_t /* updateNumber */, WindowInfosReportedListenerSet, 5> mPendingReports;
+    void callReportedListeners();
+
+    DebugInfo mDebugInfo;
+    void updateMaxSendDelay(const DelayInfo&);
 };
 
 } // namespace android
@@ -57,4 +57,21 @@ TEST_F(DisplayEventReceiverTest, getLatestVsyncEventData) {
     }
 }
 
+TEST_F(DisplayEventReceiverTest, readVsyncTimelinePage) {
+    const nsecs_t now = systemTime();
+    VsyncEventData vsyncEventData;
+    ASSERT_EQ(NO_ERROR, mDisplayEventReceiver.readVsyncTimelinePage(&vsyncEventData));
+
+    EXPECT_GT(static_cast<int64_t>(vsyncEventData.frameTimelinesLength), 0)
+            << "Frame timelines length should be greater than 0";
+    EXPECT_LE(static_cast<int64_t>(vsyncEventData.frameTimelinesLength),
+              VsyncEventData::kFrameTimelinesCapacity)
+            << "Frame timelines length should not exceed max capacity";
+    EXPECT_GT(vsyncEventData.frameTimelines[0].deadlineTimestamp, now)
+            << "A new page should hold upcoming deadlines";
+
+    // Later reads come from the mapped page.
+    EXPECT_EQ(NO_ERROR, mDisplayEventReceiver.readVsyncTimelinePage(&vsyncEventData));
+}
+
 } // namespace android
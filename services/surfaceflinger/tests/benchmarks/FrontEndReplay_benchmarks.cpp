@@ -0,0 +1,151 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <FrontEnd/LayerHierarchy.h>
+#include <FrontEnd/LayerLifecycleManager.h>
+#include <FrontEnd/LayerSnapshotBuilder.h>
+#include <Tracing/TransactionProtoParser.h>
+#include <binder/Binder.h>
+
+namespace android::surfaceflinger {
+
+namespace {
+
+using namespace android::surfaceflinger::frontend;
+
+// The trace to replay, as written by `adb shell service call SurfaceFlinger 1041 i32 0`.
+constexpr const char* kDefaultTracePath = "/data/misc/wmtrace/transactions_trace.winscope";
+
+std::optional<perfetto::protos::TransactionTraceFile> loadTrace() {
+    const char* path = std::getenv("SF_BENCHMARK_TRANSACTION_TRACE");
+    std::ifstream input(path ? path : kDefaultTracePath, std::ios::in | std::ios::binary);
+    perfetto::protos::TransactionTraceFile traceFile;
+    if (!input || !traceFile.ParseFromIstream(&input) || traceFile.entry_size() == 0) {
+        return std::nullopt;
+    }
+    return traceFile;
+}
+
+// The main thread work SurfaceFlinger does for one entry of the trace.
+struct Frame {
+    std::vector<std::unique_ptr<RequestedLayerState>> addedLayers;
+    std::vector<TransactionState> transactions;
+    std::vector<std::pair<uint32_t, std::string>> destroyedHandles;
+    bool displaysChanged = false;
+};
+
+Frame parseFrame(TransactionProtoParser& parser,
+                 const perfetto::protos::TransactionTraceEntry& entry, DisplayInfos& displayInfos) {
+    Frame frame;
+    for (const auto& addedLayer : entry.added_layers()) {
+        LayerCreationArgs args;
+        parser.fromProto(addedLayer, args);
+        frame.addedLayers.emplace_back(std::make_unique<RequestedLayerState>(args));
+    }
+    for (const auto& transactionProto : entry.transactions()) {
+        TransactionState transaction = parser.fromProto(transactionProto);
+        for (auto& resolvedComposerState : transaction.states) {
+            if ((resolvedComposerState.state.what & layer_state_t::eInputInfoChanged) &&
+                !resolvedComposerState.state.windowInfoHandle->getInfo()->inputConfig.test(
+                        gui::WindowInfo::InputConfig::NO_INPUT_CHANNEL)) {
+                // The FrontEnd expects a valid token, as in LayerTraceGenerator.
+                resolvedComposerState.state.windowInfoHandle->editInfo()->token =
+                        sp<BBinder>::make();
+            }
+        }
+        frame.transactions.emplace_back(std::move(transaction));
+    }
+    for (const uint32_t handle : entry.destroyed_layer_handles()) {
+        frame.destroyedHandles.emplace_back(handle, "");
+    }
+    frame.displaysChanged = entry.displays_changed();
+    if (frame.displaysChanged) {
+        parser.fromProto(entry.displays(), displayInfos);
+    }
+    return frame;
+}
+
+int64_t percentile(const std::vector<int64_t>& sortedValues, size_t percent) {
+    return sortedValues[(sortedValues.size() - 1) * percent / 100];
+}
+
+// Replays a recorded transaction trace through the FrontEnd, without a display, and reports
+// the percentiles of the per frame commit latency. Parsing the trace is not measured.
+static void replayTransactionTrace(benchmark::State& state) {
+    const auto traceFile = loadTrace();
+    if (!traceFile) {
+        state.SkipWithError("Set SF_BENCHMARK_TRANSACTION_TRACE to a transaction trace");
+        return;
+    }
+
+    std::vector<int64_t> frameLatencies;
+    for (auto _ : state) {
+        TransactionProtoParser parser(
+                std::make_unique<TransactionProtoParser::FlingerDataMapper>());
+        LayerLifecycleManager lifecycleManager;
+        LayerHierarchyBuilder hierarchyBuilder;
+        LayerSnapshotBuilder snapshotBuilder;
+        DisplayInfos displayInfos;
+        ShadowSettings globalShadowSettings{.ambientColor = {1, 1, 1, 1}};
+
+        std::chrono::nanoseconds replayTime{0};
+        for (const auto& entry : traceFile->entry()) {
+            Frame frame = parseFrame(parser, entry, displayInfos);
+
+            const auto start = std::chrono::steady_clock::now();
+            lifecycleManager.addLayers(std::move(frame.addedLayers));
+            lifecycleManager.applyTransactions(frame.transactions, /*ignoreUnknownHandles=*/true);
+            lifecycleManager.onHandlesDestroyed(frame.destroyedHandles,
+                                                /*ignoreUnknownHandles=*/true);
+            hierarchyBuilder.update(lifecycleManager);
+            LayerSnapshotBuilder::Args args{.root = hierarchyBuilder.getHierarchy(),
+                                            .layerLifecycleManager = lifecycleManager,
+                                            .displays = displayInfos,
+                                            .displayChanges = frame.displaysChanged,
+                                            .globalShadowSettings = globalShadowSettings,
+                                            .supportedLayerGenericMetadata = {},
+                                            .genericLayerMetadataKeyMap = {}};
+            snapshotBuilder.update(args);
+            lifecycleManager.commitChanges();
+            const auto frameLatency = std::chrono::steady_clock::now() - start;
+
+            replayTime += frameLatency;
+            frameLatencies.push_back(frameLatency.count());
+        }
+        state.SetIterationTime(std::chrono::duration<double>(replayTime).count());
+    }
+
+    std::sort(frameLatencies.begin(), frameLatencies.end());
+    state.counters["frames"] = static_cast<double>(traceFile->entry_size());
+    state.counters["p50_us"] = static_cast<double>(percentile(frameLatencies, 50)) / 1000;
+    state.counters["p90_us"] = static_cast<double>(percentile(frameLatencies, 90)) / 1000;
+    state.counters["p99_us"] = static_cast<double>(percentile(frameLatencies, 99)) / 1000;
+    state.counters["max_us"] = static_cast<double>(frameLatencies.back()) / 1000;
+}
+BENCHMARK(replayTransactionTrace)->UseManualTime()->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace android::surfaceflinger
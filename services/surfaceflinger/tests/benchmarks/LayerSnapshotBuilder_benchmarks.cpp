@@ -0,0 +1,77 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <FrontEnd/LayerHierarchy.h>
+#include <FrontEnd/LayerLifecycleManager.h>
+#include <FrontEnd/LayerSnapshotBuilder.h>
+#include <LayerLifecycleManagerHelper.h>
+
+namespace android::surfaceflinger {
+
+namespace {
+
+using namespace android::surfaceflinger::frontend;
+
+constexpr uint32_t kRootCount = 4;
+constexpr uint32_t kChildrenPerRoot = 64;
+
+// Moves every root of a hierarchy with kRootCount independent root subtrees, so that every
+// snapshot is updated, with state.range(0) traversal threads.
+static void updateRootSubtrees(benchmark::State& state) {
+    LayerLifecycleManager lifecycleManager;
+    LayerLifecycleManagerHelper helper(lifecycleManager);
+    for (uint32_t root = 1; root <= kRootCount; root++) {
+        helper.createRootLayer(root);
+        for (uint32_t child = 0; child < kChildrenPerRoot; child++) {
+            const uint32_t childId = root * 1000 + child;
+            helper.createLayer(childId, root);
+            helper.createLayer(childId * 10, childId);
+        }
+    }
+
+    LayerHierarchyBuilder hierarchyBuilder;
+    hierarchyBuilder.update(lifecycleManager);
+    DisplayInfos displays;
+    ShadowSettings globalShadowSettings;
+    LayerSnapshotBuilder snapshotBuilder;
+    snapshotBuilder.setTraversalThreadCount(static_cast<size_t>(state.range(0)));
+    auto update = [&]() {
+        LayerSnapshotBuilder::Args args{.root = hierarchyBuilder.getHierarchy(),
+                                        .layerLifecycleManager = lifecycleManager,
+                                        .displays = displays,
+                                        .globalShadowSettings = globalShadowSettings,
+                                        .supportedLayerGenericMetadata = {},
+                                        .genericLayerMetadataKeyMap = {}};
+        snapshotBuilder.update(args);
+        lifecycleManager.commitChanges();
+    };
+    update();
+
+    float position = 0.f;
+    for (auto _ : state) {
+        position = position > 100.f ? 0.f : position + 1.f;
+        for (uint32_t root = 1; root <= kRootCount; root++) {
+            helper.setPosition(root, position, position);
+        }
+        update();
+    }
+}
+BENCHMARK(updateRootSubtrees)->Arg(1)->Arg(2)->Arg(4);
+
+} // namespace
+} // namespace android::surfaceflinger
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <Scheduler/RefreshRateSelector.h>
+#include <mock/DisplayHardware/MockDisplayMode.h>
+
+namespace android::scheduler {
+
+namespace {
+
+using LayerRequirement = RefreshRateSelector::LayerRequirement;
+using LayerVoteType = RefreshRateSelector::LayerVoteType;
+
+constexpr DisplayModeId kModeId60{0};
+constexpr DisplayModeId kModeId90{1};
+constexpr DisplayModeId kModeId120{2};
+
+// A summary of state.range(0) layers, as LayerHistory::summarize produces for a busy screen.
+std::vector<LayerRequirement> createSummary(int64_t layerCount) {
+    std::vector<LayerRequirement> layers;
+    for (int64_t i = 0; i < layerCount; i++) {
+        layers.push_back({.name = "Layer#" + std::to_string(i),
+                          .vote = i % 2 == 0 ? LayerVoteType::Heuristic
+                                             : LayerVoteType::ExplicitDefault,
+                          .desiredRefreshRate = i % 3 == 0 ? 30_Hz : 60_Hz,
+                          .weight = 1.f,
+                          .focused = i == 0});
+    }
+    return layers;
+}
+
+RefreshRateSelector createSelector() {
+    return RefreshRateSelector(makeModes(mock::createDisplayMode(kModeId60, 60_Hz),
+                                         mock::createDisplayMode(kModeId90, 90_Hz),
+                                         mock::createDisplayMode(kModeId120, 120_Hz)),
+                               kModeId60);
+}
+
+// The summary is unchanged every frame, e.g. for steady video or games.
+static void rankUnchangedSummary(benchmark::State& state) {
+    RefreshRateSelector selector = createSelector();
+    const std::vector<LayerRequirement> layers = createSummary(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(selector.getRankedFrameRates(layers, {}));
+    }
+}
+BENCHMARK(rankUnchangedSummary)->Arg(8)->Arg(64);
+
+// The summary alternates between two states, e.g. with touch boost toggling.
+static void rankAlternatingSummary(benchmark::State& state) {
+    RefreshRateSelector selector = createSelector();
+    const std::vector<LayerRequirement> layers = createSummary(state.range(0));
+    bool touch = false;
+    for (auto _ : state) {
+        touch = !touch;
+        benchmark::DoNotOptimize(selector.getRankedFrameRates(layers, {.touch = touch}));
+    }
+}
+BENCHMARK(rankAlternatingSummary)->Arg(8)->Arg(64);
+
+// A layer changes its vote every frame, so every summary is ranked.
+static void rankChangingSummary(benchmark::State& state) {
+    RefreshRateSelector selector = createSelector();
+    std::vector<LayerRequirement> layers = createSummary(state.range(0));
+    float weight = 0.f;
+    for (auto _ : state) {
+        weight = weight >= 1.f ? 0.f : weight + 0.01f;
+        layers.back().weight = weight;
+        benchmark::DoNotOptimize(selector.getRankedFrameRates(layers, {}));
+    }
+}
+BENCHMARK(rankChangingSummary)->Arg(8)->Arg(64);
+
+} // namespace
+} // namespace android::scheduler
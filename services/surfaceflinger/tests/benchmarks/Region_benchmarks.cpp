@@ -0,0 +1,77 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <ui/Rect.h>
+#include <ui/Region.h>
+
+namespace android::surfaceflinger {
+
+namespace {
+
+// Runs the region operations CompositionEngine's Output::ensureOutputLayerIfVisible does for
+// each layer, from top to bottom, on a stack of state.range(0) layers.
+static void accumulateCoverage(benchmark::State& state, const std::vector<Rect>& layers) {
+    for (auto _ : state) {
+        Region aboveCoveredLayers;
+        Region aboveOpaqueLayers;
+        Region dirtyRegion;
+        for (const Rect& layer : layers) {
+            Region visibleRegion(layer);
+            Region coveredRegion = aboveCoveredLayers.intersect(visibleRegion);
+            aboveCoveredLayers.orSelf(visibleRegion);
+            visibleRegion.subtractSelf(aboveOpaqueLayers);
+            dirtyRegion.orSelf(visibleRegion.subtract(coveredRegion));
+            aboveOpaqueLayers.orSelf(layer);
+            benchmark::DoNotOptimize(visibleRegion);
+        }
+        benchmark::DoNotOptimize(dirtyRegion);
+    }
+}
+
+// Full screen layers, such as an app with a wallpaper under it, keep every region a rect.
+static void coverageOfStackedLayers(benchmark::State& state) {
+    const std::vector<Rect> layers(static_cast<size_t>(state.range(0)), Rect(0, 0, 1080, 2400));
+    accumulateCoverage(state, layers);
+}
+BENCHMARK(coverageOfStackedLayers)->Arg(4)->Arg(16);
+
+// Bars along the edges of the screen and the app between them.
+static void coverageOfTiledLayers(benchmark::State& state) {
+    std::vector<Rect> layers;
+    const int32_t height = 2400 / static_cast<int32_t>(state.range(0));
+    for (int32_t top = 0; top < 2400; top += height) {
+        layers.emplace_back(0, top, 1080, top + height);
+    }
+    accumulateCoverage(state, layers);
+}
+BENCHMARK(coverageOfTiledLayers)->Arg(4)->Arg(16);
+
+// Overlapping windows, whose coverage needs more than one rect.
+static void coverageOfCascadedLayers(benchmark::State& state) {
+    std::vector<Rect> layers;
+    for (int32_t i = 0; i < state.range(0); i++) {
+        layers.emplace_back(i * 40, i * 80, i * 40 + 600, i * 80 + 1200);
+    }
+    accumulateCoverage(state, layers);
+}
+BENCHMARK(coverageOfCascadedLayers)->Arg(4)->Arg(16);
+
+} // namespace
+} // namespace android::surfaceflinger
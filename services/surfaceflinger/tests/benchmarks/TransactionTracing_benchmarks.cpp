@@ -0,0 +1,79 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+
+#include <benchmark/benchmark.h>
+
+#include <FrontEnd/Update.h>
+#include <Tracing/TransactionProtoParser.h>
+#include <Tracing/TransactionTracing.h>
+
+namespace android::surfaceflinger {
+
+namespace {
+
+// A transaction which moves, fades and scales state.range(0) layers, as an animation would.
+TransactionState createAnimationTransaction(benchmark::State& state, uint64_t id) {
+    TransactionState transaction;
+    transaction.id = id;
+    transaction.originUid = 1;
+    transaction.originPid = 2;
+    for (uint32_t layerId = 1; layerId <= static_cast<uint32_t>(state.range(0)); layerId++) {
+        transaction.states.push_back({});
+        auto& resolvedState = transaction.states.back();
+        resolvedState.layerId = layerId;
+        resolvedState.state.what = layer_state_t::ePositionChanged | layer_state_t::eAlphaChanged |
+                layer_state_t::eMatrixChanged;
+        resolvedState.state.x = static_cast<float>(layerId);
+        resolvedState.state.y = static_cast<float>(layerId);
+        resolvedState.state.color.a = 0.5f;
+        resolvedState.state.matrix = {0.9f, 0.f, 0.f, 0.9f};
+    }
+    return transaction;
+}
+
+// Converts a transaction to the proto the tracing thread stores, and serializes it.
+static void transactionToProto(benchmark::State& state) {
+    TransactionProtoParser parser(std::make_unique<TransactionProtoParser::FlingerDataMapper>());
+    const TransactionState transaction = createAnimationTransaction(state, 1);
+    for (auto _ : state) {
+        const auto proto = parser.toProto(transaction);
+        benchmark::DoNotOptimize(proto.SerializeAsString());
+    }
+}
+BENCHMARK(transactionToProto)->Arg(1)->Arg(16);
+
+// Queues and commits a transaction every frame, and waits for the tracing thread to add it to
+// the ring buffer, so that the main thread and tracing thread work are both measured.
+static void traceCommittedTransaction(benchmark::State& state) {
+    TransactionTracing tracing;
+    int64_t vsyncId = 0;
+    for (auto _ : state) {
+        vsyncId++;
+        const TransactionState transaction =
+                createAnimationTransaction(state, static_cast<uint64_t>(vsyncId));
+        tracing.addQueuedTransaction(transaction);
+        frontend::Update update;
+        update.transactions.emplace_back(transaction);
+        tracing.addCommittedTransactions(vsyncId, 0, update, {}, false);
+        tracing.flush();
+    }
+}
+BENCHMARK(traceCommittedTransaction)->Arg(1)->Arg(16);
+
+} // namespace
+} // namespace android::surfaceflinger
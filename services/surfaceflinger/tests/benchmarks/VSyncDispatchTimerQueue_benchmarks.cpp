@@ -0,0 +1,142 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <Scheduler/VSyncDispatchTimerQueue.h>
+#include <Scheduler/VSyncPredictor.h>
+#include <mock/DisplayHardware/MockDisplayMode.h>
+#include <scheduler/TimeKeeper.h>
+
+namespace android::scheduler {
+
+namespace {
+
+constexpr nsecs_t kPeriod = (120_Hz).getPeriodNsecs();
+
+// Keeps the armed alarm instead of firing it, so that the benchmark fires it on its own thread.
+// Time only moves when the alarm fires.
+class ManualTimeKeeper : public TimeKeeper {
+public:
+    nsecs_t now() const override { return mNow; }
+    void alarmAt(std::function<void()> callback, nsecs_t time) override {
+        mCallback = std::move(callback);
+        mAlarmTime = time;
+    }
+    void alarmCancel() override { mCallback = nullptr; }
+    void dump(std::string&) const override {}
+
+    void fire() {
+        if (auto callback = std::exchange(mCallback, nullptr)) {
+            mNow = std::max(mNow, mAlarmTime);
+            callback();
+        }
+    }
+
+private:
+    nsecs_t mNow = 0;
+    nsecs_t mAlarmTime = 0;
+    std::function<void()> mCallback;
+};
+
+// Lets the tracker see the same time as the dispatch.
+class TimeKeeperClock : public Clock {
+public:
+    explicit TimeKeeperClock(const ManualTimeKeeper& timeKeeper) : mTimeKeeper(timeKeeper) {}
+    nsecs_t now() const override { return mTimeKeeper.now(); }
+
+private:
+    const ManualTimeKeeper& mTimeKeeper;
+};
+
+struct Dispatch {
+    explicit Dispatch(size_t callbackCount) {
+        auto manualTimeKeeper = std::make_unique<ManualTimeKeeper>();
+        timeKeeper = manualTimeKeeper.get();
+        auto tracker = std::make_shared<
+                VSyncPredictor>(std::make_unique<TimeKeeperClock>(*timeKeeper),
+                                ftl::as_non_null(mock::createDisplayMode(DisplayModeId(0), 120_Hz)),
+                                /* historySize */ 20, /* minimumSamplesForPrediction */ 6,
+                                /* outlierTolerancePercent */ 25);
+        dispatch = std::make_unique<VSyncDispatchTimerQueue>(std::move(manualTimeKeeper),
+                                                             std::move(tracker),
+                                                             /* timerSlack */ 500'000,
+                                                             /* minVsyncDistance */ 3'000'000);
+        for (size_t i = 0; i < callbackCount; i++) {
+            tokens.push_back(
+                    dispatch->registerCallback([](nsecs_t, nsecs_t, nsecs_t) {},
+                                               "callback" + std::to_string(i)));
+        }
+    }
+
+    ~Dispatch() {
+        for (const auto token : tokens) {
+            dispatch->unregisterCallback(token);
+        }
+    }
+
+    // Spreads the wakeups of the callbacks over the vsync period.
+    VSyncDispatch::ScheduleTiming timing(size_t i) const {
+        return {.workDuration = static_cast<nsecs_t>(i % 16) * kPeriod / 16,
+                .readyDuration = 0,
+                .lastVsync = timeKeeper->now()};
+    }
+
+    ManualTimeKeeper* timeKeeper;
+    std::unique_ptr<VSyncDispatchTimerQueue> dispatch;
+    std::vector<VSyncDispatch::CallbackToken> tokens;
+};
+
+// Reschedules one callback while state.range(0) callbacks are armed, as an EventThread
+// connection does every frame.
+static void scheduleWithArmedCallbacks(benchmark::State& state) {
+    Dispatch dispatch(static_cast<size_t>(state.range(0)));
+    for (size_t i = 0; i < dispatch.tokens.size(); i++) {
+        dispatch.dispatch->schedule(dispatch.tokens[i], dispatch.timing(i));
+    }
+
+    size_t i = 0;
+    for (auto _ : state) {
+        i = (i + 1) % dispatch.tokens.size();
+        benchmark::DoNotOptimize(dispatch.dispatch->schedule(dispatch.tokens[i],
+                                                             dispatch.timing(i)));
+    }
+}
+BENCHMARK(scheduleWithArmedCallbacks)->Arg(4)->Arg(64)->Arg(256);
+
+// Arms state.range(0) callbacks and fires the timer until all of them have run.
+static void dispatchArmedCallbacks(benchmark::State& state) {
+    Dispatch dispatch(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        for (size_t i = 0; i < dispatch.tokens.size(); i++) {
+            dispatch.dispatch->schedule(dispatch.tokens[i], dispatch.timing(i));
+        }
+        for (size_t fires = 0; fires < dispatch.tokens.size(); fires++) {
+            dispatch.timeKeeper->fire();
+        }
+    }
+}
+BENCHMARK(dispatchArmedCallbacks)->Arg(4)->Arg(64)->Arg(256);
+
+} // namespace
+} // namespace android::scheduler
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+
+#include <benchmark/benchmark.h>
+
+#include <Scheduler/VSyncPredictor.h>
+#include <Scheduler/VSyncReactor.h>
+#include <mock/DisplayHardware/MockDisplayMode.h>
+
+namespace android::scheduler {
+
+namespace {
+
+// The history VsyncSchedule creates predictors with.
+constexpr size_t kHistorySize = 20;
+constexpr size_t kMinimumSamplesForPrediction = 6;
+constexpr uint32_t kOutlierTolerancePercent = 25;
+
+// Feeds a predictor HW vsync timestamps of a state.range(0) Hz panel, with a few microseconds of
+// jitter, as the HWVsync callback thread does once the history is full.
+static void addVsyncTimestamp(benchmark::State& state) {
+    const Fps refreshRate = Fps::fromValue(static_cast<float>(state.range(0)));
+    const nsecs_t period = refreshRate.getPeriodNsecs();
+    VSyncPredictor predictor(std::make_unique<SystemClock>(),
+                             ftl::as_non_null(mock::createDisplayMode(DisplayModeId(0),
+                                                                      refreshRate)),
+                             kHistorySize, kMinimumSamplesForPrediction,
+                             kOutlierTolerancePercent);
+
+    nsecs_t vsync = 0;
+    int64_t sample = 0;
+    auto addSample = [&]() {
+        vsync += period;
+        const nsecs_t jitter = (sample++ % 7 - 3) * 1000;
+        benchmark::DoNotOptimize(predictor.addVsyncTimestamp(vsync + jitter));
+    };
+    for (size_t i = 0; i < kHistorySize; i++) {
+        addSample();
+    }
+
+    for (auto _ : state) {
+        addSample();
+    }
+}
+BENCHMARK(addVsyncTimestamp)->Arg(60)->Arg(144)->Arg(240);
+
+} // namespace
+} // namespace android::scheduler
@@ -0,0 +1,294 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <binder/ProcessState.h>
+#include <gui/BLASTBufferQueue.h>
+#include <gui/ISurfaceComposerClient.h>
+#include <gui/Surface.h>
+#include <gui/SurfaceComposerClient.h>
+#include <gui/SurfaceControl.h>
+#include <system/window.h>
+#include <ui/Fence.h>
+#include <ui/LayerStack.h>
+#include <utils/Timers.h>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Usage: atest surfaceflinger_frame_pipeline_benchmark
+//
+// Drives producer surfaces through BLASTBufferQueue into the running SurfaceFlinger and reports
+// where queued frames spend their time, using the producer side FrameTimestamps. The device
+// display must be on.
+
+using namespace android;
+using namespace std::chrono_literals;
+
+namespace {
+
+using Transaction = SurfaceComposerClient::Transaction;
+
+constexpr int kFramesPerProducer = 240;
+constexpr uint32_t kLayerSize = 256;
+constexpr int kLayersPerRow = 4;
+
+// How long to wait after the last frame is queued for the remaining frames to be presented.
+constexpr auto kResolveTimeout = 1s;
+constexpr auto kResolvePollInterval = 4ms;
+
+struct FrameStats {
+    std::vector<nsecs_t> queueToLatch;
+    std::vector<nsecs_t> latchToPresent;
+    int64_t droppedFrames = 0;
+    // Frames which aged out of the producer's frame event history before they were resolved.
+    int64_t untrackedFrames = 0;
+
+    void merge(const FrameStats& other) {
+        queueToLatch.insert(queueToLatch.end(), other.queueToLatch.begin(),
+                            other.queueToLatch.end());
+        latchToPresent.insert(latchToPresent.end(), other.latchToPresent.begin(),
+                              other.latchToPresent.end());
+        droppedFrames += other.droppedFrames;
+        untrackedFrames += other.untrackedFrames;
+    }
+};
+
+double percentileMs(std::vector<nsecs_t>& values, double percentile) {
+    if (values.empty()) {
+        return 0;
+    }
+    const size_t index =
+            std::min(values.size() - 1, static_cast<size_t>(percentile * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return static_cast<double>(values[index]) / ms2ns(1);
+}
+
+// A buffer state layer fed by a BLASTBufferQueue, queueing CPU buffers at a fixed rate.
+class Producer {
+public:
+    Producer(const sp<SurfaceComposerClient>& client, int index) {
+        const std::string name = "FramePipelineBenchmark#" + std::to_string(index);
+        mSurfaceControl = client->createSurface(String8(name.c_str()), kLayerSize, kLayerSize,
+                                                PIXEL_FORMAT_RGBA_8888,
+                                                ISurfaceComposerClient::eFXSurfaceBufferState);
+        if (mSurfaceControl == nullptr) {
+            return;
+        }
+        Transaction()
+                .setLayerStack(mSurfaceControl, ui::DEFAULT_LAYER_STACK)
+                .setLayer(mSurfaceControl, INT32_MAX - 1)
+                .setPosition(mSurfaceControl, (index % kLayersPerRow) * kLayerSize,
+                             (index / kLayersPerRow) * kLayerSize)
+                .show(mSurfaceControl)
+                .apply(true);
+
+        mBlastBufferQueue = sp<BLASTBufferQueue>::make(name);
+        mBlastBufferQueue->update(mSurfaceControl, kLayerSize, kLayerSize, PIXEL_FORMAT_RGBA_8888);
+        mSurface = mBlastBufferQueue->getSurface(false);
+        mSurface->enableFrameTimestamps(true);
+
+        ANativeWindow* window = mSurface.get();
+        if (native_window_api_connect(window, NATIVE_WINDOW_API_CPU) != OK) {
+            mSurface.clear();
+            return;
+        }
+        int supportsPresent = 0;
+        window->query(window, NATIVE_WINDOW_FRAME_TIMESTAMPS_SUPPORTS_PRESENT, &supportsPresent);
+        mSupportsPresent = supportsPresent != 0;
+    }
+
+    ~Producer() {
+        if (mSurface != nullptr) {
+            native_window_api_disconnect(mSurface.get(), NATIVE_WINDOW_API_CPU);
+        }
+    }
+
+    bool isValid() const { return mSurface != nullptr; }
+
+    // Queues frameCount frames, one every framePeriod, then waits for them to be presented.
+    // Returns false if a buffer could not be dequeued or queued.
+    bool run(int frameCount, nsecs_t framePeriod) {
+        auto nextFrameTime = std::chrono::steady_clock::now();
+        for (int i = 0; i < frameCount; i++) {
+            std::this_thread::sleep_until(nextFrameTime);
+            nextFrameTime += std::chrono::nanoseconds(framePeriod);
+            if (!queueFrame()) {
+                return false;
+            }
+            // Resolve frames as we go, since the frame event history only holds a few frames.
+            collect();
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + kResolveTimeout;
+        while (!mPendingFrames.empty() && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(kResolvePollInterval);
+            collect();
+        }
+        mStats.untrackedFrames += static_cast<int64_t>(mPendingFrames.size());
+        mPendingFrames.clear();
+        return true;
+    }
+
+    const FrameStats& stats() const { return mStats; }
+
+private:
+    struct PendingFrame {
+        uint64_t frameNumber;
+        nsecs_t queueTime;
+    };
+
+    bool queueFrame() {
+        ANativeWindow* window = mSurface.get();
+        ANativeWindowBuffer* buffer = nullptr;
+        int fenceFd = -1;
+        if (window->dequeueBuffer(window, &buffer, &fenceFd) != OK) {
+            return false;
+        }
+        sp<Fence>::make(fenceFd)->waitForever("FramePipelineBenchmark");
+
+        const uint64_t frameNumber = mSurface->getNextFrameNumber();
+        const nsecs_t queueTime = systemTime();
+        if (window->queueBuffer(window, buffer, -1) != OK) {
+            return false;
+        }
+        mPendingFrames.push_back({frameNumber, queueTime});
+        return true;
+    }
+
+    // Records every pending frame whose fate is known. A frame is presented once it has both a
+    // latch time and a present time, and dropped once a newer frame has been latched without it.
+    void collect() {
+        bool newerFrameLatched = false;
+        std::deque<PendingFrame> unresolved;
+        for (auto it = mPendingFrames.rbegin(); it != mPendingFrames.rend(); ++it) {
+            nsecs_t latchTime = NATIVE_WINDOW_TIMESTAMP_PENDING;
+            nsecs_t presentTime = NATIVE_WINDOW_TIMESTAMP_PENDING;
+            const status_t status =
+                    mSurface->getFrameTimestamps(it->frameNumber, nullptr, nullptr, &latchTime,
+                                                 nullptr, nullptr, nullptr,
+                                                 mSupportsPresent ? &presentTime : nullptr,
+                                                 nullptr, nullptr);
+            if (status != OK) {
+                mStats.untrackedFrames++;
+                continue;
+            }
+            if (latchTime > 0) {
+                newerFrameLatched = true;
+                if (mSupportsPresent && presentTime == NATIVE_WINDOW_TIMESTAMP_PENDING) {
+                    unresolved.push_front(*it);
+                    continue;
+                }
+                mStats.queueToLatch.push_back(latchTime - it->queueTime);
+                if (presentTime > 0) {
+                    mStats.latchToPresent.push_back(presentTime - latchTime);
+                }
+                continue;
+            }
+            if (newerFrameLatched) {
+                mStats.droppedFrames++;
+                continue;
+            }
+            unresolved.push_front(*it);
+        }
+        mPendingFrames = std::move(unresolved);
+    }
+
+    sp<SurfaceControl> mSurfaceControl;
+    sp<BLASTBufferQueue> mBlastBufferQueue;
+    sp<Surface> mSurface;
+    bool mSupportsPresent = false;
+    std::deque<PendingFrame> mPendingFrames;
+    FrameStats mStats;
+};
+
+// Arguments: the number of producer surfaces and the rate in Hz at which each one queues.
+// Every iteration queues kFramesPerProducer frames on each producer concurrently.
+void BM_FramePipeline(benchmark::State& state) {
+    const auto client = sp<SurfaceComposerClient>::make();
+    if (client->initCheck() != NO_ERROR) {
+        state.SkipWithError("failed to connect to SurfaceFlinger");
+        return;
+    }
+
+    const int producerCount = static_cast<int>(state.range(0));
+    const nsecs_t framePeriod = s2ns(1) / state.range(1);
+    std::vector<std::unique_ptr<Producer>> producers;
+    for (int i = 0; i < producerCount; i++) {
+        producers.push_back(std::make_unique<Producer>(client, i));
+        if (!producers.back()->isValid()) {
+            state.SkipWithError("failed to create producer surface");
+            return;
+        }
+    }
+
+    for (auto _ : state) {
+        std::vector<std::thread> threads;
+        std::vector<char> succeeded(producers.size(), false);
+        for (size_t i = 0; i < producers.size(); i++) {
+            threads.emplace_back([&, i] {
+                succeeded[i] = producers[i]->run(kFramesPerProducer, framePeriod);
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        if (std::find(succeeded.begin(), succeeded.end(), false) != succeeded.end()) {
+            state.SkipWithError("failed to dequeue or queue a buffer");
+            break;
+        }
+    }
+    if (state.error_occurred()) {
+        return;
+    }
+
+    FrameStats stats;
+    for (const auto& producer : producers) {
+        stats.merge(producer->stats());
+    }
+    state.counters["queue_to_latch_p50_ms"] = percentileMs(stats.queueToLatch, 0.5);
+    state.counters["queue_to_latch_p90_ms"] = percentileMs(stats.queueToLatch, 0.9);
+    state.counters["latch_to_present_p50_ms"] = percentileMs(stats.latchToPresent, 0.5);
+    state.counters["latch_to_present_p90_ms"] = percentileMs(stats.latchToPresent, 0.9);
+    state.counters["dropped_frames"] = static_cast<double>(stats.droppedFrames);
+    state.counters["untracked_frames"] = static_cast<double>(stats.untrackedFrames);
+    state.SetItemsProcessed(state.iterations() * producerCount * kFramesPerProducer);
+}
+
+BENCHMARK(BM_FramePipeline)
+        ->ArgNames({"producers", "hz"})
+        ->Args({1, 60})
+        ->Args({4, 60})
+        ->Args({8, 60})
+        ->Args({1, 120})
+        ->Args({4, 30})
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+} // namespace
+
+int main(int argc, char** argv) {
+    // Transaction completed and buffer release callbacks arrive on binder threads.
+    ProcessState::self()->startThreadPool();
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    return 0;
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <condition_variable>
+#include <vector>
 
 #include "BackgroundExecutor.h"
 
@@ -52,6 +53,43 @@ TEST_F(BackgroundExecutorTest, multipleProducers) {
     ASSERT_EQ(backgroundTaskCount, backgroundTaskCompleteCount);
 }
 
+TEST_F(BackgroundExecutorTest, preservesOrderWhenRingIsFull) {
+    auto& executor = BackgroundExecutor::getLowPriorityInstance();
+    const auto statsBefore = executor.getStats();
+
+    std::mutex mutex;
+    std::condition_variable condition_variable;
+    bool blocked = true;
+    executor.sendCallbacks({[&mutex, &condition_variable, &blocked]() {
+        std::unique_lock<std::mutex> lock{mutex};
+        condition_variable.wait(lock, [&blocked]() { return !blocked; });
+    }});
+
+    const size_t taskCount = BackgroundExecutor::kRingCapacity * 2;
+    std::vector<size_t> order;
+    for (size_t i = 0; i < taskCount; i++) {
+        executor.sendCallbacks({[&order, i]() { order.push_back(i); }});
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        blocked = false;
+    }
+    condition_variable.notify_one();
+    executor.flushQueue();
+
+    ASSERT_EQ(taskCount, order.size());
+    for (size_t i = 0; i < taskCount; i++) {
+        EXPECT_EQ(i, order[i]);
+    }
+
+    const auto statsAfter = executor.getStats();
+    EXPECT_EQ(taskCount + 2, statsAfter.submissions - statsBefore.submissions);
+    EXPECT_EQ(taskCount + 2, statsAfter.executions - statsBefore.executions);
+    EXPECT_GT(statsAfter.overflows, statsBefore.overflows);
+    EXPECT_GT(statsAfter.maxQueueDepth, BackgroundExecutor::kRingCapacity);
+}
+
 } // namespace
 
 } // namespace android
@@ -24,6 +24,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <log/log.h>
+#include <poll.h>
 #include <scheduler/VsyncConfig.h>
 #include <utils/Errors.h>
 
@@ -536,6 +537,83 @@ TEST_F(EventThreadTest, getLatestVsyncEventData) {
     }
 }
 
+TEST_F(EventThreadTest, vsyncTimelinePageFollowsDispatchedVsync) {
+    setupEventThread();
+
+    const nsecs_t now = systemTime();
+    mock::VSyncTracker& mockTracker =
+            *static_cast<mock::VSyncTracker*>(&mVsyncSchedule->getTracker());
+    EXPECT_CALL(mockTracker, nextAnticipatedVSyncTimeFrom(_, _))
+            .WillOnce(Return(now + 20000000));
+
+    base::unique_fd fd = mThread->getVsyncTimelinePage(mConnection);
+    ASSERT_TRUE(fd.ok());
+    EXPECT_TRUE(mResyncCallRecorder.waitForCall().has_value());
+    auto page = gui::VsyncTimelinePage::map(std::move(fd));
+    ASSERT_NE(nullptr, page);
+
+    // The page is readable before any vsync is dispatched.
+    VsyncEventData vsyncEventData;
+    ASSERT_EQ(OK, page->read(&vsyncEventData));
+    expectVsyncEventDataFrameTimelinesValidLength(vsyncEventData);
+
+    mThread->requestNextVsync(mConnection);
+    EXPECT_TRUE(mResyncCallRecorder.waitForCall().has_value());
+    expectVSyncCallbackScheduleReceived(true);
+    onVSyncEvent(123, 456, 789);
+
+    auto args = mConnectionEventCallRecorder.waitForCall();
+    ASSERT_TRUE(args.has_value());
+    const auto& event = std::get<0>(args.value());
+    ASSERT_EQ(OK, page->read(&vsyncEventData));
+    ASSERT_EQ(event.vsync.vsyncData.frameTimelinesLength, vsyncEventData.frameTimelinesLength);
+    for (size_t i = 0; i < vsyncEventData.frameTimelinesLength; i++) {
+        EXPECT_EQ(event.vsync.vsyncData.frameTimelines[i].vsyncId,
+                  vsyncEventData.frameTimelines[i].vsyncId)
+                << "Vsync ID does not match the dispatched event for frame timeline " << i;
+    }
+}
+
+TEST_F(EventThreadTest, vsyncBroadcastReplacesBitTubeForVsyncs) {
+    setupEventThread();
+
+    gui::VsyncBroadcastSubscription subscription;
+    ASSERT_EQ(NO_ERROR, mThread->subscribeToVsyncBroadcast(mConnection, &subscription));
+    auto page = gui::VsyncBroadcastPage::map(subscription.page.release());
+    ASSERT_NE(nullptr, page);
+    const base::unique_fd wakeFd = subscription.wakeEvent.release();
+    ASSERT_TRUE(wakeFd.ok());
+
+    uint64_t sequence = 0;
+    DisplayEventReceiver::Event event;
+    EXPECT_EQ(NOT_ENOUGH_DATA, page->readNext(&sequence, &event));
+
+    mThread->requestNextVsync(mConnection);
+    EXPECT_TRUE(mResyncCallRecorder.waitForCall().has_value());
+    expectVSyncCallbackScheduleReceived(true);
+    onVSyncEvent(123, 456, 789);
+
+    // The vsync goes to the page instead of the BitTube, and wakes the subscribers once.
+    struct pollfd wakePoll = {.fd = wakeFd.get(), .events = POLLIN};
+    ASSERT_EQ(1, poll(&wakePoll, 1, 1000));
+    uint64_t wakeCount = 0;
+    ASSERT_EQ(static_cast<ssize_t>(sizeof(wakeCount)),
+              read(wakeFd.get(), &wakeCount, sizeof(wakeCount)));
+    EXPECT_EQ(1u, wakeCount);
+    EXPECT_FALSE(mConnectionEventCallRecorder.waitForUnexpectedCall().has_value());
+
+    ASSERT_EQ(OK, page->readNext(&sequence, &event));
+    EXPECT_EQ(DisplayEventReceiver::DISPLAY_EVENT_VSYNC, event.header.type);
+    EXPECT_EQ(123, event.header.timestamp);
+    EXPECT_EQ(1u, event.vsync.count);
+    expectVsyncEventDataFrameTimelinesValidLength(event.vsync.vsyncData);
+    EXPECT_EQ(NOT_ENOUGH_DATA, page->readNext(&sequence, &event));
+
+    // Other events still go through the BitTube.
+    mThread->onHotplugReceived(INTERNAL_DISPLAY_ID, false);
+    expectHotplugEventReceivedByConnection(INTERNAL_DISPLAY_ID, false);
+}
+
 TEST_F(EventThreadTest, setVsyncRateZeroPostsNoVSyncEventsToThatConnection) {
     setupEventThread();
 
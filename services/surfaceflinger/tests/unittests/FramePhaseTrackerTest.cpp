@@ -0,0 +1,70 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "FramePhaseTracker.h"
+
+namespace android {
+namespace {
+
+TEST(FramePhaseTrackerTest, accumulatesPhasesOfAFrame) {
+    FramePhaseTracker tracker;
+    EXPECT_EQ(nullptr, tracker.getFrame());
+
+    tracker.addDuration(10, FramePhase::TransactionFlush, 100);
+    tracker.addDuration(10, FramePhase::SnapshotBuild, 200);
+    tracker.addDuration(10, FramePhase::SnapshotBuild, 50);
+
+    const FramePhaseTracker::FrameRecord* frame = tracker.getFrame();
+    ASSERT_NE(nullptr, frame);
+    EXPECT_EQ(10, frame->vsyncId);
+    EXPECT_EQ(100, frame->durations[static_cast<size_t>(FramePhase::TransactionFlush)]);
+    EXPECT_EQ(250, frame->durations[static_cast<size_t>(FramePhase::SnapshotBuild)]);
+    EXPECT_EQ(0, frame->durations[static_cast<size_t>(FramePhase::CompositionPresent)]);
+    EXPECT_EQ(nullptr, tracker.getFrame(1));
+}
+
+TEST(FramePhaseTrackerTest, keepsTheMostRecentFrames) {
+    FramePhaseTracker tracker;
+    const int64_t frameCount = static_cast<int64_t>(FramePhaseTracker::kFrameCount) + 3;
+    for (int64_t vsyncId = 1; vsyncId <= frameCount; vsyncId++) {
+        tracker.addDuration(vsyncId, FramePhase::CompositionPresent, vsyncId);
+    }
+
+    EXPECT_EQ(frameCount, tracker.getFrame()->vsyncId);
+    EXPECT_EQ(frameCount - 1, tracker.getFrame(1)->vsyncId);
+    const FramePhaseTracker::FrameRecord* oldest =
+            tracker.getFrame(FramePhaseTracker::kFrameCount - 1);
+    ASSERT_NE(nullptr, oldest);
+    EXPECT_EQ(4, oldest->vsyncId);
+    EXPECT_EQ(4, oldest->durations[static_cast<size_t>(FramePhase::CompositionPresent)]);
+    EXPECT_EQ(nullptr, tracker.getFrame(FramePhaseTracker::kFrameCount));
+}
+
+TEST(FramePhaseTrackerTest, dumpsEveryPhase) {
+    FramePhaseTracker tracker;
+    tracker.addDuration(1, FramePhase::WindowInfos, 2'000'000);
+
+    std::string result;
+    tracker.dump(result);
+    EXPECT_NE(std::string::npos, result.find("last 1 frames"));
+    EXPECT_NE(std::string::npos, result.find("WindowInfos"));
+    EXPECT_NE(std::string::npos, result.find("2.000"));
+}
+
+} // namespace
+} // namespace android
@@ -27,6 +27,7 @@
 #include <gtest/gtest.h>
 #include <log/log.h>
 #include <perfetto/trace/trace.pb.h>
+#include <algorithm>
 #include <cinttypes>
 
 using namespace std::chrono_literals;
@@ -147,7 +148,7 @@ public:
         for (size_t i = 0; i < maxTokens; i++) {
             mTokenManager->generateTokenForPredictions({});
         }
-        EXPECT_EQ(getPredictions().size(), maxTokens);
+        EXPECT_EQ(getPredictionCount(), maxTokens);
     }
 
     SurfaceFrame& getSurfaceFrame(size_t displayFrameIdx, size_t surfaceFrameIdx) {
@@ -166,8 +167,13 @@ public:
                 a.presentTime == b.presentTime;
     }
 
-    const std::map<int64_t, TimelineItem>& getPredictions() const {
-        return mTokenManager->mPredictions;
+    size_t getPredictionCount() const {
+        std::lock_guard<std::mutex> lock(mTokenManager->mMutex);
+        return static_cast<size_t>(
+                std::count_if(mTokenManager->mPredictions.begin(),
+                              mTokenManager->mPredictions.end(), [](const auto& slot) {
+                                  return slot.token != FrameTimelineInfo::INVALID_VSYNC_ID;
+                              }));
     }
 
     uint32_t getNumberOfDisplayFrames() const {
@@ -211,7 +217,7 @@ public:
 
 TEST_F(FrameTimelineTest, tokenManagerRemovesStalePredictions) {
     int64_t token1 = mTokenManager->generateTokenForPredictions({0, 0, 0});
-    EXPECT_EQ(getPredictions().size(), 1u);
+    EXPECT_EQ(getPredictionCount(), 1u);
     flushTokens();
     int64_t token2 = mTokenManager->generateTokenForPredictions({10, 20, 30});
     std::optional<TimelineItem> predictions = mTokenManager->getPredictionsForToken(token1);
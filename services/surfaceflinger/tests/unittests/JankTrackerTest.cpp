@@ -183,6 +183,27 @@ TEST_F(JankTrackerTest, jankDataIsDroppedIfNobodyIsListening) {
     EXPECT_EQ(getCollectedJankData(123).size(), 0u);
 }
 
+TEST_F(JankTrackerTest, oldestJankDataIsOverwrittenWhenBacklogIsFull) {
+    ASSERT_EQ(listenerCount(), 0u);
+
+    constexpr size_t kCapacity = JankTracker::kMaxPendingJankDataPerLayer;
+    constexpr size_t kOverflow = 10;
+
+    JankTracker::clearAndStartCollectingAllJankDataForTesting();
+    for (size_t i = 0; i < kCapacity + kOverflow; i++) {
+        addJankData(123, 0);
+    }
+    flushBackgroundThread();
+
+    std::vector<gui::JankData> jankData = getCollectedJankData(123);
+    ASSERT_EQ(jankData.size(), kCapacity);
+    EXPECT_EQ(jankData.front().frameVsyncId, 1000 + static_cast<int64_t>(kOverflow));
+    EXPECT_EQ(jankData.back().frameVsyncId, mVsyncId - 1);
+    JankTracker::clearAndStopCollectingAllJankDataForTesting();
+
+    EXPECT_EQ(listenerCount(), 0u);
+}
+
 TEST_F(JankTrackerTest, listenerCountTracksRegistrations) {
     ASSERT_EQ(listenerCount(), 0u);
 
@@ -45,7 +45,10 @@ protected:
     LayerInfoTest() { mFlinger.resetScheduler(mScheduler); }
 
     void setFrameTimes(const std::deque<FrameTimeData>& frameTimes) {
-        layerInfo.mFrameTimes = frameTimes;
+        layerInfo.mFrameTimes.clear();
+        for (const auto& frameTime : frameTimes) {
+            layerInfo.mFrameTimes.next() = frameTime;
+        }
     }
 
     void setLastRefreshRate(Fps fps) {
@@ -1935,4 +1935,116 @@ TEST_F(LayerSnapshotTest, shouldUpdateInputWhenNoInputInfo) {
     EXPECT_FALSE(getSnapshot(2)->hasInputInfo());
 }
 
+TEST_F(LayerSnapshotTest, parallelTraversalMatchesSerialTraversal) {
+    LayerSnapshotBuilder serialBuilder;
+    LayerSnapshotBuilder parallelBuilder;
+    parallelBuilder.setTraversalThreadCount(3);
+
+    auto updateAndCompare = [&](LayerSnapshotBuilder::ForceUpdateFlags forceUpdate) {
+        SCOPED_TRACE("");
+        if (mLifecycleManager.getGlobalChanges().test(RequestedLayerState::Changes::Hierarchy)) {
+            mHierarchyBuilder.update(mLifecycleManager);
+        }
+        LayerSnapshotBuilder::Args args{.root = mHierarchyBuilder.getHierarchy(),
+                                        .layerLifecycleManager = mLifecycleManager,
+                                        .forceUpdate = forceUpdate,
+                                        .includeMetadata = false,
+                                        .displays = mFrontEndDisplayInfos,
+                                        .globalShadowSettings = globalShadowSettings,
+                                        .supportsBlur = true,
+                                        .supportedLayerGenericMetadata = {},
+                                        .genericLayerMetadataKeyMap = {}};
+        serialBuilder.update(args);
+        parallelBuilder.update(args);
+        mLifecycleManager.commitChanges();
+
+        auto& expected = serialBuilder.getSnapshots();
+        auto& actual = parallelBuilder.getSnapshots();
+        ASSERT_EQ(expected.size(), actual.size());
+        for (size_t i = 0; i < expected.size(); i++) {
+            EXPECT_EQ(expected[i]->getDebugString(), actual[i]->getDebugString());
+            EXPECT_EQ(expected[i]->globalZ, actual[i]->globalZ);
+        }
+    };
+
+    // Root subtrees 1, 2 and 3 are independent.
+    createRootLayer(3);
+    createLayer(31, 3);
+    updateAndCompare(LayerSnapshotBuilder::ForceUpdateFlags::ALL);
+
+    setPosition(11, 10, 20);
+    setAlpha(2, 0.5f);
+    setCrop(31, Rect(0, 0, 30, 30));
+    updateAndCompare(LayerSnapshotBuilder::ForceUpdateFlags::NONE);
+
+    // Relative z ties root subtrees 1 and 3 together.
+    reparentRelativeLayer(12, 31);
+    setBuffer(1221);
+    setTouchableRegionCrop(1221, Region(Rect(0, 0, 50, 50)), /*touchCropId=*/31,
+                           /*replaceTouchableRegionWithCrop=*/true);
+    updateAndCompare(LayerSnapshotBuilder::ForceUpdateFlags::NONE);
+
+    createLayer(32, 3);
+    hideLayer(11);
+    updateAndCompare(LayerSnapshotBuilder::ForceUpdateFlags::NONE);
+
+    removeRelativeZ(12);
+    destroyLayerHandle(32);
+    setZ(2, -1);
+    updateAndCompare(LayerSnapshotBuilder::ForceUpdateFlags::NONE);
+}
+
+TEST_F(LayerSnapshotTest, bufferOnlyUpdates) {
+    auto makeBuffer = [](uint64_t bufferId, PixelFormat format) {
+        return std::make_shared<renderengine::mock::FakeExternalTexture>(100U /*width*/,
+                                                                          100U /*height*/,
+                                                                          bufferId, format,
+                                                                          0 /*usage*/);
+    };
+
+    // The first buffer makes the layer visible.
+    setBuffer(1, makeBuffer(1ULL, HAL_PIXEL_FORMAT_RGBA_8888));
+    UPDATE_AND_VERIFY(mSnapshotBuilder, STARTING_ZORDER);
+    EXPECT_FALSE(mSnapshotBuilder.isLastUpdateBufferOnly());
+
+    setBuffer(1, makeBuffer(2ULL, HAL_PIXEL_FORMAT_RGBA_8888));
+    UPDATE_AND_VERIFY(mSnapshotBuilder, STARTING_ZORDER);
+    EXPECT_TRUE(mSnapshotBuilder.isLastUpdateBufferOnly());
+
+    // A buffer which makes the layer opaque changes what it occludes.
+    setBuffer(1, makeBuffer(3ULL, HAL_PIXEL_FORMAT_RGBX_8888));
+    UPDATE_AND_VERIFY(mSnapshotBuilder, STARTING_ZORDER);
+    EXPECT_FALSE(mSnapshotBuilder.isLastUpdateBufferOnly());
+
+    setBuffer(1, makeBuffer(4ULL, HAL_PIXEL_FORMAT_RGBX_8888));
+    setAlpha(1, 0.5f);
+    UPDATE_AND_VERIFY(mSnapshotBuilder, STARTING_ZORDER);
+    EXPECT_FALSE(mSnapshotBuilder.isLastUpdateBufferOnly());
+
+    // Nothing changed at all.
+    UPDATE_AND_VERIFY(mSnapshotBuilder, STARTING_ZORDER);
+    EXPECT_FALSE(mSnapshotBuilder.isLastUpdateBufferOnly());
+}
+
+TEST_F(LayerSnapshotTest, skipsUnchangedSubtrees) {
+    setPosition(111, 10, 20);
+    UPDATE_AND_VERIFY(mSnapshotBuilder, STARTING_ZORDER);
+    EXPECT_EQ(getSnapshot(111)->geomLayerTransform.tx(), 10);
+    // Only the path to 111 is visited. 12, 13 and 2 are skipped.
+    EXPECT_EQ(mSnapshotBuilder.getLastTraversalStats().visitedSnapshots, 3u);
+    EXPECT_EQ(mSnapshotBuilder.getLastTraversalStats().skippedSubtrees, 3u);
+
+    // Alpha is passed down, so the whole subtree of 1 is visited.
+    setAlpha(1, 0.5f);
+    UPDATE_AND_VERIFY(mSnapshotBuilder, STARTING_ZORDER);
+    EXPECT_EQ(getSnapshot(1221)->alpha, 0.5f);
+    EXPECT_EQ(mSnapshotBuilder.getLastTraversalStats().visitedSnapshots, 8u);
+    EXPECT_EQ(mSnapshotBuilder.getLastTraversalStats().skippedSubtrees, 1u);
+
+    // Hierarchy changes visit everything.
+    reparentLayer(13, 2);
+    UPDATE_AND_VERIFY(mSnapshotBuilder, {1, 11, 111, 12, 121, 122, 1221, 2, 13});
+    EXPECT_EQ(mSnapshotBuilder.getLastTraversalStats().skippedSubtrees, 0u);
+}
+
 } // namespace android::surfaceflinger::frontend
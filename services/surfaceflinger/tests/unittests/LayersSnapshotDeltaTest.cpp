@@ -0,0 +1,78 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#undef LOG_TAG
+#define LOG_TAG "LayersSnapshotDeltaTest"
+
+#include <gtest/gtest.h>
+
+#include "Tracing/LayersSnapshotDelta.h"
+
+namespace android {
+
+class LayersSnapshotDeltaTest : public testing::Test {
+protected:
+    static perfetto::protos::LayersSnapshotProto createSnapshot(
+            const std::vector<std::pair<int32_t, float>>& layerAlphas) {
+        perfetto::protos::LayersSnapshotProto snapshot;
+        snapshot.set_where("visibleRegionsDirty");
+        for (const auto& [id, alpha] : layerAlphas) {
+            auto* layer = snapshot.mutable_layers()->add_layers();
+            layer->set_id(id);
+            layer->set_name("layer" + std::to_string(id));
+            layer->mutable_color()->set_a(alpha);
+        }
+        return snapshot;
+    }
+
+    // Encodes and decodes the snapshot, and checks it's restored.
+    void expectRoundTrip(const perfetto::protos::LayersSnapshotProto& snapshot) {
+        auto encoded = snapshot;
+        mEncoder.encode(encoded);
+        mEncodedLayerCounts.push_back(encoded.layers().layers_size());
+        ASSERT_TRUE(mDecoder.decode(encoded));
+        EXPECT_EQ(encoded.SerializeAsString(), snapshot.SerializeAsString());
+    }
+
+    LayersSnapshotDeltaEncoder mEncoder{3};
+    LayersSnapshotDeltaDecoder mDecoder;
+    std::vector<int> mEncodedLayerCounts;
+};
+
+TEST_F(LayersSnapshotDeltaTest, writesChangedLayersBetweenKeyframes) {
+    expectRoundTrip(createSnapshot({{1, 1.f}, {2, 1.f}, {3, 1.f}}));
+    expectRoundTrip(createSnapshot({{1, 1.f}, {2, 0.5f}, {3, 1.f}}));
+    expectRoundTrip(createSnapshot({{1, 1.f}, {2, 0.5f}, {3, 1.f}}));
+    // Keyframe
+    expectRoundTrip(createSnapshot({{1, 1.f}, {2, 0.5f}, {3, 1.f}}));
+    EXPECT_EQ(mEncodedLayerCounts, (std::vector<int>{3, 1, 0, 3}));
+}
+
+TEST_F(LayersSnapshotDeltaTest, writesAddedAndRemovedLayers) {
+    expectRoundTrip(createSnapshot({{1, 1.f}, {2, 1.f}}));
+    expectRoundTrip(createSnapshot({{1, 1.f}, {3, 1.f}}));
+    EXPECT_EQ(mEncodedLayerCounts, (std::vector<int>{2, 2}));
+}
+
+TEST_F(LayersSnapshotDeltaTest, deltaWithoutKeyframeIsNotDecoded) {
+    auto keyframe = createSnapshot({{1, 1.f}});
+    mEncoder.encode(keyframe);
+    auto delta = createSnapshot({{1, 0.5f}});
+    mEncoder.encode(delta);
+    EXPECT_FALSE(mDecoder.decode(delta));
+}
+
+} // namespace android
@@ -354,6 +354,69 @@ TEST_F(PowerAdvisorTest, hintSessionUseHwcDisplay) {
     mPowerAdvisor->reportActualWorkDuration();
 }
 
+TEST_F(PowerAdvisorTest, hintSessionPadsActualDurationAfterMissedFrames) {
+    mPowerAdvisor->onBootFinished();
+    startPowerHintSession();
+
+    std::vector<DisplayId> displayIds{PhysicalDisplayId::fromPort(42u)};
+
+    // 60hz
+    const Duration vsyncPeriod{std::chrono::nanoseconds(1s) / 60};
+    const Duration presentDuration = 5ms;
+    const Duration postCompDuration = 1ms;
+    const Duration missedFrameHeadroom = Duration::fromNs(vsyncPeriod.ns() / 4);
+    const Duration maxMissedFrameHeadroom = Duration::fromNs(vsyncPeriod.ns() / 2);
+
+    TimePoint startTime{100ns};
+
+    auto runFrame = [&](bool previousFrameMissed) {
+        fakeBasicFrameTiming(startTime, vsyncPeriod);
+        mPowerAdvisor->setPreviousFrameMissed(previousFrameMissed);
+        setExpectedTiming(vsyncPeriod, startTime + vsyncPeriod);
+        mPowerAdvisor->setDisplays(displayIds);
+        mPowerAdvisor->setHwcValidateTiming(displayIds[0], startTime + 1ms, startTime + 1500us);
+        mPowerAdvisor->setHwcPresentTiming(displayIds[0], startTime + 2ms, startTime + 2500us);
+        mPowerAdvisor->setSfPresentTiming(startTime, startTime + presentDuration);
+        mPowerAdvisor->reportActualWorkDuration();
+        mPowerAdvisor->setCompositeEnd(startTime + presentDuration + postCompDuration);
+        startTime += vsyncPeriod;
+    };
+
+    auto expectDuration = [&](Duration headroom) {
+        const Duration expectedDuration =
+                getErrorMargin() + headroom + presentDuration + postCompDuration;
+        EXPECT_CALL(*mMockPowerHintSession,
+                    reportActualWorkDuration(ElementsAre(
+                            Field(&WorkDuration::durationNanos, Eq(expectedDuration.ns())))))
+                .Times(1)
+                .WillOnce(Return(testing::ByMove(HalResult<void>::ok())));
+    };
+
+    // advisor only starts on frame 2 so do an initial no-op frame
+    runFrame(false);
+
+    expectDuration(0ns);
+    runFrame(false);
+    Mock::VerifyAndClearExpectations(mMockPowerHintSession.get());
+
+    expectDuration(missedFrameHeadroom);
+    runFrame(true);
+    Mock::VerifyAndClearExpectations(mMockPowerHintSession.get());
+
+    // The headroom is capped at half of the target...
+    expectDuration(maxMissedFrameHeadroom);
+    runFrame(true);
+    Mock::VerifyAndClearExpectations(mMockPowerHintSession.get());
+
+    expectDuration(maxMissedFrameHeadroom);
+    runFrame(true);
+    Mock::VerifyAndClearExpectations(mMockPowerHintSession.get());
+
+    // ...and decays while frames present on time
+    expectDuration(maxMissedFrameHeadroom - Duration::fromNs(maxMissedFrameHeadroom.ns() / 8));
+    runFrame(false);
+}
+
 TEST_F(PowerAdvisorTest, hintSessionSubtractsHwcFenceTime) {
     mPowerAdvisor->onBootFinished();
     startPowerHintSession();
@@ -3256,19 +3256,21 @@ TEST_P(RefreshRateSelectorTest, getBestFrameRateMode_ReadsCache) {
                                                                   {90_Hz, kMode90}}},
                                                           GlobalSignals{.touch = true}};
 
-    selector.mutableGetRankedRefreshRatesCache() = {.layers = std::vector<LayerRequirement>{},
-                                                    .signals = GlobalSignals{.touch = true,
-                                                                             .idle = true},
-                                                    .result = result};
-
-    const auto& cache = *selector.mutableGetRankedRefreshRatesCache();
+    const GlobalSignals signals{.touch = true, .idle = true};
+    selector.mutableGetRankedRefreshRatesCache().push_back(
+            {.layers = std::vector<LayerRequirement>{},
+             .signals = signals,
+             .result = result,
+             .key = TestableRefreshRateSelector::GetRankedFrameRatesCache::makeKey({}, signals)});
+
+    const auto& cache = selector.mutableGetRankedRefreshRatesCache().front();
     EXPECT_EQ(result, selector.getRankedFrameRates(cache.layers, cache.signals));
 }
 
 TEST_P(RefreshRateSelectorTest, getBestFrameRateMode_WritesCache) {
     auto selector = createSelector(kModes_30_60_72_90_120, kModeId60);
 
-    EXPECT_FALSE(selector.mutableGetRankedRefreshRatesCache());
+    EXPECT_TRUE(selector.mutableGetRankedRefreshRatesCache().empty());
 
     const std::vector<LayerRequirement> layers = {{.weight = 1.f}, {.weight = 0.5f}};
     const RefreshRateSelector::GlobalSignals globalSignals{.touch = true, .idle = true};
@@ -3276,13 +3278,39 @@ TEST_P(RefreshRateSelectorTest, getBestFrameRateMode_WritesCache) {
 
     const auto result = selector.getRankedFrameRates(layers, globalSignals, pacesetterFps);
 
-    const auto& cache = selector.mutableGetRankedRefreshRatesCache();
-    ASSERT_TRUE(cache);
+    const auto& caches = selector.mutableGetRankedRefreshRatesCache();
+    ASSERT_EQ(1u, caches.size());
+
+    const auto& cache = caches.front();
+    EXPECT_EQ(cache.layers, layers);
+    EXPECT_EQ(cache.signals, globalSignals);
+    EXPECT_EQ(cache.pacesetterFps, pacesetterFps);
+    EXPECT_EQ(cache.result, result);
+}
 
-    EXPECT_EQ(cache->layers, layers);
-    EXPECT_EQ(cache->signals, globalSignals);
-    EXPECT_EQ(cache->pacesetterFps, pacesetterFps);
-    EXPECT_EQ(cache->result, result);
+TEST_P(RefreshRateSelectorTest, getBestFrameRateMode_CachesAlternatingSignals) {
+    auto selector = createSelector(kModes_30_60_72_90_120, kModeId60);
+
+    std::vector<LayerRequirement> layers = {{.weight = 1.f}};
+    layers[0].vote = LayerVoteType::Heuristic;
+    layers[0].desiredRefreshRate = 30_Hz;
+
+    const RefreshRateSelector::GlobalSignals touch{.touch = true};
+    const auto touchResult = selector.getRankedFrameRates(layers, touch);
+    const auto idleResult = selector.getRankedFrameRates(layers, {});
+    EXPECT_EQ(2u, selector.mutableGetRankedRefreshRatesCache().size());
+
+    // Both invocations are served from the cache, most recent first.
+    EXPECT_EQ(touchResult, selector.getRankedFrameRates(layers, touch));
+    EXPECT_EQ(idleResult, selector.getRankedFrameRates(layers, {}));
+    EXPECT_EQ(2u, selector.mutableGetRankedRefreshRatesCache().size());
+    EXPECT_EQ(RefreshRateSelector::GlobalSignals{},
+              selector.mutableGetRankedRefreshRatesCache().front().signals);
+
+    // A policy change invalidates every cached invocation.
+    EXPECT_EQ(SetPolicyResult::Changed,
+              selector.setDisplayManagerPolicy({kModeId60, {30_Hz, 90_Hz}}));
+    EXPECT_TRUE(selector.mutableGetRankedRefreshRatesCache().empty());
 }
 
 TEST_P(RefreshRateSelectorTest, getBestFrameRateMode_ExplicitExactTouchBoost) {
@@ -85,6 +85,22 @@ TEST_F(RegionSamplingTest, bimodal_tiebreaker) {
                 testing::FloatEq(0.5f));
 }
 
+TEST_F(RegionSamplingTest, downscales_sample_areas_outwards) {
+    EXPECT_EQ(Rect(0, 0, 25, 8), downscaleSampleArea(whole_area, 4));
+    EXPECT_EQ(Rect(1, 0, 3, 2), downscaleSampleArea(Rect(5, 3, 9, 5), 4));
+    EXPECT_EQ(whole_area, downscaleSampleArea(whole_area, 1));
+}
+
+TEST_F(RegionSamplingTest, downscaled_area_fits_downscaled_buffer) {
+    // The sampling areas are within the sampled bounds, so their downscaled versions are within
+    // the buffer the bounds are rendered to.
+    const Rect bufferBounds = downscaleSampleArea(whole_area, 3);
+    std::fill(buffer.begin(), buffer.end(), kWhite);
+    EXPECT_THAT(sampleArea(buffer.data(), bufferBounds.getWidth(), bufferBounds.getHeight(),
+                           kStride, kOrientation, downscaleSampleArea(Rect(50, 20, 98, 29), 3)),
+                testing::FloatEq(1.0f));
+}
+
 TEST_F(RegionSamplingTest, bounds_checking) {
     std::generate(buffer.begin(), buffer.end(),
                   [n = 0]() mutable { return (n++ > (kStride * kHeight >> 1)) ? kBlack : kWhite; });
@@ -376,6 +376,31 @@ TEST_F(VSyncPredictorTest, willBeAccurateUsingPriorResultsForRate) {
     EXPECT_THAT(model.intercept, Eq(0));
 }
 
+TEST_F(VSyncPredictorTest, usesPriorResultsForRateBeforeRegressionModelIsBuilt) {
+    auto const idealPeriod = 100000;
+    auto const learnedPeriod = 101000;
+    auto const slowPeriod = 400000;
+    auto const simulatedVsyncs =
+            generateVsyncTimestamps(kMinimumSamplesForPrediction, learnedPeriod, 0);
+
+    tracker.setDisplayModePtr(displayMode(idealPeriod));
+    for (auto const& timestamp : simulatedVsyncs) {
+        tracker.addVsyncTimestamp(timestamp);
+    }
+    EXPECT_THAT(tracker.getVSyncPredictionModel().slope, Eq(learnedPeriod));
+
+    tracker.setDisplayModePtr(displayMode(slowPeriod));
+    tracker.setDisplayModePtr(displayMode(idealPeriod));
+
+    // predictions use the learned period from the first vsync after switching back
+    nsecs_t const timestamp = simulatedVsyncs.back() + slowPeriod;
+    tracker.addVsyncTimestamp(timestamp);
+    EXPECT_TRUE(tracker.needsMoreSamples());
+    EXPECT_THAT(tracker.getVSyncPredictionModel().slope, Eq(learnedPeriod));
+    EXPECT_THAT(tracker.nextAnticipatedVSyncTimeFrom(timestamp + 1000),
+                Eq(timestamp + learnedPeriod));
+}
+
 TEST_F(VSyncPredictorTest, idealModelPredictionsBeforeRegressionModelIsBuilt) {
     auto const simulatedVsyncs =
             generateVsyncTimestamps(kMinimumSamplesForPrediction + 1, mPeriod, 0);
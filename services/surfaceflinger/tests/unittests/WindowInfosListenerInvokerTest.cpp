@@ -1,4 +1,5 @@
 #include <android/gui/BnWindowInfosListener.h>
+#include <android/gui/BnWindowInfosReportedListener.h>
 #include <gtest/gtest.h>
 #include <gui/SurfaceComposerClient.h>
 #include <gui/WindowInfosUpdate.h>
@@ -214,6 +215,96 @@ TEST_F(WindowInfosListenerInvokerTest, skipsDelayedMessage) {
     EXPECT_EQ(lastUpdateId, 3);
 }
 
+class ReportedListener : public gui::BnWindowInfosReportedListener {
+public:
+    ReportedListener(std::function<void()> callback) : mCallback(std::move(callback)) {}
+
+    binder::Status onWindowInfosReported() override {
+        mCallback();
+        return binder::Status::ok();
+    }
+
+private:
+    std::function<void()> mCallback;
+};
+
+// Test that WindowInfosListenerInvoker#windowInfosChanged keeps sending updates to a listener
+// which acks them, while another listener hasn't acked its first message.
+TEST_F(WindowInfosListenerInvokerTest, slowListenerDoesNotDelayOtherListeners) {
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    int64_t slowLastUpdateId = -1;
+    int64_t fastLastUpdateId = -1;
+
+    // Simulate a slow ack by not calling IWindowInfosPublisher.ackWindowInfosReceived
+    gui::WindowInfosListenerInfo slowListenerInfo;
+    mInvoker->addWindowInfosListener(sp<Listener>::make([&](const gui::WindowInfosUpdate& update) {
+                                         std::scoped_lock lock{mutex};
+                                         slowLastUpdateId = update.vsyncId;
+                                         cv.notify_one();
+                                     }),
+                                     &slowListenerInfo);
+
+    gui::WindowInfosListenerInfo fastListenerInfo;
+    mInvoker->addWindowInfosListener(sp<Listener>::make([&](const gui::WindowInfosUpdate& update) {
+                                         std::scoped_lock lock{mutex};
+                                         fastLastUpdateId = update.vsyncId;
+                                         cv.notify_one();
+                                         fastListenerInfo.windowInfosPublisher
+                                                 ->ackWindowInfosReceived(update.vsyncId,
+                                                                          fastListenerInfo
+                                                                                  .listenerId);
+                                     }),
+                                     &fastListenerInfo);
+
+    bool reported = false;
+    WindowInfosReportedListenerSet reportedListeners{sp<ReportedListener>::make([&]() {
+        std::scoped_lock lock{mutex};
+        reported = true;
+        cv.notify_one();
+    })};
+
+    BackgroundExecutor::getInstance().sendCallbacks(
+            {[&]() { mInvoker->windowInfosChanged({{}, {}, /* vsyncId= */ 1, 0}, {}, false); }});
+    {
+        std::unique_lock lock{mutex};
+        cv.wait(lock, [&]() { return slowLastUpdateId == 1 && fastLastUpdateId == 1; });
+    }
+
+    BackgroundExecutor::getInstance().sendCallbacks({[&]() {
+        mInvoker->windowInfosChanged({{}, {}, /* vsyncId= */ 2, 0}, std::move(reportedListeners),
+                                     false);
+    }});
+    BackgroundExecutor::getInstance().sendCallbacks(
+            {[&]() { mInvoker->windowInfosChanged({{}, {}, /* vsyncId= */ 3, 0}, {}, false); }});
+    {
+        std::unique_lock lock{mutex};
+        cv.wait(lock, [&]() { return fastLastUpdateId == 3; });
+    }
+    BackgroundExecutor::getInstance().flushQueue();
+    {
+        std::scoped_lock lock{mutex};
+        EXPECT_EQ(slowLastUpdateId, 1);
+        // The slow listener hasn't seen the update the reported listener came with yet.
+        EXPECT_FALSE(reported);
+    }
+
+    // Ack the first message. The slow listener skips straight to the third update.
+    slowListenerInfo.windowInfosPublisher->ackWindowInfosReceived(1, slowListenerInfo.listenerId);
+    {
+        std::unique_lock lock{mutex};
+        cv.wait(lock, [&]() { return slowLastUpdateId == 3; });
+    }
+
+    slowListenerInfo.windowInfosPublisher->ackWindowInfosReceived(3, slowListenerInfo.listenerId);
+    {
+        std::unique_lock lock{mutex};
+        cv.wait(lock, [&]() { return reported; });
+    }
+    EXPECT_TRUE(reported);
+}
+
 // Test that WindowInfosListenerInvoker#windowInfosChanged immediately calls listener after a call
 // where no listeners were configured.
 TEST_F(WindowInfosListenerInvokerTest, noListeners) {
@@ -283,4 +374,94 @@ TEST_F(WindowInfosListenerInvokerTest, removeListenerAcks) {
     EXPECT_EQ(callCount, 2);
 }
 
+static gui::WindowInfo makeWindowInfo(int32_t id, std::string name) {
+    gui::WindowInfo windowInfo;
+    windowInfo.id = id;
+    windowInfo.name = std::move(name);
+    return windowInfo;
+}
+
+// Test that WindowInfosListenerInvoker#windowInfosChanged only sends the windows which changed
+// since the previous update, after the first one.
+TEST_F(WindowInfosListenerInvokerTest, sendsIncrementalUpdates) {
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    std::vector<gui::WindowInfosUpdate> updates;
+
+    // Simulate a slow ack by not calling IWindowInfosPublisher.ackWindowInfosReceived
+    gui::WindowInfosListenerInfo listenerInfo;
+    mInvoker->addWindowInfosListener(sp<Listener>::make([&](const gui::WindowInfosUpdate& update) {
+                                         std::scoped_lock lock{mutex};
+                                         updates.push_back(update);
+                                         cv.notify_one();
+                                     }),
+                                     &listenerInfo);
+
+    BackgroundExecutor::getInstance().sendCallbacks({[&]() {
+        mInvoker->windowInfosChanged({{makeWindowInfo(1, "a"), makeWindowInfo(2, "b"),
+                                       makeWindowInfo(3, "c")},
+                                      {},
+                                      /* vsyncId= */ 0,
+                                      0},
+                                     {}, false);
+        mInvoker->windowInfosChanged({{makeWindowInfo(1, "a"), makeWindowInfo(2, "b2")},
+                                      {},
+                                      /* vsyncId= */ 1,
+                                      0},
+                                     {}, true);
+    }});
+
+    {
+        std::unique_lock lock{mutex};
+        cv.wait(lock, [&]() { return updates.size() == 2; });
+    }
+    EXPECT_FALSE(updates[0].isIncremental);
+    EXPECT_EQ(updates[0].windowInfos.size(), 3u);
+    EXPECT_EQ(updates[0].windowIds, (std::vector<int32_t>{1, 2, 3}));
+
+    EXPECT_TRUE(updates[1].isIncremental);
+    EXPECT_EQ(updates[1].windowIds, (std::vector<int32_t>{1, 2}));
+    EXPECT_EQ(updates[1].changedWindows, (std::vector<bool>{false, true}));
+    ASSERT_EQ(updates[1].windowInfos.size(), 1u);
+    EXPECT_EQ(updates[1].windowInfos[0].name, "b2");
+}
+
+// Test that WindowInfosListenerInvoker#requestFullWindowInfos sends the last update again, in
+// full.
+TEST_F(WindowInfosListenerInvokerTest, resendsFullUpdateOnRequest) {
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    std::vector<gui::WindowInfosUpdate> updates;
+
+    gui::WindowInfosListenerInfo listenerInfo;
+    mInvoker->addWindowInfosListener(sp<Listener>::make([&](const gui::WindowInfosUpdate& update) {
+                                         std::scoped_lock lock{mutex};
+                                         updates.push_back(update);
+                                         cv.notify_one();
+                                         listenerInfo.windowInfosPublisher
+                                                 ->ackWindowInfosReceived(update.vsyncId,
+                                                                          listenerInfo.listenerId);
+                                     }),
+                                     &listenerInfo);
+
+    BackgroundExecutor::getInstance().sendCallbacks({[&]() {
+        mInvoker->windowInfosChanged({{makeWindowInfo(1, "a"), makeWindowInfo(2, "b")},
+                                      {},
+                                      /* vsyncId= */ 0,
+                                      0},
+                                     {}, false);
+    }});
+    listenerInfo.windowInfosPublisher->requestFullWindowInfos(listenerInfo.listenerId);
+
+    {
+        std::unique_lock lock{mutex};
+        cv.wait(lock, [&]() { return updates.size() == 2; });
+    }
+    EXPECT_FALSE(updates[1].isIncremental);
+    EXPECT_EQ(updates[1].vsyncId, 0);
+    EXPECT_EQ(updates[1].windowInfos.size(), 2u);
+}
+
 } // namespace android
@@ -46,6 +46,11 @@ public:
     MOCK_METHOD(void, requestNextVsync, (const sp<android::EventThreadConnection>&), (override));
     MOCK_METHOD(VsyncEventData, getLatestVsyncEventData,
                 (const sp<android::EventThreadConnection>&, nsecs_t), (const, override));
+    MOCK_METHOD(base::unique_fd, getVsyncTimelinePage, (const sp<android::EventThreadConnection>&),
+                (override));
+    MOCK_METHOD(status_t, subscribeToVsyncBroadcast,
+                (const sp<android::EventThreadConnection>&, gui::VsyncBroadcastSubscription*),
+                (override));
     MOCK_METHOD(void, requestLatestConfig, (const sp<android::EventThreadConnection>&));
     MOCK_METHOD(void, pauseVsyncCallback, (bool));
     MOCK_METHOD(void, onNewVsyncSchedule, (std::shared_ptr<scheduler::VsyncSchedule>), (override));
@@ -30,7 +30,8 @@ bool DelayedCallback::isExpired() const {
 }
 
 std::chrono::milliseconds DelayedCallback::getWaitForExpirationDuration() const {
-    std::chrono::milliseconds delta = std::chrono::duration_cast<std::chrono::milliseconds>(
+    // Round up, otherwise the scheduler would spin without waiting for the last millisecond.
+    std::chrono::milliseconds delta = std::chrono::ceil<std::chrono::milliseconds>(
             mExpiration - std::chrono::steady_clock::now());
     // Return zero if this is already expired.
     return delta > delta.zero() ? delta : delta.zero();
@@ -41,11 +42,14 @@ void DelayedCallback::run() const {
 }
 
 bool DelayedCallback::operator<(const DelayedCallback& other) const {
+    if (mExpiration == other.mExpiration) {
+        return mSequence < other.mSequence;
+    }
     return mExpiration < other.mExpiration;
 }
 
 bool DelayedCallback::operator>(const DelayedCallback& other) const {
-    return mExpiration > other.mExpiration;
+    return other < *this;
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -67,7 +71,7 @@ void CallbackScheduler::schedule(std::function<void()> callback, std::chrono::mi
         if (mCallbackThread == nullptr) {
             mCallbackThread = std::make_unique<std::thread>(&CallbackScheduler::loop, this);
         }
-        mQueue.emplace(DelayedCallback(callback, delay));
+        mQueue.emplace(std::move(callback), delay, mNextSequence++);
     }
     mCondition.notify_all();
 }
@@ -80,7 +84,8 @@ void CallbackScheduler::loop() {
             break;
         }
         while (!mQueue.empty() && mQueue.top().isExpired()) {
-            DelayedCallback callback = mQueue.top();
+            // The callback is moved out right before it's popped, so the queue order is kept.
+            DelayedCallback callback = std::move(const_cast<DelayedCallback&>(mQueue.top()));
             mQueue.pop();
             lock.unlock();
             callback.run();
@@ -143,6 +143,30 @@ HalResult<Capabilities> HalWrapper::getCapabilities() {
 
 HalResult<std::vector<milliseconds>> HalWrapper::getPrimitiveDurations() {
     std::lock_guard<std::mutex> lock(mInfoMutex);
+    return loadPrimitiveDurationsLocked();
+}
+
+milliseconds HalWrapper::getCompositionDuration(const std::vector<CompositeEffect>& primitives) {
+    std::lock_guard<std::mutex> lock(mInfoMutex);
+    // Read the cached durations in place, instead of copying them for every composition.
+    const auto& durationsResult = loadPrimitiveDurationsLocked();
+    const std::vector<milliseconds> noDurations;
+    const auto& durations = durationsResult.isOk() ? durationsResult.value() : noDurations;
+    milliseconds duration(0);
+    for (const auto& effect : primitives) {
+        auto primitiveIdx = static_cast<size_t>(effect.primitive);
+        if (primitiveIdx < durations.size()) {
+            duration += durations[primitiveIdx];
+        } else {
+            // Make sure the returned duration is positive to indicate successful vibration.
+            duration += milliseconds(1);
+        }
+        duration += milliseconds(effect.delayMs);
+    }
+    return duration;
+}
+
+const HalResult<std::vector<milliseconds>>& HalWrapper::loadPrimitiveDurationsLocked() {
     if (mInfoCache.mSupportedPrimitives.isFailed()) {
         mInfoCache.mSupportedPrimitives = getSupportedPrimitivesInternal();
         if (mInfoCache.mSupportedPrimitives.isUnsupported()) {
@@ -326,19 +350,7 @@ HalResult<milliseconds> AidlHalWrapper::performComposedEffect(
     // This method should always support callbacks, so no need to double check.
     auto cb = ndk::SharedRefBase::make<HalCallbackWrapper>(completionCallback);
 
-    auto durations = getPrimitiveDurations().valueOr({});
-    milliseconds duration(0);
-    for (const auto& effect : primitives) {
-        auto primitiveIdx = static_cast<size_t>(effect.primitive);
-        if (primitiveIdx < durations.size()) {
-            duration += durations[primitiveIdx];
-        } else {
-            // Make sure the returned duration is positive to indicate successful vibration.
-            duration += milliseconds(1);
-        }
-        duration += milliseconds(effect.delayMs);
-    }
-
+    milliseconds duration = getCompositionDuration(primitives);
     return HalResultFactory::fromStatus<milliseconds>(getHal()->compose(primitives, cb), duration);
 }
 
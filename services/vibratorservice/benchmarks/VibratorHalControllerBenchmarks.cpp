@@ -19,6 +19,7 @@
 #include <android/binder_process.h>
 #include <benchmark/benchmark.h>
 #include <vibratorservice/VibratorHalController.h>
+#include <algorithm>
 #include <future>
 
 using ::aidl::android::hardware::vibrator::CompositeEffect;
@@ -32,6 +33,7 @@ using ::benchmark::State;
 using ::benchmark::internal::Benchmark;
 
 using std::chrono::milliseconds;
+using std::chrono::steady_clock;
 
 using namespace android;
 using namespace std::chrono_literals;
@@ -111,6 +113,35 @@ private:
     int32_t mCurrentId;
 };
 
+// Records the latency of each HAL call in a benchmark, and reports its distribution as counters,
+// since vibrations triggered in quick succession are delayed by the slowest calls, not the mean.
+class LatencyRecorder {
+public:
+    void start() { mStart = steady_clock::now(); }
+
+    void stop() { mLatencies.push_back(steady_clock::now() - mStart); }
+
+    void report(State& state) {
+        if (mLatencies.empty()) {
+            return;
+        }
+        std::sort(mLatencies.begin(), mLatencies.end());
+        state.counters["p50_us"] = percentileMicros(50);
+        state.counters["p90_us"] = percentileMicros(90);
+        state.counters["p99_us"] = percentileMicros(99);
+        state.counters["max_us"] = percentileMicros(100);
+    }
+
+private:
+    steady_clock::time_point mStart;
+    std::vector<steady_clock::duration> mLatencies;
+
+    double percentileMicros(size_t percentile) const {
+        size_t index = std::min(mLatencies.size() - 1, mLatencies.size() * percentile / 100);
+        return std::chrono::duration<double, std::micro>(mLatencies[index]).count();
+    }
+};
+
 class VibratorBench : public Fixture {
 public:
     void SetUp(State& /*state*/) override {
@@ -235,6 +266,7 @@ BENCHMARK_WRAPPER(VibratorBench, tryReconnect, {
 
 BENCHMARK_WRAPPER(SlowVibratorBench, on, {
     auto duration = MAX_ON_DURATION_MS;
+    LatencyRecorder latency;
 
     for (auto _ : state) {
         // Setup
@@ -244,9 +276,11 @@ BENCHMARK_WRAPPER(SlowVibratorBench, on, {
         state.ResumeTiming();
 
         // Test
+        latency.start();
         if (shouldSkipWithError<void>(onFn, "on", state)) {
             return;
         }
+        latency.stop();
 
         // Cleanup
         state.PauseTiming();
@@ -256,6 +290,7 @@ BENCHMARK_WRAPPER(SlowVibratorBench, on, {
         cb.waitForComplete();
         state.ResumeTiming();
     }
+    latency.report(state);
 });
 
 BENCHMARK_WRAPPER(SlowVibratorBench, off, {
@@ -566,6 +601,7 @@ BENCHMARK_WRAPPER(SlowVibratorPrimitivesBench, performComposedEffect, {
     effect.delayMs = static_cast<int32_t>(0);
 
     std::vector<CompositeEffect> effects = {effect};
+    LatencyRecorder latency;
 
     for (auto _ : state) {
         // Setup
@@ -577,18 +613,72 @@ BENCHMARK_WRAPPER(SlowVibratorPrimitivesBench, performComposedEffect, {
         state.ResumeTiming();
 
         // Test
+        latency.start();
         if (shouldSkipWithError<milliseconds>(performFn, "performComposedEffect", state)) {
             return;
         }
+        latency.stop();
+
+        // Cleanup
+        state.PauseTiming();
+        if (shouldSkipWithError(turnVibratorOff(), state)) {
+            return;
+        }
+        cb.waitForComplete();
+        state.ResumeTiming();
+    }
+    latency.report(state);
+});
+
+BENCHMARK_WRAPPER(SlowVibratorPrimitivesBench, performComposedEffectAsync, {
+    if (shouldSkipWithMissingCapabilityMessage(vibrator::Capabilities::COMPOSE_EFFECTS, state)) {
+        return;
+    }
+    if (!hasArgs(state)) {
+        state.SkipWithMessage("missing args");
+        return;
+    }
+
+    CompositeEffect effect;
+    effect.primitive = getPrimitive(state);
+    effect.scale = 1.0f;
+    effect.delayMs = static_cast<int32_t>(0);
+
+    std::vector<CompositeEffect> effects = {effect};
+    // Measures the time the caller waits to submit the call, not the HAL call itself.
+    LatencyRecorder latency;
+
+    for (auto _ : state) {
+        // Setup
+        state.PauseTiming();
+        auto cb = mCallbacks.next();
+        auto performFn = [&](auto hal) {
+            return hal->performComposedEffect(effects, cb.completeFn());
+        };
+        std::promise<vibrator::HalResult<milliseconds>> resultPromise;
+        auto resultFuture = resultPromise.get_future();
+        state.ResumeTiming();
+
+        // Test
+        latency.start();
+        mController.doWithRetryAsync<milliseconds>(performFn, "performComposedEffect",
+                                                   [&](auto result) {
+                                                       resultPromise.set_value(result);
+                                                   });
+        latency.stop();
 
         // Cleanup
         state.PauseTiming();
+        if (shouldSkipWithError(resultFuture.get(), state)) {
+            return;
+        }
         if (shouldSkipWithError(turnVibratorOff(), state)) {
             return;
         }
         cb.waitForComplete();
         state.ResumeTiming();
     }
+    latency.report(state);
 });
 
 BENCHMARK_MAIN();
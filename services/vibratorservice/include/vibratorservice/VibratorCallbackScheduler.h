@@ -30,15 +30,19 @@ namespace vibrator {
 // Wrapper for a callback to be executed after a delay.
 class DelayedCallback {
 public:
-    DelayedCallback(std::function<void()> callback, std::chrono::milliseconds delay)
-          : mCallback(callback), mExpiration(std::chrono::steady_clock::now() + delay) {}
+    DelayedCallback(std::function<void()> callback, std::chrono::milliseconds delay,
+                    uint64_t sequence = 0)
+          : mCallback(std::move(callback)),
+            mExpiration(std::chrono::steady_clock::now() + delay),
+            mSequence(sequence) {}
     ~DelayedCallback() = default;
 
     void run() const;
     bool isExpired() const;
     std::chrono::milliseconds getWaitForExpirationDuration() const;
 
-    // Compare by expiration time, where A < B when A expires first.
+    // Compare by expiration time, where A < B when A expires first, and then by sequence, so
+    // callbacks that expire together run in the order they were scheduled.
     bool operator<(const DelayedCallback& other) const;
     bool operator>(const DelayedCallback& other) const;
 
@@ -47,12 +51,13 @@ private:
     // Use a steady monotonic clock to calculate the duration until expiration.
     // This clock is not related to wall clock time and is most suitable for measuring intervals.
     std::chrono::time_point<std::chrono::steady_clock> mExpiration;
+    uint64_t mSequence;
 };
 
 // Schedules callbacks to be executed after a delay.
 class CallbackScheduler {
 public:
-    CallbackScheduler() : mCallbackThread(nullptr), mFinished(false) {}
+    CallbackScheduler() : mCallbackThread(nullptr), mFinished(false), mNextSequence(0) {}
     virtual ~CallbackScheduler();
 
     virtual void schedule(std::function<void()> callback, std::chrono::milliseconds delay);
@@ -67,6 +72,9 @@ private:
     // Used to quit the callback thread when this instance is being destroyed.
     bool mFinished GUARDED_BY(mMutex);
 
+    // Sequence of the next scheduled callback.
+    uint64_t mNextSequence GUARDED_BY(mMutex);
+
     // Priority queue with reverse comparator, so tasks that expire first will be on top.
     std::priority_queue<DelayedCallback, std::vector<DelayedCallback>,
                         std::greater<DelayedCallback>>
@@ -97,6 +97,21 @@ public:
         return doWithRetry<T>(halFn, HalResult<T>::unsupported(), functionName);
     }
 
+    /* Calls given HAL function like doWithRetry, but on a worker thread, and passes the result to
+     * the given callback on that thread. Calls run in the order they are submitted, so callers can
+     * queue consecutive commands without waiting for each HAL call to return.
+     */
+    template <typename T>
+    void doWithRetryAsync(HalFunction<HalResult<T>> halFn, const char* functionName,
+                          std::function<void(HalResult<T>)> resultCallback) {
+        mCommandScheduler.schedule(
+                [this, halFn = std::move(halFn), functionName,
+                 resultCallback = std::move(resultCallback)]() {
+                    resultCallback(doWithRetry<T>(halFn, functionName));
+                },
+                std::chrono::milliseconds(0));
+    }
+
 private:
     static constexpr int MAX_RETRIES = 1;
 
@@ -106,6 +121,9 @@ private:
     std::shared_ptr<HalWrapper> mConnectedHal GUARDED_BY(mConnectedHalMutex);
     // Shared pointer to allow copies to be passed to possible recreated mConnectedHal instances.
     std::shared_ptr<CallbackScheduler> mCallbackScheduler;
+    // Runs the calls from doWithRetryAsync. Declared last, so that its thread is stopped before
+    // the rest of this controller is destroyed.
+    CallbackScheduler mCommandScheduler;
 
     /* Calls given HAL function, applying automatic retries to reconnect with the HAL when the
      * result has failed. Given default value is returned when no HAL is available, and given
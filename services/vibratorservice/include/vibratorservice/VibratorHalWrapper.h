@@ -422,6 +422,9 @@ protected:
     // Load and cache vibrator info, returning cached result is present.
     HalResult<Capabilities> getCapabilities();
     HalResult<std::vector<std::chrono::milliseconds>> getPrimitiveDurations();
+    // Returns the expected duration of a composition, from the cached primitive durations.
+    std::chrono::milliseconds getCompositionDuration(
+            const std::vector<aidl::android::hardware::vibrator::CompositeEffect>& primitives);
 
     // Request vibrator info to HAL skipping cache.
     virtual HalResult<Capabilities> getCapabilitiesInternal() = 0;
@@ -446,6 +449,9 @@ protected:
 private:
     std::mutex mInfoMutex;
     InfoCache mInfoCache GUARDED_BY(mInfoMutex);
+
+    const HalResult<std::vector<std::chrono::milliseconds>>& loadPrimitiveDurationsLocked()
+            REQUIRES(mInfoMutex);
 };
 
 // Wrapper for the AIDL Vibrator HAL.
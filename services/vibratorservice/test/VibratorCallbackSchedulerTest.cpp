@@ -90,6 +90,15 @@ TEST_F(VibratorCallbackSchedulerTest, TestScheduleMultipleCallbacksRunsInDelayOr
     ASSERT_THAT(getExpiredCallbacks(), ElementsAre(3, 2, 1));
 }
 
+TEST_F(VibratorCallbackSchedulerTest, TestScheduleCallbacksWithSameDelayRunInScheduleOrder) {
+    for (int32_t i = 0; i < 10; i++) {
+        mScheduler->schedule(createCallback(i), 0ms);
+    }
+
+    ASSERT_THAT(waitForCallbacks(10, TEST_TIMEOUT), Eq(10));
+    ASSERT_THAT(getExpiredCallbacks(), ElementsAre(0, 1, 2, 3, 4, 5, 6, 7, 8, 9));
+}
+
 TEST_F(VibratorCallbackSchedulerTest, TestDestructorDropsPendingCallbacksAndKillsThread) {
     // Schedule callback long enough that scheduler will be destroyed while it's still scheduled.
     mScheduler->schedule(createCallback(1), 100ms);
@@ -124,6 +124,36 @@ TEST_F(VibratorHalControllerTest, TestApiCallsAreForwardedToHal) {
     ASSERT_EQ(1, mConnectCounter);
 }
 
+TEST_F(VibratorHalControllerTest, TestAsyncApiCallsAreForwardedToHalInOrder) {
+    {
+        InSequence seq;
+        EXPECT_CALL(*mMockHal.get(), on(_, _))
+                .Times(Exactly(1))
+                .WillRepeatedly(Return(vibrator::HalResult<void>::ok()));
+        EXPECT_CALL(*mMockHal.get(), off())
+                .Times(Exactly(1))
+                .WillRepeatedly(Return(vibrator::HalResult<void>::failed("message")));
+    }
+
+    std::mutex mutex;
+    std::vector<bool> results;
+    vibrator::TestCounter counter;
+    auto resultCallback = [&](vibrator::HalResult<void> result) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            results.push_back(result.isOk());
+        }
+        counter.increment();
+    };
+    mController->doWithRetryAsync<void>(ON_FN, "on", resultCallback);
+    mController->doWithRetryAsync<void>(OFF_FN, "off", resultCallback);
+
+    counter.tryWaitUntilCountIsAtLeast(2, 100ms);
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_THAT(results, ElementsAre(true, false));
+    ASSERT_EQ(1, mConnectCounter);
+}
+
 TEST_F(VibratorHalControllerTest, TestUnsupportedApiResultDoesNotResetHalConnection) {
     EXPECT_CALL(*mMockHal.get(), tryReconnect()).Times(Exactly(0));
     EXPECT_CALL(*mMockHal.get(), off())
@@ -1579,6 +1579,7 @@ VkResult CreateDevice(VkPhysicalDevice physicalDevice,
 
 void DestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator) {
     DeviceData& data = GetData(device);
+    SavePlatformPipelineCaches(device);
     data.driver.DestroyDevice(device, pAllocator);
 
     VkAllocationCallbacks local_allocator;
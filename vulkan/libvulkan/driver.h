@@ -20,7 +20,9 @@
 #include <inttypes.h>
 
 #include <bitset>
+#include <mutex>
 #include <type_traits>
+#include <unordered_set>
 
 #include <log/log.h>
 
@@ -30,6 +32,7 @@
 #include "api_gen.h"
 #include "driver_gen.h"
 #include "debug_report.h"
+#include "pipeline_cache.h"
 #include "swapchain.h"
 
 namespace vulkan {
@@ -99,6 +102,11 @@ struct DeviceData {
     VkDevice driver_device;
     DeviceDriverTable driver;
     VkPhysicalDevice driver_physical_device;
+
+    // Pipeline caches that are saved to the platform pipeline cache when
+    // they are destroyed.
+    std::mutex pipeline_cache_mutex;
+    std::unordered_set<VkPipelineCache> platform_pipeline_caches;
 };
 
 bool OpenHAL();
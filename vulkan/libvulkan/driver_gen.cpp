@@ -248,6 +248,13 @@ const ProcHook g_proc_hooks[] = {
         reinterpret_cast<PFN_vkVoidFunction>(CreateInstance),
         nullptr,
     },
+    {
+        "vkCreatePipelineCache",
+        ProcHook::DEVICE,
+        ProcHook::EXTENSION_CORE_1_0,
+        reinterpret_cast<PFN_vkVoidFunction>(CreatePipelineCache),
+        nullptr,
+    },
     {
         "vkCreateSwapchainKHR",
         ProcHook::DEVICE,
@@ -283,6 +290,13 @@ const ProcHook g_proc_hooks[] = {
         reinterpret_cast<PFN_vkVoidFunction>(DestroyInstance),
         nullptr,
     },
+    {
+        "vkDestroyPipelineCache",
+        ProcHook::DEVICE,
+        ProcHook::EXTENSION_CORE_1_0,
+        reinterpret_cast<PFN_vkVoidFunction>(DestroyPipelineCache),
+        nullptr,
+    },
     {
         "vkDestroySurfaceKHR",
         ProcHook::INSTANCE,
@@ -695,6 +709,9 @@ bool InitDriverTable(VkDevice dev,
     INIT_PROC(true, dev, QueueSubmit);
     INIT_PROC(true, dev, CreateImage);
     INIT_PROC(true, dev, DestroyImage);
+    INIT_PROC(true, dev, CreatePipelineCache);
+    INIT_PROC(true, dev, DestroyPipelineCache);
+    INIT_PROC(true, dev, GetPipelineCacheData);
     INIT_PROC(true, dev, AllocateCommandBuffers);
     INIT_PROC_EXT(KHR_external_fence_fd, true, dev, ImportFenceFdKHR);
     INIT_PROC(false, dev, BindImageMemory2);
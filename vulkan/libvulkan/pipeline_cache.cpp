@@ -0,0 +1,282 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define ATRACE_TAG ATRACE_TAG_GRAPHICS
+
+#include "pipeline_cache.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <android-base/properties.h>
+#include <android-base/stringprintf.h>
+#include <android-base/unique_fd.h>
+#include <graphicsenv/GraphicsEnv.h>
+#include <log/log.h>
+#include <utils/Trace.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "driver.h"
+
+namespace vulkan {
+namespace driver {
+
+namespace {
+
+constexpr char kCacheFilePrefix[] = "vk_pipeline_cache_";
+
+// The total size of the pipeline cache files of an app. The least recently
+// used files are removed once it is exceeded.
+constexpr int64_t kDefaultMaxCacheDirSize = 16 * 1024 * 1024;
+
+int64_t GetMaxCacheDirSize() {
+    return android::base::GetIntProperty<int64_t>(
+        "ro.vulkan.pipeline_cache.max_size", kDefaultMaxCacheDirSize);
+}
+
+// Pipeline cache data is only valid for the physical device and driver build
+// that created it, which its header identifies with these properties.
+std::string GetCacheFilePath(const std::string& dir,
+                             const VkPhysicalDeviceProperties& properties) {
+    std::string path = android::base::StringPrintf(
+        "%s/%s%08x_%08x_%08x_", dir.c_str(), kCacheFilePrefix,
+        properties.vendorID, properties.deviceID, properties.driverVersion);
+    for (uint8_t byte : properties.pipelineCacheUUID) {
+        android::base::StringAppendF(&path, "%02x", byte);
+    }
+    return path;
+}
+
+std::vector<uint8_t> ReadCacheFile(const std::string& path) {
+    android::base::unique_fd fd(open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    if (fd < 0) {
+        return {};
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0 ||
+        st.st_size > GetMaxCacheDirSize()) {
+        return {};
+    }
+    std::vector<uint8_t> data(static_cast<size_t>(st.st_size));
+    if (read(fd, data.data(), data.size()) !=
+        static_cast<ssize_t>(data.size())) {
+        ALOGE("Failed to read pipeline cache %s: %s", path.c_str(),
+              strerror(errno));
+        return {};
+    }
+    // Mark the file as recently used, for TrimCacheDir.
+    futimens(fd, nullptr);
+    return data;
+}
+
+// Removes the least recently used cache files until the directory fits in its
+// budget.
+void TrimCacheDir(const std::string& dir) {
+    DIR* d = opendir(dir.c_str());
+    if (!d) {
+        return;
+    }
+    struct CacheFile {
+        std::string path;
+        off_t size;
+        struct timespec mtime;
+    };
+    std::vector<CacheFile> files;
+    int64_t total_size = 0;
+    while (struct dirent* entry = readdir(d)) {
+        if (strncmp(entry->d_name, kCacheFilePrefix,
+                    strlen(kCacheFilePrefix)) != 0) {
+            continue;
+        }
+        std::string path = dir + "/" + entry->d_name;
+        struct stat st;
+        if (stat(path.c_str(), &st) == 0) {
+            files.push_back({std::move(path), st.st_size, st.st_mtim});
+            total_size += st.st_size;
+        }
+    }
+    closedir(d);
+
+    const int64_t max_size = GetMaxCacheDirSize();
+    if (total_size <= max_size) {
+        return;
+    }
+    std::sort(files.begin(), files.end(),
+              [](const CacheFile& lhs, const CacheFile& rhs) {
+                  return lhs.mtime.tv_sec != rhs.mtime.tv_sec
+                             ? lhs.mtime.tv_sec < rhs.mtime.tv_sec
+                             : lhs.mtime.tv_nsec < rhs.mtime.tv_nsec;
+              });
+    for (const CacheFile& file : files) {
+        if (total_size <= max_size) {
+            break;
+        }
+        ALOGV("Removing pipeline cache %s", file.path.c_str());
+        if (unlink(file.path.c_str()) == 0) {
+            total_size -= file.size;
+        }
+    }
+}
+
+void SaveCacheFile(VkDevice device,
+                   VkPipelineCache pipeline_cache,
+                   const std::string& path) {
+    ATRACE_CALL();
+
+    const auto& data = GetData(device);
+    size_t size = 0;
+    VkResult result = data.driver.GetPipelineCacheData(device, pipeline_cache,
+                                                       &size, nullptr);
+    if (result != VK_SUCCESS || size == 0 ||
+        static_cast<int64_t>(size) > GetMaxCacheDirSize()) {
+        return;
+    }
+    std::vector<uint8_t> cache_data(size);
+    result = data.driver.GetPipelineCacheData(device, pipeline_cache, &size,
+                                              cache_data.data());
+    if (result != VK_SUCCESS) {
+        return;
+    }
+
+    // Write to a temporary file first, so that a reader never sees a partial
+    // cache.
+    const std::string temp_path =
+        android::base::StringPrintf("%s.%d.tmp", path.c_str(), gettid());
+    android::base::unique_fd fd(
+        open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+             S_IRUSR | S_IWUSR));
+    if (fd < 0) {
+        ALOGE("Failed to create pipeline cache %s: %s", temp_path.c_str(),
+              strerror(errno));
+        return;
+    }
+    if (write(fd, cache_data.data(), size) != static_cast<ssize_t>(size) ||
+        rename(temp_path.c_str(), path.c_str()) != 0) {
+        ALOGE("Failed to write pipeline cache %s: %s", path.c_str(),
+              strerror(errno));
+        unlink(temp_path.c_str());
+        return;
+    }
+    fd.reset();
+
+    TrimCacheDir(path.substr(0, path.rfind('/')));
+}
+
+std::string GetCacheFilePathForDevice(VkDevice device) {
+    const std::string& dir =
+        android::GraphicsEnv::getInstance().getVulkanPipelineCacheDir();
+    if (dir.empty()) {
+        return "";
+    }
+    const VkPhysicalDevice physical_device =
+        GetData(device).driver_physical_device;
+    VkPhysicalDeviceProperties properties;
+    GetData(physical_device)
+        .driver.GetPhysicalDeviceProperties(physical_device, &properties);
+    return GetCacheFilePath(dir, properties);
+}
+
+}  // anonymous namespace
+
+VkResult CreatePipelineCache(VkDevice device,
+                             const VkPipelineCacheCreateInfo* pCreateInfo,
+                             const VkAllocationCallbacks* pAllocator,
+                             VkPipelineCache* pPipelineCache) {
+    ATRACE_CALL();
+
+    auto& data = GetData(device);
+
+    // Leave the caches the app seeds itself alone.
+    if (pCreateInfo->initialDataSize != 0) {
+        return data.driver.CreatePipelineCache(device, pCreateInfo, pAllocator,
+                                               pPipelineCache);
+    }
+    const std::string path = GetCacheFilePathForDevice(device);
+    if (path.empty()) {
+        return data.driver.CreatePipelineCache(device, pCreateInfo, pAllocator,
+                                               pPipelineCache);
+    }
+
+    const std::vector<uint8_t> initial_data = ReadCacheFile(path);
+    VkPipelineCacheCreateInfo create_info = *pCreateInfo;
+    create_info.initialDataSize = initial_data.size();
+    create_info.pInitialData = initial_data.data();
+    VkResult result = data.driver.CreatePipelineCache(device, &create_info,
+                                                      pAllocator, pPipelineCache);
+    if (result != VK_SUCCESS && !initial_data.empty()) {
+        // Drivers are required to ignore incompatible data, but don't let a
+        // bad file break the app if one doesn't.
+        ALOGW("Failed to create pipeline cache from %s, creating it empty",
+              path.c_str());
+        result = data.driver.CreatePipelineCache(device, pCreateInfo,
+                                                 pAllocator, pPipelineCache);
+    }
+    if (result == VK_SUCCESS) {
+        std::lock_guard<std::mutex> lock(data.pipeline_cache_mutex);
+        data.platform_pipeline_caches.insert(*pPipelineCache);
+    }
+    return result;
+}
+
+void DestroyPipelineCache(VkDevice device,
+                          VkPipelineCache pipelineCache,
+                          const VkAllocationCallbacks* pAllocator) {
+    ATRACE_CALL();
+
+    auto& data = GetData(device);
+    bool is_platform_cache = false;
+    if (pipelineCache != VK_NULL_HANDLE) {
+        std::lock_guard<std::mutex> lock(data.pipeline_cache_mutex);
+        is_platform_cache =
+            data.platform_pipeline_caches.erase(pipelineCache) > 0;
+    }
+    if (is_platform_cache) {
+        const std::string path = GetCacheFilePathForDevice(device);
+        if (!path.empty()) {
+            SaveCacheFile(device, pipelineCache, path);
+        }
+    }
+    data.driver.DestroyPipelineCache(device, pipelineCache, pAllocator);
+}
+
+void SavePlatformPipelineCaches(VkDevice device) {
+    auto& data = GetData(device);
+    std::unordered_set<VkPipelineCache> pipeline_caches;
+    {
+        std::lock_guard<std::mutex> lock(data.pipeline_cache_mutex);
+        pipeline_caches.swap(data.platform_pipeline_caches);
+    }
+    if (pipeline_caches.empty()) {
+        return;
+    }
+    const std::string path = GetCacheFilePathForDevice(device);
+    if (path.empty()) {
+        return;
+    }
+    for (VkPipelineCache pipeline_cache : pipeline_caches) {
+        SaveCacheFile(device, pipeline_cache, path);
+    }
+}
+
+}  // namespace driver
+}  // namespace vulkan
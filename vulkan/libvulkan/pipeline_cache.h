@@ -0,0 +1,41 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LIBVULKAN_PIPELINE_CACHE_H
+#define LIBVULKAN_PIPELINE_CACHE_H 1
+
+#include <vulkan/vulkan.h>
+
+namespace vulkan {
+namespace driver {
+
+// When GraphicsEnv has a pipeline cache directory, pipeline caches that the
+// app creates without initial data are seeded from, and saved back to, a file
+// in that directory for the physical device.
+
+// clang-format off
+VKAPI_ATTR VkResult CreatePipelineCache(VkDevice device, const VkPipelineCacheCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkPipelineCache* pPipelineCache);
+VKAPI_ATTR void DestroyPipelineCache(VkDevice device, VkPipelineCache pipelineCache, const VkAllocationCallbacks* pAllocator);
+// clang-format on
+
+// Saves the platform pipeline caches that the app didn't destroy before
+// destroying the device.
+void SavePlatformPipelineCaches(VkDevice device);
+
+}  // namespace driver
+}  // namespace vulkan
+
+#endif  // LIBVULKAN_PIPELINE_CACHE_H
@@ -34,6 +34,7 @@
 #include <utils/Trace.h>
 
 #include <algorithm>
+#include <array>
 #include <unordered_set>
 #include <vector>
 
@@ -180,6 +181,7 @@ const static VkColorSpaceKHR
 
 class TimingInfo {
    public:
+    TimingInfo() = default;
     TimingInfo(const VkPresentTimeGOOGLE* qp, uint64_t nativeFrameId)
         : vals_{qp->presentID, qp->desiredPresentTime, 0, 0, 0},
           native_frame_id_(nativeFrameId) {}
@@ -270,6 +272,43 @@ enum { MAX_TIMING_INFOS = 10 };
 // syncronous requests to Surface Flinger):
 enum { MIN_NUM_FRAMES_AGO = 5 };
 
+// The TimingInfos of a swapchain, oldest first. Presenting a frame with
+// GOOGLE_display_timing adds one, so they're kept in a fixed ring rather than
+// a vector that allocates and shifts on every present.
+class TimingRing {
+   public:
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    void clear() { size_ = 0; }
+
+    TimingInfo& operator[](size_t i) {
+        return infos_[(first_ + i) % MAX_TIMING_INFOS];
+    }
+    const TimingInfo& operator[](size_t i) const {
+        return infos_[(first_ + i) % MAX_TIMING_INFOS];
+    }
+
+    // Adds a TimingInfo, dropping the oldest one if the ring is full.
+    void push_back(const TimingInfo& info) {
+        if (size_ == MAX_TIMING_INFOS) {
+            pop_front(1);
+        }
+        infos_[(first_ + size_) % MAX_TIMING_INFOS] = info;
+        size_++;
+    }
+
+    void pop_front(size_t count) {
+        count = std::min(count, size_);
+        first_ = (first_ + count) % MAX_TIMING_INFOS;
+        size_ -= count;
+    }
+
+   private:
+    std::array<TimingInfo, MAX_TIMING_INFOS> infos_;
+    size_t first_ = 0;
+    size_t size_ = 0;
+};
+
 bool IsSharedPresentMode(VkPresentModeKHR mode) {
     return mode == VK_PRESENT_MODE_SHARED_DEMAND_REFRESH_KHR ||
         mode == VK_PRESENT_MODE_SHARED_CONTINUOUS_REFRESH_KHR;
@@ -338,7 +377,9 @@ struct Swapchain {
         bool dequeued;
     } images[android::BufferQueueDefs::NUM_BUFFER_SLOTS];
 
-    std::vector<TimingInfo> timing;
+    TimingRing timing;
+    // Scratch space for the damage rects of a present.
+    std::vector<android_native_rect_t> damage_rects;
 };
 
 VkSwapchainKHR HandleFromSwapchain(Swapchain* swapchain) {
@@ -508,7 +549,7 @@ void copy_ready_timings(Swapchain& swapchain,
     }
 
     uint32_t num_copied = 0;
-    int32_t num_to_remove = 0;
+    uint32_t num_to_remove = 0;
     for (uint32_t i = 0; i <= last_ready && num_copied < *count; i++) {
         const TimingInfo& ti = swapchain.timing[i];
         if (ti.ready()) {
@@ -520,8 +561,7 @@ void copy_ready_timings(Swapchain& swapchain,
 
     // Discard old frames that aren't ready if newer frames are ready.
     // We don't expect to get the timing info for those old frames.
-    swapchain.timing.erase(swapchain.timing.begin(),
-                           swapchain.timing.begin() + num_to_remove);
+    swapchain.timing.pop_front(num_to_remove);
 
     *count = num_copied;
 }
@@ -2384,8 +2424,11 @@ static VkResult WorstPresentResult(VkResult a, VkResult b) {
 }
 
 // KHR_incremental_present aspect of QueuePresentKHR
-static void SetSwapchainSurfaceDamage(ANativeWindow *window, const VkPresentRegionKHR *pRegion) {
-    std::vector<android_native_rect_t> rects(pRegion->rectangleCount);
+static void SetSwapchainSurfaceDamage(Swapchain &swapchain, const VkPresentRegionKHR *pRegion) {
+    // Reuse the swapchain's rects, so that presenting doesn't allocate once
+    // they've grown to the app's usual number of rects.
+    std::vector<android_native_rect_t>& rects = swapchain.damage_rects;
+    rects.resize(pRegion->rectangleCount);
     for (auto i = 0u; i < pRegion->rectangleCount; i++) {
         auto const& rect = pRegion->pRectangles[i];
         if (rect.layer > 0) {
@@ -2398,7 +2441,8 @@ static void SetSwapchainSurfaceDamage(ANativeWindow *window, const VkPresentRegi
         rects[i].right = rect.offset.x + rect.extent.width;
         rects[i].top = rect.offset.y + rect.extent.height;
     }
-    native_window_set_surface_damage(window, rects.data(), rects.size());
+    native_window_set_surface_damage(swapchain.surface.window.get(), rects.data(),
+                                     rects.size());
 }
 
 // GOOGLE_display_timing aspect of QueuePresentKHR
@@ -2425,12 +2469,7 @@ static void SetSwapchainFrameTimestamp(Swapchain &swapchain, const VkPresentTime
 
     // Add a new timing record with the user's presentID and
     // the nativeFrameId.
-    swapchain.timing.emplace_back(pTime, nativeFrameId);
-    if (swapchain.timing.size() > MAX_TIMING_INFOS) {
-        swapchain.timing.erase(
-            swapchain.timing.begin(),
-            swapchain.timing.begin() + swapchain.timing.size() - MAX_TIMING_INFOS);
-    }
+    swapchain.timing.push_back(TimingInfo(pTime, nativeFrameId));
     if (pTime->desiredPresentTime) {
         ALOGV(
             "Calling native_window_set_buffers_timestamp(%" PRId64 ")",
@@ -2514,7 +2553,7 @@ static VkResult PresentOneSwapchain(
             }
 
             if (pRegion) {
-                SetSwapchainSurfaceDamage(window, pRegion);
+                SetSwapchainSurfaceDamage(swapchain, pRegion);
             }
             if (pTime) {
                 SetSwapchainFrameTimestamp(swapchain, pTime);
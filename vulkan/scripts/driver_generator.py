@@ -80,6 +80,11 @@ _NEEDED_COMMANDS = [
     'vkCreateImage',
     'vkDestroyImage',
 
+    # Platform-managed pipeline cache persistence
+    'vkCreatePipelineCache',
+    'vkDestroyPipelineCache',
+    'vkGetPipelineCacheData',
+
     'vkGetPhysicalDeviceProperties',
 
     # VK_KHR_swapchain v69 requirement
@@ -145,6 +150,10 @@ _INTERCEPTED_COMMANDS = [
 
     'vkQueueSubmit',
 
+    # Platform-managed pipeline cache persistence
+    'vkCreatePipelineCache',
+    'vkDestroyPipelineCache',
+
     # VK_KHR_swapchain v69 requirement
     'vkBindImageMemory2',
     'vkBindImageMemory2KHR',